@@ -0,0 +1,71 @@
+# Copyright 2021 PickNik Inc.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+#    * Redistributions of source code must retain the above copyright
+#      notice, this list of conditions and the following disclaimer.
+#
+#    * Redistributions in binary form must reproduce the above copyright
+#      notice, this list of conditions and the following disclaimer in the
+#      documentation and/or other materials provided with the distribution.
+#
+#    * Neither the name of the PickNik Inc. nor the names of its
+#      contributors may be used to endorse or promote products derived from
+#      this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+
+
+# moveit_add_fk_kernel(<target> URDF <urdf_file> SRDF <srdf_file>)
+#
+# Generate the forward kinematics of a robot model as C++ code, with its joint axes and fixed transforms compiled in,
+# and build it as the object library <target>. Link <target> into the executable or library that loads the robot
+# model: the kernel registers itself when it is loaded, and RobotState uses it for models with the same structure
+# (see moveit/robot_model/fk_kernel.h). The URDF file must be plain URDF, so expand xacro files first.
+function(moveit_add_fk_kernel target)
+  cmake_parse_arguments(ARG "" "URDF;SRDF" "" ${ARGN})
+  if(NOT ARG_URDF OR NOT ARG_SRDF)
+    message(FATAL_ERROR "moveit_add_fk_kernel(${target}): URDF and SRDF files are required")
+  endif()
+  get_filename_component(urdf_file "${ARG_URDF}" ABSOLUTE)
+  get_filename_component(srdf_file "${ARG_SRDF}" ABSOLUTE)
+
+  # the generator is a target when building moveit_core itself, and installed with it otherwise
+  if(TARGET moveit_generate_fk_kernel)
+    set(generator moveit_generate_fk_kernel)
+    set(robot_model_library moveit_robot_model)
+  else()
+    find_program(MOVEIT_GENERATE_FK_KERNEL moveit_generate_fk_kernel HINTS "${moveit_core_DIR}/../../../bin")
+    if(NOT MOVEIT_GENERATE_FK_KERNEL)
+      message(FATAL_ERROR "moveit_add_fk_kernel(${target}): moveit_generate_fk_kernel not found, "
+                          "call find_package(moveit_core) first")
+    endif()
+    set(generator "${MOVEIT_GENERATE_FK_KERNEL}")
+    set(robot_model_library moveit_core::moveit_robot_model)
+  endif()
+
+  string(MAKE_C_IDENTIFIER "${target}_compute" function_name)
+  set(output "${CMAKE_CURRENT_BINARY_DIR}/${target}.cpp")
+  add_custom_command(
+    OUTPUT "${output}"
+    COMMAND ${generator} "${urdf_file}" "${srdf_file}" "${output}" ${function_name}
+    DEPENDS "${urdf_file}" "${srdf_file}" ${generator}
+    COMMENT "Generating forward kinematics kernel ${target}"
+    VERBATIM
+  )
+  add_library(${target} OBJECT "${output}")
+  set_target_properties(${target} PROPERTIES POSITION_INDEPENDENT_CODE ON)
+  target_link_libraries(${target} PUBLIC ${robot_model_library})
+endfunction()
@@ -0,0 +1,137 @@
+"""Content-hashed cache of expanded xacro files.
+
+Expanding a robot description with xacro takes seconds for large robots, and every launch file that builds
+MoveItConfigs expands it again. The expanded XML is cached together with the content hashes of all files read while
+expanding it (the file itself, its includes and the yaml files it loads), so it is reused until one of them or the
+mappings change.
+
+By default, the cache is kept in $XDG_CACHE_HOME/moveit_configs_utils (~/.cache/moveit_configs_utils).
+Set MOVEIT_CONFIGS_CACHE_DIR to use another directory, or to an empty string to disable caching.
+"""
+
+import hashlib
+import json
+import logging
+import os
+import sys
+import tempfile
+import threading
+from pathlib import Path
+from typing import Dict, Optional
+
+from launch_param_builder import load_xacro
+
+CACHE_VERSION = 1
+
+# Files opened while expanding a xacro file, recorded by an audit hook
+_recording_lock = threading.Lock()
+_recorded_files = None
+_audit_hook_installed = False
+
+# Expansions of this process, to skip reading the cache files
+_expansions: Dict[str, dict] = {}
+
+
+def _record_open(event, args):
+    if (
+        event == "open"
+        and _recorded_files is not None
+        and isinstance(args[0], (str, bytes, os.PathLike))
+        and (args[1] is None or "r" in args[1])
+    ):
+        _recorded_files.add(os.path.abspath(os.fsdecode(args[0])))
+
+
+def get_cache_directory() -> Optional[Path]:
+    """Get the cache directory, or None if caching is disabled."""
+    directory = os.environ.get("MOVEIT_CONFIGS_CACHE_DIR")
+    if directory is not None:
+        return Path(directory) if directory else None
+    cache_home = os.environ.get("XDG_CACHE_HOME") or Path.home() / ".cache"
+    return Path(cache_home) / "moveit_configs_utils"
+
+
+def _file_hash(path) -> Optional[str]:
+    try:
+        with open(path, "rb") as f:
+            return hashlib.sha256(f.read()).hexdigest()
+    except OSError:
+        return None
+
+
+def _is_valid(entry: dict) -> bool:
+    return entry.get("version") == CACHE_VERSION and all(
+        _file_hash(path) == digest for path, digest in entry["dependencies"].items()
+    )
+
+
+def _expand(file_path: Path, mappings: Optional[dict]) -> dict:
+    global _recorded_files, _audit_hook_installed
+    with _recording_lock:
+        if not _audit_hook_installed:
+            sys.addaudithook(_record_open)
+            _audit_hook_installed = True
+        _recorded_files = set()
+        try:
+            xml = load_xacro(file_path, mappings=mappings)
+            files = _recorded_files | {os.path.abspath(file_path)}
+        finally:
+            _recorded_files = None
+    dependencies = {}
+    for path in sorted(files):
+        if os.path.isfile(path):
+            dependencies[path] = _file_hash(path)
+    return {"version": CACHE_VERSION, "dependencies": dependencies, "xml": xml}
+
+
+def load_xacro_cached(
+    file_path: Path,
+    mappings: Optional[dict] = None,
+    cache_directory: Optional[Path] = None,
+) -> str:
+    """Expand a xacro file like launch_param_builder.load_xacro, reusing a cached expansion if it is still valid.
+
+    :param file_path: Path to the xacro file.
+    :param mappings: Mappings (xacro arguments) to be passed when expanding the file.
+    :param cache_directory: Directory of the cache, get_cache_directory() if None.
+    :return: The expanded XML.
+    """
+    file_path = Path(file_path)
+    if cache_directory is None:
+        cache_directory = get_cache_directory()
+    if cache_directory is None or not file_path.is_file():
+        return load_xacro(file_path, mappings=mappings)
+
+    key = hashlib.sha256(
+        json.dumps(
+            [str(file_path.resolve()), sorted((mappings or {}).items())]
+        ).encode()
+    ).hexdigest()
+    cache_file = Path(cache_directory) / "xacro" / (key + ".json")
+
+    entry = _expansions.get(key)
+    if entry is None:
+        try:
+            with open(cache_file, "r") as f:
+                entry = json.load(f)
+        except (OSError, ValueError):
+            entry = None
+    if entry is not None and _is_valid(entry):
+        _expansions[key] = entry
+        return entry["xml"]
+
+    entry = _expand(file_path, mappings)
+    _expansions[key] = entry
+    try:
+        # replace atomically, as other launch files may read the cache at the same time
+        cache_file.parent.mkdir(parents=True, exist_ok=True)
+        with tempfile.NamedTemporaryFile(
+            "w", dir=cache_file.parent, suffix=".tmp", delete=False
+        ) as f:
+            json.dump(entry, f)
+        os.replace(f.name, cache_file)
+    except OSError as e:
+        logging.warning(
+            f"\x1b[33;21mCannot cache the expansion of {file_path}: {e}\x1b[0m"
+        )
+    return entry["xml"]
@@ -38,6 +38,10 @@ Example:
 Each function in MoveItConfigsBuilder has a file_path as an argument which is used to override the default
 path for the file
 
+The expanded URDF and SRDF are cached (see moveit_configs_utils.description_cache), and the nodes started with
+the parameters share the snapshots of the RobotModel's collision meshes in the same cache directory
+(robot_description_planning.model_cache_directory). Pass use_cache=False to the builder to disable both.
+
 Example:
     moveit_configs = MoveItConfigsBuilder("robot_name")
                     # Relative to robot_name_moveit_configs
@@ -59,6 +63,10 @@ from ament_index_python.packages import get_package_share_directory
 
 from launch_param_builder import ParameterBuilder, load_yaml, load_xacro
 from launch_param_builder.utils import ParameterBuilderFileNotFoundError
+from moveit_configs_utils.description_cache import (
+    get_cache_directory,
+    load_xacro_cached,
+)
 from moveit_configs_utils.substitutions import Xacro
 from launch.some_substitutions_type import SomeSubstitutionsType
 from launch_ros.parameter_descriptions import ParameterValue
@@ -154,8 +162,10 @@ class MoveItConfigsBuilder(ParameterBuilder):
         robot_name: str,
         robot_description="robot_description",
         package_name: Optional[str] = None,
+        use_cache: bool = True,
     ):
         super().__init__(package_name or (robot_name + "_moveit_config"))
+        self.__cache_directory = get_cache_directory() if use_cache else None
         self.__moveit_configs = MoveItConfigs(package_path=self._package_path)
         self.__robot_name = robot_name
         setup_assistant_file = self._package_path / ".setup_assistant"
@@ -208,6 +218,13 @@ class MoveItConfigsBuilder(ParameterBuilder):
 
         self.__robot_description = robot_description
 
+    def __load_xacro(self, file_path: Path, mappings: Optional[dict] = None) -> str:
+        if self.__cache_directory is None:
+            return load_xacro(file_path, mappings=mappings)
+        return load_xacro_cached(
+            file_path, mappings=mappings, cache_directory=self.__cache_directory
+        )
+
     def robot_description(
         self,
         file_path: Optional[str] = None,
@@ -229,7 +246,7 @@ class MoveItConfigsBuilder(ParameterBuilder):
         ):
             try:
                 self.__moveit_configs.robot_description = {
-                    self.__robot_description: load_xacro(
+                    self.__robot_description: self.__load_xacro(
                         robot_description_file_path,
                         mappings=mappings or self.__urdf_xacro_args,
                     )
@@ -267,7 +284,7 @@ class MoveItConfigsBuilder(ParameterBuilder):
         ):
             self.__moveit_configs.robot_description_semantic = {
                 self.__robot_description
-                + "_semantic": load_xacro(
+                + "_semantic": self.__load_xacro(
                     self._package_path / (file_path or self.__srdf_file_path),
                     mappings=mappings,
                 )
@@ -522,6 +539,12 @@ class MoveItConfigsBuilder(ParameterBuilder):
             self.sensors_3d()
         if not self.__moveit_configs.joint_limits:
             self.joint_limits()
+        if self.__cache_directory is not None:
+            self.__moveit_configs.joint_limits.setdefault(
+                self.__robot_description + "_planning", {}
+            ).setdefault(
+                "model_cache_directory", str(self.__cache_directory / "robot_models")
+            )
         # TODO(JafarAbdi): We should have a default moveit_cpp.yaml as port of a moveit config package
         # if not self.__moveit_configs.moveit_cpp:
         #     self.moveit_cpp()
@@ -6,7 +6,7 @@ from launch.launch_context import LaunchContext
 from launch.some_substitutions_type import SomeSubstitutionsType
 from launch.substitution import Substitution
 from launch.utilities import normalize_to_list_of_substitutions
-from launch_param_builder import load_xacro
+from moveit_configs_utils.description_cache import load_xacro_cached
 
 
 @expose_substitution("xacro")
@@ -71,4 +71,4 @@ class Xacro(Substitution):
                 perform_substitutions(context, normalized_key)
             ] = perform_substitutions(context, normalized_value)
 
-        return load_xacro(Path(expanded_file_path), mappings=expanded_mappings)
+        return load_xacro_cached(Path(expanded_file_path), mappings=expanded_mappings)
@@ -0,0 +1,42 @@
+import shutil
+from pathlib import Path
+
+from launch_param_builder import load_xacro
+
+from moveit_configs_utils import description_cache
+from moveit_configs_utils.description_cache import load_xacro_cached
+
+
+def test_cached_expansion(tmp_path, monkeypatch):
+    xacro_file = tmp_path / "robot.urdf.xacro"
+    shutil.copy(Path(__file__).parent / "robot.urdf.xacro", xacro_file)
+    cache_directory = tmp_path / "cache"
+    mappings = {"postfix": "cached"}
+
+    expanded = load_xacro_cached(xacro_file, mappings, cache_directory)
+    assert expanded == load_xacro(xacro_file, mappings=mappings)
+    assert len(list((cache_directory / "xacro").glob("*.json"))) == 1
+
+    # the cache file is used by other processes, which have not expanded the file yet
+    description_cache._expansions.clear()
+
+    def fail(*args, **kwargs):
+        raise AssertionError("expanded although the cache is valid")
+
+    monkeypatch.setattr(description_cache, "load_xacro", fail)
+    assert load_xacro_cached(xacro_file, mappings, cache_directory) == expanded
+    monkeypatch.undo()
+
+    # other mappings and changed files are expanded again
+    assert "link_other" in load_xacro_cached(
+        xacro_file, {"postfix": "other"}, cache_directory
+    )
+    xacro_file.write_text(xacro_file.read_text().replace('"base"', '"changed_base"'))
+    assert "changed_base" in load_xacro_cached(xacro_file, mappings, cache_directory)
+
+
+def test_cache_disabled(monkeypatch):
+    monkeypatch.setenv("MOVEIT_CONFIGS_CACHE_DIR", "")
+    assert description_cache.get_cache_directory() is None
+    monkeypatch.setenv("MOVEIT_CONFIGS_CACHE_DIR", "/tmp/moveit_configs_cache")
+    assert description_cache.get_cache_directory() == Path("/tmp/moveit_configs_cache")
@@ -37,6 +37,7 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <functional>
 #include <vector>
 #include <string>
@@ -144,7 +145,12 @@ struct CostSource
 /** \brief Representation of a collision checking result */
 struct CollisionResult
 {
-  CollisionResult() : collision(false), distance(std::numeric_limits<double>::max()), contact_count(0)
+  CollisionResult()
+    : collision(false)
+    , distance(std::numeric_limits<double>::max())
+    , contact_count(0)
+    , checked_pairs(0)
+    , budget_exceeded(false)
   {
   }
   using ContactMap = std::map<std::pair<std::string, std::string>, std::vector<Contact> >;
@@ -157,6 +163,8 @@ struct CollisionResult
     collision = false;
     distance = std::numeric_limits<double>::max();
     contact_count = 0;
+    checked_pairs = 0;
+    budget_exceeded = false;
     contacts.clear();
     cost_sources.clear();
   }
@@ -178,6 +186,13 @@ struct CollisionResult
 
   /** \brief These are the individual cost sources when costs are computed */
   std::set<CostSource> cost_sources;
+
+  /** \brief Number of pairs of bodies checked exactly so far, counted against CollisionRequest::max_checked_pairs */
+  std::size_t checked_pairs;
+
+  /** \brief True if the check ran out of the budget of the request before it was complete. \e collision is then
+   *  set as well, as the state could not be shown to be collision free */
+  bool budget_exceeded;
 };
 
 /** \brief Representation of a collision checking request */
@@ -191,6 +206,8 @@ struct CollisionRequest
     , max_contacts_per_pair(1)
     , max_cost_sources(1)
     , verbose(false)
+    , max_checked_pairs(0)
+    , deadline(std::chrono::steady_clock::time_point::max())
   {
   }
   virtual ~CollisionRequest()
@@ -224,6 +241,20 @@ struct CollisionRequest
 
   /** \brief Flag indicating whether information about detected collisions should be reported */
   bool verbose;
+
+  /** \brief Maximum number of pairs of bodies to check exactly, 0 for no limit. Pairs rejected by the broad phase or
+   *  the allowed collision matrix are not counted. A check that would exceed it stops and reports a collision, with
+   *  CollisionResult::budget_exceeded set. The count is kept in the result, so it covers the self and world checks
+   *  of one checkCollision() call.
+   *
+   *  Together with \e deadline, and with distance, cost and contacts disabled, this bounds the runtime of checks
+   *  run under real-time scheduling, e.g. by servo. Only environments for which supportsCollisionBudget() returns
+   *  true honor the budget. */
+  std::size_t max_checked_pairs;
+
+  /** \brief Time after which the check stops and reports a collision, with CollisionResult::budget_exceeded set. The
+   *  deadline is tested between pairs of bodies, so a single expensive pair, e.g. a large octomap, can overrun it. */
+  std::chrono::steady_clock::time_point deadline;
 };
 
 namespace DistanceRequestTypes
@@ -39,6 +39,7 @@
 #include <moveit/collision_detection/collision_matrix.h>
 #include <moveit/macros/class_forward.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit_msgs/msg/link_padding.hpp>
 #include <moveit_msgs/msg/link_scale.hpp>
 #include <moveit/collision_detection/world.h>
@@ -110,6 +111,29 @@ public:
   virtual void checkCollision(const CollisionRequest& req, CollisionResult& res, const moveit::core::RobotState& state,
                               const AllowedCollisionMatrix& acm) const;
 
+  /** \brief Check a batch of states for self collisions and collisions with the world, as checkCollision() does
+   *  for a single state. Element i of \e in_collision is set to whether \e states[i] is in collision.
+   *
+   *  Only the collision flag is reported per state. Implementations may skip computing the contacts, distances or
+   *  costs requested by \e req, so these should be disabled for batch checks.
+   *  @param req A CollisionRequest object that encapsulates the collision request
+   *  @param in_collision Resized to the number of states and filled with the result of each state
+   *  @param states The kinematic states to check, with up to date transforms
+   *  @return The number of states in collision */
+  virtual std::size_t checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                          const std::vector<const moveit::core::RobotState*>& states) const;
+
+  /** \brief Check a batch of states for self collisions and collisions with the world, taking the allowed
+   *  collision matrix into account. See above.
+   *  @param req A CollisionRequest object that encapsulates the collision request
+   *  @param in_collision Resized to the number of states and filled with the result of each state
+   *  @param states The kinematic states to check, with up to date transforms
+   *  @param acm The allowed collision matrix.
+   *  @return The number of states in collision */
+  virtual std::size_t checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                          const std::vector<const moveit::core::RobotState*>& states,
+                                          const AllowedCollisionMatrix& acm) const;
+
   /** \brief Check whether the robot model is in collision with the world. Any collisions between a robot link
    *  and the world are considered. Self collisions are not checked.
    *  @param req A CollisionRequest object that encapsulates the collision request
@@ -156,6 +180,43 @@ public:
                                    const moveit::core::RobotState& state1,
                                    const moveit::core::RobotState& state2) const = 0;
 
+  /** \brief Check whether the robot model is in collision with the world while moving along \e trajectory. Each
+   *  segment between two consecutive waypoints is checked in a continuous manner, so collisions between waypoints
+   *  are found as well. Checking stops at the first colliding segment. A trajectory with a single waypoint is checked
+   *  discretely. Allowed collisions are ignored. Self collisions are not checked.
+   *
+   *  The default implementation calls the two-state checkRobotCollision() for every segment. Only use this on
+   *  environments for which supportsContinuousCollision() returns true.
+   *  @param req A CollisionRequest object that encapsulates the collision request
+   *  @param res A CollisionResult object that encapsulates the collision result
+   *  @param trajectory The trajectory to check. The transforms of its waypoints need to be up to date. */
+  virtual void checkRobotCollisionContinuous(const CollisionRequest& req, CollisionResult& res,
+                                             const robot_trajectory::RobotTrajectory& trajectory) const;
+
+  /** \brief Check whether the robot model is in collision with the world while moving along \e trajectory. Each
+   *  segment between two consecutive waypoints is checked in a continuous manner, see above.
+   *  @param req A CollisionRequest object that encapsulates the collision request
+   *  @param res A CollisionResult object that encapsulates the collision result
+   *  @param trajectory The trajectory to check. The transforms of its waypoints need to be up to date.
+   *  @param acm The allowed collision matrix. */
+  virtual void checkRobotCollisionContinuous(const CollisionRequest& req, CollisionResult& res,
+                                             const robot_trajectory::RobotTrajectory& trajectory,
+                                             const AllowedCollisionMatrix& acm) const;
+
+  /** \brief Whether the continuous (two-state) variants of checkRobotCollision() are implemented by this
+   *  environment. Environments that do not support them leave the result untouched. */
+  virtual bool supportsContinuousCollision() const
+  {
+    return false;
+  }
+
+  /** \brief Whether the discrete checks of this environment honor CollisionRequest::max_checked_pairs and
+   *  CollisionRequest::deadline. Environments that do not support them always complete the check. */
+  virtual bool supportsCollisionBudget() const
+  {
+    return false;
+  }
+
   /** \brief The distance to self-collision given the robot is at state \e state.
       @param req A DistanceRequest object that encapsulates the distance request
       @param res A DistanceResult object that encapsulates the distance result
@@ -302,6 +363,11 @@ public:
   /** @brief Get the link scaling as a vector of messages*/
   void getScale(std::vector<moveit_msgs::msg::LinkScale>& scale) const;
 
+  /** @brief Add the memory held by this environment, its collision geometry and its world to \e usage. Nothing is
+      added if \e usage already counted this environment. Geometry shared with other environments, e.g. the padded
+      and unpadded environments of a planning scene, is counted once. */
+  void getMemoryUsage(moveit::core::MemoryUsage& usage) const;
+
 protected:
   /** @brief When the scale or padding is changed for a set of links by any of the functions in this class,
      updatedPaddingOrScaling() function is called.
@@ -311,6 +377,10 @@ protected:
       @param links the names of the links whose padding or scaling were updated */
   virtual void updatedPaddingOrScaling(const std::vector<std::string>& links);
 
+  /** @brief Add the memory held by this environment to \e usage, called once per \e usage by getMemoryUsage().
+      Derived classes extend it with their collision geometry. */
+  virtual void addMemoryUsage(moveit::core::MemoryUsage& usage) const;
+
   /** @brief The kinematic model corresponding to this collision model*/
   moveit::core::RobotModelConstPtr robot_model_;
 
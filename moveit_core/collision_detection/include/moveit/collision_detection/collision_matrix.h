@@ -38,11 +38,14 @@
 
 #include <moveit/collision_detection/collision_common.h>
 #include <moveit/macros/class_forward.h>
+#include <moveit/utils/interned_name.h>
+#include <moveit/utils/memory_usage.h>
 #include <moveit_msgs/msg/allowed_collision_matrix.hpp>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 namespace collision_detection
 {
@@ -195,6 +198,9 @@ public:
   /** @brief Clear the allowed collision matrix */
   void clear();
 
+  /** @brief Add the memory held by the entries and the lookup tables of this matrix to \e usage */
+  void getMemoryUsage(moveit::core::MemoryUsage& usage) const;
+
   /** @brief Get the size of the allowed collision matrix (number of specified entries) */
   std::size_t getSize() const
   {
@@ -243,6 +249,35 @@ public:
   bool getAllowedCollision(const std::string& name1, const std::string& name2,
                            AllowedCollision::Type& allowed_collision) const;
 
+  /** @brief Get the index of an element for the index-based lookups.
+   *  Return -1 if the element has neither an entry nor a default entry. Indices of known elements stay valid until
+   *  clear() is called, so callers checking many pairs can resolve the names once and cache the indices.
+   *  @param name name of the element */
+  int getEntryIndex(const std::string& name) const;
+
+  /** @brief Get the type of the allowed collision between two elements given by their index (see getEntryIndex()).
+   *  Same semantics as the name-based version, but only does an array lookup.
+   *  @param index1 index of first element
+   *  @param index2 index of second element
+   *  @param allowed_collision The allowed collision type will be filled here */
+  bool getAllowedCollision(std::size_t index1, std::size_t index2, AllowedCollision::Type& allowed_collision) const;
+
+  /** @brief Get the index of an element for the index-based lookups, given its interned name.
+   *  Same as the string version, but only does an array lookup.
+   *  @param name interned name of the element */
+  int getEntryIndex(const moveit::core::InternedName& name) const
+  {
+    return interned_index_.get(name);
+  }
+
+  /** @brief Get the type of the allowed collision between two elements given by their interned names.
+   *  Same semantics as the string version, but only does array lookups.
+   *  @param name1 interned name of first element
+   *  @param name2 interned name of second element
+   *  @param allowed_collision The allowed collision type will be filled here */
+  bool getAllowedCollision(const moveit::core::InternedName& name1, const moveit::core::InternedName& name2,
+                           AllowedCollision::Type& allowed_collision) const;
+
   /** @brief Print the allowed collision matrix */
   void print(std::ostream& out) const;
 
@@ -250,10 +285,31 @@ private:
   bool getDefaultEntry(const std::string& name1, const std::string& name2,
                        AllowedCollision::Type& allowed_collision) const;
 
+  /** @brief Combine the default entries of two elements into the default of the pair */
+  static bool combineDefaultEntries(unsigned char default1, unsigned char default2,
+                                    AllowedCollision::Type& allowed_collision);
+
+  /** @brief Get the index of an element in the flat tables, adding it if needed */
+  std::size_t getOrCreateEntryIndex(const std::string& name);
+
+  /** @brief Set the (symmetric) flat table value for a pair of elements */
+  void setFlatEntry(const std::string& name1, const std::string& name2, unsigned char value);
+
+  /** @brief Marker in the flat tables for pairs (or defaults) that are not set */
+  static constexpr unsigned char NO_ENTRY = 0xff;
+
   std::map<std::string, std::map<std::string, AllowedCollision::Type> > entries_;
   std::map<std::string, std::map<std::string, DecideContactFn> > allowed_contacts_;
 
   std::map<std::string, AllowedCollision::Type> default_entries_;
   std::map<std::string, DecideContactFn> default_allowed_contacts_;
+
+  // Flat mirror of entries_ and default_entries_ for fast lookups. Every element that ever had an entry is assigned an
+  // index, flat_entries_ is a flat_capacity_ x flat_capacity_ table holding the type of each pair, or NO_ENTRY
+  std::unordered_map<std::string, std::size_t> flat_index_;
+  moveit::core::InternedNameMap<int> interned_index_{ -1 };  // flat_index_ by interned name id
+  std::vector<unsigned char> flat_entries_;
+  std::vector<unsigned char> flat_default_entries_;
+  std::size_t flat_capacity_ = 0;
 };
 }  // namespace collision_detection
@@ -0,0 +1,80 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <geometric_shapes/shapes.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace collision_detection
+{
+/** \brief Parameters of the approximate convex decomposition of meshes used by the collision checkers */
+struct ConvexDecompositionOptions
+{
+  /** \brief If false (default), meshes are not decomposed and the collision checkers use the mesh or its convex hull */
+  bool enabled = false;
+
+  /** \brief Directory in which decompositions are stored for other processes, by mesh hash. If empty, decompositions
+   *  are only kept in memory. */
+  std::string cache_directory;
+
+  /** \brief A part is split further while points of its surface lie deeper than this inside its convex hull */
+  double max_concavity = 0.005;
+
+  /** \brief The maximal number of convex parts of one mesh */
+  unsigned int max_parts = 16;
+};
+
+/** \brief Convex meshes whose union contains the surface of a mesh */
+using ConvexDecomposition = std::vector<std::shared_ptr<const shapes::Mesh>>;
+using ConvexDecompositionConstPtr = std::shared_ptr<const ConvexDecomposition>;
+
+/** \brief Set the options used by getConvexDecomposition() in this process */
+void setConvexDecompositionOptions(const ConvexDecompositionOptions& options);
+
+ConvexDecompositionOptions getConvexDecompositionOptions();
+
+/** \brief Decompose \e mesh into at most \e max_parts convex meshes, splitting the parts deeper than \e max_concavity
+ *  inside their hull first. The triangles are split by planes, so every triangle of \e mesh is contained in one
+ *  part. Return an empty decomposition if \e mesh has no triangles. */
+ConvexDecomposition decomposeMesh(const shapes::Mesh& mesh, double max_concavity, unsigned int max_parts);
+
+/** \brief Get the decomposition of \e mesh with the options of this process. It is computed once per mesh content and
+ *  shared by all callers, and loaded from and stored in the cache directory if one is set. Return nullptr if
+ *  decomposition is disabled or \e mesh has no triangles. */
+ConvexDecompositionConstPtr getConvexDecomposition(const shapes::Mesh& mesh);
+}  // namespace collision_detection
@@ -164,6 +164,42 @@ TYPED_TEST_P(CollisionDetectorPandaTest, RobotWorldCollision_1)
   ASSERT_FALSE(res.collision);
 }
 
+/** \brief A batch check reports the same result for every state as checking the states one by one. */
+TYPED_TEST_P(CollisionDetectorPandaTest, CollisionBatch)
+{
+  moveit::core::RobotState self_colliding(*this->robot_state_);
+  double joint2 = 0.15;
+  double joint4 = -3.0;
+  self_colliding.setJointPositions("panda_joint2", &joint2);
+  self_colliding.setJointPositions("panda_joint4", &joint4);
+  self_colliding.update();
+
+  const std::vector<const moveit::core::RobotState*> states = { this->robot_state_.get(), &self_colliding,
+                                                                this->robot_state_.get() };
+  collision_detection::CollisionRequest req;
+  std::vector<bool> in_collision;
+
+  EXPECT_EQ(this->cenv_->checkCollisionBatch(req, in_collision, states, *this->acm_), 1u);
+  EXPECT_EQ(in_collision, std::vector<bool>({ false, true, false }));
+
+  EXPECT_EQ(this->cenv_->checkCollisionBatch(req, in_collision, {}, *this->acm_), 0u);
+  EXPECT_TRUE(in_collision.empty());
+
+  // a box the robot is in collision with at the home state
+  shapes::ShapeConstPtr shape_ptr = std::make_shared<shapes::Box>(.1, .1, .1);
+  Eigen::Isometry3d pos1 = Eigen::Isometry3d::Identity();
+  pos1.translation().z() = 0.3;
+  this->cenv_->getWorld()->addToObject("box", pos1, shape_ptr, Eigen::Isometry3d::Identity());
+
+  EXPECT_EQ(this->cenv_->checkCollisionBatch(req, in_collision, states, *this->acm_), 3u);
+  for (std::size_t i = 0; i < states.size(); ++i)
+  {
+    collision_detection::CollisionResult res;
+    this->cenv_->checkCollision(req, res, *states[i], *this->acm_);
+    EXPECT_EQ(in_collision[i], res.collision);
+  }
+}
+
 /** \brief Adding obstacles to the world which are tested against the robot. */
 TYPED_TEST_P(CollisionDetectorPandaTest, RobotWorldCollision_2)
 {
@@ -361,7 +397,8 @@ TYPED_TEST_P(DistanceFullPandaTest, DistancePoints)
 }
 
 REGISTER_TYPED_TEST_SUITE_P(CollisionDetectorPandaTest, InitOK, DefaultNotInCollision, LinksInCollision,
-                            RobotWorldCollision_1, RobotWorldCollision_2, PaddingTest, DistanceSelf, DistanceWorld);
+                            RobotWorldCollision_1, CollisionBatch, RobotWorldCollision_2, PaddingTest, DistanceSelf,
+                            DistanceWorld);
 
 REGISTER_TYPED_TEST_SUITE_P(DistanceCheckPandaTest, DistanceSingle);
 
@@ -40,10 +40,13 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <functional>
 #include <Eigen/Geometry>
 #include <eigen_stl_containers/eigen_stl_vector_container.h>
 #include <moveit/transforms/transforms.h>
+#include <moveit/utils/interned_name.h>
+#include <moveit/utils/memory_usage.h>
 
 namespace shapes
 {
@@ -63,9 +66,12 @@ public:
 
   /** \brief A copy constructor.
    * \e other should not be changed while the copy constructor is running
-   * This does copy on write and should be quick. */
+   * This does copy on write and takes constant time: the copies share their objects until one of them is changed. */
   World(const World& other);
 
+  /** \brief Not assignable, as the observers belong to a single instance */
+  World& operator=(const World& other) = delete;
+
   virtual ~World();
 
   /**********************************************************************/
@@ -122,32 +128,58 @@ public:
   /** \brief Get a particular object */
   ObjectConstPtr getObject(const std::string& object_id) const;
 
+  /** \brief Get a particular object by its interned id, without hashing or comparing strings */
+  ObjectConstPtr getObject(const moveit::core::InternedName& object_id) const
+  {
+    const ObjectPtr* obj = store_->objects_by_interned_id_.get(object_id);
+    return obj ? *obj : ObjectConstPtr();
+  }
+
   /** iterator over the objects in the world. */
   using const_iterator = std::map<std::string, ObjectPtr>::const_iterator;
   /** iterator pointing to first change */
   const_iterator begin() const
   {
-    return objects_.begin();
+    return store_->objects_.begin();
   }
   /** iterator pointing to end of changes */
   const_iterator end() const
   {
-    return objects_.end();
+    return store_->objects_.end();
   }
   /** number of changes stored */
   std::size_t size() const
   {
-    return objects_.size();
+    return store_->objects_.size();
   }
   /** find changes for a named object */
   const_iterator find(const std::string& object_id) const
   {
-    return objects_.find(object_id);
+    return store_->objects_.find(object_id);
   }
 
   /** \brief Check if a particular object exists in the collision world*/
   bool hasObject(const std::string& object_id) const;
 
+  /** \brief Get the version of the objects, which changes whenever objects, their poses or subframes may have changed.
+   * Versions are unique within the process, so references to object poses obtained from any world can be cached by
+   * version. A copy of a world starts with the version of the original. */
+  std::size_t getVersion() const
+  {
+    return version_;
+  }
+
+  /** \brief Add the memory held by this world and its objects to \e usage. Nothing is added if \e usage already
+   * counted this world. Object stores, objects and shapes shared with copies of this world, or with other objects,
+   * are counted once. */
+  void getMemoryUsage(moveit::core::MemoryUsage& usage) const;
+
+  /** \brief Check if a particular object exists in the collision world, looking it up by its interned id */
+  bool hasObject(const moveit::core::InternedName& object_id) const
+  {
+    return store_->objects_by_interned_id_.get(object_id) != nullptr;
+  }
+
   /** \brief Check if an object or subframe with given name exists in the collision world.
    * A subframe name needs to be prefixed with the object's name separated by a slash. */
   bool knowsTransform(const std::string& name) const;
@@ -240,6 +272,12 @@ public:
    * Returns true on success and false if no such object was found. */
   bool removeObject(const std::string& object_id);
 
+  /** \brief Notify the observers that the shapes of an object were modified in place, e.g. the octree of an
+   * octomap was updated. The shapes and their poses stay the same, so observers can refresh derived data
+   * (e.g. bounding volumes) instead of recreating it.
+   * Returns false if the object did not exist. */
+  bool notifyShapesUpdated(const std::string& object_id);
+
   /** \brief Set subframes on an object. The frames are relative to the object pose. */
   bool setSubframesOfObject(const std::string& object_id, const moveit::core::FixedTransformsMap& subframe_poses);
 
@@ -256,6 +294,7 @@ public:
     MOVE_SHAPE = 4,    /** one or more shapes in object were moved */
     ADD_SHAPE = 8,     /** shape(s) were added to object */
     REMOVE_SHAPE = 16, /** shape(s) were removed from object */
+    UPDATE_SHAPE = 32, /** shape(s) were modified in place */
   };
 
   /** \brief Represents an action that occurred on an object in the world.
@@ -313,6 +352,24 @@ public:
    * Used which switching from one world to another. */
   void notifyObserverAllObjects(const ObserverHandle observer_handle, Action action) const;
 
+  /** \brief Start a batch of changes.
+   * Until the matching commitBatch(), notifications are not sent to the observers
+   * but collected per object: all changes to an object are delivered as one
+   * notification with the combined action, and objects that are created and
+   * destroyed within the batch are not reported at all. Observers (e.g. collision
+   * environments) only reflect the changes after commitBatch().
+   * Batches may be nested, the notifications are sent when the outermost batch is committed. */
+  void beginBatch();
+
+  /** \brief End a batch of changes started with beginBatch() and send the collected notifications. */
+  void commitBatch();
+
+  /** \brief True if a batch of changes is in progress */
+  bool inBatch() const
+  {
+    return batch_depth_ > 0;
+  }
+
 private:
   /** notify all observers of a change */
   void notify(const ObjectConstPtr& /*obj*/, Action /*action*/);
@@ -332,8 +389,27 @@ private:
   /** \brief Updates the global shape and subframe poses. */
   void updateGlobalPosesInternal(ObjectPtr& obj, bool update_shape_poses = true, bool update_subframe_poses = true);
 
-  /** The objects maintained in the world */
-  std::map<std::string, ObjectPtr> objects_;
+  /** \brief The objects of a world. Copies of a world share their store until one of them changes its objects. */
+  struct ObjectStore
+  {
+    /** The objects maintained in the world */
+    std::map<std::string, ObjectPtr> objects_;
+
+    /** The entries of objects_ indexed by the ids of the interned object names. Object ids are interned when the
+     *  objects are created. */
+    moveit::core::InternedNameMap<const ObjectPtr*> objects_by_interned_id_{ nullptr };
+  };
+
+  /** \brief Make sure that the object store is known only to this instance of the World, copying it if it is shared
+   * with a copy of this world. Must be called before any change to the store. The objects in a copied store are still
+   * shared, so they must be made unique with ensureUnique() before they are changed. This also advances the
+   * version. */
+  void ensureUniqueStore();
+
+  std::shared_ptr<ObjectStore> store_;
+
+  /// The version of the objects, see getVersion()
+  std::size_t version_;
 
   /** Wrapper for a callback function to call when something changes in the world */
   class Observer
@@ -347,5 +423,23 @@ private:
 
   /// All registered observers of this world representation
   std::vector<Observer*> observers_;
+
+  /** \brief A notification collected during a batch of changes */
+  struct PendingChange
+  {
+    ObjectConstPtr obj_;
+    int action_;
+    /** The object did not exist when the batch started */
+    bool created_;
+  };
+
+  /// The number of open batches
+  unsigned int batch_depth_{ 0 };
+
+  /// The notifications collected during the current batch, in the order the objects were first changed
+  std::vector<PendingChange> pending_changes_;
+
+  /// The index of the latest entry in pending_changes_ for each object id
+  std::map<std::string, std::size_t> pending_change_index_;
 };
 }  // namespace collision_detection
@@ -305,7 +305,7 @@ void CollisionEnv::checkCollision(const CollisionRequest& req, CollisionResult&
                                   const moveit::core::RobotState& state) const
 {
   checkSelfCollision(req, res, state);
-  if (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts))
+  if (!res.budget_exceeded && (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts)))
     checkRobotCollision(req, res, state);
 }
 
@@ -313,7 +313,87 @@ void CollisionEnv::checkCollision(const CollisionRequest& req, CollisionResult&
                                   const moveit::core::RobotState& state, const AllowedCollisionMatrix& acm) const
 {
   checkSelfCollision(req, res, state, acm);
-  if (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts))
+  if (!res.budget_exceeded && (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts)))
     checkRobotCollision(req, res, state, acm);
 }
+
+std::size_t CollisionEnv::checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                              const std::vector<const moveit::core::RobotState*>& states) const
+{
+  in_collision.assign(states.size(), false);
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < states.size(); ++i)
+  {
+    CollisionResult res;
+    checkCollision(req, res, *states[i]);
+    if (res.collision)
+    {
+      in_collision[i] = true;
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::size_t CollisionEnv::checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                              const std::vector<const moveit::core::RobotState*>& states,
+                                              const AllowedCollisionMatrix& acm) const
+{
+  in_collision.assign(states.size(), false);
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < states.size(); ++i)
+  {
+    CollisionResult res;
+    checkCollision(req, res, *states[i], acm);
+    if (res.collision)
+    {
+      in_collision[i] = true;
+      ++count;
+    }
+  }
+  return count;
+}
+
+void CollisionEnv::checkRobotCollisionContinuous(const CollisionRequest& req, CollisionResult& res,
+                                                 const robot_trajectory::RobotTrajectory& trajectory) const
+{
+  if (trajectory.empty())
+    return;
+  if (trajectory.size() == 1)
+  {
+    checkRobotCollision(req, res, trajectory.getWayPoint(0));
+    return;
+  }
+  for (std::size_t i = 1; i < trajectory.size() && !res.collision; ++i)
+    checkRobotCollision(req, res, trajectory.getWayPoint(i - 1), trajectory.getWayPoint(i));
+}
+
+void CollisionEnv::checkRobotCollisionContinuous(const CollisionRequest& req, CollisionResult& res,
+                                                 const robot_trajectory::RobotTrajectory& trajectory,
+                                                 const AllowedCollisionMatrix& acm) const
+{
+  if (trajectory.empty())
+    return;
+  if (trajectory.size() == 1)
+  {
+    checkRobotCollision(req, res, trajectory.getWayPoint(0), acm);
+    return;
+  }
+  for (std::size_t i = 1; i < trajectory.size() && !res.collision; ++i)
+    checkRobotCollision(req, res, trajectory.getWayPoint(i - 1), trajectory.getWayPoint(i), acm);
+}
+
+void CollisionEnv::getMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  if (usage.visit(this))
+  {
+    addMemoryUsage(usage);
+    world_->getMemoryUsage(usage);
+  }
+}
+
+void CollisionEnv::addMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  usage.add("collision_env", (sizeof(std::string) + sizeof(double)) * (link_padding_.size() + link_scale_.size()));
+}
 }  // end of namespace collision_detection
@@ -37,6 +37,7 @@
 #include <moveit/collision_detection/collision_matrix.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <algorithm>
 #include <functional>
 #include <iomanip>
 
@@ -120,13 +121,16 @@ bool AllowedCollisionMatrix::getEntry(const std::string& name1, const std::strin
 bool AllowedCollisionMatrix::getEntry(const std::string& name1, const std::string& name2,
                                       AllowedCollision::Type& allowed_collision) const
 {
-  const auto it1 = entries_.find(name1);
-  if (it1 == entries_.end())
+  const auto it1 = flat_index_.find(name1);
+  if (it1 == flat_index_.end())
     return false;
-  auto it2 = it1->second.find(name2);
-  if (it2 == it1->second.end())
+  const auto it2 = flat_index_.find(name2);
+  if (it2 == flat_index_.end())
+    return false;
+  const unsigned char value = flat_entries_[it1->second * flat_capacity_ + it2->second];
+  if (value == NO_ENTRY)
     return false;
-  allowed_collision = it2->second;
+  allowed_collision = static_cast<AllowedCollision::Type>(value);
   return true;
 }
 
@@ -148,6 +152,7 @@ void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::strin
 {
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
   entries_[name1][name2] = entries_[name2][name1] = v;
+  setFlatEntry(name1, name2, v);
 
   // remove function pointers, if any
   auto it = allowed_contacts_.find(name1);
@@ -170,6 +175,7 @@ void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::strin
 {
   entries_[name1][name2] = entries_[name2][name1] = AllowedCollision::CONDITIONAL;
   allowed_contacts_[name1][name2] = allowed_contacts_[name2][name1] = fn;
+  setFlatEntry(name1, name2, AllowedCollision::CONDITIONAL);
 }
 
 void AllowedCollisionMatrix::removeEntry(const std::string& name)
@@ -180,10 +186,26 @@ void AllowedCollisionMatrix::removeEntry(const std::string& name)
     entry.second.erase(name);
   for (auto& allowed_contact : allowed_contacts_)
     allowed_contact.second.erase(name);
+
+  // the element keeps its index, only its pair entries are cleared
+  const auto it = flat_index_.find(name);
+  if (it != flat_index_.end())
+  {
+    for (std::size_t i = 0; i < flat_capacity_; ++i)
+      flat_entries_[it->second * flat_capacity_ + i] = flat_entries_[i * flat_capacity_ + it->second] = NO_ENTRY;
+  }
 }
 
 void AllowedCollisionMatrix::removeEntry(const std::string& name1, const std::string& name2)
 {
+  const auto it1 = flat_index_.find(name1);
+  const auto it2 = flat_index_.find(name2);
+  if (it1 != flat_index_.end() && it2 != flat_index_.end())
+  {
+    flat_entries_[it1->second * flat_capacity_ + it2->second] = NO_ENTRY;
+    flat_entries_[it2->second * flat_capacity_ + it1->second] = NO_ENTRY;
+  }
+
   auto jt = entries_.find(name1);
   if (jt != entries_.end())
   {
@@ -253,6 +275,11 @@ void AllowedCollisionMatrix::setEntry(const bool allowed)
     for (auto& it2 : entry.second)
       it2.second = v;
   }
+  for (unsigned char& value : flat_entries_)
+  {
+    if (value != NO_ENTRY)
+      value = v;
+  }
 }
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, const bool allowed)
@@ -260,20 +287,22 @@ void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, const bool
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
   default_entries_[name] = v;
   default_allowed_contacts_.erase(name);
+  flat_default_entries_[getOrCreateEntryIndex(name)] = v;
 }
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, DecideContactFn& fn)
 {
   default_entries_[name] = AllowedCollision::CONDITIONAL;
   default_allowed_contacts_[name] = fn;
+  flat_default_entries_[getOrCreateEntryIndex(name)] = AllowedCollision::CONDITIONAL;
 }
 
 bool AllowedCollisionMatrix::getDefaultEntry(const std::string& name, AllowedCollision::Type& allowed_collision) const
 {
-  auto it = default_entries_.find(name);
-  if (it == default_entries_.end())
+  const auto it = flat_index_.find(name);
+  if (it == flat_index_.end() || flat_default_entries_[it->second] == NO_ENTRY)
     return false;
-  allowed_collision = it->second;
+  allowed_collision = static_cast<AllowedCollision::Type>(flat_default_entries_[it->second]);
   return true;
 }
 
@@ -320,46 +349,122 @@ bool AllowedCollisionMatrix::getAllowedCollision(const std::string& name1, const
   return true;
 }
 
-bool AllowedCollisionMatrix::getDefaultEntry(const std::string& name1, const std::string& name2,
-                                             AllowedCollision::Type& allowed_collision) const
+bool AllowedCollisionMatrix::combineDefaultEntries(unsigned char default1, unsigned char default2,
+                                                   AllowedCollision::Type& allowed_collision)
 {
-  AllowedCollision::Type t1, t2;
-  const bool found1 = getDefaultEntry(name1, t1);
-  const bool found2 = getDefaultEntry(name2, t2);
-  if (!found1 && !found2)
+  if (default1 == NO_ENTRY && default2 == NO_ENTRY)
   {
     return false;
   }
-  else if (found1 && !found2)
+  else if (default2 == NO_ENTRY)
   {
-    allowed_collision = t1;
+    allowed_collision = static_cast<AllowedCollision::Type>(default1);
   }
-  else if (!found1 && found2)
+  else if (default1 == NO_ENTRY)
   {
-    allowed_collision = t2;
+    allowed_collision = static_cast<AllowedCollision::Type>(default2);
   }
-  else if (found1 && found2)
+  else if (default1 == AllowedCollision::NEVER || default2 == AllowedCollision::NEVER)
   {
-    if (t1 == AllowedCollision::NEVER || t2 == AllowedCollision::NEVER)
-    {
-      allowed_collision = AllowedCollision::NEVER;
-    }
-    else if (t1 == AllowedCollision::CONDITIONAL || t2 == AllowedCollision::CONDITIONAL)
-    {
-      allowed_collision = AllowedCollision::CONDITIONAL;
-    }
-    else
-    {  // ALWAYS is the only remaining case
-      allowed_collision = AllowedCollision::ALWAYS;
-    }
+    allowed_collision = AllowedCollision::NEVER;
+  }
+  else if (default1 == AllowedCollision::CONDITIONAL || default2 == AllowedCollision::CONDITIONAL)
+  {
+    allowed_collision = AllowedCollision::CONDITIONAL;
+  }
+  else
+  {  // ALWAYS is the only remaining case
+    allowed_collision = AllowedCollision::ALWAYS;
   }
   return true;
 }
 
+bool AllowedCollisionMatrix::getDefaultEntry(const std::string& name1, const std::string& name2,
+                                             AllowedCollision::Type& allowed_collision) const
+{
+  const auto it1 = flat_index_.find(name1);
+  const auto it2 = flat_index_.find(name2);
+  return combineDefaultEntries(it1 == flat_index_.end() ? NO_ENTRY : flat_default_entries_[it1->second],
+                               it2 == flat_index_.end() ? NO_ENTRY : flat_default_entries_[it2->second],
+                               allowed_collision);
+}
+
 bool AllowedCollisionMatrix::getAllowedCollision(const std::string& name1, const std::string& name2,
                                                  AllowedCollision::Type& allowed_collision) const
 {
-  return getEntry(name1, name2, allowed_collision) || getDefaultEntry(name1, name2, allowed_collision);
+  const auto it1 = flat_index_.find(name1);
+  const auto it2 = flat_index_.find(name2);
+  if (it1 == flat_index_.end())
+  {
+    return it2 != flat_index_.end() &&
+           combineDefaultEntries(NO_ENTRY, flat_default_entries_[it2->second], allowed_collision);
+  }
+  if (it2 == flat_index_.end())
+    return combineDefaultEntries(flat_default_entries_[it1->second], NO_ENTRY, allowed_collision);
+  return getAllowedCollision(it1->second, it2->second, allowed_collision);
+}
+
+bool AllowedCollisionMatrix::getAllowedCollision(std::size_t index1, std::size_t index2,
+                                                 AllowedCollision::Type& allowed_collision) const
+{
+  const unsigned char value = flat_entries_[index1 * flat_capacity_ + index2];
+  if (value != NO_ENTRY)
+  {
+    allowed_collision = static_cast<AllowedCollision::Type>(value);
+    return true;
+  }
+  return combineDefaultEntries(flat_default_entries_[index1], flat_default_entries_[index2], allowed_collision);
+}
+
+bool AllowedCollisionMatrix::getAllowedCollision(const moveit::core::InternedName& name1,
+                                                 const moveit::core::InternedName& name2,
+                                                 AllowedCollision::Type& allowed_collision) const
+{
+  const int index1 = interned_index_.get(name1);
+  const int index2 = interned_index_.get(name2);
+  if (index1 < 0)
+    return index2 >= 0 && combineDefaultEntries(NO_ENTRY, flat_default_entries_[index2], allowed_collision);
+  if (index2 < 0)
+    return combineDefaultEntries(flat_default_entries_[index1], NO_ENTRY, allowed_collision);
+  return getAllowedCollision(static_cast<std::size_t>(index1), static_cast<std::size_t>(index2), allowed_collision);
+}
+
+int AllowedCollisionMatrix::getEntryIndex(const std::string& name) const
+{
+  const auto it = flat_index_.find(name);
+  return it == flat_index_.end() ? -1 : static_cast<int>(it->second);
+}
+
+std::size_t AllowedCollisionMatrix::getOrCreateEntryIndex(const std::string& name)
+{
+  const auto it = flat_index_.find(name);
+  if (it != flat_index_.end())
+    return it->second;
+
+  const std::size_t index = flat_index_.size();
+  if (index == flat_capacity_)
+  {
+    // grow geometrically, so adding n elements copies the table O(log n) times only
+    const std::size_t capacity = std::max<std::size_t>(8, 2 * flat_capacity_);
+    std::vector<unsigned char> entries(capacity * capacity, NO_ENTRY);
+    for (std::size_t i = 0; i < flat_capacity_; ++i)
+    {
+      std::copy_n(flat_entries_.begin() + i * flat_capacity_, flat_capacity_, entries.begin() + i * capacity);
+    }
+    flat_entries_.swap(entries);
+    flat_default_entries_.resize(capacity, NO_ENTRY);
+    flat_capacity_ = capacity;
+  }
+  flat_index_[name] = index;
+  interned_index_.set(moveit::core::InternedName(name), static_cast<int>(index));
+  return index;
+}
+
+void AllowedCollisionMatrix::setFlatEntry(const std::string& name1, const std::string& name2, unsigned char value)
+{
+  const std::size_t index1 = getOrCreateEntryIndex(name1);
+  const std::size_t index2 = getOrCreateEntryIndex(name2);
+  flat_entries_[index1 * flat_capacity_ + index2] = flat_entries_[index2 * flat_capacity_ + index1] = value;
 }
 
 void AllowedCollisionMatrix::clear()
@@ -368,6 +473,24 @@ void AllowedCollisionMatrix::clear()
   allowed_contacts_.clear();
   default_entries_.clear();
   default_allowed_contacts_.clear();
+  flat_index_.clear();
+  interned_index_.clear();
+  flat_entries_.clear();
+  flat_default_entries_.clear();
+  flat_capacity_ = 0;
+}
+
+void AllowedCollisionMatrix::getMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  std::size_t bytes = sizeof(AllowedCollisionMatrix) + flat_entries_.capacity() + flat_default_entries_.capacity() +
+                      (sizeof(std::string) + sizeof(std::size_t)) * flat_index_.size();
+  for (const auto& entry : entries_)
+    bytes += sizeof(std::string) + (sizeof(std::string) + sizeof(AllowedCollision::Type)) * entry.second.size();
+  for (const auto& entry : allowed_contacts_)
+    bytes += sizeof(std::string) + (sizeof(std::string) + sizeof(DecideContactFn)) * entry.second.size();
+  bytes += (sizeof(std::string) + sizeof(AllowedCollision::Type)) * default_entries_.size() +
+           (sizeof(std::string) + sizeof(DecideContactFn)) * default_allowed_contacts_.size();
+  usage.add("acm", bytes);
 }
 
 void AllowedCollisionMatrix::getAllEntryNames(std::vector<std::string>& names) const
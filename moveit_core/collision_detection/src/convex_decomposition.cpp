@@ -0,0 +1,513 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/collision_detection/convex_decomposition.h>
+#include <moveit/utils/mapped_file.h>
+#include <geometric_shapes/bodies.h>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+namespace collision_detection
+{
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_collision_detection.convex_decomposition");
+
+namespace
+{
+// Layout of a cache file: the header below, followed by num_parts records. Each record is a PartRecordHeader,
+// 3 * vertex_count vertex coordinates (double) and 3 * triangle_count vertex indices (uint32, padded to a multiple of
+// 8 bytes).
+constexpr char CACHE_FILE_MAGIC[8] = { 'M', 'V', 'C', 'O', 'N', 'V', 'E', 'X' };
+constexpr std::uint32_t CACHE_FILE_VERSION = 1;
+
+struct CacheFileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t num_parts;
+  std::uint64_t hash;
+  std::uint32_t vertex_count;
+  std::uint32_t triangle_count;
+  double max_concavity;
+  std::uint32_t max_parts;
+  std::uint32_t reserved;
+};
+
+struct PartRecordHeader
+{
+  std::uint32_t vertex_count;
+  std::uint32_t triangle_count;
+};
+
+// Flat parts have no hull of nonzero volume, they are represented by their bounding box grown by this much instead
+constexpr double FLAT_PART_MARGIN = 1e-4;
+
+// The in-memory cache drops the decompositions nobody else references after this many insertions
+constexpr unsigned int MAX_CLEAN_COUNT = 100;
+
+std::size_t padded(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+void writePadded(std::ofstream& out, const void* data, std::size_t size)
+{
+  static const char ZEROS[8] = {};
+  out.write(static_cast<const char*>(data), size);
+  out.write(ZEROS, padded(size) - size);
+}
+
+// Copy \e size bytes at \e offset of \e file to \e data, advancing \e offset past the padding. Return false if the
+// file is too short.
+bool readPadded(const moveit::core::MappedFile& file, std::size_t& offset, void* data, std::size_t size)
+{
+  if (file.size() < offset || file.size() - offset < padded(size))
+    return false;
+  memcpy(data, file.begin() + offset, size);
+  offset += padded(size);
+  return true;
+}
+
+Eigen::Vector3d vertex(const shapes::Mesh& mesh, unsigned int index)
+{
+  return Eigen::Vector3d(mesh.vertices[3 * index], mesh.vertices[3 * index + 1], mesh.vertices[3 * index + 2]);
+}
+
+Eigen::Vector3d triangleCentroid(const shapes::Mesh& mesh, unsigned int triangle)
+{
+  return (vertex(mesh, mesh.triangles[3 * triangle]) + vertex(mesh, mesh.triangles[3 * triangle + 1]) +
+          vertex(mesh, mesh.triangles[3 * triangle + 2])) /
+         3.0;
+}
+
+/** \brief The convex hull of a part with the face planes pointing outwards */
+struct Hull
+{
+  EigenSTL::vector_Vector3d vertices;
+  std::vector<unsigned int> triangles;
+  EigenSTL::vector_Vector4d planes;
+
+  /** \brief The distance of \e point to the closest face plane, negative if \e point is outside */
+  double depth(const Eigen::Vector3d& point) const
+  {
+    double depth = std::numeric_limits<double>::infinity();
+    for (const Eigen::Vector4d& plane : planes)
+      depth = std::min(depth, -(plane.head<3>().dot(point) + plane[3]));
+    return depth;
+  }
+};
+
+Hull computeHull(const shapes::Mesh& part)
+{
+  Hull hull;
+  if (part.vertex_count >= 4)
+  {
+    const bodies::ConvexMesh convex(&part);
+    hull.vertices = convex.getVertices();
+    hull.triangles = convex.getTriangles();
+  }
+  if (hull.triangles.empty())
+  {
+    Eigen::AlignedBox3d box;
+    for (unsigned int i = 0; i < part.vertex_count; ++i)
+      box.extend(vertex(part, i));
+    box.min() -= Eigen::Vector3d::Constant(FLAT_PART_MARGIN);
+    box.max() += Eigen::Vector3d::Constant(FLAT_PART_MARGIN);
+
+    // corner i lies at the maximum of the box along axis d if bit d of i is set
+    static const unsigned int BOX_TRIANGLES[36] = { 0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4,
+                                                    2, 6, 7, 2, 7, 3, 0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6 };
+    hull.vertices.clear();
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+      hull.vertices.emplace_back((i & 1) ? box.max().x() : box.min().x(), (i & 2) ? box.max().y() : box.min().y(),
+                                 (i & 4) ? box.max().z() : box.min().z());
+    }
+    hull.triangles.assign(BOX_TRIANGLES, BOX_TRIANGLES + 36);
+  }
+
+  Eigen::Vector3d center = Eigen::Vector3d::Zero();
+  for (const Eigen::Vector3d& v : hull.vertices)
+    center += v;
+  center /= static_cast<double>(hull.vertices.size());
+  for (std::size_t i = 0; i + 2 < hull.triangles.size(); i += 3)
+  {
+    const Eigen::Vector3d& a = hull.vertices[hull.triangles[i]];
+    Eigen::Vector3d normal = (hull.vertices[hull.triangles[i + 1]] - a).cross(hull.vertices[hull.triangles[i + 2]] - a);
+    if (normal.norm() < std::numeric_limits<double>::epsilon())
+      continue;
+    normal.normalize();
+    if (normal.dot(center - a) > 0.0)
+      normal = -normal;
+    hull.planes.emplace_back(normal.x(), normal.y(), normal.z(), -normal.dot(a));
+  }
+  return hull;
+}
+
+/** \brief A set of triangles of the decomposed mesh together with its hull */
+struct Part
+{
+  std::vector<unsigned int> triangles;
+  Hull hull;
+
+  /** \brief The largest depth of the vertices and triangle centroids of the part inside the hull */
+  double concavity;
+};
+
+Part makePart(const shapes::Mesh& mesh, std::vector<unsigned int> triangles)
+{
+  Part part;
+  part.triangles = std::move(triangles);
+
+  std::vector<unsigned int> vertex_index(mesh.vertex_count, std::numeric_limits<unsigned int>::max());
+  std::vector<unsigned int> vertices;
+  for (unsigned int t : part.triangles)
+  {
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      unsigned int& index = vertex_index[mesh.triangles[3 * t + k]];
+      if (index == std::numeric_limits<unsigned int>::max())
+      {
+        index = vertices.size();
+        vertices.push_back(mesh.triangles[3 * t + k]);
+      }
+    }
+  }
+
+  shapes::Mesh sub_mesh(vertices.size(), part.triangles.size());
+  for (std::size_t i = 0; i < vertices.size(); ++i)
+  {
+    for (unsigned int d = 0; d < 3; ++d)
+      sub_mesh.vertices[3 * i + d] = mesh.vertices[3 * vertices[i] + d];
+  }
+  for (std::size_t i = 0; i < part.triangles.size(); ++i)
+  {
+    for (unsigned int k = 0; k < 3; ++k)
+      sub_mesh.triangles[3 * i + k] = vertex_index[mesh.triangles[3 * part.triangles[i] + k]];
+  }
+  part.hull = computeHull(sub_mesh);
+
+  part.concavity = 0.0;
+  for (unsigned int v : vertices)
+    part.concavity = std::max(part.concavity, part.hull.depth(vertex(mesh, v)));
+  for (unsigned int t : part.triangles)
+    part.concavity = std::max(part.concavity, part.hull.depth(triangleCentroid(mesh, t)));
+  return part;
+}
+
+/** \brief Split \e triangles at the median of their centroids along the axis in which the centroids spread most.
+ *  Return false if the triangles cannot be split. */
+bool splitTriangles(const shapes::Mesh& mesh, std::vector<unsigned int> triangles, std::vector<unsigned int>& first,
+                    std::vector<unsigned int>& second)
+{
+  if (triangles.size() < 2)
+    return false;
+  Eigen::AlignedBox3d bounds;
+  for (unsigned int t : triangles)
+    bounds.extend(triangleCentroid(mesh, t));
+  Eigen::Index axis;
+  if (bounds.sizes().maxCoeff(&axis) <= 0.0)
+    return false;
+
+  const auto middle = triangles.begin() + triangles.size() / 2;
+  std::nth_element(triangles.begin(), middle, triangles.end(), [&mesh, axis](unsigned int a, unsigned int b) {
+    return triangleCentroid(mesh, a)[axis] < triangleCentroid(mesh, b)[axis];
+  });
+  first.assign(triangles.begin(), middle);
+  second.assign(middle, triangles.end());
+  return true;
+}
+
+std::shared_ptr<const shapes::Mesh> hullMesh(const Hull& hull)
+{
+  auto mesh = std::make_shared<shapes::Mesh>(hull.vertices.size(), hull.triangles.size() / 3);
+  for (std::size_t i = 0; i < hull.vertices.size(); ++i)
+  {
+    for (unsigned int d = 0; d < 3; ++d)
+      mesh->vertices[3 * i + d] = hull.vertices[i][d];
+  }
+  std::copy(hull.triangles.begin(), hull.triangles.begin() + 3 * mesh->triangle_count, mesh->triangles);
+  return mesh;
+}
+
+std::uint64_t hashMesh(const shapes::Mesh& mesh)
+{
+  // FNV-1a over the raw vertex and index data
+  std::uint64_t hash = 14695981039346656037ULL;
+  const auto add = [&hash](const void* bytes, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      hash ^= static_cast<const unsigned char*>(bytes)[i];
+      hash *= 1099511628211ULL;
+    }
+  };
+  add(mesh.vertices, 3 * mesh.vertex_count * sizeof(double));
+  add(mesh.triangles, 3 * mesh.triangle_count * sizeof(unsigned int));
+  return hash;
+}
+
+/** \brief Identifies a decomposition by the mesh content and the options it was computed with */
+CacheFileHeader makeHeader(const shapes::Mesh& mesh, const ConvexDecompositionOptions& options)
+{
+  CacheFileHeader header{};
+  memcpy(header.magic, CACHE_FILE_MAGIC, sizeof(header.magic));
+  header.version = CACHE_FILE_VERSION;
+  header.hash = hashMesh(mesh);
+  header.vertex_count = mesh.vertex_count;
+  header.triangle_count = mesh.triangle_count;
+  header.max_concavity = options.max_concavity;
+  header.max_parts = options.max_parts;
+  return header;
+}
+
+bool sameDecomposition(const CacheFileHeader& a, const CacheFileHeader& b)
+{
+  return memcmp(a.magic, b.magic, sizeof(a.magic)) == 0 &&
+         std::tie(a.version, a.hash, a.vertex_count, a.triangle_count, a.max_concavity, a.max_parts) ==
+             std::tie(b.version, b.hash, b.vertex_count, b.triangle_count, b.max_concavity, b.max_parts);
+}
+
+ConvexDecompositionConstPtr loadDecomposition(const std::filesystem::path& path, const CacheFileHeader& expected)
+{
+  const moveit::core::MappedFile file(path);
+  CacheFileHeader header;
+  std::size_t offset = 0;
+  if (!readPadded(file, offset, &header, sizeof(header)))
+    return nullptr;
+  if (!sameDecomposition(header, expected))
+  {
+    RCLCPP_DEBUG(LOGGER, "'%s' is not a version %u decomposition of this mesh with these options",
+                 path.string().c_str(), CACHE_FILE_VERSION);
+    return nullptr;
+  }
+
+  auto decomposition = std::make_shared<ConvexDecomposition>();
+  for (std::uint32_t i = 0; i < header.num_parts; ++i)
+  {
+    PartRecordHeader record;
+    bool ok = readPadded(file, offset, &record, sizeof(record));
+    // check the sizes before allocating, so a corrupt header cannot make us allocate huge arrays
+    const std::size_t remaining = file.size() - std::min(offset, file.size());
+    if (!ok || remaining / (3 * sizeof(double)) < record.vertex_count ||
+        remaining / (3 * sizeof(std::uint32_t)) < record.triangle_count)
+    {
+      RCLCPP_ERROR(LOGGER, "Convex decomposition '%s' is truncated or corrupt", path.string().c_str());
+      return nullptr;
+    }
+
+    auto mesh = std::make_shared<shapes::Mesh>(record.vertex_count, record.triangle_count);
+    ok = readPadded(file, offset, mesh->vertices, 3 * record.vertex_count * sizeof(double)) &&
+         readPadded(file, offset, mesh->triangles, 3 * record.triangle_count * sizeof(std::uint32_t)) &&
+         std::all_of(mesh->triangles, mesh->triangles + 3 * record.triangle_count,
+                     [&record](unsigned int index) { return index < record.vertex_count; });
+    if (!ok)
+    {
+      RCLCPP_ERROR(LOGGER, "Convex decomposition '%s' is truncated or corrupt", path.string().c_str());
+      return nullptr;
+    }
+    decomposition->push_back(mesh);
+  }
+  if (offset != file.size())
+  {
+    RCLCPP_ERROR(LOGGER, "Convex decomposition '%s' is corrupt", path.string().c_str());
+    return nullptr;
+  }
+  return decomposition;
+}
+
+bool saveDecomposition(const std::filesystem::path& path, CacheFileHeader header,
+                       const ConvexDecomposition& decomposition)
+{
+  header.num_parts = decomposition.size();
+
+  // write to a temporary file first, so processes reading the old file never see a partial one
+  const std::string tmp_filename = path.string() + ".tmp" + std::to_string(moveit::core::processId());
+  {
+    std::ofstream out(tmp_filename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (!out.good())
+      return false;
+    writePadded(out, &header, sizeof(header));
+    for (const std::shared_ptr<const shapes::Mesh>& mesh : decomposition)
+    {
+      const PartRecordHeader record{ mesh->vertex_count, mesh->triangle_count };
+      writePadded(out, &record, sizeof(record));
+      writePadded(out, mesh->vertices, 3 * mesh->vertex_count * sizeof(double));
+      writePadded(out, mesh->triangles, 3 * mesh->triangle_count * sizeof(std::uint32_t));
+    }
+    if (!out.good())
+    {
+      out.close();
+      std::filesystem::remove(tmp_filename);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_filename, path, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tmp_filename, ec);
+    return false;
+  }
+  return true;
+}
+
+/** \brief The options of this process and the decompositions computed or loaded so far */
+struct DecompositionCache
+{
+  using Key = std::tuple<std::uint64_t, unsigned int, unsigned int, double, unsigned int>;
+
+  static DecompositionCache& instance()
+  {
+    static DecompositionCache cache;
+    return cache;
+  }
+
+  std::mutex lock_;
+  ConvexDecompositionOptions options_;
+  std::map<Key, ConvexDecompositionConstPtr> map_;
+  unsigned int insert_count_ = 0;
+};
+}  // namespace
+
+void setConvexDecompositionOptions(const ConvexDecompositionOptions& options)
+{
+  DecompositionCache& cache = DecompositionCache::instance();
+  std::lock_guard<std::mutex> slock(cache.lock_);
+  cache.options_ = options;
+}
+
+ConvexDecompositionOptions getConvexDecompositionOptions()
+{
+  DecompositionCache& cache = DecompositionCache::instance();
+  std::lock_guard<std::mutex> slock(cache.lock_);
+  return cache.options_;
+}
+
+ConvexDecomposition decomposeMesh(const shapes::Mesh& mesh, double max_concavity, unsigned int max_parts)
+{
+  ConvexDecomposition decomposition;
+  if (mesh.vertex_count == 0 || mesh.triangle_count == 0)
+    return decomposition;
+
+  std::vector<unsigned int> triangles(mesh.triangle_count);
+  std::iota(triangles.begin(), triangles.end(), 0u);
+  std::vector<Part> parts;
+  parts.push_back(makePart(mesh, std::move(triangles)));
+
+  // split the most concave part until all are flat enough or there are max_parts parts
+  while (parts.size() < max_parts)
+  {
+    auto worst = std::max_element(parts.begin(), parts.end(),
+                                  [](const Part& a, const Part& b) { return a.concavity < b.concavity; });
+    if (worst->concavity <= max_concavity)
+      break;
+    std::vector<unsigned int> first, second;
+    if (!splitTriangles(mesh, worst->triangles, first, second))
+    {
+      worst->concavity = 0.0;
+      continue;
+    }
+    *worst = makePart(mesh, std::move(first));
+    parts.push_back(makePart(mesh, std::move(second)));
+  }
+
+  for (const Part& part : parts)
+    decomposition.push_back(hullMesh(part.hull));
+  return decomposition;
+}
+
+ConvexDecompositionConstPtr getConvexDecomposition(const shapes::Mesh& mesh)
+{
+  DecompositionCache& cache = DecompositionCache::instance();
+  const ConvexDecompositionOptions options = getConvexDecompositionOptions();
+  if (!options.enabled || mesh.vertex_count == 0 || mesh.triangle_count == 0)
+    return nullptr;
+
+  const CacheFileHeader header = makeHeader(mesh, options);
+  const DecompositionCache::Key key(header.hash, header.vertex_count, header.triangle_count, header.max_concavity,
+                                    header.max_parts);
+  {
+    std::lock_guard<std::mutex> slock(cache.lock_);
+    auto it = cache.map_.find(key);
+    if (it != cache.map_.end())
+      return it->second;
+  }
+
+  // load or decompose without holding the lock, so threads creating the geometry of other meshes are not blocked
+  std::filesystem::path path;
+  ConvexDecompositionConstPtr decomposition;
+  if (!options.cache_directory.empty())
+  {
+    char filename[32];
+    snprintf(filename, sizeof(filename), "%016llx.convex", static_cast<unsigned long long>(header.hash));
+    path = std::filesystem::path(options.cache_directory) / filename;
+    decomposition = loadDecomposition(path, header);
+  }
+  if (!decomposition)
+  {
+    decomposition = std::make_shared<const ConvexDecomposition>(
+        decomposeMesh(mesh, options.max_concavity, std::max(options.max_parts, 1u)));
+    if (!path.empty())
+    {
+      std::error_code ec;
+      std::filesystem::create_directories(path.parent_path(), ec);
+      if (!saveDecomposition(path, header, *decomposition))
+        RCLCPP_WARN(LOGGER, "Failed to store the convex decomposition in '%s'", path.string().c_str());
+    }
+  }
+
+  std::lock_guard<std::mutex> slock(cache.lock_);
+  if (++cache.insert_count_ > MAX_CLEAN_COUNT)
+  {
+    cache.insert_count_ = 0;
+    for (auto it = cache.map_.begin(); it != cache.map_.end();)
+      it = it->second.use_count() == 1 ? cache.map_.erase(it) : std::next(it);
+  }
+  return cache.map_.emplace(key, decomposition).first->second;
+}
+}  // namespace collision_detection
@@ -35,22 +35,33 @@
 /* Author: Acorn Pooley, Ioan Sucan */
 
 #include <moveit/collision_detection/world.h>
+#include <moveit/robot_state/attached_body.h>
 #include <geometric_shapes/check_isometry.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <atomic>
 
 namespace collision_detection
 {
 // Logger
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_collision_detection.world");
 
-World::World()
+namespace
+{
+// Versions are drawn from one process-wide counter, so a version is never reused, not even by another world
+std::size_t nextVersion()
+{
+  static std::atomic<std::size_t> counter{ 0 };
+  return ++counter;
+}
+}  // namespace
+
+World::World() : store_(std::make_shared<ObjectStore>()), version_(nextVersion())
 {
 }
 
-World::World(const World& other)
+World::World(const World& other) : store_(other.store_), version_(other.version_)
 {
-  objects_ = other.objects_;
 }
 
 World::~World()
@@ -84,10 +95,12 @@ void World::addToObject(const std::string& object_id, const Eigen::Isometry3d& p
 
   int action = ADD_SHAPE;
 
-  ObjectPtr& obj = objects_[object_id];
+  ensureUniqueStore();
+  ObjectPtr& obj = store_->objects_[object_id];
   if (!obj)
   {
     obj = std::make_shared<Object>(object_id);
+    store_->objects_by_interned_id_.set(moveit::core::InternedName(object_id), &obj);
     action |= CREATE;
     obj->pose_ = pose;
   }
@@ -103,15 +116,15 @@ void World::addToObject(const std::string& object_id, const Eigen::Isometry3d& p
 std::vector<std::string> World::getObjectIds() const
 {
   std::vector<std::string> ids;
-  for (const auto& object : objects_)
+  for (const auto& object : store_->objects_)
     ids.push_back(object.first);
   return ids;
 }
 
 World::ObjectConstPtr World::getObject(const std::string& object_id) const
 {
-  const auto it = objects_.find(object_id);
-  if (it == objects_.end())
+  const auto it = store_->objects_.find(object_id);
+  if (it == store_->objects_.end())
   {
     return ObjectConstPtr();
   }
@@ -127,22 +140,35 @@ void World::ensureUnique(ObjectPtr& obj)
     obj = std::make_shared<Object>(*obj);
 }
 
+void World::ensureUniqueStore()
+{
+  version_ = nextVersion();
+  if (store_.use_count() > 1)
+  {
+    auto store = std::make_shared<ObjectStore>();
+    store->objects_ = store_->objects_;
+    for (const auto& object : store->objects_)
+      store->objects_by_interned_id_.set(moveit::core::InternedName(object.first), &object.second);
+    store_ = std::move(store);
+  }
+}
+
 bool World::hasObject(const std::string& object_id) const
 {
-  return objects_.find(object_id) != objects_.end();
+  return store_->objects_.find(object_id) != store_->objects_.end();
 }
 
 bool World::knowsTransform(const std::string& name) const
 {
   // Check object names first
-  const std::map<std::string, ObjectPtr>::const_iterator it = objects_.find(name);
-  if (it != objects_.end())
+  const std::map<std::string, ObjectPtr>::const_iterator it = store_->objects_.find(name);
+  if (it != store_->objects_.end())
   {
     return true;
   }
   else  // Then objects' subframes
   {
-    for (const std::pair<const std::string, ObjectPtr>& object : objects_)
+    for (const std::pair<const std::string, ObjectPtr>& object : store_->objects_)
     {
       // if "object name/" matches start of object_id, we found the matching object
       // rfind searches name for object.first in the first index (returns 0 if found)
@@ -170,14 +196,14 @@ const Eigen::Isometry3d& World::getTransform(const std::string& name, bool& fram
   // assume found
   frame_found = true;
 
-  const std::map<std::string, ObjectPtr>::const_iterator it = objects_.find(name);
-  if (it != objects_.end())
+  const std::map<std::string, ObjectPtr>::const_iterator it = store_->objects_.find(name);
+  if (it != store_->objects_.end())
   {
     return it->second->pose_;
   }
   else  // Search within subframes
   {
-    for (const std::pair<const std::string, ObjectPtr>& object : objects_)
+    for (const std::pair<const std::string, ObjectPtr>& object : store_->objects_)
     {
       // if "object name/" matches start of object_id, we found the matching object
       // rfind searches name for object.first in the first index (returns 0 if found)
@@ -200,8 +226,8 @@ const Eigen::Isometry3d& World::getTransform(const std::string& name, bool& fram
 
 const Eigen::Isometry3d& World::getGlobalShapeTransform(const std::string& object_id, const int shape_index) const
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  const auto it = store_->objects_.find(object_id);
+  if (it != store_->objects_.end())
   {
     return it->second->global_shape_poses_[shape_index];
   }
@@ -215,8 +241,8 @@ const Eigen::Isometry3d& World::getGlobalShapeTransform(const std::string& objec
 
 const EigenSTL::vector_Isometry3d& World::getGlobalShapeTransforms(const std::string& object_id) const
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  const auto it = store_->objects_.find(object_id);
+  if (it != store_->objects_.end())
   {
     return it->second->global_shape_poses_;
   }
@@ -231,8 +257,9 @@ const EigenSTL::vector_Isometry3d& World::getGlobalShapeTransforms(const std::st
 bool World::moveShapeInObject(const std::string& object_id, const shapes::ShapeConstPtr& shape,
                               const Eigen::Isometry3d& shape_pose)
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  ensureUniqueStore();
+  const auto it = store_->objects_.find(object_id);
+  if (it != store_->objects_.end())
   {
     const unsigned int n = it->second->shapes_.size();
     for (unsigned int i = 0; i < n; ++i)
@@ -254,8 +281,8 @@ bool World::moveShapeInObject(const std::string& object_id, const shapes::ShapeC
 
 bool World::moveObject(const std::string& object_id, const Eigen::Isometry3d& transform)
 {
-  const auto it = objects_.find(object_id);
-  if (it == objects_.end())
+  const auto it = store_->objects_.find(object_id);
+  if (it == store_->objects_.end())
     return false;
   if (transform.isApprox(Eigen::Isometry3d::Identity()))
     return true;  // object already at correct location
@@ -267,11 +294,13 @@ bool World::moveObject(const std::string& object_id, const Eigen::Isometry3d& tr
 bool World::setObjectPose(const std::string& object_id, const Eigen::Isometry3d& pose)
 {
   ASSERT_ISOMETRY(pose);  // unsanitized input, could contain a non-isometry
-  ObjectPtr& obj = objects_[object_id];
+  ensureUniqueStore();
+  ObjectPtr& obj = store_->objects_[object_id];
   int action;
   if (!obj)
   {
     obj = std::make_shared<Object>(object_id);
+    store_->objects_by_interned_id_.set(moveit::core::InternedName(object_id), &obj);
     action = CREATE;
   }
   else
@@ -286,10 +315,20 @@ bool World::setObjectPose(const std::string& object_id, const Eigen::Isometry3d&
   return true;
 }
 
+bool World::notifyShapesUpdated(const std::string& object_id)
+{
+  const auto it = store_->objects_.find(object_id);
+  if (it == store_->objects_.end())
+    return false;
+  notify(it->second, UPDATE_SHAPE);
+  return true;
+}
+
 bool World::removeShapeFromObject(const std::string& object_id, const shapes::ShapeConstPtr& shape)
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  ensureUniqueStore();
+  const auto it = store_->objects_.find(object_id);
+  if (it != store_->objects_.end())
   {
     const unsigned int n = it->second->shapes_.size();
     for (unsigned int i = 0; i < n; ++i)
@@ -304,7 +343,8 @@ bool World::removeShapeFromObject(const std::string& object_id, const shapes::Sh
         if (it->second->shapes_.empty())
         {
           notify(it->second, DESTROY);
-          objects_.erase(it);
+          store_->objects_by_interned_id_.erase(moveit::core::InternedName(it->first));
+          store_->objects_.erase(it);
         }
         else
         {
@@ -319,11 +359,15 @@ bool World::removeShapeFromObject(const std::string& object_id, const shapes::Sh
 
 bool World::removeObject(const std::string& object_id)
 {
-  const auto it = objects_.find(object_id);
-  if (it != objects_.end())
+  if (!hasObject(object_id))
+    return false;
+  ensureUniqueStore();
+  const auto it = store_->objects_.find(object_id);
+  if (it != store_->objects_.end())
   {
     notify(it->second, DESTROY);
-    objects_.erase(it);
+    store_->objects_by_interned_id_.erase(moveit::core::InternedName(it->first));
+    store_->objects_.erase(it);
     return true;
   }
   return false;
@@ -332,16 +376,20 @@ bool World::removeObject(const std::string& object_id)
 void World::clearObjects()
 {
   notifyAll(DESTROY);
-  objects_.clear();
+  // the store may be shared with copies of this world
+  store_ = std::make_shared<ObjectStore>();
+  version_ = nextVersion();
 }
 
 bool World::setSubframesOfObject(const std::string& object_id, const moveit::core::FixedTransformsMap& subframe_poses)
 {
-  const auto obj_pair = objects_.find(object_id);
-  if (obj_pair == objects_.end())
+  ensureUniqueStore();
+  const auto obj_pair = store_->objects_.find(object_id);
+  if (obj_pair == store_->objects_.end())
   {
     return false;
   }
+  ensureUnique(obj_pair->second);
   for (const auto& t : subframe_poses)
   {
     ASSERT_ISOMETRY(t.second)  // unsanitized input, could contain a non-isometry
@@ -395,16 +443,63 @@ void World::removeObserver(ObserverHandle observer_handle)
 
 void World::notifyAll(Action action)
 {
-  for (std::map<std::string, ObjectPtr>::const_iterator it = objects_.begin(); it != objects_.end(); ++it)
-    notify(it->second, action);
+  for (const auto& object : store_->objects_)
+    notify(object.second, action);
 }
 
 void World::notify(const ObjectConstPtr& obj, Action action)
 {
+  if (batch_depth_ > 0)
+  {
+    const auto it = pending_change_index_.find(obj->id_);
+    if (it == pending_change_index_.end() || pending_changes_[it->second].action_ == DESTROY)
+    {
+      // an object destroyed earlier in the batch and now created again is reported as two changes
+      pending_change_index_[obj->id_] = pending_changes_.size();
+      pending_changes_.push_back(PendingChange{ obj, action, (action & CREATE) != 0 });
+      return;
+    }
+
+    PendingChange& change = pending_changes_[it->second];
+    change.obj_ = obj;
+    if (action != DESTROY)
+      change.action_ |= action;
+    else
+      change.action_ = change.created_ ? UNINITIALIZED : DESTROY;
+    if (change.action_ == UNINITIALIZED)
+      pending_change_index_.erase(it);
+    return;
+  }
+
   for (Observer* observer : observers_)
     observer->callback_(obj, action);
 }
 
+void World::beginBatch()
+{
+  ++batch_depth_;
+}
+
+void World::commitBatch()
+{
+  if (batch_depth_ == 0)
+  {
+    RCLCPP_ERROR(LOGGER, "commitBatch() called without a matching beginBatch()");
+    return;
+  }
+  if (--batch_depth_ > 0)
+    return;
+
+  std::vector<PendingChange> changes;
+  changes.swap(pending_changes_);
+  pending_change_index_.clear();
+  for (const PendingChange& change : changes)
+  {
+    if (change.action_ != UNINITIALIZED)
+      notify(change.obj_, Action(change.action_));
+  }
+}
+
 void World::notifyObserverAllObjects(const ObserverHandle observer_handle, Action action) const
 {
   for (auto observer : observers_)
@@ -412,11 +507,36 @@ void World::notifyObserverAllObjects(const ObserverHandle observer_handle, Actio
     if (observer == observer_handle.observer_)
     {
       // call the callback for each object
-      for (const auto& object : objects_)
+      for (const auto& object : store_->objects_)
         observer->callback_(object.second, action);
       break;
     }
   }
 }
 
+void World::getMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  if (!usage.visit(this))
+    return;
+  usage.add("world", sizeof(World) + sizeof(PendingChange) * pending_changes_.capacity());
+  if (!usage.visit(store_.get()))
+    return;
+  usage.add("world", sizeof(ObjectStore) + (sizeof(std::string) + sizeof(ObjectPtr)) * store_->objects_.size());
+  for (const auto& entry : store_->objects_)
+  {
+    const Object& obj = *entry.second;
+    if (!usage.visit(&obj))
+      continue;
+    const std::size_t poses = sizeof(Eigen::Isometry3d) * (obj.shape_poses_.size() + obj.global_shape_poses_.size());
+    const std::size_t subframes = (sizeof(std::string) + sizeof(Eigen::Isometry3d)) *
+                                  (obj.subframe_poses_.size() + obj.global_subframe_poses_.size());
+    usage.add("world", sizeof(Object) + sizeof(shapes::ShapeConstPtr) * obj.shapes_.size() + poses + subframes);
+    for (const shapes::ShapeConstPtr& shape : obj.shapes_)
+    {
+      if (usage.visit(shape.get()))
+        usage.add(shape->type == shapes::OCTREE ? "octomap" : "shapes", moveit::core::getShapeMemoryUsage(*shape));
+    }
+  }
+}
+
 }  // end of namespace collision_detection
@@ -0,0 +1,152 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <moveit/collision_detection/collision_matrix.h>
+
+using namespace collision_detection;
+
+TEST(AllowedCollisionMatrix, Entries)
+{
+  AllowedCollisionMatrix acm({ "a", "b", "c" }, false);
+  acm.setEntry("a", "b", true);
+
+  AllowedCollision::Type type;
+  ASSERT_TRUE(acm.getAllowedCollision("a", "b", type));
+  EXPECT_EQ(type, AllowedCollision::ALWAYS);
+  ASSERT_TRUE(acm.getAllowedCollision("b", "a", type));
+  EXPECT_EQ(type, AllowedCollision::ALWAYS);
+  ASSERT_TRUE(acm.getAllowedCollision("a", "c", type));
+  EXPECT_EQ(type, AllowedCollision::NEVER);
+  EXPECT_FALSE(acm.getAllowedCollision("a", "unknown", type));
+
+  acm.removeEntry("a", "b");
+  EXPECT_FALSE(acm.getEntry("a", "b", type));
+  EXPECT_FALSE(acm.hasEntry("a", "b"));
+
+  acm.removeEntry("c");
+  EXPECT_FALSE(acm.getEntry("a", "c", type));
+  EXPECT_FALSE(acm.getEntry("c", "b", type));
+
+  acm.setEntry(true);
+  ASSERT_TRUE(acm.getEntry("b", "b", type));
+  EXPECT_EQ(type, AllowedCollision::ALWAYS);
+  EXPECT_FALSE(acm.getEntry("a", "b", type));
+
+  DecideContactFn fn = [](Contact& /*contact*/) { return true; };
+  acm.setEntry("a", "c", fn);
+  ASSERT_TRUE(acm.getAllowedCollision("c", "a", type));
+  EXPECT_EQ(type, AllowedCollision::CONDITIONAL);
+}
+
+TEST(AllowedCollisionMatrix, DefaultEntries)
+{
+  AllowedCollisionMatrix acm;
+  AllowedCollision::Type type;
+
+  acm.setDefaultEntry("a", true);
+  ASSERT_TRUE(acm.getAllowedCollision("a", "unknown", type));
+  EXPECT_EQ(type, AllowedCollision::ALWAYS);
+  ASSERT_TRUE(acm.getAllowedCollision("unknown", "a", type));
+  EXPECT_EQ(type, AllowedCollision::ALWAYS);
+  EXPECT_FALSE(acm.getAllowedCollision("unknown", "other", type));
+
+  acm.setDefaultEntry("b", false);
+  ASSERT_TRUE(acm.getAllowedCollision("a", "b", type));
+  EXPECT_EQ(type, AllowedCollision::NEVER);
+
+  // explicit entries take precedence over defaults
+  acm.setEntry("a", "b", true);
+  ASSERT_TRUE(acm.getAllowedCollision("a", "b", type));
+  EXPECT_EQ(type, AllowedCollision::ALWAYS);
+
+  acm.clear();
+  EXPECT_FALSE(acm.getAllowedCollision("a", "b", type));
+  EXPECT_EQ(acm.getEntryIndex("a"), -1);
+}
+
+TEST(AllowedCollisionMatrix, IndexLookup)
+{
+  // enough names to grow the flat table several times
+  std::vector<std::string> names;
+  for (std::size_t i = 0; i < 50; ++i)
+    names.push_back("link_" + std::to_string(i));
+  AllowedCollisionMatrix acm(names, false);
+  for (std::size_t i = 0; i + 1 < names.size(); ++i)
+    acm.setEntry(names[i], names[i + 1], true);
+
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    const int index_i = acm.getEntryIndex(names[i]);
+    ASSERT_GE(index_i, 0);
+    for (std::size_t j = 0; j < names.size(); ++j)
+    {
+      const int index_j = acm.getEntryIndex(names[j]);
+      AllowedCollision::Type by_name, by_index;
+      ASSERT_TRUE(acm.getAllowedCollision(names[i], names[j], by_name));
+      ASSERT_TRUE(acm.getAllowedCollision(index_i, index_j, by_index));
+      EXPECT_EQ(by_name, by_index);
+      EXPECT_EQ(by_name, (i + 1 == j || j + 1 == i) ? AllowedCollision::ALWAYS : AllowedCollision::NEVER);
+
+      AllowedCollision::Type by_interned_name;
+      ASSERT_TRUE(acm.getAllowedCollision(moveit::core::InternedName(names[i]), moveit::core::InternedName(names[j]),
+                                          by_interned_name));
+      EXPECT_EQ(by_name, by_interned_name);
+    }
+    EXPECT_EQ(acm.getEntryIndex(moveit::core::InternedName(names[i])), index_i);
+  }
+  EXPECT_EQ(acm.getEntryIndex("unknown"), -1);
+  EXPECT_EQ(acm.getEntryIndex(moveit::core::InternedName("unknown")), -1);
+}
+
+TEST(AllowedCollisionMatrix, MessageRoundTrip)
+{
+  AllowedCollisionMatrix acm({ "a", "b", "c" }, false);
+  acm.setEntry("a", "c", true);
+
+  moveit_msgs::msg::AllowedCollisionMatrix msg;
+  acm.getMessage(msg);
+  const AllowedCollisionMatrix copy(msg);
+
+  AllowedCollision::Type type;
+  ASSERT_TRUE(copy.getAllowedCollision("c", "a", type));
+  EXPECT_EQ(type, AllowedCollision::ALWAYS);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <moveit/collision_detection/convex_decomposition.h>
+#include <moveit/utils/mapped_file.h>
+#include <geometric_shapes/shape_operations.h>
+#include <filesystem>
+#include <memory>
+
+using namespace collision_detection;
+
+namespace
+{
+// Two unit cubes centered at the origin and at (offset, 0, 0) in one mesh
+std::unique_ptr<shapes::Mesh> makeTwoCubes(double offset)
+{
+  const std::unique_ptr<shapes::Mesh> cube(shapes::createMeshFromShape(shapes::Box(1.0, 1.0, 1.0)));
+  auto mesh = std::make_unique<shapes::Mesh>(2 * cube->vertex_count, 2 * cube->triangle_count);
+  for (unsigned int i = 0; i < cube->vertex_count; ++i)
+  {
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      mesh->vertices[3 * i + d] = cube->vertices[3 * i + d];
+      mesh->vertices[3 * (cube->vertex_count + i) + d] = cube->vertices[3 * i + d] + (d == 0 ? offset : 0.0);
+    }
+  }
+  for (unsigned int i = 0; i < 3 * cube->triangle_count; ++i)
+  {
+    mesh->triangles[i] = cube->triangles[i];
+    mesh->triangles[3 * cube->triangle_count + i] = cube->triangles[i] + cube->vertex_count;
+  }
+  return mesh;
+}
+
+double minX(const shapes::Mesh& mesh)
+{
+  double min_x = mesh.vertices[0];
+  for (unsigned int i = 0; i < mesh.vertex_count; ++i)
+    min_x = std::min(min_x, mesh.vertices[3 * i]);
+  return min_x;
+}
+}  // namespace
+
+TEST(ConvexDecomposition, ConvexMeshStaysWhole)
+{
+  const std::unique_ptr<shapes::Mesh> cube(shapes::createMeshFromShape(shapes::Box(1.0, 1.0, 1.0)));
+  const ConvexDecomposition decomposition = decomposeMesh(*cube, 0.01, 8);
+  ASSERT_EQ(decomposition.size(), 1u);
+  EXPECT_EQ(decomposition[0]->vertex_count, 8u);
+}
+
+TEST(ConvexDecomposition, SplitsSeparateParts)
+{
+  const std::unique_ptr<shapes::Mesh> mesh = makeTwoCubes(3.0);
+  const ConvexDecomposition decomposition = decomposeMesh(*mesh, 0.01, 8);
+  ASSERT_EQ(decomposition.size(), 2u);
+
+  // one part per cube, none spanning the gap
+  const double min_x_0 = minX(*decomposition[0]);
+  const double min_x_1 = minX(*decomposition[1]);
+  EXPECT_NEAR(std::min(min_x_0, min_x_1), -0.5, 1e-9);
+  EXPECT_NEAR(std::max(min_x_0, min_x_1), 2.5, 1e-9);
+
+  // the number of parts is limited
+  EXPECT_EQ(decomposeMesh(*mesh, 0.01, 1).size(), 1u);
+  EXPECT_TRUE(decomposeMesh(shapes::Mesh(), 0.01, 8).empty());
+}
+
+TEST(ConvexDecomposition, Cache)
+{
+  const std::unique_ptr<shapes::Mesh> mesh = makeTwoCubes(3.0);
+  EXPECT_FALSE(getConvexDecomposition(*mesh));
+
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                          ("test_convex_decomposition_" + std::to_string(moveit::core::processId()));
+  ConvexDecompositionOptions options;
+  options.enabled = true;
+  options.cache_directory = directory.string();
+  setConvexDecompositionOptions(options);
+
+  ConvexDecompositionConstPtr decomposition = getConvexDecomposition(*mesh);
+  ASSERT_TRUE(decomposition);
+  EXPECT_EQ(decomposition->size(), 2u);
+  EXPECT_EQ(decomposition, getConvexDecomposition(*mesh));
+  ASSERT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 1);
+
+  // other options do not use the stored decomposition
+  options.max_parts = 1;
+  setConvexDecompositionOptions(options);
+  EXPECT_EQ(getConvexDecomposition(*mesh)->size(), 1u);
+
+  std::filesystem::remove_all(directory);
+  setConvexDecompositionOptions(ConvexDecompositionOptions());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
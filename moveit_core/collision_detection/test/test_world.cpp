@@ -261,9 +261,18 @@ TEST(World, TrackChanges)
   EXPECT_EQ(World::MOVE_SHAPE, ta.action_);
   ta.reset();
 
+  // shapes modified in place
+  EXPECT_FALSE(world.notifyShapesUpdated("xyz"));
+  EXPECT_EQ(2, ta.cnt_);
+  EXPECT_TRUE(world.notifyShapesUpdated("obj1"));
+  EXPECT_EQ(3, ta.cnt_);
+  EXPECT_EQ("obj1", ta.obj_.id_);
+  EXPECT_EQ(World::UPDATE_SHAPE, ta.action_);
+  ta.reset();
+
   world.addToObject("obj1", box, Eigen::Isometry3d::Identity());
 
-  EXPECT_EQ(3, ta.cnt_);
+  EXPECT_EQ(4, ta.cnt_);
   EXPECT_EQ("obj1", ta.obj_.id_);
   EXPECT_EQ(World::ADD_SHAPE, ta.action_);
   ta.reset();
@@ -276,7 +285,7 @@ TEST(World, TrackChanges)
 
   world.addToObject("obj2", cyl, Eigen::Isometry3d::Identity());
 
-  EXPECT_EQ(4, ta.cnt_);
+  EXPECT_EQ(5, ta.cnt_);
   EXPECT_EQ("obj2", ta.obj_.id_);
   EXPECT_EQ(World::CREATE | World::ADD_SHAPE, ta.action_);
   ta.reset();
@@ -287,7 +296,7 @@ TEST(World, TrackChanges)
 
   world.addToObject("obj3", box, Eigen::Isometry3d::Identity());
 
-  EXPECT_EQ(5, ta.cnt_);
+  EXPECT_EQ(6, ta.cnt_);
   EXPECT_EQ("obj3", ta.obj_.id_);
   EXPECT_EQ(World::CREATE | World::ADD_SHAPE, ta.action_);
   ta.reset();
@@ -299,13 +308,13 @@ TEST(World, TrackChanges)
   // remove nonexistent obj
   bool rm_bad = world.removeShapeFromObject("xyz", ball);
   EXPECT_FALSE(rm_bad);
-  EXPECT_EQ(5, ta.cnt_);
+  EXPECT_EQ(6, ta.cnt_);
   EXPECT_EQ(2, ta2.cnt_);
 
   // remove wrong shape
   rm_bad = world.removeShapeFromObject("obj2", ball);
   EXPECT_FALSE(rm_bad);
-  EXPECT_EQ(5, ta.cnt_);
+  EXPECT_EQ(6, ta.cnt_);
   EXPECT_EQ(2, ta2.cnt_);
 
   TestAction ta3;
@@ -317,7 +326,7 @@ TEST(World, TrackChanges)
   bool rm_good = world.removeShapeFromObject("obj2", cyl);
   EXPECT_TRUE(rm_good);
 
-  EXPECT_EQ(6, ta.cnt_);
+  EXPECT_EQ(7, ta.cnt_);
   EXPECT_EQ("obj2", ta.obj_.id_);
   EXPECT_EQ(World::DESTROY, ta.action_);
   ta.reset();
@@ -335,7 +344,7 @@ TEST(World, TrackChanges)
   rm_good = world.removeShapeFromObject("obj1", ball);
   EXPECT_TRUE(rm_good);
 
-  EXPECT_EQ(7, ta.cnt_);
+  EXPECT_EQ(8, ta.cnt_);
   EXPECT_EQ("obj1", ta.obj_.id_);
   EXPECT_EQ(World::REMOVE_SHAPE, ta.action_);
   ta.reset();
@@ -349,7 +358,7 @@ TEST(World, TrackChanges)
   // remove all 2 objects (should make 2 DESTROY callbacks per ta)
   world.clearObjects();
 
-  EXPECT_EQ(9, ta.cnt_);
+  EXPECT_EQ(10, ta.cnt_);
   EXPECT_EQ(World::DESTROY, ta.action_);
   ta.reset();
   EXPECT_EQ(3, ta2.cnt_);
@@ -361,17 +370,126 @@ TEST(World, TrackChanges)
   world.removeObserver(observer_ta);
   world.removeObserver(observer_ta3);
 
-  EXPECT_EQ(9, ta.cnt_);
+  EXPECT_EQ(10, ta.cnt_);
   EXPECT_EQ(3, ta2.cnt_);
   EXPECT_EQ(4, ta3.cnt_);
 
   world.addToObject("obj4", box, Eigen::Isometry3d::Identity());
 
-  EXPECT_EQ(9, ta.cnt_);
+  EXPECT_EQ(10, ta.cnt_);
   EXPECT_EQ(3, ta2.cnt_);
   EXPECT_EQ(4, ta3.cnt_);
 }
 
+TEST(World, InternedObjectIds)
+{
+  World world;
+  shapes::ShapePtr ball = std::make_shared<shapes::Sphere>(1.0);
+  const moveit::core::InternedName ball_id("ball");
+
+  EXPECT_FALSE(world.hasObject(ball_id));
+  EXPECT_FALSE(world.getObject(ball_id));
+
+  world.addToObject("ball", ball, Eigen::Isometry3d::Identity());
+  EXPECT_TRUE(world.hasObject(ball_id));
+  EXPECT_EQ(world.getObject("ball"), world.getObject(ball_id));
+
+  // lookups in a copy find the objects of the copy
+  World copy(world);
+  EXPECT_TRUE(copy.hasObject(ball_id));
+  EXPECT_EQ(copy.getObject("ball"), copy.getObject(ball_id));
+
+  EXPECT_TRUE(world.removeObject("ball"));
+  EXPECT_FALSE(world.hasObject(ball_id));
+  EXPECT_TRUE(copy.hasObject(ball_id));
+
+  copy.clearObjects();
+  EXPECT_FALSE(copy.hasObject(ball_id));
+}
+
+TEST(World, BatchedChanges)
+{
+  World world;
+  shapes::ShapePtr ball = std::make_shared<shapes::Sphere>(1.0);
+  shapes::ShapePtr box = std::make_shared<shapes::Box>(1, 1, 1);
+  world.addToObject("existing", ball, Eigen::Isometry3d::Identity());
+
+  std::vector<std::pair<std::string, int>> changes;
+  world.addObserver([&changes](const World::ObjectConstPtr& object, World::Action action) {
+    changes.emplace_back(object->id_, action);
+  });
+
+  world.beginBatch();
+  EXPECT_TRUE(world.inBatch());
+  world.addToObject("obj1", ball, Eigen::Isometry3d::Identity());
+  world.addToObject("obj1", box, Eigen::Isometry3d::Identity());
+  world.moveObject("obj1", Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1)));
+  world.addToObject("temporary", box, Eigen::Isometry3d::Identity());
+  world.removeObject("temporary");
+  world.moveObject("existing", Eigen::Isometry3d(Eigen::Translation3d(1, 0, 0)));
+
+  // nested batches are delivered with the outermost one
+  world.beginBatch();
+  world.removeObject("existing");
+  world.addToObject("existing", box, Eigen::Isometry3d::Identity());
+  world.commitBatch();
+
+  EXPECT_TRUE(changes.empty());
+  EXPECT_TRUE(world.hasObject("obj1"));
+  world.commitBatch();
+  EXPECT_FALSE(world.inBatch());
+
+  ASSERT_EQ(3u, changes.size());
+  EXPECT_EQ("obj1", changes[0].first);
+  EXPECT_EQ(World::CREATE | World::ADD_SHAPE | World::MOVE_SHAPE, changes[0].second);
+  EXPECT_EQ("existing", changes[1].first);
+  EXPECT_EQ(World::DESTROY, changes[1].second);
+  EXPECT_EQ("existing", changes[2].first);
+  EXPECT_EQ(World::CREATE | World::ADD_SHAPE, changes[2].second);
+
+  // outside of a batch every change is delivered right away
+  changes.clear();
+  world.removeObject("obj1");
+  ASSERT_EQ(1u, changes.size());
+  EXPECT_EQ(World::DESTROY, changes[0].second);
+}
+
+TEST(World, CopyOnWrite)
+{
+  World world;
+  shapes::ShapePtr ball = std::make_shared<shapes::Sphere>(1.0);
+  shapes::ShapePtr box = std::make_shared<shapes::Box>(1, 1, 1);
+  world.addToObject("ball", ball, Eigen::Isometry3d::Identity());
+  world.addToObject("box", box, Eigen::Isometry3d::Identity());
+
+  // copies share the objects until they are changed
+  World copy(world);
+  EXPECT_EQ(copy.getObject("ball"), world.getObject("ball"));
+
+  copy.moveObject("ball", Eigen::Isometry3d(Eigen::Translation3d(1, 0, 0)));
+  EXPECT_NE(copy.getObject("ball"), world.getObject("ball"));
+  EXPECT_EQ(copy.getObject("box"), world.getObject("box"));
+  EXPECT_EQ(0.0, world.getTransform("ball").translation().x());
+  EXPECT_EQ(1.0, copy.getTransform("ball").translation().x());
+
+  moveit::core::FixedTransformsMap subframes;
+  subframes["frame"] = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 2));
+  copy.setSubframesOfObject("box", subframes);
+  EXPECT_TRUE(copy.knowsTransform("box/frame"));
+  EXPECT_FALSE(world.knowsTransform("box/frame"));
+
+  world.removeObject("box");
+  EXPECT_FALSE(world.hasObject("box"));
+  EXPECT_TRUE(copy.hasObject("box"));
+  EXPECT_TRUE(copy.hasObject(moveit::core::InternedName("box")));
+
+  World copy_of_copy(copy);
+  copy.clearObjects();
+  EXPECT_EQ(copy.size(), 0u);
+  EXPECT_EQ(copy_of_copy.size(), 2u);
+  EXPECT_EQ(world.size(), 1u);
+}
+
 TEST(World, ObjectPoseAndSubframes)
 {
   World world;
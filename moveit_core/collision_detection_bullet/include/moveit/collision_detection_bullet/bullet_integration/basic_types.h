@@ -51,7 +51,11 @@ enum class CollisionObjectType
   CONVEX_HULL = 1,  /**< @brief Use the mesh in shapes::Shape but make it a convex hulls collision object (if not convex
                       it will be converted) */
   MULTI_SPHERE = 2, /**< @brief Use the mesh and represent it by multiple spheres collision object */
-  SDF = 3           /**< @brief Use the mesh and rpresent it by a signed distance fields collision object */
+  SDF = 3,          /**< @brief Use the mesh and rpresent it by a signed distance fields collision object */
+
+  /** @brief Use the mesh and represent it by the convex hulls of its parts, see
+      collision_detection::getConvexDecomposition() */
+  CONVEX_DECOMPOSITION = 4
 };
 
 /** \brief Bundles the data for a collision query */
@@ -77,6 +77,8 @@ public:
   bool disableCollisionObject(const std::string& name);
 
   /**@brief Set a single static collision object's tansform
+   *
+   * The broadphase AABB of the object is only updated if the transform changed.
    * @param name The name of the object
    * @param pose The transformation in world */
   void setCollisionObjectsTransform(const std::string& name, const Eigen::Isometry3d& pose);
@@ -39,6 +39,7 @@
 #include <moveit/collision_detection/collision_env.h>
 #include <moveit/collision_detection_bullet/bullet_integration/bullet_discrete_bvh_manager.h>
 #include <moveit/collision_detection_bullet/bullet_integration/bullet_cast_bvh_manager.h>
+#include <atomic>
 #include <mutex>
 
 namespace collision_detection
@@ -78,6 +79,25 @@ public:
   void checkRobotCollision(const CollisionRequest& req, CollisionResult& res, const moveit::core::RobotState& state1,
                            const moveit::core::RobotState& state2, const AllowedCollisionMatrix& acm) const override;
 
+  std::size_t checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                  const std::vector<const moveit::core::RobotState*>& states) const override;
+
+  std::size_t checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                  const std::vector<const moveit::core::RobotState*>& states,
+                                  const AllowedCollisionMatrix& acm) const override;
+
+  void checkRobotCollisionContinuous(const CollisionRequest& req, CollisionResult& res,
+                                     const robot_trajectory::RobotTrajectory& trajectory) const override;
+
+  void checkRobotCollisionContinuous(const CollisionRequest& req, CollisionResult& res,
+                                     const robot_trajectory::RobotTrajectory& trajectory,
+                                     const AllowedCollisionMatrix& acm) const override;
+
+  bool supportsContinuousCollision() const override
+  {
+    return true;
+  }
+
   void distanceSelf(const DistanceRequest& req, DistanceResult& res,
                     const moveit::core::RobotState& state) const override;
 
@@ -110,6 +130,24 @@ protected:
   void checkRobotCollisionHelper(const CollisionRequest& req, CollisionResult& res,
                                  const moveit::core::RobotState& state, const AllowedCollisionMatrix* acm) const;
 
+  /** \brief Checks self and world collisions of all states while holding the lock once. The link transforms are
+   *  updated once per state and shared by both checks. */
+  std::size_t checkCollisionBatchHelper(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                        const std::vector<const moveit::core::RobotState*>& states,
+                                        const AllowedCollisionMatrix* acm) const;
+
+  /** \brief Checks all segments of a trajectory while holding the lock once. The attached bodies are taken from the
+   *  first waypoint and are assumed to stay attached along the whole trajectory. */
+  void checkRobotCollisionHelperTrajectoryCCD(const CollisionRequest& req, CollisionResult& res,
+                                              const robot_trajectory::RobotTrajectory& trajectory,
+                                              const AllowedCollisionMatrix* acm) const;
+
+  /** \brief Get the discrete manager of the calling thread, a clone of \e manager_.
+   *
+   *   The clone persists between calls until the environment changes, so discrete checks from several threads neither
+   *   contend for the lock nor rebuild the broadphase. Only the transforms of the moved objects are refit. */
+  const collision_detection_bullet::BulletDiscreteBVHManagerPtr& getThreadManager() const;
+
   /** \brief Construts a bullet collision object out of a robot link */
   void addLinkAsCollisionObject(const urdf::LinkSharedPtr& link);
 
@@ -140,6 +178,12 @@ protected:
   std::vector<std::string> active_;
 
 private:
+  struct PersistentManager;
+
+  /** \brief Key of the current state of \e manager_ in the per-thread manager clones. A new id is assigned whenever
+   *   the collision objects of \e manager_ change, ids are never reused. */
+  std::atomic<std::size_t> manager_id_;
+
   /** \brief Callback function executed for each change to the world environment */
   void notifyObjectChange(const ObjectConstPtr& obj, World::Action action);
 
@@ -113,6 +113,10 @@ void BulletBVHManager::setCollisionObjectsTransform(const std::string& name, con
   {
     CollisionObjectWrapperPtr& cow = it->second;
     btTransform tf = convertEigenToBt(pose);
+
+    // objects that did not move keep their broadphase AABB, persistent managers only refit what changed
+    if (tf == cow->getWorldTransform())
+      return;
     cow->setWorldTransform(tf);
 
     // Now update Broadphase AABB (See BulletWorld updateSingleAabb function)
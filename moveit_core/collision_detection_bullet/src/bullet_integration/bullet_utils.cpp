@@ -33,13 +33,19 @@
 /* Authors: John Schulman, Levi Armstrong */
 
 #include <moveit/collision_detection_bullet/bullet_integration/bullet_utils.h>
+#include <moveit/collision_detection/convex_decomposition.h>
 
 #include <BulletCollision/CollisionDispatch/btConvexConvexAlgorithm.h>
 #include <BulletCollision/CollisionShapes/btShapeHull.h>
 #include <BulletCollision/Gimpact/btGImpactShape.h>
 #include <geometric_shapes/shapes.h>
+#include <bitset>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <octomap/octomap.h>
+#include <unordered_map>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 
@@ -125,13 +131,42 @@ btCollisionShape* createShapePrimitive(const shapes::Mesh* geom, const Collision
 {
   assert(collision_object_type == CollisionObjectType::USE_SHAPE_TYPE ||
          collision_object_type == CollisionObjectType::CONVEX_HULL ||
-         collision_object_type == CollisionObjectType::SDF);
+         collision_object_type == CollisionObjectType::SDF ||
+         collision_object_type == CollisionObjectType::CONVEX_DECOMPOSITION);
 
   if (geom->vertex_count > 0 && geom->triangle_count > 0)
   {
     // convert the mesh to the assigned collision object type
     switch (collision_object_type)
     {
+      case CollisionObjectType::CONVEX_DECOMPOSITION:
+      {
+        const collision_detection::ConvexDecompositionConstPtr decomposition =
+            collision_detection::getConvexDecomposition(*geom);
+        if (!decomposition)
+          return createShapePrimitive(geom, CollisionObjectType::CONVEX_HULL, cow);
+
+        // the parts are convex already, so their vertices define their hulls
+        btCompoundShape* compound =
+            new btCompoundShape(BULLET_COMPOUND_USE_DYNAMIC_AABB, static_cast<int>(decomposition->size()));
+        compound->setMargin(BULLET_MARGIN);
+        for (const std::shared_ptr<const shapes::Mesh>& part : *decomposition)
+        {
+          btConvexHullShape* subshape = new btConvexHullShape();
+          for (unsigned int i = 0; i < part->vertex_count; ++i)
+          {
+            subshape->addPoint(btVector3(static_cast<btScalar>(part->vertices[3 * i]),
+                                         static_cast<btScalar>(part->vertices[3 * i + 1]),
+                                         static_cast<btScalar>(part->vertices[3 * i + 2])));
+          }
+          cow->manage(subshape);
+          subshape->setMargin(BULLET_MARGIN);
+          btTransform geom_trans;
+          geom_trans.setIdentity();
+          compound->addChildShape(geom_trans, subshape);
+        }
+        return compound;
+      }
       case CollisionObjectType::CONVEX_HULL:
       {
         // Create a convex hull shape to approximate Trimesh
@@ -199,6 +234,236 @@ btCollisionShape* createShapePrimitive(const shapes::Mesh* geom, const Collision
   return nullptr;
 }
 
+namespace
+{
+/** \brief Octrees are decomposed into blocks spanning 2^OCTREE_BLOCK_LEVELS leaves of maximal depth per axis */
+constexpr unsigned int OCTREE_BLOCK_LEVELS = 4;
+constexpr int OCTREE_BLOCK_SIZE = 1 << OCTREE_BLOCK_LEVELS;
+
+/** \brief The occupied leaves of one block of an octree, merged into as few boxes as possible */
+struct OctreeBlock
+{
+  /** \brief The occupied leaves as packed index keys and depths, to detect changes of the block */
+  std::vector<std::uint64_t> leaves;
+  std::vector<std::unique_ptr<btBoxShape>> boxes;
+  btAlignedObjectArray<btVector3> box_centers;
+};
+using OctreeBlockPtr = std::shared_ptr<OctreeBlock>;
+
+/** \brief The blocks of the last conversion of an octree, which are reused while their leaves do not change */
+struct OctreeBlockCache
+{
+  std::weak_ptr<const octomap::OcTree> octree;
+  std::unordered_map<std::uint64_t, OctreeBlockPtr> blocks;
+};
+
+std::mutex& octreeBlockCacheLock()
+{
+  static std::mutex lock;
+  return lock;
+}
+
+std::map<const octomap::OcTree*, OctreeBlockCache>& octreeBlockCaches()
+{
+  static std::map<const octomap::OcTree*, OctreeBlockCache> caches;
+  return caches;
+}
+
+std::uint64_t packOctreeKey(const octomap::OcTreeKey& key, unsigned int depth)
+{
+  return static_cast<std::uint64_t>(key[0]) | (static_cast<std::uint64_t>(key[1]) << 16) |
+         (static_cast<std::uint64_t>(key[2]) << 32) | (static_cast<std::uint64_t>(depth) << 48);
+}
+
+void unpackOctreeKey(std::uint64_t packed, octomap::OcTreeKey& key, unsigned int& depth)
+{
+  key[0] = static_cast<octomap::key_type>(packed & 0xffff);
+  key[1] = static_cast<octomap::key_type>((packed >> 16) & 0xffff);
+  key[2] = static_cast<octomap::key_type>((packed >> 32) & 0xffff);
+  depth = static_cast<unsigned int>(packed >> 48);
+}
+
+void addOctreeBox(const octomap::OcTree& tree, const int min_key[3], const int extent[3], OctreeBlock& block)
+{
+  const double resolution = tree.getResolution();
+  btVector3 center;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    // keyToCoord() returns the center of the leaf with the given key
+    const double min = tree.keyToCoord(static_cast<octomap::key_type>(min_key[axis])) - resolution / 2;
+    center[axis] = static_cast<btScalar>(min + extent[axis] * resolution / 2);
+  }
+  const btVector3 half_extents(static_cast<btScalar>(extent[0] * resolution / 2),
+                               static_cast<btScalar>(extent[1] * resolution / 2),
+                               static_cast<btScalar>(extent[2] * resolution / 2));
+  block.boxes.push_back(std::make_unique<btBoxShape>(half_extents));
+  block.boxes.back()->setMargin(BULLET_MARGIN);
+  block.box_centers.push_back(center);
+}
+
+/** \brief Greedily merge the occupied leaves of a block into boxes, first along x, then y, then z */
+void mergeOctreeBlock(const octomap::OcTree& tree, std::uint64_t block_key, OctreeBlock& block)
+{
+  const unsigned int tree_depth = tree.getTreeDepth();
+  octomap::OcTreeKey key;
+  unsigned int depth;
+
+  unpackOctreeKey(block_key, key, depth);
+  const int origin[3] = { key[0], key[1], key[2] };
+
+  // a leaf that is larger than a block is a block of its own
+  if (depth + OCTREE_BLOCK_LEVELS < tree_depth)
+  {
+    const int size = 1 << (tree_depth - depth);
+    const int extent[3] = { size, size, size };
+    addOctreeBox(tree, origin, extent, block);
+    return;
+  }
+
+  const auto index = [](int x, int y, int z) { return (z * OCTREE_BLOCK_SIZE + y) * OCTREE_BLOCK_SIZE + x; };
+  std::bitset<OCTREE_BLOCK_SIZE * OCTREE_BLOCK_SIZE * OCTREE_BLOCK_SIZE> open;
+  for (std::uint64_t leaf : block.leaves)
+  {
+    unpackOctreeKey(leaf, key, depth);
+    const int size = 1 << (tree_depth - depth);
+    const int x0 = key[0] - origin[0], y0 = key[1] - origin[1], z0 = key[2] - origin[2];
+    for (int z = z0; z < z0 + size; ++z)
+    {
+      for (int y = y0; y < y0 + size; ++y)
+      {
+        for (int x = x0; x < x0 + size; ++x)
+          open.set(index(x, y, z));
+      }
+    }
+  }
+
+  for (int z = 0; z < OCTREE_BLOCK_SIZE; ++z)
+  {
+    for (int y = 0; y < OCTREE_BLOCK_SIZE; ++y)
+    {
+      for (int x = 0; x < OCTREE_BLOCK_SIZE; ++x)
+      {
+        if (!open.test(index(x, y, z)))
+          continue;
+
+        int nx = 1, ny = 1, nz = 1;
+        while (x + nx < OCTREE_BLOCK_SIZE && open.test(index(x + nx, y, z)))
+          ++nx;
+        const auto row_open = [&](int yy, int zz) {
+          for (int i = x; i < x + nx; ++i)
+          {
+            if (!open.test(index(i, yy, zz)))
+              return false;
+          }
+          return true;
+        };
+        while (y + ny < OCTREE_BLOCK_SIZE && row_open(y + ny, z))
+          ++ny;
+        const auto layer_open = [&](int zz) {
+          for (int j = y; j < y + ny; ++j)
+          {
+            if (!row_open(j, zz))
+              return false;
+          }
+          return true;
+        };
+        while (z + nz < OCTREE_BLOCK_SIZE && layer_open(z + nz))
+          ++nz;
+
+        for (int k = z; k < z + nz; ++k)
+        {
+          for (int j = y; j < y + ny; ++j)
+          {
+            for (int i = x; i < x + nx; ++i)
+              open.reset(index(i, j, k));
+          }
+        }
+        const int min_key[3] = { origin[0] + x, origin[1] + y, origin[2] + z };
+        const int extent[3] = { nx, ny, nz };
+        addOctreeBox(tree, min_key, extent, block);
+      }
+    }
+  }
+}
+
+/** \brief Get the merged boxes of the occupied leaves of \e octree, reusing the blocks that did not change since the
+ *  last call for the same tree */
+std::vector<OctreeBlockPtr> getOctreeBlocks(const std::shared_ptr<const octomap::OcTree>& octree)
+{
+  const octomap::OcTree& tree = *octree;
+  const unsigned int tree_depth = tree.getTreeDepth();
+  const unsigned int block_depth = tree_depth - OCTREE_BLOCK_LEVELS;
+  const octomap::key_type block_mask = static_cast<octomap::key_type>(~(OCTREE_BLOCK_SIZE - 1));
+  const double occupancy_threshold = tree.getOccupancyThres();
+
+  std::unordered_map<std::uint64_t, std::vector<std::uint64_t>> block_leaves;
+  for (auto it = tree.begin_leafs(), end = tree.end_leafs(); it != end; ++it)
+  {
+    if (it->getOccupancy() < occupancy_threshold)
+      continue;
+    // the index key is the key of the leaf's lowest corner at maximal depth
+    const octomap::OcTreeKey key = it.getIndexKey();
+    const unsigned int depth = it.getDepth();
+    std::uint64_t block_key;
+    if (depth < block_depth)
+    {
+      block_key = packOctreeKey(key, depth);
+    }
+    else
+    {
+      const octomap::OcTreeKey block_min(key[0] & block_mask, key[1] & block_mask, key[2] & block_mask);
+      block_key = packOctreeKey(block_min, block_depth);
+    }
+    block_leaves[block_key].push_back(packOctreeKey(key, depth));
+  }
+
+  std::vector<OctreeBlockPtr> blocks;
+  blocks.reserve(block_leaves.size());
+
+  std::lock_guard<std::mutex> guard(octreeBlockCacheLock());
+  auto& caches = octreeBlockCaches();
+  for (auto it = caches.begin(); it != caches.end();)
+  {
+    if (it->second.octree.expired())
+    {
+      it = caches.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  OctreeBlockCache& cache = caches[octree.get()];
+  if (cache.octree.lock() != octree)
+  {
+    cache.octree = octree;
+    cache.blocks.clear();
+  }
+
+  std::unordered_map<std::uint64_t, OctreeBlockPtr> current_blocks;
+  for (auto& [block_key, leaves] : block_leaves)
+  {
+    auto jt = cache.blocks.find(block_key);
+    OctreeBlockPtr block;
+    if (jt != cache.blocks.end() && jt->second->leaves == leaves)
+    {
+      block = jt->second;
+    }
+    else
+    {
+      block = std::make_shared<OctreeBlock>();
+      block->leaves = std::move(leaves);
+      mergeOctreeBlock(tree, block_key, *block);
+    }
+    current_blocks[block_key] = block;
+    blocks.push_back(std::move(block));
+  }
+  cache.blocks.swap(current_blocks);
+  return blocks;
+}
+}  // namespace
+
 btCollisionShape* createShapePrimitive(const shapes::OcTree* geom, const CollisionObjectType& collision_object_type,
                                        CollisionObjectWrapper* cow)
 {
@@ -207,8 +472,6 @@ btCollisionShape* createShapePrimitive(const shapes::OcTree* geom, const Collisi
          collision_object_type == CollisionObjectType::SDF ||
          collision_object_type == CollisionObjectType::MULTI_SPHERE);
 
-  btCompoundShape* subshape =
-      new btCompoundShape(BULLET_COMPOUND_USE_DYNAMIC_AABB, static_cast<int>(geom->octree->size()));
   double occupancy_threshold = geom->octree->getOccupancyThres();
 
   // convert the mesh to the assigned collision object type
@@ -216,29 +479,30 @@ btCollisionShape* createShapePrimitive(const shapes::OcTree* geom, const Collisi
   {
     case CollisionObjectType::USE_SHAPE_TYPE:
     {
-      for (auto it = geom->octree->begin(static_cast<unsigned char>(geom->octree->getTreeDepth())),
-                end = geom->octree->end();
-           it != end; ++it)
+      // adjacent occupied leaves are merged into boxes, the blocks are shared with earlier conversions of the tree
+      const std::vector<OctreeBlockPtr> blocks = getOctreeBlocks(geom->octree);
+      int num_boxes = 0;
+      for (const OctreeBlockPtr& block : blocks)
+        num_boxes += static_cast<int>(block->boxes.size());
+
+      btCompoundShape* subshape = new btCompoundShape(BULLET_COMPOUND_USE_DYNAMIC_AABB, num_boxes);
+      for (const OctreeBlockPtr& block : blocks)
       {
-        if (it->getOccupancy() >= occupancy_threshold)
+        cow->manage(block);
+        for (std::size_t i = 0; i < block->boxes.size(); ++i)
         {
-          double size = it.getSize();
           btTransform geom_trans;
           geom_trans.setIdentity();
-          geom_trans.setOrigin(btVector3(static_cast<btScalar>(it.getX()), static_cast<btScalar>(it.getY()),
-                                         static_cast<btScalar>(it.getZ())));
-          btScalar l = static_cast<btScalar>(size / 2);
-          btBoxShape* childshape = new btBoxShape(btVector3(l, l, l));
-          childshape->setMargin(BULLET_MARGIN);
-          cow->manage(childshape);
-
-          subshape->addChildShape(geom_trans, childshape);
+          geom_trans.setOrigin(block->box_centers[static_cast<int>(i)]);
+          subshape->addChildShape(geom_trans, block->boxes[i].get());
         }
       }
       return subshape;
     }
     case CollisionObjectType::MULTI_SPHERE:
     {
+      btCompoundShape* subshape =
+          new btCompoundShape(BULLET_COMPOUND_USE_DYNAMIC_AABB, static_cast<int>(geom->octree->size()));
       for (auto it = geom->octree->begin(static_cast<unsigned char>(geom->octree->getTreeDepth())),
                 end = geom->octree->end();
            it != end; ++it)
@@ -38,6 +38,8 @@
 #include <moveit/collision_detection_bullet/collision_detector_allocator_bullet.h>
 #include <moveit/collision_detection_bullet/bullet_integration/ros_bullet_utils.h>
 #include <moveit/collision_detection_bullet/bullet_integration/contact_checker_common.h>
+#include <moveit/collision_detection/convex_decomposition.h>
+#include <array>
 #include <functional>
 #include <bullet/btBulletCollisionCommon.h>
 #include <rclcpp/logger.hpp>
@@ -49,8 +51,38 @@ static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.core.collision_d
 const std::string CollisionDetectorAllocatorBullet::NAME("Bullet");
 const double MAX_DISTANCE_MARGIN = 99;
 
+namespace
+{
+// Number of environments a thread keeps a persistent manager clone for
+constexpr std::size_t MANAGER_CACHE_SIZE = 4;
+
+// 0 is reserved for unused cache entries
+std::atomic<std::size_t> next_manager_id{ 1 };
+
+std::size_t newManagerId()
+{
+  return next_manager_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Meshes are represented by their convex hull, or by the hulls of their convex parts if meshes are decomposed
+collision_detection_bullet::CollisionObjectType meshCollisionObjectType()
+{
+  using collision_detection_bullet::CollisionObjectType;
+  return getConvexDecompositionOptions().enabled ? CollisionObjectType::CONVEX_DECOMPOSITION :
+                                                   CollisionObjectType::CONVEX_HULL;
+}
+}  // namespace
+
+struct CollisionEnvBullet::PersistentManager
+{
+  /** \brief Value of manager_id_ of the environment this manager was cloned from, 0 if unused */
+  std::size_t environment_id = 0;
+
+  collision_detection_bullet::BulletDiscreteBVHManagerPtr manager;
+};
+
 CollisionEnvBullet::CollisionEnvBullet(const moveit::core::RobotModelConstPtr& model, double padding, double scale)
-  : CollisionEnv(model, padding, scale)
+  : CollisionEnv(model, padding, scale), manager_id_(newManagerId())
 {
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
@@ -64,7 +96,7 @@ CollisionEnvBullet::CollisionEnvBullet(const moveit::core::RobotModelConstPtr& m
 
 CollisionEnvBullet::CollisionEnvBullet(const moveit::core::RobotModelConstPtr& model, const WorldPtr& world,
                                        double padding, double scale)
-  : CollisionEnv(model, world, padding, scale)
+  : CollisionEnv(model, world, padding, scale), manager_id_(newManagerId())
 {
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
@@ -79,7 +111,7 @@ CollisionEnvBullet::CollisionEnvBullet(const moveit::core::RobotModelConstPtr& m
 }
 
 CollisionEnvBullet::CollisionEnvBullet(const CollisionEnvBullet& other, const WorldPtr& world)
-  : CollisionEnv(other, world)
+  : CollisionEnv(other, world), manager_id_(newManagerId())
 {
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
@@ -116,34 +148,31 @@ void CollisionEnvBullet::checkSelfCollisionHelper(const CollisionRequest& req, C
                                                   const moveit::core::RobotState& state,
                                                   const AllowedCollisionMatrix* acm) const
 {
-  std::lock_guard<std::mutex> guard(collision_env_mutex_);
+  const collision_detection_bullet::BulletDiscreteBVHManagerPtr& manager = getThreadManager();
 
   std::vector<collision_detection_bullet::CollisionObjectWrapperPtr> cows;
   addAttachedOjects(state, cows);
 
   if (req.distance)
   {
-    manager_->setContactDistanceThreshold(MAX_DISTANCE_MARGIN);
+    manager->setContactDistanceThreshold(MAX_DISTANCE_MARGIN);
   }
 
   for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : cows)
   {
-    manager_->addCollisionObject(cow);
-    manager_->setCollisionObjectsTransform(
+    manager->addCollisionObject(cow);
+    manager->setCollisionObjectsTransform(
         cow->getName(), state.getAttachedBody(cow->getName())->getGlobalCollisionBodyTransforms()[0]);
   }
 
   // updating link positions with the current robot state
-  for (const std::string& link : active_)
-  {
-    manager_->setCollisionObjectsTransform(link, state.getCollisionBodyTransform(link, 0));
-  }
+  updateTransformsFromState(state, manager);
 
-  manager_->contactTest(res, req, acm, true);
+  manager->contactTest(res, req, acm, true);
 
   for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : cows)
   {
-    manager_->removeCollisionObject(cow->getName());
+    manager->removeCollisionObject(cow->getName());
   }
 }
 
@@ -175,33 +204,59 @@ void CollisionEnvBullet::checkRobotCollision(const CollisionRequest& req, Collis
   checkRobotCollisionHelperCCD(req, res, state1, state2, &acm);
 }
 
+std::size_t CollisionEnvBullet::checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                                    const std::vector<const moveit::core::RobotState*>& states) const
+{
+  return checkCollisionBatchHelper(req, in_collision, states, nullptr);
+}
+
+std::size_t CollisionEnvBullet::checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                                    const std::vector<const moveit::core::RobotState*>& states,
+                                                    const AllowedCollisionMatrix& acm) const
+{
+  return checkCollisionBatchHelper(req, in_collision, states, &acm);
+}
+
+void CollisionEnvBullet::checkRobotCollisionContinuous(const CollisionRequest& req, CollisionResult& res,
+                                                       const robot_trajectory::RobotTrajectory& trajectory) const
+{
+  checkRobotCollisionHelperTrajectoryCCD(req, res, trajectory, nullptr);
+}
+
+void CollisionEnvBullet::checkRobotCollisionContinuous(const CollisionRequest& req, CollisionResult& res,
+                                                       const robot_trajectory::RobotTrajectory& trajectory,
+                                                       const AllowedCollisionMatrix& acm) const
+{
+  checkRobotCollisionHelperTrajectoryCCD(req, res, trajectory, &acm);
+}
+
 void CollisionEnvBullet::checkRobotCollisionHelper(const CollisionRequest& req, CollisionResult& res,
                                                    const moveit::core::RobotState& state,
                                                    const AllowedCollisionMatrix* acm) const
 {
-  std::lock_guard<std::mutex> guard(collision_env_mutex_);
+  const collision_detection_bullet::BulletDiscreteBVHManagerPtr& manager = getThreadManager();
 
   if (req.distance)
   {
-    manager_->setContactDistanceThreshold(MAX_DISTANCE_MARGIN);
+    manager->setContactDistanceThreshold(MAX_DISTANCE_MARGIN);
   }
 
   std::vector<collision_detection_bullet::CollisionObjectWrapperPtr> attached_cows;
   addAttachedOjects(state, attached_cows);
-  updateTransformsFromState(state, manager_);
+  updateTransformsFromState(state, manager);
 
   for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : attached_cows)
   {
-    manager_->addCollisionObject(cow);
-    manager_->setCollisionObjectsTransform(
+    manager->addCollisionObject(cow);
+    manager->setCollisionObjectsTransform(
         cow->getName(), state.getAttachedBody(cow->getName())->getGlobalCollisionBodyTransforms()[0]);
   }
 
-  manager_->contactTest(res, req, acm, false);
+  manager->contactTest(res, req, acm, false);
 
   for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : attached_cows)
   {
-    manager_->removeCollisionObject(cow->getName());
+    manager->removeCollisionObject(cow->getName());
   }
 }
 
@@ -237,6 +292,111 @@ void CollisionEnvBullet::checkRobotCollisionHelperCCD(const CollisionRequest& re
   }
 }
 
+std::size_t CollisionEnvBullet::checkCollisionBatchHelper(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                                          const std::vector<const moveit::core::RobotState*>& states,
+                                                          const AllowedCollisionMatrix* acm) const
+{
+  in_collision.assign(states.size(), false);
+  if (states.empty())
+    return 0;
+
+  const collision_detection_bullet::BulletDiscreteBVHManagerPtr& manager = getThreadManager();
+
+  CollisionRequest batch_req = req;
+  batch_req.distance = false;
+  batch_req.cost = false;
+
+  std::size_t count = 0;
+  std::vector<collision_detection_bullet::CollisionObjectWrapperPtr> cows;
+  CollisionResult res;
+  for (std::size_t s = 0; s < states.size(); ++s)
+  {
+    const moveit::core::RobotState& state = *states[s];
+
+    // attached bodies are wrapped with the shape poses of each state, so they cannot be reused across states
+    for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : cows)
+    {
+      manager->removeCollisionObject(cow->getName());
+    }
+    cows.clear();
+    addAttachedOjects(state, cows);
+    for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : cows)
+    {
+      manager->addCollisionObject(cow);
+      manager->setCollisionObjectsTransform(
+          cow->getName(), state.getAttachedBody(cow->getName())->getGlobalCollisionBodyTransforms()[0]);
+    }
+
+    updateTransformsFromState(state, manager);
+
+    res.clear();
+    manager->contactTest(res, batch_req, acm, true);
+    if (!res.collision || (batch_req.contacts && res.contacts.size() < batch_req.max_contacts))
+      manager->contactTest(res, batch_req, acm, false);
+
+    if (res.collision)
+    {
+      in_collision[s] = true;
+      ++count;
+    }
+  }
+
+  for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : cows)
+  {
+    manager->removeCollisionObject(cow->getName());
+  }
+  return count;
+}
+
+void CollisionEnvBullet::checkRobotCollisionHelperTrajectoryCCD(const CollisionRequest& req, CollisionResult& res,
+                                                                const robot_trajectory::RobotTrajectory& trajectory,
+                                                                const AllowedCollisionMatrix* acm) const
+{
+  if (trajectory.empty())
+    return;
+  if (trajectory.size() == 1)
+  {
+    checkRobotCollisionHelper(req, res, trajectory.getWayPoint(0), acm);
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(collision_env_mutex_);
+
+  // attached bodies are wrapped and added to the manager only once for the whole trajectory
+  std::vector<collision_detection_bullet::CollisionObjectWrapperPtr> attached_cows;
+  addAttachedOjects(trajectory.getWayPoint(0), attached_cows);
+  for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : attached_cows)
+  {
+    manager_CCD_->addCollisionObject(cow);
+  }
+
+  for (std::size_t i = 1; i < trajectory.size() && !res.collision; ++i)
+  {
+    const moveit::core::RobotState& state1 = trajectory.getWayPoint(i - 1);
+    const moveit::core::RobotState& state2 = trajectory.getWayPoint(i);
+
+    for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : attached_cows)
+    {
+      manager_CCD_->setCastCollisionObjectsTransform(
+          cow->getName(), state1.getAttachedBody(cow->getName())->getGlobalCollisionBodyTransforms()[0],
+          state2.getAttachedBody(cow->getName())->getGlobalCollisionBodyTransforms()[0]);
+    }
+
+    for (const std::string& link : active_)
+    {
+      manager_CCD_->setCastCollisionObjectsTransform(link, state1.getCollisionBodyTransform(link, 0),
+                                                     state2.getCollisionBodyTransform(link, 0));
+    }
+
+    manager_CCD_->contactTest(res, req, acm, false);
+  }
+
+  for (const collision_detection_bullet::CollisionObjectWrapperPtr& cow : attached_cows)
+  {
+    manager_CCD_->removeCollisionObject(cow->getName());
+  }
+}
+
 void CollisionEnvBullet::distanceSelf(const DistanceRequest& /*req*/, DistanceResult& /*res*/,
                                       const moveit::core::RobotState& /*state*/) const
 {
@@ -252,12 +412,13 @@ void CollisionEnvBullet::distanceRobot(const DistanceRequest& /*req*/, DistanceR
 void CollisionEnvBullet::addToManager(const World::Object* obj)
 {
   std::vector<collision_detection_bullet::CollisionObjectType> collision_object_types;
+  const collision_detection_bullet::CollisionObjectType mesh_type = meshCollisionObjectType();
 
   for (const shapes::ShapeConstPtr& shape : obj->shapes_)
   {
     if (shape->type == shapes::MESH)
     {
-      collision_object_types.push_back(collision_detection_bullet::CollisionObjectType::CONVEX_HULL);
+      collision_object_types.push_back(mesh_type);
     }
     else
     {
@@ -320,6 +481,7 @@ void CollisionEnvBullet::setWorld(const WorldPtr& world)
 void CollisionEnvBullet::notifyObjectChange(const ObjectConstPtr& obj, World::Action action)
 {
   std::lock_guard<std::mutex> guard(collision_env_mutex_);
+  manager_id_ = newManagerId();
   if (action == World::DESTROY)
   {
     manager_->removeCollisionObject(obj->id_);
@@ -361,6 +523,9 @@ void CollisionEnvBullet::addAttachedOjects(const moveit::core::RobotState& state
 
 void CollisionEnvBullet::updatedPaddingOrScaling(const std::vector<std::string>& links)
 {
+  // the per-thread managers hold clones of the old link objects
+  manager_id_ = newManagerId();
+
   for (const std::string& link : links)
   {
     if (robot_model_->getURDF()->links_.find(link) != robot_model_->getURDF()->links_.end())
@@ -385,6 +550,28 @@ void CollisionEnvBullet::updateTransformsFromState(
   }
 }
 
+const collision_detection_bullet::BulletDiscreteBVHManagerPtr& CollisionEnvBullet::getThreadManager() const
+{
+  thread_local std::array<PersistentManager, MANAGER_CACHE_SIZE> cache;
+  thread_local std::size_t cache_next = 0;
+
+  const std::size_t id = manager_id_;
+  for (PersistentManager& entry : cache)
+  {
+    if (entry.environment_id == id)
+      return entry.manager;
+  }
+
+  // replace the oldest entry, also releasing its clone of an environment that may not exist anymore
+  PersistentManager& entry = cache[cache_next];
+  cache_next = (cache_next + 1) % MANAGER_CACHE_SIZE;
+
+  std::lock_guard<std::mutex> guard(collision_env_mutex_);
+  entry.manager = manager_->clone();
+  entry.environment_id = id;
+  return entry.manager;
+}
+
 void CollisionEnvBullet::addLinkAsCollisionObject(const urdf::LinkSharedPtr& link)
 {
   if (!link->collision_array.empty())
@@ -396,6 +583,7 @@ void CollisionEnvBullet::addLinkAsCollisionObject(const urdf::LinkSharedPtr& lin
     std::vector<shapes::ShapeConstPtr> shapes;
     collision_detection_bullet::AlignedVector<Eigen::Isometry3d> shape_poses;
     std::vector<collision_detection_bullet::CollisionObjectType> collision_object_types;
+    const collision_detection_bullet::CollisionObjectType mesh_type = meshCollisionObjectType();
 
     for (const auto& i : col_array)
     {
@@ -416,7 +604,7 @@ void CollisionEnvBullet::addLinkAsCollisionObject(const urdf::LinkSharedPtr& lin
 
           if (shape->type == shapes::MESH)
           {
-            collision_object_types.push_back(collision_detection_bullet::CollisionObjectType::CONVEX_HULL);
+            collision_object_types.push_back(mesh_type);
           }
           else
           {
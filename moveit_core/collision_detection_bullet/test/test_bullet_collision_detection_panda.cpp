@@ -36,6 +36,11 @@
 
 #include <moveit/collision_detection_bullet/collision_detector_allocator_bullet.h>
 #include <moveit/collision_detection/test_collision_common_panda.h>
+#include <moveit/collision_detection_bullet/bullet_integration/bullet_utils.h>
+#include <moveit/collision_detection_bullet/collision_env_bullet.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <octomap/octomap.h>
+#include <thread>
 
 INSTANTIATE_TYPED_TEST_SUITE_P(BulletCollisionCheckPanda, CollisionDetectorPandaTest,
                                collision_detection::CollisionDetectorAllocatorBullet);
@@ -46,6 +51,95 @@ GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(DistanceCheckPandaTest);
 GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(DistanceFullPandaTest);
 #endif
 
+namespace
+{
+collision_detection_bullet::CollisionObjectWrapperPtr makeOctreeObject(const std::shared_ptr<octomap::OcTree>& octree)
+{
+  collision_detection_bullet::AlignedVector<Eigen::Isometry3d> poses{ Eigen::Isometry3d::Identity() };
+  return std::make_shared<collision_detection_bullet::CollisionObjectWrapper>(
+      "octomap", collision_detection::BodyType::WORLD_OBJECT,
+      std::vector<shapes::ShapeConstPtr>{ std::make_shared<const shapes::OcTree>(octree) }, poses,
+      std::vector<collision_detection_bullet::CollisionObjectType>{
+          collision_detection_bullet::CollisionObjectType::USE_SHAPE_TYPE },
+      false);
+}
+}  // namespace
+
+/** \brief Adjacent occupied octree leaves are merged into boxes, which are reused while their block does not change */
+TEST(BulletOctree, MergedLeaves)
+{
+  auto octree = std::make_shared<octomap::OcTree>(0.1);
+  for (int x = 0; x < 4; ++x)
+  {
+    for (int y = 0; y < 4; ++y)
+    {
+      for (int z = 0; z < 2; ++z)
+        octree->updateNode(octomap::point3d(0.1 * x + 0.05, 0.1 * y + 0.05, 0.1 * z + 0.05), true);
+    }
+  }
+  octree->updateInnerOccupancy();
+
+  collision_detection_bullet::CollisionObjectWrapperPtr cow = makeOctreeObject(octree);
+  auto compound = static_cast<btCompoundShape*>(cow->getCollisionShape());
+  ASSERT_EQ(compound->getNumChildShapes(), 1);
+  auto box = static_cast<btBoxShape*>(compound->getChildShape(0));
+  EXPECT_NEAR(box->getHalfExtentsWithMargin().x(), 0.2, 1e-6);
+  EXPECT_NEAR(box->getHalfExtentsWithMargin().y(), 0.2, 1e-6);
+  EXPECT_NEAR(box->getHalfExtentsWithMargin().z(), 0.1, 1e-6);
+  EXPECT_NEAR(compound->getChildTransform(0).getOrigin().x(), 0.2, 1e-6);
+  EXPECT_NEAR(compound->getChildTransform(0).getOrigin().z(), 0.1, 1e-6);
+
+  // a leaf in another block does not change the merged boxes of the first one
+  octree->updateNode(octomap::point3d(5.05, 0.05, 0.05), true);
+  octree->updateInnerOccupancy();
+  collision_detection_bullet::CollisionObjectWrapperPtr updated_cow = makeOctreeObject(octree);
+  auto updated_compound = static_cast<btCompoundShape*>(updated_cow->getCollisionShape());
+  ASSERT_EQ(updated_compound->getNumChildShapes(), 2);
+  EXPECT_TRUE(updated_compound->getChildShape(0) == box || updated_compound->getChildShape(1) == box);
+}
+
+/** \brief The per-thread managers follow changes of the world and give the same results in all threads */
+TEST(BulletThreadManagers, WorldChanges)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  collision_detection::CollisionEnvBullet env(robot_model);
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  state.update();
+
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  env.checkRobotCollision(req, res, state);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation().z() = 0.3;
+  env.getWorld()->addToObject("box", std::make_shared<const shapes::Box>(0.1, 0.1, 0.1), pose);
+  env.checkRobotCollision(req, res, state);
+  ASSERT_TRUE(res.collision);
+  res.clear();
+
+  std::vector<char> in_collision(4, false);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < in_collision.size(); ++i)
+  {
+    threads.emplace_back([&, i] {
+      collision_detection::CollisionResult thread_res;
+      env.checkRobotCollision(req, thread_res, state);
+      in_collision[i] = thread_res.collision;
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  for (char collision : in_collision)
+    EXPECT_TRUE(collision);
+
+  env.getWorld()->removeObject("box");
+  env.checkRobotCollision(req, res, state);
+  EXPECT_FALSE(res.collision);
+}
+
 int main(int argc, char* argv[])
 {
   testing::InitGoogleTest(&argc, argv);
@@ -43,6 +43,7 @@
 
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/utils/robot_model_test_utils.h>
 
 #include <moveit/collision_detection_bullet/collision_env_bullet.h>
@@ -323,6 +324,64 @@ TEST_F(BulletCollisionDetectionTester, ContinuousCollisionWorld)
   res.clear();
 }
 
+/** \brief The same sweep as above, checked as part of a trajectory whose waypoints are all collision free. */
+TEST_F(BulletCollisionDetectionTester, ContinuousCollisionTrajectory)
+{
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+
+  ASSERT_TRUE(cenv_->supportsContinuousCollision());
+
+  moveit::core::RobotState state1(robot_model_);
+  moveit::core::RobotState state2(robot_model_);
+
+  setToHome(state1);
+  state1.update();
+
+  setToHome(state2);
+  double joint_2{ 0.05 };
+  double joint_4{ -1.6 };
+  state2.setJointPositions("panda_joint2", &joint_2);
+  state2.setJointPositions("panda_joint4", &joint_4);
+  state2.update();
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model_, "panda_arm");
+  trajectory.addSuffixWayPoint(state1, 0.0);
+  trajectory.addSuffixWayPoint(state1, 0.1);
+  trajectory.addSuffixWayPoint(state2, 0.1);
+  trajectory.addSuffixWayPoint(state2, 0.1);
+
+  cenv_->checkRobotCollisionContinuous(req, res, trajectory, *acm_);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+
+  shapes::ShapeConstPtr shape_ptr = std::make_shared<shapes::Box>(0.1, 0.1, 0.1);
+  Eigen::Isometry3d pos{ Eigen::Isometry3d::Identity() };
+  pos.translation().x() = 0.43;
+  pos.translation().y() = 0;
+  pos.translation().z() = 0.55;
+  cenv_->getWorld()->addToObject("box", shape_ptr, pos);
+
+  for (std::size_t i = 0; i < trajectory.size(); ++i)
+  {
+    cenv_->checkRobotCollision(req, res, trajectory.getWayPoint(i), *acm_);
+    ASSERT_FALSE(res.collision);
+    res.clear();
+  }
+
+  cenv_->checkRobotCollisionContinuous(req, res, trajectory, *acm_);
+  ASSERT_TRUE(res.collision);
+  res.clear();
+
+  // a trajectory that stays at the start state does not sweep through the box
+  robot_trajectory::RobotTrajectory still_trajectory(robot_model_, "panda_arm");
+  still_trajectory.addSuffixWayPoint(state1, 0.0);
+  still_trajectory.addSuffixWayPoint(state1, 0.1);
+  cenv_->checkRobotCollisionContinuous(req, res, still_trajectory, *acm_);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+}
+
 TEST(ContinuousCollisionUnit, BulletCastBVHCollisionBoxBoxUnit)
 {
   collision_detection::CollisionResult result;
@@ -54,6 +54,7 @@
 
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace collision_detection
 {
@@ -127,6 +128,14 @@ struct CollisionGeometryData
    *  geometry data object. */
   int shape_index;
 
+  /** \brief Convex geometry that contains the collision geometry, used to prove that no collision occurs before the
+   *  exact check. Only set for meshes, owned by the \e FCLGeometry. */
+  const fcl::CollisionGeometryd* convex_hull = nullptr;
+
+  /** \brief Convex parts whose union contains the collision geometry, if meshes are decomposed. Owned by the
+   *  \e FCLGeometry. */
+  const std::vector<std::shared_ptr<const fcl::CollisionGeometryd>>* convex_parts = nullptr;
+
   /** \brief Points to the type of body which contains the geometry. */
   union
   {
@@ -156,6 +165,23 @@ struct CollisionData
   /** \brief Compute \e active_components_only_ based on the joint group specified in \e req_ */
   void enableGroup(const moveit::core::RobotModelConstPtr& robot_model);
 
+  /** \brief Counts an exact check of a pair of bodies against the budget of \e req_. Once the budget is exceeded, a
+   *  collision is reported and checking stops.
+   *  \return False if the pair must not be checked */
+  bool consumeBudget()
+  {
+    ++res_->checked_pairs;
+    if ((req_->max_checked_pairs == 0 || res_->checked_pairs <= req_->max_checked_pairs) &&
+        (req_->deadline == std::chrono::steady_clock::time_point::max() ||
+         std::chrono::steady_clock::now() < req_->deadline))
+      return true;
+
+    res_->collision = true;
+    res_->budget_exceeded = true;
+    done_ = true;
+    return false;
+  }
+
   /** \brief The collision request passed by the user */
   const CollisionRequest* req_;
 
@@ -239,12 +265,34 @@ struct FCLGeometry
         return;
     }
     collision_geometry_data_ = std::make_shared<CollisionGeometryData>(data, shape_index);
+    collision_geometry_data_->convex_hull = convex_hull_.get();
+    collision_geometry_data_->convex_parts = convex_parts_.empty() ? nullptr : &convex_parts_;
     collision_geometry_->setUserData(collision_geometry_data_.get());
   }
 
+  /** \brief Sets the convex geometry that contains the \e collision_geometry_ in the same frame. */
+  void setConvexHull(const std::shared_ptr<const fcl::CollisionGeometryd>& convex_hull)
+  {
+    convex_hull_ = convex_hull;
+    collision_geometry_data_->convex_hull = convex_hull_.get();
+  }
+
+  /** \brief Sets the convex parts whose union contains the \e collision_geometry_ in the same frame. */
+  void setConvexParts(std::vector<std::shared_ptr<const fcl::CollisionGeometryd>> convex_parts)
+  {
+    convex_parts_ = std::move(convex_parts);
+    collision_geometry_data_->convex_parts = convex_parts_.empty() ? nullptr : &convex_parts_;
+  }
+
   /** \brief Pointer to FCL collision geometry. */
   std::shared_ptr<fcl::CollisionGeometryd> collision_geometry_;
 
+  /** \brief Optional convex hull of the \e collision_geometry_, see CollisionGeometryData::convex_hull. */
+  std::shared_ptr<const fcl::CollisionGeometryd> convex_hull_;
+
+  /** \brief Optional convex decomposition of the \e collision_geometry_, see CollisionGeometryData::convex_parts. */
+  std::vector<std::shared_ptr<const fcl::CollisionGeometryd>> convex_parts_;
+
   /** \brief Pointer to the user-defined geometry data. */
   CollisionGeometryDataPtr collision_geometry_data_;
 };
@@ -282,6 +330,20 @@ struct FCLManager
  *   \return True terminates the collision check, false continues it to the next pair of objects */
 bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data);
 
+/** \brief Leaner variant of \e collisionCallback for requests that only ask whether there is a collision.
+ *
+ *   It stops at the first pair that collides, never computes or stores contacts or cost sources and only
+ *   writes CollisionResult::collision. Contacts are computed only for conditionally allowed pairs, to evaluate the
+ *   decision function of the ACM. */
+bool booleanCollisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data);
+
+/** \brief Signature of the callbacks passed to the broadphase collision check. */
+typedef bool (*CollisionCallbackFn)(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data);
+
+/** \brief Get \e booleanCollisionCallback if \e req does not ask for contacts, cost sources, verbose output or an
+ *   is_done check, \e collisionCallback otherwise. */
+CollisionCallbackFn getCollisionCallback(const CollisionRequest& req);
+
 /** \brief Callback function used by the FCLManager used for each pair of collision objects to
  *   calculate collisions and distances.
  *
@@ -319,6 +381,10 @@ FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape,
 /** \brief Increases the counter of the caches which can trigger the cleaning of expired entries from them. */
 void cleanCollisionGeometryCache();
 
+/** \brief Add the memory held by \e geometry, its BVH and its convex hull or parts to \e usage. Geometry shared
+ *  through the caches is counted once. Octrees belong to the shapes and are not counted here. */
+void getCollisionGeometryMemoryUsage(const FCLGeometryConstPtr& geometry, moveit::core::MemoryUsage& usage);
+
 /** \brief Transforms an Eigen Isometry3d to FCL coordinate transformation */
 inline void transform2fcl(const Eigen::Isometry3d& b, fcl::Transform3d& f)
 {
@@ -82,6 +82,13 @@ public:
   void checkRobotCollision(const CollisionRequest& req, CollisionResult& res, const moveit::core::RobotState& state1,
                            const moveit::core::RobotState& state2) const override;
 
+  std::size_t checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                  const std::vector<const moveit::core::RobotState*>& states) const override;
+
+  std::size_t checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                  const std::vector<const moveit::core::RobotState*>& states,
+                                  const AllowedCollisionMatrix& acm) const override;
+
   void distanceSelf(const DistanceRequest& req, DistanceResult& res,
                     const moveit::core::RobotState& state) const override;
 
@@ -90,6 +97,11 @@ public:
 
   void setWorld(const WorldPtr& world) override;
 
+  bool supportsCollisionBudget() const override
+  {
+    return true;
+  }
+
 protected:
   /** \brief Updates the FCL collision geometry and objects saved in the CollisionRobotFCL members to reflect a new
    *   padding or scaling of the robot links.
@@ -100,14 +112,30 @@ protected:
    *   \param links The names of the links which have been updated in the robot model */
   void updatedPaddingOrScaling(const std::vector<std::string>& links) override;
 
+  /** \brief Adds the FCL geometry and collision objects of the robot and the world, the world objects are counted
+   *   once for all environments sharing them */
+  void addMemoryUsage(moveit::core::MemoryUsage& usage) const override;
+
   /** \brief Bundles the different checkSelfCollision functions into a single function */
   void checkSelfCollisionHelper(const CollisionRequest& req, CollisionResult& res,
                                 const moveit::core::RobotState& state, const AllowedCollisionMatrix* acm) const;
 
-  /** \brief Bundles the different checkRobotCollision functions into a single function */
+  /** \brief Bundles the different checkRobotCollision functions into a single function.
+   *
+   *   The robot link objects are the ones of the persistent self collision broadphase of the calling thread, so
+   *   without attached bodies no collision objects are allocated. If the request names a group, only the links and
+   *   attached bodies the group can move are updated and checked against the world. */
   void checkRobotCollisionHelper(const CollisionRequest& req, CollisionResult& res,
                                  const moveit::core::RobotState& state, const AllowedCollisionMatrix* acm) const;
 
+  /** \brief Bundles the different checkCollisionBatch functions into a single function.
+   *
+   *   Each state is checked with checkSelfCollisionHelper() and checkRobotCollisionHelper(), so the link objects of
+   *   the persistent self collision broadphase are only moved to each state. Distances and costs are not computed. */
+  std::size_t checkCollisionBatchHelper(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                        const std::vector<const moveit::core::RobotState*>& states,
+                                        const AllowedCollisionMatrix* acm) const;
+
   /** \brief Construct an FCL collision object from MoveIt's World::Object. */
   void constructFCLObjectWorld(const World::Object* obj, FCLObject& fcl_obj) const;
 
@@ -116,6 +144,13 @@ protected:
    *  If it does not exist in world, it is deleted. If it's not existing in \m fcl_objs_ yet, it's added there. */
   void updateFCLObject(const std::string& id);
 
+  /** \brief Updates the transforms and bounding boxes of the FCL objects of \e obj in place, keeping their geometry.
+   *
+   *  Only valid if the shapes of \e obj were moved or modified in place, not added or removed. If the UPDATE_SHAPE bit
+   *  is set in \e action, the local bounding boxes are recomputed as well.
+   *  \return False if the FCL objects do not correspond to \e obj anymore and need to be reconstructed. */
+  bool refreshFCLObject(const World::Object& obj, World::Action action);
+
   /** \brief Out of the current robot state and its attached bodies construct an FCLObject which can then be used to
    *   check for collision.
    *
@@ -126,10 +161,27 @@ protected:
    *   \param fcl_obj The newly filled object */
   void constructFCLObjectRobot(const moveit::core::RobotState& state, FCLObject& fcl_obj) const;
 
+  /** \brief Construct the FCL collision objects for the attached bodies of \e state and add them to \e fcl_obj. */
+  void constructFCLObjectAttachedBodies(const moveit::core::RobotState& state, FCLObject& fcl_obj) const;
+
   /** \brief Prepares for the collision check through constructing an FCL collision object out of the current robot
    *   state and specifying a broadphase collision manager of FCL where the constructed object is registered to. */
   void allocSelfCollisionBroadPhase(const moveit::core::RobotState& state, FCLManager& manager) const;
 
+  /** \brief Get the broadphase manager of the calling thread holding the robot links, updated to \e state.
+   *
+   *   The manager and its collision objects persist between calls, so only the object transforms are updated and the
+   *   AABB tree is refitted instead of being rebuilt for every check. Attached bodies are not part of the manager. */
+  FCLManager& getSelfCollisionBroadPhase(const moveit::core::RobotState& state) const;
+
+  /** \brief Get the link objects of the calling thread's self collision broadphase that \e group can move, updated to
+   *   \e state.
+   *
+   *   The other link objects keep their previous pose and the AABB tree is not refitted, so the objects can only be
+   *   checked on their own, e.g. against the world. The subset of each group is computed once per thread. */
+  const std::vector<FCLCollisionObjectPtr>& getGroupLinkObjects(const moveit::core::RobotState& state,
+                                                                const moveit::core::JointModelGroup* group) const;
+
   /** \brief Converts all shapes which make up an attached body into a vector of FCLGeometryConstPtr.
    *
    *   When they are converted, they can be added to the FCL representation of the robot for collision checking.
@@ -145,12 +197,46 @@ protected:
   /** \brief Vector of shared pointers to the FCL collision objects which make up the robot */
   std::vector<FCLCollisionObjectConstPtr> robot_fcl_objs_;
 
-  /// FCL collision manager which handles the collision checking process
-  std::unique_ptr<fcl::BroadPhaseCollisionManagerd> manager_;
+  /** \brief The FCL objects of the world together with the broadphase manager they are registered in */
+  struct WorldObjects
+  {
+    /// FCL collision manager which handles the collision checking process
+    std::unique_ptr<fcl::BroadPhaseCollisionManagerd> manager_;
 
-  std::map<std::string, FCLObject> fcl_objs_;
+    std::map<std::string, FCLObject> fcl_objs_;
+  };
+
+  /** \brief Get the world objects for modification. An environment copied from another one shares the world objects
+   *   with it until either of them changes its world, which then copies the FCL objects into a new manager. */
+  WorldObjects& mutableWorldObjects();
+
+  /** \brief The world objects, possibly shared with copies of this environment, see mutableWorldObjects() */
+  std::shared_ptr<WorldObjects> world_objects_;
 
 private:
+  struct GroupLinkObjects;
+  struct PersistentSelfCollisionManager;
+
+  /** \brief Get the self collision manager of the calling thread for this environment. A new manager is built with its
+   *   objects at \e state, an existing one is returned as is. */
+  PersistentSelfCollisionManager& getPersistentSelfCollisionManager(const moveit::core::RobotState& state) const;
+
+  /** \brief Check if the link \e object of the calling thread's self collision broadphase, placed at \e state, is
+   *   known to touch no world object.
+   *
+   *   Links that keep their pose, like the links not moved by the planned group, are checked against the whole world
+   *   once, without the ACM, the second time they are seen at the same pose. Until the world changes or the link
+   *   moves, the result is reused and a clear link does not need to be checked against the world again. */
+  bool isClearOfWorld(const moveit::core::RobotState& state, fcl::CollisionObjectd* object) const;
+
+  /** \brief Move the link \e objects, built from the \e geometry_indices of robot_geoms_, to \e state */
+  void updateLinkObjects(const moveit::core::RobotState& state, const std::vector<std::size_t>& geometry_indices,
+                         const std::vector<FCLCollisionObjectPtr>& objects) const;
+
+  /** \brief Key of this environment's robot geometry in the per-thread self-collision managers. A new id is assigned
+   *   whenever robot_fcl_objs_ change, ids are never reused. */
+  std::size_t self_collision_manager_id_;
+
   /** \brief Callback function executed for each change to the world environment */
   void notifyObjectChange(const ObjectConstPtr& obj, World::Action action);
 
@@ -35,6 +35,8 @@
 /* Author: Ioan Sucan, Jia Pan */
 
 #include <moveit/collision_detection_fcl/collision_common.h>
+#include <moveit/collision_detection/convex_decomposition.h>
+#include <geometric_shapes/bodies.h>
 #include <geometric_shapes/shapes.h>
 #include <moveit/collision_detection_fcl/fcl_compat.h>
 #include <rclcpp/logger.hpp>
@@ -43,32 +45,179 @@
 #if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
 #include <fcl/geometry/bvh/BVH_model.h>
 #include <fcl/geometry/octree/octree.h>
+#include <fcl/geometry/shape/convex.h>
 #else
 #include <fcl/BVH/BVH_model.h>
 #include <fcl/shape/geometric_shapes.h>
 #include <fcl/octree.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <tuple>
 #include <type_traits>
+#include <typeindex>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace collision_detection
 {
 // Logger
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_collision_detection_fcl.collision_common");
 
-bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data)
+namespace
 {
-  CollisionData* cdata = reinterpret_cast<CollisionData*>(data);
-  if (cdata->done_)
+#if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
+/** \brief Check if \e geometry is convex, so it can be used directly in the convex hull check */
+bool isConvexShape(const fcl::CollisionGeometryd* geometry)
+{
+  switch (geometry->getNodeType())
+  {
+    case fcl::GEOM_BOX:
+    case fcl::GEOM_SPHERE:
+    case fcl::GEOM_CYLINDER:
+    case fcl::GEOM_CONE:
+    case fcl::GEOM_CONVEX:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/** \brief Conservative checks that can only prove that two objects do not collide. The bounding spheres are compared
+ *  first, then the convex hulls of meshes, before the exact check traverses the BVH of the meshes. */
+bool separatedByBounds(const fcl::CollisionObjectd* o1, const CollisionGeometryData* cd1,
+                       const fcl::CollisionObjectd* o2, const CollisionGeometryData* cd2)
+{
+  const fcl::CollisionGeometryd* g1 = o1->collisionGeometry().get();
+  const fcl::CollisionGeometryd* g2 = o2->collisionGeometry().get();
+
+  // the bounding spheres of unbounded geometry such as planes are infinite
+  const double radius = g1->aabb_radius + g2->aabb_radius;
+  if (std::isfinite(radius) &&
+      (o1->getTransform() * g1->aabb_center - o2->getTransform() * g2->aabb_center).squaredNorm() > radius * radius)
     return true;
-  const CollisionGeometryData* cd1 = static_cast<const CollisionGeometryData*>(o1->collisionGeometry()->getUserData());
-  const CollisionGeometryData* cd2 = static_cast<const CollisionGeometryData*>(o2->collisionGeometry()->getUserData());
 
+  const fcl::CollisionGeometryd* hull1 = cd1->convex_hull ? cd1->convex_hull : (isConvexShape(g1) ? g1 : nullptr);
+  const fcl::CollisionGeometryd* hull2 = cd2->convex_hull ? cd2->convex_hull : (isConvexShape(g2) ? g2 : nullptr);
+  // without a mesh involved, the hull check would repeat the exact check
+  if (!hull1 || !hull2 || (hull1 == g1 && hull2 == g2))
+    return false;
+
+  fcl::CollisionRequestd request;
+  fcl::CollisionResultd result;
+  if (fcl::collide(hull1, o1->getTransform(), hull2, o2->getTransform(), request, result) == 0)
+    return true;
+  if (!cd1->convex_parts && !cd2->convex_parts)
+    return false;
+
+  // the hulls of concave meshes often overlap while their convex parts do not
+  const auto parts = [](const CollisionGeometryData* cd, const fcl::CollisionGeometryd* hull) {
+    std::vector<const fcl::CollisionGeometryd*> parts;
+    if (cd->convex_parts)
+    {
+      for (const std::shared_ptr<const fcl::CollisionGeometryd>& part : *cd->convex_parts)
+        parts.push_back(part.get());
+    }
+    else
+      parts.push_back(hull);
+    return parts;
+  };
+  for (const fcl::CollisionGeometryd* part1 : parts(cd1, hull1))
+  {
+    for (const fcl::CollisionGeometryd* part2 : parts(cd2, hull2))
+    {
+      const double part_radius = part1->aabb_radius + part2->aabb_radius;
+      if ((o1->getTransform() * part1->aabb_center - o2->getTransform() * part2->aabb_center).squaredNorm() >
+          part_radius * part_radius)
+        continue;
+      result.clear();
+      if (fcl::collide(part1, o1->getTransform(), part2, o2->getTransform(), request, result) > 0)
+        return false;
+    }
+  }
+  return true;
+}
+#endif
+
+#if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
+/** \brief Create the FCL geometry of a mesh that is convex already */
+std::shared_ptr<const fcl::CollisionGeometryd> createConvexGeometry(const shapes::Mesh& mesh)
+{
+  auto vertices = std::make_shared<std::vector<fcl::Vector3d>>(mesh.vertex_count);
+  for (unsigned int i = 0; i < mesh.vertex_count; ++i)
+    (*vertices)[i] = fcl::Vector3d(mesh.vertices[3 * i], mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]);
+  auto faces = std::make_shared<std::vector<int>>();
+  faces->reserve(4 * mesh.triangle_count);
+  for (unsigned int i = 0; i < mesh.triangle_count; ++i)
+  {
+    faces->push_back(3);
+    faces->insert(faces->end(), mesh.triangles + 3 * i, mesh.triangles + 3 * i + 3);
+  }
+  auto convex = std::make_shared<fcl::Convexd>(vertices, static_cast<int>(mesh.triangle_count), faces);
+  convex->computeLocalAABB();
+  return convex;
+}
+#endif
+
+/** \brief Compute the convex hull of a mesh for the early-out of the collision check, if the FCL version supports
+ *  convex geometry and the mesh is not degenerate */
+std::shared_ptr<const fcl::CollisionGeometryd> createConvexHull(const shapes::Mesh& mesh)
+{
+#if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
+  if (mesh.vertex_count < 4)
+    return nullptr;
+  const bodies::ConvexMesh hull(&mesh);
+  const EigenSTL::vector_Vector3d& hull_vertices = hull.getVertices();
+  const std::vector<unsigned int>& hull_triangles = hull.getTriangles();
+  if (hull_triangles.empty())
+    return nullptr;
+
+  shapes::Mesh hull_mesh(hull_vertices.size(), hull_triangles.size() / 3);
+  for (std::size_t i = 0; i < hull_vertices.size(); ++i)
+  {
+    for (unsigned int d = 0; d < 3; ++d)
+      hull_mesh.vertices[3 * i + d] = hull_vertices[i][d];
+  }
+  std::copy(hull_triangles.begin(), hull_triangles.begin() + 3 * hull_mesh.triangle_count, hull_mesh.triangles);
+  return createConvexGeometry(hull_mesh);
+#else
+  (void)mesh;
+  return nullptr;
+#endif
+}
+
+/** \brief Get the convex parts of a mesh for the early-out of the collision check, if meshes are decomposed and the
+ *  FCL version supports convex geometry */
+std::vector<std::shared_ptr<const fcl::CollisionGeometryd>> createConvexParts(const shapes::Mesh& mesh)
+{
+  std::vector<std::shared_ptr<const fcl::CollisionGeometryd>> parts;
+#if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
+  if (const ConvexDecompositionConstPtr decomposition = getConvexDecomposition(mesh))
+  {
+    for (const std::shared_ptr<const shapes::Mesh>& part : *decomposition)
+      parts.push_back(createConvexGeometry(*part));
+  }
+#else
+  (void)mesh;
+#endif
+  return parts;
+}
+
+/** \brief Check if the pair \e cd1, \e cd2 never has to be checked: parts of the same object, no active component,
+ *  always allowed by the ACM or touch links. Sets \e dcf if the ACM allows the collision conditionally. */
+bool isPairAllowed(const CollisionData* cdata, const CollisionGeometryData* cd1, const CollisionGeometryData* cd2,
+                   DecideContactFn& dcf)
+{
   // do not collision check geoms part of the same object / link / attached body
   if (cd1->sameObject(*cd2))
-    return false;
+    return true;
 
   // If active components are specified
   if (cdata->active_components_only_)
@@ -85,11 +234,10 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
     // If neither of the involved components is active
     if ((!l1 || cdata->active_components_only_->find(l1) == cdata->active_components_only_->end()) &&
         (!l2 || cdata->active_components_only_->find(l2) == cdata->active_components_only_->end()))
-      return false;
+      return true;
   }
 
   // use the collision matrix (if any) to avoid certain collision checks
-  DecideContactFn dcf;
   bool always_allow_collision = false;
   if (cdata->acm_)
   {
@@ -156,9 +304,37 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
       always_allow_collision = true;
   }
 
+  return always_allow_collision;
+}
+}  // namespace
+
+bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data)
+{
+  CollisionData* cdata = reinterpret_cast<CollisionData*>(data);
+  if (cdata->done_)
+    return true;
+  const CollisionGeometryData* cd1 = static_cast<const CollisionGeometryData*>(o1->collisionGeometry()->getUserData());
+  const CollisionGeometryData* cd2 = static_cast<const CollisionGeometryData*>(o2->collisionGeometry()->getUserData());
+
   // if collisions are always allowed, we are done
-  if (always_allow_collision)
+  DecideContactFn dcf;
+  if (isPairAllowed(cdata, cd1, cd2, dcf))
+    return false;
+
+#if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
+  // cost sources come from overlapping bounding volumes of the exact geometry, so the pair has to be checked exactly
+  if (!cdata->req_->cost && separatedByBounds(o1, cd1, o2, cd2))
     return false;
+#endif
+
+  // a pair that does not fit into the budget of the request is reported as a collision
+  if (!cdata->consumeBudget())
+  {
+    if (cdata->req_->verbose)
+      RCLCPP_DEBUG(LOGGER, "Collision check budget exceeded before checking %s and %s", cd1->getID().c_str(),
+                   cd2->getID().c_str());
+    return true;
+  }
 
   if (cdata->req_->verbose)
     RCLCPP_DEBUG(LOGGER, "Actually checking collisions between %s and %s", cd1->getID().c_str(), cd2->getID().c_str());
@@ -396,6 +572,57 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
   return cdata->done_;
 }
 
+bool booleanCollisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data)
+{
+  CollisionData* cdata = reinterpret_cast<CollisionData*>(data);
+  if (cdata->done_)
+    return true;
+  const CollisionGeometryData* cd1 = static_cast<const CollisionGeometryData*>(o1->collisionGeometry()->getUserData());
+  const CollisionGeometryData* cd2 = static_cast<const CollisionGeometryData*>(o2->collisionGeometry()->getUserData());
+
+  DecideContactFn dcf;
+  if (isPairAllowed(cdata, cd1, cd2, dcf))
+    return false;
+
+#if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
+  if (separatedByBounds(o1, cd1, o2, cd2))
+    return false;
+#endif
+
+  if (!cdata->consumeBudget())
+    return true;
+
+  // only conditionally allowed pairs need contacts, to decide whether each of them is accepted
+  fcl::CollisionResultd col_result;
+  bool collision = false;
+  if (dcf)
+  {
+    const int num_contacts =
+        fcl::collide(o1, o2, fcl::CollisionRequestd(std::numeric_limits<size_t>::max(), true), col_result);
+    Contact c;
+    for (int i = 0; i < num_contacts && !collision; ++i)
+    {
+      fcl2contact(col_result.getContact(i), c);
+      collision = !dcf(c);
+    }
+  }
+  else
+    collision = fcl::collide(o1, o2, fcl::CollisionRequestd(1, false), col_result) > 0;
+
+  if (collision)
+  {
+    cdata->res_->collision = true;
+    cdata->done_ = true;
+  }
+  return cdata->done_;
+}
+
+CollisionCallbackFn getCollisionCallback(const CollisionRequest& req)
+{
+  const bool boolean_only = !req.contacts && !req.cost && !req.verbose && !req.is_done;
+  return boolean_only ? &booleanCollisionCallback : &collisionCallback;
+}
+
 /** \brief Cache for an arbitrary type of shape. It is assigned during the execution of \e createCollisionGeometry().
  *
  *  Only a single cache per thread and object type is created as it is a quasi-singleton instance. */
@@ -440,9 +667,196 @@ struct FCLShapeCache
   unsigned int clean_count_;
 };
 
-bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data, double& /*min_dist*/)
+/** \brief Process-wide registry of the FCL geometry of meshes, keyed by the mesh content and the geometry owner.
+ *
+ *  The thread-local FCLShapeCache only finds geometry built for the same shape instance in the same thread, so every
+ *  thread, every collision environment with padded links and every copy of a mesh builds its own BVH. The registry
+ *  lets all of them share one BVH per owner and mesh content. The owner is part of the key because FCL keeps the
+ *  owner as user data of the geometry itself. Meshes are identified by a 64 bit hash of their vertices and triangles
+ *  together with their sizes. */
+struct FCLMeshRegistry
+{
+  struct Key
+  {
+    std::type_index bv_type;
+    const void* data;
+    int shape_index;
+    std::uint64_t hash;
+    unsigned int vertex_count;
+    unsigned int triangle_count;
+
+    bool operator<(const Key& other) const
+    {
+      return std::tie(bv_type, data, shape_index, hash, vertex_count, triangle_count) <
+             std::tie(other.bv_type, other.data, other.shape_index, other.hash, other.vertex_count,
+                      other.triangle_count);
+    }
+  };
+
+  static FCLMeshRegistry& instance()
+  {
+    static FCLMeshRegistry registry;
+    return registry;
+  }
+
+  template <typename BV>
+  static Key makeKey(const shapes::Mesh& mesh, const void* data, int shape_index)
+  {
+    // FNV-1a over the raw vertex and index data
+    std::uint64_t hash = 14695981039346656037ULL;
+    const auto add = [&hash](const void* bytes, std::size_t size) {
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        hash ^= static_cast<const unsigned char*>(bytes)[i];
+        hash *= 1099511628211ULL;
+      }
+    };
+    add(mesh.vertices, 3 * mesh.vertex_count * sizeof(double));
+    add(mesh.triangles, 3 * mesh.triangle_count * sizeof(unsigned int));
+    return Key{ std::type_index(typeid(BV)), data, shape_index, hash, mesh.vertex_count, mesh.triangle_count };
+  }
+
+  FCLGeometryConstPtr find(const Key& key)
+  {
+    std::lock_guard<std::mutex> slock(lock_);
+    auto it = map_.find(key);
+    return it == map_.end() ? FCLGeometryConstPtr() : it->second;
+  }
+
+  /** \brief Register \e geometry for \e key, returning the geometry registered meanwhile by another thread if any */
+  FCLGeometryConstPtr insert(const Key& key, const FCLGeometryConstPtr& geometry)
+  {
+    std::lock_guard<std::mutex> slock(lock_);
+    if (++insert_count_ > MAX_CLEAN_COUNT)
+    {
+      insert_count_ = 0;
+      removeUnused();
+    }
+    return map_.emplace(key, geometry).first->second;
+  }
+
+  /** \brief Drop the geometry that is only referenced by the registry */
+  void removeUnused()
+  {
+    for (auto it = map_.begin(); it != map_.end();)
+    {
+      if (it->second.use_count() == 1)
+        it = map_.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  static const unsigned int MAX_CLEAN_COUNT = 100;  // every this many insertions, unused geometry is removed
+
+  std::mutex lock_;
+
+  /** \brief The registered geometry. Holding strong references keeps the geometry shared with some other owner
+   *  forever, so FCLShapeCache never sees it as unique and never modifies it for another object. */
+  std::map<Key, FCLGeometryConstPtr> map_;
+
+  unsigned int insert_count_ = 0;
+};
+
+namespace
+{
+// Number of pairs above which the distance bounds of a thread are dropped
+constexpr std::size_t MAX_DISTANCE_BOUNDS = 10000;
+
+/* Lower bounds on the distance between pairs of collision geometries, from the last distance computed for the pair.
+ *
+ * Between consecutive queries (e.g. servo cycles) the objects move very little, so the last distance minus how far
+ * the geometries moved since is a tight lower bound. Pairs whose bound is not below the distance still of interest
+ * cannot change the result and their narrowphase query is skipped. */
+class DistanceBounds
+{
+public:
+  static DistanceBounds& threadInstance()
+  {
+    static thread_local DistanceBounds bounds;
+    return bounds;
+  }
+
+  /** \brief Lower bound on the distance between \e o1 and \e o2, -infinity if unknown */
+  double lowerBound(const fcl::CollisionObjectd* o1, const fcl::CollisionObjectd* o2) const
+  {
+    const bool swap = o2->collisionGeometry().get() < o1->collisionGeometry().get();
+    const fcl::CollisionObjectd* a = swap ? o2 : o1;
+    const fcl::CollisionObjectd* b = swap ? o1 : o2;
+    auto it = bounds_.find(Key(a->collisionGeometry().get(), b->collisionGeometry().get()));
+    // the geometry of a pair may have been freed and its address reused by another one
+    if (it == bounds_.end() || it->second.geometries[0].lock() != a->collisionGeometry() ||
+        it->second.geometries[1].lock() != b->collisionGeometry())
+    {
+      return -std::numeric_limits<double>::infinity();
+    }
+    return it->second.distance - motion(*a, it->second.transforms[0]) - motion(*b, it->second.transforms[1]);
+  }
+
+  /** \brief Record that the distance between \e o1 and \e o2 in their current poses is at least \e distance */
+  void update(const fcl::CollisionObjectd* o1, const fcl::CollisionObjectd* o2, double distance)
+  {
+    const bool swap = o2->collisionGeometry().get() < o1->collisionGeometry().get();
+    const fcl::CollisionObjectd* a = swap ? o2 : o1;
+    const fcl::CollisionObjectd* b = swap ? o1 : o2;
+    if (bounds_.size() >= MAX_DISTANCE_BOUNDS)
+      bounds_.clear();
+    PairBound& bound = bounds_[Key(a->collisionGeometry().get(), b->collisionGeometry().get())];
+    bound.geometries[0] = a->collisionGeometry();
+    bound.geometries[1] = b->collisionGeometry();
+    bound.transforms[0] = a->getTransform();
+    bound.transforms[1] = b->getTransform();
+    bound.distance = distance;
+  }
+
+private:
+  using Key = std::pair<const fcl::CollisionGeometryd*, const fcl::CollisionGeometryd*>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const
+    {
+      const std::size_t h = std::hash<const void*>()(key.first);
+      return h ^ (std::hash<const void*>()(key.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+  };
+
+  struct PairBound
+  {
+    std::weak_ptr<fcl::CollisionGeometryd> geometries[2];
+    fcl::Transform3d transforms[2];
+    double distance;
+  };
+
+  /** \brief Upper bound on how far any point of the geometry of \e object moved since it was at \e old_transform */
+  static double motion(const fcl::CollisionObjectd& object, const fcl::Transform3d& old_transform)
+  {
+    const fcl::Transform3d& transform = object.getTransform();
+    const fcl::CollisionGeometryd& geometry = *object.collisionGeometry();
+    // the Frobenius norm of the rotation difference bounds its spectral norm
+    return (transform * geometry.aabb_center - old_transform * geometry.aabb_center).norm() +
+           (transform.linear() - old_transform.linear()).norm() * geometry.aabb_radius;
+  }
+
+  std::unordered_map<Key, PairBound, KeyHash> bounds_;
+};
+
+/* Let the broadphase skip pairs whose bounding volumes are farther apart than any distance still of interest.
+ * Negative distances are not used, as deeper penetrations are still of interest for signed distances. */
+void updateMinDistance(const DistanceData& cdata, double& min_dist)
+{
+  const double prune_distance = cdata.req->type == DistanceRequestType::GLOBAL ?
+                                    cdata.res->minimum_distance.distance :
+                                    cdata.req->distance_threshold;
+  if (prune_distance > 0.0 && prune_distance < min_dist)
+    min_dist = prune_distance;
+}
+}  // namespace
+
+bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data, double& min_dist)
 {
   DistanceData* cdata = reinterpret_cast<DistanceData*>(data);
+  updateMinDistance(*cdata, min_dist);
 
   const CollisionGeometryData* cd1 = static_cast<const CollisionGeometryData*>(o1->collisionGeometry()->getUserData());
   const CollisionGeometryData* cd2 = static_cast<const CollisionGeometryData*>(o2->collisionGeometry()->getUserData());
@@ -557,6 +971,12 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
     }
   }
 
+  // octrees may be modified in place, so a previous distance to them says nothing about the current one
+  const bool use_bounds = o1->getObjectType() != fcl::OT_OCTREE && o2->getObjectType() != fcl::OT_OCTREE;
+  DistanceBounds& bounds = DistanceBounds::threadInstance();
+  if (use_bounds && bounds.lowerBound(o1, o2) >= dist_threshold)
+    return cdata->done;
+
   fcl::DistanceResultd fcl_result;
   fcl_result.min_distance = dist_threshold;
   // fcl::distance segfaults when given an octree with a null root pointer (using FCL 0.6.1)
@@ -568,6 +988,9 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
     return false;
   }
   double distance = fcl::distance(o1, o2, fcl::DistanceRequestd(cdata->req->enable_nearest_points), fcl_result);
+  // a search cut off at the threshold returns a distance below the actual one, which is still a valid lower bound
+  if (use_bounds)
+    bounds.update(o1, o2, distance);
 
   // Check if either object is already in the map. If not add it or if present
   // check to see if the new distance is closer. If closer remove the existing
@@ -700,6 +1123,7 @@ bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void
     {
       cdata->done = true;
     }
+    updateMinDistance(*cdata, min_dist);
   }
 
   return cdata->done;
@@ -866,28 +1290,41 @@ FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape,
     break;
     case shapes::MESH:
     {
-      auto g = new fcl::BVHModel<BV>();
       const shapes::Mesh* mesh = static_cast<const shapes::Mesh*>(shape.get());
-      if (mesh->vertex_count > 0 && mesh->triangle_count > 0)
+      const FCLMeshRegistry::Key key = FCLMeshRegistry::makeKey<BV>(*mesh, data, shape_index);
+      FCLGeometryConstPtr res = FCLMeshRegistry::instance().find(key);
+      if (!res)
       {
-        std::vector<fcl::Triangle> tri_indices(mesh->triangle_count);
-        for (unsigned int i = 0; i < mesh->triangle_count; ++i)
+        auto g = new fcl::BVHModel<BV>();
+        if (mesh->vertex_count > 0 && mesh->triangle_count > 0)
         {
-          tri_indices[i] =
-              fcl::Triangle(mesh->triangles[3 * i], mesh->triangles[3 * i + 1], mesh->triangles[3 * i + 2]);
-        }
+          std::vector<fcl::Triangle> tri_indices(mesh->triangle_count);
+          for (unsigned int i = 0; i < mesh->triangle_count; ++i)
+          {
+            tri_indices[i] =
+                fcl::Triangle(mesh->triangles[3 * i], mesh->triangles[3 * i + 1], mesh->triangles[3 * i + 2]);
+          }
 
-        std::vector<fcl::Vector3d> points(mesh->vertex_count);
-        for (unsigned int i = 0; i < mesh->vertex_count; ++i)
-          points[i] = fcl::Vector3d(mesh->vertices[3 * i], mesh->vertices[3 * i + 1], mesh->vertices[3 * i + 2]);
+          std::vector<fcl::Vector3d> points(mesh->vertex_count);
+          for (unsigned int i = 0; i < mesh->vertex_count; ++i)
+            points[i] = fcl::Vector3d(mesh->vertices[3 * i], mesh->vertices[3 * i + 1], mesh->vertices[3 * i + 2]);
 
-        g->beginModel();
-        g->addSubModel(points, tri_indices);
-        g->endModel();
+          g->beginModel();
+          g->addSubModel(points, tri_indices);
+          g->endModel();
+        }
+        g->computeLocalAABB();
+        auto geometry = std::make_shared<FCLGeometry>(g, data, shape_index);
+        geometry->setConvexParts(createConvexParts(*mesh));
+        // robot links are checked most often and are rarely convex, so the hull is worth its one-time cost
+        if (std::is_same<T, moveit::core::LinkModel>::value || !geometry->convex_parts_.empty())
+          geometry->setConvexHull(createConvexHull(*mesh));
+        res = FCLMeshRegistry::instance().insert(key, geometry);
       }
-      cg_g = g;
+      cache.map_[wptr] = res;
+      cache.bumpUseCount();
+      return res;
     }
-    break;
     case shapes::OCTREE:
     {
       const shapes::OcTree* g = static_cast<const shapes::OcTree*>(shape.get());
@@ -976,6 +1413,46 @@ void cleanCollisionGeometryCache()
   }
 }
 
+namespace
+{
+std::size_t getFCLGeometryBytes(const fcl::CollisionGeometryd& geometry)
+{
+  if (const auto* bvh = dynamic_cast<const fcl::BVHModel<fcl::OBBRSSd>*>(&geometry))
+  {
+    return sizeof(*bvh) + sizeof(fcl::Vector3d) * bvh->num_vertices +
+           (sizeof(fcl::Triangle) + sizeof(unsigned int)) * bvh->num_tris +
+           sizeof(fcl::BVNode<fcl::OBBRSSd>) * bvh->getNumBVs();
+  }
+#if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
+  if (const auto* convex = dynamic_cast<const fcl::Convexd*>(&geometry))
+  {
+    return sizeof(*convex) + sizeof(fcl::Vector3d) * convex->getVertices().size() +
+           sizeof(int) * convex->getFaces().size();
+  }
+#endif
+  // primitives and octrees, whose octomap is counted with the shape
+  return sizeof(fcl::CollisionGeometryd);
+}
+
+void addFCLGeometry(const fcl::CollisionGeometryd* geometry, moveit::core::MemoryUsage& usage)
+{
+  if (usage.visit(geometry))
+    usage.add("fcl_geometry", getFCLGeometryBytes(*geometry));
+}
+}  // namespace
+
+void getCollisionGeometryMemoryUsage(const FCLGeometryConstPtr& geometry, moveit::core::MemoryUsage& usage)
+{
+  if (!usage.visit(geometry.get()))
+    return;
+  usage.add("fcl_geometry", sizeof(FCLGeometry) + sizeof(CollisionGeometryData));
+  addFCLGeometry(geometry->collision_geometry_.get(), usage);
+  if (geometry->convex_hull_)
+    addFCLGeometry(geometry->convex_hull_.get(), usage);
+  for (const std::shared_ptr<const fcl::CollisionGeometryd>& part : geometry->convex_parts_)
+    addFCLGeometry(part.get(), usage);
+}
+
 void CollisionData::enableGroup(const moveit::core::RobotModelConstPtr& robot_model)
 {
   if (robot_model->hasJointModelGroup(req_->group_name))
@@ -46,6 +46,10 @@
 #include <fcl/broadphase/broadphase_dynamic_AABB_tree.h>
 #endif
 
+#include <array>
+#include <atomic>
+#include <map>
+
 namespace collision_detection
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_collision_detection_fcl.collision_env_fcl");
@@ -74,10 +78,92 @@ void checkFCLCapabilities(const DistanceRequest& req)
   static_cast<void>(req);  // silent -Wunused-parameter
 #endif
 }
+
+// Number of environments a thread keeps a persistent self-collision manager for
+constexpr std::size_t SELF_COLLISION_MANAGER_CACHE_SIZE = 4;
+
+// 0 is reserved for unused cache entries
+std::atomic<std::size_t> next_self_collision_manager_id{ 1 };
+
+std::size_t newSelfCollisionManagerId()
+{
+  return next_self_collision_manager_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Registers objects to a broadphase manager for the lifetime of the guard
+class ScopedRegistration
+{
+public:
+  ScopedRegistration(FCLObject& object, fcl::BroadPhaseCollisionManagerd* manager) : object_(object), manager_(manager)
+  {
+    object_.registerTo(manager_);
+  }
+
+  ~ScopedRegistration()
+  {
+    object_.unregisterFrom(manager_);
+  }
+
+private:
+  FCLObject& object_;
+  fcl::BroadPhaseCollisionManagerd* manager_;
+};
+
+/** \brief Whether a link object at a fixed pose touches any world object, regardless of the ACM */
+struct LinkWorldClearance
+{
+  enum State
+  {
+    UNKNOWN,
+    CLEAR,
+    CONTACT
+  };
+
+  /** \brief The world version and link pose the state was determined for */
+  std::size_t world_version = 0;
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+
+  State state = UNKNOWN;
+};
+
+/** \brief Broadphase callback that stops at the first pair in contact. \e data points to a bool set to true then. */
+bool anyContactCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data)
+{
+  bool& contact = *static_cast<bool*>(data);
+  fcl::CollisionResultd result;
+  contact = fcl::collide(o1, o2, fcl::CollisionRequestd(), result) > 0;
+  return contact;
+}
 }  // namespace
 
+struct CollisionEnvFCL::GroupLinkObjects
+{
+  /** \brief Index into robot_geoms_ for each object in objects */
+  std::vector<std::size_t> geometry_indices;
+
+  /** \brief Link objects shared with the persistent self collision manager */
+  std::vector<FCLCollisionObjectPtr> objects;
+};
+
+struct CollisionEnvFCL::PersistentSelfCollisionManager
+{
+  /** \brief Value of self_collision_manager_id_ of the environment this manager was built for, 0 if unused */
+  std::size_t environment_id = 0;
+
+  /** \brief Index into robot_geoms_ for each object in manager.object_ */
+  std::vector<std::size_t> geometry_indices;
+
+  FCLManager manager;
+
+  /** \brief The objects in manager.object_ of the links each group can move */
+  std::map<const moveit::core::JointModelGroup*, GroupLinkObjects> group_link_objects;
+
+  /** \brief Clearance from the world for each element of robot_geoms_ */
+  std::vector<LinkWorldClearance> world_clearance;
+};
+
 CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model, double padding, double scale)
-  : CollisionEnv(model, padding, scale)
+  : CollisionEnv(model, padding, scale), self_collision_manager_id_(newSelfCollisionManagerId())
 {
   const std::vector<const moveit::core::LinkModel*>& links = robot_model_->getLinkModelsWithCollisionGeometry();
   std::size_t index;
@@ -107,7 +193,8 @@ CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model,
     }
   }
 
-  manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
+  world_objects_ = std::make_shared<WorldObjects>();
+  world_objects_->manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
 
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
@@ -116,7 +203,7 @@ CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model,
 
 CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model, const WorldPtr& world, double padding,
                                  double scale)
-  : CollisionEnv(model, world, padding, scale)
+  : CollisionEnv(model, world, padding, scale), self_collision_manager_id_(newSelfCollisionManagerId())
 {
   const std::vector<const moveit::core::LinkModel*>& links = robot_model_->getLinkModelsWithCollisionGeometry();
   std::size_t index;
@@ -145,7 +232,8 @@ CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model,
     }
   }
 
-  manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
+  world_objects_ = std::make_shared<WorldObjects>();
+  world_objects_->manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
 
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
@@ -158,17 +246,28 @@ CollisionEnvFCL::~CollisionEnvFCL()
   getWorld()->removeObserver(observer_handle_);
 }
 
-CollisionEnvFCL::CollisionEnvFCL(const CollisionEnvFCL& other, const WorldPtr& world) : CollisionEnv(other, world)
+CollisionEnvFCL::WorldObjects& CollisionEnvFCL::mutableWorldObjects()
+{
+  if (world_objects_.use_count() > 1)
+  {
+    auto world_objects = std::make_shared<WorldObjects>();
+    world_objects->manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
+    world_objects->fcl_objs_ = world_objects_->fcl_objs_;
+    for (auto& fcl_obj : world_objects->fcl_objs_)
+      fcl_obj.second.registerTo(world_objects->manager_.get());
+    world_objects_ = std::move(world_objects);
+  }
+  return *world_objects_;
+}
+
+CollisionEnvFCL::CollisionEnvFCL(const CollisionEnvFCL& other, const WorldPtr& world)
+  : CollisionEnv(other, world), self_collision_manager_id_(newSelfCollisionManagerId())
 {
   robot_geoms_ = other.robot_geoms_;
   robot_fcl_objs_ = other.robot_fcl_objs_;
 
-  manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
-
-  fcl_objs_ = other.fcl_objs_;
-  for (auto& fcl_obj : fcl_objs_)
-    fcl_obj.second.registerTo(manager_.get());
-  // manager_->update();
+  // the world of the copy starts out with the same objects, the broadphase is copied when either world changes
+  world_objects_ = other.world_objects_;
 
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(
@@ -223,6 +322,13 @@ void CollisionEnvFCL::constructFCLObjectRobot(const moveit::core::RobotState& st
     }
   }
 
+  constructFCLObjectAttachedBodies(state, fcl_obj);
+}
+
+void CollisionEnvFCL::constructFCLObjectAttachedBodies(const moveit::core::RobotState& state, FCLObject& fcl_obj) const
+{
+  fcl::Transform3d fcl_tf;
+
   // TODO: Implement a method for caching fcl::CollisionObject's for moveit::core::AttachedBody's
   std::vector<const moveit::core::AttachedBody*> ab;
   state.getAttachedBodies(ab);
@@ -254,6 +360,122 @@ void CollisionEnvFCL::allocSelfCollisionBroadPhase(const moveit::core::RobotStat
   manager.object_.registerTo(manager.manager_.get());
 }
 
+CollisionEnvFCL::PersistentSelfCollisionManager&
+CollisionEnvFCL::getPersistentSelfCollisionManager(const moveit::core::RobotState& state) const
+{
+  thread_local std::array<PersistentSelfCollisionManager, SELF_COLLISION_MANAGER_CACHE_SIZE> cache;
+  thread_local std::size_t cache_next = 0;
+
+  for (PersistentSelfCollisionManager& entry : cache)
+  {
+    if (entry.environment_id == self_collision_manager_id_)
+      return entry;
+  }
+
+  // no manager for this environment yet, replace the oldest entry
+  PersistentSelfCollisionManager& entry = cache[cache_next];
+  cache_next = (cache_next + 1) % SELF_COLLISION_MANAGER_CACHE_SIZE;
+
+  entry.environment_id = self_collision_manager_id_;
+  entry.geometry_indices.clear();
+  entry.group_link_objects.clear();
+  entry.world_clearance.assign(robot_geoms_.size(), LinkWorldClearance());
+  entry.manager.object_.clear();
+  entry.manager.manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
+  fcl::Transform3d fcl_tf;
+  for (std::size_t i = 0; i < robot_geoms_.size(); ++i)
+  {
+    if (robot_geoms_[i] && robot_geoms_[i]->collision_geometry_)
+    {
+      transform2fcl(state.getCollisionBodyTransform(robot_geoms_[i]->collision_geometry_data_->ptr.link,
+                                                    robot_geoms_[i]->collision_geometry_data_->shape_index),
+                    fcl_tf);
+      auto coll_obj = std::make_shared<fcl::CollisionObjectd>(*robot_fcl_objs_[i]);
+      coll_obj->setTransform(fcl_tf);
+      coll_obj->computeAABB();
+      entry.manager.object_.collision_objects_.push_back(coll_obj);
+      entry.geometry_indices.push_back(i);
+    }
+  }
+  entry.manager.object_.registerTo(entry.manager.manager_.get());
+  return entry;
+}
+
+void CollisionEnvFCL::updateLinkObjects(const moveit::core::RobotState& state,
+                                        const std::vector<std::size_t>& geometry_indices,
+                                        const std::vector<FCLCollisionObjectPtr>& objects) const
+{
+  fcl::Transform3d fcl_tf;
+  for (std::size_t k = 0; k < objects.size(); ++k)
+  {
+    const FCLGeometryConstPtr& geom = robot_geoms_[geometry_indices[k]];
+    transform2fcl(state.getCollisionBodyTransform(geom->collision_geometry_data_->ptr.link,
+                                                  geom->collision_geometry_data_->shape_index),
+                  fcl_tf);
+    objects[k]->setTransform(fcl_tf);
+    objects[k]->computeAABB();
+  }
+}
+
+FCLManager& CollisionEnvFCL::getSelfCollisionBroadPhase(const moveit::core::RobotState& state) const
+{
+  // move the existing objects and refit the tree
+  PersistentSelfCollisionManager& entry = getPersistentSelfCollisionManager(state);
+  updateLinkObjects(state, entry.geometry_indices, entry.manager.object_.collision_objects_);
+  entry.manager.manager_->update();
+  return entry.manager;
+}
+
+const std::vector<FCLCollisionObjectPtr>&
+CollisionEnvFCL::getGroupLinkObjects(const moveit::core::RobotState& state,
+                                     const moveit::core::JointModelGroup* group) const
+{
+  PersistentSelfCollisionManager& entry = getPersistentSelfCollisionManager(state);
+  auto it = entry.group_link_objects.find(group);
+  if (it == entry.group_link_objects.end())
+  {
+    GroupLinkObjects& group_objects = entry.group_link_objects[group];
+    const std::set<const moveit::core::LinkModel*>& links = group->getUpdatedLinkModelsSet();
+    for (std::size_t k = 0; k < entry.geometry_indices.size(); ++k)
+    {
+      if (links.count(robot_geoms_[entry.geometry_indices[k]]->collision_geometry_data_->ptr.link))
+      {
+        group_objects.geometry_indices.push_back(entry.geometry_indices[k]);
+        group_objects.objects.push_back(entry.manager.object_.collision_objects_[k]);
+      }
+    }
+    it = entry.group_link_objects.find(group);
+  }
+  updateLinkObjects(state, it->second.geometry_indices, it->second.objects);
+  return it->second.objects;
+}
+
+bool CollisionEnvFCL::isClearOfWorld(const moveit::core::RobotState& state, fcl::CollisionObjectd* object) const
+{
+  const CollisionGeometryData* cd =
+      static_cast<const CollisionGeometryData*>(object->collisionGeometry()->getUserData());
+  const std::size_t index = cd->ptr.link->getFirstCollisionBodyTransformIndex() + cd->shape_index;
+  LinkWorldClearance& clearance = getPersistentSelfCollisionManager(state).world_clearance[index];
+  const Eigen::Isometry3d& pose = state.getCollisionBodyTransform(cd->ptr.link, cd->shape_index);
+  const std::size_t world_version = getWorld()->getVersion();
+
+  // only links seen at the same pose twice are checked for contacts, links that move would pay for it every time
+  if (clearance.world_version != world_version || clearance.pose.matrix() != pose.matrix())
+  {
+    clearance.world_version = world_version;
+    clearance.pose = pose;
+    clearance.state = LinkWorldClearance::UNKNOWN;
+    return false;
+  }
+  if (clearance.state == LinkWorldClearance::UNKNOWN)
+  {
+    bool contact = false;
+    world_objects_->manager_->collide(object, &contact, &anyContactCallback);
+    clearance.state = contact ? LinkWorldClearance::CONTACT : LinkWorldClearance::CLEAR;
+  }
+  return clearance.state == LinkWorldClearance::CLEAR;
+}
+
 void CollisionEnvFCL::checkSelfCollision(const CollisionRequest& req, CollisionResult& res,
                                          const moveit::core::RobotState& state) const
 {
@@ -270,11 +492,15 @@ void CollisionEnvFCL::checkSelfCollisionHelper(const CollisionRequest& req, Coll
                                                const moveit::core::RobotState& state,
                                                const AllowedCollisionMatrix* acm) const
 {
-  FCLManager manager;
-  allocSelfCollisionBroadPhase(state, manager);
-  CollisionData cd(&req, &res, acm);
-  cd.enableGroup(getRobotModel());
-  manager.manager_->collide(&cd, &collisionCallback);
+  FCLManager& manager = getSelfCollisionBroadPhase(state);
+  FCLObject attached_bodies;
+  constructFCLObjectAttachedBodies(state, attached_bodies);
+  {
+    ScopedRegistration registration(attached_bodies, manager.manager_.get());
+    CollisionData cd(&req, &res, acm);
+    cd.enableGroup(getRobotModel());
+    manager.manager_->collide(&cd, getCollisionCallback(req));
+  }
   if (req.distance)
   {
     DistanceRequest dreq;
@@ -320,13 +546,32 @@ void CollisionEnvFCL::checkRobotCollisionHelper(const CollisionRequest& req, Col
                                                 const moveit::core::RobotState& state,
                                                 const AllowedCollisionMatrix* acm) const
 {
-  FCLObject fcl_obj;
-  constructFCLObjectRobot(state, fcl_obj);
+  // links the group can not move are skipped by the callback anyway, so only the group's links are moved and checked
+  const moveit::core::JointModelGroup* group = getRobotModel()->hasJointModelGroup(req.group_name) ?
+                                                    getRobotModel()->getJointModelGroup(req.group_name) :
+                                                    nullptr;
+  const std::vector<FCLCollisionObjectPtr>& robot_objects =
+      group ? getGroupLinkObjects(state, group) : getSelfCollisionBroadPhase(state).object_.collision_objects_;
+  FCLObject attached_bodies;
+  constructFCLObjectAttachedBodies(state, attached_bodies);
 
   CollisionData cd(&req, &res, acm);
   cd.enableGroup(getRobotModel());
-  for (std::size_t i = 0; !cd.done_ && i < fcl_obj.collision_objects_.size(); ++i)
-    manager_->collide(fcl_obj.collision_objects_[i].get(), &cd, &collisionCallback);
+  const CollisionCallbackFn callback = getCollisionCallback(req);
+  for (std::size_t i = 0; !cd.done_ && i < robot_objects.size(); ++i)
+  {
+    // cost sources come from bounding volume overlaps, which a link without contacts may still have
+    if (!req.cost && isClearOfWorld(state, robot_objects[i].get()))
+      continue;
+    world_objects_->manager_->collide(robot_objects[i].get(), &cd, callback);
+  }
+  for (std::size_t i = 0; !cd.done_ && i < attached_bodies.collision_objects_.size(); ++i)
+  {
+    if (group && !group->getUpdatedLinkModelsSet().count(
+                     attached_bodies.collision_geometry_[i]->collision_geometry_data_->ptr.ab->getAttachedLink()))
+      continue;
+    world_objects_->manager_->collide(attached_bodies.collision_objects_[i].get(), &cd, callback);
+  }
 
   if (req.distance)
   {
@@ -341,13 +586,58 @@ void CollisionEnvFCL::checkRobotCollisionHelper(const CollisionRequest& req, Col
   }
 }
 
+std::size_t CollisionEnvFCL::checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                                 const std::vector<const moveit::core::RobotState*>& states) const
+{
+  return checkCollisionBatchHelper(req, in_collision, states, nullptr);
+}
+
+std::size_t CollisionEnvFCL::checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                                 const std::vector<const moveit::core::RobotState*>& states,
+                                                 const AllowedCollisionMatrix& acm) const
+{
+  return checkCollisionBatchHelper(req, in_collision, states, &acm);
+}
+
+std::size_t CollisionEnvFCL::checkCollisionBatchHelper(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                                       const std::vector<const moveit::core::RobotState*>& states,
+                                                       const AllowedCollisionMatrix* acm) const
+{
+  in_collision.assign(states.size(), false);
+  if (states.empty())
+    return 0;
+
+  CollisionRequest batch_req = req;
+  batch_req.distance = false;
+  batch_req.cost = false;
+
+  std::size_t count = 0;
+  for (std::size_t s = 0; s < states.size(); ++s)
+  {
+    const moveit::core::RobotState& state = *states[s];
+    CollisionResult res;
+    checkSelfCollisionHelper(batch_req, res, state, acm);
+    if (!res.collision || (batch_req.contacts && res.contacts.size() < batch_req.max_contacts))
+      checkRobotCollisionHelper(batch_req, res, state, acm);
+
+    if (res.collision)
+    {
+      in_collision[s] = true;
+      ++count;
+    }
+  }
+  return count;
+}
+
 void CollisionEnvFCL::distanceSelf(const DistanceRequest& req, DistanceResult& res,
                                    const moveit::core::RobotState& state) const
 {
   checkFCLCapabilities(req);
 
-  FCLManager manager;
-  allocSelfCollisionBroadPhase(state, manager);
+  FCLManager& manager = getSelfCollisionBroadPhase(state);
+  FCLObject attached_bodies;
+  constructFCLObjectAttachedBodies(state, attached_bodies);
+  ScopedRegistration registration(attached_bodies, manager.manager_.get());
   DistanceData drd(&req, &res);
 
   manager.manager_->distance(&drd, &distanceCallback);
@@ -363,16 +653,18 @@ void CollisionEnvFCL::distanceRobot(const DistanceRequest& req, DistanceResult&
 
   DistanceData drd(&req, &res);
   for (std::size_t i = 0; !drd.done && i < fcl_obj.collision_objects_.size(); ++i)
-    manager_->distance(fcl_obj.collision_objects_[i].get(), &drd, &distanceCallback);
+    world_objects_->manager_->distance(fcl_obj.collision_objects_[i].get(), &drd, &distanceCallback);
 }
 
 void CollisionEnvFCL::updateFCLObject(const std::string& id)
 {
+  WorldObjects& world_objects = mutableWorldObjects();
+
   // remove FCL objects that correspond to this object
-  auto jt = fcl_objs_.find(id);
-  if (jt != fcl_objs_.end())
+  auto jt = world_objects.fcl_objs_.find(id);
+  if (jt != world_objects.fcl_objs_.end())
   {
-    jt->second.unregisterFrom(manager_.get());
+    jt->second.unregisterFrom(world_objects.manager_.get());
     jt->second.clear();
   }
 
@@ -381,26 +673,57 @@ void CollisionEnvFCL::updateFCLObject(const std::string& id)
   if (it != getWorld()->end())
   {
     // construct FCL objects that correspond to this object
-    if (jt != fcl_objs_.end())
+    if (jt != world_objects.fcl_objs_.end())
     {
       constructFCLObjectWorld(it->second.get(), jt->second);
-      jt->second.registerTo(manager_.get());
+      jt->second.registerTo(world_objects.manager_.get());
     }
     else
     {
-      constructFCLObjectWorld(it->second.get(), fcl_objs_[id]);
-      fcl_objs_[id].registerTo(manager_.get());
+      FCLObject& fcl_obj = world_objects.fcl_objs_[id];
+      constructFCLObjectWorld(it->second.get(), fcl_obj);
+      fcl_obj.registerTo(world_objects.manager_.get());
     }
   }
   else
   {
-    if (jt != fcl_objs_.end())
-      fcl_objs_.erase(jt);
+    if (jt != world_objects.fcl_objs_.end())
+      world_objects.fcl_objs_.erase(jt);
   }
 
   // manager_->update();
 }
 
+bool CollisionEnvFCL::refreshFCLObject(const World::Object& obj, World::Action action)
+{
+  // FCL objects shared with a copy of this environment must not be changed, they are replaced instead
+  if (world_objects_.use_count() > 1)
+    return false;
+
+  auto it = world_objects_->fcl_objs_.find(obj.id_);
+  if (it == world_objects_->fcl_objs_.end() || it->second.collision_objects_.size() != obj.shapes_.size())
+    return false;
+
+  // the geometry is cached per shape and object, a copied object needs new FCL objects
+  const FCLObject& fcl_obj = it->second;
+  for (const FCLGeometryConstPtr& g : fcl_obj.collision_geometry_)
+  {
+    if (g->collision_geometry_data_->ptr.obj != &obj)
+      return false;
+  }
+
+  for (std::size_t i{ 0 }; i < fcl_obj.collision_objects_.size(); ++i)
+  {
+    const FCLCollisionObjectPtr& co = fcl_obj.collision_objects_[i];
+    if (action & World::UPDATE_SHAPE)
+      fcl_obj.collision_geometry_[i]->collision_geometry_->computeLocalAABB();
+    co->setTransform(transform2fcl(obj.global_shape_poses_[i]));
+    co->computeAABB();
+    world_objects_->manager_->update(co.get());
+  }
+  return true;
+}
+
 void CollisionEnvFCL::setWorld(const WorldPtr& world)
 {
   if (world == getWorld())
@@ -409,9 +732,9 @@ void CollisionEnvFCL::setWorld(const WorldPtr& world)
   // turn off notifications about old world
   getWorld()->removeObserver(observer_handle_);
 
-  // clear out objects from old world
-  manager_->clear();
-  fcl_objs_.clear();
+  // clear out objects from old world, without touching the ones shared with copies of this environment
+  world_objects_ = std::make_shared<WorldObjects>();
+  world_objects_->manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
   cleanCollisionGeometryCache();
 
   CollisionEnv::setWorld(world);
@@ -428,18 +751,22 @@ void CollisionEnvFCL::notifyObjectChange(const ObjectConstPtr& obj, World::Actio
 {
   if (action == World::DESTROY)
   {
-    auto it = fcl_objs_.find(obj->id_);
-    if (it != fcl_objs_.end())
+    if (world_objects_->fcl_objs_.count(obj->id_))
     {
-      it->second.unregisterFrom(manager_.get());
+      WorldObjects& world_objects = mutableWorldObjects();
+      auto it = world_objects.fcl_objs_.find(obj->id_);
+      it->second.unregisterFrom(world_objects.manager_.get());
       it->second.clear();
-      fcl_objs_.erase(it);
+      world_objects.fcl_objs_.erase(it);
     }
     cleanCollisionGeometryCache();
   }
   else
   {
-    updateFCLObject(obj->id_);
+    // shapes that were only moved or modified in place keep their FCL objects, which are refit in the broadphase
+    const bool in_place = (action & ~(World::MOVE_SHAPE | World::UPDATE_SHAPE)) == 0;
+    if (!in_place || !refreshFCLObject(*obj, action))
+      updateFCLObject(obj->id_);
     if (action & (World::DESTROY | World::REMOVE_SHAPE))
       cleanCollisionGeometryCache();
   }
@@ -447,6 +774,9 @@ void CollisionEnvFCL::notifyObjectChange(const ObjectConstPtr& obj, World::Actio
 
 void CollisionEnvFCL::updatedPaddingOrScaling(const std::vector<std::string>& links)
 {
+  // the persistent self-collision managers hold copies of the old robot objects
+  self_collision_manager_id_ = newSelfCollisionManagerId();
+
   std::size_t index;
   for (const auto& link : links)
   {
@@ -470,4 +800,27 @@ void CollisionEnvFCL::updatedPaddingOrScaling(const std::vector<std::string>& li
   }
 }
 
+void CollisionEnvFCL::addMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  CollisionEnv::addMemoryUsage(usage);
+  const std::size_t robot_object_bytes =
+      sizeof(FCLGeometryConstPtr) + sizeof(FCLCollisionObjectConstPtr) + sizeof(fcl::CollisionObjectd);
+  usage.add("collision_env", sizeof(CollisionEnvFCL) + robot_object_bytes * robot_geoms_.size());
+  for (const FCLGeometryConstPtr& geometry : robot_geoms_)
+  {
+    if (geometry)
+      getCollisionGeometryMemoryUsage(geometry, usage);
+  }
+  if (!usage.visit(world_objects_.get()))
+    return;
+  usage.add("collision_env", sizeof(WorldObjects) + sizeof(fcl::DynamicAABBTreeCollisionManagerd));
+  for (const auto& fcl_obj : world_objects_->fcl_objs_)
+  {
+    usage.add("collision_env", sizeof(std::string) + sizeof(FCLObject) +
+                                   sizeof(fcl::CollisionObjectd) * fcl_obj.second.collision_objects_.size());
+    for (const FCLGeometryConstPtr& geometry : fcl_obj.second.collision_geometry_)
+      getCollisionGeometryMemoryUsage(geometry, usage);
+  }
+}
+
 }  // end of namespace collision_detection
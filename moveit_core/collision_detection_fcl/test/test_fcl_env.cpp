@@ -42,11 +42,17 @@
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/utils/robot_model_test_utils.h>
 
+#define MOVEIT_DEFINE_ALLOCATION_INTERPOSER
+#include <moveit/utils/allocation_counter.h>
+
 #include <moveit/collision_detection_fcl/collision_common.h>
 #include <moveit/collision_detection_fcl/collision_env_fcl.h>
 
 #include <urdf_parser/urdf_parser.h>
 #include <geometric_shapes/shape_operations.h>
+#include <octomap/octomap.h>
+
+#include <thread>
 
 /** \brief Brings the panda robot in user defined home position */
 inline void setToHome(moveit::core::RobotState& panda_state)
@@ -140,6 +146,164 @@ TEST_F(CollisionDetectionEnvTest, LinksInCollision)
   ASSERT_TRUE(res.collision);
 }
 
+/** \brief Repeated self-collision checks reuse the broadphase manager and must follow the state changes. */
+TEST_F(CollisionDetectionEnvTest, RepeatedSelfCollisionChecks)
+{
+  moveit::core::RobotState colliding_state(robot_model_);
+  colliding_state.setToDefaultValues();
+  colliding_state.update();
+
+  collision_detection::CollisionRequest req;
+  for (int i = 0; i < 3; ++i)
+  {
+    collision_detection::CollisionResult res;
+    c_env_->checkSelfCollision(req, res, *robot_state_, *acm_);
+    EXPECT_FALSE(res.collision);
+    res.clear();
+    c_env_->checkSelfCollision(req, res, colliding_state, *acm_);
+    EXPECT_TRUE(res.collision);
+  }
+
+  // changing the padding invalidates the cached robot objects
+  c_env_->setLinkPadding("panda_hand", 0.0);
+  collision_detection::CollisionResult res;
+  c_env_->checkSelfCollision(req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+}
+
+/** \brief Self-collision checks refit the persistent broadphase, they allocate less than building it and the same
+    every time. */
+TEST_F(CollisionDetectionEnvTest, SelfCollisionAllocationBudget)
+{
+  if (!moveit::allocation_counter::isSupported())
+    GTEST_SKIP() << "Allocations can not be counted on this platform";
+
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  const auto check = [&](const collision_detection::CollisionEnvPtr& env) {
+    res.clear();
+    env->checkSelfCollision(req, res, *robot_state_, *acm_);
+    EXPECT_FALSE(res.collision);
+  };
+
+  // a new environment builds the broadphase of this thread on its first check
+  const collision_detection::CollisionEnvPtr new_env =
+      std::make_shared<collision_detection::CollisionEnvFCL>(robot_model_);
+  const std::size_t build_allocations = moveit::allocation_counter::countAllocations([&] { check(new_env); });
+
+  const std::size_t check_allocations = moveit::allocation_counter::countAllocations([&] { check(new_env); });
+  EXPECT_LT(check_allocations, build_allocations);
+
+  const std::size_t allocations = moveit::allocation_counter::countAllocations([&] {
+    for (int i = 0; i < 100; ++i)
+      check(new_env);
+  });
+  EXPECT_EQ(allocations, 100 * check_allocations);
+}
+
+/** \brief Checks that run out of their pair or time budget stop and conservatively report a collision. */
+TEST_F(CollisionDetectionEnvTest, CollisionBudget)
+{
+  ASSERT_TRUE(c_env_->supportsCollisionBudget());
+
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  c_env_->checkCollision(req, res, *robot_state_, *acm_);
+  ASSERT_FALSE(res.collision);
+  EXPECT_FALSE(res.budget_exceeded);
+  const std::size_t checked_pairs = res.checked_pairs;
+  ASSERT_GT(checked_pairs, 1u);
+
+  req.max_checked_pairs = checked_pairs;
+  res.clear();
+  c_env_->checkCollision(req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+  EXPECT_FALSE(res.budget_exceeded);
+
+  req.max_checked_pairs = checked_pairs - 1;
+  res.clear();
+  c_env_->checkCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+  EXPECT_TRUE(res.budget_exceeded);
+  EXPECT_EQ(res.checked_pairs, checked_pairs);
+
+  req.max_checked_pairs = 0;
+  req.deadline = std::chrono::steady_clock::now();
+  res.clear();
+  c_env_->checkCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+  EXPECT_TRUE(res.budget_exceeded);
+  EXPECT_EQ(res.checked_pairs, 1u);
+}
+
+/** \brief Requests without contacts take the boolean-only path, which must agree with the contact-collecting one. */
+TEST_F(CollisionDetectionEnvTest, BooleanCollisionQuery)
+{
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation().z() = 0.3;
+  c_env_->getWorld()->addToObject("box", std::make_shared<const shapes::Box>(0.1, 0.1, 0.1), pose);
+
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  ASSERT_EQ(collision_detection::getCollisionCallback(req), &collision_detection::booleanCollisionCallback);
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+  EXPECT_TRUE(res.contacts.empty());
+  EXPECT_EQ(res.contact_count, 0u);
+
+  collision_detection::CollisionRequest contact_req;
+  contact_req.contacts = true;
+  contact_req.max_contacts = 10;
+  ASSERT_EQ(collision_detection::getCollisionCallback(contact_req), &collision_detection::collisionCallback);
+  res.clear();
+  c_env_->checkRobotCollision(contact_req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+  EXPECT_GT(res.contact_count, 0u);
+
+  // conditionally allowed pairs are decided on their contacts in both paths
+  collision_detection::DecideContactFn accept_all = [](collision_detection::Contact& /*contact*/) { return true; };
+  acm_->setDefaultEntry("box", accept_all);
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+  res.clear();
+  c_env_->checkRobotCollision(contact_req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+
+  collision_detection::DecideContactFn reject_all = [](collision_detection::Contact& /*contact*/) { return false; };
+  acm_->setDefaultEntry("box", reject_all);
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+}
+
+/** \brief Robot-world checks move the link objects of the persistent broadphase, they allocate the same every time. */
+TEST_F(CollisionDetectionEnvTest, RobotCollisionAllocationBudget)
+{
+  if (!moveit::allocation_counter::isSupported())
+    GTEST_SKIP() << "Allocations can not be counted on this platform";
+
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation().x() = 0.6;
+  c_env_->getWorld()->addToObject("box", std::make_shared<const shapes::Box>(0.1, 0.1, 0.1), pose);
+
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  const auto check = [&] {
+    res.clear();
+    c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+    EXPECT_FALSE(res.collision);
+  };
+  check();
+
+  const std::size_t check_allocations = moveit::allocation_counter::countAllocations(check);
+  const std::size_t allocations = moveit::allocation_counter::countAllocations([&] {
+    for (int i = 0; i < 100; ++i)
+      check();
+  });
+  EXPECT_EQ(allocations, 100 * check_allocations);
+}
+
 /** \brief Adding obstacles to the world which are tested against the robot. Simple cases. */
 TEST_F(CollisionDetectionEnvTest, RobotWorldCollision_1)
 {
@@ -170,6 +334,87 @@ TEST_F(CollisionDetectionEnvTest, RobotWorldCollision_1)
   ASSERT_FALSE(res.collision);
 }
 
+/** \brief Robot-world checks for a group only consider the links the group can move. */
+TEST_F(CollisionDetectionEnvTest, GroupRobotWorldCollision)
+{
+  // the base link is not moved by any group
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation().z() = 0.05;
+  c_env_->getWorld()->addToObject("base_box", std::make_shared<const shapes::Box>(0.1, 0.1, 0.1), pose);
+
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+
+  req.group_name = "panda_arm";
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+
+  // the group's links follow the state
+  c_env_->getWorld()->addToObject("hand_box", std::make_shared<const shapes::Box>(0.05, 0.05, 0.05),
+                                  robot_state_->getGlobalLinkTransform("panda_hand"));
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+
+  moveit::core::RobotState moved_state(*robot_state_);
+  double joint1 = 1.5;
+  moved_state.setJointPositions("panda_joint1", &joint1);
+  moved_state.update();
+  res.clear();
+  c_env_->checkRobotCollision(req, res, moved_state, *acm_);
+  EXPECT_FALSE(res.collision);
+
+  // checks without a group still see all links after a group check
+  c_env_->getWorld()->removeObject("hand_box");
+  req.group_name = "";
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+}
+
+/** \brief Links that keep their pose skip the world check only while the world does not change. */
+TEST_F(CollisionDetectionEnvTest, StaticLinkWorldClearance)
+{
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation().x() = 1.0;
+  c_env_->getWorld()->addToObject("box", std::make_shared<const shapes::Box>(0.1, 0.1, 0.1), pose);
+
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  for (int i = 0; i < 3; ++i)
+  {
+    res.clear();
+    c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+    EXPECT_FALSE(res.collision);
+  }
+
+  // moving the box onto the base invalidates the clearance of the base link
+  pose.translation().x() = 0.0;
+  pose.translation().z() = 0.05;
+  c_env_->getWorld()->moveObject("box", pose);
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+
+  // a link touching an allowed object is still checked, so other objects are not missed
+  acm_->setEntry("box", "panda_link0", true);
+  for (int i = 0; i < 3; ++i)
+  {
+    res.clear();
+    c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+    EXPECT_FALSE(res.collision);
+  }
+  Eigen::Isometry3d other_pose = Eigen::Isometry3d::Identity();
+  other_pose.translation().z() = 0.05;
+  c_env_->getWorld()->addToObject("other_box", std::make_shared<const shapes::Box>(0.05, 0.05, 0.05), other_pose);
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+}
+
 /** \brief Adding obstacles to the world which are tested against the robot. */
 TEST_F(CollisionDetectionEnvTest, RobotWorldCollision_2)
 {
@@ -191,6 +436,120 @@ TEST_F(CollisionDetectionEnvTest, RobotWorldCollision_2)
   res.clear();
 }
 
+/** \brief Copies of an environment share the world objects until either of them changes the world. */
+TEST_F(CollisionDetectionEnvTest, CopiedEnvSharesWorld)
+{
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+
+  Eigen::Isometry3d far = Eigen::Isometry3d(Eigen::Translation3d(2, 0, 0));
+  c_env_->getWorld()->addToObject("far_box", std::make_shared<shapes::Box>(.1, .1, .1), far);
+
+  auto world_copy = std::make_shared<collision_detection::World>(*c_env_->getWorld());
+  collision_detection::CollisionEnvFCL c_env_copy(*c_env_, world_copy);
+
+  Eigen::Isometry3d near = Eigen::Isometry3d(Eigen::Translation3d(0, 0, 0.3));
+  world_copy->addToObject("near_box", std::make_shared<shapes::Box>(.1, .1, .1), near);
+  c_env_copy.checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+  res.clear();
+
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+  res.clear();
+
+  // moving the shared object in the original must not move it in the copy
+  c_env_->getWorld()->moveObject("far_box", near);
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_TRUE(res.collision);
+  res.clear();
+
+  world_copy->removeObject("near_box");
+  c_env_copy.checkRobotCollision(req, res, *robot_state_, *acm_);
+  EXPECT_FALSE(res.collision);
+}
+
+/** \brief Moved shapes and octrees modified in place are refit in the broadphase without rebuilding the objects. */
+TEST_F(CollisionDetectionEnvTest, WorldShapesUpdatedInPlace)
+{
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+
+  auto octree = std::make_shared<octomap::OcTree>(0.05);
+  c_env_->getWorld()->addToObject("octomap", std::make_shared<const shapes::OcTree>(octree),
+                                  Eigen::Isometry3d::Identity());
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+
+  // occupy the cells of the box that collides in RobotWorldCollision_1
+  for (double x : { -0.025, 0.025 })
+  {
+    for (double y : { -0.025, 0.025 })
+    {
+      for (double z : { 0.275, 0.325 })
+        octree->updateNode(octomap::point3d(x, y, z), true);
+    }
+  }
+  octree->updateInnerOccupancy();
+  ASSERT_TRUE(c_env_->getWorld()->notifyShapesUpdated("octomap"));
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_TRUE(res.collision);
+  res.clear();
+
+  c_env_->getWorld()->moveObject("octomap", Eigen::Isometry3d(Eigen::Translation3d(0.0, 0.0, 2.0)));
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+
+  c_env_->getWorld()->moveObject("octomap", Eigen::Isometry3d::Identity());
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_TRUE(res.collision);
+}
+
+/** \brief Distances computed after a small motion, with the bounds of the previous query, match fresh ones. */
+TEST_F(CollisionDetectionEnvTest, RepeatedDistanceQueries)
+{
+  shapes::ShapeConstPtr shape_ptr(new shapes::Box(0.1, 0.1, 0.1));
+  Eigen::Isometry3d pos{ Eigen::Isometry3d::Identity() };
+  pos.translation() = Eigen::Vector3d(0.43, 0.0, 0.7);
+  c_env_->getWorld()->addToObject("box", shape_ptr, pos);
+
+  collision_detection::DistanceRequest req;
+  req.acm = acm_.get();
+  req.type = collision_detection::DistanceRequestType::SINGLE;
+  req.distance_threshold = 0.3;
+  const auto query = [&](const moveit::core::RobotState& state, collision_detection::DistanceResult& self_res,
+                         collision_detection::DistanceResult& robot_res) {
+    c_env_->distanceSelf(req, self_res, state);
+    c_env_->distanceRobot(req, robot_res, state);
+  };
+
+  collision_detection::DistanceResult self_res, robot_res;
+  query(*robot_state_, self_res, robot_res);
+
+  double joint = -0.7;
+  for (std::size_t i = 0; i < 5; ++i)
+  {
+    joint += 0.002;
+    robot_state_->setJointPositions("panda_joint2", &joint);
+    robot_state_->update();
+
+    self_res.clear();
+    robot_res.clear();
+    query(*robot_state_, self_res, robot_res);
+
+    collision_detection::DistanceResult fresh_self_res, fresh_robot_res;
+    std::thread thread([&] { query(*robot_state_, fresh_self_res, fresh_robot_res); });
+    thread.join();
+
+    EXPECT_NEAR(self_res.minimum_distance.distance, fresh_self_res.minimum_distance.distance, 1e-9);
+    EXPECT_NEAR(robot_res.minimum_distance.distance, fresh_robot_res.minimum_distance.distance, 1e-9);
+    EXPECT_EQ(self_res.distances.size(), fresh_self_res.distances.size());
+    EXPECT_EQ(robot_res.distances.size(), fresh_robot_res.distances.size());
+  }
+}
+
 /** \brief Tests the padding through expanding the link geometry in such a way that a collision occurs. */
 TEST_F(CollisionDetectionEnvTest, PaddingTest)
 {
@@ -226,6 +585,72 @@ TEST_F(CollisionDetectionEnvTest, PaddingTest)
 /** \brief Continuous self collision checks of the robot.
  *
  *  Functionality not supported yet. */
+/** \brief Mesh geometry is shared between copies of a mesh and between threads, but not between owners. */
+TEST_F(CollisionDetectionEnvTest, SharedMeshGeometry)
+{
+  const moveit::core::LinkModel* link = robot_model_->getLinkModel("panda_link1");
+  const moveit::core::LinkModel* other_link = robot_model_->getLinkModel("panda_link2");
+  ASSERT_FALSE(link->getShapes().empty());
+  const shapes::ShapeConstPtr& shape = link->getShapes()[0];
+  ASSERT_EQ(shape->type, shapes::MESH);
+  const shapes::ShapeConstPtr copy(shape->clone());
+
+  collision_detection::FCLGeometryConstPtr geometry = collision_detection::createCollisionGeometry(shape, link, 0);
+  ASSERT_TRUE(geometry);
+  EXPECT_EQ(geometry, collision_detection::createCollisionGeometry(copy, link, 0));
+
+  collision_detection::FCLGeometryConstPtr geometry_in_thread;
+  std::thread thread([&] { geometry_in_thread = collision_detection::createCollisionGeometry(shape, link, 0); });
+  thread.join();
+  EXPECT_EQ(geometry, geometry_in_thread);
+
+  collision_detection::FCLGeometryConstPtr other_geometry =
+      collision_detection::createCollisionGeometry(copy, other_link, 0);
+  ASSERT_TRUE(other_geometry);
+  EXPECT_NE(geometry, other_geometry);
+  EXPECT_EQ(other_geometry->collision_geometry_data_->ptr.link, other_link);
+}
+
+#if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
+TEST_F(CollisionDetectionEnvTest, ConvexHullOfLinkMeshes)
+{
+  const moveit::core::LinkModel* link = robot_model_->getLinkModel("panda_link3");
+  ASSERT_FALSE(link->getShapes().empty());
+  const shapes::ShapeConstPtr& shape = link->getShapes()[0];
+  ASSERT_EQ(shape->type, shapes::MESH);
+
+  collision_detection::FCLGeometryConstPtr geometry = collision_detection::createCollisionGeometry(shape, link, 0);
+  ASSERT_TRUE(geometry);
+  ASSERT_TRUE(geometry->convex_hull_);
+  EXPECT_EQ(geometry->collision_geometry_data_->convex_hull, geometry->convex_hull_.get());
+
+  // the hull spans the same box as the mesh
+  const fcl::AABBd& mesh_box = geometry->collision_geometry_->aabb_local;
+  const fcl::AABBd& hull_box = geometry->convex_hull_->aabb_local;
+  EXPECT_TRUE(hull_box.min_.isApprox(mesh_box.min_, 1e-9));
+  EXPECT_TRUE(hull_box.max_.isApprox(mesh_box.max_, 1e-9));
+
+  // requesting cost sources disables the early-out, the results must not change
+  moveit::core::RobotState colliding_state(robot_model_);
+  colliding_state.setToDefaultValues();
+  colliding_state.update();
+  for (const moveit::core::RobotState* state : { robot_state_.get(), &colliding_state })
+  {
+    collision_detection::CollisionRequest req;
+    req.contacts = true;
+    req.max_contacts = 100;
+    collision_detection::CollisionResult res;
+    c_env_->checkSelfCollision(req, res, *state, *acm_);
+
+    req.cost = true;
+    collision_detection::CollisionResult exact_res;
+    c_env_->checkSelfCollision(req, exact_res, *state, *acm_);
+    EXPECT_EQ(res.collision, exact_res.collision);
+    EXPECT_EQ(res.contact_count, exact_res.contact_count);
+  }
+}
+#endif
+
 TEST_F(CollisionDetectionEnvTest, DISABLED_ContinuousCollisionSelf)
 {
   collision_detection::CollisionRequest req;
@@ -58,7 +58,7 @@ struct GroupStateRepresentation
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
   GroupStateRepresentation(){};
-  GroupStateRepresentation(const GroupStateRepresentation& gsr)
+  GroupStateRepresentation(const GroupStateRepresentation& gsr) : dfce_(gsr.dfce_)
   {
     link_body_decompositions_.resize(gsr.link_body_decompositions_.size());
     for (unsigned int i = 0; i < gsr.link_body_decompositions_.size(); ++i)
@@ -75,7 +75,8 @@ struct GroupStateRepresentation
     attached_body_decompositions_.resize(gsr.attached_body_decompositions_.size());
     for (unsigned int i = 0; i < gsr.attached_body_decompositions_.size(); ++i)
     {
-      (*attached_body_decompositions_[i]) = (*gsr.attached_body_decompositions_[i]);
+      attached_body_decompositions_[i] =
+          std::make_shared<PosedBodySphereDecompositionVector>(*gsr.attached_body_decompositions_[i]);
     }
     gradients_ = gsr.gradients_;
   }
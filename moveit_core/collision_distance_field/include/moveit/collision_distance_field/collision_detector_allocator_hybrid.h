@@ -41,6 +41,8 @@
 
 #include <moveit_collision_distance_field_export.h>
 
+#include <mutex>
+
 namespace collision_detection
 {
 /** \brief An allocator for Hybrid collision detectors */
@@ -50,4 +52,41 @@ class MOVEIT_COLLISION_DISTANCE_FIELD_EXPORT CollisionDetectorAllocatorHybrid
 public:
   static const std::string NAME;  // defined in collision_env_hybrid.cpp
 };
+
+/** \brief An allocator for Hybrid collision detectors that remembers the last environment it allocated from a world.
+ *  New environments for the same robot model are copied from it, so their world distance fields are only updated for
+ *  the objects that differ, instead of being generated from scratch. This is useful when planning repeatedly in
+ *  slowly changing scenes. */
+class MOVEIT_COLLISION_DISTANCE_FIELD_EXPORT CachingCollisionDetectorAllocatorHybrid : public CollisionDetectorAllocator
+{
+public:
+  const std::string& getName() const override
+  {
+    return CollisionDetectorAllocatorHybrid::NAME;
+  }
+
+  /** Copies the last environment allocated by this function if it was allocated for \e robot_model */
+  CollisionEnvPtr allocateEnv(const WorldPtr& world,
+                              const moveit::core::RobotModelConstPtr& robot_model) const override;
+
+  CollisionEnvPtr allocateEnv(const CollisionEnvConstPtr& orig, const WorldPtr& world) const override
+  {
+    return std::make_shared<CollisionEnvHybrid>(dynamic_cast<const CollisionEnvHybrid&>(*orig), world);
+  }
+
+  CollisionEnvPtr allocateEnv(const moveit::core::RobotModelConstPtr& robot_model) const override
+  {
+    return std::make_shared<CollisionEnvHybrid>(robot_model);
+  }
+
+  /** Create an allocator for collision detectors. */
+  static CollisionDetectorAllocatorPtr create()
+  {
+    return std::make_shared<CachingCollisionDetectorAllocatorHybrid>();
+  }
+
+private:
+  mutable std::mutex cache_lock_;
+  mutable std::shared_ptr<const CollisionEnvHybrid> last_env_;
+};
 }  // namespace collision_detection
@@ -376,6 +376,18 @@ public:
   {
   }
 
+  /** \brief Copy the posed decompositions of \e other, so the copy can be posed independently */
+  PosedBodySphereDecompositionVector(const PosedBodySphereDecompositionVector& other)
+    : collision_spheres_(other.collision_spheres_)
+    , posed_collision_spheres_(other.posed_collision_spheres_)
+    , sphere_radii_(other.sphere_radii_)
+    , sphere_index_map_(other.sphere_index_map_)
+  {
+    decomp_vector_.reserve(other.decomp_vector_.size());
+    for (const PosedBodySphereDecompositionPtr& decomp : other.decomp_vector_)
+      decomp_vector_.push_back(std::make_shared<PosedBodySphereDecomposition>(*decomp));
+  }
+
   const std::vector<CollisionSphere>& getCollisionSpheres() const
   {
     return collision_spheres_;
@@ -53,6 +53,7 @@ static const bool DEFAULT_USE_SIGNED_DISTANCE_FIELD = false;
 static const double DEFAULT_RESOLUTION = .02;
 static const double DEFAULT_COLLISION_TOLERANCE = 0.0;
 static const double DEFAULT_MAX_PROPOGATION_DISTANCE = .25;
+static const bool DEFAULT_SPARSE_WORLD_DISTANCE_FIELD = false;
 
 MOVEIT_CLASS_FORWARD(CollisionEnvDistanceField);  // Defines CollisionEnvDistanceFieldPtr, ConstPtr, WeakPtr... etc
 
@@ -70,7 +71,8 @@ public:
                             double resolution = DEFAULT_RESOLUTION,
                             double collision_tolerance = DEFAULT_COLLISION_TOLERANCE,
                             double max_propogation_distance = DEFAULT_MAX_PROPOGATION_DISTANCE, double padding = 0.0,
-                            double scale = 1.0);
+                            double scale = 1.0,
+                            bool sparse_world_distance_field = DEFAULT_SPARSE_WORLD_DISTANCE_FIELD);
 
   CollisionEnvDistanceField(const moveit::core::RobotModelConstPtr& robot_model, const WorldPtr& world,
                             const std::map<std::string, std::vector<CollisionSphere>>& link_body_decompositions =
@@ -81,7 +83,8 @@ public:
                             double resolution = DEFAULT_RESOLUTION,
                             double collision_tolerance = DEFAULT_COLLISION_TOLERANCE,
                             double max_propogation_distance = DEFAULT_MAX_PROPOGATION_DISTANCE, double padding = 0.0,
-                            double scale = 1.0);
+                            double scale = 1.0,
+                            bool sparse_world_distance_field = DEFAULT_SPARSE_WORLD_DISTANCE_FIELD);
 
   CollisionEnvDistanceField(const CollisionEnvDistanceField& other, const WorldPtr& world);
 
@@ -140,6 +143,8 @@ public:
   struct DistanceFieldCacheEntryWorld
   {
     std::map<std::string, std::vector<PosedBodyPointDecompositionPtr>> posed_body_point_decompositions_;
+    // the world objects the decompositions were generated from, objects are copied on write by the world
+    std::map<std::string, World::ObjectConstPtr> objects_;
     distance_field::DistanceFieldPtr distance_field_;
   };
 
@@ -157,6 +162,16 @@ public:
   virtual void checkCollision(const CollisionRequest& req, CollisionResult& res, const moveit::core::RobotState& state,
                               const AllowedCollisionMatrix& acm, GroupStateRepresentationPtr& gsr) const;
 
+  /** \brief Check a batch of states in parallel, see setBatchThreads().
+   *  The spheres of the states are posed and checked against the distance fields generated for the first state.
+   *  States that differ from it outside of \e req.group_name, or in their attached bodies, are checked one by one. */
+  std::size_t checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                  const std::vector<const moveit::core::RobotState*>& states) const override;
+
+  std::size_t checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                  const std::vector<const moveit::core::RobotState*>& states,
+                                  const AllowedCollisionMatrix& acm) const override;
+
   void checkRobotCollision(const CollisionRequest& req, CollisionResult& res,
                            const moveit::core::RobotState& state) const override;
 
@@ -200,6 +215,36 @@ public:
 
   void setWorld(const WorldPtr& world) override;
 
+  /**
+   * \brief Sets the number of threads used to update the world distance field. Large world updates, such as
+   * a new octomap, are then recomputed in parallel, see distance_field::PropagationDistanceField::setPropagationThreads
+   * \param threads The number of threads, 0 selects one per hardware thread
+   */
+  void setPropagationThreads(unsigned int threads);
+
+  /**
+   * \brief Selects a distance_field::SparseDistanceField for the world, which only allocates cells near
+   * obstacles. This makes large workspaces affordable, the distances are the same up to the maximum
+   * propagation distance. Switching regenerates the world distance field.
+   * \param sparse True for the sparse field, false for the dense distance_field::PropagationDistanceField
+   */
+  void setSparseWorldDistanceField(bool sparse);
+
+  bool getSparseWorldDistanceField() const
+  {
+    return sparse_world_distance_field_;
+  }
+
+  /**
+   * \brief Sets the number of threads used by checkCollisionBatch(). Each thread poses its own copy of the
+   * collision spheres, so the per state work is only the sphere lookups in the distance fields.
+   * \param threads The number of threads, 0 selects one per hardware thread
+   */
+  void setBatchThreads(unsigned int threads)
+  {
+    batch_threads_ = threads;
+  }
+
   distance_field::DistanceFieldConstPtr getDistanceField() const
   {
     return distance_field_cache_entry_->distance_field_;
@@ -207,6 +252,7 @@ public:
 
   collision_detection::GroupStateRepresentationConstPtr getLastGroupStateRepresentation() const
   {
+    std::scoped_lock slock(last_gsr_lock_);
     return last_gsr_;
   }
 
@@ -227,6 +273,10 @@ protected:
   bool getIntraGroupCollisions(const collision_detection::CollisionRequest& req,
                                collision_detection::CollisionResult& res, GroupStateRepresentationPtr& gsr) const;
 
+  std::size_t checkCollisionBatchHelper(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                        const std::vector<const moveit::core::RobotState*>& states,
+                                        const AllowedCollisionMatrix* acm) const;
+
   void checkSelfCollisionHelper(const collision_detection::CollisionRequest& req,
                                 collision_detection::CollisionResult& res, const moveit::core::RobotState& state,
                                 const collision_detection::AllowedCollisionMatrix* acm,
@@ -269,8 +319,14 @@ protected:
 
   void updatedPaddingOrScaling(const std::vector<std::string>& /*links*/) override{};
 
+  /** \brief Adds the voxel grids of the robot and world distance fields and the link decompositions */
+  void addMemoryUsage(moveit::core::MemoryUsage& usage) const override;
+
   DistanceFieldCacheEntryWorldPtr generateDistanceFieldCacheEntryWorld();
 
+  /** \brief Copy the world distance field of \e other, only updating the objects that differ from the current world */
+  DistanceFieldCacheEntryWorldPtr generateDistanceFieldCacheEntryWorld(const DistanceFieldCacheEntryWorld& other);
+
   void updateDistanceObject(const std::string& id, CollisionEnvDistanceField::DistanceFieldCacheEntryWorldPtr& dfce,
                             EigenSTL::vector_Vector3d& add_points, EigenSTL::vector_Vector3d& subtract_points);
 
@@ -292,6 +348,9 @@ protected:
   double resolution_;
   double collision_tolerance_;
   double max_propogation_distance_;
+  unsigned int propagation_threads_{ 1 };
+  bool sparse_world_distance_field_{ DEFAULT_SPARSE_WORLD_DISTANCE_FIELD };
+  unsigned int batch_threads_{ 0 };
 
   std::vector<BodyDecompositionConstPtr> link_body_decomposition_vector_;
   std::map<std::string, unsigned int> link_body_decomposition_index_map_;
@@ -305,6 +364,8 @@ protected:
 
   mutable std::mutex update_cache_lock_world_;
   DistanceFieldCacheEntryWorldPtr distance_field_cache_entry_world_;
+  // checks with separate group state representations may run concurrently, e.g. in CHOMP
+  mutable std::mutex last_gsr_lock_;
   GroupStateRepresentationPtr last_gsr_;
   World::ObserverHandle observer_handle_;
 };
@@ -58,7 +58,7 @@ public:
                      bool use_signed_distance_field = DEFAULT_USE_SIGNED_DISTANCE_FIELD,
                      double resolution = DEFAULT_RESOLUTION, double collision_tolerance = DEFAULT_COLLISION_TOLERANCE,
                      double max_propogation_distance = DEFAULT_MAX_PROPOGATION_DISTANCE, double padding = 0.0,
-                     double scale = 1.0);
+                     double scale = 1.0, bool sparse_world_distance_field = DEFAULT_SPARSE_WORLD_DISTANCE_FIELD);
 
   CollisionEnvHybrid(const moveit::core::RobotModelConstPtr& robot_model, const WorldPtr& world,
                      const std::map<std::string, std::vector<CollisionSphere>>& link_body_decompositions =
@@ -68,7 +68,7 @@ public:
                      bool use_signed_distance_field = DEFAULT_USE_SIGNED_DISTANCE_FIELD,
                      double resolution = DEFAULT_RESOLUTION, double collision_tolerance = DEFAULT_COLLISION_TOLERANCE,
                      double max_propogation_distance = DEFAULT_MAX_PROPOGATION_DISTANCE, double padding = 0.0,
-                     double scale = 1.0);
+                     double scale = 1.0, bool sparse_world_distance_field = DEFAULT_SPARSE_WORLD_DISTANCE_FIELD);
 
   CollisionEnvHybrid(const CollisionEnvHybrid& other, const WorldPtr& world);
 
@@ -145,7 +145,27 @@ public:
     return cenv_distance_;
   }
 
+  /**
+   * \brief Sets the number of threads used to update the world distance field, see
+   * CollisionEnvDistanceField::setPropagationThreads
+   */
+  void setPropagationThreads(unsigned int threads)
+  {
+    cenv_distance_->setPropagationThreads(threads);
+  }
+
+  /**
+   * \brief Selects a sparse world distance field, see CollisionEnvDistanceField::setSparseWorldDistanceField
+   */
+  void setSparseWorldDistanceField(bool sparse)
+  {
+    cenv_distance_->setSparseWorldDistanceField(sparse);
+  }
+
 protected:
+  /** \brief Adds the FCL geometry and the distance field environment */
+  void addMemoryUsage(moveit::core::MemoryUsage& usage) const override;
+
   CollisionEnvDistanceFieldPtr cenv_distance_;
 };
 }  // namespace collision_detection
@@ -50,6 +50,25 @@ namespace collision_detection
 static const rclcpp::Logger LOGGER =
     rclcpp::get_logger("moveit_collision_distance_field.collision_distance_field_types");
 
+namespace
+{
+// Per-thread scratch space for the batched distance field queries, so the
+// gradient functions below do not allocate once they have warmed up
+struct SphereQueryBuffers
+{
+  EigenSTL::vector_Vector3d points;
+  std::vector<double> distances;
+  EigenSTL::vector_Vector3d gradients;
+  std::vector<unsigned char> in_bounds;
+};
+
+SphereQueryBuffers& getSphereQueryBuffers()
+{
+  thread_local SphereQueryBuffers buffers;
+  return buffers;
+}
+}  // namespace
+
 std::vector<CollisionSphere> determineCollisionSpheres(const bodies::Body* body, Eigen::Isometry3d& relative_transform)
 {
   std::vector<CollisionSphere> css;
@@ -86,13 +105,21 @@ bool PosedDistanceField::getCollisionSphereGradients(const std::vector<Collision
 {
   // assumes gradient is properly initialized
 
+  // query all spheres in one batch in the local frame of the field, then map the gradients back
+  SphereQueryBuffers& buffers = getSphereQueryBuffers();
+  const Eigen::Matrix3d rotation_transpose = pose_.linear().transpose();
+  buffers.points.resize(sphere_list.size());
+  for (unsigned int i{ 0 }; i < sphere_list.size(); ++i)
+    buffers.points[i] = rotation_transpose * sphere_centers[i];
+  distance_field::PropagationDistanceField::getDistanceGradients(buffers.points, buffers.distances, buffers.gradients,
+                                                                 buffers.in_bounds);
+
   bool in_collision{ false };
   for (unsigned int i{ 0 }; i < sphere_list.size(); ++i)
   {
-    Eigen::Vector3d p = sphere_centers[i];
-    Eigen::Vector3d grad(0, 0, 0);
-    bool in_bounds;
-    double dist = getDistanceGradient(p.x(), p.y(), p.z(), grad.x(), grad.y(), grad.z(), in_bounds);
+    const Eigen::Vector3d grad = pose_ * buffers.gradients[i];
+    const bool in_bounds = buffers.in_bounds[i];
+    double dist = buffers.distances[i];
     if (!in_bounds && grad.norm() > 0)
     {
       // out of bounds
@@ -149,15 +176,18 @@ bool getCollisionSphereGradients(const distance_field::DistanceField* distance_f
 {
   // assumes gradient is properly initialized
 
+  SphereQueryBuffers& buffers = getSphereQueryBuffers();
+  distance_field->getDistanceGradients(sphere_centers, buffers.distances, buffers.gradients, buffers.in_bounds);
+
   bool in_collision{ false };
   for (unsigned int i{ 0 }; i < sphere_list.size(); ++i)
   {
-    Eigen::Vector3d p = sphere_centers[i];
-    Eigen::Vector3d grad;
-    bool in_bounds;
-    double dist = distance_field->getDistanceGradient(p.x(), p.y(), p.z(), grad.x(), grad.y(), grad.z(), in_bounds);
+    const Eigen::Vector3d& grad = buffers.gradients[i];
+    const bool in_bounds = buffers.in_bounds[i];
+    double dist = buffers.distances[i];
     if (!in_bounds && grad.norm() > EPSILON)
     {
+      const Eigen::Vector3d& p = sphere_centers[i];
       RCLCPP_DEBUG(LOGGER, "Collision sphere point is out of bounds %lf, %lf, %lf", p.x(), p.y(), p.z());
       return true;
     }
@@ -44,9 +44,13 @@
 #include <moveit/collision_distance_field/collision_env_distance_field.h>
 #include <moveit/collision_distance_field/collision_common_distance_field.h>
 #include <moveit/distance_field/propagation_distance_field.h>
+#include <moveit/distance_field/sparse_distance_field.h>
 #include <moveit/collision_distance_field/collision_detector_allocator_distance_field.h>
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <thread>
 #include <utility>
 
 namespace collision_detection
@@ -61,8 +65,9 @@ CollisionEnvDistanceField::CollisionEnvDistanceField(
     const moveit::core::RobotModelConstPtr& robot_model,
     const std::map<std::string, std::vector<CollisionSphere>>& link_body_decompositions, double size_x, double size_y,
     double size_z, const Eigen::Vector3d& origin, bool use_signed_distance_field, double resolution,
-    double collision_tolerance, double max_propogation_distance, double /*padding*/, double /*scale*/)
-  : CollisionEnv(robot_model)
+    double collision_tolerance, double max_propogation_distance, double /*padding*/, double /*scale*/,
+    bool sparse_world_distance_field)
+  : CollisionEnv(robot_model), sparse_world_distance_field_(sparse_world_distance_field)
 {
   initialize(link_body_decompositions, Eigen::Vector3d(size_x, size_y, size_z), origin, use_signed_distance_field,
              resolution, collision_tolerance, max_propogation_distance);
@@ -80,19 +85,19 @@ CollisionEnvDistanceField::CollisionEnvDistanceField(
     const moveit::core::RobotModelConstPtr& robot_model, const WorldPtr& world,
     const std::map<std::string, std::vector<CollisionSphere>>& link_body_decompositions, double size_x, double size_y,
     double size_z, const Eigen::Vector3d& origin, bool use_signed_distance_field, double resolution,
-    double collision_tolerance, double max_propogation_distance, double padding, double scale)
-  : CollisionEnv(robot_model, world, padding, scale)
+    double collision_tolerance, double max_propogation_distance, double padding, double scale,
+    bool sparse_world_distance_field)
+  : CollisionEnv(robot_model, world, padding, scale), sparse_world_distance_field_(sparse_world_distance_field)
 {
   initialize(link_body_decompositions, Eigen::Vector3d(size_x, size_y, size_z), origin, use_signed_distance_field,
              resolution, collision_tolerance, max_propogation_distance);
 
+  // already contains all objects of the world, no need to be notified about them again
   distance_field_cache_entry_world_ = generateDistanceFieldCacheEntryWorld();
 
   // request notifications about changes to world
   observer_handle_ = getWorld()->addObserver(
       [this](const World::ObjectConstPtr& object, World::Action action) { return notifyObjectChange(object, action); });
-
-  getWorld()->notifyObserverAllObjects(observer_handle_, World::CREATE);
 }
 
 CollisionEnvDistanceField::CollisionEnvDistanceField(const CollisionEnvDistanceField& other, const WorldPtr& world)
@@ -105,17 +110,28 @@ CollisionEnvDistanceField::CollisionEnvDistanceField(const CollisionEnvDistanceF
   resolution_ = other.resolution_;
   collision_tolerance_ = other.collision_tolerance_;
   max_propogation_distance_ = other.max_propogation_distance_;
+  propagation_threads_ = other.propagation_threads_;
+  sparse_world_distance_field_ = other.sparse_world_distance_field_;
+  batch_threads_ = other.batch_threads_;
   link_body_decomposition_vector_ = other.link_body_decomposition_vector_;
   link_body_decomposition_index_map_ = other.link_body_decomposition_index_map_;
   in_group_update_map_ = other.in_group_update_map_;
-  distance_field_cache_entry_world_ = generateDistanceFieldCacheEntryWorld();
+  {
+    // cache entries are never modified once generated, and are only used after checking state and acm
+    std::scoped_lock slock(other.update_cache_lock_);
+    distance_field_cache_entry_ = other.distance_field_cache_entry_;
+  }
+  {
+    // reuse the world distance field of other, so only objects that differ in world need to be added or removed
+    std::scoped_lock slock(other.update_cache_lock_world_);
+    distance_field_cache_entry_world_ = generateDistanceFieldCacheEntryWorld(*other.distance_field_cache_entry_world_);
+  }
   pregenerated_group_state_representation_map_ = other.pregenerated_group_state_representation_map_;
   planning_scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
 
   // request notifications about changes to world
   observer_handle_ = getWorld()->addObserver(
       [this](const World::ObjectConstPtr& object, World::Action action) { return notifyObjectChange(object, action); });
-  getWorld()->notifyObserverAllObjects(observer_handle_, World::CREATE);
 }
 
 CollisionEnvDistanceField::~CollisionEnvDistanceField()
@@ -1408,6 +1424,7 @@ void CollisionEnvDistanceField::checkCollision(const CollisionRequest& req, Coll
     getEnvironmentCollisions(req, res, distance_field_cache_entry_world_->distance_field_, gsr);
   }
 
+  std::scoped_lock slock(last_gsr_lock_);
   (const_cast<CollisionEnvDistanceField*>(this))->last_gsr_ = gsr;
 }
 
@@ -1441,9 +1458,108 @@ void CollisionEnvDistanceField::checkCollision(const CollisionRequest& req, Coll
     getEnvironmentCollisions(req, res, distance_field_cache_entry_world_->distance_field_, gsr);
   }
 
+  std::scoped_lock slock(last_gsr_lock_);
   (const_cast<CollisionEnvDistanceField*>(this))->last_gsr_ = gsr;
 }
 
+std::size_t
+CollisionEnvDistanceField::checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                               const std::vector<const moveit::core::RobotState*>& states) const
+{
+  return checkCollisionBatchHelper(req, in_collision, states, nullptr);
+}
+
+std::size_t CollisionEnvDistanceField::checkCollisionBatch(const CollisionRequest& req, std::vector<bool>& in_collision,
+                                                          const std::vector<const moveit::core::RobotState*>& states,
+                                                          const AllowedCollisionMatrix& acm) const
+{
+  return checkCollisionBatchHelper(req, in_collision, states, &acm);
+}
+
+std::size_t CollisionEnvDistanceField::checkCollisionBatchHelper(
+    const CollisionRequest& req, std::vector<bool>& in_collision,
+    const std::vector<const moveit::core::RobotState*>& states, const AllowedCollisionMatrix* acm) const
+{
+  in_collision.assign(states.size(), false);
+  if (states.empty())
+    return 0;
+
+  // only the collision flag is reported
+  CollisionRequest batch_req = req;
+  batch_req.contacts = false;
+  batch_req.distance = false;
+  batch_req.cost = false;
+
+  // the cache entry is generated once, every thread poses the spheres of its own copy of the representation
+  GroupStateRepresentationPtr first_gsr;
+  generateCollisionCheckingStructures(batch_req.group_name, *states[0], acm, first_gsr, true);
+  const DistanceFieldCacheEntryConstPtr dfce = first_gsr->dfce_;
+  const distance_field::DistanceFieldConstPtr env_distance_field = distance_field_cache_entry_world_->distance_field_;
+
+  // 0 not checked yet, 1 free, 2 in collision
+  std::vector<char> results(states.size(), 0);
+  std::atomic<std::size_t> next{ 0 };
+  const std::size_t chunk_size = 16;
+  const auto check_states = [&] {
+    auto gsr = std::make_shared<GroupStateRepresentation>(*first_gsr);
+    for (PosedDistanceFieldPtr& link_distance_field : gsr->link_distance_fields_)
+    {
+      if (link_distance_field)
+        link_distance_field = std::make_shared<PosedDistanceField>(*link_distance_field);
+    }
+
+    for (std::size_t begin = next.fetch_add(chunk_size); begin < states.size(); begin = next.fetch_add(chunk_size))
+    {
+      for (std::size_t i = begin; i < std::min(begin + chunk_size, states.size()); ++i)
+      {
+        if (!compareCacheEntryToState(dfce, *states[i]))
+          continue;
+        updateGroupStateRepresentationState(*states[i], gsr);
+        CollisionResult res;
+        bool done = getSelfCollisions(batch_req, res, gsr);
+        if (!done)
+          done = getIntraGroupCollisions(batch_req, res, gsr);
+        if (!done)
+          getEnvironmentCollisions(batch_req, res, env_distance_field, gsr);
+        results[i] = res.collision ? 2 : 1;
+      }
+    }
+  };
+
+  const std::size_t thread_count =
+      std::min<std::size_t>(batch_threads_ ? batch_threads_ : std::max(1u, std::thread::hardware_concurrency()),
+                            (states.size() + chunk_size - 1) / chunk_size);
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (std::size_t t = 1; t < thread_count; ++t)
+    threads.emplace_back(check_states);
+  check_states();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < states.size(); ++i)
+  {
+    if (!results[i])
+    {
+      // needs distance fields of its own
+      CollisionResult res;
+      GroupStateRepresentationPtr gsr;
+      if (acm)
+        checkCollision(batch_req, res, *states[i], *acm, gsr);
+      else
+        checkCollision(batch_req, res, *states[i], gsr);
+      results[i] = res.collision ? 2 : 1;
+    }
+    if (results[i] == 2)
+    {
+      in_collision[i] = true;
+      ++count;
+    }
+  }
+  return count;
+}
+
 void CollisionEnvDistanceField::checkRobotCollision(const CollisionRequest& req, CollisionResult& res,
                                                     const moveit::core::RobotState& state) const
 {
@@ -1465,6 +1581,7 @@ void CollisionEnvDistanceField::checkRobotCollision(const CollisionRequest& req,
     updateGroupStateRepresentationState(state, gsr);
   }
   getEnvironmentCollisions(req, res, env_distance_field, gsr);
+  std::scoped_lock slock(last_gsr_lock_);
   (const_cast<CollisionEnvDistanceField*>(this))->last_gsr_ = gsr;
 
   // checkRobotCollisionHelper(req, res, robot, state, &acm);
@@ -1494,6 +1611,7 @@ void CollisionEnvDistanceField::checkRobotCollision(const CollisionRequest& req,
     updateGroupStateRepresentationState(state, gsr);
   }
   getEnvironmentCollisions(req, res, env_distance_field, gsr);
+  std::scoped_lock slock(last_gsr_lock_);
   (const_cast<CollisionEnvDistanceField*>(this))->last_gsr_ = gsr;
 
   // checkRobotCollisionHelper(req, res, robot, state, &acm);
@@ -1534,6 +1652,7 @@ void CollisionEnvDistanceField::getCollisionGradients(const CollisionRequest& re
   getIntraGroupProximityGradients(gsr);
   getEnvironmentProximityGradients(env_distance_field, gsr);
 
+  std::scoped_lock slock(last_gsr_lock_);
   (const_cast<CollisionEnvDistanceField*>(this))->last_gsr_ = gsr;
 }
 
@@ -1555,6 +1674,7 @@ void CollisionEnvDistanceField::getAllCollisions(const CollisionRequest& req, Co
   distance_field::DistanceFieldConstPtr env_distance_field = distance_field_cache_entry_world_->distance_field_;
   getEnvironmentCollisions(req, res, env_distance_field, gsr);
 
+  std::scoped_lock slock(last_gsr_lock_);
   (const_cast<CollisionEnvDistanceField*>(this))->last_gsr_ = gsr;
 }
 
@@ -1701,6 +1821,32 @@ void CollisionEnvDistanceField::setWorld(const WorldPtr& world)
   getWorld()->notifyObserverAllObjects(observer_handle_, World::CREATE);
 }
 
+void CollisionEnvDistanceField::setPropagationThreads(unsigned int threads)
+{
+  propagation_threads_ = threads;
+  if (!distance_field_cache_entry_world_)
+    return;
+
+  auto world_distance_field = std::dynamic_pointer_cast<distance_field::PropagationDistanceField>(
+      distance_field_cache_entry_world_->distance_field_);
+  if (world_distance_field)
+    world_distance_field->setPropagationThreads(threads);
+  auto sparse_distance_field = std::dynamic_pointer_cast<distance_field::SparseDistanceField>(
+      distance_field_cache_entry_world_->distance_field_);
+  if (sparse_distance_field)
+    sparse_distance_field->setThreads(threads);
+}
+
+void CollisionEnvDistanceField::setSparseWorldDistanceField(bool sparse)
+{
+  if (sparse == sparse_world_distance_field_)
+    return;
+
+  sparse_world_distance_field_ = sparse;
+  std::scoped_lock slock(update_cache_lock_world_);
+  distance_field_cache_entry_world_ = generateDistanceFieldCacheEntryWorld();
+}
+
 void CollisionEnvDistanceField::notifyObjectChange(const ObjectConstPtr& obj, World::Action action)
 {
   rclcpp::Clock clock;
@@ -1714,10 +1860,10 @@ void CollisionEnvDistanceField::notifyObjectChange(const ObjectConstPtr& obj, Wo
   {
     distance_field_cache_entry_world_->distance_field_->removePointsFromField(subtract_points);
   }
-  else if (action & (World::MOVE_SHAPE | World::REMOVE_SHAPE))
+  else if (action & (World::MOVE_SHAPE | World::UPDATE_SHAPE | World::REMOVE_SHAPE))
   {
-    distance_field_cache_entry_world_->distance_field_->removePointsFromField(subtract_points);
-    distance_field_cache_entry_world_->distance_field_->addPointsToField(add_points);
+    // only the voxels that changed are propagated, e.g. the few cells of an octomap update
+    distance_field_cache_entry_world_->distance_field_->updatePointsInField(subtract_points, add_points);
   }
   else
   {
@@ -1770,11 +1916,13 @@ void CollisionEnvDistanceField::updateDistanceObject(const std::string& id, Dist
     }
 
     dfce->posed_body_point_decompositions_[id] = shape_points;
+    dfce->objects_[id] = object;
   }
   else
   {
     RCLCPP_DEBUG(LOGGER, "Removing Object '%s' from CollisionEnvDistanceField", id.c_str());
     dfce->posed_body_point_decompositions_.erase(id);
+    dfce->objects_.erase(id);
   }
 }
 
@@ -1782,9 +1930,18 @@ CollisionEnvDistanceField::DistanceFieldCacheEntryWorldPtr
 CollisionEnvDistanceField::generateDistanceFieldCacheEntryWorld()
 {
   DistanceFieldCacheEntryWorldPtr dfce = std::make_shared<DistanceFieldCacheEntryWorld>();
-  dfce->distance_field_ = std::make_shared<distance_field::PropagationDistanceField>(
-      size_.x(), size_.y(), size_.z(), resolution_, origin_.x() - 0.5 * size_.x(), origin_.y() - 0.5 * size_.y(),
-      origin_.z() - 0.5 * size_.z(), max_propogation_distance_, use_signed_distance_field_);
+  if (sparse_world_distance_field_)
+  {
+    dfce->distance_field_ = std::make_shared<distance_field::SparseDistanceField>(
+        size_.x(), size_.y(), size_.z(), resolution_, origin_.x() - 0.5 * size_.x(), origin_.y() - 0.5 * size_.y(),
+        origin_.z() - 0.5 * size_.z(), max_propogation_distance_, use_signed_distance_field_, propagation_threads_);
+  }
+  else
+  {
+    dfce->distance_field_ = std::make_shared<distance_field::PropagationDistanceField>(
+        size_.x(), size_.y(), size_.z(), resolution_, origin_.x() - 0.5 * size_.x(), origin_.y() - 0.5 * size_.y(),
+        origin_.z() - 0.5 * size_.z(), max_propogation_distance_, use_signed_distance_field_, propagation_threads_);
+  }
 
   EigenSTL::vector_Vector3d add_points;
   EigenSTL::vector_Vector3d subtract_points;
@@ -1795,4 +1952,107 @@ CollisionEnvDistanceField::generateDistanceFieldCacheEntryWorld()
   dfce->distance_field_->addPointsToField(add_points);
   return dfce;
 }
+
+CollisionEnvDistanceField::DistanceFieldCacheEntryWorldPtr
+CollisionEnvDistanceField::generateDistanceFieldCacheEntryWorld(const DistanceFieldCacheEntryWorld& other)
+{
+  distance_field::DistanceFieldPtr distance_field;
+  if (sparse_world_distance_field_)
+  {
+    auto other_distance_field =
+        std::dynamic_pointer_cast<const distance_field::SparseDistanceField>(other.distance_field_);
+    if (other_distance_field)
+    {
+      auto sparse_distance_field = std::make_shared<distance_field::SparseDistanceField>(*other_distance_field);
+      sparse_distance_field->setThreads(propagation_threads_);
+      distance_field = sparse_distance_field;
+    }
+  }
+  else
+  {
+    auto other_distance_field =
+        std::dynamic_pointer_cast<const distance_field::PropagationDistanceField>(other.distance_field_);
+    if (other_distance_field)
+    {
+      auto propagation_distance_field =
+          std::make_shared<distance_field::PropagationDistanceField>(*other_distance_field);
+      propagation_distance_field->setPropagationThreads(propagation_threads_);
+      distance_field = propagation_distance_field;
+    }
+  }
+  if (!distance_field)
+    return generateDistanceFieldCacheEntryWorld();
+
+  DistanceFieldCacheEntryWorldPtr dfce = std::make_shared<DistanceFieldCacheEntryWorld>();
+  dfce->posed_body_point_decompositions_ = other.posed_body_point_decompositions_;
+  dfce->objects_ = other.objects_;
+  dfce->distance_field_ = distance_field;
+
+  // objects are copied on write, so pointer equality means unchanged, except for octrees that are updated in place
+  auto is_unchanged = [](const World::ObjectConstPtr& a, const World::ObjectConstPtr& b) {
+    return a == b && std::none_of(a->shapes_.begin(), a->shapes_.end(),
+                                  [](const shapes::ShapeConstPtr& shape) { return shape->type == shapes::OCTREE; });
+  };
+
+  std::vector<std::string> changed_ids;
+  for (const std::pair<const std::string, ObjectPtr>& object : *getWorld())
+  {
+    const auto it = dfce->objects_.find(object.first);
+    if (it == dfce->objects_.end() || !is_unchanged(it->second, object.second))
+      changed_ids.push_back(object.first);
+  }
+  for (const std::pair<const std::string, World::ObjectConstPtr>& object : other.objects_)
+  {
+    if (!getWorld()->hasObject(object.first))
+      changed_ids.push_back(object.first);
+  }
+
+  EigenSTL::vector_Vector3d add_points;
+  EigenSTL::vector_Vector3d subtract_points;
+  for (const std::string& id : changed_ids)
+    updateDistanceObject(id, dfce, add_points, subtract_points);
+  RCLCPP_DEBUG(LOGGER, "Reusing world distance field, updating %zu of %zu objects", changed_ids.size(),
+               getWorld()->size());
+
+  if (!subtract_points.empty())
+    dfce->distance_field_->updatePointsInField(subtract_points, add_points);
+  else if (!add_points.empty())
+    dfce->distance_field_->addPointsToField(add_points);
+  return dfce;
+}
+
+void CollisionEnvDistanceField::addMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  CollisionEnv::addMemoryUsage(usage);
+  usage.add("collision_env", sizeof(CollisionEnvDistanceField));
+  for (const BodyDecompositionConstPtr& decomposition : link_body_decomposition_vector_)
+  {
+    if (decomposition && usage.visit(decomposition.get()))
+    {
+      usage.add("collision_env", sizeof(BodyDecomposition) +
+                                     sizeof(CollisionSphere) * decomposition->getCollisionSpheres().size() +
+                                     sizeof(Eigen::Vector3d) * decomposition->getCollisionPoints().size());
+    }
+  }
+
+  auto add_distance_field = [&usage](const distance_field::DistanceFieldConstPtr& distance_field) {
+    if (distance_field && usage.visit(distance_field.get()))
+      usage.add("distance_field", distance_field->getMemoryBytes());
+  };
+  {
+    std::scoped_lock slock(update_cache_lock_);
+    if (distance_field_cache_entry_)
+      add_distance_field(distance_field_cache_entry_->distance_field_);
+    for (const auto& gsr : pregenerated_group_state_representation_map_)
+    {
+      if (gsr.second->dfce_)
+        add_distance_field(gsr.second->dfce_->distance_field_);
+    }
+  }
+  {
+    std::scoped_lock slock(update_cache_lock_world_);
+    if (distance_field_cache_entry_world_)
+      add_distance_field(distance_field_cache_entry_world_->distance_field_);
+  }
+}
 }  // namespace collision_detection
@@ -41,15 +41,34 @@ namespace collision_detection
 {
 const std::string collision_detection::CollisionDetectorAllocatorHybrid::NAME("HYBRID");
 
+CollisionEnvPtr CachingCollisionDetectorAllocatorHybrid::allocateEnv(
+    const WorldPtr& world, const moveit::core::RobotModelConstPtr& robot_model) const
+{
+  std::scoped_lock slock(cache_lock_);
+  std::shared_ptr<CollisionEnvHybrid> env;
+  if (last_env_ && last_env_->getRobotModel() == robot_model)
+  {
+    env = std::make_shared<CollisionEnvHybrid>(*last_env_, world);
+    // start without padding, like a newly constructed environment
+    env->setPadding(0.0);
+    env->setScale(1.0);
+  }
+  else
+    env = std::make_shared<CollisionEnvHybrid>(robot_model, world);
+  last_env_ = env;
+  return env;
+}
+
 CollisionEnvHybrid::CollisionEnvHybrid(
     const moveit::core::RobotModelConstPtr& robot_model,
     const std::map<std::string, std::vector<CollisionSphere>>& link_body_decompositions, double size_x, double size_y,
     double size_z, const Eigen::Vector3d& origin, bool use_signed_distance_field, double resolution,
-    double collision_tolerance, double max_propogation_distance, double padding, double scale)
+    double collision_tolerance, double max_propogation_distance, double padding, double scale,
+    bool sparse_world_distance_field)
   : CollisionEnvFCL(robot_model)
   , cenv_distance_(std::make_shared<collision_detection::CollisionEnvDistanceField>(
         robot_model, getWorld(), link_body_decompositions, size_x, size_y, size_z, origin, use_signed_distance_field,
-        resolution, collision_tolerance, max_propogation_distance, padding, scale))
+        resolution, collision_tolerance, max_propogation_distance, padding, scale, sparse_world_distance_field))
 {
 }
 
@@ -57,11 +76,12 @@ CollisionEnvHybrid::CollisionEnvHybrid(
     const moveit::core::RobotModelConstPtr& robot_model, const WorldPtr& world,
     const std::map<std::string, std::vector<CollisionSphere>>& link_body_decompositions, double size_x, double size_y,
     double size_z, const Eigen::Vector3d& origin, bool use_signed_distance_field, double resolution,
-    double collision_tolerance, double max_propogation_distance, double padding, double scale)
+    double collision_tolerance, double max_propogation_distance, double padding, double scale,
+    bool sparse_world_distance_field)
   : CollisionEnvFCL(robot_model, world, padding, scale)
   , cenv_distance_(std::make_shared<collision_detection::CollisionEnvDistanceField>(
         robot_model, getWorld(), link_body_decompositions, size_x, size_y, size_z, origin, use_signed_distance_field,
-        resolution, collision_tolerance, max_propogation_distance, padding, scale))
+        resolution, collision_tolerance, max_propogation_distance, padding, scale, sparse_world_distance_field))
 {
 }
 
@@ -182,4 +202,10 @@ void CollisionEnvHybrid::getAllCollisions(const CollisionRequest& req, Collision
 {
   cenv_distance_->getAllCollisions(req, res, state, acm, gsr);
 }
+
+void CollisionEnvHybrid::addMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  CollisionEnvFCL::addMemoryUsage(usage);
+  cenv_distance_->getMemoryUsage(usage);
+}
 }  // namespace collision_detection
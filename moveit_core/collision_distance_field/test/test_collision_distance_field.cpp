@@ -42,6 +42,7 @@
 #include <moveit/utils/robot_model_test_utils.h>
 
 #include <geometric_shapes/shape_operations.h>
+#include <octomap/octomap.h>
 #include <urdf_parser/urdf_parser.h>
 
 #include <fstream>
@@ -330,6 +331,134 @@ TEST_F(DistanceFieldCollisionDetectionTester, AttachedBodyTester)
   ASSERT_TRUE(res.collision);
 }
 
+TEST_F(DistanceFieldCollisionDetectionTester, CopyUpdatesChangedObjects)
+{
+  collision_detection::CollisionRequest req;
+  req.group_name = "right_arm";
+
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.update();
+
+  Eigen::Isometry3d pos1 = Eigen::Isometry3d::Identity();
+  pos1.translation().x() = 1.0;
+  robot_state.updateStateWithLinkAt("r_gripper_palm_link", pos1);
+
+  cenv_->getWorld()->addToObject("box", std::make_shared<const shapes::Box>(.25, .25, .25), pos1);
+  collision_detection::CollisionResult res;
+  cenv_->checkRobotCollision(req, res, robot_state, *acm_);
+  ASSERT_TRUE(res.collision);
+
+  // a copy for an identical world reuses the distance field as is
+  auto same_world = std::make_shared<collision_detection::World>(*cenv_->getWorld());
+  DefaultCEnvType same_cenv(static_cast<const DefaultCEnvType&>(*cenv_), same_world);
+  res = collision_detection::CollisionResult();
+  same_cenv.checkRobotCollision(req, res, robot_state, *acm_);
+  EXPECT_TRUE(res.collision);
+
+  // objects moved before copying are updated in the copy only
+  auto moved_world = std::make_shared<collision_detection::World>(*cenv_->getWorld());
+  Eigen::Isometry3d pos2 = Eigen::Isometry3d::Identity();
+  pos2.translation().y() = 1.0;
+  moved_world->setObjectPose("box", pos2);
+  DefaultCEnvType moved_cenv(static_cast<const DefaultCEnvType&>(*cenv_), moved_world);
+  res = collision_detection::CollisionResult();
+  moved_cenv.checkRobotCollision(req, res, robot_state, *acm_);
+  EXPECT_FALSE(res.collision);
+
+  res = collision_detection::CollisionResult();
+  cenv_->checkRobotCollision(req, res, robot_state, *acm_);
+  EXPECT_TRUE(res.collision);
+}
+
+TEST_F(DistanceFieldCollisionDetectionTester, OctomapUpdatedInPlace)
+{
+  collision_detection::CollisionRequest req;
+  req.group_name = "right_arm";
+
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.update();
+
+  Eigen::Isometry3d pos1 = Eigen::Isometry3d::Identity();
+  pos1.translation().x() = 1.0;
+  robot_state.updateStateWithLinkAt("r_gripper_palm_link", pos1);
+
+  // octomap updaters modify the octree in place and only notify the world
+  auto octree = std::make_shared<octomap::OcTree>(0.05);
+  const auto fill = [&octree] {
+    for (double x = 0.9; x < 1.1; x += 0.05)
+    {
+      for (double y = -0.1; y < 0.1; y += 0.05)
+      {
+        for (double z = -0.1; z < 0.1; z += 0.05)
+          octree->updateNode(octomap::point3d(x, y, z), true);
+      }
+    }
+  };
+  fill();
+  cenv_->getWorld()->addToObject("octomap", std::make_shared<const shapes::OcTree>(octree),
+                                 Eigen::Isometry3d::Identity());
+  collision_detection::CollisionResult res;
+  cenv_->checkRobotCollision(req, res, robot_state, *acm_);
+  EXPECT_TRUE(res.collision);
+
+  octree->clear();
+  cenv_->getWorld()->notifyShapesUpdated("octomap");
+  res = collision_detection::CollisionResult();
+  cenv_->checkRobotCollision(req, res, robot_state, *acm_);
+  EXPECT_FALSE(res.collision);
+
+  fill();
+  cenv_->getWorld()->notifyShapesUpdated("octomap");
+  res = collision_detection::CollisionResult();
+  cenv_->checkRobotCollision(req, res, robot_state, *acm_);
+  EXPECT_TRUE(res.collision);
+}
+
+TEST_F(DistanceFieldCollisionDetectionTester, CollisionBatch)
+{
+  collision_detection::CollisionRequest req;
+  req.group_name = "right_arm";
+
+  Eigen::Isometry3d box_pose = Eigen::Isometry3d::Identity();
+  box_pose.translation().x() = 1.0;
+  cenv_->getWorld()->addToObject("box", std::make_shared<const shapes::Box>(.25, .25, .25), box_pose);
+
+  // every third state has the gripper in the box
+  std::vector<moveit::core::RobotState> states(50, moveit::core::RobotState(robot_model_));
+  std::vector<const moveit::core::RobotState*> state_ptrs;
+  for (std::size_t i = 0; i < states.size(); ++i)
+  {
+    states[i].setToDefaultValues();
+    states[i].setVariablePosition("r_shoulder_pan_joint", -0.5 + 0.02 * i);
+    states[i].update();
+    if (i % 3 == 0)
+      states[i].updateStateWithLinkAt("r_gripper_palm_link", box_pose);
+    state_ptrs.push_back(&states[i]);
+  }
+
+  auto& cenv = static_cast<DefaultCEnvType&>(*cenv_);
+  for (unsigned int threads : { 1u, 4u })
+  {
+    cenv.setBatchThreads(threads);
+    std::vector<bool> in_collision;
+    std::size_t count = cenv.checkCollisionBatch(req, in_collision, state_ptrs, *acm_);
+    ASSERT_EQ(in_collision.size(), states.size());
+
+    std::size_t expected_count = 0;
+    for (std::size_t i = 0; i < states.size(); ++i)
+    {
+      collision_detection::CollisionResult res;
+      cenv.checkCollision(req, res, states[i], *acm_);
+      EXPECT_EQ(in_collision[i], res.collision) << "state " << i;
+      expected_count += res.collision;
+    }
+    EXPECT_EQ(count, expected_count);
+    EXPECT_GE(count, 17u);
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
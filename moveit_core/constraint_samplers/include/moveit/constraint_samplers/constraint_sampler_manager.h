@@ -37,10 +37,14 @@
 #pragma once
 
 #include <moveit/constraint_samplers/constraint_sampler_allocator.h>
+#include <moveit/constraint_samplers/reachability_map.h>
 #include <moveit/macros/class_forward.h>
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp/clock.hpp>
 #include <rclcpp/duration.hpp>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace constraint_samplers
 {
@@ -75,6 +79,17 @@ public:
   {
     sampler_alloc_.push_back(sa);
   }
+  /**
+   * \brief Sets the reachability map of a group
+   *
+   * IK samplers that \ref selectSampler creates for the group, also as
+   * part of a UnionConstraintSampler, are given this map.
+   *
+   * @param group_name The group the map was generated for
+   * @param map The map, or an empty pointer to remove the map of the group
+   */
+  void setReachabilityMap(const std::string& group_name, const ReachabilityMapConstPtr& map);
+
   /**
    * \brief Selects among the potential sampler allocators.
    *
@@ -94,6 +109,32 @@ public:
   ConstraintSamplerPtr selectSampler(const planning_scene::PlanningSceneConstPtr& scene, const std::string& group_name,
                                      const moveit_msgs::msg::Constraints& constr) const;
 
+  /**
+   * \brief Draws several samples for the same constraints in parallel
+   *
+   * Each thread samples with its own sampler from \ref selectSampler,
+   * which has its own random number generator, and into its own robot
+   * state. Samplers are not split further: a UnionConstraintSampler
+   * still runs its member samplers in order, as later ones may depend
+   * on earlier ones. The kinematics solvers used by IK samplers must be
+   * safe to call concurrently.
+   *
+   * @param scene The planning scene that will be passed into the constraint samplers
+   * @param group_name The group name for which to allocate the constraint samplers
+   * @param constr The constraints
+   * @param reference_state The state the samples start from, also used for transforms
+   * @param count The number of samples wanted
+   * @param max_attempts The total number of sample() calls, over all threads
+   * @param [out] samples The samples found, at most \e count, in the order they were found
+   * @param num_threads The number of threads to sample with, or 0 for the number of hardware threads
+   *
+   * @return The number of samples found
+   */
+  std::size_t sampleMany(const planning_scene::PlanningSceneConstPtr& scene, const std::string& group_name,
+                         const moveit_msgs::msg::Constraints& constr, const moveit::core::RobotState& reference_state,
+                         std::size_t count, std::size_t max_attempts, std::vector<moveit::core::RobotState>& samples,
+                         unsigned int num_threads = 0) const;
+
   /**
    * \brief Default logic to select a ConstraintSampler given a
    * constraints message.
@@ -142,7 +183,11 @@ public:
                                                    const moveit_msgs::msg::Constraints& constr);
 
 private:
+  /** \brief Give the IK samplers in \e sampler the reachability maps of their groups */
+  void applyReachabilityMaps(const ConstraintSamplerPtr& sampler) const;
+
   std::vector<ConstraintSamplerAllocatorPtr>
       sampler_alloc_; /**< \brief Holds the constraint sampler allocators, which will be tested in order  */
+  std::map<std::string, ReachabilityMapConstPtr> reachability_maps_; /**< \brief The reachability maps by group */
 };
 }  // namespace constraint_samplers
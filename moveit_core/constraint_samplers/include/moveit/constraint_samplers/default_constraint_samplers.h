@@ -37,6 +37,7 @@
 #pragma once
 
 #include <moveit/constraint_samplers/constraint_sampler.h>
+#include <moveit/constraint_samplers/reachability_map.h>
 #include <moveit/macros/class_forward.h>
 #include <random_numbers/random_numbers.h>
 #include <rclcpp/rclcpp.hpp>
@@ -418,6 +419,27 @@ public:
     ik_timeout_ = timeout;
   }
 
+  /**
+   * \brief Sets a reachability map for the group of this sampler
+   *
+   * The map is used if it was generated for this group and for the
+   * base and tip frames of its IK solver. Sampled poses outside the
+   * reachable workspace are then redrawn without calling IK, and IK
+   * is seeded with the stored state whose tip orientation is closest
+   * to the sampled one.
+   *
+   * @param map The map, or an empty pointer to sample without one
+   */
+  void setReachabilityMap(const ReachabilityMapConstPtr& map)
+  {
+    reachability_map_ = map;
+  }
+
+  const ReachabilityMapConstPtr& getReachabilityMap() const
+  {
+    return reachability_map_;
+  }
+
   /**
    * \brief Gets the position constraint associated with this sampler.
    *
@@ -540,16 +562,20 @@ protected:
    * @param timeout The timeout for the IK search
    * @param jsg The joint state group into which to place the solution
    * @param use_as_seed If true, the state values in jsg are used as seed for the IK
+   * @param group_seed If set, these group variable values are used as seed for the IK instead
    *
    * @return True if IK returns successfully with the timeout, and otherwise false.
    */
   bool callIK(const geometry_msgs::msg::Pose& ik_query,
               const kinematics::KinematicsBase::IKCallbackFn& adapted_ik_validity_callback, double timeout,
-              moveit::core::RobotState& state, bool use_as_seed);
+              moveit::core::RobotState& state, bool use_as_seed, const std::vector<double>* group_seed = nullptr);
   bool sampleHelper(moveit::core::RobotState& state, const moveit::core::RobotState& reference_state,
                     unsigned int max_attempts);
   bool validate(moveit::core::RobotState& state) const;
 
+  /** \brief True if the reachability map was generated for this group and the frames of its IK solver */
+  bool reachabilityMapMatches() const;
+
   random_numbers::RandomNumberGenerator random_number_generator_; /**< \brief Random generator used by the sampler */
   IKSamplingPose sampling_pose_;                                  /**< \brief Holder for the pose used for sampling */
   kinematics::KinematicsBaseConstPtr kb_;                         /**< \brief Holds the kinematics solver */
@@ -560,5 +586,6 @@ protected:
   bool need_eef_to_ik_tip_transform_; /**< \brief True if the tip frame of the inverse kinematic is different than the
                                         frame of the end effector */
   Eigen::Isometry3d eef_to_ik_tip_transform_; /**< \brief Holds the transformation from end effector to IK tip frame */
+  ReachabilityMapConstPtr reachability_map_;  /**< \brief The reachability map used for sampling poses, if any */
 };
 }  // namespace constraint_samplers
@@ -0,0 +1,194 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/robot_state/robot_state.h>
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+class MappedFile;
+}
+}  // namespace moveit
+
+namespace constraint_samplers
+{
+MOVEIT_CLASS_FORWARD(ReachabilityMap);  // Defines ReachabilityMapPtr, ConstPtr, WeakPtr... etc
+
+/**
+ * \brief A voxelized map of the workspace of a joint model group, used
+ * by the IKConstraintSampler to skip unreachable poses and to seed IK.
+ *
+ * The map covers the poses of a tip link relative to a base link (the
+ * frames of the group's IK solver). It is generated offline by forward
+ * kinematics of random group states: each voxel stores how often the
+ * tip landed in it, and up to a fixed number of those states together
+ * with the tip orientation they reached. A voxel that was never hit is
+ * considered unreachable, so the map should be generated with enough
+ * samples that every reachable voxel is hit at least once.
+ *
+ * Maps are stored in a binary file that is memory-mapped on load, so
+ * all processes planning for the same robot share one copy.
+ */
+class ReachabilityMap
+{
+public:
+  /** \brief Validity check for the sampled states, e.g. a self-collision check. Invalid states are not recorded. */
+  using StateValidityFn = std::function<bool(const moveit::core::RobotState& state)>;
+
+  ~ReachabilityMap();
+
+  ReachabilityMap(const ReachabilityMap&) = delete;
+  ReachabilityMap& operator=(const ReachabilityMap&) = delete;
+
+  /**
+   * \brief Generate a map for a group by forward kinematics of random states
+   *
+   * @param model The robot model
+   * @param group_name The group whose variables are sampled
+   * @param base_frame The link the tip poses are expressed in, usually the base frame of the group's IK solver
+   * @param tip_frame The link whose poses are recorded, usually the tip frame of the group's IK solver
+   * @param resolution The edge length of the voxels
+   * @param num_samples The number of random states to sample
+   * @param seeds_per_voxel The maximum number of states stored per voxel
+   * @param validity_fn If set, only states it accepts are recorded
+   * @param rng_seed The seed of the random state sampler
+   *
+   * @return The map, or nullptr if the group or frames are not part of the model or the arguments are invalid
+   */
+  static ReachabilityMapPtr generate(const moveit::core::RobotModelConstPtr& model, const std::string& group_name,
+                                     const std::string& base_frame, const std::string& tip_frame, double resolution,
+                                     std::size_t num_samples, unsigned int seeds_per_voxel = 4,
+                                     const StateValidityFn& validity_fn = {}, unsigned int rng_seed = 0);
+
+  /**
+   * \brief Load a map stored with save()
+   *
+   * @return The map, or nullptr if the file is missing or corrupt, or was generated for a group with other variables
+   */
+  static ReachabilityMapPtr load(const std::string& filename, const moveit::core::JointModelGroup* jmg);
+
+  /** \brief Store the map in \e filename. The file is replaced atomically. */
+  bool save(const std::string& filename) const;
+
+  const std::string& getGroupName() const
+  {
+    return group_name_;
+  }
+
+  const std::string& getBaseFrame() const
+  {
+    return base_frame_;
+  }
+
+  const std::string& getTipFrame() const
+  {
+    return tip_frame_;
+  }
+
+  double getResolution() const
+  {
+    return resolution_;
+  }
+
+  /** \brief The number of voxels in which at least one sample landed */
+  std::size_t getReachableVoxelCount() const;
+
+  /** \brief True if the voxel containing \e position (in the base frame) was reached by any sample */
+  bool isReachable(const Eigen::Vector3d& position) const;
+
+  /**
+   * \brief Get an IK seed for a tip pose
+   *
+   * Among the states stored for the voxel containing \e position,
+   * picks the one whose tip orientation is closest to \e orientation.
+   *
+   * @param [in] position The tip position in the base frame
+   * @param [in] orientation The tip orientation in the base frame
+   * @param [out] values The group variable values of the seed, in the order of the group variables
+   *
+   * @return False if the voxel is unreachable
+   */
+  bool getSeed(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation,
+               std::vector<double>& values) const;
+
+private:
+  ReachabilityMap() = default;
+
+  /** \brief Index of the voxel containing \e position, or -1 if it is outside the map */
+  long voxelIndex(const Eigen::Vector3d& position) const;
+
+  std::size_t voxelCount() const
+  {
+    return static_cast<std::size_t>(dims_[0]) * dims_[1] * dims_[2];
+  }
+
+  /** \brief The number of floats stored per seed: the tip orientation followed by the group variables */
+  std::size_t seedSize() const
+  {
+    return 4 + variable_count_;
+  }
+
+  /** \brief The size of the voxel arrays in the file layout */
+  std::size_t dataSize() const;
+
+  /** \brief Point hit_counts_ and seeds_ into \e data, which holds the voxel arrays in the file layout */
+  void setData(const char* data);
+
+  std::string group_name_;
+  std::string base_frame_;
+  std::string tip_frame_;
+  std::uint64_t key_{ 0 };
+  double resolution_{ 0.0 };
+  Eigen::Vector3d origin_{ Eigen::Vector3d::Zero() };
+  std::uint32_t dims_[3] = { 0, 0, 0 };
+  std::uint32_t variable_count_{ 0 };
+  std::uint32_t seeds_per_voxel_{ 0 };
+
+  // a generated map owns its voxel arrays in buffer_, a loaded map points into the mapped file
+  std::vector<char> buffer_;
+  std::unique_ptr<moveit::core::MappedFile> file_;
+  const std::uint32_t* hit_counts_{ nullptr };
+  const float* seeds_{ nullptr };
+};
+}  // namespace constraint_samplers
@@ -37,9 +37,14 @@
 #include <moveit/constraint_samplers/constraint_sampler_manager.h>
 #include <moveit/constraint_samplers/default_constraint_samplers.h>
 #include <moveit/constraint_samplers/union_constraint_sampler.h>
+#include <moveit/utils/worker_pool.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 namespace constraint_samplers
 {
@@ -56,7 +61,85 @@ ConstraintSamplerPtr ConstraintSamplerManager::selectSampler(const planning_scen
   }
 
   // if no default sampler was used, try a default one
-  return selectDefaultSampler(scene, group_name, constr);
+  ConstraintSamplerPtr sampler = selectDefaultSampler(scene, group_name, constr);
+  if (sampler && !reachability_maps_.empty())
+    applyReachabilityMaps(sampler);
+  return sampler;
+}
+
+std::size_t ConstraintSamplerManager::sampleMany(const planning_scene::PlanningSceneConstPtr& scene,
+                                                const std::string& group_name,
+                                                const moveit_msgs::msg::Constraints& constr,
+                                                const moveit::core::RobotState& reference_state, std::size_t count,
+                                                std::size_t max_attempts,
+                                                std::vector<moveit::core::RobotState>& samples,
+                                                unsigned int num_threads) const
+{
+  samples.clear();
+  if (count == 0 || max_attempts == 0)
+    return 0;
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  num_threads = std::min<std::size_t>(num_threads, max_attempts);
+
+  // samplers keep state, so every thread gets its own; they are created here, as allocators need not be thread-safe
+  std::vector<ConstraintSamplerPtr> samplers;
+  for (unsigned int t = 0; t < num_threads; ++t)
+  {
+    ConstraintSamplerPtr sampler = selectSampler(scene, group_name, constr);
+    if (!sampler)
+      break;
+    samplers.push_back(sampler);
+  }
+  if (samplers.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "No constraint sampler for group '%s'", group_name.c_str());
+    return 0;
+  }
+
+  std::atomic<std::size_t> attempts{ 0 };
+  std::atomic<bool> done{ false };
+  std::mutex samples_lock;
+  moveit::core::WorkerPool pool(samplers.size());
+  pool.run(samplers.size(), [&](std::size_t index, unsigned int /*thread*/) {
+    const ConstraintSamplerPtr& sampler = samplers[index];
+    moveit::core::RobotState state(reference_state);
+    while (!done.load(std::memory_order_relaxed) && attempts.fetch_add(1, std::memory_order_relaxed) < max_attempts)
+    {
+      if (!sampler->sample(state, reference_state))
+        continue;
+      state.update();
+      std::lock_guard<std::mutex> guard(samples_lock);
+      if (samples.size() < count)
+        samples.push_back(state);
+      if (samples.size() >= count)
+        done = true;
+    }
+  });
+  return samples.size();
+}
+
+void ConstraintSamplerManager::setReachabilityMap(const std::string& group_name, const ReachabilityMapConstPtr& map)
+{
+  if (map)
+    reachability_maps_[group_name] = map;
+  else
+    reachability_maps_.erase(group_name);
+}
+
+void ConstraintSamplerManager::applyReachabilityMaps(const ConstraintSamplerPtr& sampler) const
+{
+  if (auto ik_sampler = std::dynamic_pointer_cast<IKConstraintSampler>(sampler))
+  {
+    auto it = reachability_maps_.find(ik_sampler->getGroupName());
+    if (it != reachability_maps_.end())
+      ik_sampler->setReachabilityMap(it->second);
+  }
+  else if (auto union_sampler = std::dynamic_pointer_cast<UnionConstraintSampler>(sampler))
+  {
+    for (const ConstraintSamplerPtr& s : union_sampler->getSamplers())
+      applyReachabilityMaps(s);
+  }
 }
 
 ConstraintSamplerPtr ConstraintSamplerManager::selectDefaultSampler(const planning_scene::PlanningSceneConstPtr& scene,
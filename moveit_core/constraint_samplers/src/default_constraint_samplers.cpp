@@ -596,37 +596,54 @@ bool IKConstraintSampler::sampleHelper(moveit::core::RobotState& state, const mo
     };
   }
 
+  const bool use_reachability_map = reachability_map_ && reachabilityMapMatches();
+  std::vector<double> map_seed;
+
   for (unsigned int a = 0; a < max_attempts; ++a)
   {
-    // sample a point in the constraint region
     Eigen::Vector3d point;
     Eigen::Quaterniond quat;  // quat is normalized by contract
-    if (!samplePose(point, quat, reference_state, max_attempts))
-    {
-      if (verbose_)
-        RCLCPP_INFO(LOGGER, "IK constraint sampler was unable to produce a pose to run IK for");
-      return false;
-    }
 
-    // we now have the transform we wish to perform IK for, in the planning frame
-    if (transform_ik_)
+    // with a reachability map, poses the IK tip cannot reach are redrawn without calling IK
+    bool reachable = false;
+    for (unsigned int p = 0; p < max_attempts && !reachable; ++p)
     {
-      // we need to convert this transform to the frame expected by the IK solver
-      // both the planning frame and the frame for the IK are assumed to be robot links
-      Eigen::Isometry3d ikq(Eigen::Translation3d(point) * quat);  // valid isometry by construction
-      // getFrameTransform() returns a valid isometry by contract
-      ikq = reference_state.getFrameTransform(ik_frame_).inverse() * ikq;  // valid isometry * valid isometry
-      point = ikq.translation();
-      quat = Eigen::Quaterniond(ikq.linear());  // ikq is isometry, so quat is normalized
-    }
+      // sample a point in the constraint region
+      if (!samplePose(point, quat, reference_state, max_attempts))
+      {
+        if (verbose_)
+          RCLCPP_INFO(LOGGER, "IK constraint sampler was unable to produce a pose to run IK for");
+        return false;
+      }
+
+      // we now have the transform we wish to perform IK for, in the planning frame
+      if (transform_ik_)
+      {
+        // we need to convert this transform to the frame expected by the IK solver
+        // both the planning frame and the frame for the IK are assumed to be robot links
+        Eigen::Isometry3d ikq(Eigen::Translation3d(point) * quat);  // valid isometry by construction
+        // getFrameTransform() returns a valid isometry by contract
+        ikq = reference_state.getFrameTransform(ik_frame_).inverse() * ikq;  // valid isometry * valid isometry
+        point = ikq.translation();
+        quat = Eigen::Quaterniond(ikq.linear());  // ikq is isometry, so quat is normalized
+      }
+
+      if (need_eef_to_ik_tip_transform_)
+      {
+        // After sampling the pose needs to be transformed to the ik chain tip
+        Eigen::Isometry3d ikq(Eigen::Translation3d(point) * quat);  // valid isometry by construction
+        ikq = ikq * eef_to_ik_tip_transform_;  // eef_to_ik_tip_transform_ is valid isometry (checked in loadIKSolver())
+        point = ikq.translation();
+        quat = Eigen::Quaterniond(ikq.linear());  // ikq is isometry, so quat is normalized
+      }
 
-    if (need_eef_to_ik_tip_transform_)
+      reachable = !use_reachability_map || reachability_map_->getSeed(point, quat, map_seed);
+    }
+    if (!reachable)
     {
-      // After sampling the pose needs to be transformed to the ik chain tip
-      Eigen::Isometry3d ikq(Eigen::Translation3d(point) * quat);  // valid isometry by construction
-      ikq = ikq * eef_to_ik_tip_transform_;  // eef_to_ik_tip_transform_ is valid isometry (checked in loadIKSolver())
-      point = ikq.translation();
-      quat = Eigen::Quaterniond(ikq.linear());  // ikq is isometry, so quat is normalized
+      if (verbose_)
+        RCLCPP_INFO(LOGGER, "IK constraint sampler was unable to produce a reachable pose");
+      continue;
     }
 
     geometry_msgs::msg::Pose ik_query;
@@ -638,12 +655,21 @@ bool IKConstraintSampler::sampleHelper(moveit::core::RobotState& state, const mo
     ik_query.orientation.z = quat.z();
     ik_query.orientation.w = quat.w();
 
-    if (callIK(ik_query, adapted_ik_validity_callback, ik_timeout_, state, a == 0))
+    if (callIK(ik_query, adapted_ik_validity_callback, ik_timeout_, state, a == 0,
+               use_reachability_map ? &map_seed : nullptr))
       return true;
   }
   return false;
 }
 
+bool IKConstraintSampler::reachabilityMapMatches() const
+{
+  const std::string& base_frame = transform_ik_ ? ik_frame_ : jmg_->getParentModel().getModelFrame();
+  return reachability_map_->getGroupName() == jmg_->getName() &&
+         moveit::core::Transforms::sameFrame(reachability_map_->getBaseFrame(), base_frame) &&
+         moveit::core::Transforms::sameFrame(reachability_map_->getTipFrame(), kb_->getTipFrame());
+}
+
 bool IKConstraintSampler::validate(moveit::core::RobotState& state) const
 {
   state.update();
@@ -655,13 +681,18 @@ bool IKConstraintSampler::validate(moveit::core::RobotState& state) const
 
 bool IKConstraintSampler::callIK(const geometry_msgs::msg::Pose& ik_query,
                                  const kinematics::KinematicsBase::IKCallbackFn& adapted_ik_validity_callback,
-                                 double timeout, moveit::core::RobotState& state, bool use_as_seed)
+                                 double timeout, moveit::core::RobotState& state, bool use_as_seed,
+                                 const std::vector<double>* group_seed)
 {
   const std::vector<size_t>& ik_joint_bijection = jmg_->getKinematicsSolverJointBijection();
   std::vector<double> seed(ik_joint_bijection.size(), 0.0);
   std::vector<double> vals;
 
-  if (use_as_seed)
+  if (group_seed)
+  {
+    vals = *group_seed;
+  }
+  else if (use_as_seed)
   {
     state.copyJointGroupPositions(jmg_, vals);
   }
@@ -0,0 +1,391 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/constraint_samplers/reachability_map.h>
+#include <moveit/robot_model/mesh_snapshot.h>
+#include <moveit/utils/mapped_file.h>
+#include <random_numbers/random_numbers.h>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace constraint_samplers
+{
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_constraint_samplers.reachability_map");
+
+namespace
+{
+// Layout of a map file: the header below, the group name, base frame and tip frame (each padded to a multiple of 8
+// bytes), the hit count of each voxel (uint32, padded) and seeds_per_voxel seeds per voxel (float, padded). A seed is
+// the tip orientation quaternion (x, y, z, w) followed by the group variable values. Voxels are ordered x-fastest.
+constexpr char MAP_FILE_MAGIC[8] = { 'M', 'V', 'R', 'E', 'A', 'C', 'H', 'M' };
+constexpr std::uint32_t MAP_FILE_VERSION = 1;
+
+// limits the size of the voxel arrays, so a bad resolution or a corrupt header cannot make us allocate huge arrays
+constexpr std::size_t MAX_VOXELS = std::size_t(1) << 28;
+
+struct MapFileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t variable_count;
+  std::uint64_t key;
+  double resolution;
+  double origin[3];
+  std::uint32_t dims[3];
+  std::uint32_t seeds_per_voxel;
+  std::uint32_t group_name_size;
+  std::uint32_t base_frame_size;
+  std::uint32_t tip_frame_size;
+  std::uint32_t reserved;
+};
+
+std::size_t padded(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+void writePadded(std::ofstream& out, const void* data, std::size_t size)
+{
+  static const char ZEROS[8] = {};
+  out.write(static_cast<const char*>(data), size);
+  out.write(ZEROS, padded(size) - size);
+}
+
+bool readPadded(const moveit::core::MappedFile& file, std::size_t& offset, void* data, std::size_t size)
+{
+  if (file.size() < offset || file.size() - offset < padded(size))
+    return false;
+  memcpy(data, file.begin() + offset, size);
+  offset += padded(size);
+  return true;
+}
+
+// Identifies the group variables the seeds are stored for
+std::uint64_t groupKey(const moveit::core::JointModelGroup* jmg)
+{
+  std::uint64_t key = moveit::core::MeshSnapshot::hashString(jmg->getName());
+  for (const std::string& name : jmg->getVariableNames())
+    key = moveit::core::MeshSnapshot::hashString('\0' + name, key);
+  return key;
+}
+
+std::string stripSlash(const std::string& frame)
+{
+  return !frame.empty() && frame[0] == '/' ? frame.substr(1) : frame;
+}
+
+Eigen::Vector3d tipPosition(const moveit::core::RobotState& state, const moveit::core::LinkModel* base,
+                            const moveit::core::LinkModel* tip, Eigen::Quaterniond* orientation = nullptr)
+{
+  const Eigen::Isometry3d pose = state.getGlobalLinkTransform(base).inverse() * state.getGlobalLinkTransform(tip);
+  if (orientation)
+    *orientation = Eigen::Quaterniond(pose.linear());
+  return pose.translation();
+}
+}  // namespace
+
+ReachabilityMap::~ReachabilityMap() = default;
+
+ReachabilityMapPtr ReachabilityMap::generate(const moveit::core::RobotModelConstPtr& model,
+                                             const std::string& group_name, const std::string& base_frame,
+                                             const std::string& tip_frame, double resolution, std::size_t num_samples,
+                                             unsigned int seeds_per_voxel, const StateValidityFn& validity_fn,
+                                             unsigned int rng_seed)
+{
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(group_name);
+  if (!jmg)
+    return nullptr;
+  const std::string base_name = stripSlash(base_frame);
+  const std::string tip_name = stripSlash(tip_frame);
+  if (!model->hasLinkModel(base_name) || !model->hasLinkModel(tip_name))
+  {
+    RCLCPP_ERROR(LOGGER, "Reachability map frames '%s' and '%s' must be links of the robot model", base_name.c_str(),
+                 tip_name.c_str());
+    return nullptr;
+  }
+  if (resolution <= 0.0 || num_samples == 0 || seeds_per_voxel == 0)
+  {
+    RCLCPP_ERROR(LOGGER, "Reachability map needs a positive resolution, sample count and number of seeds per voxel");
+    return nullptr;
+  }
+  const moveit::core::LinkModel* base = model->getLinkModel(base_name);
+  const moveit::core::LinkModel* tip = model->getLinkModel(tip_name);
+
+  ReachabilityMapPtr map(new ReachabilityMap());
+  map->group_name_ = group_name;
+  map->base_frame_ = base_name;
+  map->tip_frame_ = tip_name;
+  map->key_ = groupKey(jmg);
+  map->resolution_ = resolution;
+  map->variable_count_ = jmg->getVariableCount();
+  map->seeds_per_voxel_ = seeds_per_voxel;
+
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+
+  // the first pass finds the extent of the workspace; the second pass samples the same states again, so all of them
+  // fall inside the grid. Validity is only checked in the second pass, as it is usually much more expensive than FK.
+  Eigen::Vector3d lower = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+  Eigen::Vector3d upper = -lower;
+  {
+    random_numbers::RandomNumberGenerator rng(rng_seed);
+    for (std::size_t i = 0; i < num_samples; ++i)
+    {
+      state.setToRandomPositions(jmg, rng);
+      state.update();
+      const Eigen::Vector3d p = tipPosition(state, base, tip);
+      lower = lower.cwiseMin(p);
+      upper = upper.cwiseMax(p);
+    }
+  }
+  map->origin_ = lower - Eigen::Vector3d::Constant(0.5 * resolution);
+  std::size_t voxels = 1;
+  for (int d = 0; d < 3; ++d)
+  {
+    const double cells = std::floor((upper[d] - map->origin_[d]) / resolution) + 1.0;
+    if (cells > static_cast<double>(MAX_VOXELS))
+      voxels = MAX_VOXELS + 1;
+    else
+    {
+      map->dims_[d] = static_cast<std::uint32_t>(cells);
+      voxels *= map->dims_[d];
+    }
+  }
+  if (voxels > MAX_VOXELS)
+  {
+    RCLCPP_ERROR(LOGGER, "The resolution %lf is too fine for the workspace of group '%s'", resolution,
+                 group_name.c_str());
+    return nullptr;
+  }
+
+  map->buffer_.assign(map->dataSize(), 0);
+  std::uint32_t* hit_counts = reinterpret_cast<std::uint32_t*>(map->buffer_.data());
+  float* seeds = reinterpret_cast<float*>(map->buffer_.data() + padded(voxels * sizeof(std::uint32_t)));
+  random_numbers::RandomNumberGenerator rng(rng_seed);
+  random_numbers::RandomNumberGenerator slot_rng(rng_seed + 1);
+  std::vector<double> values;
+  for (std::size_t i = 0; i < num_samples; ++i)
+  {
+    state.setToRandomPositions(jmg, rng);
+    state.update();
+    if (validity_fn && !validity_fn(state))
+      continue;
+    Eigen::Quaterniond orientation;
+    const long index = map->voxelIndex(tipPosition(state, base, tip, &orientation));
+    if (index < 0)
+      continue;
+
+    // reservoir sampling keeps a uniform selection of the states that hit the voxel
+    const std::uint32_t hits = ++hit_counts[index];
+    std::size_t slot = hits - 1;
+    if (hits > seeds_per_voxel)
+    {
+      slot = slot_rng.uniformInteger(0, hits - 1);
+      if (slot >= seeds_per_voxel)
+        continue;
+    }
+    float* seed = seeds + (index * seeds_per_voxel + slot) * map->seedSize();
+    seed[0] = orientation.x();
+    seed[1] = orientation.y();
+    seed[2] = orientation.z();
+    seed[3] = orientation.w();
+    state.copyJointGroupPositions(jmg, values);
+    std::copy(values.begin(), values.end(), seed + 4);
+  }
+  map->setData(map->buffer_.data());
+  return map;
+}
+
+ReachabilityMapPtr ReachabilityMap::load(const std::string& filename, const moveit::core::JointModelGroup* jmg)
+{
+  auto file = std::make_unique<moveit::core::MappedFile>(filename);
+  MapFileHeader header;
+  std::size_t offset = 0;
+  if (!readPadded(*file, offset, &header, sizeof(header)))
+    return nullptr;
+  if (memcmp(header.magic, MAP_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != MAP_FILE_VERSION)
+  {
+    RCLCPP_ERROR(LOGGER, "'%s' is not a version %u reachability map", filename.c_str(), MAP_FILE_VERSION);
+    return nullptr;
+  }
+  if (header.key != groupKey(jmg) || header.variable_count != jmg->getVariableCount())
+  {
+    RCLCPP_ERROR(LOGGER, "Reachability map '%s' was generated for a different group than '%s'", filename.c_str(),
+                 jmg->getName().c_str());
+    return nullptr;
+  }
+
+  ReachabilityMapPtr map(new ReachabilityMap());
+  map->key_ = header.key;
+  map->resolution_ = header.resolution;
+  map->origin_ = Eigen::Vector3d(header.origin[0], header.origin[1], header.origin[2]);
+  std::copy(header.dims, header.dims + 3, map->dims_);
+  map->variable_count_ = header.variable_count;
+  map->seeds_per_voxel_ = header.seeds_per_voxel;
+  map->group_name_.resize(header.group_name_size);
+  map->base_frame_.resize(header.base_frame_size);
+  map->tip_frame_.resize(header.tip_frame_size);
+  const bool ok = readPadded(*file, offset, map->group_name_.data(), map->group_name_.size()) &&
+                  readPadded(*file, offset, map->base_frame_.data(), map->base_frame_.size()) &&
+                  readPadded(*file, offset, map->tip_frame_.data(), map->tip_frame_.size());
+  // check the dimensions one by one, so their product cannot overflow
+  const bool sane_dims = header.dims[0] <= MAX_VOXELS && header.dims[1] <= MAX_VOXELS / std::max(header.dims[0], 1u) &&
+                         header.dims[2] <= MAX_VOXELS / std::max(header.dims[0] * header.dims[1], 1u) &&
+                         header.seeds_per_voxel <= (1u << 16) && header.resolution > 0.0;
+  if (!ok || !sane_dims || file->size() - offset != map->dataSize())
+  {
+    RCLCPP_ERROR(LOGGER, "Reachability map '%s' is truncated or corrupt", filename.c_str());
+    return nullptr;
+  }
+  map->setData(file->begin() + offset);
+  map->file_ = std::move(file);
+  return map;
+}
+
+bool ReachabilityMap::save(const std::string& filename) const
+{
+  MapFileHeader header{};
+  memcpy(header.magic, MAP_FILE_MAGIC, sizeof(header.magic));
+  header.version = MAP_FILE_VERSION;
+  header.variable_count = variable_count_;
+  header.key = key_;
+  header.resolution = resolution_;
+  for (int d = 0; d < 3; ++d)
+  {
+    header.origin[d] = origin_[d];
+    header.dims[d] = dims_[d];
+  }
+  header.seeds_per_voxel = seeds_per_voxel_;
+  header.group_name_size = group_name_.size();
+  header.base_frame_size = base_frame_.size();
+  header.tip_frame_size = tip_frame_.size();
+
+  // write to a temporary file first, so processes reading the old file never see a partial one
+  const std::string tmp_filename = filename + ".tmp" + std::to_string(moveit::core::processId());
+  {
+    std::ofstream out(tmp_filename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (!out.good())
+      return false;
+    writePadded(out, &header, sizeof(header));
+    writePadded(out, group_name_.data(), group_name_.size());
+    writePadded(out, base_frame_.data(), base_frame_.size());
+    writePadded(out, tip_frame_.data(), tip_frame_.size());
+    out.write(reinterpret_cast<const char*>(hit_counts_), dataSize());
+    if (!out.good())
+    {
+      out.close();
+      std::filesystem::remove(tmp_filename);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_filename, filename, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tmp_filename, ec);
+    return false;
+  }
+  return true;
+}
+
+std::size_t ReachabilityMap::getReachableVoxelCount() const
+{
+  return voxelCount() - std::count(hit_counts_, hit_counts_ + voxelCount(), 0u);
+}
+
+bool ReachabilityMap::isReachable(const Eigen::Vector3d& position) const
+{
+  const long index = voxelIndex(position);
+  return index >= 0 && hit_counts_[index] > 0;
+}
+
+bool ReachabilityMap::getSeed(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation,
+                              std::vector<double>& values) const
+{
+  const long index = voxelIndex(position);
+  if (index < 0 || hit_counts_[index] == 0)
+    return false;
+
+  const std::size_t stored = std::min<std::size_t>(hit_counts_[index], seeds_per_voxel_);
+  const float* seeds = seeds_ + index * seeds_per_voxel_ * seedSize();
+  const float* best = seeds;
+  double best_similarity = -1.0;
+  for (std::size_t i = 0; i < stored; ++i)
+  {
+    const float* seed = seeds + i * seedSize();
+    // q and -q are the same rotation
+    const double similarity = std::fabs(orientation.x() * seed[0] + orientation.y() * seed[1] +
+                                        orientation.z() * seed[2] + orientation.w() * seed[3]);
+    if (similarity > best_similarity)
+    {
+      best_similarity = similarity;
+      best = seed;
+    }
+  }
+  values.assign(best + 4, best + seedSize());
+  return true;
+}
+
+long ReachabilityMap::voxelIndex(const Eigen::Vector3d& position) const
+{
+  long index = 0;
+  for (int d = 2; d >= 0; --d)
+  {
+    const double cell = std::floor((position[d] - origin_[d]) / resolution_);
+    if (!(cell >= 0.0 && cell < dims_[d]))  // also rejects NaN
+      return -1;
+    index = index * dims_[d] + static_cast<long>(cell);
+  }
+  return index;
+}
+
+std::size_t ReachabilityMap::dataSize() const
+{
+  return padded(voxelCount() * sizeof(std::uint32_t)) +
+         padded(voxelCount() * seeds_per_voxel_ * seedSize() * sizeof(float));
+}
+
+void ReachabilityMap::setData(const char* data)
+{
+  hit_counts_ = reinterpret_cast<const std::uint32_t*>(data);
+  seeds_ = reinterpret_cast<const float*>(data + padded(voxelCount() * sizeof(std::uint32_t)));
+}
+}  // namespace constraint_samplers
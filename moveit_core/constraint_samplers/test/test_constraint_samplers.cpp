@@ -40,8 +40,10 @@
 #include <moveit/constraint_samplers/union_constraint_sampler.h>
 #include <moveit/constraint_samplers/constraint_sampler_manager.h>
 #include <moveit/constraint_samplers/constraint_sampler_tools.h>
+#include <moveit/constraint_samplers/reachability_map.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/utils/robot_model_test_utils.h>
+#include <moveit/utils/mapped_file.h>
 
 #include <geometric_shapes/shape_operations.h>
 #include <visualization_msgs/msg/marker_array.hpp>
@@ -49,6 +51,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <urdf_parser/urdf_parser.h>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 
@@ -1236,6 +1239,113 @@ TEST_F(LoadPlanningModelsPr2, IKConstraintsSamplerSeeded)
   EXPECT_FALSE((root_to_left_tool2 * root_to_left_tool3.inverse()).matrix().isIdentity(1e-7));
 }
 
+TEST_F(LoadPlanningModelsPr2, ConstraintSamplerManagerSampleMany)
+{
+  moveit::core::RobotState ks(robot_model_);
+  ks.setToDefaultValues();
+  ks.update();
+
+  moveit_msgs::msg::Constraints con;
+  con.joint_constraints.resize(2);
+  con.joint_constraints[0].joint_name = "l_shoulder_pan_joint";
+  con.joint_constraints[0].position = 0.54;
+  con.joint_constraints[0].tolerance_above = 0.01;
+  con.joint_constraints[0].tolerance_below = 0.01;
+  con.joint_constraints[0].weight = 1.0;
+  con.joint_constraints[1].joint_name = "l_elbow_flex_joint";
+  con.joint_constraints[1].position = -0.54;
+  con.joint_constraints[1].tolerance_above = 0.01;
+  con.joint_constraints[1].tolerance_below = 0.01;
+  con.joint_constraints[1].weight = 1.0;
+
+  kinematic_constraints::KinematicConstraintSet kset(robot_model_);
+  kset.add(con, ps_->getTransforms());
+
+  constraint_samplers::ConstraintSamplerManager csm;
+  std::vector<moveit::core::RobotState> samples;
+  EXPECT_EQ(csm.sampleMany(ps_, "left_arm", con, ks, 20, 1000, samples, 4), 20u);
+  ASSERT_EQ(samples.size(), 20u);
+  for (const moveit::core::RobotState& sample : samples)
+    EXPECT_TRUE(kset.decide(sample).satisfied);
+  // the samples are drawn independently
+  EXPECT_NE(samples[0].getVariablePosition("l_shoulder_lift_joint"),
+            samples[1].getVariablePosition("l_shoulder_lift_joint"));
+
+  // the attempts bound the work done
+  EXPECT_EQ(csm.sampleMany(ps_, "left_arm", con, ks, 20, 5, samples, 4), 5u);
+  EXPECT_EQ(csm.sampleMany(ps_, "no_such_group", con, ks, 20, 1000, samples, 4), 0u);
+  EXPECT_TRUE(samples.empty());
+}
+
+TEST_F(LoadPlanningModelsPr2, ReachabilityMap)
+{
+  constraint_samplers::ReachabilityMapPtr map = constraint_samplers::ReachabilityMap::generate(
+      robot_model_, "left_arm", "torso_lift_link", "l_wrist_roll_link", 0.1, 20000);
+  ASSERT_TRUE(map);
+  EXPECT_GT(map->getReachableVoxelCount(), 0u);
+  EXPECT_FALSE(map->isReachable(Eigen::Vector3d(10.0, 0.0, 0.0)));
+
+  // the generator samples states with the same random seed, so this state is recorded in the map
+  moveit::core::RobotState ks(robot_model_);
+  ks.setToDefaultValues();
+  random_numbers::RandomNumberGenerator rng(0);
+  ks.setToRandomPositions(robot_model_->getJointModelGroup("left_arm"), rng);
+  ks.update();
+  const Eigen::Isometry3d tip = ks.getGlobalLinkTransform("torso_lift_link").inverse() *
+                                ks.getGlobalLinkTransform("l_wrist_roll_link");
+  EXPECT_TRUE(map->isReachable(tip.translation()));
+  std::vector<double> seed;
+  EXPECT_TRUE(map->getSeed(tip.translation(), Eigen::Quaterniond(tip.linear()), seed));
+  EXPECT_EQ(seed.size(), robot_model_->getJointModelGroup("left_arm")->getVariableCount());
+
+  const std::string filename = (std::filesystem::temp_directory_path() /
+                                ("test_reachability_map_" + std::to_string(moveit::core::processId())))
+                                   .string();
+  ASSERT_TRUE(map->save(filename));
+  constraint_samplers::ReachabilityMapPtr loaded =
+      constraint_samplers::ReachabilityMap::load(filename, robot_model_->getJointModelGroup("left_arm"));
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->getReachableVoxelCount(), map->getReachableVoxelCount());
+  EXPECT_EQ(loaded->getTipFrame(), "l_wrist_roll_link");
+  std::vector<double> loaded_seed;
+  EXPECT_TRUE(loaded->getSeed(tip.translation(), Eigen::Quaterniond(tip.linear()), loaded_seed));
+  EXPECT_EQ(seed, loaded_seed);
+  EXPECT_FALSE(constraint_samplers::ReachabilityMap::load(filename, robot_model_->getJointModelGroup("right_arm")));
+  std::filesystem::remove(filename);
+
+  moveit::core::Transforms& tf = ps_->getTransformsNonConst();
+  auto pc = std::make_shared<kinematic_constraints::PositionConstraint>(robot_model_);
+  moveit_msgs::msg::PositionConstraint pcm;
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.header.frame_id = robot_model_->getModelFrame();
+  pcm.constraint_region.primitives.resize(1);
+  pcm.constraint_region.primitives[0].type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  pcm.constraint_region.primitives[0].dimensions.resize(1);
+  pcm.constraint_region.primitives[0].dimensions[0] = 0.001;
+  pcm.constraint_region.primitive_poses.resize(1);
+  pcm.constraint_region.primitive_poses[0].position.x = 0.55;
+  pcm.constraint_region.primitive_poses[0].position.y = 0.2;
+  pcm.constraint_region.primitive_poses[0].position.z = 1.25;
+  pcm.constraint_region.primitive_poses[0].orientation.w = 1.0;
+  pcm.weight = 1.0;
+  EXPECT_TRUE(pc->configure(pcm, tf));
+
+  constraint_samplers::IKConstraintSampler iks(ps_, "left_arm");
+  iks.setReachabilityMap(loaded);
+  EXPECT_TRUE(iks.configure(constraint_samplers::IKSamplingPose(pc)));
+  for (int t = 0; t < 100; ++t)
+  {
+    EXPECT_TRUE(iks.sample(ks, ks, 100));
+    EXPECT_TRUE(pc->decide(ks).satisfied);
+  }
+
+  // poses outside the map are never passed to IK
+  pcm.constraint_region.primitive_poses[0].position.x = 10.0;
+  EXPECT_TRUE(pc->configure(pcm, tf));
+  EXPECT_TRUE(iks.configure(constraint_samplers::IKSamplingPose(pc)));
+  EXPECT_FALSE(iks.sample(ks, ks, 10));
+}
+
 int main(int argc, char** argv)
 {
   rclcpp::init(argc, argv);
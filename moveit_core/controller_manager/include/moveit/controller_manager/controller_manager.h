@@ -127,6 +127,18 @@ public:
    * Return false when the controller cannot accept the trajectory. */
   virtual bool sendTrajectory(const moveit_msgs::msg::RobotTrajectory& trajectory) = 0;
 
+  /** \brief Replace the trajectory being executed by \e trajectory, without stopping the motion.
+   *
+   * \e trajectory continues the trajectory being executed: it has the same header stamp, and its points up to the
+   * current time are the ones sent before. Controllers that switch to a new trajectory along the timeline given by its
+   * header stamp (e.g. the joint_trajectory_controller) therefore continue the motion seamlessly.
+   * A waitForExecution() call in progress may return when the replaced trajectory is preempted; callers wait again for
+   * the new one. Return false if the controller cannot replace the trajectory during execution (the default). */
+  virtual bool updateTrajectory(const moveit_msgs::msg::RobotTrajectory& /*trajectory*/)
+  {
+    return false;
+  }
+
   /** \brief Cancel the execution of any motion using this controller.
    *
    * Report false if canceling is not possible.
@@ -0,0 +1,298 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/distance_field/distance_field.h>
+#include <moveit/distance_field/voxel_grid.h>
+#include <cstdint>
+#include <vector>
+
+namespace distance_field
+{
+/**
+ * \brief Structure that holds voxel information for the
+ * CompactDistanceField.  Only the squared distances are stored, 4
+ * bytes per cell instead of the 40 bytes of a \ref
+ * PropDistanceFieldVoxel.
+ */
+struct CompactDistanceFieldVoxel
+{
+  /**
+   * \brief Constructor.  All fields left uninitialized.
+   */
+  CompactDistanceFieldVoxel() = default;
+
+  /**
+   * \brief Constructor.  Sets values of distance_square_ and
+   * negative_distance_square_.
+   *
+   * @param [in] distance_sq_positive Value to which to initialize distance_square_
+   * @param [in] distance_sq_negative Value to which to initialize negative_distance_square_
+   */
+  CompactDistanceFieldVoxel(std::uint16_t distance_sq_positive, std::uint16_t distance_sq_negative)
+    : distance_square_(distance_sq_positive), negative_distance_square_(distance_sq_negative)
+  {
+  }
+
+  std::uint16_t distance_square_; /**< \brief Distance in cells to the closest obstacle, squared, 0 in obstacles */
+  std::uint16_t negative_distance_square_; /**< \brief Distance in cells to the nearest unoccupied cell, squared */
+};
+
+MOVEIT_CLASS_FORWARD(CompactDistanceField);  // Defines CompactDistanceFieldPtr, ConstPtr, WeakPtr... etc
+
+/**
+ * \brief A DistanceField implementation with a memory footprint of 4
+ * bytes per cell.
+ *
+ * Unlike the \ref PropagationDistanceField no closest points or
+ * propagation directions are stored, which makes a fine field over a
+ * whole workcell affordable and keeps more of the grid in cache for
+ * gradient queries.  Distances are kept as 16 bit squared cell
+ * counts, so the maximum distance is limited to \ref
+ * MAX_DISTANCE_CELLS cells.
+ *
+ * Updates do not propagate from the changed cells.  Instead, an exact
+ * Euclidean distance transform is recomputed over the bounding box of
+ * the changed cells, grown by the maximum distance on each side.  This
+ * makes the distances exact, and the cost of an update depends on how
+ * spread out the changed cells are rather than on how many there are.
+ * Many clustered changes are cheap; a few changes far apart cost about
+ * as much as recomputing the whole field.  The transform is split
+ * across the number of threads given on construction.
+ */
+class CompactDistanceField : public DistanceField
+{
+public:
+  /** \brief The largest supported maximum distance, in cells */
+  static const int MAX_DISTANCE_CELLS = 255;
+
+  /**
+   * \brief Constructor that initializes entire distance field to
+   * empty - all cells will be assigned maximum distance values.
+   *
+   * @param [in] size_x The X dimension in meters of the volume to represent
+   * @param [in] size_y The Y dimension in meters of the volume to represent
+   * @param [in] size_z The Z dimension in meters of the volume to represent
+   * @param [in] resolution The resolution in meters of the volume
+   * @param [in] origin_x The minimum X point of the volume
+   * @param [in] origin_y The minimum Y point of the volume
+   * @param [in] origin_z The minimum Z point of the volume
+   *
+   * @param [in] max_distance The maximum distance to which distances
+   * are computed.  Cells that are further away are assigned the
+   * maximum distance value.  Clamped to \ref MAX_DISTANCE_CELLS cells.
+   *
+   * @param [in] propagate_negative_distances Whether or not to compute
+   * negative distances inside obstacles, see \ref
+   * PropagationDistanceField.
+   *
+   * @param [in] threads Number of threads used for updates, 0 selects
+   * one per hardware thread
+   */
+  CompactDistanceField(double size_x, double size_y, double size_z, double resolution, double origin_x,
+                       double origin_y, double origin_z, double max_distance,
+                       bool propagate_negative_distances = false, unsigned int threads = 1);
+
+  ~CompactDistanceField() override = default;
+
+  /**
+   * \brief Add a set of obstacle points to the distance field,
+   * updating distance values accordingly.  Points outside the field
+   * are ignored.
+   *
+   * @param [in] points The set of obstacle points to add
+   */
+  void addPointsToField(const EigenSTL::vector_Vector3d& points) override;
+
+  /**
+   * \brief Remove a set of obstacle points from the distance field,
+   * updating distance values accordingly.  Unlike the \ref
+   * PropagationDistanceField this costs the same as adding points.
+   *
+   * @param [in] points The set of obstacle points that will be set as free
+   */
+  void removePointsFromField(const EigenSTL::vector_Vector3d& points) override;
+
+  /**
+   * \brief Removes any obstacle points that are in the old point set
+   * but not the new point set, and adds any obstacle points that are in
+   * the new point set but not the old point set, with a single distance
+   * update.
+   *
+   * @param [in] old_points The set of points that all should be obstacle cells in the distance field
+   * @param [in] new_points The set of points, all of which are intended to be obstacle points in the distance field
+   */
+  void updatePointsInField(const EigenSTL::vector_Vector3d& old_points,
+                           const EigenSTL::vector_Vector3d& new_points) override;
+
+  /**
+   * \brief Resets the entire distance field to max_distance for
+   * positive values and zero for negative values.
+   */
+  void reset() override;
+
+  /**
+   * \brief Get the distance value associated with the cell indicated
+   * by the world coordinate.  Behaves like \ref
+   * PropagationDistanceField::getDistance.
+   */
+  double getDistance(double x, double y, double z) const override;
+
+  /**
+   * \brief Get the distance value associated with the cell indicated
+   * by the index coordinates.  Behaves like \ref
+   * PropagationDistanceField::getDistance.
+   */
+  double getDistance(int x, int y, int z) const override;
+
+  bool isCellValid(int x, int y, int z) const override;
+  int getXNumCells() const override;
+  int getYNumCells() const override;
+  int getZNumCells() const override;
+  std::size_t getMemoryBytes() const override;
+  bool gridToWorld(int x, int y, int z, double& world_x, double& world_y, double& world_z) const override;
+  bool worldToGrid(double world_x, double world_y, double world_z, int& x, int& y, int& z) const override;
+
+  /**
+   * \brief Writes the contents of the distance field to the supplied
+   * stream, in the same format as \ref
+   * PropagationDistanceField::writeToStream.
+   *
+   * @param [out] stream The stream to which to write the distance field contents.
+   *
+   * @return True
+   */
+  bool writeToStream(std::ostream& stream) const override;
+
+  /**
+   * \brief Reads, parameterizes, and populates the distance field
+   * based on the supplied stream, as written by \ref writeToStream or
+   * \ref PropagationDistanceField::writeToStream.
+   *
+   * @param [in] stream The stream from which to read
+   *
+   * @return True if reading, parameterizing, and populating the
+   * distance field is successful; otherwise False.
+   */
+  bool readFromStream(std::istream& stream) override;
+
+  /**
+   * \brief Gets the maximum distance, which is returned for all
+   * out-of-bounds queries.
+   */
+  double getUninitializedDistance() const override
+  {
+    return max_distance_;
+  }
+
+  /**
+   * \brief Gets full cell data given an index.  x,y,z MUST be valid
+   * or data corruption (SEGFAULTS) will occur.
+   *
+   * @param [in] x The X index
+   * @param [in] y The Y index
+   * @param [in] z The Z index
+   *
+   * @return The data in the indicated cell.
+   */
+  const CompactDistanceFieldVoxel& getCell(int x, int y, int z) const
+  {
+    return voxel_grid_->getCell(x, y, z);
+  }
+
+  /**
+   * \brief Gets the maximum distance squared value, in cells.
+   */
+  int getMaximumDistanceSquared() const
+  {
+    return max_distance_sq_;
+  }
+
+protected:
+  /**
+   * \brief Batched gradient query that reads the voxel grid directly,
+   * see \ref DistanceField::getDistanceGradients.
+   */
+  void computeDistanceGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                                Eigen::Vector3d* gradients, unsigned char* in_bounds) const override;
+
+private:
+  /**
+   * \brief Initializes the field, resetting the voxel grid and
+   * building a sqrt lookup table for efficiency based on
+   * max_distance_.
+   */
+  void initialize();
+
+  /**
+   * \brief Marks a cell as obstacle or free and grows the bounding box
+   * of changed cells if its state changed.
+   *
+   * @return True if the state of the cell changed
+   */
+  bool setCellOccupied(const Eigen::Vector3i& cell, bool occupied, Eigen::Vector3i& changed_min,
+                       Eigen::Vector3i& changed_max);
+
+  /**
+   * \brief Recomputes the distances of all cells that can be affected
+   * by a change inside the given box of cells.
+   *
+   * @param changed_min The minimum cell index of the changed box
+   * @param changed_max The maximum cell index of the changed box
+   */
+  void updateRegion(const Eigen::Vector3i& changed_min, const Eigen::Vector3i& changed_max);
+
+  /**
+   * \brief Determines distance based on actual voxel data
+   */
+  double getDistance(const CompactDistanceFieldVoxel& voxel) const
+  {
+    return sqrt_table_[voxel.distance_square_] - sqrt_table_[voxel.negative_distance_square_];
+  }
+
+  bool propagate_negative_; /**< \brief Whether or not to compute negative distances */
+  unsigned int threads_;    /**< \brief Number of threads used for updates */
+
+  VoxelGrid<CompactDistanceFieldVoxel>::Ptr voxel_grid_; /**< \brief Actual container for distance data */
+
+  double max_distance_;   /**< \brief Holds maximum distance  */
+  int max_distance_cells_; /**< \brief Holds maximum distance in cells, rounded up */
+  int max_distance_sq_;    /**< \brief Holds maximum distance squared in cells */
+
+  std::vector<double> sqrt_table_; /**< \brief Precomputed square root table for faster distance lookups */
+  std::vector<int> transform_distances_; /**< \brief Scratch squared distances for the region update */
+};
+}  // namespace distance_field
@@ -311,6 +311,44 @@ public:
    */
   double getDistanceGradient(double x, double y, double z, double& gradient_x, double& gradient_y, double& gradient_z,
                              bool& in_bounds) const;
+
+  /** \brief Batches smaller than this many points per thread are not split across threads */
+  static const std::size_t MIN_GRADIENT_QUERIES_PER_THREAD = 4096;
+
+  /**
+   * \brief Batched version of \ref getDistanceGradient for a packed
+   * set of query points.
+   *
+   * The output vectors are resized to the number of points, and entry
+   * i holds exactly what \ref getDistanceGradient would report for
+   * points[i].
+   *
+   * @param [in] points The query points in world coordinates
+   * @param [out] distances The distance to the closest occupied cell for each point
+   * @param [out] gradients The gradient for each point
+   * @param [out] in_bounds Non-zero for each point that is valid for gradient purposes
+   * @param [in] threads The number of threads to split large batches across, 0 selects one per hardware thread
+   */
+  void getDistanceGradients(const EigenSTL::vector_Vector3d& points, std::vector<double>& distances,
+                            EigenSTL::vector_Vector3d& gradients, std::vector<unsigned char>& in_bounds,
+                            unsigned int threads = 1) const;
+
+  /**
+   * \brief Batched gradient query on caller owned arrays of \e count
+   * entries each, e.g. the sphere centers of all points of a
+   * trajectory.  Nothing is allocated.
+   *
+   * Batches of at least \ref MIN_GRADIENT_QUERIES_PER_THREAD points
+   * per thread are split into contiguous ranges answered in parallel.
+   * The default implementation loops over the scalar query; derived
+   * classes with direct access to their storage override \ref
+   * computeDistanceGradients to avoid the per-cell virtual dispatch.
+   *
+   * @param [in] threads The number of threads to split large batches across, 0 selects one per hardware thread
+   */
+  void getDistanceGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                            Eigen::Vector3d* gradients, unsigned char* in_bounds, unsigned int threads = 1) const;
+
   /**
    * \brief Gets the distance to the closest obstacle at the given
    * integer cell location. The particulars of this function are
@@ -360,6 +398,20 @@ public:
    */
   virtual int getZNumCells() const = 0;
 
+  /**
+   * \brief Gets the approximate number of bytes held by the field,
+   * dominated by the voxel storage
+   *
+   * The default implementation returns 0 for fields that do not
+   * report their memory.
+   *
+   * @return The number of bytes
+   */
+  virtual std::size_t getMemoryBytes() const
+  {
+    return 0;
+  }
+
   /**
    * \brief Converts from an set of integer indices to a world
    * location given the origin and resolution parameters.
@@ -578,6 +630,14 @@ public:
   virtual double getUninitializedDistance() const = 0;
 
 protected:
+  /**
+   * \brief Answers the gradient queries of one contiguous range of a
+   * batch, see \ref getDistanceGradients.  May be called concurrently
+   * for disjoint ranges.
+   */
+  virtual void computeDistanceGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                                        Eigen::Vector3d* gradients, unsigned char* in_bounds) const;
+
   /**
    * @brief Get the points associated with an octree.
    * @param [in] octree The octree to find points for.
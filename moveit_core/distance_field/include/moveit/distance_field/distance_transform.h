@@ -0,0 +1,106 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace distance_field
+{
+/** \brief Marks cells without a site in \ref computeSquaredDistanceTransform */
+static const int DISTANCE_TRANSFORM_INFINITY = std::numeric_limits<int>::max();
+
+/**
+ * \brief Resolves a requested number of threads, where 0 selects one
+ * thread per hardware thread.
+ */
+inline unsigned int resolveThreadCount(unsigned int threads)
+{
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  return std::max(threads, 1u);
+}
+
+/**
+ * \brief Splits [0, count) into contiguous chunks and calls
+ * function(begin, end) for each, running the chunks on up to threads
+ * threads.  The calling thread handles the first chunk.
+ */
+template <typename Function>
+void parallelFor(std::size_t count, unsigned int threads, const Function& function)
+{
+  const std::size_t chunks = std::min<std::size_t>(threads, count);
+  if (chunks <= 1)
+  {
+    function(0, count);
+    return;
+  }
+
+  const std::size_t chunk_size = (count + chunks - 1) / chunks;
+  std::vector<std::thread> workers;
+  workers.reserve(chunks - 1);
+  for (std::size_t begin = chunk_size; begin < count; begin += chunk_size)
+    workers.emplace_back([&function, begin, end = std::min(count, begin + chunk_size)] { function(begin, end); });
+  function(0, chunk_size);
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+/**
+ * \brief Exact squared Euclidean distance transform of a dense 3D grid
+ * of cells, laid out like a \ref VoxelGrid (z fastest).
+ *
+ * Uses the separable algorithm of Felzenszwalb and Huttenlocher, one
+ * pass per axis, with the lines of each pass split across the threads.
+ *
+ * @param [in] num_x The number of cells along X
+ * @param [in] num_y The number of cells along Y
+ * @param [in] num_z The number of cells along Z
+ * @param [in,out] distances On input 0 for site cells and \ref
+ * DISTANCE_TRANSFORM_INFINITY for all others; on output the squared
+ * distance in cells to the closest site, or \ref
+ * DISTANCE_TRANSFORM_INFINITY if the grid has no site
+ * @param [in,out] sites If not null, on input the flat index of each
+ * site cell and -1 for all others; on output the flat index of the
+ * closest site of each cell
+ * @param [in] threads The number of threads to use
+ */
+void computeSquaredDistanceTransform(int num_x, int num_y, int num_z, std::vector<int>& distances,
+                                     std::vector<int>* sites, unsigned int threads);
+}  // namespace distance_field
@@ -168,10 +168,14 @@ public:
    * \ref PropagationDistanceField description for more information on
    * the implications of this.
    *
+   * @param [in] propagation_threads Number of threads used for
+   * large updates, see \ref setPropagationThreads.  The default of 1
+   * keeps the serial bucket propagation for every update.
+   *
    */
   PropagationDistanceField(double size_x, double size_y, double size_z, double resolution, double origin_x,
                            double origin_y, double origin_z, double max_distance,
-                           bool propagate_negative_distances = false);
+                           bool propagate_negative_distances = false, unsigned int propagation_threads = 1);
 
   /**
    * \brief Constructor based on an OcTree and bounding box
@@ -194,10 +198,14 @@ public:
    * and all obstacle cells will be assigned zero distance.  See the
    * \ref PropagationDistanceField description for more information on
    * the implications of this.
+   *
+   * @param [in] propagation_threads Number of threads used for
+   * large updates, see \ref setPropagationThreads.  The default of 1
+   * keeps the serial bucket propagation for every update.
    */
   PropagationDistanceField(const octomap::OcTree& octree, const octomap::point3d& bbx_min,
                            const octomap::point3d& bbx_max, double max_distance,
-                           bool propagate_negative_distances = false);
+                           bool propagate_negative_distances = false, unsigned int propagation_threads = 1);
 
   /**
    * \brief Constructor that takes an istream and reads the contents
@@ -218,9 +226,25 @@ public:
    * \ref PropagationDistanceField description for more information on
    * the implications of this.
    *
+   * @param [in] propagation_threads Number of threads used for
+   * large updates, see \ref setPropagationThreads.  The default of 1
+   * keeps the serial bucket propagation for every update.
+   *
    * @return
    */
-  PropagationDistanceField(std::istream& stream, double max_distance, bool propagate_negative_distances = false);
+  PropagationDistanceField(std::istream& stream, double max_distance, bool propagate_negative_distances = false,
+                           unsigned int propagation_threads = 1);
+
+  /**
+   * \brief Copy constructor, copies all distance data of \e other
+   * without running any propagation.
+   *
+   * @param [in] other The distance field to copy
+   */
+  PropagationDistanceField(const PropagationDistanceField& other);
+
+  PropagationDistanceField& operator=(const PropagationDistanceField& other) = delete;
+
   /**
    * \brief Empty destructor
    *
@@ -298,6 +322,30 @@ public:
    */
   void reset() override;
 
+  /**
+   * \brief Sets the number of threads used to update the field.
+   *
+   * With more than one thread, updates that change enough cells that
+   * the incremental bucket propagation would touch a large part of the
+   * grid are instead handled by recomputing the whole field with a
+   * separable exact Euclidean distance transform, split into slabs
+   * across the threads.  Small updates always use the incremental
+   * propagation.  The recomputed distances are exact, so they may be
+   * slightly smaller than the propagated ones, which only approximate
+   * the Euclidean distance.
+   *
+   * @param [in] threads The number of threads, 0 selects one per hardware thread
+   */
+  void setPropagationThreads(unsigned int threads);
+
+  /**
+   * \brief Gets the number of threads used for large updates.
+   */
+  unsigned int getPropagationThreads() const
+  {
+    return propagation_threads_;
+  }
+
   /**
    * \brief Get the distance value associated with the cell indicated
    * by the world coordinate.  If the cell is invalid, max_distance
@@ -336,6 +384,7 @@ public:
   int getXNumCells() const override;
   int getYNumCells() const override;
   int getZNumCells() const override;
+  std::size_t getMemoryBytes() const override;
   bool gridToWorld(int x, int y, int z, double& world_x, double& world_y, double& world_z) const override;
   bool worldToGrid(double world_x, double world_y, double world_z, int& x, int& y, int& z) const override;
 
@@ -452,6 +501,18 @@ public:
     return max_distance_sq_;
   }
 
+protected:
+  /**
+   * \brief Batched gradient query that reads the voxel grid directly.
+   *
+   * Produces the same output as the scalar \ref
+   * DistanceField::getDistanceGradient, but hoists the grid geometry
+   * out of the loop and addresses the six neighbouring cells by
+   * stride instead of going through the virtual cell accessors.
+   */
+  void computeDistanceGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                                Eigen::Vector3d* gradients, unsigned char* in_bounds) const override;
+
 private:
   /** Typedef for set of integer indices */
   typedef std::set<Eigen::Vector3i, CompareEigenVector3i, Eigen::aligned_allocator<Eigen::Vector3i>> VoxelSet;
@@ -493,6 +554,33 @@ private:
    */
   void propagateNegative();
 
+  /**
+   * \brief Whether an update of the given number of voxels should
+   * recompute the whole field in parallel instead of propagating
+   * incrementally.
+   *
+   * @param changed_voxels The number of voxels added or removed
+   */
+  bool useFullRecompute(std::size_t changed_voxels) const;
+
+  /**
+   * \brief Recomputes all positive, and if enabled negative,
+   * distances from the current set of obstacle cells using \ref
+   * computeDistanceTransform.
+   */
+  void recomputeField();
+
+  /**
+   * \brief Runs a separable exact squared Euclidean distance
+   * transform over the grid and stores the result in the voxels.
+   *
+   * @param negative If false, distances to the closest obstacle cell
+   * are computed for \ref PropDistanceFieldVoxel::distance_square_;
+   * if true, distances to the closest unoccupied cell are computed for
+   * \ref PropDistanceFieldVoxel::negative_distance_square_
+   */
+  void computeDistanceTransform(bool negative);
+
   /**
    * \brief Determines distance based on actual voxel data
    *
@@ -546,6 +634,7 @@ private:
   void print(const EigenSTL::vector_Vector3d& points);
 
   bool propagate_negative_; /**< \brief Whether or not to propagate negative distances */
+  unsigned int propagation_threads_; /**< \brief Number of threads used for large updates */
 
   VoxelGrid<PropDistanceFieldVoxel>::Ptr voxel_grid_; /**< \brief Actual container for distance data */
 
@@ -566,6 +655,9 @@ private:
 
   std::vector<double> sqrt_table_; /**< \brief Precomputed square root table for faster distance lookups */
 
+  std::vector<int> transform_distances_; /**< \brief Scratch squared distances for the parallel distance transform */
+  std::vector<int> transform_sites_; /**< \brief Scratch closest site indices for the parallel distance transform */
+
   /**
    * \brief Holds information on neighbor direction, with 27 different
    * directions.  Shows where to propagate given an integer distance
@@ -0,0 +1,312 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/distance_field/compact_distance_field.h>
+#include <Eigen/Core>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace distance_field
+{
+MOVEIT_CLASS_FORWARD(SparseDistanceField);  // Defines SparseDistanceFieldPtr, ConstPtr, WeakPtr... etc
+
+/**
+ * \brief A DistanceField implementation that only stores cells within
+ * the maximum distance of an obstacle.
+ *
+ * The grid is split into bricks of \ref BRICK_SIZE cells along each
+ * axis, and a brick is only allocated while one of its cells is an
+ * obstacle or closer than the maximum distance to one.  All other
+ * cells report the maximum distance.  The cells hold the same squared
+ * distances as the \ref CompactDistanceField, so a field over a large
+ * workspace costs memory in proportion to the space around the
+ * obstacles rather than to its volume; only a small brick table is
+ * kept for the whole grid.
+ *
+ * Updates recompute the bricks within the maximum distance of a
+ * changed cell with an exact Euclidean distance transform, so the
+ * distances are identical to those of a \ref CompactDistanceField
+ * with the same parameters.  The bricks are split across the number
+ * of threads given on construction.
+ */
+class SparseDistanceField : public DistanceField
+{
+public:
+  /** \brief The number of cells along each axis of a brick */
+  static const int BRICK_SIZE = 8;
+
+  /** \brief log2 of \ref BRICK_SIZE */
+  static const int BRICK_SHIFT = 3;
+
+  /** \brief The largest supported maximum distance, in cells */
+  static const int MAX_DISTANCE_CELLS = CompactDistanceField::MAX_DISTANCE_CELLS;
+
+  /**
+   * \brief Constructor that initializes entire distance field to
+   * empty - no brick is allocated and all cells report the maximum
+   * distance.
+   *
+   * @param [in] size_x The X dimension in meters of the volume to represent
+   * @param [in] size_y The Y dimension in meters of the volume to represent
+   * @param [in] size_z The Z dimension in meters of the volume to represent
+   * @param [in] resolution The resolution in meters of the volume
+   * @param [in] origin_x The minimum X point of the volume
+   * @param [in] origin_y The minimum Y point of the volume
+   * @param [in] origin_z The minimum Z point of the volume
+   *
+   * @param [in] max_distance The maximum distance to which distances
+   * are computed.  Cells that are further away are assigned the
+   * maximum distance value.  Clamped to \ref MAX_DISTANCE_CELLS cells.
+   *
+   * @param [in] propagate_negative_distances Whether or not to compute
+   * negative distances inside obstacles, see \ref
+   * PropagationDistanceField.
+   *
+   * @param [in] threads Number of threads used for updates, 0 selects
+   * one per hardware thread
+   */
+  SparseDistanceField(double size_x, double size_y, double size_z, double resolution, double origin_x,
+                      double origin_y, double origin_z, double max_distance, bool propagate_negative_distances = false,
+                      unsigned int threads = 1);
+
+  ~SparseDistanceField() override = default;
+
+  /**
+   * \brief Add a set of obstacle points to the distance field,
+   * updating distance values accordingly.  Points outside the field
+   * are ignored.
+   *
+   * @param [in] points The set of obstacle points to add
+   */
+  void addPointsToField(const EigenSTL::vector_Vector3d& points) override;
+
+  /**
+   * \brief Remove a set of obstacle points from the distance field,
+   * updating distance values accordingly.  Bricks that end up further
+   * than the maximum distance from any obstacle are released.
+   *
+   * @param [in] points The set of obstacle points that will be set as free
+   */
+  void removePointsFromField(const EigenSTL::vector_Vector3d& points) override;
+
+  /**
+   * \brief Removes any obstacle points that are in the old point set
+   * but not the new point set, and adds any obstacle points that are in
+   * the new point set but not the old point set, with a single distance
+   * update.
+   *
+   * @param [in] old_points The set of points that all should be obstacle cells in the distance field
+   * @param [in] new_points The set of points, all of which are intended to be obstacle points in the distance field
+   */
+  void updatePointsInField(const EigenSTL::vector_Vector3d& old_points,
+                           const EigenSTL::vector_Vector3d& new_points) override;
+
+  /**
+   * \brief Resets the entire distance field to max_distance for
+   * positive values and zero for negative values, releasing all
+   * bricks.
+   */
+  void reset() override;
+
+  /**
+   * \brief Get the distance value associated with the cell indicated
+   * by the world coordinate.  Behaves like \ref
+   * PropagationDistanceField::getDistance.
+   */
+  double getDistance(double x, double y, double z) const override;
+
+  /**
+   * \brief Get the distance value associated with the cell indicated
+   * by the index coordinates.  Invalid cells report the maximum
+   * distance.
+   */
+  double getDistance(int x, int y, int z) const override;
+
+  bool isCellValid(int x, int y, int z) const override;
+  int getXNumCells() const override;
+  int getYNumCells() const override;
+  int getZNumCells() const override;
+  std::size_t getMemoryBytes() const override;
+  bool gridToWorld(int x, int y, int z, double& world_x, double& world_y, double& world_z) const override;
+  bool worldToGrid(double world_x, double world_y, double world_z, int& x, int& y, int& z) const override;
+
+  /**
+   * \brief Writes the contents of the distance field to the supplied
+   * stream, in the same format as \ref
+   * PropagationDistanceField::writeToStream.
+   *
+   * @param [out] stream The stream to which to write the distance field contents.
+   *
+   * @return True
+   */
+  bool writeToStream(std::ostream& stream) const override;
+
+  /**
+   * \brief Reads, parameterizes, and populates the distance field
+   * based on the supplied stream, as written by \ref writeToStream or
+   * \ref PropagationDistanceField::writeToStream.
+   *
+   * @param [in] stream The stream from which to read
+   *
+   * @return True if reading, parameterizing, and populating the
+   * distance field is successful; otherwise False.
+   */
+  bool readFromStream(std::istream& stream) override;
+
+  /**
+   * \brief Gets the maximum distance, which is returned for all
+   * out-of-bounds queries and for cells in unallocated bricks.
+   */
+  double getUninitializedDistance() const override
+  {
+    return max_distance_;
+  }
+
+  /**
+   * \brief Gets full cell data given an index.  x,y,z MUST be valid.
+   * Cells in unallocated bricks report the maximum distance.
+   *
+   * @param [in] x The X index
+   * @param [in] y The Y index
+   * @param [in] z The Z index
+   *
+   * @return The data in the indicated cell.
+   */
+  CompactDistanceFieldVoxel getCell(int x, int y, int z) const
+  {
+    const CompactDistanceFieldVoxel* voxel = findCell(x, y, z);
+    return voxel ? *voxel : CompactDistanceFieldVoxel(max_distance_sq_, 0);
+  }
+
+  /**
+   * \brief Gets the maximum distance squared value, in cells.
+   */
+  int getMaximumDistanceSquared() const
+  {
+    return max_distance_sq_;
+  }
+
+  /** \brief The number of bricks currently holding cells */
+  std::size_t getAllocatedBrickCount() const
+  {
+    return bricks_.size() - free_bricks_.size();
+  }
+
+  /** \brief Sets the number of threads used for updates, 0 selects one per hardware thread */
+  void setThreads(unsigned int threads);
+
+private:
+  static const int BRICK_CELLS = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+  struct Brick
+  {
+    std::array<CompactDistanceFieldVoxel, BRICK_CELLS> cells;
+  };
+
+  /**
+   * \brief Initializes the field, releasing all bricks, sizing the
+   * brick table and building a sqrt lookup table for efficiency based
+   * on max_distance_.
+   */
+  void initialize();
+
+  std::size_t brickIndex(int x, int y, int z) const
+  {
+    return (std::size_t(x >> BRICK_SHIFT) * num_bricks_.y() + (y >> BRICK_SHIFT)) * num_bricks_.z() +
+           (z >> BRICK_SHIFT);
+  }
+
+  static int cellIndex(int x, int y, int z)
+  {
+    const int mask = BRICK_SIZE - 1;
+    return ((x & mask) << (2 * BRICK_SHIFT)) | ((y & mask) << BRICK_SHIFT) | (z & mask);
+  }
+
+  /** \brief The voxel of a valid cell, or nullptr if its brick is not allocated */
+  const CompactDistanceFieldVoxel* findCell(int x, int y, int z) const
+  {
+    const std::int32_t brick = brick_table_[brickIndex(x, y, z)];
+    return brick < 0 ? nullptr : &bricks_[brick].cells[cellIndex(x, y, z)];
+  }
+
+  /**
+   * \brief Marks a cell as obstacle or free, allocating its brick if
+   * needed, and records the brick as changed if the state of the cell
+   * changed.
+   *
+   * @return True if the state of the cell changed
+   */
+  bool setCellOccupied(const Eigen::Vector3i& cell, bool occupied, std::vector<std::size_t>& changed_bricks);
+
+  /**
+   * \brief Recomputes all bricks within the maximum distance of the
+   * changed bricks, allocating and releasing bricks as needed.
+   *
+   * @param changed_bricks The bricks in which cells changed state, may contain duplicates
+   */
+  void updateBricks(const std::vector<std::size_t>& changed_bricks);
+
+  std::int32_t allocateBrick();
+
+  /**
+   * \brief Determines distance based on actual voxel data
+   */
+  double getDistance(const CompactDistanceFieldVoxel& voxel) const
+  {
+    return sqrt_table_[voxel.distance_square_] - sqrt_table_[voxel.negative_distance_square_];
+  }
+
+  bool propagate_negative_; /**< \brief Whether or not to compute negative distances */
+  unsigned int threads_;    /**< \brief Number of threads used for updates */
+
+  double max_distance_;   /**< \brief Holds maximum distance  */
+  int max_distance_cells_; /**< \brief Holds maximum distance in cells, rounded up */
+  int max_distance_sq_;    /**< \brief Holds maximum distance squared in cells */
+
+  double oo_resolution_;        /**< \brief 1.0/resolution_ */
+  Eigen::Vector3d origin_minus_; /**< \brief origin - 0.5*resolution */
+  Eigen::Vector3i num_cells_;    /**< \brief The number of cells along each axis */
+  Eigen::Vector3i num_bricks_;   /**< \brief The number of bricks along each axis */
+
+  std::vector<std::int32_t> brick_table_; /**< \brief Index into bricks_ of each brick, -1 if not allocated */
+  std::vector<Brick> bricks_;             /**< \brief Storage of the allocated bricks */
+  std::vector<std::int32_t> free_bricks_; /**< \brief Released entries of bricks_, reused before growing it */
+
+  std::vector<double> sqrt_table_; /**< \brief Precomputed square root table for faster distance lookups */
+};
+}  // namespace distance_field
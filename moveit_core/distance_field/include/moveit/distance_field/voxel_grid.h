@@ -100,6 +100,14 @@ public:
    */
   VoxelGrid();
 
+  /**
+   * \brief Copy constructor, copies the size, resolution and all data
+   * elements of \e other.
+   */
+  VoxelGrid(const VoxelGrid<T>& other);
+
+  VoxelGrid<T>& operator=(const VoxelGrid<T>& other) = delete;
+
   /**
    * \brief Resize the VoxelGrid.
    *
@@ -360,6 +368,15 @@ VoxelGrid<T>::VoxelGrid() : data_(nullptr)
   stride2_ = 0;
 }
 
+template <typename T>
+VoxelGrid<T>::VoxelGrid(const VoxelGrid<T>& other) : data_(nullptr)
+{
+  resize(other.size_[DIM_X], other.size_[DIM_Y], other.size_[DIM_Z], other.resolution_, other.origin_[DIM_X],
+         other.origin_[DIM_Y], other.origin_[DIM_Z], other.default_object_);
+  if (data_)
+    std::copy(other.data_, other.data_ + num_cells_total_, data_);
+}
+
 template <typename T>
 void VoxelGrid<T>::resize(double size_x, double size_y, double size_z, double resolution, double origin_x,
                           double origin_y, double origin_z, T default_object)
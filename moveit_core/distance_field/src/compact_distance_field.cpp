@@ -0,0 +1,404 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/distance_field/compact_distance_field.h>
+#include <moveit/distance_field/distance_transform.h>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <bitset>
+
+namespace distance_field
+{
+// Logger
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_distance_field.compact_distance_field");
+
+CompactDistanceField::CompactDistanceField(double size_x, double size_y, double size_z, double resolution,
+                                           double origin_x, double origin_y, double origin_z, double max_distance,
+                                           bool propagate_negative_distances, unsigned int threads)
+  : DistanceField(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z)
+  , propagate_negative_(propagate_negative_distances)
+  , threads_(resolveThreadCount(threads))
+  , max_distance_(max_distance)
+{
+  initialize();
+}
+
+void CompactDistanceField::initialize()
+{
+  max_distance_cells_ = std::max(0, static_cast<int>(ceil(max_distance_ / resolution_)));
+  if (max_distance_cells_ > MAX_DISTANCE_CELLS)
+  {
+    RCLCPP_WARN(LOGGER, "Maximum distance %f exceeds %d cells at resolution %f, clamping", max_distance_,
+                MAX_DISTANCE_CELLS, resolution_);
+    max_distance_cells_ = MAX_DISTANCE_CELLS;
+    max_distance_ = MAX_DISTANCE_CELLS * resolution_;
+  }
+  max_distance_sq_ = max_distance_cells_ * max_distance_cells_;
+
+  voxel_grid_ = std::make_shared<VoxelGrid<CompactDistanceFieldVoxel>>(
+      size_x_, size_y_, size_z_, resolution_, origin_x_, origin_y_, origin_z_,
+      CompactDistanceFieldVoxel(max_distance_sq_, 0));
+
+  // create a sqrt table:
+  sqrt_table_.resize(max_distance_sq_ + 1);
+  for (int i = 0; i <= max_distance_sq_; ++i)
+    sqrt_table_[i] = sqrt(double(i)) * resolution_;
+
+  reset();
+}
+
+bool CompactDistanceField::setCellOccupied(const Eigen::Vector3i& cell, bool occupied, Eigen::Vector3i& changed_min,
+                                           Eigen::Vector3i& changed_max)
+{
+  CompactDistanceFieldVoxel& voxel = voxel_grid_->getCell(cell.x(), cell.y(), cell.z());
+  if ((voxel.distance_square_ == 0) == occupied)
+    return false;
+
+  // the region update recomputes the exact values, it only needs to tell obstacles from free cells
+  voxel.distance_square_ = occupied ? 0 : max_distance_sq_;
+  changed_min = changed_min.cwiseMin(cell);
+  changed_max = changed_max.cwiseMax(cell);
+  return true;
+}
+
+void CompactDistanceField::addPointsToField(const EigenSTL::vector_Vector3d& points)
+{
+  Eigen::Vector3i changed_min = Eigen::Vector3i::Constant(std::numeric_limits<int>::max());
+  Eigen::Vector3i changed_max = Eigen::Vector3i::Constant(std::numeric_limits<int>::min());
+  bool changed = false;
+  for (const Eigen::Vector3d& point : points)
+  {
+    Eigen::Vector3i cell;
+    if (worldToGrid(point.x(), point.y(), point.z(), cell.x(), cell.y(), cell.z()))
+      changed |= setCellOccupied(cell, true, changed_min, changed_max);
+  }
+  if (changed)
+    updateRegion(changed_min, changed_max);
+}
+
+void CompactDistanceField::removePointsFromField(const EigenSTL::vector_Vector3d& points)
+{
+  Eigen::Vector3i changed_min = Eigen::Vector3i::Constant(std::numeric_limits<int>::max());
+  Eigen::Vector3i changed_max = Eigen::Vector3i::Constant(std::numeric_limits<int>::min());
+  bool changed = false;
+  for (const Eigen::Vector3d& point : points)
+  {
+    Eigen::Vector3i cell;
+    if (worldToGrid(point.x(), point.y(), point.z(), cell.x(), cell.y(), cell.z()))
+      changed |= setCellOccupied(cell, false, changed_min, changed_max);
+  }
+  if (changed)
+    updateRegion(changed_min, changed_max);
+}
+
+void CompactDistanceField::updatePointsInField(const EigenSTL::vector_Vector3d& old_points,
+                                               const EigenSTL::vector_Vector3d& new_points)
+{
+  // freeing the old cells and then occupying the new ones leaves cells in both sets occupied, and a
+  // single region update covers both changes
+  Eigen::Vector3i changed_min = Eigen::Vector3i::Constant(std::numeric_limits<int>::max());
+  Eigen::Vector3i changed_max = Eigen::Vector3i::Constant(std::numeric_limits<int>::min());
+  bool changed = false;
+  for (const Eigen::Vector3d& point : old_points)
+  {
+    Eigen::Vector3i cell;
+    if (worldToGrid(point.x(), point.y(), point.z(), cell.x(), cell.y(), cell.z()))
+      changed |= setCellOccupied(cell, false, changed_min, changed_max);
+  }
+  for (const Eigen::Vector3d& point : new_points)
+  {
+    Eigen::Vector3i cell;
+    if (worldToGrid(point.x(), point.y(), point.z(), cell.x(), cell.y(), cell.z()))
+      changed |= setCellOccupied(cell, true, changed_min, changed_max);
+  }
+  if (changed)
+    updateRegion(changed_min, changed_max);
+}
+
+void CompactDistanceField::updateRegion(const Eigen::Vector3i& changed_min, const Eigen::Vector3i& changed_max)
+{
+  const Eigen::Vector3i num_cells(getXNumCells(), getYNumCells(), getZNumCells());
+  const Eigen::Vector3i reach = Eigen::Vector3i::Constant(max_distance_cells_);
+
+  // only cells within the maximum distance of a change can see a different distance, and any site closer
+  // than the maximum distance to those cells lies within twice the maximum distance of the change
+  const Eigen::Vector3i update_min = (changed_min - reach).cwiseMax(0);
+  const Eigen::Vector3i update_max = (changed_max + reach).cwiseMin(num_cells - Eigen::Vector3i::Ones());
+  const Eigen::Vector3i box_min = (changed_min - 2 * reach).cwiseMax(0);
+  const Eigen::Vector3i box_max = (changed_max + 2 * reach).cwiseMin(num_cells - Eigen::Vector3i::Ones());
+  const Eigen::Vector3i box_size = box_max - box_min + Eigen::Vector3i::Ones();
+  const std::size_t box_stride_x = std::size_t(box_size.y()) * box_size.z();
+  const std::size_t box_stride_y = box_size.z();
+  transform_distances_.resize(box_stride_x * box_size.x());
+
+  // negative distances first, both passes tell obstacles from free cells by a zero distance_square_
+  for (bool negative : { true, false })
+  {
+    if (negative && !propagate_negative_)
+      continue;
+
+    parallelFor(box_size.x(), threads_, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t bx = begin; bx < end; ++bx)
+      {
+        for (int by = 0; by < box_size.y(); ++by)
+        {
+          const CompactDistanceFieldVoxel* voxel = &voxel_grid_->getCell(box_min.x() + bx, box_min.y() + by, box_min.z());
+          int* distance = &transform_distances_[bx * box_stride_x + by * box_stride_y];
+          for (int bz = 0; bz < box_size.z(); ++bz)
+            distance[bz] = ((voxel[bz].distance_square_ == 0) != negative) ? 0 : DISTANCE_TRANSFORM_INFINITY;
+        }
+      }
+    });
+
+    computeSquaredDistanceTransform(box_size.x(), box_size.y(), box_size.z(), transform_distances_, nullptr, threads_);
+
+    const Eigen::Vector3i offset = update_min - box_min;
+    const Eigen::Vector3i update_size = update_max - update_min + Eigen::Vector3i::Ones();
+    parallelFor(update_size.x(), threads_, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t ux = begin; ux < end; ++ux)
+      {
+        for (int uy = 0; uy < update_size.y(); ++uy)
+        {
+          CompactDistanceFieldVoxel* voxel =
+              &voxel_grid_->getCell(update_min.x() + ux, update_min.y() + uy, update_min.z());
+          const int* distance =
+              &transform_distances_[(offset.x() + ux) * box_stride_x + (offset.y() + uy) * box_stride_y + offset.z()];
+          for (int uz = 0; uz < update_size.z(); ++uz)
+          {
+            const std::uint16_t value = std::min(distance[uz], max_distance_sq_);
+            if (negative)
+              voxel[uz].negative_distance_square_ = value;
+            else
+              voxel[uz].distance_square_ = value;
+          }
+        }
+      }
+    });
+  }
+}
+
+void CompactDistanceField::reset()
+{
+  voxel_grid_->reset(CompactDistanceFieldVoxel(max_distance_sq_, 0));
+}
+
+double CompactDistanceField::getDistance(double x, double y, double z) const
+{
+  return getDistance((*voxel_grid_.get())(x, y, z));
+}
+
+double CompactDistanceField::getDistance(int x, int y, int z) const
+{
+  return getDistance(voxel_grid_->getCell(x, y, z));
+}
+
+void CompactDistanceField::computeDistanceGradients(const Eigen::Vector3d* points, std::size_t count,
+                                                    double* distances, Eigen::Vector3d* gradients,
+                                                    unsigned char* in_bounds) const
+{
+  if (count == 0)
+    return;
+
+  const int num_x = voxel_grid_->getNumCells(DIM_X);
+  const int num_y = voxel_grid_->getNumCells(DIM_Y);
+  const int num_z = voxel_grid_->getNumCells(DIM_Z);
+  const double resolution = voxel_grid_->getResolution();
+  const double oo_resolution = 1.0 / resolution;
+  const double origin_minus_x = voxel_grid_->getOrigin(DIM_X) - 0.5 * resolution;
+  const double origin_minus_y = voxel_grid_->getOrigin(DIM_Y) - 0.5 * resolution;
+  const double origin_minus_z = voxel_grid_->getOrigin(DIM_Z) - 0.5 * resolution;
+  const std::ptrdiff_t stride_x = static_cast<std::ptrdiff_t>(num_y) * num_z;
+  const std::ptrdiff_t stride_y = num_z;
+  const CompactDistanceFieldVoxel* origin_cell = &voxel_grid_->getCell(0, 0, 0);
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const Eigen::Vector3d& p = points[i];
+    const int gx = int(floor((p.x() - origin_minus_x) * oo_resolution));
+    const int gy = int(floor((p.y() - origin_minus_y) * oo_resolution));
+    const int gz = int(floor((p.z() - origin_minus_z) * oo_resolution));
+
+    // we need extra padding of 1 to get gradients
+    if (gx < 1 || gy < 1 || gz < 1 || gx >= num_x - 1 || gy >= num_y - 1 || gz >= num_z - 1)
+    {
+      gradients[i].setZero();
+      distances[i] = max_distance_;
+      in_bounds[i] = false;
+      continue;
+    }
+
+    const CompactDistanceFieldVoxel* cell = origin_cell + gx * stride_x + gy * stride_y + gz;
+    gradients[i].x() = (getDistance(cell[stride_x]) - getDistance(cell[-stride_x])) * inv_twice_resolution_;
+    gradients[i].y() = (getDistance(cell[stride_y]) - getDistance(cell[-stride_y])) * inv_twice_resolution_;
+    gradients[i].z() = (getDistance(cell[1]) - getDistance(cell[-1])) * inv_twice_resolution_;
+    distances[i] = getDistance(*cell);
+    in_bounds[i] = true;
+  }
+}
+
+bool CompactDistanceField::isCellValid(int x, int y, int z) const
+{
+  return voxel_grid_->isCellValid(x, y, z);
+}
+
+int CompactDistanceField::getXNumCells() const
+{
+  return voxel_grid_->getNumCells(DIM_X);
+}
+
+int CompactDistanceField::getYNumCells() const
+{
+  return voxel_grid_->getNumCells(DIM_Y);
+}
+
+int CompactDistanceField::getZNumCells() const
+{
+  return voxel_grid_->getNumCells(DIM_Z);
+}
+
+std::size_t CompactDistanceField::getMemoryBytes() const
+{
+  const std::size_t cells = static_cast<std::size_t>(getXNumCells()) * getYNumCells() * getZNumCells();
+  return sizeof(CompactDistanceField) + sizeof(CompactDistanceFieldVoxel) * cells +
+         sizeof(double) * sqrt_table_.capacity() + sizeof(int) * transform_distances_.capacity();
+}
+
+bool CompactDistanceField::gridToWorld(int x, int y, int z, double& world_x, double& world_y, double& world_z) const
+{
+  voxel_grid_->gridToWorld(x, y, z, world_x, world_y, world_z);
+  return true;
+}
+
+bool CompactDistanceField::worldToGrid(double world_x, double world_y, double world_z, int& x, int& y, int& z) const
+{
+  return voxel_grid_->worldToGrid(world_x, world_y, world_z, x, y, z);
+}
+
+bool CompactDistanceField::writeToStream(std::ostream& os) const
+{
+  os << "resolution: " << resolution_ << '\n';
+  os << "size_x: " << size_x_ << '\n';
+  os << "size_y: " << size_y_ << '\n';
+  os << "size_z: " << size_z_ << '\n';
+  os << "origin_x: " << origin_x_ << '\n';
+  os << "origin_y: " << origin_y_ << '\n';
+  os << "origin_z: " << origin_z_ << '\n';
+
+  // obstacle cells as bits along z, zlib compressed
+  boost::iostreams::filtering_ostream out;
+  out.push(boost::iostreams::zlib_compressor());
+  out.push(os);
+
+  for (int x = 0; x < getXNumCells(); ++x)
+  {
+    for (int y = 0; y < getYNumCells(); ++y)
+    {
+      for (int z = 0; z < getZNumCells(); z += 8)
+      {
+        std::bitset<8> bs(0);
+        const int zv = std::min(8, getZNumCells() - z);
+        for (int zi = 0; zi < zv; ++zi)
+        {
+          if (getCell(x, y, z + zi).distance_square_ == 0)
+            bs[zi] = 1;
+        }
+        out.write(reinterpret_cast<char*>(&bs), sizeof(char));
+      }
+    }
+  }
+  out.flush();
+  return true;
+}
+
+bool CompactDistanceField::readFromStream(std::istream& is)
+{
+  if (!is.good())
+    return false;
+
+  const auto read_value = [&is](const std::string& key, double& value) {
+    std::string temp;
+    is >> temp;
+    if (temp != key)
+      return false;
+    is >> value;
+    return true;
+  };
+  if (!read_value("resolution:", resolution_) || !read_value("size_x:", size_x_) ||
+      !read_value("size_y:", size_y_) || !read_value("size_z:", size_z_) || !read_value("origin_x:", origin_x_) ||
+      !read_value("origin_y:", origin_y_) || !read_value("origin_z:", origin_z_))
+    return false;
+  inv_twice_resolution_ = 1.0 / (2.0 * resolution_);
+
+  // previous values for propagate_negative_ and max_distance_ will be used
+  initialize();
+
+  // this should be newline
+  char nl;
+  is.get(nl);
+
+  boost::iostreams::filtering_istream in;
+  in.push(boost::iostreams::zlib_decompressor());
+  in.push(is);
+
+  Eigen::Vector3i changed_min = Eigen::Vector3i::Constant(std::numeric_limits<int>::max());
+  Eigen::Vector3i changed_max = Eigen::Vector3i::Constant(std::numeric_limits<int>::min());
+  bool changed = false;
+  for (int x = 0; x < getXNumCells(); ++x)
+  {
+    for (int y = 0; y < getYNumCells(); ++y)
+    {
+      for (int z = 0; z < getZNumCells(); z += 8)
+      {
+        char inchar;
+        if (!in.good())
+          return false;
+        in.get(inchar);
+        std::bitset<8> inbit(static_cast<unsigned long long>(inchar));
+        const int zv = std::min(8, getZNumCells() - z);
+        for (int zi = 0; zi < zv; ++zi)
+        {
+          if (inbit[zi] == 1)
+            changed |= setCellOccupied(Eigen::Vector3i(x, y, z + zi), true, changed_min, changed_max);
+        }
+      }
+    }
+  }
+  if (changed)
+    updateRegion(changed_min, changed_max);
+  return true;
+}
+}  // namespace distance_field
@@ -35,6 +35,7 @@
 /* Author: Mrinal Kalakrishnan, Ken Anderson, E. Gil Jones */
 
 #include <moveit/distance_field/distance_field.h>
+#include <moveit/distance_field/distance_transform.h>
 #include <moveit/distance_field/find_internal_points.h>
 #include <geometric_shapes/body_operations.h>
 #include <rclcpp/logger.hpp>
@@ -90,6 +91,46 @@ double DistanceField::getDistanceGradient(double x, double y, double z, double&
   return getDistance(gx, gy, gz);
 }
 
+void DistanceField::getDistanceGradients(const EigenSTL::vector_Vector3d& points, std::vector<double>& distances,
+                                         EigenSTL::vector_Vector3d& gradients, std::vector<unsigned char>& in_bounds,
+                                         unsigned int threads) const
+{
+  distances.resize(points.size());
+  gradients.resize(points.size());
+  in_bounds.resize(points.size());
+  getDistanceGradients(points.data(), points.size(), distances.data(), gradients.data(), in_bounds.data(), threads);
+}
+
+void DistanceField::getDistanceGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                                         Eigen::Vector3d* gradients, unsigned char* in_bounds,
+                                         unsigned int threads) const
+{
+  // starting a thread costs about as much as a few thousand lookups
+  const std::size_t chunks =
+      std::min<std::size_t>(resolveThreadCount(threads), count / MIN_GRADIENT_QUERIES_PER_THREAD);
+  if (chunks <= 1)
+  {
+    computeDistanceGradients(points, count, distances, gradients, in_bounds);
+    return;
+  }
+  parallelFor(count, static_cast<unsigned int>(chunks), [&](std::size_t begin, std::size_t end) {
+    computeDistanceGradients(points + begin, end - begin, distances + begin, gradients + begin, in_bounds + begin);
+  });
+}
+
+void DistanceField::computeDistanceGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                                             Eigen::Vector3d* gradients, unsigned char* in_bounds) const
+{
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const Eigen::Vector3d& p = points[i];
+    Eigen::Vector3d& grad = gradients[i];
+    bool valid;
+    distances[i] = getDistanceGradient(p.x(), p.y(), p.z(), grad.x(), grad.y(), grad.z(), valid);
+    in_bounds[i] = valid;
+  }
+}
+
 void DistanceField::getIsoSurfaceMarkers(double min_distance, double max_distance, const std::string& frame_id,
                                          const rclcpp::Time& stamp, visualization_msgs::msg::Marker& inf_marker) const
 {
@@ -0,0 +1,133 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/distance_field/distance_transform.h>
+
+namespace distance_field
+{
+namespace
+{
+// One dimensional squared distance transform over f, which holds DISTANCE_TRANSFORM_INFINITY where there
+// is no site.  Writes the squared distances to d and the index of the minimizing element to arg.  v and z
+// are scratch space of size n and n + 1.
+void squaredDistanceTransform(const int* f, int n, int* d, int* arg, int* v, double* z)
+{
+  int k = -1;
+  for (int q = 0; q < n; ++q)
+  {
+    if (f[q] == DISTANCE_TRANSFORM_INFINITY)
+      continue;
+
+    double s = 0.0;
+    while (k >= 0)
+    {
+      const int p = v[k];
+      s = ((double(f[q]) + double(q) * q) - (double(f[p]) + double(p) * p)) / (2.0 * (q - p));
+      if (s > z[k])
+        break;
+      --k;
+    }
+    ++k;
+    v[k] = q;
+    z[k] = k == 0 ? -std::numeric_limits<double>::infinity() : s;
+  }
+
+  if (k < 0)
+  {
+    std::fill(d, d + n, DISTANCE_TRANSFORM_INFINITY);
+    std::fill(arg, arg + n, -1);
+    return;
+  }
+  z[k + 1] = std::numeric_limits<double>::infinity();
+
+  int j = 0;
+  for (int q = 0; q < n; ++q)
+  {
+    while (z[j + 1] < q)
+      ++j;
+    d[q] = (q - v[j]) * (q - v[j]) + f[v[j]];
+    arg[q] = v[j];
+  }
+}
+
+// Runs the 1D transform along lines of length cells separated by step.  Line l starts at flat index
+// (l / inner_lines) * outer_stride + (l % inner_lines) * inner_stride.
+void distanceTransformPass(std::vector<int>& distances, std::vector<int>* sites, std::size_t lines,
+                           std::size_t inner_lines, std::size_t outer_stride, std::size_t inner_stride, int length,
+                           std::size_t step, unsigned int threads)
+{
+  parallelFor(lines, threads, [&](std::size_t begin, std::size_t end) {
+    std::vector<int> f(length), d(length), arg(length), line_sites(sites ? length : 0), v(length);
+    std::vector<double> z(length + 1);
+    for (std::size_t l = begin; l < end; ++l)
+    {
+      const std::size_t start = (l / inner_lines) * outer_stride + (l % inner_lines) * inner_stride;
+      for (int q = 0; q < length; ++q)
+        f[q] = distances[start + q * step];
+      if (sites)
+      {
+        for (int q = 0; q < length; ++q)
+          line_sites[q] = (*sites)[start + q * step];
+      }
+
+      squaredDistanceTransform(f.data(), length, d.data(), arg.data(), v.data(), z.data());
+
+      for (int q = 0; q < length; ++q)
+        distances[start + q * step] = d[q];
+      if (sites)
+      {
+        for (int q = 0; q < length; ++q)
+          (*sites)[start + q * step] = arg[q] < 0 ? -1 : line_sites[arg[q]];
+      }
+    }
+  });
+}
+}  // namespace
+
+void computeSquaredDistanceTransform(int num_x, int num_y, int num_z, std::vector<int>& distances,
+                                     std::vector<int>* sites, unsigned int threads)
+{
+  if (num_x <= 0 || num_y <= 0 || num_z <= 0)
+    return;
+
+  const std::size_t stride_x = std::size_t(num_y) * num_z;
+  const std::size_t stride_y = num_z;
+
+  // z lines are contiguous, then the y and x passes combine them into full 3D distances
+  distanceTransformPass(distances, sites, std::size_t(num_x) * num_y, num_y, stride_x, stride_y, num_z, 1, threads);
+  distanceTransformPass(distances, sites, std::size_t(num_x) * num_z, num_z, stride_x, 1, num_y, stride_y, threads);
+  distanceTransformPass(distances, sites, stride_x, stride_x, 0, 1, num_x, stride_x, threads);
+}
+}  // namespace distance_field
@@ -35,6 +35,7 @@
 /* Author: Mrinal Kalakrishnan, Ken Anderson */
 
 #include <moveit/distance_field/propagation_distance_field.h>
+#include <moveit/distance_field/distance_transform.h>
 #include <visualization_msgs/msg/marker.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/copy.hpp>
@@ -49,9 +50,11 @@ static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_distance_field.p
 
 PropagationDistanceField::PropagationDistanceField(double size_x, double size_y, double size_z, double resolution,
                                                    double origin_x, double origin_y, double origin_z,
-                                                   double max_distance, bool propagate_negative)
+                                                   double max_distance, bool propagate_negative,
+                                                   unsigned int propagation_threads)
   : DistanceField(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z)
   , propagate_negative_(propagate_negative)
+  , propagation_threads_(resolveThreadCount(propagation_threads))
   , max_distance_(max_distance)
 {
   initialize();
@@ -59,10 +62,12 @@ PropagationDistanceField::PropagationDistanceField(double size_x, double size_y,
 
 PropagationDistanceField::PropagationDistanceField(const octomap::OcTree& octree, const octomap::point3d& bbx_min,
                                                    const octomap::point3d& bbx_max, double max_distance,
-                                                   bool propagate_negative_distances)
+                                                   bool propagate_negative_distances,
+                                                   unsigned int propagation_threads)
   : DistanceField(bbx_max.x() - bbx_min.x(), bbx_max.y() - bbx_min.y(), bbx_max.z() - bbx_min.z(),
                   octree.getResolution(), bbx_min.x(), bbx_min.y(), bbx_min.z())
   , propagate_negative_(propagate_negative_distances)
+  , propagation_threads_(resolveThreadCount(propagation_threads))
   , max_distance_(max_distance)
   , max_distance_sq_(0)  // avoid gcc warning about uninitialized value
 {
@@ -71,12 +76,30 @@ PropagationDistanceField::PropagationDistanceField(const octomap::OcTree& octree
 }
 
 PropagationDistanceField::PropagationDistanceField(std::istream& is, double max_distance,
-                                                   bool propagate_negative_distances)
-  : DistanceField(0, 0, 0, 0, 0, 0, 0), propagate_negative_(propagate_negative_distances), max_distance_(max_distance)
+                                                   bool propagate_negative_distances, unsigned int propagation_threads)
+  : DistanceField(0, 0, 0, 0, 0, 0, 0)
+  , propagate_negative_(propagate_negative_distances)
+  , propagation_threads_(resolveThreadCount(propagation_threads))
+  , max_distance_(max_distance)
 {
   readFromStream(is);
 }
 
+PropagationDistanceField::PropagationDistanceField(const PropagationDistanceField& other)
+  : DistanceField(other)
+  , propagate_negative_(other.propagate_negative_)
+  , propagation_threads_(other.propagation_threads_)
+  , voxel_grid_(std::make_shared<VoxelGrid<PropDistanceFieldVoxel>>(*other.voxel_grid_))
+  , bucket_queue_(other.bucket_queue_.size())
+  , negative_bucket_queue_(other.negative_bucket_queue_.size())
+  , max_distance_(other.max_distance_)
+  , max_distance_sq_(other.max_distance_sq_)
+  , sqrt_table_(other.sqrt_table_)
+  , neighborhoods_(other.neighborhoods_)
+  , direction_number_to_direction_(other.direction_number_to_direction_)
+{
+}
+
 void PropagationDistanceField::initialize()
 {
   max_distance_sq_ = ceil(max_distance_ / resolution_) * ceil(max_distance_ / resolution_);
@@ -215,6 +238,20 @@ void PropagationDistanceField::removePointsFromField(const EigenSTL::vector_Vect
 void PropagationDistanceField::addNewObstacleVoxels(const EigenSTL::vector_Vector3i& voxel_points)
 {
   int initial_update_direction = getDirectionNumber(0, 0, 0);
+
+  if (useFullRecompute(voxel_points.size()))
+  {
+    for (const Eigen::Vector3i& voxel_point : voxel_points)
+    {
+      PropDistanceFieldVoxel& voxel = voxel_grid_->getCell(voxel_point.x(), voxel_point.y(), voxel_point.z());
+      voxel.distance_square_ = 0;
+      voxel.closest_point_ = voxel_point;
+      voxel.update_direction_ = initial_update_direction;
+    }
+    recomputeField();
+    return;
+  }
+
   bucket_queue_[0].reserve(voxel_points.size());
   EigenSTL::vector_Vector3i negative_stack;
   if (propagate_negative_)
@@ -301,6 +338,19 @@ void PropagationDistanceField::removeObstacleVoxels(const EigenSTL::vector_Vecto
   EigenSTL::vector_Vector3i negative_stack;
   int initial_update_direction = getDirectionNumber(0, 0, 0);
 
+  if (useFullRecompute(voxel_points.size()))
+  {
+    for (const Eigen::Vector3i& voxel_point : voxel_points)
+    {
+      PropDistanceFieldVoxel& voxel = voxel_grid_->getCell(voxel_point.x(), voxel_point.y(), voxel_point.z());
+      voxel.distance_square_ = max_distance_sq_;
+      voxel.closest_point_ = voxel_point;
+      voxel.update_direction_ = initial_update_direction;
+    }
+    recomputeField();
+    return;
+  }
+
   stack.reserve(getXNumCells() * getYNumCells() * getZNumCells());
   bucket_queue_[0].reserve(voxel_points.size());
   if (propagate_negative_)
@@ -497,6 +547,90 @@ void PropagationDistanceField::propagateNegative()
   }
 }
 
+bool PropagationDistanceField::useFullRecompute(std::size_t changed_voxels) const
+{
+  if (propagation_threads_ <= 1 || changed_voxels == 0)
+    return false;
+
+  // the incremental propagation touches roughly a cube of side 2 * max_distance around each changed voxel,
+  // while the distance transform visits every cell three times per sign, split across the threads
+  const double num_cells = double(getXNumCells()) * getYNumCells() * getZNumCells();
+  const double reach = 2.0 * ceil(max_distance_ / resolution_) + 1.0;
+  const double incremental_cost = std::min(double(changed_voxels) * reach * reach * reach, num_cells);
+  const double recompute_cost = 3.0 * (propagate_negative_ ? 2.0 : 1.0) * num_cells / propagation_threads_;
+  return incremental_cost > recompute_cost;
+}
+
+void PropagationDistanceField::recomputeField()
+{
+  // the negative pass runs first, it identifies obstacles by a zero distance_square_ and the positive pass
+  // would otherwise make that ambiguous when max_distance_sq_ is zero
+  if (propagate_negative_)
+    computeDistanceTransform(true);
+  computeDistanceTransform(false);
+}
+
+void PropagationDistanceField::computeDistanceTransform(bool negative)
+{
+  const int num_x = getXNumCells();
+  const int num_y = getYNumCells();
+  const int num_z = getZNumCells();
+  const std::size_t num_cells = std::size_t(num_x) * num_y * num_z;
+  if (num_cells == 0)
+    return;
+
+  const int stride_x = num_y * num_z;
+  const int stride_y = num_z;
+  PropDistanceFieldVoxel* cells = &voxel_grid_->getCell(0, 0, 0);
+  transform_distances_.resize(num_cells);
+  transform_sites_.resize(num_cells);
+
+  // obstacle cells are the sites for positive distances, unoccupied cells for negative ones
+  parallelFor(num_cells, propagation_threads_, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const bool site = (cells[i].distance_square_ == 0) != negative;
+      transform_distances_[i] = site ? 0 : DISTANCE_TRANSFORM_INFINITY;
+      transform_sites_[i] = site ? int(i) : -1;
+    }
+  });
+
+  computeSquaredDistanceTransform(num_x, num_y, num_z, transform_distances_, &transform_sites_, propagation_threads_);
+
+  // same conventions as the propagation: only distances below the maximum are stored, everything else keeps
+  // the maximum with an uninitialized closest point
+  Eigen::Vector3i uninitialized;
+  uninitialized.x() = PropDistanceFieldVoxel::UNINITIALIZED;
+  uninitialized.y() = PropDistanceFieldVoxel::UNINITIALIZED;
+  uninitialized.z() = PropDistanceFieldVoxel::UNINITIALIZED;
+  parallelFor(num_cells, propagation_threads_, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const int distance_sq = transform_distances_[i];
+      const int site = transform_sites_[i];
+      const bool reached = distance_sq == 0 || distance_sq < max_distance_sq_;
+      const Eigen::Vector3i closest =
+          reached ? Eigen::Vector3i(site / stride_x, (site % stride_x) / stride_y, site % stride_y) : uninitialized;
+      PropDistanceFieldVoxel& cell = cells[i];
+      if (negative)
+      {
+        cell.negative_distance_square_ = reached ? distance_sq : max_distance_sq_;
+        cell.closest_negative_point_ = closest;
+      }
+      else
+      {
+        cell.distance_square_ = reached ? distance_sq : max_distance_sq_;
+        cell.closest_point_ = closest;
+      }
+    }
+  });
+}
+
+void PropagationDistanceField::setPropagationThreads(unsigned int threads)
+{
+  propagation_threads_ = resolveThreadCount(threads);
+}
+
 void PropagationDistanceField::reset()
 {
   voxel_grid_->reset(PropDistanceFieldVoxel(max_distance_sq_, 0));
@@ -595,6 +729,56 @@ double PropagationDistanceField::getDistance(int x, int y, int z) const
   return getDistance(voxel_grid_->getCell(x, y, z));
 }
 
+void PropagationDistanceField::computeDistanceGradients(const Eigen::Vector3d* points, std::size_t count,
+                                                        double* distances, Eigen::Vector3d* gradients,
+                                                        unsigned char* in_bounds) const
+{
+  if (count == 0)
+    return;
+
+  // grid geometry is loop invariant, so fetch it once instead of once per query
+  const int num_x = voxel_grid_->getNumCells(DIM_X);
+  const int num_y = voxel_grid_->getNumCells(DIM_Y);
+  const int num_z = voxel_grid_->getNumCells(DIM_Z);
+  const double resolution = voxel_grid_->getResolution();
+  const double oo_resolution = 1.0 / resolution;
+  const double origin_minus_x = voxel_grid_->getOrigin(DIM_X) - 0.5 * resolution;
+  const double origin_minus_y = voxel_grid_->getOrigin(DIM_Y) - 0.5 * resolution;
+  const double origin_minus_z = voxel_grid_->getOrigin(DIM_Z) - 0.5 * resolution;
+  const std::ptrdiff_t stride_x = static_cast<std::ptrdiff_t>(num_y) * num_z;
+  const std::ptrdiff_t stride_y = num_z;
+  const double* sqrt_table = sqrt_table_.data();
+  const PropDistanceFieldVoxel* origin_cell = &voxel_grid_->getCell(0, 0, 0);
+
+  const auto cell_distance = [sqrt_table](const PropDistanceFieldVoxel& cell) {
+    return sqrt_table[cell.distance_square_] - sqrt_table[cell.negative_distance_square_];
+  };
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const Eigen::Vector3d& p = points[i];
+    const int gx = int(floor((p.x() - origin_minus_x) * oo_resolution));
+    const int gy = int(floor((p.y() - origin_minus_y) * oo_resolution));
+    const int gz = int(floor((p.z() - origin_minus_z) * oo_resolution));
+
+    // same padding of 1 as the scalar query, the gradient needs both neighbours
+    if (gx < 1 || gy < 1 || gz < 1 || gx >= num_x - 1 || gy >= num_y - 1 || gz >= num_z - 1)
+    {
+      gradients[i].setZero();
+      distances[i] = max_distance_;
+      in_bounds[i] = false;
+      continue;
+    }
+
+    const PropDistanceFieldVoxel* cell = origin_cell + gx * stride_x + gy * stride_y + gz;
+    gradients[i].x() = (cell_distance(cell[stride_x]) - cell_distance(cell[-stride_x])) * inv_twice_resolution_;
+    gradients[i].y() = (cell_distance(cell[stride_y]) - cell_distance(cell[-stride_y])) * inv_twice_resolution_;
+    gradients[i].z() = (cell_distance(cell[1]) - cell_distance(cell[-1])) * inv_twice_resolution_;
+    distances[i] = cell_distance(*cell);
+    in_bounds[i] = true;
+  }
+}
+
 bool PropagationDistanceField::isCellValid(int x, int y, int z) const
 {
   return voxel_grid_->isCellValid(x, y, z);
@@ -615,6 +799,20 @@ int PropagationDistanceField::getZNumCells() const
   return voxel_grid_->getNumCells(DIM_Z);
 }
 
+std::size_t PropagationDistanceField::getMemoryBytes() const
+{
+  const std::size_t cells = static_cast<std::size_t>(getXNumCells()) * getYNumCells() * getZNumCells();
+  std::size_t bytes = sizeof(PropagationDistanceField) + sizeof(PropDistanceFieldVoxel) * cells +
+                      sizeof(double) * sqrt_table_.capacity() +
+                      sizeof(int) * (transform_distances_.capacity() + transform_sites_.capacity());
+  for (const std::vector<EigenSTL::vector_Vector3i>* queues : { &bucket_queue_, &negative_bucket_queue_ })
+  {
+    for (const EigenSTL::vector_Vector3i& queue : *queues)
+      bytes += sizeof(Eigen::Vector3i) * queue.capacity();
+  }
+  return bytes;
+}
+
 bool PropagationDistanceField::gridToWorld(int x, int y, int z, double& world_x, double& world_y, double& world_z) const
 {
   voxel_grid_->gridToWorld(x, y, z, world_x, world_y, world_z);
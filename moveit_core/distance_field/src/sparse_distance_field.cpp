@@ -0,0 +1,456 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/distance_field/sparse_distance_field.h>
+#include <moveit/distance_field/distance_transform.h>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <algorithm>
+#include <bitset>
+
+namespace distance_field
+{
+// Logger
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_distance_field.sparse_distance_field");
+
+SparseDistanceField::SparseDistanceField(double size_x, double size_y, double size_z, double resolution,
+                                         double origin_x, double origin_y, double origin_z, double max_distance,
+                                         bool propagate_negative_distances, unsigned int threads)
+  : DistanceField(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z)
+  , propagate_negative_(propagate_negative_distances)
+  , threads_(resolveThreadCount(threads))
+  , max_distance_(max_distance)
+{
+  initialize();
+}
+
+void SparseDistanceField::initialize()
+{
+  max_distance_cells_ = std::max(0, static_cast<int>(ceil(max_distance_ / resolution_)));
+  if (max_distance_cells_ > MAX_DISTANCE_CELLS)
+  {
+    RCLCPP_WARN(LOGGER, "Maximum distance %f exceeds %d cells at resolution %f, clamping", max_distance_,
+                MAX_DISTANCE_CELLS, resolution_);
+    max_distance_cells_ = MAX_DISTANCE_CELLS;
+    max_distance_ = MAX_DISTANCE_CELLS * resolution_;
+  }
+  max_distance_sq_ = max_distance_cells_ * max_distance_cells_;
+
+  // same cell layout as a VoxelGrid of this size
+  oo_resolution_ = 1.0 / resolution_;
+  origin_minus_ = Eigen::Vector3d(origin_x_, origin_y_, origin_z_) - Eigen::Vector3d::Constant(0.5 * resolution_);
+  num_cells_ = Eigen::Vector3i(static_cast<int>(size_x_ * oo_resolution_), static_cast<int>(size_y_ * oo_resolution_),
+                               static_cast<int>(size_z_ * oo_resolution_));
+  num_bricks_ = (num_cells_ + Eigen::Vector3i::Constant(BRICK_SIZE - 1)) / BRICK_SIZE;
+  brick_table_.assign(std::size_t(num_bricks_.x()) * num_bricks_.y() * num_bricks_.z(), -1);
+
+  // create a sqrt table:
+  sqrt_table_.resize(max_distance_sq_ + 1);
+  for (int i = 0; i <= max_distance_sq_; ++i)
+    sqrt_table_[i] = sqrt(double(i)) * resolution_;
+
+  reset();
+}
+
+void SparseDistanceField::setThreads(unsigned int threads)
+{
+  threads_ = resolveThreadCount(threads);
+}
+
+std::int32_t SparseDistanceField::allocateBrick()
+{
+  if (!free_bricks_.empty())
+  {
+    const std::int32_t brick = free_bricks_.back();
+    free_bricks_.pop_back();
+    return brick;
+  }
+  bricks_.emplace_back();
+  return static_cast<std::int32_t>(bricks_.size() - 1);
+}
+
+bool SparseDistanceField::setCellOccupied(const Eigen::Vector3i& cell, bool occupied,
+                                          std::vector<std::size_t>& changed_bricks)
+{
+  const std::size_t index = brickIndex(cell.x(), cell.y(), cell.z());
+  if (brick_table_[index] < 0)
+  {
+    // cells of unallocated bricks are free
+    if (!occupied)
+      return false;
+    const std::int32_t brick = allocateBrick();
+    bricks_[brick].cells.fill(CompactDistanceFieldVoxel(max_distance_sq_, 0));
+    brick_table_[index] = brick;
+  }
+
+  CompactDistanceFieldVoxel& voxel = bricks_[brick_table_[index]].cells[cellIndex(cell.x(), cell.y(), cell.z())];
+  if ((voxel.distance_square_ == 0) == occupied)
+    return false;
+
+  // the brick update recomputes the exact values, it only needs to tell obstacles from free cells
+  voxel.distance_square_ = occupied ? 0 : max_distance_sq_;
+  if (changed_bricks.empty() || changed_bricks.back() != index)
+    changed_bricks.push_back(index);
+  return true;
+}
+
+void SparseDistanceField::addPointsToField(const EigenSTL::vector_Vector3d& points)
+{
+  std::vector<std::size_t> changed_bricks;
+  for (const Eigen::Vector3d& point : points)
+  {
+    Eigen::Vector3i cell;
+    if (worldToGrid(point.x(), point.y(), point.z(), cell.x(), cell.y(), cell.z()))
+      setCellOccupied(cell, true, changed_bricks);
+  }
+  if (!changed_bricks.empty())
+    updateBricks(changed_bricks);
+}
+
+void SparseDistanceField::removePointsFromField(const EigenSTL::vector_Vector3d& points)
+{
+  std::vector<std::size_t> changed_bricks;
+  for (const Eigen::Vector3d& point : points)
+  {
+    Eigen::Vector3i cell;
+    if (worldToGrid(point.x(), point.y(), point.z(), cell.x(), cell.y(), cell.z()))
+      setCellOccupied(cell, false, changed_bricks);
+  }
+  if (!changed_bricks.empty())
+    updateBricks(changed_bricks);
+}
+
+void SparseDistanceField::updatePointsInField(const EigenSTL::vector_Vector3d& old_points,
+                                              const EigenSTL::vector_Vector3d& new_points)
+{
+  // freeing the old cells and then occupying the new ones leaves cells in both sets occupied, and a
+  // single update covers both changes
+  std::vector<std::size_t> changed_bricks;
+  for (const Eigen::Vector3d& point : old_points)
+  {
+    Eigen::Vector3i cell;
+    if (worldToGrid(point.x(), point.y(), point.z(), cell.x(), cell.y(), cell.z()))
+      setCellOccupied(cell, false, changed_bricks);
+  }
+  for (const Eigen::Vector3d& point : new_points)
+  {
+    Eigen::Vector3i cell;
+    if (worldToGrid(point.x(), point.y(), point.z(), cell.x(), cell.y(), cell.z()))
+      setCellOccupied(cell, true, changed_bricks);
+  }
+  if (!changed_bricks.empty())
+    updateBricks(changed_bricks);
+}
+
+void SparseDistanceField::updateBricks(const std::vector<std::size_t>& changed_bricks)
+{
+  const auto brick_coordinates = [this](std::size_t index) {
+    const std::size_t stride_x = std::size_t(num_bricks_.y()) * num_bricks_.z();
+    return Eigen::Vector3i(static_cast<int>(index / stride_x), static_cast<int>((index % stride_x) / num_bricks_.z()),
+                           static_cast<int>(index % num_bricks_.z()));
+  };
+
+  // only cells within the maximum distance of a change can see a different distance
+  const int brick_reach = (max_distance_cells_ + BRICK_SIZE - 1) / BRICK_SIZE;
+  std::vector<unsigned char> affected_mask(brick_table_.size(), 0);
+  for (std::size_t index : changed_bricks)
+  {
+    const Eigen::Vector3i brick = brick_coordinates(index);
+    const Eigen::Vector3i from = (brick - Eigen::Vector3i::Constant(brick_reach)).cwiseMax(0);
+    const Eigen::Vector3i to =
+        (brick + Eigen::Vector3i::Constant(brick_reach)).cwiseMin(num_bricks_ - Eigen::Vector3i::Ones());
+    for (int bx = from.x(); bx <= to.x(); ++bx)
+      for (int by = from.y(); by <= to.y(); ++by)
+        for (int bz = from.z(); bz <= to.z(); ++bz)
+          affected_mask[(std::size_t(bx) * num_bricks_.y() + by) * num_bricks_.z() + bz] = 1;
+  }
+  std::vector<std::size_t> affected;
+  for (std::size_t index = 0; index < affected_mask.size(); ++index)
+  {
+    if (affected_mask[index])
+      affected.push_back(index);
+  }
+
+  // the bricks are recomputed from the obstacle cells only, which no recomputed value changes, so
+  // all of them can be computed before any is written back
+  const Eigen::Vector3i last_cell = num_cells_ - Eigen::Vector3i::Ones();
+  const Eigen::Vector3i reach = Eigen::Vector3i::Constant(max_distance_cells_);
+  std::vector<Brick> results(affected.size());
+  parallelFor(affected.size(), threads_, [&](std::size_t begin, std::size_t end) {
+    std::vector<int> distances;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const Eigen::Vector3i brick_min = brick_coordinates(affected[i]) * BRICK_SIZE;
+      const Eigen::Vector3i brick_max =
+          (brick_min + Eigen::Vector3i::Constant(BRICK_SIZE - 1)).cwiseMin(last_cell);
+      // any site closer than the maximum distance to a cell of the brick lies within this box
+      const Eigen::Vector3i box_min = (brick_min - reach).cwiseMax(0);
+      const Eigen::Vector3i box_max = (brick_max + reach).cwiseMin(last_cell);
+      const Eigen::Vector3i box_size = box_max - box_min + Eigen::Vector3i::Ones();
+      const std::size_t box_stride_x = std::size_t(box_size.y()) * box_size.z();
+      const std::size_t box_stride_y = box_size.z();
+
+      Brick& result = results[i];
+      result.cells.fill(CompactDistanceFieldVoxel(max_distance_sq_, 0));
+      for (bool negative : { true, false })
+      {
+        if (negative && !propagate_negative_)
+          continue;
+
+        distances.resize(box_stride_x * box_size.x());
+        bool has_site = false;
+        for (int x = box_min.x(); x <= box_max.x(); ++x)
+        {
+          for (int y = box_min.y(); y <= box_max.y(); ++y)
+          {
+            int* distance = &distances[(x - box_min.x()) * box_stride_x + (y - box_min.y()) * box_stride_y];
+            for (int z = box_min.z(); z <= box_max.z(); ++z)
+            {
+              const CompactDistanceFieldVoxel* voxel = findCell(x, y, z);
+              const bool site = (voxel && voxel->distance_square_ == 0) != negative;
+              distance[z - box_min.z()] = site ? 0 : DISTANCE_TRANSFORM_INFINITY;
+              has_site |= site;
+            }
+          }
+        }
+        // without a site all cells are already at infinity
+        if (has_site)
+          computeSquaredDistanceTransform(box_size.x(), box_size.y(), box_size.z(), distances, nullptr, 1);
+
+        for (int x = brick_min.x(); x <= brick_max.x(); ++x)
+        {
+          for (int y = brick_min.y(); y <= brick_max.y(); ++y)
+          {
+            const int* distance = &distances[(x - box_min.x()) * box_stride_x + (y - box_min.y()) * box_stride_y];
+            for (int z = brick_min.z(); z <= brick_max.z(); ++z)
+            {
+              const std::uint16_t value = std::min(distance[z - box_min.z()], max_distance_sq_);
+              CompactDistanceFieldVoxel& voxel = result.cells[cellIndex(x, y, z)];
+              if (negative)
+                voxel.negative_distance_square_ = value;
+              else
+                voxel.distance_square_ = value;
+            }
+          }
+        }
+      }
+    }
+  });
+
+  // keep the bricks with a cell that does not report the maximum distance, release all others
+  for (std::size_t i = 0; i < affected.size(); ++i)
+  {
+    const bool needed = std::any_of(results[i].cells.begin(), results[i].cells.end(),
+                                    [this](const CompactDistanceFieldVoxel& voxel) {
+                                      return voxel.distance_square_ < max_distance_sq_ ||
+                                             voxel.negative_distance_square_ != 0;
+                                    });
+    std::int32_t& brick = brick_table_[affected[i]];
+    if (needed)
+    {
+      if (brick < 0)
+        brick = allocateBrick();
+      bricks_[brick] = results[i];
+    }
+    else if (brick >= 0)
+    {
+      free_bricks_.push_back(brick);
+      brick = -1;
+    }
+  }
+}
+
+void SparseDistanceField::reset()
+{
+  std::fill(brick_table_.begin(), brick_table_.end(), -1);
+  bricks_.clear();
+  bricks_.shrink_to_fit();
+  free_bricks_.clear();
+  free_bricks_.shrink_to_fit();
+}
+
+double SparseDistanceField::getDistance(double x, double y, double z) const
+{
+  int cell_x, cell_y, cell_z;
+  if (!worldToGrid(x, y, z, cell_x, cell_y, cell_z))
+    return max_distance_;
+  return getDistance(cell_x, cell_y, cell_z);
+}
+
+double SparseDistanceField::getDistance(int x, int y, int z) const
+{
+  if (!isCellValid(x, y, z))
+    return max_distance_;
+  const CompactDistanceFieldVoxel* voxel = findCell(x, y, z);
+  return voxel ? getDistance(*voxel) : max_distance_;
+}
+
+bool SparseDistanceField::isCellValid(int x, int y, int z) const
+{
+  return x >= 0 && x < num_cells_.x() && y >= 0 && y < num_cells_.y() && z >= 0 && z < num_cells_.z();
+}
+
+int SparseDistanceField::getXNumCells() const
+{
+  return num_cells_.x();
+}
+
+int SparseDistanceField::getYNumCells() const
+{
+  return num_cells_.y();
+}
+
+int SparseDistanceField::getZNumCells() const
+{
+  return num_cells_.z();
+}
+
+std::size_t SparseDistanceField::getMemoryBytes() const
+{
+  return sizeof(SparseDistanceField) + sizeof(std::int32_t) * (brick_table_.capacity() + free_bricks_.capacity()) +
+         sizeof(Brick) * bricks_.capacity() + sizeof(double) * sqrt_table_.capacity();
+}
+
+bool SparseDistanceField::gridToWorld(int x, int y, int z, double& world_x, double& world_y, double& world_z) const
+{
+  world_x = origin_x_ + resolution_ * double(x);
+  world_y = origin_y_ + resolution_ * double(y);
+  world_z = origin_z_ + resolution_ * double(z);
+  return true;
+}
+
+bool SparseDistanceField::worldToGrid(double world_x, double world_y, double world_z, int& x, int& y, int& z) const
+{
+  x = int(floor((world_x - origin_minus_.x()) * oo_resolution_));
+  y = int(floor((world_y - origin_minus_.y()) * oo_resolution_));
+  z = int(floor((world_z - origin_minus_.z()) * oo_resolution_));
+  return isCellValid(x, y, z);
+}
+
+bool SparseDistanceField::writeToStream(std::ostream& os) const
+{
+  os << "resolution: " << resolution_ << '\n';
+  os << "size_x: " << size_x_ << '\n';
+  os << "size_y: " << size_y_ << '\n';
+  os << "size_z: " << size_z_ << '\n';
+  os << "origin_x: " << origin_x_ << '\n';
+  os << "origin_y: " << origin_y_ << '\n';
+  os << "origin_z: " << origin_z_ << '\n';
+
+  // obstacle cells as bits along z, zlib compressed
+  boost::iostreams::filtering_ostream out;
+  out.push(boost::iostreams::zlib_compressor());
+  out.push(os);
+
+  for (int x = 0; x < getXNumCells(); ++x)
+  {
+    for (int y = 0; y < getYNumCells(); ++y)
+    {
+      for (int z = 0; z < getZNumCells(); z += 8)
+      {
+        std::bitset<8> bs(0);
+        const int zv = std::min(8, getZNumCells() - z);
+        for (int zi = 0; zi < zv; ++zi)
+        {
+          const CompactDistanceFieldVoxel* voxel = findCell(x, y, z + zi);
+          if (voxel && voxel->distance_square_ == 0)
+            bs[zi] = 1;
+        }
+        out.write(reinterpret_cast<char*>(&bs), sizeof(char));
+      }
+    }
+  }
+  out.flush();
+  return true;
+}
+
+bool SparseDistanceField::readFromStream(std::istream& is)
+{
+  if (!is.good())
+    return false;
+
+  const auto read_value = [&is](const std::string& key, double& value) {
+    std::string temp;
+    is >> temp;
+    if (temp != key)
+      return false;
+    is >> value;
+    return true;
+  };
+  if (!read_value("resolution:", resolution_) || !read_value("size_x:", size_x_) ||
+      !read_value("size_y:", size_y_) || !read_value("size_z:", size_z_) || !read_value("origin_x:", origin_x_) ||
+      !read_value("origin_y:", origin_y_) || !read_value("origin_z:", origin_z_))
+    return false;
+  inv_twice_resolution_ = 1.0 / (2.0 * resolution_);
+
+  // previous values for propagate_negative_ and max_distance_ will be used
+  initialize();
+
+  // this should be newline
+  char nl;
+  is.get(nl);
+
+  boost::iostreams::filtering_istream in;
+  in.push(boost::iostreams::zlib_decompressor());
+  in.push(is);
+
+  std::vector<std::size_t> changed_bricks;
+  for (int x = 0; x < getXNumCells(); ++x)
+  {
+    for (int y = 0; y < getYNumCells(); ++y)
+    {
+      for (int z = 0; z < getZNumCells(); z += 8)
+      {
+        char inchar;
+        if (!in.good())
+          return false;
+        in.get(inchar);
+        std::bitset<8> inbit(static_cast<unsigned long long>(inchar));
+        const int zv = std::min(8, getZNumCells() - z);
+        for (int zi = 0; zi < zv; ++zi)
+        {
+          if (inbit[zi] == 1)
+            setCellOccupied(Eigen::Vector3i(x, y, z + zi), true, changed_bricks);
+        }
+      }
+    }
+  }
+  if (!changed_bricks.empty())
+    updateBricks(changed_bricks);
+  return true;
+}
+}  // namespace distance_field
@@ -0,0 +1,110 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+// To run this benchmark, 'cd' to the build/moveit_core/distance_field directory and directly run the binary.
+
+#include <benchmark/benchmark.h>
+#include <moveit/distance_field/propagation_distance_field.h>
+#include <random>
+
+namespace
+{
+// A 1m cube at 1cm resolution, roughly the workspace of an arm
+constexpr double SIZE = 1.0;
+constexpr double RESOLUTION = 0.01;
+constexpr double MAX_DISTANCE = 0.3;
+
+EigenSTL::vector_Vector3d randomPoints(std::mt19937& rng, std::size_t count)
+{
+  std::uniform_real_distribution<double> coordinate(0.0, SIZE);
+  EigenSTL::vector_Vector3d points(count);
+  for (Eigen::Vector3d& point : points)
+    point = Eigen::Vector3d(coordinate(rng), coordinate(rng), coordinate(rng));
+  return points;
+}
+}  // namespace
+
+static void BM_AddPointsToField(benchmark::State& st)
+{
+  std::mt19937 rng(0);
+  const EigenSTL::vector_Vector3d points = randomPoints(rng, st.range(0));
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    distance_field::PropagationDistanceField df(SIZE, SIZE, SIZE, RESOLUTION, 0.0, 0.0, 0.0, MAX_DISTANCE);
+    st.ResumeTiming();
+    df.addPointsToField(points);
+  }
+  st.SetItemsProcessed(st.iterations() * points.size());
+}
+
+static void BM_UpdatePointsInField(benchmark::State& st)
+{
+  std::mt19937 rng(0);
+  distance_field::PropagationDistanceField df(SIZE, SIZE, SIZE, RESOLUTION, 0.0, 0.0, 0.0, MAX_DISTANCE, true);
+  EigenSTL::vector_Vector3d points = randomPoints(rng, st.range(0));
+  df.addPointsToField(points);
+
+  // move a tenth of the obstacle points per update, as a sensor update of a mostly static scene would
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    EigenSTL::vector_Vector3d new_points = points;
+    const EigenSTL::vector_Vector3d moved = randomPoints(rng, points.size() / 10);
+    std::copy(moved.begin(), moved.end(), new_points.begin());
+    st.ResumeTiming();
+    df.updatePointsInField(points, new_points);
+    points.swap(new_points);
+  }
+}
+
+static void BM_RemovePointsFromField(benchmark::State& st)
+{
+  std::mt19937 rng(0);
+  const EigenSTL::vector_Vector3d points = randomPoints(rng, st.range(0));
+  const EigenSTL::vector_Vector3d removed(points.begin(), points.begin() + points.size() / 10);
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    distance_field::PropagationDistanceField df(SIZE, SIZE, SIZE, RESOLUTION, 0.0, 0.0, 0.0, MAX_DISTANCE);
+    df.addPointsToField(points);
+    st.ResumeTiming();
+    df.removePointsFromField(removed);
+  }
+}
+
+BENCHMARK(BM_AddPointsToField)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UpdatePointsInField)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RemovePointsFromField)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
@@ -38,11 +38,14 @@
 
 #include <moveit/distance_field/voxel_grid.h>
 #include <moveit/distance_field/propagation_distance_field.h>
+#include <moveit/distance_field/compact_distance_field.h>
 #include <moveit/distance_field/find_internal_points.h>
+#include <moveit/distance_field/sparse_distance_field.h>
 #include <geometric_shapes/body_operations.h>
 #include <tf2_eigen/tf2_eigen.hpp>
 #include <octomap/octomap.h>
 #include <memory>
+#include <sstream>
 
 using namespace distance_field;
 
@@ -607,6 +610,142 @@ TEST(TestSignedPropagationDistanceField, TestSignedAddRemovePoints)
   }
 }
 
+TEST(TestSignedPropagationDistanceField, TestBatchedGradients)
+{
+  PropagationDistanceField df(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST, true);
+
+  EigenSTL::vector_Vector3d points;
+  points.push_back(POINT1);
+  points.push_back(POINT2);
+  points.push_back(POINT3);
+  df.addPointsToField(points);
+
+  // sample every cell center plus points off the grid and on its border
+  EigenSTL::vector_Vector3d queries;
+  for (int x = -1; x <= df.getXNumCells(); ++x)
+  {
+    for (int y = -1; y <= df.getYNumCells(); ++y)
+    {
+      for (int z = -1; z <= df.getZNumCells(); ++z)
+      {
+        double wx, wy, wz;
+        df.gridToWorld(x, y, z, wx, wy, wz);
+        queries.push_back(Eigen::Vector3d(wx + 0.3 * RESOLUTION, wy - 0.2 * RESOLUTION, wz));
+      }
+    }
+  }
+
+  std::vector<double> distances;
+  EigenSTL::vector_Vector3d gradients;
+  std::vector<unsigned char> in_bounds;
+  df.getDistanceGradients(queries, distances, gradients, in_bounds);
+  ASSERT_EQ(distances.size(), queries.size());
+  ASSERT_EQ(gradients.size(), queries.size());
+  ASSERT_EQ(in_bounds.size(), queries.size());
+
+  for (std::size_t i = 0; i < queries.size(); ++i)
+  {
+    const Eigen::Vector3d& q = queries[i];
+    Eigen::Vector3d grad;
+    bool valid;
+    double dist = df.getDistanceGradient(q.x(), q.y(), q.z(), grad.x(), grad.y(), grad.z(), valid);
+    EXPECT_EQ(valid, static_cast<bool>(in_bounds[i])) << q.transpose();
+    EXPECT_EQ(dist, distances[i]) << q.transpose();
+    EXPECT_EQ(grad, gradients[i]) << q.transpose();
+  }
+
+  // large batches split across threads give the same answers
+  EigenSTL::vector_Vector3d many_queries;
+  while (many_queries.size() < 4 * DistanceField::MIN_GRADIENT_QUERIES_PER_THREAD)
+    many_queries.insert(many_queries.end(), queries.begin(), queries.end());
+  std::vector<double> parallel_distances(many_queries.size());
+  EigenSTL::vector_Vector3d parallel_gradients(many_queries.size());
+  std::vector<unsigned char> parallel_in_bounds(many_queries.size());
+  df.getDistanceGradients(many_queries.data(), many_queries.size(), parallel_distances.data(),
+                          parallel_gradients.data(), parallel_in_bounds.data(), 4);
+  for (std::size_t i = 0; i < many_queries.size(); ++i)
+  {
+    const std::size_t j = i % queries.size();
+    ASSERT_EQ(parallel_distances[i], distances[j]) << i;
+    ASSERT_EQ(parallel_gradients[i], gradients[j]) << i;
+    ASSERT_EQ(parallel_in_bounds[i], in_bounds[j]) << i;
+  }
+
+  // empty query leaves empty output
+  df.getDistanceGradients(EigenSTL::vector_Vector3d(), distances, gradients, in_bounds);
+  EXPECT_TRUE(distances.empty());
+  EXPECT_TRUE(gradients.empty());
+  EXPECT_TRUE(in_bounds.empty());
+}
+
+TEST(TestSignedPropagationDistanceField, TestParallelPropagation)
+{
+  // enough threads that adding or removing these points always takes the parallel recompute
+  PropagationDistanceField df(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST, true, 64);
+  EXPECT_EQ(df.getPropagationThreads(), 64u);
+
+  EigenSTL::vector_Vector3d points;
+  for (double x = 0.2; x < 0.5; x += RESOLUTION)
+    for (double y = 0.3; y < 0.6; y += RESOLUTION)
+      for (double z = 0.4; z < 0.7; z += RESOLUTION)
+        points.push_back(Eigen::Vector3d(x, y, z));
+  points.push_back(POINT1);
+  points.push_back(POINT2);
+  points.push_back(POINT3);
+  df.addPointsToField(points);
+
+  const auto check_exact = [&df]() {
+    for (int x = 0; x < df.getXNumCells(); ++x)
+      for (int y = 0; y < df.getYNumCells(); ++y)
+        for (int z = 0; z < df.getZNumCells(); ++z)
+        {
+          // brute force the closest obstacle and free cell
+          int dsq = df.getMaximumDistanceSquared();
+          int ndsq = df.getMaximumDistanceSquared();
+          for (int ox = 0; ox < df.getXNumCells(); ++ox)
+            for (int oy = 0; oy < df.getYNumCells(); ++oy)
+              for (int oz = 0; oz < df.getZNumCells(); ++oz)
+              {
+                int d = (ox - x) * (ox - x) + (oy - y) * (oy - y) + (oz - z) * (oz - z);
+                if (df.getCell(ox, oy, oz).distance_square_ == 0)
+                  dsq = std::min(dsq, d);
+                else
+                  ndsq = std::min(ndsq, d);
+              }
+          const PropDistanceFieldVoxel& cell = df.getCell(x, y, z);
+          ASSERT_EQ(cell.distance_square_, dsq) << x << ' ' << y << ' ' << z;
+          ASSERT_EQ(cell.negative_distance_square_, ndsq) << x << ' ' << y << ' ' << z;
+          if (dsq < df.getMaximumDistanceSquared())
+          {
+            const Eigen::Vector3i& closest = cell.closest_point_;
+            ASSERT_EQ(df.getCell(closest.x(), closest.y(), closest.z()).distance_square_, 0);
+            ASSERT_EQ((closest - Eigen::Vector3i(x, y, z)).squaredNorm(), dsq);
+          }
+        }
+  };
+  check_exact();
+
+  EigenSTL::vector_Vector3d removed(points.begin(), points.begin() + points.size() / 2);
+  df.removePointsFromField(removed);
+  check_exact();
+
+  // small updates fall back to the incremental propagation on top of the recomputed field
+  PropagationDistanceField serial(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST, true);
+  serial.addPointsToField(points);
+  serial.removePointsFromField(removed);
+  EigenSTL::vector_Vector3d added;
+  added.push_back(Eigen::Vector3d(0.8, 0.8, 0.1));
+  df.addPointsToField(added);
+  serial.addPointsToField(added);
+  for (int x = 0; x < df.getXNumCells(); ++x)
+    for (int y = 0; y < df.getYNumCells(); ++y)
+      for (int z = 0; z < df.getZNumCells(); ++z)
+      {
+        EXPECT_EQ(df.getCell(x, y, z).distance_square_ == 0, serial.getCell(x, y, z).distance_square_ == 0);
+        EXPECT_LE(df.getCell(x, y, z).distance_square_, serial.getCell(x, y, z).distance_square_);
+      }
+}
+
 TEST(TestSignedPropagationDistanceField, TestShape)
 {
   PropagationDistanceField df(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST, true);
@@ -937,6 +1076,30 @@ TEST(TestSignedPropagationDistanceField, TestOcTree)
   EXPECT_TRUE(areDistanceFieldsDistancesEqual(df_test_shape_1, df_test_shape_2));
 }
 
+TEST(TestSignedPropagationDistanceField, TestCopy)
+{
+  PropagationDistanceField df(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST, true);
+
+  EigenSTL::vector_Vector3d points;
+  points.push_back(POINT1);
+  points.push_back(POINT2);
+  df.addPointsToField(points);
+
+  PropagationDistanceField df_copy(df);
+  EXPECT_TRUE(areDistanceFieldsDistancesEqual(df, df_copy));
+
+  // updating the copy incrementally must not touch the original
+  EigenSTL::vector_Vector3d more_points;
+  more_points.push_back(POINT3);
+  df_copy.addPointsToField(more_points);
+  EXPECT_FALSE(areDistanceFieldsDistancesEqual(df, df_copy));
+
+  PropagationDistanceField test_df(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST, true);
+  points.push_back(POINT3);
+  test_df.addPointsToField(points);
+  EXPECT_TRUE(areDistanceFieldsDistancesEqual(df_copy, test_df));
+}
+
 TEST(TestSignedPropagationDistanceField, TestReadWrite)
 {
   PropagationDistanceField small_df(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST);
@@ -985,6 +1148,186 @@ TEST(TestSignedPropagationDistanceField, TestReadWrite)
   EXPECT_FALSE(areDistanceFieldsDistancesEqual(df, df3));
 }
 
+TEST(TestCompactDistanceField, TestMatchesExactPropagation)
+{
+  EXPECT_EQ(sizeof(CompactDistanceFieldVoxel), 4u);
+
+  for (bool signed_field : { false, true })
+  {
+    CompactDistanceField df(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST, signed_field, 2);
+    // the parallel recompute of the propagation field is exact as well
+    PropagationDistanceField reference(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST,
+                                       signed_field, 64);
+    ASSERT_EQ(df.getXNumCells(), reference.getXNumCells());
+    ASSERT_EQ(df.getYNumCells(), reference.getYNumCells());
+    ASSERT_EQ(df.getZNumCells(), reference.getZNumCells());
+    EXPECT_EQ(df.getMaximumDistanceSquared(), reference.getMaximumDistanceSquared());
+
+    const auto expect_same = [&df, &reference]() {
+      for (int x = 0; x < df.getXNumCells(); ++x)
+        for (int y = 0; y < df.getYNumCells(); ++y)
+          for (int z = 0; z < df.getZNumCells(); ++z)
+          {
+            ASSERT_EQ(df.getCell(x, y, z).distance_square_, reference.getCell(x, y, z).distance_square_)
+                << x << ' ' << y << ' ' << z;
+            ASSERT_EQ(df.getCell(x, y, z).negative_distance_square_,
+                      reference.getCell(x, y, z).negative_distance_square_)
+                << x << ' ' << y << ' ' << z;
+            ASSERT_EQ(df.getDistance(x, y, z), reference.getDistance(x, y, z));
+          }
+    };
+
+    EigenSTL::vector_Vector3d block;
+    for (double x = 0.2; x < 0.5; x += RESOLUTION)
+      for (double y = 0.3; y < 0.6; y += RESOLUTION)
+        for (double z = 0.4; z < 0.7; z += RESOLUTION)
+          block.push_back(Eigen::Vector3d(x, y, z));
+    df.addPointsToField(block);
+    reference.addPointsToField(block);
+    expect_same();
+
+    // single points only update the region around them
+    EigenSTL::vector_Vector3d points;
+    points.push_back(POINT1);
+    points.push_back(POINT3);
+    df.addPointsToField(points);
+    reference.addPointsToField(points);
+    expect_same();
+
+    EigenSTL::vector_Vector3d removed(block.begin(), block.begin() + block.size() / 2);
+    df.removePointsFromField(removed);
+    reference.removePointsFromField(removed);
+    expect_same();
+
+    EigenSTL::vector_Vector3d moved;
+    moved.push_back(POINT2);
+    moved.push_back(POINT3);
+    df.updatePointsInField(points, moved);
+    reference.updatePointsInField(points, moved);
+    expect_same();
+
+    std::stringstream stream;
+    ASSERT_TRUE(df.writeToStream(stream));
+    CompactDistanceField read_df(0.1, 0.1, 0.1, RESOLUTION, 0.0, 0.0, 0.0, MAX_DIST, signed_field);
+    ASSERT_TRUE(read_df.readFromStream(stream));
+    ASSERT_EQ(read_df.getXNumCells(), df.getXNumCells());
+    for (int x = 0; x < df.getXNumCells(); ++x)
+      for (int y = 0; y < df.getYNumCells(); ++y)
+        for (int z = 0; z < df.getZNumCells(); ++z)
+          ASSERT_EQ(read_df.getDistance(x, y, z), df.getDistance(x, y, z));
+
+    df.reset();
+    for (int x = 0; x < df.getXNumCells(); ++x)
+      for (int y = 0; y < df.getYNumCells(); ++y)
+        for (int z = 0; z < df.getZNumCells(); ++z)
+          ASSERT_NEAR(df.getDistance(x, y, z), MAX_DIST, .0001);
+  }
+}
+
+TEST(TestSparseDistanceField, TestMatchesCompact)
+{
+  for (bool signed_field : { false, true })
+  {
+    SparseDistanceField df(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST, signed_field, 2);
+    CompactDistanceField reference(WIDTH, HEIGHT, DEPTH, RESOLUTION, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, MAX_DIST,
+                                   signed_field);
+    ASSERT_EQ(df.getXNumCells(), reference.getXNumCells());
+    ASSERT_EQ(df.getYNumCells(), reference.getYNumCells());
+    ASSERT_EQ(df.getZNumCells(), reference.getZNumCells());
+    EXPECT_EQ(df.getMaximumDistanceSquared(), reference.getMaximumDistanceSquared());
+    EXPECT_EQ(df.getAllocatedBrickCount(), 0u);
+
+    const auto expect_same = [&df, &reference]() {
+      for (int x = 0; x < df.getXNumCells(); ++x)
+        for (int y = 0; y < df.getYNumCells(); ++y)
+          for (int z = 0; z < df.getZNumCells(); ++z)
+          {
+            ASSERT_EQ(df.getCell(x, y, z).distance_square_, reference.getCell(x, y, z).distance_square_)
+                << x << ' ' << y << ' ' << z;
+            ASSERT_EQ(df.getCell(x, y, z).negative_distance_square_,
+                      reference.getCell(x, y, z).negative_distance_square_)
+                << x << ' ' << y << ' ' << z;
+            ASSERT_EQ(df.getDistance(x, y, z), reference.getDistance(x, y, z));
+          }
+    };
+
+    EigenSTL::vector_Vector3d block;
+    for (double x = 0.2; x < 0.5; x += RESOLUTION)
+      for (double y = 0.3; y < 0.6; y += RESOLUTION)
+        for (double z = 0.4; z < 0.7; z += RESOLUTION)
+          block.push_back(Eigen::Vector3d(x, y, z));
+    df.addPointsToField(block);
+    reference.addPointsToField(block);
+    expect_same();
+    EXPECT_GT(df.getAllocatedBrickCount(), 0u);
+
+    EigenSTL::vector_Vector3d points;
+    points.push_back(POINT1);
+    points.push_back(POINT3);
+    df.addPointsToField(points);
+    reference.addPointsToField(points);
+    expect_same();
+
+    EigenSTL::vector_Vector3d removed(block.begin(), block.begin() + block.size() / 2);
+    df.removePointsFromField(removed);
+    reference.removePointsFromField(removed);
+    expect_same();
+
+    EigenSTL::vector_Vector3d moved;
+    moved.push_back(POINT2);
+    moved.push_back(POINT3);
+    df.updatePointsInField(points, moved);
+    reference.updatePointsInField(points, moved);
+    expect_same();
+
+    std::stringstream stream;
+    ASSERT_TRUE(df.writeToStream(stream));
+    SparseDistanceField read_df(0.1, 0.1, 0.1, RESOLUTION, 0.0, 0.0, 0.0, MAX_DIST, signed_field);
+    ASSERT_TRUE(read_df.readFromStream(stream));
+    ASSERT_EQ(read_df.getXNumCells(), df.getXNumCells());
+    for (int x = 0; x < df.getXNumCells(); ++x)
+      for (int y = 0; y < df.getYNumCells(); ++y)
+        for (int z = 0; z < df.getZNumCells(); ++z)
+          ASSERT_EQ(read_df.getDistance(x, y, z), df.getDistance(x, y, z));
+
+    // removing all obstacles releases all bricks
+    df.removePointsFromField(block);
+    df.removePointsFromField(moved);
+    EXPECT_EQ(df.getAllocatedBrickCount(), 0u);
+
+    df.addPointsToField(block);
+    df.reset();
+    EXPECT_EQ(df.getAllocatedBrickCount(), 0u);
+    for (int x = 0; x < df.getXNumCells(); ++x)
+      for (int y = 0; y < df.getYNumCells(); ++y)
+        for (int z = 0; z < df.getZNumCells(); ++z)
+          ASSERT_NEAR(df.getDistance(x, y, z), MAX_DIST, .0001);
+  }
+}
+
+TEST(TestSparseDistanceField, TestLargeWorkspace)
+{
+  // a 20 x 20 x 2 m field at 5 cm would need 6.4 million cells in a dense grid
+  SparseDistanceField df(20.0, 20.0, 2.0, 0.05, -10.0, -10.0, 0.0, MAX_DIST, true, 2);
+  EXPECT_EQ(df.getXNumCells(), 400);
+  EXPECT_EQ(df.getZNumCells(), 40);
+
+  EigenSTL::vector_Vector3d box;
+  for (double x = 1.0; x < 1.5; x += 0.05)
+    for (double y = -2.0; y < -1.5; y += 0.05)
+      for (double z = 0.5; z < 1.0; z += 0.05)
+        box.push_back(Eigen::Vector3d(x, y, z));
+  df.addPointsToField(box);
+
+  const std::size_t dense_bytes = sizeof(CompactDistanceFieldVoxel) * 400 * 400 * 40;
+  EXPECT_LT(df.getMemoryBytes(), dense_bytes / 20);
+
+  EXPECT_LT(df.getDistance(1.2, -1.8, 0.7), 0.0);
+  EXPECT_NEAR(df.getDistance(1.2, -1.8, 1.1), 0.15, 0.051);
+  EXPECT_EQ(df.getDistance(-8.0, 8.0, 1.0), MAX_DIST);
+  EXPECT_EQ(df.getDistance(15.0, 0.0, 1.0), MAX_DIST);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -43,7 +43,10 @@
 #include <moveit/robot_state/robot_state.h>
 #include <geometry_msgs/msg/vector3.hpp>
 #include <geometry_msgs/msg/wrench.hpp>
+#include <Eigen/Core>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 /** \brief This namespace includes the dynamics_solver library */
 namespace dynamics_solver
@@ -87,6 +90,37 @@ public:
                   const std::vector<double>& joint_accelerations,
                   const std::vector<geometry_msgs::msg::Wrench>& wrenches, std::vector<double>& torques) const;
 
+  /**
+   * @brief Get the torques along a whole trajectory, without external wrenches. Each column of the
+   * input and output matrices is one waypoint, each row one joint of the group (in the order of the
+   * joints for this group in the RobotModel)
+   * @param joint_angles The joint angles, with num joints rows
+   * @param joint_velocities The joint velocities, same size as joint_angles
+   * @param joint_accelerations The joint accelerations, same size as joint_angles
+   * @param torques Computed torques, resized to the size of joint_angles
+   * @return False if any of the input matrices are of the wrong size or the torques could not be computed
+   */
+  bool getTorques(const Eigen::MatrixXd& joint_angles, const Eigen::MatrixXd& joint_velocities,
+                  const Eigen::MatrixXd& joint_accelerations, Eigen::MatrixXd& torques) const;
+
+  /**
+   * @brief Get the torques needed to hold a joint configuration against gravity. Results are cached
+   * by configuration, so repeated static checks of the same configurations skip the dynamics
+   * @param joint_angles The joint angles, this must have size = number of joints in the group
+   * @param torques Computed set of torques are filled in here, resized to the number of joints
+   * @return False if the input vector is of the wrong size
+   */
+  bool getGravityTorques(const std::vector<double>& joint_angles, std::vector<double>& torques) const;
+
+  /**
+   * @brief Set the maximum number of configurations kept by getGravityTorques(). The cache is
+   * cleared when it is full; 0 disables caching
+   */
+  void setGravityCacheSize(std::size_t size);
+
+  /** @brief Drop all cached gravity torques */
+  void clearGravityCache();
+
   /**
    * @brief Get the maximum payload for this group (in kg). Payload is
    * the weight that this group can hold when the weight is attached to the origin
@@ -134,6 +168,14 @@ public:
   }
 
 private:
+  struct ConfigurationHash
+  {
+    std::size_t operator()(const std::vector<double>& values) const;
+  };
+
+  /** @brief Run the inverse dynamics on the workspace arrays, which must hold the inputs. Lock mutex_ first */
+  bool computeWorkspaceTorques() const;
+
   std::shared_ptr<KDL::ChainIdSolver_RNE> chain_id_solver_;  // KDL chain inverse dynamics
   KDL::Chain kdl_chain_;                                     // KDL chain
 
@@ -147,5 +189,13 @@ private:
   std::vector<double> max_torques_;         // vector of max torques
 
   double gravity_;  // Norm of the gravity vector passed in initialize()
+
+  // preallocated solver inputs and outputs, guarded by mutex_ together with the gravity cache
+  mutable std::mutex mutex_;
+  mutable KDL::JntArray kdl_angles_, kdl_velocities_, kdl_accelerations_, kdl_torques_;
+  mutable KDL::Wrenches kdl_wrenches_;
+
+  std::size_t gravity_cache_size_ = 1024;
+  mutable std::unordered_map<std::vector<double>, std::vector<double>, ConfigurationHash> gravity_cache_;
 };
 }  // namespace dynamics_solver
@@ -142,6 +142,30 @@ DynamicsSolver::DynamicsSolver(const moveit::core::RobotModelConstPtr& robot_mod
   RCLCPP_DEBUG(LOGGER, "Gravity norm set to %f", gravity_);
 
   chain_id_solver_ = std::make_shared<KDL::ChainIdSolver_RNE>(kdl_chain_, gravity);
+
+  kdl_angles_.resize(num_joints_);
+  kdl_velocities_.resize(num_joints_);
+  kdl_accelerations_.resize(num_joints_);
+  kdl_torques_.resize(num_joints_);
+  kdl_wrenches_.resize(num_segments_);
+}
+
+std::size_t DynamicsSolver::ConfigurationHash::operator()(const std::vector<double>& values) const
+{
+  std::size_t seed = values.size();
+  for (double value : values)
+    seed ^= std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  return seed;
+}
+
+bool DynamicsSolver::computeWorkspaceTorques() const
+{
+  if (chain_id_solver_->CartToJnt(kdl_angles_, kdl_velocities_, kdl_accelerations_, kdl_wrenches_, kdl_torques_) < 0)
+  {
+    RCLCPP_ERROR(LOGGER, "Something went wrong computing torques");
+    return false;
+  }
+  return true;
 }
 
 bool DynamicsSolver::getTorques(const std::vector<double>& joint_angles, const std::vector<double>& joint_velocities,
@@ -181,40 +205,136 @@ bool DynamicsSolver::getTorques(const std::vector<double>& joint_angles, const s
     return false;
   }
 
-  KDL::JntArray kdl_angles(num_joints_), kdl_velocities(num_joints_), kdl_accelerations(num_joints_),
-      kdl_torques(num_joints_);
-  KDL::Wrenches kdl_wrenches(num_segments_);
-
+  std::lock_guard<std::mutex> lock(mutex_);
   for (unsigned int i = 0; i < num_joints_; ++i)
   {
-    kdl_angles(i) = joint_angles[i];
-    kdl_velocities(i) = joint_velocities[i];
-    kdl_accelerations(i) = joint_accelerations[i];
+    kdl_angles_(i) = joint_angles[i];
+    kdl_velocities_(i) = joint_velocities[i];
+    kdl_accelerations_(i) = joint_accelerations[i];
   }
 
   for (unsigned int i = 0; i < num_segments_; ++i)
   {
-    kdl_wrenches[i](0) = wrenches[i].force.x;
-    kdl_wrenches[i](1) = wrenches[i].force.y;
-    kdl_wrenches[i](2) = wrenches[i].force.z;
+    kdl_wrenches_[i](0) = wrenches[i].force.x;
+    kdl_wrenches_[i](1) = wrenches[i].force.y;
+    kdl_wrenches_[i](2) = wrenches[i].force.z;
 
-    kdl_wrenches[i](3) = wrenches[i].torque.x;
-    kdl_wrenches[i](4) = wrenches[i].torque.y;
-    kdl_wrenches[i](5) = wrenches[i].torque.z;
+    kdl_wrenches_[i](3) = wrenches[i].torque.x;
+    kdl_wrenches_[i](4) = wrenches[i].torque.y;
+    kdl_wrenches_[i](5) = wrenches[i].torque.z;
   }
 
-  if (chain_id_solver_->CartToJnt(kdl_angles, kdl_velocities, kdl_accelerations, kdl_wrenches, kdl_torques) < 0)
+  if (!computeWorkspaceTorques())
+    return false;
+
+  for (unsigned int i = 0; i < num_joints_; ++i)
+    torques[i] = kdl_torques_(i);
+
+  return true;
+}
+
+bool DynamicsSolver::getTorques(const Eigen::MatrixXd& joint_angles, const Eigen::MatrixXd& joint_velocities,
+                                const Eigen::MatrixXd& joint_accelerations, Eigen::MatrixXd& torques) const
+{
+  if (!joint_model_group_)
   {
-    RCLCPP_ERROR(LOGGER, "Something went wrong computing torques");
+    RCLCPP_DEBUG(LOGGER, "Did not construct DynamicsSolver object properly. "
+                         "Check error logs.");
+    return false;
+  }
+  if (joint_angles.rows() != num_joints_)
+  {
+    RCLCPP_ERROR(LOGGER, "Joint angles matrix should have %d rows", num_joints_);
+    return false;
+  }
+  if (joint_velocities.rows() != joint_angles.rows() || joint_velocities.cols() != joint_angles.cols())
+  {
+    RCLCPP_ERROR(LOGGER, "Joint velocities matrix should be the size of the joint angles matrix");
+    return false;
+  }
+  if (joint_accelerations.rows() != joint_angles.rows() || joint_accelerations.cols() != joint_angles.cols())
+  {
+    RCLCPP_ERROR(LOGGER, "Joint accelerations matrix should be the size of the joint angles matrix");
     return false;
   }
 
+  torques.resize(num_joints_, joint_angles.cols());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (KDL::Wrench& wrench : kdl_wrenches_)
+    wrench = KDL::Wrench::Zero();
+
+  // the KDL arrays wrap Eigen vectors, so each waypoint is a plain column copy
+  for (Eigen::Index waypoint = 0; waypoint < joint_angles.cols(); ++waypoint)
+  {
+    kdl_angles_.data = joint_angles.col(waypoint);
+    kdl_velocities_.data = joint_velocities.col(waypoint);
+    kdl_accelerations_.data = joint_accelerations.col(waypoint);
+    if (!computeWorkspaceTorques())
+      return false;
+    torques.col(waypoint) = kdl_torques_.data;
+  }
+  return true;
+}
+
+bool DynamicsSolver::getGravityTorques(const std::vector<double>& joint_angles, std::vector<double>& torques) const
+{
+  if (!joint_model_group_)
+  {
+    RCLCPP_DEBUG(LOGGER, "Did not construct DynamicsSolver object properly. "
+                         "Check error logs.");
+    return false;
+  }
+  if (joint_angles.size() != num_joints_)
+  {
+    RCLCPP_ERROR(LOGGER, "Joint angles vector should be size %d", num_joints_);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto cached = gravity_cache_.find(joint_angles);
+  if (cached != gravity_cache_.end())
+  {
+    torques = cached->second;
+    return true;
+  }
+
+  for (unsigned int i = 0; i < num_joints_; ++i)
+    kdl_angles_(i) = joint_angles[i];
+  kdl_velocities_.data.setZero();
+  kdl_accelerations_.data.setZero();
+  for (KDL::Wrench& wrench : kdl_wrenches_)
+    wrench = KDL::Wrench::Zero();
+  if (!computeWorkspaceTorques())
+    return false;
+
+  torques.resize(num_joints_);
   for (unsigned int i = 0; i < num_joints_; ++i)
-    torques[i] = kdl_torques(i);
+    torques[i] = kdl_torques_(i);
 
+  if (gravity_cache_size_ > 0)
+  {
+    if (gravity_cache_.size() >= gravity_cache_size_)
+      gravity_cache_.clear();
+    gravity_cache_.emplace(joint_angles, torques);
+  }
   return true;
 }
 
+void DynamicsSolver::setGravityCacheSize(std::size_t size)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  gravity_cache_size_ = size;
+  if (gravity_cache_.size() > gravity_cache_size_)
+    gravity_cache_.clear();
+}
+
+void DynamicsSolver::clearGravityCache()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  gravity_cache_.clear();
+}
+
 bool DynamicsSolver::getMaxPayload(const std::vector<double>& joint_angles, double& payload,
                                    unsigned int& joint_saturated) const
 {
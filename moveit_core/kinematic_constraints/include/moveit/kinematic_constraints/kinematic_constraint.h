@@ -38,6 +38,7 @@
 
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/transforms/transforms.h>
 #include <moveit/collision_detection/collision_env.h>
 #include <moveit/macros/class_forward.h>
@@ -45,7 +46,9 @@
 #include <geometric_shapes/bodies.h>
 #include <moveit_msgs/msg/constraints.hpp>
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 /** \brief Representation and evaluation of kinematic constraints */
@@ -289,6 +292,12 @@ public:
     return joint_variable_index_;
   }
 
+  /** \brief Whether distances to the desired position wrap around, as for continuous revolute joints */
+  bool isContinuous() const
+  {
+    return joint_is_continuous_;
+  }
+
   /**
    * \brief Gets the desired position component of the constraint
    *
@@ -848,9 +857,28 @@ protected:
    */
   bool decideContact(const collision_detection::Contact& contact) const;
 
+  /**
+   * \brief Cheap test whether the cone could touch any robot link the contact check does not accept.
+   *
+   * Compares the bounding sphere of the cone against the bounding spheres of the links with collision geometry.
+   * If this returns false, the full collision check cannot find a rejected contact.
+   */
+  bool coneMayTouchRobot(const moveit::core::RobotState& state, const shapes::Mesh& cone) const;
+
+  /** \brief Take a collision environment for checking the cone from the pool, creating one if the pool is empty */
+  collision_detection::CollisionEnvPtr acquireConeEnv() const;
+
+  /** \brief Return a collision environment taken with acquireConeEnv() to the pool */
+  void releaseConeEnv(const collision_detection::CollisionEnvPtr& env) const;
+
   moveit::core::RobotModelConstPtr robot_model_; /**< \brief A copy of the robot model used to create collision
                                                              environments to check the cone against robot links */
 
+  // creating the robot collision geometry dominates the cost of the cone check, so environments are kept and reused;
+  // there is one per concurrent decide() call
+  mutable std::mutex cone_envs_lock_;
+  mutable std::vector<collision_detection::CollisionEnvPtr> cone_envs_;
+
   std::string target_frame_id_;      /**< \brief The target frame id */
   std::string sensor_frame_id_;      /**< \brief The sensor frame id */
   Eigen::Isometry3d sensor_pose_;    /**< \brief The sensor pose transformed into the transform frame */
@@ -978,6 +1006,54 @@ public:
   ConstraintEvaluationResult decide(const moveit::core::RobotState& state,
                                     std::vector<ConstraintEvaluationResult>& results, bool verbose = false) const;
 
+  /**
+   * \brief Determines whether all constraints are satisfied by state, without computing distances
+   *
+   * Equivalent to decide(state, verbose).satisfied, but returns as soon as one constraint is violated. Joint
+   * constraints on non-continuous joints are checked first, as a single branch-free pass over flattened bounds.
+   * The other constraints follow from the cheapest to the most expensive type, starting with the constraint that
+   * rejected states most often so far. Thread-safe, like decide().
+   *
+   * @param [in] state The state to test
+   * @param [in] verbose Whether or not to make each constraint give debug output, which evaluates all of them
+   *
+   * @return True if all constraints are satisfied
+   */
+  bool isSatisfied(const moveit::core::RobotState& state, bool verbose = false) const;
+
+  /**
+   * \brief Evaluate all constraints on a batch of states, like decide() on each state
+   *
+   * The states are evaluated concurrently on \e num_threads threads (0 uses one thread per hardware thread). The
+   * constraints use the link transforms cached in the states, so the states need to be up to date.
+   *
+   * @param [in] states The states to test
+   * @param [out] results The result of each state, in the order of \e states
+   * @param [in] num_threads The number of threads to evaluate the states on
+   *
+   * @return A single result that is satisfied only if all states satisfy all constraints, with a distance that is the
+   * sum of the distances of all states
+   */
+  ConstraintEvaluationResult decideBatch(const std::vector<const moveit::core::RobotState*>& states,
+                                         std::vector<ConstraintEvaluationResult>& results,
+                                         unsigned int num_threads = 0) const;
+
+  /**
+   * \brief Evaluate all constraints on a batch of states, updating the link transforms of each state first
+   *
+   * Forward kinematics and the constraint evaluation of each state run in the same concurrent pass, see above.
+   */
+  ConstraintEvaluationResult decideBatch(std::vector<moveit::core::RobotState>& states,
+                                         std::vector<ConstraintEvaluationResult>& results,
+                                         unsigned int num_threads = 0) const;
+
+  /**
+   * \brief Evaluate all constraints on all waypoints of \e trajectory, see above. The waypoints need to be up to date.
+   */
+  ConstraintEvaluationResult decideBatch(const robot_trajectory::RobotTrajectory& trajectory,
+                                         std::vector<ConstraintEvaluationResult>& results,
+                                         unsigned int num_threads = 0) const;
+
   /**
    * \brief Whether or not another KinematicConstraintSet is equal to
    * this one.
@@ -1084,5 +1160,52 @@ protected:
                                                                                all
                                                                                internal visibility constraints */
   moveit_msgs::msg::Constraints all_constraints_; /**<  \brief Messages corresponding to all internal constraints */
+
+private:
+  /** \brief Counts how often each constraint was the first to reject a state in isSatisfied(), and which constraint
+   *  did so most often. Counting is thread-safe. Copies start counting anew. */
+  class RejectionCounts
+  {
+  public:
+    RejectionCounts() = default;
+
+    RejectionCounts(const RejectionCounts& other)
+      : counts_(other.counts_.size()), most_frequent_(other.counts_.size())
+    {
+    }
+
+    RejectionCounts& operator=(const RejectionCounts& other)
+    {
+      reset(other.counts_.size());
+      return *this;
+    }
+
+    void reset(std::size_t size);
+
+    void add(std::size_t index);
+
+    /** \brief The index of the constraint that rejected most often, or the number of constraints if none did */
+    std::size_t mostFrequent() const
+    {
+      return most_frequent_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::vector<std::atomic<std::size_t>> counts_;
+    std::atomic<std::size_t> most_frequent_{ 0 };
+  };
+
+  /** \brief Rebuild the data isSatisfied() uses after the constraints changed */
+  void compile();
+
+  // joint constraints on non-continuous joints, flattened for isSatisfied()
+  std::vector<int> joint_bound_indices_;
+  std::vector<double> joint_bound_positions_;
+  std::vector<double> joint_bound_lower_;
+  std::vector<double> joint_bound_upper_;
+
+  // indices in kinematic_constraints_ of the other enabled constraints, cheapest type first
+  std::vector<std::size_t> check_order_;
+  mutable RejectionCounts first_rejections_;
 };
 }  // namespace kinematic_constraints
@@ -39,6 +39,7 @@
 #include <geometric_shapes/shape_operations.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/collision_detection_fcl/collision_env_fcl.h>
+#include <moveit/utils/worker_pool.h>
 #include <geometric_shapes/check_isometry.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
@@ -47,7 +48,9 @@
 #include <functional>
 #include <limits>
 #include <math.h>
+#include <algorithm>
 #include <memory>
+#include <thread>
 #include <typeinfo>
 
 #include <rclcpp/clock.hpp>
@@ -1138,10 +1141,14 @@ ConstraintEvaluationResult VisibilityConstraint::decide(const moveit::core::Robo
       RCLCPP_ERROR(LOGGER, "Visibility constraint is violated because we could not create the visibility cone mesh.");
       return ConstraintEvaluationResult(false, 0.0);
     }
+    shapes::ShapeConstPtr cone(m);
+
+    if (!verbose && !coneMayTouchRobot(state, *m))
+      return ConstraintEvaluationResult(true, 0.0);
 
     // add the visibility cone as an object
-    const auto collision_env_local = std::make_shared<collision_detection::CollisionEnvFCL>(robot_model_);
-    collision_env_local->getWorld()->addToObject("cone", shapes::ShapeConstPtr(m), Eigen::Isometry3d::Identity());
+    const collision_detection::CollisionEnvPtr collision_env_local = acquireConeEnv();
+    collision_env_local->getWorld()->addToObject("cone", cone, Eigen::Isometry3d::Identity());
 
     // check for collisions between the robot and the cone
     collision_detection::AllowedCollisionMatrix acm;
@@ -1167,6 +1174,7 @@ ConstraintEvaluationResult VisibilityConstraint::decide(const moveit::core::Robo
     }
 
     collision_env_local->getWorld()->removeObject("cone");
+    releaseConeEnv(collision_env_local);
 
     return ConstraintEvaluationResult(!res.collision, res.collision ? res.contacts.begin()->second.front().depth : 0.0);
   }
@@ -1175,6 +1183,55 @@ ConstraintEvaluationResult VisibilityConstraint::decide(const moveit::core::Robo
   return ConstraintEvaluationResult(true, 0.0);
 }
 
+bool VisibilityConstraint::coneMayTouchRobot(const moveit::core::RobotState& state, const shapes::Mesh& cone) const
+{
+  Eigen::Vector3d cone_min = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+  Eigen::Vector3d cone_max = -cone_min;
+  for (unsigned int i = 0; i < cone.vertex_count; ++i)
+  {
+    const Eigen::Vector3d v(cone.vertices[i * 3], cone.vertices[i * 3 + 1], cone.vertices[i * 3 + 2]);
+    cone_min = cone_min.cwiseMin(v);
+    cone_max = cone_max.cwiseMax(v);
+  }
+  const Eigen::Vector3d cone_center = 0.5 * (cone_min + cone_max);
+  const double cone_radius = 0.5 * (cone_max - cone_min).norm();
+
+  for (const moveit::core::LinkModel* link : robot_model_->getLinkModelsWithCollisionGeometry())
+  {
+    // contacts with the sensor and target links are accepted by decideContact()
+    if (moveit::core::Transforms::sameFrame(link->getName(), sensor_frame_id_) ||
+        moveit::core::Transforms::sameFrame(link->getName(), target_frame_id_))
+      continue;
+    const Eigen::Vector3d link_center = state.getGlobalLinkTransform(link) * link->getCenteredBoundingBoxOffset();
+    const double link_radius = 0.5 * link->getShapeExtentsAtOrigin().norm();
+    const double reach = cone_radius + link_radius;
+    if ((link_center - cone_center).squaredNorm() <= reach * reach)
+      return true;
+  }
+  // contacts with attached bodies are always accepted, so they need no check
+  return false;
+}
+
+collision_detection::CollisionEnvPtr VisibilityConstraint::acquireConeEnv() const
+{
+  {
+    std::lock_guard<std::mutex> guard(cone_envs_lock_);
+    if (!cone_envs_.empty())
+    {
+      collision_detection::CollisionEnvPtr env = cone_envs_.back();
+      cone_envs_.pop_back();
+      return env;
+    }
+  }
+  return std::make_shared<collision_detection::CollisionEnvFCL>(robot_model_);
+}
+
+void VisibilityConstraint::releaseConeEnv(const collision_detection::CollisionEnvPtr& env) const
+{
+  std::lock_guard<std::mutex> guard(cone_envs_lock_);
+  cone_envs_.push_back(env);
+}
+
 bool VisibilityConstraint::decideContact(const collision_detection::Contact& contact) const
 {
   if (contact.body_type_1 == collision_detection::BodyTypes::ROBOT_ATTACHED ||
@@ -1219,6 +1276,7 @@ void KinematicConstraintSet::clear()
   position_constraints_.clear();
   orientation_constraints_.clear();
   visibility_constraints_.clear();
+  compile();
 }
 
 bool KinematicConstraintSet::add(const std::vector<moveit_msgs::msg::JointConstraint>& jc)
@@ -1233,6 +1291,7 @@ bool KinematicConstraintSet::add(const std::vector<moveit_msgs::msg::JointConstr
     joint_constraints_.push_back(joint_constraint);
     all_constraints_.joint_constraints.push_back(joint_constraint);
   }
+  compile();
   return result;
 }
 
@@ -1249,6 +1308,7 @@ bool KinematicConstraintSet::add(const std::vector<moveit_msgs::msg::PositionCon
     position_constraints_.push_back(position_constraint);
     all_constraints_.position_constraints.push_back(position_constraint);
   }
+  compile();
   return result;
 }
 
@@ -1265,6 +1325,7 @@ bool KinematicConstraintSet::add(const std::vector<moveit_msgs::msg::Orientation
     orientation_constraints_.push_back(orientation_constraint);
     all_constraints_.orientation_constraints.push_back(orientation_constraint);
   }
+  compile();
   return result;
 }
 
@@ -1281,6 +1342,7 @@ bool KinematicConstraintSet::add(const std::vector<moveit_msgs::msg::VisibilityC
     visibility_constraints_.push_back(visibility_constraint);
     all_constraints_.visibility_constraints.push_back(visibility_constraint);
   }
+  compile();
   return result;
 }
 
@@ -1322,6 +1384,146 @@ ConstraintEvaluationResult KinematicConstraintSet::decide(const moveit::core::Ro
   return result;
 }
 
+bool KinematicConstraintSet::isSatisfied(const moveit::core::RobotState& state, bool verbose) const
+{
+  if (verbose)
+    return decide(state, verbose).satisfied;
+
+  // the same comparisons as JointConstraint::decide(), without branches, so the loop can be vectorized
+  const double* positions = state.getVariablePositions();
+  bool joints_satisfied = true;
+  for (std::size_t i = 0; i < joint_bound_indices_.size(); ++i)
+  {
+    const double dif = positions[joint_bound_indices_[i]] - joint_bound_positions_[i];
+    joints_satisfied &= (dif <= joint_bound_upper_[i]) & (dif >= joint_bound_lower_[i]);
+  }
+  if (!joints_satisfied)
+    return false;
+
+  const std::size_t first = first_rejections_.mostFrequent();
+  if (first < kinematic_constraints_.size() && !kinematic_constraints_[first]->decide(state).satisfied)
+  {
+    first_rejections_.add(first);
+    return false;
+  }
+  for (const std::size_t index : check_order_)
+  {
+    if (index != first && !kinematic_constraints_[index]->decide(state).satisfied)
+    {
+      first_rejections_.add(index);
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace
+{
+// Call evaluate(i) for all i in [0, count) on num_threads threads and sum up the results
+template <typename Evaluate>
+ConstraintEvaluationResult decideAll(std::size_t count, std::vector<ConstraintEvaluationResult>& results,
+                                     unsigned int num_threads, const Evaluate& evaluate)
+{
+  results.resize(count);
+  const std::size_t thread_count =
+      std::min<std::size_t>(num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency()), count);
+  if (thread_count > 1)
+  {
+    moveit::core::WorkerPool pool(thread_count);
+    pool.run(count, [&](std::size_t index, unsigned int /*thread*/) { results[index] = evaluate(index); });
+  }
+  else
+  {
+    for (std::size_t i = 0; i < count; ++i)
+      results[i] = evaluate(i);
+  }
+
+  ConstraintEvaluationResult result(true, 0.0);
+  for (const ConstraintEvaluationResult& r : results)
+  {
+    result.satisfied = result.satisfied && r.satisfied;
+    result.distance += r.distance;
+  }
+  return result;
+}
+}  // namespace
+
+ConstraintEvaluationResult
+KinematicConstraintSet::decideBatch(const std::vector<const moveit::core::RobotState*>& states,
+                                    std::vector<ConstraintEvaluationResult>& results, unsigned int num_threads) const
+{
+  return decideAll(states.size(), results, num_threads, [&](std::size_t i) { return decide(*states[i]); });
+}
+
+ConstraintEvaluationResult KinematicConstraintSet::decideBatch(std::vector<moveit::core::RobotState>& states,
+                                                               std::vector<ConstraintEvaluationResult>& results,
+                                                               unsigned int num_threads) const
+{
+  return decideAll(states.size(), results, num_threads, [&](std::size_t i) {
+    states[i].update();
+    return decide(states[i]);
+  });
+}
+
+ConstraintEvaluationResult KinematicConstraintSet::decideBatch(const robot_trajectory::RobotTrajectory& trajectory,
+                                                               std::vector<ConstraintEvaluationResult>& results,
+                                                               unsigned int num_threads) const
+{
+  return decideAll(trajectory.getWayPointCount(), results, num_threads,
+                   [&](std::size_t i) { return decide(trajectory.getWayPoint(i)); });
+}
+
+void KinematicConstraintSet::compile()
+{
+  joint_bound_indices_.clear();
+  joint_bound_positions_.clear();
+  joint_bound_lower_.clear();
+  joint_bound_upper_.clear();
+  check_order_.clear();
+  for (std::size_t i = 0; i < kinematic_constraints_.size(); ++i)
+  {
+    const KinematicConstraint& constraint = *kinematic_constraints_[i];
+    // disabled constraints are always satisfied
+    if (!constraint.enabled())
+      continue;
+    if (constraint.getType() == KinematicConstraint::JOINT_CONSTRAINT)
+    {
+      const JointConstraint& joint_constraint = static_cast<const JointConstraint&>(constraint);
+      if (!joint_constraint.isContinuous())
+      {
+        joint_bound_indices_.push_back(joint_constraint.getJointVariableIndex());
+        joint_bound_positions_.push_back(joint_constraint.getDesiredJointPosition());
+        joint_bound_lower_.push_back(-joint_constraint.getJointToleranceBelow() -
+                                     2.0 * std::numeric_limits<double>::epsilon());
+        joint_bound_upper_.push_back(joint_constraint.getJointToleranceAbove() +
+                                     2.0 * std::numeric_limits<double>::epsilon());
+        continue;
+      }
+    }
+    check_order_.push_back(i);
+  }
+  // the constraint types are declared from the cheapest to the most expensive to check
+  std::stable_sort(check_order_.begin(), check_order_.end(), [this](std::size_t a, std::size_t b) {
+    return kinematic_constraints_[a]->getType() < kinematic_constraints_[b]->getType();
+  });
+  first_rejections_.reset(kinematic_constraints_.size());
+}
+
+void KinematicConstraintSet::RejectionCounts::reset(std::size_t size)
+{
+  counts_ = std::vector<std::atomic<std::size_t>>(size);
+  most_frequent_.store(size, std::memory_order_relaxed);
+}
+
+void KinematicConstraintSet::RejectionCounts::add(std::size_t index)
+{
+  // races between threads can only make the choice of the most frequent constraint less accurate
+  const std::size_t count = counts_[index].fetch_add(1, std::memory_order_relaxed) + 1;
+  const std::size_t most_frequent = most_frequent_.load(std::memory_order_relaxed);
+  if (most_frequent >= counts_.size() || count > counts_[most_frequent].load(std::memory_order_relaxed))
+    most_frequent_.store(index, std::memory_order_relaxed);
+}
+
 void KinematicConstraintSet::print(std::ostream& out) const
 {
   out << kinematic_constraints_.size() << " kinematic constraints" << '\n';
@@ -789,6 +789,53 @@ TEST_F(LoadPlanningModelsPr2, VisibilityConstraintsPR2)
   EXPECT_FALSE(vc.decide(robot_state, true).satisfied);
 }
 
+TEST_F(LoadPlanningModelsPr2, VisibilityConstraintsRepeated)
+{
+  moveit::core::RobotState clear_state(robot_model_);
+  clear_state.setToDefaultValues();
+  clear_state.update();
+  moveit::core::RobotState blocked_state(clear_state);
+  std::map<std::string, double> state_values;
+  state_values["l_shoulder_lift_joint"] = .5;
+  state_values["r_shoulder_pan_joint"] = .5;
+  state_values["r_elbow_flex_joint"] = -1.4;
+  blocked_state.setVariablePositions(state_values);
+  blocked_state.update();
+  moveit::core::Transforms tf(robot_model_->getModelFrame());
+
+  kinematic_constraints::VisibilityConstraint vc(robot_model_);
+  moveit_msgs::msg::VisibilityConstraint vcm;
+  vcm.sensor_pose.header.frame_id = "narrow_stereo_optical_frame";
+  vcm.sensor_pose.pose.position.z = 0.05;
+  vcm.sensor_pose.pose.orientation.w = 1.0;
+  vcm.target_pose.header.frame_id = "l_gripper_r_finger_tip_link";
+  vcm.target_pose.pose.position.z = 0.03;
+  vcm.target_pose.pose.orientation.w = 1.0;
+  vcm.target_radius = .05;
+  vcm.cone_sides = 10;
+  vcm.sensor_view_direction = moveit_msgs::msg::VisibilityConstraint::SENSOR_Z;
+  vcm.weight = 1.0;
+  ASSERT_TRUE(vc.configure(vcm, tf));
+
+  // the collision environment is reused between calls, and must not keep the cone of an earlier call
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_TRUE(vc.decide(clear_state).satisfied);
+    EXPECT_FALSE(vc.decide(blocked_state).satisfied);
+    EXPECT_EQ(vc.decide(blocked_state).satisfied, vc.decide(blocked_state, true).satisfied);
+  }
+
+  // a tiny cone far away from the robot passes on the bounding volume check alone
+  vcm.sensor_pose.header.frame_id = robot_model_->getModelFrame();
+  vcm.sensor_pose.pose.position.x = 10.0;
+  vcm.target_pose.header.frame_id = robot_model_->getModelFrame();
+  vcm.target_pose.pose.position.x = 11.0;
+  vcm.target_radius = .01;
+  ASSERT_TRUE(vc.configure(vcm, tf));
+  EXPECT_TRUE(vc.decide(blocked_state).satisfied);
+  EXPECT_TRUE(vc.decide(blocked_state, true).satisfied);
+}
+
 TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSet)
 {
   moveit::core::RobotState robot_state(robot_model_);
@@ -855,6 +902,123 @@ TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSet)
   EXPECT_FALSE(kcs.decide(robot_state).satisfied);
 }
 
+TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSetIsSatisfied)
+{
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  moveit::core::Transforms tf(robot_model_->getModelFrame());
+
+  kinematic_constraints::KinematicConstraintSet kcs(robot_model_);
+  // an empty set is always satisfied
+  EXPECT_TRUE(kcs.isSatisfied(robot_state));
+
+  moveit_msgs::msg::Constraints constraints;
+  // bounded, continuous and unknown joints
+  for (const std::string& joint_name : { "head_pan_joint", "r_shoulder_pan_joint", "l_wrist_roll_joint", "no_joint" })
+  {
+    moveit_msgs::msg::JointConstraint jcm;
+    jcm.joint_name = joint_name;
+    jcm.position = 0.2;
+    jcm.tolerance_above = 1.5;
+    jcm.tolerance_below = 1.5;
+    jcm.weight = 1.0;
+    constraints.joint_constraints.push_back(jcm);
+  }
+  moveit_msgs::msg::PositionConstraint pcm;
+  pcm.header.frame_id = robot_model_->getModelFrame();
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.constraint_region.primitives.resize(1);
+  pcm.constraint_region.primitives[0].type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  pcm.constraint_region.primitives[0].dimensions.push_back(1.0);
+  pcm.constraint_region.primitive_poses.resize(1);
+  pcm.constraint_region.primitive_poses[0].position.x = 0.55;
+  pcm.constraint_region.primitive_poses[0].position.y = 0.2;
+  pcm.constraint_region.primitive_poses[0].position.z = 1.25;
+  pcm.constraint_region.primitive_poses[0].orientation.w = 1.0;
+  pcm.weight = 1.0;
+  constraints.position_constraints.push_back(pcm);
+  EXPECT_FALSE(kcs.add(constraints, tf));
+
+  // the early-exit evaluation agrees with decide() however often each constraint rejected states before
+  std::size_t satisfied = 0;
+  for (std::size_t i = 0; i < 1000; ++i)
+  {
+    robot_state.setToRandomPositions();
+    robot_state.update();
+    const bool expected = kcs.decide(robot_state).satisfied;
+    EXPECT_EQ(kcs.isSatisfied(robot_state), expected);
+    satisfied += expected ? 1 : 0;
+  }
+  EXPECT_GT(satisfied, 0u);
+
+  // copies evaluate the same constraints
+  const kinematic_constraints::KinematicConstraintSet copy = kcs;
+  robot_state.setToDefaultValues();
+  robot_state.update();
+  EXPECT_EQ(copy.isSatisfied(robot_state), kcs.decide(robot_state).satisfied);
+}
+
+TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSetDecideBatch)
+{
+  moveit::core::Transforms tf(robot_model_->getModelFrame());
+  kinematic_constraints::KinematicConstraintSet kcs(robot_model_);
+  moveit_msgs::msg::Constraints constraints;
+  moveit_msgs::msg::JointConstraint jcm;
+  jcm.joint_name = "r_shoulder_pan_joint";
+  jcm.position = 0.0;
+  jcm.tolerance_above = 0.5;
+  jcm.tolerance_below = 0.5;
+  jcm.weight = 1.0;
+  constraints.joint_constraints.push_back(jcm);
+  moveit_msgs::msg::OrientationConstraint ocm;
+  ocm.link_name = "r_wrist_roll_link";
+  ocm.header.frame_id = robot_model_->getModelFrame();
+  ocm.orientation.w = 1.0;
+  ocm.absolute_x_axis_tolerance = ocm.absolute_y_axis_tolerance = ocm.absolute_z_axis_tolerance = 1.0;
+  ocm.weight = 1.0;
+  constraints.orientation_constraints.push_back(ocm);
+  ASSERT_TRUE(kcs.add(constraints, tf));
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model_);
+  std::vector<moveit::core::RobotState> states;
+  for (std::size_t i = 0; i < 100; ++i)
+  {
+    moveit::core::RobotState state(robot_model_);
+    state.setToRandomPositions();
+    trajectory.addSuffixWayPoint(state, 0.1);
+    states.push_back(state);
+  }
+  for (std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+    trajectory.getWayPointPtr(i)->update();
+
+  for (unsigned int num_threads : { 1u, 4u, 0u })
+  {
+    std::vector<kinematic_constraints::ConstraintEvaluationResult> results;
+    const kinematic_constraints::ConstraintEvaluationResult result = kcs.decideBatch(trajectory, results, num_threads);
+    ASSERT_EQ(results.size(), trajectory.getWayPointCount());
+    bool all_satisfied = true;
+    double distance = 0.0;
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+      const kinematic_constraints::ConstraintEvaluationResult expected = kcs.decide(trajectory.getWayPoint(i));
+      EXPECT_EQ(results[i].satisfied, expected.satisfied);
+      EXPECT_DOUBLE_EQ(results[i].distance, expected.distance);
+      all_satisfied = all_satisfied && expected.satisfied;
+      distance += expected.distance;
+    }
+    EXPECT_EQ(result.satisfied, all_satisfied);
+    EXPECT_NEAR(result.distance, distance, 1e-9);
+
+    // states that are not up to date are updated in the batch
+    std::vector<kinematic_constraints::ConstraintEvaluationResult> state_results;
+    std::vector<moveit::core::RobotState> batch = states;
+    kcs.decideBatch(batch, state_results, num_threads);
+    ASSERT_EQ(state_results.size(), results.size());
+    for (std::size_t i = 0; i < results.size(); ++i)
+      EXPECT_EQ(state_results[i].satisfied, results[i].satisfied);
+  }
+}
+
 TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSetEquality)
 {
   moveit::core::RobotState robot_state(robot_model_);
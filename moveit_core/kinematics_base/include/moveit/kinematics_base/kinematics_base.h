@@ -366,6 +366,40 @@ public:
     return false;
   }
 
+  /**
+   * @brief Solve a batch of independent IK queries for a single tip link.
+   *
+   * Query i asks for a solution reaching ik_poses[i] from seed ik_seed_states[i]. Either vector may instead hold a
+   * single element which is then used for every query, e.g. to try many seeds for one pose or to rank many poses from
+   * the current state. Each query is solved as by searchPositionIK() with the given timeout.
+   *
+   * The default implementation calls searchPositionIK() for each query. The queries are spread over several threads
+   * if supportsConcurrentQueries() returns true, and solved one after another otherwise. Solvers can override this to
+   * share setup work between the queries.
+   * @param ik_poses the desired poses of the tip link
+   * @param ik_seed_states the initial guesses for the inverse kinematics
+   * @param timeout The amount of time (in seconds) available to the solver for each query
+   * @param solutions the solution of each query, empty if no solution was found
+   * @param error_codes the error code of each query
+   * @param options container for other IK options. See definition of KinematicsQueryOptions for details.
+   * @return The number of queries for which a solution was found
+   */
+  virtual std::size_t
+  searchPositionIKBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                        const std::vector<std::vector<double> >& ik_seed_states, double timeout,
+                        std::vector<std::vector<double> >& solutions,
+                        std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                        const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const;
+
+  /**
+   * @brief Check whether the searchPositionIK() methods of this solver may be called concurrently from several
+   * threads. This is used by the default implementation of searchPositionIKBatch().
+   */
+  virtual bool supportsConcurrentQueries() const
+  {
+    return false;
+  }
+
   /**
    * @brief Given a set of joint angles and a set of links, compute their pose
    * @param link_names A set of links for which FK needs to be computed
@@ -592,6 +626,27 @@ protected:
   std::map<int, double> redundant_joint_discretization_;
   std::vector<DiscretizationMethod> supported_methods_;
 
+  /**
+   * @brief Check the sizes of the arguments of searchPositionIKBatch() and prepare the output vectors.
+   * @return The number of queries in the batch, 0 if the sizes don't match
+   */
+  std::size_t prepareBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                           const std::vector<std::vector<double> >& ik_seed_states,
+                           std::vector<std::vector<double> >& solutions,
+                           std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes) const;
+
+  /**
+   * @brief Run process(worker, query) for every query index of a batch.
+   *
+   * The queries are distributed dynamically over num_workers threads; the calling thread is one of them. The worker
+   * index lies in [0, num_workers), so callers can keep one scratch object per worker.
+   */
+  static void forEachQuery(std::size_t num_queries, std::size_t num_workers,
+                           const std::function<void(std::size_t worker, std::size_t query)>& process);
+
+  /** @brief The number of threads to use for a batch of num_queries queries */
+  static std::size_t batchWorkerCount(std::size_t num_queries);
+
   /** Store some core variables passed via initialize().
    *
    * @param robot_model RobotModel, this kinematics solver should act on.
@@ -37,6 +37,9 @@
 #include <moveit/kinematics_base/kinematics_base.h>
 #include <moveit/robot_model/joint_model_group.h>
 #include <rclcpp/logger.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 namespace kinematics
 {
@@ -199,4 +202,68 @@ bool KinematicsBase::getPositionIK(const std::vector<geometry_msgs::msg::Pose>&
 
   return true;
 }
+std::size_t KinematicsBase::searchPositionIKBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                                  const std::vector<std::vector<double> >& ik_seed_states,
+                                                  double timeout, std::vector<std::vector<double> >& solutions,
+                                                  std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                                                  const KinematicsQueryOptions& options) const
+{
+  const std::size_t num_queries = prepareBatch(ik_poses, ik_seed_states, solutions, error_codes);
+  std::atomic<std::size_t> num_solved{ 0 };
+  forEachQuery(num_queries, supportsConcurrentQueries() ? batchWorkerCount(num_queries) : 1,
+               [&](std::size_t /*worker*/, std::size_t query) {
+                 if (searchPositionIK(ik_poses[ik_poses.size() == 1 ? 0 : query],
+                                      ik_seed_states[ik_seed_states.size() == 1 ? 0 : query], timeout,
+                                      solutions[query], error_codes[query], options))
+                   ++num_solved;
+                 else
+                   solutions[query].clear();
+               });
+  return num_solved;
+}
+
+std::size_t KinematicsBase::prepareBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                         const std::vector<std::vector<double> >& ik_seed_states,
+                                         std::vector<std::vector<double> >& solutions,
+                                         std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes) const
+{
+  solutions.clear();
+  error_codes.clear();
+  if (ik_poses.empty() || ik_seed_states.empty() ||
+      (ik_poses.size() != ik_seed_states.size() && ik_poses.size() != 1 && ik_seed_states.size() != 1))
+  {
+    RCLCPP_ERROR(LOGGER, "IK batch needs matching numbers of poses and seeds (or a single one), got %zu and %zu",
+                 ik_poses.size(), ik_seed_states.size());
+    return 0;
+  }
+  const std::size_t num_queries = std::max(ik_poses.size(), ik_seed_states.size());
+  solutions.resize(num_queries);
+  error_codes.resize(num_queries);
+  return num_queries;
+}
+
+void KinematicsBase::forEachQuery(std::size_t num_queries, std::size_t num_workers,
+                                  const std::function<void(std::size_t worker, std::size_t query)>& process)
+{
+  num_workers = std::clamp<std::size_t>(num_workers, 1, std::max<std::size_t>(num_queries, 1));
+  std::atomic<std::size_t> next_query{ 0 };
+  const auto work = [&](std::size_t worker) {
+    for (std::size_t query = next_query++; query < num_queries; query = next_query++)
+      process(worker, query);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers - 1);
+  for (std::size_t worker = 1; worker < num_workers; ++worker)
+    threads.emplace_back(work, worker);
+  work(0);
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+std::size_t KinematicsBase::batchWorkerCount(std::size_t num_queries)
+{
+  return std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, std::max<std::size_t>(num_queries, 1));
+}
+
 }  // end of namespace kinematics
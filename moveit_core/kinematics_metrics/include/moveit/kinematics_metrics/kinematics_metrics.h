@@ -124,6 +124,39 @@ public:
   bool getManipulability(const moveit::core::RobotState& state, const moveit::core::JointModelGroup* joint_model_group,
                          double& condition_number, bool translation = false) const;
 
+  /**
+   * @brief Get the manipulability index for many configurations of a group at once. The robot state and the
+   * Jacobian, Gram matrix and SVD workspaces are shared by all configurations.
+   * @param state Complete kinematic state for the robot, supplies the variables that are not part of the group
+   * @param joint_model_group A pointer to the desired joint model group
+   * @param group_positions The group configurations, one per column in the order of the group variables
+   * @param manipulability_indices The computed manipulability index of each configuration, as for
+   * getManipulabilityIndex()
+   * @param translation Only consider the translation part of the Jacobian
+   * @param determinant_only Always compute the index as sqrt(det(JJ^T)), or sqrt(det(J^TJ)) if J has fewer
+   * columns than rows, which equals the product of the singular values without computing an SVD
+   * @return False if the group is not a chain or the positions do not match the group
+   */
+  bool getManipulabilityIndices(const moveit::core::RobotState& state,
+                                const moveit::core::JointModelGroup* joint_model_group,
+                                const Eigen::MatrixXd& group_positions, std::vector<double>& manipulability_indices,
+                                bool translation = false, bool determinant_only = false) const;
+
+  /**
+   * @brief Get the manipulability = sigma_min/sigma_max for many configurations of a group at once. The robot state
+   * and the Jacobian and SVD workspaces are shared by all configurations.
+   * @param state Complete kinematic state for the robot, supplies the variables that are not part of the group
+   * @param joint_model_group A pointer to the desired joint model group
+   * @param group_positions The group configurations, one per column in the order of the group variables
+   * @param condition_numbers The computed manipulability of each configuration, as for getManipulability()
+   * @param translation Only consider the translation part of the Jacobian
+   * @return False if the group is not a chain or the positions do not match the group
+   */
+  bool getManipulabilities(const moveit::core::RobotState& state,
+                           const moveit::core::JointModelGroup* joint_model_group,
+                           const Eigen::MatrixXd& group_positions, std::vector<double>& condition_numbers,
+                           bool translation = false) const;
+
   void setPenaltyMultiplier(double multiplier)
   {
     penalty_multiplier_ = fabs(multiplier);
@@ -255,4 +255,85 @@ bool KinematicsMetrics::getManipulability(const moveit::core::RobotState& state,
   return true;
 }
 
+bool KinematicsMetrics::getManipulabilityIndices(const moveit::core::RobotState& state,
+                                                 const moveit::core::JointModelGroup* joint_model_group,
+                                                 const Eigen::MatrixXd& group_positions,
+                                                 std::vector<double>& manipulability_indices, bool translation,
+                                                 bool determinant_only) const
+{
+  // state.getJacobian() only works for chain groups.
+  if (!joint_model_group->isChain() || group_positions.rows() != joint_model_group->getVariableCount())
+  {
+    return false;
+  }
+
+  moveit::core::RobotState workspace_state(state);
+  const moveit::core::LinkModel* tip = joint_model_group->getLinkModels().back();
+  Eigen::VectorXd positions;
+  Eigen::MatrixXd jacobian, gram;
+  Eigen::JacobiSVD<Eigen::MatrixXd> svdsolver;
+  manipulability_indices.resize(group_positions.cols());
+  for (Eigen::Index i = 0; i < group_positions.cols(); ++i)
+  {
+    positions = group_positions.col(i);
+    workspace_state.setJointGroupPositions(joint_model_group, positions);
+    if (!workspace_state.getJacobian(joint_model_group, tip, Eigen::Vector3d::Zero(), jacobian))
+    {
+      return false;
+    }
+    const auto task_jacobian = jacobian.topRows(translation ? 3 : jacobian.rows());
+
+    // the product of the singular values of J is the square root of the determinant of its smaller Gram matrix
+    double index;
+    if (!determinant_only && jacobian.cols() < 6)
+    {
+      svdsolver.compute(task_jacobian);
+      index = svdsolver.singularValues().prod();
+    }
+    else
+    {
+      if (task_jacobian.cols() < task_jacobian.rows())
+        gram.noalias() = task_jacobian.transpose() * task_jacobian;
+      else
+        gram.noalias() = task_jacobian * task_jacobian.transpose();
+      index = sqrt(std::max(0.0, gram.determinant()));
+    }
+    manipulability_indices[i] = getJointLimitsPenalty(workspace_state, joint_model_group) * index;
+  }
+  return true;
+}
+
+bool KinematicsMetrics::getManipulabilities(const moveit::core::RobotState& state,
+                                            const moveit::core::JointModelGroup* joint_model_group,
+                                            const Eigen::MatrixXd& group_positions,
+                                            std::vector<double>& condition_numbers, bool translation) const
+{
+  // state.getJacobian() only works for chain groups.
+  if (!joint_model_group->isChain() || group_positions.rows() != joint_model_group->getVariableCount())
+  {
+    return false;
+  }
+
+  moveit::core::RobotState workspace_state(state);
+  const moveit::core::LinkModel* tip = joint_model_group->getLinkModels().back();
+  Eigen::VectorXd positions;
+  Eigen::MatrixXd jacobian;
+  Eigen::JacobiSVD<Eigen::MatrixXd> svdsolver;
+  condition_numbers.resize(group_positions.cols());
+  for (Eigen::Index i = 0; i < group_positions.cols(); ++i)
+  {
+    positions = group_positions.col(i);
+    workspace_state.setJointGroupPositions(joint_model_group, positions);
+    if (!workspace_state.getJacobian(joint_model_group, tip, Eigen::Vector3d::Zero(), jacobian))
+    {
+      return false;
+    }
+    svdsolver.compute(jacobian.topRows(translation ? 3 : jacobian.rows()));
+    const Eigen::VectorXd& singular_values = svdsolver.singularValues();
+    condition_numbers[i] = getJointLimitsPenalty(workspace_state, joint_model_group) * singular_values.minCoeff() /
+                           singular_values.maxCoeff();
+  }
+  return true;
+}
+
 }  // end of namespace kinematics_metrics
@@ -39,7 +39,11 @@
 
 #pragma once
 
+#include <Eigen/Core>
+#include <array>
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 // Auto-generated
 #include <moveit_butterworth_parameters.hpp>
@@ -88,6 +92,73 @@ private:
   double feedback_term_;
 };
 
+/**
+ * Throws std::length_error if low_pass_filter_coeff does not give a stable ButterworthFilter.
+ */
+void checkButterworthFilterCoeff(double low_pass_filter_coeff);
+
+/**
+ * Class MultiButterworthFilter - The filter of ButterworthFilter for many signals at once, e.g. all joints of a group.
+ * The filter state of all signals is stored in contiguous arrays, so a filter step is a few vectorized operations
+ * and does not allocate.
+ * DOF is the number of signals if it is known at compile time, or Eigen::Dynamic otherwise.
+ */
+template <int DOF = Eigen::Dynamic>
+class MultiButterworthFilter
+{
+public:
+  using Vector = Eigen::Array<double, DOF, 1>;
+
+  /**
+   * Constructor.
+   * @param low_pass_filter_coeff The filter coefficient, as for ButterworthFilter
+   * @param size The number of signals. Must equal DOF, unless DOF is Eigen::Dynamic.
+   */
+  MultiButterworthFilter(double low_pass_filter_coeff, Eigen::Index size = DOF)
+    : previous_measurements_(Vector::Zero(size))
+    , previous_filtered_measurements_(Vector::Zero(size))
+    , scale_term_(1. / (1. + low_pass_filter_coeff))
+    , feedback_term_(1. - low_pass_filter_coeff)
+  {
+    checkButterworthFilterCoeff(low_pass_filter_coeff);
+  }
+  MultiButterworthFilter() = delete;
+
+  Eigen::Index size() const
+  {
+    return previous_measurements_.size();
+  }
+
+  /**
+   * Filter one new measurement of every signal, in place.
+   * @param measurements size() values, replaced by the filtered values
+   */
+  void filter(double* measurements)
+  {
+    Eigen::Map<Vector> x(measurements, size());
+    previous_filtered_measurements_ =
+        scale_term_ * (previous_measurements_ + x - feedback_term_ * previous_filtered_measurements_);
+    previous_measurements_ = x;
+    x = previous_filtered_measurements_;
+  }
+
+  /**
+   * Reset every signal to a constant value.
+   * @param data size() values
+   */
+  void reset(const double* data)
+  {
+    previous_measurements_ = Eigen::Map<const Vector>(data, size());
+    previous_filtered_measurements_ = previous_measurements_;
+  }
+
+private:
+  Vector previous_measurements_;
+  Vector previous_filtered_measurements_;
+  double scale_term_;
+  double feedback_term_;
+};
+
 // Plugin
 class ButterworthFilterPlugin : public SmoothingBaseClass
 {
@@ -109,6 +180,13 @@ public:
    */
   bool doSmoothing(std::vector<double>& position_vector) override;
 
+  /**
+   * Smooth the position, velocity and acceleration commands for all DOF, each with its own filter state
+   * @return True if smoothing was successful
+   */
+  bool doSmoothing(std::vector<double>& positions, std::vector<double>& velocities,
+                   std::vector<double>& accelerations) override;
+
   /**
    * Reset to a given joint state
    * @param joint_positions reset the filters to these joint positions
@@ -116,9 +194,21 @@ public:
    */
   bool reset(const std::vector<double>& joint_positions) override;
 
+  /**
+   * Reset the position, velocity and acceleration filters to a given joint state
+   * @return True if reset was successful
+   */
+  bool reset(const std::vector<double>& positions, const std::vector<double>& velocities,
+             const std::vector<double>& accelerations) override;
+
 private:
+  /** Log an error and return false if \e values does not have one value per joint */
+  bool checkLength(const std::vector<double>& values, const char* what) const;
+
   rclcpp::Node::SharedPtr node_;
-  std::vector<ButterworthFilter> position_filters_;
+  std::unique_ptr<MultiButterworthFilter<>> position_filter_;
+  std::unique_ptr<MultiButterworthFilter<>> velocity_filter_;
+  std::unique_ptr<MultiButterworthFilter<>> acceleration_filter_;
   size_t num_joints_;
 };
 }  // namespace online_signal_smoothing
@@ -0,0 +1,116 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Description: A jerk-limited online smoothing plugin built on Ruckig's real-time trajectory generation.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ruckig/ruckig.hpp>
+
+// Auto-generated
+#include <moveit_ruckig_filter_parameters.hpp>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/online_signal_smoothing/smoothing_base_class.h>
+
+namespace online_signal_smoothing
+{
+/**
+ * Class RuckigFilterPlugin - Smooths commands with Ruckig's online (real-time) mode.
+ * Each smoothing step computes a time-optimal, jerk-limited trajectory from the last smoothed state to the
+ * commanded state and outputs its state one update period ahead. Unlike a low-pass filter, this does not delay
+ * commands that are already within the velocity, acceleration and jerk limits of the joints.
+ * The Ruckig instance and its input and output parameters are allocated once in initialize(), so smoothing
+ * does not allocate.
+ */
+class RuckigFilterPlugin : public SmoothingBaseClass
+{
+public:
+  /**
+   * Initialize the smoothing algorithm
+   * @param node ROS node, used for parameter retrieval
+   * @param robot_model used to retrieve the vel/accel/jerk limits of the planning group
+   * @param num_joints number of actuated joints in the JointGroup Servo controls
+   * @return True if initialization was successful
+   */
+  bool initialize(rclcpp::Node::SharedPtr node, moveit::core::RobotModelConstPtr robot_model,
+                  size_t num_joints) override;
+
+  /**
+   * Smooth the position commands for all DOF. The commanded positions are approached to a standstill.
+   * @param position_vector array of joint position commands
+   * @return True if smoothing was successful
+   */
+  bool doSmoothing(std::vector<double>& position_vector) override;
+
+  /**
+   * Smooth the position, velocity and acceleration commands for all DOF. The commanded velocities and
+   * accelerations are the targets at the commanded positions, clamped to the joint limits.
+   * @return True if smoothing was successful
+   */
+  bool doSmoothing(std::vector<double>& positions, std::vector<double>& velocities,
+                   std::vector<double>& accelerations) override;
+
+  /**
+   * Reset to a given joint position, keeping the smoothed velocities and accelerations
+   * @param joint_positions reset the current state to these joint positions
+   * @return True if reset was successful
+   */
+  bool reset(const std::vector<double>& joint_positions) override;
+
+  /**
+   * Reset to a given joint state
+   * @return True if reset was successful
+   */
+  bool reset(const std::vector<double>& positions, const std::vector<double>& velocities,
+             const std::vector<double>& accelerations) override;
+
+private:
+  /** Log an error and return false if \e values does not have one value per joint */
+  bool checkLength(const std::vector<double>& values, const char* what) const;
+
+  /** Run one Ruckig update towards the target in ruckig_input_ and advance the current state */
+  bool update();
+
+  rclcpp::Node::SharedPtr node_;
+  size_t num_joints_;
+  std::unique_ptr<ruckig::Ruckig<ruckig::DynamicDOFs>> ruckig_;
+  std::unique_ptr<ruckig::InputParameter<ruckig::DynamicDOFs>> ruckig_input_;
+  std::unique_ptr<ruckig::OutputParameter<ruckig::DynamicDOFs>> ruckig_output_;
+};
+}  // namespace online_signal_smoothing
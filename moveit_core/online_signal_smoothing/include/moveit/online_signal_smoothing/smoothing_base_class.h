@@ -76,11 +76,33 @@ public:
    */
   virtual bool doSmoothing(std::vector<double>& position_vector) = 0;
 
+  /**
+   * Smooth arrays of joint positions, velocities and accelerations together.
+   * The default implementation only smooths the positions.
+   * @return True if smoothing was successful
+   */
+  virtual bool doSmoothing(std::vector<double>& positions, std::vector<double>& /* velocities */,
+                           std::vector<double>& /* accelerations */)
+  {
+    return doSmoothing(positions);
+  }
+
   /**
    * Reset to a given joint state
    * @param joint_positions reset the filters to these joint positions
    * @return True if reset was successful
    */
   virtual bool reset(const std::vector<double>& joint_positions) = 0;
+
+  /**
+   * Reset to a given joint state including velocities and accelerations.
+   * The default implementation only resets the positions.
+   * @return True if reset was successful
+   */
+  virtual bool reset(const std::vector<double>& positions, const std::vector<double>& /* velocities */,
+                     const std::vector<double>& /* accelerations */)
+  {
+    return reset(positions);
+  }
 };
 }  // namespace online_signal_smoothing
@@ -47,20 +47,15 @@ namespace
 constexpr double EPSILON = 1e-9;
 }
 
-ButterworthFilter::ButterworthFilter(double low_pass_filter_coeff)
-  : previous_measurements_{ 0., 0. }
-  , previous_filtered_measurement_(0.)
-  , scale_term_(1. / (1. + low_pass_filter_coeff))
-  , feedback_term_(1. - low_pass_filter_coeff)
+void checkButterworthFilterCoeff(double low_pass_filter_coeff)
 {
-  // guarantee this doesn't change because the logic below depends on this length implicitly
-  static_assert(ButterworthFilter::FILTER_LENGTH == 2,
-                "online_signal_smoothing::ButterworthFilter::FILTER_LENGTH should be 2");
+  const double scale_term = 1. / (1. + low_pass_filter_coeff);
+  const double feedback_term = 1. - low_pass_filter_coeff;
 
-  if (std::isinf(feedback_term_))
+  if (std::isinf(feedback_term))
     throw std::length_error("online_signal_smoothing::ButterworthFilter: infinite feedback_term_");
 
-  if (std::isinf(scale_term_))
+  if (std::isinf(scale_term))
     throw std::length_error("online_signal_smoothing::ButterworthFilter: infinite scale_term_");
 
   if (low_pass_filter_coeff < 1)
@@ -69,13 +64,26 @@ ButterworthFilter::ButterworthFilter(double low_pass_filter_coeff)
         "online_signal_smoothing::ButterworthFilter: Filter coefficient < 1. makes the lowpass filter unstable");
   }
 
-  if (std::abs(feedback_term_) < EPSILON)
+  if (std::abs(feedback_term) < EPSILON)
   {
     throw std::length_error(
         "online_signal_smoothing::ButterworthFilter: Filter coefficient value resulted in feedback term of 0");
   }
 }
 
+ButterworthFilter::ButterworthFilter(double low_pass_filter_coeff)
+  : previous_measurements_{ 0., 0. }
+  , previous_filtered_measurement_(0.)
+  , scale_term_(1. / (1. + low_pass_filter_coeff))
+  , feedback_term_(1. - low_pass_filter_coeff)
+{
+  // guarantee this doesn't change because the logic below depends on this length implicitly
+  static_assert(ButterworthFilter::FILTER_LENGTH == 2,
+                "online_signal_smoothing::ButterworthFilter::FILTER_LENGTH should be 2");
+
+  checkButterworthFilterCoeff(low_pass_filter_coeff);
+}
+
 double ButterworthFilter::filter(double new_measurement)
 {
   // Push in the new measurement
@@ -104,47 +112,66 @@ bool ButterworthFilterPlugin::initialize(rclcpp::Node::SharedPtr node, moveit::c
   online_signal_smoothing::ParamListener param_listener(node_);
   double filter_coeff = param_listener.get_params().butterworth_filter_coeff;
 
-  for (std::size_t i = 0; i < num_joints_; ++i)
-  {
-    position_filters_.emplace_back(filter_coeff);
-  }
+  position_filter_ = std::make_unique<MultiButterworthFilter<>>(filter_coeff, num_joints_);
+  velocity_filter_ = std::make_unique<MultiButterworthFilter<>>(filter_coeff, num_joints_);
+  acceleration_filter_ = std::make_unique<MultiButterworthFilter<>>(filter_coeff, num_joints_);
   return true;
 };
 
-bool ButterworthFilterPlugin::doSmoothing(std::vector<double>& position_vector)
+bool ButterworthFilterPlugin::checkLength(const std::vector<double>& values, const char* what) const
 {
-  if (position_vector.size() != position_filters_.size())
+  if (values.size() != num_joints_)
   {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
-    RCLCPP_ERROR_THROTTLE(node_->get_logger(), *node_->get_clock(), 1000,
-                          "Position vector to be smoothed does not have the right length.");
+    RCLCPP_ERROR_THROTTLE(node_->get_logger(), *node_->get_clock(), 1000, "%s does not have the right length.",
+                          what);
 #pragma GCC diagnostic pop
     return false;
   }
-  for (size_t i = 0; i < position_vector.size(); ++i)
-  {
-    // Lowpass filter the position command
-    position_vector[i] = position_filters_.at(i).filter(position_vector[i]);
-  }
+  return true;
+}
+
+bool ButterworthFilterPlugin::doSmoothing(std::vector<double>& position_vector)
+{
+  if (!checkLength(position_vector, "Position vector to be smoothed"))
+    return false;
+  // Lowpass filter the position commands
+  position_filter_->filter(position_vector.data());
+  return true;
+};
+
+bool ButterworthFilterPlugin::doSmoothing(std::vector<double>& positions, std::vector<double>& velocities,
+                                          std::vector<double>& accelerations)
+{
+  if (!checkLength(positions, "Position vector to be smoothed") ||
+      !checkLength(velocities, "Velocity vector to be smoothed") ||
+      !checkLength(accelerations, "Acceleration vector to be smoothed"))
+    return false;
+  position_filter_->filter(positions.data());
+  velocity_filter_->filter(velocities.data());
+  acceleration_filter_->filter(accelerations.data());
   return true;
 };
 
 bool ButterworthFilterPlugin::reset(const std::vector<double>& joint_positions)
 {
-  if (joint_positions.size() != position_filters_.size())
-  {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-    RCLCPP_ERROR_THROTTLE(node_->get_logger(), *node_->get_clock(), 1000,
-                          "Position vector to be reset does not have the right length.");
-#pragma GCC diagnostic pop
+  if (!checkLength(joint_positions, "Position vector to be reset"))
     return false;
-  }
-  for (size_t joint_idx = 0; joint_idx < joint_positions.size(); ++joint_idx)
-  {
-    position_filters_.at(joint_idx).reset(joint_positions.at(joint_idx));
-  }
+  position_filter_->reset(joint_positions.data());
+  return true;
+};
+
+bool ButterworthFilterPlugin::reset(const std::vector<double>& positions, const std::vector<double>& velocities,
+                                    const std::vector<double>& accelerations)
+{
+  if (!checkLength(positions, "Position vector to be reset") ||
+      !checkLength(velocities, "Velocity vector to be reset") ||
+      !checkLength(accelerations, "Acceleration vector to be reset"))
+    return false;
+  position_filter_->reset(positions.data());
+  velocity_filter_->reset(velocities.data());
+  acceleration_filter_->reset(accelerations.data());
   return true;
 };
 
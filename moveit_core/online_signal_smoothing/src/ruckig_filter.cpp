@@ -0,0 +1,199 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Description: A jerk-limited online smoothing plugin built on Ruckig's real-time trajectory generation.
+ */
+
+#include <algorithm>
+#include <moveit/online_signal_smoothing/ruckig_filter.h>
+#include <moveit/robot_model/joint_model_group.h>
+#include <rclcpp/clock.hpp>
+#include <rclcpp/logging.hpp>
+
+namespace online_signal_smoothing
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_core.ruckig_filter_plugin");
+
+// Limits of joints without limits in the robot model, as in trajectory_processing::RuckigSmoothing
+constexpr double DEFAULT_MAX_VELOCITY = 5;       // rad/s
+constexpr double DEFAULT_MAX_ACCELERATION = 10;  // rad/s^2
+constexpr double DEFAULT_MAX_JERK = 1000;        // rad/s^3
+}  // namespace
+
+bool RuckigFilterPlugin::initialize(rclcpp::Node::SharedPtr node, moveit::core::RobotModelConstPtr robot_model,
+                                    size_t num_joints)
+{
+  node_ = node;
+  num_joints_ = num_joints;
+
+  ruckig_filter_parameters::ParamListener param_listener(node_);
+  const auto params = param_listener.get_params();
+
+  const std::string& group_name = params.ruckig_filter.planning_group_name;
+  const moveit::core::JointModelGroup* group = robot_model->getJointModelGroup(group_name);
+  if (!group)
+  {
+    RCLCPP_ERROR(LOGGER, "The robot model does not have a planning group named '%s'", group_name.c_str());
+    return false;
+  }
+  if (group->getActiveVariableCount() != num_joints_)
+  {
+    RCLCPP_ERROR(LOGGER, "The planning group '%s' has %u active variables, but %zu joints are smoothed",
+                 group->getName().c_str(), group->getActiveVariableCount(), num_joints_);
+    return false;
+  }
+
+  ruckig_ = std::make_unique<ruckig::Ruckig<ruckig::DynamicDOFs>>(num_joints_, params.ruckig_filter.update_period);
+  ruckig_input_ = std::make_unique<ruckig::InputParameter<ruckig::DynamicDOFs>>(num_joints_);
+  ruckig_output_ = std::make_unique<ruckig::OutputParameter<ruckig::DynamicDOFs>>(num_joints_);
+
+  size_t joint = 0;
+  for (const moveit::core::JointModel::Bounds* joint_bounds : group->getActiveJointModelsBounds())
+  {
+    for (const moveit::core::VariableBounds& bounds : *joint_bounds)
+    {
+      ruckig_input_->max_velocity[joint] = bounds.velocity_bounded_ ? bounds.max_velocity_ : DEFAULT_MAX_VELOCITY;
+      ruckig_input_->max_acceleration[joint] =
+          bounds.acceleration_bounded_ ? bounds.max_acceleration_ : DEFAULT_MAX_ACCELERATION;
+      ruckig_input_->max_jerk[joint] = bounds.jerk_bounded_ ? bounds.max_jerk_ : DEFAULT_MAX_JERK;
+      ++joint;
+    }
+  }
+
+  std::fill(ruckig_input_->current_position.begin(), ruckig_input_->current_position.end(), 0.0);
+  std::fill(ruckig_input_->current_velocity.begin(), ruckig_input_->current_velocity.end(), 0.0);
+  std::fill(ruckig_input_->current_acceleration.begin(), ruckig_input_->current_acceleration.end(), 0.0);
+  return true;
+}
+
+bool RuckigFilterPlugin::checkLength(const std::vector<double>& values, const char* what) const
+{
+  if (values.size() != num_joints_)
+  {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+    RCLCPP_ERROR_THROTTLE(node_->get_logger(), *node_->get_clock(), 1000, "%s does not have the right length.",
+                          what);
+#pragma GCC diagnostic pop
+    return false;
+  }
+  return true;
+}
+
+bool RuckigFilterPlugin::update()
+{
+  const ruckig::Result result = ruckig_->update(*ruckig_input_, *ruckig_output_);
+  if (result != ruckig::Result::Working && result != ruckig::Result::Finished)
+  {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+    RCLCPP_ERROR_THROTTLE(node_->get_logger(), *node_->get_clock(), 1000,
+                          "Ruckig could not compute a smoothed command (result %d).", static_cast<int>(result));
+#pragma GCC diagnostic pop
+    return false;
+  }
+  ruckig_output_->pass_to_input(*ruckig_input_);
+  return true;
+}
+
+bool RuckigFilterPlugin::doSmoothing(std::vector<double>& position_vector)
+{
+  if (!checkLength(position_vector, "Position vector to be smoothed"))
+    return false;
+  std::copy(position_vector.begin(), position_vector.end(), ruckig_input_->target_position.begin());
+  std::fill(ruckig_input_->target_velocity.begin(), ruckig_input_->target_velocity.end(), 0.0);
+  std::fill(ruckig_input_->target_acceleration.begin(), ruckig_input_->target_acceleration.end(), 0.0);
+  if (!update())
+    return false;
+  std::copy(ruckig_output_->new_position.begin(), ruckig_output_->new_position.end(), position_vector.begin());
+  return true;
+}
+
+bool RuckigFilterPlugin::doSmoothing(std::vector<double>& positions, std::vector<double>& velocities,
+                                     std::vector<double>& accelerations)
+{
+  if (!checkLength(positions, "Position vector to be smoothed") ||
+      !checkLength(velocities, "Velocity vector to be smoothed") ||
+      !checkLength(accelerations, "Acceleration vector to be smoothed"))
+    return false;
+  // Ruckig rejects targets outside of the limits
+  for (size_t joint = 0; joint < num_joints_; ++joint)
+  {
+    ruckig_input_->target_position[joint] = positions[joint];
+    ruckig_input_->target_velocity[joint] =
+        std::clamp(velocities[joint], -ruckig_input_->max_velocity[joint], ruckig_input_->max_velocity[joint]);
+    ruckig_input_->target_acceleration[joint] = std::clamp(
+        accelerations[joint], -ruckig_input_->max_acceleration[joint], ruckig_input_->max_acceleration[joint]);
+  }
+  if (!update())
+    return false;
+  std::copy(ruckig_output_->new_position.begin(), ruckig_output_->new_position.end(), positions.begin());
+  std::copy(ruckig_output_->new_velocity.begin(), ruckig_output_->new_velocity.end(), velocities.begin());
+  std::copy(ruckig_output_->new_acceleration.begin(), ruckig_output_->new_acceleration.end(), accelerations.begin());
+  return true;
+}
+
+bool RuckigFilterPlugin::reset(const std::vector<double>& joint_positions)
+{
+  if (!checkLength(joint_positions, "Position vector to be reset"))
+    return false;
+  std::copy(joint_positions.begin(), joint_positions.end(), ruckig_input_->current_position.begin());
+  return true;
+}
+
+bool RuckigFilterPlugin::reset(const std::vector<double>& positions, const std::vector<double>& velocities,
+                               const std::vector<double>& accelerations)
+{
+  if (!checkLength(positions, "Position vector to be reset") ||
+      !checkLength(velocities, "Velocity vector to be reset") ||
+      !checkLength(accelerations, "Acceleration vector to be reset"))
+    return false;
+  // Ruckig rejects current states outside of the limits
+  for (size_t joint = 0; joint < num_joints_; ++joint)
+  {
+    ruckig_input_->current_position[joint] = positions[joint];
+    ruckig_input_->current_velocity[joint] =
+        std::clamp(velocities[joint], -ruckig_input_->max_velocity[joint], ruckig_input_->max_velocity[joint]);
+    ruckig_input_->current_acceleration[joint] = std::clamp(
+        accelerations[joint], -ruckig_input_->max_acceleration[joint], ruckig_input_->max_acceleration[joint]);
+  }
+  return true;
+}
+
+}  // namespace online_signal_smoothing
+
+#include <pluginlib/class_list_macros.hpp>
+PLUGINLIB_EXPORT_CLASS(online_signal_smoothing::RuckigFilterPlugin, online_signal_smoothing::SmoothingBaseClass)
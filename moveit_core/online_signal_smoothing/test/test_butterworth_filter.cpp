@@ -41,6 +41,8 @@
 
 #include <gtest/gtest.h>
 #include <moveit/online_signal_smoothing/butterworth_filter.h>
+#include <cmath>
+#include <vector>
 
 TEST(SMOOTHING_PLUGINS, FilterConverge)
 {
@@ -71,3 +73,43 @@ TEST(SMOOTHING_PLUGINS, FilterReset)
   // Then check that a different measurement changes the value
   EXPECT_NE(5.0, lpf.filter(100.0));
 }
+
+TEST(SMOOTHING_PLUGINS, MultiFilterMatchesScalarFilter)
+{
+  constexpr std::size_t NUM_SIGNALS = 14;
+  const online_signal_smoothing::ButterworthFilter prototype(2.0);
+  std::vector<online_signal_smoothing::ButterworthFilter> scalar_filters(NUM_SIGNALS, prototype);
+  online_signal_smoothing::MultiButterworthFilter<> dynamic_filter(2.0, NUM_SIGNALS);
+  online_signal_smoothing::MultiButterworthFilter<NUM_SIGNALS> fixed_filter(2.0);
+  EXPECT_EQ(dynamic_filter.size(), static_cast<Eigen::Index>(NUM_SIGNALS));
+
+  std::vector<double> start(NUM_SIGNALS);
+  for (std::size_t i = 0; i < NUM_SIGNALS; ++i)
+  {
+    start[i] = 0.1 * i;
+    scalar_filters[i].reset(start[i]);
+  }
+  dynamic_filter.reset(start.data());
+  fixed_filter.reset(start.data());
+
+  for (std::size_t step = 0; step < 50; ++step)
+  {
+    std::vector<double> dynamic_values(NUM_SIGNALS);
+    for (std::size_t i = 0; i < NUM_SIGNALS; ++i)
+      dynamic_values[i] = std::sin(0.3 * step + i);
+    std::vector<double> fixed_values = dynamic_values;
+    dynamic_filter.filter(dynamic_values.data());
+    fixed_filter.filter(fixed_values.data());
+    for (std::size_t i = 0; i < NUM_SIGNALS; ++i)
+    {
+      const double expected = scalar_filters[i].filter(std::sin(0.3 * step + i));
+      EXPECT_DOUBLE_EQ(expected, dynamic_values[i]);
+      EXPECT_DOUBLE_EQ(expected, fixed_values[i]);
+    }
+  }
+}
+
+TEST(SMOOTHING_PLUGINS, MultiFilterRejectsUnstableCoefficient)
+{
+  EXPECT_THROW(online_signal_smoothing::MultiButterworthFilter<>(0.5, 3), std::length_error);
+}
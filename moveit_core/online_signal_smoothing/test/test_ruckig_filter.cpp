@@ -0,0 +1,148 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc: Unit test for online_signal_smoothing::RuckigFilterPlugin
+ */
+
+#include <gtest/gtest.h>
+#include <moveit/online_signal_smoothing/ruckig_filter.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr size_t NUM_JOINTS = 7;
+constexpr double UPDATE_PERIOD = 0.01;
+}  // namespace
+
+class RuckigFilterTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::NodeOptions options;
+    options.parameter_overrides({ { "ruckig_filter.planning_group_name", "panda_arm" },
+                                  { "ruckig_filter.update_period", UPDATE_PERIOD } });
+    node_ = std::make_shared<rclcpp::Node>("test_ruckig_filter", options);
+    robot_model_ = moveit::core::loadTestingRobotModel("panda");
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  moveit::core::RobotModelPtr robot_model_;
+};
+
+TEST_F(RuckigFilterTest, RejectsWrongJointCount)
+{
+  online_signal_smoothing::RuckigFilterPlugin filter;
+  EXPECT_FALSE(filter.initialize(node_, robot_model_, NUM_JOINTS + 1));
+}
+
+TEST_F(RuckigFilterTest, StepIsJerkLimited)
+{
+  online_signal_smoothing::RuckigFilterPlugin filter;
+  ASSERT_TRUE(filter.initialize(node_, robot_model_, NUM_JOINTS));
+
+  const std::vector<double> start(NUM_JOINTS, 0.0);
+  ASSERT_TRUE(filter.reset(start, start, start));
+
+  // A step command is approached within the velocity limits, without jumping to the target
+  std::vector<double> previous = start;
+  std::vector<double> positions, velocities, accelerations;
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    positions.assign(NUM_JOINTS, 0.5);
+    velocities.assign(NUM_JOINTS, 0.0);
+    accelerations.assign(NUM_JOINTS, 0.0);
+    ASSERT_TRUE(filter.doSmoothing(positions, velocities, accelerations));
+    for (size_t joint = 0; joint < NUM_JOINTS; ++joint)
+    {
+      const auto& bounds = robot_model_->getJointModelGroup("panda_arm")->getActiveJointModelsBounds()[joint]->at(0);
+      EXPECT_LE(std::abs(velocities[joint]), bounds.max_velocity_ + 1e-6);
+      EXPECT_LE(std::abs(positions[joint] - previous[joint]), bounds.max_velocity_ * UPDATE_PERIOD + 1e-6);
+    }
+    if (i == 0)
+      EXPECT_LT(positions[0], 0.1);
+    previous = positions;
+  }
+
+  // The target is eventually reached at a standstill
+  for (size_t joint = 0; joint < NUM_JOINTS; ++joint)
+  {
+    EXPECT_NEAR(positions[joint], 0.5, 1e-6);
+    EXPECT_NEAR(velocities[joint], 0.0, 1e-6);
+  }
+}
+
+TEST_F(RuckigFilterTest, PositionResetKeepsVelocity)
+{
+  online_signal_smoothing::RuckigFilterPlugin filter;
+  ASSERT_TRUE(filter.initialize(node_, robot_model_, NUM_JOINTS));
+
+  const std::vector<double> start(NUM_JOINTS, 0.0);
+  ASSERT_TRUE(filter.reset(start, start, start));
+  std::vector<double> positions, velocities, accelerations;
+  for (size_t i = 0; i < 10; ++i)
+  {
+    positions.assign(NUM_JOINTS, 1.0);
+    velocities.assign(NUM_JOINTS, 0.0);
+    accelerations.assign(NUM_JOINTS, 0.0);
+    ASSERT_TRUE(filter.doSmoothing(positions, velocities, accelerations));
+  }
+  ASSERT_GT(velocities[0], 0.0);
+
+  // Resetting the positions only, as servo does every cycle, continues the motion instead of restarting it
+  ASSERT_TRUE(filter.reset(positions));
+  std::vector<double> command(NUM_JOINTS, 1.0);
+  ASSERT_TRUE(filter.doSmoothing(command));
+  EXPECT_GT(command[0] - positions[0], 0.5 * velocities[0] * UPDATE_PERIOD);
+}
+
+TEST_F(RuckigFilterTest, RejectsWrongLength)
+{
+  online_signal_smoothing::RuckigFilterPlugin filter;
+  ASSERT_TRUE(filter.initialize(node_, robot_model_, NUM_JOINTS));
+  std::vector<double> positions(NUM_JOINTS - 1, 0.0);
+  EXPECT_FALSE(filter.reset(positions));
+  EXPECT_FALSE(filter.doSmoothing(positions));
+}
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  const int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
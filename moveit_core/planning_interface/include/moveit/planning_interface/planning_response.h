@@ -41,6 +41,8 @@
 #include <moveit_msgs/msg/move_it_error_codes.hpp>
 #include <moveit_msgs/msg/motion_plan_response.hpp>
 #include <moveit_msgs/msg/motion_plan_detailed_response.hpp>
+#include <map>
+#include <string>
 
 namespace planning_interface
 {
@@ -70,6 +72,10 @@ struct MotionPlanResponse
   /// obstacles). This is helpful because the added states should not be considered invalid in all situations.
   std::vector<std::size_t> added_path_index;  // This won't be included into the MotionPlanResponse ROS 2 message!
 
+  /// Wall time in seconds spent in the phases of planning, e.g. request adapters, planning context setup and solving,
+  /// keyed by phase name. Filled by the planning pipeline and planners that report it, for profiling and benchmarks.
+  std::map<std::string, double> phase_times;  // This won't be included into the MotionPlanResponse ROS 2 message!
+
   // \brief Enable checking of query success or failure, for example if(response) ...
   explicit operator bool() const
   {
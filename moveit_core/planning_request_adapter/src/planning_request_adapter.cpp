@@ -36,9 +36,11 @@
 
 #include <moveit/planning_request_adapter/planning_request_adapter.h>
 #include <moveit/utils/moveit_error_code.h>
+#include <moveit/utils/tracing.h>
 #include <rclcpp/logger.hpp>
 #include <functional>
 #include <algorithm>
+#include <chrono>
 
 namespace planning_request_adapter
 {
@@ -51,10 +53,20 @@ bool callPlannerInterfaceSolve(const planning_interface::PlannerManager& planner
                                const planning_interface::MotionPlanRequest& req,
                                planning_interface::MotionPlanResponse& res)
 {
-  planning_interface::PlanningContextPtr context = planner.getPlanningContext(planning_scene, req, res.error_code);
+  const auto start = std::chrono::steady_clock::now();
+  planning_interface::PlanningContextPtr context;
+  {
+    moveit::tracing::ScopedTrace trace("planning_context_setup", planner.getDescription());
+    context = planner.getPlanningContext(planning_scene, req, res.error_code);
+  }
+  const auto context_ready = std::chrono::steady_clock::now();
+  res.phase_times["planning_context"] += std::chrono::duration<double>(context_ready - start).count();
   if (context)
   {
-    return context->solve(res);
+    moveit::tracing::ScopedTrace trace("planning_context_solve", req.planner_id);
+    const bool solved = context->solve(res);
+    res.phase_times["solve"] += std::chrono::duration<double>(std::chrono::steady_clock::now() - context_ready).count();
+    return solved;
   }
   else
   {
@@ -66,16 +78,32 @@ bool callAdapter(const PlanningRequestAdapter& adapter, const PlanningRequestAda
                  const planning_scene::PlanningSceneConstPtr& planning_scene,
                  const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res)
 {
+  const std::string description = adapter.getDescription();
   try
   {
-    bool result = adapter.adaptAndPlan(planner, planning_scene, req, res);
-    RCLCPP_DEBUG_STREAM(LOGGER, adapter.getDescription() << ": " << moveit::core::error_code_to_string(res.error_code));
+    moveit::tracing::ScopedTrace trace("planning_request_adapter", description);
+    // the adapter's own time excludes the time spent in the adapters and planner it calls
+    double inner_time = 0.0;
+    const PlanningRequestAdapter::PlannerFn timed_planner =
+        [&planner, &inner_time](const planning_scene::PlanningSceneConstPtr& scene,
+                                const planning_interface::MotionPlanRequest& req,
+                                planning_interface::MotionPlanResponse& res) {
+          const auto start = std::chrono::steady_clock::now();
+          const bool result = planner(scene, req, res);
+          inner_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+          return result;
+        };
+    const auto start = std::chrono::steady_clock::now();
+    bool result = adapter.adaptAndPlan(timed_planner, planning_scene, req, res);
+    res.phase_times["adapter " + description] +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - inner_time;
+    RCLCPP_DEBUG_STREAM(LOGGER, description << ": " << moveit::core::error_code_to_string(res.error_code));
     return result;
   }
   catch (std::exception& ex)
   {
     RCLCPP_ERROR(LOGGER, "Exception caught executing adapter '%s': %s\nSkipping adapter instead.",
-                 adapter.getDescription().c_str(), ex.what());
+                 description.c_str(), ex.what());
     return planner(planning_scene, req, res);
   }
 }
@@ -51,8 +51,13 @@
 #include <moveit_msgs/msg/constraints.hpp>
 #include <moveit_msgs/msg/planning_scene_components.hpp>
 #include <octomap_msgs/msg/octomap_with_pose.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <functional>
+#include <unordered_map>
 #include <thread>
 #include <variant>
 #include <rclcpp/rclcpp.hpp>
@@ -83,6 +88,25 @@ using ObjectColorMap = std::map<std::string, std_msgs::msg::ColorRGBA>;
 /** \brief A map from object names (e.g., attached bodies, collision objects) to their types */
 using ObjectTypeMap = std::map<std::string, object_recognition_msgs::msg::ObjectType>;
 
+/** \brief The checks isStateValid() runs on a state, see PlanningScene::setStateValidityOrder() */
+enum class StateValidityCheck
+{
+  CONSTRAINTS,     // the kinematic constraints, see kinematic_constraints::KinematicConstraintSet::isSatisfied()
+  FEASIBILITY,     // the state feasibility predicate
+  SELF_COLLISION,  // collisions between the links of the unpadded robot
+  WORLD_COLLISION  // collisions of the padded robot with the world
+};
+
+/** \brief How often a check of isStateValid() ran and rejected a state, and how long it took in total */
+struct StateValidityCheckStatistics
+{
+  StateValidityCheck check;
+  std::uint64_t calls = 0;
+  std::uint64_t rejections = 0;
+  /** \brief Time spent in the check, in seconds */
+  double time = 0.0;
+};
+
 /** \brief This class maintains the representation of the
     environment as seen by a planning instance. The environment
     geometry, the robot geometry and state are maintained. */
@@ -227,6 +251,17 @@ public:
      successful or not. */
   const Eigen::Isometry3d& getFrameTransform(const moveit::core::RobotState& state, const std::string& id) const;
 
+  /** \brief Get the transform corresponding to the frame \e id, given by its interned name.
+      Robot links and collision objects are found without hashing or comparing strings, other frames are looked up as
+      by the string version. Return identity when no transform is available. */
+  const Eigen::Isometry3d& getFrameTransform(const moveit::core::InternedName& id) const;
+
+  /** \brief Get the transform corresponding to the frame \e id, given by its interned name, for \e state.
+      Robot links and collision objects are found without hashing or comparing strings, other frames are looked up as
+      by the string version. Return identity when no transform is available. */
+  const Eigen::Isometry3d& getFrameTransform(const moveit::core::RobotState& state,
+                                             const moveit::core::InternedName& id) const;
+
   /** \brief Check if a transform to the frame \e id is known. This will be known if \e id is a link name, an attached
    * body id or a collision object */
   bool knowsFrameTransform(const std::string& id) const;
@@ -684,6 +719,22 @@ public:
   /** \brief Construct a message (\e octomap) with the octomap data from the planning_scene */
   bool getOctomapMsg(octomap_msgs::msg::OctomapWithPose& octomap) const;
 
+  /** \brief Get the version of the collision objects in the world, i.e. of their geometry, poses and types.
+   *
+   * Versions are unique within the process and change whenever the objects may have changed, so messages built by
+   * getCollisionObjectMsgs() can be cached by their version. Changes made to the parent of a diff scene are not
+   * reflected. */
+  std::size_t getCollisionObjectsVersion() const
+  {
+    return collision_objects_version_;
+  }
+
+  /** \brief Get the version of the octomap, see getCollisionObjectsVersion() */
+  std::size_t getOctomapVersion() const
+  {
+    return octomap_version_;
+  }
+
   /** \brief Construct a vector of messages (\e object_colors) with the colors of the objects from the planning_scene */
   void getObjectColorMsgs(std::vector<moveit_msgs::msg::ObjectColor>& object_colors) const;
 
@@ -842,10 +893,40 @@ public:
                     const std::string& group = "", bool verbose = false) const;
 
   /** \brief Check if a given state is valid. This means checking for collisions, feasibility  and whether the user
-   * specified validity conditions hold as well. Includes descendent links of \e group. */
+   * specified validity conditions hold as well. Includes descendent links of \e group. The checks run in the order
+   * set by setStateValidityOrder(). */
   bool isStateValid(const moveit::core::RobotState& state, const kinematic_constraints::KinematicConstraintSet& constr,
                     const std::string& group = "", bool verbose = false) const;
 
+  /** \brief Set the order in which isStateValid() runs its checks. It stops at the first check that rejects the
+   * state, so a cheap check that rejects often should run first. \e order has to contain every check exactly once,
+   * otherwise it is ignored and false is returned. The default order is world collision, self collision, feasibility,
+   * constraints. */
+  bool setStateValidityOrder(const std::vector<StateValidityCheck>& order);
+
+  /** \brief Get the order in which isStateValid() currently runs its checks */
+  std::vector<StateValidityCheck> getStateValidityOrder() const;
+
+  /** \brief If \e adaptive (the default), isStateValid() periodically reorders its checks by the time each check took
+   * per rejected state so far. In path-constrained planning, for example, the constraints then run before the
+   * collision checks. The validity of a state does not depend on the order. */
+  void setAdaptiveStateValidityOrder(bool adaptive)
+  {
+    adaptive_validity_order_ = adaptive;
+  }
+
+  bool isAdaptiveStateValidityOrder() const
+  {
+    return adaptive_validity_order_;
+  }
+
+  /** \brief Get the statistics of the checks isStateValid() ran on this scene, in the order the checks currently run.
+   * Checks that do not apply (no feasibility predicate, no constraints) are not counted. */
+  std::vector<StateValidityCheckStatistics> getStateValidityStatistics() const;
+
+  /** \brief Reset the statistics of the checks of isStateValid(), which also restarts the adaptive ordering */
+  void resetStateValidityStatistics();
+
   /** \brief Check if a given path is valid. Each state is checked for validity (collision avoidance and feasibility).
    * Includes descendent links of \e group. */
   bool isPathValid(const moveit_msgs::msg::RobotState& start_state, const moveit_msgs::msg::RobotTrajectory& trajectory,
@@ -902,6 +983,32 @@ public:
   bool isPathValid(const robot_trajectory::RobotTrajectory& trajectory, const std::string& group = "",
                    bool verbose = false, std::vector<std::size_t>* invalid_index = nullptr) const;
 
+  /** \brief Check if a given path is valid, like isPathValid(), but check the waypoints concurrently on \e num_threads
+   * threads (0 uses one thread per hardware thread). Waypoints are visited coarse-to-fine, see findInvalidWayPoints(),
+   * and all threads stop at the first invalid state found. Because of this early exit, \e invalid_index only holds the
+   * invalid waypoints found until then, in ascending order, and the goal constraints are only checked for valid
+   * paths. State feasibility and path constraint checks have to be safe to call concurrently. */
+  bool isPathValidParallel(const robot_trajectory::RobotTrajectory& trajectory,
+                           const moveit_msgs::msg::Constraints& path_constraints,
+                           const std::vector<moveit_msgs::msg::Constraints>& goal_constraints,
+                           const std::string& group = "", bool verbose = false,
+                           std::vector<std::size_t>* invalid_index = nullptr, unsigned int num_threads = 0) const;
+
+  /** \brief Same as above, without goal constraints */
+  bool isPathValidParallel(const robot_trajectory::RobotTrajectory& trajectory, const std::string& group = "",
+                           bool verbose = false, std::vector<std::size_t>* invalid_index = nullptr,
+                           unsigned int num_threads = 0) const;
+
+  /** \brief Check the waypoints of \e trajectory from \e start_index on with \e is_valid, concurrently on
+   * \e num_threads threads (0 uses one thread per hardware thread). The waypoints are visited coarse-to-fine: first
+   * the end points, then the midpoints of ever smaller intervals, so that an invalid part of the path is typically
+   * found after few checks. All threads stop as soon as an invalid waypoint is found.
+   * \return The indices of the invalid waypoints found, in ascending order. Empty if all waypoints are valid. */
+  static std::vector<std::size_t>
+  findInvalidWayPoints(const robot_trajectory::RobotTrajectory& trajectory,
+                       const std::function<bool(const moveit::core::RobotState&)>& is_valid,
+                       std::size_t start_index = 0, unsigned int num_threads = 0);
+
   /** \brief Get the top \e max_costs cost sources for a specified trajectory. The resulting costs are stored in \e
    * costs */
   void getCostSources(const robot_trajectory::RobotTrajectory& trajectory, std::size_t max_costs,
@@ -925,9 +1032,22 @@ public:
   /** \brief Outputs debug information about the planning scene contents */
   void printKnownObjects(std::ostream& out = std::cout) const;
 
+  /** \brief Add the approximate memory held by this scene to \e usage, split into categories such as "world",
+      "shapes", "octomap", "collision_env", "distance_field", "robot_state" and "acm".
+
+      The world, the collision environments, the current state and the allowed collision matrix are counted, and for
+      a diff scene the parent scenes as well. Geometry, states and objects shared between them, or with other scenes
+      and trajectories already added to \e usage, are counted once. The robot model is not counted. */
+  void getMemoryUsage(moveit::core::MemoryUsage& usage) const;
+
   /** \brief Clone a planning scene. Even if the scene \e scene depends on a parent, the cloned scene will not. */
   static PlanningScenePtr clone(const PlanningSceneConstPtr& scene);
 
+  /** \brief The number of checkCollision() and checkCollisionUnpadded() calls, and of the world and self collision
+      checks of isStateValid(), made on any planning scene in this process, for monitoring the collision checking
+      rate */
+  static std::uint64_t getCollisionCheckCount();
+
   /** \brief Allocate a new collision detector and replace the previous one if there was any.
    *
    * The collision detector type is specified with (a shared pointer to) an
@@ -954,6 +1074,20 @@ private:
    * Requires a valid robot_model_ */
   void initialize();
 
+  /* Assign fresh component versions and keep them up to date with changes of world_ */
+  void trackComponentVersions();
+
+  /* Where a frame name was found among the robot links and the collision objects of the world */
+  struct ResolvedFrame
+  {
+    const moveit::core::LinkModel* link;        // the link, if the frame is a robot link other than the model frame
+    const Eigen::Isometry3d* world_transform;  // the pose, if the frame is a collision object or one of its subframes
+    std::size_t world_version;                 // the version of the world the frame was resolved in
+  };
+
+  /* Resolve \e frame_id, reusing the result of an earlier call until the world changes */
+  ResolvedFrame resolveFrame(const std::string& frame_id) const;
+
   /* Helper functions for processing collision objects */
   bool processCollisionObjectAdd(const moveit_msgs::msg::CollisionObject& object);
   bool processCollisionObjectRemove(const moveit_msgs::msg::CollisionObject& object);
@@ -1008,6 +1142,15 @@ private:
   collision_detection::World::ObserverCallbackFn current_world_object_update_callback_;
   collision_detection::World::ObserverHandle current_world_object_update_observer_handle_;
 
+  // versions of the serializable world components, see getCollisionObjectsVersion()
+  std::size_t collision_objects_version_;
+  std::size_t octomap_version_;
+  collision_detection::World::ObserverHandle component_version_observer_handle_;
+
+  // frames resolved by resolveFrame(), entries of other world versions are stale
+  mutable std::unordered_map<std::string, ResolvedFrame> frame_cache_;
+  mutable std::mutex frame_cache_lock_;
+
   CollisionDetectorPtr collision_detector_;  // Never nullptr.
 
   collision_detection::AllowedCollisionMatrixPtr acm_;  // if nullptr use parent's
@@ -1015,6 +1158,28 @@ private:
   StateFeasibilityFn state_feasibility_;
   MotionFeasibilityFn motion_feasibility_;
 
+  /** \brief Run one check of isStateValid(). Returns true if the state passes it. */
+  bool passesStateValidityCheck(StateValidityCheck check, const moveit::core::RobotState& state,
+                                const kinematic_constraints::KinematicConstraintSet& constr, const std::string& group,
+                                bool verbose) const;
+
+  /** \brief Reorder the checks of isStateValid() by their measured time per rejected state */
+  void updateStateValidityOrder() const;
+
+  struct StateValidityCounters
+  {
+    std::atomic<std::uint64_t> calls{ 0 };
+    std::atomic<std::uint64_t> rejections{ 0 };
+    std::atomic<std::uint64_t> time_ns{ 0 };
+  };
+
+  // indexed by StateValidityCheck; counted per scene, diff scenes start anew
+  mutable std::array<StateValidityCounters, 4> validity_counters_;
+  // byte i holds the check isStateValid() runs i-th
+  mutable std::atomic<std::uint32_t> validity_order_{ 0 };
+  mutable std::atomic<std::uint64_t> validity_calls_{ 0 };
+  bool adaptive_validity_order_{ true };
+
   std::unique_ptr<ObjectColorMap> object_colors_;
 
   // a map of object types
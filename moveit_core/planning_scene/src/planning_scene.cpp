@@ -45,11 +45,18 @@
 #include <moveit/exceptions/exceptions.h>
 #include <moveit/robot_state/attached_body.h>
 #include <moveit/utils/message_checks.h>
+#include <moveit/utils/metrics.h>
+#include <moveit/utils/tracing.h>
 #include <octomap_msgs/conversions.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 #include <tf2_eigen/tf2_eigen.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <set>
 
 namespace planning_scene
@@ -59,6 +66,69 @@ static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_planning_scene.p
 const std::string PlanningScene::OCTOMAP_NS = "<octomap>";
 const std::string PlanningScene::DEFAULT_SCENE_NAME = "(noname)";
 
+namespace
+{
+moveit::metrics::Counter collision_checks;
+
+constexpr std::size_t STATE_VALIDITY_CHECK_COUNT = 4;
+
+// with an adaptive order, isStateValid() reorders its checks after this many calls
+constexpr std::uint64_t VALIDITY_ORDER_UPDATE_INTERVAL = 256;
+
+// Packs an order of the checks of isStateValid() into one word, the check that runs i-th in byte i
+constexpr std::uint32_t packValidityOrder(const std::array<StateValidityCheck, STATE_VALIDITY_CHECK_COUNT>& order)
+{
+  std::uint32_t packed = 0;
+  for (std::size_t i = 0; i < STATE_VALIDITY_CHECK_COUNT; ++i)
+    packed |= static_cast<std::uint32_t>(order[i]) << (8 * i);
+  return packed;
+}
+
+StateValidityCheck unpackValidityCheck(const std::uint32_t packed, const std::size_t index)
+{
+  return static_cast<StateValidityCheck>((packed >> (8 * index)) & 0xff);
+}
+
+// the order of the checks isStateValid() always used before it could be configured
+constexpr std::uint32_t DEFAULT_VALIDITY_ORDER =
+    packValidityOrder({ StateValidityCheck::WORLD_COLLISION, StateValidityCheck::SELF_COLLISION,
+                        StateValidityCheck::FEASIBILITY, StateValidityCheck::CONSTRAINTS });
+
+// Component versions are drawn from one process-wide counter, so a version is never reused, not even by another scene
+std::size_t nextComponentVersion()
+{
+  static std::atomic<std::size_t> counter{ 0 };
+  return ++counter;
+}
+
+// Orders the indices [begin, end) coarse-to-fine: both end points first, then the midpoints of ever smaller intervals
+std::vector<std::size_t> coarseToFineOrder(const std::size_t begin, const std::size_t end)
+{
+  std::vector<std::size_t> order;
+  if (begin >= end)
+    return order;
+  order.reserve(end - begin);
+  order.push_back(begin);
+  if (end - begin > 1)
+    order.push_back(end - 1);
+
+  // Intervals whose end points were visited already. Splitting them breadth-first refines the whole path evenly.
+  std::deque<std::pair<std::size_t, std::size_t>> intervals{ { begin, end - 1 } };
+  while (!intervals.empty())
+  {
+    const auto [low, high] = intervals.front();
+    intervals.pop_front();
+    if (high - low < 2)
+      continue;
+    const std::size_t mid = low + (high - low) / 2;
+    order.push_back(mid);
+    intervals.emplace_back(low, mid);
+    intervals.emplace_back(mid, high);
+  }
+  return order;
+}
+}  // namespace
+
 namespace utilities
 {
 /**
@@ -134,6 +204,11 @@ public:
     return scene_->getFrameTransform(from_frame);
   }
 
+  const Eigen::Isometry3d& getTransform(const moveit::core::InternedName& from_frame) const override
+  {
+    return scene_->getFrameTransform(from_frame);
+  }
+
 private:
   // Returns true if frame_id is the name of an object or the name of a subframe on an object
   bool knowsObjectFrame(const std::string& frame_id) const
@@ -176,6 +251,7 @@ PlanningScene::~PlanningScene()
 {
   if (current_world_object_update_callback_)
     world_->removeObserver(current_world_object_update_observer_handle_);
+  world_->removeObserver(component_version_observer_handle_);
 }
 
 void PlanningScene::initialize()
@@ -190,6 +266,10 @@ void PlanningScene::initialize()
 
   acm_ = std::make_shared<collision_detection::AllowedCollisionMatrix>(*getRobotModel()->getSRDF());
 
+  validity_order_ = DEFAULT_VALIDITY_ORDER;
+
+  trackComponentVersions();
+
   allocateCollisionDetector(collision_detection::CollisionDetectorAllocatorFCL::create());
 }
 
@@ -203,6 +283,9 @@ PlanningScene::PlanningScene(const PlanningSceneConstPtr& parent) : parent_(pare
 
   robot_model_ = parent_->robot_model_;
 
+  validity_order_ = parent_->validity_order_.load(std::memory_order_relaxed);
+  adaptive_validity_order_ = parent_->adaptive_validity_order_;
+
   // maintain a separate world.  Copy on write ensures that most of the object
   // info is shared until it is modified.
   world_ = std::make_shared<collision_detection::World>(*parent_->world_);
@@ -210,11 +293,25 @@ PlanningScene::PlanningScene(const PlanningSceneConstPtr& parent) : parent_(pare
 
   // record changes to the world
   world_diff_ = std::make_shared<collision_detection::WorldDiff>(world_);
+  trackComponentVersions();
 
   allocateCollisionDetector(parent_->collision_detector_->alloc_, parent_->collision_detector_);
   collision_detector_->copyPadding(*parent_->collision_detector_);
 }
 
+void PlanningScene::trackComponentVersions()
+{
+  collision_objects_version_ = nextComponentVersion();
+  octomap_version_ = nextComponentVersion();
+  component_version_observer_handle_ = world_->addObserver(
+      [this](const collision_detection::World::ObjectConstPtr& object, collision_detection::World::Action /*action*/) {
+        if (object->id_ == OCTOMAP_NS)
+          octomap_version_ = nextComponentVersion();
+        else
+          collision_objects_version_ = nextComponentVersion();
+      });
+}
+
 PlanningScenePtr PlanningScene::clone(const PlanningSceneConstPtr& scene)
 {
   PlanningScenePtr result = scene->diff();
@@ -223,6 +320,11 @@ PlanningScenePtr PlanningScene::clone(const PlanningSceneConstPtr& scene)
   return result;
 }
 
+std::uint64_t PlanningScene::getCollisionCheckCount()
+{
+  return collision_checks.value();
+}
+
 PlanningScenePtr PlanningScene::diff() const
 {
   return PlanningScenePtr(new PlanningScene(shared_from_this()));
@@ -308,9 +410,11 @@ void PlanningScene::clearDiffs()
     return;
 
   // clear everything, reset the world, record diffs
+  world_->removeObserver(component_version_observer_handle_);
   world_ = std::make_shared<collision_detection::World>(*parent_->world_);
   world_const_ = world_;
   world_diff_ = std::make_shared<collision_detection::WorldDiff>(world_);
+  trackComponentVersions();
   if (current_world_object_update_callback_)
     current_world_object_update_observer_handle_ = world_->addObserver(current_world_object_update_callback_);
 
@@ -418,11 +522,13 @@ void PlanningScene::checkCollision(const collision_detection::CollisionRequest&
                                    const moveit::core::RobotState& robot_state,
                                    const collision_detection::AllowedCollisionMatrix& acm) const
 {
+  moveit::tracing::ScopedTrace trace("collision_check");
+  collision_checks.increment();
   // check collision with the world using the padded version
   getCollisionEnv()->checkRobotCollision(req, res, robot_state, acm);
 
   // do self-collision checking with the unpadded version of the robot
-  if (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts))
+  if (!res.budget_exceeded && (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts)))
     getCollisionEnvUnpadded()->checkSelfCollision(req, res, robot_state, acm);
 }
 
@@ -444,11 +550,13 @@ void PlanningScene::checkCollisionUnpadded(const collision_detection::CollisionR
                                            const moveit::core::RobotState& robot_state,
                                            const collision_detection::AllowedCollisionMatrix& acm) const
 {
+  moveit::tracing::ScopedTrace trace("collision_check", "unpadded");
+  collision_checks.increment();
   // check collision with the world using the unpadded version
   getCollisionEnvUnpadded()->checkRobotCollision(req, res, robot_state, acm);
 
   // do self-collision checking with the unpadded version of the robot
-  if (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts))
+  if (!res.budget_exceeded && (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts)))
   {
     getCollisionEnvUnpadded()->checkSelfCollision(req, res, robot_state, acm);
   }
@@ -1191,6 +1299,7 @@ void PlanningScene::decoupleParent()
         (*object_types_)[it->first] = it->second;
     }
   }
+  collision_objects_version_ = nextComponentVersion();
 
   parent_.reset();
 }
@@ -1237,9 +1346,11 @@ bool PlanningScene::setPlanningSceneDiffMsg(const moveit_msgs::msg::PlanningScen
   for (const moveit_msgs::msg::ObjectColor& object_color : scene_msg.object_colors)
     setObjectColor(object_color.id, object_color.color);
 
-  // process collision object updates
+  // process collision object updates, the observers of the world are notified once per changed object
+  world_->beginBatch();
   for (const moveit_msgs::msg::CollisionObject& collision_object : scene_msg.world.collision_objects)
     result &= processCollisionObjectMsg(collision_object);
+  world_->commitBatch();
 
   // if an octomap was specified, replace the one we have with that one
   if (!scene_msg.world.octomap.octomap.data.empty())
@@ -1263,6 +1374,7 @@ bool PlanningScene::setPlanningSceneMsg(const moveit_msgs::msg::PlanningScene& s
     decoupleParent();
 
   object_types_.reset();
+  collision_objects_version_ = nextComponentVersion();
   scene_transforms_->setTransforms(scene_msg.fixed_frame_transforms);
   setCurrentState(scene_msg.robot_state);
   acm_ = std::make_shared<collision_detection::AllowedCollisionMatrix>(scene_msg.allowed_collision_matrix);
@@ -1278,9 +1390,12 @@ bool PlanningScene::setPlanningSceneMsg(const moveit_msgs::msg::PlanningScene& s
 bool PlanningScene::processPlanningSceneWorldMsg(const moveit_msgs::msg::PlanningSceneWorld& world)
 {
   bool result = true;
+  // the observers of the world (e.g. the collision environments) are notified once per changed object
+  world_->beginBatch();
   for (const moveit_msgs::msg::CollisionObject& collision_object : world.collision_objects)
     result &= processCollisionObjectMsg(collision_object);
   processOctomapMsg(world.octomap);
+  world_->commitBatch();
   return result;
 }
 
@@ -1393,6 +1508,9 @@ void PlanningScene::processOctomapPtr(const std::shared_ptr<const octomap::OcTre
         // if the pose changed, we update it
         if (map->shape_poses_[0].isApprox(t, std::numeric_limits<double>::epsilon() * 100.0))
         {
+          // the octree was modified in place, which the world does not notice by itself
+          world_->notifyShapesUpdated(OCTOMAP_NS);
+          octomap_version_ = nextComponentVersion();
           if (world_diff_)
           {
             world_diff_->set(OCTOMAP_NS, collision_detection::World::DESTROY | collision_detection::World::CREATE |
@@ -1870,17 +1988,76 @@ const Eigen::Isometry3d& PlanningScene::getFrameTransform(const moveit::core::Ro
     return getFrameTransform(frame_id.substr(1));
   }
 
+  const ResolvedFrame frame = resolveFrame(frame_id);
+  if (frame.link)
+    return state.getGlobalLinkTransform(frame.link);
+
+  // the attached bodies of the state take precedence over the world
   bool frame_found;
   const Eigen::Isometry3d& t1 = state.getFrameTransform(frame_id, &frame_found);
   if (frame_found)
     return t1;
 
-  const Eigen::Isometry3d& t2 = getWorld()->getTransform(frame_id, frame_found);
-  if (frame_found)
-    return t2;
+  if (frame.world_transform)
+    return *frame.world_transform;
   return getTransforms().Transforms::getTransform(frame_id);
 }
 
+PlanningScene::ResolvedFrame PlanningScene::resolveFrame(const std::string& frame_id) const
+{
+  // bounds the cache if many different names are looked up
+  static constexpr std::size_t MAX_CACHED_FRAMES = 1024;
+
+  const std::size_t world_version = world_const_->getVersion();
+  std::scoped_lock lock(frame_cache_lock_);
+  const auto it = frame_cache_.find(frame_id);
+  if (it != frame_cache_.end() && (it->second.link || it->second.world_version == world_version))
+    return it->second;
+
+  ResolvedFrame frame{ nullptr, nullptr, world_version };
+  // the model frame maps to identity even if the root link is moved by a floating root joint
+  bool found = false;
+  if (frame_id != robot_model_->getModelFrame())
+    frame.link = robot_model_->getLinkModel(frame_id, &found);
+  if (!found)
+  {
+    frame.link = nullptr;
+    const Eigen::Isometry3d& t = world_const_->getTransform(frame_id, found);
+    if (found)
+      frame.world_transform = &t;
+  }
+
+  if (frame_cache_.size() >= MAX_CACHED_FRAMES)
+    frame_cache_.clear();
+  frame_cache_[frame_id] = frame;
+  return frame;
+}
+
+const Eigen::Isometry3d& PlanningScene::getFrameTransform(const moveit::core::InternedName& frame_id) const
+{
+  return getFrameTransform(getCurrentState(), frame_id);
+}
+
+const Eigen::Isometry3d& PlanningScene::getFrameTransform(const moveit::core::RobotState& state,
+                                                          const moveit::core::InternedName& frame_id) const
+{
+  // The model frame maps to identity even if the root link is moved by a floating root joint, so leave it to the
+  // string version
+  bool is_link;
+  const moveit::core::LinkModel* link = getRobotModel()->getLinkModel(frame_id, &is_link);
+  if (is_link && link != getRobotModel()->getRootLink())
+    return state.getGlobalLinkTransform(link);
+
+  // attached bodies take precedence over collision objects of the same name
+  if (!is_link)
+  {
+    const collision_detection::World::ObjectConstPtr obj = getWorld()->getObject(frame_id);
+    if (obj && !state.hasAttachedBody(frame_id.str()))
+      return obj->pose_;
+  }
+  return getFrameTransform(state, frame_id.str());
+}
+
 bool PlanningScene::knowsFrameTransform(const std::string& frame_id) const
 {
   return knowsFrameTransform(getCurrentState(), frame_id);
@@ -1891,9 +2068,10 @@ bool PlanningScene::knowsFrameTransform(const moveit::core::RobotState& state, c
   if (!frame_id.empty() && frame_id[0] == '/')
     return knowsFrameTransform(frame_id.substr(1));
 
-  if (state.knowsFrameTransform(frame_id))
+  const ResolvedFrame frame = resolveFrame(frame_id);
+  if (frame.link || frame.world_transform)
     return true;
-  if (getWorld()->knowsTransform(frame_id))
+  if (state.knowsFrameTransform(frame_id))
     return true;
   return getTransforms().Transforms::canTransform(frame_id);
 }
@@ -1929,12 +2107,13 @@ void PlanningScene::setObjectType(const std::string& object_id, const object_rec
   if (!object_types_)
     object_types_ = std::make_unique<ObjectTypeMap>();
   (*object_types_)[object_id] = type;
+  collision_objects_version_ = nextComponentVersion();
 }
 
 void PlanningScene::removeObjectType(const std::string& object_id)
 {
-  if (object_types_)
-    object_types_->erase(object_id);
+  if (object_types_ && object_types_->erase(object_id))
+    collision_objects_version_ = nextComponentVersion();
 }
 
 void PlanningScene::getKnownObjectTypes(ObjectTypeMap& kc) const
@@ -2088,7 +2267,7 @@ bool PlanningScene::isStateConstrained(const moveit_msgs::msg::RobotState& state
 bool PlanningScene::isStateConstrained(const moveit::core::RobotState& state,
                                        const kinematic_constraints::KinematicConstraintSet& constr, bool verbose) const
 {
-  return constr.decide(state, verbose).satisfied;
+  return constr.isSatisfied(state, verbose);
 }
 
 bool PlanningScene::isStateValid(const moveit::core::RobotState& state, const std::string& group, bool verbose) const
@@ -2114,22 +2293,155 @@ bool PlanningScene::isStateValid(const moveit_msgs::msg::RobotState& state, cons
 bool PlanningScene::isStateValid(const moveit::core::RobotState& state, const moveit_msgs::msg::Constraints& constr,
                                  const std::string& group, bool verbose) const
 {
-  if (isStateColliding(state, group, verbose))
-    return false;
-  if (!isStateFeasible(state, verbose))
-    return false;
-  return isStateConstrained(state, constr, verbose);
+  kinematic_constraints::KinematicConstraintSet ks(getRobotModel());
+  ks.add(constr, getTransforms());
+  return isStateValid(state, ks, group, verbose);
 }
 
 bool PlanningScene::isStateValid(const moveit::core::RobotState& state,
                                  const kinematic_constraints::KinematicConstraintSet& constr, const std::string& group,
                                  bool verbose) const
 {
-  if (isStateColliding(state, group, verbose))
-    return false;
-  if (!isStateFeasible(state, verbose))
+  if (adaptive_validity_order_)
+  {
+    const std::uint64_t calls = validity_calls_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (calls % VALIDITY_ORDER_UPDATE_INTERVAL == 0)
+      updateStateValidityOrder();
+  }
+
+  const std::uint32_t order = validity_order_.load(std::memory_order_relaxed);
+  for (std::size_t i = 0; i < STATE_VALIDITY_CHECK_COUNT; ++i)
+  {
+    const StateValidityCheck check = unpackValidityCheck(order, i);
+    if ((check == StateValidityCheck::FEASIBILITY && !state_feasibility_) ||
+        (check == StateValidityCheck::CONSTRAINTS && constr.empty()))
+      continue;
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool passed = passesStateValidityCheck(check, state, constr, group, verbose);
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    StateValidityCounters& counters = validity_counters_[static_cast<std::size_t>(check)];
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    counters.time_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+                               std::memory_order_relaxed);
+    if (!passed)
+    {
+      counters.rejections.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PlanningScene::passesStateValidityCheck(StateValidityCheck check, const moveit::core::RobotState& state,
+                                             const kinematic_constraints::KinematicConstraintSet& constr,
+                                             const std::string& group, bool verbose) const
+{
+  switch (check)
+  {
+    case StateValidityCheck::CONSTRAINTS:
+      return constr.isSatisfied(state, verbose);
+    case StateValidityCheck::FEASIBILITY:
+      return state_feasibility_(state, verbose);
+    case StateValidityCheck::SELF_COLLISION:
+    case StateValidityCheck::WORLD_COLLISION:
+    {
+      const bool self = check == StateValidityCheck::SELF_COLLISION;
+      moveit::tracing::ScopedTrace trace("collision_check", self ? "self" : "world");
+      collision_checks.increment();
+      collision_detection::CollisionRequest req;
+      req.verbose = verbose;
+      req.group_name = group;
+      collision_detection::CollisionResult res;
+      // like checkCollision(), the world is checked with the padded robot and self-collisions with the unpadded one
+      if (self)
+        getCollisionEnvUnpadded()->checkSelfCollision(req, res, state, getAllowedCollisionMatrix());
+      else
+        getCollisionEnv()->checkRobotCollision(req, res, state, getAllowedCollisionMatrix());
+      return !res.collision;
+    }
+  }
+  return true;
+}
+
+void PlanningScene::updateStateValidityOrder() const
+{
+  // Order the checks by the time they took per rejected state, the expected cost of a check divided by the chance
+  // that it ends the evaluation. Checks that did not run yet come first, so they are measured.
+  std::array<double, STATE_VALIDITY_CHECK_COUNT> cost;
+  std::array<StateValidityCheck, STATE_VALIDITY_CHECK_COUNT> order;
+  for (std::size_t i = 0; i < STATE_VALIDITY_CHECK_COUNT; ++i)
+  {
+    const StateValidityCounters& counters = validity_counters_[i];
+    const double calls = counters.calls.load(std::memory_order_relaxed);
+    const double rejections = counters.rejections.load(std::memory_order_relaxed);
+    const double time_ns = counters.time_ns.load(std::memory_order_relaxed);
+    // the rejection rate is smoothed so a check that never rejected keeps a finite cost
+    cost[i] = calls > 0.0 ? (time_ns / calls) * (calls + 2.0) / (rejections + 1.0) : 0.0;
+    order[i] = static_cast<StateValidityCheck>(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&cost](StateValidityCheck a, StateValidityCheck b) {
+    return cost[static_cast<std::size_t>(a)] < cost[static_cast<std::size_t>(b)];
+  });
+  validity_order_.store(packValidityOrder(order), std::memory_order_relaxed);
+}
+
+bool PlanningScene::setStateValidityOrder(const std::vector<StateValidityCheck>& order)
+{
+  std::array<bool, STATE_VALIDITY_CHECK_COUNT> seen{};
+  for (const StateValidityCheck check : order)
+  {
+    const auto index = static_cast<std::size_t>(check);
+    if (index >= STATE_VALIDITY_CHECK_COUNT || seen[index])
+      break;
+    seen[index] = true;
+  }
+  if (order.size() != STATE_VALIDITY_CHECK_COUNT || std::find(seen.begin(), seen.end(), false) != seen.end())
+  {
+    RCLCPP_ERROR(LOGGER, "The order of the state validity checks has to contain every check exactly once");
     return false;
-  return isStateConstrained(state, constr, verbose);
+  }
+
+  std::array<StateValidityCheck, STATE_VALIDITY_CHECK_COUNT> packed_order;
+  std::copy(order.begin(), order.end(), packed_order.begin());
+  validity_order_.store(packValidityOrder(packed_order), std::memory_order_relaxed);
+  return true;
+}
+
+std::vector<StateValidityCheck> PlanningScene::getStateValidityOrder() const
+{
+  const std::uint32_t order = validity_order_.load(std::memory_order_relaxed);
+  std::vector<StateValidityCheck> result;
+  for (std::size_t i = 0; i < STATE_VALIDITY_CHECK_COUNT; ++i)
+    result.push_back(unpackValidityCheck(order, i));
+  return result;
+}
+
+std::vector<StateValidityCheckStatistics> PlanningScene::getStateValidityStatistics() const
+{
+  std::vector<StateValidityCheckStatistics> result;
+  for (const StateValidityCheck check : getStateValidityOrder())
+  {
+    const StateValidityCounters& counters = validity_counters_[static_cast<std::size_t>(check)];
+    StateValidityCheckStatistics& statistics = result.emplace_back();
+    statistics.check = check;
+    statistics.calls = counters.calls.load(std::memory_order_relaxed);
+    statistics.rejections = counters.rejections.load(std::memory_order_relaxed);
+    statistics.time = counters.time_ns.load(std::memory_order_relaxed) * 1e-9;
+  }
+  return result;
+}
+
+void PlanningScene::resetStateValidityStatistics()
+{
+  for (StateValidityCounters& counters : validity_counters_)
+  {
+    counters.calls = 0;
+    counters.rejections = 0;
+    counters.time_ns = 0;
+  }
+  validity_calls_ = 0;
 }
 
 bool PlanningScene::isPathValid(const moveit_msgs::msg::RobotState& start_state,
@@ -2183,6 +2495,12 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
     invalid_index->clear();
   kinematic_constraints::KinematicConstraintSet ks_p(getRobotModel());
   ks_p.add(path_constraints, getTransforms());
+
+  // all waypoints are checked when the invalid ones are requested, so evaluate the path constraints in one batch
+  std::vector<kinematic_constraints::ConstraintEvaluationResult> path_results;
+  if (invalid_index && !verbose && !ks_p.empty())
+    ks_p.decideBatch(trajectory, path_results);
+
   std::size_t n_wp = trajectory.getWayPointCount();
   for (std::size_t i = 0; i < n_wp; ++i)
   {
@@ -2193,7 +2511,9 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
       this_state_valid = false;
     if (!isStateFeasible(st, verbose))
       this_state_valid = false;
-    if (!ks_p.empty() && !ks_p.decide(st, verbose).satisfied)
+    const bool path_constrained =
+        path_results.empty() ? ks_p.empty() || ks_p.isSatisfied(st, verbose) : path_results[i].satisfied;
+    if (!path_constrained)
       this_state_valid = false;
 
     if (!this_state_valid)
@@ -2259,6 +2579,101 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
   return isPathValid(trajectory, EMP_CONSTRAINTS, EMP_CONSTRAINTS_VECTOR, group, verbose, invalid_index);
 }
 
+bool PlanningScene::isPathValidParallel(const robot_trajectory::RobotTrajectory& trajectory,
+                                        const moveit_msgs::msg::Constraints& path_constraints,
+                                        const std::vector<moveit_msgs::msg::Constraints>& goal_constraints,
+                                        const std::string& group, bool verbose, std::vector<std::size_t>* invalid_index,
+                                        unsigned int num_threads) const
+{
+  if (invalid_index)
+    invalid_index->clear();
+  kinematic_constraints::KinematicConstraintSet ks_p(getRobotModel());
+  ks_p.add(path_constraints, getTransforms());
+
+  const std::vector<std::size_t> invalid = findInvalidWayPoints(
+      trajectory,
+      [&](const moveit::core::RobotState& st) {
+        return !isStateColliding(st, group, verbose) && isStateFeasible(st, verbose) &&
+               (ks_p.empty() || ks_p.isSatisfied(st, verbose));
+      },
+      0, num_threads);
+  if (!invalid.empty())
+  {
+    if (invalid_index)
+      *invalid_index = invalid;
+    return false;
+  }
+
+  // check goal for last state
+  const std::size_t n_wp = trajectory.getWayPointCount();
+  if (n_wp > 0 && !goal_constraints.empty())
+  {
+    const moveit::core::RobotState& st = trajectory.getLastWayPoint();
+    const bool found = std::any_of(goal_constraints.begin(), goal_constraints.end(),
+                                   [&](const moveit_msgs::msg::Constraints& goal_constraint) {
+                                     return isStateConstrained(st, goal_constraint);
+                                   });
+    if (!found)
+    {
+      if (verbose)
+        RCLCPP_INFO(LOGGER, "Goal not satisfied");
+      if (invalid_index)
+        invalid_index->push_back(n_wp - 1);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PlanningScene::isPathValidParallel(const robot_trajectory::RobotTrajectory& trajectory, const std::string& group,
+                                        bool verbose, std::vector<std::size_t>* invalid_index,
+                                        unsigned int num_threads) const
+{
+  static const moveit_msgs::msg::Constraints EMP_CONSTRAINTS;
+  static const std::vector<moveit_msgs::msg::Constraints> EMP_CONSTRAINTS_VECTOR;
+  return isPathValidParallel(trajectory, EMP_CONSTRAINTS, EMP_CONSTRAINTS_VECTOR, group, verbose, invalid_index,
+                             num_threads);
+}
+
+std::vector<std::size_t>
+PlanningScene::findInvalidWayPoints(const robot_trajectory::RobotTrajectory& trajectory,
+                                    const std::function<bool(const moveit::core::RobotState&)>& is_valid,
+                                    std::size_t start_index, unsigned int num_threads)
+{
+  const std::vector<std::size_t> order = coarseToFineOrder(start_index, trajectory.getWayPointCount());
+  std::vector<std::size_t> invalid;
+  if (order.empty())
+    return invalid;
+
+  std::mutex invalid_lock;
+  std::atomic<bool> invalid_found{ false };
+  std::atomic<std::size_t> next{ 0 };
+  const auto check_waypoints = [&] {
+    for (std::size_t k = next++; k < order.size() && !invalid_found; k = next++)
+    {
+      if (!is_valid(trajectory.getWayPoint(order[k])))
+      {
+        invalid_found = true;
+        std::scoped_lock slock(invalid_lock);
+        invalid.push_back(order[k]);
+      }
+    }
+  };
+
+  const std::size_t thread_count = std::min<std::size_t>(
+      num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency()), order.size());
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (std::size_t t = 1; t < thread_count; ++t)
+    threads.emplace_back(check_waypoints);
+  check_waypoints();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  std::sort(invalid.begin(), invalid.end());
+  return invalid;
+}
+
 void PlanningScene::getCostSources(const robot_trajectory::RobotTrajectory& trajectory, std::size_t max_costs,
                                    std::set<collision_detection::CostSource>& costs, double overlap_fraction) const
 {
@@ -2343,4 +2758,34 @@ void PlanningScene::printKnownObjects(std::ostream& out) const
   out << "-----------------------------------------\n";
 }
 
+void PlanningScene::getMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  if (!usage.visit(this))
+    return;
+  std::size_t bytes = sizeof(PlanningScene) + sizeof(CollisionDetector);
+  {
+    std::scoped_lock lock(frame_cache_lock_);
+    bytes += (sizeof(std::string) + sizeof(ResolvedFrame)) * frame_cache_.size();
+  }
+  if (world_diff_)
+    bytes += sizeof(collision_detection::WorldDiff) +
+             (sizeof(std::string) + sizeof(collision_detection::World::Action)) * world_diff_->size();
+  if (object_colors_)
+    bytes += (sizeof(std::string) + sizeof(std_msgs::msg::ColorRGBA)) * object_colors_->size();
+  if (object_types_)
+    bytes += (sizeof(std::string) + sizeof(object_recognition_msgs::msg::ObjectType)) * object_types_->size();
+  usage.add("planning_scene", bytes);
+
+  world_->getMemoryUsage(usage);
+  collision_detector_->cenv_->getMemoryUsage(usage);
+  if (collision_detector_->cenv_unpadded_)
+    collision_detector_->cenv_unpadded_->getMemoryUsage(usage);
+  if (robot_state_)
+    robot_state_->getMemoryUsage(usage);
+  if (acm_ && usage.visit(acm_.get()))
+    acm_->getMemoryUsage(usage);
+  if (parent_)
+    parent_->getMemoryUsage(usage);
+}
+
 }  // end of namespace planning_scene
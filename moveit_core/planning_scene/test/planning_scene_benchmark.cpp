@@ -0,0 +1,191 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+// To run this benchmark, 'cd' to the build/moveit_core/planning_scene directory and directly run the binary.
+
+#include <benchmark/benchmark.h>
+#include <geometric_shapes/shapes.h>
+#include <moveit/collision_detection_bullet/collision_detector_allocator_bullet.h>
+#include <moveit/collision_detection_fcl/collision_detector_allocator_fcl.h>
+#include <moveit/kinematic_constraints/kinematic_constraint.h>
+#include <moveit/kinematic_constraints/utils.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <random_numbers/random_numbers.h>
+#include <tf2_eigen/tf2_eigen.hpp>
+
+namespace
+{
+// Creates a scene for the test robot with a few boxes around the origin, so that world checks have work to do
+planning_scene::PlanningScenePtr makeScene(const std::string& robot_name, bool bullet)
+{
+  auto scene = std::make_shared<planning_scene::PlanningScene>(moveit::core::loadTestingRobotModel(robot_name));
+  if (bullet)
+    scene->allocateCollisionDetector(collision_detection::CollisionDetectorAllocatorBullet::create());
+  else
+    scene->allocateCollisionDetector(collision_detection::CollisionDetectorAllocatorFCL::create());
+
+  for (int i = 0; i < 4; ++i)
+  {
+    Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+    pose.translation() = Eigen::Vector3d(0.6 * std::cos(i * M_PI_2), 0.6 * std::sin(i * M_PI_2), 0.4);
+    scene->getWorldNonConst()->addToObject("box_" + std::to_string(i),
+                                           std::make_shared<const shapes::Box>(0.2, 0.2, 0.2), pose);
+  }
+  return scene;
+}
+}  // namespace
+
+static void BM_CollisionCheck(benchmark::State& st, const std::string& robot_name, bool bullet)
+{
+  planning_scene::PlanningScenePtr scene = makeScene(robot_name, bullet);
+  moveit::core::RobotState state = scene->getCurrentState();
+  random_numbers::RandomNumberGenerator rng(0);
+
+  collision_detection::CollisionRequest req;
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    state.setToRandomPositions(rng);
+    state.updateCollisionBodyTransforms();
+    st.ResumeTiming();
+    collision_detection::CollisionResult res;
+    scene->checkCollision(req, res, state);
+    benchmark::DoNotOptimize(res.collision);
+  }
+}
+
+static void BM_DistanceToCollision(benchmark::State& st, const std::string& robot_name, bool bullet)
+{
+  planning_scene::PlanningScenePtr scene = makeScene(robot_name, bullet);
+  moveit::core::RobotState state = scene->getCurrentState();
+  random_numbers::RandomNumberGenerator rng(0);
+
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    state.setToRandomPositions(rng);
+    state.updateCollisionBodyTransforms();
+    st.ResumeTiming();
+    benchmark::DoNotOptimize(scene->distanceToCollision(state));
+  }
+}
+
+static void BM_AllowedCollisionMatrixLookup(benchmark::State& st)
+{
+  planning_scene::PlanningScenePtr scene = makeScene("pr2", false);
+  const collision_detection::AllowedCollisionMatrix& acm = scene->getAllowedCollisionMatrix();
+  const std::vector<std::string>& links = scene->getRobotModel()->getLinkModelNamesWithCollisionGeometry();
+
+  collision_detection::AllowedCollision::Type type;
+  for (auto _ : st)
+  {
+    for (const std::string& first : links)
+    {
+      for (const std::string& second : links)
+        benchmark::DoNotOptimize(acm.getAllowedCollision(first, second, type));
+    }
+  }
+  st.SetItemsProcessed(st.iterations() * links.size() * links.size());
+}
+
+static void BM_PlanningSceneClone(benchmark::State& st)
+{
+  planning_scene::PlanningScenePtr scene = makeScene("pr2", false);
+  for (auto _ : st)
+    benchmark::DoNotOptimize(planning_scene::PlanningScene::clone(scene));
+}
+
+static void BM_PlanningSceneDiff(benchmark::State& st)
+{
+  planning_scene::PlanningScenePtr scene = makeScene("pr2", false);
+  const auto box = std::make_shared<const shapes::Box>(0.1, 0.1, 0.1);
+  for (auto _ : st)
+  {
+    planning_scene::PlanningScenePtr child = scene->diff();
+    child->getWorldNonConst()->addToObject("diff_box", box, Eigen::Isometry3d::Identity());
+    child->getCurrentStateNonConst().setToDefaultValues();
+
+    moveit_msgs::msg::PlanningScene msg;
+    child->getPlanningSceneDiffMsg(msg);
+    benchmark::DoNotOptimize(msg);
+  }
+}
+
+static void BM_ConstraintEvaluation(benchmark::State& st, bool early_exit)
+{
+  const moveit::core::RobotModelPtr& robot_model = moveit::core::loadTestingRobotModel("panda");
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup("panda_arm");
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  state.update();
+
+  // joint, position and orientation constraints around the default state
+  geometry_msgs::msg::PoseStamped pose;
+  pose.header.frame_id = robot_model->getModelFrame();
+  pose.pose = tf2::toMsg(state.getGlobalLinkTransform("panda_link8"));
+  moveit_msgs::msg::Constraints constraints = kinematic_constraints::mergeConstraints(
+      kinematic_constraints::constructGoalConstraints(state, jmg, 0.5),
+      kinematic_constraints::constructGoalConstraints("panda_link8", pose, 0.05, 0.1));
+
+  kinematic_constraints::KinematicConstraintSet constraint_set(robot_model);
+  constraint_set.add(constraints, moveit::core::Transforms(robot_model->getModelFrame()));
+
+  const moveit::core::RobotState default_state = state;
+  random_numbers::RandomNumberGenerator rng(0);
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    state.setToRandomPositionsNearBy(jmg, default_state, 0.1, rng);
+    state.update();
+    st.ResumeTiming();
+    if (early_exit)
+      benchmark::DoNotOptimize(constraint_set.isSatisfied(state));
+    else
+      benchmark::DoNotOptimize(constraint_set.decide(state).satisfied);
+  }
+}
+
+BENCHMARK_CAPTURE(BM_CollisionCheck, fcl_panda, std::string("panda"), false);
+BENCHMARK_CAPTURE(BM_CollisionCheck, bullet_panda, std::string("panda"), true);
+BENCHMARK_CAPTURE(BM_CollisionCheck, fcl_pr2, std::string("pr2"), false);
+BENCHMARK_CAPTURE(BM_CollisionCheck, bullet_pr2, std::string("pr2"), true);
+BENCHMARK_CAPTURE(BM_DistanceToCollision, fcl_panda, std::string("panda"), false);
+BENCHMARK_CAPTURE(BM_DistanceToCollision, bullet_panda, std::string("panda"), true);
+BENCHMARK(BM_AllowedCollisionMatrixLookup);
+BENCHMARK(BM_PlanningSceneClone);
+BENCHMARK(BM_PlanningSceneDiff);
+BENCHMARK_CAPTURE(BM_ConstraintEvaluation, decide, false);
+BENCHMARK_CAPTURE(BM_ConstraintEvaluation, is_satisfied, true);
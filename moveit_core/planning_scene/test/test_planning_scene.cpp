@@ -40,6 +40,8 @@
 #include <moveit/utils/message_checks.h>
 #include <moveit/utils/robot_model_test_utils.h>
 #include <urdf_parser/urdf_parser.h>
+#include <octomap/octomap.h>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -191,6 +193,65 @@ TEST(PlanningScene, isStateValid)
   }
 }
 
+TEST(PlanningScene, isPathValidParallel)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  auto ps = std::make_shared<planning_scene::PlanningScene>(robot_model->getURDF(), robot_model->getSRDF());
+  const moveit::core::JointModelGroup* group = robot_model->getJointModelGroup("panda_arm");
+  // States are infeasible once the first joint passes 0.5 rad
+  ps->setStateFeasibilityPredicate([](const moveit::core::RobotState& state, bool /*verbose*/) {
+    return state.getVariablePosition("panda_joint1") <= 0.5;
+  });
+
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues(group, "ready");
+  robot_trajectory::RobotTrajectory trajectory(robot_model, group);
+  const std::size_t num_waypoints = 101;
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+  {
+    state.setVariablePosition("panda_joint1", 0.4 + 0.2 * i / (num_waypoints - 1));
+    state.update();
+    trajectory.addSuffixWayPoint(state, 0.1);
+  }
+
+  std::vector<std::size_t> expected_invalid;
+  std::vector<std::size_t> invalid;
+  EXPECT_FALSE(ps->isPathValid(trajectory, "panda_arm", false, &expected_invalid));
+  ASSERT_FALSE(expected_invalid.empty());
+  for (const unsigned int num_threads : { 1u, 4u, 0u })
+  {
+    EXPECT_FALSE(ps->isPathValidParallel(trajectory, "panda_arm", false, &invalid, num_threads));
+    ASSERT_FALSE(invalid.empty());
+    EXPECT_TRUE(std::is_sorted(invalid.begin(), invalid.end()));
+    for (const std::size_t index : invalid)
+    {
+      EXPECT_TRUE(std::binary_search(expected_invalid.begin(), expected_invalid.end(), index)) << index;
+    }
+  }
+
+  // Waypoints are visited coarse-to-fine, and the check stops at the first invalid one
+  std::vector<double> visited;
+  const std::vector<std::size_t> found = planning_scene::PlanningScene::findInvalidWayPoints(
+      trajectory,
+      [&](const moveit::core::RobotState& waypoint) {
+        visited.push_back(waypoint.getVariablePosition("panda_joint1"));
+        return waypoint.getVariablePosition("panda_joint1") <= 0.5;
+      },
+      0, 1);
+  ASSERT_EQ(found, std::vector<std::size_t>{ num_waypoints - 1 });
+  ASSERT_EQ(visited.size(), 2u);
+  EXPECT_DOUBLE_EQ(visited.front(), 0.4);
+
+  // The valid part of the trajectory
+  robot_trajectory::RobotTrajectory valid_trajectory(robot_model, group);
+  valid_trajectory.append(trajectory, 0.0, 0, expected_invalid.front());
+  EXPECT_TRUE(ps->isPathValidParallel(valid_trajectory, "panda_arm", false, &invalid, 4));
+  EXPECT_TRUE(invalid.empty());
+  EXPECT_TRUE(planning_scene::PlanningScene::findInvalidWayPoints(trajectory, [](const moveit::core::RobotState&) {
+                return true;
+              }).empty());
+}
+
 TEST(PlanningScene, loadGoodSceneGeometryNewFormat)
 {
   moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
@@ -303,6 +364,198 @@ TEST(PlanningScene, FailRetrievingNonExistentObject)
   EXPECT_FALSE(ps.getCollisionObjectMsg(obj, "non_existent_object"));
 }
 
+TEST(PlanningScene, ComponentVersions)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
+  planning_scene::PlanningScene ps{ robot_model };
+  const std::size_t objects_version = ps.getCollisionObjectsVersion();
+  const std::size_t octomap_version = ps.getOctomapVersion();
+
+  // robot state changes do not touch the world
+  ps.getCurrentStateNonConst().setToRandomPositions();
+  EXPECT_EQ(ps.getCollisionObjectsVersion(), objects_version);
+
+  ps.getWorldNonConst()->addToObject("box", std::make_shared<const shapes::Box>(0.1, 0.1, 0.1),
+                                     Eigen::Isometry3d::Identity());
+  EXPECT_NE(ps.getCollisionObjectsVersion(), objects_version);
+  EXPECT_EQ(ps.getOctomapVersion(), octomap_version);
+
+  const std::size_t moved_version = ps.getCollisionObjectsVersion();
+  ps.getWorldNonConst()->moveObject("box", Eigen::Isometry3d(Eigen::Translation3d(0.1, 0.0, 0.0)));
+  EXPECT_NE(ps.getCollisionObjectsVersion(), moved_version);
+
+  // in-place octree updates only change the octomap version
+  auto octree = std::make_shared<const octomap::OcTree>(0.1);
+  ps.processOctomapPtr(octree, Eigen::Isometry3d::Identity());
+  const std::size_t objects_version_with_octomap = ps.getCollisionObjectsVersion();
+  const std::size_t first_octomap_version = ps.getOctomapVersion();
+  EXPECT_NE(first_octomap_version, octomap_version);
+  ps.processOctomapPtr(octree, Eigen::Isometry3d::Identity());
+  EXPECT_NE(ps.getOctomapVersion(), first_octomap_version);
+  EXPECT_EQ(ps.getCollisionObjectsVersion(), objects_version_with_octomap);
+
+  // versions are never shared between scenes
+  planning_scene::PlanningScenePtr child = ps.diff();
+  EXPECT_NE(child->getCollisionObjectsVersion(), ps.getCollisionObjectsVersion());
+}
+
+TEST(PlanningScene, FrameTransformsFollowWorldChanges)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
+  planning_scene::PlanningScene ps{ robot_model };
+  const collision_detection::WorldPtr& world = ps.getWorldNonConst();
+  const Eigen::Isometry3d pose(Eigen::Translation3d(0.5, 0.0, 0.0));
+  const Eigen::Isometry3d subframe_pose(Eigen::Translation3d(0.0, 0.0, 0.1));
+
+  // unknown frames resolve to identity, and are found once they are added
+  EXPECT_FALSE(ps.knowsFrameTransform("box"));
+  EXPECT_TRUE(ps.getFrameTransform("box").isApprox(Eigen::Isometry3d::Identity()));
+  world->addToObject("box", pose, std::make_shared<const shapes::Box>(0.1, 0.1, 0.1), Eigen::Isometry3d::Identity());
+  EXPECT_TRUE(ps.knowsFrameTransform("box"));
+  EXPECT_TRUE(ps.getFrameTransform("box").isApprox(pose));
+
+  world->setSubframesOfObject("box", { { "tip", subframe_pose } });
+  EXPECT_TRUE(ps.getFrameTransform("box/tip").isApprox(pose * subframe_pose));
+
+  const Eigen::Isometry3d moved(Eigen::Translation3d(0.0, 0.3, 0.0));
+  world->setObjectPose("box", moved);
+  EXPECT_TRUE(ps.getFrameTransform("box").isApprox(moved));
+  EXPECT_TRUE(ps.getFrameTransform("box/tip").isApprox(moved * subframe_pose));
+
+  // a diff scene resolves frames in its own world
+  planning_scene::PlanningScenePtr child = ps.diff();
+  child->getWorldNonConst()->setObjectPose("box", pose);
+  EXPECT_TRUE(child->getFrameTransform("box").isApprox(pose));
+  EXPECT_TRUE(ps.getFrameTransform("box").isApprox(moved));
+
+  // links are not shadowed by collision objects, and removed objects are forgotten
+  const Eigen::Isometry3d& link_pose = ps.getCurrentState().getGlobalLinkTransform("r_gripper_palm_link");
+  world->setObjectPose("r_gripper_palm_link", pose);
+  EXPECT_TRUE(ps.getFrameTransform("r_gripper_palm_link").isApprox(link_pose));
+  world->removeObject("box");
+  EXPECT_FALSE(ps.knowsFrameTransform("box"));
+  EXPECT_FALSE(ps.knowsFrameTransform("box/tip"));
+  world->clearObjects();
+  EXPECT_TRUE(ps.getFrameTransform("r_gripper_palm_link").isApprox(link_pose));
+}
+
+TEST(PlanningScene, MemoryUsage)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
+  planning_scene::PlanningScene ps{ robot_model };
+  const collision_detection::WorldPtr& world = ps.getWorldNonConst();
+  const Eigen::Isometry3d pose(Eigen::Translation3d(0.5, 0.0, 0.0));
+
+  auto mesh = std::make_shared<shapes::Mesh>(300, 100);
+  for (unsigned int i = 0; i < 3 * mesh->vertex_count; ++i)
+    mesh->vertices[i] = 0.001 * i;
+  for (unsigned int i = 0; i < 3 * mesh->triangle_count; ++i)
+    mesh->triangles[i] = i;
+  world->addToObject("a", pose, mesh, Eigen::Isometry3d::Identity());
+
+  moveit::core::MemoryUsage usage;
+  ps.getMemoryUsage(usage);
+  EXPECT_GT(usage.getBytes("robot_state"), 0u);
+  EXPECT_GT(usage.getBytes("collision_env"), 0u);
+  EXPECT_GT(usage.getBytes("acm"), 0u);
+  const std::size_t mesh_bytes = usage.getBytes("shapes");
+  EXPECT_GE(mesh_bytes, 3 * sizeof(double) * mesh->vertex_count + 3 * sizeof(unsigned int) * mesh->triangle_count);
+
+  // a second object made of the same mesh does not count the mesh again
+  world->addToObject("b", pose, mesh, Eigen::Isometry3d::Identity());
+  usage.clear();
+  ps.getMemoryUsage(usage);
+  EXPECT_EQ(usage.getBytes("shapes"), mesh_bytes);
+
+  // a diff scene includes its parent, but the objects and geometry they share are counted once
+  planning_scene::PlanningScenePtr child = ps.diff();
+  moveit::core::MemoryUsage child_usage;
+  child->getMemoryUsage(child_usage);
+  EXPECT_EQ(child_usage.getBytes("shapes"), mesh_bytes);
+  EXPECT_LT(child_usage.getBytes("world"), 2 * usage.getBytes("world"));
+  EXPECT_GT(child_usage.getTotal(), usage.getTotal());
+  const std::size_t child_total = child_usage.getTotal();
+  child->getMemoryUsage(child_usage);
+  EXPECT_EQ(child_usage.getTotal(), child_total);
+
+  // waypoints that share a state count it once
+  auto state = std::make_shared<moveit::core::RobotState>(ps.getCurrentState());
+  robot_trajectory::RobotTrajectory trajectory(robot_model, "");
+  trajectory.addSuffixWayPoint(state, 0.0).addSuffixWayPoint(state, 0.1);
+  moveit::core::MemoryUsage state_usage;
+  state->getMemoryUsage(state_usage);
+  moveit::core::MemoryUsage trajectory_usage;
+  trajectory.getMemoryUsage(trajectory_usage);
+  EXPECT_EQ(trajectory_usage.getBytes("robot_state"), state_usage.getBytes("robot_state"));
+  EXPECT_GT(trajectory_usage.getBytes("trajectory"), 0u);
+}
+
+TEST(PlanningScene, StateValidityOrder)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
+  planning_scene::PlanningScene ps{ robot_model };
+  const std::vector<std::string>& links = robot_model->getLinkModelNamesWithCollisionGeometry();
+  ps.getAllowedCollisionMatrixNonConst().setEntry(links, links, true);
+  const moveit::core::RobotState& state = ps.getCurrentState();
+  using planning_scene::StateValidityCheck;
+  const auto position = [&ps](StateValidityCheck check) {
+    const std::vector<StateValidityCheck> order = ps.getStateValidityOrder();
+    return std::find(order.begin(), order.end(), check) - order.begin();
+  };
+
+  // the default state is valid, and each collision check ran once
+  EXPECT_TRUE(ps.isStateValid(state));
+  std::vector<planning_scene::StateValidityCheckStatistics> statistics = ps.getStateValidityStatistics();
+  ASSERT_EQ(statistics.size(), 4u);
+  EXPECT_EQ(statistics[0].check, StateValidityCheck::WORLD_COLLISION);
+  EXPECT_EQ(statistics[0].calls, 1u);
+  EXPECT_EQ(statistics[1].calls, 1u);
+  EXPECT_EQ(statistics[2].calls, 0u);  // there is no feasibility predicate
+  EXPECT_EQ(statistics[3].calls, 0u);  // there are no constraints
+
+  // a joint constraint that rejects every state moves ahead of the collision checks
+  moveit_msgs::msg::JointConstraint jc;
+  jc.joint_name = "r_shoulder_pan_joint";
+  jc.position = 0.5;
+  jc.tolerance_above = 0.01;
+  jc.tolerance_below = 0.01;
+  jc.weight = 1.0;
+  moveit_msgs::msg::Constraints constraints;
+  constraints.joint_constraints.push_back(jc);
+  kinematic_constraints::KinematicConstraintSet constraint_set(robot_model);
+  constraint_set.add(constraints, ps.getTransforms());
+  ps.resetStateValidityStatistics();
+  for (std::size_t i = 0; i < 1000; ++i)
+    EXPECT_FALSE(ps.isStateValid(state, constraint_set));
+  EXPECT_LT(position(StateValidityCheck::CONSTRAINTS), position(StateValidityCheck::WORLD_COLLISION));
+  EXPECT_LT(position(StateValidityCheck::CONSTRAINTS), position(StateValidityCheck::SELF_COLLISION));
+  for (const planning_scene::StateValidityCheckStatistics& check : ps.getStateValidityStatistics())
+  {
+    if (check.check == StateValidityCheck::CONSTRAINTS)
+      EXPECT_EQ(check.rejections, 1000u);
+    else
+      EXPECT_EQ(check.rejections, 0u);
+  }
+
+  // a fixed order is kept, invalid orders are refused
+  ps.setAdaptiveStateValidityOrder(false);
+  const std::vector<StateValidityCheck> order = { StateValidityCheck::SELF_COLLISION,
+                                                  StateValidityCheck::WORLD_COLLISION, StateValidityCheck::CONSTRAINTS,
+                                                  StateValidityCheck::FEASIBILITY };
+  EXPECT_TRUE(ps.setStateValidityOrder(order));
+  EXPECT_FALSE(ps.setStateValidityOrder({ StateValidityCheck::CONSTRAINTS, StateValidityCheck::CONSTRAINTS,
+                                          StateValidityCheck::FEASIBILITY, StateValidityCheck::WORLD_COLLISION }));
+  for (std::size_t i = 0; i < 1000; ++i)
+    EXPECT_FALSE(ps.isStateValid(state, constraint_set));
+  EXPECT_EQ(ps.getStateValidityOrder(), order);
+
+  // diff scenes inherit the order, but not the statistics
+  planning_scene::PlanningScenePtr child = ps.diff();
+  EXPECT_EQ(child->getStateValidityOrder(), order);
+  EXPECT_FALSE(child->isAdaptiveStateValidityOrder());
+  EXPECT_EQ(child->getStateValidityStatistics()[0].calls, 0u);
+}
+
 class CollisionDetectorTests : public testing::TestWithParam<const char*>
 {
 };
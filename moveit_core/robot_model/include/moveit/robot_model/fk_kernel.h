@@ -0,0 +1,77 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace moveit
+{
+namespace core
+{
+class RobotModel;
+
+/** \brief Forward kinematics generated for one robot model, with its joint axes and fixed transforms compiled in.
+
+    Kernels are generated at build time by the moveit_add_fk_kernel() CMake function and register themselves when the
+    library holding them is loaded. A RobotModel whose hash (see RobotModel::getModelHash()) matches a registered
+    kernel uses it for RobotState::update() instead of walking its link models. */
+struct FKKernel
+{
+  /** \brief Compute the local transforms of all joints and the global transforms of all links, in joint and link index
+      order, from a full state with consistent mimic joint values. Only the linear and translation parts of the
+      transforms are written, their last rows must already be set (see Eigen::Transform::makeAffine()). */
+  using ComputeFn = void (*)(const double* positions, Eigen::Isometry3d* joint_transforms,
+                             Eigen::Isometry3d* link_transforms);
+
+  std::uint64_t model_hash;
+  const char* model_name;
+  ComputeFn compute;
+};
+
+/** \brief Register a kernel for the models with its hash. Returns true, so it can initialize a static variable. */
+bool registerFKKernel(const FKKernel& kernel);
+
+/** \brief Get the kernel registered for \e model_hash, or nullptr */
+const FKKernel* findFKKernel(std::uint64_t model_hash);
+
+/** \brief Write the C++ source of a kernel for \e model, which registers itself when loaded.
+    @param function_name the name of the generated compute function, unique among the kernels linked together */
+void generateFKKernelSource(const RobotModel& model, const std::string& function_name, std::ostream& out);
+}  // namespace core
+}  // namespace moveit
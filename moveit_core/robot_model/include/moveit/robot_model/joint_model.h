@@ -358,6 +358,10 @@ public:
   /** \brief Override joint limits loaded from URDF. Unknown variables are ignored. */
   void setVariableBounds(const std::vector<moveit_msgs::msg::JointLimits>& jlim);
 
+  /** \brief A counter that is incremented whenever the bounds or the distance factor of any joint change, so copies
+   * of them can tell when they need to be refreshed */
+  static unsigned int getVariableBoundsRevision();
+
   /** \brief Get the joint limits known to this model, as a message. */
   const std::vector<moveit_msgs::msg::JointLimits>& getVariableBoundsMsg() const
   {
@@ -378,10 +382,7 @@ public:
 
   /** \brief Set the factor that should be applied to the value returned by distance() when that value is used in
    * compound distances */
-  void setDistanceFactor(double factor)
-  {
-    distance_factor_ = factor;
-  }
+  void setDistanceFactor(double factor);
 
   /** \brief Get the dimension of the state space that corresponds to this joint */
   virtual unsigned int getStateSpaceDimension() const = 0;
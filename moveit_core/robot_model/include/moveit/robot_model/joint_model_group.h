@@ -41,9 +41,14 @@
 #include <moveit/robot_model/link_model.h>
 #include <moveit/kinematics_base/kinematics_base.h>
 #include <srdfdom/model.h>
+#include <atomic>
 #include <functional>
+#include <limits>
+#include <mutex>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace moveit
 {
@@ -405,6 +410,19 @@ public:
   double distance(const double* state1, const double* state2) const;
   void interpolate(const double* from, const double* to, double t, double* state) const;
 
+  /**
+   * Interpolate between two group states at several fractions in one call, e.g. to get all the intermediate states
+   * of a motion for batched validity checking.
+   *
+   * @param from interpolate from this group state
+   * @param to to this group state
+   * @param t \e count fractions in the range [0 1]
+   * @param count the number of states to compute
+   * @param states holds the results, \e count group states stored one after the other (count x getVariableCount()
+   * values). Must not overlap \e from or \e to.
+   */
+  void interpolate(const double* from, const double* to, const double* t, std::size_t count, double* states) const;
+
   /** \brief Get the number of variables that describe this joint group. This includes variables necessary for mimic
       joints, so will always be >= the number of items returned by getActiveVariableNames() */
   unsigned int getVariableCount() const
@@ -644,6 +662,30 @@ protected:
   /** \brief The bounds for all the active joint models */
   JointBoundsVector active_joint_models_bounds_;
 
+  /** \brief True if all active joints are revolute or prismatic and the group has no mimic joints, so the group
+      state holds exactly one variable per active joint and its position bounds can be checked as flat arrays */
+  bool has_flat_position_bounds_;
+
+  /** \brief Refresh the flat position bounds, distance factors and linear runs if the bounds or distance factor of
+      any joint changed since they were built */
+  void updateFlatPositionBounds() const;
+
+  /** \brief Interpolate a group state with flat position bounds, after updateFlatPositionBounds() */
+  void interpolateFlat(const double* from, const double* to, double t, double* state) const;
+
+  /** \brief Copies of the position bounds of active_joint_models_bounds_ in group variable order, used when the
+      group has flat position bounds. Continuous joints get infinite bounds and are listed in
+      flat_continuous_variables_, since enforcing their bounds wraps the value instead of clamping it. */
+  mutable std::vector<double> flat_min_positions_;
+  mutable std::vector<double> flat_max_positions_;
+  mutable std::vector<std::size_t> flat_continuous_variables_;
+  mutable std::vector<double> flat_distance_factors_;
+  /** \brief Maximal ranges (start, size) of group variables that are not continuous, so interpolation and distance
+      are linear on them */
+  mutable std::vector<std::pair<std::size_t, std::size_t>> flat_linear_runs_;
+  mutable std::atomic<unsigned int> flat_position_bounds_revision_{ std::numeric_limits<unsigned int>::max() };
+  mutable std::mutex flat_position_bounds_mutex_;
+
   /** \brief The list of index values this group includes, with respect to a full robot state; this includes mimic
    * joints. */
   std::vector<int> variable_index_list_;
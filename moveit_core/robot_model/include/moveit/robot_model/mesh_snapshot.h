@@ -0,0 +1,105 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <geometric_shapes/shapes.h>
+#include <Eigen/Core>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace moveit
+{
+namespace core
+{
+MOVEIT_CLASS_FORWARD(MeshSnapshot);  // Defines MeshSnapshotPtr, ConstPtr, WeakPtr... etc
+
+/** \brief The decoded collision meshes of a robot model, stored in a file for later processes that load the same model.
+
+    Decoding mesh resources usually dominates the construction time of a RobotModel. A RobotModel constructed with a
+    snapshot takes its meshes from the snapshot and records the meshes it has to decode, so the snapshot can be saved
+    and loaded (memory-mapped) by the next process. The snapshot is identified by a key, e.g. hashString() of the URDF
+    and SRDF documents, and a file with a different key is not loaded. Mesh files that change while the robot
+    description stays the same are not detected. */
+class MeshSnapshot
+{
+public:
+  /** \brief Construct an empty snapshot for the robot description identified by \e key */
+  explicit MeshSnapshot(std::uint64_t key);
+
+  std::uint64_t getKey() const
+  {
+    return key_;
+  }
+
+  /** \brief Load the meshes stored in \e filename. Return false, leaving the snapshot unchanged, if the file is
+      missing, stores a different key or version, or is corrupt. */
+  bool load(const std::string& filename);
+
+  /** \brief Store the meshes in \e filename. The file is replaced atomically, so concurrent readers see either the
+      old or the new file. */
+  bool save(const std::string& filename) const;
+
+  /** \brief Get a copy of the mesh decoded from \e resource with \e scale. Meshes not in the snapshot are decoded and
+      added to it. Return nullptr if the resource cannot be decoded. */
+  shapes::ShapePtr getMesh(const std::string& resource, const Eigen::Vector3d& scale);
+
+  /** \brief True if meshes were added since the snapshot was constructed or loaded */
+  bool isModified() const
+  {
+    return modified_;
+  }
+
+  std::size_t size() const
+  {
+    return meshes_.size();
+  }
+
+  /** \brief A 64 bit FNV-1a hash of \e data, continuing from \e seed. Unlike std::hash, it is the same in every
+      process and on every platform, so it can identify the robot description across processes. */
+  static std::uint64_t hashString(const std::string& data, std::uint64_t seed = 14695981039346656037ULL);
+
+private:
+  using MeshKey = std::tuple<std::string, double, double, double>;
+
+  std::uint64_t key_;
+  std::map<MeshKey, std::shared_ptr<const shapes::Mesh>> meshes_;
+  bool modified_{ false };
+};
+}  // namespace core
+}  // namespace moveit
@@ -39,6 +39,7 @@
 
 #include <moveit/macros/class_forward.h>
 #include <moveit/exceptions/exceptions.h>
+#include <moveit/utils/interned_name.h>
 #include <srdfdom/model.h>
 
 // joint types
@@ -48,9 +49,14 @@
 #include <moveit/robot_model/planar_joint_model.h>
 #include <moveit/robot_model/revolute_joint_model.h>
 #include <moveit/robot_model/prismatic_joint_model.h>
+#include <moveit/robot_model/fk_kernel.h>
+#include <moveit/robot_model/mesh_snapshot.h>
+#include <moveit/robot_model/variable_layout.h>
 #include <rclcpp/logging.hpp>
 #include <Eigen/Geometry>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 
 /** \brief Main namespace for MoveIt */
 namespace moveit
@@ -78,6 +84,11 @@ public:
   /** \brief Construct a kinematic model from a parsed description and a list of planning groups */
   RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const srdf::ModelConstSharedPtr& srdf_model);
 
+  /** \brief Construct a kinematic model from a parsed description and a list of planning groups, taking the collision
+      meshes from \e mesh_snapshot. Meshes missing from the snapshot are decoded and added to it. */
+  RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const srdf::ModelConstSharedPtr& srdf_model,
+             const MeshSnapshotPtr& mesh_snapshot);
+
   /** \brief Destructor. Clear all memory. */
   ~RobotModel();
 
@@ -145,6 +156,15 @@ public:
   /** \brief Get a joint by its name. Output error and return nullptr when the joint is missing. */
   JointModel* getJointModel(const std::string& joint);
 
+  /** \brief Check if a joint exists, looking it up by its interned name */
+  bool hasJointModel(const InternedName& name) const
+  {
+    return joint_models_by_interned_name_.get(name) != nullptr;
+  }
+
+  /** \brief Get a joint by its interned name. Output error and return nullptr when the joint is missing. */
+  const JointModel* getJointModel(const InternedName& joint) const;
+
   /** \brief Get the array of joints, in the order they appear
       in the robot state. */
   const std::vector<const JointModel*>& getJointModels() const
@@ -254,6 +274,16 @@ public:
   /** \brief Get a link by its name. Output error and return nullptr when the link is missing. */
   LinkModel* getLinkModel(const std::string& link, bool* has_link = nullptr);
 
+  /** \brief Check if a link exists, looking it up by its interned name */
+  bool hasLinkModel(const InternedName& name) const
+  {
+    return link_models_by_interned_name_.get(name) != nullptr;
+  }
+
+  /** \brief Get a link by its interned name, without hashing or comparing strings. Output error and return nullptr
+      when the link is missing, unless \e has_link is given, which is then set to false. */
+  const LinkModel* getLinkModel(const InternedName& link, bool* has_link = nullptr) const;
+
   /** \brief Get the latest link upwards the kinematic tree, which is only connected via fixed joints
    *
    * This is useful, if the link should be warped to a specific pose using updateStateWithLinkAt().
@@ -366,6 +396,49 @@ public:
    */
   void interpolate(const double* from, const double* to, double t, double* state) const;
 
+  /**
+   * Interpolate between "from" state and "to" state at several fractions in one call. Each joint is dispatched once
+   * for the whole batch. The result can be passed to computeLinkTransformsBatch().
+   *
+   * @param from interpolate from this state
+   * @param to to this state
+   * @param t \e count fractions in the range [0 1]
+   * @param count the number of states to compute
+   * @param states holds the results, \e count full states stored one after the other (count x getVariableCount()
+   * values). Must not overlap \e from or \e to.
+   */
+  void interpolate(const double* from, const double* to, const double* t, std::size_t count, double* states) const;
+
+  /**
+   * Compute the global transforms of all links for a batch of states at once.
+   *
+   * The joint transforms are evaluated link by link for the whole batch, so the joint type dispatch and the
+   * access to the link origin transforms happen once per link instead of once per state and link.
+   * Values of mimic joints are read from \e states as is, so they must be consistent (see RobotState::update()).
+   *
+   * @param states \e count full states stored one after the other (count x getVariableCount() values)
+   * @param count the number of states in the batch
+   * @param link_transforms caller-owned buffer of count x getLinkModelCount() transforms. The transform of
+   * link \e l for state \e i is stored at link_transforms[l * count + i], so the poses of one link across the
+   * batch are contiguous.
+   */
+  void computeLinkTransformsBatch(const double* states, std::size_t count, Eigen::Isometry3d* link_transforms) const;
+
+  /** \brief A hash of everything forward kinematics depends on: the link tree, the joint types and axes, the fixed
+      transforms and the variable indices. It is the same in every process, and identifies the generated FK kernel
+      for this model. */
+  std::uint64_t getModelHash() const
+  {
+    return model_hash_;
+  }
+
+  /** \brief The generated forward kinematics for this model (see FKKernel), or nullptr if none was registered when
+      the model was built */
+  const FKKernel* getFKKernel() const
+  {
+    return fk_kernel_;
+  }
+
   /** \name Access to joint groups
    *  @{
    */
@@ -447,6 +520,10 @@ public:
   /** \brief Get the index of a variable in the robot state */
   size_t getVariableIndex(const std::string& variable) const;
 
+  /** \brief Get the layout of the variables \e names, e.g. the joint names of a message. Layouts are cached, so
+      messages with the same names share one. Throws a moveit::Exception if a name is not a variable of the model. */
+  VariableLayoutConstPtr getVariableLayout(const std::vector<std::string>& names) const;
+
   /** \brief Get the deepest joint in the kinematic tree that is a common parent of both joints passed as argument */
   const JointModel* getCommonRoot(const JointModel* a, const JointModel* b) const
   {
@@ -482,6 +559,9 @@ protected:
 
   srdf::ModelConstSharedPtr srdf_;
 
+  /** \brief The snapshot to take collision meshes from while building the model, if any */
+  MeshSnapshotPtr mesh_snapshot_;
+
   urdf::ModelInterfaceSharedPtr urdf_;
 
   // LINKS
@@ -492,6 +572,9 @@ protected:
   /** \brief A map from link names to their instances */
   LinkModelMap link_model_map_;
 
+  /** \brief The links indexed by the ids of their interned names */
+  InternedNameMap<LinkModel*> link_models_by_interned_name_{ nullptr };
+
   /** \brief The vector of links that are updated when computeTransforms() is called, in the order they are updated */
   std::vector<LinkModel*> link_model_vector_;
 
@@ -518,6 +601,9 @@ protected:
   /** \brief A map from joint names to their instances */
   JointModelMap joint_model_map_;
 
+  /** \brief The joints indexed by the ids of their interned names */
+  InternedNameMap<JointModel*> joint_models_by_interned_name_{ nullptr };
+
   /** \brief The vector of joints in the model, in the order they appear in the state vector */
   std::vector<JointModel*> joint_model_vector_;
 
@@ -577,6 +663,16 @@ protected:
   /** \brief The joints that correspond to each variable index */
   std::vector<const JointModel*> joints_of_variable_;
 
+  /** \brief The layouts handed out by getVariableLayout(), by the hash of their names */
+  mutable std::unordered_multimap<std::size_t, VariableLayoutConstPtr> variable_layouts_;
+  mutable std::mutex variable_layouts_lock_;
+
+  /** \brief See getModelHash() */
+  std::uint64_t model_hash_{ 0 };
+
+  /** \brief See getFKKernel() */
+  const FKKernel* fk_kernel_{ nullptr };
+
   // GROUPS
 
   /** \brief A map from group names to joint groups */
@@ -601,6 +697,9 @@ private:
   /** \brief Given an URDF model and a SRDF model, build a full kinematic model */
   void buildModel(const urdf::ModelInterface& urdf_model, const srdf::Model& srdf_model);
 
+  /** \brief Compute model_hash_ and look up the FK kernel for it, after the joint indexing is built */
+  void buildModelHash();
+
   /** \brief Given a SRDF model describing the groups, build up the groups in this kinematic model */
   void buildGroups(const srdf::Model& srdf_model);
 
@@ -0,0 +1,98 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <string>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+class JointModel;
+class RobotModel;
+
+MOVEIT_CLASS_FORWARD(VariableLayout);  // Defines VariableLayoutPtr, ConstPtr, WeakPtr... etc
+
+/** \brief The variable indices of a list of variable names, such as the joint_names of a JointTrajectory or the names
+    of a JointState message.
+
+    Messages with the same names can be copied into a RobotState by index with the layout, instead of looking up every
+    name for every message or trajectory point. Get layouts with RobotModel::getVariableLayout(), which caches them. */
+class VariableLayout
+{
+public:
+  /** \brief Construct the layout of \e names. Throws a moveit::Exception if a name is not a variable of \e model. */
+  VariableLayout(const RobotModel& model, const std::vector<std::string>& names);
+
+  /** \brief The names the layout was constructed for */
+  const std::vector<std::string>& getNames() const
+  {
+    return names_;
+  }
+
+  /** \brief The variable index of each name */
+  const std::vector<int>& getIndices() const
+  {
+    return indices_;
+  }
+
+  /** \brief The joints of the variables, each listed once */
+  const std::vector<const JointModel*>& getJoints() const
+  {
+    return joints_;
+  }
+
+  std::size_t size() const
+  {
+    return indices_.size();
+  }
+
+  /** \brief Copy \e values, given in the order of the layout, into the full variable array \e variables */
+  void scatter(const std::vector<double>& values, double* variables) const
+  {
+    for (std::size_t i = 0; i < indices_.size(); ++i)
+      variables[indices_[i]] = values[i];
+  }
+
+private:
+  std::vector<std::string> names_;
+  std::vector<int> indices_;
+  std::vector<const JointModel*> joints_;
+};
+}  // namespace core
+}  // namespace moveit
@@ -0,0 +1,267 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/robot_model/fk_kernel.h>
+#include <moveit/robot_model/prismatic_joint_model.h>
+#include <moveit/robot_model/revolute_joint_model.h>
+#include <moveit/robot_model/robot_model.h>
+#include <cstdio>
+#include <map>
+#include <mutex>
+
+namespace moveit
+{
+namespace core
+{
+namespace
+{
+struct FKKernelRegistry
+{
+  std::mutex lock;
+  std::map<std::uint64_t, FKKernel> kernels;
+};
+
+FKKernelRegistry& getRegistry()
+{
+  // constructed on first use, as kernels register during static initialization
+  static FKKernelRegistry registry;
+  return registry;
+}
+
+std::string literal(double value)
+{
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  std::string result(buffer);
+  if (result.find_first_of(".e") == std::string::npos)
+    result += ".0";
+  return result;
+}
+
+std::string vectorLiteral(const Eigen::Vector3d& v)
+{
+  return "Eigen::Vector3d(" + literal(v.x()) + ", " + literal(v.y()) + ", " + literal(v.z()) + ')';
+}
+
+std::string matrixLiteral(const Eigen::Matrix3d& m)
+{
+  std::string result = "(Eigen::Matrix3d() << ";
+  for (int r = 0; r < 3; ++r)
+  {
+    for (int c = 0; c < 3; ++c)
+      result += literal(m(r, c)) + (r == 2 && c == 2 ? ").finished()" : ", ");
+  }
+  return result;
+}
+
+/** \brief Index of the coordinate axis \e axis points along, with its sign, or -1 if it is not aligned */
+int alignedAxis(const Eigen::Vector3d& axis, double& sign)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    if (std::abs(axis[i]) == 1.0 && axis[(i + 1) % 3] == 0.0 && axis[(i + 2) % 3] == 0.0)
+    {
+      sign = axis[i];
+      return i;
+    }
+  }
+  return -1;
+}
+
+/** \brief Emit the rotation by \e angle (an expression) about coordinate axis \e axis, as the joint transform j and
+    applied to the link transform t */
+void emitAxisRotation(std::ostream& out, int axis, const std::string& angle)
+{
+  const int a = (axis + 1) % 3;
+  const int b = (axis + 2) % 3;
+  std::string m[3][3] = { { "0.0", "0.0", "0.0" }, { "0.0", "0.0", "0.0" }, { "0.0", "0.0", "0.0" } };
+  m[axis][axis] = "1.0";
+  m[a][a] = "c";
+  m[b][a] = "s";
+  m[a][b] = "-s";
+  m[b][b] = "c";
+  out << "    const double c = std::cos(" << angle << ");\n"
+      << "    const double s = std::sin(" << angle << ");\n"
+      << "    j.linear() << " << m[0][0] << ", " << m[0][1] << ", " << m[0][2] << ", " << m[1][0] << ", " << m[1][1]
+      << ", " << m[1][2] << ", " << m[2][0] << ", " << m[2][1] << ", " << m[2][2] << ";\n"
+      // right-multiplying the rotation only mixes the two other columns of t.linear()
+      << "    const Eigen::Vector3d col_a = t.linear().col(" << a << ");\n"
+      << "    t.linear().col(" << a << ") = c * col_a + s * t.linear().col(" << b << ");\n"
+      << "    t.linear().col(" << b << ") = c * t.linear().col(" << b << ") - s * col_a;\n";
+}
+
+std::string positionLiteral(int index)
+{
+  return "positions[" + std::to_string(index) + ']';
+}
+
+std::string stringLiteral(const std::string& value)
+{
+  std::string result = "\"";
+  for (const char c : value)
+  {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result + '"';
+}
+}  // namespace
+
+bool registerFKKernel(const FKKernel& kernel)
+{
+  FKKernelRegistry& registry = getRegistry();
+  std::scoped_lock lock(registry.lock);
+  registry.kernels[kernel.model_hash] = kernel;
+  return true;
+}
+
+const FKKernel* findFKKernel(std::uint64_t model_hash)
+{
+  FKKernelRegistry& registry = getRegistry();
+  std::scoped_lock lock(registry.lock);
+  const auto it = registry.kernels.find(model_hash);
+  return it == registry.kernels.end() ? nullptr : &it->second;
+}
+
+void generateFKKernelSource(const RobotModel& model, const std::string& function_name, std::ostream& out)
+{
+  char hash[32];
+  std::snprintf(hash, sizeof(hash), "0x%016llxULL", static_cast<unsigned long long>(model.getModelHash()));
+
+  out << "// Forward kinematics of robot '" << model.getName() << "', generated by moveit_generate_fk_kernel.\n"
+      << "// Do not edit: regenerate it when the robot description changes.\n\n"
+      << "#include <moveit/robot_model/fk_kernel.h>\n"
+      << "#include <cmath>\n\n"
+      << "namespace\n{\n"
+      << "void " << function_name
+      << "(const double* positions, Eigen::Isometry3d* joint_transforms, Eigen::Isometry3d* link_transforms)\n{\n";
+
+  for (const LinkModel* link : model.getLinkModels())
+  {
+    const JointModel* joint = link->getParentJointModel();
+    const Eigen::Isometry3d& origin = link->getJointOriginTransform();
+    const bool rotated = !link->jointOriginTransformIsIdentity() && origin.linear() != Eigen::Matrix3d::Identity();
+    const bool translated = !link->jointOriginTransformIsIdentity() && !origin.translation().isZero(0.0);
+
+    out << "  // " << link->getName() << '\n'
+        << "  {\n"
+        << "    Eigen::Isometry3d& j = joint_transforms[" << joint->getJointIndex() << "];\n"
+        << "    Eigen::Isometry3d& t = link_transforms[" << link->getLinkIndex() << "];\n";
+
+    // the fixed transform to the joint frame, folded into constants
+    if (const LinkModel* parent = link->getParentLinkModel())
+    {
+      const std::string p = "link_transforms[" + std::to_string(parent->getLinkIndex()) + ']';
+      if (rotated)
+        out << "    t.linear().noalias() = " << p << ".linear() * " << matrixLiteral(origin.linear()) << ";\n";
+      else
+        out << "    t.linear() = " << p << ".linear();\n";
+      if (translated)
+        out << "    t.translation().noalias() = " << p << ".translation() + " << p << ".linear() * "
+            << vectorLiteral(origin.translation()) << ";\n";
+      else
+        out << "    t.translation() = " << p << ".translation();\n";
+    }
+    else
+    {
+      out << "    t.linear() = " << (rotated ? matrixLiteral(origin.linear()) : "Eigen::Matrix3d::Identity()") << ";\n"
+          << "    t.translation() = " << (translated ? vectorLiteral(origin.translation()) : "Eigen::Vector3d::Zero()")
+          << ";\n";
+    }
+
+    // the joint transform, specialized for the joint type and axis
+    const int index = joint->getFirstVariableIndex();
+    double sign = 1.0;
+    switch (joint->getType())
+    {
+      case JointModel::REVOLUTE:
+      {
+        const Eigen::Vector3d& axis = static_cast<const RevoluteJointModel*>(joint)->getAxis();
+        const int aligned = alignedAxis(axis, sign);
+        out << "    j.translation().setZero();\n";
+        if (aligned >= 0)
+          emitAxisRotation(out, aligned, (sign < 0.0 ? "-" : "") + positionLiteral(index));
+        else
+          out << "    j.linear() = Eigen::AngleAxisd(" << positionLiteral(index) << ", " << vectorLiteral(axis)
+              << ").toRotationMatrix();\n"
+              << "    t.linear() = t.linear() * j.linear();\n";
+        break;
+      }
+      case JointModel::PRISMATIC:
+      {
+        const Eigen::Vector3d& axis = static_cast<const PrismaticJointModel*>(joint)->getAxis();
+        const int aligned = alignedAxis(axis, sign);
+        out << "    j.linear().setIdentity();\n";
+        if (aligned >= 0)
+          out << "    j.translation() = " << (sign < 0.0 ? "-" : "") << positionLiteral(index)
+              << " * Eigen::Vector3d::Unit(" << aligned << ");\n"
+              << "    t.translation() += " << (sign < 0.0 ? "-" : "") << positionLiteral(index)
+              << " * t.linear().col(" << aligned << ");\n";
+        else
+          out << "    j.translation() = " << positionLiteral(index) << " * " << vectorLiteral(axis) << ";\n"
+              << "    t.translation() += t.linear() * j.translation();\n";
+        break;
+      }
+      case JointModel::PLANAR:
+        out << "    j.translation() = Eigen::Vector3d(" << positionLiteral(index) << ", " << positionLiteral(index + 1)
+            << ", 0.0);\n"
+            << "    t.translation() += t.linear() * j.translation();\n";
+        emitAxisRotation(out, 2, positionLiteral(index + 2));
+        break;
+      case JointModel::FLOATING:
+        out << "    j.translation() = Eigen::Vector3d(" << positionLiteral(index) << ", " << positionLiteral(index + 1)
+            << ", " << positionLiteral(index + 2) << ");\n"
+            << "    j.linear() = Eigen::Quaterniond(" << positionLiteral(index + 6) << ", "
+            << positionLiteral(index + 3) << ", " << positionLiteral(index + 4) << ", " << positionLiteral(index + 5)
+            << ").normalized().toRotationMatrix();\n"
+            << "    t.translation() += t.linear() * j.translation();\n"
+            << "    t.linear() = t.linear() * j.linear();\n";
+        break;
+      default:
+        out << "    j.linear().setIdentity();\n"
+            << "    j.translation().setZero();\n";
+        break;
+    }
+    out << "  }\n";
+  }
+
+  out << "}\n\n"
+      << "[[maybe_unused]] const bool REGISTERED = moveit::core::registerFKKernel({ " << hash << ", "
+      << stringLiteral(model.getName()) << ", &" << function_name << " });\n"
+      << "}  // namespace\n";
+}
+}  // namespace core
+}  // namespace moveit
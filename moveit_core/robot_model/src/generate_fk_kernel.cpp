@@ -0,0 +1,74 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Generates the FK kernel of a robot model, see moveit/robot_model/fk_kernel.h and moveit_add_fk_kernel() */
+
+#include <moveit/robot_model/fk_kernel.h>
+#include <moveit/robot_model/robot_model.h>
+#include <urdf_parser/urdf_parser.h>
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+  if (argc != 5)
+  {
+    std::cerr << "Usage: " << argv[0] << " URDF_FILE SRDF_FILE OUTPUT_FILE FUNCTION_NAME\n";
+    return 1;
+  }
+
+  const urdf::ModelInterfaceSharedPtr urdf_model = urdf::parseURDFFile(argv[1]);
+  if (!urdf_model)
+  {
+    std::cerr << "Cannot parse URDF file '" << argv[1] << "'\n";
+    return 1;
+  }
+  auto srdf_model = std::make_shared<srdf::Model>();
+  if (!srdf_model->initFile(*urdf_model, argv[2]))
+  {
+    std::cerr << "Cannot parse SRDF file '" << argv[2] << "'\n";
+    return 1;
+  }
+  const moveit::core::RobotModel model(urdf_model, srdf_model);
+
+  std::ofstream out(argv[3]);
+  moveit::core::generateFKKernelSource(model, argv[4], out);
+  if (!out)
+  {
+    std::cerr << "Cannot write '" << argv[3] << "'\n";
+    return 1;
+  }
+  return 0;
+}
@@ -39,11 +39,17 @@
 #include <moveit/robot_model/joint_model.h>
 #include <moveit/robot_model/link_model.h>
 #include <algorithm>
+#include <atomic>
 
 namespace moveit
 {
 namespace core
 {
+namespace
+{
+std::atomic<unsigned int> variable_bounds_revision{ 0 };
+}  // namespace
+
 JointModel::JointModel(const std::string& name, size_t joint_index, size_t first_variable_index)
   : name_(name)
   , joint_index_(joint_index)
@@ -224,8 +230,20 @@ void JointModel::setVariableBounds(const std::vector<moveit_msgs::msg::JointLimi
   computeVariableBoundsMsg();
 }
 
+void JointModel::setDistanceFactor(double factor)
+{
+  distance_factor_ = factor;
+  variable_bounds_revision.fetch_add(1, std::memory_order_release);
+}
+
+unsigned int JointModel::getVariableBoundsRevision()
+{
+  return variable_bounds_revision.load(std::memory_order_acquire);
+}
+
 void JointModel::computeVariableBoundsMsg()
 {
+  variable_bounds_revision.fetch_add(1, std::memory_order_release);
   variable_bounds_msg_.clear();
   for (std::size_t i = 0; i < variable_bounds_.size(); ++i)
   {
@@ -119,6 +119,7 @@ JointModelGroup::JointModelGroup(const std::string& group_name, const srdf::Mode
   , is_contiguous_index_list_(true)
   , is_chain_(false)
   , is_single_dof_(true)
+  , has_flat_position_bounds_(true)
   , config_(config)
 {
   // sort joints in Depth-First order
@@ -167,6 +168,10 @@ JointModelGroup::JointModelGroup(const std::string& group_name, const srdf::Mode
           static_cast<const RevoluteJointModel*>(joint_model)->isContinuous())
         continuous_joint_model_vector_.push_back(joint_model);
 
+      if (joint_model->getMimic() != nullptr ||
+          (joint_model->getType() != JointModel::REVOLUTE && joint_model->getType() != JointModel::PRISMATIC))
+        has_flat_position_bounds_ = false;
+
       variable_count_ += vc;
     }
     else
@@ -408,10 +413,58 @@ void JointModelGroup::getVariableRandomPositionsNearBy(random_numbers::RandomNum
   updateMimicJoints(values);
 }
 
+void JointModelGroup::updateFlatPositionBounds() const
+{
+  const unsigned int revision = JointModel::getVariableBoundsRevision();
+  if (flat_position_bounds_revision_.load(std::memory_order_acquire) == revision)
+    return;
+
+  std::scoped_lock lock(flat_position_bounds_mutex_);
+  if (flat_position_bounds_revision_.load(std::memory_order_relaxed) == revision)
+    return;
+  flat_min_positions_.resize(active_variable_count_);
+  flat_max_positions_.resize(active_variable_count_);
+  flat_distance_factors_.resize(active_variable_count_);
+  flat_continuous_variables_.clear();
+  flat_linear_runs_.clear();
+  for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
+  {
+    const JointModel* joint_model = active_joint_model_vector_[i];
+    flat_distance_factors_[i] = joint_model->getDistanceFactor();
+    if (joint_model->getType() == JointModel::REVOLUTE &&
+        static_cast<const RevoluteJointModel*>(joint_model)->isContinuous())
+    {
+      flat_min_positions_[i] = -std::numeric_limits<double>::infinity();
+      flat_max_positions_[i] = std::numeric_limits<double>::infinity();
+      flat_continuous_variables_.push_back(i);
+    }
+    else
+    {
+      flat_min_positions_[i] = (*active_joint_models_bounds_[i])[0].min_position_;
+      flat_max_positions_[i] = (*active_joint_models_bounds_[i])[0].max_position_;
+      if (!flat_linear_runs_.empty() && flat_linear_runs_.back().first + flat_linear_runs_.back().second == i)
+        ++flat_linear_runs_.back().second;
+      else
+        flat_linear_runs_.emplace_back(i, 1);
+    }
+  }
+  flat_position_bounds_revision_.store(revision, std::memory_order_release);
+}
+
 bool JointModelGroup::satisfiesPositionBounds(const double* state, const JointBoundsVector& active_joint_bounds,
                                               double margin) const
 {
   assert(active_joint_bounds.size() == active_joint_model_vector_.size());
+  if (has_flat_position_bounds_ && &active_joint_bounds == &active_joint_models_bounds_)
+  {
+    updateFlatPositionBounds();
+    const Eigen::Index n = active_variable_count_;
+    const Eigen::Map<const Eigen::ArrayXd> values(state, n);
+    const Eigen::Map<const Eigen::ArrayXd> min_positions(flat_min_positions_.data(), n);
+    const Eigen::Map<const Eigen::ArrayXd> max_positions(flat_max_positions_.data(), n);
+    // written as in the joint models, so NaN values pass the check there as well as here
+    return !((values < min_positions - margin) || (values > max_positions + margin)).any();
+  }
   for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
   {
     if (!active_joint_model_vector_[i]->satisfiesPositionBounds(state + active_joint_model_start_index_[i],
@@ -424,6 +477,24 @@ bool JointModelGroup::satisfiesPositionBounds(const double* state, const JointBo
 bool JointModelGroup::enforcePositionBounds(double* state, const JointBoundsVector& active_joint_bounds) const
 {
   assert(active_joint_bounds.size() == active_joint_model_vector_.size());
+  if (has_flat_position_bounds_ && &active_joint_bounds == &active_joint_models_bounds_)
+  {
+    updateFlatPositionBounds();
+    const Eigen::Index n = active_variable_count_;
+    Eigen::Map<Eigen::ArrayXd> values(state, n);
+    const Eigen::Map<const Eigen::ArrayXd> min_positions(flat_min_positions_.data(), n);
+    const Eigen::Map<const Eigen::ArrayXd> max_positions(flat_max_positions_.data(), n);
+    bool change = ((values < min_positions) || (values > max_positions)).any();
+    if (change)
+      values = (values < min_positions).select(min_positions, (values > max_positions).select(max_positions, values));
+    for (std::size_t i : flat_continuous_variables_)
+    {
+      if (active_joint_model_vector_[i]->enforcePositionBounds(state + i, *active_joint_bounds[i]))
+        change = true;
+    }
+    return change;
+  }
+
   bool change = false;
   for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
   {
@@ -449,6 +520,24 @@ double JointModelGroup::getMaximumExtent(const JointBoundsVector& active_joint_b
 
 double JointModelGroup::distance(const double* state1, const double* state2) const
 {
+  if (has_flat_position_bounds_)
+  {
+    updateFlatPositionBounds();
+    double d = 0.0;
+    for (const std::pair<std::size_t, std::size_t>& run : flat_linear_runs_)
+    {
+      const Eigen::Index n = run.second;
+      d += ((Eigen::Map<const Eigen::ArrayXd>(state1 + run.first, n) -
+             Eigen::Map<const Eigen::ArrayXd>(state2 + run.first, n))
+                .abs() *
+            Eigen::Map<const Eigen::ArrayXd>(flat_distance_factors_.data() + run.first, n))
+               .sum();
+    }
+    for (std::size_t i : flat_continuous_variables_)
+      d += flat_distance_factors_[i] * active_joint_model_vector_[i]->distance(state1 + i, state2 + i);
+    return d;
+  }
+
   double d = 0.0;
   for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
   {
@@ -459,8 +548,29 @@ double JointModelGroup::distance(const double* state1, const double* state2) con
   return d;
 }
 
+void JointModelGroup::interpolateFlat(const double* from, const double* to, double t, double* state) const
+{
+  // element-wise, so state may alias from or to
+  for (const std::pair<std::size_t, std::size_t>& run : flat_linear_runs_)
+  {
+    const Eigen::Index n = run.second;
+    const Eigen::Map<const Eigen::ArrayXd> from_values(from + run.first, n);
+    const Eigen::Map<const Eigen::ArrayXd> to_values(to + run.first, n);
+    Eigen::Map<Eigen::ArrayXd>(state + run.first, n) = from_values + (to_values - from_values) * t;
+  }
+  for (std::size_t i : flat_continuous_variables_)
+    active_joint_model_vector_[i]->interpolate(from + i, to + i, t, state + i);
+}
+
 void JointModelGroup::interpolate(const double* from, const double* to, double t, double* state) const
 {
+  if (has_flat_position_bounds_)
+  {
+    updateFlatPositionBounds();
+    interpolateFlat(from, to, t, state);
+    return;
+  }
+
   // we interpolate values only for active joint models (non-mimic)
   for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
   {
@@ -473,6 +583,29 @@ void JointModelGroup::interpolate(const double* from, const double* to, double t
   updateMimicJoints(state);
 }
 
+void JointModelGroup::interpolate(const double* from, const double* to, const double* t, std::size_t count,
+                                  double* states) const
+{
+  if (has_flat_position_bounds_)
+  {
+    updateFlatPositionBounds();
+    for (std::size_t k = 0; k < count; ++k)
+      interpolateFlat(from, to, t[k], states + k * variable_count_);
+    return;
+  }
+
+  // joint by joint, so each joint is dispatched once for the whole batch
+  for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
+  {
+    const JointModel* joint_model = active_joint_model_vector_[i];
+    const int index = active_joint_model_start_index_[i];
+    for (std::size_t k = 0; k < count; ++k)
+      joint_model->interpolate(from + index, to + index, t[k], states + k * variable_count_ + index);
+  }
+  for (std::size_t k = 0; k < count; ++k)
+    updateMimicJoints(states + k * variable_count_);
+}
+
 void JointModelGroup::updateMimicJoints(double* values) const
 {
   // update mimic (only local joints as we are dealing with a local group state)
@@ -0,0 +1,263 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_model/mesh_snapshot.h>
+#include <moveit/utils/mapped_file.h>
+#include <geometric_shapes/shape_operations.h>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace moveit
+{
+namespace core
+{
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_robot_model.mesh_snapshot");
+
+namespace
+{
+// Layout of a snapshot file: the header below, followed by num_meshes records. Each record is a MeshRecordHeader, the
+// resource name padded to a multiple of 8 bytes, 3 * vertex_count vertex coordinates (double), 3 * triangle_count
+// vertex indices (uint32, padded to a multiple of 8 bytes) and, if flagged, 3 * triangle_count triangle normal and
+// 3 * vertex_count vertex normal coordinates (double).
+constexpr char SNAPSHOT_FILE_MAGIC[8] = { 'M', 'V', 'M', 'E', 'S', 'H', 'E', 'S' };
+constexpr std::uint32_t SNAPSHOT_FILE_VERSION = 1;
+constexpr std::uint32_t HAS_TRIANGLE_NORMALS = 1;
+constexpr std::uint32_t HAS_VERTEX_NORMALS = 2;
+
+struct SnapshotFileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t num_meshes;
+  std::uint64_t key;
+};
+
+struct MeshRecordHeader
+{
+  double scale[3];
+  std::uint32_t resource_size;
+  std::uint32_t flags;
+  std::uint32_t vertex_count;
+  std::uint32_t triangle_count;
+};
+
+std::size_t padded(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+void writePadded(std::ofstream& out, const void* data, std::size_t size)
+{
+  static const char ZEROS[8] = {};
+  out.write(static_cast<const char*>(data), size);
+  out.write(ZEROS, padded(size) - size);
+}
+
+// Copy \e size bytes at \e offset of \e file to \e data, advancing \e offset past the padding. Return false if the
+// file is too short.
+bool readPadded(const MappedFile& file, std::size_t& offset, void* data, std::size_t size)
+{
+  if (file.size() < offset || file.size() - offset < padded(size))
+    return false;
+  memcpy(data, file.begin() + offset, size);
+  offset += padded(size);
+  return true;
+}
+
+// Make \e array hold \e count values read from \e file, or release it if the file does not store them
+bool readArray(const MappedFile& file, std::size_t& offset, double*& array, std::size_t count, bool stored)
+{
+  if (!stored)
+  {
+    delete[] array;
+    array = nullptr;
+    return true;
+  }
+  if (!array)
+    array = new double[count];
+  return readPadded(file, offset, array, count * sizeof(double));
+}
+}  // namespace
+
+MeshSnapshot::MeshSnapshot(std::uint64_t key) : key_(key)
+{
+}
+
+std::uint64_t MeshSnapshot::hashString(const std::string& data, std::uint64_t seed)
+{
+  std::uint64_t hash = seed;
+  for (const char c : data)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+shapes::ShapePtr MeshSnapshot::getMesh(const std::string& resource, const Eigen::Vector3d& scale)
+{
+  const MeshKey mesh_key(resource, scale.x(), scale.y(), scale.z());
+  auto it = meshes_.find(mesh_key);
+  if (it == meshes_.end())
+  {
+    std::shared_ptr<const shapes::Mesh> mesh(shapes::createMeshFromResource(resource, scale));
+    if (!mesh)
+      return shapes::ShapePtr();
+    it = meshes_.emplace(mesh_key, mesh).first;
+    modified_ = true;
+  }
+  // hand out copies, so the meshes kept for saving cannot be changed by the model
+  return shapes::ShapePtr(it->second->clone());
+}
+
+bool MeshSnapshot::load(const std::string& filename)
+{
+  const MappedFile file(filename);
+  SnapshotFileHeader header;
+  if (file.size() < sizeof(header))
+    return false;
+  memcpy(&header, file.begin(), sizeof(header));
+  if (memcmp(header.magic, SNAPSHOT_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != SNAPSHOT_FILE_VERSION || header.key != key_)
+  {
+    RCLCPP_DEBUG(LOGGER, "Mesh snapshot '%s' is not a version %u snapshot of this robot description",
+                 filename.c_str(), SNAPSHOT_FILE_VERSION);
+    return false;
+  }
+
+  std::map<MeshKey, std::shared_ptr<const shapes::Mesh>> meshes;
+  std::size_t offset = sizeof(header);
+  for (std::uint32_t i = 0; i < header.num_meshes; ++i)
+  {
+    MeshRecordHeader record;
+    std::string resource;
+    bool ok = readPadded(file, offset, &record, sizeof(record));
+    if (ok)
+    {
+      resource.resize(record.resource_size);
+      ok = readPadded(file, offset, resource.data(), resource.size());
+    }
+    // check the sizes before allocating, so a corrupt header cannot make us allocate huge arrays
+    const std::size_t remaining = file.size() - std::min(offset, file.size());
+    if (!ok || remaining / (3 * sizeof(double)) < record.vertex_count ||
+        remaining / (3 * sizeof(std::uint32_t)) < record.triangle_count)
+    {
+      RCLCPP_ERROR(LOGGER, "Mesh snapshot '%s' is truncated or corrupt", filename.c_str());
+      return false;
+    }
+
+    auto mesh = std::make_shared<shapes::Mesh>(record.vertex_count, record.triangle_count);
+    ok = readPadded(file, offset, mesh->vertices, 3 * record.vertex_count * sizeof(double)) &&
+         readPadded(file, offset, mesh->triangles, 3 * record.triangle_count * sizeof(std::uint32_t)) &&
+         readArray(file, offset, mesh->triangle_normals, 3 * record.triangle_count,
+                   record.flags & HAS_TRIANGLE_NORMALS) &&
+         readArray(file, offset, mesh->vertex_normals, 3 * record.vertex_count, record.flags & HAS_VERTEX_NORMALS);
+    if (!ok)
+    {
+      RCLCPP_ERROR(LOGGER, "Mesh snapshot '%s' is truncated or corrupt", filename.c_str());
+      return false;
+    }
+    meshes[MeshKey(resource, record.scale[0], record.scale[1], record.scale[2])] = mesh;
+  }
+  if (offset != file.size())
+  {
+    RCLCPP_ERROR(LOGGER, "Mesh snapshot '%s' is corrupt", filename.c_str());
+    return false;
+  }
+
+  meshes_.swap(meshes);
+  modified_ = false;
+  return true;
+}
+
+bool MeshSnapshot::save(const std::string& filename) const
+{
+  SnapshotFileHeader header{};
+  memcpy(header.magic, SNAPSHOT_FILE_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_FILE_VERSION;
+  header.num_meshes = meshes_.size();
+  header.key = key_;
+
+  // write to a temporary file first, so processes reading the old file never see a partial one
+  const std::string tmp_filename = filename + ".tmp" + std::to_string(processId());
+  {
+    std::ofstream out(tmp_filename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (!out.good())
+      return false;
+    writePadded(out, &header, sizeof(header));
+    for (const auto& [mesh_key, mesh] : meshes_)
+    {
+      MeshRecordHeader record{};
+      const std::string& resource = std::get<0>(mesh_key);
+      record.scale[0] = std::get<1>(mesh_key);
+      record.scale[1] = std::get<2>(mesh_key);
+      record.scale[2] = std::get<3>(mesh_key);
+      record.resource_size = resource.size();
+      record.flags =
+          (mesh->triangle_normals ? HAS_TRIANGLE_NORMALS : 0) | (mesh->vertex_normals ? HAS_VERTEX_NORMALS : 0);
+      record.vertex_count = mesh->vertex_count;
+      record.triangle_count = mesh->triangle_count;
+
+      writePadded(out, &record, sizeof(record));
+      writePadded(out, resource.data(), resource.size());
+      writePadded(out, mesh->vertices, 3 * mesh->vertex_count * sizeof(double));
+      writePadded(out, mesh->triangles, 3 * mesh->triangle_count * sizeof(std::uint32_t));
+      if (mesh->triangle_normals)
+        writePadded(out, mesh->triangle_normals, 3 * mesh->triangle_count * sizeof(double));
+      if (mesh->vertex_normals)
+        writePadded(out, mesh->vertex_normals, 3 * mesh->vertex_count * sizeof(double));
+    }
+    if (!out.good())
+    {
+      out.close();
+      std::filesystem::remove(tmp_filename);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_filename, filename, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tmp_filename, ec);
+    return false;
+  }
+  return true;
+}
+}  // namespace core
+}  // namespace moveit
@@ -59,6 +59,17 @@ RobotModel::RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const sr
   buildModel(*urdf_model, *srdf_model);
 }
 
+RobotModel::RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const srdf::ModelConstSharedPtr& srdf_model,
+                       const MeshSnapshotPtr& mesh_snapshot)
+{
+  root_joint_ = nullptr;
+  urdf_ = urdf_model;
+  srdf_ = srdf_model;
+  mesh_snapshot_ = mesh_snapshot;
+  buildModel(*urdf_model, *srdf_model);
+  mesh_snapshot_.reset();
+}
+
 RobotModel::~RobotModel()
 {
   for (std::pair<const std::string, JointModelGroup*>& it : joint_model_group_map_)
@@ -102,6 +113,7 @@ void RobotModel::buildModel(const urdf::ModelInterface& urdf_model, const srdf::
 
     RCLCPP_DEBUG(LOGGER, "... computing joint indexing");
     buildJointInfo();
+    buildModelHash();
 
     if (link_models_with_collision_geometry_vector_.empty())
     {
@@ -849,6 +861,7 @@ JointModel* RobotModel::buildRecursive(LinkModel* parent, const urdf::Link* urdf
   // bookkeeping for the joint
   joint_model_vector_.push_back(joint);
   joint_model_map_[joint->getName()] = joint;
+  joint_models_by_interned_name_.set(InternedName(joint->getName()), joint);
   joint_model_vector_const_.push_back(joint);
   joint_model_names_vector_.push_back(joint->getName());
   joint->setParentLinkModel(parent);
@@ -860,6 +873,7 @@ JointModel* RobotModel::buildRecursive(LinkModel* parent, const urdf::Link* urdf
 
   // bookkeeping for the link
   link_model_map_[joint->getChildLinkModel()->getName()] = link;
+  link_models_by_interned_name_.set(InternedName(link->getName()), link);
   link_model_vector_.push_back(link);
   link_model_vector_const_.push_back(link);
   link_model_names_vector_.push_back(link->getName());
@@ -1270,6 +1284,8 @@ shapes::ShapePtr RobotModel::constructShape(const urdf::Geometry* geom)
       if (!mesh->filename.empty())
       {
         Eigen::Vector3d scale(mesh->scale.x, mesh->scale.y, mesh->scale.z);
+        if (mesh_snapshot_)
+          return mesh_snapshot_->getMesh(mesh->filename, scale);
         shapes::Mesh* m = shapes::createMeshFromResource(mesh->filename, scale);
         new_shape = m;
       }
@@ -1302,6 +1318,14 @@ const JointModel* RobotModel::getJointModel(const std::string& name) const
   return nullptr;
 }
 
+const JointModel* RobotModel::getJointModel(const InternedName& name) const
+{
+  if (const JointModel* joint = joint_models_by_interned_name_.get(name))
+    return joint;
+  RCLCPP_ERROR(LOGGER, "Joint '%s' not found in model '%s'", name.str().c_str(), model_name_.c_str());
+  return nullptr;
+}
+
 const JointModel* RobotModel::getJointModel(size_t index) const
 {
   if (index >= joint_model_vector_.size())
@@ -1338,6 +1362,16 @@ const LinkModel* RobotModel::getLinkModel(size_t index) const
   return link_model_vector_[index];
 }
 
+const LinkModel* RobotModel::getLinkModel(const InternedName& name, bool* has_link) const
+{
+  const LinkModel* link = link_models_by_interned_name_.get(name);
+  if (has_link)
+    *has_link = link != nullptr;
+  else if (!link)
+    RCLCPP_ERROR(LOGGER, "Link '%s' not found in model '%s'", name.str().c_str(), model_name_.c_str());
+  return link;
+}
+
 LinkModel* RobotModel::getLinkModel(const std::string& name, bool* has_link)
 {
   if (has_link)
@@ -1439,6 +1473,33 @@ size_t RobotModel::getVariableIndex(const std::string& variable) const
   return it->second;
 }
 
+VariableLayoutConstPtr RobotModel::getVariableLayout(const std::vector<std::string>& names) const
+{
+  // the number of distinct layouts is small in practice, bound it in case names are made up per message
+  static const std::size_t MAX_VARIABLE_LAYOUTS = 1024;
+
+  std::size_t hash = names.size();
+  for (const std::string& name : names)
+    hash ^= std::hash<std::string>()(name) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+  {
+    std::lock_guard<std::mutex> lock(variable_layouts_lock_);
+    auto range = variable_layouts_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (it->second->getNames() == names)
+        return it->second;
+    }
+  }
+
+  auto layout = std::make_shared<const VariableLayout>(*this, names);
+  std::lock_guard<std::mutex> lock(variable_layouts_lock_);
+  if (variable_layouts_.size() >= MAX_VARIABLE_LAYOUTS)
+    variable_layouts_.clear();
+  variable_layouts_.emplace(hash, layout);
+  return layout;
+}
+
 double RobotModel::getMaximumExtent(const JointBoundsVector& active_joint_bounds) const
 {
   double max_distance = 0.0;
@@ -1504,6 +1565,119 @@ void RobotModel::interpolate(const double* from, const double* to, double t, dou
   updateMimicJoints(state);
 }
 
+void RobotModel::interpolate(const double* from, const double* to, const double* t, std::size_t count,
+                             double* states) const
+{
+  for (std::size_t k = 0; k < count; ++k)
+    moveit::core::checkInterpolationParamBounds(LOGGER, t[k]);
+  for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
+  {
+    const JointModel* joint_model = active_joint_model_vector_[i];
+    const int index = active_joint_model_start_index_[i];
+    for (std::size_t k = 0; k < count; ++k)
+      joint_model->interpolate(from + index, to + index, t[k], states + k * variable_count_ + index);
+  }
+  for (std::size_t k = 0; k < count; ++k)
+    updateMimicJoints(states + k * variable_count_);
+}
+
+void RobotModel::buildModelHash()
+{
+  // FNV-1a over the values the FK of the model depends on, in a fixed order
+  std::uint64_t hash = 14695981039346656037ULL;
+  auto add = [&hash](const void* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      hash ^= static_cast<const unsigned char*>(data)[i];
+      hash *= 1099511628211ULL;
+    }
+  };
+  auto add_int = [&add](std::int64_t value) { add(&value, sizeof(value)); };
+
+  add_int(static_cast<std::int64_t>(variable_count_));
+  add_int(static_cast<std::int64_t>(link_model_vector_.size()));
+  for (const LinkModel* link : link_model_vector_)
+  {
+    const JointModel* joint = link->getParentJointModel();
+    add(link->getName().data(), link->getName().size());
+    add_int(link->getParentLinkModel() ? link->getParentLinkModel()->getLinkIndex() : -1);
+    add_int(link->jointOriginTransformIsIdentity());
+    add(link->getJointOriginTransform().matrix().data(), 16 * sizeof(double));
+    add_int(joint->getType());
+    add_int(joint->getFirstVariableIndex());
+    if (joint->getType() == JointModel::REVOLUTE)
+      add(static_cast<const RevoluteJointModel*>(joint)->getAxis().data(), 3 * sizeof(double));
+    else if (joint->getType() == JointModel::PRISMATIC)
+      add(static_cast<const PrismaticJointModel*>(joint)->getAxis().data(), 3 * sizeof(double));
+  }
+  model_hash_ = hash;
+
+  fk_kernel_ = findFKKernel(model_hash_);
+  if (fk_kernel_)
+    RCLCPP_INFO(LOGGER, "Using generated forward kinematics for robot model '%s'", model_name_.c_str());
+}
+
+void RobotModel::computeLinkTransformsBatch(const double* states, std::size_t count,
+                                            Eigen::Isometry3d* link_transforms) const
+{
+  // links are stored in depth-first order, so the poses of a parent link are always computed before its children.
+  // Only the affine part is written below, so the bottom row of the caller-owned buffer is set up front.
+  for (std::size_t i = 0, n = count * link_model_vector_.size(); i < n; ++i)
+    link_transforms[i].makeAffine();
+
+  Eigen::Isometry3d joint_transform;
+  for (const LinkModel* link : link_model_vector_)
+  {
+    Eigen::Isometry3d* poses = link_transforms + link->getLinkIndex() * count;
+    const LinkModel* parent = link->getParentLinkModel();
+    const Eigen::Isometry3d* parent_poses = parent ? link_transforms + parent->getLinkIndex() * count : nullptr;
+    const Eigen::Isometry3d& origin = link->getJointOriginTransform();
+
+    if (link->parentJointIsFixed())
+    {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        if (parent_poses)
+        {
+          poses[i].affine().noalias() = parent_poses[i].affine() * origin.matrix();
+        }
+        else
+        {
+          poses[i] = origin;
+        }
+      }
+      continue;
+    }
+
+    const JointModel* joint = link->getParentJointModel();
+    const double* values = states + joint->getFirstVariableIndex();
+    const bool identity_origin = link->jointOriginTransformIsIdentity();
+    for (std::size_t i = 0; i < count; ++i, values += variable_count_)
+    {
+      joint->computeTransform(values, joint_transform);
+      if (parent_poses)
+      {
+        if (identity_origin)
+        {
+          poses[i].affine().noalias() = parent_poses[i].affine() * joint_transform.matrix();
+        }
+        else
+        {
+          poses[i].affine().noalias() = parent_poses[i].affine() * origin.matrix() * joint_transform.matrix();
+        }
+      }
+      else if (identity_origin)
+      {
+        poses[i] = joint_transform;
+      }
+      else
+      {
+        poses[i].affine().noalias() = origin.affine() * joint_transform.matrix();
+      }
+    }
+  }
+}
+
 void RobotModel::setKinematicsAllocators(const std::map<std::string, SolverAllocatorFn>& allocators)
 {
   // we first set all the "simple" allocators -- where a group has one IK solver
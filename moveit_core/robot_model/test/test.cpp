@@ -35,7 +35,10 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/robot_model/robot_model.h>
+#include <moveit/utils/mapped_file.h>
 #include <urdf_parser/urdf_parser.h>
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
 
@@ -77,7 +80,15 @@ TEST_F(LoadPlanningModelsPr2, Model)
   for (std::size_t i = 0; i < links.size(); ++i)
   {
     ASSERT_EQ(links[i]->getLinkIndex(), i);
+    ASSERT_EQ(robot_model_->getLinkModel(moveit::core::InternedName(links[i]->getName())), links[i]);
   }
+  for (const moveit::core::JointModel* joint : joints)
+    ASSERT_EQ(robot_model_->getJointModel(moveit::core::InternedName(joint->getName())), joint);
+
+  bool has_link = true;
+  EXPECT_EQ(robot_model_->getLinkModel(moveit::core::InternedName("no_such_link"), &has_link), nullptr);
+  EXPECT_FALSE(has_link);
+  EXPECT_FALSE(robot_model_->hasJointModel(moveit::core::InternedName("no_such_joint")));
 
   // This joint has effort and velocity limits defined in the URDF. Nothing else.
   const std::string joint_name = "fl_caster_rotation_joint";
@@ -92,6 +103,156 @@ TEST_F(LoadPlanningModelsPr2, Model)
   EXPECT_FALSE(bounds.jerk_bounded_);
 }
 
+TEST_F(LoadPlanningModelsPr2, MeshSnapshot)
+{
+  const urdf::ModelInterfaceSharedPtr urdf_model = moveit::core::loadModelInterface("pr2");
+  const srdf::ModelSharedPtr srdf_model = moveit::core::loadSRDFModel("pr2");
+  const std::string filename =
+      (std::filesystem::temp_directory_path() / ("test_mesh_snapshot_" + std::to_string(moveit::core::processId())))
+          .string();
+
+  // building a model fills the snapshot with the decoded meshes
+  auto snapshot = std::make_shared<moveit::core::MeshSnapshot>(42);
+  moveit::core::RobotModel model(urdf_model, srdf_model, snapshot);
+  EXPECT_TRUE(snapshot->isModified());
+  ASSERT_GT(snapshot->size(), 0u);
+  ASSERT_TRUE(snapshot->save(filename));
+
+  // a snapshot of a different robot description is not loaded
+  moveit::core::MeshSnapshot other(43);
+  EXPECT_FALSE(other.load(filename));
+  EXPECT_EQ(other.size(), 0u);
+
+  auto loaded = std::make_shared<moveit::core::MeshSnapshot>(42);
+  ASSERT_TRUE(loaded->load(filename));
+  EXPECT_EQ(loaded->size(), snapshot->size());
+  std::filesystem::remove(filename);
+
+  // all meshes are taken from the loaded snapshot
+  moveit::core::RobotModel model_from_snapshot(urdf_model, srdf_model, loaded);
+  EXPECT_FALSE(loaded->isModified());
+  for (const moveit::core::LinkModel* link : robot_model_->getLinkModels())
+  {
+    const moveit::core::LinkModel* link_from_snapshot = model_from_snapshot.getLinkModel(link->getName());
+    const auto& shapes = link->getShapes();
+    ASSERT_EQ(shapes.size(), link_from_snapshot->getShapes().size());
+    for (std::size_t i = 0; i < shapes.size(); ++i)
+    {
+      ASSERT_EQ(shapes[i]->type, link_from_snapshot->getShapes()[i]->type);
+      if (shapes[i]->type != shapes::MESH)
+        continue;
+      const auto* mesh = static_cast<const shapes::Mesh*>(shapes[i].get());
+      const auto* mesh_from_snapshot = static_cast<const shapes::Mesh*>(link_from_snapshot->getShapes()[i].get());
+      ASSERT_EQ(mesh->vertex_count, mesh_from_snapshot->vertex_count);
+      ASSERT_EQ(mesh->triangle_count, mesh_from_snapshot->triangle_count);
+      EXPECT_TRUE(std::equal(mesh->vertices, mesh->vertices + 3 * mesh->vertex_count, mesh_from_snapshot->vertices));
+      EXPECT_TRUE(
+          std::equal(mesh->triangles, mesh->triangles + 3 * mesh->triangle_count, mesh_from_snapshot->triangles));
+    }
+  }
+}
+
+TEST_F(LoadPlanningModelsPr2, VariableLayout)
+{
+  const std::vector<std::string> names = { "r_elbow_flex_joint", "r_shoulder_pan_joint", "world_joint/x" };
+  const moveit::core::VariableLayoutConstPtr layout = robot_model_->getVariableLayout(names);
+  ASSERT_EQ(layout->size(), names.size());
+  for (std::size_t i = 0; i < names.size(); ++i)
+    EXPECT_EQ(layout->getIndices()[i], static_cast<int>(robot_model_->getVariableIndex(names[i])));
+  EXPECT_EQ(layout->getJoints().size(), names.size());
+
+  // the same names share the cached layout, other names get another one
+  EXPECT_EQ(robot_model_->getVariableLayout(names), layout);
+  const std::vector<std::string> reordered = { "r_shoulder_pan_joint", "r_elbow_flex_joint", "world_joint/x" };
+  EXPECT_NE(robot_model_->getVariableLayout(reordered), layout);
+
+  // the variables of a multi-dof joint share the joint
+  EXPECT_EQ(robot_model_->getVariableLayout({ "world_joint/x", "world_joint/y" })->getJoints().size(), 1u);
+
+  EXPECT_THROW(robot_model_->getVariableLayout({ "no_such_joint" }), moveit::Exception);
+}
+
+TEST_F(LoadPlanningModelsPr2, GroupPositionBounds)
+{
+  const moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup("right_arm");
+  ASSERT_TRUE(jmg);
+  ASSERT_FALSE(jmg->getContinuousJointModels().empty());
+
+  // a copy of the bounds takes the per-joint path, which the flat bounds of the group must agree with
+  const moveit::core::JointBoundsVector bounds_copy = jmg->getActiveJointModelsBounds();
+  auto check = [&](const std::vector<double>& values) {
+    EXPECT_EQ(jmg->satisfiesPositionBounds(values.data()), jmg->satisfiesPositionBounds(values.data(), bounds_copy));
+    EXPECT_EQ(jmg->satisfiesPositionBounds(values.data(), 0.1),
+              jmg->satisfiesPositionBounds(values.data(), bounds_copy, 0.1));
+    std::vector<double> flat = values;
+    std::vector<double> per_joint = values;
+    EXPECT_EQ(jmg->enforcePositionBounds(flat.data()), jmg->enforcePositionBounds(per_joint.data(), bounds_copy));
+    EXPECT_EQ(flat, per_joint);
+  };
+
+  random_numbers::RandomNumberGenerator rng(42);
+  std::vector<double> values(jmg->getVariableCount());
+  for (int i = 0; i < 100; ++i)
+  {
+    for (double& value : values)
+      value = rng.uniformReal(-10.0, 10.0);
+    check(values);
+  }
+  jmg->getVariableDefaultPositions(values);
+  check(values);
+  EXPECT_TRUE(jmg->satisfiesPositionBounds(values.data()));
+
+  // bounds changed after the model was built are picked up
+  moveit::core::JointModel* elbow = model->getJointModel("r_elbow_flex_joint");
+  moveit::core::VariableBounds elbow_bounds = elbow->getVariableBounds()[0];
+  elbow_bounds.max_position_ = elbow_bounds.min_position_ + 0.01;
+  values[jmg->getVariableGroupIndex("r_elbow_flex_joint")] = elbow_bounds.min_position_ + 0.02;
+  EXPECT_TRUE(jmg->satisfiesPositionBounds(values.data()));
+  elbow->setVariableBounds("r_elbow_flex_joint", elbow_bounds);
+  EXPECT_FALSE(jmg->satisfiesPositionBounds(values.data()));
+  check(values);
+}
+
+TEST_F(LoadPlanningModelsPr2, GroupInterpolationAndDistance)
+{
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup("right_arm");
+  ASSERT_TRUE(jmg);
+  ASSERT_FALSE(jmg->getContinuousJointModels().empty());
+  const std::vector<const moveit::core::JointModel*>& joints = jmg->getActiveJointModels();
+  ASSERT_EQ(joints.size(), jmg->getVariableCount());
+
+  random_numbers::RandomNumberGenerator rng(42);
+  const std::size_t n = jmg->getVariableCount();
+  std::vector<double> from(n), to(n), state(n);
+  const std::vector<double> t = { 0.0, 0.1, 0.5, 0.9, 1.0 };
+  std::vector<double> batch(t.size() * n);
+  for (int trial = 0; trial < 100; ++trial)
+  {
+    jmg->getVariableRandomPositions(rng, from);
+    jmg->getVariableRandomPositions(rng, to);
+
+    // the group kernels agree with the joint models, including the wrap-around of continuous joints
+    double expected_distance = 0.0;
+    for (std::size_t i = 0; i < n; ++i)
+      expected_distance += joints[i]->getDistanceFactor() * joints[i]->distance(&from[i], &to[i]);
+    EXPECT_NEAR(jmg->distance(from.data(), to.data()), expected_distance, 1e-12);
+
+    jmg->interpolate(from.data(), to.data(), t.data(), t.size(), batch.data());
+    for (std::size_t k = 0; k < t.size(); ++k)
+    {
+      jmg->interpolate(from.data(), to.data(), t[k], state.data());
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        double expected;
+        joints[i]->interpolate(&from[i], &to[i], t[k], &expected);
+        EXPECT_NEAR(state[i], expected, 1e-12);
+        EXPECT_EQ(batch[k * n + i], state[i]);
+      }
+    }
+  }
+}
+
 TEST(SiblingAssociateLinks, SimpleYRobot)
 {
   // base_link - a - b - c  //
@@ -0,0 +1,93 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/robot_model/fk_kernel.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <gtest/gtest.h>
+
+// test_fk_kernel_pr2, linked into this test, holds the kernel generated for the PR2 test model
+
+TEST(FKKernel, MatchesGenericForwardKinematics)
+{
+  const moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  const moveit::core::FKKernel* kernel = model->getFKKernel();
+  ASSERT_TRUE(kernel);
+  EXPECT_EQ(kernel->model_hash, model->getModelHash());
+
+  const std::size_t link_count = model->getLinkModelCount();
+  const std::size_t joint_count = model->getJointModelCount();
+  EigenSTL::vector_Isometry3d expected_links(link_count, Eigen::Isometry3d::Identity());
+  EigenSTL::vector_Isometry3d links(link_count, Eigen::Isometry3d::Identity());
+  EigenSTL::vector_Isometry3d joints(joint_count, Eigen::Isometry3d::Identity());
+
+  random_numbers::RandomNumberGenerator rng(42);
+  std::vector<double> positions(model->getVariableCount());
+  for (int trial = 0; trial < 100; ++trial)
+  {
+    model->getVariableRandomPositions(rng, positions);
+    model->computeLinkTransformsBatch(positions.data(), 1, expected_links.data());
+    kernel->compute(positions.data(), joints.data(), links.data());
+
+    for (const moveit::core::LinkModel* link : model->getLinkModels())
+    {
+      EXPECT_TRUE(links[link->getLinkIndex()].isApprox(expected_links[link->getLinkIndex()], 1e-10))
+          << link->getName();
+    }
+    for (const moveit::core::JointModel* joint : model->getJointModels())
+    {
+      if (joint->getVariableCount() == 0)
+        continue;
+      Eigen::Isometry3d expected;
+      joint->computeTransform(&positions[joint->getFirstVariableIndex()], expected);
+      EXPECT_TRUE(joints[joint->getJointIndex()].isApprox(expected, 1e-10)) << joint->getName();
+    }
+  }
+}
+
+TEST(FKKernel, OnlyUsedForTheSameModel)
+{
+  // the panda model was not generated, and the hash tells the models apart
+  const moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("panda");
+  EXPECT_EQ(model->getFKKernel(), nullptr);
+  EXPECT_NE(model->getModelHash(), moveit::core::loadTestingRobotModel("pr2")->getModelHash());
+  EXPECT_EQ(model->getModelHash(), moveit::core::loadTestingRobotModel("panda")->getModelHash());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
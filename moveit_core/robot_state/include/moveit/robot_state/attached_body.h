@@ -38,11 +38,14 @@
 
 #include <moveit/robot_model/link_model.h>
 #include <moveit/transforms/transforms.h>
+#include <moveit/utils/memory_usage.h>
 #include <geometric_shapes/check_isometry.h>
 #include <eigen_stl_containers/eigen_stl_containers.h>
 #include <trajectory_msgs/msg/joint_trajectory.hpp>
+#include <atomic>
 #include <set>
 #include <functional>
+#include <mutex>
 
 namespace moveit
 {
@@ -51,6 +54,9 @@ namespace core
 class AttachedBody;
 typedef std::function<void(AttachedBody* body, bool attached)> AttachedBodyCallback;
 
+/** \brief The approximate number of bytes held by \e shape, including its vertex data or octree */
+std::size_t getShapeMemoryUsage(const shapes::Shape& shape);
+
 /** @brief Object defining bodies that can be attached to robot links.
  *
  * This is useful when handling objects picked up by the robot. */
@@ -68,6 +74,9 @@ public:
                const std::set<std::string>& touch_links, const trajectory_msgs::msg::JointTrajectory& detach_posture,
                const moveit::core::FixedTransformsMap& subframe_poses = moveit::core::FixedTransformsMap());
 
+  /** \brief Copy an attached body. The copy computes its global subframe transforms independently. */
+  AttachedBody(const AttachedBody& other);
+
   ~AttachedBody();
 
   /** \brief Get the name of the attached body */
@@ -140,11 +149,9 @@ public:
     return subframe_poses_;
   }
 
-  /** \brief Get subframes of this object (in the world frame) */
-  const moveit::core::FixedTransformsMap& getGlobalSubframeTransforms() const
-  {
-    return global_subframe_poses_;
-  }
+  /** \brief Get subframes of this object (in the world frame). They are computed on the first request after the
+   *  parent link moved. */
+  const moveit::core::FixedTransformsMap& getGlobalSubframeTransforms() const;
 
   /** \brief Set all subframes of this object.
    *
@@ -158,6 +165,8 @@ public:
       ASSERT_ISOMETRY(t.second)  // unsanitized input, could contain a non-isometry
     }
     subframe_poses_ = subframe_poses;
+    global_subframe_poses_.poses = subframe_poses;
+    global_subframe_poses_.valid = false;
   }
 
   /** \brief Get the fixed transform to a named subframe on this body (relative to the body's pose)
@@ -175,6 +184,7 @@ public:
   const Eigen::Isometry3d& getSubframeTransformInLinkFrame(const std::string& frame_name, bool* found = nullptr) const;
 
   /** \brief Get the fixed transform to a named subframe on this body, relative to the world frame.
+   * The subframe transforms are computed on the first request after the parent link moved.
    * The frame_name needs to have the object's name prepended (e.g. "screwdriver/tip" returns true if the object's
    * name is "screwdriver"). Returns an identity transform if frame_name is unknown (and set found to false).
    * The returned transform is guaranteed to be a valid isometry. */
@@ -199,10 +209,34 @@ public:
   /** \brief Set the scale for the shapes of this attached object */
   void setScale(double scale);
 
-  /** \brief Recompute global_collision_body_transform given the transform of the parent link */
+  /** \brief Recompute global_collision_body_transform given the transform of the parent link. Nothing is recomputed
+   *  if the parent link did not move since the last call; the global subframe transforms are only invalidated. */
   void computeTransform(const Eigen::Isometry3d& parent_link_global_transform);
 
+  /** \brief Add the memory held by this body to \e usage. Shapes shared with other bodies or world objects are
+   *  counted once. */
+  void getMemoryUsage(MemoryUsage& usage) const;
+
 private:
+  /** \brief Global subframe transforms that are computed on request, possibly by several readers at once */
+  struct GlobalSubframePoses
+  {
+    GlobalSubframePoses(const FixedTransformsMap& subframe_poses) : poses(subframe_poses)
+    {
+    }
+
+    GlobalSubframePoses(const GlobalSubframePoses& other) : poses(other.poses), valid(other.valid.load())
+    {
+    }
+
+    FixedTransformsMap poses;
+    std::atomic<bool> valid{ false };
+    std::mutex lock;
+  };
+
+  /** \brief The global subframe transforms, recomputed first if the parent link moved */
+  const FixedTransformsMap& updatedGlobalSubframePoses() const;
+
   /** \brief The link that owns this attached body */
   const LinkModel* parent_link_model_;
 
@@ -215,6 +249,10 @@ private:
   /** \brief The transform from the model frame to the attached body's pose  */
   Eigen::Isometry3d global_pose_;
 
+  /** \brief The parent link transform global_pose_ was last computed for, valid if has_parent_transform_ */
+  Eigen::Isometry3d parent_link_global_transform_;
+  bool has_parent_transform_;
+
   /** \brief The geometries of the attached body */
   std::vector<shapes::ShapeConstPtr> shapes_;
 
@@ -238,7 +276,7 @@ private:
   moveit::core::FixedTransformsMap subframe_poses_;
 
   /** \brief Transforms to subframes on the object, relative to the model frame. */
-  moveit::core::FixedTransformsMap global_subframe_poses_;
+  mutable GlobalSubframePoses global_subframe_poses_;
 };
 }  // namespace core
 }  // namespace moveit
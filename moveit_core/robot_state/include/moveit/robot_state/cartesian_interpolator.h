@@ -90,6 +90,23 @@ struct MaxEEFStep
   double rotation;     // Radians
 };
 
+/** \brief Struct for containing the adaptive refinement of computeCartesianPath
+
+    The path is first sampled with the MaxEEFStep. Each step whose joint-space distance (RobotState::distance()) is
+    larger than \e max_joint_step is then divided into equal substeps, at most \e max_substeps of them, such that
+    the joints move about \e max_joint_step per substep. A coarse MaxEEFStep thus only needs fine sampling where the
+    joints move fast, e.g. close to singularities. Setting max_joint_step to zero disables the refinement. */
+struct AdaptiveEEFStep
+{
+  explicit AdaptiveEEFStep(double max_joint_step = 0.0, std::size_t max_substeps = 8)
+    : max_joint_step(max_joint_step), max_substeps(max_substeps)
+  {
+  }
+
+  double max_joint_step;
+  std::size_t max_substeps;
+};
+
 class CartesianInterpolator
 {
   // TODO(mlautman): Eventually, this planner should be moved out of robot_state
@@ -210,6 +227,23 @@ public:
       const kinematics::KinematicsBase::IKCostFn& cost_function = kinematics::KinematicsBase::IKCostFn(),
       const Eigen::Isometry3d& link_offset = Eigen::Isometry3d::Identity());
 
+  /** \brief Compute the sequence of joint values that correspond to a straight Cartesian path, for a particular frame,
+     refining the steps of \e max_step where the joint-space distance between them is large.
+
+     The substeps inserted by \e adaptive_step are solved together with KinematicsBase::searchPositionIKBatch(),
+     seeded with the joint values interpolated between the surrounding steps, so solvers supporting concurrent
+     queries solve them in parallel. \e validCallback is called on the calling thread only. Substeps the batch could
+     not solve, and all substeps if a \e cost_function is given or the link is not rigidly attached to the solver's
+     tip frame, are solved one after another as in the previous function. All other comments apply. */
+  static Percentage computeCartesianPath(
+      RobotState* start_state, const JointModelGroup* group, std::vector<std::shared_ptr<RobotState>>& traj,
+      const LinkModel* link, const Eigen::Isometry3d& target, bool global_reference_frame, const MaxEEFStep& max_step,
+      const AdaptiveEEFStep& adaptive_step, const JumpThreshold& jump_threshold,
+      const GroupStateValidityCallbackFn& validCallback = GroupStateValidityCallbackFn(),
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions(),
+      const kinematics::KinematicsBase::IKCostFn& cost_function = kinematics::KinematicsBase::IKCostFn(),
+      const Eigen::Isometry3d& link_offset = Eigen::Isometry3d::Identity());
+
   /** \brief Compute the sequence of joint values that perform a general Cartesian path.
 
      In contrast to the previous functions, the Cartesian path is specified as a set of \e waypoints to be sequentially
@@ -225,6 +259,17 @@ public:
       const kinematics::KinematicsBase::IKCostFn& cost_function = kinematics::KinematicsBase::IKCostFn(),
       const Eigen::Isometry3d& link_offset = Eigen::Isometry3d::Identity());
 
+  /** \brief Compute the sequence of joint values that perform a general Cartesian path, refining the steps between
+     the waypoints as described for \e adaptive_step above. All other comments apply. */
+  static Percentage computeCartesianPath(
+      RobotState* start_state, const JointModelGroup* group, std::vector<std::shared_ptr<RobotState>>& traj,
+      const LinkModel* link, const EigenSTL::vector_Isometry3d& waypoints, bool global_reference_frame,
+      const MaxEEFStep& max_step, const AdaptiveEEFStep& adaptive_step, const JumpThreshold& jump_threshold,
+      const GroupStateValidityCallbackFn& validCallback = GroupStateValidityCallbackFn(),
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions(),
+      const kinematics::KinematicsBase::IKCostFn& cost_function = kinematics::KinematicsBase::IKCostFn(),
+      const Eigen::Isometry3d& link_offset = Eigen::Isometry3d::Identity());
+
   /** \brief Tests joint space jumps of a trajectory.
 
      If \e jump_threshold_factor is non-zero, we test for relative jumps.
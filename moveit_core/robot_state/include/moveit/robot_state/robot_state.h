@@ -44,6 +44,7 @@
 #include <visualization_msgs/msg/marker_array.hpp>
 #include <std_msgs/msg/color_rgba.hpp>
 #include <geometry_msgs/msg/twist.hpp>
+#include <array>
 #include <cassert>
 
 #include <rclcpp/duration.hpp>
@@ -184,6 +185,9 @@ public:
   void setVariablePositions(const std::vector<std::string>& variable_names,
                             const std::vector<double>& variable_position);
 
+  /** \brief Set the positions of the variables in \e layout. \e variable_position is in the order of the layout. */
+  void setVariablePositions(const VariableLayout& layout, const std::vector<double>& variable_position);
+
   /** \brief Set the position of a single variable. An exception is thrown if the variable name is not known */
   void setVariablePosition(const std::string& variable, double value)
   {
@@ -278,6 +282,9 @@ public:
   void setVariableVelocities(const std::vector<std::string>& variable_names,
                              const std::vector<double>& variable_velocity);
 
+  /** \brief Set the velocities of the variables in \e layout. \e variable_velocity is in the order of the layout. */
+  void setVariableVelocities(const VariableLayout& layout, const std::vector<double>& variable_velocity);
+
   /** \brief Set the velocity of a variable. If an unknown variable name is specified, an exception is thrown. */
   void setVariableVelocity(const std::string& variable, double value)
   {
@@ -377,6 +384,10 @@ public:
   void setVariableAccelerations(const std::vector<std::string>& variable_names,
                                 const std::vector<double>& variable_acceleration);
 
+  /** \brief Set the accelerations of the variables in \e layout. \e variable_acceleration is in the order of the
+   * layout. */
+  void setVariableAccelerations(const VariableLayout& layout, const std::vector<double>& variable_acceleration);
+
   /** \brief Set the acceleration of a variable. If an unknown variable name is specified, an exception is thrown. */
   void setVariableAcceleration(const std::string& variable, double value)
   {
@@ -468,6 +479,9 @@ public:
   void setVariableEffort(const std::vector<std::string>& variable_names,
                          const std::vector<double>& variable_acceleration);
 
+  /** \brief Set the effort of the variables in \e layout. \e variable_effort is in the order of the layout. */
+  void setVariableEffort(const VariableLayout& layout, const std::vector<double>& variable_effort);
+
   /** \brief Set the effort of a variable. If an unknown variable name is specified, an exception is thrown. */
   void setVariableEffort(const std::string& variable, double value)
   {
@@ -1096,6 +1110,42 @@ public:
                                                              use_quaternion_representation);
   }
 
+  /** \brief Compute the Jacobian into a matrix of compile-time size, e.g. getJacobian<6, 7>() for a 7 DOF arm.
+   * Nothing is allocated, so this is suited for control loops that compute the Jacobian every cycle.
+   * \param group The group to compute the Jacobian for
+   * \param link The link model to compute the Jacobian for
+   * \param reference_point_position The reference point position (with respect to the link specified in link)
+   * \param jacobian The resultant jacobian, with the origin at the group root link. Rows is 6, or 7 for a
+   * quaternion representation. Cols must match the variable count of the group, unless it is Eigen::Dynamic.
+   * \return True if jacobian was successfully computed, false otherwise
+   */
+  template <int Rows, int Cols>
+  bool getJacobian(const JointModelGroup* group, const LinkModel* link, const Eigen::Vector3d& reference_point_position,
+                   Eigen::Matrix<double, Rows, Cols>& jacobian) const
+  {
+    static_assert(Rows == 6 || Rows == 7, "The Jacobian has 6 rows, or 7 with a quaternion representation");
+    if constexpr (Cols == Eigen::Dynamic)
+      jacobian.resize(Rows, group->getVariableCount());
+    return computeJacobian(group, link, reference_point_position, jacobian, Rows == 7);
+  }
+
+  /** \brief Compute the Jacobian into a matrix of compile-time size, e.g. getJacobian<6, 7>() for a 7 DOF arm.
+   * The link transforms are only updated if the state is dirty.
+   * \param group The group to compute the Jacobian for
+   * \param link The link model to compute the Jacobian for
+   * \param reference_point_position The reference point position (with respect to the link specified in link)
+   * \param jacobian The resultant jacobian, with the origin at the group root link. Rows is 6, or 7 for a
+   * quaternion representation. Cols must match the variable count of the group, unless it is Eigen::Dynamic.
+   * \return True if jacobian was successfully computed, false otherwise
+   */
+  template <int Rows, int Cols>
+  bool getJacobian(const JointModelGroup* group, const LinkModel* link, const Eigen::Vector3d& reference_point_position,
+                   Eigen::Matrix<double, Rows, Cols>& jacobian)
+  {
+    updateLinkTransforms();
+    return static_cast<const RobotState*>(this)->getJacobian(group, link, reference_point_position, jacobian);
+  }
+
   /** \brief Compute the Jacobian with reference to the last link of a specified group, and origin at the group root
    * link. If the group is not a chain, an exception is thrown.
    * \param group The group to compute the Jacobian for
@@ -1146,10 +1196,13 @@ public:
 
   void setVariableValues(const sensor_msgs::msg::JointState& msg)
   {
+    if (msg.position.empty() && msg.velocity.empty())
+      return;
+    const VariableLayoutConstPtr layout = robot_model_->getVariableLayout(msg.name);
     if (!msg.position.empty())
-      setVariablePositions(msg.name, msg.position);
+      setVariablePositions(*layout, msg.position);
     if (!msg.velocity.empty())
-      setVariableVelocities(msg.name, msg.velocity);
+      setVariableVelocities(*layout, msg.velocity);
   }
 
   /** \brief Set all joints to their default positions.
@@ -1713,6 +1766,10 @@ public:
 
   std::string getStateTreeString() const;
 
+  /** \brief Add the memory held by this state and its attached bodies to \e usage. Nothing is added if \e usage
+   *  already counted this state. The robot model is not counted. */
+  void getMemoryUsage(MemoryUsage& usage) const;
+
   /**
    * \brief Transform pose from the robot model's base frame to the reference frame of the IK solver
    * @param pose - the input to change
@@ -1730,24 +1787,72 @@ public:
   bool setToIKSolverFrame(Eigen::Isometry3d& pose, const std::string& ik_frame);
 
 private:
+  /** \brief The size of the block allocated by allocMemory() */
+  std::size_t getAllocatedBytes() const;
   void allocMemory();
   void initTransforms();
   void copyFrom(const RobotState& other);
 
+  /** \brief The roots of disjoint subtrees of the kinematic tree whose transforms are out of date */
+  struct DirtySubtrees
+  {
+    /** \brief Beyond this many subtrees, they are merged into their common root */
+    static constexpr std::size_t MAX_ROOTS = 4;
+
+    std::array<const JointModel*, MAX_ROOTS> roots;
+    std::size_t count = 0;
+  };
+
+  /** \brief Mark the subtree below \e joint as dirty in \e subtrees and merge it into their common root \e common_root.
+      Subtrees already covered by a dirty ancestor are not added, and subtrees below \e joint are dropped. */
+  void markDirtySubtree(const JointModel* joint, const JointModel*& common_root, DirtySubtrees& subtrees) const
+  {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < subtrees.count; ++i)
+    {
+      const JointModel* root = subtrees.roots[i];
+      const JointModel* common = robot_model_->getCommonRoot(root, joint);
+      if (common == root)  // already dirty
+        return;
+      if (common != joint)  // disjoint from joint; otherwise joint covers root
+        subtrees.roots[kept++] = root;
+    }
+    common_root = robot_model_->getCommonRoot(common_root, joint);
+    if (kept < DirtySubtrees::MAX_ROOTS)
+    {
+      subtrees.roots[kept++] = joint;
+      subtrees.count = kept;
+    }
+    else
+    {
+      subtrees.roots[0] = common_root;
+      subtrees.count = 1;
+    }
+  }
+
+  /** \brief Mark the link transforms below \e joint as dirty */
+  void markDirtyLinkTransforms(const JointModel* joint)
+  {
+    markDirtySubtree(joint, dirty_link_transforms_, dirty_link_subtrees_);
+  }
+
+  /** \brief Mark the collision body transforms below \e joint as dirty */
+  void markDirtyCollisionBodyTransforms(const JointModel* joint)
+  {
+    markDirtySubtree(joint, dirty_collision_body_transforms_, dirty_collision_body_subtrees_);
+  }
+
   void markDirtyJointTransforms(const JointModel* joint)
   {
     dirty_joint_transforms_[joint->getJointIndex()] = 1;
-    dirty_link_transforms_ =
-        dirty_link_transforms_ == nullptr ? joint : robot_model_->getCommonRoot(dirty_link_transforms_, joint);
+    markDirtyLinkTransforms(joint);
   }
 
   void markDirtyJointTransforms(const JointModelGroup* group)
   {
     for (const JointModel* jm : group->getActiveJointModels())
       dirty_joint_transforms_[jm->getJointIndex()] = 1;
-    dirty_link_transforms_ = dirty_link_transforms_ == nullptr ?
-                                 group->getCommonRoot() :
-                                 robot_model_->getCommonRoot(dirty_link_transforms_, group->getCommonRoot());
+    markDirtyLinkTransforms(group->getCommonRoot());
   }
 
   void markVelocity();
@@ -1776,8 +1881,14 @@ private:
     markDirtyJointTransforms(group);
   }
 
+  /** \brief Update the link transforms and the attached bodies below \e start */
   void updateLinkTransformsInternal(const JointModel* start);
 
+  /** \brief Fill \e jacobian, which must already have the size of the result, as for getJacobian() */
+  bool computeJacobian(const JointModelGroup* group, const LinkModel* link,
+                       const Eigen::Vector3d& reference_point_position, Eigen::Ref<Eigen::MatrixXd> jacobian,
+                       bool use_quaternion_representation) const;
+
   void getMissingKeys(const std::map<std::string, double>& variable_map,
                       std::vector<std::string>& missing_variables) const;
   void getStateTreeJointString(std::ostream& ss, const JointModel* jm, const std::string& pfx0, bool last) const;
@@ -1802,12 +1913,15 @@ private:
   bool has_acceleration_;
   bool has_effort_;
 
+  // common roots of all dirty subtrees, nullptr if nothing is dirty
   const JointModel* dirty_link_transforms_;
   const JointModel* dirty_collision_body_transforms_;
+  DirtySubtrees dirty_link_subtrees_;
+  DirtySubtrees dirty_collision_body_subtrees_;
 
   // All the following transform variables point into aligned memory in memory_
   // They are updated lazily, based on the flags in dirty_joint_transforms_
-  // resp. the pointers dirty_link_transforms_ and dirty_collision_body_transforms_
+  // resp. the subtrees dirty_link_subtrees_ and dirty_collision_body_subtrees_
   Eigen::Isometry3d* variable_joint_transforms_;         ///< Local transforms of all joints
   Eigen::Isometry3d* global_link_transforms_;            ///< Transforms from model frame to link frame for each link
   Eigen::Isometry3d* global_collision_body_transforms_;  ///< Transforms from model frame to collision bodies
@@ -0,0 +1,91 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/robot_state/robot_state.h>
+#include <cstddef>
+#include <memory>
+
+namespace moveit
+{
+namespace core
+{
+MOVEIT_CLASS_FORWARD(RobotStatePool);  // Defines RobotStatePoolPtr, ConstPtr, WeakPtr... etc
+
+/** \brief Hands out RobotStates of one RobotModel and recycles them when they are released.
+
+    Constructing a RobotState allocates its memory for variables and transforms. Producers of many short-lived
+    states, e.g. trajectory waypoints, can instead take them from a pool: states are created in slabs of
+    \e slab_size and return to the pool when the last RobotStatePtr to them is dropped, so that their memory is
+    reused. States may outlive the pool, and may be released from any thread. */
+class RobotStatePool
+{
+public:
+  explicit RobotStatePool(const RobotModelConstPtr& robot_model, std::size_t slab_size = 32);
+
+  RobotStatePool(const RobotStatePool&) = delete;
+  RobotStatePool& operator=(const RobotStatePool&) = delete;
+
+  const RobotModelConstPtr& getRobotModel() const
+  {
+    return robot_model_;
+  }
+
+  /** \brief Get a state with default variable values, no velocities, accelerations and efforts, and no attached
+      bodies */
+  RobotStatePtr allocate() const;
+
+  /** \brief Get a copy of \e state, which must be a state of the same robot model */
+  RobotStatePtr allocate(const RobotState& state) const;
+
+  /** \brief Make sure that at least \e count states are available without creating new ones */
+  void reserve(std::size_t count) const;
+
+  /** \brief The number of states that are in the pool, waiting to be handed out */
+  std::size_t getFreeCount() const;
+
+private:
+  struct Storage;
+
+  /** \brief Take a state from the pool, creating a new slab if it is empty */
+  RobotStatePtr take() const;
+
+  RobotModelConstPtr robot_model_;
+  std::size_t slab_size_;
+  std::shared_ptr<Storage> storage_;  // shared with the released states, which return to it
+};
+}  // namespace core
+}  // namespace moveit
@@ -37,6 +37,7 @@
 #include <moveit/robot_state/attached_body.h>
 #include <geometric_shapes/check_isometry.h>
 #include <geometric_shapes/shapes.h>
+#include <octomap/OcTree.h>
 
 namespace moveit
 {
@@ -50,6 +51,7 @@ AttachedBody::AttachedBody(const LinkModel* parent, const std::string& id, const
   : parent_link_model_(parent)
   , id_(id)
   , pose_(pose)
+  , has_parent_transform_(false)
   , shapes_(shapes)
   , shape_poses_(shape_poses)
   , touch_links_(touch_links)
@@ -81,6 +83,24 @@ AttachedBody::AttachedBody(const LinkModel* parent, const std::string& id, const
   }
 }
 
+AttachedBody::AttachedBody(const AttachedBody& other)
+  : parent_link_model_(other.parent_link_model_)
+  , id_(other.id_)
+  , pose_(other.pose_)
+  , global_pose_(other.global_pose_)
+  , parent_link_global_transform_(other.parent_link_global_transform_)
+  , has_parent_transform_(other.has_parent_transform_)
+  , shapes_(other.shapes_)
+  , shape_poses_(other.shape_poses_)
+  , shape_poses_in_link_frame_(other.shape_poses_in_link_frame_)
+  , global_collision_body_transforms_(other.global_collision_body_transforms_)
+  , touch_links_(other.touch_links_)
+  , detach_posture_(other.detach_posture_)
+  , subframe_poses_(other.subframe_poses_)
+  , global_subframe_poses_(other.global_subframe_poses_)
+{
+}
+
 AttachedBody::~AttachedBody() = default;
 
 void AttachedBody::setScale(double scale)
@@ -105,16 +125,40 @@ void AttachedBody::setScale(double scale)
 void AttachedBody::computeTransform(const Eigen::Isometry3d& parent_link_global_transform)
 {
   ASSERT_ISOMETRY(parent_link_global_transform)  // unsanitized input, could contain a non-isometry
+  if (has_parent_transform_ && parent_link_global_transform.matrix() == parent_link_global_transform_.matrix())
+    return;
+  parent_link_global_transform_ = parent_link_global_transform;
+  has_parent_transform_ = true;
   global_pose_ = parent_link_global_transform * pose_;
 
   // update collision body transforms
   for (std::size_t i = 0; i < global_collision_body_transforms_.size(); ++i)
     global_collision_body_transforms_[i] = global_pose_ * shape_poses_[i];  // valid isometry
 
-  // update subframe transforms
-  for (auto global = global_subframe_poses_.begin(), end = global_subframe_poses_.end(), local = subframe_poses_.begin();
-       global != end; ++global, ++local)
-    global->second = global_pose_ * local->second;  // valid isometry
+  // subframe transforms are only updated when requested
+  global_subframe_poses_.valid = false;
+}
+
+const FixedTransformsMap& AttachedBody::updatedGlobalSubframePoses() const
+{
+  if (!global_subframe_poses_.valid.load(std::memory_order_acquire))
+  {
+    std::lock_guard<std::mutex> _(global_subframe_poses_.lock);
+    if (!global_subframe_poses_.valid.load(std::memory_order_relaxed))
+    {
+      for (auto global = global_subframe_poses_.poses.begin(), end = global_subframe_poses_.poses.end(),
+                local = subframe_poses_.begin();
+           global != end; ++global, ++local)
+        global->second = global_pose_ * local->second;  // valid isometry
+      global_subframe_poses_.valid.store(true, std::memory_order_release);
+    }
+  }
+  return global_subframe_poses_.poses;
+}
+
+const FixedTransformsMap& AttachedBody::getGlobalSubframeTransforms() const
+{
+  return updatedGlobalSubframePoses();
 }
 
 void AttachedBody::setPadding(double padding)
@@ -158,8 +202,9 @@ const Eigen::Isometry3d& AttachedBody::getGlobalSubframeTransform(const std::str
 {
   if (frame_name.rfind(id_, 0) == 0 && frame_name[id_.length()] == '/')
   {
-    auto it = global_subframe_poses_.find(frame_name.substr(id_.length() + 1));
-    if (it != global_subframe_poses_.end())
+    const FixedTransformsMap& global_subframe_poses = updatedGlobalSubframePoses();
+    auto it = global_subframe_poses.find(frame_name.substr(id_.length() + 1));
+    if (it != global_subframe_poses.end())
     {
       if (found)
         *found = true;
@@ -179,5 +224,54 @@ bool AttachedBody::hasSubframeTransform(const std::string& frame_name) const
   return found;
 }
 
+void AttachedBody::getMemoryUsage(MemoryUsage& usage) const
+{
+  const std::size_t poses = sizeof(Eigen::Isometry3d) * (shape_poses_.size() + shape_poses_in_link_frame_.size() +
+                                                          global_collision_body_transforms_.size());
+  const std::size_t subframes = (sizeof(Eigen::Isometry3d) + sizeof(std::string)) *
+                                (subframe_poses_.size() + global_subframe_poses_.poses.size());
+  usage.add("attached_bodies", sizeof(AttachedBody) + poses + subframes);
+  for (const shapes::ShapeConstPtr& shape : shapes_)
+  {
+    if (usage.visit(shape.get()))
+      usage.add(shape->type == shapes::OCTREE ? "octomap" : "shapes", getShapeMemoryUsage(*shape));
+  }
+}
+
+std::size_t getShapeMemoryUsage(const shapes::Shape& shape)
+{
+  switch (shape.type)
+  {
+    case shapes::MESH:
+    {
+      const auto& mesh = static_cast<const shapes::Mesh&>(shape);
+      std::size_t bytes = sizeof(shapes::Mesh) + 3 * sizeof(double) * mesh.vertex_count +
+                          3 * sizeof(unsigned int) * mesh.triangle_count;
+      if (mesh.triangle_normals)
+        bytes += 3 * sizeof(double) * mesh.triangle_count;
+      if (mesh.vertex_normals)
+        bytes += 3 * sizeof(double) * mesh.vertex_count;
+      return bytes;
+    }
+    case shapes::OCTREE:
+    {
+      const auto& octree = static_cast<const shapes::OcTree&>(shape);
+      return sizeof(shapes::OcTree) + (octree.octree ? octree.octree->memoryUsage() : 0);
+    }
+    case shapes::PLANE:
+      return sizeof(shapes::Plane);
+    case shapes::SPHERE:
+      return sizeof(shapes::Sphere);
+    case shapes::CYLINDER:
+      return sizeof(shapes::Cylinder);
+    case shapes::CONE:
+      return sizeof(shapes::Cone);
+    case shapes::BOX:
+      return sizeof(shapes::Box);
+    default:
+      return sizeof(shapes::Shape);
+  }
+}
+
 }  // namespace core
 }  // namespace moveit
@@ -36,11 +36,16 @@
 
 /* Author: Ioan Sucan, Sachin Chitta, Acorn Pooley, Mario Prats, Dave Coleman */
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <memory>
 #include <moveit/robot_state/cartesian_interpolator.h>
+#include <moveit/transforms/transforms.h>
 #include <geometric_shapes/check_isometry.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <tf2_eigen/tf2_eigen.hpp>
 
 namespace moveit
 {
@@ -73,12 +78,171 @@ CartesianInterpolator::Distance CartesianInterpolator::computeCartesianPath(
                                                                           options, cost_function);
 }
 
+namespace
+{
+/** \brief Get the transforms that turn a pose of \e link, in the model frame, into an IK query of \e solver
+
+    Mirrors the frame handling of RobotState::setFromIK(). Returns false if the solver has several tips or \e link is
+    not rigidly attached to the solver's tip frame. */
+bool getIKQueryTransforms(RobotState& state, const LinkModel* link, const kinematics::KinematicsBase& solver,
+                          Eigen::Isometry3d& base_inverse, Eigen::Isometry3d& tip_offset)
+{
+  if (solver.getTipFrames().size() != 1)
+    return false;
+
+  std::string tip_frame = solver.getTipFrame();
+  if (!tip_frame.empty() && tip_frame[0] == '/')
+    tip_frame = tip_frame.substr(1);
+
+  tip_offset = Eigen::Isometry3d::Identity();
+  if (link->getName() != tip_frame)
+  {
+    bool found = false;
+    for (const auto& fixed_link : link->getAssociatedFixedTransforms())
+    {
+      if (Transforms::sameFrame(fixed_link.first->getName(), tip_frame))
+      {
+        tip_offset = fixed_link.second;
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      return false;
+  }
+
+  base_inverse = Eigen::Isometry3d::Identity();
+  return state.setToIKSolverFrame(base_inverse, solver.getBaseFrame());
+}
+
+/** \brief Insert substeps into \e traj wherever consecutive states are further apart than allowed by \e adaptive_step
+
+    \e traj[i] is expected to reach the pose at \e percentage_per_step * i. Returns the percentage reached by the last
+    state of the refined trajectory, which is truncated before the first substep that could not be solved. */
+double refineCartesianPath(const JointModelGroup* group, std::vector<RobotStatePtr>& traj, const LinkModel* link,
+                           double percentage_per_step,
+                           const std::function<Eigen::Isometry3d(double)>& interpolate_pose,
+                           const AdaptiveEEFStep& adaptive_step, const std::vector<double>& consistency_limits,
+                           const GroupStateValidityCallbackFn& validCallback,
+                           const kinematics::KinematicsQueryOptions& options,
+                           const kinematics::KinematicsBase::IKCostFn& cost_function)
+{
+  struct Substep
+  {
+    std::size_t segment;  // the substep lies between traj[segment - 1] and traj[segment]
+    double percentage;
+  };
+
+  // decide how many substeps each step needs
+  std::vector<Substep> substeps;
+  const std::size_t max_substeps = std::max<std::size_t>(adaptive_step.max_substeps, 1);
+  for (std::size_t segment = 1; segment < traj.size(); ++segment)
+  {
+    const double distance = traj[segment]->distance(*traj[segment - 1], group);
+    const std::size_t count =
+        std::min(max_substeps, static_cast<std::size_t>(std::ceil(distance / adaptive_step.max_joint_step)));
+    for (std::size_t i = 1; i < count; ++i)
+    {
+      const double fraction = static_cast<double>(i) / static_cast<double>(count);
+      substeps.push_back({ segment, (static_cast<double>(segment - 1) + fraction) * percentage_per_step });
+    }
+  }
+  const double reached_percentage = static_cast<double>(traj.size() - 1) * percentage_per_step;
+  if (substeps.empty())
+    return reached_percentage;
+
+  // Solve all substeps in one batch, seeded with the joint values interpolated between the surrounding states.
+  // Cost functions are not supported by the batch interface, so those requests are solved one by one below.
+  std::vector<std::vector<double>> solutions;
+  const kinematics::KinematicsBaseConstPtr& solver = group->getSolverInstance();
+  Eigen::Isometry3d base_inverse, tip_offset;
+  RobotState scratch(*traj.front());
+  if (solver && !cost_function && getIKQueryTransforms(scratch, link, *solver, base_inverse, tip_offset))
+  {
+    const std::vector<std::size_t>& bij = group->getKinematicsSolverJointBijection();
+    std::vector<geometry_msgs::msg::Pose> ik_poses;
+    std::vector<std::vector<double>> ik_seeds;
+    ik_poses.reserve(substeps.size());
+    ik_seeds.reserve(substeps.size());
+    std::vector<double> values;
+    for (const Substep& substep : substeps)
+    {
+      ik_poses.push_back(tf2::toMsg(base_inverse * interpolate_pose(substep.percentage) * tip_offset));
+      const double fraction = substep.percentage / percentage_per_step - static_cast<double>(substep.segment - 1);
+      traj[substep.segment - 1]->interpolate(*traj[substep.segment], fraction, scratch, group);
+      scratch.copyJointGroupPositions(group, values);
+      std::vector<double> seed(bij.size());
+      for (std::size_t i = 0; i < bij.size(); ++i)
+        seed[i] = values[bij[i]];
+      ik_seeds.push_back(std::move(seed));
+    }
+    std::vector<moveit_msgs::msg::MoveItErrorCodes> error_codes;
+    solver->searchPositionIKBatch(ik_poses, ik_seeds, group->getDefaultIKTimeout(), solutions, error_codes, options);
+  }
+
+  // Assemble the refined trajectory in order. Validity is checked here, on the calling thread. Substeps that were not
+  // solved or are invalid get another attempt seeded from their predecessor, as in the regular interpolation.
+  std::vector<RobotStatePtr> refined;
+  refined.reserve(traj.size() + substeps.size());
+  refined.push_back(traj.front());
+  std::vector<double> values;
+  double refined_percentage = 0.0;
+  std::size_t next_substep = 0;
+  for (std::size_t segment = 1; segment < traj.size(); ++segment)
+  {
+    for (; next_substep < substeps.size() && substeps[next_substep].segment == segment; ++next_substep)
+    {
+      const Substep& substep = substeps[next_substep];
+      auto state = std::make_shared<RobotState>(*refined.back());
+      bool solved = false;
+      if (next_substep < solutions.size() && !solutions[next_substep].empty())
+      {
+        const std::vector<std::size_t>& bij = group->getKinematicsSolverJointBijection();
+        values.resize(bij.size());
+        for (std::size_t i = 0; i < bij.size(); ++i)
+          values[bij[i]] = solutions[next_substep][i];
+        state->setJointGroupPositions(group, values);
+        state->update();
+        solved = !validCallback || validCallback(state.get(), group, values.data());
+        if (!solved)
+          *state = *refined.back();
+      }
+      if (!solved && !state->setFromIK(group, interpolate_pose(substep.percentage), link->getName(),
+                                       consistency_limits, 0.0, validCallback, options, cost_function))
+      {
+        RCLCPP_DEBUG(LOGGER, "Truncating Cartesian path at an unsolvable substep");
+        traj.swap(refined);
+        return refined_percentage;
+      }
+      refined.push_back(state);
+      refined_percentage = substep.percentage;
+    }
+    refined.push_back(traj[segment]);
+    refined_percentage = static_cast<double>(segment) * percentage_per_step;
+  }
+
+  traj.swap(refined);
+  return reached_percentage;
+}
+}  // namespace
+
 CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
     RobotState* start_state, const JointModelGroup* group, std::vector<RobotStatePtr>& traj, const LinkModel* link,
     const Eigen::Isometry3d& target, bool global_reference_frame, const MaxEEFStep& max_step,
     const JumpThreshold& jump_threshold, const GroupStateValidityCallbackFn& validCallback,
     const kinematics::KinematicsQueryOptions& options, const kinematics::KinematicsBase::IKCostFn& cost_function,
     const Eigen::Isometry3d& link_offset)
+{
+  return computeCartesianPath(start_state, group, traj, link, target, global_reference_frame, max_step,
+                              AdaptiveEEFStep(), jump_threshold, validCallback, options, cost_function, link_offset);
+}
+
+CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
+    RobotState* start_state, const JointModelGroup* group, std::vector<RobotStatePtr>& traj, const LinkModel* link,
+    const Eigen::Isometry3d& target, bool global_reference_frame, const MaxEEFStep& max_step,
+    const AdaptiveEEFStep& adaptive_step, const JumpThreshold& jump_threshold,
+    const GroupStateValidityCallbackFn& validCallback, const kinematics::KinematicsQueryOptions& options,
+    const kinematics::KinematicsBase::IKCostFn& cost_function, const Eigen::Isometry3d& link_offset)
 {
   // check unsanitized inputs for non-isometry
   ASSERT_ISOMETRY(target)
@@ -148,6 +312,13 @@ CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
     }
   }
 
+  // the pose of the link on the straight line from start to target
+  const auto interpolate_pose = [&](double percentage) {
+    Eigen::Isometry3d pose(start_quaternion.slerp(percentage, target_quaternion));
+    pose.translation() = percentage * rotated_target.translation() + (1 - percentage) * start_pose.translation();
+    return Eigen::Isometry3d(pose * offset);
+  };
+
   traj.clear();
   traj.push_back(std::make_shared<moveit::core::RobotState>(*start_state));
 
@@ -156,13 +327,10 @@ CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
   {
     double percentage = static_cast<double>(i) / static_cast<double>(steps);
 
-    Eigen::Isometry3d pose(start_quaternion.slerp(percentage, target_quaternion));
-    pose.translation() = percentage * rotated_target.translation() + (1 - percentage) * start_pose.translation();
-
     // Explicitly use a single IK attempt only: We want a smooth trajectory.
     // Random seeding (of additional attempts) would probably create IK jumps.
-    if (start_state->setFromIK(group, pose * offset, link->getName(), consistency_limits, 0.0, validCallback, options,
-                               cost_function))
+    if (start_state->setFromIK(group, interpolate_pose(percentage), link->getName(), consistency_limits, 0.0,
+                               validCallback, options, cost_function))
     {
       traj.push_back(std::make_shared<moveit::core::RobotState>(*start_state));
     }
@@ -174,6 +342,13 @@ CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
     last_valid_percentage = percentage;
   }
 
+  if (adaptive_step.max_joint_step > 0.0 && traj.size() > 1)
+  {
+    last_valid_percentage = refineCartesianPath(group, traj, link, 1.0 / static_cast<double>(steps), interpolate_pose,
+                                                adaptive_step, consistency_limits, validCallback, options,
+                                                cost_function);
+  }
+
   last_valid_percentage *= checkJointSpaceJump(group, traj, jump_threshold);
 
   return CartesianInterpolator::Percentage(last_valid_percentage);
@@ -185,6 +360,17 @@ CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
     const JumpThreshold& jump_threshold, const GroupStateValidityCallbackFn& validCallback,
     const kinematics::KinematicsQueryOptions& options, const kinematics::KinematicsBase::IKCostFn& cost_function,
     const Eigen::Isometry3d& link_offset)
+{
+  return computeCartesianPath(start_state, group, traj, link, waypoints, global_reference_frame, max_step,
+                              AdaptiveEEFStep(), jump_threshold, validCallback, options, cost_function, link_offset);
+}
+
+CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
+    RobotState* start_state, const JointModelGroup* group, std::vector<RobotStatePtr>& traj, const LinkModel* link,
+    const EigenSTL::vector_Isometry3d& waypoints, bool global_reference_frame, const MaxEEFStep& max_step,
+    const AdaptiveEEFStep& adaptive_step, const JumpThreshold& jump_threshold,
+    const GroupStateValidityCallbackFn& validCallback, const kinematics::KinematicsQueryOptions& options,
+    const kinematics::KinematicsBase::IKCostFn& cost_function, const Eigen::Isometry3d& link_offset)
 {
   double percentage_solved = 0.0;
   for (std::size_t i = 0; i < waypoints.size(); ++i)
@@ -194,7 +380,8 @@ CartesianInterpolator::Percentage CartesianInterpolator::computeCartesianPath(
     std::vector<RobotStatePtr> waypoint_traj;
     double wp_percentage_solved =
         computeCartesianPath(start_state, group, waypoint_traj, link, waypoints[i], global_reference_frame, max_step,
-                             NO_JOINT_SPACE_JUMP_TEST, validCallback, options, cost_function, link_offset);
+                             adaptive_step, NO_JOINT_SPACE_JUMP_TEST, validCallback, options, cost_function,
+                             link_offset);
     if (fabs(wp_percentage_solved - 1.0) < std::numeric_limits<double>::epsilon())
     {
       percentage_solved = static_cast<double>((i + 1)) / static_cast<double>(waypoints.size());
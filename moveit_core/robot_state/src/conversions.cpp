@@ -479,13 +479,14 @@ bool jointTrajPointToRobotState(const trajectory_msgs::msg::JointTrajectory& tra
     return false;
   }
 
-  state.setVariablePositions(trajectory.joint_names, trajectory.points[point_id].positions);
+  const VariableLayoutConstPtr layout = state.getRobotModel()->getVariableLayout(trajectory.joint_names);
+  state.setVariablePositions(*layout, trajectory.points[point_id].positions);
   if (!trajectory.points[point_id].velocities.empty())
-    state.setVariableVelocities(trajectory.joint_names, trajectory.points[point_id].velocities);
+    state.setVariableVelocities(*layout, trajectory.points[point_id].velocities);
   if (!trajectory.points[point_id].accelerations.empty())
-    state.setVariableAccelerations(trajectory.joint_names, trajectory.points[point_id].accelerations);
+    state.setVariableAccelerations(*layout, trajectory.points[point_id].accelerations);
   if (!trajectory.points[point_id].effort.empty())
-    state.setVariableEffort(trajectory.joint_names, trajectory.points[point_id].effort);
+    state.setVariableEffort(*layout, trajectory.points[point_id].effort);
 
   return true;
 }
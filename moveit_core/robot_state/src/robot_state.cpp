@@ -40,6 +40,7 @@
 #include <moveit/robot_state/cartesian_interpolator.h>
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/transforms/transforms.h>
+#include <moveit/utils/tracing.h>
 #include <rclcpp/clock.hpp>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
@@ -71,7 +72,7 @@ RobotState::RobotState(const RobotModelConstPtr& robot_model)
     throw std::invalid_argument("RobotState cannot be constructed with nullptr RobotModelConstPtr");
   }
 
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyLinkTransforms(robot_model_->getRootJoint());
   allocMemory();
   initTransforms();
 }
@@ -91,6 +92,17 @@ RobotState::~RobotState()
     delete rng_;
 }
 
+std::size_t RobotState::getAllocatedBytes() const
+{
+  // memory for the dirty joint transforms
+  const int nr_doubles_for_dirty_joint_transforms =
+      1 + robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
+  return sizeof(Eigen::Isometry3d) * (robot_model_->getJointModelCount() + robot_model_->getLinkModelCount() +
+                                      robot_model_->getLinkGeometryCount()) +
+         sizeof(double) * (robot_model_->getVariableCount() * 3 + nr_doubles_for_dirty_joint_transforms) +
+         EIGEN_MAX_ALIGN_BYTES - 1;
+}
+
 void RobotState::allocMemory()
 {
   static_assert((sizeof(Eigen::Isometry3d) / EIGEN_MAX_ALIGN_BYTES) * EIGEN_MAX_ALIGN_BYTES == sizeof(Eigen::Isometry3d),
@@ -100,12 +112,7 @@ void RobotState::allocMemory()
   // memory for the dirty joint transforms
   const int nr_doubles_for_dirty_joint_transforms =
       1 + robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
-  const size_t bytes =
-      sizeof(Eigen::Isometry3d) * (robot_model_->getJointModelCount() + robot_model_->getLinkModelCount() +
-                                   robot_model_->getLinkGeometryCount()) +
-      sizeof(double) * (robot_model_->getVariableCount() * 3 + nr_doubles_for_dirty_joint_transforms) +
-      extra_alignment_bytes;
-  memory_ = malloc(bytes);
+  memory_ = malloc(getAllocatedBytes());
 
   // make the memory for transforms align at EIGEN_MAX_ALIGN_BYTES
   // https://eigen.tuxfamily.org/dox/classEigen_1_1aligned__allocator.html
@@ -151,6 +158,8 @@ void RobotState::copyFrom(const RobotState& other)
 
   dirty_collision_body_transforms_ = other.dirty_collision_body_transforms_;
   dirty_link_transforms_ = other.dirty_link_transforms_;
+  dirty_collision_body_subtrees_ = other.dirty_collision_body_subtrees_;
+  dirty_link_subtrees_ = other.dirty_link_subtrees_;
 
   if (dirty_link_transforms_ == robot_model_->getRootJoint())
   {
@@ -286,7 +295,7 @@ void RobotState::setToRandomPositions()
   random_numbers::RandomNumberGenerator& rng = getRandomNumberGenerator();
   robot_model_->getVariableRandomPositions(rng, position_);
   memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyLinkTransforms(robot_model_->getRootJoint());
   // mimic values are correctly set in RobotModel
 }
 
@@ -364,7 +373,7 @@ void RobotState::setToDefaultValues()
   // set velocity & acceleration to 0
   memset(velocity_, 0, sizeof(double) * 2 * robot_model_->getVariableCount());
   memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyLinkTransforms(robot_model_->getRootJoint());
 }
 
 void RobotState::setVariablePositions(const double* position)
@@ -376,7 +385,7 @@ void RobotState::setVariablePositions(const double* position)
 
   // Since all joint values have potentially changed, we will need to recompute all transforms
   memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
-  dirty_link_transforms_ = robot_model_->getRootJoint();
+  markDirtyLinkTransforms(robot_model_->getRootJoint());
 }
 
 void RobotState::setVariablePositions(const std::map<std::string, double>& variable_map)
@@ -416,11 +425,15 @@ void RobotState::setVariablePositions(const std::map<std::string, double>& varia
 void RobotState::setVariablePositions(const std::vector<std::string>& variable_names,
                                       const std::vector<double>& variable_position)
 {
-  for (std::size_t i = 0; i < variable_names.size(); ++i)
+  setVariablePositions(*robot_model_->getVariableLayout(variable_names), variable_position);
+}
+
+void RobotState::setVariablePositions(const VariableLayout& layout, const std::vector<double>& variable_position)
+{
+  assert(layout.size() <= variable_position.size());
+  layout.scatter(variable_position, position_);
+  for (const JointModel* jm : layout.getJoints())
   {
-    const int index = robot_model_->getVariableIndex(variable_names[i]);
-    position_[index] = variable_position[i];
-    const JointModel* jm = robot_model_->getJointOfVariable(index);
     markDirtyJointTransforms(jm);
     updateMimicJoint(jm);
   }
@@ -442,11 +455,15 @@ void RobotState::setVariableVelocities(const std::map<std::string, double>& vari
 
 void RobotState::setVariableVelocities(const std::vector<std::string>& variable_names,
                                        const std::vector<double>& variable_velocity)
+{
+  setVariableVelocities(*robot_model_->getVariableLayout(variable_names), variable_velocity);
+}
+
+void RobotState::setVariableVelocities(const VariableLayout& layout, const std::vector<double>& variable_velocity)
 {
   markVelocity();
-  assert(variable_names.size() == variable_velocity.size());
-  for (std::size_t i = 0; i < variable_names.size(); ++i)
-    velocity_[robot_model_->getVariableIndex(variable_names[i])] = variable_velocity[i];
+  assert(layout.size() == variable_velocity.size());
+  layout.scatter(variable_velocity, velocity_);
 }
 
 void RobotState::setVariableAccelerations(const std::map<std::string, double>& variable_map)
@@ -465,11 +482,16 @@ void RobotState::setVariableAccelerations(const std::map<std::string, double>& v
 
 void RobotState::setVariableAccelerations(const std::vector<std::string>& variable_names,
                                           const std::vector<double>& variable_acceleration)
+{
+  setVariableAccelerations(*robot_model_->getVariableLayout(variable_names), variable_acceleration);
+}
+
+void RobotState::setVariableAccelerations(const VariableLayout& layout,
+                                          const std::vector<double>& variable_acceleration)
 {
   markAcceleration();
-  assert(variable_names.size() == variable_acceleration.size());
-  for (std::size_t i = 0; i < variable_names.size(); ++i)
-    acceleration_[robot_model_->getVariableIndex(variable_names[i])] = variable_acceleration[i];
+  assert(layout.size() == variable_acceleration.size());
+  layout.scatter(variable_acceleration, acceleration_);
 }
 
 void RobotState::setVariableEffort(const std::map<std::string, double>& variable_map)
@@ -488,11 +510,15 @@ void RobotState::setVariableEffort(const std::map<std::string, double>& variable
 
 void RobotState::setVariableEffort(const std::vector<std::string>& variable_names,
                                    const std::vector<double>& variable_effort)
+{
+  setVariableEffort(*robot_model_->getVariableLayout(variable_names), variable_effort);
+}
+
+void RobotState::setVariableEffort(const VariableLayout& layout, const std::vector<double>& variable_effort)
 {
   markEffort();
-  assert(variable_names.size() == variable_effort.size());
-  for (std::size_t i = 0; i < variable_names.size(); ++i)
-    effort_[robot_model_->getVariableIndex(variable_names[i])] = variable_effort[i];
+  assert(layout.size() == variable_effort.size());
+  layout.scatter(variable_effort, effort_);
 }
 
 void RobotState::invertVelocity()
@@ -681,7 +707,7 @@ void RobotState::update(bool force)
   if (force)
   {
     memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
-    dirty_link_transforms_ = robot_model_->getRootJoint();
+    markDirtyLinkTransforms(robot_model_->getRootJoint());
   }
 
   // this actually triggers all needed updates
@@ -693,12 +719,10 @@ void RobotState::updateCollisionBodyTransforms()
   if (dirty_link_transforms_ != nullptr)
     updateLinkTransforms();
 
-  if (dirty_collision_body_transforms_ != nullptr)
+  // only the collision bodies in the dirty subtrees are recomputed, e.g. only one arm of a dual-arm robot
+  for (std::size_t i = 0; i < dirty_collision_body_subtrees_.count; ++i)
   {
-    const std::vector<const LinkModel*>& links = dirty_collision_body_transforms_->getDescendantLinkModels();
-    dirty_collision_body_transforms_ = nullptr;
-
-    for (const LinkModel* link : links)
+    for (const LinkModel* link : dirty_collision_body_subtrees_.roots[i]->getDescendantLinkModels())
     {
       const EigenSTL::vector_Isometry3d& ot = link->getCollisionOriginTransforms();
       const std::vector<int>& ot_id = link->areCollisionOriginTransformsIdentity();
@@ -718,24 +742,33 @@ void RobotState::updateCollisionBodyTransforms()
       }
     }
   }
+  dirty_collision_body_transforms_ = nullptr;
+  dirty_collision_body_subtrees_.count = 0;
 }
 
 void RobotState::updateLinkTransforms()
 {
-  if (dirty_link_transforms_ != nullptr)
+  // the generated FK computes all links at once, which pays off when the whole tree is dirty
+  const FKKernel* fk_kernel = robot_model_->getFKKernel();
+  if (fk_kernel && dirty_link_transforms_ == robot_model_->getRootJoint())
   {
-    updateLinkTransformsInternal(dirty_link_transforms_);
-    if (dirty_collision_body_transforms_)
-    {
-      dirty_collision_body_transforms_ =
-          robot_model_->getCommonRoot(dirty_collision_body_transforms_, dirty_link_transforms_);
-    }
-    else
-    {
-      dirty_collision_body_transforms_ = dirty_link_transforms_;
-    }
+    // the kernel also computes all joint transforms, so none of them are dirty anymore
+    fk_kernel->compute(position_, variable_joint_transforms_, global_link_transforms_);
+    memset(dirty_joint_transforms_, 0, robot_model_->getJointModelCount() * sizeof(unsigned char));
+    markDirtyCollisionBodyTransforms(robot_model_->getRootJoint());
     dirty_link_transforms_ = nullptr;
+    dirty_link_subtrees_.count = 0;
+    return;
+  }
+
+  // the dirty subtrees are disjoint and their parent links are up to date, so they can be updated in any order
+  for (std::size_t i = 0; i < dirty_link_subtrees_.count; ++i)
+  {
+    updateLinkTransformsInternal(dirty_link_subtrees_.roots[i]);
+    markDirtyCollisionBodyTransforms(dirty_link_subtrees_.roots[i]);
   }
+  dirty_link_transforms_ = nullptr;
+  dirty_link_subtrees_.count = 0;
 }
 
 void RobotState::updateLinkTransformsInternal(const JointModel* start)
@@ -781,11 +814,12 @@ void RobotState::updateLinkTransformsInternal(const JointModel* start)
     }
   }
 
-  // update attached bodies tf; these are usually very few, so we update them all
+  // update the attached bodies below start; these are usually very few
   for (const auto& attached_body : attached_body_map_)
   {
-    attached_body.second->computeTransform(
-        global_link_transforms_[attached_body.second->getAttachedLink()->getLinkIndex()]);
+    const LinkModel* link = attached_body.second->getAttachedLink();
+    if (robot_model_->getCommonRoot(start, link->getParentJointModel()) == start)
+      attached_body.second->computeTransform(global_link_transforms_[link->getLinkIndex()]);
   }
 }
 
@@ -794,15 +828,7 @@ void RobotState::updateStateWithLinkAt(const LinkModel* link, const Eigen::Isome
   updateLinkTransforms();  // no link transforms must be dirty, otherwise the transform we set will be overwritten
 
   // update the fact that collision body transforms are out of date
-  if (dirty_collision_body_transforms_)
-  {
-    dirty_collision_body_transforms_ =
-        robot_model_->getCommonRoot(dirty_collision_body_transforms_, link->getParentJointModel());
-  }
-  else
-  {
-    dirty_collision_body_transforms_ = link->getParentJointModel();
-  }
+  markDirtyCollisionBodyTransforms(link->getParentJointModel());
 
   global_link_transforms_[link->getLinkIndex()] = transform;
 
@@ -838,7 +864,7 @@ void RobotState::updateStateWithLinkAt(const LinkModel* link, const Eigen::Isome
       }
     }
     // all collision body transforms are invalid now
-    dirty_collision_body_transforms_ = parent_link->getParentJointModel();
+    markDirtyCollisionBodyTransforms(parent_link->getParentJointModel());
   }
 
   // update attached bodies tf; these are usually very few, so we update them all
@@ -993,6 +1019,13 @@ bool RobotState::isValidVelocityMove(const RobotState& other, const JointModelGr
 
 double RobotState::distance(const RobotState& other, const JointModelGroup* joint_group) const
 {
+  // the group kernels work on group states, which are slices of the full state if the group is contiguous
+  if (joint_group->isContiguousWithinState())
+  {
+    const int first = joint_group->getVariableIndexList()[0];
+    return joint_group->distance(position_ + first, other.position_ + first);
+  }
+
   double d = 0.0;
   const std::vector<const JointModel*>& jm = joint_group->getActiveJointModels();
   for (const JointModel* joint : jm)
@@ -1009,17 +1042,25 @@ void RobotState::interpolate(const RobotState& to, double t, RobotState& state)
   robot_model_->interpolate(getVariablePositions(), to.getVariablePositions(), t, state.getVariablePositions());
 
   memset(state.dirty_joint_transforms_, 1, state.robot_model_->getJointModelCount() * sizeof(unsigned char));
-  state.dirty_link_transforms_ = state.robot_model_->getRootJoint();
+  state.markDirtyLinkTransforms(state.robot_model_->getRootJoint());
 }
 
 void RobotState::interpolate(const RobotState& to, double t, RobotState& state, const JointModelGroup* joint_group) const
 {
   checkInterpolationParamBounds(LOGGER, t);
-  const std::vector<const JointModel*>& jm = joint_group->getActiveJointModels();
-  for (const JointModel* joint : jm)
+  if (joint_group->isContiguousWithinState())
   {
-    const int idx = joint->getFirstVariableIndex();
-    joint->interpolate(position_ + idx, to.position_ + idx, t, state.position_ + idx);
+    const int first = joint_group->getVariableIndexList()[0];
+    joint_group->interpolate(position_ + first, to.position_ + first, t, state.position_ + first);
+  }
+  else
+  {
+    const std::vector<const JointModel*>& jm = joint_group->getActiveJointModels();
+    for (const JointModel* joint : jm)
+    {
+      const int idx = joint->getFirstVariableIndex();
+      joint->interpolate(position_ + idx, to.position_ + idx, t, state.position_ + idx);
+    }
   }
   state.updateMimicJoints(joint_group);
 }
@@ -1343,6 +1384,14 @@ Eigen::MatrixXd RobotState::getJacobian(const JointModelGroup* group,
 bool RobotState::getJacobian(const JointModelGroup* group, const LinkModel* link,
                              const Eigen::Vector3d& reference_point_position, Eigen::MatrixXd& jacobian,
                              bool use_quaternion_representation) const
+{
+  jacobian.resize(use_quaternion_representation ? 7 : 6, group->getVariableCount());
+  return computeJacobian(group, link, reference_point_position, jacobian, use_quaternion_representation);
+}
+
+bool RobotState::computeJacobian(const JointModelGroup* group, const LinkModel* link,
+                                 const Eigen::Vector3d& reference_point_position, Eigen::Ref<Eigen::MatrixXd> jacobian,
+                                 bool use_quaternion_representation) const
 {
   assert(checkLinkTransforms());
 
@@ -1369,15 +1418,21 @@ bool RobotState::getJacobian(const JointModelGroup* group, const LinkModel* link
     return false;
   }
 
+  const int rows = use_quaternion_representation ? 7 : 6;
+  const int columns = group->getVariableCount();
+  if (jacobian.rows() != rows || jacobian.cols() != columns)
+  {
+    RCLCPP_ERROR(LOGGER, "The Jacobian of group '%s' is %dx%d, but a %dx%d matrix was passed", group->getName().c_str(),
+                 rows, columns, static_cast<int>(jacobian.rows()), static_cast<int>(jacobian.cols()));
+    return false;
+  }
+
   // Get the link model of the group root link, and its inverted pose with respect to the RobotModel (URDF) root,
   // 'root_pose_world'.
   const JointModel* root_joint_model = group->getJointModels().front();
   const LinkModel* root_link_model = root_joint_model->getParentLinkModel();
   const Eigen::Isometry3d root_pose_world =
       root_link_model ? getGlobalLinkTransform(root_link_model).inverse() : Eigen::Isometry3d::Identity();
-  const int rows = use_quaternion_representation ? 7 : 6;
-  const int columns = group->getVariableCount();
-  jacobian.resize(rows, columns);
 
   // Get the tip pose with respect to the group root link. Append the user-requested offset 'reference_point_position'.
   const Eigen::Isometry3d root_pose_tip = root_pose_world * getGlobalLinkTransform(link);
@@ -1385,37 +1440,41 @@ bool RobotState::getJacobian(const JointModelGroup* group, const LinkModel* link
 
   // Here we iterate over all the group active joints, and compute how much each of them contribute to the Cartesian
   // displacement at the tip. So we build the Jacobian incrementally joint by joint.
-  std::size_t active_joints = group->getActiveJointModels().size();
+  // Only the joint origins and axes are transformed to the group root link, not the full link poses.
+  std::size_t active_joints = joint_models.size();
   int i = 0;
   for (std::size_t joint = 0; joint < active_joints; ++joint)
   {
-    // Get the child link for the current joint, and its pose with respect to the group root link.
+    // Get the child link for the current joint, and its pose with respect to the world.
     const JointModel* joint_model = joint_models[joint];
-    const LinkModel* child_link_model = joint_model->getChildLinkModel();
-    const Eigen::Isometry3d& root_pose_link = root_pose_world * getGlobalLinkTransform(child_link_model);
+    const Eigen::Isometry3d& link_pose = getGlobalLinkTransform(joint_model->getChildLinkModel());
+    const Eigen::Vector3d link_origin = root_pose_world * link_pose.translation();
 
     // Compute the Jacobian for the specific joint model, given with respect to the group root link.
     if (joint_model->getType() == JointModel::REVOLUTE)
     {
       const Eigen::Vector3d axis_wrt_origin =
-          root_pose_link.linear() * static_cast<const RevoluteJointModel*>(joint_model)->getAxis();
-      jacobian.block<3, 1>(0, i) = axis_wrt_origin.cross(tip_point - root_pose_link.translation());
+          root_pose_world.linear() *
+          (link_pose.linear() * static_cast<const RevoluteJointModel*>(joint_model)->getAxis());
+      jacobian.block<3, 1>(0, i) = axis_wrt_origin.cross(tip_point - link_origin);
       jacobian.block<3, 1>(3, i) = axis_wrt_origin;
     }
     else if (joint_model->getType() == JointModel::PRISMATIC)
     {
       const Eigen::Vector3d axis_wrt_origin =
-          root_pose_link.linear() * static_cast<const PrismaticJointModel*>(joint_model)->getAxis();
+          root_pose_world.linear() *
+          (link_pose.linear() * static_cast<const PrismaticJointModel*>(joint_model)->getAxis());
       jacobian.block<3, 1>(0, i) = axis_wrt_origin;
       jacobian.block<3, 1>(3, i) = Eigen::Vector3d::Zero();
     }
     else if (joint_model->getType() == JointModel::PLANAR)
     {
-      jacobian.block<3, 1>(0, i) = root_pose_link.linear() * Eigen::Vector3d(1.0, 0.0, 0.0);
-      jacobian.block<3, 1>(0, i + 1) = root_pose_link.linear() * Eigen::Vector3d(0.0, 1.0, 0.0);
-      jacobian.block<3, 1>(0, i + 2) =
-          (root_pose_link.linear() * Eigen::Vector3d(0.0, 0.0, 1.0)).cross(tip_point - root_pose_link.translation());
-      jacobian.block<3, 1>(3, i + 2) = root_pose_link.linear() * Eigen::Vector3d(0.0, 0.0, 1.0);
+      const Eigen::Matrix3d link_rotation = root_pose_world.linear() * link_pose.linear();
+      jacobian.block<3, 1>(0, i) = link_rotation.col(0);
+      jacobian.block<3, 1>(0, i + 1) = link_rotation.col(1);
+      jacobian.block<3, 1>(0, i + 2) = link_rotation.col(2).cross(tip_point - link_origin);
+      jacobian.block<3, 2>(3, i) = Eigen::Matrix<double, 3, 2>::Zero();
+      jacobian.block<3, 1>(3, i + 2) = link_rotation.col(2);
     }
     else
     {
@@ -1434,7 +1493,7 @@ bool RobotState::getJacobian(const JointModelGroup* group, const LinkModel* link
     //        [z]           [ -y  x  w ]
     Eigen::Quaterniond q(root_pose_tip.linear());
     double w = q.w(), x = q.x(), y = q.y(), z = q.z();
-    Eigen::MatrixXd quaternion_update_matrix(4, 3);
+    Eigen::Matrix<double, 4, 3> quaternion_update_matrix;
     quaternion_update_matrix << -x, -y, -z, w, -z, y, z, w, -x, -y, x, w;
     jacobian.block(3, 0, 4, columns) = 0.5 * quaternion_update_matrix * jacobian.block(3, 0, 3, columns);
   }
@@ -1652,6 +1711,8 @@ bool RobotState::setFromIK(const JointModelGroup* jmg, const EigenSTL::vector_Is
                            const kinematics::KinematicsQueryOptions& options,
                            const kinematics::KinematicsBase::IKCostFn& cost_function)
 {
+  moveit::tracing::ScopedTrace trace("inverse_kinematics", jmg->getName());
+
   // Error check
   if (poses_in.size() != tips_in.size())
   {
@@ -2298,6 +2359,15 @@ std::string RobotState::getStateTreeString() const
   return ss.str();
 }
 
+void RobotState::getMemoryUsage(MemoryUsage& usage) const
+{
+  if (!usage.visit(this))
+    return;
+  usage.add("robot_state", sizeof(RobotState) + (memory_ ? getAllocatedBytes() : 0));
+  for (const auto& attached_body : attached_body_map_)
+    attached_body.second->getMemoryUsage(usage);
+}
+
 namespace
 {
 void getPoseString(std::ostream& ss, const Eigen::Isometry3d& pose, const std::string& pfx)
@@ -0,0 +1,120 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/robot_state/robot_state_pool.h>
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+struct RobotStatePool::Storage
+{
+  ~Storage()
+  {
+    for (RobotState* state : free_states)
+      delete state;
+  }
+
+  void release(RobotState* state)
+  {
+    // do not keep anything of the previous user alive while the state is in the pool
+    state->setAttachedBodyUpdateCallback(AttachedBodyCallback());
+    state->clearAttachedBodies();
+
+    std::scoped_lock lock(mutex);
+    free_states.push_back(state);
+  }
+
+  std::mutex mutex;
+  std::vector<RobotState*> free_states;
+};
+
+RobotStatePool::RobotStatePool(const RobotModelConstPtr& robot_model, std::size_t slab_size)
+  : robot_model_(robot_model), slab_size_(std::max<std::size_t>(slab_size, 1)), storage_(std::make_shared<Storage>())
+{
+}
+
+RobotStatePtr RobotStatePool::allocate() const
+{
+  RobotStatePtr state = take();
+  state->setToDefaultValues();
+  state->dropDynamics();
+  return state;
+}
+
+RobotStatePtr RobotStatePool::allocate(const RobotState& state) const
+{
+  assert(state.getRobotModel() == robot_model_);
+  RobotStatePtr copy = take();
+  *copy = state;
+  return copy;
+}
+
+void RobotStatePool::reserve(std::size_t count) const
+{
+  std::scoped_lock lock(storage_->mutex);
+  storage_->free_states.reserve(count);
+  while (storage_->free_states.size() < count)
+    storage_->free_states.push_back(new RobotState(robot_model_));
+}
+
+std::size_t RobotStatePool::getFreeCount() const
+{
+  std::scoped_lock lock(storage_->mutex);
+  return storage_->free_states.size();
+}
+
+RobotStatePtr RobotStatePool::take() const
+{
+  RobotState* state;
+  {
+    std::scoped_lock lock(storage_->mutex);
+    if (storage_->free_states.empty())
+    {
+      for (std::size_t i = 0; i < slab_size_; ++i)
+        storage_->free_states.push_back(new RobotState(robot_model_));
+    }
+    state = storage_->free_states.back();
+    storage_->free_states.pop_back();
+  }
+  // the deleter keeps the storage alive, so states may outlive the pool
+  return RobotStatePtr(state, [storage = storage_](RobotState* released) { storage->release(released); });
+}
+}  // namespace core
+}  // namespace moveit
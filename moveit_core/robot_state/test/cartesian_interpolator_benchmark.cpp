@@ -0,0 +1,83 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+// To run this benchmark, 'cd' to the build/moveit_core/robot_state directory and directly run the binary.
+// computeCartesianPath() needs an IK solver, so only the joint space jump checks of the interpolator are covered here.
+
+#include <benchmark/benchmark.h>
+#include <moveit/robot_state/cartesian_interpolator.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <random_numbers/random_numbers.h>
+
+namespace
+{
+// A smooth random walk of the panda arm, as a Cartesian path would produce
+std::vector<moveit::core::RobotStatePtr> makePath(const moveit::core::RobotModelPtr& robot_model,
+                                                  const moveit::core::JointModelGroup* jmg, std::size_t waypoints)
+{
+  random_numbers::RandomNumberGenerator rng(0);
+  auto state = std::make_shared<moveit::core::RobotState>(robot_model);
+  state->setToDefaultValues();
+
+  std::vector<moveit::core::RobotStatePtr> path{ state };
+  for (std::size_t i = 1; i < waypoints; ++i)
+  {
+    auto next = std::make_shared<moveit::core::RobotState>(*path.back());
+    next->setToRandomPositionsNearBy(jmg, *path.back(), 0.01, rng);
+    path.push_back(next);
+  }
+  return path;
+}
+}  // namespace
+
+static void BM_CheckJointSpaceJump(benchmark::State& st, const moveit::core::JumpThreshold& jump_threshold)
+{
+  const moveit::core::RobotModelPtr& robot_model = moveit::core::loadTestingRobotModel("panda");
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup("panda_arm");
+  const std::vector<moveit::core::RobotStatePtr> path = makePath(robot_model, jmg, st.range(0));
+
+  for (auto _ : st)
+  {
+    // the check truncates the path at a jump, so it works on a copy
+    st.PauseTiming();
+    std::vector<moveit::core::RobotStatePtr> traj = path;
+    st.ResumeTiming();
+    benchmark::DoNotOptimize(moveit::core::CartesianInterpolator::checkJointSpaceJump(jmg, traj, jump_threshold));
+  }
+  st.SetItemsProcessed(st.iterations() * path.size());
+}
+
+BENCHMARK_CAPTURE(BM_CheckJointSpaceJump, relative, moveit::core::JumpThreshold(10.0))->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(BM_CheckJointSpaceJump, absolute, moveit::core::JumpThreshold(1.0, 1.0))->Arg(100)->Arg(1000);
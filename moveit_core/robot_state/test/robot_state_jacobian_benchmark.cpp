@@ -79,6 +79,38 @@ static void BM_MoveItJacobian(benchmark::State& st)
   }
 }
 
+static void BM_MoveItJacobianFixedSize(benchmark::State& st)
+{
+  // Load a test robot model.
+  const moveit::core::RobotModelPtr& robot_model = moveit::core::loadTestingRobotModel(TEST_ROBOT);
+
+  // Make sure the group exists and has the expected size, otherwise exit early with an error.
+  if (!robot_model->hasJointModelGroup(TEST_GROUP) ||
+      robot_model->getJointModelGroup(TEST_GROUP)->getVariableCount() != 7)
+  {
+    st.SkipWithError("The planning group doesn't exist or is not a 7 DOF group.");
+    return;
+  }
+
+  // Robot state.
+  moveit::core::RobotState kinematic_state(robot_model);
+  const moveit::core::JointModelGroup* jmg = kinematic_state.getJointModelGroup(TEST_GROUP);
+  const moveit::core::LinkModel* tip = jmg->getLinkModels().back();
+  Eigen::Matrix<double, 6, 7> jacobian;
+
+  random_numbers::RandomNumberGenerator rng(0);
+
+  for (auto _ : st)
+  {
+    // Time only the jacobian computation, not the forward kinematics.
+    st.PauseTiming();
+    kinematic_state.setToRandomPositions(jmg, rng);
+    kinematic_state.updateLinkTransforms();
+    st.ResumeTiming();
+    kinematic_state.getJacobian(jmg, tip, Eigen::Vector3d::Zero(), jacobian);
+  }
+}
+
 static void BM_KDLJacobian(benchmark::State& st)
 {
   const moveit::core::RobotModelPtr& robot_model = moveit::core::loadTestingRobotModel(TEST_ROBOT);
@@ -130,4 +162,5 @@ static void BM_KDLJacobian(benchmark::State& st)
 }
 
 BENCHMARK(BM_MoveItJacobian);
+BENCHMARK(BM_MoveItJacobianFixedSize);
 BENCHMARK(BM_KDLJacobian);
@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan */
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_state/robot_state_pool.h>
 #include <moveit/utils/robot_model_test_utils.h>
 #include <urdf_parser/urdf_parser.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
@@ -573,6 +574,36 @@ TEST_F(OneRobot, FK)
   EXPECT_NEAR_TRACED(state.getGlobalLinkTransform("link_e").translation(), Eigen::Vector3d(2.8, 0.6, 0));
 }
 
+TEST_F(OneRobot, batchFK)
+{
+  constexpr std::size_t BATCH_SIZE = 8;
+  const std::size_t variable_count = robot_model_->getVariableCount();
+  const std::size_t link_count = robot_model_->getLinkModelCount();
+
+  std::vector<moveit::core::RobotState> states;
+  std::vector<double> positions(BATCH_SIZE * variable_count);
+  for (std::size_t i = 0; i < BATCH_SIZE; ++i)
+  {
+    states.emplace_back(robot_model_);
+    states.back().setToRandomPositions();
+    states.back().update();
+    std::copy_n(states.back().getVariablePositions(), variable_count, positions.begin() + i * variable_count);
+  }
+
+  EigenSTL::vector_Isometry3d link_transforms(BATCH_SIZE * link_count);
+  robot_model_->computeLinkTransformsBatch(positions.data(), BATCH_SIZE, link_transforms.data());
+
+  for (const moveit::core::LinkModel* link : robot_model_->getLinkModels())
+  {
+    for (std::size_t i = 0; i < BATCH_SIZE; ++i)
+    {
+      EXPECT_TRUE(link_transforms[link->getLinkIndex() * BATCH_SIZE + i].isApprox(
+          states[i].getGlobalLinkTransform(link), EPSILON))
+          << "link " << link->getName() << ", state " << i;
+    }
+  }
+}
+
 TEST_F(OneRobot, testPrintCurrentPositionWithJointLimits)
 {
   moveit::core::RobotState state(robot_model_);
@@ -747,6 +778,73 @@ TEST_F(OneRobot, rigidlyConnectedParent)
   EXPECT_EQ(nullptr, state.getRigidlyConnectedParentLinkModel("/"));
 }
 
+TEST_F(OneRobot, attachedBodySubframesFollowParentLink)
+{
+  moveit::core::RobotState state(robot_model_);
+  state.setToDefaultValues();
+  const moveit::core::LinkModel* link_b{ robot_model_->getLinkModel("link_b") };
+  const Eigen::Isometry3d subframe_pose{ Eigen::Translation3d(0, 0, 1) };
+  state.attachBody(std::make_unique<moveit::core::AttachedBody>(
+      link_b, "object", Eigen::Isometry3d::Identity(), std::vector<shapes::ShapeConstPtr>{},
+      EigenSTL::vector_Isometry3d{}, std::set<std::string>{}, trajectory_msgs::msg::JointTrajectory{},
+      moveit::core::FixedTransformsMap{ { "subframe", subframe_pose } }));
+
+  // the subframe follows the link each time it moves, also in copies of the state
+  for (int i = 0; i < 3; ++i)
+  {
+    state.setToRandomPositions();
+    state.update();
+    const Eigen::Isometry3d expected = state.getGlobalLinkTransform(link_b) * subframe_pose;
+    EXPECT_TRUE(state.getFrameTransform("object/subframe").isApprox(expected));
+    moveit::core::RobotState copy(state);
+    EXPECT_TRUE(copy.getFrameTransform("object/subframe").isApprox(expected));
+  }
+}
+
+TEST_F(OneRobot, statePool)
+{
+  moveit::core::RobotState state(robot_model_);
+  state.setToRandomPositions();
+  state.setVariableVelocity(0, 1.0);
+  state.update();
+
+  auto pool = std::make_shared<moveit::core::RobotStatePool>(robot_model_, 4);
+  EXPECT_EQ(pool->getFreeCount(), 0u);
+
+  const moveit::core::RobotState* recycled;
+  {
+    moveit::core::RobotStatePtr copy = pool->allocate(state);
+    EXPECT_EQ(pool->getFreeCount(), 3u);
+    recycled = copy.get();
+    for (std::size_t i = 0; i < robot_model_->getVariableCount(); ++i)
+      EXPECT_EQ(copy->getVariablePosition(i), state.getVariablePosition(i));
+    EXPECT_TRUE(copy->hasVelocities());
+    copy->attachBody(std::make_unique<moveit::core::AttachedBody>(
+        robot_model_->getLinkModel("link_b"), "object", Eigen::Isometry3d::Identity(),
+        std::vector<shapes::ShapeConstPtr>{}, EigenSTL::vector_Isometry3d{}, std::set<std::string>{},
+        trajectory_msgs::msg::JointTrajectory{}));
+  }
+  EXPECT_EQ(pool->getFreeCount(), 4u);
+
+  // released states are handed out again, without the data of their previous user
+  moveit::core::RobotStatePtr fresh = pool->allocate();
+  EXPECT_EQ(fresh.get(), recycled);
+  EXPECT_FALSE(fresh->hasVelocities());
+  EXPECT_FALSE(fresh->hasAttachedBody("object"));
+
+  moveit::core::RobotState defaults(robot_model_);
+  defaults.setToDefaultValues();
+  for (std::size_t i = 0; i < robot_model_->getVariableCount(); ++i)
+    EXPECT_EQ(fresh->getVariablePosition(i), defaults.getVariablePosition(i));
+  EXPECT_TRUE(fresh->getGlobalLinkTransform("link_e").isApprox(defaults.getGlobalLinkTransform("link_e"), EPSILON));
+
+  // states may outlive their pool
+  pool.reset();
+  fresh->setVariablePosition(0, 0.1);
+  fresh->update();
+  fresh.reset();
+}
+
 TEST(getJacobian, RevoluteJoints)
 {
   // Robot URDF with four revolute joints.
@@ -1077,6 +1175,42 @@ TEST(getJacobian, GroupNotAtOrigin)
   CheckJacobian(state, *jmg, makeVector({ 0.1, 0.4, 0.3 }), makeVector({ 0.5, 0.1, 0.2 }));
 }
 
+TEST(getJacobian, FixedSize)
+{
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  moveit::core::RobotState state(robot_model);
+  const moveit::core::JointModelGroup* jmg = state.getJointModelGroup("panda_arm");
+  const moveit::core::LinkModel* tip = jmg->getLinkModels().back();
+  state.setToDefaultValues();
+  state.setJointGroupPositions(jmg, makeVector({ 0.1, -0.4, 0.3, -2.0, 0.2, 1.5, 0.7 }));
+  const Eigen::Vector3d reference_point(0.0, 0.0, 0.1);
+
+  for (bool use_quaternion_representation : { false, true })
+  {
+    Eigen::MatrixXd expected;
+    ASSERT_TRUE(state.getJacobian(jmg, tip, reference_point, expected, use_quaternion_representation));
+    if (use_quaternion_representation)
+    {
+      Eigen::Matrix<double, 7, 7> jacobian;
+      ASSERT_TRUE(state.getJacobian(jmg, tip, reference_point, jacobian));
+      EXPECT_NEAR_TRACED(jacobian, expected);
+    }
+    else
+    {
+      Eigen::Matrix<double, 6, 7> jacobian;
+      ASSERT_TRUE(state.getJacobian<6, 7>(jmg, tip, reference_point, jacobian));
+      EXPECT_NEAR_TRACED(jacobian, expected);
+      Eigen::Matrix<double, 6, Eigen::Dynamic> dynamic_columns;
+      ASSERT_TRUE(state.getJacobian(jmg, tip, reference_point, dynamic_columns));
+      EXPECT_NEAR_TRACED(dynamic_columns, expected);
+    }
+  }
+
+  // the columns must match the group
+  Eigen::Matrix<double, 6, 6> too_small;
+  EXPECT_FALSE(state.getJacobian(jmg, tip, reference_point, too_small));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -351,6 +351,60 @@ TEST_F(LoadPlanningModelsPr2, ObjectPoseAndSubframes)
   EXPECT_TRUE(p.isApprox(p2, EPSILON));
 }
 
+TEST_F(LoadPlanningModelsPr2, DirtySubtrees)
+{
+  moveit::core::RobotState ks(robot_model_);
+  ks.setToDefaultValues();
+
+  const auto identity = Eigen::Isometry3d::Identity();
+  std::vector<shapes::ShapeConstPtr> shapes = { std::make_shared<shapes::Box>(.1, .1, .1) };
+  EigenSTL::vector_Isometry3d poses = { identity };
+  trajectory_msgs::msg::JointTrajectory empty_state;
+  ks.attachBody(std::make_unique<moveit::core::AttachedBody>(robot_model_->getLinkModel("l_gripper_palm_link"), "boxL",
+                                                             identity, shapes, poses, std::set<std::string>(),
+                                                             empty_state));
+  ks.attachBody(std::make_unique<moveit::core::AttachedBody>(robot_model_->getLinkModel("r_gripper_palm_link"), "boxR",
+                                                             identity, shapes, poses, std::set<std::string>(),
+                                                             empty_state));
+  ks.update();
+
+  // move both arms and a few single joints, so that several disjoint subtrees are dirty
+  moveit::core::RobotState reference(ks);
+  const std::vector<std::string> joints = { "l_wrist_roll_joint", "r_wrist_roll_joint", "l_shoulder_pan_joint",
+                                            "r_forearm_roll_joint", "head_pan_joint", "torso_lift_joint" };
+  for (std::size_t i = 0; i < joints.size(); ++i)
+  {
+    const double position = ks.getVariablePosition(joints[i]) + 0.05 * (i + 1);
+    ks.setVariablePosition(joints[i], position);
+    reference.setVariablePosition(joints[i], position);
+    EXPECT_TRUE(ks.dirtyCollisionBodyTransforms());
+
+    // compare against a state in which everything is recomputed
+    ks.update();
+    reference.update(true);
+    for (const moveit::core::LinkModel* link : robot_model_->getLinkModelsWithCollisionGeometry())
+    {
+      EXPECT_TRUE(ks.getGlobalLinkTransform(link).isApprox(reference.getGlobalLinkTransform(link)))
+          << link->getName();
+      EXPECT_TRUE(ks.getCollisionBodyTransform(link, 0).isApprox(reference.getCollisionBodyTransform(link, 0)))
+          << link->getName();
+    }
+    for (const char* body : { "boxL", "boxR" })
+    {
+      EXPECT_TRUE(
+          ks.getAttachedBody(body)->getGlobalPose().isApprox(reference.getAttachedBody(body)->getGlobalPose()));
+    }
+
+    // keep the previous joints dirty for the next iteration
+    for (std::size_t j = 0; j <= i; ++j)
+    {
+      const double position = ks.getVariablePosition(joints[j]) + 0.01;
+      ks.setVariablePosition(joints[j], position);
+      reference.setVariablePosition(joints[j], position);
+    }
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
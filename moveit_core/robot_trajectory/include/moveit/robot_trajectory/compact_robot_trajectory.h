@@ -0,0 +1,251 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <Eigen/Core>
+#include <vector>
+
+namespace robot_trajectory
+{
+MOVEIT_CLASS_FORWARD(CompactRobotTrajectory);  // Defines CompactRobotTrajectoryPtr, ConstPtr, WeakPtr... etc
+
+/** \brief A trajectory for a single JointModelGroup that stores the group's positions, velocities and accelerations
+    of all waypoints in contiguous memory, together with the durations between waypoints.
+
+    Unlike RobotTrajectory, no RobotState is kept per waypoint. The values of all joints outside of the group are taken
+    from a single reference state, and full RobotStates are only constructed when requested via getWayPoint() or
+    toRobotTrajectory(). */
+class CompactRobotTrajectory
+{
+public:
+  /** @brief Construct an empty trajectory for \e group. Joints outside of the group take their values from
+   *  \e reference_state. Throws std::invalid_argument if \e group is nullptr. */
+  CompactRobotTrajectory(const moveit::core::RobotState& reference_state, const moveit::core::JointModelGroup* group);
+
+  /** @brief Copy the group values and durations of all waypoints of \e trajectory. The first waypoint (or default
+   *  values if the trajectory is empty) serves as reference state. Throws std::invalid_argument if \e trajectory
+   *  has no group. */
+  explicit CompactRobotTrajectory(const RobotTrajectory& trajectory);
+
+  const moveit::core::RobotModelConstPtr& getRobotModel() const
+  {
+    return reference_state_.getRobotModel();
+  }
+
+  const moveit::core::JointModelGroup* getGroup() const
+  {
+    return group_;
+  }
+
+  const std::string& getGroupName() const
+  {
+    return group_->getName();
+  }
+
+  const moveit::core::RobotState& getReferenceState() const
+  {
+    return reference_state_;
+  }
+
+  /** @brief The number of group variables stored per waypoint */
+  std::size_t getVariableCount() const
+  {
+    return variable_count_;
+  }
+
+  std::size_t getWayPointCount() const
+  {
+    return duration_from_previous_.size();
+  }
+
+  std::size_t size() const
+  {
+    return duration_from_previous_.size();
+  }
+
+  bool empty() const
+  {
+    return duration_from_previous_.empty();
+  }
+
+  /** @brief True if at least one waypoint was added with velocities. Waypoints without velocities store zeros. */
+  bool hasVelocities() const
+  {
+    return has_velocities_;
+  }
+
+  /** @brief True if at least one waypoint was added with accelerations. Waypoints without accelerations store zeros. */
+  bool hasAccelerations() const
+  {
+    return has_accelerations_;
+  }
+
+  /** @brief The group positions of all waypoints, one column per waypoint */
+  Eigen::Map<const Eigen::MatrixXd> getPositions() const
+  {
+    return Eigen::Map<const Eigen::MatrixXd>(positions_.data(), variable_count_, size());
+  }
+
+  Eigen::Map<const Eigen::MatrixXd> getVelocities() const
+  {
+    return Eigen::Map<const Eigen::MatrixXd>(velocities_.data(), variable_count_, size());
+  }
+
+  Eigen::Map<const Eigen::MatrixXd> getAccelerations() const
+  {
+    return Eigen::Map<const Eigen::MatrixXd>(accelerations_.data(), variable_count_, size());
+  }
+
+  Eigen::Map<const Eigen::VectorXd> getWayPointPositions(std::size_t index) const
+  {
+    return Eigen::Map<const Eigen::VectorXd>(positions_.data() + index * variable_count_, variable_count_);
+  }
+
+  Eigen::Map<Eigen::VectorXd> getWayPointPositions(std::size_t index)
+  {
+    return Eigen::Map<Eigen::VectorXd>(positions_.data() + index * variable_count_, variable_count_);
+  }
+
+  Eigen::Map<const Eigen::VectorXd> getWayPointVelocities(std::size_t index) const
+  {
+    return Eigen::Map<const Eigen::VectorXd>(velocities_.data() + index * variable_count_, variable_count_);
+  }
+
+  /** @brief Mutable access to the velocities of a waypoint. Marks the trajectory as having velocities. */
+  Eigen::Map<Eigen::VectorXd> getWayPointVelocities(std::size_t index)
+  {
+    has_velocities_ = true;
+    return Eigen::Map<Eigen::VectorXd>(velocities_.data() + index * variable_count_, variable_count_);
+  }
+
+  Eigen::Map<const Eigen::VectorXd> getWayPointAccelerations(std::size_t index) const
+  {
+    return Eigen::Map<const Eigen::VectorXd>(accelerations_.data() + index * variable_count_, variable_count_);
+  }
+
+  /** @brief Mutable access to the accelerations of a waypoint. Marks the trajectory as having accelerations. */
+  Eigen::Map<Eigen::VectorXd> getWayPointAccelerations(std::size_t index)
+  {
+    has_accelerations_ = true;
+    return Eigen::Map<Eigen::VectorXd>(accelerations_.data() + index * variable_count_, variable_count_);
+  }
+
+  const std::vector<double>& getWayPointDurations() const
+  {
+    return duration_from_previous_;
+  }
+
+  double getWayPointDurationFromPrevious(std::size_t index) const
+  {
+    return index < duration_from_previous_.size() ? duration_from_previous_[index] : 0.0;
+  }
+
+  CompactRobotTrajectory& setWayPointDurationFromPrevious(std::size_t index, double value)
+  {
+    duration_from_previous_[index] = value;
+    return *this;
+  }
+
+  /** @brief  Returns the duration after start that a waypoint will be reached.
+   *  @param  The waypoint index.
+   *  @return The duration from start; returns overall duration if index is out of range.
+   */
+  double getWayPointDurationFromStart(std::size_t index) const;
+
+  double getDuration() const;
+
+  double getAverageSegmentDuration() const;
+
+  /** @brief Reserve memory for \e num_waypoints waypoints */
+  CompactRobotTrajectory& reserve(std::size_t num_waypoints);
+
+  CompactRobotTrajectory& clear();
+
+  /**
+   * \brief Add a point to the trajectory
+   * \param positions - group positions, ordered as the group variables
+   * \param dt - duration from previous
+   */
+  CompactRobotTrajectory& addSuffixWayPoint(const Eigen::Ref<const Eigen::VectorXd>& positions, double dt);
+
+  /**
+   * \brief Add a point with velocities and accelerations to the trajectory
+   * \param positions - group positions, ordered as the group variables
+   * \param velocities - group velocities
+   * \param accelerations - group accelerations
+   * \param dt - duration from previous
+   */
+  CompactRobotTrajectory& addSuffixWayPoint(const Eigen::Ref<const Eigen::VectorXd>& positions,
+                                            const Eigen::Ref<const Eigen::VectorXd>& velocities,
+                                            const Eigen::Ref<const Eigen::VectorXd>& accelerations, double dt);
+
+  /**
+   * \brief Add the group values of \e state to the trajectory. Velocities and accelerations are copied if set.
+   * \param state - robot state
+   * \param dt - duration from previous
+   */
+  CompactRobotTrajectory& addSuffixWayPoint(const moveit::core::RobotState& state, double dt);
+
+  /** @brief Unwind the continuous joints of the group */
+  CompactRobotTrajectory& unwind();
+
+  /** @brief Write the values of waypoint \e index into \e state and update its transforms. Only the group variables
+   *  are written, so \e state should have been copied from the reference state. */
+  void getWayPoint(std::size_t index, moveit::core::RobotState& state) const;
+
+  /** @brief Construct a full RobotState for waypoint \e index from the reference state */
+  moveit::core::RobotStatePtr getWayPointState(std::size_t index) const;
+
+  /** @brief Materialize all waypoints into a RobotTrajectory */
+  RobotTrajectory toRobotTrajectory() const;
+
+  /** @brief Same as RobotTrajectory::getRobotTrajectoryMsg(), restricted to the active joints of the group */
+  void getRobotTrajectoryMsg(moveit_msgs::msg::RobotTrajectory& trajectory,
+                             const std::vector<std::string>& joint_filter = std::vector<std::string>()) const;
+
+private:
+  moveit::core::RobotState reference_state_;
+  const moveit::core::JointModelGroup* group_;
+  std::size_t variable_count_;
+  std::vector<double> positions_;
+  std::vector<double> velocities_;
+  std::vector<double> accelerations_;
+  std::vector<double> duration_from_previous_;
+  bool has_velocities_;
+  bool has_accelerations_;
+};
+}  // namespace robot_trajectory
@@ -38,11 +38,14 @@
 
 #include <moveit/macros/class_forward.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_state/robot_state_pool.h>
 #include <moveit_msgs/msg/robot_trajectory.hpp>
 #include <moveit_msgs/msg/robot_state.hpp>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include <rcl/error_handling.h>
 #include <rcl/time.h>
@@ -97,6 +100,21 @@ public:
 
   const std::string& getGroupName() const;
 
+  /** @brief Take the waypoints that are copied into this trajectory from \e pool instead of allocating them.
+   *  Passing nullptr allocates each waypoint separately again.
+   */
+  RobotTrajectory& setStatePool(const moveit::core::RobotStatePoolPtr& pool)
+  {
+    assert(!pool || pool->getRobotModel() == robot_model_);
+    state_pool_ = pool;
+    return *this;
+  }
+
+  const moveit::core::RobotStatePoolPtr& getStatePool() const
+  {
+    return state_pool_;
+  }
+
   RobotTrajectory& setGroupName(const std::string& group_name)
   {
     group_ = robot_model_->getJointModelGroup(group_name);
@@ -172,6 +190,7 @@ public:
     if (duration_from_previous_.size() <= index)
       duration_from_previous_.resize(index + 1, 0.0);
     duration_from_previous_[index] = value;
+    invalidateDurationIndex();
     return *this;
   }
 
@@ -187,7 +206,7 @@ public:
    */
   RobotTrajectory& addSuffixWayPoint(const moveit::core::RobotState& state, double dt)
   {
-    return addSuffixWayPoint(std::make_shared<moveit::core::RobotState>(state), dt);
+    return addSuffixWayPoint(copyState(state), dt);
   }
 
   /**
@@ -200,12 +219,13 @@ public:
     state->update();
     waypoints_.push_back(state);
     duration_from_previous_.push_back(dt);
+    invalidateDurationIndex();
     return *this;
   }
 
   RobotTrajectory& addPrefixWayPoint(const moveit::core::RobotState& state, double dt)
   {
-    return addPrefixWayPoint(std::make_shared<moveit::core::RobotState>(state), dt);
+    return addPrefixWayPoint(copyState(state), dt);
   }
 
   RobotTrajectory& addPrefixWayPoint(const moveit::core::RobotStatePtr& state, double dt)
@@ -213,12 +233,13 @@ public:
     state->update();
     waypoints_.push_front(state);
     duration_from_previous_.push_front(dt);
+    invalidateDurationIndex();
     return *this;
   }
 
   RobotTrajectory& insertWayPoint(std::size_t index, const moveit::core::RobotState& state, double dt)
   {
-    return insertWayPoint(index, std::make_shared<moveit::core::RobotState>(state), dt);
+    return insertWayPoint(index, copyState(state), dt);
   }
 
   RobotTrajectory& insertWayPoint(std::size_t index, const moveit::core::RobotStatePtr& state, double dt)
@@ -226,6 +247,7 @@ public:
     state->update();
     waypoints_.insert(waypoints_.begin() + index, state);
     duration_from_previous_.insert(duration_from_previous_.begin() + index, dt);
+    invalidateDurationIndex();
     return *this;
   }
 
@@ -248,6 +270,7 @@ public:
   {
     waypoints_.clear();
     duration_from_previous_.clear();
+    invalidateDurationIndex();
     return *this;
   }
 
@@ -295,6 +318,9 @@ public:
   RobotTrajectory& unwind(const moveit::core::RobotState& state);
 
   /** @brief Finds the waypoint indices before and after a duration from start.
+   *  The waypoint is found by binary search in the cumulative durations, which are computed once after the durations
+   *  change. Queries with increasing durations, as made while executing or sampling a trajectory, check the segment
+   *  of the previous query first and take constant time.
    *  @param The duration from start.
    *  @param The waypoint index before the supplied duration.
    *  @param The waypoint index after (or equal to) the supplied duration.
@@ -380,11 +406,45 @@ public:
    */
   void print(std::ostream& out, std::vector<int> variable_indexes = std::vector<int>()) const;
 
+  /** @brief Add the memory held by this trajectory to \e usage.
+   *
+   * Waypoints shared with other trajectories (e.g. by copies made without deep_copy) and shapes shared with
+   * the planning scene are counted only once per \e usage. */
+  void getMemoryUsage(moveit::core::MemoryUsage& usage) const;
+
 private:
+  /** @brief Copy \e state into a new waypoint, taken from the state pool if one is set */
+  moveit::core::RobotStatePtr copyState(const moveit::core::RobotState& state) const
+  {
+    return state_pool_ ? state_pool_->allocate(state) : std::make_shared<moveit::core::RobotState>(state);
+  }
+
+  /** @brief The durations from start of all waypoints, for the time queries */
+  struct DurationIndex
+  {
+    std::vector<double> from_start;
+    // the waypoint found by the last query, most callers query increasing durations
+    mutable std::atomic<std::size_t> cursor{ 0 };
+  };
+
+  /** @brief Get the duration index, building it if the durations changed since it was last built */
+  std::shared_ptr<const DurationIndex> getDurationIndex() const;
+
+  /** @brief The index of the first waypoint reached at or after \e duration, the waypoint count if there is none */
+  std::size_t findWayPointIndexForDuration(double duration) const;
+
+  void invalidateDurationIndex()
+  {
+    duration_index_.reset();
+  }
+
   moveit::core::RobotModelConstPtr robot_model_;
   const moveit::core::JointModelGroup* group_;
   std::deque<moveit::core::RobotStatePtr> waypoints_;
   std::deque<double> duration_from_previous_;
+  moveit::core::RobotStatePoolPtr state_pool_;
+  // built on demand by const queries, so it is swapped atomically; immutable apart from the cursor once built
+  mutable std::shared_ptr<const DurationIndex> duration_index_;
 };
 
 /** @brief Operator overload for printing trajectory to a stream */
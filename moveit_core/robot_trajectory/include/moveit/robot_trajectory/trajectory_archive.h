@@ -0,0 +1,182 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+/** \file trajectory_archive.h
+ *  \brief compact append-only files of joint trajectories, e.g. for logging planned and executed motions
+ */
+
+#include <moveit/utils/mapped_file.h>
+#include <trajectory_msgs/msg/joint_trajectory.hpp>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace robot_trajectory
+{
+/** \brief How velocities or accelerations are stored in a trajectory archive */
+enum class ArchiveEncoding
+{
+  NONE,
+  FLOAT16,
+  DOUBLE
+};
+
+struct TrajectoryArchiveOptions
+{
+  /** \brief Positions are stored as multiples of this (in radians or meters). Times are stored in nanoseconds. */
+  double position_resolution = 1e-6;
+  ArchiveEncoding velocities = ArchiveEncoding::FLOAT16;
+  ArchiveEncoding accelerations = ArchiveEncoding::NONE;
+};
+
+/** \brief Appends joint trajectories to an archive file.
+
+    Each trajectory is stored column by column: the waypoint times and the positions of each joint are quantized and
+    delta-encoded as variable-length integers, so slowly changing columns take one or two bytes per value. Velocities
+    and accelerations are optionally stored as float16 or double. Joint names are stored once per archive for each
+    distinct set of names. Every trajectory is flushed as soon as it is written, so the archive of a process that dies
+    is only missing the trajectory that was being written. Opening an existing archive appends to it. Writing is
+    thread-safe. The multi-DOF part of trajectories is not stored. */
+class TrajectoryArchiveWriter
+{
+public:
+  /** \brief Open \e filename for appending, creating it if it does not exist. Check isOpen() for errors. */
+  explicit TrajectoryArchiveWriter(const std::string& filename,
+                                   const TrajectoryArchiveOptions& options = TrajectoryArchiveOptions());
+
+  bool isOpen() const
+  {
+    return out_.is_open() && out_.good();
+  }
+
+  const std::string& getFilename() const
+  {
+    return filename_;
+  }
+
+  /** \brief Append \e trajectory with a free-form \e label (e.g. "planned" or "executed") and a \e stamp in
+   *  nanoseconds. Returns false if the archive is not open or the trajectory has non-finite or mismatching values. */
+  bool write(const trajectory_msgs::msg::JointTrajectory& trajectory, const std::string& label, std::int64_t stamp);
+
+private:
+  std::string filename_;
+  TrajectoryArchiveOptions options_;
+  std::mutex lock_;
+  std::ofstream out_;
+  std::map<std::vector<std::string>, std::uint32_t> joint_sets_;
+};
+
+/** \brief Random access to the trajectories of an archive written by TrajectoryArchiveWriter.
+
+    The archive is memory-mapped and indexed on construction by skipping from record to record, which reads a few
+    bytes per trajectory. Trajectories are only decoded when read. An incomplete last record, as left by a process
+    that died while writing, is ignored. The reader sees the archive as it was when the reader was constructed. */
+class TrajectoryArchiveReader
+{
+public:
+  explicit TrajectoryArchiveReader(const std::string& filename);
+
+  /** \brief False if the file could not be read or is not a trajectory archive */
+  bool isValid() const
+  {
+    return valid_;
+  }
+
+  /** \brief The number of trajectories in the archive */
+  std::size_t size() const
+  {
+    return entries_.size();
+  }
+
+  bool empty() const
+  {
+    return entries_.empty();
+  }
+
+  /** \brief The stamp the trajectory at \e index was written with, in nanoseconds */
+  std::int64_t getStamp(std::size_t index) const
+  {
+    return entries_.at(index).stamp;
+  }
+
+  const std::string& getLabel(std::size_t index) const
+  {
+    return entries_.at(index).label;
+  }
+
+  const std::vector<std::string>& getJointNames(std::size_t index) const
+  {
+    return joint_sets_.at(entries_.at(index).joint_set);
+  }
+
+  std::size_t getWayPointCount(std::size_t index) const
+  {
+    return entries_.at(index).point_count;
+  }
+
+  /** \brief Decode the trajectory at \e index. Returns false and logs an error if the record is corrupt. Throws
+   *  std::out_of_range if \e index is not less than size(). */
+  bool read(std::size_t index, trajectory_msgs::msg::JointTrajectory& trajectory) const;
+
+  /** \brief The number of bytes at the start of the file that hold the header and complete records */
+  std::size_t getValidSize() const
+  {
+    return valid_size_;
+  }
+
+private:
+  friend class TrajectoryArchiveWriter;
+
+  struct Entry
+  {
+    std::int64_t stamp;
+    std::string label;
+    std::uint32_t joint_set;
+    std::uint32_t point_count;
+    std::size_t offset;  // of the record header
+  };
+
+  moveit::core::MappedFile file_;
+  std::string filename_;
+  bool valid_{ false };
+  std::size_t valid_size_{ 0 };
+  std::vector<std::vector<std::string>> joint_sets_;
+  std::vector<Entry> entries_;
+};
+}  // namespace robot_trajectory
@@ -0,0 +1,104 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+/** \file trajectory_transport.h
+ *  \brief compact binary encoding of robot trajectories for sending them between nodes
+ */
+
+#include <moveit_msgs/msg/robot_trajectory.hpp>
+#include <rclcpp/type_adapter.hpp>
+#include <std_msgs/msg/u_int8_multi_array.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace robot_trajectory
+{
+struct CompactTrajectoryOptions
+{
+  /** \brief Store positions, velocities, accelerations and efforts as float instead of double. Times are always
+   *  stored in nanoseconds, multi-DOF transforms and twists always as double. */
+  bool single_precision = false;
+};
+
+/** \brief Encode \e trajectory into \e buffer.
+
+    Unlike the serialized message, which stores a header and four arrays per waypoint, the encoding stores the joint
+    names and stamp of each of the joint and multi-DOF trajectories once, followed by dense arrays of the waypoint
+    times and values, one row per waypoint. Velocities, accelerations and efforts are stored if all waypoints have
+    them. Decoding allocates only the message itself, and encoding and decoding are plain copies of contiguous
+    memory. Values are stored in the byte order of the host, decoding on a host of the other byte order fails.
+
+    Returns false and logs an error if the waypoints of a trajectory do not all have one position per joint, or have
+    some but not all of the velocities, accelerations or efforts. Such trajectories need to be sent as messages. */
+bool encodeCompactTrajectory(const moveit_msgs::msg::RobotTrajectory& trajectory, std::vector<std::uint8_t>& buffer,
+                             const CompactTrajectoryOptions& options = CompactTrajectoryOptions());
+
+/** \brief Decode a trajectory encoded by encodeCompactTrajectory(). Returns false and logs an error if \e data is not
+ *  a complete encoded trajectory. */
+bool decodeCompactTrajectory(const std::uint8_t* data, std::size_t size, moveit_msgs::msg::RobotTrajectory& trajectory);
+
+inline bool decodeCompactTrajectory(const std::vector<std::uint8_t>& buffer,
+                                    moveit_msgs::msg::RobotTrajectory& trajectory)
+{
+  return decodeCompactTrajectory(buffer.data(), buffer.size(), trajectory);
+}
+
+/** \brief Publish or subscribe RobotTrajectory messages in the compact encoding, by using
+ *  CompactTrajectoryAdapter as message type. Within a process, the messages are passed without conversion. */
+using CompactTrajectoryAdapter = rclcpp::TypeAdapter<moveit_msgs::msg::RobotTrajectory, std_msgs::msg::UInt8MultiArray>;
+}  // namespace robot_trajectory
+
+template <>
+struct rclcpp::TypeAdapter<moveit_msgs::msg::RobotTrajectory, std_msgs::msg::UInt8MultiArray>
+{
+  using is_specialized = std::true_type;
+  using custom_type = moveit_msgs::msg::RobotTrajectory;
+  using ros_message_type = std_msgs::msg::UInt8MultiArray;
+
+  /** \brief Trajectories that cannot be encoded are sent as empty arrays, which are received as empty trajectories */
+  static void convert_to_ros_message(const custom_type& source, ros_message_type& destination)
+  {
+    if (!robot_trajectory::encodeCompactTrajectory(source, destination.data))
+      destination.data.clear();
+  }
+
+  static void convert_to_custom(const ros_message_type& source, custom_type& destination)
+  {
+    if (source.data.empty() || !robot_trajectory::decodeCompactTrajectory(source.data, destination))
+      destination = custom_type();
+  }
+};
@@ -0,0 +1,374 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <math.h>
+#include <moveit/robot_trajectory/compact_robot_trajectory.h>
+#include <rclcpp/duration.hpp>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <rclcpp/time.hpp>
+#include <tf2_eigen/tf2_eigen.hpp>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+
+namespace robot_trajectory
+{
+namespace
+{
+moveit::core::RobotState makeReferenceState(const RobotTrajectory& trajectory)
+{
+  if (!trajectory.empty())
+    return trajectory.getFirstWayPoint();
+  moveit::core::RobotState state(trajectory.getRobotModel());
+  state.setToDefaultValues();
+  return state;
+}
+}  // namespace
+
+CompactRobotTrajectory::CompactRobotTrajectory(const moveit::core::RobotState& reference_state,
+                                               const moveit::core::JointModelGroup* group)
+  : reference_state_(reference_state)
+  , group_(group)
+  , variable_count_(group ? group->getVariableCount() : 0)
+  , has_velocities_(false)
+  , has_accelerations_(false)
+{
+  if (!group_)
+    throw std::invalid_argument("CompactRobotTrajectory cannot be constructed without a JointModelGroup");
+}
+
+CompactRobotTrajectory::CompactRobotTrajectory(const RobotTrajectory& trajectory)
+  : CompactRobotTrajectory(makeReferenceState(trajectory), trajectory.getGroup())
+{
+  reserve(trajectory.getWayPointCount());
+  for (std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+    addSuffixWayPoint(trajectory.getWayPoint(i), trajectory.getWayPointDurationFromPrevious(i));
+}
+
+double CompactRobotTrajectory::getWayPointDurationFromStart(std::size_t index) const
+{
+  if (duration_from_previous_.empty())
+    return 0.0;
+  if (index >= duration_from_previous_.size())
+    index = duration_from_previous_.size() - 1;
+  return std::accumulate(duration_from_previous_.begin(), duration_from_previous_.begin() + index + 1, 0.0);
+}
+
+double CompactRobotTrajectory::getDuration() const
+{
+  return std::accumulate(duration_from_previous_.begin(), duration_from_previous_.end(), 0.0);
+}
+
+double CompactRobotTrajectory::getAverageSegmentDuration() const
+{
+  if (duration_from_previous_.empty())
+  {
+    RCLCPP_WARN(rclcpp::get_logger("RobotTrajectory"), "Too few waypoints to calculate a duration. Returning 0.");
+    return 0.0;
+  }
+
+  // If the initial segment has a duration of 0, exclude it from the average calculation
+  if (duration_from_previous_[0] == 0)
+  {
+    if (duration_from_previous_.size() <= 1)
+    {
+      RCLCPP_WARN(rclcpp::get_logger("RobotTrajectory"), "First and only waypoint has a duration of 0.");
+      return 0.0;
+    }
+    else
+      return getDuration() / static_cast<double>(duration_from_previous_.size() - 1);
+  }
+  else
+    return getDuration() / static_cast<double>(duration_from_previous_.size());
+}
+
+CompactRobotTrajectory& CompactRobotTrajectory::reserve(std::size_t num_waypoints)
+{
+  positions_.reserve(num_waypoints * variable_count_);
+  velocities_.reserve(num_waypoints * variable_count_);
+  accelerations_.reserve(num_waypoints * variable_count_);
+  duration_from_previous_.reserve(num_waypoints);
+  return *this;
+}
+
+CompactRobotTrajectory& CompactRobotTrajectory::clear()
+{
+  positions_.clear();
+  velocities_.clear();
+  accelerations_.clear();
+  duration_from_previous_.clear();
+  has_velocities_ = false;
+  has_accelerations_ = false;
+  return *this;
+}
+
+CompactRobotTrajectory& CompactRobotTrajectory::addSuffixWayPoint(const Eigen::Ref<const Eigen::VectorXd>& positions,
+                                                                  double dt)
+{
+  assert(static_cast<std::size_t>(positions.size()) == variable_count_);
+  positions_.insert(positions_.end(), positions.data(), positions.data() + variable_count_);
+  velocities_.resize(positions_.size(), 0.0);
+  accelerations_.resize(positions_.size(), 0.0);
+  duration_from_previous_.push_back(dt);
+  return *this;
+}
+
+CompactRobotTrajectory&
+CompactRobotTrajectory::addSuffixWayPoint(const Eigen::Ref<const Eigen::VectorXd>& positions,
+                                          const Eigen::Ref<const Eigen::VectorXd>& velocities,
+                                          const Eigen::Ref<const Eigen::VectorXd>& accelerations, double dt)
+{
+  assert(static_cast<std::size_t>(velocities.size()) == variable_count_);
+  assert(static_cast<std::size_t>(accelerations.size()) == variable_count_);
+  positions_.insert(positions_.end(), positions.data(), positions.data() + variable_count_);
+  velocities_.insert(velocities_.end(), velocities.data(), velocities.data() + variable_count_);
+  accelerations_.insert(accelerations_.end(), accelerations.data(), accelerations.data() + variable_count_);
+  duration_from_previous_.push_back(dt);
+  has_velocities_ = true;
+  has_accelerations_ = true;
+  return *this;
+}
+
+CompactRobotTrajectory& CompactRobotTrajectory::addSuffixWayPoint(const moveit::core::RobotState& state, double dt)
+{
+  const std::size_t offset = positions_.size();
+  positions_.resize(offset + variable_count_);
+  velocities_.resize(offset + variable_count_, 0.0);
+  accelerations_.resize(offset + variable_count_, 0.0);
+  state.copyJointGroupPositions(group_, positions_.data() + offset);
+  if (state.hasVelocities())
+  {
+    state.copyJointGroupVelocities(group_, velocities_.data() + offset);
+    has_velocities_ = true;
+  }
+  if (state.hasAccelerations())
+  {
+    state.copyJointGroupAccelerations(group_, accelerations_.data() + offset);
+    has_accelerations_ = true;
+  }
+  duration_from_previous_.push_back(dt);
+  return *this;
+}
+
+CompactRobotTrajectory& CompactRobotTrajectory::unwind()
+{
+  if (empty())
+    return *this;
+
+  const std::size_t num_waypoints = size();
+  for (const moveit::core::JointModel* cont_joint : group_->getContinuousJointModels())
+  {
+    const int column = group_->getVariableGroupIndex(cont_joint->getName());
+    if (column < 0)
+      continue;
+    double* positions = positions_.data() + column;
+
+    // unwrap continuous joints
+    double running_offset = 0.0;
+    double last_value = positions[0];
+    cont_joint->enforcePositionBounds(&last_value);
+    positions[0] = last_value;
+
+    for (std::size_t j = 1; j < num_waypoints; ++j)
+    {
+      double current_value = positions[j * variable_count_];
+      cont_joint->enforcePositionBounds(&current_value);
+      if (last_value > current_value + M_PI)
+      {
+        running_offset += 2.0 * M_PI;
+      }
+      else if (current_value > last_value + M_PI)
+      {
+        running_offset -= 2.0 * M_PI;
+      }
+
+      last_value = current_value;
+      positions[j * variable_count_] = current_value + running_offset;
+    }
+  }
+
+  return *this;
+}
+
+void CompactRobotTrajectory::getWayPoint(std::size_t index, moveit::core::RobotState& state) const
+{
+  const std::size_t offset = index * variable_count_;
+  state.setJointGroupPositions(group_, positions_.data() + offset);
+  if (has_velocities_)
+    state.setJointGroupVelocities(group_, velocities_.data() + offset);
+  if (has_accelerations_)
+    state.setJointGroupAccelerations(group_, accelerations_.data() + offset);
+  state.update();
+}
+
+moveit::core::RobotStatePtr CompactRobotTrajectory::getWayPointState(std::size_t index) const
+{
+  auto state = std::make_shared<moveit::core::RobotState>(reference_state_);
+  getWayPoint(index, *state);
+  return state;
+}
+
+RobotTrajectory CompactRobotTrajectory::toRobotTrajectory() const
+{
+  RobotTrajectory trajectory(getRobotModel(), group_);
+  for (std::size_t i = 0; i < size(); ++i)
+    trajectory.addSuffixWayPoint(getWayPointState(i), duration_from_previous_[i]);
+  return trajectory;
+}
+
+void CompactRobotTrajectory::getRobotTrajectoryMsg(moveit_msgs::msg::RobotTrajectory& trajectory,
+                                                   const std::vector<std::string>& joint_filter) const
+{
+  trajectory = moveit_msgs::msg::RobotTrajectory();
+  if (empty())
+    return;
+
+  // Group indices of the first variable of each exported joint
+  std::vector<std::size_t> onedof;
+  std::vector<const moveit::core::JointModel*> mdof;
+  std::vector<std::size_t> mdof_columns;
+
+  for (const moveit::core::JointModel* active_joint : group_->getActiveJointModels())
+  {
+    // only consider joints listed in joint_filter
+    if (!joint_filter.empty() &&
+        std::find(joint_filter.begin(), joint_filter.end(), active_joint->getName()) == joint_filter.end())
+      continue;
+
+    const int column = group_->getVariableGroupIndex(active_joint->getVariableNames()[0]);
+    if (column < 0)
+      continue;
+
+    if (active_joint->getVariableCount() == 1)
+    {
+      trajectory.joint_trajectory.joint_names.push_back(active_joint->getName());
+      onedof.push_back(column);
+    }
+    else
+    {
+      trajectory.multi_dof_joint_trajectory.joint_names.push_back(active_joint->getName());
+      mdof.push_back(active_joint);
+      mdof_columns.push_back(column);
+    }
+  }
+
+  const std::size_t num_waypoints = size();
+  if (!onedof.empty())
+  {
+    trajectory.joint_trajectory.header.frame_id = getRobotModel()->getModelFrame();
+    trajectory.joint_trajectory.header.stamp = rclcpp::Time(0, 0, RCL_ROS_TIME);
+    trajectory.joint_trajectory.points.resize(num_waypoints);
+  }
+
+  // Multi-DOF joint transforms are computed on a single scratch state instead of one state per waypoint
+  std::optional<moveit::core::RobotState> scratch;
+  if (!mdof.empty())
+  {
+    trajectory.multi_dof_joint_trajectory.header.frame_id = getRobotModel()->getModelFrame();
+    trajectory.multi_dof_joint_trajectory.header.stamp = rclcpp::Time(0, 0, RCL_ROS_TIME);
+    trajectory.multi_dof_joint_trajectory.points.resize(num_waypoints);
+    scratch.emplace(reference_state_);
+  }
+
+  double total_time = 0.0;
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+  {
+    total_time += duration_from_previous_[i];
+    const auto time_from_start = rclcpp::Duration::from_seconds(total_time);
+    const std::size_t offset = i * variable_count_;
+
+    if (!onedof.empty())
+    {
+      auto& point = trajectory.joint_trajectory.points[i];
+      point.positions.resize(onedof.size());
+      if (has_velocities_)
+        point.velocities.resize(onedof.size());
+      if (has_accelerations_)
+        point.accelerations.resize(onedof.size());
+      for (std::size_t j = 0; j < onedof.size(); ++j)
+      {
+        point.positions[j] = positions_[offset + onedof[j]];
+        if (has_velocities_)
+          point.velocities[j] = velocities_[offset + onedof[j]];
+        if (has_accelerations_)
+          point.accelerations[j] = accelerations_[offset + onedof[j]];
+      }
+      point.time_from_start = time_from_start;
+    }
+
+    if (!mdof.empty())
+    {
+      scratch->setJointGroupPositions(group_, positions_.data() + offset);
+      auto& point = trajectory.multi_dof_joint_trajectory.points[i];
+      point.transforms.resize(mdof.size());
+      for (std::size_t j = 0; j < mdof.size(); ++j)
+      {
+        geometry_msgs::msg::TransformStamped ts = tf2::eigenToTransform(scratch->getJointTransform(mdof[j]));
+        point.transforms[j] = ts.transform;
+        // TODO: currently only checking for planar multi DOF joints / need to add check for floating
+        if (has_velocities_ && (mdof[j]->getType() == moveit::core::JointModel::JointType::PLANAR))
+        {
+          const std::vector<std::string>& names = mdof[j]->getVariableNames();
+          const double* velocities = velocities_.data() + offset + mdof_columns[j];
+
+          geometry_msgs::msg::Twist point_velocity;
+          for (std::size_t k = 0; k < names.size(); ++k)
+          {
+            if (names[k].find("/x") != std::string::npos)
+            {
+              point_velocity.linear.x = velocities[k];
+            }
+            else if (names[k].find("/y") != std::string::npos)
+            {
+              point_velocity.linear.y = velocities[k];
+            }
+            else if (names[k].find("/z") != std::string::npos)
+            {
+              point_velocity.linear.z = velocities[k];
+            }
+            else if (names[k].find("/theta") != std::string::npos)
+            {
+              point_velocity.angular.z = velocities[k];
+            }
+          }
+          point.velocities.push_back(point_velocity);
+        }
+      }
+      point.time_from_start = time_from_start;
+    }
+  }
+}
+}  // namespace robot_trajectory
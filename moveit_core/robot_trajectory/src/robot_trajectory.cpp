@@ -42,6 +42,7 @@
 #include <rclcpp/logging.hpp>
 #include <rclcpp/time.hpp>
 #include <tf2_eigen/tf2_eigen.hpp>
+#include <algorithm>
 #include <numeric>
 #include <optional>
 
@@ -71,7 +72,7 @@ RobotTrajectory::RobotTrajectory(const RobotTrajectory& other, bool deepcopy)
     waypoints_.clear();
     for (const auto& waypoint : other.waypoints_)
     {
-      waypoints_.emplace_back(std::make_shared<moveit::core::RobotState>(*waypoint));
+      waypoints_.emplace_back(copyState(*waypoint));
     }
   }
 }
@@ -118,6 +119,7 @@ void RobotTrajectory::swap(RobotTrajectory& other)
   std::swap(group_, other.group_);
   waypoints_.swap(other.waypoints_);
   duration_from_previous_.swap(other.duration_from_previous_);
+  duration_index_.swap(other.duration_index_);
 }
 
 RobotTrajectory& RobotTrajectory::append(const RobotTrajectory& source, double dt, size_t start_index, size_t end_index)
@@ -133,6 +135,7 @@ RobotTrajectory& RobotTrajectory::append(const RobotTrajectory& source, double d
                                  std::next(source.duration_from_previous_.begin(), end_index));
   if (duration_from_previous_.size() > index)
     duration_from_previous_[index] = dt;
+  invalidateDurationIndex();
 
   return *this;
 }
@@ -150,6 +153,7 @@ RobotTrajectory& RobotTrajectory::reverse()
     duration_from_previous_.push_back(duration_from_previous_.front());
     std::reverse(duration_from_previous_.begin(), duration_from_previous_.end());
     duration_from_previous_.pop_back();
+    invalidateDurationIndex();
   }
 
   return *this;
@@ -410,18 +414,20 @@ RobotTrajectory& RobotTrajectory::setRobotTrajectoryMsg(const moveit::core::Robo
   std::size_t state_count = trajectory.points.size();
   rclcpp::Time last_time_stamp = trajectory.header.stamp;
   rclcpp::Time this_time_stamp = last_time_stamp;
+  // look up the joint names once for all points
+  const moveit::core::VariableLayoutConstPtr layout = robot_model_->getVariableLayout(trajectory.joint_names);
 
   for (std::size_t i = 0; i < state_count; ++i)
   {
     this_time_stamp = rclcpp::Time(trajectory.header.stamp) + trajectory.points[i].time_from_start;
-    auto st = std::make_shared<moveit::core::RobotState>(copy);
-    st->setVariablePositions(trajectory.joint_names, trajectory.points[i].positions);
+    auto st = copyState(copy);
+    st->setVariablePositions(*layout, trajectory.points[i].positions);
     if (!trajectory.points[i].velocities.empty())
-      st->setVariableVelocities(trajectory.joint_names, trajectory.points[i].velocities);
+      st->setVariableVelocities(*layout, trajectory.points[i].velocities);
     if (!trajectory.points[i].accelerations.empty())
-      st->setVariableAccelerations(trajectory.joint_names, trajectory.points[i].accelerations);
+      st->setVariableAccelerations(*layout, trajectory.points[i].accelerations);
     if (!trajectory.points[i].effort.empty())
-      st->setVariableEffort(trajectory.joint_names, trajectory.points[i].effort);
+      st->setVariableEffort(*layout, trajectory.points[i].effort);
     addSuffixWayPoint(st, (this_time_stamp - last_time_stamp).seconds());
     last_time_stamp = this_time_stamp;
   }
@@ -443,33 +449,35 @@ RobotTrajectory& RobotTrajectory::setRobotTrajectoryMsg(const moveit::core::Robo
                                      trajectory.joint_trajectory.header.stamp;
   rclcpp::Time this_time_stamp = last_time_stamp;
 
+  // look up the joint names once for all points
+  const moveit::core::VariableLayoutConstPtr layout =
+      robot_model_->getVariableLayout(trajectory.joint_trajectory.joint_names);
+  std::vector<const moveit::core::JointModel*> multi_dof_joints;
+  multi_dof_joints.reserve(trajectory.multi_dof_joint_trajectory.joint_names.size());
+  for (const std::string& joint_name : trajectory.multi_dof_joint_trajectory.joint_names)
+    multi_dof_joints.push_back(robot_model_->getJointModel(joint_name));
+
   for (std::size_t i = 0; i < state_count; ++i)
   {
-    auto st = std::make_shared<moveit::core::RobotState>(copy);
+    auto st = copyState(copy);
     if (trajectory.joint_trajectory.points.size() > i)
     {
-      st->setVariablePositions(trajectory.joint_trajectory.joint_names, trajectory.joint_trajectory.points[i].positions);
+      st->setVariablePositions(*layout, trajectory.joint_trajectory.points[i].positions);
       if (!trajectory.joint_trajectory.points[i].velocities.empty())
-      {
-        st->setVariableVelocities(trajectory.joint_trajectory.joint_names,
-                                  trajectory.joint_trajectory.points[i].velocities);
-      }
+        st->setVariableVelocities(*layout, trajectory.joint_trajectory.points[i].velocities);
       if (!trajectory.joint_trajectory.points[i].accelerations.empty())
-      {
-        st->setVariableAccelerations(trajectory.joint_trajectory.joint_names,
-                                     trajectory.joint_trajectory.points[i].accelerations);
-      }
+        st->setVariableAccelerations(*layout, trajectory.joint_trajectory.points[i].accelerations);
       if (!trajectory.joint_trajectory.points[i].effort.empty())
-        st->setVariableEffort(trajectory.joint_trajectory.joint_names, trajectory.joint_trajectory.points[i].effort);
+        st->setVariableEffort(*layout, trajectory.joint_trajectory.points[i].effort);
       this_time_stamp = rclcpp::Time(trajectory.joint_trajectory.header.stamp) +
                         trajectory.joint_trajectory.points[i].time_from_start;
     }
     if (trajectory.multi_dof_joint_trajectory.points.size() > i)
     {
-      for (std::size_t j = 0; j < trajectory.multi_dof_joint_trajectory.joint_names.size(); ++j)
+      for (std::size_t j = 0; j < multi_dof_joints.size(); ++j)
       {
         Eigen::Isometry3d t = tf2::transformToEigen(trajectory.multi_dof_joint_trajectory.points[i].transforms[j]);
-        st->setJointPositions(trajectory.multi_dof_joint_trajectory.joint_names[j], t);
+        st->setJointPositions(multi_dof_joints[j], t);
       }
       this_time_stamp = rclcpp::Time(trajectory.multi_dof_joint_trajectory.header.stamp) +
                         trajectory.multi_dof_joint_trajectory.points[i].time_from_start;
@@ -490,6 +498,41 @@ RobotTrajectory& RobotTrajectory::setRobotTrajectoryMsg(const moveit::core::Robo
   return setRobotTrajectoryMsg(st, trajectory);
 }
 
+std::shared_ptr<const RobotTrajectory::DurationIndex> RobotTrajectory::getDurationIndex() const
+{
+  std::shared_ptr<const DurationIndex> index = std::atomic_load(&duration_index_);
+  if (index)
+    return index;
+
+  // concurrent queries may both build the index, they store the same values
+  auto new_index = std::make_shared<DurationIndex>();
+  new_index->from_start.resize(duration_from_previous_.size());
+  std::partial_sum(duration_from_previous_.begin(), duration_from_previous_.end(), new_index->from_start.begin());
+  index = std::move(new_index);
+  std::atomic_store(&duration_index_, index);
+  return index;
+}
+
+std::size_t RobotTrajectory::findWayPointIndexForDuration(double duration) const
+{
+  const std::shared_ptr<const DurationIndex> index = getDurationIndex();
+  const std::vector<double>& from_start = index->from_start;
+  const std::size_t num_points = from_start.size();
+
+  // check the segment of the previous query and the one after it before searching
+  const auto reaches = [&](std::size_t i) {
+    return i < num_points && from_start[i] >= duration && (i == 0 || from_start[i - 1] < duration);
+  };
+  std::size_t cursor = index->cursor.load(std::memory_order_relaxed);
+  if (!reaches(cursor) && !reaches(++cursor))
+  {
+    // durations are not negative, so the durations from start are sorted
+    cursor = std::lower_bound(from_start.begin(), from_start.end(), duration) - from_start.begin();
+  }
+  index->cursor.store(cursor, std::memory_order_relaxed);
+  return cursor;
+}
+
 void RobotTrajectory::findWayPointIndicesForDurationAfterStart(const double& duration, int& before, int& after,
                                                                double& blend) const
 {
@@ -502,25 +545,19 @@ void RobotTrajectory::findWayPointIndicesForDurationAfterStart(const double& dur
   }
 
   // Find indices
-  std::size_t index = 0, num_points = waypoints_.size();
-  double running_duration = 0.0;
-  for (; index < num_points; ++index)
-  {
-    running_duration += duration_from_previous_[index];
-    if (running_duration >= duration)
-      break;
-  }
+  const std::size_t num_points = waypoints_.size();
+  const std::size_t index = findWayPointIndexForDuration(duration);
   before = std::max<int>(index - 1, 0);
   after = std::min<int>(index, num_points - 1);
 
   // Compute duration blend
-  double before_time = running_duration - duration_from_previous_[index];
-  if (after == before)
+  if (after == before || index >= num_points)
   {
     blend = 1.0;
   }
   else
   {
+    const double before_time = getDurationIndex()->from_start[index] - duration_from_previous_[index];
     blend = (duration - before_time) / duration_from_previous_[index];
   }
 }
@@ -532,10 +569,7 @@ double RobotTrajectory::getWayPointDurationFromStart(std::size_t index) const
   if (index >= duration_from_previous_.size())
     index = duration_from_previous_.size() - 1;
 
-  double time = 0.0;
-  for (std::size_t i = 0; i <= index; ++i)
-    time += duration_from_previous_[i];
-  return time;
+  return getDurationIndex()->from_start[index];
 }
 
 bool RobotTrajectory::getStateAtDurationFromStart(const double request_duration,
@@ -554,6 +588,17 @@ bool RobotTrajectory::getStateAtDurationFromStart(const double request_duration,
   return true;
 }
 
+void RobotTrajectory::getMemoryUsage(moveit::core::MemoryUsage& usage) const
+{
+  std::size_t bytes = sizeof(RobotTrajectory) + sizeof(moveit::core::RobotStatePtr) * waypoints_.size() +
+                      sizeof(double) * duration_from_previous_.size();
+  if (const std::shared_ptr<const DurationIndex> index = std::atomic_load(&duration_index_))
+    bytes += sizeof(DurationIndex) + sizeof(double) * index->from_start.capacity();
+  usage.add("trajectory", bytes);
+  for (const moveit::core::RobotStatePtr& waypoint : waypoints_)
+    waypoint->getMemoryUsage(usage);
+}
+
 void RobotTrajectory::print(std::ostream& out, std::vector<int> variable_indexes) const
 {
   size_t num_points = getWayPointCount();
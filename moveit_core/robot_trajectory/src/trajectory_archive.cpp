@@ -0,0 +1,602 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_trajectory/trajectory_archive.h>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+namespace robot_trajectory
+{
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_robot_trajectory.trajectory_archive");
+
+namespace
+{
+// Layout of an archive: the header below, followed by records. Each record is a RecordHeader followed by size bytes.
+// A JOINT_NAMES_RECORD holds a uint32 count and count names, each a uint32 length and the characters. Joint name
+// sets are numbered in the order they appear. A TRAJECTORY_RECORD holds a TrajectoryRecordHeader, the label and a
+// stream of zigzag LEB128 integers: the time deltas in nanoseconds, then per joint the deltas of the positions in
+// multiples of the resolution. The stream is followed by the velocity and then the acceleration columns in the
+// encodings given by the flags. Record sizes are padded to a multiple of 8 bytes.
+constexpr char ARCHIVE_FILE_MAGIC[8] = { 'M', 'V', 'T', 'R', 'A', 'J', 'A', 'R' };
+constexpr std::uint32_t ARCHIVE_FILE_VERSION = 1;
+constexpr std::uint32_t JOINT_NAMES_RECORD = 1;
+constexpr std::uint32_t TRAJECTORY_RECORD = 2;
+constexpr std::uint32_t ENCODING_BITS = 3;
+constexpr std::uint32_t VELOCITIES_SHIFT = 0;
+constexpr std::uint32_t ACCELERATIONS_SHIFT = 2;
+
+struct ArchiveFileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+};
+
+struct RecordHeader
+{
+  std::uint32_t type;
+  std::uint32_t size;
+};
+
+struct TrajectoryRecordHeader
+{
+  std::int64_t stamp;
+  double position_resolution;
+  std::uint32_t joint_set;
+  std::uint32_t point_count;
+  std::uint32_t flags;
+  std::uint32_t label_size;
+};
+
+std::size_t padded(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+using Encoding = ArchiveEncoding;
+
+std::size_t encodedSize(Encoding encoding)
+{
+  switch (encoding)
+  {
+    case Encoding::FLOAT16:
+      return sizeof(std::uint16_t);
+    case Encoding::DOUBLE:
+      return sizeof(double);
+    default:
+      return 0;
+  }
+}
+
+// IEEE 754 half precision conversion, rounding to nearest even
+std::uint16_t toHalf(double value)
+{
+  const float f = static_cast<float>(value);
+  std::uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  const std::uint32_t sign = (bits >> 16) & 0x8000;
+  const std::uint32_t float_exponent = (bits >> 23) & 0xff;
+  std::uint32_t mantissa = bits & 0x7fffff;
+  if (float_exponent == 0xff)  // infinity or NaN
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+  const std::int32_t exponent = static_cast<std::int32_t>(float_exponent) - 127 + 15;
+  if (exponent >= 31)  // too large, becomes infinity
+    return sign | 0x7c00;
+  if (exponent <= 0)  // subnormal or zero
+  {
+    if (exponent < -10)
+      return sign;
+    mantissa |= 0x800000;
+    const std::uint32_t shift = 14 - exponent;
+    std::uint32_t half = mantissa >> shift;
+    const std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const std::uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1)))
+      ++half;
+    return sign | half;
+  }
+  // a carry out of the mantissa correctly increments the exponent, up to infinity
+  std::uint32_t half = (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+  const std::uint32_t remainder = mantissa & 0x1fff;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    ++half;
+  return sign | half;
+}
+
+double fromHalf(std::uint16_t half)
+{
+  const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000) << 16;
+  const std::uint32_t exponent = (half >> 10) & 0x1f;
+  std::uint32_t mantissa = half & 0x3ff;
+  std::uint32_t bits;
+  if (exponent == 0x1f)
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  else if (exponent != 0)
+    bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+  else if (mantissa == 0)
+    bits = sign;
+  else  // subnormal, normalize it
+  {
+    std::uint32_t shift = 0;
+    while (!(mantissa & 0x400))
+    {
+      mantissa <<= 1;
+      ++shift;
+    }
+    bits = sign | ((127 - 14 - shift) << 23) | ((mantissa & 0x3ff) << 13);
+  }
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+void appendBytes(std::string& buffer, const void* data, std::size_t size)
+{
+  buffer.append(static_cast<const char*>(data), size);
+}
+
+void appendVarint(std::string& buffer, std::int64_t value)
+{
+  // zigzag encoding keeps small negative deltas small
+  std::uint64_t bits = (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+  while (bits >= 0x80)
+  {
+    buffer.push_back(static_cast<char>((bits & 0x7f) | 0x80));
+    bits >>= 7;
+  }
+  buffer.push_back(static_cast<char>(bits));
+}
+
+void appendValue(std::string& buffer, double value, Encoding encoding)
+{
+  if (encoding == Encoding::FLOAT16)
+  {
+    const std::uint16_t half = toHalf(value);
+    appendBytes(buffer, &half, sizeof(half));
+  }
+  else
+    appendBytes(buffer, &value, sizeof(value));
+}
+
+// Bounds-checked sequential reads from a record
+class RecordReader
+{
+public:
+  RecordReader(const char* begin, const char* end) : current_(begin), end_(end)
+  {
+  }
+
+  bool read(void* data, std::size_t size)
+  {
+    if (static_cast<std::size_t>(end_ - current_) < size)
+      return false;
+    memcpy(data, current_, size);
+    current_ += size;
+    return true;
+  }
+
+  bool readString(std::string& value, std::size_t size)
+  {
+    if (static_cast<std::size_t>(end_ - current_) < size)
+      return false;
+    value.assign(current_, size);
+    current_ += size;
+    return true;
+  }
+
+  bool readVarint(std::int64_t& value)
+  {
+    std::uint64_t bits = 0;
+    for (unsigned int shift = 0; shift < 64 && current_ != end_; shift += 7)
+    {
+      const auto byte = static_cast<unsigned char>(*current_++);
+      bits |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+      {
+        value = static_cast<std::int64_t>(bits >> 1) ^ -static_cast<std::int64_t>(bits & 1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool readValue(double& value, Encoding encoding)
+  {
+    if (encoding == Encoding::FLOAT16)
+    {
+      std::uint16_t half;
+      if (!read(&half, sizeof(half)))
+        return false;
+      value = fromHalf(half);
+      return true;
+    }
+    return read(&value, sizeof(value));
+  }
+
+  std::size_t remaining() const
+  {
+    return end_ - current_;
+  }
+
+private:
+  const char* current_;
+  const char* end_;
+};
+
+std::string encodeJointNames(const std::vector<std::string>& names)
+{
+  std::string buffer;
+  const auto count = static_cast<std::uint32_t>(names.size());
+  appendBytes(buffer, &count, sizeof(count));
+  for (const std::string& name : names)
+  {
+    const auto length = static_cast<std::uint32_t>(name.size());
+    appendBytes(buffer, &length, sizeof(length));
+    buffer += name;
+  }
+  return buffer;
+}
+
+bool decodeJointNames(RecordReader& reader, std::vector<std::string>& names)
+{
+  std::uint32_t count;
+  if (!reader.read(&count, sizeof(count)) || reader.remaining() / sizeof(std::uint32_t) < count)
+    return false;
+  names.resize(count);
+  for (std::string& name : names)
+  {
+    std::uint32_t length;
+    if (!reader.read(&length, sizeof(length)) || !reader.readString(name, length))
+      return false;
+  }
+  return true;
+}
+
+// The encoding to store a derivative with: NONE unless every waypoint has a value for every joint
+Encoding storedEncoding(const trajectory_msgs::msg::JointTrajectory& trajectory, Encoding encoding,
+                        std::vector<double> trajectory_msgs::msg::JointTrajectoryPoint::*values)
+{
+  if (trajectory.points.empty())
+    return Encoding::NONE;
+  for (const trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+  {
+    if ((point.*values).size() != trajectory.joint_names.size())
+      return Encoding::NONE;
+  }
+  return encoding;
+}
+
+std::int64_t toNanoseconds(const builtin_interfaces::msg::Duration& duration)
+{
+  return static_cast<std::int64_t>(duration.sec) * 1000000000 + duration.nanosec;
+}
+
+builtin_interfaces::msg::Duration fromNanoseconds(std::int64_t nanoseconds)
+{
+  builtin_interfaces::msg::Duration duration;
+  std::int64_t sec = nanoseconds / 1000000000;
+  std::int64_t nanosec = nanoseconds % 1000000000;
+  if (nanosec < 0)
+  {
+    nanosec += 1000000000;
+    --sec;
+  }
+  duration.sec = static_cast<std::int32_t>(sec);
+  duration.nanosec = static_cast<std::uint32_t>(nanosec);
+  return duration;
+}
+}  // namespace
+
+TrajectoryArchiveWriter::TrajectoryArchiveWriter(const std::string& filename, const TrajectoryArchiveOptions& options)
+  : filename_(filename), options_(options)
+{
+  if (!(options_.position_resolution > 0.0) || !std::isfinite(options_.position_resolution))
+  {
+    RCLCPP_ERROR(LOGGER, "Invalid position resolution %g for trajectory archive '%s'", options_.position_resolution,
+                 filename.c_str());
+    return;
+  }
+
+  std::error_code ec;
+  if (std::filesystem::file_size(filename, ec) > 0 && !ec)
+  {
+    std::size_t valid_size;
+    {
+      const TrajectoryArchiveReader reader(filename);
+      if (!reader.isValid())
+      {
+        RCLCPP_ERROR(LOGGER, "Cannot append to '%s', it is not a trajectory archive", filename.c_str());
+        return;
+      }
+      for (std::size_t i = 0; i < reader.joint_sets_.size(); ++i)
+        joint_sets_.emplace(reader.joint_sets_[i], static_cast<std::uint32_t>(i));
+      valid_size = reader.getValidSize();
+    }
+    // drop an incomplete record, so the appended records can be read
+    std::filesystem::resize_file(filename, valid_size, ec);
+    if (ec)
+    {
+      RCLCPP_ERROR(LOGGER, "Failed to truncate trajectory archive '%s': %s", filename.c_str(), ec.message().c_str());
+      return;
+    }
+    out_.open(filename, std::ios::binary | std::ios::app);
+  }
+  else
+  {
+    out_.open(filename, std::ios::binary | std::ios::trunc);
+    ArchiveFileHeader header;
+    memcpy(header.magic, ARCHIVE_FILE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_FILE_VERSION;
+    header.reserved = 0;
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_.flush();
+  }
+  if (!isOpen())
+    RCLCPP_ERROR(LOGGER, "Failed to open trajectory archive '%s' for writing", filename.c_str());
+}
+
+bool TrajectoryArchiveWriter::write(const trajectory_msgs::msg::JointTrajectory& trajectory, const std::string& label,
+                                    std::int64_t stamp)
+{
+  const std::size_t joint_count = trajectory.joint_names.size();
+  for (const trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+  {
+    if (point.positions.size() != joint_count)
+    {
+      RCLCPP_ERROR(LOGGER, "Cannot archive a trajectory with %zu joint names and a waypoint with %zu positions",
+                   joint_count, point.positions.size());
+      return false;
+    }
+    for (const double position : point.positions)
+    {
+      if (!std::isfinite(position / options_.position_resolution) ||
+          std::fabs(position / options_.position_resolution) > 1e18)
+      {
+        RCLCPP_ERROR(LOGGER, "Cannot archive a trajectory with position %g", position);
+        return false;
+      }
+    }
+  }
+
+  TrajectoryRecordHeader header;
+  header.stamp = stamp;
+  header.position_resolution = options_.position_resolution;
+  header.point_count = static_cast<std::uint32_t>(trajectory.points.size());
+  header.label_size = static_cast<std::uint32_t>(label.size());
+  const Encoding velocities =
+      storedEncoding(trajectory, options_.velocities, &trajectory_msgs::msg::JointTrajectoryPoint::velocities);
+  const Encoding accelerations =
+      storedEncoding(trajectory, options_.accelerations, &trajectory_msgs::msg::JointTrajectoryPoint::accelerations);
+  header.flags = (static_cast<std::uint32_t>(velocities) << VELOCITIES_SHIFT) |
+                 (static_cast<std::uint32_t>(accelerations) << ACCELERATIONS_SHIFT);
+
+  // encode the columns before taking the lock
+  std::string payload;
+  payload.reserve(sizeof(header) + label.size() +
+                  trajectory.points.size() *
+                      (2 + joint_count * (2 + encodedSize(velocities) + encodedSize(accelerations))));
+  payload.resize(sizeof(header));
+  payload += label;
+  std::int64_t previous = 0;
+  for (const trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+  {
+    const std::int64_t time = toNanoseconds(point.time_from_start);
+    appendVarint(payload, time - previous);
+    previous = time;
+  }
+  for (std::size_t j = 0; j < joint_count; ++j)
+  {
+    previous = 0;
+    for (const trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+    {
+      const std::int64_t quantized = std::llround(point.positions[j] / options_.position_resolution);
+      appendVarint(payload, quantized - previous);
+      previous = quantized;
+    }
+  }
+  for (const auto& [encoding, values] :
+       { std::make_pair(velocities, &trajectory_msgs::msg::JointTrajectoryPoint::velocities),
+         std::make_pair(accelerations, &trajectory_msgs::msg::JointTrajectoryPoint::accelerations) })
+  {
+    if (encoding == Encoding::NONE)
+      continue;
+    for (std::size_t j = 0; j < joint_count; ++j)
+    {
+      for (const trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+        appendValue(payload, (point.*values)[j], encoding);
+    }
+  }
+  payload.resize(padded(payload.size()), '\0');
+  if (payload.size() > UINT32_MAX)
+  {
+    RCLCPP_ERROR(LOGGER, "Trajectory with %zu waypoints is too large to archive", trajectory.points.size());
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(lock_);
+  if (!isOpen())
+    return false;
+
+  auto it = joint_sets_.find(trajectory.joint_names);
+  if (it == joint_sets_.end())
+  {
+    std::string names = encodeJointNames(trajectory.joint_names);
+    names.resize(padded(names.size()), '\0');
+    const RecordHeader names_header{ JOINT_NAMES_RECORD, static_cast<std::uint32_t>(names.size()) };
+    out_.write(reinterpret_cast<const char*>(&names_header), sizeof(names_header));
+    out_.write(names.data(), names.size());
+    it = joint_sets_.emplace(trajectory.joint_names, static_cast<std::uint32_t>(joint_sets_.size())).first;
+  }
+  header.joint_set = it->second;
+  memcpy(payload.data(), &header, sizeof(header));
+
+  const RecordHeader record_header{ TRAJECTORY_RECORD, static_cast<std::uint32_t>(payload.size()) };
+  out_.write(reinterpret_cast<const char*>(&record_header), sizeof(record_header));
+  out_.write(payload.data(), payload.size());
+  out_.flush();
+  if (!out_.good())
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to write to trajectory archive '%s'", filename_.c_str());
+    return false;
+  }
+  return true;
+}
+
+TrajectoryArchiveReader::TrajectoryArchiveReader(const std::string& filename) : file_(filename), filename_(filename)
+{
+  ArchiveFileHeader header;
+  if (file_.size() < sizeof(header))
+    return;
+  memcpy(&header, file_.begin(), sizeof(header));
+  if (memcmp(header.magic, ARCHIVE_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != ARCHIVE_FILE_VERSION)
+  {
+    RCLCPP_ERROR(LOGGER, "'%s' is not a version %u trajectory archive", filename.c_str(), ARCHIVE_FILE_VERSION);
+    return;
+  }
+  valid_ = true;
+
+  std::size_t offset = sizeof(header);
+  while (file_.size() - offset >= sizeof(RecordHeader))
+  {
+    RecordHeader record;
+    memcpy(&record, file_.begin() + offset, sizeof(record));
+    const std::size_t begin = offset + sizeof(record);
+    if (file_.size() - begin < record.size)
+      break;
+    RecordReader reader(file_.begin() + begin, file_.begin() + begin + record.size);
+
+    if (record.type == JOINT_NAMES_RECORD)
+    {
+      std::vector<std::string> names;
+      if (!decodeJointNames(reader, names))
+        break;
+      joint_sets_.push_back(std::move(names));
+    }
+    else if (record.type == TRAJECTORY_RECORD)
+    {
+      TrajectoryRecordHeader trajectory;
+      Entry entry;
+      if (!reader.read(&trajectory, sizeof(trajectory)) || !reader.readString(entry.label, trajectory.label_size) ||
+          trajectory.joint_set >= joint_sets_.size())
+        break;
+      entry.stamp = trajectory.stamp;
+      entry.joint_set = trajectory.joint_set;
+      entry.point_count = trajectory.point_count;
+      entry.offset = offset;
+      entries_.push_back(std::move(entry));
+    }
+    // skip records of unknown types, they may have been added by later versions
+    offset = begin + record.size;
+  }
+  valid_size_ = offset;
+  if (valid_size_ != file_.size())
+    RCLCPP_WARN(LOGGER, "Ignoring %zu bytes of incomplete or corrupt records at the end of trajectory archive '%s'",
+                file_.size() - valid_size_, filename.c_str());
+}
+
+bool TrajectoryArchiveReader::read(std::size_t index, trajectory_msgs::msg::JointTrajectory& trajectory) const
+{
+  const Entry& entry = entries_.at(index);
+  RecordHeader record;
+  memcpy(&record, file_.begin() + entry.offset, sizeof(record));
+  const char* begin = file_.begin() + entry.offset + sizeof(record);
+  RecordReader reader(begin, begin + record.size);
+
+  TrajectoryRecordHeader header;
+  std::string label;
+  reader.read(&header, sizeof(header));
+  reader.readString(label, header.label_size);
+  const auto velocities = static_cast<Encoding>((header.flags >> VELOCITIES_SHIFT) & ENCODING_BITS);
+  const auto accelerations = static_cast<Encoding>((header.flags >> ACCELERATIONS_SHIFT) & ENCODING_BITS);
+  const std::vector<std::string>& joint_names = joint_sets_[entry.joint_set];
+  const std::size_t joint_count = joint_names.size();
+
+  // every waypoint takes at least one byte per time and position, check before allocating
+  if (reader.remaining() / (joint_count + 1) < header.point_count || velocities > Encoding::DOUBLE ||
+      accelerations > Encoding::DOUBLE)
+  {
+    RCLCPP_ERROR(LOGGER, "Trajectory %zu of archive '%s' is corrupt", index, filename_.c_str());
+    return false;
+  }
+  trajectory.joint_names = joint_names;
+  trajectory.points.assign(header.point_count, trajectory_msgs::msg::JointTrajectoryPoint());
+
+  bool ok = true;
+  std::int64_t value = 0;
+  std::int64_t previous = 0;
+  for (trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+  {
+    ok = ok && reader.readVarint(value);
+    previous += value;
+    point.time_from_start = fromNanoseconds(previous);
+    point.positions.resize(joint_count);
+    if (velocities != Encoding::NONE)
+      point.velocities.resize(joint_count);
+    if (accelerations != Encoding::NONE)
+      point.accelerations.resize(joint_count);
+  }
+  for (std::size_t j = 0; j < joint_count && ok; ++j)
+  {
+    previous = 0;
+    for (trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+    {
+      ok = ok && reader.readVarint(value);
+      previous += value;
+      point.positions[j] = previous * header.position_resolution;
+    }
+  }
+  for (const auto& [encoding, values] :
+       { std::make_pair(velocities, &trajectory_msgs::msg::JointTrajectoryPoint::velocities),
+         std::make_pair(accelerations, &trajectory_msgs::msg::JointTrajectoryPoint::accelerations) })
+  {
+    if (encoding == Encoding::NONE)
+      continue;
+    for (std::size_t j = 0; j < joint_count && ok; ++j)
+    {
+      for (trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+        ok = ok && reader.readValue((point.*values)[j], encoding);
+    }
+  }
+  if (!ok)
+  {
+    RCLCPP_ERROR(LOGGER, "Trajectory %zu of archive '%s' is truncated or corrupt", index, filename_.c_str());
+    trajectory.points.clear();
+  }
+  return ok;
+}
+}  // namespace robot_trajectory
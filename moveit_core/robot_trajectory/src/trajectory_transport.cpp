@@ -0,0 +1,485 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/robot_trajectory/trajectory_transport.h>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <cstring>
+#include <utility>
+#include <string>
+#include <type_traits>
+
+namespace robot_trajectory
+{
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_robot_trajectory.trajectory_transport");
+
+namespace
+{
+// Layout of an encoded trajectory: an EncodedHeader, followed by the joint and then the multi-DOF trajectory. Each
+// starts with a TrajectoryHeader, the frame id and the joint names, each name a uint32 length and the characters.
+// Then follow the waypoint times as int64 nanoseconds and the value arrays, one row per waypoint: the positions (or
+// transforms as translation and quaternion) and, as given by the flags, the velocities, accelerations and efforts
+// (or twists as linear and angular).
+constexpr char ENCODED_MAGIC[4] = { 'M', 'V', 'C', 'T' };
+constexpr std::uint16_t ENCODED_VERSION = 1;
+constexpr std::uint16_t BYTE_ORDER_MARK = 0x0102;
+constexpr std::uint32_t SINGLE_PRECISION = 1;
+constexpr std::uint32_t HAS_VELOCITIES = 1;
+constexpr std::uint32_t HAS_ACCELERATIONS = 2;
+constexpr std::uint32_t HAS_EFFORT = 4;
+
+struct EncodedHeader
+{
+  char magic[4];
+  std::uint16_t version;
+  std::uint16_t byte_order;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+};
+
+struct TrajectoryHeader
+{
+  std::int32_t sec;
+  std::uint32_t nanosec;
+  std::uint32_t joint_count;
+  std::uint32_t point_count;
+  std::uint32_t flags;
+  std::uint32_t frame_id_size;
+};
+
+void appendBytes(std::vector<std::uint8_t>& buffer, const void* data, std::size_t size)
+{
+  const auto* bytes = static_cast<const std::uint8_t*>(data);
+  buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void appendString(std::vector<std::uint8_t>& buffer, const std::string& value)
+{
+  const auto size = static_cast<std::uint32_t>(value.size());
+  appendBytes(buffer, &size, sizeof(size));
+  appendBytes(buffer, value.data(), value.size());
+}
+
+template <typename T>
+void appendValues(std::vector<std::uint8_t>& buffer, const std::vector<double>& values)
+{
+  if constexpr (std::is_same_v<T, double>)
+    appendBytes(buffer, values.data(), values.size() * sizeof(double));
+  else
+  {
+    const std::size_t offset = buffer.size();
+    buffer.resize(offset + values.size() * sizeof(T));
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+      const T value = static_cast<T>(values[i]);
+      memcpy(buffer.data() + offset + i * sizeof(T), &value, sizeof(T));
+    }
+  }
+}
+
+void appendTime(std::vector<std::uint8_t>& buffer, const builtin_interfaces::msg::Duration& time_from_start)
+{
+  const std::int64_t nanoseconds =
+      static_cast<std::int64_t>(time_from_start.sec) * 1000000000 + static_cast<std::int64_t>(time_from_start.nanosec);
+  appendBytes(buffer, &nanoseconds, sizeof(nanoseconds));
+}
+
+void appendTwist(std::vector<std::uint8_t>& buffer, const geometry_msgs::msg::Twist& twist)
+{
+  const double values[6] = { twist.linear.x, twist.linear.y, twist.linear.z,
+                             twist.angular.x, twist.angular.y, twist.angular.z };
+  appendBytes(buffer, values, sizeof(values));
+}
+
+// 0 if no waypoint has values in the column, 1 if all have one per joint and -1 otherwise
+template <typename Point, typename Column>
+int hasColumn(const std::vector<Point>& points, Column Point::*column, std::size_t joint_count)
+{
+  if (points.empty() || (points.front().*column).empty())
+  {
+    for (const Point& point : points)
+    {
+      if (!(point.*column).empty())
+        return -1;
+    }
+    return 0;
+  }
+  for (const Point& point : points)
+  {
+    if ((point.*column).size() != joint_count)
+      return -1;
+  }
+  return 1;
+}
+
+void appendHeader(std::vector<std::uint8_t>& buffer, const std_msgs::msg::Header& header,
+                  const std::vector<std::string>& joint_names, std::size_t point_count, std::uint32_t flags)
+{
+  TrajectoryHeader trajectory_header;
+  trajectory_header.sec = header.stamp.sec;
+  trajectory_header.nanosec = header.stamp.nanosec;
+  trajectory_header.joint_count = joint_names.size();
+  trajectory_header.point_count = point_count;
+  trajectory_header.flags = flags;
+  trajectory_header.frame_id_size = header.frame_id.size();
+  appendBytes(buffer, &trajectory_header, sizeof(trajectory_header));
+  appendBytes(buffer, header.frame_id.data(), header.frame_id.size());
+  for (const std::string& name : joint_names)
+    appendString(buffer, name);
+}
+
+template <typename T>
+bool appendJointTrajectory(std::vector<std::uint8_t>& buffer, const trajectory_msgs::msg::JointTrajectory& trajectory)
+{
+  using Point = trajectory_msgs::msg::JointTrajectoryPoint;
+  const std::vector<Point>& points = trajectory.points;
+  const std::size_t joint_count = trajectory.joint_names.size();
+  const int velocities = hasColumn(points, &Point::velocities, joint_count);
+  const int accelerations = hasColumn(points, &Point::accelerations, joint_count);
+  const int effort = hasColumn(points, &Point::effort, joint_count);
+  if ((!points.empty() && hasColumn(points, &Point::positions, joint_count) != 1) || velocities < 0 ||
+      accelerations < 0 || effort < 0)
+  {
+    RCLCPP_ERROR(LOGGER, "Cannot encode a joint trajectory whose waypoints do not all have values for all %zu joints",
+                 joint_count);
+    return false;
+  }
+
+  appendHeader(buffer, trajectory.header, trajectory.joint_names, points.size(),
+               (velocities ? HAS_VELOCITIES : 0) | (accelerations ? HAS_ACCELERATIONS : 0) | (effort ? HAS_EFFORT : 0));
+  const std::size_t columns = 1 + velocities + accelerations + effort;
+  buffer.reserve(buffer.size() + points.size() * (sizeof(std::int64_t) + columns * joint_count * sizeof(T)));
+  for (const Point& point : points)
+    appendTime(buffer, point.time_from_start);
+  for (const Point& point : points)
+    appendValues<T>(buffer, point.positions);
+  for (std::vector<double> Point::*column : { &Point::velocities, &Point::accelerations, &Point::effort })
+  {
+    for (const Point& point : points)
+      appendValues<T>(buffer, point.*column);
+  }
+  return true;
+}
+
+bool appendMultiDOFJointTrajectory(std::vector<std::uint8_t>& buffer,
+                                   const trajectory_msgs::msg::MultiDOFJointTrajectory& trajectory)
+{
+  using Point = trajectory_msgs::msg::MultiDOFJointTrajectoryPoint;
+  const std::vector<Point>& points = trajectory.points;
+  const std::size_t joint_count = trajectory.joint_names.size();
+  const int velocities = hasColumn(points, &Point::velocities, joint_count);
+  const int accelerations = hasColumn(points, &Point::accelerations, joint_count);
+  if ((!points.empty() && hasColumn(points, &Point::transforms, joint_count) != 1) || velocities < 0 ||
+      accelerations < 0)
+  {
+    RCLCPP_ERROR(LOGGER,
+                 "Cannot encode a multi-DOF joint trajectory whose waypoints do not all have values for all %zu joints",
+                 joint_count);
+    return false;
+  }
+
+  appendHeader(buffer, trajectory.header, trajectory.joint_names, points.size(),
+               (velocities ? HAS_VELOCITIES : 0) | (accelerations ? HAS_ACCELERATIONS : 0));
+  for (const Point& point : points)
+    appendTime(buffer, point.time_from_start);
+  for (const Point& point : points)
+  {
+    for (const geometry_msgs::msg::Transform& transform : point.transforms)
+    {
+      const double values[7] = { transform.translation.x, transform.translation.y, transform.translation.z,
+                                 transform.rotation.x,    transform.rotation.y,    transform.rotation.z,
+                                 transform.rotation.w };
+      appendBytes(buffer, values, sizeof(values));
+    }
+  }
+  for (std::vector<geometry_msgs::msg::Twist> Point::*column : { &Point::velocities, &Point::accelerations })
+  {
+    for (const Point& point : points)
+    {
+      for (const geometry_msgs::msg::Twist& twist : point.*column)
+        appendTwist(buffer, twist);
+    }
+  }
+  return true;
+}
+
+// Bounds-checked sequential reads from an encoded trajectory
+class EncodedReader
+{
+public:
+  EncodedReader(const std::uint8_t* begin, const std::uint8_t* end) : current_(begin), end_(end)
+  {
+  }
+
+  bool read(void* data, std::size_t size)
+  {
+    if (remaining() < size)
+      return false;
+    memcpy(data, current_, size);
+    current_ += size;
+    return true;
+  }
+
+  bool readString(std::string& value, std::size_t size)
+  {
+    if (remaining() < size)
+      return false;
+    value.assign(reinterpret_cast<const char*>(current_), size);
+    current_ += size;
+    return true;
+  }
+
+  bool readString(std::string& value)
+  {
+    std::uint32_t size;
+    return read(&size, sizeof(size)) && readString(value, size);
+  }
+
+  template <typename T>
+  bool readValues(std::vector<double>& values, std::size_t count)
+  {
+    if (remaining() / sizeof(T) < count)
+      return false;
+    values.resize(count);
+    if constexpr (std::is_same_v<T, double>)
+      memcpy(values.data(), current_, count * sizeof(double));
+    else
+    {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        T value;
+        memcpy(&value, current_ + i * sizeof(T), sizeof(T));
+        values[i] = value;
+      }
+    }
+    current_ += count * sizeof(T);
+    return true;
+  }
+
+  bool readTime(builtin_interfaces::msg::Duration& time_from_start)
+  {
+    std::int64_t nanoseconds;
+    if (!read(&nanoseconds, sizeof(nanoseconds)))
+      return false;
+    // the nanoseconds of negative durations are positive too
+    std::int64_t seconds = nanoseconds / 1000000000;
+    std::int64_t remainder = nanoseconds % 1000000000;
+    if (remainder < 0)
+    {
+      remainder += 1000000000;
+      --seconds;
+    }
+    time_from_start.sec = static_cast<std::int32_t>(seconds);
+    time_from_start.nanosec = static_cast<std::uint32_t>(remainder);
+    return true;
+  }
+
+  bool readTwist(geometry_msgs::msg::Twist& twist)
+  {
+    double values[6];
+    if (!read(values, sizeof(values)))
+      return false;
+    twist.linear.x = values[0];
+    twist.linear.y = values[1];
+    twist.linear.z = values[2];
+    twist.angular.x = values[3];
+    twist.angular.y = values[4];
+    twist.angular.z = values[5];
+    return true;
+  }
+
+  /** \brief Read a trajectory header, the frame id and the joint names. Fails if the remaining data is too short for
+   *  the waypoint times and \e min_value_size bytes of values per joint and waypoint. */
+  bool readHeader(TrajectoryHeader& header, std_msgs::msg::Header& msg_header, std::vector<std::string>& joint_names,
+                  std::size_t min_value_size)
+  {
+    if (!read(&header, sizeof(header)) || !readString(msg_header.frame_id, header.frame_id_size) ||
+        remaining() / sizeof(std::uint32_t) < header.joint_count)
+      return false;
+    msg_header.stamp.sec = header.sec;
+    msg_header.stamp.nanosec = header.nanosec;
+    joint_names.resize(header.joint_count);
+    for (std::string& name : joint_names)
+    {
+      if (!readString(name))
+        return false;
+    }
+    return remaining() / (sizeof(std::int64_t) + header.joint_count * min_value_size) >= header.point_count;
+  }
+
+  std::size_t remaining() const
+  {
+    return end_ - current_;
+  }
+
+private:
+  const std::uint8_t* current_;
+  const std::uint8_t* end_;
+};
+
+template <typename T>
+bool readJointTrajectory(EncodedReader& reader, trajectory_msgs::msg::JointTrajectory& trajectory)
+{
+  TrajectoryHeader header;
+  if (!reader.readHeader(header, trajectory.header, trajectory.joint_names, sizeof(T)))
+    return false;
+  using Point = trajectory_msgs::msg::JointTrajectoryPoint;
+  std::vector<Point>& points = trajectory.points;
+  points.resize(header.point_count);
+  for (Point& point : points)
+  {
+    if (!reader.readTime(point.time_from_start))
+      return false;
+  }
+  for (Point& point : points)
+  {
+    if (!reader.readValues<T>(point.positions, header.joint_count))
+      return false;
+  }
+  const std::pair<std::uint32_t, std::vector<double> Point::*> columns[] = {
+    { HAS_VELOCITIES, &Point::velocities }, { HAS_ACCELERATIONS, &Point::accelerations }, { HAS_EFFORT, &Point::effort }
+  };
+  for (const auto& [flag, column] : columns)
+  {
+    if (!(header.flags & flag))
+      continue;
+    for (Point& point : points)
+    {
+      if (!reader.readValues<T>(point.*column, header.joint_count))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool readMultiDOFJointTrajectory(EncodedReader& reader, trajectory_msgs::msg::MultiDOFJointTrajectory& trajectory)
+{
+  TrajectoryHeader header;
+  if (!reader.readHeader(header, trajectory.header, trajectory.joint_names, 7 * sizeof(double)))
+    return false;
+  using Point = trajectory_msgs::msg::MultiDOFJointTrajectoryPoint;
+  std::vector<Point>& points = trajectory.points;
+  points.resize(header.point_count);
+  for (Point& point : points)
+  {
+    if (!reader.readTime(point.time_from_start))
+      return false;
+  }
+  for (Point& point : points)
+  {
+    point.transforms.resize(header.joint_count);
+    for (geometry_msgs::msg::Transform& transform : point.transforms)
+    {
+      double values[7];
+      if (!reader.read(values, sizeof(values)))
+        return false;
+      transform.translation.x = values[0];
+      transform.translation.y = values[1];
+      transform.translation.z = values[2];
+      transform.rotation.x = values[3];
+      transform.rotation.y = values[4];
+      transform.rotation.z = values[5];
+      transform.rotation.w = values[6];
+    }
+  }
+  const std::pair<std::uint32_t, std::vector<geometry_msgs::msg::Twist> Point::*> columns[] = {
+    { HAS_VELOCITIES, &Point::velocities }, { HAS_ACCELERATIONS, &Point::accelerations }
+  };
+  for (const auto& [flag, column] : columns)
+  {
+    if (!(header.flags & flag))
+      continue;
+    for (Point& point : points)
+    {
+      (point.*column).resize(header.joint_count);
+      for (geometry_msgs::msg::Twist& twist : point.*column)
+      {
+        if (!reader.readTwist(twist))
+          return false;
+      }
+    }
+  }
+  return true;
+}
+}  // namespace
+
+bool encodeCompactTrajectory(const moveit_msgs::msg::RobotTrajectory& trajectory, std::vector<std::uint8_t>& buffer,
+                             const CompactTrajectoryOptions& options)
+{
+  buffer.clear();
+  EncodedHeader header;
+  memcpy(header.magic, ENCODED_MAGIC, sizeof(header.magic));
+  header.version = ENCODED_VERSION;
+  header.byte_order = BYTE_ORDER_MARK;
+  header.flags = options.single_precision ? SINGLE_PRECISION : 0;
+  header.reserved = 0;
+  appendBytes(buffer, &header, sizeof(header));
+
+  const bool ok = options.single_precision ? appendJointTrajectory<float>(buffer, trajectory.joint_trajectory) :
+                                             appendJointTrajectory<double>(buffer, trajectory.joint_trajectory);
+  if (!ok || !appendMultiDOFJointTrajectory(buffer, trajectory.multi_dof_joint_trajectory))
+  {
+    buffer.clear();
+    return false;
+  }
+  return true;
+}
+
+bool decodeCompactTrajectory(const std::uint8_t* data, std::size_t size, moveit_msgs::msg::RobotTrajectory& trajectory)
+{
+  trajectory = moveit_msgs::msg::RobotTrajectory();
+  EncodedReader reader(data, data + size);
+  EncodedHeader header;
+  if (!reader.read(&header, sizeof(header)) || memcmp(header.magic, ENCODED_MAGIC, sizeof(header.magic)) != 0)
+  {
+    RCLCPP_ERROR(LOGGER, "Data is not an encoded trajectory");
+    return false;
+  }
+  if (header.byte_order != BYTE_ORDER_MARK || header.version != ENCODED_VERSION)
+  {
+    RCLCPP_ERROR(LOGGER, "Trajectory was encoded in an unsupported version or byte order");
+    return false;
+  }
+
+  const bool ok = (header.flags & SINGLE_PRECISION) ? readJointTrajectory<float>(reader, trajectory.joint_trajectory) :
+                                                       readJointTrajectory<double>(reader, trajectory.joint_trajectory);
+  if (!ok || !readMultiDOFJointTrajectory(reader, trajectory.multi_dof_joint_trajectory))
+  {
+    RCLCPP_ERROR(LOGGER, "Encoded trajectory is truncated or corrupt");
+    return false;
+  }
+  return true;
+}
+}  // namespace robot_trajectory
@@ -36,6 +36,7 @@
 
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/compact_robot_trajectory.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/utils/robot_model_test_utils.h>
 #include <urdf_parser/urdf_parser.h>
@@ -426,6 +427,44 @@ TEST_F(RobotTrajectoryTestFixture, Append)
   EXPECT_EQ(initial_trajectory->getWayPointDurationFromPrevious(6), expected_duration);
 }
 
+TEST_F(RobotTrajectoryTestFixture, FindWayPointIndicesForDuration)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  initTestTrajectory(trajectory);
+
+  // Increasing, decreasing and repeated queries must find the same waypoints
+  int before, after;
+  double blend;
+  for (const double duration : { 0.05, 0.15, 0.25, 0.25, 0.45, 0.15, 0.35, 0.05 })
+  {
+    trajectory->findWayPointIndicesForDurationAfterStart(duration, before, after, blend);
+    const int expected_after = static_cast<int>(duration / 0.1);
+    EXPECT_EQ(after, expected_after) << "duration " << duration;
+    EXPECT_EQ(before, std::max(expected_after - 1, 0)) << "duration " << duration;
+    if (before != after)
+      EXPECT_NEAR(blend, 0.5, 1e-9) << "duration " << duration;
+  }
+
+  // Beyond the end the last waypoint is returned
+  trajectory->findWayPointIndicesForDurationAfterStart(1.0, before, after, blend);
+  EXPECT_EQ(before, 4);
+  EXPECT_EQ(after, 4);
+  EXPECT_EQ(blend, 1.0);
+
+  // Changed durations are picked up by the next query
+  EXPECT_NEAR(trajectory->getWayPointDurationFromStart(3), 0.4, 1e-9);
+  trajectory->setWayPointDurationFromPrevious(1, 0.3);
+  EXPECT_NEAR(trajectory->getWayPointDurationFromStart(3), 0.6, 1e-9);
+  trajectory->findWayPointIndicesForDurationAfterStart(0.25, before, after, blend);
+  EXPECT_EQ(before, 0);
+  EXPECT_EQ(after, 1);
+  EXPECT_NEAR(blend, 0.5, 1e-9);
+  trajectory->addPrefixWayPoint(*robot_state_, 0.0);
+  trajectory->findWayPointIndicesForDurationAfterStart(0.25, before, after, blend);
+  EXPECT_EQ(before, 1);
+  EXPECT_EQ(after, 2);
+}
+
 TEST_F(RobotTrajectoryTestFixture, RobotTrajectoryShallowCopy)
 {
   bool deepcopy = false;
@@ -559,6 +598,66 @@ TEST_F(RobotTrajectoryTestFixture, RobotTrajectoryDensity)
   EXPECT_FALSE(robot_trajectory::waypoint_density(*trajectory).has_value());
 }
 
+TEST_F(RobotTrajectoryTestFixture, CompactRobotTrajectory)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  initTestTrajectory(trajectory);
+  // Make the waypoints distinguishable
+  for (std::size_t i = 0; i < trajectory->getWayPointCount(); ++i)
+  {
+    trajectory->getWayPointPtr(i)->setVariablePosition(0, 0.1 * i);
+    trajectory->getWayPointPtr(i)->update();
+  }
+
+  robot_trajectory::CompactRobotTrajectory compact(*trajectory);
+  EXPECT_EQ(compact.getWayPointCount(), trajectory->getWayPointCount());
+  EXPECT_EQ(compact.getVariableCount(), trajectory->getGroup()->getVariableCount());
+  EXPECT_DOUBLE_EQ(compact.getDuration(), trajectory->getDuration());
+  EXPECT_TRUE(compact.hasVelocities());
+  EXPECT_TRUE(compact.hasAccelerations());
+  ASSERT_EQ(compact.getPositions().cols(), static_cast<Eigen::Index>(trajectory->getWayPointCount()));
+  EXPECT_DOUBLE_EQ(compact.getPositions()(0, 3), 0.3);
+  EXPECT_DOUBLE_EQ(compact.getWayPointVelocities(2)[0], 1.0);
+  EXPECT_DOUBLE_EQ(compact.getWayPointAccelerations(2)[0], -0.1);
+
+  // The message matches the one of the original trajectory
+  moveit_msgs::msg::RobotTrajectory expected_msg;
+  moveit_msgs::msg::RobotTrajectory compact_msg;
+  trajectory->getRobotTrajectoryMsg(expected_msg);
+  compact.getRobotTrajectoryMsg(compact_msg);
+  EXPECT_EQ(compact_msg.joint_trajectory.joint_names, expected_msg.joint_trajectory.joint_names);
+  ASSERT_EQ(compact_msg.joint_trajectory.points.size(), expected_msg.joint_trajectory.points.size());
+  for (std::size_t i = 0; i < expected_msg.joint_trajectory.points.size(); ++i)
+  {
+    const auto& expected_point = expected_msg.joint_trajectory.points[i];
+    const auto& compact_point = compact_msg.joint_trajectory.points[i];
+    EXPECT_EQ(compact_point.positions, expected_point.positions);
+    EXPECT_EQ(compact_point.velocities, expected_point.velocities);
+    EXPECT_EQ(compact_point.accelerations, expected_point.accelerations);
+    EXPECT_EQ(rclcpp::Duration(compact_point.time_from_start), rclcpp::Duration(expected_point.time_from_start));
+  }
+
+  // Materialized states match the original waypoints
+  const robot_trajectory::RobotTrajectory materialized = compact.toRobotTrajectory();
+  ASSERT_EQ(materialized.getWayPointCount(), trajectory->getWayPointCount());
+  for (std::size_t i = 0; i < materialized.getWayPointCount(); ++i)
+  {
+    EXPECT_EQ(materialized.getWayPoint(i).distance(trajectory->getWayPoint(i)), 0.0);
+    EXPECT_EQ(materialized.getWayPointDurationFromPrevious(i), trajectory->getWayPointDurationFromPrevious(i));
+  }
+
+  // Appending raw values
+  const Eigen::VectorXd positions = compact.getWayPointPositions(0);
+  compact.addSuffixWayPoint(positions, 0.5);
+  EXPECT_EQ(compact.getWayPointCount(), trajectory->getWayPointCount() + 1);
+  EXPECT_DOUBLE_EQ(compact.getWayPointDurationFromStart(compact.size()), trajectory->getDuration() + 0.5);
+  EXPECT_EQ(compact.getWayPointVelocities(compact.size() - 1).norm(), 0.0);
+
+  compact.clear();
+  EXPECT_TRUE(compact.empty());
+  EXPECT_FALSE(compact.hasVelocities());
+}
+
 TEST_F(OneRobot, Unwind)
 {
   const double epsilon = 1e-4;
@@ -595,6 +694,29 @@ TEST_F(OneRobot, UnwindFromState)
   }
 }
 
+TEST_F(OneRobot, CompactUnwind)
+{
+  const double epsilon = 1e-4;
+
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  initTestTrajectory(trajectory);
+  moveit::core::RobotStatePtr& first_waypoint = trajectory->getFirstWayPointPtr();
+  const double random_large_angle = 20.2;  // rad, should unwind to 1.350444 rad
+  first_waypoint->setVariablePosition("panda_joint0", random_large_angle);
+  first_waypoint->update();
+
+  robot_trajectory::CompactRobotTrajectory compact(*trajectory);
+  compact.unwind();
+  trajectory->unwind();
+  const int index = compact.getGroup()->getVariableGroupIndex("panda_joint0");
+  ASSERT_GE(index, 0);
+  for (std::size_t i = 0; i < compact.getWayPointCount(); ++i)
+  {
+    EXPECT_NEAR(compact.getWayPointPositions(i)[index],
+                trajectory->getWayPoint(i).getVariablePosition("panda_joint0"), epsilon);
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,193 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <moveit/robot_trajectory/trajectory_archive.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+using namespace robot_trajectory;
+
+namespace
+{
+std::string archiveFilename()
+{
+  return (std::filesystem::temp_directory_path() /
+          ("test_trajectory_archive_" + std::to_string(moveit::core::processId())))
+      .string();
+}
+
+trajectory_msgs::msg::JointTrajectory makeTrajectory(const std::vector<std::string>& joint_names, std::size_t points,
+                                                     double offset)
+{
+  trajectory_msgs::msg::JointTrajectory trajectory;
+  trajectory.joint_names = joint_names;
+  for (std::size_t i = 0; i < points; ++i)
+  {
+    trajectory_msgs::msg::JointTrajectoryPoint point;
+    for (std::size_t j = 0; j < joint_names.size(); ++j)
+    {
+      point.positions.push_back(offset + 0.01 * i - 0.3 * j);
+      point.velocities.push_back(0.5 - 0.1 * j);
+    }
+    point.time_from_start.sec = static_cast<std::int32_t>(i / 10);
+    point.time_from_start.nanosec = static_cast<std::uint32_t>((i % 10) * 100000000);
+    trajectory.points.push_back(point);
+  }
+  return trajectory;
+}
+}  // namespace
+
+TEST(TrajectoryArchive, RoundTrip)
+{
+  const std::string filename = archiveFilename();
+  std::filesystem::remove(filename);
+  const std::vector<std::string> arm = { "joint_1", "joint_2", "joint_3" };
+  const std::vector<std::string> gripper = { "finger" };
+  {
+    TrajectoryArchiveWriter writer(filename);
+    ASSERT_TRUE(writer.isOpen());
+    EXPECT_TRUE(writer.write(makeTrajectory(arm, 50, 0.1), "planned", 1));
+    EXPECT_TRUE(writer.write(makeTrajectory(gripper, 5, -0.2), "executed", 2));
+    EXPECT_TRUE(writer.write(makeTrajectory(arm, 0, 0.0), "empty", 3));
+  }
+  // appending reuses the joint name sets of the archive
+  {
+    TrajectoryArchiveWriter writer(filename);
+    ASSERT_TRUE(writer.isOpen());
+    EXPECT_TRUE(writer.write(makeTrajectory(arm, 20, 1.5), "executed", 4));
+  }
+
+  const TrajectoryArchiveReader reader(filename);
+  ASSERT_TRUE(reader.isValid());
+  ASSERT_EQ(reader.size(), 4u);
+  EXPECT_EQ(reader.getLabel(1), "executed");
+  EXPECT_EQ(reader.getStamp(3), 4);
+  EXPECT_EQ(reader.getJointNames(3), arm);
+  EXPECT_EQ(reader.getWayPointCount(0), 50u);
+
+  const std::vector<trajectory_msgs::msg::JointTrajectory> expected = {
+    makeTrajectory(arm, 50, 0.1), makeTrajectory(gripper, 5, -0.2), makeTrajectory(arm, 0, 0.0),
+    makeTrajectory(arm, 20, 1.5)
+  };
+  // read out of order
+  for (std::size_t i : { 3, 0, 2, 1 })
+  {
+    trajectory_msgs::msg::JointTrajectory trajectory;
+    ASSERT_TRUE(reader.read(i, trajectory));
+    EXPECT_EQ(trajectory.joint_names, expected[i].joint_names);
+    ASSERT_EQ(trajectory.points.size(), expected[i].points.size());
+    for (std::size_t p = 0; p < trajectory.points.size(); ++p)
+    {
+      const auto& point = trajectory.points[p];
+      const auto& expected_point = expected[i].points[p];
+      EXPECT_EQ(point.time_from_start, expected_point.time_from_start);
+      ASSERT_EQ(point.positions.size(), expected_point.positions.size());
+      ASSERT_EQ(point.velocities.size(), expected_point.velocities.size());
+      EXPECT_TRUE(point.accelerations.empty());
+      for (std::size_t j = 0; j < point.positions.size(); ++j)
+      {
+        EXPECT_NEAR(point.positions[j], expected_point.positions[j], 1e-6);
+        EXPECT_NEAR(point.velocities[j], expected_point.velocities[j], 1e-3);
+      }
+    }
+  }
+  std::filesystem::remove(filename);
+}
+
+TEST(TrajectoryArchive, TruncatedRecord)
+{
+  const std::string filename = archiveFilename();
+  std::filesystem::remove(filename);
+  const std::vector<std::string> arm = { "joint_1", "joint_2" };
+  TrajectoryArchiveOptions options;
+  options.velocities = ArchiveEncoding::DOUBLE;
+  {
+    TrajectoryArchiveWriter writer(filename, options);
+    ASSERT_TRUE(writer.write(makeTrajectory(arm, 10, 0.0), "first", 1));
+    ASSERT_TRUE(writer.write(makeTrajectory(arm, 10, 0.5), "second", 2));
+  }
+  // cut the last record short, as if the writing process died
+  std::filesystem::resize_file(filename, std::filesystem::file_size(filename) - 12);
+  {
+    const TrajectoryArchiveReader reader(filename);
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_EQ(reader.size(), 1u);
+  }
+  // appending drops the incomplete record
+  {
+    TrajectoryArchiveWriter writer(filename, options);
+    ASSERT_TRUE(writer.write(makeTrajectory(arm, 10, 1.0), "third", 3));
+  }
+  const TrajectoryArchiveReader reader(filename);
+  ASSERT_EQ(reader.size(), 2u);
+  EXPECT_EQ(reader.getLabel(1), "third");
+  trajectory_msgs::msg::JointTrajectory trajectory;
+  ASSERT_TRUE(reader.read(1, trajectory));
+  ASSERT_EQ(trajectory.points.size(), 10u);
+  EXPECT_NEAR(trajectory.points[9].positions[0], 1.09, 1e-6);
+  EXPECT_DOUBLE_EQ(trajectory.points[9].velocities[1], 0.4);
+  std::filesystem::remove(filename);
+}
+
+TEST(TrajectoryArchive, InvalidInput)
+{
+  const std::string filename = archiveFilename();
+  std::filesystem::remove(filename);
+  {
+    TrajectoryArchiveWriter writer(filename);
+    trajectory_msgs::msg::JointTrajectory trajectory = makeTrajectory({ "a", "b" }, 3, 0.0);
+    trajectory.points[1].positions.pop_back();
+    EXPECT_FALSE(writer.write(trajectory, "", 0));
+    trajectory.points[1].positions.push_back(std::nan(""));
+    EXPECT_FALSE(writer.write(trajectory, "", 0));
+  }
+  EXPECT_EQ(TrajectoryArchiveReader(filename).size(), 0u);
+
+  // files that are not archives are neither read nor appended to
+  {
+    std::ofstream out(filename, std::ios::trunc);
+    out << "not a trajectory archive";
+  }
+  EXPECT_FALSE(TrajectoryArchiveReader(filename).isValid());
+  EXPECT_FALSE(TrajectoryArchiveWriter(filename).isOpen());
+  std::filesystem::remove(filename);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
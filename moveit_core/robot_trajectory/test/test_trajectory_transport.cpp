@@ -0,0 +1,156 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <moveit/robot_trajectory/trajectory_transport.h>
+#include <rclcpp/serialization.hpp>
+
+using namespace robot_trajectory;
+
+namespace
+{
+moveit_msgs::msg::RobotTrajectory makeTrajectory(std::size_t points)
+{
+  moveit_msgs::msg::RobotTrajectory trajectory;
+  trajectory.joint_trajectory.header.frame_id = "world";
+  trajectory.joint_trajectory.header.stamp.sec = 12;
+  trajectory.joint_trajectory.joint_names = { "joint_1", "joint_2", "joint_3" };
+  trajectory.multi_dof_joint_trajectory.joint_names = { "base" };
+  for (std::size_t i = 0; i < points; ++i)
+  {
+    trajectory_msgs::msg::JointTrajectoryPoint point;
+    for (std::size_t j = 0; j < 3; ++j)
+    {
+      point.positions.push_back(0.01 * i - 0.3 * j);
+      point.velocities.push_back(0.5 - 0.1 * j);
+    }
+    point.time_from_start.sec = static_cast<std::int32_t>(i / 10);
+    point.time_from_start.nanosec = static_cast<std::uint32_t>((i % 10) * 100000000);
+    trajectory.joint_trajectory.points.push_back(point);
+
+    trajectory_msgs::msg::MultiDOFJointTrajectoryPoint base_point;
+    base_point.transforms.resize(1);
+    base_point.transforms[0].translation.x = 0.1 * i;
+    base_point.transforms[0].rotation.w = 1.0;
+    base_point.time_from_start = point.time_from_start;
+    trajectory.multi_dof_joint_trajectory.points.push_back(base_point);
+  }
+  return trajectory;
+}
+}  // namespace
+
+TEST(TrajectoryTransport, RoundTrip)
+{
+  const moveit_msgs::msg::RobotTrajectory trajectory = makeTrajectory(50);
+  std::vector<std::uint8_t> buffer;
+  ASSERT_TRUE(encodeCompactTrajectory(trajectory, buffer));
+
+  moveit_msgs::msg::RobotTrajectory decoded;
+  ASSERT_TRUE(decodeCompactTrajectory(buffer, decoded));
+  EXPECT_EQ(decoded, trajectory);
+
+  // smaller than the serialized message
+  rclcpp::SerializedMessage serialized;
+  rclcpp::Serialization<moveit_msgs::msg::RobotTrajectory>().serialize_message(&trajectory, &serialized);
+  EXPECT_LT(buffer.size(), serialized.size());
+}
+
+TEST(TrajectoryTransport, SinglePrecision)
+{
+  const moveit_msgs::msg::RobotTrajectory trajectory = makeTrajectory(20);
+  std::vector<std::uint8_t> buffer, single_buffer;
+  CompactTrajectoryOptions options;
+  options.single_precision = true;
+  ASSERT_TRUE(encodeCompactTrajectory(trajectory, buffer));
+  ASSERT_TRUE(encodeCompactTrajectory(trajectory, single_buffer, options));
+  EXPECT_LT(single_buffer.size(), buffer.size());
+
+  moveit_msgs::msg::RobotTrajectory decoded;
+  ASSERT_TRUE(decodeCompactTrajectory(single_buffer, decoded));
+  ASSERT_EQ(decoded.joint_trajectory.points.size(), trajectory.joint_trajectory.points.size());
+  for (std::size_t i = 0; i < decoded.joint_trajectory.points.size(); ++i)
+  {
+    const auto& point = decoded.joint_trajectory.points[i];
+    const auto& expected_point = trajectory.joint_trajectory.points[i];
+    EXPECT_EQ(point.time_from_start, expected_point.time_from_start);
+    EXPECT_TRUE(point.accelerations.empty());
+    ASSERT_EQ(point.positions.size(), expected_point.positions.size());
+    ASSERT_EQ(point.velocities.size(), expected_point.velocities.size());
+    for (std::size_t j = 0; j < point.positions.size(); ++j)
+    {
+      EXPECT_NEAR(point.positions[j], expected_point.positions[j], 1e-6);
+      EXPECT_NEAR(point.velocities[j], expected_point.velocities[j], 1e-6);
+    }
+  }
+  EXPECT_EQ(decoded.multi_dof_joint_trajectory, trajectory.multi_dof_joint_trajectory);
+}
+
+TEST(TrajectoryTransport, InvalidInput)
+{
+  moveit_msgs::msg::RobotTrajectory trajectory = makeTrajectory(10);
+  std::vector<std::uint8_t> buffer;
+  ASSERT_TRUE(encodeCompactTrajectory(trajectory, buffer));
+
+  // every truncation is detected
+  moveit_msgs::msg::RobotTrajectory decoded;
+  for (std::size_t size = 0; size < buffer.size(); ++size)
+    EXPECT_FALSE(decodeCompactTrajectory(buffer.data(), size, decoded));
+  buffer[0] = 'X';
+  EXPECT_FALSE(decodeCompactTrajectory(buffer, decoded));
+
+  // waypoints with some but not all velocities cannot be encoded
+  trajectory.joint_trajectory.points[3].velocities.clear();
+  EXPECT_FALSE(encodeCompactTrajectory(trajectory, buffer));
+  trajectory.joint_trajectory.points[3].velocities.resize(2);
+  EXPECT_FALSE(encodeCompactTrajectory(trajectory, buffer));
+}
+
+TEST(TrajectoryTransport, TypeAdapter)
+{
+  const moveit_msgs::msg::RobotTrajectory trajectory = makeTrajectory(5);
+  std_msgs::msg::UInt8MultiArray msg;
+  CompactTrajectoryAdapter::convert_to_ros_message(trajectory, msg);
+  EXPECT_FALSE(msg.data.empty());
+
+  moveit_msgs::msg::RobotTrajectory converted;
+  CompactTrajectoryAdapter::convert_to_custom(msg, converted);
+  EXPECT_EQ(converted, trajectory);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -37,6 +37,7 @@
 
 #include <Eigen/Core>
 #include <list>
+#include <moveit/robot_trajectory/compact_robot_trajectory.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <ruckig/ruckig.hpp>
 
@@ -92,7 +93,25 @@ public:
                              const double max_velocity_scaling_factor = 1.0,
                              const double max_acceleration_scaling_factor = 1.0);
 
+  /**
+   * \brief Apply smoothing to a time-parameterized CompactRobotTrajectory so that jerk limits are not violated.
+   * Kinematic limits are taken from the robot model, see the first overload for the parameters.
+   */
+  static bool applySmoothing(robot_trajectory::CompactRobotTrajectory& trajectory,
+                             const double max_velocity_scaling_factor = 1.0,
+                             const double max_acceleration_scaling_factor = 1.0, const bool mitigate_overshoot = false,
+                             const double overshoot_threshold = 0.01);
+
 private:
+  /**
+   * \brief Ruckig instance, input parameters and scratch buffers for trajectories with a given number of DOF.
+   * Workspaces are kept per thread and reused by later calls, so smoothing does not allocate them per call.
+   */
+  struct Workspace;
+
+  /** \brief Get the workspace of the calling thread for \e num_dof degrees of freedom */
+  static Workspace& getWorkspace(size_t num_dof);
+
   /**
    * \brief A utility function to check if the group is defined.
    * \param trajectory      Trajectory to smooth.
@@ -123,44 +142,57 @@ private:
                                  const moveit::core::JointModelGroup* joint_group,
                                  ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input);
 
-  /**
-   * \brief Initialize Ruckig position/vel/accel. This initializes ruckig_input and ruckig_output to the same values
-   * \param first_waypoint  The Ruckig input/output parameters are initialized to the values at this waypoint
-   * \param joint_group     The MoveIt JointModelGroup of interest
-   * \param[out] rucking_input   Input parameters to Ruckig. Initialized here.
-   */
-  static void initializeRuckigState(const moveit::core::RobotState& first_waypoint,
-                                    const moveit::core::JointModelGroup* joint_group,
-                                    ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input);
+  /** \brief Same as above, for the waypoints \e waypoint_idx and \e waypoint_idx + 1 of a CompactRobotTrajectory */
+  static void getNextRuckigInput(const robot_trajectory::CompactRobotTrajectory& trajectory, size_t waypoint_idx,
+                                 ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input);
 
   /**
    * \brief A utility function to instantiate and run Ruckig for a series of waypoints.
+   * A segment that Ruckig cannot smooth is retried with a longer duration, without smoothing the segments before it
+   * again.
    * \param[in, out] trajectory      Trajectory to smooth.
-   * \param[in, out] ruckig_input    Necessary input for Ruckig smoothing. Contains kinematic limits (vel, accel, jerk)
+   * \param[in, out] workspace       The input parameters contain the kinematic limits (vel, accel, jerk)
    * \param mitigate_overshoot If true, overshoot is mitigated by extending trajectory duration.
    * \param overshoot_threshold If an overshoot is greater than this, duration is extended (radians, for a single joint)
    */
-  [[nodiscard]] static bool runRuckig(robot_trajectory::RobotTrajectory& trajectory,
-                                      ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input,
+  [[nodiscard]] static bool runRuckig(robot_trajectory::RobotTrajectory& trajectory, Workspace& workspace,
+                                      const bool mitigate_overshoot = false, const double overshoot_threshold = 0.01);
+
+  /** \brief Same as above, for a CompactRobotTrajectory */
+  [[nodiscard]] static bool runRuckig(robot_trajectory::CompactRobotTrajectory& trajectory, Workspace& workspace,
                                       const bool mitigate_overshoot = false, const double overshoot_threshold = 0.01);
 
   /**
-   * \brief Extend the duration of every trajectory segment
-   * \param[in] duration_extension_factor A number greater than 1. Extend every timestep by this much.
-   * \param[in] num_waypoints Number of waypoints in the trajectory.
+   * \brief Run Ruckig for the segment in the workspace input parameters
+   * \return False if Ruckig failed, or if the result overshoots and \e mitigate_overshoot is set
+   */
+  static bool smoothSegment(Workspace& workspace, const bool mitigate_overshoot, const double overshoot_threshold);
+
+  /**
+   * \brief Decide what to do with a segment that could not be smoothed within the maximum duration extension
+   * \return False if Ruckig failed. A segment that only overshoots is kept with a warning.
+   */
+  static bool acceptFailedSegment(const Workspace& workspace, size_t waypoint_idx);
+
+  /**
+   * \brief Extend the duration of a trajectory segment
+   * \param[in] duration_extension_factor A number greater than 1. Extend the timestep by this much.
+   * \param[in] waypoint_idx The segment ending at waypoint \e waypoint_idx + 1 is extended.
    * \param[in] num_dof Degrees of freedom in the manipulator.
    * \param[in] move_group_idx For accessing the joints of interest out of the full RobotState.
-   * \param[in] original_trajectory Durations are extended based on the data in this original trajectory.
+   * \param[in] original_duration The duration of the segment before smoothing, which is extended.
    * \param[in, out] trajectory This trajectory will be returned with modified waypoint durations.
    */
-  static void extendTrajectoryDuration(const double duration_extension_factor, size_t num_waypoints,
+  static void extendTrajectoryDuration(const double duration_extension_factor, size_t waypoint_idx,
                                        const size_t num_dof, const std::vector<int>& move_group_idx,
-                                       const robot_trajectory::RobotTrajectory& original_trajectory,
-                                       robot_trajectory::RobotTrajectory& trajectory);
+                                       const double original_duration, robot_trajectory::RobotTrajectory& trajectory);
+
+  /** \brief Same as above, for a CompactRobotTrajectory */
+  static void extendTrajectoryDuration(const double duration_extension_factor, size_t waypoint_idx,
+                                       const double original_duration,
+                                       robot_trajectory::CompactRobotTrajectory& trajectory);
 
-  /** \brief Check if a trajectory out of Ruckig overshoots the target state */
-  static bool checkOvershoot(ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector>& ruckig_trajectory,
-                             const size_t num_dof, ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input,
-                             const double overshoot_threshold);
+  /** \brief Check if the trajectory in the workspace overshoots the target state of its input parameters */
+  static bool checkOvershoot(Workspace& workspace, const double overshoot_threshold);
 };
 }  // namespace trajectory_processing
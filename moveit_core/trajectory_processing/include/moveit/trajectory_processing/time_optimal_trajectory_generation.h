@@ -39,20 +39,37 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <functional>
 #include <list>
+#include <vector>
+#include <moveit/robot_trajectory/compact_robot_trajectory.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/trajectory_processing/time_parameterization.h>
 
+namespace dynamics_solver
+{
+class DynamicsSolver;
+}
+
 namespace trajectory_processing
 {
 enum LimitType
 {
   VELOCITY,
-  ACCELERATION
+  ACCELERATION,
+  TORQUE
 };
 
 const std::unordered_map<LimitType, std::string> LIMIT_TYPES = { { VELOCITY, "velocity" },
-                                                                 { ACCELERATION, "acceleration" } };
+                                                                 { ACCELERATION, "acceleration" },
+                                                                 { TORQUE, "torque" } };
+
+/** @brief Inverse dynamics for a batch of joint states, one state per column of the matrices.
+ *  Fills \e torques with the joint torques and returns false if they could not be computed. */
+using InverseDynamicsFn =
+    std::function<bool(const Eigen::MatrixXd& positions, const Eigen::MatrixXd& velocities,
+                       const Eigen::MatrixXd& accelerations, Eigen::MatrixXd& torques)>;
+
 class PathSegment
 {
 public:
@@ -82,6 +99,7 @@ class Path
 {
 public:
   Path(const std::list<Eigen::VectorXd>& path, double max_deviation = 0.0);
+  Path(const std::vector<Eigen::VectorXd>& path, double max_deviation = 0.0);
   Path(const Path& path);
   double getLength() const;
   Eigen::VectorXd getConfig(double s) const;
@@ -99,10 +117,13 @@ public:
   std::list<std::pair<double, bool>> getSwitchingPoints() const;
 
 private:
+  friend class Trajectory;
+
   PathSegment* getPathSegment(double& s) const;
   double length_;
-  std::list<std::pair<double, bool>> switching_points_;
-  std::list<std::unique_ptr<PathSegment>> path_segments_;
+  // both sorted by arc length, so lookups are binary searches
+  std::vector<std::pair<double, bool>> switching_points_;
+  std::vector<std::unique_ptr<PathSegment>> path_segments_;
 };
 
 class Trajectory
@@ -112,6 +133,14 @@ public:
   Trajectory(const Path& path, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
              double time_step = 0.001);
 
+  /** @brief Generates a time-optimal trajectory that also keeps the joint torques within \e max_torque.
+   *  The inverse dynamics are evaluated in batches at samples spaced at most \e torque_sample_distance apart
+   *  along each path segment and interpolated in between. Joints with a non-positive torque limit are not
+   *  torque limited. */
+  Trajectory(const Path& path, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
+             const InverseDynamicsFn& inverse_dynamics, const Eigen::VectorXd& max_torque, double time_step = 0.001,
+             double torque_sample_distance = 0.01);
+
   ~Trajectory();
 
   /** @brief Call this method after constructing the object to make sure the
@@ -144,14 +173,18 @@ private:
     double time_;
   };
 
+  void integrate();
+
   bool getNextSwitchingPoint(double path_pos, TrajectoryStep& next_switching_point, double& before_acceleration,
                              double& after_acceleration);
   bool getNextAccelerationSwitchingPoint(double path_pos, TrajectoryStep& next_switching_point,
                                          double& before_acceleration, double& after_acceleration);
   bool getNextVelocitySwitchingPoint(double path_pos, TrajectoryStep& next_switching_point, double& before_acceleration,
                                      double& after_acceleration);
-  bool integrateForward(std::list<TrajectoryStep>& trajectory, double acceleration);
-  void integrateBackward(std::list<TrajectoryStep>& start_trajectory, double path_pos, double path_vel,
+  bool getNextTorqueSwitchingPoint(double path_pos, TrajectoryStep& next_switching_point, double& before_acceleration,
+                                   double& after_acceleration);
+  bool integrateForward(std::vector<TrajectoryStep>& trajectory, double acceleration);
+  void integrateBackward(std::vector<TrajectoryStep>& start_trajectory, double path_pos, double path_vel,
                          double acceleration);
   double getMinMaxPathAcceleration(double path_position, double path_velocity, bool max);
   double getMinMaxPhaseSlope(double path_position, double path_velocity, bool max);
@@ -160,20 +193,37 @@ private:
   double getAccelerationMaxPathVelocityDeriv(double path_pos);
   double getVelocityMaxPathVelocityDeriv(double path_pos);
 
-  std::list<TrajectoryStep>::const_iterator getTrajectorySegment(double time) const;
+  /// @brief Evaluate the inverse dynamics at samples along each path segment. Returns false if it fails.
+  bool sampleTorqueCoefficients(const InverseDynamicsFn& inverse_dynamics, double sample_distance);
+  /// @brief Interpolate the sampled coefficients of the joint torques in the path acceleration and velocity
+  void getTorqueCoefficients(double path_pos, Eigen::VectorXd& mass, Eigen::VectorXd& coriolis,
+                             Eigen::VectorXd& gravity) const;
+  /// @brief The maximum path velocity allowed by the acceleration and torque limits together
+  double getTorqueMaxPathVelocity(double path_pos) const;
+
+  std::vector<TrajectoryStep>::const_iterator getTrajectorySegment(double time) const;
 
   Path path_;
   Eigen::VectorXd max_velocity_;
   Eigen::VectorXd max_acceleration_;
   unsigned int joint_num_;
   bool valid_;
-  std::list<TrajectoryStep> trajectory_;
-  std::list<TrajectoryStep> end_trajectory_;  // non-empty only if the trajectory generation failed.
+  std::vector<TrajectoryStep> trajectory_;
+  std::vector<TrajectoryStep> end_trajectory_;  // non-empty only if the trajectory generation failed.
+
+  // Joint torques along the path are mass * path_acc + coriolis * path_vel^2 + gravity. The coefficients are
+  // sampled evenly over each path segment, columns torque_segment_offsets_[k] to [k + 1] - 1 belong to segment k.
+  bool torque_limited_;
+  Eigen::VectorXd max_torque_;
+  std::vector<std::size_t> torque_segment_offsets_;
+  Eigen::MatrixXd torque_mass_;
+  Eigen::MatrixXd torque_coriolis_;
+  Eigen::MatrixXd torque_gravity_;
 
   const double time_step_;
 
   mutable double cached_time_;
-  mutable std::list<TrajectoryStep>::const_iterator cached_trajectory_segment_;
+  mutable std::vector<TrajectoryStep>::const_iterator cached_trajectory_segment_;
 };
 
 MOVEIT_CLASS_FORWARD(TimeOptimalTrajectoryGeneration);
@@ -242,10 +292,71 @@ public:
                          const double max_velocity_scaling_factor = 1.0,
                          const double max_acceleration_scaling_factor = 1.0) const override;
 
+  /**
+   * \brief Same as computeTimeStamps() with limits from the robot model, but operating directly on a
+   * CompactRobotTrajectory so that no RobotState is created for the input or the resampled waypoints.
+   */
+  bool computeTimeStamps(robot_trajectory::CompactRobotTrajectory& trajectory,
+                         const double max_velocity_scaling_factor = 1.0,
+                         const double max_acceleration_scaling_factor = 1.0) const;
+
+  /**
+   * \brief Same as computeTimeStamps() with limits from the robot model, but also keeping the joint torques within
+   * the effort limits of the robot model. The torques are evaluated along the path with batched inverse dynamics,
+   * so the acceleration limits no longer need to cover the worst-case load, and motions are only slowed down where
+   * the actuators require it. Joints without an effort limit are not torque limited.
+   * \param[in,out] trajectory A path which needs time-parameterization.
+   * \param dynamics_solver The dynamics of the group of the trajectory, including any payload in its model.
+   * \param max_velocity_scaling_factor A factor in the range [0,1] which can slow down the trajectory.
+   * \param max_acceleration_scaling_factor A factor in the range [0,1] which can slow down the trajectory.
+   * \param max_torque_scaling_factor A factor in the range [0,1] which scales the effort limits.
+   */
+  bool computeTimeStampsWithTorqueLimits(robot_trajectory::RobotTrajectory& trajectory,
+                                         const dynamics_solver::DynamicsSolver& dynamics_solver,
+                                         const double max_velocity_scaling_factor = 1.0,
+                                         const double max_acceleration_scaling_factor = 1.0,
+                                         const double max_torque_scaling_factor = 1.0) const;
+
+  /**
+   * \brief Compute time stamps for a trajectory that comes to rest at some of its waypoints, parameterizing the
+   * segments between these stop points concurrently and appending the results.
+   * Since the robot is at rest at each split point, this is equivalent to parameterizing the segments one by one.
+   * \param[in,out] trajectory A path which needs time-parameterization.
+   * \param split_points Indices of the waypoints at which the trajectory is split. Indices of the first and last
+   * waypoint and indices out of range are ignored.
+   * \param max_velocity_scaling_factor A factor in the range [0,1] which can slow down the trajectory.
+   * \param max_acceleration_scaling_factor A factor in the range [0,1] which can slow down the trajectory.
+   * \param num_threads The number of threads to use. 0 uses one thread per hardware thread.
+   */
+  bool computeTimeStampsSegmented(robot_trajectory::RobotTrajectory& trajectory,
+                                  const std::vector<std::size_t>& split_points,
+                                  const double max_velocity_scaling_factor = 1.0,
+                                  const double max_acceleration_scaling_factor = 1.0,
+                                  const unsigned int num_threads = 0) const;
+
+  /**
+   * \brief Like the above, but splits the trajectory at every intermediate waypoint whose group velocities are all
+   * zero. Waypoints without velocities are never split points.
+   */
+  bool computeTimeStampsSegmented(robot_trajectory::RobotTrajectory& trajectory,
+                                  const double max_velocity_scaling_factor = 1.0,
+                                  const double max_acceleration_scaling_factor = 1.0,
+                                  const unsigned int num_threads = 0) const;
+
 private:
+  /**
+   * @brief Read the velocity and acceleration limits of the active joints of \e group from the robot model.
+   * \return false if a limit is missing or invalid.
+   */
+  bool getModelLimits(const moveit::core::JointModelGroup* group, const double max_velocity_scaling_factor,
+                      const double max_acceleration_scaling_factor, Eigen::VectorXd& max_velocity,
+                      Eigen::VectorXd& max_acceleration) const;
+
   bool doTimeParameterizationCalculations(robot_trajectory::RobotTrajectory& trajectory,
                                           const Eigen::VectorXd& max_velocity,
-                                          const Eigen::VectorXd& max_acceleration) const;
+                                          const Eigen::VectorXd& max_acceleration,
+                                          const InverseDynamicsFn& inverse_dynamics = InverseDynamicsFn(),
+                                          const Eigen::VectorXd& max_torque = Eigen::VectorXd()) const;
 
   /**
    * @brief Check if a combination of revolute and prismatic joints is used. path_tolerance_ is not valid, if so.
@@ -257,7 +368,7 @@ private:
   /**
    * @brief Check if the requested scaling factor is valid and if not, return 1.0.
    * \param requested_scaling_factor The desired maximum scaling factor to apply to the velocity or acceleration limits
-   * \param limit_type Whether the velocity or acceleration scaling factor is being verified
+   * \param limit_type Whether the velocity, acceleration or torque scaling factor is being verified
    * \return The user requested scaling factor, if it is valid. Otherwise, return 1.0.
    */
   double verifyScalingFactor(const double requested_scaling_factor, const LimitType limit_type) const;
@@ -79,4 +79,31 @@ bool applyTOTGTimeParameterization(robot_trajectory::RobotTrajectory& trajectory
 bool applyRuckigSmoothing(robot_trajectory::RobotTrajectory& trajectory, const double& velocity_scaling_factor,
                           const double& acceleration_scaling_factor, const bool mitigate_overshoot = false,
                           const double overshoot_threshold = 0.01);
+/**
+ * \brief Resamples a time parameterized robot trajectory at a fixed time step.
+ *
+ * The variables of the trajectory's group are interpolated between the original waypoints with quintic polynomials
+ * if both waypoints have accelerations, with cubic polynomials if both have velocities and linearly otherwise.
+ * The first and last waypoints are kept.
+ * \param [in,out] trajectory The robot trajectory to be resampled.
+ * \param [in] resample_dt The time step between two resampled waypoints.
+ * \return True if resampling was successful, false if the time step is not positive or the group has joints with
+ * more than one variable.
+ */
+bool resampleTrajectory(robot_trajectory::RobotTrajectory& trajectory, const double resample_dt);
+/**
+ * \brief Removes waypoints that the interpolation between their neighbors reproduces.
+ *
+ * A waypoint is removed if the interpolation between the remaining waypoints, of the same order as in
+ * resampleTrajectory(), deviates from its positions and velocities by at most the tolerances. The remaining
+ * waypoints keep their positions, velocities and accelerations, so a controller interpolating them moves
+ * continuously along the original trajectory within the tolerances.
+ * \param [in,out] trajectory The robot trajectory to be simplified.
+ * \param [in] position_tolerance The maximum deviation of a removed waypoint's variable positions.
+ * \param [in] velocity_tolerance The maximum deviation of a removed waypoint's variable velocities.
+ * \param [in] max_waypoint_duration The maximum time between two remaining waypoints, unlimited if not positive.
+ * \return The number of removed waypoints.
+ */
+std::size_t simplifyTrajectory(robot_trajectory::RobotTrajectory& trajectory, const double position_tolerance,
+                               const double velocity_tolerance, const double max_waypoint_duration = 0.0);
 }  // namespace trajectory_processing
@@ -39,7 +39,9 @@
 #include <cmath>
 #include <Eigen/Geometry>
 #include <limits>
+#include <memory>
 #include <moveit/trajectory_processing/ruckig_traj_smoothing.h>
+#include <unordered_map>
 #include <vector>
 
 namespace trajectory_processing
@@ -54,8 +56,67 @@ constexpr double MAX_DURATION_EXTENSION_FACTOR = 10.0;
 constexpr double DURATION_EXTENSION_FRACTION = 1.1;
 // If "mitigate_overshoot" is enabled, overshoot is checked with this timestep
 constexpr double OVERSHOOT_CHECK_PERIOD = 0.01;  // sec
+
+// Clamp velocities/accelerations in case they exceed the limit due to small numerical errors
+void clampRuckigInput(ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input)
+{
+  for (size_t joint = 0; joint < ruckig_input.degrees_of_freedom; ++joint)
+  {
+    ruckig_input.current_velocity.at(joint) =
+        std::clamp(ruckig_input.current_velocity.at(joint), -ruckig_input.max_velocity.at(joint),
+                   ruckig_input.max_velocity.at(joint));
+    ruckig_input.current_acceleration.at(joint) =
+        std::clamp(ruckig_input.current_acceleration.at(joint), -ruckig_input.max_acceleration.at(joint),
+                   ruckig_input.max_acceleration.at(joint));
+    ruckig_input.target_velocity.at(joint) =
+        std::clamp(ruckig_input.target_velocity.at(joint), -ruckig_input.max_velocity.at(joint),
+                   ruckig_input.max_velocity.at(joint));
+    ruckig_input.target_acceleration.at(joint) =
+        std::clamp(ruckig_input.target_acceleration.at(joint), -ruckig_input.max_acceleration.at(joint),
+                   ruckig_input.max_acceleration.at(joint));
+  }
+}
 }  // namespace
 
+struct RuckigSmoothing::Workspace
+{
+  // delta_time is only used by Ruckig's online update(), not by calculate()
+  explicit Workspace(size_t num_dof)
+    : ruckig(num_dof)
+    , ruckig_input(num_dof)
+    , ruckig_trajectory(num_dof)
+    , new_position(num_dof)
+    , new_velocity(num_dof)
+    , new_acceleration(num_dof)
+  {
+  }
+
+  ruckig::Ruckig<ruckig::DynamicDOFs> ruckig;
+  ruckig::InputParameter<ruckig::DynamicDOFs> ruckig_input;
+  ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector> ruckig_trajectory;
+  ruckig::Result ruckig_result{ ruckig::Result::Working };
+
+  // Samples of ruckig_trajectory in checkOvershoot()
+  std::vector<double> new_position;
+  std::vector<double> new_velocity;
+  std::vector<double> new_acceleration;
+
+  // Segment durations of the trajectory before smoothing, which failed segments are extended from
+  std::vector<double> original_durations;
+};
+
+RuckigSmoothing::Workspace& RuckigSmoothing::getWorkspace(size_t num_dof)
+{
+  // One workspace per thread and number of DOF, reused by all calls
+  thread_local std::unordered_map<size_t, std::unique_ptr<Workspace>> workspaces;
+  std::unique_ptr<Workspace>& workspace = workspaces[num_dof];
+  if (!workspace)
+  {
+    workspace = std::make_unique<Workspace>(num_dof);
+  }
+  return *workspace;
+}
+
 bool RuckigSmoothing::applySmoothing(robot_trajectory::RobotTrajectory& trajectory,
                                      const double max_velocity_scaling_factor,
                                      const double max_acceleration_scaling_factor, const bool mitigate_overshoot,
@@ -76,15 +137,15 @@ bool RuckigSmoothing::applySmoothing(robot_trajectory::RobotTrajectory& trajecto
 
   // Kinematic limits (vels/accels/jerks) from RobotModel
   const moveit::core::JointModelGroup* const group = trajectory.getGroup();
-  const size_t num_dof = group->getVariableCount();
-  ruckig::InputParameter<ruckig::DynamicDOFs> ruckig_input{ num_dof };
+  Workspace& workspace = getWorkspace(group->getVariableCount());
+  ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input = workspace.ruckig_input;
   if (!getRobotModelBounds(max_velocity_scaling_factor, max_acceleration_scaling_factor, group, ruckig_input))
   {
     RCLCPP_ERROR(LOGGER, "Error while retrieving kinematic limits (vel/accel/jerk) from RobotModel.");
     return false;
   }
 
-  return runRuckig(trajectory, ruckig_input, mitigate_overshoot, overshoot_threshold);
+  return runRuckig(trajectory, workspace, mitigate_overshoot, overshoot_threshold);
 }
 
 bool RuckigSmoothing::applySmoothing(robot_trajectory::RobotTrajectory& trajectory,
@@ -110,8 +171,8 @@ bool RuckigSmoothing::applySmoothing(robot_trajectory::RobotTrajectory& trajecto
 
   // Set default kinematic limits (vels/accels/jerks)
   const moveit::core::JointModelGroup* const group = trajectory.getGroup();
-  const size_t num_dof = group->getVariableCount();
-  ruckig::InputParameter<ruckig::DynamicDOFs> ruckig_input{ num_dof };
+  Workspace& workspace = getWorkspace(group->getVariableCount());
+  ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input = workspace.ruckig_input;
   if (!getRobotModelBounds(max_velocity_scaling_factor, max_acceleration_scaling_factor, group, ruckig_input))
   {
     RCLCPP_ERROR(LOGGER, "Error while retrieving kinematic limits (vel/accel/jerk) from RobotModel.");
@@ -143,7 +204,7 @@ bool RuckigSmoothing::applySmoothing(robot_trajectory::RobotTrajectory& trajecto
     }
   }
 
-  return runRuckig(trajectory, ruckig_input, mitigate_overshoot, overshoot_threshold);
+  return runRuckig(trajectory, workspace, mitigate_overshoot, overshoot_threshold);
 }
 
 bool RuckigSmoothing::applySmoothing(robot_trajectory::RobotTrajectory& trajectory,
@@ -174,6 +235,30 @@ bool RuckigSmoothing::applySmoothing(robot_trajectory::RobotTrajectory& trajecto
                         max_acceleration_scaling_factor);
 }
 
+bool RuckigSmoothing::applySmoothing(robot_trajectory::CompactRobotTrajectory& trajectory,
+                                     const double max_velocity_scaling_factor,
+                                     const double max_acceleration_scaling_factor, const bool mitigate_overshoot,
+                                     const double overshoot_threshold)
+{
+  if (trajectory.getWayPointCount() < 2)
+  {
+    RCLCPP_WARN(LOGGER,
+                "Trajectory does not have enough points to smooth with Ruckig. Returning an unmodified trajectory.");
+    return true;
+  }
+
+  // Kinematic limits (vels/accels/jerks) from RobotModel
+  Workspace& workspace = getWorkspace(trajectory.getVariableCount());
+  if (!getRobotModelBounds(max_velocity_scaling_factor, max_acceleration_scaling_factor, trajectory.getGroup(),
+                           workspace.ruckig_input))
+  {
+    RCLCPP_ERROR(LOGGER, "Error while retrieving kinematic limits (vel/accel/jerk) from RobotModel.");
+    return false;
+  }
+
+  return runRuckig(trajectory, workspace, mitigate_overshoot, overshoot_threshold);
+}
+
 bool RuckigSmoothing::validateGroup(const robot_trajectory::RobotTrajectory& trajectory)
 {
   const moveit::core::JointModelGroup* const group = trajectory.getGroup();
@@ -239,98 +324,92 @@ bool RuckigSmoothing::getRobotModelBounds(const double max_velocity_scaling_fact
   return true;
 }
 
-bool RuckigSmoothing::runRuckig(robot_trajectory::RobotTrajectory& trajectory,
-                                ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input,
+bool RuckigSmoothing::runRuckig(robot_trajectory::RobotTrajectory& trajectory, Workspace& workspace,
                                 const bool mitigate_overshoot, const double overshoot_threshold)
 {
   const size_t num_waypoints = trajectory.getWayPointCount();
   const moveit::core::JointModelGroup* const group = trajectory.getGroup();
   const size_t num_dof = group->getVariableCount();
-  ruckig::OutputParameter<ruckig::DynamicDOFs> ruckig_output{ num_dof };
+  const std::vector<int>& move_group_idx = group->getVariableIndexList();
+  ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input = workspace.ruckig_input;
 
   // This lib does not work properly when angles wrap, so we need to unwind the path first
   trajectory.unwind();
 
-  // Initialize the smoother
-  ruckig::Ruckig<ruckig::DynamicDOFs> ruckig(num_dof, trajectory.getAverageSegmentDuration());
-  initializeRuckigState(*trajectory.getFirstWayPointPtr(), group, ruckig_input);
-
-  // Cache the trajectory in case we need to reset it
-  robot_trajectory::RobotTrajectory original_trajectory =
-      robot_trajectory::RobotTrajectory(trajectory, true /* deep copy */);
+  // Cache the durations in case we need to extend them
+  workspace.original_durations.resize(num_waypoints);
+  for (size_t waypoint_idx = 0; waypoint_idx < num_waypoints; ++waypoint_idx)
+  {
+    workspace.original_durations[waypoint_idx] = trajectory.getWayPointDurationFromPrevious(waypoint_idx);
+  }
 
-  ruckig::Result ruckig_result;
-  double duration_extension_factor = 1;
-  bool smoothing_complete = false;
-  size_t waypoint_idx = 0;
-  while ((duration_extension_factor < MAX_DURATION_EXTENSION_FACTOR) && !smoothing_complete)
+  for (size_t waypoint_idx = 0; waypoint_idx < num_waypoints - 1; ++waypoint_idx)
   {
-    while (waypoint_idx < num_waypoints - 1)
+    double duration_extension_factor = 1;
+    while (true)
     {
-      moveit::core::RobotStatePtr curr_waypoint = trajectory.getWayPointPtr(waypoint_idx);
-      moveit::core::RobotStatePtr next_waypoint = trajectory.getWayPointPtr(waypoint_idx + 1);
-
-      getNextRuckigInput(curr_waypoint, next_waypoint, group, ruckig_input);
-
-      // Run Ruckig
-      ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector> ruckig_trajectory(num_dof);
-      ruckig_result = ruckig.calculate(ruckig_input, ruckig_trajectory);
-
-      // Step through the trajectory at the given OVERSHOOT_CHECK_PERIOD and check for overshoot.
-      // We will extend the duration to mitigate it.
-      bool overshoots = false;
-      if (mitigate_overshoot)
-      {
-        overshoots = checkOvershoot(ruckig_trajectory, num_dof, ruckig_input, overshoot_threshold);
-      }
-
-      // The difference between Result::Working and Result::Finished is that Finished can be reached in one
-      // Ruckig timestep (constructor parameter). Both are acceptable for trajectories.
-      // (The difference is only relevant for streaming mode.)
-
-      // If successful and at the last trajectory segment
-      if (!overshoots && (waypoint_idx == num_waypoints - 2) &&
-          (ruckig_result == ruckig::Result::Working || ruckig_result == ruckig::Result::Finished))
+      getNextRuckigInput(trajectory.getWayPointPtr(waypoint_idx), trajectory.getWayPointPtr(waypoint_idx + 1), group,
+                         ruckig_input);
+      if (smoothSegment(workspace, mitigate_overshoot, overshoot_threshold))
       {
-        trajectory.setWayPointDurationFromPrevious(waypoint_idx + 1, ruckig_trajectory.get_duration());
-        smoothing_complete = true;
         break;
       }
 
-      // Extend the trajectory duration if Ruckig could not reach the waypoint successfully
-      if (overshoots || (ruckig_result != ruckig::Result::Working && ruckig_result != ruckig::Result::Finished))
+      // Extend the duration of the failed segment and smooth it again. The segments before it are not affected.
+      duration_extension_factor *= DURATION_EXTENSION_FRACTION;
+      if (duration_extension_factor >= MAX_DURATION_EXTENSION_FACTOR)
       {
-        duration_extension_factor *= DURATION_EXTENSION_FRACTION;
-
-        const std::vector<int>& move_group_idx = group->getVariableIndexList();
-        extendTrajectoryDuration(duration_extension_factor, waypoint_idx, num_dof, move_group_idx, original_trajectory,
-                                 trajectory);
-
-        initializeRuckigState(*trajectory.getFirstWayPointPtr(), group, ruckig_input);
-        // Continue the loop from failed segment, but with increased duration extension factor
+        if (!acceptFailedSegment(workspace, waypoint_idx))
+        {
+          return false;
+        }
         break;
       }
-      ++waypoint_idx;
+      extendTrajectoryDuration(duration_extension_factor, waypoint_idx, num_dof, move_group_idx,
+                               workspace.original_durations[waypoint_idx + 1], trajectory);
     }
   }
+  trajectory.setWayPointDurationFromPrevious(num_waypoints - 1, workspace.ruckig_trajectory.get_duration());
+
+  return true;
+}
+
+bool RuckigSmoothing::smoothSegment(Workspace& workspace, const bool mitigate_overshoot,
+                                    const double overshoot_threshold)
+{
+  workspace.ruckig_result = workspace.ruckig.calculate(workspace.ruckig_input, workspace.ruckig_trajectory);
 
-  if (ruckig_result != ruckig::Result::Working && ruckig_result != ruckig::Result::Finished)
+  // The difference between Result::Working and Result::Finished is that Finished can be reached in one
+  // Ruckig timestep (constructor parameter). Both are acceptable for trajectories.
+  // (The difference is only relevant for streaming mode.)
+  if (workspace.ruckig_result != ruckig::Result::Working && workspace.ruckig_result != ruckig::Result::Finished)
   {
-    RCLCPP_ERROR_STREAM(LOGGER, "Ruckig trajectory smoothing failed. Ruckig error: " << ruckig_result);
     return false;
   }
 
+  // Step through the trajectory at the given OVERSHOOT_CHECK_PERIOD and check for overshoot.
+  // We will extend the duration to mitigate it.
+  return !mitigate_overshoot || !checkOvershoot(workspace, overshoot_threshold);
+}
+
+bool RuckigSmoothing::acceptFailedSegment(const Workspace& workspace, size_t waypoint_idx)
+{
+  if (workspace.ruckig_result != ruckig::Result::Working && workspace.ruckig_result != ruckig::Result::Finished)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Ruckig trajectory smoothing failed. Ruckig error: " << workspace.ruckig_result);
+    return false;
+  }
+  RCLCPP_WARN(LOGGER, "Could not mitigate the overshoot between waypoints %zu and %zu.", waypoint_idx,
+              waypoint_idx + 1);
   return true;
 }
 
 void RuckigSmoothing::extendTrajectoryDuration(const double duration_extension_factor, size_t waypoint_idx,
                                                const size_t num_dof, const std::vector<int>& move_group_idx,
-                                               const robot_trajectory::RobotTrajectory& original_trajectory,
+                                               const double original_duration,
                                                robot_trajectory::RobotTrajectory& trajectory)
 {
-  trajectory.setWayPointDurationFromPrevious(waypoint_idx + 1,
-                                             duration_extension_factor *
-                                                 original_trajectory.getWayPointDurationFromPrevious(waypoint_idx + 1));
+  trajectory.setWayPointDurationFromPrevious(waypoint_idx + 1, duration_extension_factor * original_duration);
   // re-calculate waypoint velocity and acceleration
   auto target_state = trajectory.getWayPointPtr(waypoint_idx + 1);
   const auto prev_state = trajectory.getWayPointPtr(waypoint_idx);
@@ -349,31 +428,62 @@ void RuckigSmoothing::extendTrajectoryDuration(const double duration_extension_f
   }
 }
 
-void RuckigSmoothing::initializeRuckigState(const moveit::core::RobotState& first_waypoint,
-                                            const moveit::core::JointModelGroup* joint_group,
-                                            ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input)
+bool RuckigSmoothing::runRuckig(robot_trajectory::CompactRobotTrajectory& trajectory, Workspace& workspace,
+                                const bool mitigate_overshoot, const double overshoot_threshold)
 {
-  const size_t num_dof = joint_group->getVariableCount();
-  const std::vector<int>& idx = joint_group->getVariableIndexList();
+  const size_t num_waypoints = trajectory.getWayPointCount();
 
-  std::vector<double> current_positions_vector(num_dof);
-  std::vector<double> current_velocities_vector(num_dof);
-  std::vector<double> current_accelerations_vector(num_dof);
+  // This lib does not work properly when angles wrap, so we need to unwind the path first
+  trajectory.unwind();
 
-  for (size_t i = 0; i < num_dof; ++i)
+  // Cache the durations in case we need to extend them
+  workspace.original_durations.resize(num_waypoints);
+  for (size_t waypoint_idx = 0; waypoint_idx < num_waypoints; ++waypoint_idx)
+  {
+    workspace.original_durations[waypoint_idx] = trajectory.getWayPointDurationFromPrevious(waypoint_idx);
+  }
+
+  for (size_t waypoint_idx = 0; waypoint_idx < num_waypoints - 1; ++waypoint_idx)
   {
-    current_positions_vector.at(i) = first_waypoint.getVariablePosition(idx.at(i));
-    current_velocities_vector.at(i) = first_waypoint.getVariableVelocity(idx.at(i));
-    current_accelerations_vector.at(i) = first_waypoint.getVariableAcceleration(idx.at(i));
-    // Clamp velocities/accelerations in case they exceed the limit due to small numerical errors
-    current_velocities_vector.at(i) =
-        std::clamp(current_velocities_vector.at(i), -ruckig_input.max_velocity.at(i), ruckig_input.max_velocity.at(i));
-    current_accelerations_vector.at(i) = std::clamp(
-        current_accelerations_vector.at(i), -ruckig_input.max_acceleration.at(i), ruckig_input.max_acceleration.at(i));
+    double duration_extension_factor = 1;
+    while (true)
+    {
+      getNextRuckigInput(trajectory, waypoint_idx, workspace.ruckig_input);
+      if (smoothSegment(workspace, mitigate_overshoot, overshoot_threshold))
+      {
+        break;
+      }
+
+      // Extend the duration of the failed segment and smooth it again. The segments before it are not affected.
+      duration_extension_factor *= DURATION_EXTENSION_FRACTION;
+      if (duration_extension_factor >= MAX_DURATION_EXTENSION_FACTOR)
+      {
+        if (!acceptFailedSegment(workspace, waypoint_idx))
+        {
+          return false;
+        }
+        break;
+      }
+      extendTrajectoryDuration(duration_extension_factor, waypoint_idx, workspace.original_durations[waypoint_idx + 1],
+                               trajectory);
+    }
   }
-  std::copy_n(current_positions_vector.begin(), num_dof, ruckig_input.current_position.begin());
-  std::copy_n(current_velocities_vector.begin(), num_dof, ruckig_input.current_velocity.begin());
-  std::copy_n(current_accelerations_vector.begin(), num_dof, ruckig_input.current_acceleration.begin());
+  trajectory.setWayPointDurationFromPrevious(num_waypoints - 1, workspace.ruckig_trajectory.get_duration());
+
+  return true;
+}
+
+void RuckigSmoothing::extendTrajectoryDuration(const double duration_extension_factor, size_t waypoint_idx,
+                                               const double original_duration,
+                                               robot_trajectory::CompactRobotTrajectory& trajectory)
+{
+  trajectory.setWayPointDurationFromPrevious(waypoint_idx + 1, duration_extension_factor * original_duration);
+  // re-calculate waypoint velocity and acceleration
+  const double timestep = trajectory.getWayPointDurationFromPrevious(waypoint_idx + 1);
+  auto target_velocity = trajectory.getWayPointVelocities(waypoint_idx + 1);
+  target_velocity /= duration_extension_factor;
+  trajectory.getWayPointAccelerations(waypoint_idx + 1) =
+      (target_velocity - trajectory.getWayPointVelocities(waypoint_idx)) / timestep;
 }
 
 void RuckigSmoothing::getNextRuckigInput(const moveit::core::RobotStateConstPtr& current_waypoint,
@@ -394,35 +504,42 @@ void RuckigSmoothing::getNextRuckigInput(const moveit::core::RobotStateConstPtr&
     ruckig_input.target_position.at(joint) = next_waypoint->getVariablePosition(idx.at(joint));
     ruckig_input.target_velocity.at(joint) = next_waypoint->getVariableVelocity(idx.at(joint));
     ruckig_input.target_acceleration.at(joint) = next_waypoint->getVariableAcceleration(idx.at(joint));
-
-    // Clamp velocities/accelerations in case they exceed the limit due to small numerical errors
-    ruckig_input.current_velocity.at(joint) =
-        std::clamp(ruckig_input.current_velocity.at(joint), -ruckig_input.max_velocity.at(joint),
-                   ruckig_input.max_velocity.at(joint));
-    ruckig_input.current_acceleration.at(joint) =
-        std::clamp(ruckig_input.current_acceleration.at(joint), -ruckig_input.max_acceleration.at(joint),
-                   ruckig_input.max_acceleration.at(joint));
-    ruckig_input.target_velocity.at(joint) =
-        std::clamp(ruckig_input.target_velocity.at(joint), -ruckig_input.max_velocity.at(joint),
-                   ruckig_input.max_velocity.at(joint));
-    ruckig_input.target_acceleration.at(joint) =
-        std::clamp(ruckig_input.target_acceleration.at(joint), -ruckig_input.max_acceleration.at(joint),
-                   ruckig_input.max_acceleration.at(joint));
   }
+  clampRuckigInput(ruckig_input);
 }
 
-bool RuckigSmoothing::checkOvershoot(ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector>& ruckig_trajectory,
-                                     const size_t num_dof, ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input,
-                                     const double overshoot_threshold)
+void RuckigSmoothing::getNextRuckigInput(const robot_trajectory::CompactRobotTrajectory& trajectory,
+                                         size_t waypoint_idx, ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input)
 {
+  const size_t num_dof = trajectory.getVariableCount();
+  const auto current_positions = trajectory.getWayPointPositions(waypoint_idx);
+  const auto current_velocities = trajectory.getWayPointVelocities(waypoint_idx);
+  const auto current_accelerations = trajectory.getWayPointAccelerations(waypoint_idx);
+  const auto target_positions = trajectory.getWayPointPositions(waypoint_idx + 1);
+  const auto target_velocities = trajectory.getWayPointVelocities(waypoint_idx + 1);
+  const auto target_accelerations = trajectory.getWayPointAccelerations(waypoint_idx + 1);
+
+  std::copy_n(current_positions.data(), num_dof, ruckig_input.current_position.begin());
+  std::copy_n(current_velocities.data(), num_dof, ruckig_input.current_velocity.begin());
+  std::copy_n(current_accelerations.data(), num_dof, ruckig_input.current_acceleration.begin());
+  std::copy_n(target_positions.data(), num_dof, ruckig_input.target_position.begin());
+  std::copy_n(target_velocities.data(), num_dof, ruckig_input.target_velocity.begin());
+  std::copy_n(target_accelerations.data(), num_dof, ruckig_input.target_acceleration.begin());
+  clampRuckigInput(ruckig_input);
+}
+
+bool RuckigSmoothing::checkOvershoot(Workspace& workspace, const double overshoot_threshold)
+{
+  const size_t num_dof = workspace.ruckig_input.degrees_of_freedom;
+  const ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input = workspace.ruckig_input;
+  std::vector<double>& new_position = workspace.new_position;
+
   // For every timestep
-  for (double time_from_start = OVERSHOOT_CHECK_PERIOD; time_from_start < ruckig_trajectory.get_duration();
+  for (double time_from_start = OVERSHOOT_CHECK_PERIOD; time_from_start < workspace.ruckig_trajectory.get_duration();
        time_from_start += OVERSHOOT_CHECK_PERIOD)
   {
-    std::vector<double> new_position(num_dof);
-    std::vector<double> new_velocity(num_dof);
-    std::vector<double> new_acceleration(num_dof);
-    ruckig_trajectory.at_time(time_from_start, new_position, new_velocity, new_acceleration);
+    workspace.ruckig_trajectory.at_time(time_from_start, new_position, workspace.new_velocity,
+                                        workspace.new_acceleration);
     // For every joint
     for (size_t joint = 0; joint < num_dof; ++joint)
     {
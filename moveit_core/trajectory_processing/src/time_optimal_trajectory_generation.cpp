@@ -43,6 +43,10 @@
 #include <algorithm>
 #include <cmath>
 #include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
+#include <moveit/dynamics_solver/dynamics_solver.h>
+#include <atomic>
+#include <functional>
+#include <thread>
 #include <vector>
 
 namespace trajectory_processing
@@ -54,6 +58,34 @@ static const rclcpp::Logger LOGGER =
 constexpr double DEFAULT_TIMESTEP = 1e-3;
 constexpr double EPS = 1e-6;
 constexpr double DEFAULT_SCALING_FACTOR = 1.0;
+
+// Returns the waypoints whose positions differ from the previously kept one by more than min_angle_change in at
+// least one joint. The first and the last waypoint are always kept.
+std::vector<Eigen::VectorXd> removeRepeatedPoints(const size_t num_points,
+                                                  const std::function<Eigen::VectorXd(size_t)>& get_point,
+                                                  const double min_angle_change)
+{
+  std::vector<Eigen::VectorXd> points;
+  points.reserve(num_points);
+  for (size_t p = 0; p < num_points; ++p)
+  {
+    Eigen::VectorXd new_point = get_point(p);
+    // The first point should always be kept, and if any joint angle is different, it's a unique waypoint
+    const bool diverse_point = (p == 0) || ((new_point - points.back()).cwiseAbs().maxCoeff() > min_angle_change);
+
+    if (diverse_point)
+    {
+      points.push_back(std::move(new_point));
+      // If the last point is not a diverse_point we replace the last added point with it to make sure to always have
+      // the input end point as the last point
+    }
+    else if (p == num_points - 1)
+    {
+      points.back() = std::move(new_point);
+    }
+  }
+  return points;
+}
 }  // namespace
 
 class LinearPathSegment : public PathSegment
@@ -194,14 +226,21 @@ private:
   Eigen::VectorXd y_;
 };
 
-Path::Path(const std::list<Eigen::VectorXd>& path, double max_deviation) : length_(0.0)
+Path::Path(const std::list<Eigen::VectorXd>& path, double max_deviation)
+  : Path(std::vector<Eigen::VectorXd>(path.begin(), path.end()), max_deviation)
+{
+}
+
+Path::Path(const std::vector<Eigen::VectorXd>& path, double max_deviation) : length_(0.0)
 {
   if (path.size() < 2)
     return;
-  std::list<Eigen::VectorXd>::const_iterator path_iterator1 = path.begin();
-  std::list<Eigen::VectorXd>::const_iterator path_iterator2 = path_iterator1;
+  // a linear segment and a blend per waypoint at most
+  path_segments_.reserve(2 * path.size());
+  std::vector<Eigen::VectorXd>::const_iterator path_iterator1 = path.begin();
+  std::vector<Eigen::VectorXd>::const_iterator path_iterator2 = path_iterator1;
   ++path_iterator2;
-  std::list<Eigen::VectorXd>::const_iterator path_iterator3;
+  std::vector<Eigen::VectorXd>::const_iterator path_iterator3;
   Eigen::VectorXd start_config = *path_iterator1;
   while (path_iterator2 != path.end())
   {
@@ -251,6 +290,7 @@ Path::Path(const std::list<Eigen::VectorXd>& path, double max_deviation) : lengt
 
 Path::Path(const Path& path) : length_(path.length_), switching_points_(path.switching_points_)
 {
+  path_segments_.reserve(path.path_segments_.size());
   for (const std::unique_ptr<PathSegment>& path_segment : path.path_segments_)
   {
     path_segments_.emplace_back(path_segment->clone());
@@ -264,14 +304,11 @@ double Path::getLength() const
 
 PathSegment* Path::getPathSegment(double& s) const
 {
-  std::list<std::unique_ptr<PathSegment>>::const_iterator it = path_segments_.begin();
-  std::list<std::unique_ptr<PathSegment>>::const_iterator next = it;
-  ++next;
-  while (next != path_segments_.end() && s >= (*next)->position_)
-  {
-    it = next;
-    ++next;
-  }
+  // the last segment starting at or before s, or the first segment if s is before the start
+  std::vector<std::unique_ptr<PathSegment>>::const_iterator it =
+      std::upper_bound(path_segments_.begin() + 1, path_segments_.end(), s,
+                       [](double s, const std::unique_ptr<PathSegment>& segment) { return s < segment->position_; });
+  --it;
   s -= (*it)->position_;
   return (*it).get();
 }
@@ -296,11 +333,9 @@ Eigen::VectorXd Path::getCurvature(double s) const
 
 double Path::getNextSwitchingPoint(double s, bool& discontinuity) const
 {
-  std::list<std::pair<double, bool>>::const_iterator it = switching_points_.begin();
-  while (it != switching_points_.end() && it->first <= s)
-  {
-    ++it;
-  }
+  std::vector<std::pair<double, bool>>::const_iterator it =
+      std::upper_bound(switching_points_.begin(), switching_points_.end(), s,
+                       [](double s, const std::pair<double, bool>& point) { return s < point.first; });
   if (it == switching_points_.end())
   {
     discontinuity = true;
@@ -312,7 +347,7 @@ double Path::getNextSwitchingPoint(double s, bool& discontinuity) const
 
 std::list<std::pair<double, bool>> Path::getSwitchingPoints() const
 {
-  return switching_points_;
+  return std::list<std::pair<double, bool>>(switching_points_.begin(), switching_points_.end());
 }
 
 Trajectory::Trajectory(const Path& path, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
@@ -322,8 +357,42 @@ Trajectory::Trajectory(const Path& path, const Eigen::VectorXd& max_velocity, co
   , max_acceleration_(max_acceleration)
   , joint_num_(max_velocity.size())
   , valid_(true)
+  , torque_limited_(false)
+  , time_step_(time_step)
+  , cached_time_(std::numeric_limits<double>::max())
+{
+  integrate();
+}
+
+Trajectory::Trajectory(const Path& path, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
+                       const InverseDynamicsFn& inverse_dynamics, const Eigen::VectorXd& max_torque,
+                       double time_step, double torque_sample_distance)
+  : path_(path)
+  , max_velocity_(max_velocity)
+  , max_acceleration_(max_acceleration)
+  , joint_num_(max_velocity.size())
+  , valid_(true)
+  , torque_limited_(true)
+  , max_torque_(max_torque)
   , time_step_(time_step)
   , cached_time_(std::numeric_limits<double>::max())
+{
+  if (max_torque_.size() != joint_num_ || torque_sample_distance <= 0.0)
+  {
+    valid_ = false;
+    RCLCPP_ERROR(LOGGER, "The trajectory is invalid because the torque limits or the sample distance are invalid.");
+    return;
+  }
+  if (!sampleTorqueCoefficients(inverse_dynamics, torque_sample_distance))
+  {
+    valid_ = false;
+    RCLCPP_ERROR(LOGGER, "The trajectory is invalid because the inverse dynamics failed along the path.");
+    return;
+  }
+  integrate();
+}
+
+void Trajectory::integrate()
 {
   if (time_step_ == 0)
   {
@@ -353,8 +422,8 @@ Trajectory::Trajectory(const Path& path, const Eigen::VectorXd& max_velocity, co
   if (valid_)
   {
     // Calculate timing
-    std::list<TrajectoryStep>::iterator previous = trajectory_.begin();
-    std::list<TrajectoryStep>::iterator it = previous;
+    std::vector<TrajectoryStep>::iterator previous = trajectory_.begin();
+    std::vector<TrajectoryStep>::iterator it = previous;
     it->time_ = 0.0;
     ++it;
     while (it != trajectory_.end())
@@ -398,9 +467,9 @@ bool Trajectory::getNextSwitchingPoint(double path_pos, TrajectoryStep& next_swi
       (velocity_switching_point.path_vel_ > getAccelerationMaxPathVelocity(velocity_switching_point.path_pos_ - EPS) ||
        velocity_switching_point.path_vel_ > getAccelerationMaxPathVelocity(velocity_switching_point.path_pos_ + EPS)));
 
-  if (acceleration_reached_end && velocity_reached_end)
+  const bool reached_end = acceleration_reached_end && velocity_reached_end;
+  if (reached_end)
   {
-    return true;
   }
   else if (!acceleration_reached_end &&
            (velocity_reached_end || acceleration_switching_point.path_pos_ <= velocity_switching_point.path_pos_))
@@ -408,15 +477,38 @@ bool Trajectory::getNextSwitchingPoint(double path_pos, TrajectoryStep& next_swi
     next_switching_point = acceleration_switching_point;
     before_acceleration = acceleration_before_acceleration;
     after_acceleration = acceleration_after_acceleration;
-    return false;
   }
   else
   {
     next_switching_point = velocity_switching_point;
     before_acceleration = velocity_before_acceleration;
     after_acceleration = velocity_after_acceleration;
+  }
+
+  if (!torque_limited_)
+  {
+    return reached_end;
+  }
+
+  TrajectoryStep torque_switching_point(path_pos, 0.0);
+  double torque_before_acceleration, torque_after_acceleration;
+  bool torque_reached_end;
+  do
+  {
+    torque_reached_end = getNextTorqueSwitchingPoint(torque_switching_point.path_pos_, torque_switching_point,
+                                                     torque_before_acceleration, torque_after_acceleration);
+  } while (!torque_reached_end &&
+           (reached_end || torque_switching_point.path_pos_ < next_switching_point.path_pos_) &&
+           torque_switching_point.path_vel_ > getVelocityMaxPathVelocity(torque_switching_point.path_pos_));
+
+  if (!torque_reached_end && (reached_end || torque_switching_point.path_pos_ < next_switching_point.path_pos_))
+  {
+    next_switching_point = torque_switching_point;
+    before_acceleration = torque_before_acceleration;
+    after_acceleration = torque_after_acceleration;
     return false;
   }
+  return reached_end;
 }
 
 bool Trajectory::getNextAccelerationSwitchingPoint(double path_pos, TrajectoryStep& next_switching_point,
@@ -456,6 +548,12 @@ bool Trajectory::getNextAccelerationSwitchingPoint(double path_pos, TrajectorySt
       switching_path_vel = getAccelerationMaxPathVelocity(switching_path_pos);
       before_acceleration = 0.0;
       after_acceleration = 0.0;
+      if (torque_limited_)
+      {
+        // gravity and coriolis torques shift the path acceleration on the limit curve away from zero
+        before_acceleration = getMinMaxPathAcceleration(switching_path_pos, switching_path_vel, false);
+        after_acceleration = getMinMaxPathAcceleration(switching_path_pos, switching_path_vel, true);
+      }
 
       if (getAccelerationMaxPathVelocityDeriv(switching_path_pos - EPS) < 0.0 &&
           getAccelerationMaxPathVelocityDeriv(switching_path_pos + EPS) > 0.0)
@@ -514,14 +612,73 @@ bool Trajectory::getNextVelocitySwitchingPoint(double path_pos, TrajectoryStep&
   return false;
 }
 
+// Returns true if end of path is reached.
+// The torque limits bound the path velocity anywhere along the path, not only at the switching points of the path
+// segments, so the limit curve is scanned for points where the path acceleration on the curve stops exceeding the
+// slope of the curve. Leaving such a point at the limit acceleration in both directions stays below the curve.
+bool Trajectory::getNextTorqueSwitchingPoint(double path_pos, TrajectoryStep& next_switching_point,
+                                             double& before_acceleration, double& after_acceleration)
+{
+  const auto slope_excess = [this](double s) {
+    const double path_vel = getAccelerationMaxPathVelocity(s);
+    if (!std::isfinite(path_vel) || path_vel <= 0.0)
+      return 1.0;
+    return getMinMaxPhaseSlope(s, path_vel, false) - getAccelerationMaxPathVelocityDeriv(s);
+  };
+
+  double previous_excess = slope_excess(path_pos);
+  do
+  {
+    path_pos += DEFAULT_TIMESTEP;
+    const double excess = slope_excess(path_pos);
+    if (previous_excess > 0.0 && excess <= 0.0)
+    {
+      break;
+    }
+    previous_excess = excess;
+  } while (path_pos < path_.getLength());
+
+  if (path_pos >= path_.getLength())
+  {
+    return true;  // end of trajectory reached
+  }
+
+  double before_path_pos = path_pos - DEFAULT_TIMESTEP;
+  double after_path_pos = path_pos;
+  while (after_path_pos - before_path_pos > EPS)
+  {
+    path_pos = (before_path_pos + after_path_pos) / 2.0;
+    if (slope_excess(path_pos) > 0.0)
+    {
+      before_path_pos = path_pos;
+    }
+    else
+    {
+      after_path_pos = path_pos;
+    }
+  }
+
+  // the curve may have a kink here, with different limits active on either side
+  before_path_pos -= EPS;
+  after_path_pos += EPS;
+  const double path_vel = std::min(getAccelerationMaxPathVelocity(before_path_pos),
+                                   getAccelerationMaxPathVelocity(after_path_pos));
+  before_acceleration = getMinMaxPathAcceleration(before_path_pos, path_vel, false);
+  after_acceleration = getMinMaxPathAcceleration(after_path_pos, path_vel, true);
+  next_switching_point = TrajectoryStep(path_pos, path_vel);
+  return false;
+}
+
 // Returns true if end of path is reached
-bool Trajectory::integrateForward(std::list<TrajectoryStep>& trajectory, double acceleration)
+bool Trajectory::integrateForward(std::vector<TrajectoryStep>& trajectory, double acceleration)
 {
   double path_pos = trajectory.back().path_pos_;
   double path_vel = trajectory.back().path_vel_;
 
-  std::list<std::pair<double, bool>> switching_points = path_.getSwitchingPoints();
-  std::list<std::pair<double, bool>>::iterator next_discontinuity = switching_points.begin();
+  const std::vector<std::pair<double, bool>>& switching_points = path_.switching_points_;
+  std::vector<std::pair<double, bool>>::const_iterator next_discontinuity =
+      std::upper_bound(switching_points.begin(), switching_points.end(), path_pos,
+                       [](double s, const std::pair<double, bool>& point) { return s < point.first; });
 
   while (true)
   {
@@ -641,14 +798,17 @@ bool Trajectory::integrateForward(std::list<TrajectoryStep>& trajectory, double
   }
 }
 
-void Trajectory::integrateBackward(std::list<TrajectoryStep>& start_trajectory, double path_pos, double path_vel,
+void Trajectory::integrateBackward(std::vector<TrajectoryStep>& start_trajectory, double path_pos, double path_vel,
                                    double acceleration)
 {
-  std::list<TrajectoryStep>::iterator start2 = start_trajectory.end();
+  std::vector<TrajectoryStep>::iterator start2 = start_trajectory.end();
   --start2;
-  std::list<TrajectoryStep>::iterator start1 = start2;
+  std::vector<TrajectoryStep>::iterator start1 = start2;
   --start1;
-  std::list<TrajectoryStep> trajectory;
+  // The backward trajectory is built in reverse, its back() being the step closest to the start.
+  // The buffer is kept across calls so its memory is reused by every integration on this thread.
+  static thread_local std::vector<TrajectoryStep> trajectory;
+  trajectory.clear();
   double slope;
   assert(start1->path_pos_ <= path_pos);
 
@@ -656,17 +816,17 @@ void Trajectory::integrateBackward(std::list<TrajectoryStep>& start_trajectory,
   {
     if (start1->path_pos_ <= path_pos)
     {
-      trajectory.push_front(TrajectoryStep(path_pos, path_vel));
+      trajectory.push_back(TrajectoryStep(path_pos, path_vel));
       path_vel -= time_step_ * acceleration;
-      path_pos -= time_step_ * 0.5 * (path_vel + trajectory.front().path_vel_);
+      path_pos -= time_step_ * 0.5 * (path_vel + trajectory.back().path_vel_);
       acceleration = getMinMaxPathAcceleration(path_pos, path_vel, false);
-      slope = (trajectory.front().path_vel_ - path_vel) / (trajectory.front().path_pos_ - path_pos);
+      slope = (trajectory.back().path_vel_ - path_vel) / (trajectory.back().path_pos_ - path_pos);
 
       if (path_vel < 0.0)
       {
         valid_ = false;
         RCLCPP_ERROR(LOGGER, "Error while integrating backward: Negative path velocity");
-        end_trajectory_ = trajectory;
+        end_trajectory_.assign(trajectory.rbegin(), trajectory.rend());
         return;
       }
     }
@@ -682,20 +842,20 @@ void Trajectory::integrateBackward(std::list<TrajectoryStep>& start_trajectory,
     const double intersection_path_pos =
         (start1->path_vel_ - path_vel + slope * path_pos - start_slope * start1->path_pos_) / (slope - start_slope);
     if (std::max(start1->path_pos_, path_pos) - EPS <= intersection_path_pos &&
-        intersection_path_pos <= EPS + std::min(start2->path_pos_, trajectory.front().path_pos_))
+        intersection_path_pos <= EPS + std::min(start2->path_pos_, trajectory.back().path_pos_))
     {
       const double intersection_path_vel =
           start1->path_vel_ + start_slope * (intersection_path_pos - start1->path_pos_);
       start_trajectory.erase(start2, start_trajectory.end());
       start_trajectory.push_back(TrajectoryStep(intersection_path_pos, intersection_path_vel));
-      start_trajectory.splice(start_trajectory.end(), trajectory);
+      start_trajectory.insert(start_trajectory.end(), trajectory.rbegin(), trajectory.rend());
       return;
     }
   }
 
   valid_ = false;
   RCLCPP_ERROR(LOGGER, "Error while integrating backward: Did not hit start trajectory");
-  end_trajectory_ = trajectory;
+  end_trajectory_.assign(trajectory.rbegin(), trajectory.rend());
 }
 
 double Trajectory::getMinMaxPathAcceleration(double path_pos, double path_vel, bool max)
@@ -713,6 +873,20 @@ double Trajectory::getMinMaxPathAcceleration(double path_pos, double path_vel, b
                                               factor * config_deriv2[i] * path_vel * path_vel / config_deriv[i]);
     }
   }
+  if (torque_limited_)
+  {
+    Eigen::VectorXd mass, coriolis, gravity;
+    getTorqueCoefficients(path_pos, mass, coriolis, gravity);
+    for (unsigned int i = 0; i < joint_num_; ++i)
+    {
+      if (max_torque_[i] > 0.0 && mass[i] != 0.0)
+      {
+        max_path_acceleration =
+            std::min(max_path_acceleration, max_torque_[i] / std::abs(mass[i]) -
+                                                factor * (coriolis[i] * path_vel * path_vel + gravity[i]) / mass[i]);
+      }
+    }
+  }
   return factor * max_path_acceleration;
 }
 
@@ -723,6 +897,10 @@ double Trajectory::getMinMaxPhaseSlope(double path_pos, double path_vel, bool ma
 
 double Trajectory::getAccelerationMaxPathVelocity(double path_pos) const
 {
+  if (torque_limited_)
+  {
+    return getTorqueMaxPathVelocity(path_pos);
+  }
   double max_path_velocity = std::numeric_limits<double>::infinity();
   const Eigen::VectorXd config_deriv = path_.getTangent(path_pos);
   const Eigen::VectorXd config_deriv2 = path_.getCurvature(path_pos);
@@ -787,6 +965,143 @@ double Trajectory::getVelocityMaxPathVelocityDeriv(double path_pos)
          (tangent[active_constraint] * std::abs(tangent[active_constraint]));
 }
 
+bool Trajectory::sampleTorqueCoefficients(const InverseDynamicsFn& inverse_dynamics, double sample_distance)
+{
+  const std::vector<std::unique_ptr<PathSegment>>& segments = path_.path_segments_;
+  torque_segment_offsets_.assign(1, 0);
+  for (const std::unique_ptr<PathSegment>& segment : segments)
+  {
+    const auto samples = static_cast<std::size_t>(std::ceil(segment->getLength() / sample_distance)) + 1;
+    torque_segment_offsets_.push_back(torque_segment_offsets_.back() + std::max<std::size_t>(samples, 2));
+  }
+
+  const std::size_t sample_count = torque_segment_offsets_.back();
+  Eigen::MatrixXd positions(joint_num_, sample_count);
+  Eigen::MatrixXd tangents(joint_num_, sample_count);
+  Eigen::MatrixXd curvatures(joint_num_, sample_count);
+  for (std::size_t k = 0; k < segments.size(); ++k)
+  {
+    const std::size_t first = torque_segment_offsets_[k];
+    const std::size_t intervals = torque_segment_offsets_[k + 1] - first - 1;
+    for (std::size_t i = 0; i <= intervals; ++i)
+    {
+      const double s = segments[k]->getLength() * i / intervals;
+      positions.col(first + i) = segments[k]->getConfig(s);
+      tangents.col(first + i) = segments[k]->getTangent(s);
+      curvatures.col(first + i) = segments[k]->getCurvature(s);
+    }
+  }
+
+  // torques are linear in the path acceleration and quadratic in the path velocity, so three batches give the
+  // coefficients: gravity at rest, mass from a unit path acceleration, coriolis from a unit path velocity
+  const Eigen::MatrixXd zeros = Eigen::MatrixXd::Zero(joint_num_, sample_count);
+  if (!inverse_dynamics(positions, zeros, zeros, torque_gravity_) ||
+      !inverse_dynamics(positions, zeros, tangents, torque_mass_) ||
+      !inverse_dynamics(positions, tangents, curvatures, torque_coriolis_))
+  {
+    return false;
+  }
+  torque_mass_ -= torque_gravity_;
+  torque_coriolis_ -= torque_gravity_;
+  return true;
+}
+
+void Trajectory::getTorqueCoefficients(double path_pos, Eigen::VectorXd& mass, Eigen::VectorXd& coriolis,
+                                       Eigen::VectorXd& gravity) const
+{
+  const std::vector<std::unique_ptr<PathSegment>>& segments = path_.path_segments_;
+  const std::size_t segment =
+      std::upper_bound(segments.begin() + 1, segments.end(), path_pos,
+                       [](double s, const std::unique_ptr<PathSegment>& segment) { return s < segment->position_; }) -
+      segments.begin() - 1;
+  const std::size_t first = torque_segment_offsets_[segment];
+  const std::size_t intervals = torque_segment_offsets_[segment + 1] - first - 1;
+
+  const double length = segments[segment]->getLength();
+  double sample = length > 0.0 ? (path_pos - segments[segment]->position_) / length * intervals : 0.0;
+  sample = std::max(0.0, std::min(static_cast<double>(intervals), sample));
+  const std::size_t index = std::min(static_cast<std::size_t>(sample), intervals - 1);
+  const double weight = sample - index;
+
+  mass = (1.0 - weight) * torque_mass_.col(first + index) + weight * torque_mass_.col(first + index + 1);
+  coriolis = (1.0 - weight) * torque_coriolis_.col(first + index) + weight * torque_coriolis_.col(first + index + 1);
+  gravity = (1.0 - weight) * torque_gravity_.col(first + index) + weight * torque_gravity_.col(first + index + 1);
+}
+
+double Trajectory::getTorqueMaxPathVelocity(double path_pos) const
+{
+  // Each acceleration and torque limit is a constraint |a * path_acc + b * path_vel^2 + c| <= limit. The maximum
+  // path velocity is the largest one at which the path acceleration intervals of all pairs of constraints overlap.
+  Eigen::VectorXd mass, coriolis, gravity;
+  getTorqueCoefficients(path_pos, mass, coriolis, gravity);
+  const Eigen::VectorXd config_deriv = path_.getTangent(path_pos);
+  const Eigen::VectorXd config_deriv2 = path_.getCurvature(path_pos);
+
+  std::vector<double> a, b, c, limit;
+  a.reserve(2 * joint_num_);
+  b.reserve(2 * joint_num_);
+  c.reserve(2 * joint_num_);
+  limit.reserve(2 * joint_num_);
+  for (unsigned int i = 0; i < joint_num_; ++i)
+  {
+    a.push_back(config_deriv[i]);
+    b.push_back(config_deriv2[i]);
+    c.push_back(0.0);
+    limit.push_back(max_acceleration_[i]);
+  }
+  for (unsigned int i = 0; i < joint_num_; ++i)
+  {
+    if (max_torque_[i] > 0.0)
+    {
+      a.push_back(mass[i]);
+      b.push_back(coriolis[i]);
+      c.push_back(gravity[i]);
+      limit.push_back(max_torque_[i]);
+    }
+  }
+
+  double max_path_velocity_sq = std::numeric_limits<double>::infinity();
+  for (std::size_t i = 0; i < a.size(); ++i)
+  {
+    if (a[i] == 0.0)
+    {
+      // a bound on the path velocity alone
+      if (b[i] > 0.0)
+      {
+        max_path_velocity_sq = std::min(max_path_velocity_sq, (limit[i] - c[i]) / b[i]);
+      }
+      else if (b[i] < 0.0)
+      {
+        max_path_velocity_sq = std::min(max_path_velocity_sq, (limit[i] + c[i]) / -b[i]);
+      }
+      else if (std::abs(c[i]) > limit[i])
+      {
+        max_path_velocity_sq = 0.0;
+      }
+      continue;
+    }
+    for (std::size_t j = 0; j < a.size(); ++j)
+    {
+      if (j == i || a[j] == 0.0)
+      {
+        continue;
+      }
+      // the lower path acceleration bound of i must not exceed the upper one of j
+      const double slope = b[j] / a[j] - b[i] / a[i];
+      const double margin = limit[i] / std::abs(a[i]) + limit[j] / std::abs(a[j]) + c[i] / a[i] - c[j] / a[j];
+      if (slope > 0.0)
+      {
+        max_path_velocity_sq = std::min(max_path_velocity_sq, margin / slope);
+      }
+      else if (margin < 0.0)
+      {
+        max_path_velocity_sq = 0.0;
+      }
+    }
+  }
+  return std::sqrt(std::max(0.0, max_path_velocity_sq));
+}
+
 bool Trajectory::isValid() const
 {
   return valid_;
@@ -797,11 +1112,11 @@ double Trajectory::getDuration() const
   return trajectory_.back().time_;
 }
 
-std::list<Trajectory::TrajectoryStep>::const_iterator Trajectory::getTrajectorySegment(double time) const
+std::vector<Trajectory::TrajectoryStep>::const_iterator Trajectory::getTrajectorySegment(double time) const
 {
   if (time >= trajectory_.back().time_)
   {
-    std::list<TrajectoryStep>::const_iterator last = trajectory_.end();
+    std::vector<TrajectoryStep>::const_iterator last = trajectory_.end();
     last--;
     return last;
   }
@@ -809,8 +1124,12 @@ std::list<Trajectory::TrajectoryStep>::const_iterator Trajectory::getTrajectoryS
   {
     if (time < cached_time_)
     {
-      cached_trajectory_segment_ = trajectory_.begin();
+      // the first step after time
+      cached_trajectory_segment_ =
+          std::upper_bound(trajectory_.begin(), trajectory_.end(), time,
+                           [](double time, const TrajectoryStep& step) { return time < step.time_; });
     }
+    // samples are usually requested in increasing order, so walk forward from the previous one
     while (time >= cached_trajectory_segment_->time_)
     {
       ++cached_trajectory_segment_;
@@ -822,8 +1141,8 @@ std::list<Trajectory::TrajectoryStep>::const_iterator Trajectory::getTrajectoryS
 
 Eigen::VectorXd Trajectory::getPosition(double time) const
 {
-  std::list<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
-  std::list<TrajectoryStep>::const_iterator previous = it;
+  std::vector<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
+  std::vector<TrajectoryStep>::const_iterator previous = it;
   previous--;
 
   double time_step = it->time_ - previous->time_;
@@ -839,8 +1158,8 @@ Eigen::VectorXd Trajectory::getPosition(double time) const
 
 Eigen::VectorXd Trajectory::getVelocity(double time) const
 {
-  std::list<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
-  std::list<TrajectoryStep>::const_iterator previous = it;
+  std::vector<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
+  std::vector<TrajectoryStep>::const_iterator previous = it;
   previous--;
 
   double time_step = it->time_ - previous->time_;
@@ -856,8 +1175,8 @@ Eigen::VectorXd Trajectory::getVelocity(double time) const
 
 Eigen::VectorXd Trajectory::getAcceleration(double time) const
 {
-  std::list<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
-  std::list<TrajectoryStep>::const_iterator previous = it;
+  std::vector<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
+  std::vector<TrajectoryStep>::const_iterator previous = it;
   previous--;
 
   double time_step = it->time_ - previous->time_;
@@ -894,6 +1213,23 @@ bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::RobotT
     return false;
   }
 
+  Eigen::VectorXd max_velocity;
+  Eigen::VectorXd max_acceleration;
+  if (!getModelLimits(group, max_velocity_scaling_factor, max_acceleration_scaling_factor, max_velocity,
+                      max_acceleration))
+  {
+    return false;
+  }
+
+  return doTimeParameterizationCalculations(trajectory, max_velocity, max_acceleration);
+}
+
+bool TimeOptimalTrajectoryGeneration::getModelLimits(const moveit::core::JointModelGroup* group,
+                                                     const double max_velocity_scaling_factor,
+                                                     const double max_acceleration_scaling_factor,
+                                                     Eigen::VectorXd& max_velocity,
+                                                     Eigen::VectorXd& max_acceleration) const
+{
   // Validate scaling
   double velocity_scaling_factor = verifyScalingFactor(max_velocity_scaling_factor, VELOCITY);
   double acceleration_scaling_factor = verifyScalingFactor(max_acceleration_scaling_factor, ACCELERATION);
@@ -908,8 +1244,8 @@ bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::RobotT
   }
 
   const size_t num_active_joints = active_joint_indices.size();
-  Eigen::VectorXd max_velocity(num_active_joints);
-  Eigen::VectorXd max_acceleration(num_active_joints);
+  max_velocity.resize(num_active_joints);
+  max_acceleration.resize(num_active_joints);
   for (size_t idx = 0; idx < num_active_joints; ++idx)
   {
     // For active joints only (skip mimic joints and other types)
@@ -956,7 +1292,7 @@ bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::RobotT
     }
   }
 
-  return doTimeParameterizationCalculations(trajectory, max_velocity, max_acceleration);
+  return true;
 }
 
 bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::RobotTrajectory& trajectory,
@@ -1113,9 +1449,52 @@ bool totgComputeTimeStamps(const size_t num_waypoints, robot_trajectory::RobotTr
   return true;
 }
 
+bool TimeOptimalTrajectoryGeneration::computeTimeStampsWithTorqueLimits(
+    robot_trajectory::RobotTrajectory& trajectory, const dynamics_solver::DynamicsSolver& dynamics_solver,
+    const double max_velocity_scaling_factor, const double max_acceleration_scaling_factor,
+    const double max_torque_scaling_factor) const
+{
+  if (trajectory.empty())
+    return true;
+
+  const moveit::core::JointModelGroup* group = trajectory.getGroup();
+  if (!group)
+  {
+    RCLCPP_ERROR(LOGGER, "It looks like the planner did not set the group the plan was computed for");
+    return false;
+  }
+  if (dynamics_solver.getGroup() != group || dynamics_solver.getMaxTorques().size() != group->getVariableCount())
+  {
+    RCLCPP_ERROR(LOGGER, "The dynamics solver was not set up for group '%s'", group->getName().c_str());
+    return false;
+  }
+
+  Eigen::VectorXd max_velocity;
+  Eigen::VectorXd max_acceleration;
+  if (!getModelLimits(group, max_velocity_scaling_factor, max_acceleration_scaling_factor, max_velocity,
+                      max_acceleration))
+  {
+    return false;
+  }
+
+  const double torque_scaling_factor = verifyScalingFactor(max_torque_scaling_factor, TORQUE);
+  const std::vector<double>& max_torques = dynamics_solver.getMaxTorques();
+  const Eigen::VectorXd max_torque =
+      Eigen::Map<const Eigen::VectorXd>(max_torques.data(), max_torques.size()) * torque_scaling_factor;
+
+  const InverseDynamicsFn inverse_dynamics = [&dynamics_solver](
+                                                 const Eigen::MatrixXd& positions, const Eigen::MatrixXd& velocities,
+                                                 const Eigen::MatrixXd& accelerations, Eigen::MatrixXd& torques) {
+    return dynamics_solver.getTorques(positions, velocities, accelerations, torques);
+  };
+  return doTimeParameterizationCalculations(trajectory, max_velocity, max_acceleration, inverse_dynamics, max_torque);
+}
+
 bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(robot_trajectory::RobotTrajectory& trajectory,
                                                                          const Eigen::VectorXd& max_velocity,
-                                                                         const Eigen::VectorXd& max_acceleration) const
+                                                                         const Eigen::VectorXd& max_acceleration,
+                                                                         const InverseDynamicsFn& inverse_dynamics,
+                                                                         const Eigen::VectorXd& max_torque) const
 {
   // This lib does not actually work properly when angles wrap around, so we need to unwind the path first
   trajectory.unwind();
@@ -1139,35 +1518,16 @@ bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(robot_t
 
   // Have to convert into Eigen data structs and remove repeated points
   //  (https://github.com/tobiaskunz/trajectories/issues/3)
-  std::list<Eigen::VectorXd> points;
-  for (size_t p = 0; p < num_points; ++p)
-  {
-    moveit::core::RobotStatePtr waypoint = trajectory.getWayPointPtr(p);
-    Eigen::VectorXd new_point(num_joints);
-    // The first point should always be kept
-    bool diverse_point = (p == 0);
-
-    for (size_t j = 0; j < num_joints; ++j)
-    {
-      new_point[j] = waypoint->getVariablePosition(idx[j]);
-      // If any joint angle is different, it's a unique waypoint
-      if (p > 0 && std::fabs(new_point[j] - points.back()[j]) > min_angle_change_)
-      {
-        diverse_point = true;
-      }
-    }
-
-    if (diverse_point)
-    {
-      points.push_back(new_point);
-      // If the last point is not a diverse_point we replace the last added point with it to make sure to always have
-      // the input end point as the last point
-    }
-    else if (p == num_points - 1)
-    {
-      points.back() = new_point;
-    }
-  }
+  const std::vector<Eigen::VectorXd> points = removeRepeatedPoints(
+      num_points,
+      [&](size_t p) {
+        Eigen::VectorXd point(num_joints);
+        const moveit::core::RobotStatePtr& waypoint = trajectory.getWayPointPtr(p);
+        for (size_t j = 0; j < num_joints; ++j)
+          point[j] = waypoint->getVariablePosition(idx[j]);
+        return point;
+      },
+      min_angle_change_);
 
   // Return trajectory with only the first waypoint if there are not multiple diverse points
   if (points.size() == 1)
@@ -1181,7 +1541,11 @@ bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(robot_t
   }
 
   // Now actually call the algorithm
-  Trajectory parameterized(Path(points, path_tolerance_), max_velocity, max_acceleration, DEFAULT_TIMESTEP);
+  const Trajectory parameterized =
+      inverse_dynamics ?
+          Trajectory(Path(points, path_tolerance_), max_velocity, max_acceleration, inverse_dynamics, max_torque,
+                     DEFAULT_TIMESTEP) :
+          Trajectory(Path(points, path_tolerance_), max_velocity, max_acceleration, DEFAULT_TIMESTEP);
   if (!parameterized.isValid())
   {
     RCLCPP_ERROR(LOGGER, "Unable to parameterize trajectory.");
@@ -1217,6 +1581,172 @@ bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(robot_t
   return true;
 }
 
+bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::CompactRobotTrajectory& trajectory,
+                                                        const double max_velocity_scaling_factor,
+                                                        const double max_acceleration_scaling_factor) const
+{
+  if (trajectory.empty())
+    return true;
+
+  const moveit::core::JointModelGroup* group = trajectory.getGroup();
+  Eigen::VectorXd max_velocity;
+  Eigen::VectorXd max_acceleration;
+  if (!getModelLimits(group, max_velocity_scaling_factor, max_acceleration_scaling_factor, max_velocity,
+                      max_acceleration))
+  {
+    return false;
+  }
+
+  // This lib does not actually work properly when angles wrap around, so we need to unwind the path first
+  trajectory.unwind();
+
+  if (hasMixedJointTypes(group))
+  {
+    RCLCPP_WARN(LOGGER, "There is a combination of revolute and prismatic joints in the robot model. TOTG's "
+                        "`path_tolerance` will not function correctly.");
+  }
+
+  const std::vector<Eigen::VectorXd> points = removeRepeatedPoints(
+      trajectory.getWayPointCount(), [&](size_t p) { return Eigen::VectorXd(trajectory.getWayPointPositions(p)); },
+      min_angle_change_);
+
+  // Return trajectory with only the first waypoint if there are not multiple diverse points
+  const Eigen::VectorXd zeros = Eigen::VectorXd::Zero(trajectory.getVariableCount());
+  if (points.size() == 1)
+  {
+    trajectory.clear();
+    trajectory.addSuffixWayPoint(points.front(), zeros, zeros, 0.0);
+    return true;
+  }
+
+  // Now actually call the algorithm
+  Trajectory parameterized(Path(points, path_tolerance_), max_velocity, max_acceleration, DEFAULT_TIMESTEP);
+  if (!parameterized.isValid())
+  {
+    RCLCPP_ERROR(LOGGER, "Unable to parameterize trajectory.");
+    return false;
+  }
+
+  // Compute sample count
+  size_t sample_count = std::ceil(parameterized.getDuration() / resample_dt_);
+
+  // Resample and fill in trajectory
+  trajectory.clear();
+  trajectory.reserve(sample_count + 1);
+  double last_t = 0;
+  for (size_t sample = 0; sample <= sample_count; ++sample)
+  {
+    // always sample the end of the trajectory as well
+    double t = std::min(parameterized.getDuration(), sample * resample_dt_);
+    trajectory.addSuffixWayPoint(parameterized.getPosition(t), parameterized.getVelocity(t),
+                                 parameterized.getAcceleration(t), t - last_t);
+    last_t = t;
+  }
+
+  return true;
+}
+
+bool TimeOptimalTrajectoryGeneration::computeTimeStampsSegmented(robot_trajectory::RobotTrajectory& trajectory,
+                                                                 const double max_velocity_scaling_factor,
+                                                                 const double max_acceleration_scaling_factor,
+                                                                 const unsigned int num_threads) const
+{
+  std::vector<std::size_t> split_points;
+  const moveit::core::JointModelGroup* group = trajectory.getGroup();
+  if (group)
+  {
+    const std::vector<int>& idx = group->getVariableIndexList();
+    for (std::size_t p = 1; p + 1 < trajectory.getWayPointCount(); ++p)
+    {
+      const moveit::core::RobotState& waypoint = trajectory.getWayPoint(p);
+      if (waypoint.hasVelocities() &&
+          std::all_of(idx.begin(), idx.end(), [&waypoint](int i) { return waypoint.getVariableVelocity(i) == 0.0; }))
+      {
+        split_points.push_back(p);
+      }
+    }
+  }
+  return computeTimeStampsSegmented(trajectory, split_points, max_velocity_scaling_factor,
+                                    max_acceleration_scaling_factor, num_threads);
+}
+
+bool TimeOptimalTrajectoryGeneration::computeTimeStampsSegmented(robot_trajectory::RobotTrajectory& trajectory,
+                                                                 const std::vector<std::size_t>& split_points,
+                                                                 const double max_velocity_scaling_factor,
+                                                                 const double max_acceleration_scaling_factor,
+                                                                 const unsigned int num_threads) const
+{
+  const std::size_t num_points = trajectory.getWayPointCount();
+  std::vector<std::size_t> segment_ends;
+  for (const std::size_t split_point : split_points)
+  {
+    if (split_point > 0 && split_point + 1 < num_points)
+      segment_ends.push_back(split_point);
+  }
+  std::sort(segment_ends.begin(), segment_ends.end());
+  segment_ends.erase(std::unique(segment_ends.begin(), segment_ends.end()), segment_ends.end());
+
+  const moveit::core::JointModelGroup* group = trajectory.getGroup();
+  if (segment_ends.empty() || !group)
+    return computeTimeStamps(trajectory, max_velocity_scaling_factor, max_acceleration_scaling_factor);
+  segment_ends.push_back(num_points - 1);
+
+  // Validate scaling once, instead of warning for every segment
+  const double velocity_scaling_factor = verifyScalingFactor(max_velocity_scaling_factor, VELOCITY);
+  const double acceleration_scaling_factor = verifyScalingFactor(max_acceleration_scaling_factor, ACCELERATION);
+
+  // Unwind the whole path first, so the segments continue from each other. Every segment gets its own copies of the
+  // waypoints, as parameterizing a segment modifies them.
+  trajectory.unwind();
+  std::vector<robot_trajectory::RobotTrajectory> segments;
+  segments.reserve(segment_ends.size());
+  std::size_t segment_start = 0;
+  for (const std::size_t segment_end : segment_ends)
+  {
+    segments.emplace_back(trajectory.getRobotModel(), group);
+    for (std::size_t p = segment_start; p <= segment_end; ++p)
+      segments.back().addSuffixWayPoint(trajectory.getWayPoint(p), 0.0);
+    segment_start = segment_end;
+  }
+
+  std::vector<char> succeeded(segments.size(), false);
+  std::atomic<std::size_t> next_segment{ 0 };
+  const auto parameterize_segments = [&] {
+    for (std::size_t s = next_segment++; s < segments.size(); s = next_segment++)
+      succeeded[s] = computeTimeStamps(segments[s], velocity_scaling_factor, acceleration_scaling_factor);
+  };
+
+  const std::size_t thread_count =
+      std::min<std::size_t>(num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency()),
+                            segments.size());
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (std::size_t t = 1; t < thread_count; ++t)
+    threads.emplace_back(parameterize_segments);
+  parameterize_segments();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (std::size_t s = 0; s < segments.size(); ++s)
+  {
+    if (!succeeded[s])
+    {
+      RCLCPP_ERROR(LOGGER, "Unable to parameterize segment %zu of %zu.", s + 1, segments.size());
+      return false;
+    }
+  }
+
+  // Stitch the segments together. Each segment starts at rest where the previous one ended, so its first waypoint
+  // duplicates the last waypoint of the previous one.
+  trajectory.clear();
+  for (std::size_t s = 0; s < segments.size(); ++s)
+  {
+    for (std::size_t p = (s == 0) ? 0 : 1; p < segments[s].getWayPointCount(); ++p)
+      trajectory.addSuffixWayPoint(segments[s].getWayPointPtr(p), segments[s].getWayPointDurationFromPrevious(p));
+  }
+  return true;
+}
+
 bool TimeOptimalTrajectoryGeneration::hasMixedJointTypes(const moveit::core::JointModelGroup* group) const
 {
   const std::vector<const moveit::core::JointModel*>& joint_models = group->getActiveJointModels();
@@ -37,8 +37,76 @@
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/trajectory_processing/ruckig_traj_smoothing.h>
 #include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
+#include <cmath>
+#include <numeric>
+#include <rclcpp/logging.hpp>
 namespace trajectory_processing
 {
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_trajectory_processing.trajectory_tools");
+
+std::vector<int> getTrajectoryVariableIndices(const robot_trajectory::RobotTrajectory& trajectory)
+{
+  if (trajectory.getGroup())
+  {
+    return trajectory.getGroup()->getVariableIndexList();
+  }
+  std::vector<int> indices(trajectory.getRobotModel()->getVariableCount());
+  std::iota(indices.begin(), indices.end(), 0);
+  return indices;
+}
+
+/** \brief Interpolates variable \e index between \e from and \e to, which are \e duration apart, at time \e t */
+void interpolateVariable(const moveit::core::RobotState& from, const moveit::core::RobotState& to, int index,
+                         double duration, double t, double& position, double& velocity, double& acceleration)
+{
+  const double p0 = from.getVariablePosition(index);
+  const double p1 = to.getVariablePosition(index);
+  if (duration <= 0.0)
+  {
+    position = p1;
+    velocity = to.hasVelocities() ? to.getVariableVelocity(index) : 0.0;
+    acceleration = to.hasAccelerations() ? to.getVariableAcceleration(index) : 0.0;
+    return;
+  }
+
+  const double t2 = t * t;
+  if (from.hasAccelerations() && to.hasAccelerations())
+  {
+    const double v0 = from.getVariableVelocity(index);
+    const double v1 = to.getVariableVelocity(index);
+    const double a0 = from.getVariableAcceleration(index);
+    const double a1 = to.getVariableAcceleration(index);
+    const double d = duration;
+    const double c3 =
+        (20.0 * (p1 - p0) - (8.0 * v1 + 12.0 * v0) * d - (3.0 * a0 - a1) * d * d) / (2.0 * std::pow(d, 3));
+    const double c4 = (30.0 * (p0 - p1) + (14.0 * v1 + 16.0 * v0) * d + (3.0 * a0 - 2.0 * a1) * d * d) /
+                      (2.0 * std::pow(d, 4));
+    const double c5 = (12.0 * (p1 - p0) - 6.0 * (v1 + v0) * d - (a0 - a1) * d * d) / (2.0 * std::pow(d, 5));
+    position = p0 + v0 * t + 0.5 * a0 * t2 + c3 * t2 * t + c4 * t2 * t2 + c5 * t2 * t2 * t;
+    velocity = v0 + a0 * t + 3.0 * c3 * t2 + 4.0 * c4 * t2 * t + 5.0 * c5 * t2 * t2;
+    acceleration = a0 + 6.0 * c3 * t + 12.0 * c4 * t2 + 20.0 * c5 * t2 * t;
+  }
+  else if (from.hasVelocities() && to.hasVelocities())
+  {
+    const double v0 = from.getVariableVelocity(index);
+    const double v1 = to.getVariableVelocity(index);
+    const double c2 = (3.0 * (p1 - p0) - (2.0 * v0 + v1) * duration) / (duration * duration);
+    const double c3 = (2.0 * (p0 - p1) + (v0 + v1) * duration) / std::pow(duration, 3);
+    position = p0 + v0 * t + c2 * t2 + c3 * t2 * t;
+    velocity = v0 + 2.0 * c2 * t + 3.0 * c3 * t2;
+    acceleration = 2.0 * c2 + 6.0 * c3 * t;
+  }
+  else
+  {
+    velocity = (p1 - p0) / duration;
+    position = p0 + velocity * t;
+    acceleration = 0.0;
+  }
+}
+}  // namespace
+
 bool isTrajectoryEmpty(const moveit_msgs::msg::RobotTrajectory& trajectory)
 {
   return trajectory.joint_trajectory.points.empty() && trajectory.multi_dof_joint_trajectory.points.empty();
@@ -63,4 +131,136 @@ bool applyRuckigSmoothing(robot_trajectory::RobotTrajectory& trajectory, const d
   return time_param.applySmoothing(trajectory, velocity_scaling_factor, acceleration_scaling_factor, mitigate_overshoot,
                                    overshoot_threshold);
 }
+
+bool resampleTrajectory(robot_trajectory::RobotTrajectory& trajectory, const double resample_dt)
+{
+  if (resample_dt <= 0.0)
+  {
+    RCLCPP_ERROR(LOGGER, "The resampling time step must be positive");
+    return false;
+  }
+  const std::vector<int> indices = getTrajectoryVariableIndices(trajectory);
+  for (const moveit::core::JointModel* joint : trajectory.getRobotModel()->getActiveJointModels())
+  {
+    if (joint->getVariableCount() > 1 &&
+        (!trajectory.getGroup() || trajectory.getGroup()->hasJointModel(joint->getName())))
+    {
+      RCLCPP_ERROR(LOGGER, "Cannot resample joint '%s' with more than one variable", joint->getName().c_str());
+      return false;
+    }
+  }
+  if (trajectory.getWayPointCount() < 2)
+  {
+    return true;
+  }
+
+  const double duration = trajectory.getDuration();
+  robot_trajectory::RobotTrajectory resampled(trajectory.getRobotModel(), trajectory.getGroup());
+  resampled.addSuffixWayPoint(trajectory.getWayPointPtr(0), 0.0);
+
+  // the samples are taken in order, so the segment containing the next sample is found by walking forward
+  std::size_t segment = 1;
+  double segment_end = trajectory.getWayPointDurationFromPrevious(1);
+  double previous_time = 0.0;
+  double position, velocity, acceleration;
+  for (std::size_t step = 1; step * resample_dt < duration - 1e-6; ++step)
+  {
+    const double time = step * resample_dt;
+    while (segment + 1 < trajectory.getWayPointCount() && segment_end < time)
+    {
+      ++segment;
+      segment_end += trajectory.getWayPointDurationFromPrevious(segment);
+    }
+    const moveit::core::RobotState& from = trajectory.getWayPoint(segment - 1);
+    const moveit::core::RobotState& to = trajectory.getWayPoint(segment);
+    const double segment_duration = trajectory.getWayPointDurationFromPrevious(segment);
+
+    auto state = std::make_shared<moveit::core::RobotState>(from);
+    for (const int index : indices)
+    {
+      interpolateVariable(from, to, index, segment_duration, time - (segment_end - segment_duration), position,
+                          velocity, acceleration);
+      state->setVariablePosition(index, position);
+      if (from.hasVelocities() && to.hasVelocities())
+      {
+        state->setVariableVelocity(index, velocity);
+      }
+      if (from.hasAccelerations() && to.hasAccelerations())
+      {
+        state->setVariableAcceleration(index, acceleration);
+      }
+    }
+    state->update();
+    resampled.addSuffixWayPoint(state, time - previous_time);
+    previous_time = time;
+  }
+  resampled.addSuffixWayPoint(trajectory.getWayPointPtr(trajectory.getWayPointCount() - 1), duration - previous_time);
+
+  trajectory.swap(resampled);
+  return true;
+}
+
+std::size_t simplifyTrajectory(robot_trajectory::RobotTrajectory& trajectory, const double position_tolerance,
+                               const double velocity_tolerance, const double max_waypoint_duration)
+{
+  const std::size_t count = trajectory.getWayPointCount();
+  if (count < 3)
+  {
+    return 0;
+  }
+  const std::vector<int> indices = getTrajectoryVariableIndices(trajectory);
+  std::vector<double> times(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    times[i] = trajectory.getWayPointDurationFromStart(i);
+  }
+
+  // Does the interpolation between waypoints first and last reproduce all waypoints in between?
+  const auto is_reproduced = [&](std::size_t first, std::size_t last) {
+    const moveit::core::RobotState& from = trajectory.getWayPoint(first);
+    const moveit::core::RobotState& to = trajectory.getWayPoint(last);
+    double position, velocity, acceleration;
+    for (std::size_t i = first + 1; i < last; ++i)
+    {
+      const moveit::core::RobotState& state = trajectory.getWayPoint(i);
+      const bool check_velocity = state.hasVelocities() && from.hasVelocities() && to.hasVelocities();
+      for (const int index : indices)
+      {
+        interpolateVariable(from, to, index, times[last] - times[first], times[i] - times[first], position, velocity,
+                            acceleration);
+        if (std::fabs(position - state.getVariablePosition(index)) > position_tolerance ||
+            (check_velocity && std::fabs(velocity - state.getVariableVelocity(index)) > velocity_tolerance))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  // Greedily extend each segment from the last kept waypoint as long as the waypoints in between are reproduced
+  std::vector<std::size_t> kept{ 0 };
+  for (std::size_t last = 2; last < count; ++last)
+  {
+    if ((max_waypoint_duration > 0.0 && times[last] - times[kept.back()] > max_waypoint_duration) ||
+        !is_reproduced(kept.back(), last))
+    {
+      kept.push_back(last - 1);
+    }
+  }
+  kept.push_back(count - 1);
+  if (kept.size() == count)
+  {
+    return 0;
+  }
+
+  robot_trajectory::RobotTrajectory simplified(trajectory.getRobotModel(), trajectory.getGroup());
+  simplified.addSuffixWayPoint(trajectory.getWayPointPtr(0), trajectory.getWayPointDurationFromPrevious(0));
+  for (std::size_t i = 1; i < kept.size(); ++i)
+  {
+    simplified.addSuffixWayPoint(trajectory.getWayPointPtr(kept[i]), times[kept[i]] - times[kept[i - 1]]);
+  }
+  trajectory.swap(simplified);
+  return count - kept.size();
+}
 }  // namespace trajectory_processing
@@ -167,6 +167,64 @@ TEST_F(RuckigTests, single_waypoint)
   }
 }
 
+TEST_F(RuckigTests, compact_trajectory)
+{
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.zeroVelocities();
+  robot_state.zeroAccelerations();
+  trajectory_->addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+  std::vector<double> joint_positions;
+  robot_state.copyJointGroupPositions(JOINT_GROUP, joint_positions);
+  joint_positions.at(0) += 1.0;
+  robot_state.setJointGroupPositions(JOINT_GROUP, joint_positions);
+  trajectory_->addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+  robot_trajectory::CompactRobotTrajectory compact(*trajectory_);
+
+  // Smoothing the compact representation yields the same durations
+  EXPECT_TRUE(smoother_.applySmoothing(*trajectory_, 1.0, 1.0, true /* mitigate overshoot */));
+  EXPECT_TRUE(smoother_.applySmoothing(compact, 1.0, 1.0, true /* mitigate overshoot */));
+  ASSERT_EQ(compact.getWayPointCount(), trajectory_->getWayPointCount());
+  for (std::size_t i = 0; i < compact.getWayPointCount(); ++i)
+  {
+    EXPECT_DOUBLE_EQ(compact.getWayPointDurationFromPrevious(i), trajectory_->getWayPointDurationFromPrevious(i));
+  }
+}
+
+TEST_F(RuckigTests, repeated_smoothing)
+{
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.zeroVelocities();
+  robot_state.zeroAccelerations();
+  trajectory_->addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+  std::vector<double> joint_positions;
+  robot_state.copyJointGroupPositions(JOINT_GROUP, joint_positions);
+  for (std::size_t i = 0; i < 10; ++i)
+  {
+    joint_positions.at(i % joint_positions.size()) += 0.3;
+    robot_state.setJointGroupPositions(JOINT_GROUP, joint_positions);
+    trajectory_->addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+  }
+  robot_trajectory::RobotTrajectory copy(*trajectory_, true /* deep copy */);
+
+  // The workspace reused by the second call does not carry state over from the first
+  EXPECT_TRUE(smoother_.applySmoothing(*trajectory_, 1.0, 1.0, true /* mitigate overshoot */));
+  EXPECT_TRUE(smoother_.applySmoothing(copy, 1.0, 1.0, true /* mitigate overshoot */));
+  ASSERT_EQ(copy.getWayPointCount(), trajectory_->getWayPointCount());
+  for (std::size_t i = 0; i < copy.getWayPointCount(); ++i)
+  {
+    EXPECT_DOUBLE_EQ(copy.getWayPointDurationFromPrevious(i), trajectory_->getWayPointDurationFromPrevious(i));
+  }
+
+  // A group with a different number of variables gets its own workspace
+  robot_trajectory::RobotTrajectory hand_trajectory(robot_model_, "hand");
+  robot_state.setToDefaultValues();
+  hand_trajectory.addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+  hand_trajectory.addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+  EXPECT_TRUE(smoother_.applySmoothing(hand_trajectory));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
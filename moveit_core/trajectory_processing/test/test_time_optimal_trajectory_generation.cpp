@@ -38,6 +38,7 @@
 
 #include <gtest/gtest.h>
 #include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
+#include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/utils/robot_model_test_utils.h>
 
 using trajectory_processing::Path;
@@ -568,6 +569,269 @@ TEST(time_optimal_trajectory_generation, testTimeStepZeroMakesTrajectoryInvalid)
                    .isValid());
 }
 
+TEST(time_optimal_trajectory_generation, testSegmentedTrajectory)
+{
+  constexpr auto robot_name{ "panda" };
+  constexpr auto group_name{ "panda_arm" };
+
+  auto robot_model = moveit::core::loadTestingRobotModel(robot_name);
+  ASSERT_TRUE(robot_model) << "Failed to load robot model" << robot_name;
+  set_acceleration_limits(robot_model);
+  auto group = robot_model->getJointModelGroup(group_name);
+  ASSERT_TRUE(group) << "Failed to load joint model group " << group_name;
+  moveit::core::RobotState waypoint_state(robot_model);
+  waypoint_state.setToDefaultValues();
+
+  // Three motions, each stopping at its last waypoint
+  const std::vector<std::vector<double>> segment_waypoints[] = {
+    { { -0.5, -3.52, 1.35, -2.51, -0.88, 0.63, 0.0 },
+      { -0.3, -3.51, 1.37, -2.0, -0.9, 0.3, 0.0 },
+      { 0.0, -3.5, 1.4, -1.2, -1.0, -0.2, 0.0 } },
+    { { 0.0, -3.5, 1.4, -1.2, -1.0, -0.2, 0.0 },
+      { -0.2, -3.4, 1.3, -1.8, -0.9, 0.2, 0.1 },
+      { -0.5, -3.52, 1.35, -2.51, -0.88, 0.63, 0.0 } },
+    { { -0.5, -3.52, 1.35, -2.51, -0.88, 0.63, 0.0 }, { 0.0, -3.5, 1.4, -1.2, -1.0, -0.2, 0.0 } }
+  };
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model, group);
+  double expected_duration = 0.0;
+  TimeOptimalTrajectoryGeneration totg;
+  for (const std::vector<std::vector<double>>& segment : segment_waypoints)
+  {
+    robot_trajectory::RobotTrajectory segment_trajectory(robot_model, group);
+    for (const std::vector<double>& waypoint : segment)
+    {
+      waypoint_state.setJointGroupPositions(group, waypoint);
+      segment_trajectory.addSuffixWayPoint(waypoint_state, 0.1);
+    }
+    // the trajectory comes to a stop between the segments, so the first waypoint of a segment is shared
+    trajectory.append(robot_trajectory::RobotTrajectory(segment_trajectory, true /* deep copy */), 0.1,
+                      trajectory.empty() ? 0 : 1);
+    ASSERT_TRUE(totg.computeTimeStamps(segment_trajectory));
+    expected_duration += segment_trajectory.getDuration();
+  }
+  ASSERT_EQ(trajectory.getWayPointCount(), 6u);
+
+  // Explicit split points
+  robot_trajectory::RobotTrajectory split_trajectory(trajectory, true /* deep copy */);
+  ASSERT_TRUE(totg.computeTimeStampsSegmented(split_trajectory, std::vector<std::size_t>{ 4, 2, 0, 17 }, 1.0, 1.0, 2));
+  EXPECT_NEAR(split_trajectory.getDuration(), expected_duration, 1e-9);
+
+  // Split points found at the waypoints at rest
+  robot_trajectory::RobotTrajectory detected_trajectory(trajectory, true /* deep copy */);
+  for (std::size_t p = 0; p < detected_trajectory.getWayPointCount(); ++p)
+  {
+    moveit::core::RobotState& waypoint = detected_trajectory.getWayPoint(p);
+    const double velocity = (p == 2 || p == 4) ? 0.0 : 0.1;
+    for (const int index : group->getVariableIndexList())
+      waypoint.setVariableVelocity(index, velocity);
+  }
+  ASSERT_TRUE(totg.computeTimeStampsSegmented(detected_trajectory));
+  EXPECT_NEAR(detected_trajectory.getDuration(), split_trajectory.getDuration(), 1e-9);
+  ASSERT_EQ(detected_trajectory.getWayPointCount(), split_trajectory.getWayPointCount());
+
+  // The robot is at rest at the split points of the stitched trajectory
+  for (const std::vector<std::vector<double>>& segment : segment_waypoints)
+  {
+    waypoint_state.setJointGroupPositions(group, segment.back());
+    bool reached = false;
+    for (std::size_t p = 0; p < split_trajectory.getWayPointCount() && !reached; ++p)
+    {
+      const moveit::core::RobotState& waypoint = split_trajectory.getWayPoint(p);
+      reached = waypoint.distance(waypoint_state, group) < 1e-9 &&
+                std::all_of(group->getVariableIndexList().begin(), group->getVariableIndexList().end(),
+                            [&](int index) { return std::abs(waypoint.getVariableVelocity(index)) < 1e-6; });
+    }
+    EXPECT_TRUE(reached);
+  }
+}
+
+TEST(time_optimal_trajectory_generation, testLongPath)
+{
+  // A long path with blends everywhere, built from both supported waypoint containers
+  std::vector<Eigen::VectorXd> waypoints;
+  Eigen::VectorXd waypoint = Eigen::VectorXd::Zero(3);
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    waypoint[0] = 0.01 * i;
+    waypoint[1] = 0.2 * std::sin(0.005 * i);
+    waypoint[2] = 0.2 * std::cos(0.003 * i);
+    waypoints.push_back(waypoint);
+  }
+  const std::list<Eigen::VectorXd> waypoint_list(waypoints.begin(), waypoints.end());
+
+  const Eigen::Vector3d max_velocities(1.0, 1.0, 1.0);
+  const Eigen::Vector3d max_accelerations(2.0, 2.0, 2.0);
+  const Trajectory trajectory(Path(waypoints, 0.01), max_velocities, max_accelerations);
+  const Trajectory list_trajectory(Path(waypoint_list, 0.01), max_velocities, max_accelerations);
+  ASSERT_TRUE(trajectory.isValid());
+  ASSERT_TRUE(list_trajectory.isValid());
+  EXPECT_DOUBLE_EQ(trajectory.getDuration(), list_trajectory.getDuration());
+
+  // Sample backwards first, then forwards, to exercise both segment lookups
+  for (double time = trajectory.getDuration(); time > 0.0; time -= 0.37)
+    EXPECT_TRUE(trajectory.getPosition(time).isApprox(list_trajectory.getPosition(time)));
+  double previous_position = -1.0;
+  for (double time = 0.0; time < trajectory.getDuration(); time += 0.01)
+  {
+    const double position = trajectory.getPosition(time)[0];
+    EXPECT_GE(position, previous_position - 1e-9) << "Time: " << time;
+    previous_position = position;
+    EXPECT_LE(trajectory.getVelocity(time).cwiseAbs().maxCoeff(), 1.0 + 1e-3) << "Time: " << time;
+  }
+  EXPECT_NEAR(trajectory.getPosition(trajectory.getDuration())[0], waypoints.back()[0], 1e-6);
+}
+
+namespace
+{
+// Inverse dynamics of a planar two link arm moving in a vertical plane, with point masses at the link ends
+Eigen::Vector2d twoLinkArmTorques(const Eigen::Vector2d& position, const Eigen::Vector2d& velocity,
+                                  const Eigen::Vector2d& acceleration)
+{
+  const double length = 0.5, mass = 2.0, gravity = 9.81;
+  const double cos2 = std::cos(position[1]);
+  const double coupling = mass * length * length * std::sin(position[1]);
+  Eigen::Matrix2d inertia;
+  inertia << 3.0 * mass * length * length + 2.0 * mass * length * length * cos2,
+      mass * length * length * (1.0 + cos2), mass * length * length * (1.0 + cos2), mass * length * length;
+
+  Eigen::Vector2d torques = inertia * acceleration;
+  torques[0] += -coupling * (2.0 * velocity[0] * velocity[1] + velocity[1] * velocity[1]) +
+                2.0 * mass * gravity * length * std::cos(position[0]) +
+                mass * gravity * length * std::cos(position[0] + position[1]);
+  torques[1] += coupling * velocity[0] * velocity[0] + mass * gravity * length * std::cos(position[0] + position[1]);
+  return torques;
+}
+}  // namespace
+
+TEST(time_optimal_trajectory_generation, testTorqueLimits)
+{
+  const trajectory_processing::InverseDynamicsFn inverse_dynamics =
+      [](const Eigen::MatrixXd& positions, const Eigen::MatrixXd& velocities, const Eigen::MatrixXd& accelerations,
+         Eigen::MatrixXd& torques) {
+        torques.resize(2, positions.cols());
+        for (Eigen::Index i = 0; i < positions.cols(); ++i)
+          torques.col(i) = twoLinkArmTorques(positions.col(i), velocities.col(i), accelerations.col(i));
+        return true;
+      };
+
+  std::vector<Eigen::VectorXd> waypoints;
+  for (const Eigen::Vector2d& waypoint : { Eigen::Vector2d(1.4, 0.2), Eigen::Vector2d(-0.5, 1.0),
+                                           Eigen::Vector2d(0.5, 2.0), Eigen::Vector2d(1.3, -1.0) })
+    waypoints.push_back(waypoint);
+  const Path path(waypoints, 0.1);
+  const Eigen::Vector2d max_velocities(3.0, 3.0);
+  const Eigen::Vector2d max_accelerations(30.0, 30.0);
+  const Eigen::Vector2d max_torques(30.0, 12.0);
+
+  const Trajectory unlimited(path, max_velocities, max_accelerations);
+  const Trajectory limited(path, max_velocities, max_accelerations, inverse_dynamics, max_torques);
+  ASSERT_TRUE(unlimited.isValid());
+  ASSERT_TRUE(limited.isValid());
+  EXPECT_GT(limited.getDuration(), unlimited.getDuration());
+
+  // the limits hold up to the discretization of the integration
+  double max_torque_ratio = 0.0;
+  for (double time = 0.0; time < limited.getDuration(); time += 0.001)
+  {
+    const Eigen::Vector2d torques =
+        twoLinkArmTorques(limited.getPosition(time), limited.getVelocity(time), limited.getAcceleration(time));
+    max_torque_ratio = std::max(max_torque_ratio, torques.cwiseAbs().cwiseQuotient(max_torques).maxCoeff());
+  }
+  EXPECT_LE(max_torque_ratio, 1.05);
+  EXPECT_GT(max_torque_ratio, 0.95);  // and they are used
+  EXPECT_TRUE(limited.getPosition(limited.getDuration()).isApprox(waypoints.back(), 1e-6));
+
+  // the arm cannot hold itself horizontally with less shoulder torque
+  waypoints.back() = Eigen::Vector2d(0.0, 0.0);
+  EXPECT_FALSE(Trajectory(Path(waypoints, 0.1), max_velocities, max_accelerations, inverse_dynamics,
+                          Eigen::Vector2d(25.0, 12.0))
+                   .isValid());
+}
+
+TEST(time_optimal_trajectory_generation, testCompactTrajectory)
+{
+  constexpr auto robot_name{ "panda" };
+  constexpr auto group_name{ "panda_arm" };
+
+  auto robot_model = moveit::core::loadTestingRobotModel(robot_name);
+  ASSERT_TRUE(robot_model) << "Failed to load robot model" << robot_name;
+  set_acceleration_limits(robot_model);
+  auto group = robot_model->getJointModelGroup(group_name);
+  ASSERT_TRUE(group) << "Failed to load joint model group " << group_name;
+  moveit::core::RobotState waypoint_state(robot_model);
+  waypoint_state.setToDefaultValues();
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model, group);
+  for (const std::vector<double>& waypoint : { std::vector<double>{ -0.5, -3.52, 1.35, -2.51, -0.88, 0.63, 0.0 },
+                                               std::vector<double>{ -0.3, -3.51, 1.37, -2.0, -0.9, 0.3, 0.0 },
+                                               std::vector<double>{ -0.3, -3.51, 1.37, -2.0, -0.9, 0.3, 0.0 },
+                                               std::vector<double>{ 0.0, -3.5, 1.4, -1.2, -1.0, -0.2, 0.0 } })
+  {
+    waypoint_state.setJointGroupPositions(group, waypoint);
+    trajectory.addSuffixWayPoint(waypoint_state, 0.1);
+  }
+  robot_trajectory::CompactRobotTrajectory compact(trajectory);
+
+  // Both representations are parameterized identically
+  TimeOptimalTrajectoryGeneration totg;
+  ASSERT_TRUE(totg.computeTimeStamps(trajectory, 0.5, 0.5));
+  ASSERT_TRUE(totg.computeTimeStamps(compact, 0.5, 0.5));
+  ASSERT_EQ(compact.getWayPointCount(), trajectory.getWayPointCount());
+  EXPECT_DOUBLE_EQ(compact.getDuration(), trajectory.getDuration());
+  Eigen::VectorXd expected;
+  for (std::size_t p = 0; p < trajectory.getWayPointCount(); ++p)
+  {
+    trajectory.getWayPoint(p).copyJointGroupPositions(group, expected);
+    EXPECT_TRUE(compact.getWayPointPositions(p).isApprox(expected)) << "Waypoint " << p;
+    trajectory.getWayPoint(p).copyJointGroupVelocities(group, expected);
+    EXPECT_TRUE(compact.getWayPointVelocities(p).isApprox(expected, 1e-9)) << "Waypoint " << p;
+  }
+}
+
+TEST(time_optimal_trajectory_generation, testSimplifyAndResample)
+{
+  const auto robot_model = moveit::core::loadTestingRobotModel("panda");
+  ASSERT_TRUE(robot_model);
+  set_acceleration_limits(robot_model);
+  const auto group = robot_model->getJointModelGroup("panda_arm");
+  ASSERT_TRUE(group);
+
+  moveit::core::RobotState waypoint_state(robot_model);
+  waypoint_state.setToDefaultValues();
+  robot_trajectory::RobotTrajectory trajectory(robot_model, group);
+  waypoint_state.setJointGroupPositions(group, std::vector<double>{ -0.5, -1.5, 1.35, -2.51, -0.88, 0.63, 0.0 });
+  trajectory.addSuffixWayPoint(waypoint_state, 0.0);
+  waypoint_state.setJointGroupPositions(group, std::vector<double>{ 0.0, -1.2, 1.4, -1.2, -1.0, -0.2, 0.0 });
+  trajectory.addSuffixWayPoint(waypoint_state, 0.0);
+  ASSERT_TRUE(trajectory_processing::applyTOTGTimeParameterization(trajectory, 1.0, 1.0, 0.1, 0.001));
+  const double duration = trajectory.getDuration();
+
+  // The densely resampled straight path is reproduced by few waypoints
+  robot_trajectory::RobotTrajectory simplified(trajectory, true /* deep copy */);
+  const std::size_t removed = trajectory_processing::simplifyTrajectory(simplified, 1e-4, 1e-3);
+  EXPECT_EQ(removed, trajectory.getWayPointCount() - simplified.getWayPointCount());
+  EXPECT_LT(simplified.getWayPointCount(), trajectory.getWayPointCount() / 10);
+  EXPECT_NEAR(simplified.getDuration(), duration, 1e-9);
+  EXPECT_EQ(simplified.getLastWayPoint().distance(trajectory.getLastWayPoint()), 0.0);
+
+  // Resampling the simplified trajectory reproduces the original one
+  constexpr double resample_dt = 0.01;
+  ASSERT_TRUE(trajectory_processing::resampleTrajectory(simplified, resample_dt));
+  EXPECT_NEAR(simplified.getDuration(), duration, 1e-9);
+  EXPECT_EQ(simplified.getWayPointCount(), static_cast<std::size_t>(std::ceil(duration / resample_dt - 1e-6)) + 1);
+  for (std::size_t i = 0; i < trajectory.getWayPointCount(); i += 10)
+  {
+    const double time = trajectory.getWayPointDurationFromStart(i);
+    const std::size_t sample = static_cast<std::size_t>(std::round(time / resample_dt));
+    if (std::fabs(sample * resample_dt - time) < 1e-9)
+    {
+      EXPECT_NEAR(simplified.getWayPoint(sample).distance(trajectory.getWayPoint(i)), 0.0, 1e-3) << "Waypoint " << i;
+    }
+  }
+  EXPECT_FALSE(trajectory_processing::resampleTrajectory(simplified, 0.0));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,102 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+// To run this benchmark, 'cd' to the build/moveit_core/trajectory_processing directory and directly run the binary.
+
+#include <benchmark/benchmark.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/trajectory_processing/ruckig_traj_smoothing.h>
+#include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <random_numbers/random_numbers.h>
+
+namespace
+{
+constexpr char JOINT_GROUP[] = "panda_arm";
+
+// A path through random configurations of the panda arm, with waypoints_per_segment interpolated waypoints between
+// each pair of them, like the dense output of a sampling-based planner
+robot_trajectory::RobotTrajectory makePath(std::size_t segments, std::size_t waypoints_per_segment)
+{
+  const moveit::core::RobotModelPtr& robot_model = moveit::core::loadTestingRobotModel("panda");
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup(JOINT_GROUP);
+  robot_trajectory::RobotTrajectory trajectory(robot_model, JOINT_GROUP);
+
+  random_numbers::RandomNumberGenerator rng(0);
+  moveit::core::RobotState from(robot_model), to(robot_model), waypoint(robot_model);
+  from.setToDefaultValues();
+  for (std::size_t segment = 0; segment < segments; ++segment)
+  {
+    to.setToRandomPositionsNearBy(jmg, from, 0.5, rng);
+    for (std::size_t i = 0; i < waypoints_per_segment; ++i)
+    {
+      from.interpolate(to, static_cast<double>(i) / waypoints_per_segment, waypoint, jmg);
+      trajectory.addSuffixWayPoint(waypoint, 0.0);
+    }
+    from = to;
+  }
+  trajectory.addSuffixWayPoint(from, 0.0);
+  return trajectory;
+}
+}  // namespace
+
+static void BM_TOTG(benchmark::State& st)
+{
+  const robot_trajectory::RobotTrajectory path = makePath(st.range(0), 10);
+  trajectory_processing::TimeOptimalTrajectoryGeneration totg;
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    robot_trajectory::RobotTrajectory trajectory(path, true /* deepcopy */);
+    st.ResumeTiming();
+    benchmark::DoNotOptimize(totg.computeTimeStamps(trajectory));
+  }
+}
+
+static void BM_RuckigSmoothing(benchmark::State& st)
+{
+  robot_trajectory::RobotTrajectory timed_path = makePath(st.range(0), 10);
+  trajectory_processing::TimeOptimalTrajectoryGeneration().computeTimeStamps(timed_path);
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    robot_trajectory::RobotTrajectory trajectory(timed_path, true /* deepcopy */);
+    st.ResumeTiming();
+    benchmark::DoNotOptimize(trajectory_processing::RuckigSmoothing::applySmoothing(trajectory));
+  }
+}
+
+BENCHMARK(BM_TOTG)->Arg(2)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RuckigSmoothing)->Arg(2)->Arg(10)->Unit(benchmark::kMillisecond);
@@ -39,7 +39,9 @@
 #include <geometry_msgs/msg/transform_stamped.hpp>
 #include <Eigen/Geometry>
 #include <moveit/macros/class_forward.h>
+#include <moveit/utils/interned_name.h>
 #include <map>
+#include <unordered_map>
 
 namespace moveit
 {
@@ -206,9 +208,23 @@ public:
    */
   virtual const Eigen::Isometry3d& getTransform(const std::string& from_frame) const;
 
+  /**
+   * @brief Get transform for from_frame (w.r.t target frame), looking the frame up by its interned name instead of
+   * by string
+   * @param from_frame The interned id of the frame for which the transform is being computed
+   * @return The required transform. It is guaranteed to be a valid isometry.
+   */
+  virtual const Eigen::Isometry3d& getTransform(const InternedName& from_frame) const;
+
 protected:
   std::string target_frame_;
   FixedTransformsMap transforms_map_;
+
+  /** @brief The entries of transforms_map_ indexed by the ids of the interned frame names */
+  InternedNameMap<const Eigen::Isometry3d*> transforms_by_interned_name_{ nullptr };
+
+  /** @brief The entries of transforms_map_ hashed by frame name, for the string lookups */
+  std::unordered_map<std::string, const Eigen::Isometry3d*> transforms_by_name_;
 };
 }  // namespace core
 }  // namespace moveit
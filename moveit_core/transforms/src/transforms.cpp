@@ -57,7 +57,10 @@ Transforms::Transforms(const std::string& target_frame) : target_frame_(target_f
   }
   else
   {
-    transforms_map_[target_frame_] = Eigen::Isometry3d::Identity();
+    Eigen::Isometry3d& t = transforms_map_[target_frame_];
+    t = Eigen::Isometry3d::Identity();
+    transforms_by_interned_name_.set(InternedName(target_frame_), &t);
+    transforms_by_name_[target_frame_] = &t;
   }
 }
 
@@ -87,6 +90,13 @@ void Transforms::setAllTransforms(const FixedTransformsMap& transforms)
     ASSERT_ISOMETRY(t.second)  // unsanitized input, could contain a non-isometry
   }
   transforms_map_ = transforms;
+  transforms_by_interned_name_.clear();
+  transforms_by_name_.clear();
+  for (const auto& t : transforms_map_)
+  {
+    transforms_by_interned_name_.set(InternedName(t.first), &t.second);
+    transforms_by_name_[t.first] = &t.second;
+  }
 }
 
 bool Transforms::isFixedFrame(const std::string& frame) const
@@ -97,7 +107,7 @@ bool Transforms::isFixedFrame(const std::string& frame) const
   }
   else
   {
-    return transforms_map_.find(frame) != transforms_map_.end();
+    return transforms_by_name_.find(frame) != transforms_by_name_.end();
   }
 }
 
@@ -105,9 +115,9 @@ const Eigen::Isometry3d& Transforms::getTransform(const std::string& from_frame)
 {
   if (!from_frame.empty())
   {
-    FixedTransformsMap::const_iterator it = transforms_map_.find(from_frame);
-    if (it != transforms_map_.end())
-      return it->second;
+    const auto it = transforms_by_name_.find(from_frame);
+    if (it != transforms_by_name_.end())
+      return *it->second;
     // If no transform found in map, return identity
   }
 
@@ -119,6 +129,14 @@ const Eigen::Isometry3d& Transforms::getTransform(const std::string& from_frame)
   return IDENTITY;
 }
 
+const Eigen::Isometry3d& Transforms::getTransform(const InternedName& from_frame) const
+{
+  if (const Eigen::Isometry3d* t = transforms_by_interned_name_.get(from_frame))
+    return *t;
+  // the string lookup reports the error and returns identity
+  return getTransform(from_frame.str());
+}
+
 bool Transforms::canTransform(const std::string& from_frame) const
 {
   if (from_frame.empty())
@@ -127,7 +145,7 @@ bool Transforms::canTransform(const std::string& from_frame) const
   }
   else
   {
-    return transforms_map_.find(from_frame) != transforms_map_.end();
+    return transforms_by_name_.find(from_frame) != transforms_by_name_.end();
   }
 }
 
@@ -139,7 +157,16 @@ void Transforms::setTransform(const Eigen::Isometry3d& t, const std::string& fro
     RCLCPP_ERROR(LOGGER, "Cannot record transform with empty name");
   }
   else
-    transforms_map_[from_frame] = t;
+  {
+    const auto inserted = transforms_map_.insert(std::make_pair(from_frame, t));
+    if (inserted.second)
+    {
+      transforms_by_interned_name_.set(InternedName(from_frame), &inserted.first->second);
+      transforms_by_name_[from_frame] = &inserted.first->second;
+    }
+    else
+      inserted.first->second = t;
+  }
 }
 
 void Transforms::setTransform(const geometry_msgs::msg::TransformStamped& transform)
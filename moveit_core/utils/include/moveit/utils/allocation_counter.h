@@ -0,0 +1,209 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+/** \file allocation_counter.h
+ *  \brief counting the heap allocations of a thread, for tests and benchmarks that enforce allocation budgets
+ *
+ *  Counting requires the allocation functions of the C library to be interposed. Exactly one source file of a test or
+ *  benchmark executable defines the interposer by including this header after defining
+ *  MOVEIT_DEFINE_ALLOCATION_INTERPOSER:
+ *
+ *  \code
+ *  #define MOVEIT_DEFINE_ALLOCATION_INTERPOSER
+ *  #include <moveit/utils/allocation_counter.h>
+ *
+ *  TEST(Foo, barDoesNotAllocate)
+ *  {
+ *    if (!moveit::allocation_counter::isSupported())
+ *      GTEST_SKIP() << "Allocations can not be counted on this platform";
+ *    bar();  // warm up caches and buffers
+ *    EXPECT_EQ(moveit::allocation_counter::countAllocations([] { bar(); }), 0u);
+ *  }
+ *  \endcode
+ *
+ *  In Google Benchmark targets, report ScopedAllocationCounter::allocations() divided by the number of iterations as
+ *  a counter of the benchmark state. Never define the interposer in a library.
+ *
+ *  The interposer replaces malloc, calloc, realloc and the aligned allocation functions, so it catches operator new,
+ *  Eigen and C code alike. It is only available with glibc, which provides the functions it forwards to.
+ */
+
+#include <cstddef>
+
+namespace moveit
+{
+namespace allocation_counter
+{
+namespace detail
+{
+inline thread_local bool counting = false;
+inline thread_local std::size_t allocations = 0;
+inline thread_local std::size_t bytes = 0;
+
+inline void record(std::size_t size)
+{
+  if (counting)
+  {
+    ++allocations;
+    bytes += size;
+  }
+}
+}  // namespace detail
+
+/** \brief Counts the heap allocations the calling thread makes during the lifetime of the counter.
+
+    Allocations of other threads, e.g. executors or worker pools, are not counted. Counters may be nested, an outer
+    counter includes the allocations counted by inner ones. */
+class ScopedAllocationCounter
+{
+public:
+  ScopedAllocationCounter()
+    : was_counting_(detail::counting), start_allocations_(detail::allocations), start_bytes_(detail::bytes)
+  {
+    detail::counting = true;
+  }
+
+  ~ScopedAllocationCounter()
+  {
+    detail::counting = was_counting_;
+  }
+
+  ScopedAllocationCounter(const ScopedAllocationCounter&) = delete;
+  ScopedAllocationCounter& operator=(const ScopedAllocationCounter&) = delete;
+
+  /** \brief The number of allocations since construction, reallocations included */
+  std::size_t allocations() const
+  {
+    return detail::allocations - start_allocations_;
+  }
+
+  /** \brief The number of bytes requested by the counted allocations */
+  std::size_t bytes() const
+  {
+    return detail::bytes - start_bytes_;
+  }
+
+private:
+  bool was_counting_;
+  std::size_t start_allocations_;
+  std::size_t start_bytes_;
+};
+
+/** \brief Count the heap allocations the calling thread makes in \e f */
+template <typename F>
+std::size_t countAllocations(F&& f)
+{
+  ScopedAllocationCounter counter;
+  f();
+  return counter.allocations();
+}
+
+/** \brief True if the executable defines the interposer, so that allocations are counted */
+bool isSupported();
+}  // namespace allocation_counter
+}  // namespace moveit
+
+#ifdef MOVEIT_DEFINE_ALLOCATION_INTERPOSER
+#include <cerrno>
+#include <cstdlib>
+
+#ifdef __GLIBC__
+extern "C"
+{
+  void* __libc_malloc(std::size_t size);
+  void* __libc_calloc(std::size_t count, std::size_t size);
+  void* __libc_realloc(void* ptr, std::size_t size);
+  void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+  void* malloc(std::size_t size)
+  {
+    moveit::allocation_counter::detail::record(size);
+    return __libc_malloc(size);
+  }
+
+  void* calloc(std::size_t count, std::size_t size)
+  {
+    moveit::allocation_counter::detail::record(count * size);
+    return __libc_calloc(count, size);
+  }
+
+  void* realloc(void* ptr, std::size_t size)
+  {
+    moveit::allocation_counter::detail::record(size);
+    return __libc_realloc(ptr, size);
+  }
+
+  void* memalign(std::size_t alignment, std::size_t size)
+  {
+    moveit::allocation_counter::detail::record(size);
+    return __libc_memalign(alignment, size);
+  }
+
+  void* aligned_alloc(std::size_t alignment, std::size_t size)
+  {
+    moveit::allocation_counter::detail::record(size);
+    return __libc_memalign(alignment, size);
+  }
+
+  int posix_memalign(void** ptr, std::size_t alignment, std::size_t size)
+  {
+    if (alignment == 0 || alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+      return EINVAL;
+    moveit::allocation_counter::detail::record(size);
+    void* result = __libc_memalign(alignment, size);
+    if (!result)
+      return ENOMEM;
+    *ptr = result;
+    return 0;
+  }
+}
+
+bool moveit::allocation_counter::isSupported()
+{
+  ScopedAllocationCounter counter;
+  // volatile, so that the compiler can not elide the allocation
+  void* volatile ptr = std::malloc(1);
+  std::free(ptr);
+  return counter.allocations() > 0;
+}
+#else
+bool moveit::allocation_counter::isSupported()
+{
+  return false;
+}
+#endif
+#endif
@@ -0,0 +1,162 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+/** \file interned_name.h
+ *  \brief names stored once per process, for lookups by index instead of by string
+ */
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+/** \brief A name that is stored once per process and identified by a dense integer id.
+
+    Interning hashes the name once. Afterwards, interned names compare by id, and containers that accept them
+    (RobotModel, World, Transforms, AllowedCollisionMatrix, PlanningScene) find the named element by indexing a vector
+    with the id instead of hashing or comparing strings. Interned names are never released, so intern names that are
+    looked up repeatedly, like link and object names, rather than names made up per request. Interning is
+    thread-safe. */
+class InternedName
+{
+public:
+  /** \brief The empty name */
+  InternedName();
+
+  /** \brief Intern \e name */
+  explicit InternedName(const std::string& name);
+
+  /** \brief The id of the name. Ids are assigned in the order names are first interned, starting at 0. */
+  std::size_t id() const
+  {
+    return entry_->id;
+  }
+
+  const std::string& str() const
+  {
+    return entry_->name;
+  }
+
+  bool empty() const
+  {
+    return entry_->name.empty();
+  }
+
+  bool operator==(const InternedName& other) const
+  {
+    return entry_ == other.entry_;
+  }
+
+  bool operator!=(const InternedName& other) const
+  {
+    return entry_ != other.entry_;
+  }
+
+  /** \brief Order by id, not alphabetically */
+  bool operator<(const InternedName& other) const
+  {
+    return entry_->id < other.entry_->id;
+  }
+
+  struct Entry
+  {
+    std::string name;
+    std::size_t id;
+  };
+
+private:
+  const Entry* entry_;
+};
+
+/** \brief A map from interned names to values, stored as a vector indexed by the name ids.
+
+    Lookups are a bounds check and an index. The vector grows up to the largest id set, so this suits sets of names
+    that are interned together, e.g. all links of a robot model. Names without a value map to the \e missing value
+    given on construction. */
+template <typename T>
+class InternedNameMap
+{
+public:
+  explicit InternedNameMap(const T& missing = T()) : missing_(missing)
+  {
+  }
+
+  const T& get(const InternedName& name) const
+  {
+    return name.id() < values_.size() ? values_[name.id()] : missing_;
+  }
+
+  void set(const InternedName& name, const T& value)
+  {
+    if (name.id() >= values_.size())
+      values_.resize(name.id() + 1, missing_);
+    values_[name.id()] = value;
+  }
+
+  void erase(const InternedName& name)
+  {
+    if (name.id() < values_.size())
+      values_[name.id()] = missing_;
+  }
+
+  void clear()
+  {
+    values_.clear();
+  }
+
+private:
+  std::vector<T> values_;
+  T missing_;
+};
+}  // namespace core
+}  // namespace moveit
+
+namespace std
+{
+template <>
+struct hash<moveit::core::InternedName>
+{
+  std::size_t operator()(const moveit::core::InternedName& name) const
+  {
+    return name.id();
+  }
+};
+}  // namespace std
@@ -0,0 +1,90 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+/** \file memory_usage.h
+ *  \brief accumulate the memory held by planning scenes, collision environments, states and trajectories
+ */
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_set>
+
+namespace moveit
+{
+namespace core
+{
+/** \brief The approximate number of bytes held by a set of objects, split by category.
+
+    Objects add their own storage with add(). Data that may be shared between several objects (meshes, octrees,
+    collision geometry, the states of a trajectory, the parent of a diff scene) is counted only by the first object
+    that claims its address with visit(), so the total of e.g. a planning scene and its diffs counts every shared
+    geometry once. The numbers are estimates of the heap payload, not exact allocator statistics. */
+class MemoryUsage
+{
+public:
+  /** \brief Add \e bytes to \e category */
+  void add(const std::string& category, std::size_t bytes);
+
+  /** \brief Claim the data at \e address. Returns true the first time an address is seen, in which case the caller
+      should add the size of the data. A null address is never counted. */
+  bool visit(const void* address);
+
+  /** \brief The bytes of all categories */
+  std::size_t getTotal() const
+  {
+    return total_;
+  }
+
+  /** \brief The bytes of one category, 0 if nothing was added to it */
+  std::size_t getBytes(const std::string& category) const;
+
+  const std::map<std::string, std::size_t>& getCategories() const
+  {
+    return categories_;
+  }
+
+  /** \brief Forget all categories and visited addresses */
+  void clear();
+
+private:
+  std::map<std::string, std::size_t> categories_;
+  std::unordered_set<const void*> visited_;
+  std::size_t total_ = 0;
+};
+}  // namespace core
+}  // namespace moveit
@@ -0,0 +1,106 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+/** \file metrics.h
+ *  \brief lock-free counters and latency histograms that modules update and monitoring code reads
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace moveit
+{
+namespace metrics
+{
+/** \brief A monotonically increasing event count. Updates are relaxed atomic adds. */
+class Counter
+{
+public:
+  void increment(std::uint64_t n = 1)
+  {
+    value_.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  std::uint64_t value() const
+  {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> value_{ 0 };
+};
+
+/** \brief A cumulative histogram of durations.
+
+    Bucket \e i counts durations up to 100us * 2^i, the last bucket counts everything longer. Recording is a few
+    relaxed atomic adds. Readers take snapshots and subtract an older snapshot to get the statistics of a time window. */
+class LatencyHistogram
+{
+public:
+  static constexpr std::size_t BUCKETS = 24;
+
+  struct Snapshot
+  {
+    std::array<std::uint64_t, BUCKETS> buckets{};
+    std::uint64_t count = 0;
+    /** \brief Sum of all recorded durations, in seconds */
+    double sum = 0.0;
+
+    /** \brief Estimate the \e q quantile (0 <= q <= 1) in seconds by interpolating within the bucket it falls into.
+        Returns 0 if the snapshot is empty. */
+    double quantile(double q) const;
+
+    /** \brief The statistics of the durations recorded between \e older and this snapshot */
+    Snapshot operator-(const Snapshot& older) const;
+  };
+
+  /** \brief The upper bound of bucket \e index in seconds. Infinite for the last bucket. */
+  static double bucketUpperBound(std::size_t index);
+
+  void record(std::chrono::nanoseconds duration);
+
+  Snapshot snapshot() const;
+
+private:
+  std::array<std::atomic<std::uint64_t>, BUCKETS> buckets_{};
+  std::atomic<std::uint64_t> sum_ns_{ 0 };
+};
+}  // namespace metrics
+}  // namespace moveit
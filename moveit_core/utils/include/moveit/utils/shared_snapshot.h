@@ -0,0 +1,117 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+/** \file shared_snapshot.h
+ *  \brief the latest version of a serialized snapshot, shared between processes through shared memory
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+struct SharedSnapshotHeader;
+
+/** \brief Writes versions of a snapshot into a named shared memory segment, for SharedSnapshotReader in other
+    processes. There must be a single writer per name; the segment is removed when the writer is destroyed.
+
+    Shared memory is only available on POSIX systems, elsewhere isValid() is false. */
+class SharedSnapshotWriter
+{
+public:
+  /** \brief Create the segment \e name, replacing a segment left over by a writer that did not exit cleanly */
+  SharedSnapshotWriter(const std::string& name, std::size_t initial_capacity = 1 << 20);
+  ~SharedSnapshotWriter();
+
+  SharedSnapshotWriter(const SharedSnapshotWriter&) = delete;
+  SharedSnapshotWriter& operator=(const SharedSnapshotWriter&) = delete;
+
+  bool isValid() const
+  {
+    return header_ != nullptr;
+  }
+
+  /** \brief Publish a new version with \e size bytes of \e data. The segment is replaced by a larger one if needed.
+      \return False if the segment could not be created */
+  bool write(const void* data, std::size_t size);
+
+  /** \brief The version of the last write, 0 before the first one */
+  std::uint64_t getVersion() const;
+
+private:
+  bool create(std::size_t capacity);
+  void release();
+
+  std::string name_;
+  SharedSnapshotHeader* header_{ nullptr };
+  std::size_t mapped_size_{ 0 };
+};
+
+/** \brief Reads the versions written by a SharedSnapshotWriter in another process. Readers never block the writer:
+    a read that overlaps a write is retried. */
+class SharedSnapshotReader
+{
+public:
+  explicit SharedSnapshotReader(const std::string& name);
+  ~SharedSnapshotReader();
+
+  SharedSnapshotReader(const SharedSnapshotReader&) = delete;
+  SharedSnapshotReader& operator=(const SharedSnapshotReader&) = delete;
+
+  /** \brief The version available to read, 0 if there is no writer or nothing was written yet. This only reads a
+      counter in shared memory, so it can be polled. */
+  std::uint64_t getVersion();
+
+  /** \brief Copy the latest version into \e data if it is newer than \e version, and update \e version
+      \return True if a newer version was copied */
+  bool read(std::vector<char>& data, std::uint64_t& version);
+
+private:
+  /** \brief Map the current segment of the writer, or the new one if the writer replaced it */
+  bool attach();
+  void release();
+
+  std::string name_;
+  SharedSnapshotHeader* header_{ nullptr };
+  std::size_t mapped_size_{ 0 };
+};
+}  // namespace core
+}  // namespace moveit
@@ -0,0 +1,96 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+/** \file thread_placement.h
+ *  \brief names, CPU affinity and priority of MoveIt's worker threads, configured per role
+ */
+
+#include <string>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+/** \brief Roles of the threads MoveIt starts. Each component passes its role to configureCurrentThread(). */
+namespace thread_roles
+{
+/** \brief Workers of the parallel planning thread pool */
+constexpr const char* PLANNING = "planning";
+/** \brief Threads of the perception pipeline, e.g. the LazyFreeSpaceUpdater and the mesh filter */
+constexpr const char* PERCEPTION = "perception";
+/** \brief The servo loop and its collision monitor */
+constexpr const char* SERVO = "servo";
+/** \brief Workers computing the default collision matrix in the setup assistant */
+constexpr const char* SETUP_ASSISTANT = "setup_assistant";
+}  // namespace thread_roles
+
+/** \brief Where and how the threads of one role run */
+struct ThreadPlacement
+{
+  /** \brief The CPUs the threads may run on, all CPUs if empty */
+  std::vector<unsigned int> cpus;
+
+  /** \brief The nice value of the threads under the default scheduler, 0 keeps the inherited value */
+  int nice = 0;
+
+  /** \brief The SCHED_FIFO priority of the threads (1 to 99), 0 keeps the default scheduler */
+  int realtime_priority = 0;
+};
+
+/** \brief Set the placement of the threads of \e role that are configured from now on */
+void setThreadPlacement(const std::string& role, const ThreadPlacement& placement);
+
+/** \brief Get the placement of the threads of \e role.
+
+    Unless set with setThreadPlacement(), it is read from the environment variables MOVEIT_THREAD_CPUS_<ROLE>,
+    MOVEIT_THREAD_NICE_<ROLE> and MOVEIT_THREAD_RT_PRIORITY_<ROLE>, with the role in upper case, e.g.
+    MOVEIT_THREAD_CPUS_PLANNING=node0 keeps the planning threads on the first NUMA node. */
+ThreadPlacement getThreadPlacement(const std::string& role);
+
+/** \brief Parse a list of CPUs like "0-3,8,12-15" into \e cpus. An entry "node<N>" stands for the CPUs of NUMA node N.
+    Returns false if the list is malformed or names an unknown node. */
+bool parseCpuList(const std::string& list, std::vector<unsigned int>& cpus);
+
+/** \brief Name the calling thread \e name (truncated to 15 characters) and apply the placement of \e role to it.
+
+    Call this first thing in a new thread, before it allocates the memory it works on, so that the memory is local
+    to the NUMA node it runs on. Only supported on Linux, elsewhere nothing is changed.
+    Returns false if any setting could not be applied, e.g. a real-time priority without the permission for it. */
+bool configureCurrentThread(const std::string& role, const std::string& name);
+}  // namespace core
+}  // namespace moveit
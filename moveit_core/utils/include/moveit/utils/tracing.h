@@ -0,0 +1,103 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+/** \file tracing.h
+ *  \brief a hook for tracing the stages of planning and execution, e.g. into LTTng or a profiler
+ */
+
+#include <atomic>
+#include <string_view>
+
+namespace moveit
+{
+namespace tracing
+{
+/** \brief Receives the begin and end of traced sections.
+
+    MoveIt marks the stages of planning and execution with ScopedTrace, e.g. PlanningPipeline::generatePlan, each
+    planning request adapter, PlanningContext::solve, collision checks, IK calls and trajectory execution. A sink
+    forwards them to a tracer, e.g. ros2_tracing/LTTng tracepoints, with its own timestamps and thread ids. Sections
+    nest per thread and may begin and end concurrently on many threads, so implementations must be thread-safe and
+    cheap, as collision checks are traced too. */
+class TraceSink
+{
+public:
+  virtual ~TraceSink() = default;
+
+  /** \brief A section \e name starts on the calling thread. \e detail names the instance, e.g. the adapter, and may
+      be empty. Both are only valid during the call. */
+  virtual void begin(std::string_view name, std::string_view detail) = 0;
+
+  /** \brief The innermost section on the calling thread, named \e name, ends */
+  virtual void end(std::string_view name) = 0;
+};
+
+namespace detail
+{
+extern std::atomic<TraceSink*> sink;
+}
+
+/** \brief Send traced sections to \e sink, or stop tracing if it is nullptr. The sink is not owned and must stay
+    alive until it is replaced and no traced section that began with it is still running. */
+void setTraceSink(TraceSink* sink);
+
+/** \brief Traces the lifetime of the object as a section. Without a sink this costs a single atomic load. */
+class ScopedTrace
+{
+public:
+  explicit ScopedTrace(std::string_view name, std::string_view detail = {})
+    : sink_(detail::sink.load(std::memory_order_acquire)), name_(name)
+  {
+    if (sink_)
+      sink_->begin(name_, detail);
+  }
+
+  ~ScopedTrace()
+  {
+    if (sink_)
+      sink_->end(name_);
+  }
+
+  ScopedTrace(const ScopedTrace&) = delete;
+  ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+  TraceSink* const sink_;
+  const std::string_view name_;
+};
+}  // namespace tracing
+}  // namespace moveit
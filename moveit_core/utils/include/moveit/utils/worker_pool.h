@@ -0,0 +1,96 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+/** \file worker_pool.h
+ *  \brief a fixed set of threads for running many short parallel loops
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+/** \brief Runs many small parallel loops on a fixed set of threads, so that each loop does not pay for starting
+    threads.
+
+    The calling thread of run() works as thread 0, so a pool of size 1 does not start any thread. Loop bodies that
+    need per-thread scratch data (e.g. a RobotState) can index it by the thread number passed to them. */
+class WorkerPool
+{
+public:
+  /** \brief Start \e num_threads - 1 worker threads. If \e thread_role is set, they are placed with
+      configureCurrentThread() for that role. */
+  explicit WorkerPool(unsigned int num_threads, const std::string& thread_role = "");
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /** \brief The number of threads that run loop bodies, including the calling thread */
+  unsigned int size() const
+  {
+    return workers_.size() + 1;
+  }
+
+  /** \brief Call fn(index, thread) for every index in [0, count) and return once all calls are done. Must not be
+      called concurrently. */
+  void run(std::size_t count, const std::function<void(std::size_t, unsigned int)>& fn);
+
+private:
+  void process(unsigned int thread);
+  void work(unsigned int thread);
+
+  std::vector<std::thread> workers_;
+  std::mutex lock_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(std::size_t, unsigned int)>* fn_{ nullptr };
+  std::size_t count_{ 0 };
+  std::atomic<std::size_t> next_{ 0 };
+  std::size_t generation_{ 0 };
+  std::size_t busy_{ 0 };
+  bool stop_{ false };
+};
+}  // namespace core
+}  // namespace moveit
@@ -0,0 +1,82 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/utils/interned_name.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace moveit
+{
+namespace core
+{
+namespace
+{
+// Entries are allocated individually and never freed, so InternedName can keep plain pointers to them
+class NameRegistry
+{
+public:
+  const InternedName::Entry* intern(const std::string& name)
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    std::unique_ptr<InternedName::Entry>& entry = entries_[name];
+    if (!entry)
+      entry.reset(new InternedName::Entry{ name, entries_.size() - 1 });
+    return entry.get();
+  }
+
+  static NameRegistry& instance()
+  {
+    static NameRegistry registry;
+    return registry;
+  }
+
+private:
+  std::mutex lock_;
+  std::unordered_map<std::string, std::unique_ptr<InternedName::Entry>> entries_;
+};
+}  // namespace
+
+InternedName::InternedName()
+{
+  static const InternedName::Entry* const EMPTY = NameRegistry::instance().intern(std::string());
+  entry_ = EMPTY;
+}
+
+InternedName::InternedName(const std::string& name) : entry_(NameRegistry::instance().intern(name))
+{
+}
+}  // namespace core
+}  // namespace moveit
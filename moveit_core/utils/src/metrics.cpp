@@ -0,0 +1,112 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/utils/metrics.h>
+#include <algorithm>
+#include <limits>
+
+namespace moveit
+{
+namespace metrics
+{
+namespace
+{
+constexpr std::uint64_t FIRST_BUCKET_NS = 100000;
+}
+
+double LatencyHistogram::bucketUpperBound(std::size_t index)
+{
+  if (index + 1 >= BUCKETS)
+    return std::numeric_limits<double>::infinity();
+  return 1e-9 * static_cast<double>(FIRST_BUCKET_NS << index);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+  const std::uint64_t ns = static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(duration.count(), 0));
+  std::size_t index = 0;
+  while (index + 1 < BUCKETS && ns > (FIRST_BUCKET_NS << index))
+    ++index;
+  buckets_[index].fetch_add(1, std::memory_order_relaxed);
+  sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+  Snapshot snapshot;
+  for (std::size_t i = 0; i < BUCKETS; ++i)
+  {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    snapshot.count += snapshot.buckets[i];
+  }
+  snapshot.sum = 1e-9 * static_cast<double>(sum_ns_.load(std::memory_order_relaxed));
+  return snapshot;
+}
+
+double LatencyHistogram::Snapshot::quantile(double q) const
+{
+  if (count == 0)
+    return 0.0;
+  const double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(count);
+  double below = 0.0;
+  for (std::size_t i = 0; i < BUCKETS; ++i)
+  {
+    if (buckets[i] == 0 || below + static_cast<double>(buckets[i]) < rank)
+    {
+      below += static_cast<double>(buckets[i]);
+      continue;
+    }
+    const double lower = i == 0 ? 0.0 : bucketUpperBound(i - 1);
+    // nothing is known about the spread of the overflow bucket, report its lower bound
+    if (i + 1 == BUCKETS)
+      return lower;
+    return lower + (bucketUpperBound(i) - lower) * (rank - below) / static_cast<double>(buckets[i]);
+  }
+  return bucketUpperBound(BUCKETS - 2);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::operator-(const Snapshot& older) const
+{
+  Snapshot difference;
+  for (std::size_t i = 0; i < BUCKETS; ++i)
+  {
+    difference.buckets[i] = buckets[i] - older.buckets[i];
+    difference.count += difference.buckets[i];
+  }
+  difference.sum = sum - older.sum;
+  return difference;
+}
+}  // namespace metrics
+}  // namespace moveit
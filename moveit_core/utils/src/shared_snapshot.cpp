@@ -0,0 +1,276 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/utils/shared_snapshot.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace moveit
+{
+namespace core
+{
+/** \brief The start of a shared segment, followed by \e capacity bytes of data */
+struct SharedSnapshotHeader
+{
+  std::uint64_t magic;
+  // twice the version, odd while a write is in progress
+  std::atomic<std::uint64_t> sequence;
+  std::atomic<std::uint64_t> size;
+  std::uint64_t capacity;
+  // set once the writer replaced this segment or was destroyed, readers then attach again
+  std::atomic<std::uint32_t> stale;
+
+  char* data()
+  {
+    return reinterpret_cast<char*>(this + 1);
+  }
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared memory requires lock-free atomics");
+
+namespace
+{
+constexpr std::uint64_t SNAPSHOT_MAGIC = 0x4d6f766549745331;  // "MoveItS1"
+
+// a read that keeps overlapping writes gives up, the reader polls again later
+constexpr int MAX_READ_ATTEMPTS = 16;
+
+std::string segmentName(const std::string& name)
+{
+  // POSIX shared memory names start with a slash and contain no other
+  std::string segment = "moveit_" + name;
+  std::replace(segment.begin(), segment.end(), '/', '_');
+  return '/' + segment;
+}
+
+/** \brief Tell the readers of a segment to attach again, and unmap it */
+void retireSegment(SharedSnapshotHeader* header, std::size_t mapped_size)
+{
+  header->stale.store(1, std::memory_order_release);
+#ifndef _WIN32
+  munmap(header, mapped_size);
+#else
+  (void)mapped_size;
+#endif
+}
+}  // namespace
+
+SharedSnapshotWriter::SharedSnapshotWriter(const std::string& name, std::size_t initial_capacity) : name_(name)
+{
+  create(initial_capacity);
+}
+
+SharedSnapshotWriter::~SharedSnapshotWriter()
+{
+  release();
+#ifndef _WIN32
+  shm_unlink(segmentName(name_).c_str());
+#endif
+}
+
+bool SharedSnapshotWriter::create(std::size_t capacity)
+{
+#ifndef _WIN32
+  const std::string segment = segmentName(name_);
+  shm_unlink(segment.c_str());
+  int fd = shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    return false;
+  const std::size_t size = sizeof(SharedSnapshotHeader) + capacity;
+  void* data = MAP_FAILED;
+  if (ftruncate(fd, size) == 0)
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    shm_unlink(segment.c_str());
+    return false;
+  }
+
+  header_ = new (data) SharedSnapshotHeader();
+  header_->sequence.store(0, std::memory_order_relaxed);
+  header_->size.store(0, std::memory_order_relaxed);
+  header_->capacity = capacity;
+  header_->stale.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = SNAPSHOT_MAGIC;
+  mapped_size_ = size;
+  return true;
+#else
+  (void)capacity;
+  return false;
+#endif
+}
+
+void SharedSnapshotWriter::release()
+{
+  if (header_)
+    retireSegment(header_, mapped_size_);
+  header_ = nullptr;
+  mapped_size_ = 0;
+}
+
+bool SharedSnapshotWriter::write(const void* data, std::size_t size)
+{
+  if (!header_ || size > header_->capacity)
+  {
+    // readers of the old segment see it marked stale only once the new one is in place, so versions never go back
+    const std::uint64_t sequence = header_ ? header_->sequence.load(std::memory_order_relaxed) : 0;
+    const std::size_t capacity = std::max<std::size_t>(size, header_ ? 2 * header_->capacity : size);
+    SharedSnapshotHeader* old_header = header_;
+    const std::size_t old_mapped_size = mapped_size_;
+    header_ = nullptr;
+    mapped_size_ = 0;
+    const bool created = create(capacity);
+    if (created)
+      header_->sequence.store(sequence, std::memory_order_release);
+    if (old_header)
+      retireSegment(old_header, old_mapped_size);
+    if (!created)
+      return false;
+  }
+
+  const std::uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+  header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(header_->data(), data, size);
+  header_->size.store(size, std::memory_order_relaxed);
+  header_->sequence.store(sequence + 2, std::memory_order_release);
+  return true;
+}
+
+std::uint64_t SharedSnapshotWriter::getVersion() const
+{
+  return header_ ? header_->sequence.load(std::memory_order_relaxed) / 2 : 0;
+}
+
+SharedSnapshotReader::SharedSnapshotReader(const std::string& name) : name_(name)
+{
+  attach();
+}
+
+SharedSnapshotReader::~SharedSnapshotReader()
+{
+  release();
+}
+
+bool SharedSnapshotReader::attach()
+{
+  release();
+#ifndef _WIN32
+  int fd = shm_open(segmentName(name_).c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+  struct stat segment_stat;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &segment_stat) == 0 && static_cast<std::size_t>(segment_stat.st_size) > sizeof(SharedSnapshotHeader))
+    data = mmap(nullptr, segment_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  auto* header = static_cast<SharedSnapshotHeader*>(data);
+  const std::size_t size = segment_stat.st_size;
+  // the writer may still be initializing the segment
+  if (header->magic != SNAPSHOT_MAGIC || sizeof(SharedSnapshotHeader) + header->capacity > size)
+  {
+    munmap(data, size);
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  header_ = header;
+  mapped_size_ = size;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void SharedSnapshotReader::release()
+{
+#ifndef _WIN32
+  if (header_)
+    munmap(header_, mapped_size_);
+#endif
+  header_ = nullptr;
+  mapped_size_ = 0;
+}
+
+std::uint64_t SharedSnapshotReader::getVersion()
+{
+  if ((!header_ || header_->stale.load(std::memory_order_acquire)) && !attach())
+    return 0;
+  return header_->sequence.load(std::memory_order_acquire) / 2;
+}
+
+bool SharedSnapshotReader::read(std::vector<char>& data, std::uint64_t& version)
+{
+  for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt)
+  {
+    if ((!header_ || header_->stale.load(std::memory_order_acquire)) && !attach())
+      return false;
+
+    const std::uint64_t sequence = header_->sequence.load(std::memory_order_acquire);
+    if (sequence / 2 <= version)
+      return false;
+    if (sequence % 2)
+      continue;
+
+    const std::uint64_t size = header_->size.load(std::memory_order_relaxed);
+    if (size > header_->capacity)
+      continue;
+    data.resize(size);
+    std::memcpy(data.data(), header_->data(), size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header_->sequence.load(std::memory_order_relaxed) == sequence)
+    {
+      version = sequence / 2;
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace core
+}  // namespace moveit
@@ -0,0 +1,198 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/utils/thread_placement.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace moveit
+{
+namespace core
+{
+namespace
+{
+std::mutex placements_lock;
+std::map<std::string, ThreadPlacement> placements;
+
+/** \brief The value of the environment variable \e prefix followed by \e role in upper case, empty if not set */
+std::string getRoleVariable(const std::string& prefix, const std::string& role)
+{
+  std::string name = prefix;
+  for (char c : role)
+    name += std::isalnum(static_cast<unsigned char>(c)) ? std::toupper(static_cast<unsigned char>(c)) : '_';
+  const char* value = std::getenv(name.c_str());
+  return value ? value : "";
+}
+
+bool parseUnsigned(const std::string& text, unsigned int& value)
+{
+  if (text.empty() || !std::all_of(text.begin(), text.end(), [](char c) { return std::isdigit(c); }))
+    return false;
+  value = std::stoul(text);
+  return true;
+}
+}  // namespace
+
+void setThreadPlacement(const std::string& role, const ThreadPlacement& placement)
+{
+  std::lock_guard<std::mutex> guard(placements_lock);
+  placements[role] = placement;
+}
+
+ThreadPlacement getThreadPlacement(const std::string& role)
+{
+  std::lock_guard<std::mutex> guard(placements_lock);
+  auto it = placements.find(role);
+  if (it != placements.end())
+    return it->second;
+
+  ThreadPlacement placement;
+  parseCpuList(getRoleVariable("MOVEIT_THREAD_CPUS_", role), placement.cpus);
+  const std::string nice = getRoleVariable("MOVEIT_THREAD_NICE_", role);
+  if (!nice.empty())
+    placement.nice = std::atoi(nice.c_str());
+  const std::string realtime_priority = getRoleVariable("MOVEIT_THREAD_RT_PRIORITY_", role);
+  if (!realtime_priority.empty())
+    placement.realtime_priority = std::atoi(realtime_priority.c_str());
+  placements[role] = placement;
+  return placement;
+}
+
+bool parseCpuList(const std::string& list, std::vector<unsigned int>& cpus)
+{
+  cpus.clear();
+  std::size_t begin = 0;
+  while (begin < list.size())
+  {
+    std::size_t end = list.find(',', begin);
+    if (end == std::string::npos)
+      end = list.size();
+    std::string entry = list.substr(begin, end - begin);
+    entry.erase(std::remove_if(entry.begin(), entry.end(), [](char c) { return std::isspace(c); }), entry.end());
+    begin = end + 1;
+    if (entry.empty())
+      continue;
+
+    unsigned int first, last;
+    if (entry.compare(0, 4, "node") == 0)
+    {
+      // the CPUs of a NUMA node are listed in the same format
+      unsigned int node;
+      std::string node_list;
+      std::vector<unsigned int> node_cpus;
+      if (!parseUnsigned(entry.substr(4), node))
+      {
+        cpus.clear();
+        return false;
+      }
+      std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      if (!std::getline(file, node_list) || !parseCpuList(node_list, node_cpus))
+      {
+        cpus.clear();
+        return false;
+      }
+      cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+      continue;
+    }
+
+    const std::size_t dash = entry.find('-');
+    if (dash == std::string::npos ? !parseUnsigned(entry, first) :
+                                    !parseUnsigned(entry.substr(0, dash), first) ||
+                                        !parseUnsigned(entry.substr(dash + 1), last) || last < first)
+    {
+      cpus.clear();
+      return false;
+    }
+    if (dash == std::string::npos)
+      last = first;
+    for (unsigned int cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return true;
+}
+
+bool configureCurrentThread(const std::string& role, const std::string& name)
+{
+#ifdef __linux__
+  const ThreadPlacement placement = getThreadPlacement(role);
+  bool ok = pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+
+  if (!placement.cpus.empty())
+  {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (unsigned int cpu : placement.cpus)
+    {
+      if (cpu < CPU_SETSIZE)
+        CPU_SET(cpu, &cpu_set);
+    }
+    ok = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0 && ok;
+  }
+
+  if (placement.realtime_priority > 0)
+  {
+    sched_param param{};
+    param.sched_priority = placement.realtime_priority;
+    ok = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0 && ok;
+  }
+  else if (placement.nice != 0)
+  {
+    // on Linux the nice value is a property of the thread, not of the process
+    ok = setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), placement.nice) == 0 && ok;
+  }
+  return ok;
+#else
+  (void)role;
+  (void)name;
+  return true;
+#endif
+}
+}  // namespace core
+}  // namespace moveit
@@ -0,0 +1,105 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/utils/worker_pool.h>
+#include <moveit/utils/thread_placement.h>
+
+namespace moveit
+{
+namespace core
+{
+WorkerPool::WorkerPool(unsigned int num_threads, const std::string& thread_role)
+{
+  for (unsigned int t = 1; t < num_threads; ++t)
+  {
+    workers_.emplace_back([this, t, thread_role] {
+      if (!thread_role.empty())
+        configureCurrentThread(thread_role, "moveit_worker_" + std::to_string(t));
+      work(t);
+    });
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_)
+    worker.join();
+}
+
+void WorkerPool::run(std::size_t count, const std::function<void(std::size_t, unsigned int)>& fn)
+{
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    fn_ = &fn;
+    count_ = count;
+    next_ = 0;
+    busy_ = workers_.size();
+    ++generation_;
+  }
+  wake_.notify_all();
+  process(0);
+  std::unique_lock<std::mutex> lock(lock_);
+  done_.wait(lock, [this] { return busy_ == 0; });
+}
+
+void WorkerPool::process(unsigned int thread)
+{
+  for (std::size_t i = next_++; i < count_; i = next_++)
+    (*fn_)(i, thread);
+}
+
+void WorkerPool::work(unsigned int thread)
+{
+  std::size_t seen_generation = 0;
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true)
+  {
+    wake_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+    if (stop_)
+      return;
+    seen_generation = generation_;
+    lock.unlock();
+    process(thread);
+    lock.lock();
+    if (--busy_ == 0)
+      done_.notify_one();
+  }
+}
+}  // namespace core
+}  // namespace moveit
@@ -0,0 +1,158 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/kdl_kinematics_plugin/kdl_kinematics_plugin.h>
+#include <moveit/robot_model/revolute_joint_model.h>
+
+#include <Eigen/Geometry>
+#include <array>
+
+namespace analytic_kinematics_plugin
+{
+/// A joint axis expressed in the base frame, with all joints at zero
+struct JointAxis
+{
+  Eigen::Vector3d direction;  ///< Unit direction of the axis
+  Eigen::Vector3d point;      ///< A point on the axis
+};
+
+/**
+ * @brief Closed-form inverse kinematics for common 6-DOF arm geometries.
+ *
+ * At initialize() the joint axes of the group are inspected in the zero configuration. Two geometries are solved
+ * analytically (with the subproblems of Paden and Kahan), returning all solution branches:
+ *  - parallel shoulder and elbow axes with a spherical wrist (the last three axes intersect in a point), which covers
+ *    most industrial arms;
+ *  - three parallel axes in the middle of the arm with intersecting last two axes, the offset wrist of UR-style arms.
+ *
+ * Any other group, e.g. a redundant arm or one with mimic joints, is handled by the KDL solver this plugin derives
+ * from, so it can be configured for every group without knowing its geometry in advance.
+ */
+class AnalyticKinematicsPlugin : public kdl_kinematics_plugin::KDLKinematicsPlugin
+{
+public:
+  AnalyticKinematicsPlugin();
+
+  bool
+  getPositionIK(const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                std::vector<double>& solution, moveit_msgs::msg::MoveItErrorCodes& error_code,
+                const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
+  /** @brief Get all analytic solutions within the joint limits, sorted by their distance to the seed state */
+  bool getPositionIK(const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<double>& ik_seed_state,
+                     std::vector<std::vector<double>>& solutions, kinematics::KinematicsResult& result,
+                     const kinematics::KinematicsQueryOptions& options) const override;
+
+  bool searchPositionIK(
+      const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+      std::vector<double>& solution, moveit_msgs::msg::MoveItErrorCodes& error_code,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
+  bool searchPositionIK(
+      const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+      const std::vector<double>& consistency_limits, std::vector<double>& solution,
+      moveit_msgs::msg::MoveItErrorCodes& error_code,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
+  bool searchPositionIK(
+      const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+      std::vector<double>& solution, const IKCallbackFn& solution_callback,
+      moveit_msgs::msg::MoveItErrorCodes& error_code,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
+  /** @brief Return the analytic solution within the consistency limits that is closest to the seed state and is
+   *  accepted by the callback. The timeout is only used when falling back to KDL. */
+  bool searchPositionIK(
+      const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+      const std::vector<double>& consistency_limits, std::vector<double>& solution,
+      const IKCallbackFn& solution_callback, moveit_msgs::msg::MoveItErrorCodes& error_code,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
+  std::size_t searchPositionIKBatch(
+      const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+      double timeout, std::vector<std::vector<double>>& solutions,
+      std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
+  bool initialize(const rclcpp::Node::SharedPtr& node, const moveit::core::RobotModel& robot_model,
+                  const std::string& group_name, const std::string& base_frame,
+                  const std::vector<std::string>& tip_frames, double search_discretization) override;
+
+private:
+  /// The arm geometries with a closed-form solution
+  enum class Geometry
+  {
+    NONE,             ///< No closed-form solution, queries are passed to KDL
+    SPHERICAL_WRIST,  ///< Axes 2 and 3 are parallel, axes 4, 5 and 6 intersect in the wrist point
+    PARALLEL_AXES,    ///< Axes 2, 3 and 4 are parallel, axes 5 and 6 intersect in the wrist point
+  };
+
+  using JointValues = std::array<double, 6>;
+
+  /// Inspect the joint axes of the group and store the geometry that can be solved analytically, if any
+  Geometry detectGeometry();
+
+  /** @brief Compute all solutions for a tip pose in the base frame, mapped into the joint limits and sorted by their
+   *  (L1) distance to the seed state. Solutions outside the joint limits are dropped. */
+  void solveAll(const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                std::vector<std::vector<double>>& solutions) const;
+
+  /// Candidate solutions for Geometry::SPHERICAL_WRIST, motion is the tip pose times the inverse home pose
+  void solveSphericalWrist(const Eigen::Isometry3d& motion, const std::vector<double>& seed,
+                           std::vector<JointValues>& candidates) const;
+
+  /// Candidate solutions for Geometry::PARALLEL_AXES, motion is the tip pose times the inverse home pose
+  void solveParallelAxes(const Eigen::Isometry3d& motion, const std::vector<double>& seed,
+                         std::vector<JointValues>& candidates) const;
+
+  /// Solve the wrist joints of Geometry::SPHERICAL_WRIST for the rotation left after the first three joints
+  void solveSphericalWristJoints(const JointValues& arm, const Eigen::Matrix3d& wrist_rotation,
+                                 const std::vector<double>& seed, std::vector<JointValues>& candidates) const;
+
+  /// The motion of the tip relative to the home pose for the given joint values
+  Eigen::Isometry3d motion(const JointValues& values) const;
+
+  /// Shift the values by multiples of 2 pi into the joint limits, as close to the seed as possible
+  bool fitToBounds(JointValues& values, const std::vector<double>& seed) const;
+
+  Geometry geometry_;
+  std::array<const moveit::core::RevoluteJointModel*, 6> joints_;
+  std::array<JointAxis, 6> axes_;
+  Eigen::Isometry3d home_pose_;  ///< The tip pose in the base frame, with all joints at zero
+  Eigen::Vector3d wrist_point_;  ///< Intersection of the wrist axes that are used to decouple the solution
+};
+}  // namespace analytic_kinematics_plugin
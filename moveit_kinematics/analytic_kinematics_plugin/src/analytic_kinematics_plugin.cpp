@@ -0,0 +1,637 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/analytic_kinematics_plugin/analytic_kinematics_plugin.h>
+
+#include <algorithm>
+#include <cmath>
+
+// register as a KinematicsBase implementation
+#include <class_loader/class_loader.hpp>
+CLASS_LOADER_REGISTER_CLASS(analytic_kinematics_plugin::AnalyticKinematicsPlugin, kinematics::KinematicsBase)
+
+namespace analytic_kinematics_plugin
+{
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_analytic_kinematics_plugin.analytic_kinematics_plugin");
+
+namespace
+{
+// Tolerance (in m or rad) of the geometric tests, and below which a subproblem is considered degenerate
+constexpr double GEOMETRY_TOLERANCE = 1e-6;
+// Maximum position (m) and orientation (rad) error of a candidate solution
+constexpr double SOLUTION_TOLERANCE = 1e-5;
+
+bool isParallel(const Eigen::Vector3d& a, const Eigen::Vector3d& b)
+{
+  return a.cross(b).norm() < GEOMETRY_TOLERANCE;
+}
+
+double distanceToAxis(const JointAxis& axis, const Eigen::Vector3d& point)
+{
+  const Eigen::Vector3d offset = point - axis.point;
+  return (offset - axis.direction * axis.direction.dot(offset)).norm();
+}
+
+// The intersection point of two axes, false if they are parallel or do not intersect
+bool intersect(const JointAxis& a, const JointAxis& b, Eigen::Vector3d& point)
+{
+  const double cos_angle = a.direction.dot(b.direction);
+  const double denominator = 1.0 - cos_angle * cos_angle;
+  if (isParallel(a.direction, b.direction))
+    return false;
+  const Eigen::Vector3d offset = a.point - b.point;
+  const double d = a.direction.dot(offset);
+  const double e = b.direction.dot(offset);
+  const Eigen::Vector3d closest_a = a.point + a.direction * ((cos_angle * e - d) / denominator);
+  const Eigen::Vector3d closest_b = b.point + b.direction * ((e - cos_angle * d) / denominator);
+  if ((closest_a - closest_b).norm() > GEOMETRY_TOLERANCE)
+    return false;
+  point = 0.5 * (closest_a + closest_b);
+  return true;
+}
+
+// The rigid motion of a rotation by theta about the axis
+Eigen::Isometry3d screwMotion(const JointAxis& axis, double theta)
+{
+  Eigen::Isometry3d result = Eigen::Isometry3d::Identity();
+  result.linear() = Eigen::AngleAxisd(theta, axis.direction).toRotationMatrix();
+  result.translation() = axis.point - result.linear() * axis.point;
+  return result;
+}
+
+// Subproblem 1: the angle that rotates p onto q about the axis. False if p or q lies on the axis.
+bool rotationAngle(const JointAxis& axis, const Eigen::Vector3d& p, const Eigen::Vector3d& q, double& theta)
+{
+  const Eigen::Vector3d& w = axis.direction;
+  Eigen::Vector3d u = p - axis.point;
+  Eigen::Vector3d v = q - axis.point;
+  u -= w * w.dot(u);
+  v -= w * w.dot(v);
+  if (u.norm() < GEOMETRY_TOLERANCE || v.norm() < GEOMETRY_TOLERANCE)
+    return false;
+  theta = std::atan2(w.dot(u.cross(v)), u.dot(v));
+  return true;
+}
+
+bool rotationAngle(const Eigen::Vector3d& direction, const Eigen::Vector3d& p, const Eigen::Vector3d& q, double& theta)
+{
+  return rotationAngle(JointAxis{ direction, Eigen::Vector3d::Zero() }, p, q, theta);
+}
+
+// Subproblem 2 for directions: the angle pairs with R(w1, theta1) * R(w2, theta2) * p = q, w1 and w2 not parallel
+std::size_t rotationAngles(const Eigen::Vector3d& w1, const Eigen::Vector3d& w2, const Eigen::Vector3d& p,
+                           const Eigen::Vector3d& q, std::array<std::pair<double, double>, 2>& thetas)
+{
+  const double cos_angle = w1.dot(w2);
+  const double denominator = cos_angle * cos_angle - 1.0;
+  const double alpha = (cos_angle * w2.dot(p) - w1.dot(q)) / denominator;
+  const double beta = (cos_angle * w1.dot(q) - w2.dot(p)) / denominator;
+  const Eigen::Vector3d normal = w1.cross(w2);
+  const double gamma_sq =
+      (p.squaredNorm() - alpha * alpha - beta * beta - 2.0 * alpha * beta * cos_angle) / normal.squaredNorm();
+  if (gamma_sq < -GEOMETRY_TOLERANCE)
+    return 0;
+  const double gamma = std::sqrt(std::max(gamma_sq, 0.0));
+
+  std::size_t count = 0;
+  for (const double sign : { 1.0, -1.0 })
+  {
+    // the intermediate direction reached from p by the second rotation, and from q by the inverse first rotation
+    const Eigen::Vector3d z = alpha * w1 + beta * w2 + sign * gamma * normal;
+    if (rotationAngle(w2, p, z, thetas[count].second) && rotationAngle(w1, z, q, thetas[count].first))
+      ++count;
+    if (gamma < GEOMETRY_TOLERANCE)
+      break;
+  }
+  return count;
+}
+
+// Subproblem 3: the angles that rotate p about the axis to a distance delta from q
+std::size_t rotationAnglesAtDistance(const JointAxis& axis, const Eigen::Vector3d& p, const Eigen::Vector3d& q,
+                                     double delta, std::array<double, 2>& thetas)
+{
+  const Eigen::Vector3d& w = axis.direction;
+  Eigen::Vector3d u = p - axis.point;
+  Eigen::Vector3d v = q - axis.point;
+  u -= w * w.dot(u);
+  v -= w * w.dot(v);
+  const double u_norm = u.norm();
+  const double v_norm = v.norm();
+  if (u_norm < GEOMETRY_TOLERANCE || v_norm < GEOMETRY_TOLERANCE)
+    return 0;
+  const double axial = w.dot(p - q);
+  const double cos_offset =
+      (u_norm * u_norm + v_norm * v_norm - (delta * delta - axial * axial)) / (2.0 * u_norm * v_norm);
+  if (std::abs(cos_offset) > 1.0 + GEOMETRY_TOLERANCE)
+    return 0;
+  const double theta = std::atan2(w.dot(u.cross(v)), u.dot(v));
+  const double offset = std::acos(std::clamp(cos_offset, -1.0, 1.0));
+  thetas[0] = theta + offset;
+  thetas[1] = theta - offset;
+  return offset < GEOMETRY_TOLERANCE ? 1 : 2;
+}
+
+// The angles that rotate the direction p about w such that n.dot(R(w, theta) * p) = c. If every angle is a solution,
+// the only one returned is the seed.
+std::size_t rotationAnglesForProjection(const Eigen::Vector3d& w, const Eigen::Vector3d& p, const Eigen::Vector3d& n,
+                                        double c, double seed, std::array<double, 2>& thetas)
+{
+  const Eigen::Vector3d p_parallel = w * w.dot(p);
+  const Eigen::Vector3d p_normal = p - p_parallel;
+  // n.dot(R * p) = a * cos(theta) + b * sin(theta) + n.dot(p_parallel)
+  const double a = n.dot(p_normal);
+  const double b = n.dot(w.cross(p_normal));
+  const double rhs = c - n.dot(p_parallel);
+  const double amplitude = std::hypot(a, b);
+  if (amplitude < GEOMETRY_TOLERANCE)
+  {
+    if (std::abs(rhs) > GEOMETRY_TOLERANCE)
+      return 0;
+    thetas[0] = seed;
+    return 1;
+  }
+  const double ratio = rhs / amplitude;
+  if (std::abs(ratio) > 1.0 + GEOMETRY_TOLERANCE)
+    return 0;
+  const double phase = std::atan2(b, a);
+  const double offset = std::acos(std::clamp(ratio, -1.0, 1.0));
+  thetas[0] = phase + offset;
+  thetas[1] = phase - offset;
+  return offset < GEOMETRY_TOLERANCE ? 1 : 2;
+}
+
+Eigen::Isometry3d poseFromMsg(const geometry_msgs::msg::Pose& msg)
+{
+  const Eigen::Quaterniond orientation(msg.orientation.w, msg.orientation.x, msg.orientation.y, msg.orientation.z);
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation() = Eigen::Vector3d(msg.position.x, msg.position.y, msg.position.z);
+  pose.linear() = orientation.normalized().toRotationMatrix();
+  return pose;
+}
+}  // namespace
+
+AnalyticKinematicsPlugin::AnalyticKinematicsPlugin() : geometry_(Geometry::NONE)
+{
+}
+
+bool AnalyticKinematicsPlugin::initialize(const rclcpp::Node::SharedPtr& node,
+                                          const moveit::core::RobotModel& robot_model, const std::string& group_name,
+                                          const std::string& base_frame, const std::vector<std::string>& tip_frames,
+                                          double search_discretization)
+{
+  geometry_ = Geometry::NONE;
+  if (!KDLKinematicsPlugin::initialize(node, robot_model, group_name, base_frame, tip_frames, search_discretization))
+    return false;
+
+  geometry_ = detectGeometry();
+  switch (geometry_)
+  {
+    case Geometry::SPHERICAL_WRIST:
+      RCLCPP_INFO(LOGGER, "Solving group '%s' analytically as an arm with a spherical wrist", group_name.c_str());
+      break;
+    case Geometry::PARALLEL_AXES:
+      RCLCPP_INFO(LOGGER, "Solving group '%s' analytically as an arm with three parallel axes", group_name.c_str());
+      break;
+    case Geometry::NONE:
+      RCLCPP_INFO(LOGGER, "Group '%s' has no supported closed-form solution, falling back to KDL", group_name.c_str());
+      break;
+  }
+  return true;
+}
+
+AnalyticKinematicsPlugin::Geometry AnalyticKinematicsPlugin::detectGeometry()
+{
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup(group_name_);
+  const std::vector<const moveit::core::JointModel*>& active_joints = jmg->getActiveJointModels();
+  if (tip_frames_.size() != 1 || active_joints.size() != joints_.size() || !jmg->getMimicJointModels().empty() ||
+      jmg->getVariableCount() != joints_.size())
+    return Geometry::NONE;
+  for (std::size_t i = 0; i < joints_.size(); ++i)
+  {
+    if (active_joints[i]->getType() != moveit::core::JointModel::REVOLUTE)
+      return Geometry::NONE;
+    joints_[i] = static_cast<const moveit::core::RevoluteJointModel*>(active_joints[i]);
+  }
+
+  // express the joint axes in the base frame at the zero configuration
+  moveit::core::RobotState state(robot_model_);
+  state.setToDefaultValues();
+  state.setJointGroupPositions(jmg, std::vector<double>(joints_.size(), 0.0));
+  state.update();
+  const Eigen::Isometry3d base_inverse = state.getFrameTransform(base_frame_).inverse();
+  for (std::size_t i = 0; i < joints_.size(); ++i)
+  {
+    const Eigen::Isometry3d joint_frame = base_inverse * state.getGlobalLinkTransform(joints_[i]->getChildLinkModel());
+    axes_[i].direction = (joint_frame.linear() * joints_[i]->getAxis()).normalized();
+    axes_[i].point = joint_frame.translation();
+  }
+  home_pose_ = base_inverse * state.getGlobalLinkTransform(getTipFrame());
+
+  const Eigen::Vector3d& shoulder = axes_[1].direction;
+  if (!isParallel(shoulder, axes_[2].direction) || isParallel(axes_[0].direction, shoulder))
+    return Geometry::NONE;
+
+  if (!isParallel(axes_[3].direction, axes_[4].direction) && !isParallel(axes_[4].direction, axes_[5].direction) &&
+      intersect(axes_[3], axes_[4], wrist_point_) && distanceToAxis(axes_[5], wrist_point_) < GEOMETRY_TOLERANCE &&
+      distanceToAxis(axes_[2], wrist_point_) > GEOMETRY_TOLERANCE)
+    return Geometry::SPHERICAL_WRIST;
+
+  if (isParallel(shoulder, axes_[3].direction) && !isParallel(shoulder, axes_[4].direction) &&
+      intersect(axes_[4], axes_[5], wrist_point_) && distanceToAxis(axes_[2], axes_[3].point) > GEOMETRY_TOLERANCE)
+    return Geometry::PARALLEL_AXES;
+
+  return Geometry::NONE;
+}
+
+Eigen::Isometry3d AnalyticKinematicsPlugin::motion(const JointValues& values) const
+{
+  Eigen::Isometry3d result = Eigen::Isometry3d::Identity();
+  for (std::size_t i = 0; i < values.size(); ++i)
+    result = result * screwMotion(axes_[i], values[i]);
+  return result;
+}
+
+void AnalyticKinematicsPlugin::solveSphericalWrist(const Eigen::Isometry3d& motion, const std::vector<double>& seed,
+                                                   std::vector<JointValues>& candidates) const
+{
+  // the wrist joints don't move the wrist point, so the first joint has to bring the target of the wrist point into
+  // the plane in which the (parallel) second and third joints move it
+  const Eigen::Vector3d& shoulder = axes_[1].direction;
+  const Eigen::Vector3d target = motion * wrist_point_;
+  std::array<double, 2> base_angles;
+  const std::size_t num_base = rotationAnglesForProjection(axes_[0].direction, shoulder, target - axes_[0].point,
+                                                           shoulder.dot(wrist_point_ - axes_[0].point), seed[0],
+                                                           base_angles);
+  for (std::size_t i = 0; i < num_base; ++i)
+  {
+    JointValues values{};
+    values[0] = base_angles[i];
+    const Eigen::Vector3d reach = screwMotion(axes_[0], -values[0]) * target;
+    const Eigen::Vector3d center = axes_[1].point + shoulder * shoulder.dot(reach - axes_[1].point);
+
+    // the elbow sets the distance of the wrist point from the shoulder axis, the shoulder its direction
+    std::array<double, 2> elbow_angles;
+    const std::size_t num_elbow =
+        rotationAnglesAtDistance(axes_[2], wrist_point_, center, (reach - center).norm(), elbow_angles);
+    for (std::size_t j = 0; j < num_elbow; ++j)
+    {
+      values[2] = elbow_angles[j];
+      if (!rotationAngle(axes_[1], screwMotion(axes_[2], values[2]) * wrist_point_, reach, values[1]))
+        values[1] = seed[1];
+      const Eigen::Isometry3d arm =
+          screwMotion(axes_[0], values[0]) * screwMotion(axes_[1], values[1]) * screwMotion(axes_[2], values[2]);
+      solveSphericalWristJoints(values, arm.linear().transpose() * motion.linear(), seed, candidates);
+    }
+  }
+}
+
+void AnalyticKinematicsPlugin::solveSphericalWristJoints(const JointValues& arm, const Eigen::Matrix3d& wrist_rotation,
+                                                         const std::vector<double>& seed,
+                                                         std::vector<JointValues>& candidates) const
+{
+  const Eigen::Vector3d& w4 = axes_[3].direction;
+  const Eigen::Vector3d& w5 = axes_[4].direction;
+  const Eigen::Vector3d& w6 = axes_[5].direction;
+  const Eigen::Vector3d target = wrist_rotation * w6;
+
+  std::array<std::pair<double, double>, 2> wrist_angles;
+  std::size_t num_wrist = 0;
+  if (w4.cross(target).norm() < GEOMETRY_TOLERANCE)
+  {
+    // wrist singularity: the fourth and sixth axes are aligned, so only the sum of their angles is determined
+    wrist_angles[0].first = seed[3];
+    if (rotationAngle(w5, w6, Eigen::AngleAxisd(-seed[3], w4) * target, wrist_angles[0].second))
+      num_wrist = 1;
+  }
+  else
+  {
+    num_wrist = rotationAngles(w4, w5, w6, target, wrist_angles);
+  }
+
+  const Eigen::Vector3d normal = w6.unitOrthogonal();
+  for (std::size_t i = 0; i < num_wrist; ++i)
+  {
+    JointValues values = arm;
+    values[3] = wrist_angles[i].first;
+    values[4] = wrist_angles[i].second;
+    const Eigen::Matrix3d rest =
+        (Eigen::AngleAxisd(values[3], w4) * Eigen::AngleAxisd(values[4], w5)).toRotationMatrix().transpose() *
+        wrist_rotation;
+    if (rotationAngle(w6, normal, rest * normal, values[5]))
+      candidates.push_back(values);
+  }
+}
+
+void AnalyticKinematicsPlugin::solveParallelAxes(const Eigen::Isometry3d& motion, const std::vector<double>& seed,
+                                                 std::vector<JointValues>& candidates) const
+{
+  // the last two joints don't move the wrist point, and the parallel joints keep it in a plane normal to their axes
+  const Eigen::Vector3d& shoulder = axes_[1].direction;
+  const Eigen::Vector3d target = motion * wrist_point_;
+  std::array<double, 2> base_angles;
+  const std::size_t num_base = rotationAnglesForProjection(axes_[0].direction, shoulder, target - axes_[0].point,
+                                                           shoulder.dot(wrist_point_ - axes_[0].point), seed[0],
+                                                           base_angles);
+  // the parallel axes may point in opposite directions
+  const double sign3 = shoulder.dot(axes_[2].direction) > 0.0 ? 1.0 : -1.0;
+  const double sign4 = shoulder.dot(axes_[3].direction) > 0.0 ? 1.0 : -1.0;
+  const Eigen::Vector3d& w5 = axes_[4].direction;
+  const Eigen::Vector3d& w6 = axes_[5].direction;
+
+  for (std::size_t i = 0; i < num_base; ++i)
+  {
+    JointValues values{};
+    values[0] = base_angles[i];
+    // rotation of the parallel joints (by the sum of their angles) and the last two joints
+    const Eigen::Matrix3d rest = Eigen::AngleAxisd(-values[0], axes_[0].direction) * motion.linear();
+
+    // the parallel joints don't change the component of the last axis along them, so it fixes the fifth joint
+    std::array<double, 2> wrist_angles;
+    const std::size_t num_wrist =
+        rotationAnglesForProjection(w5, w6, shoulder, shoulder.dot(rest * w6), seed[4], wrist_angles);
+    for (std::size_t j = 0; j < num_wrist; ++j)
+    {
+      values[4] = wrist_angles[j];
+      const Eigen::Matrix3d wrist = Eigen::AngleAxisd(values[4], w5).toRotationMatrix();
+      double parallel_sum;
+      if (!rotationAngle(shoulder, wrist * w6, rest * w6, parallel_sum))
+      {
+        // wrist singularity: the last axis is parallel to the others, so only the sum of all their angles is determined
+        values[5] = seed[5];
+        const Eigen::Vector3d normal = shoulder.unitOrthogonal();
+        if (!rotationAngle(shoulder, wrist * Eigen::AngleAxisd(values[5], w6) * normal, rest * normal, parallel_sum))
+          continue;
+      }
+      else
+      {
+        const Eigen::Vector3d normal = w6.unitOrthogonal();
+        const Eigen::Matrix3d last = (Eigen::AngleAxisd(parallel_sum, shoulder) * wrist).transpose() * rest;
+        if (!rotationAngle(w6, normal, last * normal, values[5]))
+          continue;
+      }
+
+      // the fourth joint doesn't move points on its own axis, which leaves a planar problem for the second and third
+      const Eigen::Vector3d reach = screwMotion(axes_[0], -values[0]) * motion * screwMotion(axes_[5], -values[5]) *
+                                    screwMotion(axes_[4], -values[4]) * axes_[3].point;
+      const Eigen::Vector3d center = axes_[1].point + shoulder * shoulder.dot(reach - axes_[1].point);
+      std::array<double, 2> elbow_angles;
+      const std::size_t num_elbow =
+          rotationAnglesAtDistance(axes_[2], axes_[3].point, center, (reach - center).norm(), elbow_angles);
+      for (std::size_t k = 0; k < num_elbow; ++k)
+      {
+        values[2] = elbow_angles[k];
+        if (!rotationAngle(axes_[1], screwMotion(axes_[2], values[2]) * axes_[3].point, reach, values[1]))
+          values[1] = seed[1];
+        values[3] = sign4 * (parallel_sum - values[1] - sign3 * values[2]);
+        candidates.push_back(values);
+      }
+    }
+  }
+}
+
+bool AnalyticKinematicsPlugin::fitToBounds(JointValues& values, const std::vector<double>& seed) const
+{
+  for (std::size_t i = 0; i < values.size(); ++i)
+  {
+    // the equivalent angle closest to the seed
+    double value = seed[i] + std::remainder(values[i] - seed[i], 2.0 * M_PI);
+    const moveit::core::VariableBounds& bounds = joints_[i]->getVariableBounds()[0];
+    if (!joints_[i]->isContinuous() && bounds.position_bounded_)
+    {
+      if (value > bounds.max_position_)
+        value -= 2.0 * M_PI * std::ceil((value - bounds.max_position_) / (2.0 * M_PI));
+      else if (value < bounds.min_position_)
+        value += 2.0 * M_PI * std::ceil((bounds.min_position_ - value) / (2.0 * M_PI));
+      if (value < bounds.min_position_ - GEOMETRY_TOLERANCE || value > bounds.max_position_ + GEOMETRY_TOLERANCE)
+        return false;
+      value = std::clamp(value, bounds.min_position_, bounds.max_position_);
+    }
+    values[i] = value;
+  }
+  return true;
+}
+
+void AnalyticKinematicsPlugin::solveAll(const geometry_msgs::msg::Pose& ik_pose,
+                                        const std::vector<double>& ik_seed_state,
+                                        std::vector<std::vector<double>>& solutions) const
+{
+  const Eigen::Isometry3d target = poseFromMsg(ik_pose);
+  const Eigen::Isometry3d target_motion = target * home_pose_.inverse();
+  std::vector<JointValues> candidates;
+  if (geometry_ == Geometry::SPHERICAL_WRIST)
+    solveSphericalWrist(target_motion, ik_seed_state, candidates);
+  else
+    solveParallelAxes(target_motion, ik_seed_state, candidates);
+
+  solutions.clear();
+  for (JointValues& candidate : candidates)
+  {
+    // drop the spurious branches of degenerate subproblems
+    const Eigen::Isometry3d reached = motion(candidate) * home_pose_;
+    if ((reached.translation() - target.translation()).norm() > SOLUTION_TOLERANCE ||
+        Eigen::AngleAxisd(reached.linear().transpose() * target.linear()).angle() > SOLUTION_TOLERANCE)
+      continue;
+    if (!fitToBounds(candidate, ik_seed_state))
+      continue;
+    const bool duplicate = std::any_of(solutions.begin(), solutions.end(), [&](const std::vector<double>& solution) {
+      return std::equal(solution.begin(), solution.end(), candidate.begin(),
+                        [](double a, double b) { return std::abs(a - b) < GEOMETRY_TOLERANCE; });
+    });
+    if (!duplicate)
+      solutions.emplace_back(candidate.begin(), candidate.end());
+  }
+
+  const auto distance = [&](const std::vector<double>& solution) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < solution.size(); ++i)
+      sum += std::abs(solution[i] - ik_seed_state[i]);
+    return sum;
+  };
+  std::sort(solutions.begin(), solutions.end(),
+            [&](const std::vector<double>& a, const std::vector<double>& b) { return distance(a) < distance(b); });
+}
+
+bool AnalyticKinematicsPlugin::getPositionIK(const geometry_msgs::msg::Pose& ik_pose,
+                                             const std::vector<double>& ik_seed_state, std::vector<double>& solution,
+                                             moveit_msgs::msg::MoveItErrorCodes& error_code,
+                                             const kinematics::KinematicsQueryOptions& options) const
+{
+  std::vector<double> consistency_limits;
+  return searchPositionIK(ik_pose, ik_seed_state, 0.0, consistency_limits, solution, IKCallbackFn(), error_code,
+                          options);
+}
+
+bool AnalyticKinematicsPlugin::getPositionIK(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                             const std::vector<double>& ik_seed_state,
+                                             std::vector<std::vector<double>>& solutions,
+                                             kinematics::KinematicsResult& result,
+                                             const kinematics::KinematicsQueryOptions& options) const
+{
+  if (geometry_ == Geometry::NONE)
+    return kinematics::KinematicsBase::getPositionIK(ik_poses, ik_seed_state, solutions, result, options);
+
+  result.solution_percentage = 0.0;
+  if (options.discretization_method != kinematics::DiscretizationMethods::NO_DISCRETIZATION)
+  {
+    result.kinematic_error = kinematics::KinematicErrors::UNSUPORTED_DISCRETIZATION_REQUESTED;
+    return false;
+  }
+  if (ik_poses.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "Input ik_poses array is empty");
+    result.kinematic_error = kinematics::KinematicErrors::EMPTY_TIP_POSES;
+    return false;
+  }
+  if (ik_poses.size() != 1)
+  {
+    RCLCPP_ERROR(LOGGER, "This kinematic solver does not support getPositionIK for multiple tips");
+    result.kinematic_error = kinematics::KinematicErrors::MULTIPLE_TIPS_NOT_SUPPORTED;
+    return false;
+  }
+  if (ik_seed_state.size() != joints_.size())
+  {
+    RCLCPP_ERROR(LOGGER, "Seed state must have size %zu instead of size %zu", joints_.size(), ik_seed_state.size());
+    result.kinematic_error = kinematics::KinematicErrors::NO_SOLUTION;
+    return false;
+  }
+
+  solveAll(ik_poses[0], ik_seed_state, solutions);
+  if (solutions.empty())
+  {
+    result.kinematic_error = kinematics::KinematicErrors::NO_SOLUTION;
+    return false;
+  }
+  result.kinematic_error = kinematics::KinematicErrors::OK;
+  result.solution_percentage = 1.0;
+  return true;
+}
+
+bool AnalyticKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_pose,
+                                                const std::vector<double>& ik_seed_state, double timeout,
+                                                std::vector<double>& solution,
+                                                moveit_msgs::msg::MoveItErrorCodes& error_code,
+                                                const kinematics::KinematicsQueryOptions& options) const
+{
+  std::vector<double> consistency_limits;
+  return searchPositionIK(ik_pose, ik_seed_state, timeout, consistency_limits, solution, IKCallbackFn(), error_code,
+                          options);
+}
+
+bool AnalyticKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_pose,
+                                                const std::vector<double>& ik_seed_state, double timeout,
+                                                const std::vector<double>& consistency_limits,
+                                                std::vector<double>& solution,
+                                                moveit_msgs::msg::MoveItErrorCodes& error_code,
+                                                const kinematics::KinematicsQueryOptions& options) const
+{
+  return searchPositionIK(ik_pose, ik_seed_state, timeout, consistency_limits, solution, IKCallbackFn(), error_code,
+                          options);
+}
+
+bool AnalyticKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_pose,
+                                                const std::vector<double>& ik_seed_state, double timeout,
+                                                std::vector<double>& solution, const IKCallbackFn& solution_callback,
+                                                moveit_msgs::msg::MoveItErrorCodes& error_code,
+                                                const kinematics::KinematicsQueryOptions& options) const
+{
+  std::vector<double> consistency_limits;
+  return searchPositionIK(ik_pose, ik_seed_state, timeout, consistency_limits, solution, solution_callback, error_code,
+                          options);
+}
+
+bool AnalyticKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_pose,
+                                                const std::vector<double>& ik_seed_state, double timeout,
+                                                const std::vector<double>& consistency_limits,
+                                                std::vector<double>& solution, const IKCallbackFn& solution_callback,
+                                                moveit_msgs::msg::MoveItErrorCodes& error_code,
+                                                const kinematics::KinematicsQueryOptions& options) const
+{
+  if (geometry_ == Geometry::NONE)
+    return KDLKinematicsPlugin::searchPositionIK(ik_pose, ik_seed_state, timeout, consistency_limits, solution,
+                                                 solution_callback, error_code, options);
+
+  if (ik_seed_state.size() != joints_.size())
+  {
+    RCLCPP_ERROR(LOGGER, "Seed state must have size %zu instead of size %zu", joints_.size(), ik_seed_state.size());
+    error_code.val = error_code.NO_IK_SOLUTION;
+    return false;
+  }
+  if (!consistency_limits.empty() && consistency_limits.size() != joints_.size())
+  {
+    RCLCPP_ERROR(LOGGER, "Consistency limits must be empty or have size %zu instead of size %zu", joints_.size(),
+                 consistency_limits.size());
+    error_code.val = error_code.NO_IK_SOLUTION;
+    return false;
+  }
+
+  std::vector<std::vector<double>> solutions;
+  solveAll(ik_pose, ik_seed_state, solutions);
+  for (const std::vector<double>& candidate : solutions)
+  {
+    bool consistent = true;
+    for (std::size_t i = 0; i < consistency_limits.size() && consistent; ++i)
+      consistent = std::abs(candidate[i] - ik_seed_state[i]) <= consistency_limits[i];
+    if (!consistent)
+      continue;
+    if (solution_callback)
+    {
+      solution_callback(ik_pose, candidate, error_code);
+      if (error_code.val != error_code.SUCCESS)
+        continue;
+    }
+    solution = candidate;
+    error_code.val = error_code.SUCCESS;
+    return true;
+  }
+
+  RCLCPP_DEBUG(LOGGER, "None of the %zu analytic solutions is valid", solutions.size());
+  error_code.val = error_code.NO_IK_SOLUTION;
+  return false;
+}
+
+std::size_t AnalyticKinematicsPlugin::searchPositionIKBatch(
+    const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+    double timeout, std::vector<std::vector<double>>& solutions,
+    std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+    const kinematics::KinematicsQueryOptions& options) const
+{
+  // the analytic solver has no per-query state, so the generic batch over searchPositionIK() is all that is needed
+  if (geometry_ == Geometry::NONE)
+    return KDLKinematicsPlugin::searchPositionIKBatch(ik_poses, ik_seed_states, timeout, solutions, error_codes,
+                                                      options);
+  return kinematics::KinematicsBase::searchPositionIKBatch(ik_poses, ik_seed_states, timeout, solutions, error_codes,
+                                                           options);
+}
+}  // namespace analytic_kinematics_plugin
@@ -58,6 +58,7 @@ void CachedIKKinematicsPlugin<KinematicsPlugin>::initCache(const std::string& ro
   opts.min_pose_distance = params_.min_pose_distance;
   opts.min_joint_config_distance = params_.min_joint_config_distance;
   opts.cached_ik_path = params_.cached_ik_path;
+  opts.cached_ik_read_only = params_.cached_ik_read_only;
 
   cache_.initializeCache(robot_id, group_name, cache_name, KinematicsPlugin::getJointNames().size(), opts);
 
@@ -43,6 +43,7 @@
 #include <tf2/LinearMath/Quaternion.h>
 #include <tf2/LinearMath/Vector3.h>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <utility>
 #include <filesystem>
@@ -59,13 +60,20 @@ class IKCache
 public:
   struct Options
   {
-    Options() : max_cache_size(5000), min_pose_distance(1.0), min_joint_config_distance(1.0), cached_ik_path("")
+    Options()
+      : max_cache_size(5000)
+      , min_pose_distance(1.0)
+      , min_joint_config_distance(1.0)
+      , cached_ik_path("")
+      , cached_ik_read_only(false)
     {
     }
     unsigned int max_cache_size;
     double min_pose_distance;
     double min_joint_config_distance;
     std::string cached_ik_path;
+    /** use the cache file as is: never add entries or write it back to disk */
+    bool cached_ik_read_only;
   };
 
   /**
@@ -121,6 +129,14 @@ protected:
   double configDistance2(const std::vector<double>& config1, const std::vector<double>& config2) const;
   /** save current state of cache to disk */
   void saveCache() const;
+  /** read cache entries and nearest neighbor index from a memory-mapped cache file */
+  bool loadCache(const char* begin, const char* end);
+  /** read cache entries from a cache file written before the format was versioned */
+  bool loadLegacyCache(const char* begin, const char* end);
+  /** append an entry to the cache and stage it for insertion into ik_nn_; lock_ must be held */
+  void addEntry(const std::vector<Pose>& poses, const std::vector<double>& config) const;
+  /** insert the staged entries into ik_nn_; nn_lock_ must be held exclusively */
+  void mergeStagedEntries() const;
 
   /** number of joints in the system */
   unsigned int num_joints_;
@@ -133,6 +149,8 @@ protected:
   unsigned int max_cache_size_;
   /** file name for loading / saving cache */
   std::filesystem::path cache_file_name_;
+  /** if true, the cache is never updated or saved */
+  bool read_only_{ false };
 
   /**
     the IK methods are declared const in the base class, but the
@@ -143,10 +161,17 @@ protected:
   mutable std::vector<IKEntry> ik_cache_;
   /** nearest neighbor data structure over IK cache entries */
   mutable NearestNeighborsGNAT<IKEntry*> ik_nn_;
+  /**
+    entries that were added to ik_cache_ but not yet to ik_nn_, so that
+    inserting does not have to wait for queries to finish
+  */
+  mutable std::vector<IKEntry*> staged_entries_;
   /** size of the cache when it was last saved */
   mutable unsigned int last_saved_cache_size_{ 0 };
-  /** mutex for changing IK cache */
+  /** mutex for changing IK cache (ik_cache_, staged_entries_ and saving) */
   mutable std::mutex lock_;
+  /** queries share this lock on ik_nn_; merging staged entries takes it exclusively */
+  mutable std::shared_mutex nn_lock_;
 };
 
 /** a container of IK caches for cases where there is no fixed base frame */
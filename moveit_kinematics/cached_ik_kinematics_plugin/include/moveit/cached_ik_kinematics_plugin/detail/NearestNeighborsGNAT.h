@@ -41,6 +41,8 @@
 #include <moveit/exceptions/exceptions.h>
 #include <rsl/random.hpp>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <queue>
 #include <unordered_set>
 #include <utility>
@@ -256,6 +258,42 @@ public:
       tree_->list(*this, data);
   }
 
+  // \brief Write the tree structure to \e out in a binary format that can be
+  // restored with deserialize() without any distance computations. Each
+  // element is stored as the index returned by \e toIndex. Returns false if
+  // there are elements marked for removal; the tree should be rebuilt first.
+  bool serialize(std::ostream& out, const std::function<std::uint32_t(const _T&)>& toIndex) const
+  {
+    if (!removed_.empty())
+      return false;
+    write(out, static_cast<std::uint64_t>(size_));
+    write(out, static_cast<std::uint64_t>(rebuildSize_));
+    write(out, static_cast<std::uint8_t>(tree_ != nullptr));
+    if (tree_)
+      tree_->serialize(out, toIndex);
+    return static_cast<bool>(out);
+  }
+  // \brief Replace the tree with one written by serialize(), read from the
+  // memory in [begin, end). Stored indices refer to \e elements. Returns
+  // false (leaving the structure empty) if the data is malformed.
+  bool deserialize(const char* begin, const char* end, const std::vector<_T>& elements)
+  {
+    clear();
+    std::uint64_t size, rebuild_size;
+    std::uint8_t has_tree;
+    if (!read(begin, end, size) || !read(begin, end, rebuild_size) || !read(begin, end, has_tree))
+      return false;
+    if (has_tree)
+    {
+      tree_ = Node::deserialize(begin, end, elements);
+      if (!tree_)
+        return false;
+    }
+    size_ = size;
+    rebuildSize_ = rebuild_size;
+    return true;
+  }
+
   // \brief Print a GNAT structure (mostly useful for debugging purposes).
   friend std::ostream& operator<<(std::ostream& out, const NearestNeighborsGNAT<_T>& gnat)
   {
@@ -313,6 +351,21 @@ public:
 protected:
   using GNAT = NearestNeighborsGNAT<_T>;
 
+  template <typename T>
+  static void write(std::ostream& out, const T& value)
+  {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  template <typename T>
+  static bool read(const char*& begin, const char* end, T& value)
+  {
+    if (end - begin < static_cast<std::ptrdiff_t>(sizeof(T)))
+      return false;
+    std::memcpy(&value, begin, sizeof(T));
+    begin += sizeof(T);
+    return true;
+  }
+
   // Return true iff data has been marked for removal.
   bool isRemoved(const _T& data) const
   {
@@ -674,6 +727,76 @@ protected:
         children_[i]->list(gnat, data);
     }
 
+    void serialize(std::ostream& out, const std::function<std::uint32_t(const _T&)>& toIndex) const
+    {
+      write(out, static_cast<std::uint32_t>(degree_));
+      write(out, minRadius_);
+      write(out, maxRadius_);
+      write(out, static_cast<std::uint32_t>(minRange_.size()));
+      out.write(reinterpret_cast<const char*>(minRange_.data()), minRange_.size() * sizeof(double));
+      out.write(reinterpret_cast<const char*>(maxRange_.data()), maxRange_.size() * sizeof(double));
+      write(out, toIndex(pivot_));
+      write(out, static_cast<std::uint32_t>(data_.size()));
+      for (const _T& element : data_)
+        write(out, toIndex(element));
+      write(out, static_cast<std::uint32_t>(children_.size()));
+      for (const Node* child : children_)
+        child->serialize(out, toIndex);
+    }
+
+    // Read a subtree written by serialize(); returns nullptr if the data is malformed.
+    static Node* deserialize(const char*& begin, const char* end, const std::vector<_T>& elements)
+    {
+      std::uint32_t degree, num_ranges, pivot, num_data, num_children;
+      double min_radius, max_radius;
+      if (!read(begin, end, degree) || !read(begin, end, min_radius) || !read(begin, end, max_radius) ||
+          !read(begin, end, num_ranges) ||
+          static_cast<std::size_t>(end - begin) < 2 * static_cast<std::size_t>(num_ranges) * sizeof(double))
+        return nullptr;
+      std::vector<double> min_range(num_ranges), max_range(num_ranges);
+      std::memcpy(min_range.data(), begin, num_ranges * sizeof(double));
+      begin += num_ranges * sizeof(double);
+      std::memcpy(max_range.data(), begin, num_ranges * sizeof(double));
+      begin += num_ranges * sizeof(double);
+      if (!read(begin, end, pivot) || pivot >= elements.size() || !read(begin, end, num_data) ||
+          static_cast<std::size_t>(end - begin) < static_cast<std::size_t>(num_data) * sizeof(std::uint32_t))
+        return nullptr;
+
+      Node* node = new Node(degree, num_data, elements[pivot]);
+      node->minRadius_ = min_radius;
+      node->maxRadius_ = max_radius;
+      node->minRange_.swap(min_range);
+      node->maxRange_.swap(max_range);
+      for (std::uint32_t i = 0; i < num_data; ++i)
+      {
+        std::uint32_t index = 0;
+        read(begin, end, index);
+        if (index >= elements.size())
+        {
+          delete node;
+          return nullptr;
+        }
+        node->data_.push_back(elements[index]);
+      }
+      if (!read(begin, end, num_children))
+      {
+        delete node;
+        return nullptr;
+      }
+      node->children_.reserve(num_children);
+      for (std::uint32_t i = 0; i < num_children; ++i)
+      {
+        Node* child = deserialize(begin, end, elements);
+        if (!child)
+        {
+          delete node;
+          return nullptr;
+        }
+        node->children_.push_back(child);
+      }
+      return node;
+    }
+
     friend std::ostream& operator<<(std::ostream& out, const Node& node)
     {
       out << "\ndegree:\t" << node.degree_;
@@ -34,14 +34,69 @@
 
 /* Author: Mark Moll */
 
+#include <cstdint>
+#include <cstring>
 #include <numeric>
 #include <filesystem>
 #include <fstream>
 
 #include <moveit/cached_ik_kinematics_plugin/cached_ik_kinematics_plugin.h>
+#include <moveit/utils/mapped_file.h>
 
 namespace cached_ik_kinematics_plugin
 {
+namespace
+{
+// Layout of a cache file: the header below, followed by num_entries fixed-size
+// records (num_tips poses of 7 tf2Scalars each, then num_dofs doubles), followed
+// by the serialized nearest neighbor index.
+constexpr char CACHE_FILE_MAGIC[8] = { 'M', 'V', 'I', 'K', 'C', 'A', 'C', 'H' };
+constexpr std::uint32_t CACHE_FILE_VERSION = 2;
+
+struct CacheFileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t scalar_size;
+  std::uint64_t num_entries;
+  std::uint32_t num_dofs;
+  std::uint32_t num_tips;
+  std::uint64_t index_offset;
+  std::uint64_t index_size;
+};
+
+// Staged entries are merged into the nearest neighbor index once there are
+// this many, if no query holds the index at that moment ...
+constexpr std::size_t MERGE_BATCH_SIZE = 32;
+// ... and unconditionally once there are this many.
+constexpr std::size_t MAX_STAGED_ENTRIES = 512;
+
+constexpr std::size_t POSITION_SIZE = 3 * sizeof(tf2Scalar);
+constexpr std::size_t ORIENTATION_SIZE = 4 * sizeof(tf2Scalar);
+constexpr std::size_t POSE_SIZE = POSITION_SIZE + ORIENTATION_SIZE;
+
+// Copy num_entries records starting at data into cache.
+void readEntries(const char* data, std::size_t num_entries, unsigned int num_dofs, unsigned int num_tips,
+                 std::vector<IKCache::IKEntry>& cache)
+{
+  const std::size_t config_size = num_dofs * sizeof(double);
+  const std::size_t offset_conf = POSE_SIZE * num_tips;
+  IKCache::IKEntry entry;
+  entry.first.resize(num_tips);
+  entry.second.resize(num_dofs);
+  for (std::size_t i = 0; i < num_entries; ++i, data += offset_conf + config_size)
+  {
+    for (unsigned int j = 0; j < num_tips; ++j)
+    {
+      memcpy(&entry.first[j].position[0], data + j * POSE_SIZE, POSITION_SIZE);
+      memcpy(&entry.first[j].orientation[0], data + j * POSE_SIZE + POSITION_SIZE, ORIENTATION_SIZE);
+    }
+    memcpy(entry.second.data(), data + offset_conf, config_size);
+    cache.push_back(entry);
+  }
+}
+}  // namespace
+
 IKCache::IKCache()
 {
   // set distance function for nearest-neighbor queries
@@ -55,7 +110,7 @@ IKCache::IKCache()
 
 IKCache::~IKCache()
 {
-  if (!ik_cache_.empty())
+  if (!read_only_ && !ik_cache_.empty())
     saveCache();
 }
 
@@ -72,6 +127,7 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
 
   // use mutex lock for rest of initialization
   std::lock_guard<std::mutex> slock(lock_);
+  std::unique_lock<std::shared_mutex> nn_lock(nn_lock_);
   // determine cache file name
   std::filesystem::path prefix(!cached_ik_path.empty() ? std::filesystem::path(cached_ik_path) :
                                                          std::filesystem::current_path());
@@ -84,52 +140,20 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
 
   ik_cache_.clear();
   ik_nn_.clear();
+  staged_entries_.clear();
   last_saved_cache_size_ = 0;
+  read_only_ = opts.cached_ik_read_only;
   if (std::filesystem::exists(cache_file_name_))
   {
-    // read cache
-    std::ifstream cache_file(cache_file_name_, std::ios_base::binary | std::ios_base::in);
-    cache_file.read(reinterpret_cast<char*>(&last_saved_cache_size_), sizeof(unsigned int));
-    unsigned int num_dofs;
-    cache_file.read(reinterpret_cast<char*>(&num_dofs), sizeof(unsigned int));
-    unsigned int num_tips;
-    cache_file.read(reinterpret_cast<char*>(&num_tips), sizeof(unsigned int));
-
-    RCLCPP_INFO(LOGGER, "Found %d IK solutions for a %d-dof system with %d end effectors in %s", last_saved_cache_size_,
-                num_dofs, num_tips, cache_file_name_.string().c_str());
-
-    unsigned int position_size = 3 * sizeof(tf2Scalar);
-    unsigned int orientation_size = 4 * sizeof(tf2Scalar);
-    unsigned int pose_size = position_size + orientation_size;
-    unsigned int config_size = num_dofs * sizeof(double);
-    unsigned int offset_conf = pose_size * num_tips;
-    unsigned int bufsize = offset_conf + config_size;
-    char* buffer = new char[bufsize];
-    IKEntry entry;
-    entry.first.resize(num_tips);
-    entry.second.resize(num_dofs);
-    ik_cache_.reserve(last_saved_cache_size_);
-
-    for (unsigned i = 0; i < last_saved_cache_size_; ++i)
+    moveit::core::MappedFile cache_file(cache_file_name_);
+    if (cache_file.empty() || !(loadCache(cache_file.begin(), cache_file.end()) ||
+                                loadLegacyCache(cache_file.begin(), cache_file.end())))
     {
-      unsigned int j = 0;
-      cache_file.read(buffer, bufsize);
-      for (auto& pose : entry.first)
-      {
-        memcpy(&pose.position[0], buffer + j * pose_size, position_size);
-        memcpy(&pose.orientation[0], buffer + j * pose_size + position_size, orientation_size);
-        ++j;
-      }
-      memcpy(&entry.second[0], buffer + offset_conf, config_size);
-      ik_cache_.push_back(entry);
+      RCLCPP_ERROR(LOGGER, "Cache file %s is corrupt, starting with an empty cache", cache_file_name_.string().c_str());
+      ik_cache_.clear();
+      ik_nn_.clear();
+      last_saved_cache_size_ = 0;
     }
-    RCLCPP_INFO(LOGGER, "freeing buffer");
-    delete[] buffer;
-    RCLCPP_INFO(LOGGER, "freed buffer");
-    std::vector<IKEntry*> ik_entry_ptrs(last_saved_cache_size_);
-    for (unsigned int i = 0; i < last_saved_cache_size_; ++i)
-      ik_entry_ptrs[i] = &ik_cache_[i];
-    ik_nn_.add(ik_entry_ptrs);
   }
 
   num_joints_ = num_joints;
@@ -137,6 +161,77 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
   RCLCPP_INFO(LOGGER, "cache file %s initialized!", cache_file_name_.string().c_str());
 }
 
+bool IKCache::loadCache(const char* begin, const char* end)
+{
+  CacheFileHeader header;
+  if (static_cast<std::size_t>(end - begin) < sizeof(header))
+    return false;
+  memcpy(&header, begin, sizeof(header));
+  if (memcmp(header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) != 0)
+    return false;
+  if (header.version != CACHE_FILE_VERSION || header.scalar_size != sizeof(tf2Scalar))
+  {
+    RCLCPP_WARN(LOGGER, "Cache file %s has version %u with %u-byte scalars, expected version %u with %zu-byte scalars",
+                cache_file_name_.string().c_str(), header.version, header.scalar_size, CACHE_FILE_VERSION,
+                sizeof(tf2Scalar));
+    return false;
+  }
+  const std::size_t entry_size = POSE_SIZE * header.num_tips + header.num_dofs * sizeof(double);
+  const std::size_t file_size = end - begin;
+  if (header.num_entries > (file_size - sizeof(header)) / std::max<std::size_t>(entry_size, 1))
+    return false;
+
+  RCLCPP_INFO(LOGGER, "Found %lu IK solutions for a %u-dof system with %u end effectors in %s",
+              static_cast<unsigned long>(header.num_entries), header.num_dofs, header.num_tips,
+              cache_file_name_.string().c_str());
+
+  ik_cache_.reserve(header.num_entries);
+  readEntries(begin + sizeof(header), header.num_entries, header.num_dofs, header.num_tips, ik_cache_);
+  last_saved_cache_size_ = ik_cache_.size();
+
+  std::vector<IKEntry*> ik_entry_ptrs(ik_cache_.size());
+  for (std::size_t i = 0; i < ik_cache_.size(); ++i)
+    ik_entry_ptrs[i] = &ik_cache_[i];
+  if (header.index_offset < sizeof(header) || header.index_offset > file_size ||
+      header.index_size > file_size - header.index_offset ||
+      !ik_nn_.deserialize(begin + header.index_offset, begin + header.index_offset + header.index_size,
+                          ik_entry_ptrs) ||
+      ik_nn_.size() != ik_cache_.size())
+  {
+    RCLCPP_WARN(LOGGER, "Nearest neighbor index in %s is invalid, rebuilding it", cache_file_name_.string().c_str());
+    ik_nn_.clear();
+    ik_nn_.add(ik_entry_ptrs);
+  }
+  return true;
+}
+
+bool IKCache::loadLegacyCache(const char* begin, const char* end)
+{
+  unsigned int header[3];
+  if (static_cast<std::size_t>(end - begin) < sizeof(header))
+    return false;
+  memcpy(header, begin, sizeof(header));
+  const unsigned int num_entries = header[0];
+  const unsigned int num_dofs = header[1];
+  const unsigned int num_tips = header[2];
+  const std::size_t entry_size = POSE_SIZE * num_tips + num_dofs * sizeof(double);
+  if (num_entries > (end - begin - sizeof(header)) / std::max<std::size_t>(entry_size, 1))
+    return false;
+
+  RCLCPP_INFO(LOGGER, "Found %u IK solutions for a %u-dof system with %u end effectors in %s (old format)",
+              num_entries, num_dofs, num_tips, cache_file_name_.string().c_str());
+
+  ik_cache_.reserve(num_entries);
+  readEntries(begin + sizeof(header), num_entries, num_dofs, num_tips, ik_cache_);
+  last_saved_cache_size_ = ik_cache_.size();
+
+  std::vector<IKEntry*> ik_entry_ptrs(ik_cache_.size());
+  for (std::size_t i = 0; i < ik_cache_.size(); ++i)
+    ik_entry_ptrs[i] = &ik_cache_[i];
+  ik_nn_.add(ik_entry_ptrs);
+  return true;
+}
+
 double IKCache::configDistance2(const std::vector<double>& config1, const std::vector<double>& config2) const
 {
   double dist = 0., diff;
@@ -150,7 +245,8 @@ double IKCache::configDistance2(const std::vector<double>& config1, const std::v
 
 const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const Pose& pose) const
 {
-  if (ik_cache_.empty())
+  std::shared_lock<std::shared_mutex> nn_lock(nn_lock_);
+  if (ik_nn_.size() == 0)
   {
     static IKEntry dummy = std::make_pair(std::vector<Pose>(1, pose), std::vector<double>(num_joints_, 0.));
     return dummy;
@@ -161,7 +257,8 @@ const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const Pose& pose)
 
 const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const std::vector<Pose>& poses) const
 {
-  if (ik_cache_.empty())
+  std::shared_lock<std::shared_mutex> nn_lock(nn_lock_);
+  if (ik_nn_.size() == 0)
   {
     static IKEntry dummy = std::make_pair(poses, std::vector<double>(num_joints_, 0.));
     return dummy;
@@ -172,81 +269,144 @@ const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const std::vector<
 
 void IKCache::updateCache(const IKEntry& nearest, const Pose& pose, const std::vector<double>& config) const
 {
-  if (ik_cache_.size() < ik_cache_.capacity() && (nearest.first[0].distance(pose) > min_pose_distance_ ||
-                                                  configDistance2(nearest.second, config) > min_config_distance2_))
+  if (!read_only_ && (nearest.first[0].distance(pose) > min_pose_distance_ ||
+                      configDistance2(nearest.second, config) > min_config_distance2_))
   {
     std::lock_guard<std::mutex> slock(lock_);
-    ik_cache_.emplace_back(std::vector<Pose>(1u, pose), config);
-    ik_nn_.add(&ik_cache_.back());
-    if (ik_cache_.size() >= last_saved_cache_size_ + 500u || ik_cache_.size() == max_cache_size_)
-      saveCache();
+    addEntry(std::vector<Pose>(1u, pose), config);
   }
 }
 
 void IKCache::updateCache(const IKEntry& nearest, const std::vector<Pose>& poses,
                           const std::vector<double>& config) const
 {
-  if (ik_cache_.size() < ik_cache_.capacity())
+  if (read_only_)
+    return;
+  bool add_to_cache = configDistance2(nearest.second, config) > min_config_distance2_;
+  if (!add_to_cache)
   {
-    bool add_to_cache = configDistance2(nearest.second, config) > min_config_distance2_;
-    if (!add_to_cache)
+    double dist = 0.;
+    for (unsigned int i = 0; i < poses.size(); ++i)
     {
-      double dist = 0.;
-      for (unsigned int i = 0; i < poses.size(); ++i)
+      dist += nearest.first[i].distance(poses[i]);
+      if (dist > min_pose_distance_)
       {
-        dist += nearest.first[i].distance(poses[i]);
-        if (dist > min_pose_distance_)
-        {
-          add_to_cache = true;
-          break;
-        }
+        add_to_cache = true;
+        break;
       }
     }
-    if (add_to_cache)
-    {
-      std::lock_guard<std::mutex> slock(lock_);
-      ik_cache_.emplace_back(poses, config);
-      ik_nn_.add(&ik_cache_.back());
-      if (ik_cache_.size() >= last_saved_cache_size_ + 500u || ik_cache_.size() == max_cache_size_)
-        saveCache();
-    }
   }
+  if (add_to_cache)
+  {
+    std::lock_guard<std::mutex> slock(lock_);
+    addEntry(poses, config);
+  }
+}
+
+void IKCache::addEntry(const std::vector<Pose>& poses, const std::vector<double>& config) const
+{
+  // ik_cache_ never grows beyond its reserved capacity, so entries (and
+  // the references handed out to them) stay valid while queries run.
+  if (ik_cache_.size() >= ik_cache_.capacity())
+    return;
+  ik_cache_.emplace_back(poses, config);
+  staged_entries_.push_back(&ik_cache_.back());
+  if (staged_entries_.size() >= MERGE_BATCH_SIZE)
+  {
+    std::unique_lock<std::shared_mutex> nn_lock(nn_lock_, std::defer_lock);
+    if (staged_entries_.size() >= MAX_STAGED_ENTRIES)
+      nn_lock.lock();
+    else
+      nn_lock.try_lock();
+    if (nn_lock.owns_lock())
+      mergeStagedEntries();
+  }
+  if (ik_cache_.size() >= last_saved_cache_size_ + 500u || ik_cache_.size() == max_cache_size_)
+    saveCache();
+}
+
+void IKCache::mergeStagedEntries() const
+{
+  ik_nn_.add(staged_entries_);
+  staged_entries_.clear();
 }
 
 void IKCache::saveCache() const
 {
   if (cache_file_name_.empty())
+  {
     RCLCPP_ERROR(LOGGER, "can't save cache before initialization");
+    return;
+  }
 
   RCLCPP_INFO(LOGGER, "writing %ld IK solutions to %s", ik_cache_.size(), cache_file_name_.string().c_str());
 
-  std::ofstream cache_file(cache_file_name_, std::ios_base::binary | std::ios_base::out);
-  unsigned int position_size = 3 * sizeof(tf2Scalar);
-  unsigned int orientation_size = 4 * sizeof(tf2Scalar);
-  unsigned int pose_size = position_size + orientation_size;
-  unsigned int num_tips = ik_cache_[0].first.size();
-  unsigned int config_size = ik_cache_[0].second.size() * sizeof(double);
-  unsigned int offset_conf = num_tips * pose_size;
-  unsigned int bufsize = offset_conf + config_size;
-  char* buffer = new char[bufsize];
-
-  // write number of IK entries and size of each configuration first
+  // The saved index must cover all saved entries. Writers hold lock_, so the
+  // index can't change again once the exclusive lock is released and queries
+  // can continue while the file is written.
+  {
+    std::unique_lock<std::shared_mutex> nn_lock(nn_lock_);
+    mergeStagedEntries();
+  }
+  std::shared_lock<std::shared_mutex> nn_lock(nn_lock_);
+
+  CacheFileHeader header;
+  memcpy(header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+  header.version = CACHE_FILE_VERSION;
+  header.scalar_size = sizeof(tf2Scalar);
+  header.num_entries = ik_cache_.size();
+  header.num_dofs = ik_cache_[0].second.size();
+  header.num_tips = ik_cache_[0].first.size();
+  const std::size_t config_size = header.num_dofs * sizeof(double);
+  const std::size_t offset_conf = header.num_tips * POSE_SIZE;
+  header.index_offset = sizeof(header) + header.num_entries * (offset_conf + config_size);
   last_saved_cache_size_ = ik_cache_.size();
-  cache_file.write(reinterpret_cast<char*>(&last_saved_cache_size_), sizeof(unsigned int));
-  unsigned int sz = ik_cache_[0].second.size();
-  cache_file.write(reinterpret_cast<char*>(&sz), sizeof(unsigned int));
-  cache_file.write(reinterpret_cast<char*>(&num_tips), sizeof(unsigned int));
+
+  // Write to a temporary file and rename it, so that other processes that have
+  // the old file mapped keep a consistent view and never see a partial file.
+  std::filesystem::path tmp_file_name(cache_file_name_);
+  tmp_file_name += ".tmp" + std::to_string(moveit::core::processId());
+  std::ofstream cache_file(tmp_file_name, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+  cache_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  std::vector<char> buffer(offset_conf + config_size);
   for (const auto& entry : ik_cache_)
   {
-    for (unsigned int i = 0; i < num_tips; ++i)
+    for (unsigned int i = 0; i < header.num_tips; ++i)
     {
-      memcpy(buffer + i * pose_size, &entry.first[i].position[0], position_size);
-      memcpy(buffer + i * pose_size + position_size, &entry.first[i].orientation[0], orientation_size);
+      memcpy(buffer.data() + i * POSE_SIZE, &entry.first[i].position[0], POSITION_SIZE);
+      memcpy(buffer.data() + i * POSE_SIZE + POSITION_SIZE, &entry.first[i].orientation[0], ORIENTATION_SIZE);
     }
-    memcpy(buffer + offset_conf, &entry.second[0], config_size);
-    cache_file.write(buffer, bufsize);
+    memcpy(buffer.data() + offset_conf, entry.second.data(), config_size);
+    cache_file.write(buffer.data(), buffer.size());
+  }
+
+  const IKEntry* first_entry = ik_cache_.data();
+  if (ik_nn_.serialize(cache_file, [first_entry](IKEntry* const& entry) {
+        return static_cast<std::uint32_t>(entry - first_entry);
+      }))
+  {
+    header.index_size = static_cast<std::uint64_t>(cache_file.tellp()) - header.index_offset;
+  }
+  else
+  {
+    // the index is rebuilt when the cache is loaded
+    header.index_size = 0;
+  }
+  cache_file.seekp(0);
+  cache_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  cache_file.close();
+
+  std::error_code ec;
+  if (!cache_file)
+    RCLCPP_ERROR(LOGGER, "failed to write IK cache to %s", tmp_file_name.string().c_str());
+  else
+    std::filesystem::rename(tmp_file_name, cache_file_name_, ec);
+  if (!cache_file || ec)
+  {
+    if (ec)
+      RCLCPP_ERROR(LOGGER, "failed to replace %s: %s", cache_file_name_.string().c_str(), ec.message().c_str());
+    std::filesystem::remove(tmp_file_name, ec);
   }
-  delete[] buffer;
 }
 
 void IKCache::verifyCache(kdl_kinematics_plugin::KDLKinematicsPlugin& fk) const
@@ -188,7 +188,13 @@ def create_parameter_dict():
                 "default_value": "",
                 "type": "string",
                 "description": "prefix added to tip- and baseframe to allow different namespaces or multi-robot setups",
-            }
+            },
+            "batch_free_joint_search": {
+                "default_value": False,
+                "type": "bool",
+                "description": "solve the whole free joint discretization in one sweep in searchPositionIK and apply the "
+                "solution callback to the solutions in the order of their distance to the seed",
+            },
         }
     }
     return parameter_dict
@@ -224,16 +224,15 @@ public:
   /**
    * @brief Given a desired pose of the end-effector, compute the set joint angles solutions that are able to reach it.
    *
-   * This is a default implementation that returns only one solution and so its result is equivalent to calling
-   * 'getPositionIK(...)' with a zero initialized seed.
+   * All analytic solutions within the joint limits are returned, for every sampled value of the free joint, sorted by
+   * their distance to the seed state. The free joint values are solved in a single sweep.
    *
    * @param ik_poses  The desired pose of each tip link
    * @param ik_seed_state an initial guess solution for the inverse kinematics
    * @param solutions A vector of vectors where each entry is a valid joint solution
    * @param result A struct that reports the results of the query
-   * @param options An option struct which contains the type of redundancy discretization used. This default
-   *                implementation only supports the KinmaticSearches::NO_DISCRETIZATION method; requesting any
-   *                other will result in failure.
+   * @param options An option struct which contains the type of redundancy discretization used: NO_DISCRETIZATION
+   *                (the free joint keeps its seed value), ALL_DISCRETIZED or ALL_RANDOM_SAMPLED.
    * @return True if a valid set of solutions was found, false otherwise.
    */
   bool getPositionIK(const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<double>& ik_seed_state,
@@ -347,6 +346,18 @@ private:
   void getSolution(const IkSolutionList<IkReal>& solutions, const std::vector<double>& ik_seed_state, int i,
                    std::vector<double>& solution) const;
 
+  /**
+   * @brief Solve for every value of the free joint and collect the solutions within the joint limits
+   * @param pose_frame The pose in the solver frame
+   * @param free_values The values of the free joint to solve for, or empty if the solver has no free joint
+   * @param ik_seed_state The seed the solutions are moved close to, see getSolution()
+   * @param max_joint_cost If true, the cost of a solution is its largest joint motion from the seed instead of the sum
+   * @param solutions The solutions, sorted by increasing cost
+   */
+  void solveBatch(KDL::Frame& pose_frame, const std::vector<double>& free_values,
+                  const std::vector<double>& ik_seed_state, bool max_joint_cost,
+                  std::vector<LimitObeyingSol>& solutions) const;
+
   /**
    * @brief If the value is outside of min/max then it tries to +/- 2 * pi to put the value into the range
    */
@@ -705,6 +716,47 @@ void IKFastKinematicsPlugin::getSolution(const IkSolutionList<IkReal>& solutions
   }
 }
 
+void IKFastKinematicsPlugin::solveBatch(KDL::Frame& pose_frame, const std::vector<double>& free_values,
+                                        const std::vector<double>& ik_seed_state, bool max_joint_cost,
+                                        std::vector<LimitObeyingSol>& solutions) const
+{
+  solutions.clear();
+
+  // the solution list and free joint vector are reused for all free joint values
+  IkSolutionList<IkReal> ik_solutions;
+  std::vector<double> vfree(free_values.empty() ? 0 : 1);
+  std::vector<double> sol;
+  const std::size_t num_free_values = std::max<std::size_t>(free_values.size(), 1);
+  for (std::size_t f = 0; f < num_free_values; ++f)
+  {
+    if (!free_values.empty())
+      vfree[0] = free_values[f];
+    const size_t numsol = solve(pose_frame, vfree, ik_solutions);
+    for (size_t s = 0; s < numsol; ++s)
+    {
+      getSolution(ik_solutions, ik_seed_state, s, sol);
+
+      bool obeys_limits = true;
+      double cost = 0.0;
+      for (std::size_t i = 0; i < sol.size() && obeys_limits; ++i)
+      {
+        // Add tolerance to limit check
+        obeys_limits = !joint_has_limits_vector_[i] || ((sol[i] >= (joint_min_vector_[i] - LIMIT_TOLERANCE)) &&
+                                                        (sol[i] <= (joint_max_vector_[i] + LIMIT_TOLERANCE)));
+        const double distance = fabs(ik_seed_state[i] - sol[i]);
+        cost = max_joint_cost ? std::max(cost, distance) : cost + distance;
+      }
+      if (obeys_limits)
+        solutions.push_back({ sol, cost });
+    }
+  }
+  RCLCPP_DEBUG_STREAM(LOGGER, "Found " << solutions.size() << " solutions within limits for " << num_free_values
+                                       << " free joint values");
+
+  // keep the order of the free joint values for solutions with equal costs
+  std::stable_sort(solutions.begin(), solutions.end());
+}
+
 double IKFastKinematicsPlugin::enforceLimits(double joint_value, double min, double max) const
 {
   // If the joint_value is greater than max subtract 2 * PI until it is less than the max
@@ -987,6 +1039,35 @@ bool IKFastKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik
   if ((search_mode & OPTIMIZE_MAX_JOINT) && (num_positive_increments + num_negative_increments) > 1000)
     RCLCPP_WARN_STREAM_ONCE(LOGGER, "Large search space, consider increasing the search discretization");
 
+  if (params_.batch_free_joint_search)
+  {
+    // Solve the whole discretization at once, in the order of the sequential search, and apply the callback to the
+    // solutions from the cheapest to the most expensive one
+    std::vector<double> free_values(1, initial_guess);
+    while (getCount(counter, num_positive_increments, -num_negative_increments))
+      free_values.push_back(initial_guess + search_discretization * counter);
+
+    std::vector<LimitObeyingSol> solutions;
+    solveBatch(frame, free_values, ik_seed_state, search_mode & OPTIMIZE_MAX_JOINT, solutions);
+    for (const LimitObeyingSol& candidate : solutions)
+    {
+      if (solution_callback)
+      {
+        solution_callback(ik_pose, candidate.value, error_code);
+        if (error_code.val != error_code.SUCCESS)
+          continue;
+      }
+      solution = candidate.value;
+      error_code.val = error_code.SUCCESS;
+      return true;
+    }
+
+    RCLCPP_DEBUG_STREAM(LOGGER, "None of the " << solutions.size() << " solutions for " << free_values.size()
+                                               << " free joint values is valid");
+    error_code.val = moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION;
+    return false;
+  }
+
   double best_costs = -1.0;
   std::vector<double> best_solution;
   int nattempts = 0, nvalid = 0;
@@ -1232,11 +1313,6 @@ bool IKFastKinematicsPlugin::getPositionIK(const std::vector<geometry_msgs::msg:
   KDL::Frame frame;
   transformToChainFrame(ik_poses[0], frame);
 
-  // solving ik
-  std::vector<IkSolutionList<IkReal>> solution_set;
-  IkSolutionList<IkReal> ik_solutions;
-  std::vector<double> vfree;
-  int numsol = 0;
   std::vector<double> sampled_joint_vals;
   if (!redundant_joint_indices_.empty())
   {
@@ -1259,81 +1335,29 @@ bool IKFastKinematicsPlugin::getPositionIK(const std::vector<geometry_msgs::msg:
       }
     }
 
-    // computing all solutions sets for each sampled value of the redundant joint
+    // sampling all values of the redundant joint to solve for
     if (!sampleRedundantJoint(options.discretization_method, sampled_joint_vals))
     {
       result.kinematic_error = kinematics::KinematicErrors::UNSUPORTED_DISCRETIZATION_REQUESTED;
       return false;
     }
-
-    for (unsigned int i = 0; i < sampled_joint_vals.size(); ++i)
-    {
-      vfree.clear();
-      vfree.push_back(sampled_joint_vals[i]);
-      numsol += solve(frame, vfree, ik_solutions);
-      solution_set.push_back(ik_solutions);
-    }
-  }
-  else
-  {
-    // computing for single solution set
-    numsol = solve(frame, vfree, ik_solutions);
-    solution_set.push_back(ik_solutions);
   }
 
-  RCLCPP_DEBUG_STREAM(LOGGER, "Found " << numsol << " solutions from IKFast");
-  bool solutions_found = false;
-  if (numsol > 0)
-  {
-    /*
-      Iterating through all solution sets and storing those that do not exceed joint limits.
-    */
-    for (unsigned int r = 0; r < solution_set.size(); ++r)
-    {
-      ik_solutions = solution_set[r];
-      numsol = ik_solutions.GetNumSolutions();
-      for (int s = 0; s < numsol; ++s)
-      {
-        std::vector<double> sol;
-        getSolution(ik_solutions, ik_seed_state, s, sol);
-
-        bool obeys_limits = true;
-        for (unsigned int i = 0; i < sol.size(); ++i)
-        {
-          // Add tolerance to limit check
-          if (joint_has_limits_vector_[i] && ((sol[i] < (joint_min_vector_[i] - LIMIT_TOLERANCE)) ||
-                                              (sol[i] > (joint_max_vector_[i] + LIMIT_TOLERANCE))))
-          {
-            // One element of solution is not within limits
-            obeys_limits = false;
-            RCLCPP_DEBUG_STREAM(LOGGER, "Not in limits! "
-                                            << i << " value " << sol[i] << " has limit: " << joint_has_limits_vector_[i]
-                                            << "  being  " << joint_min_vector_[i] << " to " << joint_max_vector_[i]);
-            break;
-          }
-        }
-        if (obeys_limits)
-        {
-          // All elements of solution obey limits
-          solutions_found = true;
-          solutions.push_back(sol);
-        }
-      }
-    }
-
-    if (solutions_found)
-    {
-      result.kinematic_error = kinematics::KinematicErrors::OK;
-      return true;
-    }
-  }
-  else
+  // solving ik for all sampled values in one sweep, keeping the solutions within the joint limits
+  std::vector<LimitObeyingSol> solutions_obey_limits;
+  solveBatch(frame, sampled_joint_vals, ik_seed_state, false, solutions_obey_limits);
+  if (solutions_obey_limits.empty())
   {
     RCLCPP_DEBUG_STREAM(LOGGER, "No IK solution");
+    result.kinematic_error = kinematics::KinematicErrors::NO_SOLUTION;
+    return false;
   }
 
-  result.kinematic_error = kinematics::KinematicErrors::NO_SOLUTION;
-  return false;
+  solutions.reserve(solutions.size() + solutions_obey_limits.size());
+  for (LimitObeyingSol& sol : solutions_obey_limits)
+    solutions.push_back(std::move(sol.value));
+  result.kinematic_error = kinematics::KinematicErrors::OK;
+  return true;
 }
 
 bool IKFastKinematicsPlugin::sampleRedundantJoint(kinematics::DiscretizationMethod method,
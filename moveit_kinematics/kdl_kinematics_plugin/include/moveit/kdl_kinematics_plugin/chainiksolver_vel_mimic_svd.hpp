@@ -95,6 +95,9 @@ public:
 private:
   bool jacToJacReduced(const Jacobian& jac, Jacobian& jac_reduced);
 
+  /// Compute qdot = svd_^# * v like svd_.solve(v), but without allocating temporaries
+  void solve(const Eigen::Ref<const Eigen::VectorXd>& v, Eigen::VectorXd& qdot);
+
   // Mimic joint specific
   const std::vector<kdl_kinematics_plugin::JointMimic>& mimic_joints_;
   int num_mimic_joints_;
@@ -104,6 +107,7 @@ private:
 
   Eigen::JacobiSVD<Eigen::MatrixXd> svd_;
   Eigen::VectorXd qdot_out_reduced_;
+  Eigen::VectorXd svd_tmp_;  // U^T * v, for solve()
 
   Jacobian jac_;          // full Jacobian
   Jacobian jac_reduced_;  // reduced Jacobian with contributions of mimic joints mapped onto active DoFs
@@ -108,6 +108,12 @@ public:
       const IKCallbackFn& solution_callback, moveit_msgs::msg::MoveItErrorCodes& error_code,
       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
 
+  std::size_t searchPositionIKBatch(
+      const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+      double timeout, std::vector<std::vector<double>>& solutions,
+      std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
   bool getPositionFK(const std::vector<std::string>& link_names, const std::vector<double>& joint_angles,
                      std::vector<geometry_msgs::msg::Pose>& poses) const override;
 
@@ -134,7 +140,26 @@ protected:
                 KDL::JntArray& q_out, const unsigned int max_iter, const Eigen::VectorXd& joint_weights,
                 const Twist& cartesian_weights) const;
 
+  /// Solve position IK given initial joint values, using the given forward kinematics solver
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  int CartToJnt(KDL::ChainFkSolverPos& fk_solver, KDL::ChainIkSolverVelMimicSVD& ik_solver,
+                const KDL::JntArray& q_init, const KDL::Frame& p_in, KDL::JntArray& q_out, const unsigned int max_iter,
+                const Eigen::VectorXd& joint_weights, const Twist& cartesian_weights) const;
+
 private:
+  struct CartToJntBuffers;
+  struct SolverWorkspace;
+
+  /** @brief Get the solver objects and buffers of the calling thread for this plugin instance. They are allocated on
+   *  the first query of each thread (and for the initializing thread in initialize()) and reused by later queries. */
+  SolverWorkspace& getThreadWorkspace() const;
+
+  /// Implementation of CartToJnt() on preallocated buffers
+  int solveCartToJnt(KDL::ChainFkSolverPos& fk_solver, KDL::ChainIkSolverVelMimicSVD& ik_solver,
+                     const KDL::JntArray& q_init, const KDL::Frame& p_in, KDL::JntArray& q_out,
+                     const unsigned int max_iter, const Eigen::VectorXd& joint_weights, const Twist& cartesian_weights,
+                     CartToJntBuffers& buffers) const;
+
   void getJointWeights();
   bool timedOut(const rclcpp::Time& start_time, double duration) const;
 
@@ -147,15 +172,25 @@ private:
   bool checkConsistency(const Eigen::VectorXd& seed_state, const std::vector<double>& consistency_limits,
                         const Eigen::VectorXd& solution) const;
 
-  void getRandomConfiguration(Eigen::VectorXd& jnt_array) const;
+  void getRandomConfiguration(moveit::core::RobotState& state, Eigen::VectorXd& jnt_array) const;
 
   /** @brief Get a random configuration within consistency limits close to the seed state
+   *  @param state RobotState providing the random number generator
    *  @param seed_state Seed state
    *  @param consistency_limits
    *  @param jnt_array Returned random configuration
    */
-  void getRandomConfiguration(const Eigen::VectorXd& seed_state, const std::vector<double>& consistency_limits,
-                              Eigen::VectorXd& jnt_array) const;
+  void getRandomConfiguration(moveit::core::RobotState& state, const Eigen::VectorXd& seed_state,
+                              const std::vector<double>& consistency_limits, Eigen::VectorXd& jnt_array) const;
+
+  /** @brief Implementation of searchPositionIK() on the given solver workspace, so that
+   *  several queries can run concurrently on separate workspaces.
+   */
+  bool solvePositionIK(SolverWorkspace& workspace, const geometry_msgs::msg::Pose& ik_pose,
+                       const std::vector<double>& ik_seed_state, double timeout,
+                       const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                       const IKCallbackFn& solution_callback, moveit_msgs::msg::MoveItErrorCodes& error_code,
+                       const kinematics::KinematicsQueryOptions& options) const;
 
   /// clip q_delta such that joint limits will not be violated
   void clipToJointLimits(const KDL::JntArray& q, KDL::JntArray& q_delta, Eigen::ArrayXd& weighting) const;
@@ -172,6 +207,7 @@ private:
   std::vector<JointMimic> mimic_joints_;
   std::vector<double> joint_weights_;
   Eigen::VectorXd joint_min_, joint_max_;  ///< joint limits
+  std::size_t workspace_id_;               ///< Key of this instance in the per-thread solver workspaces
 
   std::shared_ptr<kdl_kinematics::ParamListener> param_listener_;
   kdl_kinematics::Params params_;
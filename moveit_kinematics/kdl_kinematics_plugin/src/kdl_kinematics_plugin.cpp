@@ -45,26 +45,101 @@
 #include <kdl/frames_io.hpp>
 #include <kdl/kinfam_io.hpp>
 
+#include <array>
+#include <atomic>
+
 namespace kdl_kinematics_plugin
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_kdl_kinematics_plugin.kdl_kinematics_plugin");
 static rclcpp::Clock steady_clock = rclcpp::Clock(RCL_ROS_TIME);
 
-KDLKinematicsPlugin::KDLKinematicsPlugin() : initialized_(false)
+namespace
+{
+// Number of plugin instances a thread keeps a solver workspace for
+constexpr std::size_t WORKSPACE_CACHE_SIZE = 8;
+
+// 0 is reserved for unused cache entries
+std::atomic<std::size_t> next_workspace_id{ 1 };
+}  // namespace
+
+// Buffers of the iterations in CartToJnt()
+struct KDLKinematicsPlugin::CartToJntBuffers
+{
+  CartToJntBuffers(unsigned int dimension, Eigen::Index num_weights)
+    : delta_q(dimension), q_backup(dimension), extra_joint_weights(num_weights), weights(num_weights)
+  {
+  }
+  KDL::JntArray delta_q;
+  KDL::JntArray q_backup;
+  Eigen::ArrayXd extra_joint_weights;
+  Eigen::VectorXd weights;
+};
+
+// Solver objects and buffers of one thread, allocated once and reused by all its queries
+struct KDLKinematicsPlugin::SolverWorkspace
+{
+  SolverWorkspace(const KDLKinematicsPlugin& plugin, bool position_ik)
+    : fk_solver(plugin.kdl_chain_)
+    , ik_solver_vel(plugin.kdl_chain_, plugin.mimic_joints_, position_ik)
+    , sampling_state(*plugin.state_)
+    , jnt_seed_state(plugin.dimension_)
+    , jnt_pos_in(plugin.dimension_)
+    , jnt_pos_out(plugin.dimension_)
+    , buffers(plugin.dimension_, static_cast<Eigen::Index>(plugin.joint_weights_.size()))
+  {
+    consistency_limits_mimic.reserve(plugin.dimension_);
+  }
+  KDL::ChainFkSolverPos_recursive fk_solver;
+  KDL::ChainIkSolverVelMimicSVD ik_solver_vel;
+  // random restarts are sampled from a per-thread state
+  moveit::core::RobotState sampling_state;
+  KDL::JntArray jnt_seed_state;
+  KDL::JntArray jnt_pos_in;
+  KDL::JntArray jnt_pos_out;
+  std::vector<double> consistency_limits_mimic;
+  CartToJntBuffers buffers;
+};
+
+KDLKinematicsPlugin::KDLKinematicsPlugin() : initialized_(false), workspace_id_(0)
 {
 }
 
-void KDLKinematicsPlugin::getRandomConfiguration(Eigen::VectorXd& jnt_array) const
+KDLKinematicsPlugin::SolverWorkspace& KDLKinematicsPlugin::getThreadWorkspace() const
 {
-  state_->setToRandomPositions(joint_model_group_);
-  state_->copyJointGroupPositions(joint_model_group_, &jnt_array[0]);
+  struct CachedWorkspace
+  {
+    // workspace_id_ of the plugin the workspace belongs to, 0 if unused
+    std::size_t plugin_id = 0;
+    std::unique_ptr<SolverWorkspace> workspace;
+  };
+  thread_local std::array<CachedWorkspace, WORKSPACE_CACHE_SIZE> cache;
+  thread_local std::size_t cache_next = 0;
+
+  for (CachedWorkspace& entry : cache)
+  {
+    if (entry.plugin_id == workspace_id_)
+      return *entry.workspace;
+  }
+
+  CachedWorkspace& entry = cache[cache_next];
+  cache_next = (cache_next + 1) % cache.size();
+  const bool position_ik = params_.position_only_ik || params_.orientation_vs_position == 0.0;
+  entry.workspace = std::make_unique<SolverWorkspace>(*this, position_ik);
+  entry.plugin_id = workspace_id_;
+  return *entry.workspace;
 }
 
-void KDLKinematicsPlugin::getRandomConfiguration(const Eigen::VectorXd& seed_state,
+void KDLKinematicsPlugin::getRandomConfiguration(moveit::core::RobotState& state, Eigen::VectorXd& jnt_array) const
+{
+  state.setToRandomPositions(joint_model_group_);
+  state.copyJointGroupPositions(joint_model_group_, &jnt_array[0]);
+}
+
+void KDLKinematicsPlugin::getRandomConfiguration(moveit::core::RobotState& state, const Eigen::VectorXd& seed_state,
                                                  const std::vector<double>& consistency_limits,
                                                  Eigen::VectorXd& jnt_array) const
 {
-  joint_model_group_->getVariableRandomPositionsNearBy(state_->getRandomNumberGenerator(), &jnt_array[0],
+  joint_model_group_->getVariableRandomPositionsNearBy(state.getRandomNumberGenerator(), &jnt_array[0],
                                                        &seed_state[0], consistency_limits);
 }
 
@@ -232,6 +307,10 @@ bool KDLKinematicsPlugin::initialize(const rclcpp::Node::SharedPtr& node, const
 
   fk_solver_ = std::make_unique<KDL::ChainFkSolverPos_recursive>(kdl_chain_);
 
+  // a new key, so that threads do not reuse workspaces of an earlier initialization
+  workspace_id_ = next_workspace_id.fetch_add(1, std::memory_order_relaxed);
+  getThreadWorkspace();
+
   initialized_ = true;
   RCLCPP_DEBUG(LOGGER, "KDL solver initialized");
   return true;
@@ -294,7 +373,6 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
                                            moveit_msgs::msg::MoveItErrorCodes& error_code,
                                            const kinematics::KinematicsQueryOptions& options) const
 {
-  const rclcpp::Time start_time = steady_clock.now();
   if (!initialized_)
   {
     RCLCPP_ERROR(LOGGER, "kinematics solver not initialized");
@@ -302,6 +380,56 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
     return false;
   }
 
+  return solvePositionIK(getThreadWorkspace(), ik_pose, ik_seed_state, timeout, consistency_limits, solution,
+                         solution_callback, error_code, options);
+}
+
+std::size_t KDLKinematicsPlugin::searchPositionIKBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                                       const std::vector<std::vector<double>>& ik_seed_states,
+                                                       double timeout, std::vector<std::vector<double>>& solutions,
+                                                       std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                                                       const kinematics::KinematicsQueryOptions& options) const
+{
+  const std::size_t num_queries = prepareBatch(ik_poses, ik_seed_states, solutions, error_codes);
+  if (num_queries == 0)
+    return 0;
+  if (!initialized_)
+  {
+    RCLCPP_ERROR(LOGGER, "kinematics solver not initialized");
+    for (auto& error_code : error_codes)
+      error_code.val = error_code.NO_IK_SOLUTION;
+    return 0;
+  }
+
+  // Each worker reuses one workspace for all of its queries. The worker threads only live for this call, so they
+  // use their own workspaces instead of the per-thread cache, except for the calling thread (worker 0).
+  const bool position_ik = params_.position_only_ik || params_.orientation_vs_position == 0.0;
+  const std::size_t num_workers = batchWorkerCount(num_queries);
+  std::vector<std::unique_ptr<SolverWorkspace>> workspaces(num_workers);
+  std::atomic<std::size_t> num_solved{ 0 };
+  const std::vector<double> no_consistency_limits;
+  forEachQuery(num_queries, num_workers, [&](std::size_t worker, std::size_t query) {
+    if (worker > 0 && !workspaces[worker])
+      workspaces[worker] = std::make_unique<SolverWorkspace>(*this, position_ik);
+    SolverWorkspace& workspace = worker > 0 ? *workspaces[worker] : getThreadWorkspace();
+    if (solvePositionIK(workspace, ik_poses[ik_poses.size() == 1 ? 0 : query],
+                        ik_seed_states[ik_seed_states.size() == 1 ? 0 : query], timeout, no_consistency_limits,
+                        solutions[query], IKCallbackFn(), error_codes[query], options))
+      ++num_solved;
+    else
+      solutions[query].clear();
+  });
+  return num_solved;
+}
+
+bool KDLKinematicsPlugin::solvePositionIK(SolverWorkspace& workspace, const geometry_msgs::msg::Pose& ik_pose,
+                                          const std::vector<double>& ik_seed_state, double timeout,
+                                          const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                                          const IKCallbackFn& solution_callback,
+                                          moveit_msgs::msg::MoveItErrorCodes& error_code,
+                                          const kinematics::KinematicsQueryOptions& options) const
+{
+  const rclcpp::Time start_time = steady_clock.now();
   if (ik_seed_state.size() != dimension_)
   {
     RCLCPP_ERROR(LOGGER, "Seed state must have size %d instead of size %zu\n", dimension_, ik_seed_state.size());
@@ -310,7 +438,8 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
   }
 
   // Resize consistency limits to remove mimic joints
-  std::vector<double> consistency_limits_mimic;
+  std::vector<double>& consistency_limits_mimic = workspace.consistency_limits_mimic;
+  consistency_limits_mimic.clear();
   if (!consistency_limits.empty())
   {
     if (consistency_limits.size() != dimension_)
@@ -336,13 +465,12 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
   cartesian_weights.topRows<3>().setConstant(1.0);
   cartesian_weights.bottomRows<3>().setConstant(orientation_vs_position_weight);
 
-  KDL::JntArray jnt_seed_state(dimension_);
-  KDL::JntArray jnt_pos_in(dimension_);
-  KDL::JntArray jnt_pos_out(dimension_);
+  KDL::JntArray& jnt_seed_state = workspace.jnt_seed_state;
+  KDL::JntArray& jnt_pos_in = workspace.jnt_pos_in;
+  KDL::JntArray& jnt_pos_out = workspace.jnt_pos_out;
   jnt_seed_state.data = Eigen::Map<const Eigen::VectorXd>(ik_seed_state.data(), ik_seed_state.size());
   jnt_pos_in = jnt_seed_state;
 
-  KDL::ChainIkSolverVelMimicSVD ik_solver_vel(kdl_chain_, mimic_joints_, orientation_vs_position_weight == 0.0);
   solution.resize(dimension_);
 
   KDL::Frame pose_desired;
@@ -361,18 +489,20 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
     {
       if (!consistency_limits_mimic.empty())
       {
-        getRandomConfiguration(jnt_seed_state.data, consistency_limits_mimic, jnt_pos_in.data);
+        getRandomConfiguration(workspace.sampling_state, jnt_seed_state.data, consistency_limits_mimic,
+                               jnt_pos_in.data);
       }
       else
       {
-        getRandomConfiguration(jnt_pos_in.data);
+        getRandomConfiguration(workspace.sampling_state, jnt_pos_in.data);
       }
       RCLCPP_DEBUG_STREAM(LOGGER, "New random configuration (" << attempt << "): " << jnt_pos_in);
     }
 
-    int ik_valid =
-        CartToJnt(ik_solver_vel, jnt_pos_in, pose_desired, jnt_pos_out, params_.max_solver_iterations,
-                  Eigen::Map<const Eigen::VectorXd>(joint_weights_.data(), joint_weights_.size()), cartesian_weights);
+    int ik_valid = solveCartToJnt(workspace.fk_solver, workspace.ik_solver_vel, jnt_pos_in, pose_desired, jnt_pos_out,
+                                  params_.max_solver_iterations,
+                                  Eigen::Map<const Eigen::VectorXd>(joint_weights_.data(), joint_weights_.size()),
+                                  cartesian_weights, workspace.buffers);
     if (ik_valid == 0 || options.return_approximate_solution)  // found acceptable solution
     {
       if (!consistency_limits_mimic.empty() &&
@@ -405,13 +535,32 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
 int KDLKinematicsPlugin::CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, const KDL::JntArray& q_init,
                                    const KDL::Frame& p_in, KDL::JntArray& q_out, const unsigned int max_iter,
                                    const Eigen::VectorXd& joint_weights, const Twist& cartesian_weights) const
+{
+  return CartToJnt(*fk_solver_, ik_solver, q_init, p_in, q_out, max_iter, joint_weights, cartesian_weights);
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+int KDLKinematicsPlugin::CartToJnt(KDL::ChainFkSolverPos& fk_solver, KDL::ChainIkSolverVelMimicSVD& ik_solver,
+                                   const KDL::JntArray& q_init, const KDL::Frame& p_in, KDL::JntArray& q_out,
+                                   const unsigned int max_iter, const Eigen::VectorXd& joint_weights,
+                                   const Twist& cartesian_weights) const
+{
+  CartToJntBuffers buffers(q_out.rows(), joint_weights.rows());
+  return solveCartToJnt(fk_solver, ik_solver, q_init, p_in, q_out, max_iter, joint_weights, cartesian_weights, buffers);
+}
+
+int KDLKinematicsPlugin::solveCartToJnt(KDL::ChainFkSolverPos& fk_solver, KDL::ChainIkSolverVelMimicSVD& ik_solver,
+                                        const KDL::JntArray& q_init, const KDL::Frame& p_in, KDL::JntArray& q_out,
+                                        const unsigned int max_iter, const Eigen::VectorXd& joint_weights,
+                                        const Twist& cartesian_weights, CartToJntBuffers& buffers) const
 {
   double last_delta_twist_norm = DBL_MAX;
   double step_size = 1.0;
   KDL::Frame f;
   KDL::Twist delta_twist;
-  KDL::JntArray delta_q(q_out.rows()), q_backup(q_out.rows());
-  Eigen::ArrayXd extra_joint_weights(joint_weights.rows());
+  KDL::JntArray& delta_q = buffers.delta_q;
+  KDL::JntArray& q_backup = buffers.q_backup;
+  Eigen::ArrayXd& extra_joint_weights = buffers.extra_joint_weights;
   extra_joint_weights.setOnes();
 
   q_out = q_init;
@@ -421,7 +570,7 @@ int KDLKinematicsPlugin::CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, con
   bool success = false;
   for (i = 0; i < max_iter; ++i)
   {
-    fk_solver_->JntToCart(q_out, f);
+    fk_solver.JntToCart(q_out, f);
     delta_twist = diff(f, p_in);
     RCLCPP_DEBUG_STREAM(LOGGER, "[" << std::setw(3) << i << "] delta_twist: " << delta_twist);
 
@@ -451,7 +600,8 @@ int KDLKinematicsPlugin::CartToJnt(KDL::ChainIkSolverVelMimicSVD& ik_solver, con
       step_size = 1.0;   // reset step size
       last_delta_twist_norm = delta_twist_norm;
 
-      ik_solver.CartToJnt(q_out, delta_twist, delta_q, extra_joint_weights * joint_weights.array(), cartesian_weights);
+      buffers.weights = extra_joint_weights * joint_weights.array();
+      ik_solver.CartToJnt(q_out, delta_twist, delta_q, buffers.weights, cartesian_weights);
     }
 
     clipToJointLimits(q_out, delta_q, extra_joint_weights);
@@ -58,6 +58,11 @@
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
 
+namespace KDL
+{
+class ChainIkSolverPos_LMA;
+}
+
 namespace lma_kinematics_plugin
 {
 /**
@@ -100,6 +105,12 @@ public:
       const IKCallbackFn& solution_callback, moveit_msgs::msg::MoveItErrorCodes& error_code,
       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
 
+  std::size_t searchPositionIKBatch(
+      const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+      double timeout, std::vector<std::vector<double>>& solutions,
+      std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
   bool getPositionFK(const std::vector<std::string>& link_names, const std::vector<double>& joint_angles,
                      std::vector<geometry_msgs::msg::Pose>& poses) const override;
 
@@ -133,15 +144,29 @@ private:
   /** Harmonize revolute joint values into the range -2 Pi .. 2 Pi */
   void harmonize(Eigen::VectorXd& values) const;
 
-  void getRandomConfiguration(Eigen::VectorXd& jnt_array) const;
+  void getRandomConfiguration(moveit::core::RobotState& state, Eigen::VectorXd& jnt_array) const;
 
   /** @brief Get a random configuration within consistency limits close to the seed state
+   *  @param state RobotState providing the random number generator
    *  @param seed_state Seed state
    *  @param consistency_limits
    *  @param jnt_array Returned random configuration
    */
-  void getRandomConfiguration(const Eigen::VectorXd& seed_state, const std::vector<double>& consistency_limits,
-                              Eigen::VectorXd& jnt_array) const;
+  void getRandomConfiguration(moveit::core::RobotState& state, const Eigen::VectorXd& seed_state,
+                              const std::vector<double>& consistency_limits, Eigen::VectorXd& jnt_array) const;
+
+  /** @brief Implementation of searchPositionIK() on the given solver objects, so that
+   *  several queries can run concurrently on separate objects.
+   *  @param sampling_state RobotState used to sample random restarts
+   */
+  bool solvePositionIK(KDL::ChainIkSolverPos_LMA& ik_solver_pos, moveit::core::RobotState& sampling_state,
+                       const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                       double timeout, const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                       const IKCallbackFn& solution_callback, moveit_msgs::msg::MoveItErrorCodes& error_code,
+                       const kinematics::KinematicsQueryOptions& options) const;
+
+  /** Weights of the Cartesian error components used by the LMA solver */
+  Eigen::Matrix<double, 6, 1> getCartesianWeights() const;
 
   bool initialized_;  ///< Internal variable that indicates whether solver is configured and ready
 
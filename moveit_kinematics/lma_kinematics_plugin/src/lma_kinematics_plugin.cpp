@@ -43,6 +43,8 @@
 #include <kdl/frames_io.hpp>
 #include <kdl/kinfam_io.hpp>
 
+#include <atomic>
+
 // register as a KinematicsBase implementation
 #include <class_loader/class_loader.hpp>
 CLASS_LOADER_REGISTER_CLASS(lma_kinematics_plugin::LMAKinematicsPlugin, kinematics::KinematicsBase)
@@ -55,17 +57,17 @@ LMAKinematicsPlugin::LMAKinematicsPlugin() : initialized_(false)
 {
 }
 
-void LMAKinematicsPlugin::getRandomConfiguration(Eigen::VectorXd& jnt_array) const
+void LMAKinematicsPlugin::getRandomConfiguration(moveit::core::RobotState& state, Eigen::VectorXd& jnt_array) const
 {
-  state_->setToRandomPositions(joint_model_group_);
-  state_->copyJointGroupPositions(joint_model_group_, &jnt_array[0]);
+  state.setToRandomPositions(joint_model_group_);
+  state.copyJointGroupPositions(joint_model_group_, &jnt_array[0]);
 }
 
-void LMAKinematicsPlugin::getRandomConfiguration(const Eigen::VectorXd& seed_state,
+void LMAKinematicsPlugin::getRandomConfiguration(moveit::core::RobotState& state, const Eigen::VectorXd& seed_state,
                                                  const std::vector<double>& consistency_limits,
                                                  Eigen::VectorXd& jnt_array) const
 {
-  joint_model_group_->getVariableRandomPositionsNearBy(state_->getRandomNumberGenerator(), &jnt_array[0],
+  joint_model_group_->getVariableRandomPositionsNearBy(state.getRandomNumberGenerator(), &jnt_array[0],
                                                        &seed_state[0], consistency_limits);
 }
 
@@ -216,7 +218,6 @@ bool LMAKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
                                            moveit_msgs::msg::MoveItErrorCodes& error_code,
                                            const kinematics::KinematicsQueryOptions& options) const
 {
-  rclcpp::Time start_time = node_->now();
   if (!initialized_)
   {
     RCLCPP_ERROR(LOGGER, "kinematics solver not initialized");
@@ -224,21 +225,67 @@ bool LMAKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
     return false;
   }
 
-  if (ik_seed_state.size() != dimension_)
+  KDL::ChainIkSolverPos_LMA ik_solver_pos(kdl_chain_, getCartesianWeights(), params_.epsilon,
+                                          params_.max_solver_iterations);
+  return solvePositionIK(ik_solver_pos, *state_, ik_pose, ik_seed_state, timeout, consistency_limits, solution,
+                         solution_callback, error_code, options);
+}
+
+namespace
+{
+// Solver objects owned by one thread of searchPositionIKBatch()
+struct BatchWorker
+{
+  BatchWorker(const KDL::Chain& chain, const Eigen::Matrix<double, 6, 1>& cartesian_weights, double epsilon,
+              int max_iterations, const moveit::core::RobotState& state)
+    : ik_solver_pos(chain, cartesian_weights, epsilon, max_iterations), sampling_state(state)
   {
-    RCLCPP_ERROR(LOGGER, "Seed state must have size %d instead of size %zu", dimension_, ik_seed_state.size());
-    error_code.val = error_code.NO_IK_SOLUTION;
-    return false;
   }
-
-  if (!consistency_limits.empty() && consistency_limits.size() != dimension_)
+  KDL::ChainIkSolverPos_LMA ik_solver_pos;
+  moveit::core::RobotState sampling_state;
+};
+}  // namespace
+
+std::size_t LMAKinematicsPlugin::searchPositionIKBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                                       const std::vector<std::vector<double>>& ik_seed_states,
+                                                       double timeout, std::vector<std::vector<double>>& solutions,
+                                                       std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                                                       const kinematics::KinematicsQueryOptions& options) const
+{
+  const std::size_t num_queries = prepareBatch(ik_poses, ik_seed_states, solutions, error_codes);
+  if (num_queries == 0)
+    return 0;
+  if (!initialized_)
   {
-    RCLCPP_ERROR_STREAM(LOGGER, "Consistency limits be empty or must have size " << dimension_ << " instead of size "
-                                                                                 << consistency_limits.size());
-    error_code.val = error_code.NO_IK_SOLUTION;
-    return false;
+    RCLCPP_ERROR(LOGGER, "kinematics solver not initialized");
+    for (auto& error_code : error_codes)
+      error_code.val = error_code.NO_IK_SOLUTION;
+    return 0;
   }
 
+  // ChainIkSolverPos_LMA allocates its Jacobian, SVD and FK buffers on construction, so each thread reuses one for
+  // all of its queries. Random restarts are sampled from a per-thread state instead of the shared state_.
+  const Eigen::Matrix<double, 6, 1> cartesian_weights = getCartesianWeights();
+  const std::size_t num_workers = batchWorkerCount(num_queries);
+  std::vector<std::unique_ptr<BatchWorker>> workers(num_workers);
+  std::atomic<std::size_t> num_solved{ 0 };
+  forEachQuery(num_queries, num_workers, [&](std::size_t worker, std::size_t query) {
+    if (!workers[worker])
+      workers[worker] = std::make_unique<BatchWorker>(kdl_chain_, cartesian_weights, params_.epsilon,
+                                                      params_.max_solver_iterations, *state_);
+    BatchWorker& w = *workers[worker];
+    if (solvePositionIK(w.ik_solver_pos, w.sampling_state, ik_poses[ik_poses.size() == 1 ? 0 : query],
+                        ik_seed_states[ik_seed_states.size() == 1 ? 0 : query], timeout, std::vector<double>(),
+                        solutions[query], IKCallbackFn(), error_codes[query], options))
+      ++num_solved;
+    else
+      solutions[query].clear();
+  });
+  return num_solved;
+}
+
+Eigen::Matrix<double, 6, 1> LMAKinematicsPlugin::getCartesianWeights() const
+{
   const auto orientation_vs_position_weight = params_.position_only_ik ? 0.0 : params_.orientation_vs_position;
   if (orientation_vs_position_weight == 0.0)
     RCLCPP_INFO(LOGGER, "Using position only ik");
@@ -250,6 +297,33 @@ bool LMAKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
   cartesian_weights(3) = orientation_vs_position_weight;
   cartesian_weights(4) = orientation_vs_position_weight;
   cartesian_weights(5) = orientation_vs_position_weight;
+  return cartesian_weights;
+}
+
+bool LMAKinematicsPlugin::solvePositionIK(KDL::ChainIkSolverPos_LMA& ik_solver_pos,
+                                          moveit::core::RobotState& sampling_state,
+                                          const geometry_msgs::msg::Pose& ik_pose,
+                                          const std::vector<double>& ik_seed_state, double timeout,
+                                          const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                                          const IKCallbackFn& solution_callback,
+                                          moveit_msgs::msg::MoveItErrorCodes& error_code,
+                                          const kinematics::KinematicsQueryOptions& options) const
+{
+  rclcpp::Time start_time = node_->now();
+  if (ik_seed_state.size() != dimension_)
+  {
+    RCLCPP_ERROR(LOGGER, "Seed state must have size %d instead of size %zu", dimension_, ik_seed_state.size());
+    error_code.val = error_code.NO_IK_SOLUTION;
+    return false;
+  }
+
+  if (!consistency_limits.empty() && consistency_limits.size() != dimension_)
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Consistency limits be empty or must have size " << dimension_ << " instead of size "
+                                                                                 << consistency_limits.size());
+    error_code.val = error_code.NO_IK_SOLUTION;
+    return false;
+  }
 
   KDL::JntArray jnt_seed_state(dimension_);
   KDL::JntArray jnt_pos_in(dimension_);
@@ -257,7 +331,6 @@ bool LMAKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
   jnt_seed_state.data = Eigen::Map<const Eigen::VectorXd>(ik_seed_state.data(), ik_seed_state.size());
   jnt_pos_in = jnt_seed_state;
 
-  KDL::ChainIkSolverPos_LMA ik_solver_pos(kdl_chain_, cartesian_weights, params_.epsilon, params_.max_solver_iterations);
   solution.resize(dimension_);
 
   KDL::Frame pose_desired;
@@ -275,11 +348,11 @@ bool LMAKinematicsPlugin::searchPositionIK(const geometry_msgs::msg::Pose& ik_po
     {
       if (!consistency_limits.empty())
       {
-        getRandomConfiguration(jnt_seed_state.data, consistency_limits, jnt_pos_in.data);
+        getRandomConfiguration(sampling_state, jnt_seed_state.data, consistency_limits, jnt_pos_in.data);
       }
       else
       {
-        getRandomConfiguration(jnt_pos_in.data);
+        getRandomConfiguration(sampling_state, jnt_pos_in.data);
       }
       RCLCPP_DEBUG_STREAM(LOGGER, "New random configuration (" << attempt << "): " << jnt_pos_in);
     }
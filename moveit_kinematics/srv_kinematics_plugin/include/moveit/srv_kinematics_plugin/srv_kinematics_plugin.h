@@ -47,11 +47,13 @@
 
 // System
 #include <memory>
+#include <thread>
 
 // ROS msgs
 #include <geometry_msgs/msg/pose.hpp>
 #include <moveit_msgs/msg/kinematic_solver_info.hpp>
 #include <moveit_msgs/msg/move_it_error_codes.hpp>
+#include <moveit_msgs/srv/get_position_ik.hpp>
 
 // MoveIt
 #include <moveit/kinematics_base/kinematics_base.h>
@@ -66,11 +68,16 @@ namespace srv_kinematics_plugin
 class SrvKinematicsPlugin : public kinematics::KinematicsBase
 {
 public:
+  /// Future of a pending IK service call, see sendIKRequest()
+  using IKResponseFuture = rclcpp::Client<moveit_msgs::srv::GetPositionIK>::SharedFuture;
+
   /**
    *  @brief Default constructor
    */
   SrvKinematicsPlugin();
 
+  ~SrvKinematicsPlugin() override;
+
   bool
   getPositionIK(const geometry_msgs::msg::Pose& ik_pose, const std::vector<double>& ik_seed_state,
                 std::vector<double>& solution, moveit_msgs::msg::MoveItErrorCodes& error_code,
@@ -105,6 +112,48 @@ public:
                         const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions(),
                         const moveit::core::RobotState* context_state = nullptr) const override;
 
+  /**
+   * @brief Solve a batch of single-tip queries with pipelined service calls: up to max_pending_requests requests are
+   * sent before the first response is awaited, so the batch doesn't wait for one network round trip per query.
+   */
+  std::size_t searchPositionIKBatch(
+      const std::vector<geometry_msgs::msg::Pose>& ik_poses, const std::vector<std::vector<double>>& ik_seed_states,
+      double timeout, std::vector<std::vector<double>>& solutions,
+      std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
+  bool supportsConcurrentQueries() const override
+  {
+    return true;
+  }
+
+  /**
+   * @brief Send an IK request to the service without waiting for the response.
+   *
+   * Any number of requests may be pending at the same time. Their responses are received by an executor thread of
+   * the plugin, so the futures complete no matter how (or whether) the node is spun elsewhere.
+   * @param ik_poses The desired pose of each tip frame
+   * @param ik_seed_state The seed state of the group
+   * @param error_code Set to a failure code if the request could not be sent
+   * @return The future of the response, invalid if the request could not be sent
+   */
+  IKResponseFuture sendIKRequest(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                 const std::vector<double>& ik_seed_state,
+                                 moveit_msgs::msg::MoveItErrorCodes& error_code) const;
+
+  /**
+   * @brief Wait for the response to a request sent with sendIKRequest() and extract the group solution from it
+   * @param future The future returned by sendIKRequest()
+   * @param ik_poses The poses of the request, passed on to the solution callback
+   * @param solution The solution of the group
+   * @param solution_callback If set, the solution is only accepted if the callback reports success
+   * @param error_code The error code of the service or the callback
+   * @return True if a valid solution was received
+   */
+  bool collectIKResponse(const IKResponseFuture& future, const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                         std::vector<double>& solution, const IKCallbackFn& solution_callback,
+                         moveit_msgs::msg::MoveItErrorCodes& error_code) const;
+
   bool getPositionFK(const std::vector<std::string>& link_names, const std::vector<double>& joint_angles,
                      std::vector<geometry_msgs::msg::Pose>& poses) const override;
 
@@ -145,12 +194,18 @@ private:
 
   const moveit::core::JointModelGroup* joint_model_group_;
 
-  moveit::core::RobotStatePtr robot_state_;
+  moveit::core::RobotStatePtr robot_state_;  ///< Default state of the robot, copied to build requests
 
   int num_possible_redundant_joints_;
 
   rclcpp::Client<moveit_msgs::srv::GetPositionIK>::SharedPtr ik_service_client_;
 
+  // The service client lives in its own callback group, spun by a dedicated executor thread, so responses are
+  // received while queries wait on their futures
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
+  rclcpp::executors::SingleThreadedExecutor callback_executor_;
+  std::thread callback_thread_;
+
   rclcpp::Node::SharedPtr node_;
 
   std::shared_ptr<srv_kinematics::ParamListener> param_listener_;
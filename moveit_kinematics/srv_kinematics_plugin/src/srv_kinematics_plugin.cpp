@@ -38,6 +38,7 @@
 #include <moveit/srv_kinematics_plugin/srv_kinematics_plugin.h>
 #include <class_loader/class_loader.hpp>
 #include <moveit/robot_state/conversions.h>
+#include <deque>
 #include <iterator>
 
 // Eigen
@@ -55,6 +56,13 @@ SrvKinematicsPlugin::SrvKinematicsPlugin() : active_(false)
 {
 }
 
+SrvKinematicsPlugin::~SrvKinematicsPlugin()
+{
+  callback_executor_.cancel();
+  if (callback_thread_.joinable())
+    callback_thread_.join();
+}
+
 bool SrvKinematicsPlugin::initialize(const rclcpp::Node::SharedPtr& node, const moveit::core::RobotModel& robot_model,
                                      const std::string& group_name, const std::string& base_frame,
                                      const std::vector<std::string>& tip_frames, double search_discretization)
@@ -116,9 +124,15 @@ bool SrvKinematicsPlugin::initialize(const rclcpp::Node::SharedPtr& node, const
   robot_state_ = std::make_shared<moveit::core::RobotState>(robot_model_);
   robot_state_->setToDefaultValues();
 
-  // Create the ROS2 service client
+  // Create the ROS2 service client. It is spun by our own executor thread, since we have no control over how the node
+  // is executed, and it is kept for the lifetime of the plugin so the connection to the server stays warm.
   RCLCPP_DEBUG(LOGGER, "IK Service client topic : %s", params_.kinematics_solver_service_name.c_str());
-  ik_service_client_ = node_->create_client<moveit_msgs::srv::GetPositionIK>(params_.kinematics_solver_service_name);
+  callback_group_ = node_->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive,
+                                                 false /* don't spin with node executor */);
+  ik_service_client_ = node_->create_client<moveit_msgs::srv::GetPositionIK>(
+      params_.kinematics_solver_service_name, rmw_qos_profile_services_default, callback_group_);
+  callback_executor_.add_callback_group(callback_group_, node_->get_node_base_interface());
+  callback_thread_ = std::thread([this]() { callback_executor_.spin(); });
 
   if (!ik_service_client_->wait_for_service(std::chrono::seconds(1)))
   {  // wait 0.1 seconds, blocking
@@ -271,14 +285,45 @@ bool SrvKinematicsPlugin::searchPositionIK(const std::vector<geometry_msgs::msg:
     return false;
   }
 
+  IKResponseFuture future = sendIKRequest(ik_poses, ik_seed_state, error_code);
+  if (!future.valid())
+    return false;
+  if (!collectIKResponse(future, ik_poses, solution, solution_callback, error_code))
+    return false;
+
+  RCLCPP_INFO(LOGGER, "IK Solver Succeeded!");
+  return true;
+}
+
+SrvKinematicsPlugin::IKResponseFuture
+SrvKinematicsPlugin::sendIKRequest(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                   const std::vector<double>& ik_seed_state,
+                                   moveit_msgs::msg::MoveItErrorCodes& error_code) const
+{
+  if (!active_)
+  {
+    RCLCPP_ERROR(LOGGER, "kinematics not active");
+    error_code.val = error_code.NO_IK_SOLUTION;
+    return IKResponseFuture();
+  }
+  if (ik_seed_state.size() != dimension_ || tip_frames_.size() != ik_poses.size())
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "IK request needs a seed state of size " << dimension_ << " and " << tip_frames_.size()
+                                                                         << " poses, got " << ik_seed_state.size()
+                                                                         << " and " << ik_poses.size());
+    error_code.val = error_code.NO_IK_SOLUTION;
+    return IKResponseFuture();
+  }
+
   // Create the service message
   auto ik_srv = std::make_shared<moveit_msgs::srv::GetPositionIK::Request>();
   ik_srv->ik_request.avoid_collisions = true;
   ik_srv->ik_request.group_name = getGroupName();
 
-  // Copy seed state into virtual robot state and convert into moveit_msg
-  robot_state_->setJointGroupPositions(joint_model_group_, ik_seed_state);
-  moveit::core::robotStateToRobotStateMsg(*robot_state_, ik_srv->ik_request.robot_state);
+  // Copy seed state into a copy of the default robot state (requests may be built concurrently) and convert it
+  moveit::core::RobotState seed_state(*robot_state_);
+  seed_state.setJointGroupPositions(joint_model_group_, ik_seed_state);
+  moveit::core::robotStateToRobotStateMsg(seed_state, ik_srv->ik_request.robot_state);
 
   // Load the poses into the request in difference places depending if there is more than one or not
   geometry_msgs::msg::PoseStamped ik_pose_st;
@@ -302,42 +347,59 @@ bool SrvKinematicsPlugin::searchPositionIK(const std::vector<geometry_msgs::msg:
     ik_srv->ik_request.ik_link_name = getTipFrames()[0];
   }
 
+  if (!ik_service_client_->service_is_ready() && !ik_service_client_->wait_for_service(std::chrono::seconds(1)))
+  {
+    RCLCPP_DEBUG_STREAM(LOGGER, "Service call failed to connect to service: " << ik_service_client_->get_service_name());
+    error_code.val = error_code.FAILURE;
+    return IKResponseFuture();
+  }
+
   RCLCPP_DEBUG(LOGGER, "Calling service: %s", ik_service_client_->get_service_name());
-  auto result_future = ik_service_client_->async_send_request(ik_srv);
-  const auto& response = result_future.get();
-  if (rclcpp::spin_until_future_complete(node_, result_future) == rclcpp::FutureReturnCode::SUCCESS)
+  return ik_service_client_->async_send_request(ik_srv).future.share();
+}
+
+bool SrvKinematicsPlugin::collectIKResponse(const IKResponseFuture& future,
+                                            const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                            std::vector<double>& solution, const IKCallbackFn& solution_callback,
+                                            moveit_msgs::msg::MoveItErrorCodes& error_code) const
+{
+  if (params_.response_timeout > 0.0 &&
+      future.wait_for(std::chrono::duration<double>(params_.response_timeout)) != std::future_status::ready)
   {
-    // Check error code
-    error_code.val = response->error_code.val;
-    if (error_code.val != error_code.SUCCESS)
-    {
-      // TODO (JafarAbdi) Print the entire message for ROS2?
-      // RCLCPP_DEBUG("srv", "An IK that satisifes the constraints and is collision free could not be found."
-      //                                   << "\nRequest was: \n"
-      //                                   << ik_srv.request.ik_request << "\nResponse was: \n"
-      //                                   << ik_srv.response.solution);
-      switch (error_code.val)
-      {
-        case moveit_msgs::msg::MoveItErrorCodes::FAILURE:
-          RCLCPP_ERROR(LOGGER, "Service failed with with error code: FAILURE");
-          break;
-        case moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION:
-          RCLCPP_DEBUG(LOGGER, "Service failed with with error code: NO IK SOLUTION");
-          break;
-        default:
-          RCLCPP_DEBUG_STREAM(LOGGER, "Service failed with with error code: " << error_code.val);
-      }
-      return false;
-    }
+    RCLCPP_ERROR_STREAM(LOGGER, "No response from service " << ik_service_client_->get_service_name() << " within "
+                                                            << params_.response_timeout << "s");
+    ik_service_client_->remove_pending_request(future);
+    error_code.val = error_code.TIMED_OUT;
+    return false;
   }
-  else
+  const auto& response = future.get();
+
+  // Check error code
+  error_code.val = response->error_code.val;
+  if (error_code.val != error_code.SUCCESS)
   {
-    RCLCPP_DEBUG_STREAM(LOGGER, "Service call failed to connect to service: " << ik_service_client_->get_service_name());
-    error_code.val = error_code.FAILURE;
+    // TODO (JafarAbdi) Print the entire message for ROS2?
+    // RCLCPP_DEBUG("srv", "An IK that satisifes the constraints and is collision free could not be found."
+    //                                   << "\nRequest was: \n"
+    //                                   << ik_srv.request.ik_request << "\nResponse was: \n"
+    //                                   << ik_srv.response.solution);
+    switch (error_code.val)
+    {
+      case moveit_msgs::msg::MoveItErrorCodes::FAILURE:
+        RCLCPP_ERROR(LOGGER, "Service failed with with error code: FAILURE");
+        break;
+      case moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION:
+        RCLCPP_DEBUG(LOGGER, "Service failed with with error code: NO IK SOLUTION");
+        break;
+      default:
+        RCLCPP_DEBUG_STREAM(LOGGER, "Service failed with with error code: " << error_code.val);
+    }
     return false;
   }
-  // Convert the robot state message to our robot_state representation
-  if (!moveit::core::robotStateMsgToRobotState(response->solution, *robot_state_))
+
+  // Convert the robot state message to a robot state
+  moveit::core::RobotState solution_state(*robot_state_);
+  if (!moveit::core::robotStateMsgToRobotState(response->solution, solution_state))
   {
     RCLCPP_ERROR(LOGGER, "An error occurred converting received robot state message into internal robot state.");
     error_code.val = error_code.FAILURE;
@@ -345,7 +407,7 @@ bool SrvKinematicsPlugin::searchPositionIK(const std::vector<geometry_msgs::msg:
   }
 
   // Get just the joints we are concerned about in our planning group
-  robot_state_->copyJointGroupPositions(joint_model_group_, solution);
+  solution_state.copyJointGroupPositions(joint_model_group_, solution);
 
   // Run the solution callback (i.e. collision checker) if available
   if (solution_callback)
@@ -372,11 +434,46 @@ bool SrvKinematicsPlugin::searchPositionIK(const std::vector<geometry_msgs::msg:
       return false;
     }
   }
-
-  RCLCPP_INFO(LOGGER, "IK Solver Succeeded!");
   return true;
 }
 
+std::size_t SrvKinematicsPlugin::searchPositionIKBatch(const std::vector<geometry_msgs::msg::Pose>& ik_poses,
+                                                       const std::vector<std::vector<double>>& ik_seed_states,
+                                                       double /*timeout*/, std::vector<std::vector<double>>& solutions,
+                                                       std::vector<moveit_msgs::msg::MoveItErrorCodes>& error_codes,
+                                                       const kinematics::KinematicsQueryOptions& /*options*/) const
+{
+  const std::size_t num_queries = prepareBatch(ik_poses, ik_seed_states, solutions, error_codes);
+
+  // keep up to max_pending_requests requests in flight, and collect the responses in the order of the queries
+  const std::size_t max_pending = static_cast<std::size_t>(params_.max_pending_requests);
+  std::deque<std::pair<std::size_t, IKResponseFuture>> pending;
+  std::size_t next_query = 0;
+  std::size_t num_solved = 0;
+  while (next_query < num_queries || !pending.empty())
+  {
+    if (next_query < num_queries && pending.size() < max_pending)
+    {
+      const std::size_t query = next_query++;
+      const std::vector<geometry_msgs::msg::Pose> query_poses(1, ik_poses[ik_poses.size() == 1 ? 0 : query]);
+      IKResponseFuture future =
+          sendIKRequest(query_poses, ik_seed_states[ik_seed_states.size() == 1 ? 0 : query], error_codes[query]);
+      if (future.valid())
+        pending.emplace_back(query, std::move(future));
+      continue;
+    }
+
+    const std::size_t query = pending.front().first;
+    const std::vector<geometry_msgs::msg::Pose> query_poses(1, ik_poses[ik_poses.size() == 1 ? 0 : query]);
+    if (collectIKResponse(pending.front().second, query_poses, solutions[query], IKCallbackFn(), error_codes[query]))
+      ++num_solved;
+    else
+      solutions[query].clear();
+    pending.pop_front();
+  }
+  return num_solved;
+}
+
 bool SrvKinematicsPlugin::getPositionFK(const std::vector<std::string>& link_names,
                                         const std::vector<double>& joint_angles,
                                         std::vector<geometry_msgs::msg::Pose>& poses) const
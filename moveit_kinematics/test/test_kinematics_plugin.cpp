@@ -576,6 +576,57 @@ TEST_F(KinematicsTest, searchIK)
   EXPECT_GE(success, EXPECTED_SUCCESS_RATE * num_ik_tests_);
 }
 
+TEST_F(KinematicsTest, searchIKBatch)
+{
+  const std::vector<std::string>& fk_names = kinematics_solver_->getTipFrames();
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+
+  // many poses, all from the same seed
+  std::vector<geometry_msgs::msg::Pose> poses;
+  std::vector<double> fk_values;
+  for (unsigned int i = 0; i < num_ik_tests_; ++i)
+  {
+    robot_state.setToRandomPositions(jmg_, this->rng_);
+    robot_state.copyJointGroupPositions(jmg_, fk_values);
+    std::vector<geometry_msgs::msg::Pose> fk_poses;
+    ASSERT_TRUE(kinematics_solver_->getPositionFK(fk_names, fk_values, fk_poses));
+    poses.push_back(fk_poses[0]);
+  }
+  const std::vector<std::vector<double>> seeds(1, std::vector<double>(kinematics_solver_->getJointNames().size(), 0.0));
+
+  std::vector<std::vector<double>> solutions;
+  std::vector<moveit_msgs::msg::MoveItErrorCodes> error_codes;
+  const std::size_t success =
+      kinematics_solver_->searchPositionIKBatch(poses, seeds, timeout_, solutions, error_codes);
+  ASSERT_EQ(solutions.size(), poses.size());
+  ASSERT_EQ(error_codes.size(), poses.size());
+
+  std::size_t num_solutions = 0;
+  for (std::size_t i = 0; i < poses.size(); ++i)
+  {
+    if (error_codes[i].val != moveit_msgs::msg::MoveItErrorCodes::SUCCESS)
+    {
+      EXPECT_TRUE(solutions[i].empty());
+      continue;
+    }
+    ++num_solutions;
+    const std::vector<geometry_msgs::msg::Pose> expected_poses{ poses[i] };
+    std::vector<geometry_msgs::msg::Pose> reached_poses;
+    kinematics_solver_->getPositionFK(fk_names, solutions[i], reached_poses);
+    EXPECT_NEAR_POSES(expected_poses, reached_poses, tolerance_);
+  }
+  EXPECT_EQ(success, num_solutions);
+  EXPECT_GE(success, EXPECTED_SUCCESS_RATE * num_ik_tests_);
+
+  // mismatching sizes are rejected
+  const std::vector<std::vector<double>> two_seeds(2, seeds[0]);
+  EXPECT_EQ(kinematics_solver_->searchPositionIKBatch(std::vector<geometry_msgs::msg::Pose>(3, poses[0]), two_seeds,
+                                                      timeout_, solutions, error_codes),
+            0u);
+  EXPECT_TRUE(solutions.empty());
+}
+
 TEST_F(KinematicsTest, searchIKWithCallback)
 {
   std::vector<double> seed, fk_values, solution;
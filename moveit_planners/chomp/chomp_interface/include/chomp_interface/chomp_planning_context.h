@@ -64,6 +64,8 @@ public:
 private:
   CHOMPInterfacePtr chomp_interface_;
   moveit::core::RobotModelConstPtr robot_model_;
+  // the last solution, used to warm start the next request if chomp.warm_start is set
+  robot_trajectory::RobotTrajectoryConstPtr previous_solution_;
 };
 
 }  // namespace chomp_interface
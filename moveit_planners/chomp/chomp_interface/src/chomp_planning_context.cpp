@@ -39,6 +39,8 @@
 
 namespace chomp_interface
 {
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("chomp_planning_context");
+
 CHOMPPlanningContext::CHOMPPlanningContext(const std::string& name, const std::string& group,
                                            const moveit::core::RobotModelConstPtr& model,
                                            const rclcpp::Node::SharedPtr& node)
@@ -49,7 +51,23 @@ CHOMPPlanningContext::CHOMPPlanningContext(const std::string& name, const std::s
 
 bool CHOMPPlanningContext::solve(planning_interface::MotionPlanDetailedResponse& res)
 {
-  return chomp_interface_->solve(planning_scene_, request_, chomp_interface_->getParams(), res);
+  const chomp::ChompParameters& params = chomp_interface_->getParams();
+  if (params.warm_start_ && previous_solution_)
+  {
+    if (chomp_interface_->solve(planning_scene_, request_, params, res, previous_solution_))
+    {
+      previous_solution_ = res.trajectory[0];
+      return true;
+    }
+    RCLCPP_INFO(LOGGER, "Warm started CHOMP failed, retrying with trajectory initialization method '%s'",
+                params.trajectory_initialization_method_.c_str());
+    res = planning_interface::MotionPlanDetailedResponse();
+  }
+
+  bool planning_success = chomp_interface_->solve(planning_scene_, request_, params, res);
+  if (planning_success)
+    previous_solution_ = res.trajectory[0];
+  return planning_success;
 }
 
 bool CHOMPPlanningContext::solve(planning_interface::MotionPlanResponse& res)
@@ -76,6 +94,7 @@ bool CHOMPPlanningContext::terminate()
 
 void CHOMPPlanningContext::clear()
 {
+  previous_solution_.reset();
 }
 
 }  // namespace chomp_interface
@@ -83,9 +83,9 @@ public:
       return planning_interface::PlanningContextPtr();
     }
 
-    // create PlanningScene using hybrid collision detector
+    // create PlanningScene using hybrid collision detector, reusing the distance field of the previous request
     planning_scene::PlanningScenePtr ps = planning_scene->diff();
-    ps->allocateCollisionDetector(collision_detection::CollisionDetectorAllocatorHybrid::create());
+    ps->allocateCollisionDetector(hybrid_allocator_);
 
     // retrieve and configure existing context
     const CHOMPPlanningContextPtr& context = planning_contexts_.at(req.group_name);
@@ -115,6 +115,8 @@ public:
 
 protected:
   std::map<std::string, CHOMPPlanningContextPtr> planning_contexts_;
+  collision_detection::CollisionDetectorAllocatorPtr hybrid_allocator_ =
+      collision_detection::CachingCollisionDetectorAllocatorHybrid::create();
 };
 
 }  // namespace chomp_interface
@@ -43,9 +43,11 @@
 #include <moveit/collision_distance_field/collision_env_hybrid.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_model/robot_model.h>
+#include <moveit/utils/worker_pool.h>
 
 #include <Eigen/Core>
 #include <Eigen/StdVector>
+#include <memory>
 #include <vector>
 
 namespace chomp
@@ -81,6 +83,15 @@ public:
   }
 
 private:
+  /** Scratch data of one thread computing forward kinematics and collision increments of trajectory points */
+  struct ThreadData
+  {
+    moveit::core::RobotState state;
+    collision_detection::GroupStateRepresentationPtr gsr;
+    Eigen::MatrixXd jacobian;
+    Eigen::MatrixXd jacobian_pseudo_inverse;
+  };
+
   inline double getPotential(double field_distance, double radius, double clearance)
   {
     double d = field_distance - radius;
@@ -108,7 +119,7 @@ private:
   //                     const std::string& group_name,
   //                     Eigen::VectorXd& state_vec);
 
-  void setRobotStateFromPoint(ChompTrajectory& group_trajectory, int i);
+  void setRobotStateFromPoint(ChompTrajectory& group_trajectory, int i, moveit::core::RobotState& state);
 
   // collision_proximity::CollisionProximitySpace::TrajectorySafety checkCurrentIterValidity();
 
@@ -136,6 +147,14 @@ private:
   collision_detection::GroupStateRepresentationPtr gsr_;
   bool initialized_;
 
+  // threads for the per-point computations, and one set of scratch data per thread
+  std::unique_ptr<moveit::core::WorkerPool> worker_pool_;
+  std::vector<ThreadData> thread_data_;
+
+  // the group trajectory at the last forward kinematics of each point, for skipping points that barely moved
+  Eigen::MatrixXd fk_trajectory_;
+  std::vector<int> fk_points_;
+
   std::vector<std::vector<std::string> > collision_point_joint_names_;
   std::vector<EigenSTL::vector_Vector3d> collision_point_pos_eigen_;
   std::vector<EigenSTL::vector_Vector3d> collision_point_vel_eigen_;
@@ -170,9 +189,6 @@ private:
 
   // temporary variables for all functions:
   Eigen::VectorXd smoothness_derivative_;
-  Eigen::MatrixXd jacobian_;
-  Eigen::MatrixXd jacobian_pseudo_inverse_;
-  Eigen::MatrixXd jacobian_jacobian_tranpose_;
   Eigen::VectorXd random_state_;
   Eigen::VectorXd joint_state_velocities_;
 
@@ -199,8 +215,10 @@ private:
   void initialize();
   void calculateSmoothnessIncrements();
   void calculateCollisionIncrements();
+  void calculateCollisionIncrements(int trajectory_point, ThreadData& thread_data);
   void calculateTotalIncrements();
   void performForwardKinematics();
+  void performForwardKinematics(int trajectory_point, ThreadData& thread_data);
   void addIncrementsToTrajectory();
   void updateFullTrajectory();
   void debugCost();
@@ -212,8 +230,8 @@ private:
   void getRandomMomentum();
   void updateMomentum();
   void updatePositionFromMomentum();
-  void calculatePseudoInverse();
-  void computeJointProperties(int trajectoryPoint);
+  void calculatePseudoInverse(ThreadData& thread_data) const;
+  void computeJointProperties(int trajectoryPoint, const moveit::core::RobotState& state);
   bool isCurrentTrajectoryMeshToMeshCollisionFree() const;
 };
 }  // namespace chomp
@@ -94,6 +94,11 @@ public:
                                     an initial path is not found with the specified chomp parameters */
   int max_recovery_attempts_;    /*!< this the maximum recovery attempts to find a collision free path after an initial
                                     failure to find a solution */
+  int num_threads_; /*!< number of threads computing forward kinematics and collision increments, 0 uses all cores */
+  double fk_update_threshold_; /*!< forward kinematics of a trajectory point are only recomputed if one of its joints
+                                  moved more than this since the last computation, 0 recomputes every changed point */
+  bool warm_start_; /*!< if set to true, the planning context initializes the trajectory from its previous solution and
+                       only falls back to trajectory_initialization_method_ if that fails */
 };
 
 }  // namespace chomp
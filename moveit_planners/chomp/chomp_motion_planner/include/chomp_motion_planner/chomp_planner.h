@@ -41,6 +41,7 @@
 #include <moveit/planning_interface/planning_response.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
 
 namespace chomp
 {
@@ -50,8 +51,12 @@ public:
   ChompPlanner() = default;
   virtual ~ChompPlanner() = default;
 
+  /** \brief Plan for \e req. If \e seed_trajectory is given for the requested group, the trajectory is initialized
+   *  from it (see ChompTrajectory::fillInFromPreviousTrajectory()) instead of using the initialization method of
+   *  \e params */
   bool solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
              const planning_interface::MotionPlanRequest& req, const ChompParameters& params,
-             planning_interface::MotionPlanDetailedResponse& res) const;
+             planning_interface::MotionPlanDetailedResponse& res,
+             const robot_trajectory::RobotTrajectoryConstPtr& seed_trajectory = nullptr) const;
 };
 }  // namespace chomp
@@ -135,6 +135,14 @@ public:
    */
   bool fillInFromTrajectory(const robot_trajectory::RobotTrajectory& trajectory);
 
+  /**
+   * \brief Initializes the trajectory from a previous solution, e.g. to warm start a re-optimization. The \a trajectory
+   * is resampled like in fillInFromTrajectory(), and then offset linearly so it still connects the start and goal
+   * points already set in this trajectory
+   * @param trajectory
+   */
+  bool fillInFromPreviousTrajectory(const robot_trajectory::RobotTrajectory& trajectory);
+
   /**
    * \brief This function assigns the given \a source RobotState to the row at index \a chomp_trajectory_point
    *
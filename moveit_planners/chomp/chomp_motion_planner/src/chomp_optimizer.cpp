@@ -44,7 +44,9 @@
 #include <rclcpp/logging.hpp>
 #include <eigen3/Eigen/Core>
 #include <eigen3/Eigen/LU>
+#include <algorithm>
 #include <random>
+#include <thread>
 #include <visualization_msgs/msg/marker_array.hpp>
 
 namespace chomp
@@ -134,12 +136,28 @@ void ChompOptimizer::initialize()
   collision_increments_ = Eigen::MatrixXd::Zero(num_vars_free_, num_joints_);
   final_increments_ = Eigen::MatrixXd::Zero(num_vars_free_, num_joints_);
   smoothness_derivative_ = Eigen::VectorXd::Zero(num_vars_all_);
-  jacobian_ = Eigen::MatrixXd::Zero(3, num_joints_);
-  jacobian_pseudo_inverse_ = Eigen::MatrixXd::Zero(num_joints_, 3);
-  jacobian_jacobian_tranpose_ = Eigen::MatrixXd::Zero(3, 3);
   random_state_ = Eigen::VectorXd::Zero(num_joints_);
   joint_state_velocities_ = Eigen::VectorXd::Zero(num_joints_);
 
+  // set up the threads for the per-point computations. Each thread checks collisions with its own group state
+  // representation, and these are all created here because creating them may update the distance field cache.
+  const unsigned int num_threads = parameters_->num_threads_ > 0 ? parameters_->num_threads_ :
+                                                                   std::max(1u, std::thread::hardware_concurrency());
+  worker_pool_ = std::make_unique<moveit::core::WorkerPool>(num_threads);
+  thread_data_.clear();
+  thread_data_.reserve(num_threads);
+  for (unsigned int t = 0; t < num_threads; ++t)
+  {
+    thread_data_.push_back({ state_, t == 0 ? gsr_ : nullptr, Eigen::MatrixXd::Zero(3, num_joints_),
+                             Eigen::MatrixXd::Zero(num_joints_, 3) });
+    if (!thread_data_.back().gsr)
+    {
+      hy_env_->getCollisionGradients(req, res, state_, &planning_scene_->getAllowedCollisionMatrix(),
+                                     thread_data_.back().gsr);
+    }
+  }
+  fk_trajectory_ = group_trajectory_.getTrajectory();
+
   group_trajectory_backup_ = group_trajectory_.getTrajectory();
   best_group_trajectory_ = group_trajectory_.getTrajectory();
 
@@ -585,15 +603,6 @@ void ChompOptimizer::calculateSmoothnessIncrements()
 
 void ChompOptimizer::calculateCollisionIncrements()
 {
-  double potential;
-  double vel_mag_sq;
-  double vel_mag;
-  Eigen::Vector3d potential_gradient;
-  Eigen::Vector3d normalized_velocity;
-  Eigen::Matrix3d orthogonal_projector;
-  Eigen::Vector3d curvature_vector;
-  Eigen::Vector3d cartesian_gradient;
-
   collision_increments_.setZero(num_vars_free_, num_joints_);
 
   int start_point = 0;
@@ -615,56 +624,73 @@ void ChompOptimizer::calculateCollisionIncrements()
     start_point = free_vars_start_;
   }
 
-  for (int i = start_point; i <= end_point; ++i)
+  // every point only writes its own row of the increments
+  worker_pool_->run(end_point - start_point + 1, [&](std::size_t index, unsigned int thread) {
+    calculateCollisionIncrements(start_point + static_cast<int>(index), thread_data_[thread]);
+  });
+  // cout << collision_increments_ << endl;
+}
+
+void ChompOptimizer::calculateCollisionIncrements(int i, ThreadData& thread_data)
+{
+  double potential;
+  double vel_mag_sq;
+  double vel_mag;
+  Eigen::Vector3d potential_gradient;
+  Eigen::Vector3d normalized_velocity;
+  Eigen::Matrix3d orthogonal_projector;
+  Eigen::Vector3d curvature_vector;
+  Eigen::Vector3d cartesian_gradient;
+
+  for (int j = 0; j < num_collision_points_; ++j)
   {
-    for (int j = 0; j < num_collision_points_; ++j)
-    {
-      potential = collision_point_potential_[i][j];
+    potential = collision_point_potential_[i][j];
 
-      if (potential < 0.0001)
-        continue;
+    if (potential < 0.0001)
+      continue;
 
-      potential_gradient = -collision_point_potential_gradient_[i][j];
+    potential_gradient = -collision_point_potential_gradient_[i][j];
 
-      vel_mag = collision_point_vel_mag_[i][j];
-      vel_mag_sq = vel_mag * vel_mag;
+    vel_mag = collision_point_vel_mag_[i][j];
+    vel_mag_sq = vel_mag * vel_mag;
 
-      // all math from the CHOMP paper:
+    // all math from the CHOMP paper:
 
-      normalized_velocity = collision_point_vel_eigen_[i][j] / vel_mag;
-      orthogonal_projector = Eigen::Matrix3d::Identity() - (normalized_velocity * normalized_velocity.transpose());
-      curvature_vector = (orthogonal_projector * collision_point_acc_eigen_[i][j]) / vel_mag_sq;
-      cartesian_gradient = vel_mag * (orthogonal_projector * potential_gradient - potential * curvature_vector);
+    normalized_velocity = collision_point_vel_eigen_[i][j] / vel_mag;
+    orthogonal_projector = Eigen::Matrix3d::Identity() - (normalized_velocity * normalized_velocity.transpose());
+    curvature_vector = (orthogonal_projector * collision_point_acc_eigen_[i][j]) / vel_mag_sq;
+    cartesian_gradient = vel_mag * (orthogonal_projector * potential_gradient - potential * curvature_vector);
 
-      // pass it through the jacobian transpose to get the increments
-      getJacobian(i, collision_point_pos_eigen_[i][j], collision_point_joint_names_[i][j], jacobian_);
+    // pass it through the jacobian transpose to get the increments
+    getJacobian(i, collision_point_pos_eigen_[i][j], collision_point_joint_names_[i][j], thread_data.jacobian);
 
-      if (parameters_->use_pseudo_inverse_)
-      {
-        calculatePseudoInverse();
-        collision_increments_.row(i - free_vars_start_).transpose() -= jacobian_pseudo_inverse_ * cartesian_gradient;
-      }
-      else
+    if (parameters_->use_pseudo_inverse_)
+    {
+      calculatePseudoInverse(thread_data);
+      collision_increments_.row(i - free_vars_start_).transpose() -=
+          thread_data.jacobian_pseudo_inverse * cartesian_gradient;
+    }
+    else
+    {
+      collision_increments_.row(i - free_vars_start_).transpose() -=
+          thread_data.jacobian.transpose() * cartesian_gradient;
+    }
+
+    /*
+      if(point_is_in_collision_[i][j])
       {
-        collision_increments_.row(i - free_vars_start_).transpose() -= jacobian_.transpose() * cartesian_gradient;
+      break;
       }
-
-      /*
-        if(point_is_in_collision_[i][j])
-        {
-        break;
-        }
-      */
-    }
+    */
   }
-  // cout << collision_increments_ << endl;
 }
 
-void ChompOptimizer::calculatePseudoInverse()
+void ChompOptimizer::calculatePseudoInverse(ThreadData& thread_data) const
 {
-  jacobian_jacobian_tranpose_ =
-      jacobian_ * jacobian_.transpose() + Eigen::MatrixXd::Identity(3, 3) * parameters_->pseudo_inverse_ridge_factor_;
-  jacobian_pseudo_inverse_ = jacobian_.transpose() * jacobian_jacobian_tranpose_.inverse();
+  const Eigen::Matrix3d jacobian_jacobian_tranpose =
+      thread_data.jacobian * thread_data.jacobian.transpose() +
+      Eigen::Matrix3d::Identity() * parameters_->pseudo_inverse_ridge_factor_;
+  thread_data.jacobian_pseudo_inverse = thread_data.jacobian.transpose() * jacobian_jacobian_tranpose.inverse();
 }
 
 void ChompOptimizer::calculateTotalIncrements()
@@ -752,11 +778,11 @@ double ChompOptimizer::getCollisionCost()
   return parameters_->obstacle_cost_weight_ * collision_cost;
 }
 
-void ChompOptimizer::computeJointProperties(int trajectory_point)
+void ChompOptimizer::computeJointProperties(int trajectory_point, const moveit::core::RobotState& state)
 {
   for (int j = 0; j < num_joints_; ++j)
   {
-    const moveit::core::JointModel* joint_model = state_.getJointModel(joint_names_[j]);
+    const moveit::core::JointModel* joint_model = state.getJointModel(joint_names_[j]);
     const moveit::core::RevoluteJointModel* revolute_joint =
         dynamic_cast<const moveit::core::RevoluteJointModel*>(joint_model);
     const moveit::core::PrismaticJointModel* prismatic_joint =
@@ -764,9 +790,9 @@ void ChompOptimizer::computeJointProperties(int trajectory_point)
 
     std::string parent_link_name = joint_model->getParentLinkModel()->getName();
     std::string child_link_name = joint_model->getChildLinkModel()->getName();
-    Eigen::Isometry3d joint_transform = state_.getGlobalLinkTransform(parent_link_name) *
+    Eigen::Isometry3d joint_transform = state.getGlobalLinkTransform(parent_link_name) *
                                         (robot_model_->getLinkModel(child_link_name)->getJointOriginTransform() *
-                                         (state_.getJointTransform(joint_model)));
+                                         (state.getJointTransform(joint_model)));
 
     // joint_transform = inverseWorldTransform * jointTransform;
     Eigen::Vector3d axis;
@@ -911,66 +937,24 @@ void ChompOptimizer::performForwardKinematics()
     end = num_vars_all_ - 1;
   }
 
-  is_collision_free_ = true;
-
-  auto total_dur = std::chrono::duration<double>::zero();
-
-  // for each point in the trajectory
+  // only points that moved by more than the threshold since their last forward kinematics are recomputed
+  fk_points_.clear();
   for (int i = start; i <= end; ++i)
   {
-    // Set Robot state from trajectory point...
-    collision_detection::CollisionRequest req;
-    collision_detection::CollisionResult res;
-    req.group_name = planning_group_;
-    setRobotStateFromPoint(group_trajectory_, i);
-    auto grad = std::chrono::system_clock::now();
-
-    hy_env_->getCollisionGradients(req, res, state_, nullptr, gsr_);
-    total_dur += (std::chrono::system_clock::now() - grad);
-    computeJointProperties(i);
-    state_is_in_collision_[i] = false;
-
-    // Keep vars in scope
+    if (iteration_ == 0 || (group_trajectory_.getTrajectoryPoint(i) - fk_trajectory_.row(i)).cwiseAbs().maxCoeff() >
+                               parameters_->fk_update_threshold_)
     {
-      size_t j = 0;
-      for (const collision_detection::GradientInfo& info : gsr_->gradients_)
-      {
-        for (size_t k = 0; k < info.sphere_locations.size(); ++k)
-        {
-          collision_point_pos_eigen_[i][j][0] = info.sphere_locations[k].x();
-          collision_point_pos_eigen_[i][j][1] = info.sphere_locations[k].y();
-          collision_point_pos_eigen_[i][j][2] = info.sphere_locations[k].z();
-
-          collision_point_potential_[i][j] =
-              getPotential(info.distances[k], info.sphere_radii[k], parameters_->min_clearance_);
-          collision_point_potential_gradient_[i][j][0] = info.gradients[k].x();
-          collision_point_potential_gradient_[i][j][1] = info.gradients[k].y();
-          collision_point_potential_gradient_[i][j][2] = info.gradients[k].z();
-
-          point_is_in_collision_[i][j] = (info.distances[k] - info.sphere_radii[k] < info.sphere_radii[k]);
-
-          if (point_is_in_collision_[i][j])
-          {
-            state_is_in_collision_[i] = true;
-            // if(is_collision_free_ == true) {
-            //   RCLCPP_INFO(LOGGER,"We know it's not collision free " << g);
-            //   RCLCPP_INFO(LOGGER,"Sphere location " << info.sphere_locations[k].x() << " " <<
-            //   info.sphere_locations[k].y() << " " << info.sphere_locations[k].z());
-            //   RCLCPP_INFO(LOGGER,"Gradient " << info.gradients[k].x() << " " << info.gradients[k].y() << " " <<
-            //   info.gradients[k].z() << " distance " << info.distances[k] << " radii " << info.sphere_radii[k]);
-            //   RCLCPP_INFO(LOGGER,"Radius " << info.sphere_radii[k] << " potential " <<
-            //   collision_point_potential_[i][j]);
-            // }
-
-            is_collision_free_ = false;
-          }
-          j++;
-        }
-      }
+      fk_points_.push_back(i);
     }
   }
 
-  // RCLCPP_INFO(LOGGER,"Total dur " << total_dur << " total checks " << end-start+1);
+  // for each point in the trajectory
+  worker_pool_->run(fk_points_.size(), [this](std::size_t index, unsigned int thread) {
+    performForwardKinematics(fk_points_[index], thread_data_[thread]);
+  });
+
+  is_collision_free_ = std::none_of(state_is_in_collision_.begin() + start, state_is_in_collision_.begin() + end + 1,
+                                    [](int in_collision) { return in_collision; });
 
   // now, get the vel and acc for each collision point (using finite differencing)
   for (int i = free_vars_start_; i <= free_vars_end_; ++i)
@@ -993,7 +977,46 @@ void ChompOptimizer::performForwardKinematics()
   }
 }
 
-void ChompOptimizer::setRobotStateFromPoint(ChompTrajectory& group_trajectory, int i)
+void ChompOptimizer::performForwardKinematics(int i, ThreadData& thread_data)
+{
+  // Set Robot state from trajectory point...
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+  req.group_name = planning_group_;
+  setRobotStateFromPoint(group_trajectory_, i, thread_data.state);
+
+  hy_env_->getCollisionGradients(req, res, thread_data.state, nullptr, thread_data.gsr);
+  computeJointProperties(i, thread_data.state);
+  fk_trajectory_.row(i) = group_trajectory_.getTrajectoryPoint(i);
+  state_is_in_collision_[i] = false;
+
+  size_t j = 0;
+  for (const collision_detection::GradientInfo& info : thread_data.gsr->gradients_)
+  {
+    for (size_t k = 0; k < info.sphere_locations.size(); ++k)
+    {
+      collision_point_pos_eigen_[i][j][0] = info.sphere_locations[k].x();
+      collision_point_pos_eigen_[i][j][1] = info.sphere_locations[k].y();
+      collision_point_pos_eigen_[i][j][2] = info.sphere_locations[k].z();
+
+      collision_point_potential_[i][j] =
+          getPotential(info.distances[k], info.sphere_radii[k], parameters_->min_clearance_);
+      collision_point_potential_gradient_[i][j][0] = info.gradients[k].x();
+      collision_point_potential_gradient_[i][j][1] = info.gradients[k].y();
+      collision_point_potential_gradient_[i][j][2] = info.gradients[k].z();
+
+      point_is_in_collision_[i][j] = (info.distances[k] - info.sphere_radii[k] < info.sphere_radii[k]);
+
+      if (point_is_in_collision_[i][j])
+      {
+        state_is_in_collision_[i] = true;
+      }
+      j++;
+    }
+  }
+}
+
+void ChompOptimizer::setRobotStateFromPoint(ChompTrajectory& group_trajectory, int i, moveit::core::RobotState& state)
 {
   const Eigen::MatrixXd::RowXpr& point = group_trajectory.getTrajectoryPoint(i);
 
@@ -1002,8 +1025,8 @@ void ChompOptimizer::setRobotStateFromPoint(ChompTrajectory& group_trajectory, i
   for (size_t j = 0; j < group_trajectory.getNumJoints(); ++j)
     joint_states.emplace_back(point(0, j));
 
-  state_.setJointGroupPositions(planning_group_, joint_states);
-  state_.update();
+  state.setJointGroupPositions(planning_group_, joint_states);
+  state.update();
 }
 
 void ChompOptimizer::perturbTrajectory()
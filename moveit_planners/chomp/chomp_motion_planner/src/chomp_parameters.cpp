@@ -64,6 +64,9 @@ ChompParameters::ChompParameters()
   trajectory_initialization_method_ = std::string("quintic-spline");
   enable_failure_recovery_ = false;
   max_recovery_attempts_ = 5;
+  num_threads_ = 1;
+  fk_update_threshold_ = 0.0;
+  warm_start_ = false;
 }
 
 ChompParameters::~ChompParameters() = default;
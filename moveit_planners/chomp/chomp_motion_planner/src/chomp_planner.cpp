@@ -50,7 +50,8 @@ static const rclcpp::Logger LOGGER = rclcpp::get_logger("chomp_planner");
 
 bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
                          const planning_interface::MotionPlanRequest& req, const ChompParameters& params,
-                         planning_interface::MotionPlanDetailedResponse& res) const
+                         planning_interface::MotionPlanDetailedResponse& res,
+                         const robot_trajectory::RobotTrajectoryConstPtr& seed_trajectory) const
 {
   auto start_time = std::chrono::system_clock::now();
   res.planner_id = std::string("chomp");
@@ -123,8 +124,14 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
     }
   }
 
-  // fill in an initial trajectory based on user choice from the chomp_config.yaml file
-  if (params.trajectory_initialization_method_.compare("quintic-spline") == 0)
+  // fill in an initial trajectory from the seed, or based on user choice from the chomp_config.yaml file
+  const bool warm_started = seed_trajectory && seed_trajectory->getGroupName() == req.group_name &&
+                            trajectory.fillInFromPreviousTrajectory(*seed_trajectory);
+  if (warm_started)
+  {
+    RCLCPP_INFO(LOGGER, "CHOMP trajectory initialized from a previous trajectory");
+  }
+  else if (params.trajectory_initialization_method_.compare("quintic-spline") == 0)
   {
     trajectory.fillInMinJerk();
   }
@@ -156,8 +163,9 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
     return false;
   }
 
-  RCLCPP_INFO(LOGGER, "CHOMP trajectory initialized using method: %s ",
-              (params.trajectory_initialization_method_).c_str());
+  if (!warm_started)
+    RCLCPP_INFO(LOGGER, "CHOMP trajectory initialized using method: %s ",
+                (params.trajectory_initialization_method_).c_str());
 
   // optimize!
   auto create_time = std::chrono::system_clock::now();
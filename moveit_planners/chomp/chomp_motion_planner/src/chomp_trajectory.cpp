@@ -208,6 +208,25 @@ bool ChompTrajectory::fillInFromTrajectory(const robot_trajectory::RobotTrajecto
   return true;
 }
 
+bool ChompTrajectory::fillInFromPreviousTrajectory(const robot_trajectory::RobotTrajectory& trajectory)
+{
+  const size_t goal_index = getNumPoints() - 1;
+  const Eigen::RowVectorXd start = getTrajectoryPoint(0);
+  const Eigen::RowVectorXd goal = getTrajectoryPoint(goal_index);
+  if (!fillInFromTrajectory(trajectory))
+    return false;
+
+  // distribute the differences to the requested start and goal linearly over the trajectory
+  const Eigen::RowVectorXd start_offset = start - getTrajectoryPoint(0);
+  const Eigen::RowVectorXd goal_offset = goal - getTrajectoryPoint(goal_index);
+  for (size_t i = 0; i <= goal_index; ++i)
+  {
+    const double fraction = static_cast<double>(i) / goal_index;
+    getTrajectoryPoint(i) += (1.0 - fraction) * start_offset + fraction * goal_offset;
+  }
+  return true;
+}
+
 void ChompTrajectory::assignCHOMPTrajectoryPointFromRobotState(const moveit::core::RobotState& source,
                                                                size_t chomp_trajectory_point_index,
                                                                const moveit::core::JointModelGroup* group)
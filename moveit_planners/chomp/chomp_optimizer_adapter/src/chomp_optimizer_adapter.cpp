@@ -155,6 +155,17 @@ public:
       RCLCPP_DEBUG(LOGGER, "Param use_stochastic_descent was not set. Using default value: %d",
                    params_.use_stochastic_descent_);
     }
+    if (!node->get_parameter("chomp.num_threads", params_.num_threads_))
+    {
+      params_.num_threads_ = 1;
+      RCLCPP_DEBUG(LOGGER, "Param num_threads was not set. Using default value: %d", params_.num_threads_);
+    }
+    if (!node->get_parameter("chomp.fk_update_threshold", params_.fk_update_threshold_))
+    {
+      params_.fk_update_threshold_ = 0.0;
+      RCLCPP_DEBUG(LOGGER, "Param fk_update_threshold was not set. Using default value: %f",
+                   params_.fk_update_threshold_);
+    }
     params_.trajectory_initialization_method_ = "quintic-spline";
     std::string method;
     if (node->get_parameter("chomp.trajectory_initialization_method", method) &&
@@ -183,14 +194,11 @@ public:
     if (!planner(ps, req, res))
       return false;
 
-    // create a hybrid collision detector to set the collision checker as hybrid
-    collision_detection::CollisionDetectorAllocatorPtr hybrid_cd(
-        collision_detection::CollisionDetectorAllocatorHybrid::create());
-
-    // create a writable planning scene
+    // create a writable planning scene using the hybrid collision detector, reusing the distance field of the
+    // previous request
     planning_scene::PlanningScenePtr planning_scene = ps->diff();
     RCLCPP_DEBUG(LOGGER, "Configuring Planning Scene for CHOMP ...");
-    planning_scene->allocateCollisionDetector(hybrid_cd);
+    planning_scene->allocateCollisionDetector(hybrid_allocator_);
 
     chomp::ChompPlanner chomp_planner;
     planning_interface::MotionPlanDetailedResponse res_detailed;
@@ -210,6 +218,8 @@ public:
 
 private:
   chomp::ChompParameters params_;
+  collision_detection::CollisionDetectorAllocatorPtr hybrid_allocator_ =
+      collision_detection::CachingCollisionDetectorAllocatorHybrid::create();
 };
 }  // namespace chomp
 
@@ -0,0 +1,73 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/** A motion validator for planning with a ValidityCache. Like OMPL's DiscreteMotionValidator it checks the states
+ * interpolated along a motion, but it first looks all of them up in the cache, so that a motion through a state that
+ * is already known to be in collision is rejected without checking any state. The remaining states are checked in
+ * bisection order, filling the cache.
+ **/
+
+#pragma once
+
+#include <moveit/ompl_interface/detail/threadsafe_state_storage.h>
+#include <moveit/ompl_interface/detail/validity_cache.h>
+#include <ompl/base/MotionValidator.h>
+
+namespace ompl_interface
+{
+class ModelBasedPlanningContext;
+
+/** @class CachedMotionValidator
+    @brief An OMPL motion validator that rejects motions through states cached as invalid before checking any state */
+class CachedMotionValidator : public ompl::base::MotionValidator
+{
+public:
+  CachedMotionValidator(const ModelBasedPlanningContext* planning_context);
+
+  bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const override;
+
+  bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                   std::pair<ompl::base::State*, double>& last_valid) const override;
+
+protected:
+  /** \brief True if one of \e states is cached as invalid */
+  bool containsKnownInvalid(const std::vector<ompl::base::State*>& states) const;
+
+  const ModelBasedPlanningContext* planning_context_;
+  ValidityCachePtr validity_cache_;
+  std::uint64_t validity_cache_generation_;
+  TSStateStorage tss_;
+};
+}  // namespace ompl_interface
@@ -43,20 +43,38 @@
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/robot_model/joint_model_group.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace ompl_interface
 {
 class ModelBasedPlanningContext;
 
 /** @class ConstrainedGoalSampler
- *  An interface to the OMPL goal lazy sampler*/
+ *  An interface to the OMPL goal lazy sampler.
+ *
+ *  Each sampler in \e background_samplers runs in its own thread while OMPL samples goals, and fills a queue of goal
+ *  states that already satisfy the constraints and are valid. The OMPL sampling thread takes goals from this queue
+ *  before sampling on its own. The background samplers must be separate instances of the same kind as \e cs. */
 class ConstrainedGoalSampler : public ompl::base::GoalLazySamples
 {
 public:
   ConstrainedGoalSampler(const ModelBasedPlanningContext* pc, kinematic_constraints::KinematicConstraintSetPtr ks,
-                         constraint_samplers::ConstraintSamplerPtr cs = constraint_samplers::ConstraintSamplerPtr());
+                         constraint_samplers::ConstraintSamplerPtr cs = constraint_samplers::ConstraintSamplerPtr(),
+                         std::vector<constraint_samplers::ConstraintSamplerPtr> background_samplers = {});
+
+  ~ConstrainedGoalSampler() override;
 
 private:
   bool sampleUsingConstraintSampler(const ompl::base::GoalLazySamples* gls, ompl::base::State* new_goal);
+  bool sampleGoal(const ompl::base::GoalLazySamples* gls, ompl::base::State* new_goal);
+  void startBackgroundSampling();
+  void stopBackgroundSampling();
+  void backgroundSampling(const constraint_samplers::ConstraintSamplerPtr& sampler);
+  bool takeBackgroundGoal(ompl::base::State* new_goal);
   bool stateValidityCallback(ompl::base::State* new_goal, const moveit::core::RobotState* state,
                              const moveit::core::JointModelGroup* /*jmg*/, const double* /*jpos*/,
                              bool verbose = false) const;
@@ -71,5 +89,12 @@ private:
   unsigned int invalid_sampled_constraints_;
   bool warned_invalid_samples_;
   unsigned int verbose_display_;
+
+  std::vector<constraint_samplers::ConstraintSamplerPtr> background_samplers_;
+  std::vector<std::thread> background_threads_;
+  std::deque<ompl::base::State*> background_goals_;
+  std::mutex background_goals_lock_;
+  std::condition_variable background_goals_condition_;
+  bool stop_background_sampling_;
 };
 }  // namespace ompl_interface
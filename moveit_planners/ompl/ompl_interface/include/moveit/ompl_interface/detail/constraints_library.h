@@ -135,6 +135,7 @@ struct ConstraintApproximationConstructionOptions
     , explicit_motions(false)
     , explicit_points_resolution(0.0)
     , max_explicit_points(0)
+    , num_threads(0)
   {
   }
 
@@ -145,6 +146,8 @@ struct ConstraintApproximationConstructionOptions
   bool explicit_motions;
   double explicit_points_resolution;
   unsigned int max_explicit_points;
+  /// Threads used to sample and connect states; 0 uses all hardware threads
+  unsigned int num_threads;
 };
 
 struct ConstraintApproximationConstructionResults
@@ -0,0 +1,78 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/** A motion validator that, in addition to checking the validity of the interpolated states like OMPL's
+ * DiscreteMotionValidator, sweeps the robot links and attached bodies between consecutive interpolated states
+ * and checks the swept volumes against the world. This catches thin obstacles that lie between two discretely
+ * checked states.
+ *
+ * The sweep relies on the continuous checkRobotCollision() of the active collision environment. If the
+ * environment does not support continuous checks, only the discrete checks are performed.
+ **/
+
+#pragma once
+
+#include <moveit/ompl_interface/detail/threadsafe_state_storage.h>
+#include <moveit/collision_detection/collision_common.h>
+#include <ompl/base/MotionValidator.h>
+
+namespace ompl_interface
+{
+class ModelBasedPlanningContext;
+
+/** @class ContinuousMotionValidator
+    @brief An OMPL motion validator that checks the swept volume between interpolated states */
+class ContinuousMotionValidator : public ompl::base::MotionValidator
+{
+public:
+  ContinuousMotionValidator(const ModelBasedPlanningContext* planning_context);
+
+  bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const override;
+
+  bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                   std::pair<ompl::base::State*, double>& last_valid) const override;
+
+protected:
+  /** \brief Check the motion from \e s1 to \e s2. Returns the index of the last valid interpolation step, which is
+   *  \e segment_count if the whole motion is valid. */
+  unsigned int checkSegments(const ompl::base::State* s1, const ompl::base::State* s2,
+                             unsigned int segment_count) const;
+
+  const ModelBasedPlanningContext* planning_context_;
+  TSStateStorage tss_previous_;
+  TSStateStorage tss_current_;
+  collision_detection::CollisionRequest collision_request_;
+};
+}  // namespace ompl_interface
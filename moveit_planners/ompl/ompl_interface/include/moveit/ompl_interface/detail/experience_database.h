@@ -0,0 +1,105 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/ompl_interface/parameterization/model_based_state_space.h>
+#include <ompl/base/Goal.h>
+#include <ompl/base/PlannerTerminationCondition.h>
+#include <ompl/base/SpaceInformation.h>
+#include <ompl/geometric/PathGeometric.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ompl_interface
+{
+MOVEIT_CLASS_FORWARD(ExperienceDatabase);  // Defines ExperienceDatabasePtr, ConstPtr, WeakPtr... etc
+
+/** @class ExperienceDatabase
+    @brief Stores the solution paths of previous planning requests, so that requests with similar start states and goals
+    can be answered by repairing a stored path instead of planning from scratch.
+
+    All functions are thread-safe, so one database can be shared by all planning contexts of a planner configuration. */
+class ExperienceDatabase
+{
+public:
+  /** \brief Construct a database for states of \e state_space. If \e filename is not empty, previously stored paths
+   *  are loaded from it and the database is saved there again on destruction. */
+  ExperienceDatabase(const ModelBasedStateSpacePtr& state_space, const std::string& filename = "");
+
+  ~ExperienceDatabase();
+
+  ExperienceDatabase(const ExperienceDatabase&) = delete;
+  ExperienceDatabase& operator=(const ExperienceDatabase&) = delete;
+
+  /** \brief The number of stored paths */
+  std::size_t size() const;
+
+  void clear();
+
+  /** \brief Store \e path. A stored path with nearly the same start and end state is replaced. */
+  void addPath(const ompl::geometric::PathGeometric& path);
+
+  /** \brief Find the stored paths whose start is closest to \e start and whose end is closest to \e goal, and try to
+   *  repair them into a valid path from \e start to a state satisfying \e goal.
+   *
+   *  Stored states that are invalid in the current planning scene are dropped and the path is connected to \e start
+   *  and to a goal state. Segments that are no longer valid are replanned locally with a short time budget. Returns
+   *  false if no stored path could be repaired before \e ptc terminates. */
+  bool retrieveRepairedPath(const ompl::base::SpaceInformationPtr& si, const ompl::base::State* start,
+                            const ompl::base::Goal& goal, const ompl::base::PlannerTerminationCondition& ptc,
+                            ompl::geometric::PathGeometric& path) const;
+
+  /** \brief Replace the stored paths with the ones in \e filename. Returns false if the file could not be read or was
+   *  stored for a different state space. */
+  bool load(const std::string& filename);
+
+  /** \brief Write the stored paths to \e filename */
+  bool save(const std::string& filename) const;
+
+private:
+  bool repairPath(const ompl::base::SpaceInformationPtr& si, const ompl::base::State* start,
+                  const ompl::base::Goal& goal, const std::vector<char>& records,
+                  const ompl::base::PlannerTerminationCondition& ptc, ompl::geometric::PathGeometric& path) const;
+
+  ModelBasedStateSpacePtr state_space_;
+  std::string filename_;
+
+  /// each path is stored as the serialized states of its waypoints
+  std::vector<std::vector<char>> paths_;
+  mutable std::mutex lock_;
+};
+}  // namespace ompl_interface
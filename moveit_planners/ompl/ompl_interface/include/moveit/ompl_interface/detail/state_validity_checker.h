@@ -48,6 +48,7 @@
 #pragma once
 
 #include <moveit/ompl_interface/detail/threadsafe_state_storage.h>
+#include <moveit/ompl_interface/detail/validity_cache.h>
 #include <moveit/collision_detection/collision_common.h>
 #include <ompl/base/StateValidityChecker.h>
 
@@ -87,6 +88,13 @@ public:
   void setVerbose(bool flag);
 
 protected:
+  /** \brief Check \e robot_state for collisions, using and filling the validity cache of the planning context */
+  bool checkCollision(moveit::core::RobotState& robot_state, bool verbose) const;
+
+  /** \brief Check \e robot_state for collisions and compute its clearance \e dist, using and filling the validity
+   *  cache of the planning context */
+  bool checkCollision(moveit::core::RobotState& robot_state, double& dist, bool verbose) const;
+
   const ModelBasedPlanningContext* planning_context_;
   std::string group_name_;
   TSStateStorage tss_;
@@ -97,6 +105,9 @@ protected:
 
   collision_detection::CollisionRequest collision_request_with_cost_;
   bool verbose_;
+
+  ValidityCachePtr validity_cache_;
+  std::uint64_t validity_cache_generation_;
 };
 
 /** \brief A StateValidityChecker that can handle states of type `ompl::base::ConstraintStateSpace::StateType`.
@@ -37,11 +37,16 @@
 #pragma once
 
 #include <moveit/robot_state/robot_state.h>
+#include <atomic>
 #include <thread>
 #include <mutex>
 
 namespace ompl_interface
 {
+/** \brief Provides every thread with its own scratch copy of a start state.
+
+    The per-thread states are owned by this class, but each thread also remembers the states it was handed out
+    in thread-local storage, so repeated calls from the same thread do not take any lock. */
 class TSStateStorage
 {
 public:
@@ -51,9 +56,22 @@ public:
 
   moveit::core::RobotState* getStateStorage() const;
 
+  /** \brief Number of getStateStorage() calls that missed the thread-local cache and had to take the lock.
+      In steady state this stays at one per thread using this storage. */
+  std::size_t getLockedLookupCount() const
+  {
+    return locked_lookups_.load(std::memory_order_relaxed);
+  }
+
 private:
+  moveit::core::RobotState* getStateStorageLocked() const;
+
+  /** \brief Unique id of this storage, used as key in the thread-local caches. Ids are never reused, so cache
+      entries of destroyed storages can never be mistaken for ours. */
+  const std::size_t id_;
   moveit::core::RobotState start_state_;
   mutable std::map<std::thread::id, moveit::core::RobotState*> thread_states_;
   mutable std::mutex lock_;
+  mutable std::atomic<std::size_t> locked_lookups_;
 };
 }  // namespace ompl_interface
@@ -0,0 +1,141 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit_msgs/msg/allowed_collision_matrix.hpp>
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ompl_interface
+{
+MOVEIT_CLASS_FORWARD(ValidityCache);  // Defines ValidityCachePtr, ConstPtr, WeakPtr... etc
+
+/** @class ValidityCache
+    @brief Remembers the collision status and clearance of group states across planning requests.
+
+    States are identified by their group variable values, discretized at a fixed resolution. Only the result of the
+    collision check is cached; bounds, path constraints and feasibility are still checked for every state, as they
+    differ between requests.
+
+    Before each request, update() compares the planning scene with the one the cached results were computed in. When
+    world objects were only added, states known to be in collision stay so; when objects were only removed, collision
+    free states stay so. Any other change clears the cache.
+
+    All functions are thread-safe, so one cache can be shared by all planning contexts of a planner configuration. */
+class ValidityCache
+{
+public:
+  struct Entry
+  {
+    bool valid;
+    /** \brief The distance to the nearest obstacle, NaN if it is not known */
+    double clearance;
+  };
+
+  /** \brief Construct a cache for the states of \e group. At most \e max_entries states are remembered. */
+  ValidityCache(const moveit::core::JointModelGroup* group, double resolution = 1e-4,
+                std::size_t max_entries = 1 << 20);
+
+  ValidityCache(const ValidityCache&) = delete;
+  ValidityCache& operator=(const ValidityCache&) = delete;
+
+  /** \brief Drop the cached results that may have changed since the last call, given the planning \e scene and the
+   *  \e state that provides the values of the variables outside the group.
+   *
+   *  Returns the generation of the cache, which changes whenever results are dropped. find() and insert() ignore the
+   *  cache when they are passed another generation, so that a request planning in an outdated scene neither uses nor
+   *  adds results of the current one. */
+  std::uint64_t update(const planning_scene::PlanningScene& scene, const moveit::core::RobotState& state);
+
+  /** \brief Look up the group state of \e state. Returns false if it is not cached. */
+  bool find(const moveit::core::RobotState& state, std::uint64_t generation, Entry& entry) const;
+
+  /** \brief Remember the result of checking the group state of \e state */
+  void insert(const moveit::core::RobotState& state, std::uint64_t generation, const Entry& entry);
+
+  /** \brief The number of cached states */
+  std::size_t size() const;
+
+  void clear();
+
+private:
+  using Key = std::vector<std::int64_t>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct ObjectFingerprint
+  {
+    Eigen::Isometry3d pose;
+    std::vector<shapes::ShapeConstPtr> shapes;
+    EigenSTL::vector_Isometry3d shape_poses;
+  };
+
+  /** \brief Everything in the planning scene and robot state that affects the cached results */
+  struct SceneFingerprint
+  {
+    std::map<std::string, ObjectFingerprint> objects;
+    moveit_msgs::msg::AllowedCollisionMatrix acm;
+    std::vector<std::string> attached_bodies;
+    std::vector<double> fixed_positions;
+  };
+
+  void computeKey(const moveit::core::RobotState& state, Key& key) const;
+
+  /** \brief Drop the entries with the given validity and forget the clearances of the others */
+  void invalidate(bool valid);
+
+  const moveit::core::JointModelGroup* group_;
+  std::vector<int> fixed_variables_;
+  double resolution_;
+  std::size_t max_entries_;
+
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  SceneFingerprint scene_;
+  bool has_scene_;
+  std::uint64_t generation_;
+  mutable std::shared_mutex lock_;
+};
+}  // namespace ompl_interface
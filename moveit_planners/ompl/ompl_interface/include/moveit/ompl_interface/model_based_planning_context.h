@@ -39,6 +39,7 @@
 #include <moveit/ompl_interface/parameterization/model_based_state_space.h>
 #include <moveit/constraint_samplers/constraint_sampler_manager.h>
 #include <moveit/planning_interface/planning_interface.h>
+#include <moveit/robot_state/robot_state_pool.h>
 
 #include <ompl/geometric/SimpleSetup.h>
 #include <ompl/tools/benchmark/Benchmark.h>
@@ -54,6 +55,8 @@ namespace ot = ompl::tools;
 
 MOVEIT_CLASS_FORWARD(ModelBasedPlanningContext);  // Defines ModelBasedPlanningContextPtr, ConstPtr, WeakPtr... etc
 MOVEIT_CLASS_FORWARD(ConstraintsLibrary);         // Defines ConstraintsLibraryPtr, ConstPtr, WeakPtr... etc
+MOVEIT_CLASS_FORWARD(ExperienceDatabase);         // Defines ExperienceDatabasePtr, ConstPtr, WeakPtr... etc
+MOVEIT_CLASS_FORWARD(ValidityCache);              // Defines ValidityCachePtr, ConstPtr, WeakPtr... etc
 
 struct ModelBasedPlanningContextSpecification;
 typedef std::function<ob::PlannerPtr(const ompl::base::SpaceInformationPtr& si, const std::string& name,
@@ -111,6 +114,8 @@ public:
 
   void setSpecificationConfig(const std::map<std::string, std::string>& config)
   {
+    if (config != spec_.config_)
+      warm_ = false;
     spec_.config_ = config;
   }
 
@@ -195,6 +200,32 @@ public:
     max_goal_samples_ = max_goal_samples;
   }
 
+  /* \brief Get the number of threads that sample goals in the background, in addition to OMPL's sampling thread */
+  unsigned int getGoalSamplingThreads() const
+  {
+    return goal_sampling_threads_;
+  }
+
+  /* \brief Set the number of threads that sample goals in the background. The constraint samplers of the goals, and
+     the kinematics solvers they use, need to be safe to run concurrently. */
+  void setGoalSamplingThreads(unsigned int goal_sampling_threads)
+  {
+    goal_sampling_threads_ = goal_sampling_threads;
+  }
+
+  /* \brief Get the number of threads that simplify a solution concurrently */
+  unsigned int getSimplificationThreads() const
+  {
+    return simplification_threads_;
+  }
+
+  /* \brief Set the number of threads that simplify a solution concurrently, each from its own copy of the path with
+     its own random shortcuts. The shortest result is kept. With one thread, OMPL's simplifier is used as is. */
+  void setSimplificationThreads(unsigned int simplification_threads)
+  {
+    simplification_threads_ = simplification_threads;
+  }
+
   /* \brief Get the maximum number of planning threads allowed */
   unsigned int getMaximumPlanningThreads() const
   {
@@ -269,6 +300,42 @@ public:
     return constraints_library_;
   }
 
+  /** \brief Answer requests from the solution paths stored in \e experience_database before planning, and store new
+   *  solutions in it. Set by the PlanningContextManager when the 'experience' planner parameter is true. */
+  void setExperienceDatabase(const ExperienceDatabasePtr& experience_database)
+  {
+    experience_database_ = experience_database;
+  }
+
+  const ExperienceDatabasePtr& getExperienceDatabase() const
+  {
+    return experience_database_;
+  }
+
+  /** \brief Remember the collision status of states across requests in \e validity_cache, and validate motions
+   *  lazily against it. Set by the PlanningContextManager when the 'validity_cache' planner parameter is true. */
+  void setValidityCache(const ValidityCachePtr& validity_cache)
+  {
+    validity_cache_ = validity_cache;
+  }
+
+  const ValidityCachePtr& getValidityCache() const
+  {
+    return validity_cache_;
+  }
+
+  /** \brief The generation of the validity cache for the current planning scene, see ValidityCache::update() */
+  std::uint64_t getValidityCacheGeneration() const
+  {
+    return validity_cache_generation_;
+  }
+
+  /** \brief Whether the last solution was repaired from a stored path instead of planned */
+  bool isLastSolutionFromExperience() const
+  {
+    return last_solution_from_experience_;
+  }
+
   bool simplifySolutions() const
   {
     return simplify_solutions_;
@@ -289,6 +356,13 @@ public:
     hybridize_ = flag;
   }
 
+  /** \brief Whether configure() keeps the planner, projection evaluator and parameters set up by the previous
+   *  request instead of rebuilding them. Set with the 'warm_context' planner parameter. */
+  bool isWarmContextEnabled() const
+  {
+    return warm_context_enabled_;
+  }
+
   /* @brief Solve the planning problem. Return true if the problem is solved
      @param timeout The time to spend on solving
      @param count The number of runs to combine the paths of, in an attempt to generate better quality paths
@@ -319,6 +393,9 @@ public:
      @param timeout The amount of time allowed to be spent on simplifying the plan*/
   void simplifySolution(double timeout);
 
+  /* @brief Simplify the solution with simplification_threads_ threads, keeping the best result */
+  void simplifySolutionInParallel(const ompl::base::PlannerTerminationCondition& ptc);
+
   /* @brief Interpolate the solution*/
   void interpolateSolution();
 
@@ -339,6 +416,10 @@ public:
    *
    * ompl_simple_setup_ gets a start state, state sampler, and state validity checker.
    *
+   * If warm contexts are enabled and this context was fully configured before, only the start state and the state
+   * validity checker are replaced. The constraint approximations, the planner configuration and the planner
+   * itself are kept from the previous request.
+   *
    * \param node ROS node used to load the constraint approximations.
    * \param use_constraints_approximations Set to true if we want to load the constraint approximation.
    * */
@@ -348,6 +429,12 @@ protected:
   void preSolve();
   void postSolve();
 
+  /** \brief Try to answer the current request by repairing a path of the experience database */
+  bool solveFromExperience(const ob::PlannerTerminationCondition& ptc);
+
+  /** \brief Add the current solution to the experience database, unless it was retrieved from there */
+  void storeExperience();
+
   void startSampling();
   void stopSampling();
 
@@ -394,6 +481,9 @@ protected:
 
   moveit::core::RobotState complete_initial_robot_state_;
 
+  /// the waypoints of solution paths are taken from this pool
+  moveit::core::RobotStatePoolPtr state_pool_;
+
   /// the OMPL planning context; this contains the problem definition and the planner used
   og::SimpleSetupPtr ompl_simple_setup_;
 
@@ -429,9 +519,15 @@ protected:
   /// maximum number of attempts to be made at sampling a goal states
   unsigned int max_goal_sampling_attempts_;
 
+  /// number of threads that fill a queue of valid goal states while OMPL samples goals
+  unsigned int goal_sampling_threads_;
+
   /// when planning in parallel, this is the maximum number of threads to use at one time
   unsigned int max_planning_threads_;
 
+  /// number of threads that simplify the solution concurrently
+  unsigned int simplification_threads_;
+
   /// the maximum length that is allowed for segments that make up the motion plan; by default this is 1% from the
   /// extent of the space
   double max_solution_segment_length_;
@@ -445,6 +541,14 @@ protected:
 
   ConstraintsLibraryPtr constraints_library_;
 
+  ExperienceDatabasePtr experience_database_;
+
+  ValidityCachePtr validity_cache_;
+
+  std::uint64_t validity_cache_generation_;
+
+  bool last_solution_from_experience_;
+
   bool simplify_solutions_;
 
   // if false the final solution is not interpolated
@@ -452,5 +556,14 @@ protected:
 
   // if false parallel plan returns the first solution found
   bool hybridize_;
+
+  // if true, a configured context is reused by configure() without being set up again
+  bool warm_context_enabled_;
+
+  // true once configure() fully set up this context with warm contexts enabled
+  bool warm_;
+
+  // the use_constraints_approximations flag of the configure() call that set up the warm context
+  bool warm_constraints_approximations_;
 };
 }  // namespace ompl_interface
@@ -77,5 +77,7 @@ public:
   void copyToOMPLState(ompl::base::State* ompl_state, const moveit::core::RobotState& robot_state) const override;
   void copyJointToOMPLState(ompl::base::State* ompl_state, const moveit::core::RobotState& robot_state,
                             const moveit::core::JointModel* joint_model, int ompl_state_joint_index) const override;
+
+  const StateType* getModelBasedState(const ompl::base::State* ompl_state) const override;
 };
 }  // namespace ompl_interface
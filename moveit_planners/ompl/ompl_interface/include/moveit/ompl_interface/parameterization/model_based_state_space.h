@@ -83,7 +83,8 @@ public:
       GOAL_DISTANCE_KNOWN = 2,
       VALIDITY_TRUE = 4,
       IS_START_STATE = 8,
-      IS_GOAL_STATE = 16
+      IS_GOAL_STATE = 16,
+      PROJECTION_KNOWN = 32
     };
 
     StateType() : ompl::base::State(), values(nullptr), tag(-1), flags(0), distance(0.0)
@@ -160,10 +161,25 @@ public:
       flags |= IS_GOAL_STATE;
     }
 
+    /** \brief Store the position of the projection link, computed by FK of this state */
+    void markProjection(const Eigen::Vector3d& position)
+    {
+      projection[0] = position.x();
+      projection[1] = position.y();
+      projection[2] = position.z();
+      flags |= PROJECTION_KNOWN;
+    }
+
+    bool isProjectionKnown() const
+    {
+      return flags & PROJECTION_KNOWN;
+    }
+
     double* values;
     int tag;
     int flags;
     double distance;
+    double projection[3];
   };
 
   ModelBasedStateSpace(ModelBasedStateSpaceSpecification spec);
@@ -234,7 +250,9 @@ public:
   }
 
   /// Copy the data from an OMPL state to a set of joint states.
-  // The joint states \b must be specified in the same order as the joint models in the constructor
+  // The joint states \b must be specified in the same order as the joint models in the constructor.
+  // For groups of revolute and prismatic joints stored contiguously in the robot state, only the joints whose
+  // values change are marked dirty, so the transforms of the links above them are not recomputed.
   virtual void copyToRobotState(moveit::core::RobotState& rstate, const ompl::base::State* state) const;
 
   /// Copy the data from a set of joint states to an OMPL state.
@@ -254,6 +272,32 @@ public:
   virtual void copyJointToOMPLState(ompl::base::State* state, const moveit::core::RobotState& robot_state,
                                     const moveit::core::JointModel* joint_model, int ompl_state_joint_index) const;
 
+  /// Get the StateType holding the values of \e state. States of derived spaces may wrap it.
+  virtual const StateType* getModelBasedState(const ompl::base::State* state) const
+  {
+    return state->as<StateType>();
+  }
+
+  /// Set the link whose position is cached in the states whenever FK is computed for them, e.g. by the state
+  /// validity checker, so a projection evaluator for that link does not compute FK again. nullptr disables caching.
+  void setProjectionLink(const moveit::core::LinkModel* link)
+  {
+    projection_link_ = link;
+  }
+
+  const moveit::core::LinkModel* getProjectionLink() const
+  {
+    return projection_link_;
+  }
+
+  /// Cache the position of the projection link in \e state, if there is one. \e rstate must hold \e state with
+  /// up-to-date link transforms.
+  void cacheProjection(const StateType* state, const moveit::core::RobotState& rstate) const
+  {
+    if (projection_link_)
+      const_cast<StateType*>(state)->markProjection(rstate.getGlobalLinkTransform(projection_link_).translation());
+  }
+
   double getTagSnapToSegment() const;
   void setTagSnapToSegment(double snap);
 
@@ -264,10 +308,16 @@ protected:
   unsigned int variable_count_;
   size_t state_values_size_;
 
+  /// index of the first group variable in the robot state if the group only consists of single-variable joints
+  /// stored contiguously in group order, -1 otherwise
+  int contiguous_variable_index_;
+
   InterpolationFunction interpolation_function_;
   DistanceFunction distance_function_;
 
   double tag_snap_to_segment_;
   double tag_snap_to_segment_complement_;
+
+  const moveit::core::LinkModel* projection_link_ = nullptr;
 };
 }  // namespace ompl_interface
@@ -43,8 +43,22 @@
 
 #include <ompl/base/PlannerDataStorage.h>
 
-#include <string>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace ompl
+{
+namespace geometric
+{
+class PRM;
+}
+}  // namespace ompl
 
 namespace ompl_interface
 {
@@ -67,13 +81,41 @@ private:
   template <typename T>
   inline ob::Planner* allocatePersistentPlanner(const ob::PlannerData& data);
 
-  // Storing multi-query planners
+  /** \brief Load planner data stored with storeRoadmap(), or else with ob::PlannerDataStorage */
+  void loadPlannerData(const std::string& file_path, ob::PlannerData& data);
+
+  /** \brief Get the roadmap of planner \e name, or of its grower if that roadmap is larger. Requires planners_mutex_
+   *  to be locked, unless no planners are allocated concurrently. */
+  void getRoadmap(const std::string& name, ob::PlannerData& data);
+
+  /** \brief Grow the roadmaps of the PRM planners while no planner was allocated for a while */
+  void growRoadmaps();
+
+  // A copy of a PRM planner that extends its roadmap in the background, up to max_vertices milestones
+  struct RoadmapGrower
+  {
+    std::unique_ptr<ob::PlannerData> seed;
+    std::function<ompl::geometric::PRM*(const ob::PlannerData&)> allocate;
+    std::shared_ptr<ompl::geometric::PRM> planner;
+    unsigned int max_vertices;
+  };
+
+  // Storing multi-query planners, guarded by planners_mutex_
   std::map<std::string, ob::PlannerPtr> planners_;
 
   std::map<std::string, std::string> planner_data_storage_paths_;
+  std::mutex planners_mutex_;
 
   // Store and load planner data
   ob::PlannerDataStorage storage_;
+
+  // Background roadmap growth, guarded by growth_mutex_
+  std::map<std::string, RoadmapGrower> growers_;
+  std::mutex growth_mutex_;
+  std::condition_variable growth_condition_;
+  std::chrono::steady_clock::time_point last_allocation_;
+  bool stop_growth_{ false };
+  std::thread growth_thread_;
 };
 
 class PlanningContextManager
@@ -215,7 +257,12 @@ protected:
   template <typename T>
   void registerPlannerAllocatorHelper(const std::string& planner_id);
 
-  /** \brief This is the function that constructs new planning contexts if no previous ones exist that are suitable */
+  /** \brief Construct a new planning context for \e config */
+  ModelBasedPlanningContextPtr createPlanningContext(const planning_interface::PlannerConfigurationSettings& config,
+                                                     const ModelBasedStateSpaceFactoryPtr& factory,
+                                                     const moveit_msgs::msg::MotionPlanRequest& req) const;
+
+  /** \brief Get an idle cached planning context for \e config, or construct a new one if all are in use */
   ModelBasedPlanningContextPtr getPlanningContext(const planning_interface::PlannerConfigurationSettings& config,
                                                   const ModelBasedStateSpaceFactoryPtr& factory,
                                                   const moveit_msgs::msg::MotionPlanRequest& req) const;
@@ -55,14 +55,14 @@ static const std::string ROBOT_DESCRIPTION = "robot_description";
 static const std::string CONSTRAINT_PARAMETER = "constraints";
 
 static bool get_uint_parameter_or(const rclcpp::Node::SharedPtr& node, const std::string& param_name,
-                                  size_t&& result_value, const size_t default_value)
+                                  unsigned int& result_value, const unsigned int default_value)
 {
   int param_value;
   if (node->get_parameter(param_name, param_value))
   {
     if (param_value >= 0)
     {
-      result_value = static_cast<size_t>(param_value);
+      result_value = static_cast<unsigned int>(param_value);
       return true;
     }
 
@@ -95,6 +95,9 @@ struct GenerateStateDatabaseParameters
     node->get_parameter_or("explicit_points_resolution", construction_opts.explicit_points_resolution, 0.05);
     get_uint_parameter_or(node, "max_explicit_points", construction_opts.max_explicit_points, 200);
 
+    // 0 uses all hardware threads
+    get_uint_parameter_or(node, "num_threads", construction_opts.num_threads, 0);
+
     // local planning in JointModel state space
     node->get_parameter_or("state_space_parameterization", construction_opts.state_space_parameterization,
                            std::string("JointModel"));
@@ -0,0 +1,153 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/ompl_interface/detail/cached_motion_validator.h>
+#include <moveit/ompl_interface/model_based_planning_context.h>
+#include <queue>
+
+namespace ompl_interface
+{
+CachedMotionValidator::CachedMotionValidator(const ModelBasedPlanningContext* pc)
+  : ompl::base::MotionValidator(pc->getOMPLSimpleSetup()->getSpaceInformation())
+  , planning_context_(pc)
+  , validity_cache_(pc->getValidityCache())
+  , validity_cache_generation_(pc->getValidityCacheGeneration())
+  , tss_(pc->getCompleteInitialRobotState())
+{
+}
+
+bool CachedMotionValidator::containsKnownInvalid(const std::vector<ompl::base::State*>& states) const
+{
+  if (!validity_cache_)
+    return false;
+
+  moveit::core::RobotState* robot_state = tss_.getStateStorage();
+  ValidityCache::Entry entry;
+  for (const ompl::base::State* state : states)
+  {
+    planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, state);
+    if (validity_cache_->find(*robot_state, validity_cache_generation_, entry) && !entry.valid)
+      return true;
+  }
+  return false;
+}
+
+bool CachedMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const
+{
+  if (!si_->isValid(s2))
+  {
+    invalid_++;
+    return false;
+  }
+
+  std::vector<ompl::base::State*> states;
+  const unsigned int segment_count = si_->getStateSpace()->validSegmentCount(s1, s2);
+  if (segment_count > 1)
+    si_->getMotionStates(s1, s2, states, segment_count - 1, false, true);
+
+  bool result = !containsKnownInvalid(states);
+  if (result && !states.empty())
+  {
+    // check in bisection order like the DiscreteMotionValidator, which finds collisions with fewer checks
+    std::queue<std::pair<std::size_t, std::size_t>> intervals;
+    intervals.emplace(0, states.size() - 1);
+    while (!intervals.empty())
+    {
+      const auto [first, last] = intervals.front();
+      intervals.pop();
+      const std::size_t mid = (first + last) / 2;
+      if (!si_->isValid(states[mid]))
+      {
+        result = false;
+        break;
+      }
+      if (first < mid)
+        intervals.emplace(first, mid - 1);
+      if (mid < last)
+        intervals.emplace(mid + 1, last);
+    }
+  }
+  si_->freeStates(states);
+
+  if (result)
+  {
+    valid_++;
+  }
+  else
+  {
+    invalid_++;
+  }
+  return result;
+}
+
+bool CachedMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                                        std::pair<ompl::base::State*, double>& last_valid) const
+{
+  // the last valid state is only known when checking in order, so the cache is only used through the validity checker
+  const unsigned int segment_count = si_->getStateSpace()->validSegmentCount(s1, s2);
+  bool result = true;
+  unsigned int last_valid_step = segment_count;
+  ompl::base::State* test = si_->allocState();
+  for (unsigned int j = 1; j < segment_count && result; ++j)
+  {
+    si_->getStateSpace()->interpolate(s1, s2, static_cast<double>(j) / segment_count, test);
+    if (!si_->isValid(test))
+    {
+      last_valid_step = j - 1;
+      result = false;
+    }
+  }
+  si_->freeState(test);
+
+  if (result && !si_->isValid(s2))
+  {
+    last_valid_step = segment_count - 1;
+    result = false;
+  }
+
+  if (!result)
+  {
+    last_valid.second = static_cast<double>(last_valid_step) / segment_count;
+    if (last_valid.first != nullptr)
+      si_->getStateSpace()->interpolate(s1, s2, last_valid.second, last_valid.first);
+    invalid_++;
+  }
+  else
+  {
+    valid_++;
+  }
+  return result;
+}
+}  // namespace ompl_interface
@@ -38,6 +38,7 @@
 #include <moveit/ompl_interface/model_based_planning_context.h>
 #include <moveit/ompl_interface/detail/state_validity_checker.h>
 
+#include <algorithm>
 #include <utility>
 
 namespace ompl_interface
@@ -47,7 +48,9 @@ static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ompl_planning.co
 
 ompl_interface::ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedPlanningContext* pc,
                                                                kinematic_constraints::KinematicConstraintSetPtr ks,
-                                                               constraint_samplers::ConstraintSamplerPtr cs)
+                                                               constraint_samplers::ConstraintSamplerPtr cs,
+                                                               std::vector<constraint_samplers::ConstraintSamplerPtr>
+                                                                   background_samplers)
   : ob::GoalLazySamples(
         pc->getOMPLSimpleSetup()->getSpaceInformation(),
         [this](const GoalLazySamples* gls, ompl::base::State* state) {
@@ -61,6 +64,8 @@ ompl_interface::ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedP
   , invalid_sampled_constraints_(0)
   , warned_invalid_samples_(false)
   , verbose_display_(0)
+  , background_samplers_(std::move(background_samplers))
+  , stop_background_sampling_(false)
 {
   if (!constraint_sampler_)
     default_sampler_ = si_->allocStateSampler();
@@ -68,6 +73,13 @@ ompl_interface::ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedP
   startSampling();
 }
 
+ompl_interface::ConstrainedGoalSampler::~ConstrainedGoalSampler()
+{
+  // the sampling thread calls into this instance, so it has to finish before the members are destroyed
+  stopSampling();
+  stopBackgroundSampling();
+}
+
 bool ompl_interface::ConstrainedGoalSampler::checkStateValidity(ob::State* new_goal,
                                                                 const moveit::core::RobotState& state,
                                                                 bool verbose) const
@@ -88,8 +100,101 @@ bool ompl_interface::ConstrainedGoalSampler::stateValidityCallback(ob::State* ne
   return checkStateValidity(new_goal, solution_state, verbose);
 }
 
+void ompl_interface::ConstrainedGoalSampler::startBackgroundSampling()
+{
+  if (!background_threads_.empty() || background_samplers_.empty())
+    return;
+  stop_background_sampling_ = false;
+  for (const constraint_samplers::ConstraintSamplerPtr& sampler : background_samplers_)
+    background_threads_.emplace_back([this, &sampler] { backgroundSampling(sampler); });
+}
+
+void ompl_interface::ConstrainedGoalSampler::stopBackgroundSampling()
+{
+  if (background_threads_.empty())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(background_goals_lock_);
+    stop_background_sampling_ = true;
+  }
+  background_goals_condition_.notify_all();
+  for (std::thread& thread : background_threads_)
+    thread.join();
+  background_threads_.clear();
+
+  // goals that were not used are specific to the current request
+  for (ob::State* goal : background_goals_)
+    si_->freeState(goal);
+  background_goals_.clear();
+}
+
+void ompl_interface::ConstrainedGoalSampler::backgroundSampling(
+    const constraint_samplers::ConstraintSamplerPtr& sampler)
+{
+  moveit::core::RobotState state(planning_context_->getCompleteInitialRobotState());
+  ob::State* goal = si_->allocState();
+  sampler->setGroupStateValidityCallback([this, goal](moveit::core::RobotState* robot_state,
+                                                      const moveit::core::JointModelGroup* joint_group,
+                                                      const double* joint_group_variable_values) {
+    return stateValidityCallback(goal, robot_state, joint_group, joint_group_variable_values);
+  });
+
+  const std::size_t max_queued_goals = std::max(1u, planning_context_->getMaximumGoalSamples());
+  const ob::ProblemDefinitionPtr& pdef = planning_context_->getOMPLSimpleSetup()->getProblemDefinition();
+  while (!pdef->hasSolution())
+  {
+    {
+      std::unique_lock<std::mutex> lock(background_goals_lock_);
+      background_goals_condition_.wait(lock, [this, max_queued_goals] {
+        return stop_background_sampling_ || background_goals_.size() < max_queued_goals;
+      });
+      if (stop_background_sampling_)
+        break;
+    }
+
+    if (sampler->sample(state, planning_context_->getMaximumStateSamplingAttempts()))
+    {
+      state.update();
+      if (kinematic_constraint_set_->isSatisfied(state) && checkStateValidity(goal, state))
+      {
+        std::lock_guard<std::mutex> lock(background_goals_lock_);
+        background_goals_.push_back(si_->cloneState(goal));
+      }
+    }
+  }
+  si_->freeState(goal);
+}
+
+bool ompl_interface::ConstrainedGoalSampler::takeBackgroundGoal(ob::State* new_goal)
+{
+  if (background_threads_.empty())
+    return false;
+  ob::State* goal = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(background_goals_lock_);
+    if (background_goals_.empty())
+      return false;
+    goal = background_goals_.front();
+    background_goals_.pop_front();
+  }
+  background_goals_condition_.notify_one();
+  si_->copyState(new_goal, goal);
+  si_->freeState(goal);
+  return true;
+}
+
 bool ompl_interface::ConstrainedGoalSampler::sampleUsingConstraintSampler(const ob::GoalLazySamples* gls,
                                                                           ob::State* new_goal)
+{
+  // the background threads only run while the OMPL sampling thread keeps asking for goals
+  startBackgroundSampling();
+  if (sampleGoal(gls, new_goal))
+    return true;
+  stopBackgroundSampling();
+  return false;
+}
+
+bool ompl_interface::ConstrainedGoalSampler::sampleGoal(const ob::GoalLazySamples* gls, ob::State* new_goal)
 {
   unsigned int max_attempts = planning_context_->getMaximumGoalSamplingAttempts();
   unsigned int attempts_so_far = gls->samplingAttemptsCount();
@@ -119,6 +224,9 @@ bool ompl_interface::ConstrainedGoalSampler::sampleUsingConstraintSampler(const
       }
     }
 
+    if (takeBackgroundGoal(new_goal))
+      return true;
+
     if (constraint_sampler_)
     {
       // makes the constraint sampler also perform a validity callback
@@ -133,7 +241,7 @@ bool ompl_interface::ConstrainedGoalSampler::sampleUsingConstraintSampler(const
       if (constraint_sampler_->sample(work_state_, planning_context_->getMaximumStateSamplingAttempts()))
       {
         work_state_.update();
-        if (kinematic_constraint_set_->decide(work_state_, verbose).satisfied)
+        if (kinematic_constraint_set_->isSatisfied(work_state_, verbose))
         {
           if (checkStateValidity(new_goal, work_state_, verbose))
             return true;
@@ -157,7 +265,7 @@ bool ompl_interface::ConstrainedGoalSampler::sampleUsingConstraintSampler(const
       if (static_cast<const StateValidityChecker*>(si_->getStateValidityChecker().get())->isValid(new_goal, verbose))
       {
         planning_context_->getOMPLStateSpace()->copyToRobotState(work_state_, new_goal);
-        if (kinematic_constraint_set_->decide(work_state_, verbose).satisfied)
+        if (kinematic_constraint_set_->isSatisfied(work_state_, verbose))
           return true;
       }
     }
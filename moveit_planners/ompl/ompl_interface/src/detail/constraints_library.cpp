@@ -35,10 +35,17 @@
 /* Author: Ioan Sucan */
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <thread>
 #include <moveit/ompl_interface/detail/constrained_sampler.h>
 #include <moveit/ompl_interface/detail/constraints_library.h>
+#include <moveit/utils/mapped_file.h>
+#include <moveit/utils/worker_pool.h>
 
 #include <ompl/tools/config/SelfConfig.h>
 #include <utility>
@@ -99,6 +106,172 @@ void hexToMsg(const std::string& hex, T& msg)
     return;
   }
 }
+
+// Layout of a binary approximation file: the header below, followed by num_states state records of record_size
+// bytes (the state space serialization, padded to a multiple of 8 bytes), the connections as num_states + 1 offsets
+// into num_neighbors neighbor indices, and the explicit motions as num_states + 1 offsets into num_motions records
+// of (neighbor, first state, end state). All integers after the header are 64 bit.
+constexpr char APPROXIMATION_FILE_MAGIC[8] = { 'M', 'V', 'C', 'A', 'P', 'P', 'R', 'X' };
+constexpr std::uint32_t APPROXIMATION_FILE_VERSION = 1;
+
+struct ApproximationFileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t num_states;
+  std::uint64_t num_neighbors;
+  std::uint64_t num_motions;
+};
+
+std::size_t recordSize(const ob::StateSpace& space)
+{
+  return (space.getSerializationLength() + 7) & ~static_cast<std::size_t>(7);
+}
+
+template <typename T>
+void writeValue(std::ofstream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+bool storeApproximationStates(const ConstraintApproximationStateStorage& storage, const std::string& filename)
+{
+  const ob::StateSpace& space = *storage.getStateSpace();
+  const std::size_t record_size = recordSize(space);
+
+  ApproximationFileHeader header{};
+  memcpy(header.magic, APPROXIMATION_FILE_MAGIC, sizeof(header.magic));
+  header.version = APPROXIMATION_FILE_VERSION;
+  header.record_size = record_size;
+  header.num_states = storage.size();
+  for (std::size_t i = 0; i < storage.size(); ++i)
+  {
+    header.num_neighbors += storage.getMetadata(i).first.size();
+    header.num_motions += storage.getMetadata(i).second.size();
+  }
+
+  // write to a temporary file first, so processes reading the old file never see a partial one
+  const std::string tmp_filename = filename + ".tmp" + std::to_string(moveit::core::processId());
+  {
+    std::ofstream out(tmp_filename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (!out.good())
+      return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<char> record(record_size, 0);
+    for (std::size_t i = 0; i < storage.size(); ++i)
+    {
+      space.serialize(record.data(), storage.getState(i));
+      out.write(record.data(), record_size);
+    }
+
+    std::uint64_t offset = 0;
+    writeValue(out, offset);
+    for (std::size_t i = 0; i < storage.size(); ++i)
+    {
+      offset += storage.getMetadata(i).first.size();
+      writeValue(out, offset);
+    }
+    for (std::size_t i = 0; i < storage.size(); ++i)
+    {
+      for (std::size_t neighbor : storage.getMetadata(i).first)
+        writeValue(out, static_cast<std::uint64_t>(neighbor));
+    }
+
+    offset = 0;
+    writeValue(out, offset);
+    for (std::size_t i = 0; i < storage.size(); ++i)
+    {
+      offset += storage.getMetadata(i).second.size();
+      writeValue(out, offset);
+    }
+    for (std::size_t i = 0; i < storage.size(); ++i)
+    {
+      for (const auto& [neighbor, states] : storage.getMetadata(i).second)
+      {
+        writeValue(out, static_cast<std::uint64_t>(neighbor));
+        writeValue(out, static_cast<std::uint64_t>(states.first));
+        writeValue(out, static_cast<std::uint64_t>(states.second));
+      }
+    }
+    if (!out.good())
+    {
+      out.close();
+      std::filesystem::remove(tmp_filename);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_filename, filename, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tmp_filename, ec);
+    return false;
+  }
+  return true;
+}
+
+/** Fill \e storage from a binary approximation file. Returns false if the file is not in the binary format (e.g.
+    it was stored by OMPL's StateStorage) or does not match the state space of \e storage. */
+bool loadApproximationStates(ConstraintApproximationStateStorage& storage, const std::string& filename)
+{
+  const moveit::core::MappedFile file(filename);
+  ApproximationFileHeader header;
+  if (file.size() < sizeof(header))
+    return false;
+  memcpy(&header, file.begin(), sizeof(header));
+  if (memcmp(header.magic, APPROXIMATION_FILE_MAGIC, sizeof(header.magic)) != 0)
+    return false;
+
+  const ob::StateSpace& space = *storage.getStateSpace();
+  if (header.version != APPROXIMATION_FILE_VERSION || header.record_size != recordSize(space))
+  {
+    RCLCPP_ERROR(LOGGER, "Constraint approximation '%s' has version %u and record size %u, expected %u and %zu",
+                 filename.c_str(), header.version, header.record_size, APPROXIMATION_FILE_VERSION,
+                 recordSize(space));
+    return false;
+  }
+
+  const std::uint64_t expected_size = sizeof(header) + header.num_states * header.record_size +
+                                      2 * (header.num_states + 1) * sizeof(std::uint64_t) +
+                                      (header.num_neighbors + 3 * header.num_motions) * sizeof(std::uint64_t);
+  if (file.size() != expected_size)
+  {
+    RCLCPP_ERROR(LOGGER, "Constraint approximation '%s' is truncated or corrupt", filename.c_str());
+    return false;
+  }
+
+  const char* records = file.begin() + sizeof(header);
+  const auto* neighbor_offsets =
+      reinterpret_cast<const std::uint64_t*>(records + header.num_states * header.record_size);
+  const std::uint64_t* neighbors = neighbor_offsets + header.num_states + 1;
+  const std::uint64_t* motion_offsets = neighbors + header.num_neighbors;
+  const std::uint64_t* motions = motion_offsets + header.num_states + 1;
+  if (neighbor_offsets[header.num_states] != header.num_neighbors ||
+      motion_offsets[header.num_states] != header.num_motions)
+  {
+    RCLCPP_ERROR(LOGGER, "Constraint approximation '%s' has an inconsistent index", filename.c_str());
+    return false;
+  }
+
+  storage.clear();
+  ob::State* state = space.allocState();
+  ConstrainedStateMetadata metadata;
+  for (std::size_t i = 0; i < header.num_states; ++i)
+  {
+    space.deserialize(state, records + i * header.record_size);
+    metadata.first.assign(neighbors + neighbor_offsets[i], neighbors + neighbor_offsets[i + 1]);
+    metadata.second.clear();
+    for (std::uint64_t k = motion_offsets[i]; k < motion_offsets[i + 1]; ++k)
+      metadata.second.emplace_hint(metadata.second.end(), motions[3 * k],
+                                   std::make_pair(motions[3 * k + 1], motions[3 * k + 2]));
+    storage.addState(state, metadata);
+  }
+  space.freeState(state);
+  return true;
+}
 }  // namespace
 
 class ConstraintApproximationStateSampler : public ob::StateSampler
@@ -363,7 +536,12 @@ void ompl_interface::ConstraintsLibrary::loadConstraintApproximations(const std:
     moveit_msgs::msg::Constraints msg;
     hexToMsg(serialization, msg);
     auto* cass = new ConstraintApproximationStateStorage(context_->getOMPLSimpleSetup()->getStateSpace());
-    cass->load((std::string{ path }.append("/").append(filename)).c_str());
+    const std::string file_path = std::string{ path }.append("/").append(filename);
+    if (!loadApproximationStates(*cass, file_path))
+    {
+      // approximations stored before the binary format was introduced
+      cass->load(file_path.c_str());
+    }
     auto cap = std::make_shared<ConstraintApproximation>(group, state_space_parameterization, explicit_motions, msg,
                                                          filename, ompl::base::StateStoragePtr(cass), milestones);
     if (constraint_approximations_.find(cap->getName()) != constraint_approximations_.end())
@@ -408,8 +586,14 @@ void ompl_interface::ConstraintsLibrary::saveConstraintApproximations(const std:
       msgToHex(it->second->getConstraintsMsg(), serialization);
       fout << serialization << '\n';
       fout << it->second->getFilename() << '\n';
-      if (it->second->getStateStorage())
-        it->second->getStateStorage()->store((path + "/" + it->second->getFilename()).c_str());
+      if (it->second->getStateStorage() &&
+          !storeApproximationStates(
+              *static_cast<const ConstraintApproximationStateStorage*>(it->second->getStateStorage().get()),
+              path + "/" + it->second->getFilename()))
+      {
+        RCLCPP_ERROR(LOGGER, "Unable to save the states of constraint approximation '%s'",
+                     it->second->getName().c_str());
+      }
     }
   }
   else
@@ -540,44 +724,70 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
   ob::StateSamplerPtr ss(constrained_sampler ? ob::StateSamplerPtr(constrained_sampler) :
                                                pcontext->getOMPLStateSpace()->allocDefaultStateSampler());
 
-  ompl::base::ScopedState<> temp(pcontext->getOMPLStateSpace());
+  const unsigned int num_threads = options.num_threads ? options.num_threads :
+                                                         std::max(1u, std::thread::hardware_concurrency());
+  moveit::core::WorkerPool pool(num_threads);
+
+  // constraint samplers (e.g. IK based ones) are not safe to share between threads, so sampling only runs in
+  // parallel when states are drawn from the default sampler
+  const unsigned int sampling_threads = constrained_sampler ? 1 : pool.size();
+  std::vector<ob::StateSamplerPtr> samplers(sampling_threads);
+  std::vector<moveit::core::RobotState> robot_states(pool.size(), robot_state);
+  samplers[0] = ss;
+  for (unsigned int t = 1; t < sampling_threads; ++t)
+    samplers[t] = pcontext->getOMPLStateSpace()->allocDefaultStateSampler();
+
+  std::mutex storage_lock;
+  bool abort_sampling = false;
   int done = -1;
   bool slow_warn = false;
   ompl::time::point start = ompl::time::now();
-  while (state_storage->size() < options.samples)
-  {
-    ++attempts;
-    int done_now = 100 * state_storage->size() / options.samples;
-    if (done != done_now)
+  pool.run(sampling_threads, [&](std::size_t /*index*/, unsigned int thread) {
+    ompl::base::ScopedState<> temp(pcontext->getOMPLStateSpace());
+    moveit::core::RobotState& thread_state = robot_states[thread];
+    const ob::StateSamplerPtr& sampler = samplers[std::min<unsigned int>(thread, sampling_threads - 1)];
+    while (true)
     {
-      done = done_now;
-      RCLCPP_INFO(LOGGER, "%d%% complete (kept %0.1lf%% sampled states)", done,
-                  100.0 * static_cast<double>(state_storage->size()) / static_cast<double>(attempts));
-    }
+      {
+        std::lock_guard<std::mutex> guard(storage_lock);
+        if (abort_sampling || state_storage->size() >= options.samples)
+          return;
+        ++attempts;
+        int done_now = 100 * state_storage->size() / options.samples;
+        if (done != done_now)
+        {
+          done = done_now;
+          RCLCPP_INFO(LOGGER, "%d%% complete (kept %0.1lf%% sampled states)", done,
+                      100.0 * static_cast<double>(state_storage->size()) / static_cast<double>(attempts));
+        }
 
-    if (!slow_warn && attempts > 10 && attempts > state_storage->size() * 100)
-    {
-      slow_warn = true;
-      RCLCPP_WARN(LOGGER, "Computation of valid state database is very slow...");
-    }
+        if (!slow_warn && attempts > 10 && attempts > state_storage->size() * 100)
+        {
+          slow_warn = true;
+          RCLCPP_WARN(LOGGER, "Computation of valid state database is very slow...");
+        }
 
-    if (attempts > options.samples && state_storage->size() == 0)
-    {
-      RCLCPP_ERROR(LOGGER, "Unable to generate any samples");
-      break;
-    }
+        if (attempts > options.samples && state_storage->size() == 0)
+        {
+          RCLCPP_ERROR(LOGGER, "Unable to generate any samples");
+          abort_sampling = true;
+          return;
+        }
+      }
 
-    ss->sampleUniform(temp.get());
-    pcontext->getOMPLStateSpace()->copyToRobotState(robot_state, temp.get());
-    if (kset.decide(robot_state).satisfied)
-    {
-      if (state_storage->size() < options.samples)
+      sampler->sampleUniform(temp.get());
+      pcontext->getOMPLStateSpace()->copyToRobotState(thread_state, temp.get());
+      if (kset.isSatisfied(thread_state))
       {
-        temp->as<ModelBasedStateSpace::StateType>()->tag = state_storage->size();
-        state_storage->addState(temp.get());
+        std::lock_guard<std::mutex> guard(storage_lock);
+        if (state_storage->size() < options.samples)
+        {
+          temp->as<ModelBasedStateSpace::StateType>()->tag = state_storage->size();
+          state_storage->addState(temp.get());
+        }
       }
     }
-  }
+  });
 
   result.state_sampling_time = ompl::time::seconds(ompl::time::now() - start);
   RCLCPP_INFO(LOGGER, "Generated %u states in %lf seconds", static_cast<unsigned int>(state_storage->size()),
@@ -595,14 +805,42 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
 
     // construct connections
     const ob::StateSpacePtr& space = pcontext->getOMPLSimpleSetup()->getStateSpace();
+    const ob::SpaceInformationPtr& si = pcontext->getOMPLSimpleSetup()->getSpaceInformation();
     unsigned int milestones = state_storage->size();
-    std::vector<ob::State*> int_states(options.max_explicit_points, nullptr);
-    pcontext->getOMPLSimpleSetup()->getSpaceInformation()->allocStates(int_states);
+    std::vector<std::vector<ob::State*>> int_states(pool.size());
+    for (std::vector<ob::State*>& thread_int_states : int_states)
+    {
+      thread_int_states.resize(options.max_explicit_points, nullptr);
+      si->allocStates(thread_int_states);
+    }
 
     ompl::time::point start = ompl::time::now();
     int good = 0;
     int done = -1;
 
+    // Checks whether the motion from milestone i to sj stays on the constraint manifold, leaving the intermediate
+    // states in int_states. The milestones are read only while candidate motions are checked.
+    auto check_motion = [&](std::size_t i, const ob::State* sj, double d, std::vector<ob::State*>& states,
+                            moveit::core::RobotState& thread_state) {
+      unsigned int isteps =
+          std::min<unsigned int>(options.max_explicit_points, d / options.explicit_points_resolution);
+      double step = 1.0 / static_cast<double>(isteps);
+      space->interpolate(state_storage->getState(i), sj, step, states[0]);
+      for (unsigned int k = 1; k < isteps; ++k)
+      {
+        double this_step = step / (1.0 - (k - 1) * step);
+        space->interpolate(states[k - 1], sj, this_step, states[k]);
+        pcontext->getOMPLStateSpace()->copyToRobotState(thread_state, states[k]);
+        if (!kset.isSatisfied(thread_state))
+          return false;
+      }
+      return true;
+    };
+
+    std::vector<std::size_t> candidates;
+    std::vector<double> distances;
+    std::vector<char> valid;
+    const std::size_t chunk_size = 4 * pool.size();
     for (std::size_t j = 0; j < milestones; ++j)
     {
       int done_now = 100 * j / milestones;
@@ -616,6 +854,10 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
 
       const ob::State* sj = state_storage->getState(j);
 
+      // edges accepted for j only ever add to the edge count of j itself and of milestones already skipped, so the
+      // candidates can be collected upfront and checked in parallel while still accepting them in sequential order
+      candidates.clear();
+      distances.clear();
       for (std::size_t i = j + 1; i < milestones; ++i)
       {
         if (cass->getMetadata(i).first.size() >= options.edges_per_sample)
@@ -623,35 +865,40 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
         double d = space->distance(state_storage->getState(i), sj);
         if (d >= options.max_edge_length)
           continue;
-        unsigned int isteps =
-            std::min<unsigned int>(options.max_explicit_points, d / options.explicit_points_resolution);
-        double step = 1.0 / static_cast<double>(isteps);
-        bool ok = true;
-        space->interpolate(state_storage->getState(i), sj, step, int_states[0]);
-        for (unsigned int k = 1; k < isteps; ++k)
-        {
-          double this_step = step / (1.0 - (k - 1) * step);
-          space->interpolate(int_states[k - 1], sj, this_step, int_states[k]);
-          pcontext->getOMPLStateSpace()->copyToRobotState(robot_state, int_states[k]);
-          if (!kset.decide(robot_state).satisfied)
-          {
-            ok = false;
-            break;
-          }
-        }
+        candidates.push_back(i);
+        distances.push_back(d);
+      }
 
-        if (ok)
+      for (std::size_t chunk = 0;
+           chunk < candidates.size() && cass->getMetadata(j).first.size() < options.edges_per_sample;
+           chunk += chunk_size)
+      {
+        const std::size_t chunk_end = std::min(candidates.size(), chunk + chunk_size);
+        valid.assign(chunk_end - chunk, 0);
+        pool.run(chunk_end - chunk, [&](std::size_t c, unsigned int thread) {
+          valid[c] = check_motion(candidates[chunk + c], sj, distances[chunk + c], int_states[thread],
+                                  robot_states[thread]);
+        });
+
+        for (std::size_t c = chunk; c < chunk_end; ++c)
         {
+          if (!valid[c - chunk])
+            continue;
+          const std::size_t i = candidates[c];
           cass->getMetadata(i).first.push_back(j);
           cass->getMetadata(j).first.push_back(i);
 
           if (options.explicit_motions)
           {
+            // the intermediate states of the worker threads are overwritten by now, recompute them
+            check_motion(i, sj, distances[c], int_states[0], robot_states[0]);
+            unsigned int isteps = std::min<unsigned int>(options.max_explicit_points,
+                                                         distances[c] / options.explicit_points_resolution);
             cass->getMetadata(i).second[j].first = state_storage->size();
             for (unsigned int k = 0; k < isteps; ++k)
             {
-              int_states[k]->as<ModelBasedStateSpace::StateType>()->tag = -1;
-              state_storage->addState(int_states[k]);
+              int_states[0][k]->as<ModelBasedStateSpace::StateType>()->tag = -1;
+              state_storage->addState(int_states[0][k]);
             }
             cass->getMetadata(i).second[j].second = state_storage->size();
             cass->getMetadata(j).second[i] = cass->getMetadata(i).second[j];
@@ -667,7 +914,8 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
     result.state_connection_time = ompl::time::seconds(ompl::time::now() - start);
     RCLCPP_INFO(LOGGER, "Computed possible connexions in %lf seconds. Added %d connexions",
                 result.state_connection_time, good);
-    pcontext->getOMPLSimpleSetup()->getSpaceInformation()->freeStates(int_states);
+    for (std::vector<ob::State*>& thread_int_states : int_states)
+      si->freeStates(thread_int_states);
 
     return state_storage;
   }
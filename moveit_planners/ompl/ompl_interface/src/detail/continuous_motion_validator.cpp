@@ -0,0 +1,134 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/ompl_interface/detail/continuous_motion_validator.h>
+#include <moveit/ompl_interface/model_based_planning_context.h>
+
+namespace ompl_interface
+{
+ContinuousMotionValidator::ContinuousMotionValidator(const ModelBasedPlanningContext* pc)
+  : ompl::base::MotionValidator(pc->getOMPLSimpleSetup()->getSpaceInformation())
+  , planning_context_(pc)
+  , tss_previous_(pc->getCompleteInitialRobotState())
+  , tss_current_(pc->getCompleteInitialRobotState())
+{
+  collision_request_.group_name = pc->getGroupName();
+}
+
+unsigned int ContinuousMotionValidator::checkSegments(const ompl::base::State* s1, const ompl::base::State* s2,
+                                                      unsigned int segment_count) const
+{
+  const planning_scene::PlanningSceneConstPtr& scene = planning_context_->getPlanningScene();
+  const collision_detection::CollisionEnvConstPtr& env = scene->getCollisionEnv();
+  const bool sweep = env->supportsContinuousCollision();
+
+  moveit::core::RobotState* previous = tss_previous_.getStateStorage();
+  moveit::core::RobotState* current = tss_current_.getStateStorage();
+  if (sweep)
+    planning_context_->getOMPLStateSpace()->copyToRobotState(*previous, s1);
+
+  ompl::base::State* test = si_->allocState();
+  unsigned int last_valid = segment_count;
+  for (unsigned int j = 1; j <= segment_count; ++j)
+  {
+    const ompl::base::State* state = s2;
+    if (j < segment_count)
+    {
+      si_->getStateSpace()->interpolate(s1, s2, static_cast<double>(j) / segment_count, test);
+      if (!si_->isValid(test))
+      {
+        last_valid = j - 1;
+        break;
+      }
+      state = test;
+    }
+
+    if (sweep)
+    {
+      planning_context_->getOMPLStateSpace()->copyToRobotState(*current, state);
+      collision_detection::CollisionResult res;
+      env->checkRobotCollision(collision_request_, res, *previous, *current, scene->getAllowedCollisionMatrix());
+      if (res.collision)
+      {
+        last_valid = j - 1;
+        break;
+      }
+      std::swap(previous, current);
+    }
+  }
+  si_->freeState(test);
+  return last_valid;
+}
+
+bool ContinuousMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const
+{
+  // assume s1 is valid, as OMPL's DiscreteMotionValidator does
+  if (!si_->isValid(s2))
+  {
+    invalid_++;
+    return false;
+  }
+
+  unsigned int segment_count = si_->getStateSpace()->validSegmentCount(s1, s2);
+  if (checkSegments(s1, s2, segment_count) < segment_count)
+  {
+    invalid_++;
+    return false;
+  }
+  valid_++;
+  return true;
+}
+
+bool ContinuousMotionValidator::checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                                            std::pair<ompl::base::State*, double>& last_valid) const
+{
+  unsigned int segment_count = si_->getStateSpace()->validSegmentCount(s1, s2);
+  unsigned int last_valid_step = checkSegments(s1, s2, segment_count);
+  if (last_valid_step == segment_count && si_->isValid(s2))
+  {
+    valid_++;
+    return true;
+  }
+
+  // the end state itself is invalid, so the last valid state is at most one step before it
+  if (last_valid_step == segment_count)
+    last_valid_step = segment_count - 1;
+  last_valid.second = static_cast<double>(last_valid_step) / segment_count;
+  if (last_valid.first)
+    si_->getStateSpace()->interpolate(s1, s2, last_valid.second, last_valid.first);
+  invalid_++;
+  return false;
+}
+}  // namespace ompl_interface
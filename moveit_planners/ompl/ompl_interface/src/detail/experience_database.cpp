@@ -0,0 +1,361 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/ompl_interface/detail/experience_database.h>
+#include <moveit/utils/mapped_file.h>
+#include <ompl/base/goals/GoalSampleableRegion.h>
+#include <ompl/geometric/planners/rrt/RRTConnect.h>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+namespace ompl_interface
+{
+namespace ob = ompl::base;
+namespace og = ompl::geometric;
+
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ompl_planning.experience_database");
+
+namespace
+{
+// Layout of an experience file: the header below, num_paths + 1 64 bit offsets into the waypoints, and num_states
+// waypoint records of record_size bytes holding the state space serialization
+constexpr char EXPERIENCE_FILE_MAGIC[8] = { 'M', 'V', 'E', 'X', 'P', 'D', 'B', '\0' };
+constexpr std::uint32_t EXPERIENCE_FILE_VERSION = 1;
+
+struct ExperienceFileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t num_paths;
+  std::uint64_t num_states;
+};
+
+/// number of stored paths that are tried per request, nearest first
+constexpr std::size_t MAX_REPAIR_CANDIDATES = 3;
+
+/// number of goal samples considered when connecting a stored path to the goal
+constexpr unsigned int GOAL_SAMPLE_CANDIDATES = 10;
+
+/// time allowed for replanning each invalid segment of a stored path
+constexpr double SEGMENT_REPAIR_TIME = 0.05;
+
+/// paths whose endpoints are closer than this fraction of the space extent are considered duplicates
+constexpr double DUPLICATE_DISTANCE_FRACTION = 1e-3;
+
+double goalDistance(const ob::Goal& goal, const ob::State* state)
+{
+  double distance = std::numeric_limits<double>::infinity();
+  if (goal.isSatisfied(state, &distance))
+    return 0.0;
+  return distance;
+}
+
+bool repairSegment(const ob::SpaceInformationPtr& si, const ob::State* from, const ob::State* to,
+                   const ob::PlannerTerminationCondition& ptc, og::PathGeometric& path)
+{
+  auto pdef = std::make_shared<ob::ProblemDefinition>(si);
+  pdef->setStartAndGoalStates(from, to);
+  og::RRTConnect planner(si);
+  planner.setProblemDefinition(pdef);
+  planner.setup();
+  const ob::PlannerTerminationCondition segment_ptc =
+      ob::plannerOrTerminationCondition(ptc, ob::timedPlannerTerminationCondition(SEGMENT_REPAIR_TIME));
+  if (planner.solve(segment_ptc) != ob::PlannerStatus::EXACT_SOLUTION)
+    return false;
+
+  // the first state of the segment is already on the path
+  const auto& segment = *pdef->getSolutionPath()->as<og::PathGeometric>();
+  for (std::size_t k = 1; k < segment.getStateCount(); ++k)
+    path.append(segment.getState(k));
+  return true;
+}
+}  // namespace
+
+ExperienceDatabase::ExperienceDatabase(const ModelBasedStateSpacePtr& state_space, const std::string& filename)
+  : state_space_(state_space), filename_(filename)
+{
+  if (!filename_.empty() && std::filesystem::exists(filename_))
+  {
+    if (load(filename_))
+      RCLCPP_INFO(LOGGER, "Loaded %zu experience paths from '%s'", paths_.size(), filename_.c_str());
+    else
+      RCLCPP_ERROR(LOGGER, "Unable to load experience paths from '%s'", filename_.c_str());
+  }
+}
+
+ExperienceDatabase::~ExperienceDatabase()
+{
+  if (!filename_.empty() && !save(filename_))
+    RCLCPP_ERROR(LOGGER, "Unable to save experience paths to '%s'", filename_.c_str());
+}
+
+std::size_t ExperienceDatabase::size() const
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  return paths_.size();
+}
+
+void ExperienceDatabase::clear()
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  paths_.clear();
+}
+
+void ExperienceDatabase::addPath(const og::PathGeometric& path)
+{
+  if (path.getStateCount() < 2)
+    return;
+
+  const std::size_t record_size = state_space_->getSerializationLength();
+  std::vector<char> records(path.getStateCount() * record_size);
+  for (std::size_t k = 0; k < path.getStateCount(); ++k)
+    state_space_->serialize(records.data() + k * record_size, path.getState(k));
+
+  // a path replacing one with nearly the same endpoints was planned because the stored path could not be repaired
+  const double duplicate_distance = DUPLICATE_DISTANCE_FRACTION * state_space_->getMaximumExtent();
+  ob::State* state = state_space_->allocState();
+  std::lock_guard<std::mutex> slock(lock_);
+  for (std::vector<char>& stored : paths_)
+  {
+    state_space_->deserialize(state, stored.data());
+    double d = state_space_->distance(state, path.getState(0));
+    state_space_->deserialize(state, stored.data() + stored.size() - record_size);
+    d += state_space_->distance(state, path.getStates().back());
+    if (d < duplicate_distance)
+    {
+      stored.swap(records);
+      state_space_->freeState(state);
+      return;
+    }
+  }
+  state_space_->freeState(state);
+  paths_.push_back(std::move(records));
+}
+
+bool ExperienceDatabase::retrieveRepairedPath(const ob::SpaceInformationPtr& si, const ob::State* start,
+                                              const ob::Goal& goal, const ob::PlannerTerminationCondition& ptc,
+                                              og::PathGeometric& path) const
+{
+  // copy the nearest paths, so they are repaired without holding the lock
+  std::vector<std::vector<char>> candidates;
+  {
+    std::lock_guard<std::mutex> slock(lock_);
+    if (paths_.empty())
+      return false;
+
+    const std::size_t record_size = state_space_->getSerializationLength();
+    std::vector<std::pair<double, std::size_t>> scores;
+    scores.reserve(paths_.size());
+    ob::State* state = state_space_->allocState();
+    for (std::size_t i = 0; i < paths_.size(); ++i)
+    {
+      state_space_->deserialize(state, paths_[i].data());
+      double d = state_space_->distance(start, state);
+      state_space_->deserialize(state, paths_[i].data() + paths_[i].size() - record_size);
+      d += goalDistance(goal, state);
+      scores.emplace_back(d, i);
+    }
+    state_space_->freeState(state);
+
+    const std::size_t count = std::min(MAX_REPAIR_CANDIDATES, scores.size());
+    std::partial_sort(scores.begin(), scores.begin() + count, scores.end());
+    for (std::size_t c = 0; c < count; ++c)
+      candidates.push_back(paths_[scores[c].second]);
+  }
+
+  for (const std::vector<char>& candidate : candidates)
+  {
+    if (ptc())
+      break;
+    og::PathGeometric repaired(si);
+    if (repairPath(si, start, goal, candidate, ptc, repaired))
+    {
+      path = repaired;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ExperienceDatabase::repairPath(const ob::SpaceInformationPtr& si, const ob::State* start, const ob::Goal& goal,
+                                    const std::vector<char>& records, const ob::PlannerTerminationCondition& ptc,
+                                    og::PathGeometric& path) const
+{
+  // collect the stored waypoints that are still valid
+  const std::size_t record_size = state_space_->getSerializationLength();
+  og::PathGeometric waypoints(si);
+  waypoints.append(start);
+  ob::State* state = si->allocState();
+  for (std::size_t k = 0; k < records.size() / record_size; ++k)
+  {
+    state_space_->deserialize(state, records.data() + k * record_size);
+    // the tags of the stored states refer to constraint approximations of an earlier request
+    state->as<ModelBasedStateSpace::StateType>()->tag = -1;
+    if (si->isValid(state))
+      waypoints.append(state);
+  }
+  si->freeState(state);
+
+  // connect the path to the goal if its end does not satisfy it
+  if (!goal.isSatisfied(waypoints.getStates().back()))
+  {
+    if (!goal.hasType(ob::GOAL_SAMPLEABLE_REGION))
+      return false;
+    const auto& goal_region = *goal.as<ob::GoalSampleableRegion>();
+    // goal states may still be sampled in the background
+    while (!ptc() && goal_region.maxSampleCount() == 0 && goal_region.canSample())
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (goal_region.maxSampleCount() == 0)
+      return false;
+
+    ob::State* sample = si->allocState();
+    ob::State* best = si->allocState();
+    double best_distance = std::numeric_limits<double>::infinity();
+    for (unsigned int k = 0; k < std::min(GOAL_SAMPLE_CANDIDATES, goal_region.maxSampleCount()); ++k)
+    {
+      goal_region.sampleGoal(sample);
+      double d = si->distance(waypoints.getStates().back(), sample);
+      if (d < best_distance)
+      {
+        best_distance = d;
+        si->copyState(best, sample);
+      }
+    }
+    waypoints.append(best);
+    si->freeState(sample);
+    si->freeState(best);
+  }
+
+  // check the motions between the waypoints and replan the ones that are invalid now
+  path.append(waypoints.getState(0));
+  for (std::size_t k = 1; k < waypoints.getStateCount(); ++k)
+  {
+    if (ptc())
+      return false;
+    if (si->checkMotion(path.getStates().back(), waypoints.getState(k)))
+      path.append(waypoints.getState(k));
+    else if (!repairSegment(si, path.getStates().back(), waypoints.getState(k), ptc, path))
+      return false;
+  }
+  return true;
+}
+
+bool ExperienceDatabase::load(const std::string& filename)
+{
+  const moveit::core::MappedFile file(filename);
+  ExperienceFileHeader header;
+  if (file.size() < sizeof(header))
+    return false;
+  memcpy(&header, file.begin(), sizeof(header));
+  if (memcmp(header.magic, EXPERIENCE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != EXPERIENCE_FILE_VERSION || header.record_size != state_space_->getSerializationLength())
+    return false;
+
+  const std::uint64_t offsets_size = (header.num_paths + 1) * sizeof(std::uint64_t);
+  if (file.size() != sizeof(header) + offsets_size + header.num_states * header.record_size)
+    return false;
+
+  const auto* offsets = reinterpret_cast<const std::uint64_t*>(file.begin() + sizeof(header));
+  const char* records = file.begin() + sizeof(header) + offsets_size;
+  if (offsets[header.num_paths] != header.num_states)
+    return false;
+
+  std::vector<std::vector<char>> paths;
+  paths.reserve(header.num_paths);
+  for (std::size_t i = 0; i < header.num_paths; ++i)
+  {
+    if (offsets[i] >= offsets[i + 1] || offsets[i + 1] > header.num_states)
+      return false;
+    paths.emplace_back(records + offsets[i] * header.record_size, records + offsets[i + 1] * header.record_size);
+  }
+
+  std::lock_guard<std::mutex> slock(lock_);
+  paths_.swap(paths);
+  return true;
+}
+
+bool ExperienceDatabase::save(const std::string& filename) const
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  ExperienceFileHeader header{};
+  memcpy(header.magic, EXPERIENCE_FILE_MAGIC, sizeof(header.magic));
+  header.version = EXPERIENCE_FILE_VERSION;
+  header.record_size = state_space_->getSerializationLength();
+  header.num_paths = paths_.size();
+  for (const std::vector<char>& path : paths_)
+    header.num_states += path.size() / header.record_size;
+
+  // write to a temporary file first, so processes loading the database never see a partial one
+  const std::string tmp_filename = filename + ".tmp" + std::to_string(moveit::core::processId());
+  {
+    std::ofstream out(tmp_filename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (!out.good())
+      return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t offset = 0;
+    out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    for (const std::vector<char>& path : paths_)
+    {
+      offset += path.size() / header.record_size;
+      out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    for (const std::vector<char>& path : paths_)
+      out.write(path.data(), path.size());
+    if (!out.good())
+    {
+      out.close();
+      std::filesystem::remove(tmp_filename);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_filename, filename, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tmp_filename, ec);
+    return false;
+  }
+  return true;
+}
+}  // namespace ompl_interface
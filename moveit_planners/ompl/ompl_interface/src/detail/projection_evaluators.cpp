@@ -47,6 +47,8 @@ ompl_interface::ProjectionEvaluatorLinkPose::ProjectionEvaluatorLinkPose(const M
   , link_(planning_context_->getJointModelGroup()->getLinkModel(link))
   , tss_(planning_context_->getCompleteInitialRobotState())
 {
+  // let the state validity checker cache the link position when it computes FK
+  planning_context_->getOMPLStateSpace()->setProjectionLink(link_);
 }
 
 unsigned int ompl_interface::ProjectionEvaluatorLinkPose::getDimension() const
@@ -65,13 +67,19 @@ void ompl_interface::ProjectionEvaluatorLinkPose::defaultCellSizes()
 void ompl_interface::ProjectionEvaluatorLinkPose::project(const ompl::base::State* state,
                                                           OMPLProjection projection) const
 {
-  moveit::core::RobotState* s = tss_.getStateStorage();
-  planning_context_->getOMPLStateSpace()->copyToRobotState(*s, state);
+  const ModelBasedStateSpacePtr& state_space = planning_context_->getOMPLStateSpace();
+  const ModelBasedStateSpace::StateType* model_state = state_space->getModelBasedState(state);
+  if (!model_state->isProjectionKnown() || state_space->getProjectionLink() != link_)
+  {
+    moveit::core::RobotState* s = tss_.getStateStorage();
+    state_space->copyToRobotState(*s, state);
+    const_cast<ModelBasedStateSpace::StateType*>(model_state)
+        ->markProjection(s->getGlobalLinkTransform(link_).translation());
+  }
 
-  const Eigen::Vector3d& o = s->getGlobalLinkTransform(link_).translation();
-  projection(0) = o.x();
-  projection(1) = o.y();
-  projection(2) = o.z();
+  projection(0) = model_state->projection[0];
+  projection(1) = model_state->projection[1];
+  projection(2) = model_state->projection[2];
 }
 
 ompl_interface::ProjectionEvaluatorJointValue::ProjectionEvaluatorJointValue(const ModelBasedPlanningContext* pc,
@@ -0,0 +1,193 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/ompl_interface/detail/roadmap_storage.h>
+#include <moveit/utils/mapped_file.h>
+#include <ompl/base/SpaceInformation.h>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace ompl_interface
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ompl_planning.roadmap_storage");
+
+constexpr char MAGIC[8] = { 'M', 'V', 'I', 'T', 'R', 'M', 'A', 'P' };
+constexpr std::uint32_t VERSION = 1;
+
+/* the file starts with this header, followed by the serialized states, padded to 8 bytes, and the edges */
+struct Header
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t state_size;
+  std::uint64_t vertex_count;
+  std::uint64_t edge_count;
+};
+
+struct Edge
+{
+  std::uint32_t from;
+  std::uint32_t to;
+  double weight;
+};
+
+std::size_t padded(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+}  // namespace
+
+bool storeRoadmap(const ompl::base::PlannerData& data, const std::string& filename)
+{
+  const ompl::base::StateSpacePtr& space = data.getSpaceInformation()->getStateSpace();
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.state_size = space->getSerializationLength();
+  header.vertex_count = data.numVertices();
+
+  std::vector<char> states(padded(header.state_size * header.vertex_count), 0);
+  std::vector<Edge> edges;
+  edges.reserve(data.numEdges());
+  std::vector<unsigned int> targets;
+  for (unsigned int i = 0; i < data.numVertices(); ++i)
+  {
+    space->serialize(states.data() + static_cast<std::size_t>(i) * header.state_size, data.getVertex(i).getState());
+    data.getEdges(i, targets);
+    for (unsigned int j : targets)
+    {
+      ompl::base::Cost weight;
+      data.getEdgeWeight(i, j, &weight);
+      edges.push_back(Edge{ i, j, weight.value() });
+    }
+  }
+  header.edge_count = edges.size();
+
+  // write to a temporary file first, so processes reading the old file never see a partial one
+  const std::string tmp_filename = filename + ".tmp" + std::to_string(moveit::core::processId());
+  {
+    std::ofstream out(tmp_filename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (!out.good())
+    {
+      RCLCPP_ERROR(LOGGER, "Unable to open '%s' for writing the roadmap", tmp_filename.c_str());
+      return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(states.data(), states.size());
+    out.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(Edge));
+    if (!out.good())
+    {
+      RCLCPP_ERROR(LOGGER, "Failed to write the roadmap to '%s'", tmp_filename.c_str());
+      out.close();
+      std::filesystem::remove(tmp_filename);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_filename, filename, ec);
+  if (ec)
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to move the roadmap to '%s': %s", filename.c_str(), ec.message().c_str());
+    std::filesystem::remove(tmp_filename, ec);
+    return false;
+  }
+  return true;
+}
+
+bool loadRoadmap(const std::string& filename, ompl::base::PlannerData& data)
+{
+  const moveit::core::MappedFile file(filename);
+  Header header;
+  if (file.size() < sizeof(header))
+    return false;
+  std::memcpy(&header, file.begin(), sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    return false;
+
+  const ompl::base::SpaceInformationPtr& si = data.getSpaceInformation();
+  if (header.state_size != si->getStateSpace()->getSerializationLength())
+  {
+    RCLCPP_ERROR(LOGGER, "The roadmap in '%s' was stored for another state space", filename.c_str());
+    return false;
+  }
+  const std::size_t states_size = padded(header.state_size * header.vertex_count);
+  if (file.size() != sizeof(header) + states_size + header.edge_count * sizeof(Edge))
+  {
+    RCLCPP_ERROR(LOGGER, "The roadmap in '%s' is truncated", filename.c_str());
+    return false;
+  }
+
+  const char* states = file.begin() + sizeof(header);
+  std::vector<ompl::base::State*> vertex_states;
+  vertex_states.reserve(header.vertex_count);
+  for (std::size_t i = 0; i < header.vertex_count; ++i)
+  {
+    ompl::base::State* state = si->allocState();
+    si->getStateSpace()->deserialize(state, states + i * header.state_size);
+    vertex_states.push_back(state);
+    data.addVertex(ompl::base::PlannerDataVertex(state));
+  }
+
+  // the edges follow the padded states, so they are aligned within the mapped file
+  const auto* edges = reinterpret_cast<const Edge*>(states + states_size);
+  bool valid = true;
+  for (std::size_t i = 0; i < header.edge_count && valid; ++i)
+  {
+    valid = edges[i].from < header.vertex_count && edges[i].to < header.vertex_count;
+    if (valid)
+      data.addEdge(edges[i].from, edges[i].to, ompl::base::PlannerDataEdge(), ompl::base::Cost(edges[i].weight));
+  }
+
+  // let data own copies of the states, as if it had been loaded by ompl::base::PlannerDataStorage
+  data.decoupleFromPlanner();
+  for (ompl::base::State* state : vertex_states)
+    si->freeState(state);
+
+  if (!valid)
+  {
+    RCLCPP_ERROR(LOGGER, "The roadmap in '%s' is corrupt", filename.c_str());
+    data.clear();
+  }
+  return valid;
+}
+}  // namespace ompl_interface
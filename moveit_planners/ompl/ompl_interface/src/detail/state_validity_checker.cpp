@@ -39,6 +39,8 @@
 #include <ompl/base/spaces/constraint/ConstrainedStateSpace.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <cmath>
+#include <limits>
 
 namespace ompl_interface
 {
@@ -50,6 +52,8 @@ ompl_interface::StateValidityChecker::StateValidityChecker(const ModelBasedPlann
   , group_name_(pc->getGroupName())
   , tss_(pc->getCompleteInitialRobotState())
   , verbose_(false)
+  , validity_cache_(pc->getValidityCache())
+  , validity_cache_generation_(pc->getValidityCacheGeneration())
 {
   specs_.clearanceComputationType = ompl::base::StateValidityCheckerSpecs::APPROXIMATE;
   specs_.hasValidDirectionComputation = false;
@@ -73,6 +77,43 @@ void ompl_interface::StateValidityChecker::setVerbose(bool flag)
   verbose_ = flag;
 }
 
+bool StateValidityChecker::checkCollision(moveit::core::RobotState& robot_state, bool verbose) const
+{
+  // verbose checks are for debugging, so they always report the contacts
+  ValidityCache::Entry entry;
+  if (validity_cache_ && !verbose && validity_cache_->find(robot_state, validity_cache_generation_, entry))
+    return entry.valid;
+
+  collision_detection::CollisionResult res;
+  planning_context_->getPlanningScene()->checkCollision(
+      verbose ? collision_request_simple_verbose_ : collision_request_simple_, res, robot_state);
+  if (validity_cache_)
+  {
+    validity_cache_->insert(robot_state, validity_cache_generation_,
+                            { !res.collision, std::numeric_limits<double>::quiet_NaN() });
+  }
+  return !res.collision;
+}
+
+bool StateValidityChecker::checkCollision(moveit::core::RobotState& robot_state, double& dist, bool verbose) const
+{
+  ValidityCache::Entry entry;
+  if (validity_cache_ && !verbose && validity_cache_->find(robot_state, validity_cache_generation_, entry) &&
+      (!entry.valid || !std::isnan(entry.clearance)))
+  {
+    dist = std::isnan(entry.clearance) ? 0.0 : entry.clearance;
+    return entry.valid;
+  }
+
+  collision_detection::CollisionResult res;
+  planning_context_->getPlanningScene()->checkCollision(
+      verbose ? collision_request_with_distance_verbose_ : collision_request_with_distance_, res, robot_state);
+  if (validity_cache_)
+    validity_cache_->insert(robot_state, validity_cache_generation_, { !res.collision, res.distance });
+  dist = res.distance;
+  return !res.collision;
+}
+
 bool StateValidityChecker::isValid(const ompl::base::State* state, bool verbose) const
 {
   assert(state != nullptr);
@@ -94,10 +135,11 @@ bool StateValidityChecker::isValid(const ompl::base::State* state, bool verbose)
 
   moveit::core::RobotState* robot_state = tss_.getStateStorage();
   planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, state);
+  planning_context_->getOMPLStateSpace()->cacheProjection(state->as<ModelBasedStateSpace::StateType>(), *robot_state);
 
   // check path constraints
   const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
-  if (kset && !kset->decide(*robot_state, verbose).satisfied)
+  if (kset && !kset->isSatisfied(*robot_state, verbose))
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
     return false;
@@ -111,10 +153,8 @@ bool StateValidityChecker::isValid(const ompl::base::State* state, bool verbose)
   }
 
   // check collision avoidance
-  collision_detection::CollisionResult res;
-  planning_context_->getPlanningScene()->checkCollision(
-      verbose ? collision_request_simple_verbose_ : collision_request_simple_, res, *robot_state);
-  if (!res.collision)
+  const bool valid = checkCollision(*robot_state, verbose);
+  if (valid)
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markValid();
   }
@@ -122,7 +162,7 @@ bool StateValidityChecker::isValid(const ompl::base::State* state, bool verbose)
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
   }
-  return !res.collision;
+  return valid;
 }
 
 bool StateValidityChecker::isValid(const ompl::base::State* state, double& dist, bool verbose) const
@@ -148,6 +188,7 @@ bool StateValidityChecker::isValid(const ompl::base::State* state, double& dist,
 
   moveit::core::RobotState* robot_state = tss_.getStateStorage();
   planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, state);
+  planning_context_->getOMPLStateSpace()->cacheProjection(state->as<ModelBasedStateSpace::StateType>(), *robot_state);
 
   // check path constraints
   const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
@@ -170,11 +211,7 @@ bool StateValidityChecker::isValid(const ompl::base::State* state, double& dist,
   }
 
   // check collision avoidance
-  collision_detection::CollisionResult res;
-  planning_context_->getPlanningScene()->checkCollision(
-      verbose ? collision_request_with_distance_verbose_ : collision_request_with_distance_, res, *robot_state);
-  dist = res.distance;
-  return !res.collision;
+  return checkCollision(*robot_state, dist, verbose);
 }
 
 double StateValidityChecker::cost(const ompl::base::State* state) const
@@ -234,10 +271,11 @@ bool ConstrainedPlanningStateValidityChecker::isValid(const ompl::base::State* w
   moveit::core::RobotState* robot_state = tss_.getStateStorage();
   // do not use the unwrapped state here, as copyToRobotState expects a state of type ConstrainedStateSpace::StateType
   planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, wrapped_state);
+  planning_context_->getOMPLStateSpace()->cacheProjection(state->as<ModelBasedStateSpace::StateType>(), *robot_state);
 
   // check path constraints
   const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
-  if (kset && !kset->decide(*robot_state, verbose).satisfied)
+  if (kset && !kset->isSatisfied(*robot_state, verbose))
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
     return false;
@@ -292,10 +330,11 @@ bool ConstrainedPlanningStateValidityChecker::isValid(const ompl::base::State* w
 
   // do not use the unwrapped state here, as copyToRobotState expects a state of type ConstrainedStateSpace::StateType
   planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, wrapped_state);
+  planning_context_->getOMPLStateSpace()->cacheProjection(state->as<ModelBasedStateSpace::StateType>(), *robot_state);
 
   // check path constraints
   const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
-  if (kset && !kset->decide(*robot_state, verbose).satisfied)
+  if (kset && !kset->isSatisfied(*robot_state, verbose))
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
     return false;
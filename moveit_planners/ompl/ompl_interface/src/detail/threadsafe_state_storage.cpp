@@ -35,14 +35,33 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/ompl_interface/detail/threadsafe_state_storage.h>
+#include <array>
+
+namespace
+{
+struct CachedStateStorage
+{
+  std::size_t storage_id = 0;
+  moveit::core::RobotState* state = nullptr;
+};
+
+// a thread usually works with a handful of storages at most (validity checker, projections, constraints)
+constexpr std::size_t THREAD_CACHE_SIZE = 4;
+thread_local std::array<CachedStateStorage, THREAD_CACHE_SIZE> thread_cache;
+thread_local std::size_t thread_cache_next = 0;
+
+// 0 is reserved for empty cache entries
+std::atomic<std::size_t> next_storage_id{ 1 };
+}  // namespace
 
 ompl_interface::TSStateStorage::TSStateStorage(const moveit::core::RobotModelPtr& robot_model)
-  : start_state_(robot_model)
+  : id_(next_storage_id.fetch_add(1, std::memory_order_relaxed)), start_state_(robot_model), locked_lookups_(0)
 {
   start_state_.setToDefaultValues();
 }
 
-ompl_interface::TSStateStorage::TSStateStorage(const moveit::core::RobotState& start_state) : start_state_(start_state)
+ompl_interface::TSStateStorage::TSStateStorage(const moveit::core::RobotState& start_state)
+  : id_(next_storage_id.fetch_add(1, std::memory_order_relaxed)), start_state_(start_state), locked_lookups_(0)
 {
 }
 
@@ -56,8 +75,24 @@ ompl_interface::TSStateStorage::~TSStateStorage()
 
 moveit::core::RobotState* ompl_interface::TSStateStorage::getStateStorage() const
 {
+  for (const CachedStateStorage& entry : thread_cache)
+  {
+    if (entry.storage_id == id_)
+      return entry.state;
+  }
+
+  moveit::core::RobotState* st = getStateStorageLocked();
+  thread_cache[thread_cache_next] = { id_, st };
+  thread_cache_next = (thread_cache_next + 1) % THREAD_CACHE_SIZE;
+  return st;
+}
+
+moveit::core::RobotState* ompl_interface::TSStateStorage::getStateStorageLocked() const
+{
+  locked_lookups_.fetch_add(1, std::memory_order_relaxed);
+
   moveit::core::RobotState* st = nullptr;
-  std::unique_lock<std::mutex> slock(lock_);  /// \todo use Thread Local Storage?
+  std::unique_lock<std::mutex> slock(lock_);
   std::map<std::thread::id, moveit::core::RobotState*>::const_iterator it =
       thread_states_.find(std::this_thread::get_id());
   if (it == thread_states_.end())
@@ -0,0 +1,205 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/ompl_interface/detail/validity_cache.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace ompl_interface
+{
+namespace
+{
+bool samePoses(const Eigen::Isometry3d& a, const Eigen::Isometry3d& b)
+{
+  return a.matrix() == b.matrix();
+}
+}  // namespace
+
+ValidityCache::ValidityCache(const moveit::core::JointModelGroup* group, double resolution, std::size_t max_entries)
+  : group_(group), resolution_(resolution), max_entries_(max_entries), has_scene_(false), generation_(0)
+{
+  const std::vector<int>& group_variables = group_->getVariableIndexList();
+  for (std::size_t i = 0; i < group_->getParentModel().getVariableCount(); ++i)
+  {
+    if (std::find(group_variables.begin(), group_variables.end(), static_cast<int>(i)) == group_variables.end())
+      fixed_variables_.push_back(static_cast<int>(i));
+  }
+}
+
+std::size_t ValidityCache::KeyHash::operator()(const Key& key) const
+{
+  // FNV-1a over the discretized values
+  std::size_t hash = 14695981039346656037ull;
+  for (std::int64_t value : key)
+  {
+    hash ^= static_cast<std::size_t>(value);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+void ValidityCache::computeKey(const moveit::core::RobotState& state, Key& key) const
+{
+  const std::vector<int>& group_variables = group_->getVariableIndexList();
+  key.resize(group_variables.size());
+  for (std::size_t i = 0; i < group_variables.size(); ++i)
+    key[i] = std::llround(state.getVariablePosition(group_variables[i]) / resolution_);
+}
+
+std::uint64_t ValidityCache::update(const planning_scene::PlanningScene& scene, const moveit::core::RobotState& state)
+{
+  SceneFingerprint fingerprint;
+  for (const auto& [id, object] : *scene.getWorld())
+    fingerprint.objects[id] = ObjectFingerprint{ object->pose_, object->shapes_, object->shape_poses_ };
+  scene.getAllowedCollisionMatrix().getMessage(fingerprint.acm);
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  state.getAttachedBodies(attached_bodies);
+  for (const moveit::core::AttachedBody* body : attached_bodies)
+    fingerprint.attached_bodies.push_back(body->getName() + '@' + body->getAttachedLinkName());
+  std::sort(fingerprint.attached_bodies.begin(), fingerprint.attached_bodies.end());
+  fingerprint.fixed_positions.reserve(fixed_variables_.size());
+  for (int variable : fixed_variables_)
+    fingerprint.fixed_positions.push_back(state.getVariablePosition(variable));
+
+  std::unique_lock<std::shared_mutex> lock(lock_);
+  if (!has_scene_ || fingerprint.acm != scene_.acm || fingerprint.attached_bodies != scene_.attached_bodies ||
+      fingerprint.fixed_positions != scene_.fixed_positions)
+  {
+    entries_.clear();
+    ++generation_;
+  }
+  else
+  {
+    // adding or moving an object can only bring valid states into collision, removing or moving one can only free
+    // states that were in collision
+    bool added = false;
+    bool removed = false;
+    for (const auto& [id, object] : fingerprint.objects)
+    {
+      auto previous = scene_.objects.find(id);
+      if (previous == scene_.objects.end())
+      {
+        added = true;
+      }
+      else if (object.shapes != previous->second.shapes || !samePoses(object.pose, previous->second.pose) ||
+               !std::equal(object.shape_poses.begin(), object.shape_poses.end(),
+                           previous->second.shape_poses.begin(), previous->second.shape_poses.end(), samePoses))
+      {
+        added = true;
+        removed = true;
+      }
+    }
+    for (const auto& entry : scene_.objects)
+    {
+      if (fingerprint.objects.find(entry.first) == fingerprint.objects.end())
+        removed = true;
+    }
+
+    if (added && removed)
+    {
+      entries_.clear();
+    }
+    else if (added)
+    {
+      invalidate(true);
+    }
+    else if (removed)
+    {
+      invalidate(false);
+    }
+    if (added || removed)
+      ++generation_;
+  }
+  scene_ = std::move(fingerprint);
+  has_scene_ = true;
+  return generation_;
+}
+
+void ValidityCache::invalidate(bool valid)
+{
+  for (auto it = entries_.begin(); it != entries_.end();)
+  {
+    if (it->second.valid == valid)
+    {
+      it = entries_.erase(it);
+    }
+    else
+    {
+      it->second.clearance = std::numeric_limits<double>::quiet_NaN();
+      ++it;
+    }
+  }
+}
+
+bool ValidityCache::find(const moveit::core::RobotState& state, std::uint64_t generation, Entry& entry) const
+{
+  thread_local Key key;
+  computeKey(state, key);
+  std::shared_lock<std::shared_mutex> lock(lock_);
+  if (generation != generation_)
+    return false;
+  auto it = entries_.find(key);
+  if (it == entries_.end())
+    return false;
+  entry = it->second;
+  return true;
+}
+
+void ValidityCache::insert(const moveit::core::RobotState& state, std::uint64_t generation, const Entry& entry)
+{
+  Key key;
+  computeKey(state, key);
+  std::unique_lock<std::shared_mutex> lock(lock_);
+  if (generation != generation_)
+    return;
+  if (entries_.size() >= max_entries_)
+    entries_.clear();
+  entries_[std::move(key)] = entry;
+}
+
+std::size_t ValidityCache::size() const
+{
+  std::shared_lock<std::shared_mutex> lock(lock_);
+  return entries_.size();
+}
+
+void ValidityCache::clear()
+{
+  std::unique_lock<std::shared_mutex> lock(lock_);
+  entries_.clear();
+}
+}  // namespace ompl_interface
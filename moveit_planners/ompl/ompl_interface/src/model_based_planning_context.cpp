@@ -46,6 +46,10 @@
 #include <moveit/ompl_interface/detail/goal_union.h>
 #include <moveit/ompl_interface/detail/projection_evaluators.h>
 #include <moveit/ompl_interface/detail/constraints_library.h>
+#include <moveit/ompl_interface/detail/continuous_motion_validator.h>
+#include <moveit/ompl_interface/detail/experience_database.h>
+#include <moveit/ompl_interface/detail/validity_cache.h>
+#include <moveit/ompl_interface/detail/cached_motion_validator.h>
 
 #include <moveit/kinematic_constraints/utils.h>
 
@@ -67,6 +71,9 @@
 #include <ompl/base/objectives/MaximizeMinClearanceObjective.h>
 #include <ompl/geometric/planners/prm/LazyPRM.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace ompl_interface
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ompl_planning.model_based_planning_context");
@@ -77,6 +84,7 @@ ompl_interface::ModelBasedPlanningContext::ModelBasedPlanningContext(const std::
   : planning_interface::PlanningContext(name, spec.state_space_->getJointModelGroup()->getName())
   , spec_(spec)
   , complete_initial_robot_state_(spec.state_space_->getRobotModel())
+  , state_pool_(std::make_shared<moveit::core::RobotStatePool>(spec.state_space_->getRobotModel()))
   , ompl_simple_setup_(spec.ompl_simple_setup_)
   , ompl_benchmark_(*ompl_simple_setup_)
   , ompl_parallel_plan_(ompl_simple_setup_->getProblemDefinition())
@@ -86,13 +94,20 @@ ompl_interface::ModelBasedPlanningContext::ModelBasedPlanningContext(const std::
   , max_goal_samples_(0)
   , max_state_sampling_attempts_(0)
   , max_goal_sampling_attempts_(0)
+  , goal_sampling_threads_(0)
   , max_planning_threads_(0)
+  , simplification_threads_(1)
   , max_solution_segment_length_(0.0)
   , minimum_waypoint_count_(0)
   , multi_query_planning_enabled_(false)  // maintain "old" behavior by default
+  , validity_cache_generation_(0)
+  , last_solution_from_experience_(false)
   , simplify_solutions_(true)
   , interpolate_(true)
   , hybridize_(true)
+  , warm_context_enabled_(false)
+  , warm_(false)
+  , warm_constraints_approximations_(false)
 {
   complete_initial_robot_state_.setToDefaultValues();  // avoid uninitialized memory
   complete_initial_robot_state_.update();
@@ -103,15 +118,22 @@ ompl_interface::ModelBasedPlanningContext::ModelBasedPlanningContext(const std::
 void ompl_interface::ModelBasedPlanningContext::configure(const rclcpp::Node::SharedPtr& node,
                                                           bool use_constraints_approximations)
 {
-  loadConstraintApproximations(node);
-  if (!use_constraints_approximations)
+  const bool warm = warm_ && use_constraints_approximations == warm_constraints_approximations_;
+  if (!warm)
   {
-    setConstraintsApproximations(ConstraintsLibraryPtr());
+    loadConstraintApproximations(node);
+    if (!use_constraints_approximations)
+    {
+      setConstraintsApproximations(ConstraintsLibraryPtr());
+    }
   }
   complete_initial_robot_state_.update();
-  ompl_simple_setup_->getStateSpace()->computeSignature(space_signature_);
-  ompl_simple_setup_->getStateSpace()->setStateSamplerAllocator(
-      [this](const ompl::base::StateSpace* ss) { return allocPathConstrainedSampler(ss); });
+  if (!warm)
+  {
+    ompl_simple_setup_->getStateSpace()->computeSignature(space_signature_);
+    ompl_simple_setup_->getStateSpace()->setStateSamplerAllocator(
+        [this](const ompl::base::StateSpace* ss) { return allocPathConstrainedSampler(ss); });
+  }
 
   if (spec_.constrained_state_space_)
   {
@@ -127,6 +149,14 @@ void ompl_interface::ModelBasedPlanningContext::configure(const rclcpp::Node::Sh
     ompl::base::ScopedState<> ompl_start_state(spec_.state_space_);
     spec_.state_space_->copyToOMPLState(ompl_start_state.get(), getCompleteInitialRobotState());
     ompl_simple_setup_->setStartState(ompl_start_state);
+    if (validity_cache_)
+    {
+      validity_cache_generation_ = validity_cache_->update(*getPlanningScene(), getCompleteInitialRobotState());
+      // continuous collision checking needs its own motion validator and still uses the cache for the states
+      const ob::SpaceInformationPtr& si = ompl_simple_setup_->getSpaceInformation();
+      if (!std::dynamic_pointer_cast<ContinuousMotionValidator>(si->getMotionValidator()))
+        si->setMotionValidator(std::make_shared<CachedMotionValidator>(this));
+    }
     ompl_simple_setup_->setStateValidityChecker(std::make_shared<StateValidityChecker>(this));
   }
 
@@ -141,9 +171,19 @@ void ompl_interface::ModelBasedPlanningContext::configure(const rclcpp::Node::Sh
     }
   }
 
-  useConfig();
+  if (warm)
+  {
+    RCLCPP_DEBUG(LOGGER, "%s: Reusing warm planning context", name_.c_str());
+  }
+  else
+  {
+    useConfig();
+  }
   if (ompl_simple_setup_->getGoal())
     ompl_simple_setup_->setup();
+
+  warm_ = warm_context_enabled_;
+  warm_constraints_approximations_ = use_constraints_approximations;
 }
 
 void ompl_interface::ModelBasedPlanningContext::setProjectionEvaluator(const std::string& peval)
@@ -397,6 +437,64 @@ void ompl_interface::ModelBasedPlanningContext::useConfig()
     cfg.erase(it);
   }
 
+  // check whether the set up context should be kept between requests
+  it = cfg.find("warm_context");
+  if (it != cfg.end())
+  {
+    warm_context_enabled_ = boost::lexical_cast<bool>(it->second);
+    cfg.erase(it);
+  }
+
+  // check how many threads should simplify the solution
+  it = cfg.find("simplification_threads");
+  if (it != cfg.end())
+  {
+    simplification_threads_ = std::max(1u, boost::lexical_cast<unsigned int>(it->second));
+    cfg.erase(it);
+  }
+
+  // check how many threads should sample goals in the background
+  it = cfg.find("goal_sampling_threads");
+  if (it != cfg.end())
+  {
+    goal_sampling_threads_ = boost::lexical_cast<unsigned int>(it->second);
+    cfg.erase(it);
+  }
+
+  // the experience database and validity cache are shared between contexts and handed out by the
+  // PlanningContextManager, which also manages the pool of contexts
+  for (const char* key : { "experience", "experience_database_path", "validity_cache", "context_pool_size" })
+  {
+    it = cfg.find(key);
+    if (it != cfg.end())
+      cfg.erase(it);
+  }
+
+  // check whether motions should also be validated by sweeping the robot between interpolated states
+  it = cfg.find("continuous_collision_checking");
+  if (it != cfg.end())
+  {
+    if (boost::lexical_cast<bool>(it->second))
+    {
+      if (spec_.constrained_state_space_)
+      {
+        RCLCPP_WARN(LOGGER, "Continuous collision checking is not supported in constrained state spaces, "
+                            "using discrete motion validation");
+      }
+      else
+      {
+        if (!getPlanningScene()->getCollisionEnv()->supportsContinuousCollision())
+        {
+          RCLCPP_WARN(LOGGER, "The active collision detector does not support continuous collision checking, "
+                              "only interpolated states will be checked");
+        }
+        ompl_simple_setup_->getSpaceInformation()->setMotionValidator(
+            std::make_shared<ContinuousMotionValidator>(this));
+      }
+    }
+    cfg.erase(it);
+  }
+
   // remove the 'type' parameter; the rest are parameters for the planner itself
   it = cfg.find("type");
   if (it == cfg.end())
@@ -449,11 +547,52 @@ void ompl_interface::ModelBasedPlanningContext::simplifySolution(double timeout)
   ompl::time::point start = ompl::time::now();
   ob::PlannerTerminationCondition ptc = constructPlannerTerminationCondition(timeout, start);
   registerTerminationCondition(ptc);
-  ompl_simple_setup_->simplifySolution(ptc);
-  last_simplify_time_ = ompl_simple_setup_->getLastSimplificationTime();
+  if (simplification_threads_ > 1 && ompl_simple_setup_->haveSolutionPath())
+  {
+    simplifySolutionInParallel(ptc);
+    last_simplify_time_ = ompl::time::seconds(ompl::time::now() - start);
+  }
+  else
+  {
+    ompl_simple_setup_->simplifySolution(ptc);
+    last_simplify_time_ = ompl_simple_setup_->getLastSimplificationTime();
+  }
   unregisterTerminationCondition();
 }
 
+void ompl_interface::ModelBasedPlanningContext::simplifySolutionInParallel(const ob::PlannerTerminationCondition& ptc)
+{
+  const ob::SpaceInformationPtr& si = ompl_simple_setup_->getSpaceInformation();
+  const ob::ProblemDefinitionPtr& pdef = ompl_simple_setup_->getProblemDefinition();
+  const ob::OptimizationObjectivePtr objective =
+      pdef->hasOptimizationObjective() ? pdef->getOptimizationObjective() : ob::OptimizationObjectivePtr();
+  og::PathGeometric& solution = ompl_simple_setup_->getSolutionPath();
+
+  // every thread shortcuts its own copy of the path with its own random choices; the validity checker and motion
+  // validator are safe to use concurrently
+  std::vector<og::PathGeometric> paths(simplification_threads_, solution);
+  std::vector<std::thread> threads;
+  threads.reserve(paths.size());
+  for (og::PathGeometric& path : paths)
+  {
+    threads.emplace_back([&si, &pdef, &objective, &ptc, &path] {
+      og::PathSimplifier simplifier(si, pdef->getGoal(), objective);
+      simplifier.simplify(path, ptc);
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  const auto is_better = [&objective](const og::PathGeometric& a, const og::PathGeometric& b) {
+    if (objective)
+      return objective->isCostBetterThan(a.cost(objective), b.cost(objective));
+    return a.length() < b.length();
+  };
+  const auto best = std::min_element(paths.begin(), paths.end(), is_better);
+  if (is_better(*best, solution) && best->check())
+    solution = *best;
+}
+
 void ompl_interface::ModelBasedPlanningContext::interpolateSolution()
 {
   if (ompl_simple_setup_->haveSolutionPath())
@@ -485,11 +624,12 @@ void ompl_interface::ModelBasedPlanningContext::interpolateSolution()
 void ompl_interface::ModelBasedPlanningContext::convertPath(const ompl::geometric::PathGeometric& pg,
                                                             robot_trajectory::RobotTrajectory& traj) const
 {
-  moveit::core::RobotState ks = complete_initial_robot_state_;
+  state_pool_->reserve(pg.getStateCount());
   for (std::size_t i = 0; i < pg.getStateCount(); ++i)
   {
-    spec_.state_space_->copyToRobotState(ks, pg.getState(i));
-    traj.addSuffixWayPoint(ks, 0.0);
+    moveit::core::RobotStatePtr state = state_pool_->allocate(complete_initial_robot_state_);
+    spec_.state_space_->copyToRobotState(*state, pg.getState(i));
+    traj.addSuffixWayPoint(state, 0.0);
   }
 }
 
@@ -527,7 +667,17 @@ ompl::base::GoalPtr ompl_interface::ModelBasedPlanningContext::constructGoal()
 
     if (constraint_sampler)
     {
-      ob::GoalPtr goal = std::make_shared<ConstrainedGoalSampler>(this, goal_constraint, constraint_sampler);
+      // every background thread samples with its own instance, as constraint samplers keep state
+      std::vector<constraint_samplers::ConstraintSamplerPtr> background_samplers;
+      for (unsigned int t = 0; t < goal_sampling_threads_; ++t)
+      {
+        constraint_samplers::ConstraintSamplerPtr sampler = spec_.constraint_sampler_manager_->selectSampler(
+            getPlanningScene(), getGroupName(), goal_constraint->getAllConstraints());
+        if (sampler)
+          background_samplers.push_back(sampler);
+      }
+      ob::GoalPtr goal = std::make_shared<ConstrainedGoalSampler>(this, goal_constraint, constraint_sampler,
+                                                                  std::move(background_samplers));
       goals.push_back(goal);
     }
   }
@@ -769,15 +919,20 @@ bool ompl_interface::ModelBasedPlanningContext::solve(planning_interface::Motion
   if (res.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS)
   {
     double ptime = getLastPlanTime();
+    res.phase_times["ompl_plan"] += ptime;
     if (simplify_solutions_)
     {
       simplifySolution(request_.allowed_planning_time - ptime);
       ptime += getLastSimplifyTime();
+      res.phase_times["ompl_simplify"] += getLastSimplifyTime();
     }
+    storeExperience();
 
     if (interpolate_)
     {
+      ompl::time::point start_interpolate = ompl::time::now();
       interpolateSolution();
+      res.phase_times["ompl_interpolate"] += ompl::time::seconds(ompl::time::now() - start_interpolate);
     }
 
     // fill the response
@@ -822,6 +977,7 @@ bool ompl_interface::ModelBasedPlanningContext::solve(planning_interface::Motion
       res.trajectory.back() = std::make_shared<robot_trajectory::RobotTrajectory>(getRobotModel(), getGroupName());
       getSolutionPath(*res.trajectory.back());
     }
+    storeExperience();
 
     if (interpolate_)
     {
@@ -855,6 +1011,24 @@ const moveit_msgs::msg::MoveItErrorCodes ompl_interface::ModelBasedPlanningConte
 
   moveit_msgs::msg::MoveItErrorCodes result;
   result.val = moveit_msgs::msg::MoveItErrorCodes::FAILURE;
+
+  last_solution_from_experience_ = false;
+  if (experience_database_)
+  {
+    ob::PlannerTerminationCondition ptc = constructPlannerTerminationCondition(timeout, start);
+    registerTerminationCondition(ptc);
+    last_solution_from_experience_ = solveFromExperience(ptc);
+    unregisterTerminationCondition();
+    if (last_solution_from_experience_)
+    {
+      last_plan_time_ = ompl::time::seconds(ompl::time::now() - start);
+      RCLCPP_DEBUG(LOGGER, "%s: Repaired a stored path in %lf seconds", name_.c_str(), last_plan_time_);
+      result.val = moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
+      postSolve();
+      return result;
+    }
+  }
+
   if (count <= 1 || multi_query_planning_enabled_)  // multi-query planners should always run in single instances
   {
     RCLCPP_DEBUG(LOGGER, "%s: Solving the planning problem once...", name_.c_str());
@@ -961,6 +1135,29 @@ const moveit_msgs::msg::MoveItErrorCodes ompl_interface::ModelBasedPlanningConte
   return result;
 }
 
+bool ompl_interface::ModelBasedPlanningContext::solveFromExperience(const ob::PlannerTerminationCondition& ptc)
+{
+  const ob::ProblemDefinitionPtr& pdef = ompl_simple_setup_->getProblemDefinition();
+  if (pdef->getStartStateCount() == 0 || !pdef->getGoal())
+    return false;
+
+  // the path simplifier and motion validator are set up along with the planner
+  ompl_simple_setup_->setup();
+
+  auto path = std::make_shared<og::PathGeometric>(ompl_simple_setup_->getSpaceInformation());
+  if (!experience_database_->retrieveRepairedPath(ompl_simple_setup_->getSpaceInformation(), pdef->getStartState(0),
+                                                  *pdef->getGoal(), ptc, *path))
+    return false;
+  pdef->addSolutionPath(path, false, 0.0, "experience");
+  return true;
+}
+
+void ompl_interface::ModelBasedPlanningContext::storeExperience()
+{
+  if (experience_database_ && !last_solution_from_experience_ && ompl_simple_setup_->haveExactSolutionPath())
+    experience_database_->addPath(ompl_simple_setup_->getSolutionPath());
+}
+
 void ompl_interface::ModelBasedPlanningContext::registerTerminationCondition(const ob::PlannerTerminationCondition& ptc)
 {
   std::unique_lock<std::mutex> slock(ptc_lock_);
@@ -162,7 +162,15 @@ void OMPLInterface::loadPlannerConfigurations()
       { "projection_evaluator", rclcpp::ParameterType::PARAMETER_STRING },
       { "longest_valid_segment_fraction", rclcpp::ParameterType::PARAMETER_DOUBLE },
       { "enforce_joint_model_state_space", rclcpp::ParameterType::PARAMETER_BOOL },
-      { "enforce_constrained_state_space", rclcpp::ParameterType::PARAMETER_BOOL }
+      { "enforce_constrained_state_space", rclcpp::ParameterType::PARAMETER_BOOL },
+      { "continuous_collision_checking", rclcpp::ParameterType::PARAMETER_BOOL },
+      { "warm_context", rclcpp::ParameterType::PARAMETER_BOOL },
+      { "goal_sampling_threads", rclcpp::ParameterType::PARAMETER_INTEGER },
+      { "simplification_threads", rclcpp::ParameterType::PARAMETER_INTEGER },
+      { "experience", rclcpp::ParameterType::PARAMETER_BOOL },
+      { "experience_database_path", rclcpp::ParameterType::PARAMETER_STRING },
+      { "validity_cache", rclcpp::ParameterType::PARAMETER_BOOL },
+      { "context_pool_size", rclcpp::ParameterType::PARAMETER_INTEGER }
     };
 
     const std::string group_name_param = parameter_namespace_ + "." + group_name;
@@ -203,6 +211,26 @@ void OMPLInterface::loadPlannerConfigurations()
       }
     }
 
+    // an offline generated reachability map speeds up IK-based goal sampling for the group
+    std::string reachability_map_file;
+    if (node_->get_parameter(group_name_param + ".reachability_map", reachability_map_file) &&
+        !reachability_map_file.empty())
+    {
+      constraint_samplers::ReachabilityMapPtr reachability_map = constraint_samplers::ReachabilityMap::load(
+          reachability_map_file, robot_model_->getJointModelGroup(group_name));
+      if (reachability_map)
+      {
+        constraint_sampler_manager_->setReachabilityMap(group_name, reachability_map);
+        RCLCPP_INFO(LOGGER, "Loaded reachability map '%s' for group '%s'", reachability_map_file.c_str(),
+                    group_name.c_str());
+      }
+      else
+      {
+        RCLCPP_WARN(LOGGER, "Unable to load reachability map '%s' for group '%s'", reachability_map_file.c_str(),
+                    group_name.c_str());
+      }
+    }
+
     // add default planner configuration
     planning_interface::PlannerConfigurationSettings default_pc;
     std::string default_planner_id;
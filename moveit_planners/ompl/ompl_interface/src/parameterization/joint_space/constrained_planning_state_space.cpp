@@ -71,6 +71,12 @@ void ConstrainedPlanningStateSpace::copyToRobotState(moveit::core::RobotState& r
   robot_state.update();
 }
 
+const ModelBasedStateSpace::StateType*
+ConstrainedPlanningStateSpace::getModelBasedState(const ompl::base::State* ompl_state) const
+{
+  return ompl_state->as<ompl::base::ConstrainedStateSpace::StateType>()->getState()->as<StateType>();
+}
+
 void ConstrainedPlanningStateSpace::copyToOMPLState(ompl::base::State* ompl_state,
                                                     const moveit::core::RobotState& robot_state) const
 {
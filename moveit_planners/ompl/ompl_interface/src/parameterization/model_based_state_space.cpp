@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/ompl_interface/parameterization/model_based_state_space.h>
+#include <algorithm>
 #include <utility>
 
 namespace ompl_interface
@@ -51,6 +52,24 @@ ompl_interface::ModelBasedStateSpace::ModelBasedStateSpace(ModelBasedStateSpaceS
   state_values_size_ = variable_count_ * sizeof(double);
   joint_model_vector_ = spec_.joint_model_group_->getActiveJointModels();
 
+  // revolute and prismatic joints laid out in group order can be copied without going through the group
+  contiguous_variable_index_ = -1;
+  if (!joint_model_vector_.empty() && joint_model_vector_.size() == variable_count_ &&
+      spec_.joint_model_group_->getMimicJointModels().empty())
+  {
+    const int first_variable_index = joint_model_vector_[0]->getFirstVariableIndex();
+    bool contiguous = true;
+    for (std::size_t i = 0; contiguous && i < joint_model_vector_.size(); ++i)
+    {
+      const moveit::core::JointModel* joint_model = joint_model_vector_[i];
+      contiguous = (joint_model->getType() == moveit::core::JointModel::REVOLUTE ||
+                    joint_model->getType() == moveit::core::JointModel::PRISMATIC) &&
+                   joint_model->getFirstVariableIndex() == first_variable_index + static_cast<int>(i);
+    }
+    if (contiguous)
+      contiguous_variable_index_ = first_variable_index;
+  }
+
   // make sure we have bounds for every joint stored within the spec (use default bounds if not specified)
   if (!spec_.joint_bounds_.empty() && spec_.joint_bounds_.size() != joint_model_vector_.size())
   {
@@ -123,6 +142,8 @@ void ompl_interface::ModelBasedStateSpace::copyState(ompl::base::State* destinat
   destination->as<StateType>()->tag = source->as<StateType>()->tag;
   destination->as<StateType>()->flags = source->as<StateType>()->flags;
   destination->as<StateType>()->distance = source->as<StateType>()->distance;
+  std::copy(source->as<StateType>()->projection, source->as<StateType>()->projection + 3,
+            destination->as<StateType>()->projection);
 }
 
 unsigned int ompl_interface::ModelBasedStateSpace::getSerializationLength() const
@@ -341,14 +362,37 @@ void ompl_interface::ModelBasedStateSpace::printState(const ompl::base::State* s
 void ompl_interface::ModelBasedStateSpace::copyToRobotState(moveit::core::RobotState& rstate,
                                                             const ompl::base::State* state) const
 {
-  rstate.setJointGroupPositions(spec_.joint_model_group_, state->as<StateType>()->values);
+  if (contiguous_variable_index_ >= 0)
+  {
+    // consecutive states usually share some joint values, e.g. along an interpolated motion, and the links above the
+    // first changed joint keep their transforms
+    const double* values = state->as<StateType>()->values;
+    const double* current = rstate.getVariablePositions() + contiguous_variable_index_;
+    for (unsigned int i = 0; i < variable_count_; ++i)
+    {
+      if (values[i] != current[i])
+        rstate.setJointPositions(joint_model_vector_[i], values + i);
+    }
+  }
+  else
+  {
+    rstate.setJointGroupPositions(spec_.joint_model_group_, state->as<StateType>()->values);
+  }
   rstate.update();
 }
 
 void ompl_interface::ModelBasedStateSpace::copyToOMPLState(ompl::base::State* state,
                                                            const moveit::core::RobotState& rstate) const
 {
-  rstate.copyJointGroupPositions(spec_.joint_model_group_, state->as<StateType>()->values);
+  if (contiguous_variable_index_ >= 0)
+  {
+    memcpy(state->as<StateType>()->values, rstate.getVariablePositions() + contiguous_variable_index_,
+           state_values_size_);
+  }
+  else
+  {
+    rstate.copyJointGroupPositions(spec_.joint_model_group_, state->as<StateType>()->values);
+  }
   // clear any cached info (such as validity known or not)
   state->as<StateType>()->clearKnownInformation();
 }
@@ -37,6 +37,7 @@
 #include <moveit/ompl_interface/planning_context_manager.h>
 #include <moveit/robot_state/conversions.h>
 
+#include <type_traits>
 #include <utility>
 
 #include <ompl/geometric/planners/AnytimePathShortening.h>
@@ -76,6 +77,9 @@
 #include <moveit/ompl_interface/parameterization/joint_space/constrained_planning_state_space.h>
 #include <moveit/ompl_interface/parameterization/work_space/pose_model_state_space_factory.h>
 #include <moveit/ompl_interface/detail/ompl_constraints.h>
+#include <moveit/ompl_interface/detail/experience_database.h>
+#include <moveit/ompl_interface/detail/roadmap_storage.h>
+#include <moveit/ompl_interface/detail/validity_cache.h>
 
 using namespace std::placeholders;
 
@@ -86,19 +90,105 @@ static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ompl_planning.pl
 struct PlanningContextManager::CachedContexts
 {
   std::map<std::pair<std::string, std::string>, std::vector<ModelBasedPlanningContextPtr> > contexts_;
+  std::map<std::pair<std::string, std::string>, ExperienceDatabasePtr> experience_databases_;
+  std::map<std::pair<std::string, std::string>, ValidityCachePtr> validity_caches_;
   std::mutex lock_;
 };
 
+namespace
+{
+// Roadmaps are only grown after no planner was allocated for this long, and in slices of this length, so that
+// allocations wait at most one slice for the growth mutex
+constexpr std::chrono::milliseconds IDLE_TIME_BEFORE_GROWTH(1000);
+constexpr double GROWTH_SLICE = 0.005;
+}  // namespace
+
 MultiQueryPlannerAllocator::~MultiQueryPlannerAllocator()
 {
+  if (growth_thread_.joinable())
+  {
+    {
+      std::scoped_lock lock(growth_mutex_);
+      stop_growth_ = true;
+    }
+    growth_condition_.notify_all();
+    growth_thread_.join();
+  }
+
   // Store all planner data
   for (const auto& entry : planner_data_storage_paths_)
   {
     ob::PlannerData data(planners_[entry.first]->getSpaceInformation());
-    planners_[entry.first]->getPlannerData(data);
+    getRoadmap(entry.first, data);
     RCLCPP_INFO_STREAM(LOGGER, "Storing planner data. NumEdges: " << data.numEdges()
                                                                   << ", NumVertices: " << data.numVertices());
-    storage_.store(data, entry.second.c_str());
+    if (!storeRoadmap(data, entry.second))
+      RCLCPP_ERROR(LOGGER, "Failed to store the planner data of '%s'", entry.first.c_str());
+  }
+}
+
+void MultiQueryPlannerAllocator::loadPlannerData(const std::string& file_path, ob::PlannerData& data)
+{
+  // Files written by older versions are in the ob::PlannerDataStorage format
+  if (!loadRoadmap(file_path, data))
+  {
+    data.clear();
+    storage_.load(file_path.c_str(), data);
+  }
+}
+
+void MultiQueryPlannerAllocator::getRoadmap(const std::string& name, ob::PlannerData& data)
+{
+  // The planner may have added vertices while solving, the grower while idle. Take the larger roadmap, the vertices
+  // only the other one has are lost.
+  planners_[name]->getPlannerData(data);
+  std::scoped_lock lock(growth_mutex_);
+  auto grower_it = growers_.find(name);
+  if (grower_it != growers_.end() && grower_it->second.planner &&
+      grower_it->second.planner->milestoneCount() > data.numVertices())
+  {
+    data.clear();
+    grower_it->second.planner->getPlannerData(data);
+  }
+}
+
+void MultiQueryPlannerAllocator::growRoadmaps()
+{
+  std::unique_lock<std::mutex> lock(growth_mutex_);
+  while (!stop_growth_)
+  {
+    const auto idle_since = last_allocation_ + IDLE_TIME_BEFORE_GROWTH;
+    if (std::chrono::steady_clock::now() < idle_since)
+    {
+      growth_condition_.wait_until(lock, idle_since);
+      continue;
+    }
+
+    bool growing = false;
+    for (auto& [name, grower] : growers_)
+    {
+      if (!grower.planner)
+      {
+        // Building the nearest-neighbor structure of a large roadmap takes a while, so do it without the lock.
+        // Growers are only added, never removed, while this thread runs, so the iterator stays valid.
+        std::unique_ptr<ob::PlannerData> seed = std::move(grower.seed);
+        const auto allocate = grower.allocate;
+        lock.unlock();
+        std::shared_ptr<og::PRM> planner{ allocate(*seed) };
+        seed.reset();
+        lock.lock();
+        grower.planner = std::move(planner);
+        if (stop_growth_)
+          return;
+      }
+      if (grower.planner->milestoneCount() < grower.max_vertices)
+      {
+        grower.planner->growRoadmap(ob::timedPlannerTerminationCondition(GROWTH_SLICE));
+        growing = true;
+      }
+    }
+    if (!growing)
+      growth_condition_.wait(lock);  // until a planner is allocated or a grower added
   }
 }
 
@@ -120,15 +210,24 @@ ompl::base::PlannerPtr MultiQueryPlannerAllocator::allocatePlanner(const ob::Spa
   {
     // If we already have an instance, reuse it's planning data
     // FIXME: make reusing PlannerPtr not crash, so that we don't have to reconstruct a PlannerPtr instance
-    auto planner_map_it = planners_.find(new_name);
-    if (planner_map_it != planners_.end())
+    {
+      std::scoped_lock lock(growth_mutex_);
+      last_allocation_ = std::chrono::steady_clock::now();
+    }
+    // Contexts planning concurrently allocate planners concurrently, so the map is locked. The planner is
+    // constructed without the lock, the first instance of a planner is created with it.
+    std::unique_lock<std::mutex> planners_lock(planners_mutex_);
+    if (planners_.find(new_name) != planners_.end())
     {
       ob::PlannerData data(si);
-      planner_map_it->second->getPlannerData(data);
+      getRoadmap(new_name, data);
+      planners_lock.unlock();
       RCLCPP_INFO_STREAM(LOGGER, "Reusing planner data. NumEdges: " << data.numEdges()
                                                                     << ", NumVertices: " << data.numVertices());
-      planners_[planner_map_it->first] = std::shared_ptr<ob::Planner>{ allocatePersistentPlanner<T>(data) };
-      return planners_[planner_map_it->first];
+      ob::PlannerPtr planner{ allocatePersistentPlanner<T>(data) };
+      planners_lock.lock();
+      planners_[new_name] = planner;
+      return planner;
     }
 
     // Certain multi-query planners allow loading and storing the generated planner data. This feature can be
@@ -157,9 +256,42 @@ ompl::base::PlannerPtr MultiQueryPlannerAllocator::allocatePlanner(const ob::Spa
       planner_data_path = it->second;
       cfg.erase(it);
     }
+    // PRM based planners can extend their roadmap in the background while no planner is allocated, up to the number
+    // of vertices set by 'idle_roadmap_growth' (0 disables the growth)
+    it = cfg.find("idle_roadmap_growth");
+    unsigned int idle_roadmap_growth = 0;
+    if (it != cfg.end())
+    {
+      idle_roadmap_growth = boost::lexical_cast<unsigned int>(it->second);
+      cfg.erase(it);
+    }
     // Store planner instance for multi-query use
     planners_[new_name] =
         allocatePlannerImpl<T>(si, new_name, spec, load_planner_data, store_planner_data, planner_data_path);
+
+    if constexpr (std::is_base_of_v<og::PRM, T>)
+    {
+      if (idle_roadmap_growth > 0)
+      {
+        RoadmapGrower grower;
+        grower.seed = std::make_unique<ob::PlannerData>(si);
+        planners_[new_name]->getPlannerData(*grower.seed);
+        grower.seed->decoupleFromPlanner();
+        grower.allocate = [config = spec.config_](const ob::PlannerData& data) {
+          auto planner = new T(data);
+          planner->params().setParams(config, true);
+          return planner;
+        };
+        grower.max_vertices = idle_roadmap_growth;
+        {
+          std::scoped_lock lock(growth_mutex_);
+          growers_[new_name] = std::move(grower);
+        }
+        if (!growth_thread_.joinable())
+          growth_thread_ = std::thread([this] { growRoadmaps(); });
+        growth_condition_.notify_all();
+      }
+    }
     return planners_[new_name];
   }
   else
@@ -181,7 +313,7 @@ MultiQueryPlannerAllocator::allocatePlannerImpl(const ob::SpaceInformationPtr& s
   if (load_planner_data)
   {
     ob::PlannerData data(si);
-    storage_.load(file_path.c_str(), data);
+    loadPlannerData(file_path, data);
     RCLCPP_INFO_STREAM(LOGGER, "Loading planner data. NumEdges: " << data.numEdges()
                                                                   << ", NumVertices: " << data.numVertices());
     planner = std::shared_ptr<ob::Planner>{ allocatePersistentPlanner<T>(data) };
@@ -331,76 +463,109 @@ void PlanningContextManager::setPlannerConfigurations(const planning_interface::
   planner_configs_ = pconfig;
 }
 
+ModelBasedPlanningContextPtr
+PlanningContextManager::createPlanningContext(const planning_interface::PlannerConfigurationSettings& config,
+                                              const ModelBasedStateSpaceFactoryPtr& factory,
+                                              const moveit_msgs::msg::MotionPlanRequest& req) const
+{
+  ModelBasedStateSpaceSpecification space_spec(robot_model_, config.group);
+  ModelBasedPlanningContextSpecification context_spec;
+  context_spec.config_ = config.config;
+  context_spec.planner_selector_ = getPlannerSelector();
+  context_spec.constraint_sampler_manager_ = constraint_sampler_manager_;
+  context_spec.state_space_ = factory->getNewStateSpace(space_spec);
+
+  if (factory->getType() == ConstrainedPlanningStateSpace::PARAMETERIZATION_TYPE)
+  {
+    RCLCPP_DEBUG_STREAM(LOGGER, "planning_context_manager: Using OMPL's constrained state space for planning.");
+
+    // Select the correct type of constraints based on the path constraints in the planning request.
+    ompl::base::ConstraintPtr ompl_constraint =
+        createOMPLConstraints(robot_model_, config.group, req.path_constraints);
+
+    // Create a constrained state space of type "projected state space".
+    // Other types are available, so we probably should add another setting to ompl_planning.yaml
+    // to choose between them.
+    context_spec.constrained_state_space_ =
+        std::make_shared<ob::ProjectedStateSpace>(context_spec.state_space_, ompl_constraint);
+
+    // Pass the constrained state space to ompl simple setup through the creation of a
+    // ConstrainedSpaceInformation object. This makes sure the state space is properly initialized.
+    context_spec.ompl_simple_setup_ = std::make_shared<ompl::geometric::SimpleSetup>(
+        std::make_shared<ob::ConstrainedSpaceInformation>(context_spec.constrained_state_space_));
+  }
+  else
+  {
+    // Choose the correct simple setup type to load
+    context_spec.ompl_simple_setup_ = std::make_shared<ompl::geometric::SimpleSetup>(context_spec.state_space_);
+  }
+
+  RCLCPP_DEBUG(LOGGER, "Creating new planning context");
+  return std::make_shared<ModelBasedPlanningContext>(config.name, context_spec);
+}
+
 ModelBasedPlanningContextPtr
 PlanningContextManager::getPlanningContext(const planning_interface::PlannerConfigurationSettings& config,
                                            const ModelBasedStateSpaceFactoryPtr& factory,
                                            const moveit_msgs::msg::MotionPlanRequest& req) const
 {
+  // Do not cache a constrained planning context, as the constraints could be changed
+  // and need to be parsed again.
+  const bool cacheable = factory->getType() != ConstrainedPlanningStateSpace::PARAMETERIZATION_TYPE;
+
+  // Concurrent requests for a configuration are planned in separate contexts. With 'context_pool_size' set, that many
+  // contexts are created with the first request and kept for reuse; requests beyond the pool size get a context that
+  // is dropped afterwards. Without it, every context that was ever needed is kept.
+  std::size_t pool_size = 0;
+  auto pool_size_it = config.config.find("context_pool_size");
+  if (pool_size_it != config.config.end())
+    pool_size = boost::lexical_cast<std::size_t>(pool_size_it->second);
+
   // Check for a cached planning context
   ModelBasedPlanningContextPtr context;
-
+  bool fill_pool = false;
+  if (cacheable)
   {
     std::unique_lock<std::mutex> slock(cached_contexts_->lock_);
-    auto cached_contexts = cached_contexts_->contexts_.find(std::make_pair(config.name, factory->getType()));
-    if (cached_contexts != cached_contexts_->contexts_.end())
+    std::vector<ModelBasedPlanningContextPtr>& cached_contexts =
+        cached_contexts_->contexts_[std::make_pair(config.name, factory->getType())];
+    for (const ModelBasedPlanningContextPtr& cached_context : cached_contexts)
     {
-      for (const ModelBasedPlanningContextPtr& cached_context : cached_contexts->second)
+      if (cached_context.use_count() == 1)
       {
-        if (cached_context.unique())
-        {
-          RCLCPP_DEBUG(LOGGER, "Reusing cached planning context");
-          context = cached_context;
-          break;
-        }
+        RCLCPP_DEBUG(LOGGER, "Reusing cached planning context");
+        context = cached_context;
+        break;
       }
     }
+    fill_pool = cached_contexts.empty() && pool_size > 1;
   }
 
   // Create a new planning context
   if (!context)
   {
-    ModelBasedStateSpaceSpecification space_spec(robot_model_, config.group);
-    ModelBasedPlanningContextSpecification context_spec;
-    context_spec.config_ = config.config;
-    context_spec.planner_selector_ = getPlannerSelector();
-    context_spec.constraint_sampler_manager_ = constraint_sampler_manager_;
-    context_spec.state_space_ = factory->getNewStateSpace(space_spec);
+    context = createPlanningContext(config, factory, req);
 
-    if (factory->getType() == ConstrainedPlanningStateSpace::PARAMETERIZATION_TYPE)
+    if (cacheable)
     {
-      RCLCPP_DEBUG_STREAM(LOGGER, "planning_context_manager: Using OMPL's constrained state space for planning.");
-
-      // Select the correct type of constraints based on the path constraints in the planning request.
-      ompl::base::ConstraintPtr ompl_constraint =
-          createOMPLConstraints(robot_model_, config.group, req.path_constraints);
-
-      // Create a constrained state space of type "projected state space".
-      // Other types are available, so we probably should add another setting to ompl_planning.yaml
-      // to choose between them.
-      context_spec.constrained_state_space_ =
-          std::make_shared<ob::ProjectedStateSpace>(context_spec.state_space_, ompl_constraint);
-
-      // Pass the constrained state space to ompl simple setup through the creation of a
-      // ConstrainedSpaceInformation object. This makes sure the state space is properly initialized.
-      context_spec.ompl_simple_setup_ = std::make_shared<ompl::geometric::SimpleSetup>(
-          std::make_shared<ob::ConstrainedSpaceInformation>(context_spec.constrained_state_space_));
-    }
-    else
-    {
-      // Choose the correct simple setup type to load
-      context_spec.ompl_simple_setup_ = std::make_shared<ompl::geometric::SimpleSetup>(context_spec.state_space_);
-    }
-
-    RCLCPP_DEBUG(LOGGER, "Creating new planning context");
-    context = std::make_shared<ModelBasedPlanningContext>(config.name, context_spec);
+      std::vector<ModelBasedPlanningContextPtr> spare_contexts;
+      if (fill_pool)
+      {
+        for (std::size_t i = 1; i < pool_size; ++i)
+          spare_contexts.push_back(createPlanningContext(config, factory, req));
+      }
 
-    // Do not cache a constrained planning context, as the constraints could be changed
-    // and need to be parsed again.
-    if (factory->getType() != ConstrainedPlanningStateSpace::PARAMETERIZATION_TYPE)
-    {
+      std::lock_guard<std::mutex> slock(cached_contexts_->lock_);
+      std::vector<ModelBasedPlanningContextPtr>& cached_contexts =
+          cached_contexts_->contexts_[std::make_pair(config.name, factory->getType())];
+      if (pool_size == 0 || cached_contexts.size() < pool_size)
+        cached_contexts.push_back(context);
+      else
+        RCLCPP_DEBUG(LOGGER, "All %zu planning contexts of '%s' are in use", pool_size, config.name.c_str());
+      for (ModelBasedPlanningContextPtr& spare_context : spare_contexts)
       {
-        std::lock_guard<std::mutex> slock(cached_contexts_->lock_);
-        cached_contexts_->contexts_[std::make_pair(config.name, factory->getType())].push_back(context);
+        if (cached_contexts.size() < pool_size)
+          cached_contexts.push_back(std::move(spare_context));
       }
     }
   }
@@ -418,6 +583,51 @@ PlanningContextManager::getPlanningContext(const planning_interface::PlannerConf
   context->setMinimumWaypointCount(minimum_waypoint_count_);
   context->setSpecificationConfig(config.config);
 
+  // all contexts of a planner configuration share one experience database, which is only stored once
+  ExperienceDatabasePtr experience_database;
+  auto experience = config.config.find("experience");
+  if (experience != config.config.end() && boost::lexical_cast<bool>(experience->second))
+  {
+    if (factory->getType() == ConstrainedPlanningStateSpace::PARAMETERIZATION_TYPE)
+    {
+      RCLCPP_WARN(LOGGER, "Experience based planning is not supported in constrained state spaces");
+    }
+    else
+    {
+      std::lock_guard<std::mutex> slock(cached_contexts_->lock_);
+      ExperienceDatabasePtr& database =
+          cached_contexts_->experience_databases_[std::make_pair(config.name, factory->getType())];
+      if (!database)
+      {
+        auto path = config.config.find("experience_database_path");
+        database = std::make_shared<ExperienceDatabase>(context->getOMPLStateSpace(),
+                                                        path != config.config.end() ? path->second : "");
+      }
+      experience_database = database;
+    }
+  }
+  context->setExperienceDatabase(experience_database);
+
+  // likewise for the validity cache, so that repeated requests in the same scene reuse the collision checks
+  ValidityCachePtr validity_cache;
+  auto use_validity_cache = config.config.find("validity_cache");
+  if (use_validity_cache != config.config.end() && boost::lexical_cast<bool>(use_validity_cache->second))
+  {
+    if (factory->getType() == ConstrainedPlanningStateSpace::PARAMETERIZATION_TYPE)
+    {
+      RCLCPP_WARN(LOGGER, "The validity cache is not supported in constrained state spaces");
+    }
+    else
+    {
+      std::lock_guard<std::mutex> slock(cached_contexts_->lock_);
+      ValidityCachePtr& cache = cached_contexts_->validity_caches_[std::make_pair(config.name, factory->getType())];
+      if (!cache)
+        cache = std::make_shared<ValidityCache>(context->getJointModelGroup());
+      validity_cache = cache;
+    }
+  }
+  context->setValidityCache(validity_cache);
+
   return context;
 }
 
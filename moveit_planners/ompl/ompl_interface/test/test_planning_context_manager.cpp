@@ -53,10 +53,12 @@
 #include "load_test_robot.h"
 
 #include <gtest/gtest.h>
+#include <thread>
 
 #include <tf2_eigen/tf2_eigen.hpp>
 
 #include <moveit/ompl_interface/planning_context_manager.h>
+#include <moveit/ompl_interface/detail/experience_database.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/planning_interface/planning_request.h>
 #include <moveit/robot_state/conversions.h>
@@ -111,6 +113,179 @@ public:
     ASSERT_TRUE(pc->solve(res));
   }
 
+  void testWarmContext(const std::vector<double>& start, const std::vector<double>& goal)
+  {
+    SCOPED_TRACE("testWarmContext");
+
+    planning_interface::PlannerConfigurationSettings pconfig_settings;
+    pconfig_settings.group = group_name_;
+    pconfig_settings.name = group_name_;
+    pconfig_settings.config = { { "enforce_joint_model_state_space", "0" },
+                                { "type", "geometric::RRTConnect" },
+                                { "warm_context", "1" } };
+
+    planning_interface::PlannerConfigurationMap pconfig_map{ { pconfig_settings.name, pconfig_settings } };
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+
+    ompl_interface::PlanningContextManager pcm(robot_model_, constraint_sampler_manager_);
+    pcm.setPlannerConfigurations(pconfig_map);
+
+    auto pc = pcm.getPlanningContext(planning_scene_, createRequest(start, goal), error_code, node_, false);
+    ASSERT_NE(pc, nullptr);
+    EXPECT_TRUE(pc->isWarmContextEnabled());
+    planning_interface::MotionPlanDetailedResponse res;
+    ASSERT_TRUE(pc->solve(res));
+
+    const ompl_interface::ModelBasedPlanningContext* first_context = pc.get();
+    const ompl::base::Planner* first_planner = pc->getOMPLSimpleSetup()->getPlanner().get();
+    pc.reset();
+
+    // the second request swaps start and goal and is solved by the same context and planner instance
+    pc = pcm.getPlanningContext(planning_scene_, createRequest(goal, start), error_code, node_, false);
+    ASSERT_NE(pc, nullptr);
+    EXPECT_EQ(pc.get(), first_context);
+    EXPECT_EQ(pc->getOMPLSimpleSetup()->getPlanner().get(), first_planner);
+
+    planning_interface::MotionPlanDetailedResponse res2;
+    ASSERT_TRUE(pc->solve(res2));
+    ASSERT_FALSE(res2.trajectory.empty());
+
+    std::vector<double> last_positions;
+    res2.trajectory.back()->getLastWayPoint().copyJointGroupPositions(joint_model_group_, last_positions);
+    ASSERT_EQ(last_positions.size(), start.size());
+    for (std::size_t i = 0; i < start.size(); ++i)
+    {
+      EXPECT_NEAR(last_positions[i], start[i], 0.001);
+    }
+  }
+
+  void testExperience(const std::vector<double>& start, const std::vector<double>& goal)
+  {
+    SCOPED_TRACE("testExperience");
+
+    planning_interface::PlannerConfigurationSettings pconfig_settings;
+    pconfig_settings.group = group_name_;
+    pconfig_settings.name = group_name_;
+    pconfig_settings.config = { { "enforce_joint_model_state_space", "0" },
+                                { "type", "geometric::RRTConnect" },
+                                { "experience", "1" } };
+
+    planning_interface::PlannerConfigurationMap pconfig_map{ { pconfig_settings.name, pconfig_settings } };
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+
+    ompl_interface::PlanningContextManager pcm(robot_model_, constraint_sampler_manager_);
+    pcm.setPlannerConfigurations(pconfig_map);
+
+    // the first request is planned and its solution is stored
+    auto pc = pcm.getPlanningContext(planning_scene_, createRequest(start, goal), error_code, node_, false);
+    ASSERT_NE(pc, nullptr);
+    ASSERT_NE(pc->getExperienceDatabase(), nullptr);
+    planning_interface::MotionPlanDetailedResponse res;
+    ASSERT_TRUE(pc->solve(res));
+    EXPECT_FALSE(pc->isLastSolutionFromExperience());
+    EXPECT_EQ(pc->getExperienceDatabase()->size(), 1u);
+    pc.reset();
+
+    // the same request again is answered from the stored path
+    pc = pcm.getPlanningContext(planning_scene_, createRequest(start, goal), error_code, node_, false);
+    ASSERT_NE(pc, nullptr);
+    planning_interface::MotionPlanDetailedResponse res2;
+    ASSERT_TRUE(pc->solve(res2));
+    EXPECT_TRUE(pc->isLastSolutionFromExperience());
+    EXPECT_EQ(pc->getExperienceDatabase()->size(), 1u);
+    ASSERT_FALSE(res2.trajectory.empty());
+
+    std::vector<double> last_positions;
+    res2.trajectory.back()->getLastWayPoint().copyJointGroupPositions(joint_model_group_, last_positions);
+    ASSERT_EQ(last_positions.size(), goal.size());
+    for (std::size_t i = 0; i < goal.size(); ++i)
+    {
+      EXPECT_NEAR(last_positions[i], goal[i], 0.001);
+    }
+  }
+
+  void testGoalSamplingThreads(const std::vector<double>& start, const std::vector<double>& goal)
+  {
+    SCOPED_TRACE("testGoalSamplingThreads");
+
+    planning_interface::PlannerConfigurationSettings pconfig_settings;
+    pconfig_settings.group = group_name_;
+    pconfig_settings.name = group_name_;
+    pconfig_settings.config = { { "enforce_joint_model_state_space", "0" },
+                                { "type", "geometric::RRTConnect" },
+                                { "goal_sampling_threads", "2" } };
+
+    planning_interface::PlannerConfigurationMap pconfig_map{ { pconfig_settings.name, pconfig_settings } };
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+
+    ompl_interface::PlanningContextManager pcm(robot_model_, constraint_sampler_manager_);
+    pcm.setPlannerConfigurations(pconfig_map);
+
+    auto pc = pcm.getPlanningContext(planning_scene_, createRequest(start, goal), error_code, node_, false);
+    ASSERT_NE(pc, nullptr);
+    EXPECT_EQ(pc->getGoalSamplingThreads(), 2u);
+
+    planning_interface::MotionPlanDetailedResponse res;
+    ASSERT_TRUE(pc->solve(res));
+    ASSERT_FALSE(res.trajectory.empty());
+
+    std::vector<double> last_positions;
+    res.trajectory.back()->getLastWayPoint().copyJointGroupPositions(joint_model_group_, last_positions);
+    ASSERT_EQ(last_positions.size(), goal.size());
+    for (std::size_t i = 0; i < goal.size(); ++i)
+    {
+      EXPECT_NEAR(last_positions[i], goal[i], 0.001);
+    }
+  }
+
+  void testContextPool(const std::vector<double>& start, const std::vector<double>& goal)
+  {
+    SCOPED_TRACE("testContextPool");
+
+    planning_interface::PlannerConfigurationSettings pconfig_settings;
+    pconfig_settings.group = group_name_;
+    pconfig_settings.name = group_name_;
+    pconfig_settings.config = { { "enforce_joint_model_state_space", "0" },
+                                { "type", "geometric::RRTConnect" },
+                                { "context_pool_size", "2" } };
+
+    planning_interface::PlannerConfigurationMap pconfig_map{ { pconfig_settings.name, pconfig_settings } };
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+
+    ompl_interface::PlanningContextManager pcm(robot_model_, constraint_sampler_manager_);
+    pcm.setPlannerConfigurations(pconfig_map);
+
+    // concurrent requests get separate contexts, and both are solved in parallel
+    auto pc1 = pcm.getPlanningContext(planning_scene_, createRequest(start, goal), error_code, node_, false);
+    auto pc2 = pcm.getPlanningContext(planning_scene_, createRequest(goal, start), error_code, node_, false);
+    ASSERT_NE(pc1, nullptr);
+    ASSERT_NE(pc2, nullptr);
+    EXPECT_NE(pc1, pc2);
+
+    planning_interface::MotionPlanDetailedResponse res1, res2;
+    bool solved2 = false;
+    std::thread second([&] { solved2 = pc2->solve(res2); });
+    EXPECT_TRUE(pc1->solve(res1));
+    second.join();
+    EXPECT_TRUE(solved2);
+
+    // a request beyond the pool size gets a context that is not kept
+    auto pc3 = pcm.getPlanningContext(planning_scene_, createRequest(start, goal), error_code, node_, false);
+    ASSERT_NE(pc3, nullptr);
+    EXPECT_NE(pc3, pc1);
+    EXPECT_NE(pc3, pc2);
+    EXPECT_EQ(pc3.use_count(), 1);
+
+    // once they are released, the pooled contexts are reused
+    const ompl_interface::ModelBasedPlanningContext* first_context = pc1.get();
+    const ompl_interface::ModelBasedPlanningContext* second_context = pc2.get();
+    pc1.reset();
+    pc2.reset();
+    auto pc4 = pcm.getPlanningContext(planning_scene_, createRequest(start, goal), error_code, node_, false);
+    ASSERT_NE(pc4, nullptr);
+    EXPECT_TRUE(pc4.get() == first_context || pc4.get() == second_context);
+  }
+
   void testPathConstraints(const std::vector<double>& start, const std::vector<double>& goal)
   {
     SCOPED_TRACE("testPathConstraints");
@@ -321,6 +496,26 @@ TEST_F(PandaTestPlanningContext, testSimpleRequest)
   testSimpleRequest({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
 }
 
+TEST_F(PandaTestPlanningContext, testWarmContext)
+{
+  testWarmContext({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
+}
+
+TEST_F(PandaTestPlanningContext, testExperience)
+{
+  testExperience({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
+}
+
+TEST_F(PandaTestPlanningContext, testGoalSamplingThreads)
+{
+  testGoalSamplingThreads({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
+}
+
+TEST_F(PandaTestPlanningContext, testContextPool)
+{
+  testContextPool({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
+}
+
 // TODO(seng): This test is temporarily disabled as it is flaky since #1300. Re-enable when #2015 is resolved.
 // TEST_F(PandaTestPlanningContext, testPathConstraints)
 // {
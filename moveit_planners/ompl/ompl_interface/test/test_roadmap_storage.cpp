@@ -0,0 +1,114 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/ompl_interface/detail/roadmap_storage.h>
+#include <ompl/base/SpaceInformation.h>
+#include <ompl/base/spaces/RealVectorStateSpace.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+namespace ob = ompl::base;
+
+class RoadmapStorage : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    auto space = std::make_shared<ob::RealVectorStateSpace>(3);
+    space->setBounds(-1.0, 1.0);
+    si_ = std::make_shared<ob::SpaceInformation>(space);
+    si_->setup();
+    filename_ = (std::filesystem::temp_directory_path() / "test_roadmap_storage.roadmap").string();
+  }
+
+  void TearDown() override
+  {
+    std::filesystem::remove(filename_);
+  }
+
+  ob::SpaceInformationPtr si_;
+  std::string filename_;
+};
+
+TEST_F(RoadmapStorage, RoundTrip)
+{
+  ob::PlannerData data(si_);
+  ob::State* state = si_->allocState();
+  for (int i = 0; i < 5; ++i)
+  {
+    auto* values = state->as<ob::RealVectorStateSpace::StateType>()->values;
+    values[0] = 0.1 * i;
+    values[1] = -0.2 * i;
+    values[2] = 0.05;
+    data.addVertex(ob::PlannerDataVertex(state));
+  }
+  si_->freeState(state);
+  data.decoupleFromPlanner();
+  for (unsigned int i = 0; i + 1 < 5; ++i)
+  {
+    data.addEdge(i, i + 1, ob::PlannerDataEdge(), ob::Cost(1.0 + i));
+    data.addEdge(i + 1, i, ob::PlannerDataEdge(), ob::Cost(1.0 + i));
+  }
+  ASSERT_TRUE(ompl_interface::storeRoadmap(data, filename_));
+
+  ob::PlannerData loaded(si_);
+  ASSERT_TRUE(ompl_interface::loadRoadmap(filename_, loaded));
+  ASSERT_EQ(loaded.numVertices(), data.numVertices());
+  ASSERT_EQ(loaded.numEdges(), data.numEdges());
+  for (unsigned int i = 0; i < data.numVertices(); ++i)
+    EXPECT_TRUE(si_->equalStates(loaded.getVertex(i).getState(), data.getVertex(i).getState()));
+  ob::Cost weight;
+  ASSERT_TRUE(loaded.getEdgeWeight(2, 3, &weight));
+  EXPECT_DOUBLE_EQ(weight.value(), 3.0);
+  EXPECT_TRUE(loaded.edgeExists(3, 2));
+  EXPECT_FALSE(loaded.edgeExists(0, 2));
+}
+
+TEST_F(RoadmapStorage, RejectsOtherFiles)
+{
+  ob::PlannerData loaded(si_);
+  EXPECT_FALSE(ompl_interface::loadRoadmap(filename_, loaded));
+
+  std::ofstream(filename_) << "not a roadmap, but long enough for the header";
+  EXPECT_FALSE(ompl_interface::loadRoadmap(filename_, loaded));
+  EXPECT_EQ(loaded.numVertices(), 0u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
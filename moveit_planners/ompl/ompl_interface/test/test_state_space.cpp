@@ -184,6 +184,46 @@ TEST_F(LoadPlanningModelsPr2, StateSpaceCopy)
   joint_model_state_space.freeState(state);
 }
 
+TEST_F(LoadPlanningModelsPr2, StateSpaceCopyUpdatesChangedJoints)
+{
+  ompl_interface::ModelBasedStateSpaceSpecification spec(robot_model_, "right_arm");
+  ompl_interface::JointModelStateSpace joint_model_state_space(spec);
+  joint_model_state_space.setup();
+  const moveit::core::JointModelGroup* joint_model_group = robot_model_->getJointModelGroup("right_arm");
+
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToRandomPositions();
+  robot_state.update();
+  moveit::core::RobotState random_state(robot_state);
+  ompl::base::State* state = joint_model_state_space.allocState();
+  double* values = state->as<ompl_interface::ModelBasedStateSpace::StateType>()->values;
+  for (int i = 0; i < 10; ++i)
+  {
+    // alternately change only the last joint of the group and all of its joints
+    if (i % 2)
+    {
+      random_state.setToRandomPositions(joint_model_group);
+      joint_model_state_space.copyToOMPLState(state, random_state);
+    }
+    else
+    {
+      joint_model_state_space.copyToOMPLState(state, robot_state);
+      values[joint_model_group->getVariableCount() - 1] += 0.1;
+    }
+    joint_model_state_space.copyToRobotState(robot_state, state);
+
+    moveit::core::RobotState expected_state(robot_state);
+    expected_state.update(true);
+    for (const moveit::core::LinkModel* link_model : robot_model_->getLinkModels())
+    {
+      EXPECT_TRUE(robot_state.getGlobalLinkTransform(link_model)
+                      .isApprox(expected_state.getGlobalLinkTransform(link_model), EPSILON))
+          << link_model->getName();
+    }
+  }
+  joint_model_state_space.freeState(state);
+}
+
 // Run the OMPL sanity checks on the diff drive model
 TEST(TestDiffDrive, TestStateSpace)
 {
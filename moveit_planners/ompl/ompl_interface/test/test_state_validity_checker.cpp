@@ -39,6 +39,7 @@
  *        - States inside and outside joint limits.
  *        - States that are in self-collision.
  *        - Position constraints on the robot's end-effector link.
+ *        - The heap allocations of repeated checks.
  *
  *    It does not yet test:
  *        - Collision with objects in the environment.
@@ -60,6 +61,9 @@
 #include <moveit/ompl_interface/parameterization/joint_space/joint_model_state_space.h>
 #include <moveit/planning_scene/planning_scene.h>
 
+#define MOVEIT_DEFINE_ALLOCATION_INTERPOSER
+#include <moveit/utils/allocation_counter.h>
+
 #include <ompl/geometric/SimpleSetup.h>
 
 /** \brief This flag sets the verbosity level for the state validity checker. **/
@@ -192,6 +196,52 @@ public:
     EXPECT_FALSE(checker->isValid(ompl_state.get()));
   }
 
+  /** This test takes a state that is inside the joint limits and collision free as input. **/
+  void testAllocations(const std::vector<double>& position_in_limits)
+  {
+    SCOPED_TRACE("testAllocations");
+
+    if (!moveit::allocation_counter::isSupported())
+      GTEST_SKIP() << "Allocations can not be counted on this platform";
+
+    auto checker = std::make_shared<ompl_interface::StateValidityChecker>(planning_context_.get());
+    checker->setVerbose(VERBOSE);
+
+    robot_state_->setJointGroupPositions(joint_model_group_, position_in_limits);
+    ompl::base::ScopedState<> ompl_state(state_space_);
+    state_space_->copyToOMPLState(ompl_state.get(), *robot_state_);
+    auto* state = ompl_state->as<ompl_interface::JointModelStateSpace::StateType>();
+
+    // the first check sets up the thread's robot state and collision broadphase
+    EXPECT_TRUE(checker->isValid(ompl_state.get()));
+
+    // answering from the validity stored in the state is free
+    EXPECT_EQ(moveit::allocation_counter::countAllocations([&] { EXPECT_TRUE(checker->isValid(ompl_state.get())); }),
+              0u);
+
+    // a complete check costs the same every time, nothing accumulates from one check to the next
+    const std::size_t allocations_per_check = moveit::allocation_counter::countAllocations([&] {
+      state->clearKnownInformation();
+      EXPECT_TRUE(checker->isValid(ompl_state.get()));
+    });
+    const std::size_t allocations = moveit::allocation_counter::countAllocations([&] {
+      for (int i = 0; i < 100; ++i)
+      {
+        state->clearKnownInformation();
+        EXPECT_TRUE(checker->isValid(ompl_state.get()));
+      }
+    });
+    EXPECT_EQ(allocations, 100 * allocations_per_check);
+
+    // states outside the bounds are rejected before any robot state is touched
+    state->values[0] = std::numeric_limits<double>::max();
+    const std::size_t out_of_bounds_allocations = moveit::allocation_counter::countAllocations([&] {
+      state->clearKnownInformation();
+      EXPECT_FALSE(checker->isValid(ompl_state.get()));
+    });
+    EXPECT_EQ(out_of_bounds_allocations, 0u);
+  }
+
 protected:
   void SetUp() override
   {
@@ -292,6 +342,11 @@ TEST_F(PandaValidity, testPathConstraints)
   testPathConstraints({ 0., -0.785, 0., -2.356, 0., 1.571, 0.785 });
 }
 
+TEST_F(PandaValidity, testAllocations)
+{
+  testAllocations({ 0., -0.785, 0., -2.356, 0., 1.571, 0.785 });
+}
+
 /***************************************************************************
  * Run all tests on the Fanuc robot
  * ************************************************************************/
@@ -41,6 +41,7 @@ The skeleton of this test was taken from test_state_validity_checker.cpp by Jero
 #include "load_test_robot.h"
 #include <moveit/ompl_interface/detail/threadsafe_state_storage.h>
 #include <gtest/gtest.h>
+#include <thread>
 
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ompl_planning.test.test_thread_safe_storage");
 
@@ -76,6 +77,29 @@ public:
     }
   }
 
+  /** This test checks that every thread gets its own state, and that repeated lookups do not take the lock **/
+  void testPerThreadStates()
+  {
+    SCOPED_TRACE("testPerThreadStates");
+
+    ompl_interface::TSStateStorage const tss(*robot_state_);
+    moveit::core::RobotState* const main_state = tss.getStateStorage();
+    EXPECT_EQ(tss.getStateStorage(), main_state);
+
+    moveit::core::RobotState* thread_state = nullptr;
+    std::thread worker([&tss, &thread_state] {
+      thread_state = tss.getStateStorage();
+      for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(tss.getStateStorage(), thread_state);
+    });
+    worker.join();
+
+    EXPECT_NE(thread_state, nullptr);
+    EXPECT_NE(thread_state, main_state);
+    EXPECT_EQ(tss.getStateStorage(), main_state);
+    EXPECT_EQ(tss.getLockedLookupCount(), 2u);
+  }
+
 protected:
   void SetUp() override
   {
@@ -98,6 +122,11 @@ TEST_F(PandaTest, testConstruction)
   testReadback({ 0., -0.785, 0., -2.356, 0., 1.571, 0.785 });
 }
 
+TEST_F(PandaTest, testPerThreadStates)
+{
+  testPerThreadStates();
+}
+
 /***************************************************************************
  * Run all tests on the Fanuc robot
  * ************************************************************************/
@@ -0,0 +1,132 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include "load_test_robot.h"
+#include <moveit/ompl_interface/detail/validity_cache.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <geometric_shapes/shapes.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+class ValidityCacheTest : public ompl_interface_testing::LoadTestRobot, public testing::Test
+{
+protected:
+  ValidityCacheTest() : LoadTestRobot("panda", "panda_arm")
+  {
+  }
+
+  void SetUp() override
+  {
+    scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+    cache_ = std::make_shared<ompl_interface::ValidityCache>(joint_model_group_);
+    valid_state_ = std::make_shared<moveit::core::RobotState>(*robot_state_);
+    invalid_state_ = std::make_shared<moveit::core::RobotState>(*robot_state_);
+    std::vector<double> positions(num_dofs_, 0.3);
+    invalid_state_->setJointGroupPositions(joint_model_group_, positions);
+  }
+
+  void addBox()
+  {
+    scene_->getWorldNonConst()->addToObject("box", std::make_shared<const shapes::Box>(0.1, 0.1, 0.1),
+                                            Eigen::Isometry3d::Identity());
+  }
+
+  planning_scene::PlanningScenePtr scene_;
+  ompl_interface::ValidityCachePtr cache_;
+  moveit::core::RobotStatePtr valid_state_;
+  moveit::core::RobotStatePtr invalid_state_;
+};
+
+TEST_F(ValidityCacheTest, FindsInsertedStates)
+{
+  const std::uint64_t generation = cache_->update(*scene_, *robot_state_);
+  ompl_interface::ValidityCache::Entry entry;
+  EXPECT_FALSE(cache_->find(*valid_state_, generation, entry));
+
+  cache_->insert(*valid_state_, generation, { true, 0.5 });
+  cache_->insert(*invalid_state_, generation, { false, 0.0 });
+  ASSERT_TRUE(cache_->find(*valid_state_, generation, entry));
+  EXPECT_TRUE(entry.valid);
+  EXPECT_DOUBLE_EQ(entry.clearance, 0.5);
+  ASSERT_TRUE(cache_->find(*invalid_state_, generation, entry));
+  EXPECT_FALSE(entry.valid);
+
+  // an unchanged scene keeps all results
+  EXPECT_EQ(cache_->update(*scene_, *robot_state_), generation);
+  EXPECT_EQ(cache_->size(), 2u);
+}
+
+TEST_F(ValidityCacheTest, InvalidatesOnWorldChanges)
+{
+  std::uint64_t generation = cache_->update(*scene_, *robot_state_);
+  cache_->insert(*valid_state_, generation, { true, 0.5 });
+  cache_->insert(*invalid_state_, generation, { false, 0.0 });
+
+  // an added object can only make valid states invalid
+  addBox();
+  const std::uint64_t old_generation = generation;
+  generation = cache_->update(*scene_, *robot_state_);
+  EXPECT_NE(generation, old_generation);
+  ompl_interface::ValidityCache::Entry entry;
+  EXPECT_FALSE(cache_->find(*valid_state_, generation, entry));
+  ASSERT_TRUE(cache_->find(*invalid_state_, generation, entry));
+  EXPECT_FALSE(entry.valid);
+  EXPECT_FALSE(cache_->find(*invalid_state_, old_generation, entry));
+
+  // a removed object can only make invalid states valid
+  cache_->insert(*valid_state_, generation, { true, 0.5 });
+  scene_->getWorldNonConst()->removeObject("box");
+  generation = cache_->update(*scene_, *robot_state_);
+  ASSERT_TRUE(cache_->find(*valid_state_, generation, entry));
+  EXPECT_TRUE(std::isnan(entry.clearance));
+  EXPECT_FALSE(cache_->find(*invalid_state_, generation, entry));
+}
+
+TEST_F(ValidityCacheTest, ClearsWhenOtherJointsMove)
+{
+  const std::uint64_t generation = cache_->update(*scene_, *robot_state_);
+  cache_->insert(*valid_state_, generation, { true, 0.5 });
+
+  moveit::core::RobotState state(*robot_state_);
+  state.setVariablePosition("panda_finger_joint1", 0.02);
+  cache_->update(*scene_, state);
+  EXPECT_EQ(cache_->size(), 0u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -41,6 +41,8 @@
 
 #include <moveit/planning_interface/planning_interface.h>
 #include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/utils/worker_pool.h>
+#include <moveit_msgs/msg/allowed_collision_matrix.hpp>
 #include <moveit_msgs/msg/motion_plan_response.hpp>
 #include <moveit_msgs/msg/motion_sequence_request.hpp>
 
@@ -71,6 +73,15 @@ CREATE_MOVEIT_ERROR_CODE_EXCEPTION(PlanningPipelineException, moveit_msgs::msg::
 class CommandListManager
 {
 public:
+  /**
+   * @brief The parameter "pilz_industrial_motion_planner.sequence_threads" of
+   * \e node sets the number of threads used by solve(), 0 uses all cores.
+   * The default of 1 plans and blends all commands on the calling thread.
+   *
+   * The parameter "pilz_industrial_motion_planner.sequence_cache" (default
+   * true) keeps the trajectories and blends of the last solve() call, see
+   * solve().
+   */
   CommandListManager(const rclcpp::Node::SharedPtr& node, const moveit::core::RobotModelConstPtr& model);
 
   /**
@@ -102,6 +113,18 @@ public:
    * which it belongs to. Starts states can even be incomplete. In this case
    * default values are set for the unset joints.
    *
+   * With more than one sequence thread, the commands of different groups are
+   * generated concurrently, as they do not depend on each other, and all
+   * blends are computed concurrently. The result is the same as with one
+   * thread.
+   *
+   * With the sequence cache, a command is only planned again if its request
+   * or its start state differ from the last call, and a blend only if one of
+   * its trajectories or its radius changed. So appending commands or changing
+   * one blend radius only regenerates the changed parts. The cache is dropped
+   * when the planning pipeline, the current state, the collision objects, the
+   * octomap or the allowed collision matrix of \e planning_scene change.
+   *
    * @return Contains the calculated/generated trajectories.
    */
   RobotTrajCont solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
@@ -114,6 +137,14 @@ private:
   using RadiiCont = std::vector<double>;
   using GroupNamesCont = std::vector<std::string>;
 
+  //! A solved sequence item and the request it was planned for, including its start state.
+  struct Segment
+  {
+    planning_interface::MotionPlanRequest req;
+    planning_interface::MotionPlanResponse res;
+  };
+  using SegmentCont = std::vector<Segment>;
+
 private:
   /**
    * @brief Validates that two consecutive blending radii do not overlap.
@@ -130,12 +161,44 @@ private:
    * @param planning_scene The planning_scene to be used for trajectory
    * generation.
    * @param req_list Container of requests for calculation/generation.
+   * @param segments The request and response of each item.
    *
    * @return Container of generated trajectories.
    */
   MotionResponseCont solveSequenceItems(const planning_scene::PlanningSceneConstPtr& planning_scene,
                                         const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
-                                        const moveit_msgs::msg::MotionSequenceRequest& req_list) const;
+                                        const moveit_msgs::msg::MotionSequenceRequest& req_list,
+                                        SegmentCont& segments) const;
+
+  /**
+   * @brief Solve the sequence items of each group concurrently on the worker
+   * pool, the items of one group are solved in order.
+   *
+   * Throws the exception of the first failing item in the request list.
+   */
+  MotionResponseCont solveSequenceItemsParallel(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                                const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                                                const moveit_msgs::msg::MotionSequenceRequest& req_list,
+                                                SegmentCont& segments) const;
+
+  /**
+   * @brief Solve a single sequence item, starting at the end state of the last
+   * response of the same group in \e motion_plan_responses.
+   *
+   * The response of a cached segment with the same request is reused.
+   */
+  planning_interface::MotionPlanResponse
+  solveSequenceItem(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                    const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                    const moveit_msgs::msg::MotionSequenceItem& seq_item,
+                    const MotionResponseCont& motion_plan_responses, Segment& segment) const;
+
+  /**
+   * @brief Drops the cached segments and blends if they were computed with
+   * another pipeline or planning scene state.
+   */
+  void validateSequenceCache(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                             const planning_pipeline::PlanningPipelinePtr& planning_pipeline);
 
   /**
    * @return TRUE if the blending radii of specified trajectories overlap,
@@ -223,6 +286,24 @@ private:
 
   std::shared_ptr<cartesian_limits::ParamListener> param_listener_;
   cartesian_limits::Params params_;
+
+  //! Threads planning and blending sequences, nullptr if only the calling
+  //! thread is used.
+  std::unique_ptr<moveit::core::WorkerPool> worker_pool_;
+
+  //! Whether the segments and blends of the last request are reused.
+  bool sequence_cache_;
+
+  //! The segments of the last request, in the order of its items.
+  SegmentCont cached_segments_;
+
+  //! The pipeline and planning scene state the cached segments and blends
+  //! were computed with.
+  planning_pipeline::PlanningPipelinePtr cached_pipeline_;
+  std::size_t cached_collision_objects_version_{ 0 };
+  std::size_t cached_octomap_version_{ 0 };
+  std::vector<double> cached_current_state_;
+  moveit_msgs::msg::AllowedCollisionMatrix cached_acm_;
 };
 
 inline void CommandListManager::checkLastBlendRadiusZero(const moveit_msgs::msg::MotionSequenceRequest& req_list)
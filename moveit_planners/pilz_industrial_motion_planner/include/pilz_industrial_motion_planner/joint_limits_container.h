@@ -112,6 +112,17 @@ public:
    */
   JointLimit getLimit(const std::string& joint_name) const;
 
+  /**
+   * @brief get the limits of the given joints, in the same order
+   *
+   * Lets trajectory generators look up the limits once and index them like
+   * the group variables, instead of looking up each joint by name per sample.
+   * @param joint_names
+   * @return joint limits, a joint without limit gets a JointLimit without any
+   * limit set
+   */
+  std::vector<JointLimit> getLimits(const std::vector<std::string>& joint_names) const;
+
   /**
    * @brief ConstIterator to the underlying data structure
    * @return
@@ -156,6 +167,38 @@ public:
    */
   bool verifyDecelerationLimit(const std::string& joint_name, double joint_acceleration) const;
 
+  /**
+   * @brief verify position limit of single joint
+   * @param joint_limit limit of the joint, see getLimits()
+   * @param joint_position
+   * @return true if within limits, false otherwise
+   */
+  static bool verifyPositionLimit(const JointLimit& joint_limit, double joint_position);
+
+  /**
+   * @brief verify velocity limit of single joint
+   * @param joint_limit limit of the joint, see getLimits()
+   * @param joint_velocity
+   * @return true if within limits, false otherwise
+   */
+  static bool verifyVelocityLimit(const JointLimit& joint_limit, double joint_velocity);
+
+  /**
+   * @brief verify acceleration limit of single joint
+   * @param joint_limit limit of the joint, see getLimits()
+   * @param joint_acceleration
+   * @return true if within limits, false otherwise
+   */
+  static bool verifyAccelerationLimit(const JointLimit& joint_limit, double joint_acceleration);
+
+  /**
+   * @brief verify deceleration limit of single joint
+   * @param joint_limit limit of the joint, see getLimits()
+   * @param joint_acceleration
+   * @return true if within limits, false otherwise
+   */
+  static bool verifyDecelerationLimit(const JointLimit& joint_limit, double joint_acceleration);
+
 private:
   /**
    * @brief update the most strict limit with given joint limit
@@ -34,12 +34,15 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/planning_interface/planning_interface.h>
+#include <moveit/utils/worker_pool.h>
 
 #include <pilz_industrial_motion_planner/trajectory_blend_request.h>
 #include <pilz_industrial_motion_planner/trajectory_blender.h>
@@ -99,20 +102,88 @@ public:
   void append(const planning_scene::PlanningSceneConstPtr& planning_scene,
               const robot_trajectory::RobotTrajectoryPtr& other, const double blend_radius);
 
+  /**
+   * @brief Computes the blends between consecutive trajectories concurrently,
+   * so that the following append() calls for the same \e trajectories only
+   * need to stitch the results together.
+   *
+   * Each blend is computed on the unshortened trajectories. It is only used
+   * if it does not reach into the part of its first trajectory that was
+   * already replaced by the preceding blend, otherwise append() blends as
+   * usual. The result is the same as without preparing the blends. Blends
+   * which are still kept from before the last reset() are not computed again.
+   *
+   * @param planning_scene The scene planning is occurring in.
+   *
+   * @param trajectories The trajectories which will be appended in this order.
+   *
+   * @param blend_radii The blending radius between trajectory i and i+1 is
+   * stored at index i.
+   *
+   * @param worker_pool The threads computing the blends.
+   */
+  void prepareBlends(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                     const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                     const std::vector<double>& blend_radii, moveit::core::WorkerPool& worker_pool);
+
   /**
    * @brief Clears the trajectory container under construction.
+   *
+   * The blends computed for the trajectories appended since the previous
+   * reset() are kept, so appending the same trajectories again reuses them.
+   * All other blends are dropped.
    */
   void reset();
 
+  /**
+   * @brief Drops all kept blends, e.g. because the planning scene changed.
+   */
+  void clearBlends();
+
   /**
    * @return The final trajectory container which results from the append calls.
    */
   std::vector<robot_trajectory::RobotTrajectoryPtr> build() const;
 
 private:
+  //! A blend of two unshortened trajectories.
+  struct PreparedBlend
+  {
+    robot_trajectory::RobotTrajectoryPtr first_trajectory;
+    double blend_radius;
+    pilz_industrial_motion_planner::TrajectoryBlendResponse response;
+    //! Whether the blend was used since the last reset().
+    bool used{ false };
+  };
+
   void blend(const planning_scene::PlanningSceneConstPtr& planning_scene,
              const robot_trajectory::RobotTrajectoryPtr& other, const double blend_radius);
 
+  /**
+   * @return TRUE if a blend of \e first and \e second with \e blend_radius
+   * is kept in prepared_blends_, otherwise FALSE.
+   */
+  bool hasPreparedBlend(const robot_trajectory::RobotTrajectoryPtr& first,
+                        const robot_trajectory::RobotTrajectoryPtr& second, const double blend_radius) const;
+
+  /**
+   * @brief Blends \e first and \e second into \e prepared_blend.
+   *
+   * @return TRUE if blending succeeded, otherwise FALSE.
+   */
+  bool prepareBlend(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                    const robot_trajectory::RobotTrajectoryPtr& first,
+                    const robot_trajectory::RobotTrajectoryPtr& second, const double blend_radius,
+                    PreparedBlend& prepared_blend) const;
+
+  /**
+   * @brief Uses the blend prepared for traj_tail_ and \e other, if there is
+   * one which fits the current (possibly shortened) traj_tail_.
+   *
+   * @return TRUE if a prepared blend was used, otherwise FALSE.
+   */
+  bool usePreparedBlend(const robot_trajectory::RobotTrajectoryPtr& other, const double blend_radius);
+
 private:
   /**
    * @brief Appends a trajectory to a result trajectory leaving out the
@@ -136,6 +207,13 @@ private:
   //! The previously added trajectory.
   robot_trajectory::RobotTrajectoryPtr traj_tail_;
 
+  //! The added trajectory traj_tail_ was cut from by blending.
+  robot_trajectory::RobotTrajectoryPtr traj_tail_source_;
+
+  //! Blends computed by prepareBlends() or kept from earlier append() calls,
+  //! by their second trajectory.
+  std::map<robot_trajectory::RobotTrajectoryConstPtr, PreparedBlend> prepared_blends_;
+
   //! The trajectory container under construction.
   std::vector<robot_trajectory::RobotTrajectoryPtr> traj_cont_;
 
@@ -154,10 +232,9 @@ inline void PlanComponentsBuilder::setModel(const moveit::core::RobotModelConstP
   model_ = model;
 }
 
-inline void PlanComponentsBuilder::reset()
+inline void PlanComponentsBuilder::clearBlends()
 {
-  traj_tail_ = nullptr;
-  traj_cont_.clear();
+  prepared_blends_.clear();
 }
 
 }  // namespace pilz_industrial_motion_planner
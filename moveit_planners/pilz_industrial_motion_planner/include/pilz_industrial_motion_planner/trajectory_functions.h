@@ -73,6 +73,89 @@ bool computePoseIK(const planning_scene::PlanningSceneConstPtr& scene, const std
                    const std::map<std::string, double>& seed, std::map<std::string, double>& solution,
                    bool check_self_collision = true, const double timeout = 0.0);
 
+/**
+ * @brief Computes the inverse kinematics of consecutive poses, e.g. the samples
+ * of a Cartesian trajectory.
+ *
+ * The checks, robot state and collision callback of computePoseIK() are set up
+ * once for all poses. Each pose is seeded with a linear extrapolation of the two
+ * previous solutions. A solution found from that seed which moves a joint faster
+ * than its velocity limit is rejected, and the pose is solved again with the
+ * previous solution as seed.
+ */
+class PoseIKSequenceSolver
+{
+public:
+  /**
+   * @param scene: planning scene
+   * @param joint_limits: joint limits, used to reject jumps of the predicted
+   * solution
+   * @param group_name: name of planning group
+   * @param link_name: name of target link
+   * @param initial_joint_position: joint positions preceding the first pose
+   * @param check_self_collision: true to enable self collision checking after IK
+   * computation
+   * @param timeout: timeout for IK, if not set the default solver timeout is used
+   */
+  PoseIKSequenceSolver(const planning_scene::PlanningSceneConstPtr& scene, const JointLimitsContainer& joint_limits,
+                       const std::string& group_name, const std::string& link_name,
+                       const std::map<std::string, double>& initial_joint_position, bool check_self_collision = true,
+                       const double timeout = 0.0);
+
+  /**
+   * @brief false if the group does not exist or cannot solve IK for the link
+   */
+  bool isValid() const
+  {
+    return group_ != nullptr;
+  }
+
+  /**
+   * @brief compute the inverse kinematics of the next pose
+   * @param pose: target pose in the model frame
+   * @param duration: time since the previous pose
+   * @param solution: solution of IK
+   * @return true if succeed
+   */
+  bool solve(const Eigen::Isometry3d& pose, double duration, std::map<std::string, double>& solution);
+
+  /**
+   * @brief compute the inverse kinematics of the next pose
+   * @param pose: target pose in the model frame
+   * @param duration: time since the previous pose
+   * @param solution: solution of IK, in the order of getJointNames()
+   * @return true if succeed
+   */
+  bool solve(const Eigen::Isometry3d& pose, double duration, std::vector<double>& solution);
+
+  /**
+   * @brief the active joints of the group, in the order of the solutions
+   */
+  const std::vector<std::string>& getJointNames() const
+  {
+    return joint_names_;
+  }
+
+private:
+  bool solveFromSeed(const Eigen::Isometry3d& pose, const std::vector<double>& seed);
+
+  bool isJump(double duration) const;
+
+  const moveit::core::JointModelGroup* group_{ nullptr };
+  std::string link_name_;
+  double timeout_;
+  moveit::core::RobotState state_;
+  moveit::core::GroupStateValidityCallbackFn validity_callback_;
+  std::vector<std::string> joint_names_;
+  std::vector<double> max_velocities_;
+
+  std::vector<double> seed_;
+  std::vector<double> current_;
+  std::vector<double> last_;
+  std::vector<double> before_last_;
+  double last_duration_{ 0.0 };
+};
+
 /**
  * @brief compute the pose of a link at give robot state
  * @param robot_model: kinematic model of the robot
@@ -106,6 +189,23 @@ bool verifySampleJointLimits(const std::map<std::string, double>& position_last,
                              const std::map<std::string, double>& position_current, double duration_last,
                              double duration_current, const JointLimitsContainer& joint_limits);
 
+/**
+ * @brief verify the velocity/acceleration limits of current sample, with the
+ * joints given by index instead of by name
+ * @param joint_names: names of the joints, for the error messages
+ * @param joint_limits: limits of the joints, see JointLimitsContainer::getLimits()
+ * @param position_last: position of last sample
+ * @param velocity_last: velocity of last sample
+ * @param position_current: position of current sample
+ * @param duration_last: duration of last sample
+ * @param duration_current: duration of current sample
+ * @return
+ */
+bool verifySampleJointLimits(const std::vector<std::string>& joint_names, const std::vector<JointLimit>& joint_limits,
+                             const std::vector<double>& position_last, const std::vector<double>& velocity_last,
+                             const std::vector<double>& position_current, double duration_last,
+                             double duration_current);
+
 /**
  * @brief Generate joint trajectory from a KDL Cartesian trajectory
  * @param scene: planning scene
@@ -82,6 +82,22 @@ private:
                trajectory_msgs::msg::JointTrajectory& joint_trajectory, const double& velocity_scaling_factor,
                const double& acceleration_scaling_factor, const double& sampling_time);
 
+  /**
+   * @brief plan ptp joint trajectory with zero start velocity, with the joints
+   * given by index instead of by name
+   * @param joint_names the joints of the trajectory
+   * @param start_pos start positions, in the order of joint_names
+   * @param goal_pos goal positions, in the order of joint_names
+   * @param joint_trajectory
+   * @param velocity_scaling_factor
+   * @param acceleration_scaling_factor
+   * @param sampling_time
+   */
+  void planPTP(const std::vector<std::string>& joint_names, const std::vector<double>& start_pos,
+               const std::vector<double>& goal_pos, trajectory_msgs::msg::JointTrajectory& joint_trajectory,
+               const double& velocity_scaling_factor, const double& acceleration_scaling_factor,
+               const double& sampling_time);
+
   void plan(const planning_scene::PlanningSceneConstPtr& scene, const planning_interface::MotionPlanRequest& req,
             const MotionPlanInfo& plan_info, const double& sampling_time,
             trajectory_msgs::msg::JointTrajectory& joint_trajectory) override;
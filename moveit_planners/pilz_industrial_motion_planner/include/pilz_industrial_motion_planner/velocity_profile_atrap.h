@@ -36,6 +36,7 @@
 
 #include <kdl/velocityprofile.hpp>
 #include <iostream>
+#include <vector>
 
 namespace pilz_industrial_motion_planner
 {
@@ -184,6 +185,8 @@ public:
   ~VelocityProfileATrap() override;
 
 private:
+  friend class SynchronizedProfilesATrap;
+
   /// helper functions
   void setEmptyProfile();
 
@@ -212,4 +215,54 @@ private:
 std::ostream& operator<<(std::ostream& os,
                          const VelocityProfileATrap& p);  // LCOV_EXCL_LINE
 
+/**
+ * @brief Samples profiles that share their phase durations, e.g. the
+ * synchronized joint profiles of a PTP motion.
+ *
+ * Gives the same values as Pos(), Vel() and Acc() of each profile. The
+ * coefficients of all profiles are packed once, each sample determines its
+ * phase once for all profiles and evaluates them in a loop over the packed
+ * coefficients, which the compiler can vectorize.
+ */
+class SynchronizedProfilesATrap
+{
+public:
+  /**
+   * @param profiles profiles with equal phase durations, as set by
+   * setProfileAllDurations()
+   */
+  explicit SynchronizedProfilesATrap(const std::vector<VelocityProfileATrap>& profiles);
+
+  std::size_t size() const
+  {
+    return start_pos_.size();
+  }
+
+  /**
+   * @brief sample all profiles at one time
+   * @param time
+   * @param positions output, size() values
+   * @param velocities output, size() values
+   * @param accelerations output, size() values
+   */
+  void sample(double time, double* positions, double* velocities, double* accelerations) const;
+
+private:
+  /// coefficients ^0 -> ^2 of one phase, one entry per profile
+  struct Phase
+  {
+    std::vector<double> c0, c1, c2;
+  };
+
+  static void evaluate(const Phase& phase, double time, double* positions, double* velocities);
+
+  double t_a_{ 0.0 };
+  double t_b_{ 0.0 };
+  double t_c_{ 0.0 };
+  std::vector<double> start_pos_;
+  std::vector<double> end_pos_;
+  std::vector<double> start_vel_;
+  Phase phases_[3];
+};
+
 }  // namespace pilz_industrial_motion_planner
@@ -36,11 +36,15 @@
 
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
+#include <algorithm>
 #include <cassert>
+#include <exception>
 #include <functional>
 #include <sstream>
+#include <thread>
 
 #include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_state/conversions.h>
 
 #include "cartesian_limits_parameters.hpp"
@@ -52,6 +56,8 @@
 namespace pilz_industrial_motion_planner
 {
 static const std::string PARAM_NAMESPACE_LIMITS = "robot_description_planning";
+static const std::string PARAM_SEQUENCE_THREADS = "pilz_industrial_motion_planner.sequence_threads";
+static const std::string PARAM_SEQUENCE_CACHE = "pilz_industrial_motion_planner.sequence_cache";
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.pilz_industrial_motion_planner.command_list_manager");
 
 CommandListManager::CommandListManager(const rclcpp::Node::SharedPtr& node,
@@ -75,6 +81,20 @@ CommandListManager::CommandListManager(const rclcpp::Node::SharedPtr& node,
   plan_comp_builder_.setModel(model);
   plan_comp_builder_.setBlender(std::unique_ptr<pilz_industrial_motion_planner::TrajectoryBlender>(
       new pilz_industrial_motion_planner::TrajectoryBlenderTransitionWindow(limits)));
+
+  int sequence_threads;
+  node_->get_parameter_or(PARAM_SEQUENCE_THREADS, sequence_threads, 1);
+  if (sequence_threads <= 0)
+  {
+    sequence_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (sequence_threads > 1)
+  {
+    RCLCPP_INFO(LOGGER, "Solving sequences with %d threads", sequence_threads);
+    worker_pool_ = std::make_unique<moveit::core::WorkerPool>(sequence_threads);
+  }
+
+  node_->get_parameter_or(PARAM_SEQUENCE_CACHE, sequence_cache_, true);
 }
 
 RobotTrajCont CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
@@ -90,13 +110,31 @@ RobotTrajCont CommandListManager::solve(const planning_scene::PlanningSceneConst
   checkLastBlendRadiusZero(req_list);
   checkStartStates(req_list);
 
-  MotionResponseCont resp_cont{ solveSequenceItems(planning_scene, planning_pipeline, req_list) };
+  validateSequenceCache(planning_scene, planning_pipeline);
+  SegmentCont segments;
+  MotionResponseCont resp_cont{ worker_pool_ ?
+                                    solveSequenceItemsParallel(planning_scene, planning_pipeline, req_list, segments) :
+                                    solveSequenceItems(planning_scene, planning_pipeline, req_list, segments) };
+  if (sequence_cache_)
+  {
+    cached_segments_ = std::move(segments);
+  }
 
   assert(model_);
   RadiiCont radii{ extractBlendRadii(*model_, req_list) };
   checkForOverlappingRadii(resp_cont, radii);
 
   plan_comp_builder_.reset();
+  if (worker_pool_)
+  {
+    RobotTrajCont trajectories;
+    trajectories.reserve(resp_cont.size());
+    for (const planning_interface::MotionPlanResponse& resp : resp_cont)
+    {
+      trajectories.push_back(resp.trajectory);
+    }
+    plan_comp_builder_.prepareBlends(planning_scene, trajectories, radii, *worker_pool_);
+  }
   for (MotionResponseCont::size_type i = 0; i < resp_cont.size(); ++i)
   {
     plan_comp_builder_.append(planning_scene, resp_cont.at(i).trajectory,
@@ -108,6 +146,39 @@ RobotTrajCont CommandListManager::solve(const planning_scene::PlanningSceneConst
   return plan_comp_builder_.build();
 }
 
+void CommandListManager::validateSequenceCache(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                               const planning_pipeline::PlanningPipelinePtr& planning_pipeline)
+{
+  if (!sequence_cache_)
+  {
+    plan_comp_builder_.clearBlends();
+    return;
+  }
+
+  const moveit::core::RobotState& current_state{ planning_scene->getCurrentState() };
+  const std::vector<double> current_state_positions(
+      current_state.getVariablePositions(), current_state.getVariablePositions() + current_state.getVariableCount());
+  moveit_msgs::msg::AllowedCollisionMatrix acm;
+  planning_scene->getAllowedCollisionMatrix().getMessage(acm);
+
+  if (planning_pipeline == cached_pipeline_ &&
+      planning_scene->getCollisionObjectsVersion() == cached_collision_objects_version_ &&
+      planning_scene->getOctomapVersion() == cached_octomap_version_ &&
+      current_state_positions == cached_current_state_ && acm == cached_acm_)
+  {
+    return;
+  }
+
+  RCLCPP_DEBUG(LOGGER, "Planning scene or pipeline changed, dropping the sequence cache");
+  cached_segments_.clear();
+  plan_comp_builder_.clearBlends();
+  cached_pipeline_ = planning_pipeline;
+  cached_collision_objects_version_ = planning_scene->getCollisionObjectsVersion();
+  cached_octomap_version_ = planning_scene->getOctomapVersion();
+  cached_current_state_ = current_state_positions;
+  cached_acm_ = std::move(acm);
+}
+
 bool CommandListManager::checkRadiiForOverlap(const robot_trajectory::RobotTrajectory& traj_A, const double radii_A,
                                               const robot_trajectory::RobotTrajectory& traj_B,
                                               const double radii_B) const
@@ -228,34 +299,103 @@ CommandListManager::extractBlendRadii(const moveit::core::RobotModel& model,
 CommandListManager::MotionResponseCont
 CommandListManager::solveSequenceItems(const planning_scene::PlanningSceneConstPtr& planning_scene,
                                        const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
-                                       const moveit_msgs::msg::MotionSequenceRequest& req_list) const
+                                       const moveit_msgs::msg::MotionSequenceRequest& req_list,
+                                       SegmentCont& segments) const
 {
   MotionResponseCont motion_plan_responses;
-  size_t curr_req_index{ 0 };
   const size_t num_req{ req_list.items.size() };
-  for (const auto& seq_item : req_list.items)
+  segments.resize(num_req);
+  for (size_t i = 0; i < num_req; ++i)
   {
-    planning_interface::MotionPlanRequest req{ seq_item.req };
-    setStartState(motion_plan_responses, req.group_name, req.start_state);
+    motion_plan_responses.emplace_back(
+        solveSequenceItem(planning_scene, planning_pipeline, req_list.items[i], motion_plan_responses, segments[i]));
+    RCLCPP_DEBUG_STREAM(LOGGER, "Solved [" << i + 1 << '/' << num_req << ']');
+  }
+  return motion_plan_responses;
+}
 
-    planning_interface::MotionPlanResponse res;
-    if (!planning_pipeline->generatePlan(planning_scene, req, res))
+CommandListManager::MotionResponseCont
+CommandListManager::solveSequenceItemsParallel(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                               const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                                               const moveit_msgs::msg::MotionSequenceRequest& req_list,
+                                               SegmentCont& segments) const
+{
+  // The start state of an item only depends on the previous item of the same group
+  const GroupNamesCont group_names{ getGroupNames(req_list) };
+  std::vector<std::vector<size_t>> group_item_indices(group_names.size());
+  for (size_t i = 0; i < req_list.items.size(); ++i)
+  {
+    const auto group_it = std::find(group_names.cbegin(), group_names.cend(), req_list.items[i].req.group_name);
+    group_item_indices[group_it - group_names.cbegin()].push_back(i);
+  }
+
+  MotionResponseCont motion_plan_responses(req_list.items.size());
+  segments.resize(req_list.items.size());
+  std::vector<std::exception_ptr> errors(req_list.items.size());
+  worker_pool_->run(group_names.size(), [&](std::size_t group_index, unsigned int /* thread */) {
+    MotionResponseCont group_responses;
+    for (const size_t i : group_item_indices[group_index])
     {
-      RCLCPP_ERROR(LOGGER, "Generating a plan with planning pipeline failed.");
-      res.error_code.val = moveit_msgs::msg::MoveItErrorCodes::FAILURE;
+      try
+      {
+        group_responses.emplace_back(
+            solveSequenceItem(planning_scene, planning_pipeline, req_list.items[i], group_responses, segments[i]));
+      }
+      catch (...)
+      {
+        errors[i] = std::current_exception();
+        return;
+      }
+      motion_plan_responses[i] = group_responses.back();
+      RCLCPP_DEBUG_STREAM(LOGGER, "Solved [" << i + 1 << '/' << req_list.items.size() << ']');
     }
-    if (res.error_code.val != res.error_code.SUCCESS)
+  });
+
+  for (const std::exception_ptr& error : errors)
+  {
+    if (error)
     {
-      std::ostringstream os;
-      os << "Could not solve request\n";  // TODO(henning): re-enable "---\n" << req << "\n---\n";
-      throw PlanningPipelineException(os.str(), res.error_code.val);
+      std::rethrow_exception(error);
     }
-    motion_plan_responses.emplace_back(res);
-    RCLCPP_DEBUG_STREAM(LOGGER, "Solved [" << ++curr_req_index << '/' << num_req << ']');
   }
   return motion_plan_responses;
 }
 
+planning_interface::MotionPlanResponse
+CommandListManager::solveSequenceItem(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                      const planning_pipeline::PlanningPipelinePtr& planning_pipeline,
+                                      const moveit_msgs::msg::MotionSequenceItem& seq_item,
+                                      const MotionResponseCont& motion_plan_responses, Segment& segment) const
+{
+  planning_interface::MotionPlanRequest& req{ segment.req };
+  req = seq_item.req;
+  setStartState(motion_plan_responses, req.group_name, req.start_state);
+
+  // The trajectories are not modified by blending, so the cached ones can be shared
+  const auto cached = std::find_if(cached_segments_.cbegin(), cached_segments_.cend(),
+                                   [&req](const Segment& cached_segment) { return cached_segment.req == req; });
+  if (cached != cached_segments_.cend())
+  {
+    RCLCPP_DEBUG(LOGGER, "Reusing the cached trajectory of an unchanged request");
+    segment.res = cached->res;
+    return segment.res;
+  }
+
+  planning_interface::MotionPlanResponse& res{ segment.res };
+  if (!planning_pipeline->generatePlan(planning_scene, req, res))
+  {
+    RCLCPP_ERROR(LOGGER, "Generating a plan with planning pipeline failed.");
+    res.error_code.val = moveit_msgs::msg::MoveItErrorCodes::FAILURE;
+  }
+  if (res.error_code.val != res.error_code.SUCCESS)
+  {
+    std::ostringstream os;
+    os << "Could not solve request\n";  // TODO(henning): re-enable "---\n" << req << "\n---\n";
+    throw PlanningPipelineException(os.str(), res.error_code.val);
+  }
+  return res;
+}
+
 void CommandListManager::checkForNegativeRadii(const moveit_msgs::msg::MotionSequenceRequest& req_list)
 {
   if (!std::all_of(req_list.items.begin(), req_list.items.end(),
@@ -109,28 +109,61 @@ std::map<std::string, JointLimit>::const_iterator JointLimitsContainer::end() co
   return container_.end();
 }
 
+std::vector<JointLimit> JointLimitsContainer::getLimits(const std::vector<std::string>& joint_names) const
+{
+  std::vector<JointLimit> limits;
+  limits.reserve(joint_names.size());
+  for (const auto& joint_name : joint_names)
+  {
+    const auto it = container_.find(joint_name);
+    limits.push_back(it != container_.end() ? it->second : JointLimit());
+  }
+  return limits;
+}
+
 bool JointLimitsContainer::verifyPositionLimit(const std::string& joint_name, double joint_position) const
 {
-  return (!(hasLimit(joint_name) && getLimit(joint_name).has_position_limits &&
-            (joint_position < getLimit(joint_name).min_position || joint_position > getLimit(joint_name).max_position)));
+  const auto it = container_.find(joint_name);
+  return it == container_.end() || verifyPositionLimit(it->second, joint_position);
 }
 
 bool JointLimitsContainer::verifyVelocityLimit(const std::string& joint_name, double joint_velocity) const
 {
-  return (!(hasLimit(joint_name) && getLimit(joint_name).has_velocity_limits &&
-            fabs(joint_velocity) > getLimit(joint_name).max_velocity));
+  const auto it = container_.find(joint_name);
+  return it == container_.end() || verifyVelocityLimit(it->second, joint_velocity);
 }
 
 bool JointLimitsContainer::verifyAccelerationLimit(const std::string& joint_name, double joint_acceleration) const
 {
-  return (!(hasLimit(joint_name) && getLimit(joint_name).has_acceleration_limits &&
-            fabs(joint_acceleration) > getLimit(joint_name).max_acceleration));
+  const auto it = container_.find(joint_name);
+  return it == container_.end() || verifyAccelerationLimit(it->second, joint_acceleration);
 }
 
 bool JointLimitsContainer::verifyDecelerationLimit(const std::string& joint_name, double joint_acceleration) const
 {
-  return (!(hasLimit(joint_name) && getLimit(joint_name).has_deceleration_limits &&
-            fabs(joint_acceleration) > -1.0 * getLimit(joint_name).max_deceleration));
+  const auto it = container_.find(joint_name);
+  return it == container_.end() || verifyDecelerationLimit(it->second, joint_acceleration);
+}
+
+bool JointLimitsContainer::verifyPositionLimit(const JointLimit& joint_limit, double joint_position)
+{
+  return (!(joint_limit.has_position_limits &&
+            (joint_position < joint_limit.min_position || joint_position > joint_limit.max_position)));
+}
+
+bool JointLimitsContainer::verifyVelocityLimit(const JointLimit& joint_limit, double joint_velocity)
+{
+  return (!(joint_limit.has_velocity_limits && fabs(joint_velocity) > joint_limit.max_velocity));
+}
+
+bool JointLimitsContainer::verifyAccelerationLimit(const JointLimit& joint_limit, double joint_acceleration)
+{
+  return (!(joint_limit.has_acceleration_limits && fabs(joint_acceleration) > joint_limit.max_acceleration));
+}
+
+bool JointLimitsContainer::verifyDecelerationLimit(const JointLimit& joint_limit, double joint_acceleration)
+{
+  return (!(joint_limit.has_deceleration_limits && fabs(joint_acceleration) > -1.0 * joint_limit.max_deceleration));
 }
 
 void JointLimitsContainer::updateCommonLimit(const JointLimit& joint_limit, JointLimit& common_limit)
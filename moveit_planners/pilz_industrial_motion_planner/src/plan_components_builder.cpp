@@ -36,10 +36,34 @@
 
 #include <cassert>
 
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+
 #include <pilz_industrial_motion_planner/tip_frame_getter.h>
 
 namespace pilz_industrial_motion_planner
 {
+static const rclcpp::Logger LOGGER =
+    rclcpp::get_logger("moveit.pilz_industrial_motion_planner.plan_components_builder");
+
+void PlanComponentsBuilder::reset()
+{
+  traj_tail_ = nullptr;
+  traj_tail_source_ = nullptr;
+  traj_cont_.clear();
+
+  for (auto it = prepared_blends_.begin(); it != prepared_blends_.end();)
+  {
+    if (!it->second.used)
+    {
+      it = prepared_blends_.erase(it);
+      continue;
+    }
+    it->second.used = false;
+    ++it;
+  }
+}
+
 std::vector<robot_trajectory::RobotTrajectoryPtr> PlanComponentsBuilder::build() const
 {
   std::vector<robot_trajectory::RobotTrajectoryPtr> res_vec{ traj_cont_ };
@@ -78,6 +102,19 @@ void PlanComponentsBuilder::blend(const planning_scene::PlanningSceneConstPtr& p
 
   assert(other->getGroupName() == traj_tail_->getGroupName());
 
+  // Blend the unshortened trajectory, so the blend can be used again if the same trajectories are appended after the
+  // next reset()
+  PreparedBlend prepared_blend;
+  if (!hasPreparedBlend(traj_tail_source_, other, blend_radius) &&
+      prepareBlend(planning_scene, traj_tail_source_, other, blend_radius, prepared_blend))
+  {
+    prepared_blends_[other] = std::move(prepared_blend);
+  }
+  if (usePreparedBlend(other, blend_radius))
+  {
+    return;
+  }
+
   pilz_industrial_motion_planner::TrajectoryBlendRequest blend_request;
 
   blend_request.first_trajectory = traj_tail_;
@@ -97,6 +134,113 @@ void PlanComponentsBuilder::blend(const planning_scene::PlanningSceneConstPtr& p
   traj_cont_.back()->append(*blend_response.blend_trajectory, 0.0);
   // Store the last new trajectory element for future processing
   traj_tail_ = blend_response.second_trajectory;  // first for next blending segment
+  traj_tail_source_ = other;
+}
+
+void PlanComponentsBuilder::prepareBlends(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                          const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                          const std::vector<double>& blend_radii,
+                                          moveit::core::WorkerPool& worker_pool)
+{
+  if (!blender_)
+  {
+    throw NoBlenderSetException("No blender set");
+  }
+
+  std::vector<std::size_t> blend_indices;
+  for (std::size_t i = 0; i + 1 < trajectories.size(); ++i)
+  {
+    if (blend_radii.at(i) > 0.0 && trajectories[i]->getGroupName() == trajectories[i + 1]->getGroupName() &&
+        !hasPreparedBlend(trajectories[i], trajectories[i + 1], blend_radii[i]))
+    {
+      blend_indices.push_back(i);
+    }
+  }
+
+  std::vector<PreparedBlend> blends(blend_indices.size());
+  std::vector<char> succeeded(blend_indices.size(), false);
+  worker_pool.run(blend_indices.size(), [&](std::size_t index, unsigned int /* thread */) {
+    const std::size_t i = blend_indices[index];
+    succeeded[index] =
+        prepareBlend(planning_scene, trajectories[i], trajectories[i + 1], blend_radii[i], blends[index]);
+  });
+
+  // failed blends are repeated by append(), which reports the failure in order
+  for (std::size_t index = 0; index < blend_indices.size(); ++index)
+  {
+    if (succeeded[index])
+    {
+      prepared_blends_[trajectories[blend_indices[index] + 1]] = std::move(blends[index]);
+    }
+  }
+}
+
+bool PlanComponentsBuilder::hasPreparedBlend(const robot_trajectory::RobotTrajectoryPtr& first,
+                                             const robot_trajectory::RobotTrajectoryPtr& second,
+                                             const double blend_radius) const
+{
+  const auto it = prepared_blends_.find(second);
+  return it != prepared_blends_.end() && it->second.first_trajectory == first &&
+         it->second.blend_radius == blend_radius;
+}
+
+bool PlanComponentsBuilder::prepareBlend(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                         const robot_trajectory::RobotTrajectoryPtr& first,
+                                         const robot_trajectory::RobotTrajectoryPtr& second, const double blend_radius,
+                                         PreparedBlend& prepared_blend) const
+{
+  try
+  {
+    pilz_industrial_motion_planner::TrajectoryBlendRequest blend_request;
+    blend_request.first_trajectory = first;
+    blend_request.second_trajectory = second;
+    blend_request.blend_radius = blend_radius;
+    blend_request.group_name = first->getGroupName();
+    blend_request.link_name = getSolverTipFrame(model_->getJointModelGroup(blend_request.group_name));
+
+    prepared_blend.first_trajectory = first;
+    prepared_blend.blend_radius = blend_radius;
+    return blender_->blend(planning_scene, blend_request, prepared_blend.response);
+  }
+  catch (const std::exception& ex)
+  {
+    RCLCPP_DEBUG(LOGGER, "Preparing blend failed: %s", ex.what());
+  }
+  return false;
+}
+
+bool PlanComponentsBuilder::usePreparedBlend(const robot_trajectory::RobotTrajectoryPtr& other,
+                                             const double blend_radius)
+{
+  if (!hasPreparedBlend(traj_tail_source_, other, blend_radius))
+  {
+    return false;
+  }
+  const auto it = prepared_blends_.find(other);
+
+  // traj_tail_ consists of the last waypoints of the trajectory the blend was computed for, with the duration of its
+  // first waypoint adjusted by the preceding blend
+  const TrajectoryBlendResponse& blend_response = it->second.response;
+  const std::size_t removed_count = traj_tail_source_->getWayPointCount() - traj_tail_->getWayPointCount();
+  const std::size_t first_count = blend_response.first_trajectory->getWayPointCount();
+  if (first_count <= removed_count)
+  {
+    RCLCPP_DEBUG(LOGGER, "Prepared blend overlaps the preceding blend, blending again");
+    return false;
+  }
+
+  auto first_trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(model_, traj_tail_->getGroupName());
+  for (std::size_t i = 0; i < first_count - removed_count; ++i)
+  {
+    first_trajectory->addSuffixWayPoint(traj_tail_->getWayPoint(i), traj_tail_->getWayPointDurationFromPrevious(i));
+  }
+
+  appendWithStrictTimeIncrease(*(traj_cont_.back()), *first_trajectory);
+  traj_cont_.back()->append(*blend_response.blend_trajectory, 0.0);
+  traj_tail_ = blend_response.second_trajectory;
+  traj_tail_source_ = other;
+  it->second.used = true;
+  return true;
 }
 
 void PlanComponentsBuilder::append(const planning_scene::PlanningSceneConstPtr& planning_scene,
@@ -110,6 +254,7 @@ void PlanComponentsBuilder::append(const planning_scene::PlanningSceneConstPtr&
   if (!traj_tail_)
   {
     traj_tail_ = other;
+    traj_tail_source_ = other;
     // Reserve space in container for new trajectory
     traj_cont_.emplace_back(std::make_shared<robot_trajectory::RobotTrajectory>(model_, other->getGroupName()));
     return;
@@ -120,6 +265,7 @@ void PlanComponentsBuilder::append(const planning_scene::PlanningSceneConstPtr&
   {
     appendWithStrictTimeIncrease(*(traj_cont_.back()), *traj_tail_);
     traj_tail_ = other;
+    traj_tail_source_ = other;
     // Create new container element
     traj_cont_.emplace_back(std::make_shared<robot_trajectory::RobotTrajectory>(model_, other->getGroupName()));
     return;
@@ -130,6 +276,7 @@ void PlanComponentsBuilder::append(const planning_scene::PlanningSceneConstPtr&
   {
     appendWithStrictTimeIncrease(*(traj_cont_.back()), *traj_tail_);
     traj_tail_ = other;
+    traj_tail_source_ = other;
     return;
   }
 
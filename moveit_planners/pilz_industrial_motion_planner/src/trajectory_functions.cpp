@@ -34,6 +34,10 @@
 
 #include <pilz_industrial_motion_planner/trajectory_functions.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include <moveit/planning_scene/planning_scene.h>
 #include <tf2/LinearMath/Quaternion.h>
 #include <tf2_eigen_kdl/tf2_eigen_kdl.hpp>
@@ -43,6 +47,30 @@
 namespace
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.pilz_industrial_motion_planner.trajectory_functions");
+
+/**
+ * @brief find the index of each trajectory joint in the IK solutions
+ * @return false if the trajectory joints are not the joints of the solutions
+ */
+bool getSolutionIndices(const std::vector<std::string>& joint_names,
+                        const std::vector<std::string>& solution_joint_names, std::vector<std::size_t>& indices)
+{
+  if (joint_names.size() != solution_joint_names.size())
+  {
+    return false;
+  }
+  indices.clear();
+  for (const auto& joint_name : joint_names)
+  {
+    const auto it = std::find(solution_joint_names.begin(), solution_joint_names.end(), joint_name);
+    if (it == solution_joint_names.end())
+    {
+      return false;
+    }
+    indices.push_back(it - solution_joint_names.begin());
+  }
+  return true;
+}
 }
 
 bool pilz_industrial_motion_planner::computePoseIK(const planning_scene::PlanningSceneConstPtr& scene,
@@ -115,6 +143,129 @@ bool pilz_industrial_motion_planner::computePoseIK(const planning_scene::Plannin
                        timeout);
 }
 
+pilz_industrial_motion_planner::PoseIKSequenceSolver::PoseIKSequenceSolver(
+    const planning_scene::PlanningSceneConstPtr& scene, const JointLimitsContainer& joint_limits,
+    const std::string& group_name, const std::string& link_name,
+    const std::map<std::string, double>& initial_joint_position, bool check_self_collision, const double timeout)
+  : link_name_(link_name), timeout_(timeout), state_(scene->getCurrentState())
+{
+  const moveit::core::RobotModelConstPtr& robot_model = scene->getRobotModel();
+  if (!robot_model->hasJointModelGroup(group_name))
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "Robot model has no planning group named as " << group_name);
+    return;
+  }
+
+  const moveit::core::JointModelGroup* group = robot_model->getJointModelGroup(group_name);
+  if (!group->canSetStateFromIK(link_name))
+  {
+    RCLCPP_ERROR_STREAM(LOGGER, "No valid IK solver exists for " << link_name << " in planning group " << group_name);
+    return;
+  }
+  group_ = group;
+
+  validity_callback_ = [check_self_collision, scene](moveit::core::RobotState* robot_state,
+                                                     const moveit::core::JointModelGroup* joint_group,
+                                                     const double* joint_group_variable_values) {
+    return pilz_industrial_motion_planner::isStateColliding(check_self_collision, scene, robot_state, joint_group,
+                                                            joint_group_variable_values);
+  };
+
+  state_.setVariablePositions(initial_joint_position);
+  joint_names_ = group_->getActiveJointModelNames();
+  const std::vector<JointLimit> limits = joint_limits.getLimits(joint_names_);
+  for (std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    last_.push_back(state_.getVariablePosition(joint_names_[i]));
+    max_velocities_.push_back(limits[i].has_velocity_limits ? limits[i].max_velocity :
+                                                              std::numeric_limits<double>::infinity());
+  }
+}
+
+bool pilz_industrial_motion_planner::PoseIKSequenceSolver::solve(const Eigen::Isometry3d& pose, double duration,
+                                                                 std::map<std::string, double>& solution)
+{
+  std::vector<double> values;
+  if (!solve(pose, duration, values))
+  {
+    return false;
+  }
+  for (std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    solution[joint_names_[i]] = values[i];
+  }
+  return true;
+}
+
+bool pilz_industrial_motion_planner::PoseIKSequenceSolver::solve(const Eigen::Isometry3d& pose, double duration,
+                                                                 std::vector<double>& solution)
+{
+  if (!isValid())
+  {
+    return false;
+  }
+
+  // predict the solution from the two previous ones, assuming a constant joint velocity
+  bool solved{ false };
+  if (!before_last_.empty() && last_duration_ > 0.0 && duration > 0.0)
+  {
+    seed_.resize(last_.size());
+    const double ratio{ duration / last_duration_ };
+    for (std::size_t i = 0; i < last_.size(); ++i)
+    {
+      seed_[i] = last_[i] + (last_[i] - before_last_[i]) * ratio;
+    }
+    solved = solveFromSeed(pose, seed_) && !isJump(duration);
+  }
+
+  // fall back to the previous solution as seed, e.g. if the prediction ended up on another IK branch
+  if (!solved && !solveFromSeed(pose, last_))
+  {
+    RCLCPP_ERROR(LOGGER, "Unable to find IK solution.");
+    return false;
+  }
+
+  solution.assign(current_.begin(), current_.end());
+  before_last_.swap(last_);
+  last_.swap(current_);
+  last_duration_ = duration;
+  return true;
+}
+
+bool pilz_industrial_motion_planner::PoseIKSequenceSolver::solveFromSeed(const Eigen::Isometry3d& pose,
+                                                                         const std::vector<double>& seed)
+{
+  for (std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    state_.setVariablePosition(joint_names_[i], seed[i]);
+  }
+  state_.enforceBounds(group_);
+
+  if (!state_.setFromIK(group_, pose, link_name_, timeout_, validity_callback_))
+  {
+    return false;
+  }
+
+  current_.resize(joint_names_.size());
+  for (std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    current_[i] = state_.getVariablePosition(joint_names_[i]);
+  }
+  return true;
+}
+
+bool pilz_industrial_motion_planner::PoseIKSequenceSolver::isJump(double duration) const
+{
+  for (std::size_t i = 0; i < current_.size(); ++i)
+  {
+    if (std::fabs(current_[i] - last_[i]) > max_velocities_[i] * duration)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool pilz_industrial_motion_planner::computeLinkFK(const planning_scene::PlanningSceneConstPtr& scene,
                                                    const std::string& link_name,
                                                    const std::map<std::string, double>& joint_state,
@@ -197,6 +348,61 @@ bool pilz_industrial_motion_planner::verifySampleJointLimits(
   return true;
 }
 
+bool pilz_industrial_motion_planner::verifySampleJointLimits(
+    const std::vector<std::string>& joint_names, const std::vector<JointLimit>& joint_limits,
+    const std::vector<double>& position_last, const std::vector<double>& velocity_last,
+    const std::vector<double>& position_current, double duration_last, double duration_current)
+{
+  const double epsilon = 10e-6;
+  if (duration_current <= epsilon)
+  {
+    RCLCPP_ERROR(LOGGER, "Sample duration too small, cannot compute the velocity");
+    return false;
+  }
+
+  for (std::size_t i = 0; i < joint_names.size(); ++i)
+  {
+    const double velocity_current = (position_current[i] - position_last[i]) / duration_current;
+    if (!JointLimitsContainer::verifyVelocityLimit(joint_limits[i], velocity_current))
+    {
+      RCLCPP_ERROR_STREAM(LOGGER, "Joint velocity limit of "
+                                      << joint_names[i] << " violated. Set the velocity scaling factor lower!"
+                                      << " Actual joint velocity is " << velocity_current << ", while the limit is "
+                                      << joint_limits[i].max_velocity << ". ");
+      return false;
+    }
+
+    const double acceleration_current =
+        (velocity_current - velocity_last[i]) / (duration_last + duration_current) * 2;
+    // acceleration case
+    if (fabs(velocity_last[i]) <= fabs(velocity_current))
+    {
+      if (!JointLimitsContainer::verifyAccelerationLimit(joint_limits[i], acceleration_current))
+      {
+        RCLCPP_ERROR_STREAM(LOGGER, "Joint acceleration limit of "
+                                        << joint_names[i] << " violated. Set the acceleration scaling factor lower!"
+                                        << " Actual joint acceleration is " << acceleration_current
+                                        << ", while the limit is " << joint_limits[i].max_acceleration << ". ");
+        return false;
+      }
+    }
+    // deceleration case
+    else
+    {
+      if (!JointLimitsContainer::verifyDecelerationLimit(joint_limits[i], acceleration_current))
+      {
+        RCLCPP_ERROR_STREAM(LOGGER, "Joint deceleration limit of "
+                                        << joint_names[i] << " violated. Set the acceleration scaling factor lower!"
+                                        << " Actual joint deceleration is " << acceleration_current
+                                        << ", while the limit is " << joint_limits[i].max_deceleration << ". ");
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 bool pilz_industrial_motion_planner::generateJointTrajectory(
     const planning_scene::PlanningSceneConstPtr& scene,
     const pilz_industrial_motion_planner::JointLimitsContainer& joint_limits, const KDL::Trajectory& trajectory,
@@ -207,7 +413,6 @@ bool pilz_industrial_motion_planner::generateJointTrajectory(
 {
   RCLCPP_DEBUG(LOGGER, "Generate joint trajectory from a Cartesian trajectory.");
 
-  const moveit::core::RobotModelConstPtr& robot_model = scene->getRobotModel();
   rclcpp::Clock clock;
   rclcpp::Time generation_begin = clock.now();
 
@@ -221,12 +426,32 @@ bool pilz_industrial_motion_planner::generateJointTrajectory(
   time_samples.push_back(trajectory.Duration());
 
   // sample the trajectory and solve the inverse kinematics
+  PoseIKSequenceSolver ik_solver(scene, joint_limits, group_name, link_name, initial_joint_position,
+                                 check_self_collision);
+
+  // the samples are computed in the joint order of the IK solutions and written in the order of the initial positions
+  joint_trajectory.joint_names.clear();
+  for (const auto& start_joint : initial_joint_position)
+  {
+    joint_trajectory.joint_names.push_back(start_joint.first);
+  }
+  std::vector<std::size_t> solution_indices;
+  if (ik_solver.isValid() &&
+      !getSolutionIndices(joint_trajectory.joint_names, ik_solver.getJointNames(), solution_indices))
+  {
+    RCLCPP_ERROR(LOGGER, "The initial joint positions are not the active joints of the planning group.");
+    error_code.val = moveit_msgs::msg::MoveItErrorCodes::PLANNING_FAILED;
+    joint_trajectory.points.clear();
+    return false;
+  }
+  const std::vector<std::string>& solution_joint_names = ik_solver.getJointNames();
+  const std::vector<JointLimit> solution_joint_limits = joint_limits.getLimits(solution_joint_names);
+
   Eigen::Isometry3d pose_sample;
-  std::map<std::string, double> ik_solution_last, ik_solution, joint_velocity_last;
-  ik_solution_last = initial_joint_position;
-  for (const auto& item : ik_solution_last)
+  std::vector<double> ik_solution_last, ik_solution, joint_velocity_last(solution_joint_names.size(), 0.0);
+  for (const auto& joint_name : solution_joint_names)
   {
-    joint_velocity_last[item.first] = 0.0;
+    ik_solution_last.push_back(initial_joint_position.at(joint_name));
   }
 
   for (std::vector<double>::const_iterator time_iter = time_samples.begin(); time_iter != time_samples.end();
@@ -234,16 +459,6 @@ bool pilz_industrial_motion_planner::generateJointTrajectory(
   {
     tf2::transformKDLToEigen(trajectory.Pos(*time_iter), pose_sample);
 
-    if (!computePoseIK(scene, group_name, link_name, pose_sample, robot_model->getModelFrame(), ik_solution_last,
-                       ik_solution, check_self_collision))
-    {
-      RCLCPP_ERROR(LOGGER, "Failed to compute inverse kinematics solution for sampled Cartesian pose.");
-      error_code.val = moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION;
-      joint_trajectory.points.clear();
-      return false;
-    }
-
-    // check the joint limits
     double duration_current_sample = sampling_time;
     // last interval can be shorter than the sampling time
     if (time_iter == (time_samples.end() - 1) && time_samples.size() > 1)
@@ -255,10 +470,22 @@ bool pilz_industrial_motion_planner::generateJointTrajectory(
       duration_current_sample = *time_iter;
     }
 
+    // the first sample is at zero time from start
+    const double duration_from_last_solution = time_iter == time_samples.begin() ? 0.0 : duration_current_sample;
+    if (!ik_solver.solve(pose_sample, duration_from_last_solution, ik_solution))
+    {
+      RCLCPP_ERROR(LOGGER, "Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+      error_code.val = moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION;
+      joint_trajectory.points.clear();
+      return false;
+    }
+
+    // check the joint limits
+
     // skip the first sample with zero time from start for limits checking
     if (time_iter != time_samples.begin() &&
-        !verifySampleJointLimits(ik_solution_last, joint_velocity_last, ik_solution, sampling_time,
-                                 duration_current_sample, joint_limits))
+        !verifySampleJointLimits(solution_joint_names, solution_joint_limits, ik_solution_last, joint_velocity_last,
+                                 ik_solution, sampling_time, duration_current_sample))
     {
       RCLCPP_ERROR_STREAM(LOGGER, "Inverse kinematics solution at "
                                       << *time_iter
@@ -270,39 +497,30 @@ bool pilz_industrial_motion_planner::generateJointTrajectory(
 
     // fill the point with joint values
     trajectory_msgs::msg::JointTrajectoryPoint point;
-
-    // set joint names
-    joint_trajectory.joint_names.clear();
-    for (const auto& start_joint : initial_joint_position)
-    {
-      joint_trajectory.joint_names.push_back(start_joint.first);
-    }
-
     point.time_from_start = rclcpp::Duration::from_seconds(*time_iter);
-    for (const auto& joint_name : joint_trajectory.joint_names)
+    for (const std::size_t j : solution_indices)
     {
-      point.positions.push_back(ik_solution.at(joint_name));
+      point.positions.push_back(ik_solution[j]);
 
       if (time_iter != time_samples.begin() && time_iter != time_samples.end() - 1)
       {
-        double joint_velocity =
-            (ik_solution.at(joint_name) - ik_solution_last.at(joint_name)) / duration_current_sample;
+        double joint_velocity = (ik_solution[j] - ik_solution_last[j]) / duration_current_sample;
         point.velocities.push_back(joint_velocity);
-        point.accelerations.push_back((joint_velocity - joint_velocity_last.at(joint_name)) /
+        point.accelerations.push_back((joint_velocity - joint_velocity_last[j]) /
                                       (duration_current_sample + sampling_time) * 2);
-        joint_velocity_last[joint_name] = joint_velocity;
+        joint_velocity_last[j] = joint_velocity;
       }
       else
       {
         point.velocities.push_back(0.);
         point.accelerations.push_back(0.);
-        joint_velocity_last[joint_name] = 0.;
+        joint_velocity_last[j] = 0.;
       }
     }
 
     // update joint trajectory
     joint_trajectory.points.push_back(point);
-    ik_solution_last = ik_solution;
+    ik_solution_last.swap(ik_solution);
   }
 
   error_code.val = moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
@@ -325,34 +543,41 @@ bool pilz_industrial_motion_planner::generateJointTrajectory(
 {
   RCLCPP_DEBUG(LOGGER, "Generate joint trajectory from a Cartesian trajectory.");
 
-  const moveit::core::RobotModelConstPtr& robot_model = scene->getRobotModel();
   rclcpp::Clock clock;
   rclcpp::Time generation_begin = clock.now();
 
-  std::map<std::string, double> ik_solution_last = initial_joint_position;
-  std::map<std::string, double> joint_velocity_last = initial_joint_velocity;
   double duration_last = 0;
   double duration_current = 0;
   joint_trajectory.joint_names.clear();
-  for (const auto& joint_position : ik_solution_last)
+  for (const auto& joint_position : initial_joint_position)
   {
     joint_trajectory.joint_names.push_back(joint_position.first);
   }
-  std::map<std::string, double> ik_solution;
-  for (size_t i = 0; i < trajectory.points.size(); ++i)
+  PoseIKSequenceSolver ik_solver(scene, joint_limits, group_name, link_name, initial_joint_position,
+                                 check_self_collision);
+
+  // the samples are computed in the joint order of the IK solutions and written in the order of the initial positions
+  std::vector<std::size_t> solution_indices;
+  if (ik_solver.isValid() &&
+      !getSolutionIndices(joint_trajectory.joint_names, ik_solver.getJointNames(), solution_indices))
   {
-    // compute inverse kinematics
-    if (!computePoseIK(scene, group_name, link_name, trajectory.points.at(i).pose, robot_model->getModelFrame(),
-                       ik_solution_last, ik_solution, check_self_collision))
-    {
-      RCLCPP_ERROR(LOGGER, "Failed to compute inverse kinematics solution for sampled "
-                           "Cartesian pose.");
-      error_code.val = moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION;
-      joint_trajectory.points.clear();
-      return false;
-    }
+    RCLCPP_ERROR(LOGGER, "The initial joint positions are not the active joints of the planning group.");
+    error_code.val = moveit_msgs::msg::MoveItErrorCodes::PLANNING_FAILED;
+    joint_trajectory.points.clear();
+    return false;
+  }
+  const std::vector<std::string>& solution_joint_names = ik_solver.getJointNames();
+  const std::vector<JointLimit> solution_joint_limits = joint_limits.getLimits(solution_joint_names);
 
-    // verify the joint limits
+  std::vector<double> ik_solution_last, ik_solution, joint_velocity_last;
+  for (const auto& joint_name : solution_joint_names)
+  {
+    ik_solution_last.push_back(initial_joint_position.at(joint_name));
+    joint_velocity_last.push_back(initial_joint_velocity.at(joint_name));
+  }
+  Eigen::Isometry3d pose_sample;
+  for (size_t i = 0; i < trajectory.points.size(); ++i)
+  {
     if (i == 0)
     {
       duration_current = trajectory.points.front().time_from_start.seconds();
@@ -364,8 +589,21 @@ bool pilz_industrial_motion_planner::generateJointTrajectory(
           trajectory.points.at(i).time_from_start.seconds() - trajectory.points.at(i - 1).time_from_start.seconds();
     }
 
-    if (!verifySampleJointLimits(ik_solution_last, joint_velocity_last, ik_solution, duration_last, duration_current,
-                                 joint_limits))
+    // compute inverse kinematics
+    tf2::convert<geometry_msgs::msg::Pose, Eigen::Isometry3d>(trajectory.points.at(i).pose, pose_sample);
+    if (!ik_solver.solve(pose_sample, duration_current, ik_solution))
+    {
+      RCLCPP_ERROR(LOGGER, "Failed to compute inverse kinematics solution for sampled "
+                           "Cartesian pose.");
+      error_code.val = moveit_msgs::msg::MoveItErrorCodes::NO_IK_SOLUTION;
+      joint_trajectory.points.clear();
+      return false;
+    }
+
+    // verify the joint limits
+
+    if (!verifySampleJointLimits(solution_joint_names, solution_joint_limits, ik_solution_last, joint_velocity_last,
+                                 ik_solution, duration_last, duration_current))
     {
       // LCOV_EXCL_START since the same code was captured in a test in the other
       // overload generateJointTrajectory(...,
@@ -384,20 +622,20 @@ bool pilz_industrial_motion_planner::generateJointTrajectory(
     // compute the waypoint
     trajectory_msgs::msg::JointTrajectoryPoint waypoint_joint;
     waypoint_joint.time_from_start = trajectory.points.at(i).time_from_start;
-    for (const auto& joint_name : joint_trajectory.joint_names)
+    for (const std::size_t j : solution_indices)
     {
-      waypoint_joint.positions.push_back(ik_solution.at(joint_name));
-      double joint_velocity = (ik_solution.at(joint_name) - ik_solution_last.at(joint_name)) / duration_current;
+      waypoint_joint.positions.push_back(ik_solution[j]);
+      double joint_velocity = (ik_solution[j] - ik_solution_last[j]) / duration_current;
       waypoint_joint.velocities.push_back(joint_velocity);
-      waypoint_joint.accelerations.push_back((joint_velocity - joint_velocity_last.at(joint_name)) /
+      waypoint_joint.accelerations.push_back((joint_velocity - joint_velocity_last[j]) /
                                              (duration_current + duration_last) * 2);
       // update the joint velocity
-      joint_velocity_last[joint_name] = joint_velocity;
+      joint_velocity_last[j] = joint_velocity;
     }
 
     // update joint trajectory
     joint_trajectory.points.push_back(waypoint_joint);
-    ik_solution_last = ik_solution;
+    ik_solution_last.swap(ik_solution);
     duration_last = duration_current;
   }
 
@@ -94,17 +94,33 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
                                      const double& velocity_scaling_factor, const double& acceleration_scaling_factor,
                                      const double& sampling_time)
 {
-  // initialize joint names
+  std::vector<std::string> joint_names;
+  std::vector<double> start_positions, goal_positions;
   for (const auto& item : goal_pos)
   {
-    joint_trajectory.joint_names.push_back(item.first);
+    joint_names.push_back(item.first);
+    start_positions.push_back(start_pos.at(item.first));
+    goal_positions.push_back(item.second);
   }
+  planPTP(joint_names, start_positions, goal_positions, joint_trajectory, velocity_scaling_factor,
+          acceleration_scaling_factor, sampling_time);
+}
+
+void TrajectoryGeneratorPTP::planPTP(const std::vector<std::string>& joint_names, const std::vector<double>& start_pos,
+                                     const std::vector<double>& goal_pos,
+                                     trajectory_msgs::msg::JointTrajectory& joint_trajectory,
+                                     const double& velocity_scaling_factor, const double& acceleration_scaling_factor,
+                                     const double& sampling_time)
+{
+  // initialize joint names
+  joint_trajectory.joint_names.insert(joint_trajectory.joint_names.end(), joint_names.begin(), joint_names.end());
+  const std::size_t joint_count = joint_names.size();
 
   // check if goal already reached
   bool goal_reached = true;
-  for (const auto& goal : goal_pos)
+  for (std::size_t i = 0; i < joint_count; ++i)
   {
-    if (fabs(start_pos.at(goal.first) - goal.second) >= MIN_MOVEMENT)
+    if (fabs(start_pos[i] - goal_pos[i]) >= MIN_MOVEMENT)
     {
       goal_reached = false;
       break;
@@ -117,35 +133,31 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
     {
       trajectory_msgs::msg::JointTrajectoryPoint point;
       point.time_from_start = rclcpp::Duration::from_seconds(sampling_time);
-      for (const std::string& joint_name : joint_trajectory.joint_names)
-      {
-        point.positions.push_back(start_pos.at(joint_name));
-        point.velocities.push_back(0);
-        point.accelerations.push_back(0);
-      }
+      point.positions = start_pos;
+      point.velocities.assign(joint_count, 0.0);
+      point.accelerations.assign(joint_count, 0.0);
       joint_trajectory.points.push_back(point);
     }
     return;
   }
 
   // compute the fastest trajectory and choose the slowest joint as leading axis
-  std::string leading_axis = joint_trajectory.joint_names.front();
+  std::size_t leading_axis = 0;
   double max_duration = -1.0;
 
-  std::map<std::string, VelocityProfileATrap> velocity_profile;
-  for (const auto& joint_name : joint_trajectory.joint_names)
+  std::vector<VelocityProfileATrap> velocity_profile;
+  velocity_profile.reserve(joint_count);
+  for (std::size_t i = 0; i < joint_count; ++i)
   {
-    // create vecocity profile if necessary
-    velocity_profile.insert(std::make_pair(
-        joint_name, VelocityProfileATrap(velocity_scaling_factor * most_strict_limit_.max_velocity,
-                                         acceleration_scaling_factor * most_strict_limit_.max_acceleration,
-                                         acceleration_scaling_factor * most_strict_limit_.max_deceleration)));
-
-    velocity_profile.at(joint_name).SetProfile(start_pos.at(joint_name), goal_pos.at(joint_name));
-    if (velocity_profile.at(joint_name).Duration() > max_duration)
+    velocity_profile.emplace_back(velocity_scaling_factor * most_strict_limit_.max_velocity,
+                                  acceleration_scaling_factor * most_strict_limit_.max_acceleration,
+                                  acceleration_scaling_factor * most_strict_limit_.max_deceleration);
+
+    velocity_profile[i].SetProfile(start_pos[i], goal_pos[i]);
+    if (velocity_profile[i].Duration() > max_duration)
     {
-      max_duration = velocity_profile.at(joint_name).Duration();
-      leading_axis = joint_name;
+      max_duration = velocity_profile[i].Duration();
+      leading_axis = i;
     }
   }
 
@@ -153,27 +165,25 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
   // This should only work if all axes have same max_vel, max_acc, max_dec
   // values
   // reset the velocity profile for other joints
-  double acc_time = velocity_profile.at(leading_axis).firstPhaseDuration();
-  double const_time = velocity_profile.at(leading_axis).secondPhaseDuration();
-  double dec_time = velocity_profile.at(leading_axis).thirdPhaseDuration();
+  double acc_time = velocity_profile[leading_axis].firstPhaseDuration();
+  double const_time = velocity_profile[leading_axis].secondPhaseDuration();
+  double dec_time = velocity_profile[leading_axis].thirdPhaseDuration();
 
-  for (const auto& joint_name : joint_trajectory.joint_names)
+  for (std::size_t i = 0; i < joint_count; ++i)
   {
-    if (joint_name != leading_axis)
+    if (i != leading_axis)
     {
       // make full synchronization
       // causes the program to terminate if acc_time<=0 or dec_time<=0 (should
       // be prevented by goal_reached block above)
       // by using the most strict limit, the following should always return true
-      if (!velocity_profile.at(joint_name)
-               .setProfileAllDurations(start_pos.at(joint_name), goal_pos.at(joint_name), acc_time, const_time,
-                                       dec_time))
+      if (!velocity_profile[i].setProfileAllDurations(start_pos[i], goal_pos[i], acc_time, const_time, dec_time))
       // LCOV_EXCL_START
       {
         std::stringstream error_str;
         error_str << "TrajectoryGeneratorPTP::planPTP(): Can not synchronize "
                      "velocity profile of axis "
-                  << joint_name << " with leading axis " << leading_axis;
+                  << joint_names[i] << " with leading axis " << joint_names[leading_axis];
         throw PtpVelocityProfileSyncFailed(error_str.str());
       }
       // LCOV_EXCL_STOP
@@ -189,18 +199,19 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
   // add last time
   time_samples.push_back(max_duration);
 
-  // construct joint trajectory point
-  for (double time_stamp : time_samples)
+  // construct joint trajectory points, sampling all joints at once since their profiles share the phase durations
+  const SynchronizedProfilesATrap synchronized_profiles(velocity_profile);
+  const std::size_t first_point = joint_trajectory.points.size();
+  joint_trajectory.points.resize(first_point + time_samples.size());
+  for (std::size_t i = 0; i < time_samples.size(); ++i)
   {
-    trajectory_msgs::msg::JointTrajectoryPoint point;
-    point.time_from_start = rclcpp::Duration::from_seconds(time_stamp);
-    for (std::string& joint_name : joint_trajectory.joint_names)
-    {
-      point.positions.push_back(velocity_profile.at(joint_name).Pos(time_stamp));
-      point.velocities.push_back(velocity_profile.at(joint_name).Vel(time_stamp));
-      point.accelerations.push_back(velocity_profile.at(joint_name).Acc(time_stamp));
-    }
-    joint_trajectory.points.push_back(point);
+    trajectory_msgs::msg::JointTrajectoryPoint& point = joint_trajectory.points[first_point + i];
+    point.time_from_start = rclcpp::Duration::from_seconds(time_samples[i]);
+    point.positions.resize(joint_count);
+    point.velocities.resize(joint_count);
+    point.accelerations.resize(joint_count);
+    synchronized_profiles.sample(time_samples[i], point.positions.data(), point.velocities.data(),
+                                 point.accelerations.data());
   }
 
   // Set last point velocity and acceleration to zero
@@ -34,6 +34,9 @@
 
 #include <pilz_industrial_motion_planner/velocity_profile_atrap.h>
 
+#include <algorithm>
+#include <cassert>
+
 namespace pilz_industrial_motion_planner
 {
 VelocityProfileATrap::VelocityProfileATrap(double max_vel, double max_acc, double max_dec)
@@ -448,4 +451,102 @@ void VelocityProfileATrap::setEmptyProfile()
   t_c_ = 0;
 }
 
+SynchronizedProfilesATrap::SynchronizedProfilesATrap(const std::vector<VelocityProfileATrap>& profiles)
+{
+  if (!profiles.empty())
+  {
+    t_a_ = profiles.front().t_a_;
+    t_b_ = profiles.front().t_b_;
+    t_c_ = profiles.front().t_c_;
+  }
+  for (const VelocityProfileATrap& profile : profiles)
+  {
+    assert(profile.t_a_ == t_a_ && profile.t_b_ == t_b_ && profile.t_c_ == t_c_);
+    start_pos_.push_back(profile.start_pos_);
+    end_pos_.push_back(profile.end_pos_);
+    start_vel_.push_back(profile.start_vel_);
+    phases_[0].c0.push_back(profile.a1_);
+    phases_[0].c1.push_back(profile.a2_);
+    phases_[0].c2.push_back(profile.a3_);
+    phases_[1].c0.push_back(profile.b1_);
+    phases_[1].c1.push_back(profile.b2_);
+    phases_[1].c2.push_back(profile.b3_);
+    phases_[2].c0.push_back(profile.c1_);
+    phases_[2].c1.push_back(profile.c2_);
+    phases_[2].c2.push_back(profile.c3_);
+  }
+}
+
+void SynchronizedProfilesATrap::evaluate(const Phase& phase, double time, double* positions, double* velocities)
+{
+  const std::size_t n = phase.c0.size();
+  const double* c0 = phase.c0.data();
+  const double* c1 = phase.c1.data();
+  const double* c2 = phase.c2.data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    positions[i] = c0[i] + time * (c1[i] + c2[i] * time);
+    velocities[i] = c1[i] + 2 * c2[i] * time;
+  }
+}
+
+void SynchronizedProfilesATrap::sample(double time, double* positions, double* velocities,
+                                       double* accelerations) const
+{
+  const std::size_t n = size();
+
+  // positions and velocities, with the phase bounds of Pos() and Vel()
+  if (time < 0)
+  {
+    std::copy(start_pos_.begin(), start_pos_.end(), positions);
+    std::copy(start_vel_.begin(), start_vel_.end(), velocities);
+  }
+  else if (time < t_a_)
+  {
+    evaluate(phases_[0], time, positions, velocities);
+  }
+  else if (time < (t_a_ + t_b_))
+  {
+    evaluate(phases_[1], time - t_a_, positions, velocities);
+  }
+  else if (time <= (t_a_ + t_b_ + t_c_))
+  {
+    evaluate(phases_[2], time - t_a_ - t_b_, positions, velocities);
+  }
+  else
+  {
+    std::copy(end_pos_.begin(), end_pos_.end(), positions);
+    std::fill(velocities, velocities + n, 0.0);
+  }
+
+  // accelerations, with the phase bounds of Acc()
+  const std::vector<double>* c2 = nullptr;
+  if (time > 0)
+  {
+    if (time <= t_a_)
+    {
+      c2 = &phases_[0].c2;
+    }
+    else if (time <= (t_a_ + t_b_))
+    {
+      c2 = &phases_[1].c2;
+    }
+    else if (time <= (t_a_ + t_b_ + t_c_))
+    {
+      c2 = &phases_[2].c2;
+    }
+  }
+  if (c2)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      accelerations[i] = 2 * (*c2)[i];
+    }
+  }
+  else
+  {
+    std::fill(accelerations, accelerations + n, 0.0);
+  }
+}
+
 }  // namespace pilz_industrial_motion_planner
@@ -584,6 +584,87 @@ TEST_F(IntegrationTestCommandListManager, TestDifferentGroups)
   }
 }
 
+/**
+ * @brief Checks that solving a sequence with several threads gives the
+ * same trajectories as solving it on the calling thread.
+ *
+ * Test Sequence:
+ *    1. Solve a blended sequence of two groups with the default manager.
+ *    2. Solve the same sequence with a manager using four threads.
+ *
+ * Expected Results:
+ *    1. Planning succeeds.
+ *    2. Planning succeeds and all trajectories have the same waypoints and
+ *       durations as in Test Step 1.
+ */
+TEST_F(IntegrationTestCommandListManager, TestParallelSequenceThreads)
+{
+  Sequence seq{ data_loader_->getSequence("ComplexSequenceWithGripper") };
+  ASSERT_GE(seq.size(), 2u);
+  RobotTrajCont res_serial_vec{ manager_->solve(scene_, pipeline_, seq.toRequest()) };
+
+  ph_.setParam("pilz_industrial_motion_planner.sequence_threads", 4);
+  auto parallel_manager = std::make_shared<pilz_industrial_motion_planner::CommandListManager>(ph_, robot_model_);
+  RobotTrajCont res_parallel_vec{ parallel_manager->solve(scene_, pipeline_, seq.toRequest()) };
+
+  ASSERT_EQ(res_serial_vec.size(), res_parallel_vec.size());
+  for (size_t i = 0; i < res_serial_vec.size(); ++i)
+  {
+    ASSERT_EQ(res_serial_vec.at(i)->getWayPointCount(), res_parallel_vec.at(i)->getWayPointCount());
+    for (size_t j = 0; j < res_serial_vec.at(i)->getWayPointCount(); ++j)
+    {
+      EXPECT_NEAR(res_serial_vec.at(i)->getWayPoint(j).distance(res_parallel_vec.at(i)->getWayPoint(j)), 0.0, 1e-10);
+      EXPECT_DOUBLE_EQ(res_serial_vec.at(i)->getWayPointDurationFromPrevious(j),
+                       res_parallel_vec.at(i)->getWayPointDurationFromPrevious(j));
+    }
+  }
+}
+
+/**
+ * @brief Checks that solving a changed sequence with the segments and blends
+ * cached from the previous request gives the same trajectories as solving it
+ * without the cache.
+ *
+ * Test Sequence:
+ *    1. Solve a blended sequence with the default (caching) manager.
+ *    2. Change one blend radius and solve again with the caching manager and
+ *       with a manager without sequence cache.
+ *
+ * Expected Results:
+ *    1. Planning succeeds.
+ *    2. Planning succeeds and both managers return trajectories with the same
+ *       waypoints and durations.
+ */
+TEST_F(IntegrationTestCommandListManager, TestSequenceCache)
+{
+  Sequence seq{ data_loader_->getSequence("ComplexSequence") };
+  ASSERT_GE(seq.size(), 3u);
+  seq.erase(3, seq.size());
+  seq.setAllBlendRadiiToZero();
+  seq.setBlendRadius(0, 0.1);
+  RobotTrajCont res_first_vec{ manager_->solve(scene_, pipeline_, seq.toRequest()) };
+  ASSERT_EQ(res_first_vec.size(), 1u);
+
+  seq.setBlendRadius(1, 0.1);
+  RobotTrajCont res_cached_vec{ manager_->solve(scene_, pipeline_, seq.toRequest()) };
+
+  ph_.setParam("pilz_industrial_motion_planner.sequence_cache", false);
+  auto uncached_manager = std::make_shared<pilz_industrial_motion_planner::CommandListManager>(ph_, robot_model_);
+  RobotTrajCont res_uncached_vec{ uncached_manager->solve(scene_, pipeline_, seq.toRequest()) };
+
+  ASSERT_EQ(res_cached_vec.size(), res_uncached_vec.size());
+  for (size_t i = 0; i < res_cached_vec.size(); ++i)
+  {
+    ASSERT_EQ(res_cached_vec.at(i)->getWayPointCount(), res_uncached_vec.at(i)->getWayPointCount());
+    for (size_t j = 0; j < res_cached_vec.at(i)->getWayPointCount(); ++j)
+    {
+      EXPECT_NEAR(res_cached_vec.at(i)->getWayPoint(j).distance(res_uncached_vec.at(i)->getWayPoint(j)), 0.0, 1e-10);
+      EXPECT_DOUBLE_EQ(res_cached_vec.at(i)->getWayPointDurationFromPrevious(j),
+                       res_uncached_vec.at(i)->getWayPointDurationFromPrevious(j));
+    }
+  }
+}
+
 /**
  * @brief Checks that no exception is thrown if two gripper commands are
  * blended.
@@ -203,6 +203,33 @@ TEST_F(JointLimitsContainerTest, FirstPositionEmpty)
   EXPECT_EQ(-1, limits.min_position);
 }
 
+/**
+ * @brief limits looked up by index follow the order of the joint names,
+ * joints without limit get an empty limit
+ */
+TEST_F(JointLimitsContainerTest, GetLimitsInJointOrder)
+{
+  pilz_industrial_motion_planner::JointLimit lim;
+  lim.has_velocity_limits = true;
+  lim.max_velocity = 2;
+
+  pilz_industrial_motion_planner::JointLimitsContainer container;
+  container.addLimit("joint1", lim);
+
+  const std::vector<pilz_industrial_motion_planner::JointLimit> limits =
+      container.getLimits({ "joint2", "joint1" });
+  ASSERT_EQ(2u, limits.size());
+  EXPECT_FALSE(limits[0].has_velocity_limits);
+  EXPECT_TRUE(limits[1].has_velocity_limits);
+  EXPECT_EQ(2, limits[1].max_velocity);
+
+  EXPECT_TRUE(pilz_industrial_motion_planner::JointLimitsContainer::verifyVelocityLimit(limits[0], 3));
+  EXPECT_FALSE(pilz_industrial_motion_planner::JointLimitsContainer::verifyVelocityLimit(limits[1], -3));
+  EXPECT_TRUE(pilz_industrial_motion_planner::JointLimitsContainer::verifyVelocityLimit(limits[1], 1));
+  EXPECT_EQ(container.verifyVelocityLimit("joint1", 3),
+            pilz_industrial_motion_planner::JointLimitsContainer::verifyVelocityLimit(limits[1], 3));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
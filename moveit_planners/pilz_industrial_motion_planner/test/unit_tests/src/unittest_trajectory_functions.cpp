@@ -435,6 +435,77 @@ TEST_F(TrajectoryFunctionsTestFlangeAndGripper, testComputePoseIKInvalidFrameId)
                                                              "InvalidFrameId", ik_seed, ik_actual, false));
 }
 
+/**
+ * @brief Test that PoseIKSequenceSolver follows a sequence of poses
+ * generated from closely spaced joint positions.
+ *
+ * Test Sequence:
+ *    1. Sample a random start state and move all joints with constant
+ *       velocity.
+ *    2. Solve the IK of the link poses along that motion one after another.
+ *
+ * Expected Results:
+ *    1. -
+ *    2. All poses are solved and the solutions stay close to the joint
+ *       positions the poses were generated from.
+ */
+TEST_F(TrajectoryFunctionsTestFlangeAndGripper, testPoseIKSequenceSolver)
+{
+  moveit::core::RobotState rstate(robot_model_);
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz_industrial_motion_planner::JointLimitsContainer joint_limits;
+  const double sampling_time{ 0.01 };
+  const double joint_velocity{ 0.2 };
+
+  while (random_test_number_ > 0)
+  {
+    rstate.setToRandomPositions(jmg, rng_);
+
+    std::map<std::string, double> start;
+    for (const auto& joint_name : jmg->getActiveJointModelNames())
+    {
+      start[joint_name] = rstate.getVariablePosition(joint_name);
+    }
+
+    pilz_industrial_motion_planner::PoseIKSequenceSolver ik_solver(planning_scene_, joint_limits, planning_group_,
+                                                                   tcp_link_, start, false);
+    ASSERT_TRUE(ik_solver.isValid());
+
+    std::map<std::string, double> ik_actual;
+    for (int step = 1; step <= 10; ++step)
+    {
+      for (const auto& joint : start)
+      {
+        double position{ joint.second + (joint.second > 0 ? -1 : 1) * joint_velocity * sampling_time * step };
+        rstate.setVariablePosition(joint.first, position);
+      }
+      rstate.update();
+
+      ASSERT_TRUE(ik_solver.solve(rstate.getFrameTransform(tcp_link_), sampling_time, ik_actual));
+      for (const auto& joint_pair : ik_actual)
+      {
+        EXPECT_NEAR(joint_pair.second, rstate.getVariablePosition(joint_pair.first), 4 * IK_SEED_OFFSET);
+      }
+    }
+
+    --random_test_number_;
+  }
+}
+
+/**
+ * @brief Test PoseIKSequenceSolver for invalid group_name
+ */
+TEST_F(TrajectoryFunctionsTestFlangeAndGripper, testPoseIKSequenceSolverInvalidGroupName)
+{
+  pilz_industrial_motion_planner::JointLimitsContainer joint_limits;
+  pilz_industrial_motion_planner::PoseIKSequenceSolver ik_solver(planning_scene_, joint_limits, "InvalidGroupName",
+                                                                 tcp_link_, zero_state_, false);
+  EXPECT_FALSE(ik_solver.isValid());
+
+  std::map<std::string, double> ik_actual;
+  EXPECT_FALSE(ik_solver.solve(Eigen::Isometry3d::Identity(), 0.1, ik_actual));
+}
+
 // /**
 //  * @brief Test if activated self collision for a pose that would be in self
 //  * collision without the check results in a
@@ -624,6 +624,34 @@ TEST(ATrapTest, Test_Clone)
   delete vp_clone;
 }
 
+TEST(ATrapTest, Test_SynchronizedProfiles)
+{
+  // a leading profile and two profiles synchronized to it, one of them not moving
+  std::vector<pilz_industrial_motion_planner::VelocityProfileATrap> profiles(
+      3, pilz_industrial_motion_planner::VelocityProfileATrap(4, 2, 1));
+  profiles[0].SetProfile(3, 35);
+  EXPECT_TRUE(profiles[1].setProfileAllDurations(1, -5, profiles[0].firstPhaseDuration(),
+                                                 profiles[0].secondPhaseDuration(), profiles[0].thirdPhaseDuration()));
+  EXPECT_TRUE(profiles[2].setProfileAllDurations(2, 2, profiles[0].firstPhaseDuration(),
+                                                 profiles[0].secondPhaseDuration(), profiles[0].thirdPhaseDuration()));
+
+  const pilz_industrial_motion_planner::SynchronizedProfilesATrap synchronized(profiles);
+  ASSERT_EQ(synchronized.size(), 3u);
+
+  // includes the phase bounds 0, 2, 7 and 11, where Pos() and Acc() switch phases differently
+  double positions[3], velocities[3], accelerations[3];
+  for (const double time : { -1.0, 0.0, 1.0, 2.0, 4.5, 7.0, 9.0, 11.0, 12.0 })
+  {
+    synchronized.sample(time, positions, velocities, accelerations);
+    for (std::size_t i = 0; i < profiles.size(); ++i)
+    {
+      EXPECT_EQ(positions[i], profiles[i].Pos(time)) << "time " << time << " profile " << i;
+      EXPECT_EQ(velocities[i], profiles[i].Vel(time)) << "time " << time << " profile " << i;
+      EXPECT_EQ(accelerations[i], profiles[i].Acc(time)) << "time " << time << " profile " << i;
+    }
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -163,7 +163,8 @@ CostFn get_cost_function_from_state_validator(const StateValidatorFn& state_vali
  * @param group             The group to use for computing link transforms from joint positions
  * @param collision_penalty The penalty cost value applied to colliding states
  *
- * @return                  Cost function that computes smooth costs for colliding path segments
+ * @return                  Cost function that computes smooth costs for colliding path segments. The function owns
+ *                          the robot state it updates, so every thread needs to create its own instance.
  */
 CostFn get_collision_cost_function(const std::shared_ptr<const planning_scene::PlanningScene>& planning_scene,
                                    const moveit::core::JointModelGroup* group, double collision_penalty)
@@ -171,14 +172,13 @@ CostFn get_collision_cost_function(const std::shared_ptr<const planning_scene::P
   const auto& joints = group ? group->getActiveJointModels() : planning_scene->getRobotModel()->getActiveJointModels();
   const auto& group_name = group ? group->getName() : "";
 
+  auto state = std::make_shared<moveit::core::RobotState>(planning_scene->getCurrentState());
   StateValidatorFn collision_validator_fn = [=](const Eigen::VectorXd& positions) {
-    static moveit::core::RobotState state(planning_scene->getCurrentState());
-
     // Update robot state values
-    set_joint_positions(positions, joints, state);
-    state.update();
+    set_joint_positions(positions, joints, *state);
+    state->update();
 
-    return !planning_scene->isStateColliding(state, group_name);
+    return !planning_scene->isStateColliding(*state, group_name);
   };
 
   return get_cost_function_from_state_validator(collision_validator_fn, COL_CHECK_DISTANCE, collision_penalty);
@@ -194,7 +194,8 @@ CostFn get_collision_cost_function(const std::shared_ptr<const planning_scene::P
  * @param constraints_msg     The constraints used for validating group states
  * @param constraints_penalty The penalty cost value applied to invalid states
  *
- * @return                    Cost function that computes smooth costs for invalid path segments
+ * @return                    Cost function that computes smooth costs for invalid path segments. The function owns
+ *                            the robot state it updates, so every thread needs to create its own instance.
  */
 CostFn get_constraints_cost_function(const std::shared_ptr<const planning_scene::PlanningScene>& planning_scene,
                                      const moveit::core::JointModelGroup* group,
@@ -205,16 +206,15 @@ CostFn get_constraints_cost_function(const std::shared_ptr<const planning_scene:
   kinematic_constraints::KinematicConstraintSet constraints(planning_scene->getRobotModel());
   constraints.add(constraints_msg, planning_scene->getTransforms());
 
+  auto state = std::make_shared<moveit::core::RobotState>(planning_scene->getCurrentState());
   StateValidatorFn constraints_validator_fn = [=](const Eigen::VectorXd& positions) {
-    static moveit::core::RobotState state(planning_scene->getCurrentState());
-
     // Update robot state values
-    set_joint_positions(positions, joints, state);
-    state.update();
+    set_joint_positions(positions, joints, *state);
+    state->update();
 
     // NOTE: the returned ConstraintEvaluationResult also provides a `double distance` which might be used as an
     // actual cost gradient instead of the binary state penalty
-    return constraints.decide(state).satisfied;
+    return constraints.decide(*state).satisfied;
   };
 
   return get_cost_function_from_state_validator(constraints_validator_fn, CONSTRAINT_CHECK_DISTANCE,
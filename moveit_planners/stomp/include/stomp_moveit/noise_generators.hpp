@@ -42,20 +42,23 @@
 #include <stomp_moveit/stomp_moveit_task.hpp>  // Function definitions
 #include <stomp_moveit/math/multivariate_gaussian.hpp>
 #include <Eigen/Geometry>
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <memory>
+#include <random>
 
 namespace stomp_moveit
 {
 namespace noise
 {
 /**
- * Creates a noise generator function that applies noise sampled from a normal distribution.
- * The noise is applied over a matrix of size (num_timesteps, stddev.size()) which corresponds
- * to the matrix representation of a robot trajectory.
+ * Computes the covariance of the noise applied to trajectories, which is the scaled inverse of the finite difference
+ * acceleration matrix. Noise sampled with this covariance is smooth over the waypoints.
  *
  * @param num_timesteps the waypoint count of the trajectory
- * @param stddev the standard deviation for each variable dimension (number of joints)
  */
-NoiseGeneratorFn get_normal_distribution_generator(size_t num_timesteps, const std::vector<double>& stddev)
+Eigen::MatrixXd get_smooth_noise_covariance(size_t num_timesteps)
 {
   // Five-point stencil constants
   static const std::vector<double> ACC_MATRIX_DIAGONAL_VALUES = { -1.0 / 12.0, 16.0 / 12.0, -30.0 / 12.0, 16.0 / 12.0,
@@ -79,6 +82,20 @@ NoiseGeneratorFn get_normal_distribution_generator(size_t num_timesteps, const s
   covariance = acceleration.transpose() * acceleration;
   covariance = covariance.fullPivLu().inverse();
   covariance /= covariance.array().abs().matrix().maxCoeff();
+  return covariance;
+}
+
+/**
+ * Creates a noise generator function that applies noise sampled from a normal distribution.
+ * The noise is applied over a matrix of size (num_timesteps, stddev.size()) which corresponds
+ * to the matrix representation of a robot trajectory.
+ *
+ * @param num_timesteps the waypoint count of the trajectory
+ * @param stddev the standard deviation for each variable dimension (number of joints)
+ */
+NoiseGeneratorFn get_normal_distribution_generator(size_t num_timesteps, const std::vector<double>& stddev)
+{
+  const Eigen::MatrixXd covariance = get_smooth_noise_covariance(num_timesteps);
 
   // create random generators
   std::vector<math::MultivariateGaussianPtr> rand_generators(stddev.size());
@@ -102,5 +119,65 @@ NoiseGeneratorFn get_normal_distribution_generator(size_t num_timesteps, const s
   };
   return noise_generator_fn;
 }
+
+/**
+ * Creates a noise generator function that draws the same noise distribution as get_normal_distribution_generator(),
+ * but computes the noise of all joints of batch_size calls at once. Standard normal samples are drawn into a
+ * preallocated buffer and multiplied with the Cholesky factor of the covariance in a single matrix product. The
+ * buffers are reused for the whole planning run, so generating noise does not allocate.
+ *
+ * @param num_timesteps the waypoint count of the trajectory
+ * @param stddev the standard deviation for each variable dimension (number of joints)
+ * @param batch_size the number of noisy trajectories computed at once, typically the number of rollouts per iteration
+ */
+NoiseGeneratorFn get_batched_normal_distribution_generator(size_t num_timesteps, const std::vector<double>& stddev,
+                                                           size_t batch_size)
+{
+  struct NoiseBatch
+  {
+    Eigen::MatrixXd covariance_cholesky;
+    Eigen::MatrixXd raw_samples;
+    Eigen::MatrixXd samples;
+    Eigen::Index next_column;
+    std::mt19937 rng;
+    std::normal_distribution<double> normal_dist;
+  };
+
+  const auto num_dimensions = static_cast<Eigen::Index>(stddev.size());
+  auto batch = std::make_shared<NoiseBatch>();
+  batch->covariance_cholesky = get_smooth_noise_covariance(num_timesteps).llt().matrixL();
+  batch->raw_samples.resize(num_timesteps, num_dimensions * std::max<size_t>(batch_size, 1));
+  batch->samples.resizeLike(batch->raw_samples);
+  batch->next_column = batch->samples.cols();  // the first call fills the buffer
+  batch->rng.seed(rand());
+  const Eigen::VectorXd scale = Eigen::Map<const Eigen::VectorXd>(stddev.data(), num_dimensions);
+
+  NoiseGeneratorFn noise_generator_fn = [=](const Eigen::MatrixXd& values, Eigen::MatrixXd& noisy_values,
+                                            Eigen::MatrixXd& noise) {
+    if (values.rows() != num_dimensions || values.cols() != batch->samples.rows())
+    {
+      return false;
+    }
+
+    if (batch->next_column + num_dimensions > batch->samples.cols())
+    {
+      double* raw = batch->raw_samples.data();
+      for (Eigen::Index i = 0; i < batch->raw_samples.size(); ++i)
+      {
+        raw[i] = batch->normal_dist(batch->rng);
+      }
+      batch->samples.noalias() = batch->covariance_cholesky.triangularView<Eigen::Lower>() * batch->raw_samples;
+      batch->samples.topRows(1).setZero();
+      batch->samples.bottomRows(1).setZero();  // zeroing out the start and end noise values
+      batch->next_column = 0;
+    }
+
+    noise = (batch->samples.middleCols(batch->next_column, num_dimensions) * scale.asDiagonal()).transpose();
+    noisy_values = values + noise;
+    batch->next_column += num_dimensions;
+    return true;
+  };
+  return noise_generator_fn;
+}
 }  // namespace noise
 }  // namespace stomp_moveit
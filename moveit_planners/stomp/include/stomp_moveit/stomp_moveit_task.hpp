@@ -46,6 +46,9 @@
  * - PostIterationFn: reports on planning progress at each iteration (see STOMP documentation)
  * - DoneFn: reports on planning result when STOMP run terminates
  *
+ * The costs of noisy rollouts can optionally be computed in parallel by passing one additional CostFn instance per
+ * worker thread. Each rollout is queued for evaluation as soon as it has been generated.
+ *
  * Each of these functions use Eigen types for representing path and waypoints.
  * The Eigen::MatrixXd 'values' refer to full path candidates where rows are the joint dimensions
  * and columns are the waypoints. Accordingly, Eigen::VectorXd is used for representing cost values,
@@ -54,6 +57,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <stomp/task.h>
 
 namespace stomp_moveit
@@ -75,20 +87,40 @@ using DoneFn =
 //
 // The ComposableTask stores custom functions for the most important callback types in STOMP and applies them during
 // a motion planning run. This class is used for injecting MoveIt concepts and other custom features into STOMP.
+//
+// If rollout_cost_fns is not empty, one worker thread is started per cost function. Noisy rollouts are evaluated by
+// these threads while STOMP keeps generating the remaining rollouts of the iteration. The cost functions are never
+// shared between threads, so they may keep their own state (e.g. a RobotState).
 class ComposableTask final : public stomp::Task
 {
 public:
   ComposableTask(NoiseGeneratorFn noise_generator_fn, CostFn cost_fn, FilterFn filter_fn,
-                 PostIterationFn post_iteration_fn, DoneFn done_fn)
+                 PostIterationFn post_iteration_fn, DoneFn done_fn, std::vector<CostFn> rollout_cost_fns = {})
     : noise_generator_fn_(std::move(noise_generator_fn))
     , cost_fn_(std::move(cost_fn))
     , filter_fn_(std::move(filter_fn))
     , post_iteration_fn_(std::move(post_iteration_fn))
     , done_fn_(std::move(done_fn))
+    , rollout_cost_fns_(std::move(rollout_cost_fns))
   {
+    for (const auto& rollout_cost_fn : rollout_cost_fns_)
+    {
+      workers_.emplace_back([this, &rollout_cost_fn] { evaluateRollouts(rollout_cost_fn); });
+    }
   }
 
-  ~ComposableTask() = default;
+  ~ComposableTask()
+  {
+    {
+      std::lock_guard<std::mutex> lock(rollouts_mutex_);
+      stop_workers_ = true;
+    }
+    rollouts_cv_.notify_all();
+    for (auto& worker : workers_)
+    {
+      worker.join();
+    }
+  }
 
   /**
    * @brief Generates a noisy trajectory from the parameters.
@@ -102,10 +134,18 @@ public:
    * @return True if cost were properly computed, otherwise false
    */
   bool generateNoisyParameters(const Eigen::MatrixXd& parameters, std::size_t /*start_timestep*/,
-                               std::size_t /*num_timesteps*/, int /*iteration_number*/, int /*rollout_number*/,
+                               std::size_t /*num_timesteps*/, int /*iteration_number*/, int rollout_number,
                                Eigen::MatrixXd& parameters_noise, Eigen::MatrixXd& noise) override
   {
-    return noise_generator_fn_(parameters, parameters_noise, noise);
+    if (!noise_generator_fn_(parameters, parameters_noise, noise))
+    {
+      return false;
+    }
+    if (!workers_.empty())
+    {
+      scheduleRollout(rollout_number, parameters_noise);
+    }
+    return true;
   }
 
   /**
@@ -136,9 +176,14 @@ public:
    * @return True if cost were properly computed, otherwise false
    */
   bool computeNoisyCosts(const Eigen::MatrixXd& parameters, std::size_t /*start_timestep*/,
-                         std::size_t /*num_timesteps*/, int /*iteration_number*/, int /*rollout_number*/,
+                         std::size_t /*num_timesteps*/, int /*iteration_number*/, int rollout_number,
                          Eigen::VectorXd& costs, bool& validity) override
   {
+    bool success = false;
+    if (!workers_.empty() && takeRolloutCosts(rollout_number, parameters, costs, validity, success))
+    {
+      return success;
+    }
     return cost_fn_(parameters, costs, validity);
   }
 
@@ -188,10 +233,101 @@ public:
   }
 
 private:
+  // @brief A noisy rollout that is queued for, or has finished, parallel cost evaluation
+  struct Rollout
+  {
+    Eigen::MatrixXd parameters;
+    Eigen::VectorXd costs;
+    bool validity = false;
+    bool success = false;
+    bool done = false;
+  };
+
+  // @brief Queue a generated rollout for evaluation, replacing a result of the same index that was never used
+  void scheduleRollout(int rollout_number, const Eigen::MatrixXd& parameters)
+  {
+    auto rollout = std::make_shared<Rollout>();
+    rollout->parameters = parameters;
+    {
+      std::lock_guard<std::mutex> lock(rollouts_mutex_);
+      rollouts_[rollout_number] = rollout;
+      queued_rollouts_.push_back(rollout);
+    }
+    rollouts_cv_.notify_one();
+  }
+
+  // @brief Get the costs of a scheduled rollout, returns false if the caller needs to compute them itself
+  bool takeRolloutCosts(int rollout_number, const Eigen::MatrixXd& parameters, Eigen::VectorXd& costs, bool& validity,
+                        bool& success)
+  {
+    std::unique_lock<std::mutex> lock(rollouts_mutex_);
+    auto it = rollouts_.find(rollout_number);
+    if (it == rollouts_.end())
+    {
+      return false;
+    }
+    const auto rollout = it->second;
+    rollouts_.erase(it);
+
+    // rollouts that no worker has started yet are evaluated by the calling thread right away
+    auto queued = std::find(queued_rollouts_.begin(), queued_rollouts_.end(), rollout);
+    if (queued != queued_rollouts_.end())
+    {
+      queued_rollouts_.erase(queued);
+      return false;
+    }
+
+    // STOMP may have modified the rollout since it was generated
+    if (rollout->parameters.rows() != parameters.rows() || rollout->parameters.cols() != parameters.cols() ||
+        rollout->parameters != parameters)
+    {
+      return false;
+    }
+
+    done_cv_.wait(lock, [&rollout] { return rollout->done; });
+    costs = rollout->costs;
+    validity = rollout->validity;
+    success = rollout->success;
+    return true;
+  }
+
+  // @brief Worker thread loop that evaluates queued rollouts with its own cost function
+  void evaluateRollouts(const CostFn& cost_fn)
+  {
+    std::unique_lock<std::mutex> lock(rollouts_mutex_);
+    while (true)
+    {
+      rollouts_cv_.wait(lock, [this] { return stop_workers_ || !queued_rollouts_.empty(); });
+      if (stop_workers_)
+      {
+        return;
+      }
+      const auto rollout = queued_rollouts_.front();
+      queued_rollouts_.pop_front();
+      lock.unlock();
+
+      const bool success = cost_fn(rollout->parameters, rollout->costs, rollout->validity);
+
+      lock.lock();
+      rollout->success = success;
+      rollout->done = true;
+      done_cv_.notify_all();
+    }
+  }
+
   NoiseGeneratorFn noise_generator_fn_;
   CostFn cost_fn_;
   FilterFn filter_fn_;
   PostIterationFn post_iteration_fn_;
   DoneFn done_fn_;
+
+  std::vector<CostFn> rollout_cost_fns_;
+  std::vector<std::thread> workers_;
+  std::map<int, std::shared_ptr<Rollout>> rollouts_;
+  std::deque<std::shared_ptr<Rollout>> queued_rollouts_;
+  std::mutex rollouts_mutex_;
+  std::condition_variable rollouts_cv_;
+  std::condition_variable done_cv_;
+  bool stop_workers_ = false;
 };
 }  // namespace stomp_moveit
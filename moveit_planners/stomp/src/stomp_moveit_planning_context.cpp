@@ -36,8 +36,10 @@
  * @author Henning Kayser
  **/
 
+#include <algorithm>
 #include <atomic>
 #include <future>
+#include <thread>
 
 #include <stomp/stomp.h>
 
@@ -136,7 +138,8 @@ bool extractSeedTrajectory(const planning_interface::MotionPlanRequest& req,
 }
 
 // @brief Build a STOMP task that uses MoveIt callback types for planning in STOMP
-stomp::TaskPtr createStompTask(const stomp::StompConfiguration& config, StompPlanningContext& context)
+stomp::TaskPtr createStompTask(const stomp::StompConfiguration& config, StompPlanningContext& context,
+                               int num_threads_param)
 {
   const size_t num_timesteps = config.num_timesteps;
   const auto planning_scene = context.getPlanningScene();
@@ -151,21 +154,32 @@ stomp::TaskPtr createStompTask(const stomp::StompConfiguration& config, StompPla
   // Cost, noise and filter functions are provided for planning.
   // TODO(henningkayser): parameterize cost penalties
   using namespace stomp_moveit;
-  CostFn cost_fn;
-  if (!constraints.empty())
-  {
-    cost_fn = costs::sum({ costs::get_collision_cost_function(planning_scene, group, 1.0 /* collision penalty */),
-                           costs::get_constraints_cost_function(planning_scene, group, constraints.getAllConstraints(),
-                                                                1.0 /* constraint penalty */) });
-  }
-  else
+  const auto create_cost_fn = [&]() -> CostFn {
+    if (!constraints.empty())
+    {
+      return costs::sum({ costs::get_collision_cost_function(planning_scene, group, 1.0 /* collision penalty */),
+                          costs::get_constraints_cost_function(planning_scene, group, constraints.getAllConstraints(),
+                                                               1.0 /* constraint penalty */) });
+    }
+    return costs::get_collision_cost_function(planning_scene, group, 1.0 /* collision penalty */);
+  };
+  CostFn cost_fn = create_cost_fn();
+
+  // Cost functions keep their own robot state, so every rollout worker thread gets a separate instance.
+  // The STOMP thread evaluates rollouts as well, and there is no use in more threads than rollouts.
+  const size_t num_threads = std::min<size_t>(
+      num_threads_param > 0 ? num_threads_param : std::max(1u, std::thread::hardware_concurrency()),
+      config.num_rollouts);
+  std::vector<CostFn> rollout_cost_fns;
+  for (size_t i = 1; i < num_threads; ++i)
   {
-    cost_fn = costs::get_collision_cost_function(planning_scene, group, 1.0 /* collision penalty */);
+    rollout_cost_fns.push_back(create_cost_fn());
   }
 
   // TODO(henningkayser): parameterize stddev
   const std::vector<double> stddev(group->getActiveJointModels().size(), 0.1);
-  auto noise_generator_fn = noise::get_normal_distribution_generator(num_timesteps, stddev);
+  auto noise_generator_fn =
+      noise::get_batched_normal_distribution_generator(num_timesteps, stddev, config.num_rollouts);
   auto filter_fn =
       filters::chain({ filters::simple_smoothing_matrix(num_timesteps), filters::enforce_position_bounds(group) });
   auto iteration_callback_fn =
@@ -174,8 +188,8 @@ stomp::TaskPtr createStompTask(const stomp::StompConfiguration& config, StompPla
       visualization::get_success_trajectory_publisher(context.getPathPublisher(), planning_scene, group);
 
   // Initialize and return STOMP task
-  stomp::TaskPtr task =
-      std::make_shared<ComposableTask>(noise_generator_fn, cost_fn, filter_fn, iteration_callback_fn, done_callback_fn);
+  stomp::TaskPtr task = std::make_shared<ComposableTask>(noise_generator_fn, cost_fn, filter_fn, iteration_callback_fn,
+                                                         done_callback_fn, std::move(rollout_cost_fns));
   return task;
 }
 
@@ -233,7 +247,7 @@ bool StompPlanningContext::solve(planning_interface::MotionPlanResponse& res)
   {
     config.num_timesteps = input_trajectory->size();
   }
-  const auto task = createStompTask(config, *this);
+  const auto task = createStompTask(config, *this, params_.num_threads);
   stomp_ = std::make_shared<stomp::Stomp>(config, task);
 
   std::condition_variable cv;
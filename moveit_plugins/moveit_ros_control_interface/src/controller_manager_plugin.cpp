@@ -107,9 +107,14 @@ class Ros2ControlManager : public moveit_controller_manager::MoveItControllerMan
    */
   std::mutex controllers_mutex_;
 
+  /** @brief Response to the last list_controllers request made without waiting, not applied yet */
+  std::shared_ptr<controller_manager_msgs::srv::ListControllers::Response> received_controllers_;
+  std::mutex received_controllers_mutex_;
+
   rclcpp::Node::SharedPtr node_;
   rclcpp::Client<controller_manager_msgs::srv::ListControllers>::SharedPtr list_controllers_service_;
   rclcpp::Client<controller_manager_msgs::srv::SwitchController>::SharedPtr switch_controller_service_;
+  rclcpp::TimerBase::SharedPtr discovery_timer_;
 
   // Chained controllers have dependencies (other controllers which must be running)
   std::unordered_map<std::string /* controller name */, std::vector<std::string> /* dependencies */> dependency_map_;
@@ -125,22 +130,25 @@ class Ros2ControlManager : public moveit_controller_manager::MoveItControllerMan
   }
 
   /**
-   * \brief  Call list_controllers and populate managed_controllers_ and active_controllers_. Allocates handles if
+   * \brief  Update managed_controllers_ and active_controllers_ from the controller manager. Allocates handles if
    * needed.
-   * Throttled down to 1 Hz, controllers_mutex_ must be locked externally
-   * @param force force rediscover
+   * controllers_mutex_ must be locked externally.
+   * Unless forced, the call does not wait for the controller manager: the controller list is refreshed in the
+   * background (see requestControllerList()), and the call applies the last list received.
+   * @param force call list_controllers and wait for the response
    */
   void discover(bool force = false)
   {
-    // Skip if controller stamp is too new for new discovery, enforce update if force==true
-    if (!force && ((node_->now() - controllers_stamp_) < CONTROLLER_INFORMATION_VALIDITY_AGE))
+    std::shared_ptr<controller_manager_msgs::srv::ListControllers::Response> received;
     {
-      RCLCPP_WARN_STREAM(LOGGER, "Controller information from " << list_controllers_service_->get_service_name()
-                                                                << " is out of date, skipping discovery");
-      return;
+      std::scoped_lock<std::mutex> lock(received_controllers_mutex_);
+      received.swap(received_controllers_);
     }
+    if (received)
+      applyControllerList(received);
 
-    controllers_stamp_ = node_->now();
+    if (!force)
+      return;
 
     auto request = std::make_shared<controller_manager_msgs::srv::ListControllers::Request>();
     auto result_future = list_controllers_service_->async_send_request(request);
@@ -152,10 +160,48 @@ class Ros2ControlManager : public moveit_controller_manager::MoveItControllerMan
       return;
     }
 
+    auto result = result_future.get();
+    {
+      // a response to an earlier request is older than this one
+      std::scoped_lock<std::mutex> lock(received_controllers_mutex_);
+      received_controllers_.reset();
+    }
+    applyControllerList(result);
+  }
+
+  /**
+   * \brief Call list_controllers without waiting for the response. The response is applied right away if
+   * controllers_mutex_ is free, and otherwise stored for the next discover(), as callers of discover() may hold
+   * controllers_mutex_ while waiting for a response.
+   */
+  void requestControllerList()
+  {
+    auto request = std::make_shared<controller_manager_msgs::srv::ListControllers::Request>();
+    list_controllers_service_->async_send_request(
+        request, [this](rclcpp::Client<controller_manager_msgs::srv::ListControllers>::SharedFuture result_future) {
+          auto result = result_future.get();
+          std::unique_lock<std::mutex> lock(controllers_mutex_, std::try_to_lock);
+          std::scoped_lock<std::mutex> received_lock(received_controllers_mutex_);
+          if (lock.owns_lock())
+          {
+            received_controllers_.reset();
+            applyControllerList(result);
+          }
+          else
+            received_controllers_ = result;
+        });
+  }
+
+  /**
+   * \brief Populate managed_controllers_ and active_controllers_ from a list_controllers response, controllers_mutex_
+   * must be locked externally
+   */
+  void applyControllerList(std::shared_ptr<controller_manager_msgs::srv::ListControllers::Response>& result)
+  {
+    controllers_stamp_ = node_->now();
     managed_controllers_.clear();
     active_controllers_.clear();
 
-    auto result = result_future.get();
     if (!Ros2ControlManager::fixChainedControllers(result))
     {
       return;
@@ -277,6 +323,10 @@ public:
 
     std::scoped_lock<std::mutex> lock(controllers_mutex_);
     discover(true);
+
+    // keep the controller information up to date in the background, so queries do not wait for the controller manager
+    discovery_timer_ = node_->create_wall_timer(
+        CONTROLLER_INFORMATION_VALIDITY_AGE.to_chrono<std::chrono::nanoseconds>(), [this] { requestControllerList(); });
   }
   /**
    * \brief Find and return the pre-allocated handle for the given controller.
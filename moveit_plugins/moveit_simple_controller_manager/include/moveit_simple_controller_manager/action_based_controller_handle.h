@@ -41,6 +41,8 @@
 #include <rclcpp_action/rclcpp_action.hpp>
 #include <moveit/controller_manager/controller_manager.h>
 #include <moveit/macros/class_forward.h>
+#include <atomic>
+#include <future>
 #include <memory>
 
 namespace moveit_simple_controller_manager
@@ -87,6 +89,16 @@ public:
     // through the controller handle will fail if the server is not running when an action goal message is sent.
     controller_action_client_ = rclcpp_action::create_client<T>(node, getActionName());
     last_exec_ = moveit_controller_manager::ExecutionStatus::SUCCEEDED;
+
+    // Track the server's readiness in the background, so sending a trajectory does not have to query the ROS graph
+    server_ready_ = controller_action_client_->action_server_is_ready();
+    readiness_timer_ = node_->create_wall_timer(READINESS_CHECK_PERIOD, [this] {
+      const bool ready = controller_action_client_->action_server_is_ready();
+      if (ready != server_ready_.exchange(ready))
+      {
+        RCLCPP_INFO_STREAM(logger_, "Action server " << getActionName() << (ready ? " is ready" : " is gone"));
+      }
+    });
   }
 
   /**
@@ -127,9 +139,12 @@ public:
   bool waitForExecution(const rclcpp::Duration& timeout = rclcpp::Duration::from_seconds(-1.0)) override
   {
     auto result_callback_done = std::make_shared<std::promise<bool>>();
+    const auto goal = current_goal_;
     auto result_future = controller_action_client_->async_get_result(
-        current_goal_, [this, result_callback_done](const auto& wrapped_result) {
-          controllerDoneCallback(wrapped_result);
+        goal, [this, goal, result_callback_done](const auto& wrapped_result) {
+          // A goal replaced by updateTrajectory() is preempted, which does not end the execution
+          if (goal == current_goal_)
+            controllerDoneCallback(wrapped_result);
           result_callback_done->set_value(true);
         });
     if (timeout < std::chrono::nanoseconds(0))
@@ -190,11 +205,46 @@ protected:
 
   /**
    * @brief Check if the controller's action server is ready to receive action goals.
+   *
+   * The readiness is tracked in the background. Only a server which was not ready at the last check is looked up
+   * again, so a server that just started is not missed. A server that just went away is caught by the timeout of
+   * waitForGoalResponse().
    * @return True if the action server is ready, false if it is not ready or does not exist.
    */
   bool isConnected() const
   {
-    return controller_action_client_->action_server_is_ready();
+    return server_ready_ || controller_action_client_->action_server_is_ready();
+  }
+
+  /**
+   * @brief Send a goal to the action server without waiting for its response.
+   * @return The future of the goal handle, which is nullptr if the goal was rejected.
+   */
+  std::shared_future<typename rclcpp_action::ClientGoalHandle<T>::SharedPtr>
+  sendGoal(const typename T::Goal& goal, const typename rclcpp_action::Client<T>::SendGoalOptions& options)
+  {
+    return controller_action_client_->async_send_goal(goal, options);
+  }
+
+  /**
+   * @brief Wait for the server's response to a goal sent by sendGoal() and make the goal the current one.
+   * @return True if the goal was accepted, false if it was rejected or the server did not respond in time.
+   */
+  bool
+  waitForGoalResponse(const std::shared_future<typename rclcpp_action::ClientGoalHandle<T>::SharedPtr>& goal_future)
+  {
+    if (goal_future.wait_for(GOAL_RESPONSE_TIMEOUT) == std::future_status::timeout)
+    {
+      RCLCPP_ERROR_STREAM(logger_, "Action server " << getActionName() << " did not respond to the goal");
+      return false;
+    }
+    current_goal_ = goal_future.get();
+    if (!current_goal_)
+    {
+      RCLCPP_ERROR(logger_, "Goal was rejected by server");
+      return false;
+    }
+    return true;
   }
 
   /**
@@ -273,6 +323,20 @@ protected:
    * @brief Current goal that has been sent to the action server.
    */
   typename rclcpp_action::ClientGoalHandle<T>::SharedPtr current_goal_;
+
+private:
+  static constexpr std::chrono::milliseconds READINESS_CHECK_PERIOD{ 500 };
+  static constexpr std::chrono::seconds GOAL_RESPONSE_TIMEOUT{ 5 };
+
+  /**
+   * @brief Whether the action server was ready at the last background check.
+   */
+  std::atomic<bool> server_ready_;
+
+  /**
+   * @brief Timer checking the readiness of the action server.
+   */
+  rclcpp::TimerBase::SharedPtr readiness_timer_;
 };
 
 }  // namespace moveit_simple_controller_manager
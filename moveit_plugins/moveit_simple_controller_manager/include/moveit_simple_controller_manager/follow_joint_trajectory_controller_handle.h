@@ -61,6 +61,12 @@ public:
 
   bool sendTrajectory(const moveit_msgs::msg::RobotTrajectory& trajectory) override;
 
+  /** The joint_trajectory_controller replaces the active goal by a new one, so updates are sent as new goals */
+  bool updateTrajectory(const moveit_msgs::msg::RobotTrajectory& trajectory) override
+  {
+    return sendTrajectory(trajectory);
+  }
+
   // TODO(JafarAbdi): Revise parameter lookup
   // void configure(XmlRpc::XmlRpcValue& config) override;
 
@@ -153,11 +153,8 @@ public:
         [this](const rclcpp_action::Client<control_msgs::action::GripperCommand>::GoalHandle::SharedPtr&
                /* unused-arg */) { RCLCPP_DEBUG_STREAM(logger_, name_ << " started execution"); };
     // Send goal
-    auto current_goal_future = controller_action_client_->async_send_goal(goal, send_goal_options);
-    current_goal_ = current_goal_future.get();
-    if (!current_goal_)
+    if (!waitForGoalResponse(sendGoal(goal, send_goal_options)))
     {
-      RCLCPP_ERROR(logger_, "Goal was rejected by server");
       return false;
     }
 
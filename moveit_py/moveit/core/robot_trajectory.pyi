@@ -17,3 +17,11 @@ class RobotTrajectory:
     def duration(self) -> Any: ...
     @property
     def robot_model(self) -> Any: ...
+
+class TrajectoryArchiveReader:
+    def __init__(self, *args, **kwargs) -> None: ...
+    def get_joint_names(self, *args, **kwargs) -> Any: ...
+    def get_label(self, *args, **kwargs) -> Any: ...
+    def get_stamp(self, *args, **kwargs) -> Any: ...
+    def __getitem__(self, index) -> Any: ...
+    def __len__(self) -> Any: ...
@@ -37,6 +37,7 @@
 #include "planning_scene.h"
 #include <moveit_py/moveit_py_utils/ros_msg_typecasters.h>
 #include <pybind11/operators.h>
+#include <moveit/utils/worker_pool.h>
 
 namespace moveit_py
 {
@@ -71,6 +72,66 @@ moveit_msgs::msg::PlanningScene get_planning_scene_msg(std::shared_ptr<planning_
   return planning_scene_msg;
 }
 
+namespace
+{
+// Sets each row of positions as the group positions of a copy of the current state and calls
+// fn(index, state) with its collision transforms updated. Runs without the GIL, on num_threads threads
+// (0 picks the number of cores).
+template <typename Fn>
+void for_each_group_state(const planning_scene::PlanningScene& planning_scene,
+                          const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                          const std::string& joint_model_group_name, unsigned int num_threads, const Fn& fn)
+{
+  const moveit::core::JointModelGroup* group =
+      planning_scene.getRobotModel()->getJointModelGroup(joint_model_group_name);
+  if (!group)
+    throw std::invalid_argument("Unknown joint model group '" + joint_model_group_name + "'");
+  const std::size_t dof = group->getVariableCount();
+  if (positions.ndim() != 2 || static_cast<std::size_t>(positions.shape(1)) != dof)
+    throw std::invalid_argument("Expected an array of shape (N, " + std::to_string(dof) + ")");
+
+  const std::size_t count = positions.shape(0);
+  const double* data = positions.data();
+  py::gil_scoped_release release;
+  moveit::core::WorkerPool pool(num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<moveit::core::RobotState> states(pool.size(), planning_scene.getCurrentState());
+  pool.run(count, [&](std::size_t index, unsigned int thread) {
+    moveit::core::RobotState& state = states[thread];
+    state.setJointGroupPositions(group, data + index * dof);
+    state.updateCollisionBodyTransforms();
+    fn(index, state);
+  });
+}
+}  // namespace
+
+py::array_t<bool>
+is_state_colliding_batch(const std::shared_ptr<planning_scene::PlanningScene>& planning_scene,
+                         const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                         const std::string& joint_model_group_name, unsigned int num_threads)
+{
+  py::array_t<bool> colliding(positions.ndim() > 0 ? positions.shape(0) : 0);
+  bool* out = colliding.mutable_data();
+  for_each_group_state(*planning_scene, positions, joint_model_group_name, num_threads,
+                       [&](std::size_t index, const moveit::core::RobotState& state) {
+                         out[index] = planning_scene->isStateColliding(state, joint_model_group_name);
+                       });
+  return colliding;
+}
+
+py::array_t<double>
+distance_to_collision_batch(const std::shared_ptr<planning_scene::PlanningScene>& planning_scene,
+                            const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                            const std::string& joint_model_group_name, unsigned int num_threads)
+{
+  py::array_t<double> distances(positions.ndim() > 0 ? positions.shape(0) : 0);
+  double* out = distances.mutable_data();
+  for_each_group_state(*planning_scene, positions, joint_model_group_name, num_threads,
+                       [&](std::size_t index, const moveit::core::RobotState& state) {
+                         out[index] = planning_scene->distanceToCollision(state);
+                       });
+  return distances;
+}
+
 void init_planning_scene(py::module& m)
 {
   py::module planning_scene = m.def_submodule("planning_scene");
@@ -220,10 +281,11 @@ void init_planning_scene(py::module& m)
       .def("is_state_valid",
            py::overload_cast<const moveit::core::RobotState&, const std::string&, bool>(
                &planning_scene::PlanningScene::isStateValid, py::const_),
-           py::arg("robot_state"), py::arg("joint_model_group_name"), py::arg("verbose") = false)
+           py::arg("robot_state"), py::arg("joint_model_group_name"), py::arg("verbose") = false,
+           py::call_guard<py::gil_scoped_release>())
       .def("is_state_colliding",
            py::overload_cast<const std::string&, bool>(&planning_scene::PlanningScene::isStateColliding),
-           py::arg("joint_model_group_name"), py::arg("verbose") = false,
+           py::arg("joint_model_group_name"), py::arg("verbose") = false, py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -238,6 +300,7 @@ void init_planning_scene(py::module& m)
            py::overload_cast<const moveit::core::RobotState&, const std::string&, bool>(
                &planning_scene::PlanningScene::isStateColliding, py::const_),
            py::arg("robot_state"), py::arg("joint_model_group_name"), py::arg("verbose") = false,
+           py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -249,10 +312,39 @@ void init_planning_scene(py::module& m)
                bool: True if the robot state is in collision, false otherwise.
            )")
 
+      .def("is_state_colliding_batch", &moveit_py::bind_planning_scene::is_state_colliding_batch,
+           py::arg("positions"), py::arg("joint_model_group_name"), py::kw_only(), py::arg("num_threads") = 1,
+           R"(
+           Check many joint group configurations for collision in one call.
+
+           Each row is applied to a copy of the current state of the scene, so variables outside the group keep their current values.
+
+	   Args:
+               positions (:py:class:`numpy.ndarray`): An array of shape (N, number of group variables).
+               joint_model_group_name (str): The name of the group the positions are for and to check collision for.
+               num_threads (int): The number of threads to check on, 0 for one per core (default: 1).
+           Returns:
+               :py:class:`numpy.ndarray`: N booleans, true where the configuration is in collision.
+           )")
+
+      .def("distance_to_collision_batch", &moveit_py::bind_planning_scene::distance_to_collision_batch,
+           py::arg("positions"), py::arg("joint_model_group_name"), py::kw_only(), py::arg("num_threads") = 1,
+           R"(
+           Compute the distance to collision for many joint group configurations in one call.
+
+	   Args:
+               positions (:py:class:`numpy.ndarray`): An array of shape (N, number of group variables).
+               joint_model_group_name (str): The name of the group the positions are for.
+               num_threads (int): The number of threads to compute on, 0 for one per core (default: 1).
+           Returns:
+               :py:class:`numpy.ndarray`: N distances between the robot and the world, ignoring self collisions.
+           )")
+
       .def("is_state_constrained",
            py::overload_cast<const moveit::core::RobotState&, const moveit_msgs::msg::Constraints&, bool>(
                &planning_scene::PlanningScene::isStateConstrained, py::const_),
            py::arg("state"), py::arg("constraints"), py::arg("verbose") = false,
+           py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state fulfills the passed constraints
 
@@ -268,7 +360,7 @@ void init_planning_scene(py::module& m)
            py::overload_cast<const robot_trajectory::RobotTrajectory&, const std::string&, bool,
                              std::vector<std::size_t>*>(&planning_scene::PlanningScene::isPathValid, py::const_),
            py::arg("trajectory"), py::arg("joint_model_group_name"), py::arg("verbose") = false,
-           py::arg("invalid_index") = nullptr,
+           py::arg("invalid_index") = nullptr, py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if a given path is valid. Each state is checked for validity (collision avoidance and feasibility)
 
@@ -287,7 +379,7 @@ void init_planning_scene(py::module& m)
       .def("check_collision",
            py::overload_cast<const collision_detection::CollisionRequest&, collision_detection::CollisionResult&>(
                &planning_scene::PlanningScene::checkCollision),
-           py::arg("collision_request"), py::arg("collision_result"),
+           py::arg("collision_request"), py::arg("collision_result"), py::call_guard<py::gil_scoped_release>(),
            R"(
            Check whether the current state is in collision, and if needed, updates the collision transforms of the current state before the computation.
 
@@ -303,6 +395,7 @@ void init_planning_scene(py::module& m)
            py::overload_cast<const collision_detection::CollisionRequest&, collision_detection::CollisionResult&,
                              moveit::core::RobotState&>(&planning_scene::PlanningScene::checkCollision, py::const_),
            py::arg("collision_request"), py::arg("collision_result"), py::arg("state"),
+           py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -320,6 +413,7 @@ void init_planning_scene(py::module& m)
                              moveit::core::RobotState&, const collision_detection::AllowedCollisionMatrix&>(
                &planning_scene::PlanningScene::checkCollision, py::const_),
            py::arg("collision_request"), py::arg("collision_result"), py::arg("state"), py::arg("acm"),
+           py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -336,7 +430,7 @@ void init_planning_scene(py::module& m)
       .def("check_collision_unpadded",
            py::overload_cast<const collision_detection::CollisionRequest&, collision_detection::CollisionResult&>(
                &planning_scene::PlanningScene::checkCollisionUnpadded),
-           py::arg("req"), py::arg("result"),
+           py::arg("req"), py::arg("result"), py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -353,6 +447,7 @@ void init_planning_scene(py::module& m)
                              moveit::core::RobotState&>(&planning_scene::PlanningScene::checkCollisionUnpadded,
                                                         py::const_),
            py::arg("collision_request"), py::arg("collision_result"), py::arg("state"),
+           py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -370,6 +465,7 @@ void init_planning_scene(py::module& m)
                              moveit::core::RobotState&, const collision_detection::AllowedCollisionMatrix&>(
                &planning_scene::PlanningScene::checkCollisionUnpadded, py::const_),
            py::arg("collision_request"), py::arg("collision_result"), py::arg("state"), py::arg("acm"),
+           py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -386,7 +482,7 @@ void init_planning_scene(py::module& m)
       .def("check_self_collision",
            py::overload_cast<const collision_detection::CollisionRequest&, collision_detection::CollisionResult&>(
                &planning_scene::PlanningScene::checkSelfCollision),
-           py::arg("collision_request"), py::arg("collision_result"),
+           py::arg("collision_request"), py::arg("collision_result"), py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -402,6 +498,7 @@ void init_planning_scene(py::module& m)
            py::overload_cast<const collision_detection::CollisionRequest&, collision_detection::CollisionResult&,
                              moveit::core::RobotState&>(&planning_scene::PlanningScene::checkSelfCollision, py::const_),
            py::arg("collision_request"), py::arg("collision_result"), py::arg("state"),
+           py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
@@ -419,6 +516,7 @@ void init_planning_scene(py::module& m)
                              moveit::core::RobotState&, const collision_detection::AllowedCollisionMatrix&>(
                &planning_scene::PlanningScene::checkSelfCollision, py::const_),
            py::arg("collision_request"), py::arg("collision_result"), py::arg("state"), py::arg("acm"),
+           py::call_guard<py::gil_scoped_release>(),
            R"(
            Check if the robot state is in collision.
 
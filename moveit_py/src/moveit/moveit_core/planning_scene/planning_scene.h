@@ -38,6 +38,7 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 #include <moveit_py/moveit_py_utils/copy_ros_msg.h>
 #include <moveit_py/moveit_py_utils/ros_msg_typecasters.h>
@@ -58,6 +59,16 @@ Eigen::MatrixXd get_frame_transform(std::shared_ptr<planning_scene::PlanningScen
 
 moveit_msgs::msg::PlanningScene get_planning_scene_msg(std::shared_ptr<planning_scene::PlanningScene>& planning_scene);
 
+py::array_t<bool>
+is_state_colliding_batch(const std::shared_ptr<planning_scene::PlanningScene>& planning_scene,
+                         const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                         const std::string& joint_model_group_name, unsigned int num_threads);
+
+py::array_t<double>
+distance_to_collision_batch(const std::shared_ptr<planning_scene::PlanningScene>& planning_scene,
+                            const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                            const std::string& joint_model_group_name, unsigned int num_threads);
+
 void init_planning_scene(py::module& m);
 }  // namespace bind_planning_scene
 }  // namespace moveit_py
@@ -39,6 +39,7 @@
 #include <moveit_py/moveit_py_utils/ros_msg_typecasters.h>
 #include <moveit_msgs/msg/robot_state.hpp>
 #include <moveit/robot_state/conversions.h>
+#include <moveit/utils/worker_pool.h>
 
 namespace moveit_py
 {
@@ -182,6 +183,58 @@ Eigen::VectorXd copy_joint_group_accelerations(const moveit::core::RobotState* s
   return values;
 }
 
+py::array_t<double> get_positions_view(const py::object& self)
+{
+  const auto* state = self.cast<const moveit::core::RobotState*>();
+  // the array borrows the state's storage and keeps the Python object alive through its base
+  py::array_t<double> view(state->getVariableCount(), state->getVariablePositions(), self);
+  // writing through the view would bypass the dirty flags, so positions are only set via set_positions_from_array
+  py::detail::array_proxy(view.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+  return view;
+}
+
+void set_positions_from_array(moveit::core::RobotState* self,
+                              const py::array_t<double, py::array::c_style | py::array::forcecast>& positions)
+{
+  if (positions.ndim() != 1 || static_cast<std::size_t>(positions.shape(0)) != self->getVariableCount())
+    throw std::invalid_argument("Expected a 1-D array with " + std::to_string(self->getVariableCount()) + " positions");
+  self->setVariablePositions(positions.data());
+}
+
+py::array_t<double>
+get_global_link_transforms_batch(const moveit::core::RobotState* self,
+                                 const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                                 const std::string& joint_model_group_name, const std::string& link_name,
+                                 unsigned int num_threads)
+{
+  const moveit::core::JointModelGroup* group = self->getJointModelGroup(joint_model_group_name);
+  const moveit::core::LinkModel* link = self->getLinkModel(link_name);
+  if (!group || !link)
+    throw std::invalid_argument("Unknown joint model group or link");
+  const std::size_t dof = group->getVariableCount();
+  if (positions.ndim() != 2 || static_cast<std::size_t>(positions.shape(1)) != dof)
+    throw std::invalid_argument("Expected an array of shape (N, " + std::to_string(dof) + ")");
+
+  const std::size_t count = positions.shape(0);
+  py::array_t<double> transforms({ count, std::size_t(4), std::size_t(4) });
+  const double* data = positions.data();
+  double* out = transforms.mutable_data();
+  {
+    py::gil_scoped_release release;
+    moveit::core::WorkerPool pool(num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<moveit::core::RobotState> states(pool.size(), *self);
+    pool.run(count, [&](std::size_t index, unsigned int thread) {
+      moveit::core::RobotState& state = states[thread];
+      state.setJointGroupPositions(group, data + index * dof);
+      state.updateLinkTransforms();
+      // row-major 4x4 blocks, matching the layout of get_global_link_transform
+      Eigen::Map<Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(out + index * 16) =
+          state.getGlobalLinkTransform(link).matrix();
+    });
+  }
+  return transforms;
+}
+
 Eigen::MatrixXd get_jacobian(const moveit::core::RobotState* self, const std::string& joint_model_group_name,
                              const Eigen::Vector3d& reference_point_position)
 {
@@ -332,6 +385,14 @@ void init_robot_state(py::module& m)
       .def_property("joint_positions", &moveit_py::bind_robot_state::get_joint_positions,
                     &moveit_py::bind_robot_state::set_joint_positions, py::return_value_policy::copy)
 
+      .def_property("positions_view", &moveit_py::bind_robot_state::get_positions_view,
+                    &moveit_py::bind_robot_state::set_positions_from_array,
+                    R"(
+                    :py:class:`numpy.ndarray`: A read-only view of all variable positions, in the order of the robot model variables.
+
+                    The view shares memory with the robot state, so it reflects later changes to the state without copying. Assigning an array of the same length sets all variable positions at once.
+                    )")
+
       .def_property("joint_velocities", &moveit_py::bind_robot_state::get_joint_velocities,
                     &moveit_py::bind_robot_state::set_joint_velocities, py::return_value_policy::copy)
 
@@ -437,6 +498,24 @@ void init_robot_state(py::module& m)
            :py:class:`numpy.ndarray`: The transform of the specified link in the global frame.
        )")
 
+      .def("get_global_link_transforms_batch", &moveit_py::bind_robot_state::get_global_link_transforms_batch,
+           py::arg("positions"), py::arg("joint_model_group_name"), py::arg("link_name"), py::kw_only(),
+           py::arg("num_threads") = 1,
+           R"(
+       Computes the transform of a link in the global frame for many joint group configurations in one call.
+
+       Each row is applied to a copy of this robot state, so variables outside the group keep their values.
+
+       Args:
+           positions (:py:class:`numpy.ndarray`): An array of shape (N, number of group variables).
+           joint_model_group_name (str): The name of the joint model group the positions are for.
+           link_name (str): The name of the link to get the transforms for.
+           num_threads (int): The number of threads to compute on, 0 for one per core (default: 1).
+
+       Returns:
+           :py:class:`numpy.ndarray`: An array of shape (N, 4, 4) with the transform for each configuration.
+       )")
+
       // Setting state from inverse kinematics
       .def(
           "set_from_ik",
@@ -444,6 +523,7 @@ void init_robot_state(py::module& m)
              const std::string& tip,
              double timeout) { return self->setFromIK(self->getJointModelGroup(group), pose, tip, timeout); },
           py::arg("joint_model_group_name"), py::arg("geometry_pose"), py::arg("tip_name"), py::arg("timeout") = 0.0,
+          py::call_guard<py::gil_scoped_release>(),
           R"(
            Sets the state of the robot to the one that results from solving the inverse kinematics for the specified group.
 
@@ -39,6 +39,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <moveit_py/moveit_py_utils/copy_ros_msg.h>
 #include <tf2_eigen/tf2_eigen.hpp>
 #include <moveit/robot_state/robot_state.h>
@@ -64,6 +65,16 @@ Eigen::VectorXd copy_joint_group_velocities(const moveit::core::RobotState* self
 Eigen::VectorXd copy_joint_group_accelerations(const moveit::core::RobotState* self,
                                                const std::string& joint_model_group_name);
 
+py::array_t<double> get_positions_view(const py::object& self);
+void set_positions_from_array(moveit::core::RobotState* self,
+                              const py::array_t<double, py::array::c_style | py::array::forcecast>& positions);
+
+py::array_t<double>
+get_global_link_transforms_batch(const moveit::core::RobotState* self,
+                                 const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                                 const std::string& joint_model_group_name, const std::string& link_name,
+                                 unsigned int num_threads);
+
 Eigen::MatrixXd get_jacobian(const moveit::core::RobotState* self, const std::string& joint_model_group_name,
                              const std::string& link_model_name, const Eigen::Vector3d& reference_point_position,
                              bool use_quaternion_representation);
@@ -37,6 +37,7 @@
 #include "robot_trajectory.h"
 #include <moveit_py/moveit_py_utils/ros_msg_typecasters.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
+#include <algorithm>
 
 namespace moveit_py
 {
@@ -58,6 +59,92 @@ set_robot_trajectory_msg(const std::shared_ptr<robot_trajectory::RobotTrajectory
   return robot_trajectory->setRobotTrajectoryMsg(robot_state, msg);
 }
 
+namespace
+{
+// an empty name selects the trajectory's group, or all variables if the trajectory has none
+const moveit::core::JointModelGroup* resolve_group(const robot_trajectory::RobotTrajectory& robot_trajectory,
+                                                   const std::string& joint_model_group_name)
+{
+  if (joint_model_group_name.empty())
+    return robot_trajectory.getGroup();
+  const moveit::core::JointModelGroup* group =
+      robot_trajectory.getRobotModel()->getJointModelGroup(joint_model_group_name);
+  if (!group)
+    throw std::invalid_argument("Unknown joint model group '" + joint_model_group_name + "'");
+  return group;
+}
+}  // namespace
+
+py::array_t<double> as_array(const robot_trajectory::RobotTrajectory& robot_trajectory,
+                             const std::string& joint_model_group_name)
+{
+  const moveit::core::JointModelGroup* group = resolve_group(robot_trajectory, joint_model_group_name);
+  const std::size_t count = robot_trajectory.getWayPointCount();
+  const std::size_t dof = group ? group->getVariableCount() : robot_trajectory.getRobotModel()->getVariableCount();
+
+  // waypoints are separate states, so the rows are copied, but in a single pass without the GIL
+  py::array_t<double> positions({ count, dof });
+  double* data = positions.mutable_data();
+  {
+    py::gil_scoped_release release;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const moveit::core::RobotState& waypoint = robot_trajectory.getWayPoint(i);
+      if (group)
+        waypoint.copyJointGroupPositions(group, data + i * dof);
+      else
+        std::copy_n(waypoint.getVariablePositions(), dof, data + i * dof);
+    }
+  }
+  return positions;
+}
+
+void set_positions_from_array(robot_trajectory::RobotTrajectory& robot_trajectory,
+                              const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                              const std::string& joint_model_group_name)
+{
+  const moveit::core::JointModelGroup* group = resolve_group(robot_trajectory, joint_model_group_name);
+  const std::size_t count = robot_trajectory.getWayPointCount();
+  const std::size_t dof = group ? group->getVariableCount() : robot_trajectory.getRobotModel()->getVariableCount();
+  if (positions.ndim() != 2 || static_cast<std::size_t>(positions.shape(0)) != count ||
+      static_cast<std::size_t>(positions.shape(1)) != dof)
+    throw std::invalid_argument("Expected an array of shape (" + std::to_string(count) + ", " + std::to_string(dof) +
+                                ")");
+
+  const double* data = positions.data();
+  py::gil_scoped_release release;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    moveit::core::RobotState& waypoint = *robot_trajectory.getWayPointPtr(i);
+    if (group)
+      waypoint.setJointGroupPositions(group, data + i * dof);
+    else
+      waypoint.setVariablePositions(data + i * dof);
+  }
+}
+
+std::shared_ptr<robot_trajectory::TrajectoryArchiveReader> open_trajectory_archive(const std::string& filename)
+{
+  auto reader = std::make_shared<robot_trajectory::TrajectoryArchiveReader>(filename);
+  if (!reader->isValid())
+    throw std::invalid_argument("'" + filename + "' is not a trajectory archive");
+  return reader;
+}
+
+trajectory_msgs::msg::JointTrajectory read_trajectory_archive(const robot_trajectory::TrajectoryArchiveReader& reader,
+                                                              std::size_t index)
+{
+  trajectory_msgs::msg::JointTrajectory trajectory;
+  bool ok;
+  {
+    py::gil_scoped_release release;
+    ok = reader.read(index, trajectory);
+  }
+  if (!ok)
+    throw std::runtime_error("Trajectory " + std::to_string(index) + " of the archive is corrupt");
+  return trajectory;
+}
+
 void init_robot_trajectory(py::module& m)
 {
   py::module robot_trajectory = m.def_submodule("robot_trajectory");
@@ -138,6 +225,7 @@ void init_robot_trajectory(py::module& m)
       .def("apply_totg_time_parameterization", &trajectory_processing::applyTOTGTimeParameterization,
            py::arg("velocity_scaling_factor"), py::arg("acceleration_scaling_factor"), py::kw_only(),
            py::arg("path_tolerance") = 0.1, py::arg("resample_dt") = 0.1, py::arg("min_angle_change") = 0.001,
+           py::call_guard<py::gil_scoped_release>(),
            R"(
                Adds time parameterization to the trajectory using the Time-Optimal Trajectory Generation (TOTG) algorithm.
            Args:
@@ -152,7 +240,7 @@ void init_robot_trajectory(py::module& m)
            )")
       .def("apply_ruckig_smoothing", &trajectory_processing::applyRuckigSmoothing, py::arg("velocity_scaling_factor"),
            py::arg("acceleration_scaling_factor"), py::kw_only(), py::arg("mitigate_overshoot") = false,
-           py::arg("overshoot_threshold") = 0.01,
+           py::arg("overshoot_threshold") = 0.01, py::call_guard<py::gil_scoped_release>(),
            R"(
                Applies Ruckig smoothing to the trajectory.
            Args:
@@ -164,6 +252,25 @@ void init_robot_trajectory(py::module& m)
            Returns:
                bool: True if the trajectory was successfully retimed, false otherwise.
            )")
+      .def("as_array", &moveit_py::bind_robot_trajectory::as_array, py::arg("joint_model_group_name") = "",
+           R"(
+           Get the waypoint positions of the trajectory as a single array.
+
+           Args:
+               joint_model_group_name (str): The joint model group to get the positions for. Defaults to the group of the trajectory, or all variables if the trajectory has no group.
+
+           Returns:
+               :py:class:`numpy.ndarray`: An array of shape (number of waypoints, number of group variables).
+           )")
+      .def("set_positions_from_array", &moveit_py::bind_robot_trajectory::set_positions_from_array,
+           py::arg("positions"), py::arg("joint_model_group_name") = "",
+           R"(
+           Set the waypoint positions of the trajectory from a single array.
+
+           Args:
+               positions (:py:class:`numpy.ndarray`): An array of shape (number of waypoints, number of group variables).
+               joint_model_group_name (str): The joint model group to set the positions for. Defaults to the group of the trajectory, or all variables if the trajectory has no group.
+           )")
       .def("get_robot_trajectory_msg", &moveit_py::bind_robot_trajectory::get_robot_trajectory_msg,
            py::arg("joint_filter") = std::vector<std::string>(),
            R"(
@@ -178,6 +285,46 @@ void init_robot_trajectory(py::module& m)
            Set the trajectory from a moveit_msgs.msg.RobotTrajectory message.
            )");
   // TODO (peterdavidfagan): support other methods such as appending trajectories
+
+  py::class_<robot_trajectory::TrajectoryArchiveReader, std::shared_ptr<robot_trajectory::TrajectoryArchiveReader>>(
+      robot_trajectory, "TrajectoryArchiveReader",
+      R"(
+      Random access to the trajectories of an archive written by the trajectory execution manager.
+      )")
+      .def(py::init(&moveit_py::bind_robot_trajectory::open_trajectory_archive), py::arg("filename"),
+           R"(
+           Opens and indexes a trajectory archive.
+
+           Args:
+               filename (str): The path of the archive.
+           )")
+      .def("__len__", &robot_trajectory::TrajectoryArchiveReader::size,
+           R"(
+           Returns:
+               int: The number of trajectories in the archive.
+           )")
+      .def("__getitem__", &moveit_py::bind_robot_trajectory::read_trajectory_archive, py::arg("index"),
+           R"(
+           Decode the trajectory at the specified index.
+
+           Returns:
+               trajectory_msgs.msg.JointTrajectory: The trajectory, without header.
+           )")
+      .def("get_stamp", &robot_trajectory::TrajectoryArchiveReader::getStamp, py::arg("index"),
+           R"(
+           Returns:
+               int: The time the trajectory at the specified index was archived, in nanoseconds.
+           )")
+      .def("get_label", &robot_trajectory::TrajectoryArchiveReader::getLabel, py::arg("index"),
+           R"(
+           Returns:
+               str: The label of the trajectory at the specified index, e.g. the controller name and execution status.
+           )")
+      .def("get_joint_names", &robot_trajectory::TrajectoryArchiveReader::getJointNames, py::arg("index"),
+           R"(
+           Returns:
+               list of str: The joint names of the trajectory at the specified index.
+           )");
 }
 }  // namespace bind_robot_trajectory
 }  // namespace moveit_py
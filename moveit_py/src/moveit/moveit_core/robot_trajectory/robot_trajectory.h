@@ -39,7 +39,9 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/robot_trajectory/trajectory_archive.h>
 #include <moveit_msgs/msg/robot_trajectory.hpp>
 #include <rclcpp/rclcpp.hpp>
 
@@ -56,6 +58,16 @@ robot_trajectory::RobotTrajectory
 set_robot_trajectory_msg(const std::shared_ptr<robot_trajectory::RobotTrajectory>& robot_trajectory,
                          const moveit::core::RobotState& robot_state, const moveit_msgs::msg::RobotTrajectory& msg);
 
+py::array_t<double> as_array(const robot_trajectory::RobotTrajectory& robot_trajectory,
+                             const std::string& joint_model_group_name);
+void set_positions_from_array(robot_trajectory::RobotTrajectory& robot_trajectory,
+                              const py::array_t<double, py::array::c_style | py::array::forcecast>& positions,
+                              const std::string& joint_model_group_name);
+
+std::shared_ptr<robot_trajectory::TrajectoryArchiveReader> open_trajectory_archive(const std::string& filename);
+trajectory_msgs::msg::JointTrajectory read_trajectory_archive(const robot_trajectory::TrajectoryArchiveReader& reader,
+                                                              std::size_t index);
+
 void init_robot_trajectory(py::module& m);
 }  // namespace bind_robot_trajectory
 }  // namespace moveit_py
@@ -123,6 +123,7 @@ void init_planning_scene_monitor(py::module& m)
 	   )")
 
       .def("wait_for_current_robot_state", &planning_scene_monitor::PlanningSceneMonitor::waitForCurrentRobotState,
+           py::call_guard<py::gil_scoped_release>(),
            R"(
 	   Waits for the current robot state to be received.
 	   )")
@@ -132,12 +133,12 @@ void init_planning_scene_monitor(py::module& m)
            Clears the octomap.
            )")
 
-      .def("read_only", &moveit_py::bind_planning_scene_monitor::read_only,
+      .def("read_only", &moveit_py::bind_planning_scene_monitor::read_only, py::call_guard<py::gil_scoped_release>(),
            R"(
            Returns a read-only context manager for the planning scene.
            )")
 
-      .def("read_write", &moveit_py::bind_planning_scene_monitor::read_write,
+      .def("read_write", &moveit_py::bind_planning_scene_monitor::read_write, py::call_guard<py::gil_scoped_release>(),
            R"(
            Returns a read-write context manager for the planning scene.
            )");
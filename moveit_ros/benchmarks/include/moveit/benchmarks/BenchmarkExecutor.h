@@ -46,6 +46,7 @@
 #include <moveit/warehouse/constraints_storage.h>
 #include <moveit/warehouse/trajectory_constraints_storage.h>
 #include <moveit/moveit_cpp/moveit_cpp.h>
+#include <moveit/moveit_cpp/planning_component.h>
 #include <warehouse_ros/database_loader.h>
 #include <pluginlib/class_loader.hpp>
 
@@ -54,6 +55,11 @@
 #include <string>
 #include <functional>
 
+namespace boost
+{
+class progress_display;
+}
+
 namespace moveit_ros_benchmarks
 {
 /// A class that executes motion plan requests and aggregates data across multiple runs
@@ -188,6 +194,11 @@ protected:
   /// Load all motion plan requests matching the given regular expression from the warehouse
   bool loadQueries(const std::string& regex, const std::string& scene_name, std::vector<BenchmarkRequest>& queries);
 
+  /// Create a query from the first to the last waypoint of each trajectory in the given archive whose label matches
+  /// the given regular expression
+  bool loadArchivedQueries(const std::string& filename, const std::string& regex,
+                           std::vector<BenchmarkRequest>& queries);
+
   /// Duplicate the given benchmark request for all combinations of start states and path constraints
   void createRequestCombinations(const BenchmarkRequest& benchmark_request, const std::vector<StartState>& start_states,
                                  const std::vector<PathConstraints>& path_constraints,
@@ -196,6 +207,19 @@ protected:
   /// Execute the given motion plan request on the set of planners for the set number of runs
   void runBenchmark(moveit_msgs::msg::MotionPlanRequest request, const BenchmarkOptions& options);
 
+  /// Plans one run with the given planning component and scene, fills the response and any run data measured while
+  /// planning, and returns whether it succeeded
+  typedef std::function<bool(moveit_cpp::PlanningComponent& planning_component,
+                             const planning_scene::PlanningScenePtr& planning_scene,
+                             planning_interface::MotionPlanDetailedResponse& response, PlannerRunData& run_data)>
+      RunFunction;
+
+  /// Execute options.runs runs of one planner, options.parallel_runs at a time, and collect their metrics
+  void executeRuns(moveit_msgs::msg::MotionPlanRequest& request, const BenchmarkOptions& options,
+                   const RunFunction& run, PlannerBenchmarkData& planner_data,
+                   std::vector<planning_interface::MotionPlanDetailedResponse>& responses, std::vector<bool>& solved,
+                   boost::progress_display& progress);
+
   std::shared_ptr<planning_scene_monitor::PlanningSceneMonitor> planning_scene_monitor_;
   std::shared_ptr<moveit_warehouse::PlanningSceneStorage> planning_scene_storage_;
   std::shared_ptr<moveit_warehouse::PlanningSceneWorldStorage> planning_scene_world_storage_;
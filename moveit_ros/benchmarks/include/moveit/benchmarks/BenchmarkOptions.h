@@ -57,6 +57,8 @@ namespace moveit_ros_benchmarks
 ///     parameters:
 ///         name: # Experiment name
 ///         runs: # Number of experiment runs
+///         parallel_runs: # Number of runs executed at the same time, each in its own planning scene copy (default: 1)
+///         hardware_counters: # Record CPU cycles, instructions and cache misses per run, Linux only (default: false)
 ///         group: # Joint group name
 ///         timeout: # Experiment timeout
 ///         output_directory: # Output directory for results file
@@ -65,6 +67,8 @@ namespace moveit_ros_benchmarks
 ///         goal_constraints_regex: # Goal constrains
 ///         path_constraints_regex
 ///         trajectory_constraints_regex
+///         trajectory_archive: # Trajectory archive to create queries from, from the first to the last waypoint
+///         trajectory_archive_regex: # Labels of the archived trajectories to use (default: .*)
 ///         predefined_poses_group: # Group where the predefined poses are specified
 ///         predefined_poses: # List of named targets
 ///     planning_pipelines:
@@ -103,6 +107,8 @@ struct BenchmarkOptions
 
   /// Benchmark parameters
   int runs;                                   // Number of experiment runs
+  int parallel_runs;                          // Number of runs executed at the same time
+  bool hardware_counters;                     // Record hardware performance counters of each run
   double timeout;                             // Experiment timeout
   std::string benchmark_name;                 // Experiment name
   std::string group_name;                     // Joint group name
@@ -112,6 +118,8 @@ struct BenchmarkOptions
   std::string goal_constraint_regex;          // Regex for goal_constraints in database
   std::string path_constraint_regex;          // Regex for path_constraints in database
   std::string trajectory_constraint_regex;    // Regex for trajectory_constraint in database
+  std::string trajectory_archive;             // Trajectory archive to create queries from
+  std::string trajectory_archive_regex;       // Regex for the labels of archived trajectories
   std::vector<std::string> predefined_poses;  // List of named targets
   std::string predefined_poses_group;         // Group where the predefined poses are specified
   std::vector<double> goal_offsets =
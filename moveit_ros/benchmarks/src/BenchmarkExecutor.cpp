@@ -39,6 +39,8 @@
 #include <moveit/utils/lexical_casts.h>
 #include <moveit/utils/moveit_error_code.h>
 #include <moveit/robot_state/conversions.h>
+#include <moveit/robot_trajectory/trajectory_archive.h>
+#include <moveit/utils/worker_pool.h>
 #include <moveit/version.h>
 #include <tf2_eigen/tf2_eigen.hpp>
 
@@ -51,13 +53,22 @@
 #undef BOOST_ALLOW_DEPRECATED_HEADERS
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <math.h>
+#include <cctype>
+#include <ctime>
 #include <limits>
 #include <filesystem>
+#include <mutex>
+#include <optional>
 #ifndef _WIN32
 #include <unistd.h>
 #else
 #include <winsock2.h>
 #endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 #undef max
 
@@ -65,6 +76,106 @@ using namespace moveit_ros_benchmarks;
 
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros.benchmarks.BenchmarkExecutor");
 
+// CPU time spent by the calling thread, which stays comparable when runs share the machine
+static double threadCpuTime()
+{
+#ifndef _WIN32
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#else
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+namespace
+{
+// Stores the phase times of a planning response as 'phase_<name>_time' properties, with names reduced to the
+// characters the log format and moveit_benchmark_statistics.py accept
+void addPhaseTimes(BenchmarkExecutor::PlannerRunData& run_data, const std::map<std::string, double>& phase_times)
+{
+  for (const std::pair<const std::string, double>& phase_time : phase_times)
+  {
+    std::string name;
+    for (char c : phase_time.first)
+      name += std::isalnum(static_cast<unsigned char>(c)) ? std::tolower(static_cast<unsigned char>(c)) : '_';
+    run_data["phase_" + name + "_time REAL"] = moveit::core::toString(phase_time.second);
+  }
+}
+
+// Counts hardware events of the calling thread with perf_event_open. Events the kernel does not allow
+// (see /proc/sys/kernel/perf_event_paranoid) or does not support are left out.
+class HardwareCounters
+{
+public:
+  HardwareCounters()
+  {
+#ifdef __linux__
+    const std::pair<const char*, std::uint64_t> events[] = { { "cpu_cycles", PERF_COUNT_HW_CPU_CYCLES },
+                                                             { "instructions", PERF_COUNT_HW_INSTRUCTIONS },
+                                                             { "cache_misses", PERF_COUNT_HW_CACHE_MISSES } };
+    for (const std::pair<const char*, std::uint64_t>& event : events)
+    {
+      perf_event_attr attr{};
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = event.second;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1, -1, 0));
+      if (fd >= 0)
+        counters_.emplace_back(event.first, fd);
+    }
+#endif
+    static std::once_flag warned;
+    if (counters_.empty())
+      std::call_once(warned, [] { RCLCPP_WARN(LOGGER, "Hardware counters are not available on this system"); });
+  }
+
+  ~HardwareCounters()
+  {
+#ifdef __linux__
+    for (const std::pair<std::string, int>& counter : counters_)
+      close(counter.second);
+#endif
+  }
+
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  void start()
+  {
+#ifdef __linux__
+    for (const std::pair<std::string, int>& counter : counters_)
+    {
+      ioctl(counter.second, PERF_EVENT_IOC_RESET, 0);
+      ioctl(counter.second, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  /// Stop counting and store the counts as '<event> INTEGER' properties
+  void stop(BenchmarkExecutor::PlannerRunData& run_data)
+  {
+#ifdef __linux__
+    for (const std::pair<std::string, int>& counter : counters_)
+    {
+      ioctl(counter.second, PERF_EVENT_IOC_DISABLE, 0);
+      std::uint64_t value;
+      if (read(counter.second, &value, sizeof(value)) == sizeof(value))
+        run_data[counter.first + " INTEGER"] = std::to_string(value);
+    }
+#else
+    (void)run_data;
+#endif
+  }
+
+private:
+  std::vector<std::pair<std::string, int>> counters_;
+};
+}  // namespace
+
 template <class Clock, class Duration>
 boost::posix_time::ptime toBoost(const std::chrono::time_point<Clock, Duration>& from)
 {
@@ -442,6 +553,11 @@ bool BenchmarkExecutor::loadBenchmarkQueryData(
   {
     RCLCPP_ERROR(LOGGER, "Failed to get a query regex");
   }
+  if (!options.trajectory_archive.empty() &&
+      !loadArchivedQueries(options.trajectory_archive, options.trajectory_archive_regex, queries))
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to load the archived trajectories");
+  }
   return true;
 }
 
@@ -629,10 +745,11 @@ bool BenchmarkExecutor::loadQueries(const std::string& regex, const std::string&
     return true;
   }
 
+  std::vector<moveit_warehouse::MotionPlanRequestWithMetadata> planning_queries;
   std::vector<std::string> query_names;
   try
   {
-    planning_scene_storage_->getPlanningQueriesNames(regex, query_names, scene_name);
+    planning_scene_storage_->getPlanningQueries(regex, planning_queries, query_names, scene_name);
   }
   catch (std::exception& ex)
   {
@@ -646,25 +763,53 @@ bool BenchmarkExecutor::loadQueries(const std::string& regex, const std::string&
     return false;
   }
 
-  for (const std::string& query_name : query_names)
+  for (std::size_t i = 0; i < planning_queries.size(); ++i)
   {
-    moveit_warehouse::MotionPlanRequestWithMetadata planning_query;
-    try
-    {
-      planning_scene_storage_->getPlanningQuery(planning_query, scene_name, query_name);
-    }
-    catch (std::exception& ex)
-    {
-      RCLCPP_ERROR(LOGGER, "Error loading motion planning query '%s': %s", query_name.c_str(), ex.what());
+    BenchmarkRequest query;
+    query.name = query_names[i];
+    query.request = static_cast<moveit_msgs::msg::MotionPlanRequest>(*planning_queries[i]);
+    queries.push_back(query);
+  }
+  RCLCPP_INFO(LOGGER, "Loaded queries successfully");
+  return true;
+}
+
+bool BenchmarkExecutor::loadArchivedQueries(const std::string& filename, const std::string& regex,
+                                            std::vector<BenchmarkRequest>& queries)
+{
+  const robot_trajectory::TrajectoryArchiveReader archive(filename);
+  if (!archive.isValid())
+    return false;
+
+  const boost::regex label_regex(regex);
+  std::size_t loaded = 0;
+  trajectory_msgs::msg::JointTrajectory trajectory;
+  for (std::size_t i = 0; i < archive.size(); ++i)
+  {
+    // only the index is decoded for trajectories that are skipped
+    if (archive.getWayPointCount(i) == 0 || !boost::regex_match(archive.getLabel(i), label_regex) ||
+        !archive.read(i, trajectory))
       continue;
-    }
 
     BenchmarkRequest query;
-    query.name = query_name;
-    query.request = static_cast<moveit_msgs::msg::MotionPlanRequest>(*planning_query);
+    query.name = archive.getLabel(i) + " #" + std::to_string(i);
+    query.request.start_state.joint_state.name = trajectory.joint_names;
+    query.request.start_state.joint_state.position = trajectory.points.front().positions;
+    moveit_msgs::msg::Constraints goal;
+    for (std::size_t j = 0; j < trajectory.joint_names.size(); ++j)
+    {
+      moveit_msgs::msg::JointConstraint joint_constraint;
+      joint_constraint.joint_name = trajectory.joint_names[j];
+      joint_constraint.position = trajectory.points.back().positions[j];
+      joint_constraint.tolerance_above = joint_constraint.tolerance_below = std::numeric_limits<double>::epsilon();
+      joint_constraint.weight = 1.0;
+      goal.joint_constraints.push_back(joint_constraint);
+    }
+    query.request.goal_constraints.push_back(goal);
     queries.push_back(query);
+    ++loaded;
   }
-  RCLCPP_INFO(LOGGER, "Loaded queries successfully");
+  RCLCPP_INFO(LOGGER, "Created %zu queries from %zu archived trajectories", loaded, archive.size());
   return true;
 }
 
@@ -672,37 +817,23 @@ bool BenchmarkExecutor::loadStates(const std::string& regex, std::vector<StartSt
 {
   if (!regex.empty())
   {
-    std::regex start_regex(regex);
+    std::vector<moveit_warehouse::RobotStateWithMetadata> robot_states;
     std::vector<std::string> state_names;
-    robot_state_storage_->getKnownRobotStates(state_names);
-
-    if (state_names.empty())
+    try
+    {
+      robot_state_storage_->getRobotStates(regex, robot_states, state_names);
+    }
+    catch (std::exception& ex)
     {
-      RCLCPP_WARN(LOGGER, "Database does not contain any named states");
+      RCLCPP_ERROR(LOGGER, "Runtime error when loading states: %s", ex.what());
     }
 
-    for (const std::string& state_name : state_names)
+    for (std::size_t i = 0; i < robot_states.size(); ++i)
     {
-      std::smatch match;
-      if (std::regex_match(state_name, match, start_regex))
-      {
-        moveit_warehouse::RobotStateWithMetadata robot_state;
-        try
-        {
-          if (robot_state_storage_->getRobotState(robot_state, state_name))
-          {
-            StartState start_state;
-            start_state.state = moveit_msgs::msg::RobotState(*robot_state);
-            start_state.name = state_name;
-            start_states.push_back(start_state);
-          }
-        }
-        catch (std::exception& ex)
-        {
-          RCLCPP_ERROR(LOGGER, "Runtime error when loading state '%s': %s", state_name.c_str(), ex.what());
-          continue;
-        }
-      }
+      StartState start_state;
+      start_state.state = moveit_msgs::msg::RobotState(*robot_states[i]);
+      start_state.name = state_names[i];
+      start_states.push_back(start_state);
     }
 
     if (start_states.empty())
@@ -718,27 +849,23 @@ bool BenchmarkExecutor::loadPathConstraints(const std::string& regex, std::vecto
 {
   if (!regex.empty())
   {
+    std::vector<moveit_warehouse::ConstraintsWithMetadata> constrs;
     std::vector<std::string> cnames;
-    constraints_storage_->getKnownConstraints(regex, cnames);
+    try
+    {
+      constraints_storage_->getConstraints(regex, constrs, cnames);
+    }
+    catch (std::exception& ex)
+    {
+      RCLCPP_ERROR(LOGGER, "Runtime error when loading path constraints: %s", ex.what());
+    }
 
-    for (const std::string& cname : cnames)
+    for (std::size_t i = 0; i < constrs.size(); ++i)
     {
-      moveit_warehouse::ConstraintsWithMetadata constr;
-      try
-      {
-        if (constraints_storage_->getConstraints(constr, cname))
-        {
-          PathConstraints constraint;
-          constraint.constraints.push_back(*constr);
-          constraint.name = cname;
-          constraints.push_back(constraint);
-        }
-      }
-      catch (std::exception& ex)
-      {
-        RCLCPP_ERROR(LOGGER, "Runtime error when loading path constraint '%s': %s", cname.c_str(), ex.what());
-        continue;
-      }
+      PathConstraints constraint;
+      constraint.constraints.push_back(*constrs[i]);
+      constraint.name = cnames[i];
+      constraints.push_back(constraint);
     }
 
     if (constraints.empty())
@@ -836,57 +963,22 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::msg::MotionPlanRequest request
         .max_acceleration_scaling_factor = request.max_acceleration_scaling_factor
       };
 
-      // Iterate runs
-      for (int j = 0; j < options.runs; ++j)
-      {
-        // Pre-run events
-        for (PreRunEventFunction& pre_event_function : pre_event_functions_)
-          pre_event_function(request);
-
-        // Create planning component
-        auto planning_component = std::make_shared<moveit_cpp::PlanningComponent>(request.group_name, moveit_cpp_);
-        moveit::core::RobotState start_state(planning_scene_monitor_->getRobotModel());
-        moveit::core::robotStateMsgToRobotState(request.start_state, start_state);
-
-        planning_component->setStartState(start_state);
-        planning_component->setGoal(request.goal_constraints);
-        planning_component->setPathConstraints(request.path_constraints);
-        planning_component->setTrajectoryConstraints(request.trajectory_constraints);
-
-        // Solve problem
-        std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
-
-        // Planning pipeline benchmark
-        const auto response = planning_component->plan(plan_req_params, planning_scene_);
-
-        solved[j] = bool(response.error_code);
-
-        responses[j].error_code = response.error_code;
-        if (response.trajectory)
-        {
-          responses[j].description.push_back("plan");
-          responses[j].trajectory.push_back(response.trajectory);
-          responses[j].processing_time.push_back(response.planning_time);
-        }
-
-        std::chrono::duration<double> dt = std::chrono::system_clock::now() - start;
-        double total_time = dt.count();
-
-        // Collect data
-        start = std::chrono::system_clock::now();
-
-        // Post-run events
-        for (PostRunEventFunction& post_event_fn : post_event_functions_)
-        {
-          post_event_fn(request, responses[j], planner_data[j]);
-        }
-        collectMetrics(planner_data[j], responses[j], solved[j], total_time);
-        dt = std::chrono::system_clock::now() - start;
-        double metriconstraints_storage_time = dt.count();
-        RCLCPP_DEBUG(LOGGER, "Spent %lf seconds collecting metrics", metriconstraints_storage_time);
-
-        ++progress;
-      }
+      executeRuns(
+          request, options,
+          [&](moveit_cpp::PlanningComponent& planning_component, const planning_scene::PlanningScenePtr& scene,
+              planning_interface::MotionPlanDetailedResponse& detailed_response, PlannerRunData& run_data) {
+            const auto response = planning_component.plan(plan_req_params, scene);
+            addPhaseTimes(run_data, response.phase_times);
+            detailed_response.error_code = response.error_code;
+            if (response.trajectory)
+            {
+              detailed_response.description.push_back("plan");
+              detailed_response.trajectory.push_back(response.trajectory);
+              detailed_response.processing_time.push_back(response.planning_time);
+            }
+            return bool(response.error_code);
+          },
+          planner_data, responses, solved, progress);
 
       computeAveragePathSimilarities(planner_data, responses, solved);
 
@@ -933,62 +1025,28 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::msg::MotionPlanRequest request
         multi_pipeline_plan_request.plan_request_parameter_vector.push_back(plan_req_params);
       }
 
-      // Iterate runs
-      for (int j = 0; j < options.runs; ++j)
-      {
-        // Pre-run events
-        for (PreRunEventFunction& pre_event_function : pre_event_functions_)
-        {
-          pre_event_function(request);
-        }
-
-        // Create planning component
-        auto planning_component = std::make_shared<moveit_cpp::PlanningComponent>(request.group_name, moveit_cpp_);
-        moveit::core::RobotState start_state(planning_scene_monitor_->getRobotModel());
-        moveit::core::robotStateMsgToRobotState(request.start_state, start_state);
-
-        planning_component->setStartState(start_state);
-        planning_component->setGoal(request.goal_constraints);
-        planning_component->setPathConstraints(request.path_constraints);
-        planning_component->setTrajectoryConstraints(request.trajectory_constraints);
-
-        // Solve problem
-        std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
-
-        const auto t1 = std::chrono::system_clock::now();
-        const auto response = planning_component->plan(multi_pipeline_plan_request,
-                                                       &moveit::planning_pipeline_interfaces::getShortestSolution,
-                                                       nullptr, planning_scene_);
-        const auto t2 = std::chrono::system_clock::now();
-
-        solved[j] = bool(response.error_code);
-
-        responses[j].error_code = response.error_code;
-        if (response.trajectory)
-        {
-          responses[j].description.push_back("plan");
-          responses[j].trajectory.push_back(response.trajectory);
-          responses[j].processing_time.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count());
-        }
-
-        std::chrono::duration<double> dt = std::chrono::system_clock::now() - start;
-        double total_time = dt.count();
-
-        // Collect data
-        start = std::chrono::system_clock::now();
-        // Post-run events
-        for (PostRunEventFunction& post_event_fn : post_event_functions_)
-        {
-          post_event_fn(request, responses[j], planner_data[j]);
-        }
-
-        collectMetrics(planner_data[j], responses[j], solved[j], total_time);
-        dt = std::chrono::system_clock::now() - start;
-        double metriconstraints_storage_time = dt.count();
-        RCLCPP_DEBUG(LOGGER, "Spent %lf seconds collecting metrics", metriconstraints_storage_time);
-
-        ++progress;
-      }
+      executeRuns(
+          request, options,
+          [&](moveit_cpp::PlanningComponent& planning_component, const planning_scene::PlanningScenePtr& scene,
+              planning_interface::MotionPlanDetailedResponse& detailed_response, PlannerRunData& run_data) {
+            const auto t1 = std::chrono::system_clock::now();
+            const auto response =
+                planning_component.plan(multi_pipeline_plan_request,
+                                        &moveit::planning_pipeline_interfaces::getShortestSolution, nullptr, scene);
+            const auto t2 = std::chrono::system_clock::now();
+            addPhaseTimes(run_data, response.phase_times);
+
+            detailed_response.error_code = response.error_code;
+            if (response.trajectory)
+            {
+              detailed_response.description.push_back("plan");
+              detailed_response.trajectory.push_back(response.trajectory);
+              detailed_response.processing_time.push_back(
+                  std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count());
+            }
+            return bool(response.error_code);
+          },
+          planner_data, responses, solved, progress);
 
       computeAveragePathSimilarities(planner_data, responses, solved);
 
@@ -1003,6 +1061,81 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::msg::MotionPlanRequest request
   }
 }
 
+void BenchmarkExecutor::executeRuns(moveit_msgs::msg::MotionPlanRequest& request, const BenchmarkOptions& options,
+                                    const RunFunction& run, PlannerBenchmarkData& planner_data,
+                                    std::vector<planning_interface::MotionPlanDetailedResponse>& responses,
+                                    std::vector<bool>& solved, boost::progress_display& progress)
+{
+  // Planning sets the start state of the scene it is given, so parallel workers each plan in their own copy of the
+  // scene. A single worker keeps using planning_scene_ and runs on this thread, exactly like the sequential benchmark.
+  moveit::core::WorkerPool pool(std::max(1, std::min(options.parallel_runs, options.runs)));
+  std::vector<planning_scene::PlanningScenePtr> scenes(pool.size(), planning_scene_);
+  if (pool.size() > 1)
+  {
+    for (planning_scene::PlanningScenePtr& scene : scenes)
+      scene = planning_scene::PlanningScene::clone(planning_scene_);
+  }
+
+  // events and the progress display are not thread-safe, so they run one at a time
+  std::mutex event_lock;
+  pool.run(options.runs, [&](std::size_t j, unsigned int thread) {
+    moveit_msgs::msg::MotionPlanRequest run_request;
+    {
+      std::lock_guard<std::mutex> lock(event_lock);
+      // Pre-run events
+      for (PreRunEventFunction& pre_event_function : pre_event_functions_)
+        pre_event_function(request);
+      run_request = request;
+    }
+
+    // Create planning component
+    auto planning_component = std::make_shared<moveit_cpp::PlanningComponent>(run_request.group_name, moveit_cpp_);
+    moveit::core::RobotState start_state(planning_scene_monitor_->getRobotModel());
+    moveit::core::robotStateMsgToRobotState(run_request.start_state, start_state);
+
+    planning_component->setStartState(start_state);
+    planning_component->setGoal(run_request.goal_constraints);
+    planning_component->setPathConstraints(run_request.path_constraints);
+    planning_component->setTrajectoryConstraints(run_request.trajectory_constraints);
+
+    // Solve problem
+    std::optional<HardwareCounters> hardware_counters;
+    if (options.hardware_counters)
+      hardware_counters.emplace();
+    std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
+    const double cpu_start = threadCpuTime();
+    if (hardware_counters)
+      hardware_counters->start();
+    const bool run_solved = run(*planning_component, scenes[thread], responses[j], planner_data[j]);
+    if (hardware_counters)
+      hardware_counters->stop(planner_data[j]);
+    const double cpu_time = threadCpuTime() - cpu_start;
+    std::chrono::duration<double> dt = std::chrono::system_clock::now() - start;
+    double total_time = dt.count();
+
+    // Collect data
+    start = std::chrono::system_clock::now();
+    {
+      std::lock_guard<std::mutex> lock(event_lock);
+      // Post-run events
+      for (PostRunEventFunction& post_event_fn : post_event_functions_)
+      {
+        post_event_fn(run_request, responses[j], planner_data[j]);
+      }
+    }
+    collectMetrics(planner_data[j], responses[j], run_solved, total_time);
+    planner_data[j]["time_cpu REAL"] = moveit::core::toString(cpu_time);
+    dt = std::chrono::system_clock::now() - start;
+    double metriconstraints_storage_time = dt.count();
+    RCLCPP_DEBUG(LOGGER, "Spent %lf seconds collecting metrics", metriconstraints_storage_time);
+
+    // std::vector<bool> packs its elements, so writing it needs the lock as well
+    std::lock_guard<std::mutex> lock(event_lock);
+    solved[j] = run_solved;
+    ++progress;
+  });
+}
+
 void BenchmarkExecutor::collectMetrics(PlannerRunData& metrics,
                                        const planning_interface::MotionPlanDetailedResponse& motion_plan_response,
                                        bool solved, double total_time)
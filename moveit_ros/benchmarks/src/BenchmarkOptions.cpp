@@ -67,6 +67,8 @@ bool BenchmarkOptions::readBenchmarkOptions(const rclcpp::Node::SharedPtr& node)
     // Read benchmark parameters
     node->get_parameter_or(std::string("benchmark_config.parameters.name"), benchmark_name, std::string(""));
     node->get_parameter_or(std::string("benchmark_config.parameters.runs"), runs, 10);
+    node->get_parameter_or(std::string("benchmark_config.parameters.parallel_runs"), parallel_runs, 1);
+    node->get_parameter_or(std::string("benchmark_config.parameters.hardware_counters"), hardware_counters, false);
     node->get_parameter_or(std::string("benchmark_config.parameters.timeout"), timeout, 10.0);
     node->get_parameter_or(std::string("benchmark_config.parameters.output_directory"), output_directory,
                            std::string(""));
@@ -79,6 +81,10 @@ bool BenchmarkOptions::readBenchmarkOptions(const rclcpp::Node::SharedPtr& node)
                            std::string(""));
     node->get_parameter_or(std::string("benchmark_config.parameters.trajectory_constraints_regex"),
                            trajectory_constraint_regex, std::string(""));
+    node->get_parameter_or(std::string("benchmark_config.parameters.trajectory_archive"), trajectory_archive,
+                           std::string(""));
+    node->get_parameter_or(std::string("benchmark_config.parameters.trajectory_archive_regex"),
+                           trajectory_archive_regex, std::string(".*"));
     node->get_parameter_or(std::string("benchmark_config.parameters.predefined_poses"), predefined_poses, {});
     node->get_parameter_or(std::string("benchmark_config.parameters.predefined_poses_group"), predefined_poses_group,
                            std::string(""));
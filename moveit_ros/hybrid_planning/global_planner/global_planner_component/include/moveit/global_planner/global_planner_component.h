@@ -49,6 +49,9 @@
 #include <moveit_msgs/msg/motion_plan_request.hpp>
 #include <moveit_msgs/msg/motion_plan_response.hpp>
 
+#include <atomic>
+#include <thread>
+
 namespace moveit::hybrid_planning
 {
 // Component node containing the global planner
@@ -100,9 +103,15 @@ private:
   // Initialize planning scene monitor and load pipelines
   bool initializeGlobalPlanner();
 
+  // Stop the running global planning request, it is aborted with the PREEMPTED error code
+  void preemptRunningRequest();
+
   // This thread is used for long-running callbacks. It's a member so they do not go out of scope.
   std::thread long_callback_thread_;
 
+  // Set when the running request is replaced by a newer goal
+  std::atomic<bool> preempted_{ false };
+
   // A unique callback group, to avoid mixing callbacks with other action servers
   rclcpp::CallbackGroup::SharedPtr cb_group_;
 };
@@ -75,6 +75,16 @@ public:
   virtual moveit_msgs::msg::MotionPlanResponse plan(
       const std::shared_ptr<rclcpp_action::ServerGoalHandle<moveit_msgs::action::GlobalPlanner>> global_goal_handle) = 0;
 
+  /**
+   * Stop a plan() call that is running on another thread, e.g. because a newer goal preempts it. plan() should return
+   * as soon as possible afterwards. The default implementation does nothing, so plan() runs to completion.
+   * @return True if the running plan() call was asked to stop
+   */
+  virtual bool terminate() noexcept
+  {
+    return false;
+  }
+
   /**
    * Reset global planner plugin. This should never fail.
    * @return True if reset was successful
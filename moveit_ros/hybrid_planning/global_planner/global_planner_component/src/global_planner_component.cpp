@@ -78,14 +78,17 @@ bool GlobalPlannerComponent::initializeGlobalPlanner()
       [this](const rclcpp_action::GoalUUID& /*unused*/,
              const std::shared_ptr<const moveit_msgs::action::GlobalPlanner::Goal>& /*unused*/) {
         RCLCPP_INFO(LOGGER, "Received global planning goal request");
-        // If another goal is active, cancel it and reject this goal
+        // If another goal is active, preempt it. Reject this goal if it cannot be stopped in time.
         if (long_callback_thread_.joinable())
         {
+          preemptRunningRequest();
           // Try to terminate the execution thread
           auto future = std::async(std::launch::async, &std::thread::join, &long_callback_thread_);
           if (future.wait_for(JOIN_THREAD_TIMEOUT) == std::future_status::timeout)
           {
             RCLCPP_WARN(LOGGER, "Another goal was running. Rejecting the new hybrid planning goal.");
+            // The running request is not replaced, so its result is still reported
+            preempted_ = false;
             return rclcpp_action::GoalResponse::REJECT;
           }
           if (!global_planner_instance_->reset())
@@ -100,6 +103,7 @@ bool GlobalPlannerComponent::initializeGlobalPlanner()
         RCLCPP_INFO(LOGGER, "Received request to cancel global planning goal");
         if (long_callback_thread_.joinable())
         {
+          global_planner_instance_->terminate();
           long_callback_thread_.join();
         }
         if (!global_planner_instance_->reset())
@@ -113,9 +117,11 @@ bool GlobalPlannerComponent::initializeGlobalPlanner()
         // this needs to return quickly to avoid blocking the executor, so spin up a new thread
         if (long_callback_thread_.joinable())
         {
+          preemptRunningRequest();
           long_callback_thread_.join();
           global_planner_instance_->reset();
         }
+        preempted_ = false;
         long_callback_thread_ = std::thread(&GlobalPlannerComponent::globalPlanningRequestCallback, this, goal_handle);
       },
       rcl_action_server_get_default_options(), cb_group_);
@@ -155,6 +161,16 @@ bool GlobalPlannerComponent::initializeGlobalPlanner()
   return true;
 }
 
+void GlobalPlannerComponent::preemptRunningRequest()
+{
+  preempted_ = true;
+  if (!global_planner_instance_->terminate())
+  {
+    RCLCPP_WARN(LOGGER, "Global planner '%s' cannot be stopped, waiting for the running request to finish",
+                planner_plugin_name_.c_str());
+  }
+}
+
 void GlobalPlannerComponent::globalPlanningRequestCallback(
     const std::shared_ptr<rclcpp_action::ServerGoalHandle<moveit_msgs::action::GlobalPlanner>>& goal_handle)
 {
@@ -165,7 +181,14 @@ void GlobalPlannerComponent::globalPlanningRequestCallback(
   auto result = std::make_shared<moveit_msgs::action::GlobalPlanner::Result>();
   result->response = planning_solution;
 
-  if (planning_solution.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS)
+  if (preempted_)
+  {
+    // A solution for the replaced goal is outdated, so it is not handed to the local planner
+    RCLCPP_INFO(LOGGER, "Global planning request was preempted by a newer goal");
+    result->response.error_code.val = moveit_msgs::msg::MoveItErrorCodes::PREEMPTED;
+    goal_handle->abort(result);
+  }
+  else if (planning_solution.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS)
   {
     // Publish global planning solution to the local planner
     global_trajectory_pub_->publish(planning_solution);
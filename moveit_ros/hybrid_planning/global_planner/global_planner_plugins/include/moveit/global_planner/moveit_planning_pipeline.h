@@ -53,6 +53,7 @@ public:
   ~MoveItPlanningPipeline() override = default;
   bool initialize(const rclcpp::Node::SharedPtr& node) override;
   bool reset() noexcept override;
+  bool terminate() noexcept override;
   moveit_msgs::msg::MotionPlanResponse
   plan(const std::shared_ptr<rclcpp_action::ServerGoalHandle<moveit_msgs::action::GlobalPlanner>> global_goal_handle)
       override;
@@ -94,6 +94,20 @@ bool MoveItPlanningPipeline::reset() noexcept
   return true;
 }
 
+bool MoveItPlanningPipeline::terminate() noexcept
+{
+  if (!moveit_cpp_)
+  {
+    return false;
+  }
+  // The pipeline of the running request is not known here, so stop all of them
+  for (const auto& [name, pipeline] : moveit_cpp_->getPlanningPipelines())
+  {
+    pipeline->terminate();
+  }
+  return true;
+}
+
 moveit_msgs::msg::MotionPlanResponse MoveItPlanningPipeline::plan(
     const std::shared_ptr<rclcpp_action::ServerGoalHandle<moveit_msgs::action::GlobalPlanner>> global_goal_handle)
 {
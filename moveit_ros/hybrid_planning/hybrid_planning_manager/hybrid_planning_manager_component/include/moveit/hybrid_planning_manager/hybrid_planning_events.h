@@ -50,6 +50,8 @@ enum class HybridPlanningEvent
   GLOBAL_PLANNING_ACTION_SUCCESSFUL,
   GLOBAL_PLANNING_ACTION_ABORTED,
   GLOBAL_PLANNING_ACTION_CANCELED,
+  // The global planning action was stopped because a newer global planning goal replaced it
+  GLOBAL_PLANNING_ACTION_PREEMPTED,
   // Indicates that the global planner found a solution (This solution is not necessarily the last or best solution)
   GLOBAL_SOLUTION_AVAILABLE,
   // Result of the local planning action
@@ -65,6 +65,9 @@ struct ReactionResult
       case HybridPlanningEvent::GLOBAL_PLANNING_ACTION_CANCELED:
         event = "Global planning action canceled";
         break;
+      case HybridPlanningEvent::GLOBAL_PLANNING_ACTION_PREEMPTED:
+        event = "Global planning action preempted";
+        break;
       case HybridPlanningEvent::GLOBAL_SOLUTION_AVAILABLE:
         event = "Global solution available";
         break;
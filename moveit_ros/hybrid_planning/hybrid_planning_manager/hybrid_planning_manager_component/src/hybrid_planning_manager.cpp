@@ -259,7 +259,16 @@ bool HybridPlanningManager::sendGlobalPlannerAction()
             reaction_result = planner_logic_instance_->react(HybridPlanningEvent::GLOBAL_PLANNING_ACTION_CANCELED);
             break;
           case rclcpp_action::ResultCode::ABORTED:
-            reaction_result = planner_logic_instance_->react(HybridPlanningEvent::GLOBAL_PLANNING_ACTION_ABORTED);
+            // A goal that was replaced by a newer global planning goal is aborted with the PREEMPTED error code
+            if (global_result.result &&
+                global_result.result->response.error_code.val == moveit_msgs::msg::MoveItErrorCodes::PREEMPTED)
+            {
+              reaction_result = planner_logic_instance_->react(HybridPlanningEvent::GLOBAL_PLANNING_ACTION_PREEMPTED);
+            }
+            else
+            {
+              reaction_result = planner_logic_instance_->react(HybridPlanningEvent::GLOBAL_PLANNING_ACTION_ABORTED);
+            }
             break;
           default:
             break;
@@ -44,8 +44,11 @@ namespace moveit::hybrid_planning
 {
 ReactionResult ReplanInvalidatedTrajectory::react(const std::string& event)
 {
+  // Degraded progress starts the replanning early while the local planner keeps following the current trajectory. A
+  // replan started by a later event preempts the one that is in progress.
   if ((event == toString(LocalFeedbackEnum::COLLISION_AHEAD)) ||
-      (event == toString(LocalFeedbackEnum::LOCAL_PLANNER_STUCK)))
+      (event == toString(LocalFeedbackEnum::LOCAL_PLANNER_STUCK)) ||
+      (event == toString(LocalFeedbackEnum::PROGRESS_DEGRADED)))
   {
     if (!hybrid_planning_manager_->sendGlobalPlannerAction())  // Start global planning
     {
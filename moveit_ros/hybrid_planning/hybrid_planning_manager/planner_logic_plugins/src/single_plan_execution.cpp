@@ -74,6 +74,9 @@ ReactionResult SinglePlanExecution::react(const HybridPlanningEvent& event)
         local_planner_started_ = true;
       }
       return ReactionResult(event, "", moveit_msgs::msg::MoveItErrorCodes::SUCCESS);
+    case HybridPlanningEvent::GLOBAL_PLANNING_ACTION_PREEMPTED:
+      // Do nothing since the global planning action that replaced the preempted one is still running
+      return ReactionResult(event, "Do nothing", moveit_msgs::msg::MoveItErrorCodes::SUCCESS);
     case HybridPlanningEvent::GLOBAL_PLANNING_ACTION_ABORTED:
       // Abort hybrid planning if no global solution is found
       return ReactionResult(event, "Global planner failed to find a solution",
@@ -35,11 +35,17 @@
 /* Author: Sebastian Jahr
    Description: Simple local solver plugin that forwards the next waypoint of the sampled local trajectory.
    The local solver stops for two conditions: invalid waypoint (likely due to collision) or if it has been stuck for
-   several iterations.
+   several iterations. Before it is considered stuck, it reports degraded progress so that replanning can start early.
+   All waypoints of the local trajectory are checked, so a trajectory operator providing upcoming waypoints lets the
+   solver stop before a blocked path is reached. Waypoints that were valid in the last iteration are only checked again
+   if the planning scene world changed.
  */
 
 #pragma once
 
+#include <deque>
+#include <vector>
+
 #include <rclcpp/rclcpp.hpp>
 #include <moveit/local_planner/local_constraint_solver_interface.h>
 
@@ -61,6 +67,10 @@ public:
         trajectory_msgs::msg::JointTrajectory& local_solution) override;
 
 private:
+  // Check the local trajectory waypoints that were not valid in the last iteration. Returns false if one is invalid.
+  bool updateValidWaypoints(const planning_scene::PlanningScene& planning_scene,
+                            const robot_trajectory::RobotTrajectory& local_trajectory);
+
   rclcpp::Node::SharedPtr node_;
   planning_scene_monitor::PlanningSceneMonitorPtr planning_scene_monitor_;
   bool path_invalidation_event_send_;  // Send path invalidation event only once
@@ -68,6 +78,13 @@ private:
 
   // Detect when the local planner gets stuck
   size_t num_iterations_stuck_;
+  bool progress_degraded_event_send_;  // Send degraded progress event only once until the planner moves again
   moveit::core::RobotStatePtr prev_waypoint_target_;
+
+  // Variable positions of the leading local trajectory waypoints that were valid in the last iteration, and the
+  // versions of the planning scene world they were checked against
+  std::deque<std::vector<double>> valid_waypoints_;
+  std::size_t valid_collision_objects_version_ = 0;
+  std::size_t valid_octomap_version_ = 0;
 };
 }  // namespace moveit::hybrid_planning
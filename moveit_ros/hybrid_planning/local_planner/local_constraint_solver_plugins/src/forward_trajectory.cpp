@@ -37,12 +37,21 @@
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/robot_state/conversions.h>
 
+#include <algorithm>
+
 namespace
 {
 const rclcpp::Logger LOGGER = rclcpp::get_logger("local_planner_component");
 // If stuck for this many iterations or more, abort the local planning action
 constexpr size_t STUCK_ITERATIONS_THRESHOLD = 5;
+// If stuck for this many iterations, report degraded progress so that a new global plan can be computed early
+constexpr size_t DEGRADED_ITERATIONS_THRESHOLD = 2;
 constexpr double STUCK_THRESHOLD_RAD = 1e-4;  // L1-norm sum across all joints
+
+bool haveEqualPositions(const std::vector<double>& positions, const moveit::core::RobotState& state)
+{
+  return std::equal(positions.cbegin(), positions.cend(), state.getVariablePositions());
+}
 }  // namespace
 
 namespace moveit::hybrid_planning
@@ -63,6 +72,7 @@ bool ForwardTrajectory::initialize(const rclcpp::Node::SharedPtr& node,
   node_ = node;
   path_invalidation_event_send_ = false;
   num_iterations_stuck_ = 0;
+  progress_degraded_event_send_ = false;
 
   planning_scene_monitor_ = planning_scene_monitor;
 
@@ -74,6 +84,8 @@ bool ForwardTrajectory::reset()
   num_iterations_stuck_ = 0;
   prev_waypoint_target_.reset();
   path_invalidation_event_send_ = false;
+  progress_degraded_event_send_ = false;
+  valid_waypoints_.clear();
   return true;
 };
 
@@ -111,7 +123,7 @@ ForwardTrajectory::solve(const robot_trajectory::RobotTrajectory& local_trajecto
       planning_scene_monitor_->updateSceneWithCurrentState();
       planning_scene_monitor::LockedPlanningSceneRO locked_planning_scene(planning_scene_monitor_);
       current_state = std::make_shared<moveit::core::RobotState>(locked_planning_scene->getCurrentState());
-      is_path_valid = locked_planning_scene->isPathValid(local_trajectory, local_trajectory.getGroupName(), false);
+      is_path_valid = updateValidWaypoints(*locked_planning_scene, local_trajectory);
     }
 
     // Check if path is valid
@@ -163,8 +175,19 @@ ForwardTrajectory::solve(const robot_trajectory::RobotTrajectory& local_trajecto
           prev_waypoint_target_ = nullptr;
           feedback_result.feedback = toString(LocalFeedbackEnum::LOCAL_PLANNER_STUCK);
           path_invalidation_event_send_ = true;  // Set feedback flag
+          progress_degraded_event_send_ = false;
           RCLCPP_INFO(LOGGER, "The local planner has been stuck for several iterations. Aborting.");
         }
+        else if (num_iterations_stuck_ >= DEGRADED_ITERATIONS_THRESHOLD && !progress_degraded_event_send_ &&
+                 !path_invalidation_event_send_)
+        {
+          feedback_result.feedback = toString(LocalFeedbackEnum::PROGRESS_DEGRADED);
+          progress_degraded_event_send_ = true;
+        }
+      }
+      else
+      {
+        progress_degraded_event_send_ = false;
       }
       prev_waypoint_target_ = robot_command.getFirstWayPointPtr();
     }
@@ -177,6 +200,47 @@ ForwardTrajectory::solve(const robot_trajectory::RobotTrajectory& local_trajecto
 
   return feedback_result;
 }
+
+bool ForwardTrajectory::updateValidWaypoints(const planning_scene::PlanningScene& planning_scene,
+                                             const robot_trajectory::RobotTrajectory& local_trajectory)
+{
+  // Any change of the world may block the waypoints checked before
+  if (planning_scene.getCollisionObjectsVersion() != valid_collision_objects_version_ ||
+      planning_scene.getOctomapVersion() != valid_octomap_version_)
+  {
+    valid_waypoints_.clear();
+    valid_collision_objects_version_ = planning_scene.getCollisionObjectsVersion();
+    valid_octomap_version_ = planning_scene.getOctomapVersion();
+  }
+
+  // Drop the waypoints the local trajectory moved past. The remaining ones are only still valid if they are the
+  // leading waypoints of the local trajectory.
+  while (!valid_waypoints_.empty() && local_trajectory.getWayPointCount() > 0 &&
+         !haveEqualPositions(valid_waypoints_.front(), local_trajectory.getWayPoint(0)))
+  {
+    valid_waypoints_.pop_front();
+  }
+  std::size_t checked = 0;
+  while (checked < valid_waypoints_.size() && checked < local_trajectory.getWayPointCount() &&
+         haveEqualPositions(valid_waypoints_[checked], local_trajectory.getWayPoint(checked)))
+  {
+    ++checked;
+  }
+  valid_waypoints_.resize(checked);
+
+  // Check the waypoints that entered the local trajectory
+  for (std::size_t i = checked; i < local_trajectory.getWayPointCount(); ++i)
+  {
+    const moveit::core::RobotState& waypoint = local_trajectory.getWayPoint(i);
+    if (!planning_scene.isStateValid(waypoint, local_trajectory.getGroupName(), false))
+    {
+      return false;
+    }
+    valid_waypoints_.emplace_back(waypoint.getVariablePositions(),
+                                  waypoint.getVariablePositions() + waypoint.getVariableCount());
+  }
+  return true;
+}
 }  // namespace moveit::hybrid_planning
 
 #include <pluginlib/class_list_macros.hpp>
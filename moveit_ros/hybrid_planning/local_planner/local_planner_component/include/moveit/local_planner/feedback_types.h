@@ -51,7 +51,8 @@ namespace moveit::hybrid_planning
 enum LocalFeedbackEnum
 {
   COLLISION_AHEAD = 1,
-  LOCAL_PLANNER_STUCK = 2
+  LOCAL_PLANNER_STUCK = 2,
+  PROGRESS_DEGRADED = 3
 };
 
 [[nodiscard]] constexpr std::string_view toString(const LocalFeedbackEnum& code)
@@ -62,6 +63,8 @@ enum LocalFeedbackEnum
       return "Collision ahead";
     case LOCAL_PLANNER_STUCK:
       return "Local planner is stuck";
+    case PROGRESS_DEGRADED:
+      return "Local planner progress is degraded";
     default:
       __builtin_unreachable();
   }
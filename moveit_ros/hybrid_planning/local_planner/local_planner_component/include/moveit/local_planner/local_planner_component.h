@@ -61,6 +61,8 @@
 #include <tf2_ros/buffer.h>
 #include <tf2_ros/transform_listener.h>
 
+#include <mutex>
+
 namespace moveit::hybrid_planning
 {
 // TODO(sjahr) Refactor and use repository wide solution
@@ -117,6 +119,11 @@ public:
                                      undefined, node);
       declareOrGetParam<std::string>("local_planning_action_name", local_planning_action_name, undefined, node);
       declareOrGetParam<double>("local_planning_frequency", local_planning_frequency, 1.0, node);
+      // Real-time loop options
+      declareOrGetParam<bool>("use_realtime_loop", use_realtime_loop, false, node);
+      declareOrGetParam<int>("realtime_thread_priority", realtime_thread_priority, 0, node);
+      declareOrGetParam<int>("realtime_cpu_affinity", realtime_cpu_affinity, -1, node);
+      declareOrGetParam<std::string>("loop_statistics_topic", loop_statistics_topic, "~/loop_statistics", node);
       declareOrGetParam<std::string>("global_solution_topic", global_solution_topic, undefined, node);
       declareOrGetParam<std::string>("local_solution_topic", local_solution_topic, undefined, node);
       declareOrGetParam<std::string>("local_solution_topic_type", local_solution_topic_type, undefined, node);
@@ -141,6 +148,14 @@ public:
     bool publish_joint_positions;
     bool publish_joint_velocities;
     double local_planning_frequency;
+    // Run executeIteration() on a dedicated thread that sleeps until absolute deadlines instead of using a wall timer
+    bool use_realtime_loop;
+    // SCHED_FIFO priority of the real-time loop thread, 0 keeps the default scheduling policy
+    int realtime_thread_priority;
+    // CPU the real-time loop thread is pinned to, -1 allows all CPUs
+    int realtime_cpu_affinity;
+    // Topic the real-time loop publishes its iteration statistics on, empty to disable
+    std::string loop_statistics_topic;
     std::string monitored_planning_scene_topic;
     std::string collision_object_topic;
     std::string joint_states_topic;
@@ -152,7 +167,8 @@ public:
   /** \brief Destructor */
   ~LocalPlannerComponent()
   {
-    // Join the thread used for long-running callbacks
+    // Stop the real-time loop and join the thread used for long-running callbacks
+    stop_loop_ = true;
     if (long_callback_thread_.joinable())
     {
       long_callback_thread_.join();
@@ -183,6 +199,17 @@ private:
   /** \brief Reset internal data members including state_ = LocalPlannerState::AWAIT_GLOBAL_TRAJECTORY */
   void reset();
 
+  /**
+   * Call executeIteration() at the local planning frequency until the planner is reset. The calling thread is
+   * configured with the real-time priority and CPU affinity of the config and sleeps until the absolute start time of
+   * the next iteration, so the period does not drift with the iteration duration. Iterations that end after the start
+   * of the next one are counted as missed deadlines, and the loop skips ahead to the next period in the future.
+   */
+  void runRealtimeLoop();
+
+  /** \brief Apply realtime_thread_priority and realtime_cpu_affinity to the calling thread */
+  void configureRealtimeThread();
+
   std::shared_ptr<rclcpp::Node> node_;
 
   // Planner configuration
@@ -194,6 +221,16 @@ private:
   // Timer to periodically call executeIteration()
   rclcpp::TimerBase::SharedPtr timer_;
 
+  // Signals the real-time loop to return after the current iteration
+  std::atomic<bool> stop_loop_{ false };
+
+  // Serializes executeIteration() on the real-time loop thread with the global solution callback
+  std::mutex iteration_mutex_;
+
+  // Statistics of the real-time loop: [iterations, missed deadlines, mean duration, max duration] since the last
+  // publication, durations in seconds
+  rclcpp::Publisher<std_msgs::msg::Float64MultiArray>::SharedPtr loop_statistics_publisher_;
+
   // Latest action goal handle
   std::shared_ptr<rclcpp_action::ServerGoalHandle<moveit_msgs::action::LocalPlanner>> local_planning_goal_handle_;
 
@@ -107,6 +107,16 @@ public:
    */
   virtual bool reset() = 0;
 
+  /**
+   * Whether addTrajectorySegment() may run concurrently to the other functions. If so, the local planner does not pause
+   * its iterations while a new reference trajectory is added.
+   * @return True if the trajectory operator synchronizes reference trajectory updates itself
+   */
+  virtual bool supportsConcurrentTrajectoryUpdates() const
+  {
+    return false;
+  }
+
 protected:
   // Reference trajectory to be precessed
   robot_trajectory::RobotTrajectoryPtr reference_trajectory_;
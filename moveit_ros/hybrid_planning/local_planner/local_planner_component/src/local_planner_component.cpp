@@ -41,6 +41,14 @@
 
 #include <moveit_msgs/msg/constraints.hpp>
 
+#include <realtime_tools/thread_priority.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <algorithm>
+#include <cerrno>
+
 namespace moveit::hybrid_planning
 {
 using namespace std::chrono_literals;
@@ -52,6 +60,21 @@ const auto JOIN_THREAD_TIMEOUT = std::chrono::seconds(1);
 
 // If the trajectory progress reaches more than 0.X the global goal state is considered as reached
 constexpr double PROGRESS_THRESHOLD = 0.995;
+
+// Interval at which the real-time loop publishes its statistics
+const auto LOOP_STATISTICS_INTERVAL = std::chrono::seconds(1);
+
+// Sleep until an absolute time of the steady clock, which is CLOCK_MONOTONIC on Linux
+void sleepUntil(const std::chrono::steady_clock::time_point& deadline)
+{
+  const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+  timespec ts;
+  ts.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+  ts.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+  {
+  }
+}
 }  // namespace
 
 LocalPlannerComponent::LocalPlannerComponent(const rclcpp::NodeOptions& options)
@@ -193,6 +216,12 @@ bool LocalPlannerComponent::initialize()
         }
         // Start a local planning loop.
         // This needs to return quickly to avoid blocking the executor, so run the local planner in a new thread.
+        if (config_.use_realtime_loop)
+        {
+          stop_loop_ = false;
+          long_callback_thread_ = std::thread([this]() { runRealtimeLoop(); });
+          return;
+        }
         auto local_planner_timer = [&]() {
           timer_ =
               node_->create_wall_timer(1s / config_.local_planning_frequency, [this]() { return executeIteration(); });
@@ -210,7 +239,20 @@ bool LocalPlannerComponent::initialize()
         moveit::core::RobotState start_state(planning_scene_monitor_->getRobotModel());
         moveit::core::robotStateMsgToRobotState(msg->trajectory_start, start_state);
         new_trajectory.setRobotTrajectoryMsg(start_state, msg->trajectory);
-        *local_planner_feedback_ = trajectory_operator_instance_->addTrajectorySegment(new_trajectory);
+
+        // Only pause the local planning iterations for the update if the trajectory operator requires it
+        std::unique_lock<std::mutex> lock(iteration_mutex_, std::defer_lock);
+        if (!trajectory_operator_instance_->supportsConcurrentTrajectoryUpdates())
+        {
+          lock.lock();
+        }
+        moveit_msgs::action::LocalPlanner::Feedback feedback =
+            trajectory_operator_instance_->addTrajectorySegment(new_trajectory);
+        if (!lock.owns_lock())
+        {
+          lock.lock();
+        }
+        *local_planner_feedback_ = feedback;
 
         // Feedback is only send when the hybrid planning architecture should react to a discrete event that occurred
         // when the reference trajectory is updated
@@ -240,10 +282,99 @@ bool LocalPlannerComponent::initialize()
     // Local solution publisher is defined by the local constraint solver plugin
   }
 
+  if (config_.use_realtime_loop && !config_.loop_statistics_topic.empty())
+  {
+    loop_statistics_publisher_ =
+        node_->create_publisher<std_msgs::msg::Float64MultiArray>(config_.loop_statistics_topic, 1);
+  }
+
   state_ = LocalPlannerState::AWAIT_GLOBAL_TRAJECTORY;
   return true;
 }
 
+void LocalPlannerComponent::configureRealtimeThread()
+{
+  if (config_.realtime_thread_priority > 0)
+  {
+    if (!realtime_tools::has_realtime_kernel())
+    {
+      RCLCPP_WARN(LOGGER, "Realtime kernel is recommended for the real-time local planning loop.");
+    }
+    if (!realtime_tools::configure_sched_fifo(config_.realtime_thread_priority))
+    {
+      RCLCPP_WARN(LOGGER, "Could not enable FIFO RT scheduling policy with priority %d.",
+                  config_.realtime_thread_priority);
+    }
+  }
+
+  if (config_.realtime_cpu_affinity >= 0)
+  {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(config_.realtime_cpu_affinity, &cpu_set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+    {
+      RCLCPP_WARN(LOGGER, "Could not pin the local planning loop to CPU %d.", config_.realtime_cpu_affinity);
+    }
+  }
+}
+
+void LocalPlannerComponent::runRealtimeLoop()
+{
+  configureRealtimeThread();
+
+  const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / config_.local_planning_frequency));
+
+  std::size_t iterations = 0;
+  std::size_t missed_deadlines = 0;
+  double duration_sum = 0.0;
+  double duration_max = 0.0;
+
+  auto deadline = std::chrono::steady_clock::now();
+  auto statistics_start = deadline;
+  while (!stop_loop_)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> lock(iteration_mutex_);
+      executeIteration();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double duration = std::chrono::duration<double>(end - start).count();
+    ++iterations;
+    duration_sum += duration;
+    duration_max = std::max(duration_max, duration);
+
+    deadline += period;
+    if (end > deadline)
+    {
+      // Skip the periods that already passed instead of running the late iterations back to back
+      ++missed_deadlines;
+      deadline += ((end - deadline) / period + 1) * period;
+    }
+
+    if (loop_statistics_publisher_ && end - statistics_start >= LOOP_STATISTICS_INTERVAL)
+    {
+      auto statistics = std::make_unique<std_msgs::msg::Float64MultiArray>();
+      statistics->data = { static_cast<double>(iterations), static_cast<double>(missed_deadlines),
+                           duration_sum / iterations, duration_max };
+      loop_statistics_publisher_->publish(std::move(statistics));
+      iterations = 0;
+      missed_deadlines = 0;
+      duration_sum = 0.0;
+      duration_max = 0.0;
+      statistics_start = end;
+    }
+
+    if (!stop_loop_)
+    {
+      sleepUntil(deadline);
+    }
+  }
+}
+
 void LocalPlannerComponent::executeIteration()
 {
   auto result = std::make_shared<moveit_msgs::action::LocalPlanner::Result>();
@@ -305,11 +436,11 @@ void LocalPlannerComponent::executeIteration()
       *local_planner_feedback_ = local_constraint_solver_instance_->solve(
           local_trajectory, local_planning_goal_handle_->get_goal(), local_solution);
 
-      // Feedback is only send when the hybrid planning architecture should react to a discrete event
+      // Feedback is only send when the hybrid planning architecture should react to a discrete event. The local
+      // solution is still sent, so the robot keeps following it while the event is handled (e.g. by replanning)
       if (!local_planner_feedback_->feedback.empty())
       {
         local_planning_goal_handle_->publish_feedback(local_planner_feedback_);
-        return;
       }
 
       // Use a configurable message interface like MoveIt servo
@@ -359,7 +490,11 @@ void LocalPlannerComponent::reset()
 {
   local_constraint_solver_instance_->reset();
   trajectory_operator_instance_->reset();
-  timer_->cancel();
+  if (timer_)
+  {
+    timer_->cancel();
+  }
+  stop_loop_ = true;
   state_ = LocalPlannerState::AWAIT_GLOBAL_TRAJECTORY;
 }
 }  // namespace moveit::hybrid_planning
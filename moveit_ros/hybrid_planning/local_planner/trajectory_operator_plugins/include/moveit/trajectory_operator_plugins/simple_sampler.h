@@ -36,6 +36,8 @@
    Description: Simple trajectory operator that samples the next global trajectory waypoint as local goal constraint
    based on the current robot state. When the waypoint is reached the index that marks the current local goal constraint
    is updated to the next global trajectory waypoint. Global trajectory updates simply replace the reference trajectory.
+   The local trajectory can also contain the following waypoints up to the "lookahead_waypoints" parameter, so the
+   local solver can detect path blockage early.
  */
 
 #include <moveit/local_planner/trajectory_operator_interface.h>
@@ -49,8 +51,8 @@ public:
   SimpleSampler() = default;
   ~SimpleSampler() override = default;
 
-  bool initialize([[maybe_unused]] const rclcpp::Node::SharedPtr& node,
-                  const moveit::core::RobotModelConstPtr& robot_model, const std::string& group_name) override;
+  bool initialize(const rclcpp::Node::SharedPtr& node, const moveit::core::RobotModelConstPtr& robot_model,
+                  const std::string& group_name) override;
   moveit_msgs::action::LocalPlanner::Feedback
   addTrajectorySegment(const robot_trajectory::RobotTrajectory& new_trajectory) override;
   moveit_msgs::action::LocalPlanner::Feedback
@@ -65,5 +67,6 @@ private:
   moveit_msgs::action::LocalPlanner::Feedback feedback_;  // Empty feedback
   trajectory_processing::TimeOptimalTrajectoryGeneration time_parametrization_;
   const moveit::core::JointModelGroup* joint_group_;
+  std::size_t lookahead_waypoints_;  // Number of reference waypoints added to the local trajectory after the local goal
 };
 }  // namespace moveit::hybrid_planning
@@ -0,0 +1,82 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Description: Trajectory operator with bounded per-iteration cost. New global trajectories are prepared on the thread
+   that receives them and swapped in through an atomic pointer, so the local planner does not pause for them. The local
+   goal is the reference waypoint after the one closest to the current state, searched in a fixed size window starting
+   at the current local goal, so the cost of an iteration does not depend on the trajectory length.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <moveit/local_planner/trajectory_operator_interface.h>
+#include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
+
+namespace moveit::hybrid_planning
+{
+class WindowedSampler : public TrajectoryOperatorInterface
+{
+public:
+  WindowedSampler() = default;
+  ~WindowedSampler() override = default;
+
+  bool initialize(const rclcpp::Node::SharedPtr& node, const moveit::core::RobotModelConstPtr& robot_model,
+                  const std::string& group_name) override;
+  moveit_msgs::action::LocalPlanner::Feedback
+  addTrajectorySegment(const robot_trajectory::RobotTrajectory& new_trajectory) override;
+  moveit_msgs::action::LocalPlanner::Feedback
+  getLocalTrajectory(const moveit::core::RobotState& current_state,
+                     robot_trajectory::RobotTrajectory& local_trajectory) override;
+  double getTrajectoryProgress([[maybe_unused]] const moveit::core::RobotState& current_state) override;
+  bool reset() override;
+  bool supportsConcurrentTrajectoryUpdates() const override
+  {
+    return true;
+  }
+
+private:
+  // Newest global trajectory, taken over by the next getLocalTrajectory() call
+  robot_trajectory::RobotTrajectoryConstPtr pending_trajectory_;
+  // Global trajectory the local goals are sampled from, only used by the local planning iterations
+  robot_trajectory::RobotTrajectoryConstPtr active_trajectory_;
+  std::size_t next_waypoint_index_ = 0;  // Reference waypoint that is the current local goal
+  std::size_t search_window_ = 1;        // Number of reference waypoints searched for the closest one
+  std::size_t lookahead_waypoints_ = 0;  // Number of reference waypoints added to the local trajectory after the goal
+  const moveit::core::JointModelGroup* joint_group_ = nullptr;
+  moveit_msgs::action::LocalPlanner::Feedback feedback_;  // Empty feedback
+};
+}  // namespace moveit::hybrid_planning
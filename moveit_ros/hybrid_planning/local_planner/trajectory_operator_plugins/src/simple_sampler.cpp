@@ -44,9 +44,19 @@ const rclcpp::Logger LOGGER = rclcpp::get_logger("local_planner_component");
 constexpr double WAYPOINT_RADIAN_TOLERANCE = 0.2;  // rad: L1-norm sum for all joints
 }  // namespace
 
-bool SimpleSampler::initialize([[maybe_unused]] const rclcpp::Node::SharedPtr& node,
-                               const moveit::core::RobotModelConstPtr& robot_model, const std::string& group_name)
+bool SimpleSampler::initialize(const rclcpp::Node::SharedPtr& node, const moveit::core::RobotModelConstPtr& robot_model,
+                               const std::string& group_name)
 {
+  int lookahead_waypoints;
+  if (node->has_parameter("lookahead_waypoints"))
+  {
+    node->get_parameter<int>("lookahead_waypoints", lookahead_waypoints);
+  }
+  else
+  {
+    lookahead_waypoints = node->declare_parameter<int>("lookahead_waypoints", 0);
+  }
+  lookahead_waypoints_ = std::max(lookahead_waypoints, 0);
   reference_trajectory_ = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model, group_name);
   next_waypoint_index_ = 0;
   joint_group_ = robot_model->getJointModelGroup(group_name);
@@ -103,6 +113,15 @@ SimpleSampler::getLocalTrajectory(const moveit::core::RobotState& current_state,
   local_trajectory.addSuffixWayPoint(reference_trajectory_->getWayPoint(next_waypoint_index_),
                                      reference_trajectory_->getWayPointDurationFromPrevious(next_waypoint_index_));
 
+  // Append the following waypoints, so the local solver can look ahead
+  const std::size_t lookahead_end =
+      std::min(next_waypoint_index_ + lookahead_waypoints_ + 1, reference_trajectory_->getWayPointCount());
+  for (std::size_t i = next_waypoint_index_ + 1; i < lookahead_end; ++i)
+  {
+    local_trajectory.addSuffixWayPoint(reference_trajectory_->getWayPoint(i),
+                                       reference_trajectory_->getWayPointDurationFromPrevious(i));
+  }
+
   // Return empty feedback
   return feedback_;
 }
@@ -0,0 +1,163 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/trajectory_operator_plugins/windowed_sampler.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace moveit::hybrid_planning
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("local_planner_component");
+constexpr double WAYPOINT_RADIAN_TOLERANCE = 0.2;  // rad: L1-norm sum for all joints
+
+int getIntParameter(const rclcpp::Node::SharedPtr& node, const std::string& name, int default_value)
+{
+  int value;
+  if (node->has_parameter(name))
+  {
+    node->get_parameter<int>(name, value);
+  }
+  else
+  {
+    value = node->declare_parameter<int>(name, default_value);
+  }
+  return value;
+}
+}  // namespace
+
+bool WindowedSampler::initialize(const rclcpp::Node::SharedPtr& node,
+                                 const moveit::core::RobotModelConstPtr& robot_model, const std::string& group_name)
+{
+  joint_group_ = robot_model->getJointModelGroup(group_name);
+  search_window_ = std::max(getIntParameter(node, "waypoint_search_window", 10), 1);
+  lookahead_waypoints_ = std::max(getIntParameter(node, "lookahead_waypoints", 0), 0);
+  return joint_group_ != nullptr;
+}
+
+moveit_msgs::action::LocalPlanner::Feedback
+WindowedSampler::addTrajectorySegment(const robot_trajectory::RobotTrajectory& new_trajectory)
+{
+  // Parametrize the trajectory before it is swapped in, so the local planning iterations never wait for it
+  auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(new_trajectory);
+  trajectory_processing::TimeOptimalTrajectoryGeneration time_parametrization;
+  if (!time_parametrization.computeTimeStamps(*trajectory))
+  {
+    RCLCPP_WARN(LOGGER, "Time parametrization of the new reference trajectory failed");
+  }
+  std::atomic_store(&pending_trajectory_, robot_trajectory::RobotTrajectoryConstPtr(trajectory));
+
+  // Return empty feedback
+  return feedback_;
+}
+
+bool WindowedSampler::reset()
+{
+  std::atomic_store(&pending_trajectory_, robot_trajectory::RobotTrajectoryConstPtr());
+  active_trajectory_.reset();
+  next_waypoint_index_ = 0;
+  return true;
+}
+
+moveit_msgs::action::LocalPlanner::Feedback
+WindowedSampler::getLocalTrajectory(const moveit::core::RobotState& current_state,
+                                    robot_trajectory::RobotTrajectory& local_trajectory)
+{
+  // Take over a new reference trajectory
+  if (auto pending = std::atomic_exchange(&pending_trajectory_, robot_trajectory::RobotTrajectoryConstPtr()))
+  {
+    active_trajectory_ = std::move(pending);
+    next_waypoint_index_ = 0;
+  }
+  if (!active_trajectory_ || active_trajectory_->getWayPointCount() == 0)
+  {
+    feedback_.feedback = "unhandled_exception";
+    return feedback_;
+  }
+
+  // Delete previous local trajectory
+  local_trajectory.clear();
+
+  // The robot moves forward along the reference trajectory, so the closest waypoint is searched from the current
+  // local goal on
+  const std::size_t waypoint_count = active_trajectory_->getWayPointCount();
+  const std::size_t window_end = std::min(next_waypoint_index_ + search_window_, waypoint_count);
+  std::size_t closest_index = next_waypoint_index_;
+  double closest_distance = std::numeric_limits<double>::infinity();
+  for (std::size_t i = next_waypoint_index_; i < window_end; ++i)
+  {
+    const double distance = active_trajectory_->getWayPoint(i).distance(current_state, joint_group_);
+    if (distance < closest_distance)
+    {
+      closest_distance = distance;
+      closest_index = i;
+    }
+  }
+
+  // Once the closest waypoint is reached, the next one becomes the local goal
+  next_waypoint_index_ = closest_index;
+  if (closest_distance <= WAYPOINT_RADIAN_TOLERANCE)
+  {
+    next_waypoint_index_ = std::min(closest_index + 1, waypoint_count - 1);
+  }
+
+  // Construct local trajectory containing the local goal and the waypoints to look ahead
+  const std::size_t local_end = std::min(next_waypoint_index_ + lookahead_waypoints_ + 1, waypoint_count);
+  for (std::size_t i = next_waypoint_index_; i < local_end; ++i)
+  {
+    local_trajectory.addSuffixWayPoint(active_trajectory_->getWayPoint(i),
+                                       active_trajectory_->getWayPointDurationFromPrevious(i));
+  }
+
+  // Return empty feedback
+  return feedback_;
+}
+
+double WindowedSampler::getTrajectoryProgress([[maybe_unused]] const moveit::core::RobotState& current_state)
+{
+  // Check if trajectory is unwinded
+  if (active_trajectory_ && next_waypoint_index_ + 1 >= active_trajectory_->getWayPointCount())
+  {
+    return 1.0;
+  }
+  return 0.0;
+}
+}  // namespace moveit::hybrid_planning
+
+#include <pluginlib/class_list_macros.hpp>
+
+PLUGINLIB_EXPORT_CLASS(moveit::hybrid_planning::WindowedSampler, moveit::hybrid_planning::TrajectoryOperatorInterface);
@@ -0,0 +1,197 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include "batch_plan_service_capability.h"
+
+#include <moveit/moveit_cpp/moveit_cpp.h>
+#include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/move_group/capability_names.h>
+#include <moveit/robot_state/conversions.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+namespace move_group
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_move_group_default_capabilities.batch_plan_service_capability");
+constexpr bool DISPLAY_COMPUTED_MOTION_PLANS = false;
+constexpr bool CHECK_SOLUTION_PATHS = true;
+}  // namespace
+
+MoveGroupBatchPlanService::MoveGroupBatchPlanService() : MoveGroupCapability("BatchMotionPlanService"), max_successes_(0)
+{
+}
+
+void MoveGroupBatchPlanService::initialize()
+{
+  context_->moveit_cpp_->getNode()->get_parameter_or("batch_planning_max_successes", max_successes_, 0);
+
+  batch_plan_service_ = context_->moveit_cpp_->getNode()->create_service<moveit_msgs::srv::GetMotionSequence>(
+      BATCH_PLANNER_SERVICE_NAME,
+      [this](const std::shared_ptr<rmw_request_id_t>& request_header,
+             const std::shared_ptr<moveit_msgs::srv::GetMotionSequence::Request>& req,
+             const std::shared_ptr<moveit_msgs::srv::GetMotionSequence::Response>& res) {
+        return computeBatchPlanService(request_header, req, res);
+      });
+}
+
+bool MoveGroupBatchPlanService::computeBatchPlanService(
+    const std::shared_ptr<rmw_request_id_t>& /* unused */,
+    const std::shared_ptr<moveit_msgs::srv::GetMotionSequence::Request>& req,
+    const std::shared_ptr<moveit_msgs::srv::GetMotionSequence::Response>& res)
+{
+  const std::vector<moveit_msgs::msg::MotionSequenceItem>& items = req->request.items;
+  RCLCPP_INFO(LOGGER, "Received batch planning service request with %zu motion plan requests...", items.size());
+  const rclcpp::Time start_time = context_->moveit_cpp_->getNode()->get_clock()->now();
+
+  // before we start planning, ensure that we have the latest robot state received...
+  for (const moveit_msgs::msg::MotionSequenceItem& item : items)
+  {
+    if (static_cast<bool>(item.req.start_state.is_diff))
+    {
+      context_->planning_scene_monitor_->waitForCurrentRobotState(start_time);
+      break;
+    }
+  }
+  context_->planning_scene_monitor_->updateFrameTransforms();
+
+  // Plan all requests against the same copy of the scene, so the monitor is not blocked while the batch is planned
+  planning_scene::PlanningScenePtr scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO ps(context_->planning_scene_monitor_, "batch_plan_service");
+    scene = planning_scene::PlanningScene::clone(ps);
+  }
+  moveit::core::robotStateToRobotStateMsg(scene->getCurrentState(), res->response.sequence_start);
+
+  // Resolve every pipeline once before the requests are handed to the workers
+  std::map<std::string, planning_pipeline::PlanningPipelinePtr> resolved_pipelines;
+  std::vector<planning_pipeline::PlanningPipelinePtr> pipelines(items.size());
+  for (std::size_t i = 0; i < items.size(); ++i)
+  {
+    const std::string& pipeline_id = items[i].req.pipeline_id;
+    auto it = resolved_pipelines.find(pipeline_id);
+    if (it == resolved_pipelines.end())
+      it = resolved_pipelines.emplace(pipeline_id, resolvePlanningPipeline(pipeline_id)).first;
+    pipelines[i] = it->second;
+  }
+
+  std::vector<planning_interface::MotionPlanResponse> responses(items.size());
+  const std::size_t max_successes = static_cast<std::size_t>(std::max(max_successes_, 0));
+  std::atomic<std::size_t> successes{ 0 };
+  std::size_t remaining = items.size();
+  std::mutex remaining_mutex;
+  std::condition_variable remaining_condition;
+
+  const moveit::planning_pipeline_interfaces::PlanningThreadPoolPtr& pool =
+      context_->moveit_cpp_->getPlanningThreadPool();
+  for (std::size_t i = 0; i < items.size(); ++i)
+  {
+    auto task = [&, i]() {
+      planning_interface::MotionPlanResponse& mp_res = responses[i];
+      if (!pipelines[i])
+      {
+        mp_res.error_code.val = moveit_msgs::msg::MoveItErrorCodes::FAILURE;
+      }
+      else if (max_successes > 0 && successes >= max_successes)
+      {
+        // Enough solutions were found already, skip requests that did not start yet
+        mp_res.error_code.val = moveit_msgs::msg::MoveItErrorCodes::PREEMPTED;
+      }
+      else
+      {
+        try
+        {
+          if (!pipelines[i]->generatePlan(scene, items[i].req, mp_res, context_->debug_, CHECK_SOLUTION_PATHS,
+                                          DISPLAY_COMPUTED_MOTION_PLANS))
+          {
+            mp_res.error_code.val = moveit_msgs::msg::MoveItErrorCodes::FAILURE;
+          }
+        }
+        catch (std::exception& ex)
+        {
+          RCLCPP_ERROR(LOGGER, "Planning pipeline threw an exception for request %zu: %s", i, ex.what());
+          mp_res.error_code.val = moveit_msgs::msg::MoveItErrorCodes::FAILURE;
+        }
+        if (mp_res.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS)
+          ++successes;
+      }
+
+      std::lock_guard<std::mutex> lock(remaining_mutex);
+      if (--remaining == 0)
+        remaining_condition.notify_all();
+    };
+
+    if (pool)
+      pool->submit(task);
+    else
+      task();
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(remaining_mutex);
+    remaining_condition.wait(lock, [&remaining] { return remaining == 0; });
+  }
+
+  res->response.planned_trajectories.resize(items.size());
+  for (std::size_t i = 0; i < items.size(); ++i)
+  {
+    if (responses[i].error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS && responses[i].trajectory)
+    {
+      moveit_msgs::msg::RobotState start_state;
+      convertToMsg(responses[i].trajectory, start_state, res->response.planned_trajectories[i]);
+    }
+    else
+    {
+      RCLCPP_DEBUG(LOGGER, "Request %zu of the batch failed with error code %d", i, responses[i].error_code.val);
+    }
+  }
+
+  RCLCPP_INFO(LOGGER, "Batch planning found %zu solutions for %zu motion plan requests", successes.load(),
+              items.size());
+  res->response.error_code.val = (successes > 0 || items.empty()) ? moveit_msgs::msg::MoveItErrorCodes::SUCCESS :
+                                                                    moveit_msgs::msg::MoveItErrorCodes::PLANNING_FAILED;
+  res->response.planning_time = (context_->moveit_cpp_->getNode()->get_clock()->now() - start_time).seconds();
+  return true;
+}
+}  // namespace move_group
+
+#include <pluginlib/class_list_macros.hpp>
+
+PLUGINLIB_EXPORT_CLASS(move_group::MoveGroupBatchPlanService, move_group::MoveGroupCapability)
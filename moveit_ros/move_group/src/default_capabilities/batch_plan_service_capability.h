@@ -0,0 +1,64 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/move_group/move_group_capability.h>
+#include <moveit_msgs/srv/get_motion_sequence.hpp>
+
+namespace move_group
+{
+/** \brief Plans a batch of independent motion plan requests against one planning scene snapshot.
+
+    The service reuses the GetMotionSequence interface: every item is planned on its own, blend radii are ignored and
+    planned_trajectories holds one trajectory per item, left empty for items that failed or were skipped. */
+class MoveGroupBatchPlanService : public MoveGroupCapability
+{
+public:
+  MoveGroupBatchPlanService();
+
+  void initialize() override;
+
+private:
+  bool computeBatchPlanService(const std::shared_ptr<rmw_request_id_t>& request_header,
+                               const std::shared_ptr<moveit_msgs::srv::GetMotionSequence::Request>& req,
+                               const std::shared_ptr<moveit_msgs::srv::GetMotionSequence::Response>& res);
+
+  rclcpp::Service<moveit_msgs::srv::GetMotionSequence>::SharedPtr batch_plan_service_;
+
+  /// Number of successful plans after which requests that did not start yet are skipped, 0 plans all requests
+  int max_successes_;
+};
+}  // namespace move_group
@@ -0,0 +1,258 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include "batch_state_validation_service_capability.h"
+
+#include <moveit/moveit_cpp/moveit_cpp.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit/utils/message_checks.h>
+#include <moveit/collision_detection/collision_tools.h>
+#include <moveit/kinematic_constraints/kinematic_constraint.h>
+#include <moveit/move_group/capability_names.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace move_group
+{
+namespace
+{
+const rclcpp::Logger LOGGER =
+    rclcpp::get_logger("moveit_move_group_default_capabilities.batch_state_validation_service_capability");
+
+// Copy the joint values of one state of the batch into a single state message
+void copyState(const moveit_msgs::msg::RobotState& batch, std::size_t index, moveit_msgs::msg::RobotState& state)
+{
+  const std::size_t joint_count = batch.joint_state.name.size();
+  auto positions = batch.joint_state.position.begin() + index * joint_count;
+  state.joint_state.position.assign(positions, positions + joint_count);
+
+  const std::size_t multi_dof_joint_count = batch.multi_dof_joint_state.joint_names.size();
+  auto transforms = batch.multi_dof_joint_state.transforms.begin() + index * multi_dof_joint_count;
+  state.multi_dof_joint_state.transforms.assign(transforms, transforms + multi_dof_joint_count);
+}
+}  // namespace
+
+MoveGroupBatchStateValidationService::MoveGroupBatchStateValidationService()
+  : MoveGroupCapability("BatchStateValidationService"), stop_at_first_invalid_(true)
+{
+}
+
+void MoveGroupBatchStateValidationService::initialize()
+{
+  context_->moveit_cpp_->getNode()->get_parameter_or("batch_state_validation_stop_at_first_invalid",
+                                                     stop_at_first_invalid_, true);
+
+  batch_validity_service_ = context_->moveit_cpp_->getNode()->create_service<moveit_msgs::srv::GetStateValidity>(
+      BATCH_STATE_VALIDITY_SERVICE_NAME,
+      [this](const std::shared_ptr<rmw_request_id_t>& request_header,
+             const std::shared_ptr<moveit_msgs::srv::GetStateValidity::Request>& req,
+             const std::shared_ptr<moveit_msgs::srv::GetStateValidity::Response>& res) {
+        return computeService(request_header, req, res);
+      });
+}
+
+bool MoveGroupBatchStateValidationService::computeService(
+    const std::shared_ptr<rmw_request_id_t>& /* unused */,
+    const std::shared_ptr<moveit_msgs::srv::GetStateValidity::Request>& req,
+    const std::shared_ptr<moveit_msgs::srv::GetStateValidity::Response>& res)
+{
+  const moveit_msgs::msg::RobotState& batch = req->robot_state;
+  const std::size_t joint_count = batch.joint_state.name.size();
+  const std::size_t multi_dof_joint_count = batch.multi_dof_joint_state.joint_names.size();
+  std::size_t state_count = 1;
+  if (joint_count > 0)
+    state_count = batch.joint_state.position.size() / joint_count;
+  else if (multi_dof_joint_count > 0)
+    state_count = batch.multi_dof_joint_state.transforms.size() / multi_dof_joint_count;
+
+  res->valid = false;
+  if (batch.joint_state.position.size() != state_count * joint_count ||
+      batch.multi_dof_joint_state.transforms.size() != state_count * multi_dof_joint_count)
+  {
+    RCLCPP_ERROR(LOGGER, "The joint values of the batch do not match the number of joints");
+    return true;
+  }
+  RCLCPP_DEBUG(LOGGER, "Received batch state validation request with %zu states", state_count);
+
+  // Check all states against the same copy of the scene, so the monitor is not blocked while the batch is checked
+  planning_scene::PlanningScenePtr scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO ls(context_->planning_scene_monitor_,
+                                                     "batch_state_validation_service");
+    scene = planning_scene::PlanningScene::clone(ls);
+  }
+
+  // The single state message every state of the batch is copied into, the first one also sets the attached bodies
+  moveit_msgs::msg::RobotState state_msg;
+  state_msg.joint_state.header = batch.joint_state.header;
+  state_msg.joint_state.name = batch.joint_state.name;
+  state_msg.multi_dof_joint_state.header = batch.multi_dof_joint_state.header;
+  state_msg.multi_dof_joint_state.joint_names = batch.multi_dof_joint_state.joint_names;
+  state_msg.attached_collision_objects = batch.attached_collision_objects;
+  state_msg.is_diff = batch.is_diff;
+
+  moveit::core::RobotState start_state = scene->getCurrentState();
+  if (state_count > 0)
+    copyState(batch, 0, state_msg);
+  moveit::core::robotStateMsgToRobotState(scene->getTransforms(), state_msg, start_state);
+  state_msg.attached_collision_objects.clear();
+  state_msg.is_diff = true;
+
+  std::unique_ptr<kinematic_constraints::KinematicConstraintSet> kset;
+  if (!moveit::core::isEmpty(req->constraints))
+  {
+    kset = std::make_unique<kinematic_constraints::KinematicConstraintSet>(scene->getRobotModel());
+    kset->add(req->constraints, scene->getTransforms());
+  }
+
+  // Contacts are only computed for the first invalid state, the states of the batch are checked for collisions only
+  collision_detection::CollisionRequest creq;
+  creq.group_name = req->group_name;
+
+  res->constraint_result.resize(state_count);
+  for (moveit_msgs::msg::ConstraintEvalResult& result : res->constraint_result)
+    result.distance = -1.0;
+  std::atomic<std::size_t> first_invalid{ state_count };
+
+  // Every task checks every task_count-th state in order, so with early exit the states before the first invalid
+  // state are always checked while the ones after it are skipped as soon as it is found
+  const moveit::planning_pipeline_interfaces::PlanningThreadPoolPtr& pool =
+      context_->moveit_cpp_->getPlanningThreadPool();
+  const std::size_t task_count = std::min(pool ? pool->getThreadCount() : 1, state_count);
+  std::size_t remaining = task_count;
+  std::mutex remaining_mutex;
+  std::condition_variable remaining_condition;
+
+  for (std::size_t t = 0; t < task_count; ++t)
+  {
+    auto task = [&, t]() {
+      moveit::core::RobotState state(start_state);
+      moveit_msgs::msg::RobotState msg(state_msg);
+      for (std::size_t i = t; i < state_count; i += task_count)
+      {
+        if (stop_at_first_invalid_ && i > first_invalid)
+          break;
+
+        copyState(batch, i, msg);
+        moveit::core::robotStateMsgToRobotState(scene->getTransforms(), msg, state, false);
+        state.update();
+
+        collision_detection::CollisionResult cres;
+        scene->checkCollision(creq, cres, state);
+        bool valid = !cres.collision;
+        double distance = 0.0;
+        if (valid && kset)
+        {
+          kinematic_constraints::ConstraintEvaluationResult kres = kset->decide(state);
+          valid = kres.satisfied;
+          distance = kres.distance;
+        }
+
+        res->constraint_result[i].result = valid;
+        res->constraint_result[i].distance = distance;
+        if (!valid)
+        {
+          std::size_t expected = first_invalid;
+          while (i < expected && !first_invalid.compare_exchange_weak(expected, i))
+          {
+          }
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(remaining_mutex);
+      if (--remaining == 0)
+        remaining_condition.notify_all();
+    };
+
+    if (pool)
+      pool->submit(task);
+    else
+      task();
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(remaining_mutex);
+    remaining_condition.wait(lock, [&remaining] { return remaining == 0; });
+  }
+
+  res->valid = first_invalid == state_count;
+  if (res->valid)
+    return true;
+
+  // Report the contacts and cost sources of the first invalid state
+  moveit::core::RobotState state(start_state);
+  copyState(batch, first_invalid, state_msg);
+  moveit::core::robotStateMsgToRobotState(scene->getTransforms(), state_msg, state, false);
+  state.update();
+
+  creq.cost = true;
+  creq.contacts = true;
+  creq.max_contacts = scene->getWorld()->size() + scene->getRobotModel()->getLinkModelsWithCollisionGeometry().size();
+  creq.max_cost_sources = creq.max_contacts;
+  creq.max_contacts *= creq.max_contacts;
+  collision_detection::CollisionResult cres;
+  scene->checkCollision(creq, cres, state);
+
+  const rclcpp::Time time_now = context_->moveit_cpp_->getNode()->get_clock()->now();
+  res->contacts.reserve(cres.contact_count);
+  for (const auto& [link_pair, contacts] : cres.contacts)
+  {
+    for (const collision_detection::Contact& contact : contacts)
+    {
+      res->contacts.resize(res->contacts.size() + 1);
+      collision_detection::contactToMsg(contact, res->contacts.back());
+      res->contacts.back().header.frame_id = scene->getPlanningFrame();
+      res->contacts.back().header.stamp = time_now;
+    }
+  }
+
+  res->cost_sources.reserve(cres.cost_sources.size());
+  for (const collision_detection::CostSource& cost_source : cres.cost_sources)
+  {
+    res->cost_sources.resize(res->cost_sources.size() + 1);
+    collision_detection::costSourceToMsg(cost_source, res->cost_sources.back());
+  }
+
+  RCLCPP_DEBUG(LOGGER, "State %zu of %zu states is invalid", first_invalid.load(), state_count);
+  return true;
+}
+}  // namespace move_group
+
+#include <pluginlib/class_list_macros.hpp>
+
+PLUGINLIB_EXPORT_CLASS(move_group::MoveGroupBatchStateValidationService, move_group::MoveGroupCapability)
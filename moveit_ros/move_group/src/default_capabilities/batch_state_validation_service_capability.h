@@ -0,0 +1,68 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/move_group/move_group_capability.h>
+#include <moveit_msgs/srv/get_state_validity.hpp>
+
+namespace move_group
+{
+/** \brief Validates many robot states, e.g. the waypoints of a trajectory, against one planning scene snapshot.
+
+    The service reuses the GetStateValidity interface. The joint_state of the request holds the positions of all states
+    back to back, i.e. position has one block of joint_state.name.size() values per state, and multi_dof_joint_state
+    holds one block of transforms per state the same way. Attached collision objects apply to all states.
+    constraint_result holds one entry per state: result is the validity of the state and distance the distance to the
+    constraints, or -1 if the state was skipped after an earlier invalid state. contacts and cost_sources describe the
+    first invalid state. */
+class MoveGroupBatchStateValidationService : public MoveGroupCapability
+{
+public:
+  MoveGroupBatchStateValidationService();
+
+  void initialize() override;
+
+private:
+  bool computeService(const std::shared_ptr<rmw_request_id_t>& request_header,
+                      const std::shared_ptr<moveit_msgs::srv::GetStateValidity::Request>& req,
+                      const std::shared_ptr<moveit_msgs::srv::GetStateValidity::Response>& res);
+
+  rclcpp::Service<moveit_msgs::srv::GetStateValidity>::SharedPtr batch_validity_service_;
+
+  /// Skip the states after the first invalid one
+  bool stop_at_first_invalid_;
+};
+}  // namespace move_group
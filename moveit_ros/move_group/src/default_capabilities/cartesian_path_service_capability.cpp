@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan */
 
 #include "cartesian_path_service_capability.h"
+#include <algorithm>
 #include <moveit/moveit_cpp/moveit_cpp.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/utils/message_checks.h>
@@ -56,7 +57,7 @@ bool isStateValid(const planning_scene::PlanningScene* planning_scene,
   state->setJointGroupPositions(group, ik_solution);
   state->update();
   return (!planning_scene || !planning_scene->isStateColliding(*state, group->getName())) &&
-         (!constraint_set || constraint_set->decide(*state).satisfied);
+         (!constraint_set || constraint_set->isSatisfied(*state));
 }
 }  // namespace
 
@@ -66,12 +67,15 @@ static const rclcpp::Logger LOGGER =
     rclcpp::get_logger("moveit_move_group_default_capabilities.cartersian_path_service_capability");
 
 MoveGroupCartesianPathService::MoveGroupCartesianPathService()
-  : MoveGroupCapability("CartesianPathService"), display_computed_paths_(true)
+  : MoveGroupCapability("CartesianPathService"), display_computed_paths_(true), max_joint_step_(0.0), max_substeps_(8)
 {
 }
 
 void MoveGroupCartesianPathService::initialize()
 {
+  context_->moveit_cpp_->getNode()->get_parameter_or("cartesian_path_max_joint_step", max_joint_step_, 0.0);
+  context_->moveit_cpp_->getNode()->get_parameter_or("cartesian_path_max_substeps", max_substeps_, 8);
+
   display_path_ = context_->moveit_cpp_->getNode()->create_publisher<moveit_msgs::msg::DisplayTrajectory>(
       planning_pipeline::PlanningPipeline::DISPLAY_PATH_TOPIC, 10);
 
@@ -171,7 +175,9 @@ bool MoveGroupCartesianPathService::computeService(
           std::vector<moveit::core::RobotStatePtr> traj;
           res->fraction = moveit::core::CartesianInterpolator::computeCartesianPath(
               &start_state, jmg, traj, start_state.getLinkModel(link_name), waypoints, global_frame,
-              moveit::core::MaxEEFStep(req->max_step), moveit::core::JumpThreshold(req->jump_threshold), constraint_fn);
+              moveit::core::MaxEEFStep(req->max_step),
+              moveit::core::AdaptiveEEFStep(max_joint_step_, static_cast<std::size_t>(std::max(max_substeps_, 1))),
+              moveit::core::JumpThreshold(req->jump_threshold), constraint_fn);
           moveit::core::robotStateToRobotStateMsg(start_state, res->start_state);
 
           robot_trajectory::RobotTrajectory rt(context_->planning_scene_monitor_->getRobotModel(), req->group_name);
@@ -58,5 +58,9 @@ private:
   rclcpp::Publisher<moveit_msgs::msg::DisplayTrajectory>::SharedPtr display_path_;
 
   bool display_computed_paths_;
+
+  // Refinement of the requested max_step, see moveit::core::AdaptiveEEFStep. Disabled by default.
+  double max_joint_step_;
+  int max_substeps_;
 };
 }  // namespace move_group
@@ -52,18 +52,24 @@ MoveGroupKinematicsService::MoveGroupKinematicsService() : MoveGroupCapability("
 
 void MoveGroupKinematicsService::initialize()
 {
+  // Requests only read the planning scene, so clients that keep many requests in flight get them solved in parallel
+  callback_group_ = context_->moveit_cpp_->getNode()->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
   fk_service_ = context_->moveit_cpp_->getNode()->create_service<moveit_msgs::srv::GetPositionFK>(
-      FK_SERVICE_NAME, [this](const std::shared_ptr<rmw_request_id_t>& req_header,
-                              const std::shared_ptr<moveit_msgs::srv::GetPositionFK::Request>& req,
-                              const std::shared_ptr<moveit_msgs::srv::GetPositionFK::Response>& res) {
+      FK_SERVICE_NAME,
+      [this](const std::shared_ptr<rmw_request_id_t>& req_header,
+             const std::shared_ptr<moveit_msgs::srv::GetPositionFK::Request>& req,
+             const std::shared_ptr<moveit_msgs::srv::GetPositionFK::Response>& res) {
         return computeFKService(req_header, req, res);
-      });
+      },
+      rmw_qos_profile_services_default, callback_group_);
   ik_service_ = context_->moveit_cpp_->getNode()->create_service<moveit_msgs::srv::GetPositionIK>(
-      IK_SERVICE_NAME, [this](const std::shared_ptr<rmw_request_id_t>& req_header,
-                              const std::shared_ptr<moveit_msgs::srv::GetPositionIK::Request>& req,
-                              const std::shared_ptr<moveit_msgs::srv::GetPositionIK::Response>& res) {
+      IK_SERVICE_NAME,
+      [this](const std::shared_ptr<rmw_request_id_t>& req_header,
+             const std::shared_ptr<moveit_msgs::srv::GetPositionIK::Request>& req,
+             const std::shared_ptr<moveit_msgs::srv::GetPositionIK::Response>& res) {
         return computeIKService(req_header, req, res);
-      });
+      },
+      rmw_qos_profile_services_default, callback_group_);
 }
 
 namespace
@@ -76,7 +82,7 @@ bool isIKSolutionValid(const planning_scene::PlanningScene* planning_scene,
   state->setJointGroupPositions(jmg, ik_solution);
   state->update();
   return (!planning_scene || !planning_scene->isStateColliding(*state, jmg->getName())) &&
-         (!constraint_set || constraint_set->decide(*state).satisfied);
+         (!constraint_set || constraint_set->isSatisfied(*state));
 }
 }  // namespace
 
@@ -94,6 +100,12 @@ void MoveGroupKinematicsService::computeIK(moveit_msgs::msg::PositionIKRequest&
     }
     const std::string& default_frame = context_->planning_scene_monitor_->getRobotModel()->getModelFrame();
 
+    // The solver instance is shared by all requests for this group
+    std::unique_lock<std::mutex> solver_lock(ik_solver_mutex_, std::defer_lock);
+    const kinematics::KinematicsBaseConstPtr solver = jmg->getSolverInstance();
+    if (!solver || !solver->supportsConcurrentQueries())
+      solver_lock.lock();
+
     if (req.pose_stamped_vector.empty() || req.pose_stamped_vector.size() == 1)
     {
       geometry_msgs::msg::PoseStamped req_pose =
@@ -175,7 +187,7 @@ bool MoveGroupKinematicsService::computeIKService(const std::shared_ptr<rmw_requ
   // check if the planning scene needs to be kept locked; if so, call computeIK() in the scope of the lock
   if (req->ik_request.avoid_collisions || !moveit::core::isEmpty(req->ik_request.constraints))
   {
-    planning_scene_monitor::LockedPlanningSceneRO ls(context_->planning_scene_monitor_);
+    planning_scene_monitor::LockedPlanningSceneRO ls(context_->planning_scene_monitor_, "kinematics_service");
     kinematic_constraints::KinematicConstraintSet kset(ls->getRobotModel());
     moveit::core::RobotState rs = ls->getCurrentState();
     kset.add(req->ik_request.constraints, ls->getTransforms());
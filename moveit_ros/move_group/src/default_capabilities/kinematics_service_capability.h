@@ -40,6 +40,8 @@
 #include <moveit_msgs/srv/get_position_ik.hpp>
 #include <moveit_msgs/srv/get_position_fk.hpp>
 
+#include <mutex>
+
 namespace move_group
 {
 class MoveGroupKinematicsService : public MoveGroupCapability
@@ -62,7 +64,12 @@ private:
                  const moveit::core::GroupStateValidityCallbackFn& constraint =
                      moveit::core::GroupStateValidityCallbackFn()) const;
 
+  /// Lets the multi-threaded executor answer several FK and IK requests at the same time
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
   rclcpp::Service<moveit_msgs::srv::GetPositionFK>::SharedPtr fk_service_;
   rclcpp::Service<moveit_msgs::srv::GetPositionIK>::SharedPtr ik_service_;
+
+  /// Serializes IK queries for solvers that do not support concurrent queries
+  mutable std::mutex ik_solver_mutex_;
 };
 }  // namespace move_group
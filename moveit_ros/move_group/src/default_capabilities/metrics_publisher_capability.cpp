@@ -0,0 +1,269 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include "metrics_publisher_capability.h"
+
+#include <moveit/moveit_cpp/moveit_cpp.h>
+#include <moveit/move_group/capability_names.h>
+#include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit/trajectory_execution_manager/trajectory_execution_manager.h>
+#include <moveit/utils/memory_usage.h>
+#include <fmt/format.h>
+
+namespace move_group
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_move_group_default_capabilities.metrics_publisher_capability");
+
+void addValue(diagnostic_msgs::msg::DiagnosticStatus& status, const std::string& key, double value)
+{
+  diagnostic_msgs::msg::KeyValue key_value;
+  key_value.key = key;
+  key_value.value = fmt::format("{}", value);
+  status.values.push_back(key_value);
+}
+
+void addRate(diagnostic_msgs::msg::DiagnosticStatus& status, const std::string& key, std::uint64_t events,
+             double period)
+{
+  addValue(status, key, period > 0.0 ? events / period : 0.0);
+}
+
+// latencies are reported in seconds
+void addLatency(diagnostic_msgs::msg::DiagnosticStatus& status, const std::string& prefix,
+                const moveit::metrics::LatencyHistogram::Snapshot& window, double period)
+{
+  addRate(status, prefix + "_per_second", window.count, period);
+  addValue(status, prefix + "_mean", window.count > 0 ? window.sum / window.count : 0.0);
+  for (const auto& [suffix, q] :
+       { std::make_pair("_p50", 0.5), std::make_pair("_p90", 0.9), std::make_pair("_p99", 0.99) })
+    addValue(status, prefix + suffix, window.quantile(q));
+}
+
+diagnostic_msgs::msg::DiagnosticStatus makeStatus(const std::string& name)
+{
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.name = name;
+  return status;
+}
+}  // namespace
+
+MetricsPublisher::MetricsPublisher()
+  : MoveGroupCapability("MetricsPublisher")
+  , rate_(1.0)
+  , keep_running_(false)
+  , previous_collision_checks_(0)
+  , previous_scene_updates_(0)
+{
+}
+
+MetricsPublisher::~MetricsPublisher()
+{
+  keep_running_ = false;
+  if (thread_.joinable())
+    thread_.join();
+}
+
+diagnostic_msgs::msg::DiagnosticArray MetricsPublisher::collectMetrics()
+{
+  const auto now = std::chrono::steady_clock::now();
+  const double period = std::chrono::duration<double>(now - previous_time_).count();
+  previous_time_ = now;
+
+  diagnostic_msgs::msg::DiagnosticArray metrics;
+  metrics.header.stamp = context_->moveit_cpp_->getNode()->get_clock()->now();
+
+  for (const auto& [pipeline_name, pipeline] : context_->moveit_cpp_->getPlanningPipelines())
+  {
+    for (const auto& [planner_id, latency] : pipeline->getPlanningLatencies())
+    {
+      const std::string name = "planning/" + pipeline_name + "/" + (planner_id.empty() ? "default" : planner_id);
+      diagnostic_msgs::msg::DiagnosticStatus status = makeStatus(name);
+      status.hardware_id = pipeline_name;
+      addValue(status, "plans_total", latency.count);
+      addLatency(status, "plans", latency - previous_planning_latencies_[name], period);
+      previous_planning_latencies_[name] = latency;
+      metrics.status.push_back(status);
+    }
+  }
+
+  {
+    const std::uint64_t collision_checks = planning_scene::PlanningScene::getCollisionCheckCount();
+    diagnostic_msgs::msg::DiagnosticStatus status = makeStatus("collision_checking");
+    addValue(status, "checks_total", collision_checks);
+    addRate(status, "checks_per_second", collision_checks - previous_collision_checks_, period);
+    previous_collision_checks_ = collision_checks;
+    metrics.status.push_back(status);
+  }
+
+  if (context_->planning_scene_monitor_)
+  {
+    const planning_scene_monitor::PlanningSceneMonitor::Metrics& monitor_metrics =
+        context_->planning_scene_monitor_->getMetrics();
+    diagnostic_msgs::msg::DiagnosticStatus status = makeStatus("planning_scene_monitor");
+    status.hardware_id = context_->planning_scene_monitor_->getName();
+
+    const std::uint64_t scene_updates = monitor_metrics.scene_updates.value();
+    addValue(status, "scene_updates_total", scene_updates);
+    addRate(status, "scene_updates_per_second", scene_updates - previous_scene_updates_, period);
+    previous_scene_updates_ = scene_updates;
+
+    const moveit::metrics::LatencyHistogram::Snapshot lock_wait = monitor_metrics.lock_wait.snapshot();
+    addLatency(status, "lock_wait", lock_wait - previous_lock_wait_, period);
+    previous_lock_wait_ = lock_wait;
+
+    const moveit::metrics::LatencyHistogram::Snapshot octree_lock_wait = monitor_metrics.octree_lock_wait.snapshot();
+    addLatency(status, "octree_lock_wait", octree_lock_wait - previous_octree_lock_wait_, period);
+    previous_octree_lock_wait_ = octree_lock_wait;
+
+    const moveit::metrics::LatencyHistogram::Snapshot octomap_update = monitor_metrics.octomap_update.snapshot();
+    addLatency(status, "octomap_updates", octomap_update - previous_octomap_update_, period);
+    previous_octomap_update_ = octomap_update;
+    metrics.status.push_back(status);
+
+    for (const auto& [tag, lock_statistics] : context_->planning_scene_monitor_->getLockStatistics())
+    {
+      diagnostic_msgs::msg::DiagnosticStatus lock_status = makeStatus("planning_scene_lock/" + tag);
+      lock_status.hardware_id = status.hardware_id;
+      const auto& previous = previous_lock_statistics_[tag];
+      addLatency(lock_status, "read_wait", lock_statistics.read_wait - previous.read_wait, period);
+      addLatency(lock_status, "read_hold", lock_statistics.read_hold - previous.read_hold, period);
+      addLatency(lock_status, "write_wait", lock_statistics.write_wait - previous.write_wait, period);
+      addLatency(lock_status, "write_hold", lock_statistics.write_hold - previous.write_hold, period);
+      previous_lock_statistics_[tag] = lock_statistics;
+      metrics.status.push_back(lock_status);
+    }
+
+    moveit::core::MemoryUsage memory_usage;
+    {
+      planning_scene_monitor::LockedPlanningSceneRO scene(context_->planning_scene_monitor_, "metrics");
+      scene->getMemoryUsage(memory_usage);
+    }
+    diagnostic_msgs::msg::DiagnosticStatus memory_status = makeStatus("memory/planning_scene");
+    memory_status.hardware_id = status.hardware_id;
+    addValue(memory_status, "total_bytes", memory_usage.getTotal());
+    for (const auto& [category, bytes] : memory_usage.getCategories())
+      addValue(memory_status, category + "_bytes", bytes);
+    metrics.status.push_back(memory_status);
+  }
+
+  if (context_->trajectory_execution_manager_)
+  {
+    diagnostic_msgs::msg::DiagnosticStatus status = makeStatus("trajectory_execution");
+    const moveit::metrics::LatencyHistogram::Snapshot execution_start =
+        context_->trajectory_execution_manager_->getExecutionStartLatency().snapshot();
+    addValue(status, "execution_starts_total", execution_start.count);
+    addLatency(status, "execution_starts", execution_start - previous_execution_start_, period);
+    previous_execution_start_ = execution_start;
+    metrics.status.push_back(status);
+  }
+
+  return metrics;
+}
+
+void MetricsPublisher::getSceneLockStatistics(const std::shared_ptr<std_srvs::srv::Trigger::Request>& /*req*/,
+                                              const std::shared_ptr<std_srvs::srv::Trigger::Response>& res)
+{
+  if (!context_->planning_scene_monitor_)
+  {
+    res->success = false;
+    res->message = "No planning scene monitor";
+    return;
+  }
+
+  // cumulative since startup, in milliseconds
+  std::string table = fmt::format("{:<40} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "tag", "mode", "count",
+                                  "wait p50", "wait p99", "hold p50", "hold p99");
+  const auto add_row = [&table](const std::string& tag, const char* mode,
+                                const moveit::metrics::LatencyHistogram::Snapshot& wait,
+                                const moveit::metrics::LatencyHistogram::Snapshot& hold) {
+    if (wait.count == 0)
+      return;
+    table += fmt::format("{:<40} {:>10} {:>10} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}\n", tag, mode, wait.count,
+                         1e3 * wait.quantile(0.5), 1e3 * wait.quantile(0.99), 1e3 * hold.quantile(0.5),
+                         1e3 * hold.quantile(0.99));
+  };
+  for (const auto& [tag, lock_statistics] : context_->planning_scene_monitor_->getLockStatistics())
+  {
+    add_row(tag, "read", lock_statistics.read_wait, lock_statistics.read_hold);
+    add_row(tag, "write", lock_statistics.write_wait, lock_statistics.write_hold);
+  }
+  res->success = true;
+  res->message = table;
+}
+
+void MetricsPublisher::publishMetrics()
+{
+  rclcpp::Rate rate(rate_);
+  while (keep_running_)
+  {
+    rate.sleep();
+    metrics_publisher_->publish(collectMetrics());
+  }
+}
+
+void MetricsPublisher::initialize()
+{
+  context_->moveit_cpp_->getNode()->get_parameter_or("metrics_publishing_rate", rate_, 1.0);
+  if (rate_ <= 0.0)
+  {
+    RCLCPP_ERROR(LOGGER, "metrics_publishing_rate must be positive, not publishing metrics");
+    return;
+  }
+
+  metrics_publisher_ = context_->moveit_cpp_->getNode()->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+      METRICS_TOPIC_NAME, rclcpp::SystemDefaultsQoS());
+  scene_lock_statistics_service_ = context_->moveit_cpp_->getNode()->create_service<std_srvs::srv::Trigger>(
+      SCENE_LOCK_STATISTICS_SERVICE_NAME,
+      [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>& req,
+             const std::shared_ptr<std_srvs::srv::Trigger::Response>& res) { getSceneLockStatistics(req, res); });
+
+  // start the first period now, so the first rates do not include everything since startup
+  previous_time_ = std::chrono::steady_clock::now();
+  collectMetrics();
+
+  keep_running_ = true;
+  RCLCPP_INFO(LOGGER, "Publishing move_group metrics at %g Hz", rate_);
+  thread_ = std::thread(&MetricsPublisher::publishMetrics, this);
+}
+}  // namespace move_group
+
+#include <pluginlib/class_list_macros.hpp>
+
+PLUGINLIB_EXPORT_CLASS(move_group::MetricsPublisher, move_group::MoveGroupCapability)
@@ -0,0 +1,91 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/move_group/move_group_capability.h>
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit/utils/metrics.h>
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <std_srvs/srv/trigger.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+
+namespace move_group
+{
+/** \brief Periodically publishes runtime statistics of move_group as a diagnostic_msgs/DiagnosticArray.
+
+    Reported are the planning latency per pipeline and planner, the collision checking rate, the scene update rate,
+    scene lock wait and octomap update times of the planning scene monitor, the approximate memory held by the
+    monitored planning scene, and the time it takes to start trajectory execution. Rates and latency percentiles cover
+    the last publishing period, totals are cumulative. The wait and hold times of the planning scene lock are reported
+    per caller tag, and can also be queried as a table with cumulative statistics through a std_srvs/Trigger
+    service. */
+class MetricsPublisher : public MoveGroupCapability
+{
+public:
+  MetricsPublisher();
+  ~MetricsPublisher() override;
+
+  void initialize() override;
+
+private:
+  void publishMetrics();
+  diagnostic_msgs::msg::DiagnosticArray collectMetrics();
+  void getSceneLockStatistics(const std::shared_ptr<std_srvs::srv::Trigger::Request>& req,
+                              const std::shared_ptr<std_srvs::srv::Trigger::Response>& res);
+
+  double rate_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr metrics_publisher_;
+  rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr scene_lock_statistics_service_;
+  std::thread thread_;
+  std::atomic<bool> keep_running_;
+
+  // readings of the previous period, subtracted from the current ones
+  std::chrono::steady_clock::time_point previous_time_;
+  std::map<std::string, moveit::metrics::LatencyHistogram::Snapshot> previous_planning_latencies_;
+  std::uint64_t previous_collision_checks_;
+  std::uint64_t previous_scene_updates_;
+  moveit::metrics::LatencyHistogram::Snapshot previous_lock_wait_;
+  moveit::metrics::LatencyHistogram::Snapshot previous_octree_lock_wait_;
+  moveit::metrics::LatencyHistogram::Snapshot previous_octomap_update_;
+  std::map<std::string, planning_scene_monitor::PlanningSceneMonitor::LockStatisticsSnapshot> previous_lock_statistics_;
+  moveit::metrics::LatencyHistogram::Snapshot previous_execution_start_;
+};
+}  // namespace move_group
@@ -134,7 +134,7 @@ void MoveGroupMoveAction::executeMoveCallbackPlanAndExecute(const std::shared_pt
 
   if (moveit::core::isEmpty(goal->get_goal()->planning_options.planning_scene_diff))
   {
-    planning_scene_monitor::LockedPlanningSceneRO lscene(context_->planning_scene_monitor_);
+    planning_scene_monitor::LockedPlanningSceneRO lscene(context_->planning_scene_monitor_, "move_action");
     const moveit::core::RobotState& current_state = lscene->getCurrentState();
 
     // check to see if the desired constraints are already met
@@ -192,7 +192,7 @@ void MoveGroupMoveAction::executeMoveCallbackPlanOnly(const std::shared_ptr<MGAc
   RCLCPP_INFO(LOGGER, "Planning request received for MoveGroup action. Forwarding to planning pipeline.");
 
   // lock the scene so that it does not modify the world representation while diff() is called
-  planning_scene_monitor::LockedPlanningSceneRO lscene(context_->planning_scene_monitor_);
+  planning_scene_monitor::LockedPlanningSceneRO lscene(context_->planning_scene_monitor_, "move_action");
   const planning_scene::PlanningSceneConstPtr& the_scene =
       (moveit::core::isEmpty(goal->get_goal()->planning_options.planning_scene_diff)) ?
           static_cast<const planning_scene::PlanningSceneConstPtr&>(lscene) :
@@ -251,7 +251,7 @@ bool MoveGroupMoveAction::planUsingPlanningPipeline(const planning_interface::Mo
     return solved;
   }
 
-  planning_scene_monitor::LockedPlanningSceneRO lscene(plan.planning_scene_monitor);
+  planning_scene_monitor::LockedPlanningSceneRO lscene(plan.planning_scene_monitor, "move_action");
   try
   {
     solved = planning_pipeline->generatePlan(plan.planning_scene, req, res, context_->debug_, CHECK_SOLUTION_PATHS,
@@ -82,7 +82,7 @@ bool MoveGroupPlanService::computePlanService(const std::shared_ptr<rmw_request_
     return true;
   }
 
-  planning_scene_monitor::LockedPlanningSceneRO ps(context_->planning_scene_monitor_);
+  planning_scene_monitor::LockedPlanningSceneRO ps(context_->planning_scene_monitor_, "plan_service");
   try
   {
     planning_interface::MotionPlanResponse mp_res;
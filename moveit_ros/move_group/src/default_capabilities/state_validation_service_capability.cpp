@@ -62,7 +62,7 @@ bool MoveGroupStateValidationService::computeService(
     const std::shared_ptr<moveit_msgs::srv::GetStateValidity::Request>& req,
     const std::shared_ptr<moveit_msgs::srv::GetStateValidity::Response>& res)
 {
-  planning_scene_monitor::LockedPlanningSceneRO ls(context_->planning_scene_monitor_);
+  planning_scene_monitor::LockedPlanningSceneRO ls(context_->planning_scene_monitor_, "state_validation_service");
   moveit::core::RobotState rs = ls->getCurrentState();
   moveit::core::robotStateMsgToRobotState(req->robot_state, rs);
 
@@ -85,7 +85,8 @@ void TfPublisher::publishPlanningSceneFrames()
   {
     {
       rclcpp::Time stamp = context_->moveit_cpp_->getNode()->get_clock()->now();
-      planning_scene_monitor::LockedPlanningSceneRO locked_planning_scene(context_->planning_scene_monitor_);
+      planning_scene_monitor::LockedPlanningSceneRO locked_planning_scene(context_->planning_scene_monitor_,
+                                                                          "tf_publisher");
       collision_detection::WorldConstPtr world = locked_planning_scene->getWorld();
       std::string planning_frame = locked_planning_scene->getPlanningFrame();
 
@@ -71,10 +71,14 @@ move_group::MoveGroupContext::MoveGroupContext(const moveit_cpp::MoveItCppPtr& m
     plan_execution_ = std::make_shared<plan_execution::PlanExecution>(moveit_cpp_->getNode(), planning_scene_monitor_,
                                                                       trajectory_execution_manager_);
   }
+
+  // let nodes in this process use the scene and pipelines of move_group without going through messages
+  moveit_cpp::MoveItCpp::registerInstance(moveit_cpp_->getNode()->get_fully_qualified_name(), moveit_cpp_);
 }
 
 move_group::MoveGroupContext::~MoveGroupContext()
 {
+  moveit_cpp::MoveItCpp::unregisterInstance(moveit_cpp_->getNode()->get_fully_qualified_name(), moveit_cpp_.get());
   plan_execution_.reset();
   trajectory_execution_manager_.reset();
   planning_pipeline_.reset();
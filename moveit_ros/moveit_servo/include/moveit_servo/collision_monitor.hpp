@@ -42,8 +42,13 @@
 #pragma once
 
 #include <moveit_servo_lib_parameters.hpp>
+#include <moveit/collision_distance_field/collision_distance_field_types.h>
+#include <moveit/distance_field/propagation_distance_field.h>
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 
 namespace moveit_servo
 {
@@ -58,12 +63,60 @@ public:
 
   void stop();
 
+  /**
+   * \brief Sets the joint velocities of the move group that servo is commanding.
+   * They are used to predict the state that is checked, and wake up the monitor when checking on updates.
+   * @param velocities The commanded joint velocities, before collision scaling.
+   */
+  void updateCommandedVelocities(const Eigen::VectorXd& velocities);
+
+  /**
+   * \brief Computes the velocity scaling for collisions with the scene from the scene distance field.
+   * Used by servo on every cycle if the scene_distance_field parameter is set, the monitor thread then only checks
+   * self collisions. The distance and gradient of the field are looked up at the collision spheres of the move group
+   * links, and only spheres that the commanded motion moves towards the scene slow the robot down.
+   * Returns 1 until the monitor thread built the first distance field.
+   * @param robot_state The current robot state.
+   * @param joint_position_delta The joint position change of the move group servo is about to command.
+   * @return The velocity scaling factor.
+   */
+  double sceneCollisionVelocityScale(moveit::core::RobotState& robot_state,
+                                     const Eigen::VectorXd& joint_position_delta);
+
 private:
   /**
    * \brief The collision checking function, this will run in a separate thread.
    */
   void checkCollisions();
 
+  /**
+   * \brief Blocks until the robot state, the planning scene or the command changed, or a stop is requested.
+   * @return True if the state to check needs to be updated.
+   */
+  bool waitForUpdate();
+
+  /**
+   * \brief Updates the collision velocity scaling for the latest robot state, moved along the commanded velocities.
+   */
+  void updateCollisionVelocityScale();
+
+  /**
+   * \brief Builds the scene distance field from the objects of a world and swaps it in for servo.
+   * @param world A copy of the world of the planning scene, so the field is built without locking the scene.
+   */
+  void updateSceneDistanceField(const collision_detection::World& world);
+
+  // Wakes up the monitor thread when checking on updates. It is shared with the state and scene update callbacks,
+  // which cannot be removed from the planning scene monitor and may outlive the collision monitor.
+  struct UpdateSignal
+  {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool state_updated = false;
+    bool scene_updated = false;
+    bool command_updated = false;
+  };
+
   // Variables
 
   const servo::Params& servo_params_;
@@ -84,6 +137,31 @@ private:
   // The data structures used to get information about robot collision with other objects in the collision scene.
   collision_detection::CollisionRequest scene_collision_request_;
   collision_detection::CollisionResult scene_collision_result_;
+  // Whether the last cycle ran out of the collision check budget, to only warn when it starts to.
+  bool budget_exceeded_ = false;
+
+  // Signals updates to the monitor thread when checking on updates.
+  std::shared_ptr<UpdateSignal> update_signal_;
+  const moveit::core::JointModelGroup* joint_model_group_;
+  // The commanded velocities are written by servo, guarded by the update signal mutex.
+  Eigen::VectorXd commanded_velocities_, checked_velocities_;
+  Eigen::VectorXd checked_positions_, predicted_positions_;
+
+  // The scene distance field, swapped by the monitor thread and read by servo, and the scene versions it shows.
+  std::shared_ptr<const distance_field::PropagationDistanceField> scene_distance_field_;
+  std::size_t distance_field_objects_version_ = 0;
+  std::size_t distance_field_octomap_version_ = 0;
+  // The collision spheres of the links moved by the move group, used by servo.
+  std::vector<const moveit::core::LinkModel*> sphere_links_;
+  std::vector<collision_detection::BodyDecompositionConstPtr> link_decompositions_;
+  double max_sphere_radius_ = 0.0;
+  // The state servo is about to command, used by servo.
+  moveit::core::RobotStatePtr lookahead_state_;
+  Eigen::VectorXd lookahead_positions_;
+  // The sphere centers at the current and the lookahead state, and the field lookups for them.
+  EigenSTL::vector_Vector3d sphere_centers_, lookahead_centers_, sphere_gradients_;
+  std::vector<double> sphere_radii_, sphere_distances_;
+  std::vector<unsigned char> sphere_in_bounds_;
 };
 
 }  // namespace moveit_servo
@@ -78,6 +78,35 @@ public:
    */
   KinematicState getNextJointState(const ServoInput& command);
 
+  /**
+   * \brief Computes the joint state required to follow the given command, reusing the storage of the given state.
+   * All working buffers are allocated for the move group when servo is created, so that once next_joint_state has
+   * been sized by a first call, joint jog commands and commands solved with the inverse Jacobian do not allocate.
+   * An IK solver plugin, or a TF lookup for a command frame outside the robot model, may still allocate.
+   * @param command The command to follow, std::variant type, can handle JointJog, Twist and Pose.
+   * @param next_joint_state The required joint state.
+   */
+  void getNextJointState(const ServoInput& command, KinematicState& next_joint_state);
+
+  /**
+   * \brief Computes the joint state required to follow commands for several subgroups of the move group at once,
+   * e.g. one twist command per arm of a dual arm move group. The commands share one update of the robot state, one
+   * collision check and one smoothing pass, and each command may be of any type, regardless of the command type set
+   * with setCommandType(). Subgroups should not share joints, the deltas of shared joints add up.
+   * If any command is invalid, the status is INVALID and the robot does not move.
+   * @param commands The commands to follow, one per subgroup.
+   * @return The required joint state of the move group.
+   */
+  KinematicState getNextJointState(const std::vector<SubgroupCommand>& commands);
+
+  /**
+   * \brief Computes the joint state required to follow commands for several subgroups of the move group at once,
+   * reusing the storage of the given state.
+   * @param commands The commands to follow, one per subgroup.
+   * @param next_joint_state The required joint state of the move group.
+   */
+  void getNextJointState(const std::vector<SubgroupCommand>& commands, KinematicState& next_joint_state);
+
   /**
    * \brief Set the type of incoming servo command.
    * @param command_type The type of command servo should expect.
@@ -162,12 +191,55 @@ private:
   /**
    * \brief Compute the change in joint position required to follow the received command.
    * @param command The incoming servo command.
-   * @return The joint position change required (delta).
+   * @param robot_state The current robot state.
+   * @param joint_position_delta The joint position change required (delta).
+   */
+  void jointDeltaFromCommand(const ServoInput& command, const moveit::core::RobotStatePtr& robot_state,
+                             Eigen::VectorXd& joint_position_delta);
+
+  /**
+   * \brief Compute the change in joint position required to follow a command of any type.
+   * @param command The incoming servo command.
+   * @param params The servo parameters, with the active subgroup the command is for.
+   * @param joint_name_group_index_map The mapping of the active subgroup joints to move group joints.
+   * @param joint_position_delta The joint position change required (delta).
+   * @return The status of the computation.
    */
-  Eigen::VectorXd jointDeltaFromCommand(const ServoInput& command, const moveit::core::RobotStatePtr& robot_state);
+  StatusCode jointDeltaFromInput(const ServoInput& command, const servo::Params& params,
+                                 const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                 Eigen::VectorXd& joint_position_delta);
 
   /**
-   * \brief Updates data depending on joint model group
+   * \brief Compute the change in joint position required to follow commands for several subgroups.
+   * @param commands The incoming servo commands, one per subgroup.
+   * @param joint_position_delta The joint position change of the move group required (delta).
+   */
+  void jointDeltaFromSubgroupCommands(const std::vector<SubgroupCommand>& commands,
+                                      Eigen::VectorXd& joint_position_delta);
+
+  /**
+   * \brief Get the parameters to compute the joint deltas of a subgroup with.
+   * They are the servo parameters with the subgroup active and its tip as end effector frame.
+   * @param group_name The name of the subgroup.
+   * @return The parameters, or nullptr if the group is not a subgroup of the move group.
+   */
+  const servo::Params* getSubgroupParams(const std::string& group_name);
+
+  /**
+   * \brief Starts a servo cycle: updates the parameters and the robot state, and sizes the target state.
+   * @param target_state The target state to size for the move group.
+   */
+  void beginCycle(KinematicState& target_state);
+
+  /**
+   * \brief Finishes a servo cycle: applies the collision scaling, smoothing and limits to the joint position delta
+   * computed for the cycle, and computes the target state from it.
+   * @param target_state The target state.
+   */
+  void finishCycle(KinematicState& target_state);
+
+  /**
+   * \brief Updates data depending on joint model group, and sizes the working buffers for it.
    */
   void updateJointModelGroup();
 
@@ -192,11 +264,10 @@ private:
    * \brief Apply halting logic to specified joints.
    * @param joints_to_halt The indices of joints to be halted.
    * @param current_state The current kinematic state.
-   * @param target_state The target kinematic state.
-   * @return The bounded kinematic state.
+   * @param target_state The target kinematic state, bounded in place.
    */
-  KinematicState haltJoints(const std::vector<int>& joints_to_halt, const KinematicState& current_state,
-                            const KinematicState& target_state) const;
+  void haltJoints(const std::vector<int>& joints_to_halt, const KinematicState& current_state,
+                  KinematicState& target_state) const;
 
   // Variables
 
@@ -217,6 +288,19 @@ private:
 
   // Map between joint subgroup names and corresponding joint name - move group indices map
   std::unordered_map<std::string, JointNameToMoveGroupIndexMap> joint_name_to_index_maps_;
+
+  // Working buffers of getNextJointState(), sized for the move group by updateJointModelGroup().
+  moveit::core::RobotStatePtr robot_state_;
+  const moveit::core::JointModelGroup* joint_model_group_ = nullptr;
+  moveit::core::JointBoundsVector joint_bounds_;
+  KinematicState current_state_;
+  Eigen::VectorXd joint_position_delta_, commanded_joint_velocities_, subgroup_joint_position_delta_;
+  std::vector<int> joints_to_halt_;
+  JointDeltaWorkspace joint_delta_workspace_;
+
+  // Parameters of the subgroups commanded through getNextJointState(const std::vector<SubgroupCommand>&, ...),
+  // rebuilt when the parameters change.
+  std::unordered_map<std::string, servo::Params> subgroup_params_;
 };
 
 }  // namespace moveit_servo
@@ -52,6 +52,7 @@
 #include <std_srvs/srv/set_bool.hpp>
 #include <trajectory_msgs/msg/joint_trajectory.hpp>
 #include <std_msgs/msg/float64_multi_array.hpp>
+#include <chrono>
 
 namespace moveit_servo
 {
@@ -80,6 +81,23 @@ private:
    */
   void servoLoop();
 
+  /**
+   * \brief Publish a command in the deadline loop, through a loaned message if the middleware supports loans,
+   * otherwise through a preallocated message.
+   */
+  void publishCommand(const KinematicState& joint_state);
+
+  /**
+   * \brief Sleep until the next deadline of the deadline loop and update the loop timing.
+   * Deadlines that already passed are skipped and counted as overruns.
+   */
+  void sleepUntilDeadline(std::chrono::steady_clock::time_point& deadline);
+
+  /**
+   * \brief Append the loop timing to a status message.
+   */
+  void appendLoopTiming(std::string& message) const;
+
   /**
    * \brief The service to pause servoing, this does not exit the loop or stop the servo loop thread.
    * The loop will be alive even after pausing, but no commands will be processed.
@@ -125,6 +143,24 @@ private:
   rclcpp::Service<moveit_msgs::srv::ServoCommandType>::SharedPtr switch_command_type_;
   rclcpp::Service<std_srvs::srv::SetBool>::SharedPtr pause_servo_;
 
+  // Preallocated outgoing messages of the deadline loop
+  trajectory_msgs::msg::JointTrajectory trajectory_msg_;
+  std_msgs::msg::Float64MultiArray multi_array_msg_;
+
+  // Timing of the deadline loop
+  struct LoopTiming
+  {
+    std::chrono::steady_clock::time_point cycle_start;
+    // Time the last cycle spent processing, from waking up until going to sleep
+    std::chrono::steady_clock::duration cycle_time{ 0 };
+    // How late the loop woke up after the last deadline, and the worst case so far
+    std::chrono::steady_clock::duration wakeup_latency{ 0 };
+    std::chrono::steady_clock::duration max_wakeup_latency{ 0 };
+    // Cycles that ran past the deadline of the next cycle
+    std::size_t overruns = 0;
+  };
+  LoopTiming loop_timing_;
+
   // Used for communication with thread
   std::atomic<bool> stop_servo_;
   std::atomic<bool> servo_paused_;
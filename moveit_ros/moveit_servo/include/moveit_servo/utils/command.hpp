@@ -62,6 +62,21 @@ JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const mo
                                         const servo::Params& servo_params,
                                         const JointNameToMoveGroupIndexMap& joint_name_group_index_map);
 
+/**
+ * \brief Compute the change in joint position for the given joint jog command, using preallocated buffers.
+ * @param command The joint jog command.
+ * @param robot_state_ The current robot state as obtained from PlanningSceneMonitor.
+ * @param servo_params The servo parameters.
+ * @param joint_name_group_index_map Mapping between joint subgroup name and move group joint vector position.
+ * @param workspace The working buffers reused between calls.
+ * @param joint_position_delta The joint position change required (delta).
+ * @return The status of the computation.
+ */
+StatusCode jointDeltaFromJointJog(const JointJogCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                                  const servo::Params& servo_params,
+                                  const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                  JointDeltaWorkspace& workspace, Eigen::VectorXd& joint_position_delta);
+
 /**
  * \brief Compute the change in joint position for the given twist command.
  * @param command The twist command.
@@ -74,6 +89,21 @@ JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::
                                      const servo::Params& servo_params,
                                      const JointNameToMoveGroupIndexMap& joint_name_group_index_map);
 
+/**
+ * \brief Compute the change in joint position for the given twist command, using preallocated buffers.
+ * @param command The twist command.
+ * @param robot_state_ The current robot state as obtained from PlanningSceneMonitor.
+ * @param servo_params The servo parameters.
+ * @param joint_name_group_index_map Mapping between joint subgroup name and move group joint vector position.
+ * @param workspace The working buffers reused between calls.
+ * @param joint_position_delta The joint position change required (delta).
+ * @return The status of the computation.
+ */
+StatusCode jointDeltaFromTwist(const TwistCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                               const servo::Params& servo_params,
+                               const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                               JointDeltaWorkspace& workspace, Eigen::VectorXd& joint_position_delta);
+
 /**
  * \brief Compute the change in joint position for the given pose command.
  * @param command The pose command.
@@ -86,6 +116,21 @@ JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::co
                                     const servo::Params& servo_params,
                                     const JointNameToMoveGroupIndexMap& joint_name_group_index_map);
 
+/**
+ * \brief Compute the change in joint position for the given pose command, using preallocated buffers.
+ * @param command The pose command.
+ * @param robot_state_ The current robot state as obtained from PlanningSceneMonitor.
+ * @param servo_params The servo parameters.
+ * @param joint_name_group_index_map Mapping between sub group joint name and move group joint vector position
+ * @param workspace The working buffers reused between calls.
+ * @param joint_position_delta The joint position change required (delta).
+ * @return The status of the computation.
+ */
+StatusCode jointDeltaFromPose(const PoseCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                              const servo::Params& servo_params,
+                              const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                              JointDeltaWorkspace& workspace, Eigen::VectorXd& joint_position_delta);
+
 /**
  * \brief Computes the required change in joint angles for given Cartesian change, using the robot's IK solver.
  * @param cartesian_position_delta The change in Cartesian position.
@@ -98,4 +143,20 @@ JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delt
                                   const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
                                   const JointNameToMoveGroupIndexMap& joint_name_group_index_map);
 
+/**
+ * \brief Computes the required change in joint angles for given Cartesian change, using preallocated buffers.
+ * The inverse Jacobian fallback does not allocate, but an IK solver plugin may allocate internally.
+ * @param cartesian_position_delta The change in Cartesian position.
+ * @param robot_state_ The current robot state as obtained from PlanningSceneMonitor.
+ * @param servo_params The servo parameters.
+ * @param joint_name_group_index_map Mapping between joint subgroup name and move group joint vector position.
+ * @param workspace The working buffers reused between calls.
+ * @param joint_position_delta The joint position change required (delta).
+ * @return The status of the computation.
+ */
+StatusCode jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delta,
+                            const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
+                            const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                            JointDeltaWorkspace& workspace, Eigen::VectorXd& joint_position_delta);
+
 }  // namespace moveit_servo
@@ -101,6 +101,16 @@ geometry_msgs::msg::Pose poseFromCartesianDelta(const Eigen::VectorXd& delta_x,
 trajectory_msgs::msg::JointTrajectory composeTrajectoryMessage(const servo::Params& servo_params,
                                                                const KinematicState& joint_state);
 
+/**
+ * \brief Fill a trajectory message with the given joint state, like composeTrajectoryMessage().
+ * The memory the message already holds is reused, so refilling a message of the same size does not allocate.
+ * @param servo_params The configuration used by servo, required for setting some field of the trajectory message.
+ * @param joint_state The joint state to be added into the trajectory.
+ * @param joint_trajectory The trajectory message to fill.
+ */
+void updateTrajectoryMessage(const servo::Params& servo_params, const KinematicState& joint_state,
+                             trajectory_msgs::msg::JointTrajectory& joint_trajectory);
+
 /**
  * \brief Create a Float64MultiArray message from given joint state
  * @param servo_params The configuration used by servo, required for selecting position vs velocity.
@@ -110,6 +120,16 @@ trajectory_msgs::msg::JointTrajectory composeTrajectoryMessage(const servo::Para
 std_msgs::msg::Float64MultiArray composeMultiArrayMessage(const servo::Params& servo_params,
                                                           const KinematicState& joint_state);
 
+/**
+ * \brief Fill a Float64MultiArray message with the given joint state, like composeMultiArrayMessage().
+ * The memory the message already holds is reused, so refilling a message of the same size does not allocate.
+ * @param servo_params The configuration used by servo, required for selecting position vs velocity.
+ * @param joint_state The joint state to be added into the Float64MultiArray.
+ * @param multi_array The Float64MultiArray message to fill.
+ */
+void updateMultiArrayMessage(const servo::Params& servo_params, const KinematicState& joint_state,
+                             std_msgs::msg::Float64MultiArray& multi_array);
+
 /**
  * \brief Computes scaling factor for velocity when the robot is near a singularity.
  * @param joint_model_group The joint model group of the robot, used for fetching the Jacobian.
@@ -122,6 +142,41 @@ std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::
                                                                   const Eigen::VectorXd& target_delta_x,
                                                                   const servo::Params& servo_params);
 
+/**
+ * \brief Computes scaling factor for velocity when the robot is near a singularity, using preallocated buffers.
+ * The Jacobian and its decomposition are reused while the move group does not move. The direction towards the
+ * singularity is taken from the previous call if it continues it, only otherwise a look ahead step is evaluated.
+ * @param robot_state The current state of the robot, used for singularity look ahead.
+ * @param target_delta_x The vector containing the required change in Cartesian position.
+ * @param servo_params The servo parameters, contains the singularity thresholds.
+ * @param workspace The buffers used for the Jacobian and its decomposition, kept between calls.
+ * @return The velocity scaling factor and the reason for scaling.
+ */
+std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::core::RobotStatePtr& robot_state,
+                                                                  const Eigen::VectorXd& target_delta_x,
+                                                                  const servo::Params& servo_params,
+                                                                  JointDeltaWorkspace& workspace);
+
+/**
+ * \brief Gets the Jacobian of the move group, only computing it if the group moved since it was last computed.
+ * @param robot_state The current state of the robot.
+ * @param servo_params The servo parameters, contains the move group name.
+ * @param workspace The buffers holding the cached Jacobian.
+ * @return The Jacobian of the move group at the current state.
+ */
+const Eigen::MatrixXd& moveGroupJacobian(const moveit::core::RobotStatePtr& robot_state,
+                                         const servo::Params& servo_params, JointDeltaWorkspace& workspace);
+
+/**
+ * \brief Multiplies a vector with the pseudo inverse of a decomposed matrix, without allocating temporaries.
+ * @param svd The decomposition of the matrix, with thin U and V computed.
+ * @param vector The vector to be multiplied.
+ * @param scratch Buffer for the intermediate product.
+ * @param result The product of the pseudo inverse and the vector.
+ */
+void pseudoInverseProduct(const Eigen::JacobiSVD<Eigen::MatrixXd>& svd, const Eigen::VectorXd& vector,
+                          Eigen::VectorXd& scratch, Eigen::VectorXd& result);
+
 /**
  * \brief Apply velocity scaling based on joint limits.
  * @param velocities The commanded velocities.
@@ -129,7 +184,7 @@ std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::
  * @param scaling_override The user defined velocity scaling override.
  * @return The velocity scaling factor.
  */
-double jointLimitVelocityScalingFactor(const Eigen::VectorXd& velocities,
+double jointLimitVelocityScalingFactor(const Eigen::Ref<const Eigen::VectorXd>& velocities,
                                        const moveit::core::JointBoundsVector& joint_bounds, double scaling_override);
 
 /**
@@ -140,9 +195,22 @@ double jointLimitVelocityScalingFactor(const Eigen::VectorXd& velocities,
  * @param margin Additional buffer on the actual joint limits.
  * @return The joints that are violating the specified position limits.
  */
-std::vector<int> jointsToHalt(const Eigen::VectorXd& positions, const Eigen::VectorXd& velocities,
+std::vector<int> jointsToHalt(const Eigen::Ref<const Eigen::VectorXd>& positions,
+                              const Eigen::Ref<const Eigen::VectorXd>& velocities,
                               const moveit::core::JointBoundsVector& joint_bounds, double margin);
 
+/**
+ * \brief Finds the joints that are exceeding allowable position limits, reusing the storage of the result.
+ * @param positions The joint positions.
+ * @param velocities The current commanded velocities.
+ * @param joint_bounds The allowable limits for the robot joints.
+ * @param margin Additional buffer on the actual joint limits.
+ * @param joints_to_halt The joints that are violating the specified position limits.
+ */
+void jointsToHalt(const Eigen::Ref<const Eigen::VectorXd>& positions,
+                  const Eigen::Ref<const Eigen::VectorXd>& velocities,
+                  const moveit::core::JointBoundsVector& joint_bounds, double margin, std::vector<int>& joints_to_halt);
+
 /**
  * \brief Helper function for converting Eigen::Isometry3d to geometry_msgs/TransformStamped.
  * @param eigen_tf The isometry to be converted to TransformStamped.
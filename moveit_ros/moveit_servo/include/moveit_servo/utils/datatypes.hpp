@@ -41,6 +41,9 @@
 
 #pragma once
 
+#include <Eigen/Eigenvalues>
+#include <Eigen/SVD>
+#include <algorithm>
 #include <string>
 #include <tf2_eigen/tf2_eigen.hpp>
 #include <unordered_map>
@@ -110,6 +113,14 @@ struct PoseCommand
 // The generic input type for servo that can be JointJog, Twist or Pose.
 typedef std::variant<JointJogCommand, TwistCommand, PoseCommand> ServoInput;
 
+// A command for one group servoed together with others, group_name is the move group or one of its subgroups.
+// Twist and pose commands move the tip of the group: the tip frame of its IK solver, or else its last link.
+struct SubgroupCommand
+{
+  std::string group_name;
+  ServoInput command;
+};
+
 // The output datatype of servo, this structure contains the names of the joints along with their positions, velocities and accelerations.
 struct KinematicState
 {
@@ -132,4 +143,52 @@ struct KinematicState
 // Mapping joint names and their position in the move group vector
 typedef std::unordered_map<std::string, std::size_t> JointNameToMoveGroupIndexMap;
 
+// Working buffers used while computing joint position deltas. Servo sizes them for its move group on construction, so
+// that the steady state servo loop does not allocate. Buffers are only resized if the group they are used for changes.
+// The move group Jacobian and the singularity analysis are cached between cycles, so a workspace should only be used
+// with a single robot model and move group.
+struct JointDeltaWorkspace
+{
+  Eigen::VectorXd cartesian_delta, joint_velocities, sub_group_delta, joint_positions, svd_scratch;
+
+  // The Jacobian of the move group, and the move group joint positions it was computed for.
+  Eigen::MatrixXd jacobian;
+  Eigen::VectorXd jacobian_positions;
+  bool jacobian_valid = false;
+
+  // The eigen decomposition of jacobian * jacobian^T. Its eigenvalues are the squared singular values of the Jacobian,
+  // and its eigenvectors the left singular vectors.
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6>> singularity_solver;
+  bool singularity_solver_valid = false;
+
+  // The direction towards the singularity found in the previous cycle, it resolves the sign of the next one.
+  Eigen::Vector<double, 6> singular_vector;
+  bool singular_vector_valid = false;
+
+  // Buffers for the singularity look ahead, and for the inverse Jacobian of subgroups.
+  Eigen::MatrixXd lookahead_jacobian, ik_jacobian;
+  Eigen::JacobiSVD<Eigen::MatrixXd> ik_svd;
+  std::vector<double> ik_seed, ik_solution;
+
+  JointDeltaWorkspace(const int num_joints)
+    : cartesian_delta(6)
+    , joint_velocities(num_joints)
+    , sub_group_delta(num_joints)
+    , joint_positions(num_joints)
+    , svd_scratch(std::min(6, num_joints))
+    , jacobian(6, num_joints)
+    , jacobian_positions(num_joints)
+    , lookahead_jacobian(6, num_joints)
+    , ik_jacobian(6, num_joints)
+    , ik_svd(6, num_joints, Eigen::ComputeThinU | Eigen::ComputeThinV)
+  {
+    ik_seed.reserve(num_joints);
+    ik_solution.reserve(num_joints);
+  }
+
+  JointDeltaWorkspace()
+  {
+  }
+};
+
 }  // namespace moveit_servo
@@ -38,12 +38,17 @@
  */
 
 #include <moveit_servo/collision_monitor.hpp>
+#include <moveit/utils/thread_placement.h>
 #include <rclcpp/rclcpp.hpp>
 
 namespace
 {
 const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_servo.servo");
-}
+// The largest joint position change [rad or m] for which the robot is considered not to have moved between checks.
+constexpr double STATE_CHANGE_EPS = 1e-6;
+// How long the monitor waits for an update before checking whether it should still run.
+constexpr std::chrono::milliseconds UPDATE_WAIT_TIMEOUT(100);
+}  // namespace
 
 namespace moveit_servo
 {
@@ -53,12 +58,73 @@ CollisionMonitor::CollisionMonitor(const planning_scene_monitor::PlanningSceneMo
   : servo_params_(servo_params)
   , planning_scene_monitor_(planning_scene_monitor)
   , collision_velocity_scale_(collision_velocity_scale)
+  , update_signal_(std::make_shared<UpdateSignal>())
 {
+  robot_state_ = planning_scene_monitor_->getStateMonitor()->getCurrentState();
+  joint_model_group_ = robot_state_->getJointModelGroup(servo_params_.move_group_name);
+
+  const int num_joints = joint_model_group_->getActiveJointModelNames().size();
+  commanded_velocities_ = Eigen::VectorXd::Zero(num_joints);
+  checked_velocities_ = Eigen::VectorXd::Zero(num_joints);
+  predicted_positions_ = Eigen::VectorXd::Zero(joint_model_group_->getVariableCount());
+  checked_positions_ = Eigen::VectorXd::Zero(robot_state_->getVariableCount());
+
+  if (servo_params_.scene_distance_field)
+  {
+    for (const moveit::core::LinkModel* link : joint_model_group_->getUpdatedLinkModelsWithGeometry())
+    {
+      auto decomposition = std::make_shared<const collision_detection::BodyDecomposition>(
+          link->getShapes(), link->getCollisionOriginTransforms(), servo_params_.distance_field_resolution, 0.0);
+      for (const collision_detection::CollisionSphere& sphere : decomposition->getCollisionSpheres())
+      {
+        sphere_radii_.push_back(sphere.radius_);
+        max_sphere_radius_ = std::max(max_sphere_radius_, sphere.radius_);
+      }
+      sphere_links_.push_back(link);
+      link_decompositions_.push_back(std::move(decomposition));
+    }
+    sphere_centers_.resize(sphere_radii_.size());
+    lookahead_centers_.resize(sphere_radii_.size());
+    lookahead_state_ = std::make_shared<moveit::core::RobotState>(*robot_state_);
+    lookahead_positions_ = Eigen::VectorXd::Zero(joint_model_group_->getVariableCount());
+  }
+
+  // Wake up the monitor thread on new robot states and scene changes. State changes of the scene are left out, they
+  // are already signaled by the state monitor.
+  const std::weak_ptr<UpdateSignal> weak_signal = update_signal_;
+  planning_scene_monitor_->getStateMonitor()->addUpdateCallback(
+      [weak_signal](const sensor_msgs::msg::JointState::ConstSharedPtr& /* joint_state */) {
+        if (const std::shared_ptr<UpdateSignal> signal = weak_signal.lock())
+        {
+          {
+            std::lock_guard<std::mutex> lock(signal->mutex);
+            signal->state_updated = true;
+          }
+          signal->condition.notify_one();
+        }
+      });
+  planning_scene_monitor_->addUpdateCallback(
+      [weak_signal](planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType update_type) {
+        const std::shared_ptr<UpdateSignal> signal = weak_signal.lock();
+        if (signal && (update_type & ~planning_scene_monitor::PlanningSceneMonitor::UPDATE_STATE))
+        {
+          {
+            std::lock_guard<std::mutex> lock(signal->mutex);
+            signal->scene_updated = true;
+          }
+          signal->condition.notify_one();
+        }
+      });
 }
 
 void CollisionMonitor::start()
 {
-  stop_requested_ = false;
+  {
+    // Check the scene once when starting, also if collisions are only checked on updates.
+    std::lock_guard<std::mutex> lock(update_signal_->mutex);
+    stop_requested_ = false;
+    update_signal_->scene_updated = true;
+  }
   if (!monitor_thread_.joinable())
   {
     monitor_thread_ = std::thread(&CollisionMonitor::checkCollisions, this);
@@ -72,7 +138,11 @@ void CollisionMonitor::start()
 
 void CollisionMonitor::stop()
 {
-  stop_requested_ = true;
+  {
+    std::lock_guard<std::mutex> lock(update_signal_->mutex);
+    stop_requested_ = true;
+  }
+  update_signal_->condition.notify_all();
   if (monitor_thread_.joinable())
   {
     monitor_thread_.join();
@@ -80,80 +150,281 @@ void CollisionMonitor::stop()
   RCLCPP_INFO_STREAM(LOGGER, "Collision monitor stopped");
 }
 
+void CollisionMonitor::updateCommandedVelocities(const Eigen::VectorXd& velocities)
+{
+  {
+    std::lock_guard<std::mutex> lock(update_signal_->mutex);
+    if (velocities.size() == commanded_velocities_.size() && velocities == commanded_velocities_)
+    {
+      return;
+    }
+    commanded_velocities_ = velocities;
+    update_signal_->command_updated = true;
+  }
+  update_signal_->condition.notify_one();
+}
+
 void CollisionMonitor::checkCollisions()
 {
+  moveit::core::configureCurrentThread(moveit::core::thread_roles::SERVO, "servo_collision");
   rclcpp::WallRate rate(servo_params_.collision_check_rate);
 
+  while (rclcpp::ok() && !stop_requested_)
+  {
+    if (!servo_params_.collision_check_on_update)
+    {
+      {
+        std::lock_guard<std::mutex> lock(update_signal_->mutex);
+        checked_velocities_ = commanded_velocities_;
+        update_signal_->state_updated = update_signal_->scene_updated = update_signal_->command_updated = false;
+      }
+      updateCollisionVelocityScale();
+    }
+    else if (waitForUpdate())
+    {
+      // The rate still bounds how often collisions are checked, as updates may arrive much faster.
+      updateCollisionVelocityScale();
+    }
+    else
+    {
+      continue;
+    }
+    rate.sleep();
+  }
+}
+
+bool CollisionMonitor::waitForUpdate()
+{
+  bool state_updated, scene_or_command_updated;
+  {
+    std::unique_lock<std::mutex> lock(update_signal_->mutex);
+    update_signal_->condition.wait_for(lock, UPDATE_WAIT_TIMEOUT, [this] {
+      return stop_requested_ || update_signal_->state_updated || update_signal_->scene_updated ||
+             update_signal_->command_updated;
+    });
+    state_updated = update_signal_->state_updated;
+    scene_or_command_updated = update_signal_->scene_updated || update_signal_->command_updated;
+    update_signal_->state_updated = update_signal_->scene_updated = update_signal_->command_updated = false;
+    checked_velocities_ = commanded_velocities_;
+  }
+
+  if (stop_requested_ || !(state_updated || scene_or_command_updated))
+  {
+    return false;
+  }
+  if (scene_or_command_updated)
+  {
+    return true;
+  }
+
+  // Joint states keep being published while the robot is stationary, only check the state again if it moved.
+  planning_scene_monitor_->getStateMonitor()->setToCurrentState(*robot_state_);
+  const Eigen::Map<const Eigen::VectorXd> positions(robot_state_->getVariablePositions(),
+                                                    robot_state_->getVariableCount());
+  return (positions - checked_positions_).cwiseAbs().maxCoeff() > STATE_CHANGE_EPS;
+}
+
+void CollisionMonitor::updateCollisionVelocityScale()
+{
   bool approaching_self_collision, approaching_scene_collision;
   double self_collision_threshold_delta, scene_collision_threshold_delta;
   double self_collision_scale, scene_collision_scale;
   const double log_val = -log(0.001);
 
-  while (rclcpp::ok() && !stop_requested_)
-  {
-    const double self_velocity_scale_coefficient{ log_val / servo_params_.self_collision_proximity_threshold };
-    const double scene_velocity_scale_coefficient{ log_val / servo_params_.scene_collision_proximity_threshold };
+  const double self_velocity_scale_coefficient{ log_val / servo_params_.self_collision_proximity_threshold };
+  const double scene_velocity_scale_coefficient{ log_val / servo_params_.scene_collision_proximity_threshold };
 
-    // Reset the scale on every iteration.
+  if (!servo_params_.check_collisions)
+  {
     collision_velocity_scale_ = 1.0;
+    return;
+  }
 
-    if (servo_params_.check_collisions)
-    {
-      // Fetch latest robot state.
-      robot_state_ = planning_scene_monitor_->getStateMonitor()->getCurrentState();
-      // This must be called before doing collision checking.
-      robot_state_->updateCollisionBodyTransforms();
+  // Fetch latest robot state.
+  planning_scene_monitor_->getStateMonitor()->setToCurrentState(*robot_state_);
+  checked_positions_ = Eigen::Map<const Eigen::VectorXd>(robot_state_->getVariablePositions(),
+                                                         robot_state_->getVariableCount());
+
+  // Check the state the robot reaches if it keeps following the command, to make up for the time between checks.
+  const double prediction_time = servo_params_.collision_prediction_time;
+  if (prediction_time > 0.0 && checked_velocities_.size() == predicted_positions_.size() &&
+      !checked_velocities_.isZero())
+  {
+    robot_state_->copyJointGroupPositions(joint_model_group_, predicted_positions_);
+    predicted_positions_ += checked_velocities_ * prediction_time;
+    robot_state_->setJointGroupPositions(joint_model_group_, predicted_positions_);
+    robot_state_->enforceBounds(joint_model_group_);
+  }
+
+  // This must be called before doing collision checking.
+  robot_state_->updateCollisionBodyTransforms();
 
-      // Get a read-only copy of planning scene.
-      planning_scene_monitor::LockedPlanningSceneRO locked_scene(planning_scene_monitor_);
+  // Both checks share the budget, a check that exceeds it reports a collision.
+  if (servo_params_.collision_check_budget > 0.0)
+  {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                               std::chrono::duration<double>(servo_params_.collision_check_budget));
+    self_collision_request_.deadline = scene_collision_request_.deadline = deadline;
+  }
+
+  collision_detection::WorldConstPtr changed_world;
+  {
+    // Get a read-only copy of planning scene.
+    planning_scene_monitor::LockedPlanningSceneRO locked_scene(planning_scene_monitor_);
 
-      // Check collision with environment.
-      scene_collision_result_.clear();
+    // Check collision with environment, unless servo looks it up in the scene distance field.
+    scene_collision_result_.clear();
+    if (!servo_params_.scene_distance_field)
+    {
       locked_scene->getCollisionEnv()->checkRobotCollision(scene_collision_request_, scene_collision_result_,
                                                            *robot_state_);
+    }
+    else if (!scene_distance_field_ ||
+             locked_scene->getCollisionObjectsVersion() != distance_field_objects_version_ ||
+             locked_scene->getOctomapVersion() != distance_field_octomap_version_)
+    {
+      // The world copy shares the objects, the field is built from it after the scene is unlocked.
+      changed_world = std::make_shared<const collision_detection::World>(*locked_scene->getWorld());
+      distance_field_objects_version_ = locked_scene->getCollisionObjectsVersion();
+      distance_field_octomap_version_ = locked_scene->getOctomapVersion();
+    }
 
-      // Check robot self collision.
-      self_collision_result_.clear();
-      locked_scene->getCollisionEnvUnpadded()->checkSelfCollision(
-          self_collision_request_, self_collision_result_, *robot_state_, locked_scene->getAllowedCollisionMatrix());
+    // Check robot self collision.
+    self_collision_result_.clear();
+    locked_scene->getCollisionEnvUnpadded()->checkSelfCollision(
+        self_collision_request_, self_collision_result_, *robot_state_, locked_scene->getAllowedCollisionMatrix());
+  }
+  if (changed_world)
+  {
+    updateSceneDistanceField(*changed_world);
+  }
 
-      // If collision detected scale velocity to 0, else start decelerating exponentially.
-      // velocity_scale = e ^ k * (collision_distance - threshold)
-      // k = - ln(0.001) / collision_proximity_threshold
-      // velocity_scale should equal one when collision_distance is at collision_proximity_threshold.
-      // velocity_scale should equal 0.001 when collision_distance is at zero.
+  // If collision detected scale velocity to 0, else start decelerating exponentially.
+  // velocity_scale = e ^ k * (collision_distance - threshold)
+  // k = - ln(0.001) / collision_proximity_threshold
+  // velocity_scale should equal one when collision_distance is at collision_proximity_threshold.
+  // velocity_scale should equal 0.001 when collision_distance is at zero.
 
-      if (self_collision_result_.collision || scene_collision_result_.collision)
-      {
-        collision_velocity_scale_ = 0.0;
-      }
-      else
-      {
-        self_collision_scale = scene_collision_scale = 1.0;
+  const bool budget_exceeded = self_collision_result_.budget_exceeded || scene_collision_result_.budget_exceeded;
+  if (budget_exceeded && !budget_exceeded_)
+  {
+    RCLCPP_WARN(LOGGER, "Collision checks exceeded the budget of %f s, halting", servo_params_.collision_check_budget);
+  }
+  budget_exceeded_ = budget_exceeded;
+  if (self_collision_result_.collision || scene_collision_result_.collision)
+  {
+    collision_velocity_scale_ = 0.0;
+  }
+  else
+  {
+    self_collision_scale = scene_collision_scale = 1.0;
 
-        approaching_scene_collision =
-            scene_collision_result_.distance < servo_params_.scene_collision_proximity_threshold;
-        approaching_self_collision = self_collision_result_.distance < servo_params_.self_collision_proximity_threshold;
+    approaching_scene_collision = scene_collision_result_.distance < servo_params_.scene_collision_proximity_threshold;
+    approaching_self_collision = self_collision_result_.distance < servo_params_.self_collision_proximity_threshold;
 
-        if (approaching_scene_collision)
-        {
-          scene_collision_threshold_delta =
-              scene_collision_result_.distance - servo_params_.scene_collision_proximity_threshold;
-          scene_collision_scale = std::exp(scene_velocity_scale_coefficient * scene_collision_threshold_delta);
-        }
+    if (approaching_scene_collision)
+    {
+      scene_collision_threshold_delta =
+          scene_collision_result_.distance - servo_params_.scene_collision_proximity_threshold;
+      scene_collision_scale = std::exp(scene_velocity_scale_coefficient * scene_collision_threshold_delta);
+    }
 
-        if (approaching_self_collision)
-        {
-          self_collision_threshold_delta =
-              self_collision_result_.distance - servo_params_.self_collision_proximity_threshold;
-          self_collision_scale = std::exp(self_velocity_scale_coefficient * self_collision_threshold_delta);
-        }
+    if (approaching_self_collision)
+    {
+      self_collision_threshold_delta =
+          self_collision_result_.distance - servo_params_.self_collision_proximity_threshold;
+      self_collision_scale = std::exp(self_velocity_scale_coefficient * self_collision_threshold_delta);
+    }
 
-        // Use the scaling factor with lower value, i.e maximum scale down.
-        collision_velocity_scale_ = std::min(scene_collision_scale, self_collision_scale);
-      }
+    // Use the scaling factor with lower value, i.e maximum scale down.
+    collision_velocity_scale_ = std::min(scene_collision_scale, self_collision_scale);
+  }
+}
+
+void CollisionMonitor::updateSceneDistanceField(const collision_detection::World& world)
+{
+  const double size = servo_params_.distance_field_size;
+  const double resolution = servo_params_.distance_field_resolution;
+  // Spheres further from the scene than the proximity threshold are not slowed down, no need to propagate further.
+  const double max_distance = servo_params_.scene_collision_proximity_threshold + max_sphere_radius_ + resolution;
+  auto field = std::make_shared<distance_field::PropagationDistanceField>(
+      size, size, size, resolution, -0.5 * size, -0.5 * size, -0.5 * size, max_distance);
+  for (const auto& [id, object] : world)
+  {
+    for (std::size_t i = 0; i < object->shapes_.size(); ++i)
+    {
+      field->addShapeToField(object->shapes_[i].get(), object->global_shape_poses_[i]);
+    }
+  }
+  std::atomic_store(&scene_distance_field_,
+                    std::shared_ptr<const distance_field::PropagationDistanceField>(std::move(field)));
+}
+
+double CollisionMonitor::sceneCollisionVelocityScale(moveit::core::RobotState& robot_state,
+                                                     const Eigen::VectorXd& joint_position_delta)
+{
+  const std::shared_ptr<const distance_field::PropagationDistanceField> field =
+      std::atomic_load(&scene_distance_field_);
+  if (!field || !servo_params_.check_collisions)
+  {
+    return 1.0;
+  }
+
+  // Move the lookahead state by the commanded delta. Without a matching delta, all spheres count as approaching.
+  robot_state.updateLinkTransforms();
+  lookahead_state_->setVariablePositions(robot_state.getVariablePositions());
+  if (joint_position_delta.size() == lookahead_positions_.size())
+  {
+    robot_state.copyJointGroupPositions(joint_model_group_, lookahead_positions_);
+    lookahead_positions_ += joint_position_delta;
+    lookahead_state_->setJointGroupPositions(joint_model_group_, lookahead_positions_);
+  }
+  lookahead_state_->updateLinkTransforms();
+
+  std::size_t sphere_index = 0;
+  for (std::size_t i = 0; i < sphere_links_.size(); ++i)
+  {
+    const Eigen::Isometry3d& pose = robot_state.getGlobalLinkTransform(sphere_links_[i]);
+    const Eigen::Isometry3d& lookahead_pose = lookahead_state_->getGlobalLinkTransform(sphere_links_[i]);
+    for (const collision_detection::CollisionSphere& sphere : link_decompositions_[i]->getCollisionSpheres())
+    {
+      sphere_centers_[sphere_index] = pose * sphere.relative_vec_;
+      lookahead_centers_[sphere_index] = lookahead_pose * sphere.relative_vec_;
+      ++sphere_index;
+    }
+  }
+  field->getDistanceGradients(sphere_centers_, sphere_distances_, sphere_gradients_, sphere_in_bounds_);
+
+  // Same exponential scaling as for the scene distance checked by the monitor thread.
+  const double threshold = servo_params_.scene_collision_proximity_threshold;
+  const double scale_coefficient = -log(0.001) / threshold;
+  double scale = 1.0;
+  for (std::size_t i = 0; i < sphere_centers_.size(); ++i)
+  {
+    if (!sphere_in_bounds_[i])
+    {
+      continue;
+    }
+    // The gradient points away from the closest obstacle, moving against it approaches the scene.
+    const double gradient_norm = sphere_gradients_[i].norm();
+    const double approach =
+        gradient_norm > 0.0 ? -sphere_gradients_[i].dot(lookahead_centers_[i] - sphere_centers_[i]) / gradient_norm :
+                              0.0;
+    if (approach < 0.0)
+    {
+      continue;
+    }
+    const double clearance = sphere_distances_[i] - sphere_radii_[i] - approach;
+    if (clearance <= 0.0)
+    {
+      return 0.0;
+    }
+    if (clearance < threshold)
+    {
+      scale = std::min(scale, std::exp(scale_coefficient * (clearance - threshold)));
     }
-    rate.sleep();
   }
+  return scale;
 }
 }  // namespace moveit_servo
@@ -147,6 +147,10 @@ Servo::Servo(const rclcpp::Node::SharedPtr& node, std::shared_ptr<const servo::P
     joint_name_to_index_maps_.insert(
         std::make_pair<std::string, JointNameToMoveGroupIndexMap>(std::string(sub_group_name), std::move(new_map)));
   }
+
+  // Allocate the working buffers of the servo loop up front.
+  robot_state_ = robot_state;
+  updateJointModelGroup();
   RCLCPP_INFO_STREAM(LOGGER, "Servo initialized successfully");
 }
 
@@ -155,6 +159,23 @@ Servo::~Servo()
   setCollisionChecking(false);
 }
 
+void Servo::updateJointModelGroup()
+{
+  joint_model_group_ = planning_scene_monitor_->getRobotModel()->getJointModelGroup(servo_params_.move_group_name);
+  const std::vector<std::string>& joint_names = joint_model_group_->getActiveJointModelNames();
+  const int num_joints = joint_names.size();
+
+  joint_bounds_ = joint_model_group_->getActiveJointModelsBounds();
+  current_state_ = KinematicState(num_joints);
+  current_state_.joint_names = joint_names;
+  joint_position_delta_ = Eigen::VectorXd::Zero(num_joints);
+  commanded_joint_velocities_ = Eigen::VectorXd::Zero(num_joints);
+  subgroup_joint_position_delta_ = Eigen::VectorXd::Zero(num_joints);
+  joints_to_halt_.clear();
+  joints_to_halt_.reserve(num_joints);
+  joint_delta_workspace_ = JointDeltaWorkspace(num_joints);
+}
+
 void Servo::setSmoothingPlugin()
 {
   // Load the smoothing plugin
@@ -301,16 +322,13 @@ Eigen::Isometry3d Servo::getEndEffectorPose() const
   return planning_scene_monitor_->getStateMonitor()->getCurrentState()->getGlobalLinkTransform(servo_params_.ee_frame);
 }
 
-KinematicState Servo::haltJoints(const std::vector<int>& joints_to_halt, const KinematicState& current_state,
-                                 const KinematicState& target_state) const
+void Servo::haltJoints(const std::vector<int>& joints_to_halt, const KinematicState& current_state,
+                       KinematicState& target_state) const
 {
-  KinematicState bounded_state(target_state.joint_names.size());
-  bounded_state.joint_names = target_state.joint_names;
-
   std::stringstream halting_joint_names;
   for (const int idx : joints_to_halt)
   {
-    halting_joint_names << bounded_state.joint_names[idx] + " ";
+    halting_joint_names << target_state.joint_names[idx] + " ";
   }
   RCLCPP_WARN_STREAM(LOGGER, "Joint position limit reached on joints: " << halting_joint_names.str());
 
@@ -320,25 +338,22 @@ KinematicState Servo::haltJoints(const std::vector<int>& joints_to_halt, const K
 
   if (all_joint_halt)
   {
-    // The velocities are initialized to zero by default, so we dont need to set it here.
-    bounded_state.positions = current_state.positions;
+    target_state.positions = current_state.positions;
+    std::fill(target_state.velocities.begin(), target_state.velocities.end(), 0.0);
   }
   else
   {
     // Halt only the joints that are out of bounds
-    bounded_state.positions = target_state.positions;
-    bounded_state.velocities = target_state.velocities;
     for (const int idx : joints_to_halt)
     {
-      bounded_state.positions[idx] = current_state.positions[idx];
-      bounded_state.velocities[idx] = 0.0;
+      target_state.positions[idx] = current_state.positions[idx];
+      target_state.velocities[idx] = 0.0;
     }
   }
-
-  return bounded_state;
 }
 
-Eigen::VectorXd Servo::jointDeltaFromCommand(const ServoInput& command, const moveit::core::RobotStatePtr& robot_state)
+void Servo::jointDeltaFromCommand(const ServoInput& command, const moveit::core::RobotStatePtr& robot_state,
+                                  Eigen::VectorXd& joint_position_delta)
 {
   // Determine joint_name_group_index_map, if no subgroup is active, the map is empty
   const auto& joint_name_group_index_map =
@@ -348,105 +363,230 @@ Eigen::VectorXd Servo::jointDeltaFromCommand(const ServoInput& command, const mo
 
   const int num_joints =
       robot_state->getJointModelGroup(servo_params_.move_group_name)->getActiveJointModelNames().size();
-  Eigen::VectorXd joint_position_deltas(num_joints);
-  joint_position_deltas.setZero();
-
-  JointDeltaResult delta_result;
 
   const CommandType expected_type = getCommandType();
   if (command.index() == static_cast<size_t>(expected_type))
   {
-    if (expected_type == CommandType::JOINT_JOG)
+    servo_status_ = jointDeltaFromInput(command, servo_params_, joint_name_group_index_map, joint_position_delta);
+  }
+  else
+  {
+    servo_status_ = StatusCode::INVALID;
+    RCLCPP_WARN_STREAM(LOGGER, "Incoming servo command type does not match known command types.");
+  }
+
+  if (servo_status_ == StatusCode::INVALID)
+  {
+    joint_position_delta.setZero(num_joints);
+  }
+}
+
+StatusCode Servo::jointDeltaFromInput(const ServoInput& command, const servo::Params& params,
+                                      const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                      Eigen::VectorXd& joint_position_delta)
+{
+  StatusCode status = StatusCode::INVALID;
+  const auto command_type = static_cast<CommandType>(command.index());
+  if (command_type == CommandType::JOINT_JOG)
+  {
+    status = jointDeltaFromJointJog(std::get<JointJogCommand>(command), robot_state_, params,
+                                    joint_name_group_index_map, joint_delta_workspace_, joint_position_delta);
+  }
+  else if (command_type == CommandType::TWIST)
+  {
+    try
     {
-      delta_result = jointDeltaFromJointJog(std::get<JointJogCommand>(command), robot_state, servo_params_,
-                                            joint_name_group_index_map);
-      servo_status_ = delta_result.first;
+      const TwistCommand command_in_planning_frame = toPlanningFrame(std::get<TwistCommand>(command));
+      status = jointDeltaFromTwist(command_in_planning_frame, robot_state_, params, joint_name_group_index_map,
+                                   joint_delta_workspace_, joint_position_delta);
     }
-    else if (expected_type == CommandType::TWIST)
+    catch (tf2::TransformException& ex)
     {
-      try
-      {
-        const TwistCommand command_in_planning_frame = toPlanningFrame(std::get<TwistCommand>(command));
-        delta_result =
-            jointDeltaFromTwist(command_in_planning_frame, robot_state, servo_params_, joint_name_group_index_map);
-        servo_status_ = delta_result.first;
-      }
-      catch (tf2::TransformException& ex)
-      {
-        servo_status_ = StatusCode::INVALID;
-        RCLCPP_ERROR_STREAM(LOGGER, "Could not transform twist to planning frame.");
-      }
+      RCLCPP_ERROR_STREAM(LOGGER, "Could not transform twist to planning frame.");
     }
-    else if (expected_type == CommandType::POSE)
+  }
+  else if (command_type == CommandType::POSE)
+  {
+    try
     {
-      try
-      {
-        const PoseCommand command_in_planning_frame = toPlanningFrame(std::get<PoseCommand>(command));
-        delta_result =
-            jointDeltaFromPose(command_in_planning_frame, robot_state, servo_params_, joint_name_group_index_map);
-        servo_status_ = delta_result.first;
-      }
-      catch (tf2::TransformException& ex)
-      {
-        servo_status_ = StatusCode::INVALID;
-        RCLCPP_ERROR_STREAM(LOGGER, "Could not transform pose to planning frame.");
-      }
+      const PoseCommand command_in_planning_frame = toPlanningFrame(std::get<PoseCommand>(command));
+      status = jointDeltaFromPose(command_in_planning_frame, robot_state_, params, joint_name_group_index_map,
+                                  joint_delta_workspace_, joint_position_delta);
     }
-
-    if (servo_status_ != StatusCode::INVALID)
+    catch (tf2::TransformException& ex)
     {
-      joint_position_deltas = delta_result.second;
+      RCLCPP_ERROR_STREAM(LOGGER, "Could not transform pose to planning frame.");
     }
   }
+  return status;
+}
+
+const servo::Params* Servo::getSubgroupParams(const std::string& group_name)
+{
+  const auto it = subgroup_params_.find(group_name);
+  if (it != subgroup_params_.end())
+  {
+    return &it->second;
+  }
+
+  const bool is_move_group = (group_name == servo_params_.move_group_name);
+  if (!is_move_group && !joint_model_group_->isSubgroup(group_name))
+  {
+    return nullptr;
+  }
+
+  servo::Params params = servo_params_;
+  if (is_move_group)
+  {
+    params.active_subgroup.clear();
+  }
   else
   {
-    servo_status_ = StatusCode::INVALID;
-    RCLCPP_WARN_STREAM(LOGGER, "Incoming servo command type does not match known command types.");
+    // Twist and pose commands move the tip of the subgroup, which is also the link its inverse Jacobian is taken for.
+    const moveit::core::JointModelGroup* subgroup = robot_state_->getJointModelGroup(group_name);
+    const kinematics::KinematicsBaseConstPtr& ik_solver = subgroup->getSolverInstance();
+    params.active_subgroup = group_name;
+    params.ee_frame = ik_solver ? ik_solver->getTipFrame() : subgroup->getLinkModels().back()->getName();
+  }
+  return &subgroup_params_.emplace(group_name, std::move(params)).first->second;
+}
+
+void Servo::jointDeltaFromSubgroupCommands(const std::vector<SubgroupCommand>& commands,
+                                           Eigen::VectorXd& joint_position_delta)
+{
+  static const JointNameToMoveGroupIndexMap MOVE_GROUP_INDEX_MAP;
+  const int num_joints = joint_model_group_->getActiveJointModelNames().size();
+
+  joint_position_delta.setZero(num_joints);
+  for (const SubgroupCommand& subgroup_command : commands)
+  {
+    const servo::Params* params = getSubgroupParams(subgroup_command.group_name);
+    if (!params)
+    {
+      servo_status_ = StatusCode::INVALID;
+      RCLCPP_WARN_STREAM(LOGGER, "Group '" << subgroup_command.group_name << "' is not a subgroup of the move group '"
+                                           << servo_params_.move_group_name << "'.");
+      break;
+    }
+
+    const JointNameToMoveGroupIndexMap& joint_name_group_index_map =
+        params->active_subgroup.empty() ? MOVE_GROUP_INDEX_MAP :
+                                          joint_name_to_index_maps_.at(subgroup_command.group_name);
+    const StatusCode status = jointDeltaFromInput(subgroup_command.command, *params, joint_name_group_index_map,
+                                                  subgroup_joint_position_delta_);
+
+    // An invalid command stops the whole move group, otherwise the first warning of a subgroup is reported.
+    if (status == StatusCode::INVALID)
+    {
+      servo_status_ = StatusCode::INVALID;
+      break;
+    }
+    if (servo_status_ == StatusCode::NO_WARNING)
+    {
+      servo_status_ = status;
+    }
+    joint_position_delta += subgroup_joint_position_delta_;
   }
 
-  return joint_position_deltas;
+  if (servo_status_ == StatusCode::INVALID)
+  {
+    joint_position_delta.setZero(num_joints);
+  }
 }
 
 KinematicState Servo::getNextJointState(const ServoInput& command)
+{
+  KinematicState target_state;
+  getNextJointState(command, target_state);
+  return target_state;
+}
+
+KinematicState Servo::getNextJointState(const std::vector<SubgroupCommand>& commands)
+{
+  KinematicState target_state;
+  getNextJointState(commands, target_state);
+  return target_state;
+}
+
+void Servo::getNextJointState(const ServoInput& command, KinematicState& target_state)
+{
+  beginCycle(target_state);
+
+  // Compute the change in joint position due to the incoming command
+  jointDeltaFromCommand(command, robot_state_, joint_position_delta_);
+
+  finishCycle(target_state);
+}
+
+void Servo::getNextJointState(const std::vector<SubgroupCommand>& commands, KinematicState& target_state)
+{
+  beginCycle(target_state);
+
+  // Compute the change in joint position due to the commands of all subgroups
+  jointDeltaFromSubgroupCommands(commands, joint_position_delta_);
+
+  finishCycle(target_state);
+}
+
+void Servo::beginCycle(KinematicState& target_state)
 {
   // Set status to clear
   servo_status_ = StatusCode::NO_WARNING;
 
   // Update the parameters
-  updateParams();
+  if (updateParams())
+  {
+    subgroup_params_.clear();
+  }
 
   // Get the robot state and joint model group info.
-  moveit::core::RobotStatePtr robot_state = planning_scene_monitor_->getStateMonitor()->getCurrentState();
-  const moveit::core::JointModelGroup* joint_model_group =
-      robot_state->getJointModelGroup(servo_params_.move_group_name);
+  planning_scene_monitor_->getStateMonitor()->setToCurrentState(*robot_state_);
 
   // Get necessary information about joints
-  const std::vector<std::string> joint_names = joint_model_group->getActiveJointModelNames();
-  const moveit::core::JointBoundsVector joint_bounds = joint_model_group->getActiveJointModelsBounds();
+  const std::vector<std::string>& joint_names = joint_model_group_->getActiveJointModelNames();
   const int num_joints = joint_names.size();
 
-  // State variables
-  KinematicState current_state(num_joints), target_state(num_joints);
+  // State variables, these only allocate if target_state does not match the move group yet.
   target_state.joint_names = joint_names;
+  target_state.positions.assign(num_joints, 0.0);
+  target_state.velocities.assign(num_joints, 0.0);
+  target_state.accelerations.assign(num_joints, 0.0);
 
   // Copy current kinematic data from RobotState.
-  robot_state->copyJointGroupPositions(joint_model_group, current_state.positions);
-  robot_state->copyJointGroupVelocities(joint_model_group, current_state.velocities);
+  robot_state_->copyJointGroupPositions(joint_model_group_, current_state_.positions);
+  robot_state_->copyJointGroupVelocities(joint_model_group_, current_state_.velocities);
+}
+
+void Servo::finishCycle(KinematicState& target_state)
+{
+  const int num_joints = target_state.joint_names.size();
 
   // Create Eigen maps for cleaner operations.
-  Eigen::Map<Eigen::VectorXd> current_joint_positions(current_state.positions.data(), num_joints);
+  Eigen::Map<Eigen::VectorXd> current_joint_positions(current_state_.positions.data(), num_joints);
   Eigen::Map<Eigen::VectorXd> target_joint_positions(target_state.positions.data(), num_joints);
-  Eigen::Map<Eigen::VectorXd> current_joint_velocities(current_state.velocities.data(), num_joints);
+  Eigen::Map<Eigen::VectorXd> current_joint_velocities(current_state_.velocities.data(), num_joints);
   Eigen::Map<Eigen::VectorXd> target_joint_velocities(target_state.velocities.data(), num_joints);
+  Eigen::VectorXd& joint_position_delta = joint_position_delta_;
 
-  // Compute the change in joint position due to the incoming command
-  Eigen::VectorXd joint_position_delta = jointDeltaFromCommand(command, robot_state);
+  // Let the collision monitor look ahead along the commanded motion, before it is scaled down for collisions.
+  double collision_velocity_scale = collision_velocity_scale_;
+  if (collision_monitor_)
+  {
+    commanded_joint_velocities_ = joint_position_delta / servo_params_.publish_period;
+    collision_monitor_->updateCommandedVelocities(commanded_joint_velocities_);
+    // The scene distance field is cheap enough to check the commanded motion on every cycle.
+    if (servo_params_.scene_distance_field && servo_status_ != StatusCode::INVALID)
+    {
+      const double scene_scale = collision_monitor_->sceneCollisionVelocityScale(*robot_state_, joint_position_delta);
+      collision_velocity_scale = std::min(collision_velocity_scale, scene_scale);
+    }
+  }
 
-  if (collision_velocity_scale_ > 0 && collision_velocity_scale_ < 1)
+  if (collision_velocity_scale > 0 && collision_velocity_scale < 1)
   {
     servo_status_ = StatusCode::DECELERATE_FOR_COLLISION;
   }
-  else if (collision_velocity_scale_ == 0)
+  else if (collision_velocity_scale == 0)
   {
     servo_status_ = StatusCode::HALT_FOR_COLLISION;
   }
@@ -456,7 +596,7 @@ KinematicState Servo::getNextJointState(const ServoInput& command)
   if (servo_status_ != StatusCode::INVALID && servo_status_ != StatusCode::HALT_FOR_COLLISION)
   {
     // Apply collision scaling to the joint position delta
-    joint_position_delta *= collision_velocity_scale_;
+    joint_position_delta *= collision_velocity_scale;
 
     // Compute the next joint positions based on the joint position deltas
     target_joint_positions = current_joint_positions + joint_position_delta;
@@ -466,7 +606,7 @@ KinematicState Servo::getNextJointState(const ServoInput& command)
     // Update filter state and apply filtering in position domain
     if (smoother_)
     {
-      smoother_->reset(current_state.positions);
+      smoother_->reset(current_state_.positions);
       smoother_->doSmoothing(target_state.positions);
     }
 
@@ -474,7 +614,7 @@ KinematicState Servo::getNextJointState(const ServoInput& command)
     target_joint_velocities = (target_joint_positions - current_joint_positions) / servo_params_.publish_period;
 
     // Scale down the velocity based on joint velocity limit or user defined scaling if applicable.
-    const double joint_limit_scale = jointLimitVelocityScalingFactor(target_joint_velocities, joint_bounds,
+    const double joint_limit_scale = jointLimitVelocityScalingFactor(target_joint_velocities, joint_bounds_,
                                                                      servo_params_.override_velocity_scaling_factor);
     if (joint_limit_scale < 1.0)  // 1.0 means no scaling.
     {
@@ -487,27 +627,25 @@ KinematicState Servo::getNextJointState(const ServoInput& command)
     target_joint_positions = current_joint_positions + (target_joint_velocities * servo_params_.publish_period);
 
     // Check if any joints are going past joint position limits
-    const std::vector<int> joints_to_halt =
-        jointsToHalt(target_joint_positions, target_joint_velocities, joint_bounds, servo_params_.joint_limit_margin);
+    jointsToHalt(target_joint_positions, target_joint_velocities, joint_bounds_, servo_params_.joint_limit_margin,
+                 joints_to_halt_);
 
     // Apply halting if any joints need to be halted.
-    if (!joints_to_halt.empty())
+    if (!joints_to_halt_.empty())
     {
       servo_status_ = StatusCode::JOINT_BOUND;
-      target_state = haltJoints(joints_to_halt, current_state, target_state);
+      haltJoints(joints_to_halt_, current_state_, target_state);
     }
   }
-
-  return target_state;
 }
 
 Eigen::Isometry3d Servo::getPlanningToCommandFrameTransform(const std::string& command_frame) const
 {
-  const moveit::core::RobotStatePtr robot_state = planning_scene_monitor_->getStateMonitor()->getCurrentState();
-  if (robot_state->knowsFrameTransform(command_frame))
+  // The working state has just been updated to the current state by getNextJointState().
+  if (robot_state_->knowsFrameTransform(command_frame))
   {
-    return robot_state->getGlobalLinkTransform(servo_params_.planning_frame).inverse() *
-           robot_state->getGlobalLinkTransform(command_frame);
+    return robot_state_->getGlobalLinkTransform(servo_params_.planning_frame).inverse() *
+           robot_state_->getGlobalLinkTransform(command_frame);
   }
   else
   {
@@ -518,7 +656,7 @@ Eigen::Isometry3d Servo::getPlanningToCommandFrameTransform(const std::string& c
 
 TwistCommand Servo::toPlanningFrame(const TwistCommand& command) const
 {
-  Eigen::VectorXd transformed_twist = command.velocities;
+  Eigen::Vector<double, 6> transformed_twist = command.velocities;
 
   if (command.frame_id != servo_params_.planning_frame)
   {
@@ -546,7 +684,7 @@ TwistCommand Servo::toPlanningFrame(const TwistCommand& command) const
       // as shown in Equation 3.83 in http://hades.mech.northwestern.edu/images/7/7f/MR.pdf.
       // The above equation defines twist as [angular; linear], but in our convention it is
       // [linear; angular] so the adjoint matrix is also reordered accordingly.
-      Eigen::MatrixXd adjoint(6, 6);
+      Eigen::Matrix<double, 6, 6> adjoint;
 
       const Eigen::Matrix3d& rotation = planning_to_command_tf.rotation();
       const Eigen::Vector3d& translation = planning_to_command_tf.translation();
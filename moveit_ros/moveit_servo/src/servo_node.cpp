@@ -39,11 +39,38 @@
  */
 
 #include <moveit_servo/servo_node.hpp>
+#include <moveit/utils/thread_placement.h>
 #include <realtime_tools/thread_priority.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
 
 namespace
 {
 const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_servo.servo_node");
+
+// Publish a message filled by update(), loaned from the middleware if it supports loans for MessageT.
+// Otherwise reused_msg is filled, which does not allocate once it has the size of the command.
+template <typename MessageT, typename UpdateFn>
+void publishInPlace(rclcpp::Publisher<MessageT>& publisher, MessageT& reused_msg, const UpdateFn& update)
+{
+  if (publisher.can_loan_messages())
+  {
+    auto loaned_msg = publisher.borrow_loaned_message();
+    update(loaned_msg.get());
+    publisher.publish(std::move(loaned_msg));
+  }
+  else
+  {
+    update(reused_msg);
+    publisher.publish(reused_msg);
+  }
+}
+
+double toMilliseconds(const std::chrono::steady_clock::duration& duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
 }  // namespace
 
 namespace moveit_servo
@@ -288,11 +315,66 @@ std::optional<KinematicState> ServoNode::processPoseCommand()
   return next_joint_state;
 }
 
+void ServoNode::publishCommand(const KinematicState& joint_state)
+{
+  const servo::Params& params = servo_->getParams();
+  if (trajectory_publisher_)
+  {
+    publishInPlace(*trajectory_publisher_, trajectory_msg_, [&](trajectory_msgs::msg::JointTrajectory& msg) {
+      updateTrajectoryMessage(params, joint_state, msg);
+    });
+  }
+  else if (multi_array_publisher_)
+  {
+    publishInPlace(*multi_array_publisher_, multi_array_msg_, [&](std_msgs::msg::Float64MultiArray& msg) {
+      updateMultiArrayMessage(params, joint_state, msg);
+    });
+  }
+}
+
+void ServoNode::sleepUntilDeadline(std::chrono::steady_clock::time_point& deadline)
+{
+  const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(servo_params_.publish_period));
+
+  auto now = std::chrono::steady_clock::now();
+  loop_timing_.cycle_time = now - loop_timing_.cycle_start;
+  if (now >= deadline)
+  {
+    // Skip the deadlines that passed instead of running the missed cycles back to back
+    const auto missed = (now - deadline) / period + 1;
+    loop_timing_.overruns += missed;
+    deadline += missed * period;
+  }
+
+  std::this_thread::sleep_until(deadline);
+  now = std::chrono::steady_clock::now();
+  loop_timing_.cycle_start = now;
+  loop_timing_.wakeup_latency = now - deadline;
+  loop_timing_.max_wakeup_latency = std::max(loop_timing_.max_wakeup_latency, loop_timing_.wakeup_latency);
+  deadline += period;
+}
+
+void ServoNode::appendLoopTiming(std::string& message) const
+{
+  char timing[160];
+  std::snprintf(timing, sizeof(timing), " [cycle: %.3f ms, wake-up latency: %.3f ms (max %.3f ms), overruns: %zu]",
+                toMilliseconds(loop_timing_.cycle_time), toMilliseconds(loop_timing_.wakeup_latency),
+                toMilliseconds(loop_timing_.max_wakeup_latency), loop_timing_.overruns);
+  message += timing;
+}
+
 void ServoNode::servoLoop()
 {
+  moveit::core::configureCurrentThread(moveit::core::thread_roles::SERVO, "servo_loop");
   moveit_msgs::msg::ServoStatus status_msg;
   std::optional<KinematicState> next_joint_state = std::nullopt;
   rclcpp::WallRate servo_frequency(1 / servo_params_.publish_period);
+  const bool deadline_loop = servo_params_.deadline_loop;
+  loop_timing_.cycle_start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point deadline =
+      loop_timing_.cycle_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::duration<double>(servo_params_.publish_period));
 
   while (rclcpp::ok() && !stop_servo_)
   {
@@ -324,7 +406,11 @@ void ServoNode::servoLoop()
     if (next_joint_state && (servo_->getStatus() != StatusCode::INVALID) &&
         (servo_->getStatus() != StatusCode::HALT_FOR_COLLISION))
     {
-      if (servo_params_.command_out_type == "trajectory_msgs/JointTrajectory")
+      if (deadline_loop)
+      {
+        publishCommand(next_joint_state.value());
+      }
+      else if (servo_params_.command_out_type == "trajectory_msgs/JointTrajectory")
       {
         trajectory_publisher_->publish(composeTrajectoryMessage(servo_->getParams(), next_joint_state.value()));
       }
@@ -337,9 +423,18 @@ void ServoNode::servoLoop()
 
     status_msg.code = static_cast<int8_t>(servo_->getStatus());
     status_msg.message = servo_->getStatusMessage();
+    if (deadline_loop)
+      appendLoopTiming(status_msg.message);
     status_publisher_->publish(status_msg);
 
-    servo_frequency.sleep();
+    if (deadline_loop)
+    {
+      sleepUntilDeadline(deadline);
+    }
+    else
+    {
+      servo_frequency.sleep();
+    }
   }
 }
 
@@ -51,25 +51,33 @@ const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_servo.command_processor
  * @param robot_state Current robot state
  * @param servo_params Servo params
  * @param joint_name_group_index_map Mapping between joint subgroup name and move group joint vector position.
- * @return Delta vector for the whole move group. The elements that don't belong to the actuated subgroup are zero.
+ * @param move_group_delta_theta Delta vector for the whole move group. The elements that don't belong to the actuated
+ * subgroup are zero.
  */
-const Eigen::VectorXd createMoveGroupDelta(const Eigen::VectorXd& sub_group_deltas,
-                                           const moveit::core::RobotStatePtr& robot_state,
-                                           const servo::Params& servo_params,
-                                           const moveit_servo::JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+void createMoveGroupDelta(const Eigen::VectorXd& sub_group_deltas, const moveit::core::RobotStatePtr& robot_state,
+                          const servo::Params& servo_params,
+                          const moveit_servo::JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                          Eigen::VectorXd& move_group_delta_theta)
 {
   const auto& subgroup_joint_names =
       robot_state->getJointModelGroup(servo_params.active_subgroup)->getActiveJointModelNames();
 
   // Create
-  Eigen::VectorXd move_group_delta_theta = Eigen::VectorXd::Zero(
+  move_group_delta_theta.setZero(
       robot_state->getJointModelGroup(servo_params.move_group_name)->getActiveJointModelNames().size());
   for (size_t index = 0; index < subgroup_joint_names.size(); index++)
   {
     move_group_delta_theta[joint_name_group_index_map.at(subgroup_joint_names.at(index))] = sub_group_deltas[index];
   }
-  return move_group_delta_theta;
 };
+
+/**
+ * @brief Checks if servo acts on a subgroup of the move group, whose deltas need to be expanded to the move group.
+ */
+bool isSubgroupActive(const servo::Params& servo_params)
+{
+  return !servo_params.active_subgroup.empty() && servo_params.active_subgroup != servo_params.move_group_name;
+}
 }  // namespace
 
 namespace moveit_servo
@@ -78,17 +86,30 @@ namespace moveit_servo
 JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const moveit::core::RobotStatePtr& robot_state,
                                         const servo::Params& servo_params,
                                         const JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+{
+  JointDeltaWorkspace workspace;
+  Eigen::VectorXd joint_position_delta;
+  const StatusCode status = jointDeltaFromJointJog(command, robot_state, servo_params, joint_name_group_index_map,
+                                                   workspace, joint_position_delta);
+  return std::make_pair(status, joint_position_delta);
+}
+
+StatusCode jointDeltaFromJointJog(const JointJogCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                                  const servo::Params& servo_params,
+                                  const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                                  JointDeltaWorkspace& workspace, Eigen::VectorXd& joint_position_delta)
 {
   // Find the target joint position based on the commanded joint velocity
   StatusCode status = StatusCode::NO_WARNING;
   const auto& group_name =
       servo_params.active_subgroup.empty() ? servo_params.move_group_name : servo_params.active_subgroup;
   const moveit::core::JointModelGroup* joint_model_group = robot_state->getJointModelGroup(group_name);
-  const auto joint_names = joint_model_group->getActiveJointModelNames();
-  Eigen::VectorXd joint_position_delta(joint_names.size());
-  Eigen::VectorXd velocities(joint_names.size());
+  const auto& joint_names = joint_model_group->getActiveJointModelNames();
+  const bool subgroup_active = isSubgroupActive(servo_params);
+  Eigen::VectorXd& sub_group_delta = subgroup_active ? workspace.sub_group_delta : joint_position_delta;
+  Eigen::VectorXd& velocities = workspace.joint_velocities;
 
-  velocities.setZero();
+  velocities.setZero(joint_names.size());
   bool names_valid = true;
 
   for (size_t i = 0; i < command.names.size(); i++)
@@ -109,15 +130,16 @@ JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const mo
   const bool velocity_valid = isValidCommand(velocities);
   if (names_valid && velocity_valid)
   {
-    joint_position_delta = velocities * servo_params.publish_period;
+    sub_group_delta = velocities * servo_params.publish_period;
     if (servo_params.command_in_type == "unitless")
     {
-      joint_position_delta *= servo_params.scale.joint;
+      sub_group_delta *= servo_params.scale.joint;
     }
   }
   else
   {
     status = StatusCode::INVALID;
+    sub_group_delta.setZero(joint_names.size());
     if (!names_valid)
     {
       RCLCPP_WARN_STREAM(LOGGER, "Invalid joint names in joint jog command. Either you're sending commands for a joint "
@@ -130,24 +152,33 @@ JointDeltaResult jointDeltaFromJointJog(const JointJogCommand& command, const mo
     }
   }
 
-  if (!servo_params.active_subgroup.empty() && servo_params.active_subgroup != servo_params.move_group_name)
+  if (subgroup_active)
   {
-    return std::make_pair(status, createMoveGroupDelta(joint_position_delta, robot_state, servo_params,
-                                                       joint_name_group_index_map));
+    createMoveGroupDelta(sub_group_delta, robot_state, servo_params, joint_name_group_index_map, joint_position_delta);
   }
 
-  return std::make_pair(status, joint_position_delta);
+  return status;
 }
 
 JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::core::RobotStatePtr& robot_state,
                                      const servo::Params& servo_params,
                                      const JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+{
+  JointDeltaWorkspace workspace;
+  Eigen::VectorXd joint_position_delta;
+  const StatusCode status = jointDeltaFromTwist(command, robot_state, servo_params, joint_name_group_index_map,
+                                                workspace, joint_position_delta);
+  return std::make_pair(status, joint_position_delta);
+}
+
+StatusCode jointDeltaFromTwist(const TwistCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                               const servo::Params& servo_params,
+                               const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                               JointDeltaWorkspace& workspace, Eigen::VectorXd& joint_position_delta)
 {
   StatusCode status = StatusCode::NO_WARNING;
   const int num_joints =
       robot_state->getJointModelGroup(servo_params.move_group_name)->getActiveJointModelNames().size();
-  Eigen::VectorXd joint_position_delta(num_joints);
-  Eigen::VectorXd cartesian_position_delta;
 
   const bool valid_command = isValidCommand(command);
   const bool is_planning_frame = (command.frame_id == servo_params.planning_frame);
@@ -155,6 +186,7 @@ JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::
   if (!is_zero && is_planning_frame && valid_command)
   {
     // Compute the Cartesian position delta based on incoming command, assumed to be in m/s
+    Eigen::VectorXd& cartesian_position_delta = workspace.cartesian_delta;
     cartesian_position_delta = command.velocities * servo_params.publish_period;
     // This scaling is supposed to be applied to the command.
     // But since it is only used here, we avoid creating a copy of the command,
@@ -166,15 +198,13 @@ JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::
     }
 
     // Compute the required change in joint angles.
-    const auto delta_result =
-        jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params, joint_name_group_index_map);
-    status = delta_result.first;
+    status = jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params, joint_name_group_index_map,
+                              workspace, joint_position_delta);
     if (status != StatusCode::INVALID)
     {
-      joint_position_delta = delta_result.second;
       // Get velocity scaling information for singularity.
       const std::pair<double, StatusCode> singularity_scaling_info =
-          velocityScalingFactorForSingularity(robot_state, cartesian_position_delta, servo_params);
+          velocityScalingFactorForSingularity(robot_state, cartesian_position_delta, servo_params, workspace);
       // Apply velocity scaling for singularity, if there was any scaling.
       if (singularity_scaling_info.second != StatusCode::NO_WARNING)
       {
@@ -186,11 +216,12 @@ JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::
   }
   else if (is_zero)
   {
-    joint_position_delta.setZero();
+    joint_position_delta.setZero(num_joints);
   }
   else
   {
     status = StatusCode::INVALID;
+    joint_position_delta.setZero(num_joints);
     if (!valid_command)
     {
       RCLCPP_WARN_STREAM(LOGGER, "Invalid twist command.");
@@ -201,24 +232,36 @@ JointDeltaResult jointDeltaFromTwist(const TwistCommand& command, const moveit::
                          "Command frame is: " << command.frame_id << ", expected: " << servo_params.planning_frame);
     }
   }
-  return std::make_pair(status, joint_position_delta);
+  return status;
 }
 
 JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::core::RobotStatePtr& robot_state,
                                     const servo::Params& servo_params,
                                     const JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+{
+  JointDeltaWorkspace workspace;
+  Eigen::VectorXd joint_position_delta;
+  const StatusCode status = jointDeltaFromPose(command, robot_state, servo_params, joint_name_group_index_map,
+                                               workspace, joint_position_delta);
+  return std::make_pair(status, joint_position_delta);
+}
+
+StatusCode jointDeltaFromPose(const PoseCommand& command, const moveit::core::RobotStatePtr& robot_state,
+                              const servo::Params& servo_params,
+                              const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                              JointDeltaWorkspace& workspace, Eigen::VectorXd& joint_position_delta)
 {
   StatusCode status = StatusCode::NO_WARNING;
   const int num_joints =
       robot_state->getJointModelGroup(servo_params.move_group_name)->getActiveJointModelNames().size();
-  Eigen::VectorXd joint_position_delta(num_joints);
 
   const bool valid_command = isValidCommand(command);
   const bool is_planning_frame = command.frame_id == servo_params.planning_frame;
 
   if (valid_command && is_planning_frame)
   {
-    Eigen::Vector<double, 6> cartesian_position_delta;
+    Eigen::VectorXd& cartesian_position_delta = workspace.cartesian_delta;
+    cartesian_position_delta.resize(6);
 
     // Compute linear and angular change needed.
     const Eigen::Isometry3d ee_pose{ robot_state->getGlobalLinkTransform(servo_params.ee_frame) };
@@ -230,17 +273,13 @@ JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::co
     cartesian_position_delta.tail<3>() = angle_axis_error.axis() * angle_axis_error.angle();
 
     // Compute the required change in joint angles.
-    const auto delta_result =
-        jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params, joint_name_group_index_map);
-    status = delta_result.first;
-    if (status != StatusCode::INVALID)
-    {
-      joint_position_delta = delta_result.second;
-    }
+    status = jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params, joint_name_group_index_map,
+                              workspace, joint_position_delta);
   }
   else
   {
     status = StatusCode::INVALID;
+    joint_position_delta.setZero(num_joints);
     if (!valid_command)
     {
       RCLCPP_WARN_STREAM(LOGGER, "Invalid pose command.");
@@ -251,24 +290,38 @@ JointDeltaResult jointDeltaFromPose(const PoseCommand& command, const moveit::co
                          "Command frame is: " << command.frame_id << " expected: " << servo_params.planning_frame);
     }
   }
-  return std::make_pair(status, joint_position_delta);
+  return status;
 }
 
 JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delta,
                                   const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
                                   const JointNameToMoveGroupIndexMap& joint_name_group_index_map)
+{
+  JointDeltaWorkspace workspace;
+  Eigen::VectorXd joint_position_delta;
+  const StatusCode status = jointDeltaFromIK(cartesian_position_delta, robot_state, servo_params,
+                                             joint_name_group_index_map, workspace, joint_position_delta);
+  return std::make_pair(status, joint_position_delta);
+}
+
+StatusCode jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delta,
+                            const moveit::core::RobotStatePtr& robot_state, const servo::Params& servo_params,
+                            const JointNameToMoveGroupIndexMap& joint_name_group_index_map,
+                            JointDeltaWorkspace& workspace, Eigen::VectorXd& joint_position_delta)
 {
   const auto& group_name =
       servo_params.active_subgroup.empty() ? servo_params.move_group_name : servo_params.active_subgroup;
   const moveit::core::JointModelGroup* joint_model_group = robot_state->getJointModelGroup(group_name);
+  const bool subgroup_active = isSubgroupActive(servo_params);
 
-  std::vector<double> current_joint_positions;
+  std::vector<double>& current_joint_positions = workspace.ik_seed;
   robot_state->copyJointGroupPositions(joint_model_group, current_joint_positions);
 
-  Eigen::VectorXd delta_theta(current_joint_positions.size());
+  Eigen::VectorXd& delta_theta = subgroup_active ? workspace.sub_group_delta : joint_position_delta;
+  delta_theta.setZero(current_joint_positions.size());
   StatusCode status = StatusCode::NO_WARNING;
 
-  const kinematics::KinematicsBaseConstPtr ik_solver = joint_model_group->getSolverInstance();
+  const kinematics::KinematicsBaseConstPtr& ik_solver = joint_model_group->getSolverInstance();
   bool ik_solver_supports_group = true;
   if (ik_solver)
   {
@@ -290,8 +343,8 @@ JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delt
         poseFromCartesianDelta(cartesian_position_delta, base_to_tip_frame_transform);
 
     // setup for IK call
-    std::vector<double> solution;
-    solution.reserve(current_joint_positions.size());
+    std::vector<double>& solution = workspace.ik_solution;
+    solution.clear();
     moveit_msgs::msg::MoveItErrorCodes err;
     kinematics::KinematicsQueryOptions opts;
     opts.return_approximate_solution = true;
@@ -313,22 +366,30 @@ JointDeltaResult jointDeltaFromIK(const Eigen::VectorXd& cartesian_position_delt
   else
   {
     // Robot does not have an IK solver, use inverse Jacobian to compute IK.
-    const Eigen::MatrixXd jacobian = robot_state->getJacobian(joint_model_group);
-    const Eigen::JacobiSVD<Eigen::MatrixXd> svd =
-        Eigen::JacobiSVD<Eigen::MatrixXd>(jacobian, Eigen::ComputeThinU | Eigen::ComputeThinV);
-    const Eigen::MatrixXd matrix_s = svd.singularValues().asDiagonal();
-    const Eigen::MatrixXd pseudo_inverse = svd.matrixV() * matrix_s.inverse() * svd.matrixU().transpose();
-
-    delta_theta = pseudo_inverse * cartesian_position_delta;
+    // The move group Jacobian is shared with the singularity scaling, which runs on the same state.
+    if (!subgroup_active)
+    {
+      workspace.ik_svd.compute(moveGroupJacobian(robot_state, servo_params, workspace),
+                               Eigen::ComputeThinU | Eigen::ComputeThinV);
+    }
+    else
+    {
+      if (!robot_state->getJacobian(joint_model_group, joint_model_group->getLinkModels().back(),
+                                    Eigen::Vector3d::Zero(), workspace.ik_jacobian))
+      {
+        throw moveit::Exception("Unable to compute Jacobian");
+      }
+      workspace.ik_svd.compute(workspace.ik_jacobian, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    }
+    pseudoInverseProduct(workspace.ik_svd, cartesian_position_delta, workspace.svd_scratch, delta_theta);
   }
 
-  if (!servo_params.active_subgroup.empty() && servo_params.active_subgroup != servo_params.move_group_name)
+  if (subgroup_active)
   {
-    return std::make_pair(status,
-                          createMoveGroupDelta(delta_theta, robot_state, servo_params, joint_name_group_index_map));
+    createMoveGroupDelta(delta_theta, robot_state, servo_params, joint_name_group_index_map, joint_position_delta);
   }
 
-  return std::make_pair(status, delta_theta);
+  return status;
 }
 
 }  // namespace moveit_servo
@@ -37,12 +37,29 @@
  *      Author    : Andy Zelenak, V Mohammed Ibrahim
  */
 
+#include <limits>
 #include <moveit_servo/utils/common.hpp>
 
 namespace
 {
 // The threshold above which `override_velocity_scaling_factor` will be used instead of computing the scaling from joint bounds.
 const double SCALING_OVERRIDE_THRESHOLD = 0.01;
+// The least absolute cosine between the singular vectors of consecutive cycles, for which the sign of the previous
+// direction towards the singularity is carried over instead of being found by a look ahead step.
+const double SINGULAR_VECTOR_CONTINUITY = 0.9;
+
+/**
+ * \brief Computes the condition number of a matrix from its squared singular values, sorted in increasing order.
+ */
+double conditionNumber(const Eigen::Vector<double, 6>& squared_singular_values)
+{
+  // Rounding can make the smallest eigenvalue slightly negative at a singularity.
+  if (squared_singular_values(0) <= 0.0)
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+  return std::sqrt(squared_singular_values(5) / squared_singular_values(0));
+}
 }  // namespace
 
 namespace moveit_servo
@@ -110,33 +127,54 @@ geometry_msgs::msg::Pose poseFromCartesianDelta(const Eigen::VectorXd& delta_x,
 
 trajectory_msgs::msg::JointTrajectory composeTrajectoryMessage(const servo::Params& servo_params,
                                                                const KinematicState& joint_state)
+{
+  trajectory_msgs::msg::JointTrajectory joint_trajectory;
+  updateTrajectoryMessage(servo_params, joint_state, joint_trajectory);
+  return joint_trajectory;
+}
+
+void updateTrajectoryMessage(const servo::Params& servo_params, const KinematicState& joint_state,
+                             trajectory_msgs::msg::JointTrajectory& joint_trajectory)
 {
   // When a joint_trajectory_controller receives a new command, a stamp of 0 indicates "begin immediately"
   // See http://wiki.ros.org/joint_trajectory_controller#Trajectory_replacement
-
-  trajectory_msgs::msg::JointTrajectory joint_trajectory;
   joint_trajectory.header.stamp = rclcpp::Time(0);
   joint_trajectory.header.frame_id = servo_params.planning_frame;
   joint_trajectory.joint_names = joint_state.joint_names;
 
-  trajectory_msgs::msg::JointTrajectoryPoint point;
+  joint_trajectory.points.resize(1);
+  trajectory_msgs::msg::JointTrajectoryPoint& point = joint_trajectory.points.front();
   point.time_from_start = rclcpp::Duration::from_seconds(servo_params.publish_period);
 
   // Set the fields of trajectory point based on which fields are requested.
   // Some controllers check that acceleration data is non-empty, even if accelerations are not used
   // Send all zeros (joint_state.accelerations is a vector of all zeros).
-  point.positions = servo_params.publish_joint_positions ? joint_state.positions : point.positions;
-  point.velocities = servo_params.publish_joint_velocities ? joint_state.velocities : point.velocities;
-  point.accelerations = servo_params.publish_joint_accelerations ? joint_state.accelerations : point.accelerations;
-
-  joint_trajectory.points.push_back(point);
-  return joint_trajectory;
+  // Assigning a vector to one of the same size copies the values without reallocating.
+  if (servo_params.publish_joint_positions)
+    point.positions = joint_state.positions;
+  else
+    point.positions.clear();
+  if (servo_params.publish_joint_velocities)
+    point.velocities = joint_state.velocities;
+  else
+    point.velocities.clear();
+  if (servo_params.publish_joint_accelerations)
+    point.accelerations = joint_state.accelerations;
+  else
+    point.accelerations.clear();
 }
 
 std_msgs::msg::Float64MultiArray composeMultiArrayMessage(const servo::Params& servo_params,
                                                           const KinematicState& joint_state)
 {
   std_msgs::msg::Float64MultiArray multi_array;
+  updateMultiArrayMessage(servo_params, joint_state, multi_array);
+  return multi_array;
+}
+
+void updateMultiArrayMessage(const servo::Params& servo_params, const KinematicState& joint_state,
+                             std_msgs::msg::Float64MultiArray& multi_array)
+{
   if (servo_params.publish_joint_positions)
   {
     multi_array.data = joint_state.positions;
@@ -145,13 +183,24 @@ std_msgs::msg::Float64MultiArray composeMultiArrayMessage(const servo::Params& s
   {
     multi_array.data = joint_state.velocities;
   }
-
-  return multi_array;
+  else
+  {
+    multi_array.data.clear();
+  }
 }
 
 std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::core::RobotStatePtr& robot_state,
                                                                   const Eigen::VectorXd& target_delta_x,
                                                                   const servo::Params& servo_params)
+{
+  JointDeltaWorkspace workspace;
+  return velocityScalingFactorForSingularity(robot_state, target_delta_x, servo_params, workspace);
+}
+
+std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::core::RobotStatePtr& robot_state,
+                                                                  const Eigen::VectorXd& target_delta_x,
+                                                                  const servo::Params& servo_params,
+                                                                  JointDeltaWorkspace& workspace)
 {
   // We need to send information back about if we are halting, moving away or towards the singularity.
   StatusCode servo_status = StatusCode::NO_WARNING;
@@ -164,50 +213,72 @@ std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::
   const double hard_stop_singularity_threshold = servo_params.hard_stop_singularity_threshold;
   const double leaving_singularity_threshold_multiplier = servo_params.leaving_singularity_threshold_multiplier;
 
-  // Get size of total controllable dimensions.
-  const size_t dims = target_delta_x.size();
-
-  // Get the current Jacobian and compute SVD
-  const Eigen::JacobiSVD<Eigen::MatrixXd> current_svd = Eigen::JacobiSVD<Eigen::MatrixXd>(
-      robot_state->getJacobian(joint_model_group), Eigen::ComputeThinU | Eigen::ComputeThinV);
-  const Eigen::MatrixXd matrix_s = current_svd.singularValues().asDiagonal();
+  // Get the current Jacobian, and decompose it unless it has not changed since the last call.
+  // The eigenvalues of J * J^T are the squared singular values of J, in increasing order, and its eigenvectors are
+  // the left singular vectors. This is much cheaper than a full SVD of J and all we need here.
+  const bool jacobian_valid = workspace.jacobian_valid;
+  const Eigen::MatrixXd& jacobian = moveGroupJacobian(robot_state, servo_params, workspace);
+  if (!jacobian_valid || !workspace.singularity_solver_valid)
+  {
+    Eigen::Matrix<double, 6, 6> jacobian_squared;
+    jacobian_squared.noalias() = jacobian * jacobian.transpose();
+    workspace.singularity_solver.compute(jacobian_squared);
+    workspace.singularity_solver_valid = true;
+  }
+  const Eigen::Vector<double, 6>& squared_singular_values = workspace.singularity_solver.eigenvalues();
 
-  // Compute pseudo inverse
-  const Eigen::MatrixXd pseudo_inverse = current_svd.matrixV() * matrix_s.inverse() * current_svd.matrixU().transpose();
+  // Compute the current condition number. The ratio of max and min singular values.
+  const double current_condition_number = conditionNumber(squared_singular_values);
 
   // Get the singular vector corresponding to least singular value.
-  // This vector represents the least responsive dimension. By convention this is the last column of the matrix U.
+  // This vector represents the least responsive dimension.
   // The sign of the singular vector from result of SVD is not reliable, so we need to do extra checking to make sure of
   // the sign. See R. Bro, "Resolving the Sign Ambiguity in the Singular Value Decomposition".
-  Eigen::VectorXd vector_towards_singularity = current_svd.matrixU().col(dims - 1);
-
-  // Compute the current condition number. The ratio of max and min singular values.
-  // By convention these are the first and last element of the diagonal.
-  const double current_condition_number = current_svd.singularValues()(0) / current_svd.singularValues()(dims - 1);
-
-  // Take a small step in the direction of vector_towards_singularity
-  const Eigen::VectorXd delta_x = vector_towards_singularity * servo_params.singularity_step_scale;
-
-  // Compute the new joint angles if we take the small step delta_x
-  Eigen::VectorXd next_joint_angles;
-  robot_state->copyJointGroupPositions(joint_model_group, next_joint_angles);
-  next_joint_angles += pseudo_inverse * delta_x;
+  Eigen::Vector<double, 6> vector_towards_singularity = workspace.singularity_solver.eigenvectors().col(0);
 
-  // Compute the Jacobian SVD for the new robot state.
-  robot_state->setJointGroupPositions(joint_model_group, next_joint_angles);
-  const Eigen::JacobiSVD<Eigen::MatrixXd> next_svd = Eigen::JacobiSVD<Eigen::MatrixXd>(
-      robot_state->getJacobian(joint_model_group), Eigen::ComputeThinU | Eigen::ComputeThinV);
-
-  // Compute condition number for the new Jacobian.
-  const double next_condition_number = next_svd.singularValues()(0) / next_svd.singularValues()(dims - 1);
-
-  // If the condition number has increased, we are moving towards singularity and the direction of the
-  // vector_towards_singularity is correct. If the condition number has decreased, it means the sign of
-  // vector_towards_singularity needs to be flipped.
-  if (next_condition_number <= current_condition_number)
+  // The direction changes continuously while servoing, so the one found in the previous cycle tells the sign.
+  const double continuity =
+      workspace.singular_vector_valid ? workspace.singular_vector.dot(vector_towards_singularity) : 0.0;
+  if (std::abs(continuity) >= SINGULAR_VECTOR_CONTINUITY)
+  {
+    if (continuity < 0)
+    {
+      vector_towards_singularity *= -1;
+    }
+  }
+  else
   {
-    vector_towards_singularity *= -1;
+    // Take a small step in the direction of vector_towards_singularity, and compute the new joint angles.
+    // The pseudo inverse of J applied to a left singular vector u_i is J^T * u_i / sigma_i^2.
+    Eigen::VectorXd& next_joint_angles = workspace.joint_positions;
+    next_joint_angles = workspace.jacobian_positions;
+    next_joint_angles.noalias() += jacobian.transpose() * vector_towards_singularity *
+                                   (servo_params.singularity_step_scale / squared_singular_values(0));
+
+    // Compute the condition number for the new robot state, then restore the current one.
+    robot_state->setJointGroupPositions(joint_model_group, next_joint_angles);
+    if (!robot_state->getJacobian(joint_model_group, joint_model_group->getLinkModels().back(),
+                                  Eigen::Vector3d::Zero(), workspace.lookahead_jacobian))
+    {
+      throw moveit::Exception("Unable to compute Jacobian");
+    }
+    robot_state->setJointGroupPositions(joint_model_group, workspace.jacobian_positions);
+    Eigen::Matrix<double, 6, 6> next_jacobian_squared;
+    next_jacobian_squared.noalias() = workspace.lookahead_jacobian * workspace.lookahead_jacobian.transpose();
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6>> next_solver(next_jacobian_squared,
+                                                                                 Eigen::EigenvaluesOnly);
+    const double next_condition_number = conditionNumber(next_solver.eigenvalues());
+
+    // If the condition number has increased, we are moving towards singularity and the direction of the
+    // vector_towards_singularity is correct. If the condition number has decreased, it means the sign of
+    // vector_towards_singularity needs to be flipped.
+    if (next_condition_number <= current_condition_number)
+    {
+      vector_towards_singularity *= -1;
+    }
   }
+  workspace.singular_vector = vector_towards_singularity;
+  workspace.singular_vector_valid = true;
 
   // Double check the direction using dot product.
   const bool moving_towards_singularity = vector_towards_singularity.dot(target_delta_x) > 0;
@@ -247,53 +318,91 @@ std::pair<double, StatusCode> velocityScalingFactorForSingularity(const moveit::
   return std::make_pair(velocity_scale, servo_status);
 }
 
-double jointLimitVelocityScalingFactor(const Eigen::VectorXd& velocities,
+const Eigen::MatrixXd& moveGroupJacobian(const moveit::core::RobotStatePtr& robot_state,
+                                         const servo::Params& servo_params, JointDeltaWorkspace& workspace)
+{
+  const moveit::core::JointModelGroup* joint_model_group =
+      robot_state->getJointModelGroup(servo_params.move_group_name);
+
+  Eigen::VectorXd& joint_positions = workspace.joint_positions;
+  robot_state->copyJointGroupPositions(joint_model_group, joint_positions);
+  if (workspace.jacobian_valid && joint_positions == workspace.jacobian_positions)
+  {
+    return workspace.jacobian;
+  }
+
+  workspace.jacobian_valid = false;
+  workspace.singularity_solver_valid = false;
+  if (!robot_state->getJacobian(joint_model_group, joint_model_group->getLinkModels().back(), Eigen::Vector3d::Zero(),
+                                workspace.jacobian))
+  {
+    throw moveit::Exception("Unable to compute Jacobian");
+  }
+  workspace.jacobian_positions = joint_positions;
+  workspace.jacobian_valid = true;
+  return workspace.jacobian;
+}
+
+void pseudoInverseProduct(const Eigen::JacobiSVD<Eigen::MatrixXd>& svd, const Eigen::VectorXd& vector,
+                          Eigen::VectorXd& scratch, Eigen::VectorXd& result)
+{
+  // V * S^-1 * U^T * vector, evaluated right to left so that only vectors are formed.
+  scratch.noalias() = svd.matrixU().transpose() * vector;
+  scratch.array() /= svd.singularValues().array();
+  result.noalias() = svd.matrixV() * scratch;
+}
+
+double jointLimitVelocityScalingFactor(const Eigen::Ref<const Eigen::VectorXd>& velocities,
                                        const moveit::core::JointBoundsVector& joint_bounds, double scaling_override)
 {
   // If override value is close to zero, user is not overriding the scaling
   if (scaling_override < SCALING_OVERRIDE_THRESHOLD)
   {
     scaling_override = 1.0;  // Set to no scaling.
-    double bounded_vel;
-    std::vector<double> velocity_scaling_factors;  // The allowable fraction of computed veclocity
 
+    // Find the lowest allowable fraction of computed velocity, this helps preserve Cartesian motion.
     for (size_t i = 0; i < joint_bounds.size(); i++)
     {
-      const auto joint_bound = (joint_bounds[i])->front();
+      const auto& joint_bound = (joint_bounds[i])->front();
       if (joint_bound.velocity_bounded_ && velocities(i) != 0.0)
       {
         // Find the ratio of clamped velocity to original velocity
-        bounded_vel = std::clamp(velocities(i), joint_bound.min_velocity_, joint_bound.max_velocity_);
-        velocity_scaling_factors.push_back(bounded_vel / velocities(i));
+        const double bounded_vel = std::clamp(velocities(i), joint_bound.min_velocity_, joint_bound.max_velocity_);
+        scaling_override = std::min(scaling_override, bounded_vel / velocities(i));
       }
     }
-    // Find the lowest scaling factor, this helps preserve Cartesian motion.
-    scaling_override = velocity_scaling_factors.empty() ?
-                           scaling_override :
-                           *std::min_element(velocity_scaling_factors.begin(), velocity_scaling_factors.end());
   }
 
   return scaling_override;
 }
 
-std::vector<int> jointsToHalt(const Eigen::VectorXd& positions, const Eigen::VectorXd& velocities,
+std::vector<int> jointsToHalt(const Eigen::Ref<const Eigen::VectorXd>& positions,
+                              const Eigen::Ref<const Eigen::VectorXd>& velocities,
                               const moveit::core::JointBoundsVector& joint_bounds, double margin)
 {
   std::vector<int> joint_idxs_to_halt;
+  jointsToHalt(positions, velocities, joint_bounds, margin, joint_idxs_to_halt);
+  return joint_idxs_to_halt;
+}
+
+void jointsToHalt(const Eigen::Ref<const Eigen::VectorXd>& positions,
+                  const Eigen::Ref<const Eigen::VectorXd>& velocities,
+                  const moveit::core::JointBoundsVector& joint_bounds, double margin, std::vector<int>& joints_to_halt)
+{
+  joints_to_halt.clear();
   for (size_t i = 0; i < joint_bounds.size(); i++)
   {
-    const auto joint_bound = (joint_bounds[i])->front();
+    const auto& joint_bound = (joint_bounds[i])->front();
     if (joint_bound.position_bounded_)
     {
       const bool negative_bound = velocities[i] < 0 && positions[i] < (joint_bound.min_position_ + margin);
       const bool positive_bound = velocities[i] > 0 && positions[i] > (joint_bound.max_position_ - margin);
       if (negative_bound || positive_bound)
       {
-        joint_idxs_to_halt.push_back(i);
+        joints_to_halt.push_back(i);
       }
     }
   }
-  return joint_idxs_to_halt;
 }
 
 /** \brief Helper function for converting Eigen::Isometry3d to geometry_msgs/TransformStamped **/
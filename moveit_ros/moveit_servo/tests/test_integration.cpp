@@ -41,6 +41,11 @@
 
 #include "servo_cpp_fixture.hpp"
 
+// Count the heap allocations made by the calling thread, other threads (executors, collision checking) do not
+// interfere with the count.
+#define MOVEIT_DEFINE_ALLOCATION_INTERPOSER
+#include <moveit/utils/allocation_counter.h>
+
 namespace
 {
 
@@ -146,6 +151,63 @@ TEST_F(ServoCppFixture, PoseTest)
   ASSERT_NEAR(delta, expected_delta, tol);
 }
 
+TEST_F(ServoCppFixture, JointJogDoesNotAllocate)
+{
+  if (!moveit::allocation_counter::isSupported())
+    GTEST_SKIP() << "Allocations can not be counted on this platform";
+
+  moveit_servo::JointJogCommand joint_jog_z{ { "panda_joint7" }, { 1.0 } };
+  servo_test_instance_->setCommandType(moveit_servo::CommandType::JOINT_JOG);
+
+  // The first call sizes the output state.
+  moveit_servo::KinematicState next_state;
+  servo_test_instance_->getNextJointState(joint_jog_z, next_state);
+  ASSERT_EQ(servo_test_instance_->getStatus(), moveit_servo::StatusCode::NO_WARNING);
+
+  const std::size_t allocations = moveit::allocation_counter::countAllocations([&] {
+    for (int i = 0; i < 100; ++i)
+    {
+      servo_test_instance_->getNextJointState(joint_jog_z, next_state);
+    }
+  });
+
+  ASSERT_EQ(servo_test_instance_->getStatus(), moveit_servo::StatusCode::NO_WARNING);
+  EXPECT_EQ(allocations, 0u);
+
+  // The reused state matches the one computed into a fresh state.
+  const moveit_servo::KinematicState fresh_state = servo_test_instance_->getNextJointState(joint_jog_z);
+  EXPECT_EQ(fresh_state.joint_names, next_state.joint_names);
+  ASSERT_EQ(fresh_state.positions.size(), next_state.positions.size());
+  for (std::size_t i = 0; i < next_state.positions.size(); ++i)
+  {
+    EXPECT_NEAR(fresh_state.positions[i], next_state.positions[i], 1e-9);
+  }
+}
+
+TEST_F(ServoCppFixture, SubgroupCommandsTest)
+{
+  moveit_servo::JointJogCommand joint_jog_z{ { "panda_joint7" }, { 1.0 } };
+  servo_test_instance_->setCommandType(moveit_servo::CommandType::JOINT_JOG);
+  const moveit_servo::KinematicState single_state = servo_test_instance_->getNextJointState(joint_jog_z);
+  ASSERT_EQ(servo_test_instance_->getStatus(), moveit_servo::StatusCode::NO_WARNING);
+
+  // A command for the move group gives the same state, regardless of the expected command type
+  servo_test_instance_->setCommandType(moveit_servo::CommandType::TWIST);
+  const std::vector<moveit_servo::SubgroupCommand> commands{ { servo_params_.move_group_name, joint_jog_z } };
+  const moveit_servo::KinematicState multi_state = servo_test_instance_->getNextJointState(commands);
+  ASSERT_EQ(servo_test_instance_->getStatus(), moveit_servo::StatusCode::NO_WARNING);
+  ASSERT_EQ(multi_state.positions.size(), single_state.positions.size());
+  for (std::size_t i = 0; i < single_state.positions.size(); ++i)
+  {
+    EXPECT_NEAR(multi_state.positions[i], single_state.positions[i], 1e-9);
+  }
+
+  // Groups that are not part of the move group are rejected
+  const std::vector<moveit_servo::SubgroupCommand> invalid_commands{ { "hand", joint_jog_z } };
+  servo_test_instance_->getNextJointState(invalid_commands);
+  EXPECT_EQ(servo_test_instance_->getStatus(), moveit_servo::StatusCode::INVALID);
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
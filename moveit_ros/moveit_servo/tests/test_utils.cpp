@@ -222,6 +222,89 @@ TEST(ServoUtilsUnitTests, LeavingSingularityScaling)
   ASSERT_EQ(scaling_result.second, moveit_servo::StatusCode::DECELERATE_FOR_LEAVING_SINGULARITY);
 }
 
+TEST(ServoUtilsUnitTests, CachedSingularityScaling)
+{
+  using moveit::core::loadTestingRobotModel;
+  moveit::core::RobotModelPtr robot_model = loadTestingRobotModel("panda");
+  moveit::core::RobotStatePtr robot_state = std::make_shared<moveit::core::RobotState>(robot_model);
+
+  servo::Params servo_params;
+  servo_params.move_group_name = "panda_arm";
+  const moveit::core::JointModelGroup* joint_model_group =
+      robot_state->getJointModelGroup(servo_params.move_group_name);
+  robot_state->setToDefaultValues();
+
+  Eigen::Vector<double, 6> cartesian_delta{ 0.005, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  Eigen::Vector<double, 7> state_ready{ 0.0, -0.785, 0.0, -2.356, 0.0, 1.571, 0.785 };
+  Eigen::Vector<double, 7> singular_state{ -0.0001, 0.5690, 0.0005, -0.7782, 0.0, 1.3453, 0.7845 };
+
+  // Servo towards the singularity, reusing the workspace between cycles like servo does.
+  moveit_servo::JointDeltaWorkspace workspace(joint_model_group->getActiveJointModelNames().size());
+  constexpr int num_steps = 100;
+  for (int step = 0; step <= num_steps; ++step)
+  {
+    const Eigen::Vector<double, 7> state =
+        state_ready + (singular_state - state_ready) * (static_cast<double>(step) / num_steps);
+    robot_state->setJointGroupActivePositions(joint_model_group, state);
+
+    const auto expected = moveit_servo::velocityScalingFactorForSingularity(robot_state, cartesian_delta, servo_params);
+    const auto cached =
+        moveit_servo::velocityScalingFactorForSingularity(robot_state, cartesian_delta, servo_params, workspace);
+    // Calling again on the same state reuses the Jacobian and its decomposition.
+    const auto repeated =
+        moveit_servo::velocityScalingFactorForSingularity(robot_state, cartesian_delta, servo_params, workspace);
+
+    ASSERT_EQ(cached.second, expected.second) << "step " << step;
+    ASSERT_NEAR(cached.first, expected.first, 1e-9) << "step " << step;
+    ASSERT_EQ(repeated.second, cached.second) << "step " << step;
+    ASSERT_EQ(repeated.first, cached.first) << "step " << step;
+  }
+  EXPECT_EQ(moveit_servo::velocityScalingFactorForSingularity(robot_state, cartesian_delta, servo_params, workspace).second,
+            moveit_servo::StatusCode::HALT_FOR_SINGULARITY);
+
+  // The look ahead leaves the robot state unchanged.
+  Eigen::VectorXd positions;
+  robot_state->copyJointGroupPositions(joint_model_group, positions);
+  EXPECT_EQ(positions, Eigen::VectorXd(singular_state));
+}
+
+TEST(ServoUtilsUnitTests, UpdateMessagesInPlace)
+{
+  servo::Params servo_params;
+  servo_params.planning_frame = "panda_link0";
+  servo_params.publish_period = 0.01;
+  servo_params.publish_joint_positions = true;
+  servo_params.publish_joint_velocities = false;
+  servo_params.publish_joint_accelerations = false;
+
+  moveit_servo::KinematicState joint_state(2);
+  joint_state.joint_names = { "panda_joint1", "panda_joint2" };
+  joint_state.positions = { 0.1, 0.2 };
+
+  // Filling a message matches composing a new one
+  trajectory_msgs::msg::JointTrajectory trajectory;
+  moveit_servo::updateTrajectoryMessage(servo_params, joint_state, trajectory);
+  EXPECT_EQ(trajectory, moveit_servo::composeTrajectoryMessage(servo_params, joint_state));
+  ASSERT_EQ(trajectory.points.size(), 1u);
+  EXPECT_TRUE(trajectory.points[0].velocities.empty());
+
+  // Refilling keeps the buffers of the message
+  const double* positions = trajectory.points[0].positions.data();
+  joint_state.positions = { 0.3, 0.4 };
+  moveit_servo::updateTrajectoryMessage(servo_params, joint_state, trajectory);
+  EXPECT_EQ(trajectory, moveit_servo::composeTrajectoryMessage(servo_params, joint_state));
+  EXPECT_EQ(trajectory.points[0].positions.data(), positions);
+
+  std_msgs::msg::Float64MultiArray multi_array;
+  moveit_servo::updateMultiArrayMessage(servo_params, joint_state, multi_array);
+  EXPECT_EQ(multi_array, moveit_servo::composeMultiArrayMessage(servo_params, joint_state));
+  servo_params.publish_joint_positions = false;
+  servo_params.publish_joint_velocities = true;
+  joint_state.velocities = { 1.0, 2.0 };
+  moveit_servo::updateMultiArrayMessage(servo_params, joint_state, multi_array);
+  EXPECT_EQ(multi_array.data, joint_state.velocities);
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
@@ -44,10 +44,13 @@
 #include <rclcpp/rclcpp.hpp>
 #include <tf2_ros/buffer.h>
 
+#include <condition_variable>
 #include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -64,6 +67,15 @@ public:
     double map_resolution;
     std::string map_frame;
     std::vector<std::pair<std::string, std::string>> sensor_plugins;
+    /** Cells farther than this from the origin of the map frame are merged into cells of coarse_resolution.
+        0 keeps the whole map at map_resolution. */
+    double fine_radius = 0.0;
+    double coarse_resolution = 0.0;
+    /** Time in seconds after which a fully occupied or free cell that is not observed again becomes unknown.
+        0 disables decay. */
+    double decay_time = 0.0;
+    /** A map stored with saveMap() that is loaded on construction, if not empty. */
+    std::string initial_map;
   };
 
   /**
@@ -263,6 +275,44 @@ public:
    */
   void publishDebugInformation(bool flag);
 
+  /**
+   * @brief      Save the octree to a binary file, gzip-compressed if the file name ends in ".gz". The tree is only
+   *             locked while it is copied to memory, and the file is replaced atomically.
+   *
+   * @param[in]  filename  The file name
+   *
+   * @return     True on success, False otherwise.
+   */
+  bool saveMap(const std::string& filename);
+
+  /**
+   * @brief      Like saveMap(), but only copies the tree in the calling thread; compression and writing happen in
+   *             another thread. Destroying the returned future waits for the write to finish.
+   *
+   * @param[in]  filename  The file name
+   *
+   * @return     A future that becomes true if the file was written.
+   */
+  std::future<bool> saveMapAsync(const std::string& filename);
+
+  /**
+   * @brief      Replace the octree by one stored with saveMap() or in a plain .bt file. The file is memory-mapped and
+   *             parsed without holding the tree lock, which is only taken to swap the new tree in.
+   *
+   * @param[in]  filename  The file name
+   *
+   * @return     True on success, False otherwise.
+   */
+  bool loadMap(const std::string& filename);
+
+  /**
+   * @brief      Decay the cells of the octree and merge the cells outside the fine radius, as configured by the
+   *             parameters. Called periodically while the monitor is active.
+   *
+   * @param[in]  elapsed  The time in seconds the cells decay by, usually the time since the last call
+   */
+  void maintainMap(double elapsed);
+
   /**
    * @brief      Determines if active.
    *
@@ -313,6 +363,25 @@ private:
   bool getShapeTransformCache(std::size_t index, const std::string& target_frame, const rclcpp::Time& target_time,
                               ShapeTransformCache& cache) const;
 
+  /**
+   * @brief      Serialize the octree in the binary format
+   *
+   * @param[out] data  The serialized tree
+   *
+   * @return     True on success, False otherwise.
+   */
+  bool serializeMap(std::string& data) const;
+
+  /**
+   * @brief      Calls maintainMap() periodically until stopMaintenance() is called.
+   */
+  void maintenanceThread();
+
+  /**
+   * @brief      Stops and joins the maintenance thread, if it runs.
+   */
+  void stopMaintenance();
+
   std::unique_ptr<MiddlewareHandle> middleware_handle_; /*!< The abstract interface to ros */
   std::shared_ptr<tf2_ros::Buffer> tf_buffer_;          /*!< TF buffer */
   Parameters parameters_;
@@ -329,5 +398,10 @@ private:
   std::size_t mesh_handle_count_; /*!< Count of mesh handles */
 
   bool active_; /*!< True when actively monitoring updaters */
+
+  std::thread maintenance_thread_;                /*!< Decays and coarsens the map while active */
+  std::mutex maintenance_lock_;                   /*!< Protects maintenance_running_ */
+  std::condition_variable maintenance_condition_; /*!< Wakes the maintenance thread when it should stop */
+  bool maintenance_running_;                      /*!< False when the maintenance thread should stop */
 };
 }  // namespace occupancy_map_monitor
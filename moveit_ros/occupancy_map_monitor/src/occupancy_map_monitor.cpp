@@ -37,13 +37,23 @@
 #include <moveit/collision_detection/occupancy_map.h>
 #include <moveit/occupancy_map_monitor/occupancy_map_monitor.h>
 #include <moveit/occupancy_map_monitor/occupancy_map_monitor_middleware_handle.hpp>
+#include <moveit/utils/mapped_file.h>
 #include <moveit_msgs/srv/load_map.hpp>
 #include <moveit_msgs/srv/save_map.hpp>
 #include <rclcpp/clock.hpp>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 #include <rclcpp/node.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -53,6 +63,57 @@ namespace occupancy_map_monitor
 namespace
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros.occupancy_map_monitor");
+
+// how often the map is decayed and coarsened
+constexpr std::chrono::seconds MAINTENANCE_PERIOD(1);
+
+bool isGzipFileName(const std::string& filename)
+{
+  return filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gz") == 0;
+}
+
+/* write a serialized tree to filename, through a temporary file so readers never see a partial one */
+bool writeMapFile(const std::string& filename, const std::string& data)
+{
+  const std::string tmp_filename = filename + ".tmp" + std::to_string(moveit::core::processId());
+  {
+    std::ofstream out(tmp_filename, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+    if (!out.good())
+    {
+      RCLCPP_ERROR(LOGGER, "Failed to open %s for writing", tmp_filename.c_str());
+      return false;
+    }
+    if (isGzipFileName(filename))
+    {
+      boost::iostreams::filtering_ostream compressed;
+      compressed.push(boost::iostreams::gzip_compressor());
+      compressed.push(out);
+      compressed.write(data.data(), data.size());
+      compressed.reset();  // flushes the compressor into out
+    }
+    else
+    {
+      out.write(data.data(), data.size());
+    }
+    if (!out.good())
+    {
+      RCLCPP_ERROR(LOGGER, "Failed to write map to %s", tmp_filename.c_str());
+      out.close();
+      std::filesystem::remove(tmp_filename);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_filename, filename, ec);
+  if (ec)
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to rename %s to %s: %s", tmp_filename.c_str(), filename.c_str(), ec.message().c_str());
+    std::filesystem::remove(tmp_filename, ec);
+    return false;
+  }
+  return true;
+}
 }
 
 OccupancyMapMonitor::OccupancyMapMonitor(const rclcpp::Node::SharedPtr& node, double map_resolution)
@@ -76,6 +137,7 @@ OccupancyMapMonitor::OccupancyMapMonitor(std::unique_ptr<MiddlewareHandle> middl
   , debug_info_{ false }
   , mesh_handle_count_{ 0 }
   , active_{ false }
+  , maintenance_running_{ false }
 {
   if (middleware_handle_ == nullptr)
   {
@@ -86,6 +148,12 @@ OccupancyMapMonitor::OccupancyMapMonitor(std::unique_ptr<MiddlewareHandle> middl
   parameters_ = middleware_handle_->getParameters();
 
   RCLCPP_DEBUG(LOGGER, "Using resolution = %lf m for building octomap", parameters_.map_resolution);
+  if (parameters_.fine_radius > 0.0 && parameters_.coarse_resolution <= parameters_.map_resolution)
+  {
+    RCLCPP_WARN(LOGGER, "Coarse octomap resolution %lf m is not larger than the resolution; ignoring the fine radius",
+                parameters_.coarse_resolution);
+    parameters_.fine_radius = 0.0;
+  }
 
   if (tf_buffer_ != nullptr && parameters_.map_frame.empty())
   {
@@ -100,6 +168,12 @@ OccupancyMapMonitor::OccupancyMapMonitor(std::unique_ptr<MiddlewareHandle> middl
   tree_ = std::make_shared<collision_detection::OccMapTree>(parameters_.map_resolution);
   tree_const_ = tree_;
 
+  if (!parameters_.initial_map.empty())
+  {
+    RCLCPP_INFO(LOGGER, "Loading initial map from %s", parameters_.initial_map.c_str());
+    loadMap(parameters_.initial_map);
+  }
+
   for (const auto& [sensor_name, sensor_type] : parameters_.sensor_plugins)
   {
     auto occupancy_map_updater = middleware_handle_->loadOccupancyMapUpdater(sensor_type);
@@ -283,42 +357,208 @@ bool OccupancyMapMonitor::saveMapCallback(const std::shared_ptr<rmw_request_id_t
                                           const std::shared_ptr<moveit_msgs::srv::SaveMap::Response>& response)
 {
   RCLCPP_INFO(LOGGER, "Writing map to %s", request->filename.c_str());
+  response->success = saveMap(request->filename);
+  return true;
+}
+
+bool OccupancyMapMonitor::loadMapCallback(const std::shared_ptr<rmw_request_id_t>& /* unused */,
+                                          const std::shared_ptr<moveit_msgs::srv::LoadMap::Request>& request,
+                                          const std::shared_ptr<moveit_msgs::srv::LoadMap::Response>& response)
+{
+  RCLCPP_INFO(LOGGER, "Reading map from %s", request->filename.c_str());
+  response->success = loadMap(request->filename);
+  return true;
+}
+
+bool OccupancyMapMonitor::serializeMap(std::string& data) const
+{
+  std::ostringstream stream;
+  bool success;
   tree_->lockRead();
   try
   {
-    response->success = tree_->writeBinary(request->filename);
+    // unlike writeBinary(), this does not convert the tree to maximum likelihood, so a read lock is enough
+    success = static_cast<bool>(tree_->writeBinaryConst(stream));
   }
   catch (...)
   {
-    response->success = false;
+    success = false;
   }
   tree_->unlockRead();
+
+  if (!success)
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to serialize map");
+    return false;
+  }
+  data = stream.str();
   return true;
 }
 
-bool OccupancyMapMonitor::loadMapCallback(const std::shared_ptr<rmw_request_id_t>& /* unused */,
-                                          const std::shared_ptr<moveit_msgs::srv::LoadMap::Request>& request,
-                                          const std::shared_ptr<moveit_msgs::srv::LoadMap::Response>& response)
+bool OccupancyMapMonitor::saveMap(const std::string& filename)
 {
-  RCLCPP_INFO(LOGGER, "Reading map from %s", request->filename.c_str());
+  std::string data;
+  return serializeMap(data) && writeMapFile(filename, data);
+}
+
+std::future<bool> OccupancyMapMonitor::saveMapAsync(const std::string& filename)
+{
+  auto data = std::make_shared<std::string>();
+  if (!serializeMap(*data))
+  {
+    std::promise<bool> failed;
+    failed.set_value(false);
+    return failed.get_future();
+  }
+  return std::async(std::launch::async, [filename, data] { return writeMapFile(filename, *data); });
+}
+
+bool OccupancyMapMonitor::loadMap(const std::string& filename)
+{
+  const moveit::core::MappedFile file(filename);
+  if (file.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to open map %s", filename.c_str());
+    return false;
+  }
+
+  /* parse into a separate tree, so the monitored one stays usable meanwhile */
+  auto tree = std::make_unique<octomap::OcTree>(parameters_.map_resolution);
+  try
+  {
+    boost::iostreams::filtering_istream in;
+    if (file.size() >= 2 && static_cast<unsigned char>(file.begin()[0]) == 0x1f &&
+        static_cast<unsigned char>(file.begin()[1]) == 0x8b)
+      in.push(boost::iostreams::gzip_decompressor());
+    in.push(boost::iostreams::array_source(file.begin(), file.size()));
+    if (!tree->readBinary(in))
+    {
+      RCLCPP_ERROR(LOGGER, "Failed to load map from %s", filename.c_str());
+      return false;
+    }
+  }
+  catch (...)
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to load map from %s", filename.c_str());
+    return false;
+  }
 
-  /* load the octree from disk */
+  tree_->lockWrite();
+  if (tree->getResolution() != tree_->getResolution())
+    tree_->setResolution(tree->getResolution());
+  tree_->swapContent(*tree);
+  tree_->unlockWrite();
+  tree_->triggerUpdateCallback();
+
+  // the previous content of the tree is freed here, without holding the lock
+  tree.reset();
+  return true;
+}
+
+void OccupancyMapMonitor::maintainMap(double elapsed)
+{
+  const bool decay = parameters_.decay_time > 0.0 && elapsed > 0.0;
+  const bool coarsen = parameters_.fine_radius > 0.0;
+  if (!decay && !coarsen)
+    return;
+
+  bool changed = false;
   tree_->lockWrite();
   try
   {
-    response->success = tree_->readBinary(request->filename);
+    if (decay)
+    {
+      /* move the log-odds of every leaf towards unknown; cells that reach it are removed */
+      const float fraction = static_cast<float>(elapsed / parameters_.decay_time);
+      const float occupied_step = tree_->getClampingThresMaxLog() * fraction;
+      const float free_step = -tree_->getClampingThresMinLog() * fraction;
+      std::vector<std::pair<octomap::OcTreeKey, unsigned int>> unknown_cells;
+      for (auto it = tree_->begin_leafs(), end = tree_->end_leafs(); it != end; ++it)
+      {
+        const float log_odds = it->getLogOdds();
+        const float decayed = log_odds > 0.0f ? log_odds - occupied_step : log_odds + free_step;
+        if (decayed * log_odds <= 0.0f)
+          unknown_cells.emplace_back(it.getKey(), it.getDepth());
+        else
+          it->setLogOdds(decayed);
+      }
+      for (const std::pair<octomap::OcTreeKey, unsigned int>& cell : unknown_cells)
+        tree_->deleteNode(cell.first, cell.second);
+      tree_->updateInnerOccupancy();
+      changed = true;
+    }
+
+    if (coarsen)
+    {
+      /* inner nodes hold the maximum occupancy of their children, so removing the children of a node at the coarse
+         depth keeps it as occupied as the most occupied cell it contained */
+      const unsigned int levels = std::min(
+          tree_->getTreeDepth() - 1,
+          static_cast<unsigned int>(
+              std::max(1.0, std::round(std::log2(parameters_.coarse_resolution / parameters_.map_resolution)))));
+      const unsigned int coarse_depth = tree_->getTreeDepth() - levels;
+      std::vector<octomap::OcTreeKey> coarse_nodes;
+      for (auto it = tree_->begin_tree(coarse_depth), end = tree_->end_tree(); it != end; ++it)
+      {
+        if (it.getDepth() != coarse_depth || !tree_->nodeHasChildren(&*it))
+          continue;
+        const octomap::point3d center = it.getCoordinate();
+        const double half_diagonal = 0.5 * std::sqrt(3.0) * it.getSize();
+        if (center.norm() - half_diagonal > parameters_.fine_radius)
+          coarse_nodes.push_back(it.getKey());
+      }
+      for (const octomap::OcTreeKey& key : coarse_nodes)
+      {
+        octomap::OcTreeNode* node = tree_->search(key, coarse_depth);
+        if (!node)
+          continue;
+        for (unsigned int i = 0; i < 8; ++i)
+        {
+          if (tree_->nodeChildExists(node, i))
+            tree_->deleteNodeChild(node, i);
+        }
+      }
+      changed = changed || !coarse_nodes.empty();
+    }
+
+    if (changed)
+      tree_->prune();
   }
   catch (...)
   {
-    RCLCPP_ERROR(LOGGER, "Failed to load map from file");
-    response->success = false;
+    RCLCPP_ERROR(LOGGER, "Internal error while maintaining octree");
   }
   tree_->unlockWrite();
 
-  if (response->success)
+  if (changed)
     tree_->triggerUpdateCallback();
+}
 
-  return true;
+void OccupancyMapMonitor::maintenanceThread()
+{
+  auto last = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> ulock(maintenance_lock_);
+  while (maintenance_running_)
+  {
+    if (maintenance_condition_.wait_for(ulock, MAINTENANCE_PERIOD, [this] { return !maintenance_running_; }))
+      break;
+    const auto now = std::chrono::steady_clock::now();
+    ulock.unlock();
+    maintainMap(std::chrono::duration<double>(now - last).count());
+    ulock.lock();
+    last = now;
+  }
+}
+
+void OccupancyMapMonitor::stopMaintenance()
+{
+  {
+    std::lock_guard<std::mutex> _(maintenance_lock_);
+    maintenance_running_ = false;
+  }
+  maintenance_condition_.notify_all();
+  if (maintenance_thread_.joinable())
+    maintenance_thread_.join();
 }
 
 void OccupancyMapMonitor::startMonitor()
@@ -327,6 +567,12 @@ void OccupancyMapMonitor::startMonitor()
   /* initialize all of the occupancy map updaters */
   for (OccupancyMapUpdaterPtr& map_updater : map_updaters_)
     map_updater->start();
+
+  if ((parameters_.decay_time > 0.0 || parameters_.fine_radius > 0.0) && !maintenance_thread_.joinable())
+  {
+    maintenance_running_ = true;
+    maintenance_thread_ = std::thread([this] { maintenanceThread(); });
+  }
 }
 
 void OccupancyMapMonitor::stopMonitor()
@@ -334,6 +580,7 @@ void OccupancyMapMonitor::stopMonitor()
   active_ = false;
   for (OccupancyMapUpdaterPtr& map_updater : map_updaters_)
     map_updater->stop();
+  stopMaintenance();
 }
 
 OccupancyMapMonitor::~OccupancyMapMonitor()
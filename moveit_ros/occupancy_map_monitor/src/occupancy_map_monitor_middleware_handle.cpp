@@ -79,6 +79,12 @@ OccupancyMapMonitorMiddlewareHandle::OccupancyMapMonitorMiddlewareHandle(const r
     }
   }
 
+  // These parameters are optional
+  node_->get_parameter("octomap_fine_radius", parameters_.fine_radius);
+  node_->get_parameter("octomap_coarse_resolution", parameters_.coarse_resolution);
+  node_->get_parameter("octomap_decay_time", parameters_.decay_time);
+  node_->get_parameter("octomap_initial_map", parameters_.initial_map);
+
   if (parameters_.map_frame.empty())
   {
     node_->get_parameter("octomap_frame", parameters_.map_frame);
@@ -77,6 +77,89 @@ TEST(OccupancyMapMonitorTests, ConstructorTest)
   };
 }
 
+TEST(OccupancyMapMonitorTests, MaintainMapDecaysCells)
+{
+  // GIVEN a monitor whose cells decay within 10 seconds
+  occupancy_map_monitor::OccupancyMapMonitor::Parameters parameters{ 0.1, "", {} };
+  parameters.decay_time = 10.0;
+  auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
+  EXPECT_CALL(*mock_middleware_handle, getParameters).WillOnce(::testing::Return(parameters));
+  occupancy_map_monitor::OccupancyMapMonitor occupancy_map_monitor{ std::move(mock_middleware_handle), nullptr };
+  const collision_detection::OccMapTreePtr& tree = occupancy_map_monitor.getOcTreePtr();
+  tree->updateNode(1.02, 0.02, 0.02, true);
+  tree->updateNode(2.02, 0.02, 0.02, false);
+
+  // WHEN less than the decay time passes
+  occupancy_map_monitor.maintainMap(0.01);
+
+  // THEN the cells are still known
+  ASSERT_NE(tree->search(1.02, 0.02, 0.02), nullptr);
+  EXPECT_TRUE(tree->isNodeOccupied(tree->search(1.02, 0.02, 0.02)));
+  ASSERT_NE(tree->search(2.02, 0.02, 0.02), nullptr);
+  EXPECT_FALSE(tree->isNodeOccupied(tree->search(2.02, 0.02, 0.02)));
+
+  // WHEN the decay time passes
+  occupancy_map_monitor.maintainMap(10.0);
+
+  // THEN the cells are unknown
+  EXPECT_EQ(tree->search(1.02, 0.02, 0.02), nullptr);
+  EXPECT_EQ(tree->search(2.02, 0.02, 0.02), nullptr);
+}
+
+TEST(OccupancyMapMonitorTests, MaintainMapCoarsensDistantCells)
+{
+  // GIVEN a monitor that keeps cells of 0.1 m within 1 m and of 0.4 m farther away
+  occupancy_map_monitor::OccupancyMapMonitor::Parameters parameters{ 0.1, "", {} };
+  parameters.fine_radius = 1.0;
+  parameters.coarse_resolution = 0.4;
+  auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
+  EXPECT_CALL(*mock_middleware_handle, getParameters).WillOnce(::testing::Return(parameters));
+  occupancy_map_monitor::OccupancyMapMonitor occupancy_map_monitor{ std::move(mock_middleware_handle), nullptr };
+  const collision_detection::OccMapTreePtr& tree = occupancy_map_monitor.getOcTreePtr();
+
+  // AND an occupied and a free cell next to each other, both near and far from the origin
+  tree->updateNode(0.02, 0.02, 0.02, true);
+  tree->updateNode(0.12, 0.02, 0.02, false);
+  tree->updateNode(5.02, 0.02, 0.02, true);
+  tree->updateNode(5.12, 0.02, 0.02, false);
+
+  // WHEN the map is maintained
+  occupancy_map_monitor.maintainMap(0.0);
+
+  // THEN the near cells keep their occupancy
+  EXPECT_TRUE(tree->isNodeOccupied(tree->search(0.02, 0.02, 0.02)));
+  EXPECT_FALSE(tree->isNodeOccupied(tree->search(0.12, 0.02, 0.02)));
+
+  // AND the far cells are merged into one occupied cell
+  EXPECT_TRUE(tree->isNodeOccupied(tree->search(5.02, 0.02, 0.02)));
+  EXPECT_TRUE(tree->isNodeOccupied(tree->search(5.12, 0.02, 0.02)));
+}
+
+TEST(OccupancyMapMonitorTests, SaveAndLoadCompressedMap)
+{
+  // GIVEN a monitor with an occupied cell
+  auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
+  EXPECT_CALL(*mock_middleware_handle, getParameters)
+      .WillOnce(::testing::Return(occupancy_map_monitor::OccupancyMapMonitor::Parameters{ 0.1, "", {} }));
+  occupancy_map_monitor::OccupancyMapMonitor occupancy_map_monitor{ std::move(mock_middleware_handle), nullptr };
+  const collision_detection::OccMapTreePtr& tree = occupancy_map_monitor.getOcTreePtr();
+  tree->updateNode(1.02, 0.02, 0.02, true);
+
+  // WHEN the map is saved compressed, cleared and loaded again
+  const std::string filename = testing::TempDir() + "occupancy_map_monitor_test.bt.gz";
+  ASSERT_TRUE(occupancy_map_monitor.saveMapAsync(filename).get());
+  tree->clear();
+  ASSERT_EQ(tree->search(1.02, 0.02, 0.02), nullptr);
+  ASSERT_TRUE(occupancy_map_monitor.loadMap(filename));
+
+  // THEN the cell is occupied again
+  ASSERT_NE(tree->search(1.02, 0.02, 0.02), nullptr);
+  EXPECT_TRUE(tree->isNodeOccupied(tree->search(1.02, 0.02, 0.02)));
+
+  // AND loading a missing map fails
+  EXPECT_FALSE(occupancy_map_monitor.loadMap(filename + ".missing"));
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -42,6 +42,7 @@
 #include <moveit/mesh_filter/mesh_filter.h>
 #include <moveit/mesh_filter/stereo_camera_model.h>
 #include <moveit/lazy_free_space_updater/lazy_free_space_updater.h>
+#include <moveit/depth_image_octomap_updater/depth_image_update_batch.h>
 #include <image_transport/image_transport.hpp>
 #include <memory>
 
@@ -85,6 +86,7 @@ private:
   std::string ns_;
   std::string sensor_type_;
   std::string image_topic_;
+  std::string batch_group_;
   std::size_t queue_size_;
   double near_clipping_plane_distance_;
   double far_clipping_plane_distance_;
@@ -103,6 +105,10 @@ private:
   std::unique_ptr<mesh_filter::MeshFilter<mesh_filter::StereoCameraModel> > mesh_filter_;
   std::unique_ptr<LazyFreeSpaceUpdater> free_space_updater_;
 
+  /* shared with the other updaters of batch_group_, if one is set */
+  std::shared_ptr<DepthImageUpdateBatch> update_batch_;
+  unsigned int batch_member_;
+
   std::vector<double> x_cache_, y_cache_;
   double inv_fx_, inv_fy_, K0_, K2_, K4_, K5_;
   std::vector<unsigned int> filtered_labels_;
@@ -0,0 +1,94 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/collision_detection/occupancy_map.h>
+#include <moveit/lazy_free_space_updater/lazy_free_space_updater.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace occupancy_map_monitor
+{
+/** \brief Merges the occupied cells found by several depth image updaters into a single octree write per cycle.
+ *
+ * Updaters that share a batch submit their cells instead of locking the octree themselves. A cycle is written once
+ * every member has submitted, or earlier when a member submits again before the others caught up, so a camera that
+ * stopped publishing cannot hold back the rest. Cells any member labeled as part of the robot are not marked
+ * occupied. Free space is still cleared by each member's own LazyFreeSpaceUpdater, since it is computed per sensor
+ * origin. */
+class DepthImageUpdateBatch
+{
+public:
+  /** \brief Get the batch shared by all updaters of the given group writing to the given tree, creating it if needed */
+  static std::shared_ptr<DepthImageUpdateBatch> get(const std::string& group,
+                                                    const collision_detection::OccMapTreePtr& tree);
+
+  DepthImageUpdateBatch(const collision_detection::OccMapTreePtr& tree);
+  ~DepthImageUpdateBatch();
+
+  /** \brief Register a new member and return its id */
+  unsigned int join();
+
+  /** \brief Unregister a member. Cells still pending are written first */
+  void leave(unsigned int member);
+
+  /** \brief Submit the cells found by a member in one image. Ownership of the key sets is taken; they are passed on
+   * to \e free_space_updater once the cycle has been written to the octree. */
+  void submit(unsigned int member, octomap::KeySet* occupied_cells, octomap::KeySet* model_cells,
+              const octomap::point3d& sensor_origin, LazyFreeSpaceUpdater& free_space_updater);
+
+private:
+  struct Contribution
+  {
+    octomap::KeySet* occupied_cells;
+    octomap::KeySet* model_cells;
+    octomap::point3d sensor_origin;
+    LazyFreeSpaceUpdater* free_space_updater;
+  };
+
+  /** \brief Write all pending contributions to the octree. Must be called with lock_ held */
+  void flush();
+
+  collision_detection::OccMapTreePtr tree_;
+
+  std::mutex lock_;
+  unsigned int next_member_;
+  std::size_t member_count_;
+  std::map<unsigned int, Contribution> pending_;
+};
+}  // namespace occupancy_map_monitor
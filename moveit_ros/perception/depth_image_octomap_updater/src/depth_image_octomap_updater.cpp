@@ -71,12 +71,15 @@ DepthImageOctomapUpdater::DepthImageOctomapUpdater()
   , K2_(0.0)
   , K4_(0.0)
   , K5_(0.0)
+  , batch_member_(0)
 {
 }
 
 DepthImageOctomapUpdater::~DepthImageOctomapUpdater()
 {
   stopHelper();
+  if (update_batch_)
+    update_batch_->leave(batch_member_);
 }
 
 bool DepthImageOctomapUpdater::setParams(const std::string& name_space)
@@ -95,6 +98,8 @@ bool DepthImageOctomapUpdater::setParams(const std::string& name_space)
         node_->get_parameter(name_space + ".skip_horizontal_pixels", skip_horizontal_pixels_) &&
         node_->get_parameter(name_space + ".filtered_cloud_topic", filtered_cloud_topic_) &&
         node_->get_parameter(name_space + ".ns", ns_);
+    // Updaters that share a batch group write to the octree together, once per cycle
+    node_->get_parameter_or(name_space + ".batch_group", batch_group_, std::string());
     return true;
   }
   catch (const rclcpp::exceptions::InvalidParameterTypeException& e)
@@ -130,6 +135,13 @@ bool DepthImageOctomapUpdater::initialize(const rclcpp::Node::SharedPtr& node)
 
 void DepthImageOctomapUpdater::start()
 {
+  // parameters are only set after initialize(), so the batch is joined here
+  if (!batch_group_.empty() && !update_batch_)
+  {
+    update_batch_ = DepthImageUpdateBatch::get(batch_group_, tree_);
+    batch_member_ = update_batch_->join();
+  }
+
   pub_model_depth_image_ = model_depth_transport_->advertiseCamera("model_depth", 1);
 
   std::string prefix = "";
@@ -577,6 +589,14 @@ void DepthImageOctomapUpdater::depthImageCallback(const sensor_msgs::msg::Image:
   }
   tree_->unlockRead();
 
+  if (update_batch_)
+  {
+    // the batch marks the occupied cells of all its members at once, and frees the space afterwards
+    update_batch_->submit(batch_member_, occupied_cells_ptr, model_cells_ptr, sensor_origin, *free_space_updater_);
+    RCLCPP_DEBUG(LOGGER, "Processed depth image in %lf ms", (node_->now() - start).seconds() * 1000.0);
+    return;
+  }
+
   /* cells that overlap with the model are not occupied */
   for (const octomap::OcTreeKey& model_cell : model_cells)
     occupied_cells.erase(model_cell);
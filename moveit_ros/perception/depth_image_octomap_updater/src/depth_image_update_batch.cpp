@@ -0,0 +1,136 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/depth_image_octomap_updater/depth_image_update_batch.h>
+#include <rclcpp/logging.hpp>
+
+namespace occupancy_map_monitor
+{
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros.perception.depth_image_update_batch");
+
+std::shared_ptr<DepthImageUpdateBatch> DepthImageUpdateBatch::get(const std::string& group,
+                                                                  const collision_detection::OccMapTreePtr& tree)
+{
+  static std::mutex registry_lock;
+  static std::map<std::pair<const collision_detection::OccMapTree*, std::string>, std::weak_ptr<DepthImageUpdateBatch>>
+      registry;
+
+  std::scoped_lock _(registry_lock);
+  std::weak_ptr<DepthImageUpdateBatch>& entry = registry[std::make_pair(tree.get(), group)];
+  std::shared_ptr<DepthImageUpdateBatch> batch = entry.lock();
+  if (!batch)
+  {
+    batch = std::make_shared<DepthImageUpdateBatch>(tree);
+    entry = batch;
+  }
+  return batch;
+}
+
+DepthImageUpdateBatch::DepthImageUpdateBatch(const collision_detection::OccMapTreePtr& tree)
+  : tree_(tree), next_member_(0), member_count_(0)
+{
+}
+
+DepthImageUpdateBatch::~DepthImageUpdateBatch()
+{
+  std::scoped_lock _(lock_);
+  flush();
+}
+
+unsigned int DepthImageUpdateBatch::join()
+{
+  std::scoped_lock _(lock_);
+  ++member_count_;
+  return next_member_++;
+}
+
+void DepthImageUpdateBatch::leave(unsigned int member)
+{
+  std::scoped_lock _(lock_);
+  // the free space updaters of pending contributions may not outlive their member
+  flush();
+  if (member_count_ > 0)
+    --member_count_;
+  else
+    RCLCPP_ERROR(LOGGER, "Member %u left a depth image update batch it never joined", member);
+}
+
+void DepthImageUpdateBatch::submit(unsigned int member, octomap::KeySet* occupied_cells, octomap::KeySet* model_cells,
+                                   const octomap::point3d& sensor_origin, LazyFreeSpaceUpdater& free_space_updater)
+{
+  std::scoped_lock _(lock_);
+
+  // a member that is faster than the others does not wait for them
+  if (pending_.find(member) != pending_.end())
+    flush();
+
+  pending_[member] = Contribution{ occupied_cells, model_cells, sensor_origin, &free_space_updater };
+  if (pending_.size() >= member_count_)
+    flush();
+}
+
+void DepthImageUpdateBatch::flush()
+{
+  if (pending_.empty())
+    return;
+
+  /* cells that overlap with the model, as seen by any of the sensors, are not occupied */
+  for (std::pair<const unsigned int, Contribution>& contribution : pending_)
+    for (std::pair<const unsigned int, Contribution>& other : pending_)
+      for (const octomap::OcTreeKey& model_cell : *other.second.model_cells)
+        contribution.second.occupied_cells->erase(model_cell);
+
+  tree_->lockWrite();
+  try
+  {
+    /* now mark all occupied cells */
+    for (std::pair<const unsigned int, Contribution>& contribution : pending_)
+      for (const octomap::OcTreeKey& occupied_cell : *contribution.second.occupied_cells)
+        tree_->updateNode(occupied_cell, true);
+  }
+  catch (...)
+  {
+    RCLCPP_ERROR(LOGGER, "Internal error while updating octree");
+  }
+  tree_->unlockWrite();
+  tree_->triggerUpdateCallback();
+
+  // at this point we still have not freed the space
+  for (std::pair<const unsigned int, Contribution>& contribution : pending_)
+    contribution.second.free_space_updater->pushLazyUpdate(
+        contribution.second.occupied_cells, contribution.second.model_cells, contribution.second.sensor_origin);
+  pending_.clear();
+}
+}  // namespace occupancy_map_monitor
@@ -37,6 +37,7 @@
 #pragma once
 
 #include <moveit/collision_detection/occupancy_map.h>
+#include <atomic>
 #include <deque>
 #include <unordered_map>
 #include <condition_variable>
@@ -53,6 +54,13 @@ public:
   void pushLazyUpdate(octomap::KeySet* occupied_cells, octomap::KeySet* model_cells,
                       const octomap::point3d& sensor_origin);
 
+  /** \brief Release the write lock of the tree after updating this many cells of a batch and take it again, so
+      readers of the tree are not blocked for the whole batch. 0 (the default) updates a batch under one lock. */
+  void setMaxCellsPerWriteLock(std::size_t max_cells)
+  {
+    max_cells_per_write_lock_ = max_cells;
+  }
+
 private:
 #ifdef __APPLE__
   typedef std::unordered_map<octomap::OcTreeKey, unsigned int, octomap::OcTreeKey::KeyHash> OcTreeKeyCountMap;
@@ -72,6 +80,7 @@ private:
   bool running_;
   std::size_t max_batch_size_;
   double max_sensor_delta_;
+  std::atomic<std::size_t> max_cells_per_write_lock_;
 
   std::deque<octomap::KeySet*> occupied_cells_sets_;
   std::deque<octomap::KeySet*> model_cells_sets_;
@@ -35,9 +35,14 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/lazy_free_space_updater/lazy_free_space_updater.h>
+#include <moveit/utils/thread_placement.h>
 #include <rclcpp/logging.hpp>
 #include <rclcpp/clock.hpp>
 
+#include <omp.h>
+#include <utility>
+#include <vector>
+
 namespace occupancy_map_monitor
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros.perception.lazy_free_space_updater");
@@ -47,6 +52,7 @@ LazyFreeSpaceUpdater::LazyFreeSpaceUpdater(const collision_detection::OccMapTree
   , running_(true)
   , max_batch_size_(max_batch_size)
   , max_sensor_delta_(1e-3)  // 1mm
+  , max_cells_per_write_lock_(0)
   , process_occupied_cells_set_(nullptr)
   , process_model_cells_set_(nullptr)
   , update_thread_([this] { lazyUpdateThread(); })
@@ -106,16 +112,18 @@ void LazyFreeSpaceUpdater::pushBatchToProcess(OcTreeKeyCountMap* occupied_cells,
 
 void LazyFreeSpaceUpdater::processThread()
 {
+  moveit::core::configureCurrentThread(moveit::core::thread_roles::PERCEPTION, "moveit_free_proc");
   const float lg_0 = tree_->getClampingThresMinLog() - tree_->getClampingThresMaxLog();
   const float lg_miss = tree_->getProbMissLog();
 
-  octomap::KeyRay key_ray1, key_ray2;
-  OcTreeKeyCountMap free_cells1, free_cells2;
+  OcTreeKeyCountMap free_cells;
+  std::vector<std::pair<octomap::OcTreeKey, unsigned int>> ray_ends;
+  std::vector<OcTreeKeyCountMap> thread_free_cells;
 
   while (running_)
   {
-    free_cells1.clear();
-    free_cells2.clear();
+    free_cells.clear();
+    ray_ends.clear();
 
     std::unique_lock<std::mutex> ulock(cell_process_lock_);
     while (!process_occupied_cells_set_ && running_)
@@ -131,52 +139,69 @@ void LazyFreeSpaceUpdater::processThread()
 
     rclcpp::Clock clock;
     rclcpp::Time start = clock.now();
-    tree_->lockRead();
 
-#pragma omp sections
+    /* rays end at occupied cells, weighted by how often they were seen, and at model cells */
+    ray_ends.reserve(process_occupied_cells_set_->size() + process_model_cells_set_->size());
+    ray_ends.insert(ray_ends.end(), process_occupied_cells_set_->begin(), process_occupied_cells_set_->end());
+    for (const octomap::OcTreeKey& it : *process_model_cells_set_)
+      ray_ends.emplace_back(it, 1);
+
+    /* compute the free cells along each ray; every thread counts into its own map, so no locking is needed */
+    thread_free_cells.resize(omp_get_max_threads());
+    const std::ptrdiff_t ray_count = ray_ends.size();
+    tree_->lockRead();
+#pragma omp parallel
     {
-#pragma omp section
-      {
-        /* compute the free cells along each ray that ends at an occupied cell */
-        for (std::pair<const octomap::OcTreeKey, unsigned int>& it : *process_occupied_cells_set_)
-        {
-          if (tree_->computeRayKeys(process_sensor_origin_, tree_->keyToCoord(it.first), key_ray1))
-          {
-            for (octomap::OcTreeKey& jt : key_ray1)
-              free_cells1[jt] += it.second;
-          }
-        }
-      }
+      /* KeyRay pre-allocates a lot of memory in its constructor, so each thread keeps its own */
+      static thread_local octomap::KeyRay key_ray;
+      OcTreeKeyCountMap& cells = thread_free_cells[omp_get_thread_num()];
+      cells.clear();
 
-#pragma omp section
+#pragma omp for schedule(dynamic, 64)
+      for (std::ptrdiff_t i = 0; i < ray_count; ++i)
       {
-        /* compute the free cells along each ray that ends at a model cell */
-        for (const octomap::OcTreeKey& it : *process_model_cells_set_)
+        if (tree_->computeRayKeys(process_sensor_origin_, tree_->keyToCoord(ray_ends[i].first), key_ray))
         {
-          if (tree_->computeRayKeys(process_sensor_origin_, tree_->keyToCoord(it), key_ray2))
-          {
-            for (octomap::OcTreeKey& jt : key_ray2)
-              free_cells2[jt]++;
-          }
+          for (const octomap::OcTreeKey& jt : key_ray)
+            cells[jt] += ray_ends[i].second;
         }
       }
     }
-
     tree_->unlockRead();
 
-    for (std::pair<const octomap::OcTreeKey, unsigned int>& it : *process_occupied_cells_set_)
+    /* merge the thread maps once all threads are done */
+    for (OcTreeKeyCountMap& cells : thread_free_cells)
     {
-      free_cells1.erase(it.first);
-      free_cells2.erase(it.first);
+      if (free_cells.empty())
+      {
+        free_cells.swap(cells);
+      }
+      else
+      {
+        for (const std::pair<const octomap::OcTreeKey, unsigned int>& it : cells)
+          free_cells[it.first] += it.second;
+      }
+      cells.clear();
     }
 
-    for (const octomap::OcTreeKey& it : *process_model_cells_set_)
-    {
-      free_cells1.erase(it);
-      free_cells2.erase(it);
-    }
-    RCLCPP_DEBUG(LOGGER, "Marking %lu cells as free...",
-                 static_cast<long unsigned int>(free_cells1.size() + free_cells2.size()));
+    /* ray ends are not free */
+    for (const std::pair<octomap::OcTreeKey, unsigned int>& it : ray_ends)
+      free_cells.erase(it.first);
+    RCLCPP_DEBUG(LOGGER, "Marking %lu cells as free...", static_cast<long unsigned int>(free_cells.size()));
+
+    const std::size_t max_cells_per_write_lock = max_cells_per_write_lock_;
+    std::size_t cells_in_slice = 0;
+    const auto update_cell = [&](const octomap::OcTreeKey& key, float log_odds) {
+      if (max_cells_per_write_lock > 0 && ++cells_in_slice > max_cells_per_write_lock)
+      {
+        // let waiting readers in before the next slice
+        tree_->unlockWrite();
+        std::this_thread::yield();
+        tree_->lockWrite();
+        cells_in_slice = 1;
+      }
+      tree_->updateNode(key, log_odds);
+    };
 
     tree_->lockWrite();
 
@@ -184,13 +209,11 @@ void LazyFreeSpaceUpdater::processThread()
     {
       // set the logodds to the minimum for the cells that are part of the model
       for (const octomap::OcTreeKey& it : *process_model_cells_set_)
-        tree_->updateNode(it, lg_0);
+        update_cell(it, lg_0);
 
       /* mark free cells only if not seen occupied in this cloud */
-      for (std::pair<const octomap::OcTreeKey, unsigned int>& it : free_cells1)
-        tree_->updateNode(it.first, it.second * lg_miss);
-      for (std::pair<const octomap::OcTreeKey, unsigned int>& it : free_cells2)
-        tree_->updateNode(it.first, it.second * lg_miss);
+      for (const std::pair<const octomap::OcTreeKey, unsigned int>& it : free_cells)
+        update_cell(it.first, it.second * lg_miss);
     }
     catch (...)
     {
@@ -210,6 +233,7 @@ void LazyFreeSpaceUpdater::processThread()
 
 void LazyFreeSpaceUpdater::lazyUpdateThread()
 {
+  moveit::core::configureCurrentThread(moveit::core::thread_roles::PERCEPTION, "moveit_free_upd");
   OcTreeKeyCountMap* occupied_cells_set = nullptr;
   octomap::KeySet* model_cells_set = nullptr;
   octomap::point3d sensor_origin;
@@ -43,6 +43,7 @@
 #else
 #include <GL/gl.h>
 #endif
+#include <cstddef>
 #include <string>
 #include <thread>
 #include <mutex>
@@ -108,6 +109,15 @@ public:
    */
   void getDepthBuffer(double* buffer) const;
 
+  /**
+   * \brief starts an asynchronous transfer of the color and depth buffers into pixel buffer objects.
+   *        Subsequent calls to getColorBuffer and getDepthBuffer copy from these buffers instead of reading back
+   *        synchronously, until rendering starts again with begin(). Two sets of pixel buffers are used in turn, so
+   *        the transfer of one frame does not stall on the previous one still being copied out.
+   *        Does nothing if pixel buffer objects are not supported by the OpenGL context.
+   */
+  void startReadback();
+
   /**
    * \brief loads, compiles, links and adds GLSL shaders from files to the current OpenGL context.
    * \author Suat Gedikli (gedikli@willowgarage.com)
@@ -247,6 +257,14 @@ private:
    */
   void deleteFrameBuffers();
 
+  /**
+   * \brief copies the content of a pixel buffer object into client memory
+   * \param[in] pbo_id handle of the pixel buffer object
+   * \param[out] buffer pointer to memory of at least size bytes
+   * \param[in] size number of bytes to copy
+   */
+  void copyPixelBuffer(GLuint pbo_id, void* buffer, std::size_t size) const;
+
   /**
    * \brief create the OpenGL context if required. Only on context is created for each thread
    * \author Suat Gedikli (gedikli@willowgarage.com)
@@ -277,6 +295,18 @@ private:
   /** \brief handle to depth buffer*/
   GLuint depth_id_;
 
+  /** \brief handles to the pixel buffer objects receiving the color buffer, 0 if not supported*/
+  GLuint color_pbo_ids_[2];
+
+  /** \brief handles to the pixel buffer objects receiving the depth buffer, 0 if not supported*/
+  GLuint depth_pbo_ids_[2];
+
+  /** \brief index of the pixel buffer objects used by the last call to startReadback*/
+  unsigned readback_index_;
+
+  /** \brief whether the pixel buffer objects hold the content of the frame buffers*/
+  mutable bool readback_valid_;
+
   /** \brief handle to program that is currently used*/
   GLuint program_;
 
@@ -298,12 +328,29 @@ private:
   /** \brief y-coordinate of principal point of camera in pixels*/
   float cy_;
 
+  /** \brief OpenGL context of a thread, created either through a hidden GLUT window or headless through EGL */
+  struct GLContext
+  {
+    /** \brief number of renderers using this context*/
+    unsigned ref_count;
+
+    /** \brief handle of the GLUT window, 0 for EGL contexts*/
+    GLuint window_id;
+
+    /** \brief EGL context and surface handles, nullptr for GLUT contexts*/
+    void* egl_context;
+    void* egl_surface;
+  };
+
   /** \brief map from thread id to OpenGL context */
-  static std::map<std::thread::id, std::pair<unsigned, GLuint> > context;
+  static std::map<std::thread::id, GLContext> context;
 
   /* \brief lock for context map */
   static std::mutex context_lock;
 
   static bool glut_initialized;
+
+  /** \brief whether contexts are created headless through EGL. Decided once, when the first context is created */
+  static bool use_egl;
 };
 }  // namespace mesh_filter
@@ -42,7 +42,12 @@
 #include <GL/glut.h>
 #endif
 #include <GL/freeglut.h>
+#ifdef MOVEIT_MESH_FILTER_HAVE_EGL
+#include <EGL/egl.h>
+#endif
 #include <moveit/mesh_filter/gl_renderer.h>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <fstream>
 #include <stdexcept>
@@ -62,6 +67,10 @@ mesh_filter::GLRenderer::GLRenderer(unsigned width, unsigned height, double near
   , rbo_id_(0)
   , rgb_id_(0)
   , depth_id_(0)
+  , color_pbo_ids_{ 0, 0 }
+  , depth_pbo_ids_{ 0, 0 }
+  , readback_index_(0)
+  , readback_valid_(false)
   , program_(0)
   , near_(near)
   , far_(far)
@@ -166,6 +175,22 @@ void mesh_filter::GLRenderer::initFrameBuffers()
     throw runtime_error("Couldn't create frame buffer");
 
   glBindFramebuffer(GL_FRAMEBUFFER, 0);  // Unbind our frame buffer
+
+  if (GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object)
+  {
+    // both the RGBA color buffer and the float depth buffer use 4 bytes per pixel
+    const GLsizeiptr size = static_cast<GLsizeiptr>(width_) * height_ * 4;
+    glGenBuffers(2, color_pbo_ids_);
+    glGenBuffers(2, depth_pbo_ids_);
+    for (unsigned i = 0; i < 2; ++i)
+    {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, color_pbo_ids_[i]);
+      glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_pbo_ids_[i]);
+      glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
 }
 
 void mesh_filter::GLRenderer::deleteFrameBuffers()
@@ -179,11 +204,19 @@ void mesh_filter::GLRenderer::deleteFrameBuffers()
   if (rgb_id_)
     glDeleteTextures(1, &rgb_id_);
 
+  if (color_pbo_ids_[0])
+    glDeleteBuffers(2, color_pbo_ids_);
+  if (depth_pbo_ids_[0])
+    glDeleteBuffers(2, depth_pbo_ids_);
+
   rbo_id_ = fbo_id_ = depth_id_ = rgb_id_ = 0;
+  color_pbo_ids_[0] = color_pbo_ids_[1] = depth_pbo_ids_[0] = depth_pbo_ids_[1] = 0;
+  readback_valid_ = false;
 }
 
 void mesh_filter::GLRenderer::begin() const
 {
+  readback_valid_ = false;
   glPushAttrib(GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_POLYGON_BIT | GL_PIXEL_MODE_BIT);
   glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -206,8 +239,46 @@ void mesh_filter::GLRenderer::end() const
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void mesh_filter::GLRenderer::startReadback()
+{
+  if (!color_pbo_ids_[0])
+    return;
+
+  // alternate between the two sets of pixel buffers, so this transfer does not wait for the previous one
+  readback_index_ ^= 1;
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, color_pbo_ids_[readback_index_]);
+  glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_pbo_ids_[readback_index_]);
+  glReadPixels(0, 0, width_, height_, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  readback_valid_ = true;
+}
+
+void mesh_filter::GLRenderer::copyPixelBuffer(GLuint pbo_id, void* buffer, std::size_t size) const
+{
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_id);
+  const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+  if (data)
+  {
+    memcpy(buffer, data, size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (!data)
+    throw runtime_error("Could not map pixel buffer object");
+}
+
 void mesh_filter::GLRenderer::getColorBuffer(unsigned char* buffer) const
 {
+  if (readback_valid_)
+  {
+    copyPixelBuffer(color_pbo_ids_[readback_index_], buffer, static_cast<std::size_t>(width_) * height_ * 4);
+    return;
+  }
+
   glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
   glBindTexture(GL_TEXTURE_2D, rgb_id_);
   glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
@@ -216,6 +287,13 @@ void mesh_filter::GLRenderer::getColorBuffer(unsigned char* buffer) const
 
 void mesh_filter::GLRenderer::getDepthBuffer(double* buffer) const
 {
+  if (readback_valid_)
+  {
+    copyPixelBuffer(depth_pbo_ids_[readback_index_], buffer,
+                    static_cast<std::size_t>(width_) * height_ * sizeof(GLfloat));
+    return;
+  }
+
   glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
   glBindTexture(GL_TEXTURE_2D, depth_id_);
   glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, buffer);
@@ -357,15 +435,95 @@ GLuint mesh_filter::GLRenderer::loadShaders(const string& vertex_source, const s
   return program_id;
 }
 
-map<std::thread::id, pair<unsigned, GLuint> > mesh_filter::GLRenderer::context;
+map<std::thread::id, mesh_filter::GLRenderer::GLContext> mesh_filter::GLRenderer::context;
 std::mutex mesh_filter::GLRenderer::context_lock;
 bool mesh_filter::GLRenderer::glut_initialized = false;
+bool mesh_filter::GLRenderer::use_egl = false;
 
 namespace
 {
 void nullDisplayFunction()
 {
 }
+
+void initializeGLEW(bool headless)
+{
+  GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+  // GLEW built against GLX loads the OpenGL entry points before failing to find a GLX display,
+  // which does not exist for headless EGL contexts
+  if (headless && err == GLEW_ERROR_NO_GLX_DISPLAY)
+    err = GLEW_OK;
+#else
+  (void)headless;
+#endif
+  if (GLEW_OK != err)
+  {
+    stringstream error_stream;
+    error_stream << "Unable to initialize GLEW: " << glewGetErrorString(err);
+
+    throw(runtime_error(error_stream.str()));
+  }
+}
+
+#ifdef MOVEIT_MESH_FILTER_HAVE_EGL
+EGLDisplay egl_display = EGL_NO_DISPLAY;
+
+void createEGLContext(void*& egl_context, void*& egl_surface)
+{
+  if (egl_display == EGL_NO_DISPLAY)
+  {
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+      throw runtime_error("Unable to initialize EGL display");
+    RCLCPP_INFO(LOGGER, "No display available, rendering headless through EGL %d.%d", major, minor);
+    egl_display = display;
+  }
+
+  const EGLint config_attributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RED_SIZE,        8,
+                                       EGL_GREEN_SIZE,   8,               EGL_BLUE_SIZE,       8,
+                                       EGL_DEPTH_SIZE,   24,              EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                       EGL_NONE };
+  EGLConfig config;
+  EGLint num_configs = 0;
+  if (!eglChooseConfig(egl_display, config_attributes, &config, 1, &num_configs) || num_configs == 0)
+    throw runtime_error("Unable to find a suitable EGL configuration");
+
+  // the shaders and the fixed function calls of the filter need desktop OpenGL
+  if (!eglBindAPI(EGL_OPENGL_API))
+    throw runtime_error("Unable to bind the OpenGL API through EGL");
+
+  const EGLint surface_attributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+  EGLSurface surface = eglCreatePbufferSurface(egl_display, config, surface_attributes);
+  if (surface == EGL_NO_SURFACE)
+    throw runtime_error("Unable to create EGL pixel buffer surface");
+
+  EGLContext context = eglCreateContext(egl_display, config, EGL_NO_CONTEXT, nullptr);
+  if (context == EGL_NO_CONTEXT)
+  {
+    eglDestroySurface(egl_display, surface);
+    throw runtime_error("Unable to create EGL context");
+  }
+
+  if (!eglMakeCurrent(egl_display, surface, surface, context))
+  {
+    eglDestroyContext(egl_display, context);
+    eglDestroySurface(egl_display, surface);
+    throw runtime_error("Unable to make EGL context current");
+  }
+
+  egl_context = context;
+  egl_surface = surface;
+}
+
+void deleteEGLContext(void* egl_context, void* egl_surface)
+{
+  eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  eglDestroyContext(egl_display, egl_context);
+  eglDestroySurface(egl_display, egl_surface);
+}
+#endif
 }  // namespace
 
 void mesh_filter::GLRenderer::createGLContext()
@@ -373,53 +531,74 @@ void mesh_filter::GLRenderer::createGLContext()
   std::unique_lock<std::mutex> _(context_lock);
   if (!glut_initialized)
   {
-    char buffer[1];
-    char* args = buffer;
-    int n = 1;
+#ifdef MOVEIT_MESH_FILTER_HAVE_EGL
+    // GLUT aborts the process if it cannot connect to a display, so go headless when there is none
+    const char* display = std::getenv("DISPLAY");
+    use_egl = display == nullptr || display[0] == '\0';
+#endif
+    if (!use_egl)
+    {
+      char buffer[1];
+      char* args = buffer;
+      int n = 1;
 
-    glutInit(&n, &args);
-    glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB | GLUT_DEPTH);
+      glutInit(&n, &args);
+      glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB | GLUT_DEPTH);
+    }
     glut_initialized = true;
   }
 
   // check if our thread is initialized
   std::thread::id thread_id = std::this_thread::get_id();
-  map<std::thread::id, pair<unsigned, GLuint> >::iterator context_it = context.find(thread_id);
+  map<std::thread::id, GLContext>::iterator context_it = context.find(thread_id);
 
   if (context_it == context.end())
   {
-    context[thread_id] = std::pair<unsigned, GLuint>(1, 0);
+    GLContext thread_context{ 1, 0, nullptr, nullptr };
+
+#ifdef MOVEIT_MESH_FILTER_HAVE_EGL
+    if (use_egl)
+    {
+      createEGLContext(thread_context.egl_context, thread_context.egl_surface);
+      try
+      {
+        initializeGLEW(true);
+      }
+      catch (...)
+      {
+        deleteEGLContext(thread_context.egl_context, thread_context.egl_surface);
+        throw;
+      }
+      context[thread_id] = thread_context;
+      return;
+    }
+#endif
+
+    context[thread_id] = thread_context;
 
     glutInitWindowPosition(glutGet(GLUT_SCREEN_WIDTH) + 30000, 0);
     glutInitWindowSize(1, 1);
     GLuint window_id = glutCreateWindow("mesh_filter");
     glutDisplayFunc(nullDisplayFunction);
 
-    GLenum err = glewInit();
-    if (GLEW_OK != err)
-    {
-      stringstream error_stream;
-      error_stream << "Unable to initialize GLEW: " << glewGetErrorString(err);
-
-      throw(runtime_error(error_stream.str()));
-    }
+    initializeGLEW(false);
     glutIconifyWindow();
     glutHideWindow();
 
     for (int i = 0; i < 10; ++i)
       glutMainLoopEvent();
 
-    context[thread_id] = std::pair<unsigned, GLuint>(1, window_id);
+    context[thread_id].window_id = window_id;
   }
   else
-    ++(context_it->second.first);
+    ++(context_it->second.ref_count);
 }
 
 void mesh_filter::GLRenderer::deleteGLContext()
 {
   std::unique_lock<std::mutex> _(context_lock);
   std::thread::id thread_id = std::this_thread::get_id();
-  map<std::thread::id, pair<unsigned, GLuint> >::iterator context_it = context.find(thread_id);
+  map<std::thread::id, GLContext>::iterator context_it = context.find(thread_id);
   if (context_it == context.end())
   {
     stringstream error_msg;
@@ -427,9 +606,14 @@ void mesh_filter::GLRenderer::deleteGLContext()
     throw runtime_error(error_msg.str());
   }
 
-  if (--(context_it->second.first) == 0)
+  if (--(context_it->second.ref_count) == 0)
   {
-    glutDestroyWindow(context_it->second.second);
+#ifdef MOVEIT_MESH_FILTER_HAVE_EGL
+    if (context_it->second.egl_context)
+      deleteEGLContext(context_it->second.egl_context, context_it->second.egl_surface);
+    else
+#endif
+      glutDestroyWindow(context_it->second.window_id);
     context.erase(context_it);
   }
 }
@@ -37,6 +37,7 @@
 #include <moveit/mesh_filter/mesh_filter_base.h>
 #include <moveit/mesh_filter/gl_mesh.h>
 #include <moveit/mesh_filter/filter_job.h>
+#include <moveit/utils/thread_placement.h>
 
 #include <geometric_shapes/shapes.h>
 #include <geometric_shapes/shape_operations.h>
@@ -271,6 +272,7 @@ void mesh_filter::MeshFilterBase::run(const std::string& render_vertex_shader,
                                       const std::string& filter_vertex_shader,
                                       const std::string& filter_fragment_shader)
 {
+  moveit::core::configureCurrentThread(moveit::core::thread_roles::PERCEPTION, "moveit_mesh_flt");
   initialize(render_vertex_shader, render_fragment_shader, filter_vertex_shader, filter_fragment_shader);
 
   while (!stop_)
@@ -393,6 +395,10 @@ void mesh_filter::MeshFilterBase::doFilter(const void* sensor_data, const int en
   glBindTexture(GL_TEXTURE_2D, color_texture);
   glCallList(canvas_);
   depth_filter_->end();
+
+  // queue the transfer of the filtered labels and depth now, so it overlaps with whatever the caller does
+  // until it asks for the results
+  depth_filter_->startReadback();
 }
 
 void mesh_filter::MeshFilterBase::setPaddingOffset(float offset)
@@ -73,6 +73,9 @@ public:
 
   void setTransformCallback(const TransformCallback& transform_callback);
 
+  /** \brief Set the number of threads maskContainment() splits the cloud between. Defaults to 1. */
+  void setThreadCount(unsigned int thread_count);
+
   /** \brief Compute the containment mask (INSIDE or OUTSIDE) for a given pointcloud. If a mask element is INSIDE, the
      point
       is inside the robot. The point is outside if the mask element is OUTSIDE.
@@ -124,6 +127,24 @@ private:
   /** \brief Free memory. */
   void freeMemory();
 
+  /** \brief Pose the bodies and sort them into the grid. Returns false if no body could be posed. */
+  bool updateBodyGrid();
+
+  /** \brief The mask value of \e pt, testing only the bodies in its grid cell */
+  int computeMaskContainment(const Eigen::Vector3d& pt, double min_sensor_dist, double max_sensor_dist) const;
+
+  // the bodies posed by updateBodyGrid(), largest first, with their bounding spheres in bspheres_
+  std::vector<const bodies::Body*> posed_bodies_;
+
+  // uniform grid over the bounding spheres of posed_bodies_; each cell lists, in order, the indices of the bodies
+  // whose bounding spheres overlap it, so a point is only tested against the bodies near it
+  Eigen::Vector3d grid_origin_;
+  double grid_resolution_;
+  Eigen::Array3i grid_size_;
+  std::vector<std::vector<unsigned int>> grid_cells_;
+
+  unsigned int thread_count_;
+
   ShapeHandle next_handle_;
   ShapeHandle min_handle_;
   std::map<ShapeHandle, std::set<SeeShape, SortBodies>::iterator> used_handles_;
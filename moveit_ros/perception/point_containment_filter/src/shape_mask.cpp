@@ -40,10 +40,26 @@
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros.perception.shape_mask");
 
+// number of grid cells along the longest side of the robot's bounding box
+static const double GRID_CELLS_PER_AXIS = 16.0;
+// the least number of points a thread of maskContainment() works on
+static const std::size_t MIN_POINTS_PER_THREAD = 4096;
+
 point_containment_filter::ShapeMask::ShapeMask(const TransformCallback& transform_callback)
-  : transform_callback_(transform_callback), next_handle_(1), min_handle_(1)
+  : transform_callback_(transform_callback)
+  , grid_origin_(Eigen::Vector3d::Zero())
+  , grid_resolution_(1.0)
+  , grid_size_(Eigen::Array3i::Zero())
+  , thread_count_(1)
+  , next_handle_(1)
+  , min_handle_(1)
 {
 }
 
@@ -65,6 +81,12 @@ void point_containment_filter::ShapeMask::setTransformCallback(const TransformCa
   transform_callback_ = transform_callback;
 }
 
+void point_containment_filter::ShapeMask::setThreadCount(unsigned int thread_count)
+{
+  std::scoped_lock _(shapes_lock_);
+  thread_count_ = std::max(1u, thread_count);
+}
+
 point_containment_filter::ShapeHandle point_containment_filter::ShapeMask::addShape(const shapes::ShapeConstPtr& shape,
                                                                                     double scale, double padding)
 {
@@ -117,6 +139,87 @@ void point_containment_filter::ShapeMask::removeShape(ShapeHandle handle)
     RCLCPP_ERROR(LOGGER, "Unable to remove shape handle %u", handle);
 }
 
+bool point_containment_filter::ShapeMask::updateBodyGrid()
+{
+  Eigen::Isometry3d tmp;
+  posed_bodies_.clear();
+  bspheres_.clear();
+  for (std::set<SeeShape>::const_iterator it = bodies_.begin(); it != bodies_.end(); ++it)
+  {
+    if (!transform_callback_(it->handle, tmp))
+    {
+      if (!it->body)
+      {
+        RCLCPP_ERROR_STREAM(LOGGER, "Missing transform for shape with handle " << it->handle << " without a body");
+      }
+      else
+      {
+        RCLCPP_ERROR_STREAM(LOGGER,
+                            "Missing transform for shape " << it->body->getType() << " with handle " << it->handle);
+      }
+    }
+    else
+    {
+      it->body->setPose(tmp);
+      bspheres_.emplace_back();
+      it->body->computeBoundingSphere(bspheres_.back());
+      posed_bodies_.push_back(it->body);
+    }
+  }
+  if (posed_bodies_.empty())
+    return false;
+
+  // the grid covers the bounding box of all bounding spheres
+  Eigen::Vector3d min_corner = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+  Eigen::Vector3d max_corner = -min_corner;
+  for (const bodies::BoundingSphere& sphere : bspheres_)
+  {
+    min_corner = min_corner.cwiseMin(sphere.center - Eigen::Vector3d::Constant(sphere.radius));
+    max_corner = max_corner.cwiseMax(sphere.center + Eigen::Vector3d::Constant(sphere.radius));
+  }
+  grid_origin_ = min_corner;
+  grid_resolution_ = std::max((max_corner - min_corner).maxCoeff() / GRID_CELLS_PER_AXIS, 1e-3);
+  grid_size_ = ((max_corner - min_corner) / grid_resolution_).array().ceil().cast<int>().max(1);
+
+  grid_cells_.assign(static_cast<std::size_t>(grid_size_.prod()), std::vector<unsigned int>());
+  for (unsigned int i = 0; i < bspheres_.size(); ++i)
+  {
+    const bodies::BoundingSphere& sphere = bspheres_[i];
+    const Eigen::Array3i lo =
+        ((sphere.center.array() - sphere.radius - grid_origin_.array()) / grid_resolution_).floor().cast<int>().max(0);
+    const Eigen::Array3i hi = ((sphere.center.array() + sphere.radius - grid_origin_.array()) / grid_resolution_)
+                                  .floor()
+                                  .cast<int>()
+                                  .min(grid_size_ - 1);
+    for (int x = lo.x(); x <= hi.x(); ++x)
+      for (int y = lo.y(); y <= hi.y(); ++y)
+        for (int z = lo.z(); z <= hi.z(); ++z)
+          grid_cells_[(static_cast<std::size_t>(x) * grid_size_.y() + y) * grid_size_.z() + z].push_back(i);
+  }
+  return true;
+}
+
+int point_containment_filter::ShapeMask::computeMaskContainment(const Eigen::Vector3d& pt, double min_sensor_dist,
+                                                                double max_sensor_dist) const
+{
+  const double d = pt.norm();
+  if (d < min_sensor_dist || d > max_sensor_dist)
+    return CLIP;
+
+  const Eigen::Array3i cell = ((pt - grid_origin_).array() / grid_resolution_).floor().cast<int>();
+  if ((cell < 0).any() || (cell >= grid_size_).any())
+    return OUTSIDE;
+
+  for (unsigned int i : grid_cells_[(static_cast<std::size_t>(cell.x()) * grid_size_.y() + cell.y()) * grid_size_.z() +
+                                    cell.z()])
+  {
+    const bodies::BoundingSphere& sphere = bspheres_[i];
+    if ((sphere.center - pt).squaredNorm() <= sphere.radius * sphere.radius && posed_bodies_[i]->containsPoint(pt))
+      return INSIDE;
+  }
+  return OUTSIDE;
+}
+
 void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::msg::PointCloud2& data_in,
                                                           const Eigen::Vector3d& /*sensor_origin*/,
                                                           const double min_sensor_dist, const double max_sensor_dist,
@@ -126,69 +229,41 @@ void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::msg
   const unsigned int np = data_in.data.size() / data_in.point_step;
   mask.resize(np);
 
-  if (bodies_.empty())
+  if (bodies_.empty() || !updateBodyGrid())
   {
     std::fill(mask.begin(), mask.end(), static_cast<int>(OUTSIDE));
+    return;
   }
-  else
-  {
-    Eigen::Isometry3d tmp;
-    bspheres_.resize(bodies_.size());
-    std::size_t j = 0;
-    for (std::set<SeeShape>::const_iterator it = bodies_.begin(); it != bodies_.end(); ++it)
-    {
-      if (!transform_callback_(it->handle, tmp))
-      {
-        if (!it->body)
-        {
-          RCLCPP_ERROR_STREAM(LOGGER, "Missing transform for shape with handle " << it->handle << " without a body");
-        }
-        else
-        {
-          RCLCPP_ERROR_STREAM(LOGGER,
-                              "Missing transform for shape " << it->body->getType() << " with handle " << it->handle);
-        }
-      }
-      else
-      {
-        it->body->setPose(tmp);
-        it->body->computeBoundingSphere(bspheres_[j++]);
-      }
-    }
-
-    // compute a sphere that bounds the entire robot
-    bodies::BoundingSphere bound;
-    bodies::mergeBoundingSpheres(bspheres_, bound);
-    const double radius_squared = bound.radius * bound.radius;
 
-    // we now decide which points we keep
-    sensor_msgs::PointCloud2ConstIterator<float> iter_x(data_in, "x");
-    sensor_msgs::PointCloud2ConstIterator<float> iter_y(data_in, "y");
-    sensor_msgs::PointCloud2ConstIterator<float> iter_z(data_in, "z");
+  // we now decide which points we keep
+  sensor_msgs::PointCloud2ConstIterator<float> iter_x(data_in, "x");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_y(data_in, "y");
+  sensor_msgs::PointCloud2ConstIterator<float> iter_z(data_in, "z");
 
-    // Cloud iterators are not incremented in the for loop, because of the pragma
-    // Comment out below parallelization as it can result in very high CPU consumption
-    //#pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < static_cast<int>(np); ++i)
+  // each thread works on a contiguous range of points; the bodies are only read
+  const auto mask_range = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
     {
-      Eigen::Vector3d pt = Eigen::Vector3d(*(iter_x + i), *(iter_y + i), *(iter_z + i));
-      double d = pt.norm();
-      int out = OUTSIDE;
-      if (d < min_sensor_dist || d > max_sensor_dist)
-      {
-        out = CLIP;
-      }
-      else if ((bound.center - pt).squaredNorm() < radius_squared)
-      {
-        for (std::set<SeeShape>::const_iterator it = bodies_.begin(); it != bodies_.end() && out == OUTSIDE; ++it)
-        {
-          if (it->body->containsPoint(pt))
-            out = INSIDE;
-        }
-      }
-      mask[i] = out;
+      const Eigen::Vector3d pt(*(iter_x + i), *(iter_y + i), *(iter_z + i));
+      mask[i] = computeMaskContainment(pt, min_sensor_dist, max_sensor_dist);
     }
+  };
+
+  const std::size_t thread_count =
+      std::max<std::size_t>(1, std::min<std::size_t>(thread_count_, np / MIN_POINTS_PER_THREAD));
+  if (thread_count == 1)
+  {
+    mask_range(0, np);
+    return;
   }
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (std::size_t t = 1; t < thread_count; ++t)
+    threads.emplace_back(mask_range, np * t / thread_count, np * (t + 1) / thread_count);
+  mask_range(0, np / thread_count);
+  for (std::thread& thread : threads)
+    thread.join();
 }
 
 int point_containment_filter::ShapeMask::getMaskContainment(const Eigen::Vector3d& pt) const
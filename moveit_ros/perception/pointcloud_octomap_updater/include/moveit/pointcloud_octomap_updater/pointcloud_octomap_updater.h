@@ -45,6 +45,7 @@
 #include <moveit/point_containment_filter/shape_mask.h>
 
 #include <memory>
+#include <vector>
 
 namespace occupancy_map_monitor
 {
@@ -88,6 +89,7 @@ private:
   double padding_;
   double max_range_;
   unsigned int point_subsample_;
+  bool voxel_filter_;
   double max_update_rate_;
   std::string filtered_cloud_topic_;
   std::string ns_;
@@ -96,9 +98,19 @@ private:
   message_filters::Subscriber<sensor_msgs::msg::PointCloud2>* point_cloud_subscriber_;
   tf2_ros::MessageFilter<sensor_msgs::msg::PointCloud2>* point_cloud_filter_;
 
-  /* used to store all cells in the map which a given ray passes through during raycasting.
-     we cache this here because it dynamically pre-allocates a lot of memory in its constructor */
-  octomap::KeyRay key_ray_;
+  /* per-cloud scratch buffers, kept as members so their memory is reused between callbacks.
+     the key vectors are sorted and free of duplicates once a cloud has been processed */
+  std::vector<octomap::OcTreeKey> occupied_keys_;
+  std::vector<octomap::OcTreeKey> model_keys_;
+  std::vector<octomap::OcTreeKey> ray_end_keys_;
+  std::vector<octomap::OcTreeKey> free_keys_;
+  Eigen::Matrix3Xf sensor_points_;
+  Eigen::Matrix3Xd map_points_;
+
+  /* with voxel_filter_, the first point of each octree cell in the sensor frame, and the cells in the same order */
+  sensor_msgs::msg::PointCloud2 voxel_cloud_;
+  std::vector<octomap::OcTreeKey> voxel_keys_;
+  octomap::KeySet voxel_key_set_;
 
   std::unique_ptr<point_containment_filter::ShapeMask> shape_mask_;
   std::vector<int> mask_;
@@ -44,17 +44,103 @@
 #include <tf2_ros/create_timer_interface.h>
 #include <tf2_ros/create_timer_ros.h>
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 namespace occupancy_map_monitor
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros.perception.pointcloud_octomap_updater");
+
+namespace
+{
+/* rays are only compacted once a thread has collected this many keys since the last compaction */
+constexpr std::size_t MIN_RAY_KEYS_BEFORE_COMPACTION = 1 << 20;
+
+struct OcTreeKeyLess
+{
+  bool operator()(const octomap::OcTreeKey& a, const octomap::OcTreeKey& b) const
+  {
+    if (a[0] != b[0])
+      return a[0] < b[0];
+    if (a[1] != b[1])
+      return a[1] < b[1];
+    return a[2] < b[2];
+  }
+};
+
+void sortUniqueKeys(std::vector<octomap::OcTreeKey>& keys)
+{
+  std::sort(keys.begin(), keys.end(), OcTreeKeyLess());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+/* remove from the sorted vector keys every element of the sorted vector remove */
+void eraseSortedKeys(std::vector<octomap::OcTreeKey>& keys, const std::vector<octomap::OcTreeKey>& remove)
+{
+  const OcTreeKeyLess less;
+  auto out = keys.begin();
+  auto rit = remove.begin();
+  for (auto it = keys.begin(); it != keys.end(); ++it)
+  {
+    while (rit != remove.end() && less(*rit, *it))
+      ++rit;
+    if (rit == remove.end() || less(*it, *rit))
+      *out++ = *it;
+  }
+  keys.erase(out, keys.end());
+}
+
+/* byte offset of a float32 field, or -1 if the cloud has no such field */
+int findFieldOffset(const sensor_msgs::msg::PointCloud2& cloud, const std::string& name)
+{
+  for (const sensor_msgs::msg::PointField& field : cloud.fields)
+    if (field.name == name && field.datatype == sensor_msgs::msg::PointField::FLOAT32)
+      return field.offset;
+  return -1;
+}
+
+/* cast one ray per end point and collect the sorted, unique keys of the cells the rays traverse.
+   The tree must be locked for reading by the caller. */
+void computeFreeKeys(const octomap::OcTree& tree, const octomap::point3d& origin,
+                     const std::vector<octomap::OcTreeKey>& ray_ends, std::vector<octomap::OcTreeKey>& free_keys)
+{
+  const std::ptrdiff_t count = ray_ends.size();
+#pragma omp parallel
+  {
+    /* KeyRay pre-allocates a lot of memory in its constructor, so each thread keeps its own */
+    static thread_local octomap::KeyRay key_ray;
+    std::vector<octomap::OcTreeKey> thread_keys;
+    std::size_t compaction_size = MIN_RAY_KEYS_BEFORE_COMPACTION;
+
+#pragma omp for schedule(dynamic, 64) nowait
+    for (std::ptrdiff_t i = 0; i < count; ++i)
+    {
+      if (!tree.computeRayKeys(origin, tree.keyToCoord(ray_ends[i]), key_ray))
+        continue;
+      thread_keys.insert(thread_keys.end(), key_ray.begin(), key_ray.end());
+      // rays from the same origin overlap heavily, so deduplicate before the vector grows too large
+      if (thread_keys.size() > compaction_size)
+      {
+        sortUniqueKeys(thread_keys);
+        compaction_size = thread_keys.size() + MIN_RAY_KEYS_BEFORE_COMPACTION;
+      }
+    }
+
+#pragma omp critical
+    free_keys.insert(free_keys.end(), thread_keys.begin(), thread_keys.end());
+  }
+  sortUniqueKeys(free_keys);
+}
+}  // namespace
+
 PointCloudOctomapUpdater::PointCloudOctomapUpdater()
   : OccupancyMapUpdater("PointCloudUpdater")
   , scale_(1.0)
   , padding_(0.0)
   , max_range_(std::numeric_limits<double>::infinity())
   , point_subsample_(1)
+  , voxel_filter_(false)
   , max_update_rate_(0)
   , point_cloud_subscriber_(nullptr)
   , point_cloud_filter_(nullptr)
@@ -70,6 +156,7 @@ bool PointCloudOctomapUpdater::setParams(const std::string& name_space)
 {
   // This parameter is optional
   node_->get_parameter_or(name_space + ".ns", ns_, std::string());
+  node_->get_parameter_or(name_space + ".voxel_filter", voxel_filter_, false);
   return node_->get_parameter(name_space + ".point_cloud_topic", point_cloud_topic_) &&
          node_->get_parameter(name_space + ".max_range", max_range_) &&
          node_->get_parameter(name_space + ".padding_offset", padding_) &&
@@ -227,11 +314,134 @@ void PointCloudOctomapUpdater::cloudMsgCallback(const sensor_msgs::msg::PointClo
   if (!updateTransformCache(cloud_msg->header.frame_id, cloud_msg->header.stamp))
     return;
 
+  /* the x, y and z coordinates are read as three consecutive floats starting at the "x" field */
+  const int x_offset = findFieldOffset(*cloud_msg, "x");
+  if (x_offset < 0)
+  {
+    RCLCPP_ERROR(LOGGER, "Point cloud has no float32 'x' field; quitting callback");
+    return;
+  }
+
+  /* the message buffer can be mapped in place when every point starts on a float boundary;
+     otherwise each row is copied into a scratch matrix first */
+  const std::size_t point_stride = static_cast<std::size_t>(point_subsample_) * cloud_msg->point_step;
+  const bool mappable = cloud_msg->point_step % sizeof(float) == 0 && static_cast<std::size_t>(x_offset) % sizeof(float) == 0 &&
+                        reinterpret_cast<std::uintptr_t>(cloud_msg->data.data()) % alignof(float) == 0;
+
+  Eigen::Isometry3d map_h_sensor_eigen;
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+      map_h_sensor_eigen.linear()(i, j) = map_h_sensor.getBasis()[i][j];
+    map_h_sensor_eigen.translation()[i] = sensor_origin_eigen[i];
+  }
+  map_h_sensor_eigen.makeAffine();
+
+  /* call process_row(row_c, sensor_points) for every subsampled row, where row_c is the index of the row's first
+     point and sensor_points holds the row's points in the sensor frame; map_points_ holds them in the map frame */
+  const auto for_each_row = [&](const auto& process_row) {
+    for (unsigned int row = 0; row < cloud_msg->height; row += point_subsample_)
+    {
+      const unsigned int row_c = row * cloud_msg->width;
+      const uint8_t* row_data = cloud_msg->data.data() + static_cast<std::size_t>(row_c) * cloud_msg->point_step + x_offset;
+      const Eigen::Index row_points = (cloud_msg->width + point_subsample_ - 1) / point_subsample_;
+
+      const float* row_floats;
+      Eigen::Index column_stride;
+      if (mappable)
+      {
+        row_floats = reinterpret_cast<const float*>(row_data);
+        column_stride = point_stride / sizeof(float);
+      }
+      else
+      {
+        sensor_points_.resize(3, row_points);
+        for (Eigen::Index i = 0; i < row_points; ++i)
+          std::memcpy(sensor_points_.col(i).data(), row_data + i * point_stride, 3 * sizeof(float));
+        row_floats = sensor_points_.data();
+        column_stride = 3;
+      }
+      const Eigen::Map<const Eigen::Matrix3Xf, 0, Eigen::OuterStride<>> sensor_points(
+          row_floats, 3, row_points, Eigen::OuterStride<>(column_stride));
+
+      /* transform the whole row to the map frame at once */
+      map_points_.resize(3, row_points);
+      map_points_.noalias() = map_h_sensor_eigen.linear() * sensor_points.cast<double>();
+      map_points_.colwise() += map_h_sensor_eigen.translation();
+
+      process_row(row_c, sensor_points);
+    }
+  };
+
+  /* key of the end point of a ray clipped to the maximum range */
+  const auto clipped_key = [&](const auto& sensor_point) {
+    const Eigen::Vector3d clipped_point =
+        map_h_sensor_eigen * (sensor_point.template cast<double>().normalized() * max_range_);
+    return tree_->coordToKey(clipped_point.x(), clipped_point.y(), clipped_point.z());
+  };
+
+  occupied_keys_.clear();
+  model_keys_.clear();
+  ray_end_keys_.clear();
+  free_keys_.clear();
+
+  /* with the voxel filter, only the first point that falls into each octree cell is self-filtered and added to the
+     map; points beyond the maximum range are not masked at all and only contribute the end of their clipped ray */
+  const sensor_msgs::msg::PointCloud2* masked_cloud = cloud_msg.get();
+  if (voxel_filter_)
+  {
+    voxel_keys_.clear();
+    voxel_key_set_.clear();
+    voxel_cloud_.header = cloud_msg->header;
+    sensor_msgs::PointCloud2Modifier voxel_modifier(voxel_cloud_);
+    voxel_modifier.setPointCloud2FieldsByString(1, "xyz");
+    voxel_modifier.resize(cloud_msg->width * cloud_msg->height);
+    sensor_msgs::PointCloud2Iterator<float> iter_voxel_x(voxel_cloud_, "x");
+    sensor_msgs::PointCloud2Iterator<float> iter_voxel_y(voxel_cloud_, "y");
+    sensor_msgs::PointCloud2Iterator<float> iter_voxel_z(voxel_cloud_, "z");
+
+    tree_->lockRead();
+    try
+    {
+      for_each_row([&](unsigned int /*row_c*/, const auto& sensor_points) {
+        for (Eigen::Index i = 0; i < sensor_points.cols(); ++i)
+        {
+          const auto sensor_point = sensor_points.col(i);
+          if (sensor_point.hasNaN())
+            continue;
+          if (sensor_point.template cast<double>().norm() > max_range_)
+          {
+            ray_end_keys_.push_back(clipped_key(sensor_point));
+            continue;
+          }
+          const octomap::OcTreeKey key = tree_->coordToKey(map_points_(0, i), map_points_(1, i), map_points_(2, i));
+          if (!voxel_key_set_.insert(key).second)
+            continue;
+          voxel_keys_.push_back(key);
+          *iter_voxel_x = sensor_point[0];
+          *iter_voxel_y = sensor_point[1];
+          *iter_voxel_z = sensor_point[2];
+          ++iter_voxel_x;
+          ++iter_voxel_y;
+          ++iter_voxel_z;
+        }
+      });
+    }
+    catch (...)
+    {
+      tree_->unlockRead();
+      return;
+    }
+    tree_->unlockRead();
+
+    voxel_modifier.resize(voxel_keys_.size());
+    masked_cloud = &voxel_cloud_;
+  }
+
   /* mask out points on the robot */
-  shape_mask_->maskContainment(*cloud_msg, sensor_origin_eigen, 0.0, max_range_, mask_);
-  updateMask(*cloud_msg, sensor_origin_eigen, mask_);
+  shape_mask_->maskContainment(*masked_cloud, sensor_origin_eigen, 0.0, max_range_, mask_);
+  updateMask(*masked_cloud, sensor_origin_eigen, mask_);
 
-  octomap::KeySet free_cells, occupied_cells, model_cells, clip_cells;
   std::unique_ptr<sensor_msgs::msg::PointCloud2> filtered_cloud;
 
   // We only use these iterators if we are creating a filtered_cloud for
@@ -256,82 +466,85 @@ void PointCloudOctomapUpdater::cloudMsgCallback(const sensor_msgs::msg::PointClo
   }
   size_t filtered_cloud_size = 0;
 
+  // build list of valid points if we want to publish them
+  const auto add_filtered_point = [&](float x, float y, float z) {
+    if (!filtered_cloud)
+      return;
+    **iter_filtered_x = x;
+    **iter_filtered_y = y;
+    **iter_filtered_z = z;
+    ++filtered_cloud_size;
+    ++*iter_filtered_x;
+    ++*iter_filtered_y;
+    ++*iter_filtered_z;
+  };
+
   tree_->lockRead();
 
   try
   {
-    /* do ray tracing to find which cells this point cloud indicates should be free, and which it indicates
-     * should be occupied */
-    for (unsigned int row = 0; row < cloud_msg->height; row += point_subsample_)
+    if (voxel_filter_)
     {
-      unsigned int row_c = row * cloud_msg->width;
-      sensor_msgs::PointCloud2ConstIterator<float> pt_iter(*cloud_msg, "x");
-      // set iterator to point at start of the current row
-      pt_iter += row_c;
-
-      for (unsigned int col = 0; col < cloud_msg->width; col += point_subsample_, pt_iter += point_subsample_)
+      /* the cells of the voxel cloud are already known, only their mask is needed */
+      sensor_msgs::PointCloud2ConstIterator<float> iter_voxel_x(voxel_cloud_, "x");
+      sensor_msgs::PointCloud2ConstIterator<float> iter_voxel_y(voxel_cloud_, "y");
+      sensor_msgs::PointCloud2ConstIterator<float> iter_voxel_z(voxel_cloud_, "z");
+      for (std::size_t i = 0; i < voxel_keys_.size(); ++i, ++iter_voxel_x, ++iter_voxel_y, ++iter_voxel_z)
       {
-        // if (mask_[row_c + col] == point_containment_filter::ShapeMask::CLIP)
-        //  continue;
-
-        /* check for NaN */
-        if (!std::isnan(pt_iter[0]) && !std::isnan(pt_iter[1]) && !std::isnan(pt_iter[2]))
+        if (mask_[i] == point_containment_filter::ShapeMask::INSIDE)
+        {
+          model_keys_.push_back(voxel_keys_[i]);
+        }
+        else if (mask_[i] == point_containment_filter::ShapeMask::OUTSIDE)
+        {
+          occupied_keys_.push_back(voxel_keys_[i]);
+          add_filtered_point(*iter_voxel_x, *iter_voxel_y, *iter_voxel_z);
+        }
+      }
+    }
+    else
+    {
+      /* find the cells this point cloud indicates should be occupied, and the end points of the rays
+       * along which cells should be free */
+      for_each_row([&](unsigned int row_c, const auto& sensor_points) {
+        for (Eigen::Index i = 0; i < sensor_points.cols(); ++i)
         {
+          const unsigned int col = static_cast<unsigned int>(i) * point_subsample_;
+          const auto sensor_point = sensor_points.col(i);
+
+          /* check for NaN */
+          if (sensor_point.hasNaN())
+            continue;
+
           /* occupied cell at ray endpoint if ray is shorter than max range and this point
              isn't on a part of the robot*/
           if (mask_[row_c + col] == point_containment_filter::ShapeMask::INSIDE)
           {
-            // transform to map frame
-            tf2::Vector3 point_tf = map_h_sensor * tf2::Vector3(pt_iter[0], pt_iter[1], pt_iter[2]);
-            model_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
+            model_keys_.push_back(tree_->coordToKey(map_points_(0, i), map_points_(1, i), map_points_(2, i)));
           }
           else if (mask_[row_c + col] == point_containment_filter::ShapeMask::CLIP)
           {
-            tf2::Vector3 clipped_point_tf =
-                map_h_sensor * (tf2::Vector3(pt_iter[0], pt_iter[1], pt_iter[2]).normalize() * max_range_);
-            clip_cells.insert(
-                tree_->coordToKey(clipped_point_tf.getX(), clipped_point_tf.getY(), clipped_point_tf.getZ()));
+            ray_end_keys_.push_back(clipped_key(sensor_point));
           }
           else
           {
-            tf2::Vector3 point_tf = map_h_sensor * tf2::Vector3(pt_iter[0], pt_iter[1], pt_iter[2]);
-            occupied_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
-            // build list of valid points if we want to publish them
-            if (filtered_cloud)
-            {
-              **iter_filtered_x = pt_iter[0];
-              **iter_filtered_y = pt_iter[1];
-              **iter_filtered_z = pt_iter[2];
-              ++filtered_cloud_size;
-              ++*iter_filtered_x;
-              ++*iter_filtered_y;
-              ++*iter_filtered_z;
-            }
+            occupied_keys_.push_back(tree_->coordToKey(map_points_(0, i), map_points_(1, i), map_points_(2, i)));
+            add_filtered_point(sensor_point[0], sensor_point[1], sensor_point[2]);
           }
         }
-      }
+      });
     }
 
-    /* compute the free cells along each ray that ends at an occupied cell */
-    for (const octomap::OcTreeKey& occupied_cell : occupied_cells)
-    {
-      if (tree_->computeRayKeys(sensor_origin, tree_->keyToCoord(occupied_cell), key_ray_))
-        free_cells.insert(key_ray_.begin(), key_ray_.end());
-    }
+    sortUniqueKeys(occupied_keys_);
+    sortUniqueKeys(model_keys_);
 
-    /* compute the free cells along each ray that ends at a model cell */
-    for (const octomap::OcTreeKey& model_cell : model_cells)
-    {
-      if (tree_->computeRayKeys(sensor_origin, tree_->keyToCoord(model_cell), key_ray_))
-        free_cells.insert(key_ray_.begin(), key_ray_.end());
-    }
+    /* rays end at occupied, model and clipped cells alike */
+    ray_end_keys_.insert(ray_end_keys_.end(), occupied_keys_.begin(), occupied_keys_.end());
+    ray_end_keys_.insert(ray_end_keys_.end(), model_keys_.begin(), model_keys_.end());
+    sortUniqueKeys(ray_end_keys_);
 
-    /* compute the free cells along each ray that ends at a clipped cell */
-    for (const octomap::OcTreeKey& clip_cell : clip_cells)
-    {
-      if (tree_->computeRayKeys(sensor_origin, tree_->keyToCoord(clip_cell), key_ray_))
-        free_cells.insert(key_ray_.begin(), key_ray_.end());
-    }
+    /* compute the free cells along each ray */
+    computeFreeKeys(*tree_, sensor_origin, ray_end_keys_, free_keys_);
   }
   catch (...)
   {
@@ -342,28 +555,26 @@ void PointCloudOctomapUpdater::cloudMsgCallback(const sensor_msgs::msg::PointClo
   tree_->unlockRead();
 
   /* cells that overlap with the model are not occupied */
-  for (const octomap::OcTreeKey& model_cell : model_cells)
-    occupied_cells.erase(model_cell);
+  eraseSortedKeys(occupied_keys_, model_keys_);
 
   /* occupied cells are not free */
-  for (const octomap::OcTreeKey& occupied_cell : occupied_cells)
-    free_cells.erase(occupied_cell);
+  eraseSortedKeys(free_keys_, occupied_keys_);
 
   tree_->lockWrite();
 
   try
   {
     /* mark free cells only if not seen occupied in this cloud */
-    for (const octomap::OcTreeKey& free_cell : free_cells)
+    for (const octomap::OcTreeKey& free_cell : free_keys_)
       tree_->updateNode(free_cell, false);
 
     /* now mark all occupied cells */
-    for (const octomap::OcTreeKey& occupied_cell : occupied_cells)
+    for (const octomap::OcTreeKey& occupied_cell : occupied_keys_)
       tree_->updateNode(occupied_cell, true);
 
     // set the logodds to the minimum for the cells that are part of the model
     const float lg = tree_->getClampingThresMinLog() - tree_->getClampingThresMaxLog();
-    for (const octomap::OcTreeKey& model_cell : model_cells)
+    for (const octomap::OcTreeKey& model_cell : model_keys_)
       tree_->updateNode(model_cell, lg);
   }
   catch (...)
@@ -41,7 +41,13 @@
 #include <moveit/planning_scene/planning_scene.h>
 #include <object_recognition_msgs/msg/table_array.hpp>
 #include <moveit_msgs/msg/collision_object.hpp>
+#include <condition_variable>
+#include <map>
 #include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace shapes
 {
@@ -69,6 +75,11 @@ public:
    */
   SemanticWorld(const rclcpp::Node::SharedPtr& node, const planning_scene::PlanningSceneConstPtr& planning_scene);
 
+  ~SemanticWorld();
+
+  SemanticWorld(const SemanticWorld&) = delete;
+  SemanticWorld& operator=(const SemanticWorld&) = delete;
+
   /**
    * @brief Get all the tables within a region of interest
    */
@@ -106,6 +117,10 @@ public:
    * specified height above the table (in meters) and then at subsequent additional heights (num_heights
    * times) incremented by delta_height. Locations are only accepted if they are at least min_distance_from_edge
    * meters from the edge of the table.
+   *
+   * The grid locations and their distances from the edge are cached per table contour and resolution, so repeated
+   * queries and tables that only moved do not sample the contour again. When new tables arrive, their grids are
+   * computed in the background for the resolutions queried before.
    */
   std::vector<geometry_msgs::msg::PoseStamped> generatePlacePoses(const object_recognition_msgs::msg::Table& table,
                                                                   double resolution, double height_above_table,
@@ -132,6 +147,31 @@ public:
                             double min_distance_from_edge = 0.0, double min_vertical_offset = 0.0) const;
 
 private:
+  /** @brief The locations sampled on a table contour, in the table frame */
+  struct PlaceGrid
+  {
+    /** @brief The x and y coordinates of each location */
+    std::vector<std::pair<double, double>> locations;
+
+    /** @brief The distance of each location from the table edge, scaled as by cv::pointPolygonTest */
+    std::vector<double> edge_distances;
+  };
+  using PlaceGridConstPtr = std::shared_ptr<const PlaceGrid>;
+
+  /** @brief Key of a cached grid: the table contour and the resolution */
+  using PlaceGridKey = std::pair<std::vector<double>, double>;
+
+  static PlaceGridKey placeGridKey(const object_recognition_msgs::msg::Table& table, double resolution);
+
+  /** @brief Sample the contour of \e table in a grid at \e resolution */
+  static PlaceGridConstPtr computePlaceGrid(const object_recognition_msgs::msg::Table& table, double resolution);
+
+  /** @brief Get the cached grid of \e table at \e resolution, computing it if needed */
+  PlaceGridConstPtr getPlaceGrid(const object_recognition_msgs::msg::Table& table, double resolution) const;
+
+  /** @brief Compute the grids of tables queued by tableCallback() for the resolutions queried so far */
+  void placeGridThread();
+
   shapes::Mesh* createSolidMeshFromPlanarPolygon(const shapes::Mesh& polygon, double thickness) const;
 
   shapes::Mesh* orientPlanarPolygon(const shapes::Mesh& polygon) const;
@@ -158,6 +198,14 @@ private:
   TableCallbackFn table_callback_;
 
   rclcpp::Publisher<moveit_msgs::msg::PlanningScene>::SharedPtr planning_scene_diff_publisher_;
+
+  mutable std::mutex place_grid_lock_;
+  mutable std::map<PlaceGridKey, PlaceGridConstPtr> place_grids_;
+  mutable std::set<double> place_grid_resolutions_;
+  std::vector<object_recognition_msgs::msg::Table> pending_place_grid_tables_;
+  std::condition_variable place_grid_condition_;
+  bool stop_place_grid_thread_ = false;
+  std::thread place_grid_thread_;
 };
 }  // namespace semantic_world
 }  // namespace moveit
@@ -78,6 +78,17 @@ SemanticWorld::SemanticWorld(const rclcpp::Node::SharedPtr& node,
   collision_object_publisher_ =
       node_handle_->create_publisher<moveit_msgs::msg::CollisionObject>("/collision_object", 20);
   planning_scene_diff_publisher_ = node_handle_->create_publisher<moveit_msgs::msg::PlanningScene>("planning_scene", 1);
+  place_grid_thread_ = std::thread([this] { placeGridThread(); });
+}
+
+SemanticWorld::~SemanticWorld()
+{
+  {
+    std::scoped_lock lock(place_grid_lock_);
+    stop_place_grid_thread_ = true;
+  }
+  place_grid_condition_.notify_all();
+  place_grid_thread_.join();
 }
 
 visualization_msgs::msg::MarkerArray
@@ -330,6 +341,54 @@ SemanticWorld::generatePlacePoses(const object_recognition_msgs::msg::Table& tab
   // Assumption that the table's normal is along the Z axis
   if (table.convex_hull.empty())
     return place_poses;
+  const PlaceGridConstPtr grid = getPlaceGrid(table, resolution);
+  if (!grid)
+    return place_poses;
+
+  // the grid is in the table frame, so a table that moved only needs the new pose
+  const int scale_factor = 100;
+  Eigen::Isometry3d pose;
+  tf2::fromMsg(table.pose, pose);
+  for (std::size_t i = 0; i < grid->locations.size(); ++i)
+  {
+    if (static_cast<int>(grid->edge_distances[i]) < static_cast<int>(min_distance_from_edge * scale_factor))
+      continue;
+    for (std::size_t mm = 0; mm < num_heights; ++mm)
+    {
+      const Eigen::Vector3d point =
+          pose * Eigen::Vector3d(grid->locations[i].first, grid->locations[i].second,
+                                 height_above_table + mm * delta_height);
+      geometry_msgs::msg::PoseStamped place_pose;
+      place_pose.pose.orientation.w = 1.0;
+      place_pose.pose.position.x = point.x();
+      place_pose.pose.position.y = point.y();
+      place_pose.pose.position.z = point.z();
+      place_pose.header = table.header;
+      place_poses.push_back(place_pose);
+    }
+  }
+  return place_poses;
+}
+
+SemanticWorld::PlaceGridKey SemanticWorld::placeGridKey(const object_recognition_msgs::msg::Table& table,
+                                                        double resolution)
+{
+  PlaceGridKey key;
+  key.first.reserve(2 * table.convex_hull.size());
+  for (const geometry_msgs::msg::Point& vertex : table.convex_hull)
+  {
+    key.first.push_back(vertex.x);
+    key.first.push_back(vertex.y);
+  }
+  key.second = resolution;
+  return key;
+}
+
+SemanticWorld::PlaceGridConstPtr SemanticWorld::computePlaceGrid(const object_recognition_msgs::msg::Table& table,
+                                                                 double resolution)
+{
+  if (table.convex_hull.empty() || resolution <= 0.0)
+    return nullptr;
   const int scale_factor = 100;
   std::vector<cv::Point2f> table_contour;
   float x_min = table.convex_hull[0].x, x_max = x_min, y_min = table.convex_hull[0].y, y_max = y_min;
@@ -377,37 +436,88 @@ SemanticWorld::generatePlacePoses(const object_recognition_msgs::msg::Table& tab
   std::vector<std::vector<cv::Point> > contours;
   std::vector<cv::Vec4i> hierarchy;
   cv::findContours(src, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
+  if (contours.empty())
+    return nullptr;
 
+  auto grid = std::make_shared<PlaceGrid>();
+  grid->locations.reserve(num_x * num_y);
+  grid->edge_distances.reserve(num_x * num_y);
   for (std::size_t j = 0; j < num_x; ++j)
   {
     int point_x = j * resolution * scale_factor;
     for (std::size_t k = 0; k < num_y; ++k)
     {
-      for (std::size_t mm = 0; mm < num_heights; ++mm)
+      int point_y = k * resolution * scale_factor;
+      cv::Point2f point2f(point_x, point_y);
+      grid->locations.emplace_back(static_cast<double>(point_x) / scale_factor + x_min,
+                                   static_cast<double>(point_y) / scale_factor + y_min);
+      grid->edge_distances.push_back(cv::pointPolygonTest(contours[0], point2f, true));
+    }
+  }
+  return grid;
+}
+
+SemanticWorld::PlaceGridConstPtr SemanticWorld::getPlaceGrid(const object_recognition_msgs::msg::Table& table,
+                                                             double resolution) const
+{
+  PlaceGridKey key = placeGridKey(table, resolution);
+  {
+    std::scoped_lock lock(place_grid_lock_);
+    place_grid_resolutions_.insert(resolution);
+    auto it = place_grids_.find(key);
+    if (it != place_grids_.end())
+      return it->second;
+  }
+
+  PlaceGridConstPtr grid = computePlaceGrid(table, resolution);
+  if (grid)
+  {
+    std::scoped_lock lock(place_grid_lock_);
+    place_grids_.emplace(std::move(key), grid);
+  }
+  return grid;
+}
+
+void SemanticWorld::placeGridThread()
+{
+  std::unique_lock<std::mutex> lock(place_grid_lock_);
+  while (true)
+  {
+    place_grid_condition_.wait(lock, [this] { return stop_place_grid_thread_ || !pending_place_grid_tables_.empty(); });
+    if (stop_place_grid_thread_)
+      return;
+
+    // grids of tables that disappeared are dropped, grids of tables that only moved are kept
+    std::vector<object_recognition_msgs::msg::Table> tables;
+    tables.swap(pending_place_grid_tables_);
+    const std::set<double> resolutions = place_grid_resolutions_;
+    std::map<PlaceGridKey, PlaceGridConstPtr> place_grids;
+    std::vector<std::pair<PlaceGridKey, const object_recognition_msgs::msg::Table*>> missing;
+    for (const object_recognition_msgs::msg::Table& table : tables)
+    {
+      for (double resolution : resolutions)
       {
-        int point_y = k * resolution * scale_factor;
-        cv::Point2f point2f(point_x, point_y);
-        double result = cv::pointPolygonTest(contours[0], point2f, true);
-        if (static_cast<int>(result) >= static_cast<int>(min_distance_from_edge * scale_factor))
-        {
-          Eigen::Vector3d point(static_cast<double>(point_x) / scale_factor + x_min,
-                                static_cast<double>(point_y) / scale_factor + y_min,
-                                height_above_table + mm * delta_height);
-          Eigen::Isometry3d pose;
-          tf2::fromMsg(table.pose, pose);
-          point = pose * point;
-          geometry_msgs::msg::PoseStamped place_pose;
-          place_pose.pose.orientation.w = 1.0;
-          place_pose.pose.position.x = point.x();
-          place_pose.pose.position.y = point.y();
-          place_pose.pose.position.z = point.z();
-          place_pose.header = table.header;
-          place_poses.push_back(place_pose);
-        }
+        PlaceGridKey key = placeGridKey(table, resolution);
+        auto it = place_grids_.find(key);
+        if (it != place_grids_.end())
+          place_grids.insert(*it);
+        else
+          missing.emplace_back(std::move(key), &table);
       }
     }
+    place_grids_.swap(place_grids);
+
+    lock.unlock();
+    for (std::pair<PlaceGridKey, const object_recognition_msgs::msg::Table*>& entry : missing)
+    {
+      PlaceGridConstPtr grid = computePlaceGrid(*entry.second, entry.first.second);
+      if (!grid)
+        continue;
+      std::scoped_lock grid_lock(place_grid_lock_);
+      place_grids_.emplace(std::move(entry.first), grid);
+    }
+    lock.lock();
   }
-  return place_poses;
 }
 
 bool SemanticWorld::isInsideTableContour(const geometry_msgs::msg::Pose& pose,
@@ -500,6 +610,11 @@ void SemanticWorld::tableCallback(const object_recognition_msgs::msg::TableArray
   table_array_ = *msg;
   RCLCPP_INFO(LOGGER, "Table callback with %d tables", static_cast<int>(table_array_.tables.size()));
   transformTableArray(table_array_);
+  {
+    std::scoped_lock lock(place_grid_lock_);
+    pending_place_grid_tables_ = table_array_.tables;
+  }
+  place_grid_condition_.notify_one();
   // Callback on an update
   if (table_callback_)
   {
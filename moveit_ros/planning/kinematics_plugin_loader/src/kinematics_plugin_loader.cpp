@@ -138,8 +138,6 @@ public:
                                   links.front()->getParentJointModel()->getParentLinkModel()->getName() :
                                   jmg->getParentModel().getModelFrame();
 
-    // just to be sure, do not call the same pluginlib instance allocation function in parallel
-    std::scoped_lock slock(lock_);
     for (const auto& [group, solver] : possible_kinematics_solvers_)
     {
       // Don't bother trying to load a solver for the wrong group
@@ -149,7 +147,11 @@ public:
       }
       try
       {
-        result = kinematics_loader_->createUniqueInstance(solver);
+        {
+          // the class loader is not thread safe, but solvers for different groups may be initialized in parallel
+          std::scoped_lock slock(lock_);
+          result = kinematics_loader_->createUniqueInstance(solver);
+        }
         if (result)
         {
           // choose the tip of the IK solver
@@ -194,14 +196,18 @@ public:
   // second call in JointModelGroup::setSolverAllocators() is to actually retrieve the instance for use
   kinematics::KinematicsBasePtr allocKinematicsSolverWithCache(const moveit::core::JointModelGroup* jmg)
   {
-    std::scoped_lock slock(cache_lock_);
-    kinematics::KinematicsBasePtr& cached = instances_[jmg];
-    if (cached.unique())
-      return std::move(cached);  // pass on unique instance
+    {
+      std::scoped_lock slock(cache_lock_);
+      kinematics::KinematicsBasePtr& cached = instances_[jmg];
+      if (cached.unique())
+        return std::move(cached);  // pass on unique instance
+    }
 
-    // create a new instance and store in instances_
-    cached = allocKinematicsSolver(jmg);
-    return cached;
+    // create a new instance and store in instances_, without blocking the allocation for other groups
+    kinematics::KinematicsBasePtr result = allocKinematicsSolver(jmg);
+    std::scoped_lock slock(cache_lock_);
+    instances_[jmg] = result;
+    return result;
   }
 
   void status() const
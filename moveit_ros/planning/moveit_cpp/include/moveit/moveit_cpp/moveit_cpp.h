@@ -43,6 +43,7 @@
 #include <moveit/controller_manager/controller_manager.h>
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
 #include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/planning_pipeline_interfaces/planning_thread_pool.hpp>
 #include <moveit/trajectory_execution_manager/trajectory_execution_manager.h>
 #include <moveit/robot_state/robot_state.h>
 #include <tf2_ros/buffer.h>
@@ -89,9 +90,12 @@ public:
       const std::string ns = "planning_pipelines.";
       node->get_parameter(ns + "pipeline_names", pipeline_names);
       node->get_parameter(ns + "namespace", parent_namespace);
+      node->get_parameter_or(ns + "parallel_planning_threads", parallel_planning_threads, 0);
     }
     std::vector<std::string> pipeline_names;
     std::string parent_namespace;
+    /// Number of threads used to solve parallel planning requests, 0 uses std::thread::hardware_concurrency()
+    int parallel_planning_threads = 0;
   };
 
   /// Parameter container for initializing MoveItCpp
@@ -142,6 +146,9 @@ public:
   /** \brief Get all loaded planning pipeline instances mapped to their reference names */
   const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>& getPlanningPipelines() const;
 
+  /** \brief Get the persistent thread pool used to solve parallel planning requests */
+  const moveit::planning_pipeline_interfaces::PlanningThreadPoolPtr& getPlanningThreadPool() const;
+
   /** \brief Get the stored instance of the planning scene monitor */
   planning_scene_monitor::PlanningSceneMonitorConstPtr getPlanningSceneMonitor() const;
   planning_scene_monitor::PlanningSceneMonitorPtr getPlanningSceneMonitorNonConst();
@@ -171,6 +178,20 @@ public:
   /** \brief Utility to terminate the given planning pipeline */
   bool terminatePlanningPipeline(const std::string& pipeline_name);
 
+  /** \brief Make \e moveit_cpp available to other code in this process under \e name.
+   *
+   * Code running in the same process, e.g. a node composed with move_group, can look the instance up with
+   * getInstance() and share its planning scene, pipelines and trajectories as objects instead of exchanging them as
+   * ROS messages. The registry does not keep the instance alive. An instance registered under \e name before is
+   * replaced. move_group registers its instance under the fully qualified name of its node. */
+  static void registerInstance(const std::string& name, const MoveItCppPtr& moveit_cpp);
+
+  /** \brief Remove the instance registered under \e name, if it is \e moveit_cpp */
+  static void unregisterInstance(const std::string& name, const MoveItCpp* moveit_cpp);
+
+  /** \brief Get the instance registered under \e name, or nullptr if there is none or it was destroyed */
+  static MoveItCppPtr getInstance(const std::string& name);
+
 private:
   //  Core properties and instances
   rclcpp::Node::SharedPtr node_;
@@ -179,6 +200,7 @@ private:
   // Planning
   std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr> planning_pipelines_;
   std::unordered_map<std::string, std::set<std::string>> groups_algorithms_map_;
+  moveit::planning_pipeline_interfaces::PlanningThreadPoolPtr planning_thread_pool_;
 
   // Execution
   trajectory_execution_manager::TrajectoryExecutionManagerPtr trajectory_execution_manager_;
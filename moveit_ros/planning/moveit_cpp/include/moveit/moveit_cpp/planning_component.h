@@ -207,6 +207,20 @@ public:
        const moveit::planning_pipeline_interfaces::StoppingCriterionFunction& stopping_criterion_callback = nullptr,
        planning_scene::PlanningScenePtr planning_scene = nullptr);
 
+  /** \brief Anytime planning: Plan repeatedly from start or current state to fulfill the last goal constraints provided
+   * by setGoal() until the planning time of the provided PlanRequestParameters is used up. Each solution that improves
+   * on the best one so far, as decided by \e solution_selection_function, is passed to \e solution_callback, which can
+   * stop planning by returning true, e.g. to start executing a solution that is good enough. Returns the best
+   * solution. */
+  planning_interface::MotionPlanResponse
+  planAnytime(const MultiPipelinePlanRequestParameters& parameters,
+              const moveit::planning_pipeline_interfaces::SolutionCallbackFunction& solution_callback,
+              const moveit::planning_pipeline_interfaces::SolutionSelectionFunction& solution_selection_function =
+                  &moveit::planning_pipeline_interfaces::getShortestSolution,
+              const moveit::planning_pipeline_interfaces::StoppingCriterionFunction& stopping_criterion_callback =
+                  nullptr,
+              planning_scene::PlanningScenePtr planning_scene = nullptr);
+
   /** \brief Execute the latest computed solution trajectory computed by plan(). By default this function terminates
    * after the execution is complete. The execution can be run in background by setting blocking to false. */
   [[deprecated("Use MoveItCpp::execute()")]] bool execute(bool /*blocking */)
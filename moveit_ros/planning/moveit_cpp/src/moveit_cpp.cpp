@@ -34,6 +34,9 @@
 
 /* Author: Henning Kayser */
 
+#include <algorithm>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 
 #include <moveit/controller_manager/controller_manager.h>
@@ -46,6 +49,17 @@ namespace moveit_cpp
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros_planning_interface.moveit_cpp");
 
+namespace
+{
+// instances shared within the process, see MoveItCpp::registerInstance()
+std::mutex registry_mutex;
+std::map<std::string, MoveItCppWeakPtr>& registry()
+{
+  static std::map<std::string, MoveItCppWeakPtr> instances;
+  return instances;
+}
+}  // namespace
+
 MoveItCpp::MoveItCpp(const rclcpp::Node::SharedPtr& node) : MoveItCpp(node, Options(node))
 {
 }
@@ -134,6 +148,9 @@ bool MoveItCpp::loadPlanningPipelines(const PlanningPipelineOptions& options)
     RCLCPP_ERROR(LOGGER, "Failed to load any planning pipelines.");
     return false;
   }
+
+  planning_thread_pool_ = std::make_shared<moveit::planning_pipeline_interfaces::PlanningThreadPool>(
+      std::max(options.parallel_planning_threads, 0));
   return true;
 }
 
@@ -173,6 +190,11 @@ const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>& M
   return planning_pipelines_;
 }
 
+const moveit::planning_pipeline_interfaces::PlanningThreadPoolPtr& MoveItCpp::getPlanningThreadPool() const
+{
+  return planning_thread_pool_;
+}
+
 planning_scene_monitor::PlanningSceneMonitorConstPtr MoveItCpp::getPlanningSceneMonitor() const
 {
   return planning_scene_monitor_;
@@ -255,4 +277,28 @@ std::shared_ptr<tf2_ros::Buffer> MoveItCpp::getTFBuffer()
   return planning_scene_monitor_->getTFClient();
 }
 
+void MoveItCpp::registerInstance(const std::string& name, const MoveItCppPtr& moveit_cpp)
+{
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  registry()[name] = moveit_cpp;
+}
+
+void MoveItCpp::unregisterInstance(const std::string& name, const MoveItCpp* moveit_cpp)
+{
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  const auto it = registry().find(name);
+  if (it == registry().end())
+    return;
+  // an expired entry may be removed by anyone
+  const MoveItCppPtr registered = it->second.lock();
+  if (!registered || registered.get() == moveit_cpp)
+    registry().erase(it);
+}
+
+MoveItCppPtr MoveItCpp::getInstance(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  const auto it = registry().find(name);
+  return it == registry().end() ? MoveItCppPtr() : it->second.lock();
+}
 }  // namespace moveit_cpp
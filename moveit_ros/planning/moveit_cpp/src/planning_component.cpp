@@ -191,7 +191,7 @@ planning_interface::MotionPlanResponse PlanningComponent::plan(
 
   const auto motion_plan_response_vector = moveit::planning_pipeline_interfaces::planWithParallelPipelines(
       requests, planning_scene, moveit_cpp_->getPlanningPipelines(), stopping_criterion_callback,
-      solution_selection_function);
+      solution_selection_function, moveit_cpp_->getPlanningThreadPool());
 
   try
   {
@@ -208,6 +208,56 @@ planning_interface::MotionPlanResponse PlanningComponent::plan(
   return plan_solution;
 }
 
+planning_interface::MotionPlanResponse PlanningComponent::planAnytime(
+    const MultiPipelinePlanRequestParameters& parameters,
+    const moveit::planning_pipeline_interfaces::SolutionCallbackFunction& solution_callback,
+    const moveit::planning_pipeline_interfaces::SolutionSelectionFunction& solution_selection_function,
+    const moveit::planning_pipeline_interfaces::StoppingCriterionFunction& stopping_criterion_callback,
+    planning_scene::PlanningScenePtr planning_scene)
+{
+  auto plan_solution = planning_interface::MotionPlanResponse();
+
+  // check if joint_model_group exists
+  if (!joint_model_group_)
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to retrieve joint model group for name '%s'.", group_name_.c_str());
+    plan_solution.error_code = moveit::core::MoveItErrorCode::INVALID_GROUP_NAME;
+    return plan_solution;
+  }
+
+  // Check if goal constraints exist
+  if (current_goal_constraints_.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "No goal constraints set for planning request");
+    plan_solution.error_code = moveit::core::MoveItErrorCode::INVALID_GOAL_CONSTRAINTS;
+    return plan_solution;
+  }
+
+  if (!planning_scene)
+  {  // Clone current planning scene
+    planning_scene_monitor::PlanningSceneMonitorPtr planning_scene_monitor =
+        moveit_cpp_->getPlanningSceneMonitorNonConst();
+    planning_scene_monitor->updateFrameTransforms();
+    planning_scene = [planning_scene_monitor] {
+      planning_scene_monitor::LockedPlanningSceneRO ls(planning_scene_monitor);
+      return planning_scene::PlanningScene::clone(ls);
+    }();
+    planning_scene_monitor.reset();  // release this pointer}
+  }
+  // Init MotionPlanRequest
+  std::vector<::planning_interface::MotionPlanRequest> requests = getMotionPlanRequestVector(parameters);
+
+  // Set start state
+  for (const auto& request : requests)
+  {
+    planning_scene->setCurrentState(request.start_state);
+  }
+
+  return moveit::planning_pipeline_interfaces::planAnytime(
+      requests, planning_scene, moveit_cpp_->getPlanningPipelines(), solution_callback, solution_selection_function,
+      stopping_criterion_callback, moveit_cpp_->getPlanningThreadPool());
+}
+
 planning_interface::MotionPlanResponse PlanningComponent::plan()
 {
   PlanRequestParameters plan_request_parameters;
@@ -44,6 +44,8 @@
 #include <pluginlib/class_loader.hpp>
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 /** \brief This namespace includes functionality specific to the execution and monitoring of motion plans */
 namespace plan_execution
@@ -132,9 +134,31 @@ public:
     return default_max_replan_attempts_;
   }
 
+  /** \brief Set the number of threads used to revalidate the remaining path after scene updates. 0 uses one thread per
+      hardware thread. */
+  void setPathValidationThreads(unsigned int num_threads)
+  {
+    path_validation_threads_ = num_threads;
+  }
+
+  unsigned int getPathValidationThreads() const
+  {
+    return path_validation_threads_;
+  }
+
   void planAndExecute(ExecutableMotionPlan& plan, const Options& opt);
   void planAndExecute(ExecutableMotionPlan& plan, const moveit_msgs::msg::PlanningScene& scene_diff, const Options& opt);
 
+  /** \brief Plan and execute like planAndExecute(), overlapping planning with the execution of the previous motion.
+
+      Calls from several threads form a pipeline: each call plans while the motion of the previous call still executes,
+      starting from the last state of that motion instead of the current state, and executes once the previous call is
+      done. Calls plan and execute in the order they were made. If the previous motion does not end where it was
+      planned to, the plan is computed again from the current state. */
+  void planAndExecutePipelined(ExecutableMotionPlan& plan, const Options& opt);
+  void planAndExecutePipelined(ExecutableMotionPlan& plan, const moveit_msgs::msg::PlanningScene& scene_diff,
+                               const Options& opt);
+
   /** \brief Execute and monitor a previously created \e plan.
 
       In case there is no \e planning_scene or \e planning_scene_monitor set in the \e plan they will be set at the
@@ -145,7 +169,12 @@ public:
 
 private:
   void planAndExecuteHelper(ExecutableMotionPlan& plan, const Options& opt);
-  bool isRemainingPathValid(const ExecutableMotionPlan& plan, const std::pair<int, int>& path_segment);
+  planning_scene::PlanningSceneConstPtr getPlanningScene(const moveit_msgs::msg::PlanningScene& scene_diff) const;
+  /** \brief Check the remaining waypoints of the trajectory component in \e path_segment. If \e changed_regions is
+      given, only the world within these regions changed since the trajectory was last found valid, so waypoints whose
+      bounding box is outside of them are not checked again. */
+  bool isRemainingPathValid(const ExecutableMotionPlan& plan, const std::pair<int, int>& path_segment,
+                            const std::vector<Eigen::AlignedBox3d>* changed_regions = nullptr);
 
   void planningSceneUpdatedCallback(const planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType update_type);
   void doneWithTrajectoryExecution(const moveit_controller_manager::ExecutionStatus& status);
@@ -157,6 +186,7 @@ private:
   planning_scene_monitor::TrajectoryMonitorPtr trajectory_monitor_;
 
   unsigned int default_max_replan_attempts_;
+  unsigned int path_validation_threads_;
 
   class
   {
@@ -177,7 +207,17 @@ private:
     }
   } preempt_;
 
+  // calls of planAndExecutePipelined(), numbered in the order they were made
+  std::mutex pipeline_mutex_;
+  std::condition_variable pipeline_condition_;
+  std::size_t pipeline_calls_;
+  std::size_t pipeline_planned_;   // calls done planning
+  std::size_t pipeline_executed_;  // calls done executing
+  moveit::core::RobotStatePtr pipeline_end_state_;  // end of the last plan, null if planning failed
+  bool pipeline_succeeded_;  // whether the last call executed the plan it computed in the pipeline successfully
+
   bool new_scene_update_;
+  bool new_full_scene_update_;  // an update that may change more than the world geometry, e.g. the ACM
 
   bool execution_complete_;
   bool path_became_invalid_;
@@ -38,6 +38,8 @@
 #include <moveit/robot_state/conversions.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/collision_detection/collision_tools.h>
+#include <moveit/collision_detection/world_diff.h>
+#include <moveit/robot_model/aabb.h>
 #include <moveit/utils/message_checks.h>
 #include <moveit/utils/moveit_error_code.h>
 #include <boost/algorithm/string/join.hpp>
@@ -47,6 +49,8 @@
 #include <rclcpp/parameter_value.hpp>
 #include <rclcpp/rate.hpp>
 #include <rclcpp/utilities.hpp>
+#include <geometric_shapes/shape_operations.h>
+#include <octomap/octomap.h>
 
 // #include <dynamic_reconfigure/server.h>
 // #include <moveit_ros_planning/PlanExecutionDynamicReconfigureConfig.h>
@@ -55,6 +59,39 @@ namespace plan_execution
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_ros.plan_execution");
 
+namespace
+{
+// Bounding box of all shapes of a world object, in the world frame
+Eigen::AlignedBox3d computeObjectAABB(const collision_detection::World::Object& object)
+{
+  moveit::core::AABB aabb;
+  for (std::size_t i = 0; i < object.shapes_.size(); ++i)
+  {
+    const Eigen::Isometry3d& pose = object.global_shape_poses_[i];
+    if (object.shapes_[i]->type == shapes::MESH)
+    {
+      // computeShapeExtents() assumes meshes are centered at their origin
+      const shapes::Mesh* mesh = static_cast<const shapes::Mesh*>(object.shapes_[i].get());
+      for (unsigned int j = 0; j < mesh->vertex_count; ++j)
+        aabb.extend(pose * Eigen::Map<const Eigen::Vector3d>(&mesh->vertices[3 * j]));
+    }
+    else if (object.shapes_[i]->type == shapes::OCTREE)
+    {
+      const shapes::OcTree* octree = static_cast<const shapes::OcTree*>(object.shapes_[i].get());
+      if (!octree->octree || octree->octree->size() == 0)
+        continue;
+      Eigen::Vector3d min, max;
+      octree->octree->getMetricMin(min.x(), min.y(), min.z());
+      octree->octree->getMetricMax(max.x(), max.y(), max.z());
+      aabb.extendWithTransformedBox(pose * Eigen::Translation3d(0.5 * (min + max)), max - min);
+    }
+    else
+      aabb.extendWithTransformedBox(pose, shapes::computeShapeExtents(object.shapes_[i].get()));
+  }
+  return aabb;
+}
+}  // namespace
+
 // class PlanExecution::DynamicReconfigureImpl
 // {
 // public:
@@ -89,8 +126,15 @@ plan_execution::PlanExecution::PlanExecution(
   }
 
   default_max_replan_attempts_ = 5;
+  path_validation_threads_ = 0;
 
   new_scene_update_ = false;
+  new_full_scene_update_ = false;
+
+  pipeline_calls_ = 0;
+  pipeline_planned_ = 0;
+  pipeline_executed_ = 0;
+  pipeline_succeeded_ = false;
 
   // we want to be notified when new information is available
   planning_scene_monitor_->addUpdateCallback(
@@ -141,6 +185,122 @@ void plan_execution::PlanExecution::planAndExecute(ExecutableMotionPlan& plan,
   }
 }
 
+void plan_execution::PlanExecution::planAndExecutePipelined(ExecutableMotionPlan& plan, const Options& opt)
+{
+  planAndExecutePipelined(plan, moveit_msgs::msg::PlanningScene(), opt);
+}
+
+void plan_execution::PlanExecution::planAndExecutePipelined(ExecutableMotionPlan& plan,
+                                                            const moveit_msgs::msg::PlanningScene& scene_diff,
+                                                            const Options& opt)
+{
+  std::size_t call;
+  bool previous_running;
+  moveit::core::RobotStatePtr start_state;
+  {
+    std::unique_lock<std::mutex> lock(pipeline_mutex_);
+    call = pipeline_calls_++;
+    pipeline_condition_.wait(lock, [this, call] { return pipeline_planned_ == call; });
+    // while the previous motion executes, plan from where it is going to end
+    previous_running = pipeline_executed_ < call;
+    if (previous_running)
+      start_state = pipeline_end_state_;
+  }
+
+  plan.planning_scene_monitor = planning_scene_monitor_;
+  if (start_state)
+  {
+    planning_scene::PlanningScenePtr scene;
+    {
+      planning_scene_monitor::LockedPlanningSceneRO lscene(planning_scene_monitor_);
+      scene = moveit::core::isEmpty(scene_diff) ? lscene->diff() : lscene->diff(scene_diff);
+    }
+    scene->setCurrentState(*start_state);
+    plan.planning_scene = scene;
+  }
+  else
+    plan.planning_scene = getPlanningScene(scene_diff);
+
+  // without a plan for the previous motion, where it ends is only known once it is done
+  bool solved = false;
+  if (!previous_running || start_state)
+  {
+    if (opt.before_plan_callback_)
+      opt.before_plan_callback_();
+    solved = opt.plan_callback(plan) && plan.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
+  }
+
+  bool previous_succeeded;
+  {
+    std::unique_lock<std::mutex> lock(pipeline_mutex_);
+    pipeline_end_state_.reset();
+    if (solved)
+    {
+      for (auto it = plan.plan_components.rbegin(); it != plan.plan_components.rend() && !pipeline_end_state_; ++it)
+      {
+        if (it->trajectory && !it->trajectory->empty())
+          pipeline_end_state_ = std::make_shared<moveit::core::RobotState>(it->trajectory->getLastWayPoint());
+      }
+      // an empty plan ends where it starts
+      if (!pipeline_end_state_)
+        pipeline_end_state_ = std::make_shared<moveit::core::RobotState>(plan.planning_scene->getCurrentState());
+    }
+    ++pipeline_planned_;
+    pipeline_condition_.notify_all();
+
+    pipeline_condition_.wait(lock, [this, call] { return pipeline_executed_ == call; });
+    previous_succeeded = pipeline_succeeded_;
+  }
+
+  bool executed_as_planned = false;
+  if (!solved || (previous_running && !previous_succeeded))
+  {
+    // the plan does not start where the robot is, or there is none: plan and execute from the current state
+    plan.plan_components.clear();
+    planAndExecute(plan, scene_diff, opt);
+  }
+  else
+  {
+    // monitor the execution against the current scene
+    plan.planning_scene = getPlanningScene(scene_diff);
+    if (opt.before_execution_callback_)
+      opt.before_execution_callback_();
+
+    if (preempt_.checkAndClear())
+      plan.error_code.val = moveit_msgs::msg::MoveItErrorCodes::PREEMPTED;
+    else
+      plan.error_code = executeAndMonitor(plan, false);
+
+    if (plan.error_code.val == moveit_msgs::msg::MoveItErrorCodes::MOTION_PLAN_INVALIDATED_BY_ENVIRONMENT_CHANGE &&
+        opt.replan)
+    {
+      plan.plan_components.clear();
+      planAndExecute(plan, scene_diff, opt);
+    }
+    else
+    {
+      executed_as_planned = true;
+      if (opt.done_callback_)
+        opt.done_callback_();
+    }
+  }
+
+  std::scoped_lock lock(pipeline_mutex_);
+  pipeline_succeeded_ = executed_as_planned && plan.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
+  ++pipeline_executed_;
+  pipeline_condition_.notify_all();
+}
+
+planning_scene::PlanningSceneConstPtr
+plan_execution::PlanExecution::getPlanningScene(const moveit_msgs::msg::PlanningScene& scene_diff) const
+{
+  if (moveit::core::isEmpty(scene_diff))
+    return planning_scene_monitor_->getPlanningScene();
+  // lock the scene so that it does not modify the world representation while diff() is called
+  planning_scene_monitor::LockedPlanningSceneRO lscene(planning_scene_monitor_);
+  return lscene->diff(scene_diff);
+}
+
 void plan_execution::PlanExecution::planAndExecuteHelper(ExecutableMotionPlan& plan, const Options& opt)
 {
   // perform initial configuration steps & various checks
@@ -263,7 +423,8 @@ void plan_execution::PlanExecution::planAndExecuteHelper(ExecutableMotionPlan& p
 }
 
 bool plan_execution::PlanExecution::isRemainingPathValid(const ExecutableMotionPlan& plan,
-                                                         const std::pair<int, int>& path_segment)
+                                                         const std::pair<int, int>& path_segment,
+                                                         const std::vector<Eigen::AlignedBox3d>* changed_regions)
 {
   if (path_segment.first >= 0 &&
       plan.plan_components[path_segment.first].trajectory_monitoring)  // If path_segment.second <= 0, the function
@@ -276,41 +437,62 @@ bool plan_execution::PlanExecution::isRemainingPathValid(const ExecutableMotionP
     const robot_trajectory::RobotTrajectory& t = *plan.plan_components[path_segment.first].trajectory;
     const collision_detection::AllowedCollisionMatrix* acm =
         plan.plan_components[path_segment.first].allowed_collision_matrix.get();
-    std::size_t wpc = t.getWayPointCount();
     collision_detection::CollisionRequest req;
     req.group_name = t.getGroupName();
-    for (std::size_t i = std::max(path_segment.second - 1, 0); i < wpc; ++i)
-    {
+    const auto is_state_valid = [&](const moveit::core::RobotState& state) {
+      if (changed_regions)
+      {
+        // a waypoint away from all changes keeps its validity
+        std::vector<double> bounds;
+        if (state.dirtyLinkTransforms())
+        {
+          moveit::core::RobotState updated(state);
+          updated.updateLinkTransforms();
+          updated.computeAABB(bounds);
+        }
+        else
+          state.computeAABB(bounds);
+        const Eigen::AlignedBox3d state_aabb(Eigen::Vector3d(bounds[0], bounds[2], bounds[4]),
+                                             Eigen::Vector3d(bounds[1], bounds[3], bounds[5]));
+        if (std::none_of(changed_regions->begin(), changed_regions->end(),
+                         [&](const Eigen::AlignedBox3d& region) { return region.intersects(state_aabb); }))
+          return true;
+      }
       collision_detection::CollisionResult res;
       if (acm)
       {
-        plan.planning_scene->checkCollisionUnpadded(req, res, t.getWayPoint(i), *acm);
+        plan.planning_scene->checkCollisionUnpadded(req, res, state, *acm);
       }
       else
       {
-        plan.planning_scene->checkCollisionUnpadded(req, res, t.getWayPoint(i));
+        plan.planning_scene->checkCollisionUnpadded(req, res, state);
       }
+      return !res.collision && plan.planning_scene->isStateFeasible(state, false);
+    };
 
-      if (res.collision || !plan.planning_scene->isStateFeasible(t.getWayPoint(i), false))
+    // Waypoints are checked concurrently and coarse-to-fine, stopping at the first invalid one
+    const std::vector<std::size_t> invalid = planning_scene::PlanningScene::findInvalidWayPoints(
+        t, is_state_valid, std::max(path_segment.second - 1, 0), path_validation_threads_);
+    if (!invalid.empty())
+    {
+      const moveit::core::RobotState& invalid_state = t.getWayPoint(invalid.front());
+      // Dave's debacle
+      RCLCPP_INFO(LOGGER, "Trajectory component '%s' is invalid",
+                  plan.plan_components[path_segment.first].description.c_str());
+
+      // call the same functions again, in verbose mode, to show what issues have been detected
+      plan.planning_scene->isStateFeasible(invalid_state, true);
+      req.verbose = true;
+      collision_detection::CollisionResult res;
+      if (acm)
       {
-        // Dave's debacle
-        RCLCPP_INFO(LOGGER, "Trajectory component '%s' is invalid",
-                    plan.plan_components[path_segment.first].description.c_str());
-
-        // call the same functions again, in verbose mode, to show what issues have been detected
-        plan.planning_scene->isStateFeasible(t.getWayPoint(i), true);
-        req.verbose = true;
-        res.clear();
-        if (acm)
-        {
-          plan.planning_scene->checkCollisionUnpadded(req, res, t.getWayPoint(i), *acm);
-        }
-        else
-        {
-          plan.planning_scene->checkCollisionUnpadded(req, res, t.getWayPoint(i));
-        }
-        return false;
+        plan.planning_scene->checkCollisionUnpadded(req, res, invalid_state, *acm);
       }
+      else
+      {
+        plan.planning_scene->checkCollisionUnpadded(req, res, invalid_state);
+      }
+      return false;
     }
   }
   return true;
@@ -419,6 +601,17 @@ moveit_msgs::msg::MoveItErrorCodes plan_execution::PlanExecution::executeAndMoni
   if (trajectory_monitor_)
     trajectory_monitor_->startTrajectoryMonitor();
 
+  // record the changes of the monitored world, to only revalidate waypoints near them
+  std::unique_ptr<collision_detection::WorldDiff> world_diff;
+  if (plan.planning_scene == planning_scene_monitor_->getPlanningScene())
+  {
+    planning_scene_monitor::LockedPlanningSceneRO lscene(planning_scene_monitor_);
+    world_diff = std::make_unique<collision_detection::WorldDiff>(
+        planning_scene_monitor_->getPlanningScene()->getWorldNonConst());
+  }
+  // changes made before the diff was created are only seen by a full check
+  new_full_scene_update_ = true;
+
   // start a trajectory execution thread
   trajectory_execution_manager_->execute(
       [this](const moveit_controller_manager::ExecutionStatus& status) { doneWithTrajectoryExecution(status); },
@@ -436,7 +629,22 @@ moveit_msgs::msg::MoveItErrorCodes plan_execution::PlanExecution::executeAndMoni
     {
       new_scene_update_ = false;
       std::pair<int, int> current_index = trajectory_execution_manager_->getCurrentExpectedTrajectoryIndex();
-      if (!isRemainingPathValid(plan, current_index))
+      std::vector<Eigen::AlignedBox3d> changed_regions;
+      const bool incremental = world_diff && !new_full_scene_update_;
+      new_full_scene_update_ = false;
+      if (world_diff)
+      {
+        planning_scene_monitor::LockedPlanningSceneRO lscene(planning_scene_monitor_);
+        for (const auto& change : *world_diff)
+        {
+          // removed objects cannot invalidate the path
+          const collision_detection::World::ObjectConstPtr object = lscene->getWorld()->getObject(change.first);
+          if (object)
+            changed_regions.push_back(computeObjectAABB(*object));
+        }
+        world_diff->clearChanges();
+      }
+      if (!isRemainingPathValid(plan, current_index, incremental ? &changed_regions : nullptr))
       {
         RCLCPP_INFO(LOGGER, "Trajectory component '%s' is invalid after scene update",
                     plan.plan_components[current_index.first].description.c_str());
@@ -450,6 +658,12 @@ moveit_msgs::msg::MoveItErrorCodes plan_execution::PlanExecution::executeAndMoni
       break;
   }
 
+  if (world_diff)
+  {
+    planning_scene_monitor::LockedPlanningSceneRO lscene(planning_scene_monitor_);
+    world_diff.reset();
+  }
+
   // stop execution if needed
   if (preempt_requested)
   {
@@ -515,7 +729,12 @@ void plan_execution::PlanExecution::planningSceneUpdatedCallback(
 {
   if (update_type & (planning_scene_monitor::PlanningSceneMonitor::UPDATE_GEOMETRY |
                      planning_scene_monitor::PlanningSceneMonitor::UPDATE_TRANSFORMS))
+  {
+    if ((update_type & planning_scene_monitor::PlanningSceneMonitor::UPDATE_SCENE) ==
+        planning_scene_monitor::PlanningSceneMonitor::UPDATE_SCENE)
+      new_full_scene_update_ = true;
     new_scene_update_ = true;
+  }
 }
 
 void plan_execution::PlanExecution::doneWithTrajectoryExecution(
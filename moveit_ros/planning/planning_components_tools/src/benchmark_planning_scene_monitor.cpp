@@ -0,0 +1,409 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Measures the update throughput of the PlanningSceneMonitor under sensor load.
+ *
+ * The monitor runs in this process, subscribed to the default scene, collision object and joint state topics and, if
+ * the octomap is configured with a point cloud sensor, to its cloud topic. The load is either generated here at
+ * configurable rates or replayed from a recording, e.g. with 'ros2 bag play --rate <factor>', while the generator
+ * rates are set to 0. Reader threads lock the scene like planners do.
+ *
+ * At the end, one CSV row per stream reports the messages that arrived, the updates the monitor applied, the messages
+ * it dropped and the latency quantiles. Latencies are only known for generated messages, which carry their send time.
+ */
+
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit/utils/metrics.h>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <rclcpp/executors/multi_threaded_executor.hpp>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static const std::string ROBOT_DESCRIPTION = "robot_description";
+
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("benchmark_planning_scene_monitor");
+
+namespace
+{
+const std::string SCENE_NAME_PREFIX = "benchmark_";
+
+// Time since the epoch of the steady clock, shared by the generator and the measurements
+std::chrono::nanoseconds steadyNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+builtin_interfaces::msg::Time toStamp(std::chrono::nanoseconds time)
+{
+  builtin_interfaces::msg::Time stamp;
+  stamp.sec = static_cast<int32_t>(time.count() / 1000000000);
+  stamp.nanosec = static_cast<uint32_t>(time.count() % 1000000000);
+  return stamp;
+}
+
+std::chrono::nanoseconds fromStamp(const builtin_interfaces::msg::Time& stamp)
+{
+  return std::chrono::nanoseconds(static_cast<int64_t>(stamp.sec) * 1000000000 + stamp.nanosec);
+}
+
+struct StreamStatistics
+{
+  // messages that arrived on the topic, counted by a subscription of our own
+  moveit::metrics::Counter arrived;
+  // messages the monitor applied
+  moveit::metrics::Counter applied;
+  // latency from sending a generated message to the monitor applying it
+  moveit::metrics::LatencyHistogram latency;
+};
+
+class Report
+{
+public:
+  explicit Report(std::ostream& out) : out_(out)
+  {
+    out_ << "stream,arrived,applied,dropped,rate,mean,p50,p90,p99" << '\n';
+  }
+
+  void add(const std::string& stream, std::uint64_t arrived, std::uint64_t applied,
+           const moveit::metrics::LatencyHistogram::Snapshot& latency, double seconds)
+  {
+    const double mean = latency.count > 0 ? latency.sum / static_cast<double>(latency.count) : 0.0;
+    out_ << stream << ',' << arrived << ',' << applied << ',' << (arrived > applied ? arrived - applied : 0) << ','
+         << static_cast<double>(applied) / seconds << ',' << mean << ',' << latency.quantile(0.5) << ','
+         << latency.quantile(0.9) << ',' << latency.quantile(0.99) << std::endl;
+  }
+
+private:
+  std::ostream& out_;
+};
+
+// Publishes scene diffs, joint states and point clouds at fixed rates
+class LoadGenerator
+{
+public:
+  LoadGenerator(const rclcpp::Node::SharedPtr& node, const moveit::core::RobotModelConstPtr& model,
+                const std::string& cloud_topic, std::size_t cloud_points)
+    : node_(node), state_(model), cloud_points_(cloud_points)
+  {
+    state_.setToDefaultValues();
+    scene_publisher_ = node_->create_publisher<moveit_msgs::msg::PlanningScene>(
+        planning_scene_monitor::PlanningSceneMonitor::DEFAULT_PLANNING_SCENE_TOPIC, 100);
+    joint_state_publisher_ = node_->create_publisher<sensor_msgs::msg::JointState>(
+        planning_scene_monitor::PlanningSceneMonitor::DEFAULT_JOINT_STATES_TOPIC, 100);
+    if (!cloud_topic.empty())
+      cloud_publisher_ = node_->create_publisher<sensor_msgs::msg::PointCloud2>(cloud_topic, 10);
+  }
+
+  void start(double scene_rate, double joint_state_rate, double cloud_rate)
+  {
+    if (scene_rate > 0.0)
+      timers_.push_back(node_->create_wall_timer(period(scene_rate), [this] { publishScene(); }));
+    if (joint_state_rate > 0.0)
+      timers_.push_back(node_->create_wall_timer(period(joint_state_rate), [this] { publishJointState(); }));
+    if (cloud_rate > 0.0 && cloud_publisher_)
+      timers_.push_back(node_->create_wall_timer(period(cloud_rate), [this] { publishCloud(); }));
+  }
+
+  void stop()
+  {
+    for (const rclcpp::TimerBase::SharedPtr& timer : timers_)
+      timer->cancel();
+  }
+
+private:
+  static std::chrono::nanoseconds period(double rate)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(1.0 / rate));
+  }
+
+  // a diff that moves a box, named after its send time so that the monitor's update reveals the latency
+  void publishScene()
+  {
+    moveit_msgs::msg::PlanningScene scene;
+    scene.is_diff = true;
+    scene.robot_state.is_diff = true;
+    moveit_msgs::msg::CollisionObject object;
+    object.id = "benchmark_box";
+    object.header.frame_id = state_.getRobotModel()->getModelFrame();
+    object.operation = moveit_msgs::msg::CollisionObject::ADD;
+    object.primitives.resize(1);
+    object.primitives[0].type = shape_msgs::msg::SolidPrimitive::BOX;
+    object.primitives[0].dimensions = { 0.1, 0.1, 0.1 };
+    object.primitive_poses.resize(1);
+    object.primitive_poses[0].position.x = 2.0 + uniform_(rng_);
+    object.primitive_poses[0].orientation.w = 1.0;
+    object.pose.orientation.w = 1.0;
+    scene.world.collision_objects.push_back(object);
+    scene.name = SCENE_NAME_PREFIX + std::to_string(steadyNow().count());
+    scene_publisher_->publish(scene);
+  }
+
+  void publishJointState()
+  {
+    state_.setToRandomPositions();
+    sensor_msgs::msg::JointState joint_state;
+    joint_state.header.stamp = toStamp(steadyNow());
+    for (const moveit::core::JointModel* joint : state_.getRobotModel()->getSingleDOFJointModels())
+    {
+      joint_state.name.push_back(joint->getName());
+      joint_state.position.push_back(state_.getVariablePosition(joint->getFirstVariableIndex()));
+    }
+    joint_state_publisher_->publish(joint_state);
+  }
+
+  // random points in front of the robot, in the model frame
+  void publishCloud()
+  {
+    sensor_msgs::msg::PointCloud2 cloud;
+    cloud.header.frame_id = state_.getRobotModel()->getModelFrame();
+    cloud.header.stamp = node_->now();
+    sensor_msgs::PointCloud2Modifier modifier(cloud);
+    modifier.setPointCloud2FieldsByString(1, "xyz");
+    modifier.resize(cloud_points_);
+    sensor_msgs::PointCloud2Iterator<float> x(cloud, "x");
+    sensor_msgs::PointCloud2Iterator<float> y(cloud, "y");
+    sensor_msgs::PointCloud2Iterator<float> z(cloud, "z");
+    for (std::size_t i = 0; i < cloud_points_; ++i, ++x, ++y, ++z)
+    {
+      *x = static_cast<float>(1.5 + uniform_(rng_));
+      *y = static_cast<float>(2.0 * uniform_(rng_) - 1.0);
+      *z = static_cast<float>(2.0 * uniform_(rng_));
+    }
+    cloud_publisher_->publish(cloud);
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  moveit::core::RobotState state_;
+  std::size_t cloud_points_;
+  std::mt19937 rng_;
+  std::uniform_real_distribution<double> uniform_{ 0.0, 1.0 };
+  rclcpp::Publisher<moveit_msgs::msg::PlanningScene>::SharedPtr scene_publisher_;
+  rclcpp::Publisher<sensor_msgs::msg::JointState>::SharedPtr joint_state_publisher_;
+  rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr cloud_publisher_;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers_;
+};
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  auto node = rclcpp::Node::make_shared("benchmark_planning_scene_monitor");
+  auto load_node = rclcpp::Node::make_shared("benchmark_planning_scene_monitor_load");
+
+  double duration = 10.0;
+  double scene_rate = 10.0;
+  double joint_state_rate = 100.0;
+  double cloud_rate = 0.0;
+  std::string cloud_topic;
+  std::size_t cloud_points = 10000;
+  unsigned int readers = 2;
+  double reader_rate = 50.0;
+  std::string output;
+  boost::program_options::options_description desc;
+  desc.add_options()("duration", boost::program_options::value<double>(&duration)->default_value(duration),
+                     "Seconds to measure for")(
+      "scene_rate", boost::program_options::value<double>(&scene_rate)->default_value(scene_rate),
+      "Rate of the generated planning scene diffs, 0 to disable")(
+      "joint_state_rate", boost::program_options::value<double>(&joint_state_rate)->default_value(joint_state_rate),
+      "Rate of the generated joint states, 0 to disable")(
+      "cloud_rate", boost::program_options::value<double>(&cloud_rate)->default_value(cloud_rate),
+      "Rate of the generated point clouds, 0 to disable")(
+      "cloud_topic", boost::program_options::value<std::string>(&cloud_topic),
+      "Point cloud topic of the octomap sensor configured for the monitor")(
+      "cloud_points", boost::program_options::value<std::size_t>(&cloud_points)->default_value(cloud_points),
+      "Number of points per generated cloud")(
+      "readers", boost::program_options::value<unsigned int>(&readers)->default_value(readers),
+      "Number of threads that lock the scene for reading and check the current state for collisions")(
+      "reader_rate", boost::program_options::value<double>(&reader_rate)->default_value(reader_rate),
+      "Rate at which every reader locks the scene")("output", boost::program_options::value<std::string>(&output),
+                                                    "CSV file to write the results to, standard output if not set")(
+      "help", "this screen");
+  boost::program_options::variables_map vm;
+  boost::program_options::parsed_options po = boost::program_options::parse_command_line(argc, argv, desc);
+  boost::program_options::store(po, vm);
+  boost::program_options::notify(vm);
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << '\n';
+    return 0;
+  }
+
+  auto psm = std::make_shared<planning_scene_monitor::PlanningSceneMonitor>(node, ROBOT_DESCRIPTION);
+  if (!psm->getPlanningScene())
+  {
+    RCLCPP_ERROR(LOGGER, "Planning scene not configured");
+    return 1;
+  }
+
+  std::ofstream output_file;
+  if (!output.empty())
+  {
+    output_file.open(output);
+    if (!output_file)
+    {
+      RCLCPP_ERROR(LOGGER, "Unable to open '%s'", output.c_str());
+      return 1;
+    }
+  }
+
+  StreamStatistics scene_statistics;
+  StreamStatistics joint_state_statistics;
+  StreamStatistics cloud_statistics;
+
+  // count the messages that arrive, independent of what the monitor does with them
+  auto scene_subscription = load_node->create_subscription<moveit_msgs::msg::PlanningScene>(
+      planning_scene_monitor::PlanningSceneMonitor::DEFAULT_PLANNING_SCENE_TOPIC, 100,
+      [&](const moveit_msgs::msg::PlanningScene::ConstSharedPtr& /*scene*/) { scene_statistics.arrived.increment(); });
+  auto joint_state_subscription = load_node->create_subscription<sensor_msgs::msg::JointState>(
+      planning_scene_monitor::PlanningSceneMonitor::DEFAULT_JOINT_STATES_TOPIC, 100,
+      [&](const sensor_msgs::msg::JointState::ConstSharedPtr& /*joint_state*/) {
+        joint_state_statistics.arrived.increment();
+      });
+  rclcpp::Subscription<sensor_msgs::msg::PointCloud2>::SharedPtr cloud_subscription;
+  if (!cloud_topic.empty())
+  {
+    cloud_subscription = load_node->create_subscription<sensor_msgs::msg::PointCloud2>(
+        cloud_topic, 10,
+        [&](const sensor_msgs::msg::PointCloud2::ConstSharedPtr& /*cloud*/) { cloud_statistics.arrived.increment(); });
+  }
+
+  psm->startSceneMonitor();
+  psm->startWorldGeometryMonitor();
+  psm->startStateMonitor();
+
+  const bool generate = scene_rate > 0.0 || joint_state_rate > 0.0 || cloud_rate > 0.0;
+  psm->addUpdateCallback([&](planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType type) {
+    if (type != planning_scene_monitor::PlanningSceneMonitor::UPDATE_SCENE)
+      return;
+    scene_statistics.applied.increment();
+    if (!generate)
+      return;
+    std::string name;
+    {
+      planning_scene_monitor::LockedPlanningSceneRO scene(psm, "benchmark_latency");
+      name = scene->getName();
+    }
+    if (name.rfind(SCENE_NAME_PREFIX, 0) == 0)
+      scene_statistics.latency.record(steadyNow() -
+                                      std::chrono::nanoseconds(std::stoll(name.substr(SCENE_NAME_PREFIX.size()))));
+  });
+  psm->getStateMonitorNonConst()->addUpdateCallback([&](const sensor_msgs::msg::JointState::ConstSharedPtr& msg) {
+    joint_state_statistics.applied.increment();
+    if (generate)
+      joint_state_statistics.latency.record(steadyNow() - fromStamp(msg->header.stamp));
+  });
+
+  rclcpp::executors::MultiThreadedExecutor executor;
+  executor.add_node(node);
+  executor.add_node(load_node);
+  std::thread executor_thread([&executor] { executor.spin(); });
+
+  // let the subscriptions connect before measuring
+  rclcpp::sleep_for(1s);
+  const moveit::metrics::LatencyHistogram::Snapshot octomap_update_before = psm->getMetrics().octomap_update.snapshot();
+  const moveit::metrics::LatencyHistogram::Snapshot lock_wait_before = psm->getMetrics().lock_wait.snapshot();
+
+  LoadGenerator generator(load_node, psm->getRobotModel(), cloud_topic, cloud_points);
+  generator.start(scene_rate, joint_state_rate, cloud_rate);
+  if (!generate)
+    RCLCPP_INFO(LOGGER, "No load is generated, measuring the messages replayed by other nodes");
+
+  std::atomic<bool> done{ false };
+  std::vector<std::thread> reader_threads;
+  for (unsigned int i = 0; i < readers && reader_rate > 0.0; ++i)
+  {
+    reader_threads.emplace_back([&] {
+      const auto period = std::chrono::duration<double>(1.0 / reader_rate);
+      auto next = std::chrono::steady_clock::now();
+      while (!done)
+      {
+        {
+          planning_scene_monitor::LockedPlanningSceneRO scene(psm, "benchmark_reader");
+          collision_detection::CollisionRequest req;
+          collision_detection::CollisionResult res;
+          scene->checkCollision(req, res);
+        }
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        std::this_thread::sleep_until(next);
+      }
+    });
+  }
+
+  RCLCPP_INFO(LOGGER, "Measuring for %.1f seconds...", duration);
+  const auto start = std::chrono::steady_clock::now();
+  rclcpp::sleep_for(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(duration)));
+  generator.stop();
+  // give the monitor time to apply the messages still in flight
+  rclcpp::sleep_for(500ms);
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  done = true;
+  for (std::thread& reader_thread : reader_threads)
+    reader_thread.join();
+
+  const moveit::metrics::LatencyHistogram::Snapshot octomap_update =
+      psm->getMetrics().octomap_update.snapshot() - octomap_update_before;
+  const moveit::metrics::LatencyHistogram::Snapshot scene_lock_wait =
+      psm->getMetrics().lock_wait.snapshot() - lock_wait_before;
+
+  Report report(output.empty() ? std::cout : output_file);
+  report.add("planning_scene", scene_statistics.arrived.value(), scene_statistics.applied.value(),
+             scene_statistics.latency.snapshot(), seconds);
+  report.add("joint_states", joint_state_statistics.arrived.value(), joint_state_statistics.applied.value(),
+             joint_state_statistics.latency.snapshot(), seconds);
+  // the octomap update duration includes waiting for the scene lock, the time the cloud spent in transit is unknown
+  report.add("octomap", cloud_statistics.arrived.value(), octomap_update.count, octomap_update, seconds);
+  // lock waits are not messages, their rows report the number of lock acquisitions and the wait quantiles
+  const auto lock_statistics = psm->getLockStatistics();
+  const auto reader = lock_statistics.find("benchmark_reader");
+  if (reader != lock_statistics.end())
+    report.add("reader_lock_wait", reader->second.read_wait.count, reader->second.read_wait.count,
+               reader->second.read_wait, seconds);
+  report.add("scene_lock_wait", scene_lock_wait.count, scene_lock_wait.count, scene_lock_wait, seconds);
+
+  executor.cancel();
+  executor_thread.join();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,391 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Measures how collision checking, IK and motion planning scale with the number of threads.
+ *
+ * For every benchmark and thread count, the workload runs for a fixed wall time and one CSV row is written with the
+ * number of operations, the throughput, the speedup over one thread and the parallel efficiency (speedup per thread).
+ */
+
+#include <moveit/kinematic_constraints/utils.h>
+#include <moveit/planning_pipeline_interfaces/planning_pipeline_interfaces.hpp>
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit/robot_state/conversions.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static const std::string ROBOT_DESCRIPTION = "robot_description";
+
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("evaluate_parallel_scaling");
+
+namespace
+{
+struct Measurement
+{
+  std::size_t operations = 0;
+  std::size_t successes = 0;
+  double seconds = 0.0;
+};
+
+// Called repeatedly by every thread with the thread index and the number of operations the thread has run so far,
+// returns whether the operation succeeded
+using Operation = std::function<bool(unsigned int, std::size_t)>;
+
+Measurement runThreads(unsigned int thread_count, double duration, const Operation& operation)
+{
+  std::atomic<std::size_t> operations{ 0 };
+  std::atomic<std::size_t> successes{ 0 };
+  const auto start = std::chrono::steady_clock::now();
+  const auto deadline = start + std::chrono::duration<double>(duration);
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < thread_count; ++i)
+  {
+    threads.emplace_back([i, deadline, &operation, &operations, &successes] {
+      std::size_t thread_operations = 0;
+      std::size_t thread_successes = 0;
+      while (std::chrono::steady_clock::now() < deadline)
+      {
+        if (operation(i, thread_operations))
+          ++thread_successes;
+        ++thread_operations;
+      }
+      operations += thread_operations;
+      successes += thread_successes;
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  Measurement measurement;
+  measurement.operations = operations;
+  measurement.successes = successes;
+  measurement.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return measurement;
+}
+
+// The thread counts of the sweep: powers of two up to max_threads, and max_threads itself
+std::vector<unsigned int> threadCounts(unsigned int max_threads)
+{
+  std::vector<unsigned int> counts;
+  for (unsigned int count = 1; count < max_threads; count *= 2)
+    counts.push_back(count);
+  counts.push_back(max_threads);
+  return counts;
+}
+
+class Report
+{
+public:
+  explicit Report(std::ostream& out) : out_(out)
+  {
+    out_ << "benchmark,threads,operations,successes,seconds,throughput,speedup,efficiency" << '\n';
+  }
+
+  void add(const std::string& benchmark, unsigned int threads, const Measurement& measurement)
+  {
+    const double throughput =
+        measurement.seconds > 0.0 ? static_cast<double>(measurement.successes) / measurement.seconds : 0.0;
+    // the first row of every benchmark is measured with one thread and is the baseline for the speedup
+    if (threads == 1)
+      baseline_ = throughput;
+    const double speedup = baseline_ > 0.0 ? throughput / baseline_ : 0.0;
+    out_ << benchmark << ',' << threads << ',' << measurement.operations << ',' << measurement.successes << ','
+         << measurement.seconds << ',' << throughput << ',' << speedup << ',' << speedup / threads << std::endl;
+    RCLCPP_INFO(LOGGER, "%s with %u threads: %.1f successful operations per second, speedup %.2f", benchmark.c_str(),
+                threads, throughput, speedup);
+  }
+
+private:
+  std::ostream& out_;
+  double baseline_ = 0.0;
+};
+
+// Sample a state that is valid in the scene, for the variables of the group or all variables if group is nullptr
+void sampleValidState(const planning_scene::PlanningScene& scene, const moveit::core::JointModelGroup* group,
+                      moveit::core::RobotState& state)
+{
+  collision_detection::CollisionRequest req;
+  do
+  {
+    if (group)
+      state.setToRandomPositions(group);
+    else
+      state.setToRandomPositions();
+    state.update();
+    collision_detection::CollisionResult res;
+    scene.checkCollision(req, res, state);
+    if (!res.collision)
+      break;
+  } while (true);
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  auto node = rclcpp::Node::make_shared("evaluate_parallel_scaling");
+
+  unsigned int max_threads = std::max(1u, std::thread::hardware_concurrency());
+  double duration = 2.0;
+  unsigned int samples = 20;
+  std::string benchmarks = "collision,ik,planning,planning_attempts";
+  std::string group_name;
+  std::string pipeline_name;
+  std::string planner_id;
+  double planning_time = 1.0;
+  double ik_timeout = 0.05;
+  std::string output;
+  boost::program_options::options_description desc;
+  desc.add_options()("max_threads",
+                     boost::program_options::value<unsigned int>(&max_threads)->default_value(max_threads),
+                     "Largest number of threads, the sweep runs powers of two up to this count")(
+      "duration", boost::program_options::value<double>(&duration)->default_value(duration),
+      "Wall time in seconds each benchmark runs for every thread count")(
+      "samples", boost::program_options::value<unsigned int>(&samples)->default_value(samples),
+      "Number of random states, poses and planning problems the operations cycle through")(
+      "benchmarks", boost::program_options::value<std::string>(&benchmarks)->default_value(benchmarks),
+      "Comma separated benchmarks to run: collision, ik, planning (concurrent requests to one pipeline) and "
+      "planning_attempts (one request with as many planning attempts as threads)")(
+      "group", boost::program_options::value<std::string>(&group_name), "Joint model group for IK and planning")(
+      "pipeline", boost::program_options::value<std::string>(&pipeline_name),
+      "Name of the planning pipeline, also the namespace of its parameters")(
+      "planner_id", boost::program_options::value<std::string>(&planner_id), "Planner of the pipeline to use")(
+      "planning_time", boost::program_options::value<double>(&planning_time)->default_value(planning_time),
+      "Allowed planning time per request")(
+      "ik_timeout", boost::program_options::value<double>(&ik_timeout)->default_value(ik_timeout),
+      "Timeout per IK query")("output", boost::program_options::value<std::string>(&output),
+                              "CSV file to write the results to, standard output if not set")(
+      "wait", "Wait for a user command (so the planning scene can be updated in the background)")("help",
+                                                                                                  "this screen");
+  boost::program_options::variables_map vm;
+  boost::program_options::parsed_options po = boost::program_options::parse_command_line(argc, argv, desc);
+  boost::program_options::store(po, vm);
+  boost::program_options::notify(vm);
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << '\n';
+    return 0;
+  }
+
+  std::vector<std::string> selected;
+  boost::split(selected, benchmarks, boost::is_any_of(","), boost::token_compress_on);
+  const auto is_selected = [&selected](const std::string& name) {
+    return std::find(selected.begin(), selected.end(), name) != selected.end();
+  };
+
+  auto psm = std::make_shared<planning_scene_monitor::PlanningSceneMonitor>(node, ROBOT_DESCRIPTION);
+  if (!psm->getPlanningScene())
+  {
+    RCLCPP_ERROR(LOGGER, "Planning scene not configured");
+    return 1;
+  }
+
+  if (vm.count("wait"))
+  {
+    psm->startWorldGeometryMonitor();
+    psm->startSceneMonitor();
+    std::cout << "Listening to planning scene updates. Press Enter to continue ..." << '\n';
+    std::cin.get();
+  }
+  else
+    rclcpp::sleep_for(500ms);
+
+  // benchmark a snapshot, so that scene updates do not change the workload during the sweep
+  planning_scene::PlanningScenePtr scene;
+  {
+    planning_scene_monitor::LockedPlanningSceneRO locked_scene(psm);
+    scene = planning_scene::PlanningScene::clone(locked_scene);
+  }
+  const moveit::core::RobotModelConstPtr& model = scene->getRobotModel();
+
+  const moveit::core::JointModelGroup* group = nullptr;
+  if (!group_name.empty())
+  {
+    group = model->getJointModelGroup(group_name);
+    if (!group)
+    {
+      RCLCPP_ERROR(LOGGER, "Group '%s' is not part of the robot model", group_name.c_str());
+      return 1;
+    }
+  }
+
+  std::ofstream output_file;
+  if (!output.empty())
+  {
+    output_file.open(output);
+    if (!output_file)
+    {
+      RCLCPP_ERROR(LOGGER, "Unable to open '%s'", output.c_str());
+      return 1;
+    }
+  }
+  Report report(output.empty() ? std::cout : output_file);
+
+  samples = std::max(1u, samples);
+  const std::vector<unsigned int> thread_counts = threadCounts(std::max(1u, max_threads));
+
+  if (is_selected("collision"))
+  {
+    RCLCPP_INFO(LOGGER, "Sampling %u valid states...", samples);
+    std::vector<moveit::core::RobotState> states(samples, moveit::core::RobotState(model));
+    for (moveit::core::RobotState& state : states)
+      sampleValidState(*scene, nullptr, state);
+
+    for (unsigned int threads : thread_counts)
+    {
+      report.add("collision", threads, runThreads(threads, duration, [&](unsigned int thread, std::size_t iteration) {
+                   collision_detection::CollisionRequest req;
+                   collision_detection::CollisionResult res;
+                   scene->checkCollision(req, res, states[(thread + iteration) % states.size()]);
+                   return true;
+                 }));
+    }
+  }
+
+  if (is_selected("ik"))
+  {
+    const kinematics::KinematicsBaseConstPtr solver = group ? group->getSolverInstance() : nullptr;
+    if (!solver)
+      RCLCPP_ERROR(LOGGER, "Skipping the IK benchmark, it requires a group with an IK solver");
+    else
+    {
+      // poses the tip reaches in valid states, so every query has a solution
+      const std::string& tip = solver->getTipFrame();
+      std::vector<Eigen::Isometry3d> poses;
+      moveit::core::RobotState state(model);
+      state.setToDefaultValues();
+      for (unsigned int i = 0; i < samples; ++i)
+      {
+        sampleValidState(*scene, group, state);
+        poses.push_back(state.getGlobalLinkTransform(tip));
+      }
+
+      // every thread solves from random seeds in its own robot state
+      std::vector<moveit::core::RobotState> thread_states(thread_counts.back(), state);
+      for (unsigned int threads : thread_counts)
+      {
+        report.add("ik", threads, runThreads(threads, duration, [&](unsigned int thread, std::size_t iteration) {
+                     moveit::core::RobotState& thread_state = thread_states[thread];
+                     thread_state.setToRandomPositions(group);
+                     return thread_state.setFromIK(group, poses[(thread + iteration) % poses.size()], tip, ik_timeout);
+                   }));
+      }
+    }
+  }
+
+  if (is_selected("planning") || is_selected("planning_attempts"))
+  {
+    planning_pipeline::PlanningPipelinePtr pipeline;
+    if (group && !pipeline_name.empty())
+    {
+      const auto pipelines =
+          moveit::planning_pipeline_interfaces::createPlanningPipelineMap({ pipeline_name }, model, node);
+      const auto it = pipelines.find(pipeline_name);
+      if (it != pipelines.end())
+        pipeline = it->second;
+    }
+
+    if (!pipeline)
+      RCLCPP_ERROR(LOGGER, "Skipping the planning benchmarks, they require a group and a planning pipeline");
+    else
+    {
+      RCLCPP_INFO(LOGGER, "Sampling %u planning problems...", samples);
+      std::vector<planning_interface::MotionPlanRequest> requests;
+      moveit::core::RobotState start(model);
+      moveit::core::RobotState goal(model);
+      start.setToDefaultValues();
+      goal.setToDefaultValues();
+      for (unsigned int i = 0; i < samples; ++i)
+      {
+        sampleValidState(*scene, group, start);
+        sampleValidState(*scene, group, goal);
+        planning_interface::MotionPlanRequest req;
+        req.pipeline_id = pipeline_name;
+        req.planner_id = planner_id;
+        req.group_name = group_name;
+        req.allowed_planning_time = planning_time;
+        req.num_planning_attempts = 1;
+        req.max_velocity_scaling_factor = 1.0;
+        req.max_acceleration_scaling_factor = 1.0;
+        moveit::core::robotStateToRobotStateMsg(start, req.start_state);
+        req.goal_constraints.push_back(kinematic_constraints::constructGoalConstraints(goal, group));
+        requests.push_back(req);
+      }
+
+      if (is_selected("planning"))
+      {
+        // independent requests planned concurrently, as with parallel pipelines
+        for (unsigned int threads : thread_counts)
+        {
+          const Operation plan = [&](unsigned int thread, std::size_t iteration) {
+            planning_interface::MotionPlanResponse res;
+            return pipeline->generatePlan(scene, requests[(thread + iteration) % requests.size()], res, false, true,
+                                          false);
+          };
+          report.add("planning", threads, runThreads(threads, duration, plan));
+        }
+      }
+
+      if (is_selected("planning_attempts"))
+      {
+        // one request at a time, the planner runs the attempts in parallel (e.g. OMPL's parallel plan)
+        for (unsigned int threads : thread_counts)
+        {
+          report.add("planning_attempts", threads, runThreads(1, duration, [&](unsigned int, std::size_t iteration) {
+                       planning_interface::MotionPlanRequest req = requests[iteration % requests.size()];
+                       req.num_planning_attempts = threads;
+                       planning_interface::MotionPlanResponse res;
+                       return pipeline->generatePlan(scene, req, res, false, true, false);
+                     }));
+        }
+      }
+    }
+  }
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,117 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/constraint_samplers/reachability_map.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <rclcpp/node.hpp>
+#include <rclcpp/utilities.hpp>
+
+static const std::string ROBOT_DESCRIPTION = "robot_description";
+
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("generate_reachability_map");
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  auto node = rclcpp::Node::make_shared("generate_reachability_map");
+
+  std::string group_name;
+  std::string output;
+  double resolution = 0.05;
+  std::size_t samples = 1000000;
+  unsigned int seeds_per_voxel = 4;
+  boost::program_options::options_description desc;
+  desc.add_options()("group", boost::program_options::value<std::string>(&group_name), "The planning group")(
+      "output", boost::program_options::value<std::string>(&output), "The file to store the map in")(
+      "resolution", boost::program_options::value<double>(&resolution)->default_value(resolution),
+      "The edge length of the voxels")(
+      "samples", boost::program_options::value<std::size_t>(&samples)->default_value(samples),
+      "The number of random states to sample")(
+      "seeds", boost::program_options::value<unsigned int>(&seeds_per_voxel)->default_value(seeds_per_voxel),
+      "The number of IK seeds to store per voxel")("help", "this screen");
+  boost::program_options::variables_map vm;
+  boost::program_options::parsed_options po =
+      boost::program_options::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+  boost::program_options::store(po, vm);
+  boost::program_options::notify(vm);
+
+  if (vm.count("help") || group_name.empty() || output.empty())
+  {
+    std::cout << desc << '\n';
+    rclcpp::shutdown();
+    return vm.count("help") ? 0 : 1;
+  }
+
+  robot_model_loader::RobotModelLoader rml(node, ROBOT_DESCRIPTION);
+  const moveit::core::RobotModelConstPtr& robot_model = rml.getModel();
+  const moveit::core::JointModelGroup* jmg = robot_model ? robot_model->getJointModelGroup(group_name) : nullptr;
+  const kinematics::KinematicsBaseConstPtr solver = jmg ? jmg->getSolverInstance() : nullptr;
+  if (!solver)
+  {
+    RCLCPP_ERROR(LOGGER, "Group '%s' does not exist or has no IK solver", group_name.c_str());
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  // states in self-collision are not recorded, so they are never used as IK seeds
+  const planning_scene::PlanningScene scene(robot_model);
+  const auto self_collision_free = [&scene](const moveit::core::RobotState& state) {
+    collision_detection::CollisionRequest req;
+    collision_detection::CollisionResult res;
+    scene.checkSelfCollision(req, res, state);
+    return !res.collision;
+  };
+
+  RCLCPP_INFO(LOGGER, "Sampling %zu states of group '%s' for tip '%s' in frame '%s'", samples, group_name.c_str(),
+              solver->getTipFrame().c_str(), solver->getBaseFrame().c_str());
+  constraint_samplers::ReachabilityMapPtr map =
+      constraint_samplers::ReachabilityMap::generate(robot_model, group_name, solver->getBaseFrame(),
+                                                     solver->getTipFrame(), resolution, samples, seeds_per_voxel,
+                                                     self_collision_free);
+  if (!map || !map->save(output))
+  {
+    RCLCPP_ERROR(LOGGER, "Unable to generate the reachability map '%s'", output.c_str());
+    rclcpp::shutdown();
+    return 1;
+  }
+  RCLCPP_INFO(LOGGER, "Stored %zu reachable voxels in '%s'", map->getReachableVoxelCount(), output.c_str());
+
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,157 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/planning_interface/planning_request.h>
+#include <moveit/planning_interface/planning_response.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <moveit_planning_pipeline_export.h>
+
+namespace planning_pipeline
+{
+MOVEIT_CLASS_FORWARD(MotionPlanCacheBackend);  // Defines MotionPlanCacheBackendPtr, ConstPtr, WeakPtr... etc
+MOVEIT_CLASS_FORWARD(MotionPlanCache);         // Defines MotionPlanCachePtr, ConstPtr, WeakPtr... etc
+
+/** \brief A solution stored in a MotionPlanCache */
+struct CachedMotionPlan
+{
+  /// The positions of all variables of the start state the plan was computed for
+  std::vector<double> start_positions;
+  robot_trajectory::RobotTrajectoryConstPtr trajectory;
+  std::string planner_id;
+};
+
+/** \brief Storage of a MotionPlanCache. Implementations must be thread-safe. */
+class MOVEIT_PLANNING_PIPELINE_EXPORT MotionPlanCacheBackend
+{
+public:
+  virtual ~MotionPlanCacheBackend() = default;
+
+  /** \brief Get the plan stored for \e key. Returns false if there is none. */
+  virtual bool get(std::size_t key, CachedMotionPlan& plan) = 0;
+
+  /** \brief Store \e plan for \e key, replacing a plan stored for the same key */
+  virtual void put(std::size_t key, const CachedMotionPlan& plan) = 0;
+
+  virtual void erase(std::size_t key) = 0;
+
+  virtual void clear() = 0;
+
+  virtual std::size_t size() const = 0;
+};
+
+/** \brief In-memory backend that evicts the least recently used plan once \e capacity plans are stored */
+class MOVEIT_PLANNING_PIPELINE_EXPORT LRUMotionPlanCacheBackend : public MotionPlanCacheBackend
+{
+public:
+  explicit LRUMotionPlanCacheBackend(std::size_t capacity);
+
+  bool get(std::size_t key, CachedMotionPlan& plan) override;
+  void put(std::size_t key, const CachedMotionPlan& plan) override;
+  void erase(std::size_t key) override;
+  void clear() override;
+  std::size_t size() const override;
+
+private:
+  using Entries = std::list<std::pair<std::size_t, CachedMotionPlan>>;
+
+  std::size_t capacity_;
+  /// most recently used entries first
+  Entries entries_;
+  std::unordered_map<std::size_t, Entries::iterator> index_;
+  mutable std::mutex lock_;
+};
+
+/** \brief Caches the responses of a planning pipeline.
+
+    Requests are fingerprinted by their content (group, goal and path constraints, planner, ...), the start state
+    quantized to \e start_state_tolerance, and the objects in the planning scene world. A cached plan is only returned
+    if its start state is within the tolerance of the requested one and it is still valid in the current scene. */
+class MOVEIT_PLANNING_PIPELINE_EXPORT MotionPlanCache
+{
+public:
+  struct Statistics
+  {
+    std::size_t hits;
+    std::size_t misses;
+    /// lookups that found a plan which was no longer valid in the planning scene
+    std::size_t revalidation_failures;
+  };
+
+  MotionPlanCache(const MotionPlanCacheBackendPtr& backend, double start_state_tolerance);
+
+  /** \brief Fill \e res with a cached plan for \e req. Returns false on a miss. */
+  bool lookup(const planning_scene::PlanningSceneConstPtr& planning_scene,
+              const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res);
+
+  /** \brief Store the successful response \e res to \e req */
+  void store(const planning_scene::PlanningSceneConstPtr& planning_scene,
+             const planning_interface::MotionPlanRequest& req, const planning_interface::MotionPlanResponse& res);
+
+  Statistics getStatistics() const;
+
+  const MotionPlanCacheBackendPtr& getBackend() const
+  {
+    return backend_;
+  }
+
+  double getStartStateTolerance() const
+  {
+    return start_state_tolerance_;
+  }
+
+private:
+  std::size_t fingerprint(const planning_scene::PlanningScene& planning_scene,
+                          const planning_interface::MotionPlanRequest& req,
+                          const moveit::core::RobotState& start_state) const;
+
+  MotionPlanCacheBackendPtr backend_;
+  double start_state_tolerance_;
+
+  std::atomic<std::size_t> hits_;
+  std::atomic<std::size_t> misses_;
+  std::atomic<std::size_t> revalidation_failures_;
+};
+}  // namespace planning_pipeline
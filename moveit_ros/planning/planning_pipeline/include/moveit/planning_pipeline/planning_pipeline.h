@@ -39,13 +39,18 @@
 #include <atomic>
 
 #include <moveit/planning_interface/planning_interface.h>
+#include <moveit/planning_pipeline/motion_plan_cache.h>
 #include <moveit/planning_request_adapter/planning_request_adapter.h>
+#include <moveit/utils/metrics.h>
 #include <pluginlib/class_loader.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <diagnostic_msgs/msg/diagnostic_status.hpp>
 #include <moveit_msgs/msg/display_trajectory.hpp>
 #include <visualization_msgs/msg/marker_array.hpp>
 
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include <moveit_planning_pipeline_export.h>
 
@@ -70,6 +75,9 @@ public:
   /** \brief When contacts are found in the solution path reported by a planner, they can be published as markers on
    * this topic (visualization_msgs::MarkerArray) */
   static inline const std::string MOTION_CONTACTS_TOPIC = std::string("display_contacts");
+  /** \brief When a motion plan cache is used, its hit, miss and revalidation failure counts are published on this topic
+   * (diagnostic_msgs::msg::DiagnosticStatus) after every request */
+  static inline const std::string MOTION_PLAN_CACHE_STATUS_TOPIC = std::string("motion_plan_cache_status");
 
   /** \brief Given a robot model (\e model), a node handle (\e pipeline_nh), initialize the planning pipeline.
       \param model The robot model for which this pipeline is initialized.
@@ -154,6 +162,20 @@ public:
     return robot_model_;
   }
 
+  /** \brief Answer requests from \e cache when it holds a valid plan for them, and store new solutions in it. Pass
+      nullptr to disable caching. The in-memory cache can also be enabled with the 'response_cache_capacity'
+      parameter. */
+  void setMotionPlanCache(const MotionPlanCachePtr& cache);
+
+  [[nodiscard]] const MotionPlanCachePtr& getMotionPlanCache() const
+  {
+    return motion_plan_cache_;
+  }
+
+  /** \brief Get the distribution of the time generatePlan() took to find a plan, by planner id. Requests without a
+      planner id are counted under the empty id. */
+  [[nodiscard]] std::map<std::string, moveit::metrics::LatencyHistogram::Snapshot> getPlanningLatencies() const;
+
   /** \brief Get current status of the planning pipeline */
   [[nodiscard]] bool isActive() const
   {
@@ -163,6 +185,8 @@ public:
 private:
   void configure();
 
+  void publishMotionPlanCacheStatus() const;
+
   // Flag that indicates whether or not the planning pipeline is currently solving a planning problem
   mutable std::atomic<bool> active_;
 
@@ -186,6 +210,13 @@ private:
 
   /// Publish contacts if the generated plans are checked again by the planning pipeline
   rclcpp::Publisher<visualization_msgs::msg::MarkerArray>::SharedPtr contacts_publisher_;
+
+  /// Optional cache of previous solutions
+  MotionPlanCachePtr motion_plan_cache_;
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticStatus>::SharedPtr motion_plan_cache_status_publisher_;
+
+  mutable std::mutex planning_latency_lock_;
+  mutable std::map<std::string, moveit::metrics::LatencyHistogram> planning_latency_;
 };
 
 MOVEIT_CLASS_FORWARD(PlanningPipeline);  // Defines PlanningPipelinePtr, ConstPtr, WeakPtr... etc
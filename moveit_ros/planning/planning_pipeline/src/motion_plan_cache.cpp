@@ -0,0 +1,235 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/planning_pipeline/motion_plan_cache.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit/utils/message_checks.h>
+#include <boost/functional/hash.hpp>
+#include <rclcpp/logging.hpp>
+#include <rclcpp/serialization.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <string_view>
+
+namespace planning_pipeline
+{
+namespace
+{
+const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros_planning.motion_plan_cache");
+
+void hashIsometry(std::size_t& seed, const Eigen::Isometry3d& pose)
+{
+  const double* data = pose.matrix().data();
+  for (std::size_t i = 0; i < 16; ++i)
+    boost::hash_combine(seed, data[i]);
+}
+
+moveit::core::RobotState getStartState(const planning_scene::PlanningScene& planning_scene,
+                                       const planning_interface::MotionPlanRequest& req)
+{
+  moveit::core::RobotState start_state = planning_scene.getCurrentState();
+  if (!moveit::core::isEmpty(req.start_state))
+    moveit::core::robotStateMsgToRobotState(planning_scene.getTransforms(), req.start_state, start_state);
+  return start_state;
+}
+}  // namespace
+
+LRUMotionPlanCacheBackend::LRUMotionPlanCacheBackend(std::size_t capacity) : capacity_(capacity)
+{
+}
+
+bool LRUMotionPlanCacheBackend::get(std::size_t key, CachedMotionPlan& plan)
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  auto it = index_.find(key);
+  if (it == index_.end())
+    return false;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  plan = it->second->second;
+  return true;
+}
+
+void LRUMotionPlanCacheBackend::put(std::size_t key, const CachedMotionPlan& plan)
+{
+  if (capacity_ == 0)
+    return;
+  std::lock_guard<std::mutex> slock(lock_);
+  auto it = index_.find(key);
+  if (it != index_.end())
+  {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    it->second->second = plan;
+    return;
+  }
+  if (entries_.size() >= capacity_)
+  {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, plan);
+  index_[key] = entries_.begin();
+}
+
+void LRUMotionPlanCacheBackend::erase(std::size_t key)
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  auto it = index_.find(key);
+  if (it != index_.end())
+  {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+}
+
+void LRUMotionPlanCacheBackend::clear()
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  entries_.clear();
+  index_.clear();
+}
+
+std::size_t LRUMotionPlanCacheBackend::size() const
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  return entries_.size();
+}
+
+MotionPlanCache::MotionPlanCache(const MotionPlanCacheBackendPtr& backend, double start_state_tolerance)
+  : backend_(backend), start_state_tolerance_(start_state_tolerance), hits_(0), misses_(0), revalidation_failures_(0)
+{
+  if (!backend_)
+    throw std::invalid_argument("MotionPlanCache needs a backend");
+  if (!(start_state_tolerance_ > 0.0))
+    throw std::invalid_argument("MotionPlanCache needs a positive start state tolerance");
+}
+
+std::size_t MotionPlanCache::fingerprint(const planning_scene::PlanningScene& planning_scene,
+                                         const planning_interface::MotionPlanRequest& req,
+                                         const moveit::core::RobotState& start_state) const
+{
+  // the start state is hashed with tolerance below, and the planning time and number of attempts do not change what a
+  // valid solution is
+  planning_interface::MotionPlanRequest request = req;
+  request.start_state = moveit_msgs::msg::RobotState();
+  request.allowed_planning_time = 0.0;
+  request.num_planning_attempts = 0;
+
+  rclcpp::Serialization<moveit_msgs::msg::MotionPlanRequest> serialization;
+  rclcpp::SerializedMessage serialized_request;
+  serialization.serialize_message(&request, &serialized_request);
+  const rcl_serialized_message_t& buffer = serialized_request.get_rcl_serialized_message();
+  std::size_t seed = std::hash<std::string_view>()(
+      std::string_view(reinterpret_cast<const char*>(buffer.buffer), buffer.buffer_length));
+
+  // states within the tolerance usually fall into the same cell; lookup() compares the exact positions
+  for (std::size_t i = 0; i < start_state.getVariableCount(); ++i)
+    boost::hash_combine(seed, std::llround(start_state.getVariablePosition(i) / start_state_tolerance_));
+
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  start_state.getAttachedBodies(attached_bodies);
+  for (const moveit::core::AttachedBody* attached_body : attached_bodies)
+    boost::hash_combine(seed, attached_body->getName());
+
+  for (const auto& [id, object] : *planning_scene.getWorld())
+  {
+    boost::hash_combine(seed, id);
+    hashIsometry(seed, object->pose_);
+    for (std::size_t k = 0; k < object->shapes_.size(); ++k)
+    {
+      boost::hash_combine(seed, static_cast<int>(object->shapes_[k]->type));
+      hashIsometry(seed, object->shape_poses_[k]);
+    }
+  }
+  return seed;
+}
+
+bool MotionPlanCache::lookup(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                             const planning_interface::MotionPlanRequest& req,
+                             planning_interface::MotionPlanResponse& res)
+{
+  const auto start_time = std::chrono::steady_clock::now();
+  const moveit::core::RobotState start_state = getStartState(*planning_scene, req);
+  const std::size_t key = fingerprint(*planning_scene, req, start_state);
+
+  CachedMotionPlan plan;
+  bool found = backend_->get(key, plan) && plan.trajectory &&
+               plan.start_positions.size() == start_state.getVariableCount();
+  for (std::size_t i = 0; found && i < plan.start_positions.size(); ++i)
+    found = std::abs(plan.start_positions[i] - start_state.getVariablePosition(i)) <= start_state_tolerance_;
+  if (!found)
+  {
+    ++misses_;
+    return false;
+  }
+
+  if (!planning_scene->isPathValid(*plan.trajectory, req.path_constraints, req.goal_constraints, req.group_name))
+  {
+    RCLCPP_DEBUG(LOGGER, "Cached plan for group '%s' is no longer valid", req.group_name.c_str());
+    ++revalidation_failures_;
+    backend_->erase(key);
+    return false;
+  }
+
+  ++hits_;
+  res.trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(*plan.trajectory, true);
+  moveit::core::robotStateToRobotStateMsg(plan.trajectory->getFirstWayPoint(), res.start_state);
+  res.planner_id = plan.planner_id;
+  res.error_code.val = moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
+  res.planning_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  return true;
+}
+
+void MotionPlanCache::store(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                            const planning_interface::MotionPlanRequest& req,
+                            const planning_interface::MotionPlanResponse& res)
+{
+  if (!res || !res.trajectory || res.trajectory->empty())
+    return;
+
+  const moveit::core::RobotState start_state = getStartState(*planning_scene, req);
+  CachedMotionPlan plan;
+  plan.start_positions.assign(start_state.getVariablePositions(),
+                              start_state.getVariablePositions() + start_state.getVariableCount());
+  plan.trajectory = std::make_shared<const robot_trajectory::RobotTrajectory>(*res.trajectory, true);
+  plan.planner_id = res.planner_id;
+  backend_->put(fingerprint(*planning_scene, req, start_state), plan);
+}
+
+MotionPlanCache::Statistics MotionPlanCache::getStatistics() const
+{
+  return Statistics{ hits_, misses_, revalidation_failures_ };
+}
+}  // namespace planning_pipeline
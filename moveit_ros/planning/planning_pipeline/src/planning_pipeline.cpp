@@ -38,8 +38,10 @@
 #include <moveit/robot_state/conversions.h>
 #include <moveit/collision_detection/collision_tools.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
+#include <moveit/utils/tracing.h>
 #include <boost/tokenizer.hpp>
 #include <fmt/format.h>
+#include <chrono>
 #include <sstream>
 
 #include <planning_pipeline_parameters.hpp>
@@ -68,6 +70,14 @@ planning_pipeline::PlanningPipeline::PlanningPipeline(const moveit::core::RobotM
   }
 
   configure();
+
+  if (params.response_cache_capacity > 0)
+  {
+    setMotionPlanCache(std::make_shared<MotionPlanCache>(
+        std::make_shared<LRUMotionPlanCacheBackend>(params.response_cache_capacity),
+        params.response_cache_start_state_tolerance));
+    RCLCPP_INFO(LOGGER, "Caching up to %ld motion plan responses", params.response_cache_capacity);
+  }
 }
 
 planning_pipeline::PlanningPipeline::PlanningPipeline(const moveit::core::RobotModelConstPtr& model,
@@ -85,6 +95,46 @@ planning_pipeline::PlanningPipeline::PlanningPipeline(const moveit::core::RobotM
   configure();
 }
 
+void planning_pipeline::PlanningPipeline::setMotionPlanCache(const MotionPlanCachePtr& cache)
+{
+  motion_plan_cache_ = cache;
+  if (motion_plan_cache_ && !motion_plan_cache_status_publisher_)
+  {
+    motion_plan_cache_status_publisher_ = node_->create_publisher<diagnostic_msgs::msg::DiagnosticStatus>(
+        MOTION_PLAN_CACHE_STATUS_TOPIC, rclcpp::SystemDefaultsQoS());
+  }
+}
+
+void planning_pipeline::PlanningPipeline::publishMotionPlanCacheStatus() const
+{
+  const MotionPlanCache::Statistics statistics = motion_plan_cache_->getStatistics();
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+  status.name = "motion_plan_cache";
+  status.hardware_id = parameter_namespace_;
+  for (const auto& [key, value] :
+       { std::make_pair("hits", statistics.hits), std::make_pair("misses", statistics.misses),
+         std::make_pair("revalidation_failures", statistics.revalidation_failures),
+         std::make_pair("size", motion_plan_cache_->getBackend()->size()) })
+  {
+    diagnostic_msgs::msg::KeyValue key_value;
+    key_value.key = key;
+    key_value.value = std::to_string(value);
+    status.values.push_back(key_value);
+  }
+  motion_plan_cache_status_publisher_->publish(status);
+}
+
+std::map<std::string, moveit::metrics::LatencyHistogram::Snapshot>
+planning_pipeline::PlanningPipeline::getPlanningLatencies() const
+{
+  std::map<std::string, moveit::metrics::LatencyHistogram::Snapshot> latencies;
+  std::scoped_lock lock(planning_latency_lock_);
+  for (const auto& [planner_id, histogram] : planning_latency_)
+    latencies[planner_id] = histogram.snapshot();
+  return latencies;
+}
+
 void planning_pipeline::PlanningPipeline::configure()
 {
   // Optional publishers for debugging
@@ -195,10 +245,12 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
                                                        const bool check_solution_paths,
                                                        const bool display_computed_motion_plans) const
 {
+  moveit::tracing::ScopedTrace trace("planning_pipeline_generate_plan", req.pipeline_id);
   assert(planner_instance_ != nullptr);
 
   // Set planning pipeline active
   active_ = true;
+  const auto planning_start = std::chrono::steady_clock::now();
 
   // broadcast the request we are about to work on, if needed
   if (publish_received_requests)
@@ -210,9 +262,15 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
   // Solve the motion planning problem
   // ---------------------------------
   bool solved = false;
+  bool solved_from_cache = false;
   try
   {
-    if (adapter_chain_)
+    if (motion_plan_cache_ && motion_plan_cache_->lookup(planning_scene, req, res))
+    {
+      RCLCPP_DEBUG(LOGGER, "Returning a cached motion plan");
+      solved = solved_from_cache = true;
+    }
+    else if (adapter_chain_)
     {
       solved = adapter_chain_->adaptAndPlan(planner_instance_, planning_scene, req, res);
       if (!res.added_path_index.empty())
@@ -225,8 +283,12 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
     }
     else
     {
-      planning_interface::PlanningContextPtr context =
-          planner_instance_->getPlanningContext(planning_scene, req, res.error_code);
+      planning_interface::PlanningContextPtr context;
+      {
+        moveit::tracing::ScopedTrace setup_trace("planning_context_setup", planner_instance_->getDescription());
+        context = planner_instance_->getPlanningContext(planning_scene, req, res.error_code);
+      }
+      moveit::tracing::ScopedTrace solve_trace("planning_context_solve", req.planner_id);
       solved = context ? context->solve(res) : false;
     }
   }
@@ -237,6 +299,10 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
     active_ = false;
     return false;
   }
+  {
+    std::scoped_lock lock(planning_latency_lock_);
+    planning_latency_[req.planner_id].record(std::chrono::steady_clock::now() - planning_start);
+  }
 
   // -----------------
   // Validate solution
@@ -245,7 +311,8 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
   {
     std::size_t state_count = res.trajectory->getWayPointCount();
     RCLCPP_DEBUG(LOGGER, "Motion planner reported a solution path with %ld states", state_count);
-    if (check_solution_paths)
+    // cached plans were already revalidated by the cache
+    if (check_solution_paths && !solved_from_cache)
     {
       visualization_msgs::msg::MarkerArray arr;
       visualization_msgs::msg::Marker m;
@@ -380,6 +447,13 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
     res.planner_id = req.planner_id;
   }
 
+  if (motion_plan_cache_)
+  {
+    if (!solved_from_cache && solved && res)
+      motion_plan_cache_->store(planning_scene, req, res);
+    publishMotionPlanCacheStatus();
+  }
+
   // Set planning pipeline to inactive
   active_ = false;
   return solved && bool(res);
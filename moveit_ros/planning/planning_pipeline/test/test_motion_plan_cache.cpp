@@ -0,0 +1,161 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/planning_pipeline/motion_plan_cache.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <geometric_shapes/shapes.h>
+#include <gtest/gtest.h>
+
+using namespace planning_pipeline;
+
+namespace
+{
+CachedMotionPlan planWithId(const std::string& planner_id)
+{
+  CachedMotionPlan plan;
+  plan.planner_id = planner_id;
+  return plan;
+}
+}  // namespace
+
+TEST(LRUMotionPlanCacheBackend, EvictsLeastRecentlyUsed)
+{
+  LRUMotionPlanCacheBackend backend(2);
+  backend.put(1, planWithId("one"));
+  backend.put(2, planWithId("two"));
+
+  // using plan 1 makes plan 2 the least recently used one
+  CachedMotionPlan plan;
+  ASSERT_TRUE(backend.get(1, plan));
+  EXPECT_EQ(plan.planner_id, "one");
+  backend.put(3, planWithId("three"));
+
+  EXPECT_EQ(backend.size(), 2u);
+  EXPECT_TRUE(backend.get(1, plan));
+  EXPECT_FALSE(backend.get(2, plan));
+  EXPECT_TRUE(backend.get(3, plan));
+
+  backend.erase(1);
+  EXPECT_FALSE(backend.get(1, plan));
+  backend.clear();
+  EXPECT_EQ(backend.size(), 0u);
+}
+
+class MotionPlanCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    robot_model_ = moveit::core::loadTestingRobotModel("panda");
+    scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+    const moveit::core::JointModelGroup* group = robot_model_->getJointModelGroup("panda_arm");
+    moveit::core::RobotState& state = scene_->getCurrentStateNonConst();
+    state.setToDefaultValues(group, "ready");
+    state.update();
+
+    request_.group_name = "panda_arm";
+
+    response_.trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, group);
+    response_.trajectory->addSuffixWayPoint(state, 0.0);
+    moveit::core::RobotState goal(state);
+    goal.setVariablePosition("panda_joint7", goal.getVariablePosition("panda_joint7") - 0.1);
+    goal.update();
+    response_.trajectory->addSuffixWayPoint(goal, 0.1);
+    response_.planner_id = "test_planner";
+    response_.error_code.val = moveit_msgs::msg::MoveItErrorCodes::SUCCESS;
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  planning_scene::PlanningScenePtr scene_;
+  planning_interface::MotionPlanRequest request_;
+  planning_interface::MotionPlanResponse response_;
+};
+
+TEST_F(MotionPlanCacheTest, HitAndMiss)
+{
+  MotionPlanCache cache(std::make_shared<LRUMotionPlanCacheBackend>(10), 1e-3);
+  planning_interface::MotionPlanResponse res;
+  EXPECT_FALSE(cache.lookup(scene_, request_, res));
+
+  cache.store(scene_, request_, response_);
+  ASSERT_TRUE(cache.lookup(scene_, request_, res));
+  ASSERT_TRUE(res.trajectory);
+  EXPECT_EQ(res.trajectory->getWayPointCount(), response_.trajectory->getWayPointCount());
+  EXPECT_EQ(res.planner_id, "test_planner");
+  EXPECT_TRUE(bool(res));
+
+  // a request for another planner is a different request
+  planning_interface::MotionPlanRequest other_request = request_;
+  other_request.planner_id = "other";
+  EXPECT_FALSE(cache.lookup(scene_, other_request, res));
+
+  // so is a start state outside of the tolerance
+  moveit::core::RobotState& state = scene_->getCurrentStateNonConst();
+  state.setVariablePosition("panda_joint1", state.getVariablePosition("panda_joint1") + 0.01);
+  state.update();
+  EXPECT_FALSE(cache.lookup(scene_, request_, res));
+
+  const MotionPlanCache::Statistics statistics = cache.getStatistics();
+  EXPECT_EQ(statistics.hits, 1u);
+  EXPECT_EQ(statistics.misses, 3u);
+  EXPECT_EQ(statistics.revalidation_failures, 0u);
+}
+
+TEST_F(MotionPlanCacheTest, RevalidatesCachedPlans)
+{
+  const Eigen::Isometry3d pose = Eigen::Isometry3d(Eigen::Translation3d(2.0, 0.0, 0.0));
+  scene_->getWorldNonConst()->addToObject("box", pose, std::make_shared<const shapes::Box>(0.01, 0.01, 0.01),
+                                          Eigen::Isometry3d::Identity());
+
+  MotionPlanCache cache(std::make_shared<LRUMotionPlanCacheBackend>(10), 1e-3);
+  cache.store(scene_, request_, response_);
+
+  // growing the box keeps the fingerprint of the scene, but the cached plan collides now
+  scene_->getWorldNonConst()->removeObject("box");
+  scene_->getWorldNonConst()->addToObject("box", pose, std::make_shared<const shapes::Box>(4.0, 4.0, 4.0),
+                                          Eigen::Isometry3d::Identity());
+  planning_interface::MotionPlanResponse res;
+  EXPECT_FALSE(cache.lookup(scene_, request_, res));
+  EXPECT_EQ(cache.getStatistics().revalidation_failures, 1u);
+
+  // invalid plans are dropped from the cache
+  EXPECT_EQ(cache.getBackend()->size(), 0u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -38,6 +38,7 @@
 #pragma once
 
 #include <moveit/planning_pipeline_interfaces/plan_responses_container.hpp>
+#include <moveit/planning_pipeline_interfaces/planning_thread_pool.hpp>
 #include <moveit/planning_interface/planning_response.h>
 #include <moveit/planning_interface/planning_request.h>
 #include <moveit/planning_pipeline/planning_pipeline.h>
@@ -64,6 +65,12 @@ typedef std::function<::planning_interface::MotionPlanResponse(
     const std::vector<::planning_interface::MotionPlanResponse>& solutions)>
     SolutionSelectionFunction;
 
+/** \brief A callback function type for the anytime planning API of planning component
+ * \param [in] solution The best solution found so far
+ * \return True to stop planning, e.g. because the solution is good enough to start executing it
+ */
+typedef std::function<bool(const ::planning_interface::MotionPlanResponse& solution)> SolutionCallbackFunction;
+
 /** \brief Function to calculate the MotionPlanResponse for a given MotionPlanRequest and a PlanningScene
  * \param [in] motion_plan_request Motion planning problem to be solved
  * \param [in] planning_scene Planning scene for which the given planning problem needs to be solved
@@ -86,6 +93,9 @@ typedef std::function<::planning_interface::MotionPlanResponse(
  terminate after the max. planning time defined in the MotionPlanningRequest is reached.
  * \param [in] solution_selection_function Function to select a specific solution out of all available solution. If no
  function is provided, all solutions are returned.
+ * \param [in] thread_pool Persistent pool the planning problems are queued on. Problems that have not started when the
+ stopping criterion is met are skipped and returned as PREEMPTED. If no pool is provided, a temporary pool with at most
+ std::thread::hardware_concurrency() threads is used.
  + \return If a solution_selection_function is provided a vector containing the selected response is returned, otherwise
  the vector contains all solutions produced.
 */
@@ -94,7 +104,32 @@ const std::vector<::planning_interface::MotionPlanResponse> planWithParallelPipe
     const ::planning_scene::PlanningSceneConstPtr& planning_scene,
     const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>& planning_pipelines,
     const StoppingCriterionFunction& stopping_criterion_callback = nullptr,
-    const SolutionSelectionFunction& solution_selection_function = nullptr);
+    const SolutionSelectionFunction& solution_selection_function = nullptr,
+    const PlanningThreadPoolPtr& thread_pool = nullptr);
+
+/** \brief Anytime planning: Solve the planning problems repeatedly with planWithParallelPipelines() until the largest
+ allowed planning time of the requests is used up, passing each solution that improves on the best one so far to
+ \e solution_callback
+ * \param [in] motion_plan_requests Motion planning problems to be solved, their allowed planning time is the total time
+ budget
+ * \param [in] planning_scene Planning scene for which the given planning problem needs to be solved
+ * \param [in] planning_pipelines Pipelines available to solve the problems
+ * \param [in] solution_callback Called from the calling thread with every improved solution. If it returns true,
+ planning stops and the solution is returned.
+ * \param [in] solution_selection_function Function that selects the best solution, it decides whether a new solution
+ improves on the best one so far. If no function is provided, the shortest solution is selected.
+ * \param [in] stopping_criterion_callback Stopping criterion applied to each round of parallel planning
+ * \param [in] thread_pool Persistent pool the planning problems are queued on, see planWithParallelPipelines()
+ * \return The best solution found. If no solution was found, a failed response.
+*/
+::planning_interface::MotionPlanResponse
+planAnytime(const std::vector<::planning_interface::MotionPlanRequest>& motion_plan_requests,
+            const ::planning_scene::PlanningSceneConstPtr& planning_scene,
+            const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>& planning_pipelines,
+            const SolutionCallbackFunction& solution_callback,
+            const SolutionSelectionFunction& solution_selection_function = nullptr,
+            const StoppingCriterionFunction& stopping_criterion_callback = nullptr,
+            const PlanningThreadPoolPtr& thread_pool = nullptr);
 
 /** \brief Utility function to create a map of named planning pipelines
  * \param [in] pipeline_names Vector of planning pipeline names to be used. Each name is also the namespace from which
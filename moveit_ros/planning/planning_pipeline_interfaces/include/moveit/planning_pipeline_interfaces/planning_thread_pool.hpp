@@ -0,0 +1,111 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Desc: A persistent, work-stealing thread pool to run planning pipelines in parallel */
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace moveit
+{
+namespace planning_pipeline_interfaces
+{
+MOVEIT_CLASS_FORWARD(PlanningThreadPool);  // Defines PlanningThreadPoolPtr, ConstPtr, WeakPtr... etc
+
+/** \brief A fixed set of worker threads executing planning tasks.
+ *
+ * Every worker owns a task queue. Tasks submitted from a worker thread are pushed to its own queue, all other tasks are
+ * distributed round-robin. Idle workers steal from the back of other queues, so long-running plans do not block short
+ * ones queued behind them. Tasks beyond the number of workers are queued instead of oversubscribing the CPU.
+ */
+class PlanningThreadPool
+{
+public:
+  using Task = std::function<void()>;
+
+  /** \brief Constructor
+   * \param [in] thread_count Number of worker threads. If 0, std::thread::hardware_concurrency() workers are started
+   */
+  PlanningThreadPool(std::size_t thread_count = 0);
+
+  /** \brief Destructor, runs all queued tasks and joins the worker threads */
+  ~PlanningThreadPool();
+
+  PlanningThreadPool(const PlanningThreadPool&) = delete;
+  PlanningThreadPool& operator=(const PlanningThreadPool&) = delete;
+
+  /** \brief Queue a task for execution on one of the workers
+   * \param [in] task Task to execute, must not throw
+   */
+  void submit(Task task);
+
+  /** \brief Get the number of worker threads */
+  std::size_t getThreadCount() const
+  {
+    return workers_.size();
+  }
+
+private:
+  struct TaskQueue
+  {
+    std::deque<Task> tasks;
+    std::mutex mutex;
+  };
+
+  void runWorker(std::size_t index);
+
+  /** \brief Take a task from the own queue or steal one from another worker */
+  bool popTask(std::size_t index, Task& task);
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_condition_;
+  std::size_t pending_tasks_;
+  std::size_t next_queue_;
+  bool stop_;
+};
+}  // namespace planning_pipeline_interfaces
+}  // namespace moveit
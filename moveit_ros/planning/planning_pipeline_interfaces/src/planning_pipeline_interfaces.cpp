@@ -35,7 +35,12 @@
 /* Author: Sebastian Jahr */
 
 #include <moveit/planning_pipeline_interfaces/planning_pipeline_interfaces.hpp>
+#include <moveit/planning_pipeline_interfaces/solution_selection_functions.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <thread>
 
 namespace moveit
@@ -70,49 +75,68 @@ const std::vector<::planning_interface::MotionPlanResponse> planWithParallelPipe
     const ::planning_scene::PlanningSceneConstPtr& planning_scene,
     const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>& planning_pipelines,
     const StoppingCriterionFunction& stopping_criterion_callback,
-    const SolutionSelectionFunction& solution_selection_function)
+    const SolutionSelectionFunction& solution_selection_function, const PlanningThreadPoolPtr& thread_pool)
 {
   // Create solutions container
   PlanResponsesContainer plan_responses_container{ motion_plan_requests.size() };
-  std::vector<std::thread> planning_threads;
-  planning_threads.reserve(motion_plan_requests.size());
 
-  // Print a warning if more parallel planning problems than available concurrent threads are defined. If
-  // std::thread::hardware_concurrency() is not defined, the command returns 0 so the check does not work
-  const auto hardware_concurrency = std::thread::hardware_concurrency();
-  if (motion_plan_requests.size() > hardware_concurrency && hardware_concurrency != 0)
+  // Without a persistent pool, a temporary one is created that does not oversubscribe the hardware. If
+  // std::thread::hardware_concurrency() is not defined, the command returns 0 and one thread per request is used
+  PlanningThreadPoolPtr pool = thread_pool;
+  if (!pool)
   {
-    RCLCPP_WARN(LOGGER,
-                "More parallel planning problems defined ('%ld') than possible to solve concurrently with the "
-                "hardware ('%d')",
-                motion_plan_requests.size(), hardware_concurrency);
+    const std::size_t hardware_concurrency = std::thread::hardware_concurrency();
+    pool = std::make_shared<PlanningThreadPool>(hardware_concurrency == 0 ?
+                                                    motion_plan_requests.size() :
+                                                    std::min(motion_plan_requests.size(), hardware_concurrency));
   }
+  if (motion_plan_requests.size() > pool->getThreadCount())
+  {
+    RCLCPP_DEBUG(LOGGER, "Queuing %ld parallel planning problems on %ld planning threads", motion_plan_requests.size(),
+                 pool->getThreadCount());
+  }
+
+  // Set once the stopping criterion is met, so requests that did not start yet are skipped
+  std::atomic<bool> stop_planning{ false };
 
-  // Launch planning threads
+  // Number of requests that are not finished yet, the caller blocks until this reaches zero
+  std::size_t remaining_requests = motion_plan_requests.size();
+  std::mutex remaining_requests_mutex;
+  std::condition_variable requests_done_condition;
+
+  // Queue planning tasks
   for (const auto& request : motion_plan_requests)
   {
-    auto planning_thread = std::thread([&]() {
+    pool->submit([&]() {
       auto plan_solution = ::planning_interface::MotionPlanResponse();
-      try
+      if (stop_planning)
       {
-        // Use planning scene if provided, otherwise the planning scene from planning scene monitor is used
-        plan_solution = planWithSinglePipeline(request, planning_scene, planning_pipelines);
+        plan_solution.error_code = moveit::core::MoveItErrorCode::PREEMPTED;
       }
-      catch (const std::exception& e)
+      else
       {
-        RCLCPP_ERROR(LOGGER, "Planning pipeline '%s' threw exception '%s'", request.pipeline_id.c_str(), e.what());
-        plan_solution = ::planning_interface::MotionPlanResponse();
-        plan_solution.error_code = moveit::core::MoveItErrorCode::FAILURE;
+        try
+        {
+          // Use planning scene if provided, otherwise the planning scene from planning scene monitor is used
+          plan_solution = planWithSinglePipeline(request, planning_scene, planning_pipelines);
+        }
+        catch (const std::exception& e)
+        {
+          RCLCPP_ERROR(LOGGER, "Planning pipeline '%s' threw exception '%s'", request.pipeline_id.c_str(), e.what());
+          plan_solution = ::planning_interface::MotionPlanResponse();
+          plan_solution.error_code = moveit::core::MoveItErrorCode::FAILURE;
+        }
       }
       plan_solution.planner_id = request.planner_id;
       plan_responses_container.pushBack(plan_solution);
 
-      if (stopping_criterion_callback != nullptr)
+      if (stopping_criterion_callback != nullptr && !stop_planning)
       {
         if (stopping_criterion_callback(plan_responses_container, motion_plan_requests))
         {
           // Terminate planning pipelines
           RCLCPP_INFO(LOGGER, "Stopping criterion met: Terminating planning pipelines that are still active");
+          stop_planning = true;
           for (const auto& request : motion_plan_requests)
           {
             try
@@ -131,17 +155,19 @@ const std::vector<::planning_interface::MotionPlanResponse> planWithParallelPipe
           }
         }
       }
+
+      std::lock_guard<std::mutex> lock(remaining_requests_mutex);
+      if (--remaining_requests == 0)
+      {
+        requests_done_condition.notify_all();
+      }
     });
-    planning_threads.push_back(std::move(planning_thread));
   }
 
-  // Wait for threads to finish
-  for (auto& planning_thread : planning_threads)
+  // Wait for all requests to finish
   {
-    if (planning_thread.joinable())
-    {
-      planning_thread.join();
-    }
+    std::unique_lock<std::mutex> lock(remaining_requests_mutex);
+    requests_done_condition.wait(lock, [&remaining_requests] { return remaining_requests == 0; });
   }
 
   // If a solution selection function is provided, it is used to compute the return value
@@ -157,6 +183,70 @@ const std::vector<::planning_interface::MotionPlanResponse> planWithParallelPipe
   return plan_responses_container.getSolutions();
 }
 
+::planning_interface::MotionPlanResponse
+planAnytime(const std::vector<::planning_interface::MotionPlanRequest>& motion_plan_requests,
+            const ::planning_scene::PlanningSceneConstPtr& planning_scene,
+            const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>& planning_pipelines,
+            const SolutionCallbackFunction& solution_callback,
+            const SolutionSelectionFunction& solution_selection_function,
+            const StoppingCriterionFunction& stopping_criterion_callback, const PlanningThreadPoolPtr& thread_pool)
+{
+  const SolutionSelectionFunction select_solution =
+      solution_selection_function ? solution_selection_function : &getShortestSolution;
+
+  double time_budget = 0.0;
+  for (const auto& request : motion_plan_requests)
+  {
+    time_budget = std::max(time_budget, request.allowed_planning_time);
+  }
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(time_budget);
+
+  ::planning_interface::MotionPlanResponse best_solution;
+  best_solution.error_code = moveit::core::MoveItErrorCode::FAILURE;
+  std::vector<::planning_interface::MotionPlanRequest> round_requests = motion_plan_requests;
+  for (std::size_t round = 1;; ++round)
+  {
+    const double remaining_time = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+    if (round > 1 && remaining_time <= 0.0)
+    {
+      break;
+    }
+
+    // Later rounds only get the time that is left
+    for (std::size_t i = 0; i < round_requests.size(); ++i)
+    {
+      round_requests[i].allowed_planning_time =
+          std::min(motion_plan_requests[i].allowed_planning_time, std::max(remaining_time, 0.0));
+    }
+    const auto solutions = planWithParallelPipelines(round_requests, planning_scene, planning_pipelines,
+                                                     stopping_criterion_callback, nullptr, thread_pool);
+
+    // The best solution so far goes first, so it is kept if a new one is not better
+    std::vector<::planning_interface::MotionPlanResponse> candidates;
+    candidates.reserve(solutions.size() + 1);
+    candidates.push_back(best_solution);
+    candidates.insert(candidates.end(), solutions.begin(), solutions.end());
+    ::planning_interface::MotionPlanResponse selected_solution = select_solution(candidates);
+
+    if (selected_solution && selected_solution.trajectory != best_solution.trajectory)
+    {
+      best_solution = std::move(selected_solution);
+      RCLCPP_INFO(LOGGER, "Anytime planning found an improved solution in round %zu", round);
+      if (solution_callback && solution_callback(best_solution))
+      {
+        RCLCPP_INFO(LOGGER, "Solution accepted: Stopping anytime planning");
+        break;
+      }
+    }
+    else if (!best_solution)
+    {
+      // Keep the error of the latest failure
+      best_solution = std::move(selected_solution);
+    }
+  }
+  return best_solution;
+}
+
 std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>
 createPlanningPipelineMap(const std::vector<std::string>& pipeline_names,
                           const moveit::core::RobotModelConstPtr& robot_model, const rclcpp::Node::SharedPtr& node,
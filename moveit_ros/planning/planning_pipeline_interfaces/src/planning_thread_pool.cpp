@@ -0,0 +1,154 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/planning_pipeline_interfaces/planning_thread_pool.hpp>
+#include <moveit/utils/thread_placement.h>
+
+#include <algorithm>
+
+namespace moveit
+{
+namespace planning_pipeline_interfaces
+{
+namespace
+{
+// Index of the pool worker running on this thread, used to keep nested submissions local
+thread_local const PlanningThreadPool* current_pool = nullptr;
+thread_local std::size_t current_worker_index = 0;
+}  // namespace
+
+PlanningThreadPool::PlanningThreadPool(std::size_t thread_count) : pending_tasks_(0), next_queue_(0), stop_(false)
+{
+  if (thread_count == 0)
+  {
+    // std::thread::hardware_concurrency() may return 0 if the value is not computable
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  queues_.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i)
+    queues_.push_back(std::make_unique<TaskQueue>());
+
+  workers_.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i)
+    workers_.emplace_back([this, i] { runWorker(i); });
+}
+
+PlanningThreadPool::~PlanningThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stop_ = true;
+  }
+  wake_condition_.notify_all();
+  for (std::thread& worker : workers_)
+  {
+    if (worker.joinable())
+      worker.join();
+  }
+}
+
+void PlanningThreadPool::submit(Task task)
+{
+  {
+    // The task is queued and counted atomically with respect to the workers, so pending_tasks_ never underflows
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    std::size_t index = current_worker_index;
+    if (current_pool != this)
+    {
+      index = next_queue_;
+      next_queue_ = (next_queue_ + 1) % queues_.size();
+    }
+
+    std::lock_guard<std::mutex> queue_lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(task));
+    ++pending_tasks_;
+  }
+  wake_condition_.notify_one();
+}
+
+bool PlanningThreadPool::popTask(std::size_t index, Task& task)
+{
+  // Own tasks are processed in submission order, stolen tasks are taken from the back of the victim's queue
+  for (std::size_t i = 0; i < queues_.size(); ++i)
+  {
+    TaskQueue& queue = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      continue;
+
+    if (i == 0)
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    else
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    return true;
+  }
+  return false;
+}
+
+void PlanningThreadPool::runWorker(std::size_t index)
+{
+  moveit::core::configureCurrentThread(moveit::core::thread_roles::PLANNING, "moveit_plan_" + std::to_string(index));
+  current_pool = this;
+  current_worker_index = index;
+
+  Task task;
+  while (true)
+  {
+    if (popTask(index, task))
+    {
+      {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        --pending_tasks_;
+      }
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_condition_.wait(lock, [this] { return stop_ || pending_tasks_ > 0; });
+    if (stop_ && pending_tasks_ == 0)
+      return;
+  }
+}
+}  // namespace planning_pipeline_interfaces
+}  // namespace moveit
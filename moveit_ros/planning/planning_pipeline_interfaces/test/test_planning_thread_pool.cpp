@@ -0,0 +1,99 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+#include <moveit/planning_pipeline_interfaces/planning_thread_pool.hpp>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+
+using moveit::planning_pipeline_interfaces::PlanningThreadPool;
+
+TEST(PlanningThreadPool, RunsAllTasks)
+{
+  constexpr int NUM_TASKS = 100;
+  std::atomic<int> executed{ 0 };
+  {
+    PlanningThreadPool pool(4);
+    EXPECT_EQ(pool.getThreadCount(), 4u);
+    for (int i = 0; i < NUM_TASKS; ++i)
+      pool.submit([&executed] { ++executed; });
+  }  // the destructor drains all queued tasks
+  EXPECT_EQ(executed, NUM_TASKS);
+}
+
+TEST(PlanningThreadPool, DefaultThreadCount)
+{
+  PlanningThreadPool pool;
+  EXPECT_GE(pool.getThreadCount(), 1u);
+}
+
+TEST(PlanningThreadPool, IdleWorkersStealQueuedTasks)
+{
+  PlanningThreadPool pool(2);
+
+  // Block one worker, the tasks queued behind it must still be picked up by the other one
+  std::promise<void> release_blocker;
+  std::shared_future<void> blocker = release_blocker.get_future().share();
+  pool.submit([blocker] { blocker.wait(); });
+
+  std::promise<void> done;
+  std::atomic<int> executed{ 0 };
+  constexpr int NUM_TASKS = 10;
+  for (int i = 0; i < NUM_TASKS; ++i)
+  {
+    pool.submit([&] {
+      if (++executed == NUM_TASKS)
+        done.set_value();
+    });
+  }
+  EXPECT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  release_blocker.set_value();
+}
+
+TEST(PlanningThreadPool, NestedSubmission)
+{
+  PlanningThreadPool pool(2);
+  std::promise<void> done;
+  pool.submit([&pool, &done] { pool.submit([&done] { done.set_value(); }); });
+  EXPECT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -51,6 +51,15 @@
 
 #include <default_plan_request_adapter_parameters.hpp>
 
+#include <Eigen/Dense>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <thread>
+
 namespace default_planner_request_adapters
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_ros.fix_start_state_collision");
@@ -103,7 +112,6 @@ public:
       }
 
       auto prefix_state = std::make_shared<moveit::core::RobotState>(start_state);
-      random_numbers::RandomNumberGenerator& rng = prefix_state->getRandomNumberGenerator();
 
       const std::vector<const moveit::core::JointModel*>& jmodels =
           planning_scene->getRobotModel()->hasJointModelGroup(req.group_name) ?
@@ -113,28 +121,37 @@ public:
       bool found = false;
       const auto params = param_listener_->get_params();
 
-      for (int c = 0; !found && c < params.max_sampling_attempts; ++c)
+      // a state found for the same start state before is likely still valid, which saves sampling
+      const std::vector<double> start_positions(start_state.getVariablePositions(),
+                                                start_state.getVariablePositions() + start_state.getVariableCount());
+      std::vector<double> cached_positions;
+      if (findFixedStartState(req.group_name, start_positions, cached_positions))
       {
-        for (std::size_t i = 0; !found && i < jmodels.size(); ++i)
-        {
-          std::vector<double> sampled_variable_values(jmodels[i]->getVariableCount());
-          const double* original_values = prefix_state->getJointPositions(jmodels[i]);
-          jmodels[i]->getVariableRandomPositionsNearBy(rng, &sampled_variable_values[0], original_values,
-                                                       jmodels[i]->getMaximumExtent() * params.jiggle_fraction);
-          start_state.setJointPositions(jmodels[i], sampled_variable_values);
-          collision_detection::CollisionResult cres;
-          planning_scene->checkCollision(creq, cres, start_state);
-          if (!cres.collision)
-          {
-            found = true;
-            RCLCPP_INFO(LOGGER, "Found a valid state near the start state at distance %lf after %d attempts",
-                        prefix_state->distance(start_state), c);
-          }
-        }
+        start_state.setVariablePositions(cached_positions);
+        collision_detection::CollisionResult cached_cres;
+        planning_scene->checkCollision(creq, cached_cres, start_state);
+        found = !cached_cres.collision;
+        if (found)
+          RCLCPP_INFO(LOGGER, "Reusing the valid state found near this start state before");
+        else
+          start_state.setVariablePositions(start_positions);
       }
+      const bool sampled = !found;
+
+      if (!found && params.push_out_of_collision)
+      {
+        found = pushOutOfCollision(*planning_scene, creq, req.group_name, params.push_out_iterations, start_state);
+        if (!found)
+          start_state.setVariablePositions(start_positions);
+      }
+      if (!found)
+        found = sampleNearbyState(*planning_scene, creq, jmodels, *prefix_state, params, start_state);
 
       if (found)
       {
+        if (sampled)
+          storeFixedStartState(req.group_name, start_positions, start_state);
+
         planning_interface::MotionPlanRequest req2 = req;
         moveit::core::robotStateToRobotStateMsg(start_state, req2.start_state);
         bool solved = planner(planning_scene, req2, res);
@@ -180,7 +197,208 @@ public:
   }
 
 private:
+  /** \brief Move \e state out of collision along the contact normals, stepping the joints of the chain group
+   * \e group_name by the pseudo-inverse of the Jacobians of the links in contact. Converges in a few steps for the
+   * slight contacts robots typically start in, e.g. after grasping. */
+  static bool pushOutOfCollision(const planning_scene::PlanningScene& scene,
+                                 const collision_detection::CollisionRequest& creq, const std::string& group_name,
+                                 int iterations, moveit::core::RobotState& state)
+  {
+    if (!scene.getRobotModel()->hasJointModelGroup(group_name))
+      return false;
+    const moveit::core::JointModelGroup* jmg = scene.getRobotModel()->getJointModelGroup(group_name);
+    if (!jmg->isChain())
+      return false;
+
+    collision_detection::CollisionRequest contact_req = creq;
+    contact_req.contacts = true;
+    contact_req.max_contacts = MAX_PUSH_CONTACTS;
+    contact_req.max_contacts_per_pair = 1;
+
+    // the Jacobians are expressed in the frame of the group root
+    const moveit::core::LinkModel* root_link = jmg->getJointModels().front()->getParentLinkModel();
+    Eigen::VectorXd positions;
+    for (int i = 0; i < iterations; ++i)
+    {
+      collision_detection::CollisionResult cres;
+      scene.checkCollision(contact_req, cres, state);
+      if (!cres.collision)
+      {
+        RCLCPP_INFO(LOGGER, "Moved the start state out of collision in %d steps", i);
+        return true;
+      }
+
+      const Eigen::Matrix3d world_to_root =
+          root_link ? Eigen::Matrix3d(state.getGlobalLinkTransform(root_link).linear().transpose()) :
+                      Eigen::Matrix3d::Identity();
+      Eigen::VectorXd step = Eigen::VectorXd::Zero(jmg->getVariableCount());
+      for (const auto& contact_pair : cres.contacts)
+      {
+        for (const collision_detection::Contact& contact : contact_pair.second)
+        {
+          // contact normals point from the first body to the second one, so each body is moved away from the other
+          addContactStep(state, jmg, contact.body_name_1, contact.body_type_1, contact, -contact.normal,
+                         world_to_root, step);
+          addContactStep(state, jmg, contact.body_name_2, contact.body_type_2, contact, contact.normal, world_to_root,
+                         step);
+        }
+      }
+      if (step.isZero())
+        return false;
+
+      state.copyJointGroupPositions(jmg, positions);
+      state.setJointGroupPositions(jmg, positions + step);
+      state.enforceBounds(jmg);
+      state.update();
+    }
+
+    collision_detection::CollisionResult cres;
+    scene.checkCollision(creq, cres, state);
+    if (!cres.collision)
+      RCLCPP_INFO(LOGGER, "Moved the start state out of collision in %d steps", iterations);
+    return !cres.collision;
+  }
+
+  /** \brief Add to \e step the joint motion that moves the contact point on \e body_name by its penetration depth
+   * along \e direction, if the body is moved by \e jmg */
+  static void addContactStep(moveit::core::RobotState& state, const moveit::core::JointModelGroup* jmg,
+                             const std::string& body_name, collision_detection::BodyType body_type,
+                             const collision_detection::Contact& contact, const Eigen::Vector3d& direction,
+                             const Eigen::Matrix3d& world_to_root, Eigen::VectorXd& step)
+  {
+    const moveit::core::LinkModel* link = nullptr;
+    if (body_type == collision_detection::BodyTypes::ROBOT_LINK)
+    {
+      link = state.getRobotModel()->getLinkModel(body_name);
+    }
+    else if (body_type == collision_detection::BodyTypes::ROBOT_ATTACHED)
+    {
+      if (const moveit::core::AttachedBody* body = state.getAttachedBody(body_name))
+        link = body->getAttachedLink();
+    }
+    if (!link || !jmg->isLinkUpdated(link->getName()))
+      return;
+
+    Eigen::MatrixXd jacobian;
+    const Eigen::Vector3d point = state.getGlobalLinkTransform(link).inverse() * contact.pos;
+    if (!state.getJacobian(jmg, link, point, jacobian))
+      return;
+    const Eigen::Vector3d displacement = world_to_root * direction * (std::abs(contact.depth) + PUSH_MARGIN);
+    step += jacobian.topRows<3>().completeOrthogonalDecomposition().solve(displacement);
+  }
+
+  /** \brief Randomly perturb the joints \e jmodels of \e original until a valid state is found and store it in
+   * \e state. With several sampling threads, the attempts are split between them and the first valid state wins. */
+  static bool sampleNearbyState(const planning_scene::PlanningScene& scene,
+                                const collision_detection::CollisionRequest& creq,
+                                const std::vector<const moveit::core::JointModel*>& jmodels,
+                                moveit::core::RobotState& original,
+                                const default_plan_request_adapter_parameters::Params& params,
+                                moveit::core::RobotState& state)
+  {
+    const int attempts = static_cast<int>(params.max_sampling_attempts);
+    const int thread_count = std::max(1, std::min(static_cast<int>(params.sampling_threads), attempts));
+    std::atomic<bool> found{ false };
+
+    const auto sample = [&](int first_attempt, int last_attempt, random_numbers::RandomNumberGenerator& rng,
+                            moveit::core::RobotState& sampled_state) {
+      for (int c = first_attempt; !found && c < last_attempt; ++c)
+      {
+        for (std::size_t i = 0; !found && i < jmodels.size(); ++i)
+        {
+          std::vector<double> sampled_variable_values(jmodels[i]->getVariableCount());
+          const double* original_values = original.getJointPositions(jmodels[i]);
+          jmodels[i]->getVariableRandomPositionsNearBy(rng, &sampled_variable_values[0], original_values,
+                                                       jmodels[i]->getMaximumExtent() * params.jiggle_fraction);
+          sampled_state.setJointPositions(jmodels[i], sampled_variable_values);
+          collision_detection::CollisionResult cres;
+          scene.checkCollision(creq, cres, sampled_state);
+          // only the first thread to find a valid state writes the result
+          if (!cres.collision && !found.exchange(true))
+          {
+            RCLCPP_INFO(LOGGER, "Found a valid state near the start state at distance %lf after %d attempts",
+                        original.distance(sampled_state), c);
+            if (&sampled_state != &state)
+              state = sampled_state;
+          }
+        }
+      }
+    };
+
+    random_numbers::RandomNumberGenerator& rng = original.getRandomNumberGenerator();
+    if (thread_count == 1)
+    {
+      sample(0, attempts, rng, state);
+      return found;
+    }
+
+    // the states are copied before any thread may write the result to state
+    std::vector<moveit::core::RobotState> sampled_states(thread_count, state);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t)
+    {
+      const int first_attempt = attempts * t / thread_count;
+      const int last_attempt = attempts * (t + 1) / thread_count;
+      const auto seed = static_cast<std::uint32_t>(rng.uniformInteger(0, std::numeric_limits<int>::max()));
+      threads.emplace_back([&, t, first_attempt, last_attempt, seed] {
+        random_numbers::RandomNumberGenerator thread_rng(seed);
+        sample(first_attempt, last_attempt, thread_rng, sampled_states[t]);
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+    return found;
+  }
+
+  /** \brief A start state in collision and the valid state that was found near it */
+  struct FixedStartState
+  {
+    std::string group_name;
+    std::vector<double> start_positions;
+    std::vector<double> fixed_positions;
+  };
+
+  bool findFixedStartState(const std::string& group_name, const std::vector<double>& start_positions,
+                           std::vector<double>& fixed_positions) const
+  {
+    std::lock_guard<std::mutex> lock(fixed_start_states_lock_);
+    for (auto it = fixed_start_states_.begin(); it != fixed_start_states_.end(); ++it)
+    {
+      if (it->group_name == group_name && it->start_positions == start_positions)
+      {
+        fixed_positions = it->fixed_positions;
+        fixed_start_states_.splice(fixed_start_states_.begin(), fixed_start_states_, it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void storeFixedStartState(const std::string& group_name, const std::vector<double>& start_positions,
+                            const moveit::core::RobotState& fixed_state) const
+  {
+    std::lock_guard<std::mutex> lock(fixed_start_states_lock_);
+    fixed_start_states_.remove_if([&](const FixedStartState& entry) {
+      return entry.group_name == group_name && entry.start_positions == start_positions;
+    });
+    fixed_start_states_.push_front(
+        { group_name, start_positions,
+          std::vector<double>(fixed_state.getVariablePositions(),
+                              fixed_state.getVariablePositions() + fixed_state.getVariableCount()) });
+    if (fixed_start_states_.size() > MAX_FIXED_START_STATES)
+      fixed_start_states_.pop_back();
+  }
+
+  static constexpr std::size_t MAX_FIXED_START_STATES = 16;
+  static constexpr std::size_t MAX_PUSH_CONTACTS = 32;
+  // distance beyond the penetration depth the contacts are pushed, so the next step starts out of contact
+  static constexpr double PUSH_MARGIN = 1e-3;
+
   std::unique_ptr<default_plan_request_adapter_parameters::ParamListener> param_listener_;
+
+  // most recently used first; entries are validated against the scene before they are used
+  mutable std::list<FixedStartState> fixed_start_states_;
+  mutable std::mutex fixed_start_states_lock_;
 };
 }  // namespace default_planner_request_adapters
 
@@ -0,0 +1,101 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, PickNik Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of PickNik Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+
+/* Desc: An adapter that removes redundant waypoints from the time parameterized trajectory and optionally resamples it
+ * at a fixed time step first. It has to run after a time parameterization adapter.
+ */
+
+#include <moveit/planning_request_adapter/planning_request_adapter.h>
+#include <moveit/trajectory_processing/trajectory_tools.h>
+#include <class_loader/class_loader.hpp>
+
+#include <default_plan_request_adapter_parameters.hpp>
+
+namespace default_planner_request_adapters
+{
+using namespace trajectory_processing;
+
+static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_ros.simplify_trajectory");
+
+/** @brief Removes the waypoints of the solution that the interpolation between their neighbors reproduces */
+class SimplifyTrajectory : public planning_request_adapter::PlanningRequestAdapter
+{
+public:
+  void initialize(const rclcpp::Node::SharedPtr& node, const std::string& parameter_namespace) override
+  {
+    param_listener_ =
+        std::make_unique<default_plan_request_adapter_parameters::ParamListener>(node, parameter_namespace);
+  }
+
+  std::string getDescription() const override
+  {
+    return "Simplify Trajectory";
+  }
+
+  bool adaptAndPlan(const PlannerFn& planner, const planning_scene::PlanningSceneConstPtr& planning_scene,
+                    const planning_interface::MotionPlanRequest& req,
+                    planning_interface::MotionPlanResponse& res) const override
+  {
+    bool result = planner(planning_scene, req, res);
+    if (result && res.trajectory)
+    {
+      RCLCPP_DEBUG(LOGGER, " Running '%s'", getDescription().c_str());
+      const auto params = param_listener_->get_params();
+      if (params.simplify_resample_dt > 0.0 && !resampleTrajectory(*res.trajectory, params.simplify_resample_dt))
+      {
+        RCLCPP_WARN(LOGGER, " Resampling the solution path failed.");
+        result = false;
+      }
+      else
+      {
+        const std::size_t waypoint_count = res.trajectory->getWayPointCount();
+        const std::size_t removed =
+            simplifyTrajectory(*res.trajectory, params.simplify_position_tolerance,
+                               params.simplify_velocity_tolerance, params.simplify_max_waypoint_duration);
+        RCLCPP_DEBUG(LOGGER, " Removed %zu of %zu waypoints", removed, waypoint_count);
+      }
+    }
+
+    return result;
+  }
+
+protected:
+  std::unique_ptr<default_plan_request_adapter_parameters::ParamListener> param_listener_;
+};
+
+}  // namespace default_planner_request_adapters
+
+CLASS_LOADER_REGISTER_CLASS(default_planner_request_adapters::SimplifyTrajectory,
+                            planning_request_adapter::PlanningRequestAdapter)
@@ -36,7 +36,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <condition_variable>
@@ -250,6 +252,8 @@ public:
   }
 
   /** @brief Get the current state
+   *  The getters of the current state never wait for an update in progress: updates publish the joint values with a
+   *  sequence lock, and readers retry the copy if an update happened meanwhile.
    *  @return Returns the current state */
   moveit::core::RobotStatePtr getCurrentState() const;
 
@@ -326,11 +330,39 @@ private:
   void updateMultiDofJoints();
   void transformCallback(const tf2_msgs::msg::TFMessage::ConstSharedPtr& msg, const bool is_static);
 
+  /** @brief Values of the published state, as copied by readState() */
+  struct StateValues
+  {
+    std::vector<double> positions, velocities, efforts;
+    bool has_velocities = false;
+    bool has_efforts = false;
+    std::int64_t time_ns = 0;
+  };
+
+  /** @brief Publish the values of robot_state_ and current_state_time_ to the readers. Requires state_update_lock_ */
+  void publishState();
+
+  /** @brief Copy the latest published values to \e values, without locking */
+  void readState(StateValues& values) const;
+
+  /** @brief Set \e state to the values of the published state */
+  void applyState(const StateValues& values, moveit::core::RobotState& state) const;
+
   std::unique_ptr<MiddlewareHandle> middleware_handle_;
   std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
   moveit::core::RobotModelConstPtr robot_model_;
   moveit::core::RobotState robot_state_;
-  std::map<const moveit::core::JointModel*, rclcpp::Time> joint_time_;
+
+  /** @brief Time of the last update of each joint in nanoseconds, indexed by joint index. Negative if never updated */
+  std::vector<std::atomic<std::int64_t>> joint_time_;
+
+  /** @brief The published state: positions, velocities and efforts of all variables. The sequence is odd while an
+   *  update is in progress */
+  std::atomic<std::uint64_t> published_sequence_{ 0 };
+  std::unique_ptr<std::atomic<double>[]> published_values_;
+  std::atomic<bool> published_has_velocities_{ false };
+  std::atomic<bool> published_has_efforts_{ false };
+  std::atomic<std::int64_t> published_time_ns_{ 0 };
   bool state_monitor_started_;
   bool copy_dynamics_;  // Copy velocity and effort from joint_state
   rclcpp::Time monitor_start_time_ = rclcpp::Time(0, 0, RCL_ROS_TIME);
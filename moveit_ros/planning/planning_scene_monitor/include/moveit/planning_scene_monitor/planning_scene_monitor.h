@@ -45,7 +45,14 @@
 #include <moveit/occupancy_map_monitor/occupancy_map_monitor.h>
 #include <moveit/planning_scene_monitor/current_state_monitor.h>
 #include <moveit/collision_plugin_loader/collision_plugin_loader.h>
+#include <moveit/utils/metrics.h>
+#include <moveit/utils/shared_snapshot.h>
 #include <moveit_msgs/srv/get_planning_scene.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <thread>
 #include <shared_mutex>
@@ -116,6 +123,9 @@ public:
   /// name, so the topic is prefixed by the node name)
   static const std::string MONITORED_PLANNING_SCENE_TOPIC;  // "monitored_planning_scene"
 
+  /// The name of the shared memory segment used by default for sharing the monitored planning scene between processes
+  static const std::string DEFAULT_SHARED_SCENE_NAME;  // "planning_scene"
+
   /** @brief Constructor
    *  @param robot_description The name of the ROS parameter that contains the URDF (in string format)
    *  @param name A name identifying this planning scene monitor
@@ -266,6 +276,17 @@ public:
     return publish_planning_scene_frequency_;
   }
 
+  /** \brief Set the maximum frequency at which octomap changes are included in published planning scene diffs.
+      Octomap changes in between are held back and sent with a later diff. Full scenes always contain the octomap.
+      0 (the default) publishes the octomap with every diff it changed in. */
+  void setOctomapPublishingFrequency(double hz);
+
+  /** \brief Get the maximum frequency at which octomap changes are published (Hz), 0 if they are not limited */
+  double getOctomapPublishingFrequency() const
+  {
+    return publish_octomap_frequency_;
+  }
+
   /** @brief Get the stored instance of the stored current state monitor
    *  @return An instance of the stored current state monitor*/
   const CurrentStateMonitorPtr& getStateMonitor() const
@@ -319,6 +340,26 @@ public:
     }
   }
 
+  /** @brief Read the robot state from the state monitor instead of writing it into the scene.
+   *
+   * When enabled, joint state updates no longer lock the scene for writing. The current state of the monitored scene
+   * then only changes on scene messages, attached objects and explicit calls to updateSceneWithCurrentState(), while
+   * getSceneSnapshot() and setToCurrentState() overlay the latest joint values received by the state monitor at the
+   * time they are called. This is meant for high-rate readers like servoing or execution monitoring, which need the
+   * freshest state without the write-lock churn of a high state update frequency. Disabling the mode brings the
+   * scene up to date again. */
+  void setLiveRobotState(bool enabled);
+
+  bool getLiveRobotState() const
+  {
+    return live_robot_state_;
+  }
+
+  /** @brief Set the joint values of \e state to the latest ones received by the state monitor, and update its
+   * transforms. This does not lock the scene. Attached bodies of \e state are kept.
+   *  @return False if no state monitor is running */
+  bool setToCurrentState(moveit::core::RobotState& state) const;
+
   /** @brief Start the scene monitor (ROS topic-based)
    *  @param scene_topic The name of the planning scene topic
    */
@@ -345,6 +386,34 @@ public:
   /** @brief Stop the scene monitor*/
   void stopSceneMonitor();
 
+  /** @brief Share the monitored scene with monitors in other processes on this machine, see startSharedSceneMonitor().
+   *         After each update, the full scene including the octomap is written to shared memory as a new version, so
+   *         the other processes do not need to subscribe to the scene topics or process sensor data themselves.
+   *  @param name The name of the shared memory segment, there must be only one publishing monitor per name
+   *  @param max_hz The maximum rate at which versions are written
+   */
+  void startSharedScenePublisher(const std::string& name = DEFAULT_SHARED_SCENE_NAME, double max_hz = 10.0);
+
+  /** @brief Stop sharing the monitored scene */
+  void stopSharedScenePublisher();
+
+  /** @brief Keep the scene up to date with the scene shared by startSharedScenePublisher() in another process.
+   *         Each new version replaces the whole scene, so this should not be combined with the other monitors that
+   *         modify the scene. The shared memory is polled, and the publishing process may be started later.
+   *  @param name The name of the shared memory segment
+   *  @param poll_hz The rate at which the shared memory is checked for a new version
+   */
+  void startSharedSceneMonitor(const std::string& name = DEFAULT_SHARED_SCENE_NAME, double poll_hz = 100.0);
+
+  /** @brief Stop following the shared scene */
+  void stopSharedSceneMonitor();
+
+  /** @brief The version of the shared scene last applied by the shared scene monitor, 0 if none was */
+  std::uint64_t getSharedSceneVersion() const
+  {
+    return shared_scene_version_;
+  }
+
   /** @brief Start the OccupancyMapMonitor and listening for:
    *     - Requests to add/remove/update collision objects to/from the world
    *     - The collision map
@@ -380,6 +449,77 @@ public:
   /** @brief This function is called every time there is a change to the planning scene */
   void triggerSceneUpdateEvent(SceneUpdateType update_type);
 
+  /** @brief Statistics about the snapshots handed out by getSceneSnapshot() */
+  struct SceneSnapshotStatistics
+  {
+    /** @brief Number of snapshots built since the monitor was created */
+    std::size_t published_snapshots = 0;
+    /** @brief Number of snapshots that are still referenced by readers */
+    std::size_t live_snapshots = 0;
+    /** @brief Time between the first scene update not reflected by the previous snapshot and the publication of the
+     * latest snapshot */
+    std::chrono::nanoseconds last_publication_latency{ 0 };
+    /** @brief Time it took to copy the scene for the latest snapshot */
+    std::chrono::nanoseconds last_build_duration{ 0 };
+  };
+
+  /** @brief Get an immutable copy of the monitored planning scene.
+   *
+   * Unlike LockedPlanningSceneRO, the returned scene can be used without holding any lock, so long-running readers
+   * like planners do not block scene updates. A new snapshot is built on the first call after the scene changed, all
+   * other calls return the same instance. The octomap is deep-copied into the snapshot, so it is not affected by
+   * later sensor updates either.
+   *
+   * With setLiveRobotState() enabled, the returned scene is a diff of the cached snapshot whose current state holds
+   * the latest joint values of the state monitor.
+   */
+  planning_scene::PlanningSceneConstPtr getSceneSnapshot();
+
+  /** @brief Get statistics about the snapshots returned by getSceneSnapshot() */
+  SceneSnapshotStatistics getSceneSnapshotStatistics();
+
+  /** @brief Counters the monitor updates as it runs, for runtime monitoring */
+  struct Metrics
+  {
+    /** @brief Number of scene update events */
+    moveit::metrics::Counter scene_updates;
+    /** @brief Time spent waiting in lockSceneRead() and lockSceneWrite() */
+    moveit::metrics::LatencyHistogram lock_wait;
+    /** @brief The part of lock_wait spent waiting for the octree lock of the octomap monitor */
+    moveit::metrics::LatencyHistogram octree_lock_wait;
+    /** @brief Time it took to apply octomap updates to the scene, including waiting for the scene lock */
+    moveit::metrics::LatencyHistogram octomap_update;
+  };
+
+  const Metrics& getMetrics() const
+  {
+    return metrics_;
+  }
+
+  /** @brief Wait and hold times of the scene lock recorded for one caller tag */
+  struct LockStatistics
+  {
+    moveit::metrics::LatencyHistogram read_wait;
+    moveit::metrics::LatencyHistogram read_hold;
+    moveit::metrics::LatencyHistogram write_wait;
+    moveit::metrics::LatencyHistogram write_hold;
+  };
+
+  struct LockStatisticsSnapshot
+  {
+    moveit::metrics::LatencyHistogram::Snapshot read_wait;
+    moveit::metrics::LatencyHistogram::Snapshot read_hold;
+    moveit::metrics::LatencyHistogram::Snapshot write_wait;
+    moveit::metrics::LatencyHistogram::Snapshot write_hold;
+  };
+
+  /** @brief Get the wait and hold times of the scene lock, by caller tag.
+   *
+   * LockedPlanningSceneRO and LockedPlanningSceneRW record under the tag passed on construction, the monitor records
+   * its own scene updates under tags naming the update source, e.g. "octomap_update" or "robot_state_update".
+   */
+  std::map<std::string, LockStatisticsSnapshot> getLockStatistics();
+
   /** \brief Wait for robot state to become more recent than time t.
    *
    * If there is no state monitor active, there will be no scene updates.
@@ -412,6 +552,10 @@ protected:
    */
   void unlockSceneWrite();
 
+  /** \brief Get the lock statistics recorded for \e tag, creating them on first use. The returned reference is valid
+   * for the lifetime of the monitor. */
+  LockStatistics& getLockStatistics(const std::string& tag);
+
   /** @brief Configure the collision matrix for a particular scene */
   void configureCollisionMatrix(const planning_scene::PlanningScenePtr& scene);
 
@@ -453,6 +597,10 @@ protected:
   bool getShapeTransformCache(const std::string& target_frame, const rclcpp::Time& target_time,
                               occupancy_map_monitor::ShapeTransformCache& cache) const;
 
+  /// Return \e snapshot, or a diff of it holding the latest monitored state if live_robot_state_ is set
+  planning_scene::PlanningSceneConstPtr
+  overlayLiveRobotState(const planning_scene::PlanningSceneConstPtr& snapshot) const;
+
   /// The name of this scene monitor
   std::string monitor_name_;
 
@@ -460,8 +608,21 @@ protected:
   planning_scene::PlanningSceneConstPtr scene_const_;
   planning_scene::PlanningScenePtr parent_scene_;  /// if diffs are monitored, this is the pointer to the parent scene
   std::shared_mutex scene_update_mutex_;           /// mutex for stored scene
+
+  // Immutable scene copies handed out by getSceneSnapshot()
+  std::mutex scene_snapshot_mutex_;  /// guards all snapshot members below
+  planning_scene::PlanningSceneConstPtr scene_snapshot_;
+  std::size_t scene_snapshot_generation_;
+  std::vector<std::weak_ptr<const planning_scene::PlanningScene>> published_scene_snapshots_;
+  SceneSnapshotStatistics scene_snapshot_statistics_;
+  Metrics metrics_;
+  std::mutex lock_statistics_mutex_;  /// guards the map, not the histograms in it
+  std::map<std::string, LockStatistics> lock_statistics_;
+  std::atomic<std::size_t> scene_generation_;  /// incremented with every scene update event
+  std::atomic<std::chrono::steady_clock::rep> first_unpublished_update_time_;  /// 0 if the snapshot is up to date
   rclcpp::Time last_update_time_;                  /// Last time the state was updated
   rclcpp::Time last_robot_motion_time_;            /// Last time the robot has moved
+  std::atomic<bool> live_robot_state_{ false };    /// see setLiveRobotState()
 
   std::shared_ptr<rclcpp::Node> node_;
 
@@ -494,10 +655,27 @@ protected:
   rclcpp::Publisher<moveit_msgs::msg::PlanningScene>::SharedPtr planning_scene_publisher_;
   std::unique_ptr<std::thread> publish_planning_scene_;
   double publish_planning_scene_frequency_;
+  double publish_octomap_frequency_;
+  // whether an octomap change was held back from the published diffs, and when the octomap was last published. Only
+  // accessed by the publishing thread
+  bool octomap_publish_pending_;
+  std::chrono::steady_clock::time_point last_octomap_publish_time_;
   SceneUpdateType publish_update_types_;
   std::atomic<SceneUpdateType> new_scene_update_;
   std::condition_variable_any new_scene_update_condition_;
 
+  // variables for sharing the scene with other processes
+  std::unique_ptr<moveit::core::SharedSnapshotWriter> shared_scene_writer_;
+  std::thread shared_scene_publisher_;
+  std::mutex shared_scene_lock_;
+  std::condition_variable shared_scene_condition_;
+  bool shared_scene_update_pending_ = false;  // guarded by shared_scene_lock_
+  bool shared_scene_publishing_ = false;      // guarded by shared_scene_lock_
+  std::unique_ptr<moveit::core::SharedSnapshotReader> shared_scene_reader_;
+  rclcpp::TimerBase::SharedPtr shared_scene_timer_;
+  std::vector<char> shared_scene_buffer_;
+  std::atomic<std::uint64_t> shared_scene_version_{ 0 };
+
   // subscribe to various sources of data
   rclcpp::Subscription<moveit_msgs::msg::PlanningScene>::SharedPtr planning_scene_subscriber_;
   rclcpp::Subscription<moveit_msgs::msg::PlanningSceneWorld>::SharedPtr planning_scene_world_subscriber_;
@@ -509,6 +687,13 @@ protected:
   // this is used by MoveGroup and related application nodes
   rclcpp::Service<moveit_msgs::srv::GetPlanningScene>::SharedPtr get_scene_service_;
 
+  // serialized world components returned by get_scene_service_, reused while the scene reports the same version.
+  // Guarded by scene_update_mutex_
+  std::vector<moveit_msgs::msg::CollisionObject> cached_collision_objects_;
+  std::size_t cached_collision_objects_version_ = 0;
+  octomap_msgs::msg::OctomapWithPose cached_octomap_;
+  std::size_t cached_octomap_version_ = 0;
+
   // include a octomap monitor
   std::unique_ptr<occupancy_map_monitor::OccupancyMapMonitor> octomap_monitor_;
 
@@ -539,6 +724,12 @@ private:
   // publish planning scene update diffs (runs in its own thread)
   void scenePublishingThread();
 
+  // write the scene to shared memory after updates (runs in its own thread)
+  void sharedScenePublishingThread(double max_hz);
+
+  // called by shared_scene_timer_ to apply a new version of the shared scene
+  void sharedSceneTimerCallback();
+
   // called by current_state_monitor_ when robot state (as monitored on joint state topic) changes
   void onStateUpdate(const sensor_msgs::msg::JointState::ConstSharedPtr& joint_state);
 
@@ -618,10 +809,13 @@ private:
 class LockedPlanningSceneRO
 {
 public:
-  LockedPlanningSceneRO(const PlanningSceneMonitorPtr& planning_scene_monitor)
+  /** \brief Lock the scene of \e planning_scene_monitor for reading. The time spent waiting for and holding the lock
+   * is recorded under \e tag, see PlanningSceneMonitor::getLockStatistics(). */
+  LockedPlanningSceneRO(const PlanningSceneMonitorPtr& planning_scene_monitor,
+                        const std::string& tag = "LockedPlanningSceneRO")
     : planning_scene_monitor_(planning_scene_monitor)
   {
-    initialize(true);
+    initialize(true, tag);
   }
 
   const PlanningSceneMonitorPtr& getPlanningSceneMonitor()
@@ -645,16 +839,16 @@ public:
   }
 
 protected:
-  LockedPlanningSceneRO(const PlanningSceneMonitorPtr& planning_scene_monitor, bool read_only)
+  LockedPlanningSceneRO(const PlanningSceneMonitorPtr& planning_scene_monitor, bool read_only, const std::string& tag)
     : planning_scene_monitor_(planning_scene_monitor)
   {
-    initialize(read_only);
+    initialize(read_only, tag);
   }
 
-  void initialize(bool read_only)
+  void initialize(bool read_only, const std::string& tag)
   {
     if (planning_scene_monitor_)
-      lock_ = std::make_shared<SingleUnlock>(planning_scene_monitor_.get(), read_only);
+      lock_ = std::make_shared<SingleUnlock>(planning_scene_monitor_.get(), read_only, tag);
   }
 
   MOVEIT_STRUCT_FORWARD(SingleUnlock);
@@ -663,9 +857,12 @@ protected:
   // even if the LockedPlanningScene instance is copied around
   struct SingleUnlock
   {
-    SingleUnlock(PlanningSceneMonitor* planning_scene_monitor, bool read_only)
-      : planning_scene_monitor_(planning_scene_monitor), read_only_(read_only)
+    SingleUnlock(PlanningSceneMonitor* planning_scene_monitor, bool read_only, const std::string& tag)
+      : planning_scene_monitor_(planning_scene_monitor)
+      , read_only_(read_only)
+      , statistics_(planning_scene_monitor->getLockStatistics(tag))
     {
+      const auto start = std::chrono::steady_clock::now();
       if (read_only)
       {
         planning_scene_monitor_->lockSceneRead();
@@ -674,6 +871,8 @@ protected:
       {
         planning_scene_monitor_->lockSceneWrite();
       }
+      acquired_ = std::chrono::steady_clock::now();
+      (read_only_ ? statistics_.read_wait : statistics_.write_wait).record(acquired_ - start);
     }
     ~SingleUnlock()
     {
@@ -685,9 +884,13 @@ protected:
       {
         planning_scene_monitor_->unlockSceneWrite();
       }
+      moveit::metrics::LatencyHistogram& hold = read_only_ ? statistics_.read_hold : statistics_.write_hold;
+      hold.record(std::chrono::steady_clock::now() - acquired_);
     }
     PlanningSceneMonitor* planning_scene_monitor_;
     bool read_only_;
+    PlanningSceneMonitor::LockStatistics& statistics_;
+    std::chrono::steady_clock::time_point acquired_;
   };
 
   PlanningSceneMonitorPtr planning_scene_monitor_;
@@ -718,8 +921,11 @@ protected:
 class LockedPlanningSceneRW : public LockedPlanningSceneRO
 {
 public:
-  LockedPlanningSceneRW(const PlanningSceneMonitorPtr& planning_scene_monitor)
-    : LockedPlanningSceneRO(planning_scene_monitor, false)
+  /** \brief Lock the scene of \e planning_scene_monitor for writing. The time spent waiting for and holding the lock
+   * is recorded under \e tag, see PlanningSceneMonitor::getLockStatistics(). */
+  LockedPlanningSceneRW(const PlanningSceneMonitorPtr& planning_scene_monitor,
+                        const std::string& tag = "LockedPlanningSceneRW")
+    : LockedPlanningSceneRO(planning_scene_monitor, false, tag)
   {
   }
 
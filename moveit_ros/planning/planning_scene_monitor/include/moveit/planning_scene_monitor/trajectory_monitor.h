@@ -52,7 +52,10 @@ using TrajectoryStateAddedCallback = std::function<void(const moveit::core::Robo
 MOVEIT_CLASS_FORWARD(TrajectoryMonitor);  // Defines TrajectoryMonitorPtr, ConstPtr, WeakPtr... etc
 
 /** @class TrajectoryMonitor
-    @brief Monitors the joint_states topic and tf to record the trajectory of the robot. */
+    @brief Monitors the joint_states topic and tf to record the trajectory of the robot.
+
+    The trajectory is either sampled at the sampling frequency by a thread, or recorded from every update of the state
+    monitor into a ring buffer of bounded size, see startRingBufferRecording(). */
 class TrajectoryMonitor
 {
 public:
@@ -125,9 +128,38 @@ public:
     state_add_callback_ = callback;
   }
 
+  /** @brief Record the positions of every update of \e state_monitor into a ring buffer of the last \e capacity states
+   *
+   *  The states are written by an update callback of the state monitor, so no thread polls the state, and the memory
+   *  is allocated once. Writing never waits for readers of the buffer. The state add callback is not called for
+   *  these states. The update callback cannot be removed from the state monitor: calling this again with another
+   *  capacity replaces the buffer and leaves the previous callback without effect.
+   *  @param[in]  state_monitor The state monitor of this trajectory monitor
+   *  @param[in]  capacity The number of states kept
+   */
+  void startRingBufferRecording(const CurrentStateMonitorPtr& state_monitor, std::size_t capacity);
+
+  /** @brief Pause recording into the ring buffer, the recorded states are kept */
+  void stopRingBufferRecording();
+
+  bool isRingBufferRecording() const;
+
+  /** @brief Drop the states recorded in the ring buffer */
+  void clearRingBuffer();
+
+  /** @brief Replace the content of \e trajectory by the states recorded in the ring buffer, oldest first
+   *
+   *  Safe to call while recording. States that are overwritten during the export are left out.
+   *  @return False if ring buffer recording was never started
+   */
+  bool getRingBufferTrajectory(robot_trajectory::RobotTrajectory& trajectory) const;
+
 private:
   void recordStates();
 
+  /** @brief The compact states recorded by startRingBufferRecording() */
+  struct StateRingBuffer;
+
   // Samples robot states.
   CurrentStateMonitorConstPtr current_state_monitor_;
   // Interface for communicating with ROS.
@@ -140,5 +172,8 @@ private:
 
   std::unique_ptr<std::thread> record_states_thread_;
   TrajectoryStateAddedCallback state_add_callback_;
+
+  // shared with the update callback of the state monitor, which may outlive this monitor
+  std::shared_ptr<StateRingBuffer> ring_buffer_;
 };
 }  // namespace planning_scene_monitor
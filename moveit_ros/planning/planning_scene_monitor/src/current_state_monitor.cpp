@@ -40,9 +40,11 @@
 #include <tf2_eigen/tf2_eigen.hpp>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #include <memory>
+#include <thread>
 
 namespace planning_scene_monitor
 {
@@ -51,7 +53,10 @@ using namespace std::chrono_literals;
 namespace
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_ros.current_state_monitor");
-}
+
+// value of joint_time_ for joints that were never updated
+constexpr std::int64_t NEVER_UPDATED = -1;
+}  // namespace
 
 CurrentStateMonitor::CurrentStateMonitor(std::unique_ptr<CurrentStateMonitor::MiddlewareHandle> middleware_handle,
                                          const moveit::core::RobotModelConstPtr& robot_model,
@@ -60,12 +65,17 @@ CurrentStateMonitor::CurrentStateMonitor(std::unique_ptr<CurrentStateMonitor::Mi
   , tf_buffer_(tf_buffer)
   , robot_model_(robot_model)
   , robot_state_(robot_model)
+  , joint_time_(robot_model->getJointModelCount())
   , state_monitor_started_(false)
   , copy_dynamics_(false)
   , error_(std::numeric_limits<double>::epsilon())
   , use_sim_time_(use_sim_time)
 {
   robot_state_.setToDefaultValues();
+  for (std::atomic<std::int64_t>& time : joint_time_)
+    time.store(NEVER_UPDATED, std::memory_order_relaxed);
+  published_values_.reset(new std::atomic<double>[3 * robot_model_->getVariableCount()]());
+  publishState();
 }
 
 CurrentStateMonitor::CurrentStateMonitor(const rclcpp::Node::SharedPtr& node,
@@ -81,59 +91,114 @@ CurrentStateMonitor::~CurrentStateMonitor()
   stopStateMonitor();
 }
 
+void CurrentStateMonitor::publishState()
+{
+  const std::size_t n = robot_model_->getVariableCount();
+  const double* positions = robot_state_.getVariablePositions();
+  const double* velocities = robot_state_.hasVelocities() ? robot_state_.getVariableVelocities() : nullptr;
+  const double* efforts = robot_state_.hasEffort() ? robot_state_.getVariableEffort() : nullptr;
+
+  // sequence lock: readers retry while the sequence is odd or if it changed during their copy
+  const std::uint64_t sequence = published_sequence_.load(std::memory_order_relaxed);
+  published_sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    published_values_[i].store(positions[i], std::memory_order_relaxed);
+    if (velocities)
+      published_values_[n + i].store(velocities[i], std::memory_order_relaxed);
+    if (efforts)
+      published_values_[2 * n + i].store(efforts[i], std::memory_order_relaxed);
+  }
+  published_has_velocities_.store(velocities != nullptr, std::memory_order_relaxed);
+  published_has_efforts_.store(efforts != nullptr, std::memory_order_relaxed);
+  published_time_ns_.store(current_state_time_.nanoseconds(), std::memory_order_relaxed);
+  published_sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void CurrentStateMonitor::readState(StateValues& values) const
+{
+  const std::size_t n = robot_model_->getVariableCount();
+  values.positions.resize(n);
+  values.velocities.resize(n);
+  values.efforts.resize(n);
+  while (true)
+  {
+    const std::uint64_t sequence = published_sequence_.load(std::memory_order_acquire);
+    if (sequence & 1)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    values.has_velocities = published_has_velocities_.load(std::memory_order_relaxed);
+    values.has_efforts = published_has_efforts_.load(std::memory_order_relaxed);
+    values.time_ns = published_time_ns_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      values.positions[i] = published_values_[i].load(std::memory_order_relaxed);
+      values.velocities[i] = published_values_[n + i].load(std::memory_order_relaxed);
+      values.efforts[i] = published_values_[2 * n + i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (published_sequence_.load(std::memory_order_relaxed) == sequence)
+      return;
+  }
+}
+
+void CurrentStateMonitor::applyState(const StateValues& values, moveit::core::RobotState& state) const
+{
+  state.setVariablePositions(values.positions);
+  if (values.has_velocities)
+    state.setVariableVelocities(values.velocities);
+  if (values.has_efforts)
+    state.setVariableEffort(values.efforts);
+}
+
 moveit::core::RobotStatePtr CurrentStateMonitor::getCurrentState() const
 {
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  moveit::core::RobotState* result = new moveit::core::RobotState(robot_state_);
-  return moveit::core::RobotStatePtr(result);
+  StateValues values;
+  readState(values);
+  auto result = std::make_shared<moveit::core::RobotState>(robot_model_);
+  applyState(values, *result);
+  return result;
 }
 
 rclcpp::Time CurrentStateMonitor::getCurrentStateTime() const
 {
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  return current_state_time_;
+  return rclcpp::Time(published_time_ns_.load(std::memory_order_acquire), RCL_ROS_TIME);
 }
 
 std::pair<moveit::core::RobotStatePtr, rclcpp::Time> CurrentStateMonitor::getCurrentStateAndTime() const
 {
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  moveit::core::RobotState* result = new moveit::core::RobotState(robot_state_);
-  return std::make_pair(moveit::core::RobotStatePtr(result), current_state_time_);
+  StateValues values;
+  readState(values);
+  auto result = std::make_shared<moveit::core::RobotState>(robot_model_);
+  applyState(values, *result);
+  return std::make_pair(result, rclcpp::Time(values.time_ns, RCL_ROS_TIME));
 }
 
 std::map<std::string, double> CurrentStateMonitor::getCurrentStateValues() const
 {
+  StateValues values;
+  readState(values);
   std::map<std::string, double> m;
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  const double* pos = robot_state_.getVariablePositions();
-  const std::vector<std::string>& names = robot_state_.getVariableNames();
+  const std::vector<std::string>& names = robot_model_->getVariableNames();
   for (std::size_t i = 0; i < names.size(); ++i)
-    m[names[i]] = pos[i];
+    m[names[i]] = values.positions[i];
   return m;
 }
 
 void CurrentStateMonitor::setToCurrentState(moveit::core::RobotState& upd) const
 {
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  const double* pos = robot_state_.getVariablePositions();
-  upd.setVariablePositions(pos);
+  StateValues values;
+  readState(values);
+  upd.setVariablePositions(values.positions);
   if (copy_dynamics_)
   {
-    if (robot_state_.hasVelocities())
-    {
-      const double* vel = robot_state_.getVariableVelocities();
-      upd.setVariableVelocities(vel);
-    }
-    if (robot_state_.hasAccelerations())
-    {
-      const double* acc = robot_state_.getVariableAccelerations();
-      upd.setVariableAccelerations(acc);
-    }
-    if (robot_state_.hasEffort())
-    {
-      const double* eff = robot_state_.getVariableEffort();
-      upd.setVariableEffort(eff);
-    }
+    if (values.has_velocities)
+      upd.setVariableVelocities(values.velocities);
+    if (values.has_efforts)
+      upd.setVariableEffort(values.efforts);
   }
 }
 
@@ -152,7 +217,8 @@ void CurrentStateMonitor::startStateMonitor(const std::string& joint_states_topi
 {
   if (!state_monitor_started_ && robot_model_)
   {
-    joint_time_.clear();
+    for (std::atomic<std::int64_t>& time : joint_time_)
+      time.store(NEVER_UPDATED, std::memory_order_relaxed);
     if (joint_states_topic.empty())
     {
       RCLCPP_ERROR(LOGGER, "The joint states topic cannot be an empty string");
@@ -204,18 +270,17 @@ bool CurrentStateMonitor::haveCompleteStateHelper(const rclcpp::Time& oldest_all
                                                   std::vector<std::string>* missing_joints) const
 {
   const std::vector<const moveit::core::JointModel*>& active_joints = robot_model_->getActiveJointModels();
-  std::unique_lock<std::mutex> slock(state_update_lock_);
   for (const moveit::core::JointModel* joint : active_joints)
   {
-    std::map<const moveit::core::JointModel*, rclcpp::Time>::const_iterator it = joint_time_.find(joint);
-    if (it == joint_time_.end())
+    const std::int64_t time_ns = joint_time_[joint->getJointIndex()].load(std::memory_order_acquire);
+    if (time_ns == NEVER_UPDATED)
     {
       RCLCPP_DEBUG(LOGGER, "Joint '%s' has never been updated", joint->getName().c_str());
     }
-    else if (it->second < oldest_allowed_update_time)
+    else if (time_ns < oldest_allowed_update_time.nanoseconds())
     {
       RCLCPP_DEBUG(LOGGER, "Joint '%s' was last updated %0.3lf seconds before requested time", joint->getName().c_str(),
-                   (oldest_allowed_update_time - it->second).seconds());
+                   (oldest_allowed_update_time.nanoseconds() - time_ns) * 1e-9);
     }
     else
       continue;
@@ -282,15 +347,26 @@ bool CurrentStateMonitor::waitForCurrentState(const rclcpp::Time& t, double wait
 
 bool CurrentStateMonitor::waitForCompleteState(double wait_time_s) const
 {
-  const double sleep_step_s = std::min(0.05, wait_time_s / 10.0);
-  const auto sleep_step_duration = rclcpp::Duration::from_seconds(sleep_step_s);
-  double slept_time_s = 0.0;
-  while (!haveCompleteState() && slept_time_s < wait_time_s)
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(std::max(wait_time_s, 0.0)));
+
+  // joint times are written under state_update_lock_, so checking them with the lock held cannot miss a notification
+  std::unique_lock<std::mutex> lock(state_update_lock_);
+  while (!haveCompleteState())
   {
-    middleware_handle_->sleepFor(sleep_step_duration.to_chrono<std::chrono::nanoseconds>());
-    slept_time_s += sleep_step_s;
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline)
+      return false;
+    // wake up periodically to notice a shutdown, which sends no notification
+    state_update_condition_.wait_until(lock, std::min(deadline, now + std::chrono::steady_clock::duration(100ms)));
+    if (!middleware_handle_->ok())
+    {
+      RCLCPP_DEBUG(LOGGER, "ROS context shut down while waiting for complete robot state.");
+      return haveCompleteState();
+    }
   }
-  return haveCompleteState();
+  return true;
 }
 
 bool CurrentStateMonitor::waitForCompleteState(const std::string& group, double wait_time_s) const
@@ -342,6 +418,7 @@ void CurrentStateMonitor::jointStateCallback(const sensor_msgs::msg::JointState:
     // read the received values, and update their time stamps
     std::size_t n = joint_state->name.size();
     current_state_time_ = joint_state->header.stamp;
+    const std::int64_t stamp_ns = current_state_time_.nanoseconds();
     for (std::size_t i = 0; i < n; ++i)
     {
       // Skip joints that don't belong to the RobotModel
@@ -355,7 +432,7 @@ void CurrentStateMonitor::jointStateCallback(const sensor_msgs::msg::JointState:
       if (jm->getVariableCount() != 1)
         continue;
 
-      joint_time_.insert_or_assign(jm, joint_state->header.stamp);
+      joint_time_[jm->getJointIndex()].store(stamp_ns, std::memory_order_release);
 
       if (robot_state_.getJointPositions(jm)[0] != joint_state->position[i])
       {
@@ -404,6 +481,7 @@ void CurrentStateMonitor::jointStateCallback(const sensor_msgs::msg::JointState:
         }
       }
     }
+    publishState();
   }
 
   // callbacks, if needed
@@ -449,13 +527,12 @@ void CurrentStateMonitor::updateMultiDofJoints()
         continue;
       }
 
-      if (auto joint_time_it = joint_time_.find(joint); joint_time_it == joint_time_.end())
-        joint_time_.emplace(joint, rclcpp::Time(0, 0, RCL_ROS_TIME));
-
       // allow update if time is more recent or if it is a static transform (time = 0)
-      if (latest_common_time <= joint_time_[joint] && latest_common_time > rclcpp::Time(0, 0, RCL_ROS_TIME))
+      std::atomic<std::int64_t>& joint_time = joint_time_[joint->getJointIndex()];
+      const std::int64_t latest_common_time_ns = latest_common_time.nanoseconds();
+      if (latest_common_time_ns <= joint_time.load(std::memory_order_relaxed) && latest_common_time_ns > 0)
         continue;
-      joint_time_[joint] = latest_common_time;
+      joint_time.store(latest_common_time_ns, std::memory_order_release);
 
       std::vector<double> new_values(joint->getStateSpaceDimension());
       const moveit::core::LinkModel* link = joint->getChildLinkModel();
@@ -477,6 +554,8 @@ void CurrentStateMonitor::updateMultiDofJoints()
       robot_state_.setJointPositions(joint, new_values.data());
       update = true;
     }
+    if (update)
+      publishState();
   }
 
   // callbacks, if needed
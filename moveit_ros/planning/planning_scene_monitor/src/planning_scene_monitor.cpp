@@ -46,17 +46,47 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 
 #include <fmt/format.h>
+#include <algorithm>
 #include <memory>
 
 #include <std_msgs/msg/string.hpp>
 
 #include <chrono>
+#include <rclcpp/serialization.hpp>
 using namespace std::chrono_literals;
 
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_ros.planning_scene_monitor.planning_scene_monitor");
 
 namespace planning_scene_monitor
 {
+namespace
+{
+// Exclusive lock on the scene mutex that records its wait and hold times
+class TimedSceneUpdateLock
+{
+public:
+  TimedSceneUpdateLock(std::shared_mutex& mutex, PlanningSceneMonitor::LockStatistics& statistics)
+    : statistics_(statistics)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    lock_ = std::unique_lock<std::shared_mutex>(mutex);
+    acquired_ = std::chrono::steady_clock::now();
+    statistics_.write_wait.record(acquired_ - start);
+  }
+
+  ~TimedSceneUpdateLock()
+  {
+    lock_.unlock();
+    statistics_.write_hold.record(std::chrono::steady_clock::now() - acquired_);
+  }
+
+private:
+  std::unique_lock<std::shared_mutex> lock_;
+  PlanningSceneMonitor::LockStatistics& statistics_;
+  std::chrono::steady_clock::time_point acquired_;
+};
+}  // namespace
+
 const std::string PlanningSceneMonitor::DEFAULT_JOINT_STATES_TOPIC = "joint_states";
 const std::string PlanningSceneMonitor::DEFAULT_ATTACHED_COLLISION_OBJECT_TOPIC = "attached_collision_object";
 const std::string PlanningSceneMonitor::DEFAULT_COLLISION_OBJECT_TOPIC = "collision_object";
@@ -64,6 +94,7 @@ const std::string PlanningSceneMonitor::DEFAULT_PLANNING_SCENE_WORLD_TOPIC = "pl
 const std::string PlanningSceneMonitor::DEFAULT_PLANNING_SCENE_TOPIC = "planning_scene";
 const std::string PlanningSceneMonitor::DEFAULT_PLANNING_SCENE_SERVICE = "get_planning_scene";
 const std::string PlanningSceneMonitor::MONITORED_PLANNING_SCENE_TOPIC = "monitored_planning_scene";
+const std::string PlanningSceneMonitor::DEFAULT_SHARED_SCENE_NAME = "planning_scene";
 
 PlanningSceneMonitor::PlanningSceneMonitor(const rclcpp::Node::SharedPtr& node, const std::string& robot_description,
                                            const std::string& name)
@@ -91,6 +122,9 @@ PlanningSceneMonitor::PlanningSceneMonitor(const rclcpp::Node::SharedPtr& node,
                                            const robot_model_loader::RobotModelLoaderPtr& rm_loader,
                                            const std::string& name)
   : monitor_name_(name)
+  , scene_snapshot_generation_(0)
+  , scene_generation_(0)
+  , first_unpublished_update_time_(0)
   , node_(node)
   , private_executor_(std::make_shared<rclcpp::executors::SingleThreadedExecutor>())
   , tf_buffer_(std::make_shared<tf2_ros::Buffer>(node->get_clock()))
@@ -129,6 +163,8 @@ PlanningSceneMonitor::~PlanningSceneMonitor()
   stopStateMonitor();
   stopWorldGeometryMonitor();
   stopSceneMonitor();
+  stopSharedScenePublisher();
+  stopSharedSceneMonitor();
 
   private_executor_->cancel();
   if (private_executor_thread_.joinable())
@@ -198,6 +234,8 @@ void PlanningSceneMonitor::initialize(const planning_scene::PlanningScenePtr& sc
   }
 
   publish_planning_scene_frequency_ = 2.0;
+  publish_octomap_frequency_ = 0.0;
+  octomap_publish_pending_ = false;
   new_scene_update_ = UPDATE_NONE;
 
   last_update_time_ = last_robot_motion_time_ = rclcpp::Clock().now();
@@ -273,6 +311,9 @@ void PlanningSceneMonitor::initialize(const planning_scene::PlanningScenePtr& sc
                           "Set the maximum frequency at which planning scene updates are published");
     updatePublishSettings(publish_geometry_updates, publish_state_updates, publish_transform_updates,
                           publish_planning_scene, publish_planning_scene_hz);
+    setOctomapPublishingFrequency(declare_parameter(
+        "publish_octomap_hz", 0.0,
+        "Set the maximum frequency at which octomap changes are included in planning scene updates, 0 for no limit"));
   }
   catch (const rclcpp::exceptions::InvalidParameterTypeException& e)
   {
@@ -336,6 +377,10 @@ void PlanningSceneMonitor::initialize(const planning_scene::PlanningScenePtr& sc
       {
         publish_planning_scene_hz = parameter.as_double();
       }
+      else if (name == "planning_scene_monitor.publish_octomap_hz")
+      {
+        setOctomapPublishingFrequency(parameter.as_double());
+      }
     }
 
     if (result.successful)
@@ -429,6 +474,11 @@ void PlanningSceneMonitor::scenePublishingThread()
 {
   RCLCPP_DEBUG(LOGGER, "Started scene publishing thread ...");
 
+  const auto next_octomap_publish_time = [this] {
+    return last_octomap_publish_time_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                            std::chrono::duration<double>(1.0 / publish_octomap_frequency_));
+  };
+
   // publish the full planning scene once
   {
     moveit_msgs::msg::PlanningScene msg;
@@ -439,6 +489,8 @@ void PlanningSceneMonitor::scenePublishingThread()
       scene_->getPlanningSceneMsg(msg);
     }
     planning_scene_publisher_->publish(msg);
+    octomap_publish_pending_ = false;
+    last_octomap_publish_time_ = std::chrono::steady_clock::now();
     RCLCPP_DEBUG(LOGGER, "Published the full planning scene: '%s'", msg.name.c_str());
   }
 
@@ -448,10 +500,25 @@ void PlanningSceneMonitor::scenePublishingThread()
     bool publish_msg = false;
     bool is_full = false;
     rclcpp::Rate rate(publish_planning_scene_frequency_);
+    std::chrono::steady_clock::time_point publish_start;
     {
       std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
       while (new_scene_update_ == UPDATE_NONE && publish_planning_scene_)
-        new_scene_update_condition_.wait(ulock);
+      {
+        if (!octomap_publish_pending_ || publish_octomap_frequency_ <= 0.0)
+        {
+          new_scene_update_condition_.wait(ulock);
+        }
+        else if (new_scene_update_condition_.wait_until(ulock, next_octomap_publish_time()) == std::cv_status::timeout)
+        {
+          // send the octomap change that was held back, even if nothing else changed since
+          if (publish_update_types_ & UPDATE_GEOMETRY)
+            new_scene_update_ = UPDATE_GEOMETRY;
+          else
+            octomap_publish_pending_ = false;
+        }
+      }
+      publish_start = std::chrono::steady_clock::now();
       if (new_scene_update_ != UPDATE_NONE)
       {
         if ((publish_update_types_ & new_scene_update_) || new_scene_update_ == UPDATE_SCENE)
@@ -471,6 +538,20 @@ void PlanningSceneMonitor::scenePublishingThread()
               msg.robot_state.attached_collision_objects.clear();
               msg.robot_state.is_diff = true;
             }
+            if (publish_octomap_frequency_ > 0.0)
+            {
+              // the octomap is usually the largest part of a diff, so its changes are published at a lower rate
+              const bool octomap_due = publish_start >= next_octomap_publish_time();
+              if (!msg.world.octomap.octomap.data.empty() && !octomap_due)
+              {
+                msg.world.octomap = octomap_msgs::msg::OctomapWithPose();
+                octomap_publish_pending_ = true;
+              }
+              else if (octomap_publish_pending_ && octomap_due && msg.world.octomap.octomap.data.empty())
+              {
+                scene_->getOctomapMsg(msg.world.octomap);
+              }
+            }
           }
           std::scoped_lock prevent_shape_cache_updates(shape_handles_lock_);  // we don't want the
                                                                               // transform cache to
@@ -499,6 +580,11 @@ void PlanningSceneMonitor::scenePublishingThread()
               lock = octomap_monitor_->getOcTreePtr()->reading();
             scene_->getPlanningSceneMsg(msg);
           }
+          if (!msg.world.octomap.octomap.data.empty())
+          {
+            octomap_publish_pending_ = false;
+            last_octomap_publish_time_ = publish_start;
+          }
           // also publish timestamp of this robot_state
           msg.robot_state.joint_state.header.stamp = last_robot_motion_time_;
           publish_msg = true;
@@ -511,7 +597,12 @@ void PlanningSceneMonitor::scenePublishingThread()
       planning_scene_publisher_->publish(msg);
       if (is_full)
         RCLCPP_DEBUG(LOGGER, "Published full planning scene: '%s'", msg.name.c_str());
+      const std::chrono::steady_clock::duration publish_duration = std::chrono::steady_clock::now() - publish_start;
       rate.sleep();
+      // When building and sending a message takes up most of the period, e.g. because publish() blocks on slow
+      // subscribers, pause for as long as publishing took. Updates received in the meantime are coalesced.
+      if (publish_duration * 2 > rate.period())
+        std::this_thread::sleep_for(publish_duration);
     }
   } while (publish_planning_scene_);
 }
@@ -563,6 +654,8 @@ bool PlanningSceneMonitor::updatesScene(const planning_scene::PlanningSceneConst
 
 void PlanningSceneMonitor::triggerSceneUpdateEvent(SceneUpdateType update_type)
 {
+  metrics_.scene_updates.increment();
+
   // do not modify update functions while we are calling them
   std::scoped_lock lock(update_lock_);
 
@@ -570,6 +663,113 @@ void PlanningSceneMonitor::triggerSceneUpdateEvent(SceneUpdateType update_type)
     update_callback(update_type);
   new_scene_update_ = static_cast<SceneUpdateType>(static_cast<int>(new_scene_update_) | static_cast<int>(update_type));
   new_scene_update_condition_.notify_all();
+  {
+    std::scoped_lock slock(shared_scene_lock_);
+    shared_scene_update_pending_ = true;
+  }
+  shared_scene_condition_.notify_all();
+
+  // invalidate the current snapshot, remembering when the oldest unpublished update happened
+  ++scene_generation_;
+  std::chrono::steady_clock::rep no_pending_update = 0;
+  first_unpublished_update_time_.compare_exchange_strong(
+      no_pending_update, std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+planning_scene::PlanningSceneConstPtr PlanningSceneMonitor::getSceneSnapshot()
+{
+  std::scoped_lock lock(scene_snapshot_mutex_);
+
+  // read the generation before copying the scene: an update racing with the copy then triggers a rebuild next time
+  const std::size_t generation = scene_generation_;
+  if (scene_snapshot_ && scene_snapshot_generation_ == generation)
+    return overlayLiveRobotState(scene_snapshot_);
+
+  const auto build_start = std::chrono::steady_clock::now();
+  const std::chrono::steady_clock::rep first_update_time = first_unpublished_update_time_.exchange(0);
+  planning_scene::PlanningScenePtr snapshot;
+  {
+    // also locks the octree, which is shared with the octomap monitor until it is copied below
+    lockSceneRead();
+    try
+    {
+      snapshot = planning_scene::PlanningScene::clone(scene_);
+      collision_detection::CollisionEnv::ObjectConstPtr map =
+          snapshot->getWorld()->getObject(planning_scene::PlanningScene::OCTOMAP_NS);
+      if (map && map->shapes_.size() == 1 && map->shapes_[0]->type == shapes::OCTREE)
+      {
+        const auto* octree = static_cast<const shapes::OcTree*>(map->shapes_[0].get());
+        snapshot->processOctomapPtr(std::make_shared<const octomap::OcTree>(*octree->octree), map->shape_poses_[0]);
+      }
+    }
+    catch (...)
+    {
+      unlockSceneRead();
+      throw;
+    }
+    unlockSceneRead();
+  }
+  const auto published = std::chrono::steady_clock::now();
+
+  scene_snapshot_ = snapshot;
+  scene_snapshot_generation_ = generation;
+  published_scene_snapshots_.push_back(scene_snapshot_);
+
+  ++scene_snapshot_statistics_.published_snapshots;
+  scene_snapshot_statistics_.last_build_duration = published - build_start;
+  scene_snapshot_statistics_.last_publication_latency =
+      first_update_time == 0 ? published - build_start :
+                               published.time_since_epoch() - std::chrono::steady_clock::duration(first_update_time);
+  return overlayLiveRobotState(scene_snapshot_);
+}
+
+planning_scene::PlanningSceneConstPtr
+PlanningSceneMonitor::overlayLiveRobotState(const planning_scene::PlanningSceneConstPtr& snapshot) const
+{
+  if (!live_robot_state_ || !current_state_monitor_)
+    return snapshot;
+
+  // the diff shares the world of the snapshot and only copies its robot state
+  planning_scene::PlanningScenePtr live = snapshot->diff();
+  setToCurrentState(live->getCurrentStateNonConst());
+  return live;
+}
+
+void PlanningSceneMonitor::setLiveRobotState(bool enabled)
+{
+  if (live_robot_state_.exchange(enabled) == enabled)
+    return;
+  RCLCPP_INFO(LOGGER, "%s the robot state of the planning scene from the state monitor",
+              enabled ? "Reading" : "No longer reading");
+  if (!enabled && current_state_monitor_)
+  {
+    {
+      std::unique_lock<std::mutex> lock(state_pending_mutex_);
+      state_update_pending_ = false;
+      last_robot_state_update_wall_time_ = std::chrono::system_clock::now();
+    }
+    updateSceneWithCurrentState();
+  }
+}
+
+bool PlanningSceneMonitor::setToCurrentState(moveit::core::RobotState& state) const
+{
+  if (!current_state_monitor_)
+    return false;
+  current_state_monitor_->setToCurrentState(state);
+  state.update();
+  return true;
+}
+
+PlanningSceneMonitor::SceneSnapshotStatistics PlanningSceneMonitor::getSceneSnapshotStatistics()
+{
+  std::scoped_lock lock(scene_snapshot_mutex_);
+  published_scene_snapshots_.erase(
+      std::remove_if(published_scene_snapshots_.begin(), published_scene_snapshots_.end(),
+                     [](const std::weak_ptr<const planning_scene::PlanningScene>& s) { return s.expired(); }),
+      published_scene_snapshots_.end());
+  scene_snapshot_statistics_.live_snapshots = published_scene_snapshots_.size();
+  return scene_snapshot_statistics_;
 }
 
 bool PlanningSceneMonitor::requestPlanningSceneState(const std::string& service_name)
@@ -637,8 +837,39 @@ void PlanningSceneMonitor::getPlanningSceneServiceCallback(
   moveit_msgs::msg::PlanningSceneComponents all_components;
   all_components.components = UINT_MAX;  // Return all scene components if nothing is specified.
 
-  std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
-  scene_->getPlanningSceneMsg(res->scene, req->components.components ? req->components : all_components);
+  moveit_msgs::msg::PlanningSceneComponents components =
+      req->components.components ? req->components : all_components;
+  const uint32_t world_geometry =
+      components.components & moveit_msgs::msg::PlanningSceneComponents::WORLD_OBJECT_GEOMETRY;
+  const uint32_t octomap = components.components & moveit_msgs::msg::PlanningSceneComponents::OCTOMAP;
+
+  // Collision object meshes and the octomap are expensive to serialize, so they are taken from the cache unless the
+  // scene reports that they changed since they were last serialized
+  if (world_geometry)
+    components.components &= ~moveit_msgs::msg::PlanningSceneComponents::WORLD_OBJECT_NAMES;
+  components.components &= ~(world_geometry | octomap);
+
+  TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("get_planning_scene_service"));
+  scene_->getPlanningSceneMsg(res->scene, components);
+  if (world_geometry)
+  {
+    if (cached_collision_objects_version_ != scene_->getCollisionObjectsVersion())
+    {
+      scene_->getCollisionObjectMsgs(cached_collision_objects_);
+      cached_collision_objects_version_ = scene_->getCollisionObjectsVersion();
+    }
+    res->scene.world.collision_objects = cached_collision_objects_;
+  }
+  if (octomap)
+  {
+    if (cached_octomap_version_ != scene_->getOctomapVersion())
+    {
+      cached_octomap_ = octomap_msgs::msg::OctomapWithPose();
+      scene_->getOctomapMsg(cached_octomap_);
+      cached_octomap_version_ = scene_->getOctomapVersion();
+    }
+    res->scene.world.octomap = cached_octomap_;
+  }
 }
 
 void PlanningSceneMonitor::updatePublishSettings(bool publish_geom_updates, bool publish_state_updates,
@@ -679,7 +910,7 @@ void PlanningSceneMonitor::clearOctomap()
 {
   bool removed = false;
   {
-    std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+    TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("clear_octomap"));
     removed = scene_->getWorldNonConst()->removeObject(scene_->OCTOMAP_NS);
 
     if (octomap_monitor_)
@@ -708,7 +939,7 @@ bool PlanningSceneMonitor::newPlanningSceneMessage(const moveit_msgs::msg::Plann
   SceneUpdateType upd = UPDATE_SCENE;
   std::string old_scene_name;
   {
-    std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+    TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("planning_scene_message"));
     // we don't want the transform cache to update while we are potentially changing attached bodies
     std::scoped_lock prevent_shape_cache_updates(shape_handles_lock_);
 
@@ -787,7 +1018,7 @@ void PlanningSceneMonitor::newPlanningSceneWorldCallback(
   {
     updateFrameTransforms();
     {
-      std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+      TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("planning_scene_world_message"));
       last_update_time_ = rclcpp::Clock().now();
       scene_->getWorldNonConst()->clearObjects();
       scene_->processPlanningSceneWorldMsg(*world);
@@ -812,7 +1043,7 @@ void PlanningSceneMonitor::collisionObjectCallback(const moveit_msgs::msg::Colli
 
   updateFrameTransforms();
   {
-    std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+    TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("collision_object_message"));
     last_update_time_ = rclcpp::Clock().now();
     if (!scene_->processCollisionObjectMsg(*obj))
       return;
@@ -826,7 +1057,7 @@ void PlanningSceneMonitor::attachObjectCallback(const moveit_msgs::msg::Attached
   {
     updateFrameTransforms();
     {
-      std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+      TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("attached_collision_object_message"));
       last_update_time_ = rclcpp::Clock().now();
       scene_->processAttachedCollisionObjectMsg(*obj);
     }
@@ -1118,11 +1349,35 @@ bool PlanningSceneMonitor::waitForCurrentRobotState(const rclcpp::Time& t, doubl
   return success;
 }
 
+PlanningSceneMonitor::LockStatistics& PlanningSceneMonitor::getLockStatistics(const std::string& tag)
+{
+  std::scoped_lock lock(lock_statistics_mutex_);
+  return lock_statistics_[tag];
+}
+
+std::map<std::string, PlanningSceneMonitor::LockStatisticsSnapshot> PlanningSceneMonitor::getLockStatistics()
+{
+  std::map<std::string, LockStatisticsSnapshot> snapshots;
+  std::scoped_lock lock(lock_statistics_mutex_);
+  for (const auto& [tag, statistics] : lock_statistics_)
+  {
+    snapshots[tag] = { statistics.read_wait.snapshot(), statistics.read_hold.snapshot(),
+                       statistics.write_wait.snapshot(), statistics.write_hold.snapshot() };
+  }
+  return snapshots;
+}
+
 void PlanningSceneMonitor::lockSceneRead()
 {
+  const auto start = std::chrono::steady_clock::now();
   scene_update_mutex_.lock_shared();
   if (octomap_monitor_)
+  {
+    const auto octree_start = std::chrono::steady_clock::now();
     octomap_monitor_->getOcTreePtr()->lockRead();
+    metrics_.octree_lock_wait.record(std::chrono::steady_clock::now() - octree_start);
+  }
+  metrics_.lock_wait.record(std::chrono::steady_clock::now() - start);
 }
 
 void PlanningSceneMonitor::unlockSceneRead()
@@ -1134,9 +1389,15 @@ void PlanningSceneMonitor::unlockSceneRead()
 
 void PlanningSceneMonitor::lockSceneWrite()
 {
+  const auto start = std::chrono::steady_clock::now();
   scene_update_mutex_.lock();
   if (octomap_monitor_)
+  {
+    const auto octree_start = std::chrono::steady_clock::now();
     octomap_monitor_->getOcTreePtr()->lockWrite();
+    metrics_.octree_lock_wait.record(std::chrono::steady_clock::now() - octree_start);
+  }
+  metrics_.lock_wait.record(std::chrono::steady_clock::now() - start);
 }
 
 void PlanningSceneMonitor::unlockSceneWrite()
@@ -1171,6 +1432,126 @@ void PlanningSceneMonitor::stopSceneMonitor()
   }
 }
 
+void PlanningSceneMonitor::startSharedScenePublisher(const std::string& name, double max_hz)
+{
+  stopSharedScenePublisher();
+
+  shared_scene_writer_ = std::make_unique<moveit::core::SharedSnapshotWriter>(name);
+  if (!shared_scene_writer_->isValid())
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to create the shared memory for sharing the planning scene as '%s'", name.c_str());
+    shared_scene_writer_.reset();
+    return;
+  }
+  {
+    std::scoped_lock slock(shared_scene_lock_);
+    shared_scene_publishing_ = true;
+    // write the current scene right away
+    shared_scene_update_pending_ = true;
+  }
+  shared_scene_publisher_ = std::thread([this, max_hz] { sharedScenePublishingThread(max_hz); });
+  RCLCPP_INFO(LOGGER, "Sharing the planning scene as '%s'", name.c_str());
+}
+
+void PlanningSceneMonitor::stopSharedScenePublisher()
+{
+  {
+    std::scoped_lock slock(shared_scene_lock_);
+    shared_scene_publishing_ = false;
+  }
+  shared_scene_condition_.notify_all();
+  if (shared_scene_publisher_.joinable())
+  {
+    RCLCPP_INFO(LOGGER, "Stopped sharing the planning scene");
+    shared_scene_publisher_.join();
+  }
+  shared_scene_writer_.reset();
+}
+
+void PlanningSceneMonitor::sharedScenePublishingThread(double max_hz)
+{
+  const auto min_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(max_hz > 0.0 ? 1.0 / max_hz : 0.0));
+  rclcpp::Serialization<moveit_msgs::msg::PlanningScene> serialization;
+  rclcpp::SerializedMessage serialized_msg;
+  std::unique_lock<std::mutex> ulock(shared_scene_lock_);
+  while (true)
+  {
+    shared_scene_condition_.wait(ulock, [this] { return shared_scene_update_pending_ || !shared_scene_publishing_; });
+    if (!shared_scene_publishing_)
+      return;
+    shared_scene_update_pending_ = false;
+    ulock.unlock();
+
+    const auto start = std::chrono::steady_clock::now();
+    moveit_msgs::msg::PlanningScene msg;
+    {
+      std::shared_lock<std::shared_mutex> slock(scene_update_mutex_);
+      collision_detection::OccMapTree::ReadLock lock;
+      if (octomap_monitor_)
+        lock = octomap_monitor_->getOcTreePtr()->reading();
+      scene_->getPlanningSceneMsg(msg);
+    }
+    serialization.serialize_message(&msg, &serialized_msg);
+    const rcl_serialized_message_t& buffer = serialized_msg.get_rcl_serialized_message();
+    if (!shared_scene_writer_->write(buffer.buffer, buffer.buffer_length))
+      RCLCPP_ERROR(LOGGER, "Failed to write the planning scene to shared memory");
+
+    // updates arriving in the meantime are combined into the next version
+    ulock.lock();
+    shared_scene_condition_.wait_until(ulock, start + min_period, [this] { return !shared_scene_publishing_; });
+  }
+}
+
+void PlanningSceneMonitor::startSharedSceneMonitor(const std::string& name, double poll_hz)
+{
+  stopSharedSceneMonitor();
+
+  shared_scene_reader_ = std::make_unique<moveit::core::SharedSnapshotReader>(name);
+  shared_scene_timer_ = pnode_->create_wall_timer(std::chrono::duration<double>(1.0 / poll_hz),
+                                                  [this]() { return sharedSceneTimerCallback(); });
+  RCLCPP_INFO(LOGGER, "Following the planning scene shared as '%s'", name.c_str());
+}
+
+void PlanningSceneMonitor::stopSharedSceneMonitor()
+{
+  if (shared_scene_timer_)
+  {
+    RCLCPP_INFO(LOGGER, "Stopped following the shared planning scene");
+    shared_scene_timer_->cancel();
+    shared_scene_timer_.reset();
+  }
+  shared_scene_reader_.reset();
+}
+
+void PlanningSceneMonitor::sharedSceneTimerCallback()
+{
+  // only compares the version counter in shared memory unless there is a new version
+  std::uint64_t version = shared_scene_version_;
+  if (!shared_scene_reader_ || !shared_scene_reader_->read(shared_scene_buffer_, version))
+    return;
+
+  rclcpp::SerializedMessage serialized_msg(shared_scene_buffer_.size());
+  rcl_serialized_message_t& buffer = serialized_msg.get_rcl_serialized_message();
+  std::copy(shared_scene_buffer_.begin(), shared_scene_buffer_.end(), buffer.buffer);
+  buffer.buffer_length = shared_scene_buffer_.size();
+
+  moveit_msgs::msg::PlanningScene msg;
+  try
+  {
+    rclcpp::Serialization<moveit_msgs::msg::PlanningScene>().deserialize_message(&serialized_msg, &msg);
+  }
+  catch (const rclcpp::exceptions::RCLError& e)
+  {
+    RCLCPP_ERROR(LOGGER, "Failed to read version %s of the shared planning scene: %s", std::to_string(version).c_str(),
+                 e.what());
+    shared_scene_version_ = version;
+    return;
+  }
+  if (newPlanningSceneMessage(msg))
+    shared_scene_version_ = version;
+}
+
 bool PlanningSceneMonitor::getShapeTransformCache(const std::string& target_frame, const rclcpp::Time& target_time,
                                                   occupancy_map_monitor::ShapeTransformCache& cache) const
 {
@@ -1364,6 +1745,10 @@ void PlanningSceneMonitor::stopStateMonitor()
 
 void PlanningSceneMonitor::onStateUpdate(const sensor_msgs::msg::JointState::ConstSharedPtr& /*joint_state */)
 {
+  // readers overlay the state of the state monitor themselves
+  if (live_robot_state_)
+    return;
+
   const std::chrono::system_clock::time_point& n = std::chrono::system_clock::now();
   std::chrono::duration<double> dt = n - last_robot_state_update_wall_time_;
 
@@ -1423,9 +1808,10 @@ void PlanningSceneMonitor::octomapUpdateCallback()
   if (!octomap_monitor_)
     return;
 
+  const auto start = std::chrono::steady_clock::now();
   updateFrameTransforms();
   {
-    std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+    TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("octomap_update"));
     last_update_time_ = rclcpp::Clock().now();
     octomap_monitor_->getOcTreePtr()->lockRead();
     try
@@ -1439,6 +1825,7 @@ void PlanningSceneMonitor::octomapUpdateCallback()
       throw;
     }
   }
+  metrics_.octomap_update.record(std::chrono::steady_clock::now() - start);
   triggerSceneUpdateEvent(UPDATE_GEOMETRY);
 }
 
@@ -1490,7 +1877,7 @@ void PlanningSceneMonitor::updateSceneWithCurrentState()
     }
 
     {
-      std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+      TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("robot_state_update"));
       last_update_time_ = last_robot_motion_time_ = current_state_monitor_->getCurrentStateTime();
       RCLCPP_DEBUG(LOGGER, "robot state update %f", fmod(last_robot_motion_time_.seconds(), 10.));
       current_state_monitor_->setToCurrentState(scene_->getCurrentStateNonConst());
@@ -1528,6 +1915,12 @@ void PlanningSceneMonitor::setPlanningScenePublishingFrequency(double hz)
                publish_planning_scene_frequency_);
 }
 
+void PlanningSceneMonitor::setOctomapPublishingFrequency(double hz)
+{
+  publish_octomap_frequency_ = hz;
+  RCLCPP_DEBUG(LOGGER, "Maximum frequency for publishing octomap changes is now %lf Hz", publish_octomap_frequency_);
+}
+
 void PlanningSceneMonitor::getUpdatedFrameTransforms(std::vector<geometry_msgs::msg::TransformStamped>& transforms)
 {
   const std::string& target = getRobotModel()->getModelFrame();
@@ -1563,7 +1956,7 @@ void PlanningSceneMonitor::updateFrameTransforms()
     std::vector<geometry_msgs::msg::TransformStamped> transforms;
     getUpdatedFrameTransforms(transforms);
     {
-      std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+      TimedSceneUpdateLock ulock(scene_update_mutex_, getLockStatistics("transform_update"));
       scene_->getTransformsNonConst().setTransforms(transforms);
       last_update_time_ = rclcpp::Clock().now();
     }
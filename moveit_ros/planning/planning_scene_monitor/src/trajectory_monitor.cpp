@@ -37,11 +37,79 @@
 #include <moveit/planning_scene_monitor/trajectory_monitor.h>
 #include <moveit/planning_scene_monitor/trajectory_monitor_middleware_handle.hpp>
 #include <moveit/trajectory_processing/trajectory_tools.h>
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <memory>
+#include <mutex>
 
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_ros.planning_scene_monitor.trajectory_monitor");
 
+struct planning_scene_monitor::TrajectoryMonitor::StateRingBuffer
+{
+  StateRingBuffer(const moveit::core::RobotModelConstPtr& robot_model, std::size_t capacity)
+    : variable_count(robot_model->getVariableCount())
+    , capacity(capacity)
+    , positions(new std::atomic<double>[capacity * variable_count]())
+    , times_ns(new std::atomic<std::int64_t>[capacity]())
+    , sequences(new std::atomic<std::uint64_t>[capacity]())
+    , state(robot_model)
+  {
+    state.setToDefaultValues();
+  }
+
+  /** @brief Append the current state of \e state_monitor, overwriting the oldest state if the buffer is full */
+  void record(const CurrentStateMonitor& state_monitor)
+  {
+    if (!recording.load(std::memory_order_relaxed))
+      return;
+
+    // the update callbacks of the state monitor are hardly ever concurrent, the lock is not contended
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    state_monitor.setToCurrentState(state);
+    const std::int64_t time_ns = state_monitor.getCurrentStateTime().nanoseconds();
+    const double* values = state.getVariablePositions();
+    const std::uint64_t sample = sample_count.load(std::memory_order_relaxed);
+    const std::size_t slot = sample % capacity;
+
+    // sequence lock per slot: the sequence is odd while the slot is written
+    sequences[slot].store(2 * sample + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < variable_count; ++i)
+      positions[slot * variable_count + i].store(values[i], std::memory_order_relaxed);
+    times_ns[slot].store(time_ns, std::memory_order_relaxed);
+    sequences[slot].store(2 * sample + 2, std::memory_order_release);
+    sample_count.store(sample + 1, std::memory_order_release);
+  }
+
+  /** @brief Copy the positions and time of \e sample, false if it was overwritten or is being written */
+  bool read(std::uint64_t sample, std::vector<double>& values, std::int64_t& time_ns) const
+  {
+    const std::size_t slot = sample % capacity;
+    const std::uint64_t sequence = sequences[slot].load(std::memory_order_acquire);
+    if (sequence != 2 * sample + 2)
+      return false;
+    for (std::size_t i = 0; i < variable_count; ++i)
+      values[i] = positions[slot * variable_count + i].load(std::memory_order_relaxed);
+    time_ns = times_ns[slot].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return sequences[slot].load(std::memory_order_relaxed) == sequence;
+  }
+
+  const std::size_t variable_count;
+  const std::size_t capacity;
+  std::unique_ptr<std::atomic<double>[]> positions;
+  std::unique_ptr<std::atomic<std::int64_t>[]> times_ns;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> sequences;
+  // samples are numbered from the creation of the buffer, sample n is stored in slot n % capacity
+  std::atomic<std::uint64_t> sample_count{ 0 };
+  std::atomic<std::uint64_t> first_sample{ 0 };
+  std::atomic<bool> recording{ true };
+
+  std::mutex writer_mutex;
+  moveit::core::RobotState state;
+};
+
 planning_scene_monitor::TrajectoryMonitor::TrajectoryMonitor(const CurrentStateMonitorConstPtr& state_monitor,
                                                              double sampling_frequency)
   : TrajectoryMonitor(state_monitor, std::make_unique<TrajectoryMonitorMiddlewareHandle>(sampling_frequency),
@@ -142,3 +210,70 @@ void planning_scene_monitor::TrajectoryMonitor::recordStates()
       state_add_callback_(state.first, state.second);
   }
 }
+
+void planning_scene_monitor::TrajectoryMonitor::startRingBufferRecording(const CurrentStateMonitorPtr& state_monitor,
+                                                                         std::size_t capacity)
+{
+  if (!state_monitor || capacity == 0)
+  {
+    RCLCPP_ERROR(LOGGER, "Ring buffer recording needs a state monitor and a positive capacity");
+    return;
+  }
+  if (ring_buffer_ && ring_buffer_->capacity == capacity)
+  {
+    ring_buffer_->recording = true;
+    return;
+  }
+
+  ring_buffer_ = std::make_shared<StateRingBuffer>(state_monitor->getRobotModel(), capacity);
+  const std::weak_ptr<StateRingBuffer> weak_ring_buffer = ring_buffer_;
+  const CurrentStateMonitor* monitor = state_monitor.get();  // the callback is owned by the state monitor
+  state_monitor->addUpdateCallback(
+      [weak_ring_buffer, monitor](const sensor_msgs::msg::JointState::ConstSharedPtr& /* joint_state */) {
+        if (const std::shared_ptr<StateRingBuffer> ring_buffer = weak_ring_buffer.lock())
+          ring_buffer->record(*monitor);
+      });
+  RCLCPP_DEBUG(LOGGER, "Recording the last %zu states into a ring buffer", capacity);
+}
+
+void planning_scene_monitor::TrajectoryMonitor::stopRingBufferRecording()
+{
+  if (ring_buffer_)
+    ring_buffer_->recording = false;
+}
+
+bool planning_scene_monitor::TrajectoryMonitor::isRingBufferRecording() const
+{
+  return ring_buffer_ && ring_buffer_->recording;
+}
+
+void planning_scene_monitor::TrajectoryMonitor::clearRingBuffer()
+{
+  if (ring_buffer_)
+    ring_buffer_->first_sample = ring_buffer_->sample_count.load();
+}
+
+bool planning_scene_monitor::TrajectoryMonitor::getRingBufferTrajectory(
+    robot_trajectory::RobotTrajectory& trajectory) const
+{
+  trajectory.clear();
+  if (!ring_buffer_)
+    return false;
+
+  const std::uint64_t end = ring_buffer_->sample_count.load(std::memory_order_acquire);
+  const std::uint64_t begin = std::max<std::uint64_t>(ring_buffer_->first_sample.load(std::memory_order_relaxed),
+                                                      end > ring_buffer_->capacity ? end - ring_buffer_->capacity : 0);
+  moveit::core::RobotState state(current_state_monitor_->getRobotModel());
+  state.setToDefaultValues();
+  std::vector<double> values(ring_buffer_->variable_count);
+  std::int64_t time_ns = 0, previous_time_ns = 0;
+  for (std::uint64_t sample = begin; sample < end; ++sample)
+  {
+    if (!ring_buffer_->read(sample, values, time_ns))
+      continue;
+    state.setVariablePositions(values);
+    trajectory.addSuffixWayPoint(state, trajectory.empty() ? 0.0 : (time_ns - previous_time_ns) * 1e-9);
+    previous_time_ns = time_ns;
+  }
+  return true;
+}
@@ -34,9 +34,11 @@
 
 /* Author: Tyler Weaver */
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -178,13 +180,7 @@ TEST(CurrentStateMonitorTests, HaveCompleteStateConstructFalse)
 TEST(CurrentStateMonitorTests, WaitForCompleteStateWaits)
 {
   auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
-
-  auto nanoseconds_slept = std::chrono::nanoseconds(0);
-  ON_CALL(*mock_middleware_handle, sleepFor)
-      .WillByDefault(testing::Invoke([&](const std::chrono::nanoseconds& nanoseconds) {
-        nanoseconds_slept += nanoseconds;
-        return true;
-      }));
+  ON_CALL(*mock_middleware_handle, ok).WillByDefault(testing::Return(true));
 
   // GIVEN a CurrentStateMonitor
   planning_scene_monitor::CurrentStateMonitor current_state_monitor{
@@ -192,11 +188,149 @@ TEST(CurrentStateMonitorTests, WaitForCompleteStateWaits)
     std::make_shared<tf2_ros::Buffer>(std::make_shared<rclcpp::Clock>()), false
   };
 
-  // WHEN we wait for complete state for 1s
-  current_state_monitor.waitForCompleteState(1.0);
+  // WHEN we wait for complete state for 0.2s
+  const auto start = std::chrono::steady_clock::now();
+  const bool complete = current_state_monitor.waitForCompleteState(0.2);
+
+  // THEN we expect it to time out after waiting for the full duration
+  EXPECT_FALSE(complete);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+}
+
+TEST(CurrentStateMonitorTests, WaitForCompleteStateWakesOnUpdate)
+{
+  auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
+  ON_CALL(*mock_middleware_handle, ok).WillByDefault(testing::Return(true));
+  planning_scene_monitor::JointStateUpdateCallback joint_state_callback;
+  ON_CALL(*mock_middleware_handle, createJointStateSubscription)
+      .WillByDefault(testing::Invoke([&](const std::string& /*topic*/,
+                                         planning_scene_monitor::JointStateUpdateCallback callback) {
+        joint_state_callback = callback;
+      }));
+
+  // GIVEN a started CurrentStateMonitor
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  planning_scene_monitor::CurrentStateMonitor current_state_monitor{
+    std::move(mock_middleware_handle), robot_model,
+    std::make_shared<tf2_ros::Buffer>(std::make_shared<rclcpp::Clock>()), false
+  };
+  current_state_monitor.startStateMonitor();
+  ASSERT_TRUE(joint_state_callback);
+
+  auto joint_state = std::make_shared<sensor_msgs::msg::JointState>();
+  joint_state->header.stamp = rclcpp::Time(42, 0, RCL_ROS_TIME);
+  for (const moveit::core::JointModel* joint : robot_model->getActiveJointModels())
+  {
+    joint_state->name.push_back(joint->getName());
+    joint_state->position.push_back(joint->getVariableBounds()[0].min_position_);
+  }
+
+  // WHEN the complete state arrives while waiting
+  const auto start = std::chrono::steady_clock::now();
+  std::thread publisher([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    joint_state_callback(joint_state);
+  });
+  const bool complete = current_state_monitor.waitForCompleteState(10.0);
+  publisher.join();
+
+  // THEN the waiter returns right away instead of waiting for the timeout
+  EXPECT_TRUE(complete);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(CurrentStateMonitorTests, JointStateUpdatesCurrentState)
+{
+  auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
+  planning_scene_monitor::JointStateUpdateCallback joint_state_callback;
+  ON_CALL(*mock_middleware_handle, createJointStateSubscription)
+      .WillByDefault(testing::Invoke([&](const std::string& /*topic*/,
+                                         planning_scene_monitor::JointStateUpdateCallback callback) {
+        joint_state_callback = callback;
+      }));
+
+  // GIVEN a started CurrentStateMonitor
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  planning_scene_monitor::CurrentStateMonitor current_state_monitor{
+    std::move(mock_middleware_handle), robot_model,
+    std::make_shared<tf2_ros::Buffer>(std::make_shared<rclcpp::Clock>()), false
+  };
+  current_state_monitor.startStateMonitor();
+  ASSERT_TRUE(joint_state_callback);
+
+  // WHEN it receives the positions of all active joints
+  auto joint_state = std::make_shared<sensor_msgs::msg::JointState>();
+  joint_state->header.stamp = rclcpp::Time(42, 0, RCL_ROS_TIME);
+  for (const moveit::core::JointModel* joint : robot_model->getActiveJointModels())
+  {
+    joint_state->name.push_back(joint->getName());
+    joint_state->position.push_back(joint->getVariableBounds()[0].min_position_);
+  }
+  joint_state_callback(joint_state);
+
+  // THEN the state is complete, and the current state holds the received positions and time
+  EXPECT_TRUE(current_state_monitor.haveCompleteState());
+  EXPECT_FALSE(current_state_monitor.haveCompleteState(rclcpp::Time(43, 0, RCL_ROS_TIME)));
+  EXPECT_EQ(current_state_monitor.getCurrentStateTime().nanoseconds(), rclcpp::Time(42, 0).nanoseconds());
+  const moveit::core::RobotStatePtr state = current_state_monitor.getCurrentState();
+  const std::map<std::string, double> values = current_state_monitor.getCurrentStateValues();
+  for (std::size_t i = 0; i < joint_state->name.size(); ++i)
+  {
+    EXPECT_EQ(state->getVariablePosition(joint_state->name[i]), joint_state->position[i]);
+    EXPECT_EQ(values.at(joint_state->name[i]), joint_state->position[i]);
+  }
+}
+
+TEST(CurrentStateMonitorTests, ReadersSeeConsistentStates)
+{
+  auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
+  planning_scene_monitor::JointStateUpdateCallback joint_state_callback;
+  ON_CALL(*mock_middleware_handle, createJointStateSubscription)
+      .WillByDefault(testing::Invoke([&](const std::string& /*topic*/,
+                                         planning_scene_monitor::JointStateUpdateCallback callback) {
+        joint_state_callback = callback;
+      }));
+
+  // GIVEN a started CurrentStateMonitor
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  planning_scene_monitor::CurrentStateMonitor current_state_monitor{
+    std::move(mock_middleware_handle), robot_model,
+    std::make_shared<tf2_ros::Buffer>(std::make_shared<rclcpp::Clock>()), false
+  };
+  current_state_monitor.startStateMonitor();
+  ASSERT_TRUE(joint_state_callback);
+
+  auto joint_state = std::make_shared<sensor_msgs::msg::JointState>();
+  const std::vector<const moveit::core::JointModel*>& joints = robot_model->getActiveJointModels();
+  for (const moveit::core::JointModel* joint : joints)
+    joint_state->name.push_back(joint->getName());
+  joint_state->position.resize(joint_state->name.size());
+
+  // WHEN updates that set all joints to the same value race with a reader
+  std::atomic<bool> done{ false };
+  std::size_t inconsistent = 0;
+  std::thread reader([&] {
+    moveit::core::RobotState state(robot_model);
+    while (!done)
+    {
+      current_state_monitor.setToCurrentState(state);
+      for (const moveit::core::JointModel* joint : joints)
+      {
+        if (state.getJointPositions(joint)[0] != state.getJointPositions(joints.front())[0])
+          ++inconsistent;
+      }
+    }
+  });
+  for (int i = 1; i <= 1000; ++i)
+  {
+    std::fill(joint_state->position.begin(), joint_state->position.end(), i * 1e-4);
+    joint_state_callback(joint_state);
+  }
+  done = true;
+  reader.join();
 
-  // THEN we expect it waited for near 1 seconds
-  EXPECT_NEAR(nanoseconds_slept.count(), 1e+9, 1e3);
+  // THEN the reader never sees a partial update
+  EXPECT_EQ(inconsistent, 0u);
 }
 
 int main(int argc, char** argv)
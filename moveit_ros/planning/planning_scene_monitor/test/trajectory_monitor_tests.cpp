@@ -110,6 +110,64 @@ TEST(TrajectoryMonitorTests, SleepAtLeastOnce)
   waitFor(10s, [&]() { return static_cast<bool>(callback_called); });
 }
 
+TEST(TrajectoryMonitorTests, RingBufferKeepsLatestStates)
+{
+  auto mock_current_state_monitor_middleware_handle = std::make_unique<MockCurrentStateMonitorMiddlewareHandle>();
+  planning_scene_monitor::JointStateUpdateCallback joint_state_callback;
+  ON_CALL(*mock_current_state_monitor_middleware_handle, createJointStateSubscription)
+      .WillByDefault(testing::Invoke([&](const std::string& /*topic*/,
+                                         planning_scene_monitor::JointStateUpdateCallback callback) {
+        joint_state_callback = callback;
+      }));
+
+  // GIVEN a started state monitor and a trajectory monitor recording the last 3 states into a ring buffer
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  auto current_state_monitor = std::make_shared<planning_scene_monitor::CurrentStateMonitor>(
+      std::move(mock_current_state_monitor_middleware_handle), robot_model,
+      std::make_shared<tf2_ros::Buffer>(std::make_shared<rclcpp::Clock>()), false);
+  current_state_monitor->startStateMonitor();
+  ASSERT_TRUE(joint_state_callback);
+
+  auto mock_trajectory_monitor_middleware_handle = std::make_unique<MockTrajectoryMonitorMiddlewareHandle>();
+  planning_scene_monitor::TrajectoryMonitor trajectory_monitor{ current_state_monitor,
+                                                                std::move(mock_trajectory_monitor_middleware_handle),
+                                                                10.0 };
+  trajectory_monitor.startRingBufferRecording(current_state_monitor, 3);
+  EXPECT_TRUE(trajectory_monitor.isRingBufferRecording());
+
+  // WHEN 5 joint states arrive 0.1s apart
+  const moveit::core::JointModel* joint = robot_model->getJointModel("panda_joint1");
+  for (int i = 0; i < 5; ++i)
+  {
+    auto joint_state = std::make_shared<sensor_msgs::msg::JointState>();
+    joint_state->header.stamp = rclcpp::Time(1, i * 100000000, RCL_ROS_TIME);
+    joint_state->name.push_back(joint->getName());
+    joint_state->position.push_back(0.1 * i);
+    joint_state_callback(joint_state);
+  }
+
+  // THEN the exported trajectory holds the last 3 of them
+  robot_trajectory::RobotTrajectory trajectory(robot_model);
+  ASSERT_TRUE(trajectory_monitor.getRingBufferTrajectory(trajectory));
+  ASSERT_EQ(trajectory.getWayPointCount(), 3u);
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    EXPECT_NEAR(trajectory.getWayPoint(i).getJointPositions(joint)[0], 0.1 * (i + 2), 1e-9);
+    EXPECT_NEAR(trajectory.getWayPointDurationFromPrevious(i), i == 0 ? 0.0 : 0.1, 1e-9);
+  }
+
+  // AND nothing is recorded after clearing while paused
+  trajectory_monitor.clearRingBuffer();
+  trajectory_monitor.stopRingBufferRecording();
+  auto joint_state = std::make_shared<sensor_msgs::msg::JointState>();
+  joint_state->header.stamp = rclcpp::Time(2, 0, RCL_ROS_TIME);
+  joint_state->name.push_back(joint->getName());
+  joint_state->position.push_back(1.0);
+  joint_state_callback(joint_state);
+  ASSERT_TRUE(trajectory_monitor.getRingBufferTrajectory(trajectory));
+  EXPECT_TRUE(trajectory.empty());
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
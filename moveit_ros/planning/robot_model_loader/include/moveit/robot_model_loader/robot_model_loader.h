@@ -74,6 +74,15 @@ public:
     /** @brief Flag indicating whether the kinematics solvers should be loaded as well, using specified ROS parameters
      */
     bool load_kinematics_solvers;
+
+    /** @brief Directory to keep snapshots of the decoded collision meshes in, one per robot description. Loading a
+     * snapshot skips decoding the mesh resources when the URDF and SRDF are unchanged. If empty, the ROS parameter
+     * robot_description + "_planning.model_cache_directory" is used; if that is not set either, no snapshot is kept. */
+    std::string model_cache_directory;
+
+    /** @brief The number of threads initializing the kinematics solvers of different groups concurrently. 0 uses one
+     * thread per group, 1 initializes the solvers one after the other, e.g. for plugins that are not thread safe */
+    unsigned int kinematics_solver_threads = 0;
   };
 
   /** @brief Default constructor */
@@ -129,9 +138,13 @@ public:
 private:
   void configure(const Options& opt);
 
+  /** @brief Construct model_ from the loaded URDF and SRDF, using the mesh snapshot in \e cache_directory if given */
+  void buildModel(const srdf::ModelSharedPtr& srdf, const std::string& cache_directory);
+
   moveit::core::RobotModelPtr model_;
   rdf_loader::RDFLoaderPtr rdf_loader_;
   kinematics_plugin_loader::KinematicsPluginLoaderPtr kinematics_loader_;
+  unsigned int kinematics_solver_threads_ = 0;
   const rclcpp::Node::SharedPtr node_;
 };
 }  // namespace robot_model_loader
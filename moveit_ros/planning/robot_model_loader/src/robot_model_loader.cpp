@@ -41,6 +41,12 @@
 #include <rclcpp/logging.hpp>
 #include <rclcpp/parameter_value.hpp>
 #include <rclcpp/time.hpp>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <thread>
 #include <typeinfo>
 
 namespace robot_model_loader
@@ -105,6 +111,7 @@ void RobotModelLoader::configure(const Options& opt)
 {
   rclcpp::Clock clock;
   rclcpp::Time start = clock.now();
+  kinematics_solver_threads_ = opt.kinematics_solver_threads;
   if (!opt.urdf_string_.empty() && !opt.srdf_string.empty())
   {
     rdf_loader_ = std::make_shared<rdf_loader::RDFLoader>(opt.urdf_string_, opt.srdf_string);
@@ -117,7 +124,23 @@ void RobotModelLoader::configure(const Options& opt)
   {
     const srdf::ModelSharedPtr& srdf =
         rdf_loader_->getSRDF() ? rdf_loader_->getSRDF() : std::make_shared<srdf::Model>();
-    model_ = std::make_shared<moveit::core::RobotModel>(rdf_loader_->getURDF(), srdf);
+
+    std::string cache_directory = opt.model_cache_directory;
+    if (cache_directory.empty() && node_ && !rdf_loader_->getRobotDescription().empty())
+    {
+      const std::string param_name = rdf_loader_->getRobotDescription() + "_planning.model_cache_directory";
+      try
+      {
+        if (!node_->has_parameter(param_name))
+          node_->declare_parameter(param_name, rclcpp::ParameterType::PARAMETER_STRING);
+        node_->get_parameter(param_name, cache_directory);
+      }
+      catch (const rclcpp::ParameterTypeException& e)
+      {
+        RCLCPP_ERROR_STREAM(LOGGER, "When getting the parameter " << param_name << ": " << e.what());
+      }
+    }
+    buildModel(srdf, cache_directory);
   }
 
   if (model_ && !rdf_loader_->getRobotDescription().empty())
@@ -252,6 +275,35 @@ void RobotModelLoader::configure(const Options& opt)
   RCLCPP_DEBUG(node_->get_logger(), "Loaded kinematic model in %f seconds", (clock.now() - start).seconds());
 }
 
+void RobotModelLoader::buildModel(const srdf::ModelSharedPtr& srdf, const std::string& cache_directory)
+{
+  if (cache_directory.empty())
+  {
+    model_ = std::make_shared<moveit::core::RobotModel>(rdf_loader_->getURDF(), srdf);
+    return;
+  }
+
+  // the snapshot belongs to this exact robot description
+  const std::uint64_t key = moveit::core::MeshSnapshot::hashString(
+      rdf_loader_->getSRDFString(), moveit::core::MeshSnapshot::hashString(rdf_loader_->getURDFString()));
+  std::stringstream filename;
+  filename << std::hex << std::setw(16) << std::setfill('0') << key << ".meshes";
+  const std::filesystem::path path = std::filesystem::path(cache_directory) / filename.str();
+
+  auto snapshot = std::make_shared<moveit::core::MeshSnapshot>(key);
+  if (snapshot->load(path.string()))
+    RCLCPP_DEBUG(LOGGER, "Loaded %zu meshes from snapshot '%s'", snapshot->size(), path.c_str());
+  model_ = std::make_shared<moveit::core::RobotModel>(rdf_loader_->getURDF(), srdf, snapshot);
+
+  if (snapshot->isModified())
+  {
+    std::error_code ec;
+    std::filesystem::create_directories(cache_directory, ec);
+    if (ec || !snapshot->save(path.string()))
+      RCLCPP_WARN(LOGGER, "Unable to store mesh snapshot '%s'", path.c_str());
+  }
+}
+
 void RobotModelLoader::loadKinematicsSolvers(const kinematics_plugin_loader::KinematicsPluginLoaderPtr& kloader)
 {
   if (rdf_loader_ && model_)
@@ -275,16 +327,37 @@ void RobotModelLoader::loadKinematicsSolvers(const kinematics_plugin_loader::Kin
     if (groups.empty() && !model_->getJointModelGroups().empty())
       RCLCPP_WARN(LOGGER, "No kinematics plugins defined. Fill and load kinematics.yaml!");
 
-    std::map<std::string, moveit::core::SolverAllocatorFn> imap;
+    // Check if a group in kinematics.yaml exists in the srdf
+    std::vector<const moveit::core::JointModelGroup*> jmgs;
     for (const std::string& group : groups)
     {
-      // Check if a group in kinematics.yaml exists in the srdf
-      if (!model_->hasJointModelGroup(group))
-        continue;
+      if (model_->hasJointModelGroup(group))
+        jmgs.push_back(model_->getJointModelGroup(group));
+    }
 
-      const moveit::core::JointModelGroup* jmg = model_->getJointModelGroup(group);
+    // solvers can take seconds to initialize (e.g. large IK tables), so the groups are initialized concurrently.
+    // The allocator caches the instances for the calls by setKinematicsAllocators() below
+    std::vector<kinematics::KinematicsBasePtr> solvers(jmgs.size());
+    std::atomic<std::size_t> next{ 0 };
+    const auto allocate_solvers = [&] {
+      for (std::size_t i = next++; i < jmgs.size(); i = next++)
+        solvers[i] = kinematics_allocator(jmgs[i]);
+    };
+    const std::size_t thread_count =
+        std::min<std::size_t>(kinematics_solver_threads_ ? kinematics_solver_threads_ : jmgs.size(), jmgs.size());
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < thread_count; ++t)
+      threads.emplace_back(allocate_solvers);
+    allocate_solvers();
+    for (std::thread& thread : threads)
+      thread.join();
 
-      kinematics::KinematicsBasePtr solver = kinematics_allocator(jmg);
+    std::map<std::string, moveit::core::SolverAllocatorFn> imap;
+    for (std::size_t i = 0; i < jmgs.size(); ++i)
+    {
+      const moveit::core::JointModelGroup* jmg = jmgs[i];
+      const std::string& group = jmg->getName();
+      const kinematics::KinematicsBasePtr& solver = solvers[i];
       if (solver)
       {
         std::string error_msg;
@@ -304,6 +377,8 @@ void RobotModelLoader::loadKinematicsSolvers(const kinematics_plugin_loader::Kin
         RCLCPP_ERROR(LOGGER, "Kinematics solver could not be instantiated for joint group %s.", group.c_str());
       }
     }
+    // release the instances, so the allocator passes the cached ones on instead of creating new ones
+    solvers.clear();
     model_->setKinematicsAllocators(imap);
 
     // set the default IK timeouts
@@ -44,8 +44,12 @@
 #include <std_msgs/msg/string.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <moveit/controller_manager/controller_manager.h>
+#include <moveit/robot_trajectory/trajectory_archive.h>
+#include <moveit/robot_trajectory/trajectory_transport.h>
+#include <moveit/utils/metrics.h>
 #include <pluginlib/class_loader.hpp>
 
+#include <atomic>
 #include <memory>
 #include <deque>
 #include <thread>
@@ -63,6 +67,9 @@ class MOVEIT_TRAJECTORY_EXECUTION_MANAGER_EXPORT TrajectoryExecutionManager
 {
 public:
   static const std::string EXECUTION_EVENT_TOPIC;
+  /// Topic on which trajectories in the compact encoding of robot_trajectory::CompactTrajectoryAdapter are received
+  /// for execution, if the trajectory_execution.compact_trajectory_transport parameter is set
+  static const std::string COMPACT_TRAJECTORY_TOPIC;
 
   /// Definition of the function signature that is called when the execution of all the pushed trajectories completes.
   /// The status of the overall execution is passed as argument
@@ -153,6 +160,14 @@ public:
   /// If no controller is specified, a default is used.
   bool push(const moveit_msgs::msg::RobotTrajectory& trajectory, const std::vector<std::string>& controllers);
 
+  /// Extend the trajectory being executed by \e trajectory, without stopping the robot. This allows streaming a
+  /// motion in segments: push() and execute() the first segment, then append() the following ones while the robot
+  /// moves. The segment must start at the last point of the last pushed trajectory and use the same joints and
+  /// controllers, which must support MoveItControllerHandle::updateTrajectory(). Appending fails when the last pushed
+  /// trajectory is not executing (yet). On failure, the execution continues with the trajectory sent before, unless
+  /// only some of the controllers accepted the update, in which case the execution is stopped.
+  bool append(const moveit_msgs::msg::RobotTrajectory& trajectory);
+
   /// Get the trajectories to be executed
   const std::vector<TrajectoryExecutionContext*>& getTrajectories() const;
 
@@ -180,9 +195,30 @@ public:
   /// pushAndExecute().
   std::pair<int, int> getCurrentExpectedTrajectoryIndex() const;
 
+  /// Get the fraction of the trajectory part being executed that the robot is expected to have completed, from 0 to 1.
+  /// This is updated with every joint state received by the current state monitor while a part executes
+  double getExecutionProgress() const
+  {
+    return execution_progress_;
+  }
+
+  /// Get the largest joint-value distance between the last received joint state and the state the robot is expected to
+  /// be at, for the trajectory part being executed (or last executed)
+  double getExecutionDeviation() const
+  {
+    return execution_deviation_;
+  }
+
   /// Return the controller status for the last attempted execution
   moveit_controller_manager::ExecutionStatus getLastExecutionStatus() const;
 
+  /// Distribution of the time from starting to execute a trajectory part until all its controllers accepted it,
+  /// including switching controllers
+  const moveit::metrics::LatencyHistogram& getExecutionStartLatency() const
+  {
+    return execution_start_latency_;
+  }
+
   /// Stop whatever executions are active, if any
   void stopExecution(bool auto_clear = true);
 
@@ -208,9 +244,23 @@ public:
   /// Set joint-value tolerance for validating trajectory's start point against current robot state
   void setAllowedStartTolerance(double tolerance);
 
+  /// Abort the execution as soon as a joint deviates from its expected value by more than \e tolerance, instead of
+  /// waiting for the controller or the execution duration monitoring to fail. Radians for revolute joints.
+  /// By default, this is 0.0, which disables the check
+  void setAllowedExecutionDeviation(double tolerance);
+
   /// Enable or disable waiting for trajectory completion
   void setWaitForTrajectoryCompletion(bool flag);
 
+  /// When a trajectory is split across several controllers, stamp the parts without a start time to start this many
+  /// seconds after they are sent, so all controllers start together instead of when they receive their part.
+  /// By default, this is 0.0, which disables synchronized starts
+  void setSynchronizedStartDelay(double delay);
+
+  /// Append the joint trajectory of every executed part to the trajectory archive \e filename, labeled with the
+  /// controller name and the execution status. An empty filename stops archiving, which is the default
+  void setTrajectoryArchive(const std::string& filename);
+
   rclcpp::Node::SharedPtr getControllerManagerNode()
   {
     return controller_mgr_node_;
@@ -266,11 +316,21 @@ private:
   void executeThread(const ExecutionCompleteCallback& callback, const PathSegmentCompleteCallback& part_callback,
                      bool auto_clear);
   bool executePart(std::size_t part_index);
+  /// Wait for \e handle to finish executing, following trajectory updates by append(). Return true on timeout
+  bool waitForHandle(moveit_controller_manager::MoveItControllerHandle& handle,
+                     const rclcpp::Duration& expected_trajectory_duration, const rclcpp::Time& start_time,
+                     std::size_t initial_updates);
   bool waitForRobotToStop(const TrajectoryExecutionContext& context, double wait_time = 1.0);
+  bool appendPart(moveit_msgs::msg::RobotTrajectory& part, const moveit_msgs::msg::RobotTrajectory& segment) const;
 
   void stopExecutionInternal();
 
+  /// Compare \e joint_state with the expected state of the trajectory part being executed and abort on deviation
+  void updateExecutionProgress(const sensor_msgs::msg::JointState& joint_state);
+
   void receiveEvent(const std_msgs::msg::String::ConstSharedPtr& event);
+  /// Append \e trajectory to the executing trajectory, or push and execute it if none executes
+  void receiveCompactTrajectory(const moveit_msgs::msg::RobotTrajectory& trajectory);
 
   void loadControllerParams();
 
@@ -284,6 +344,7 @@ private:
   moveit::core::RobotModelConstPtr robot_model_;
   planning_scene_monitor::CurrentStateMonitorPtr csm_;
   rclcpp::Subscription<std_msgs::msg::String>::SharedPtr event_topic_subscriber_;
+  rclcpp::Subscription<robot_trajectory::CompactTrajectoryAdapter>::SharedPtr compact_trajectory_subscriber_;
   std::map<std::string, ControllerInformation> known_controllers_;
   bool manage_controllers_;
 
@@ -297,12 +358,20 @@ private:
   std::condition_variable execution_complete_condition_;
 
   moveit_controller_manager::ExecutionStatus last_execution_status_;
+  moveit::metrics::LatencyHistogram execution_start_latency_;
   std::vector<moveit_controller_manager::MoveItControllerHandlePtr> active_handles_;
   int current_context_;
   std::vector<rclcpp::Time> time_index_;  // used to find current expected trajectory location
   mutable std::mutex time_index_mutex_;
   bool execution_complete_;
 
+  // state of the executing trajectory, for append()
+  rclcpp::Time part_start_time_{ 0, 0, RCL_ROS_TIME };   // start of the trajectory as timed by the controllers
+  int time_index_part_;                                  // trajectory part time_index_ is computed from
+  rclcpp::Time time_index_start_{ 0, 0, RCL_ROS_TIME };  // time the points of time_index_part_ are timed from
+  rclcpp::Duration appended_duration_{ 0, 0 };           // expected execution duration added by append()
+  std::atomic<std::size_t> trajectory_updates_;          // count of trajectories updated by append()
+
   std::vector<TrajectoryExecutionContext*> trajectories_;
 
   std::unique_ptr<pluginlib::ClassLoader<moveit_controller_manager::MoveItControllerManager> > controller_manager_loader_;
@@ -319,9 +388,23 @@ private:
   std::map<std::string, double> controller_allowed_execution_duration_scaling_;
   std::map<std::string, double> controller_allowed_goal_duration_margin_;
 
-  double allowed_start_tolerance_;  // joint tolerance for validate(): radians for revolute joints
+  double allowed_start_tolerance_;      // joint tolerance for validate(): radians for revolute joints
+  double allowed_execution_deviation_;  // joint tolerance while executing, 0 disables the check
+
+  // progress tracking from the joint state updates, which the current state monitor calls as long as it exists
+  struct ProgressTracker
+  {
+    std::mutex mutex;
+    TrajectoryExecutionManager* manager;
+  };
+  std::shared_ptr<ProgressTracker> progress_tracker_;
+  std::atomic<double> execution_progress_;
+  std::atomic<double> execution_deviation_;
+  std::atomic<bool> execution_deviated_;  // the executing part was aborted for deviating
   double execution_velocity_scaling_;
   bool wait_for_trajectory_completion_;
+  double synchronized_start_delay_;
+  std::shared_ptr<robot_trajectory::TrajectoryArchiveWriter> trajectory_archive_;  // accessed atomically
 
   rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr callback_handler_;
 };
@@ -36,14 +36,20 @@
 
 #include <moveit/trajectory_execution_manager/trajectory_execution_manager.h>
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/utils/tracing.h>
 #include <geometric_shapes/check_isometry.h>
 #include <tf2_eigen/tf2_eigen.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <future>
+
 namespace trajectory_execution_manager
 {
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_ros.trajectory_execution_manager");
 
 const std::string TrajectoryExecutionManager::EXECUTION_EVENT_TOPIC = "trajectory_execution_event";
+const std::string TrajectoryExecutionManager::COMPACT_TRAJECTORY_TOPIC = "compact_trajectory_execution";
 
 static const auto DEFAULT_CONTROLLER_INFORMATION_VALIDITY_AGE = rclcpp::Duration::from_seconds(1);
 static const double DEFAULT_CONTROLLER_GOAL_DURATION_MARGIN = 0.5;  // allow 0.5s more than the expected execution time
@@ -73,6 +79,11 @@ TrajectoryExecutionManager::TrajectoryExecutionManager(const rclcpp::Node::Share
 
 TrajectoryExecutionManager::~TrajectoryExecutionManager()
 {
+  if (progress_tracker_)
+  {
+    std::scoped_lock lock(progress_tracker_->mutex);
+    progress_tracker_->manager = nullptr;
+  }
   stopExecution(true);
   if (private_executor_)
     private_executor_->cancel();
@@ -85,11 +96,18 @@ void TrajectoryExecutionManager::initialize()
   verbose_ = false;
   execution_complete_ = true;
   current_context_ = -1;
+  time_index_part_ = -1;
+  trajectory_updates_ = 0;
   last_execution_status_ = moveit_controller_manager::ExecutionStatus::SUCCEEDED;
   execution_duration_monitoring_ = true;
   execution_velocity_scaling_ = 1.0;
   allowed_start_tolerance_ = 0.01;
+  allowed_execution_deviation_ = 0.0;
+  execution_progress_ = 0.0;
+  execution_deviation_ = 0.0;
+  execution_deviated_ = false;
   wait_for_trajectory_completion_ = true;
+  synchronized_start_delay_ = 0.0;
 
   allowed_execution_duration_scaling_ = DEFAULT_CONTROLLER_GOAL_DURATION_SCALING;
   allowed_goal_duration_margin_ = DEFAULT_CONTROLLER_GOAL_DURATION_MARGIN;
@@ -189,6 +207,18 @@ void TrajectoryExecutionManager::initialize()
       EXECUTION_EVENT_TOPIC, rclcpp::SystemDefaultsQoS(),
       [this](const std_msgs::msg::String::ConstSharedPtr& event) { return receiveEvent(event); }, options);
 
+  bool compact_trajectory_transport = false;
+  controller_mgr_node_->get_parameter("trajectory_execution.compact_trajectory_transport",
+                                      compact_trajectory_transport);
+  if (compact_trajectory_transport)
+  {
+    compact_trajectory_subscriber_ = node_->create_subscription<robot_trajectory::CompactTrajectoryAdapter>(
+        COMPACT_TRAJECTORY_TOPIC, rclcpp::SystemDefaultsQoS(),
+        [this](const moveit_msgs::msg::RobotTrajectory& trajectory) { return receiveCompactTrajectory(trajectory); },
+        options);
+    RCLCPP_INFO(LOGGER, "Receiving compact trajectories for execution on '%s'", COMPACT_TRAJECTORY_TOPIC.c_str());
+  }
+
   controller_mgr_node_->get_parameter("trajectory_execution.execution_duration_monitoring",
                                       execution_duration_monitoring_);
   controller_mgr_node_->get_parameter("trajectory_execution.allowed_execution_duration_scaling",
@@ -196,6 +226,12 @@ void TrajectoryExecutionManager::initialize()
   controller_mgr_node_->get_parameter("trajectory_execution.allowed_goal_duration_margin",
                                       allowed_goal_duration_margin_);
   controller_mgr_node_->get_parameter("trajectory_execution.allowed_start_tolerance", allowed_start_tolerance_);
+  controller_mgr_node_->get_parameter("trajectory_execution.allowed_execution_deviation",
+                                      allowed_execution_deviation_);
+  controller_mgr_node_->get_parameter("trajectory_execution.synchronized_start_delay", synchronized_start_delay_);
+  std::string trajectory_archive;
+  if (controller_mgr_node_->get_parameter("trajectory_execution.trajectory_archive", trajectory_archive))
+    setTrajectoryArchive(trajectory_archive);
 
   if (manage_controllers_)
   {
@@ -206,6 +242,22 @@ void TrajectoryExecutionManager::initialize()
     RCLCPP_INFO(LOGGER, "Trajectory execution is not managing controllers");
   }
 
+  // track the execution progress with every joint state, so deviations are noticed before the duration monitoring
+  if (csm_)
+  {
+    progress_tracker_ = std::make_shared<ProgressTracker>();
+    progress_tracker_->manager = this;
+    const std::weak_ptr<ProgressTracker> weak_tracker = progress_tracker_;
+    csm_->addUpdateCallback([weak_tracker](const sensor_msgs::msg::JointState::ConstSharedPtr& joint_state) {
+      if (const std::shared_ptr<ProgressTracker> tracker = weak_tracker.lock())
+      {
+        std::scoped_lock lock(tracker->mutex);
+        if (tracker->manager)
+          tracker->manager->updateExecutionProgress(*joint_state);
+      }
+    });
+  }
+
   auto controller_mgr_parameter_set_callback = [this](const std::vector<rclcpp::Parameter>& parameters) {
     auto result = rcl_interfaces::msg::SetParametersResult();
     result.successful = true;
@@ -232,10 +284,22 @@ void TrajectoryExecutionManager::initialize()
       {
         setAllowedStartTolerance(parameter.as_double());
       }
+      else if (name == "trajectory_execution.allowed_execution_deviation")
+      {
+        setAllowedExecutionDeviation(parameter.as_double());
+      }
       else if (name == "trajectory_execution.wait_for_trajectory_completion")
       {
         setWaitForTrajectoryCompletion(parameter.as_bool());
       }
+      else if (name == "trajectory_execution.synchronized_start_delay")
+      {
+        setSynchronizedStartDelay(parameter.as_double());
+      }
+      else if (name == "trajectory_execution.trajectory_archive")
+      {
+        setTrajectoryArchive(parameter.as_string());
+      }
       else
       {
         result.successful = false;
@@ -271,11 +335,35 @@ void TrajectoryExecutionManager::setAllowedStartTolerance(double tolerance)
   allowed_start_tolerance_ = tolerance;
 }
 
+void TrajectoryExecutionManager::setAllowedExecutionDeviation(double tolerance)
+{
+  allowed_execution_deviation_ = tolerance;
+}
+
 void TrajectoryExecutionManager::setWaitForTrajectoryCompletion(bool flag)
 {
   wait_for_trajectory_completion_ = flag;
 }
 
+void TrajectoryExecutionManager::setSynchronizedStartDelay(double delay)
+{
+  synchronized_start_delay_ = delay;
+}
+
+void TrajectoryExecutionManager::setTrajectoryArchive(const std::string& filename)
+{
+  std::shared_ptr<robot_trajectory::TrajectoryArchiveWriter> archive;
+  if (!filename.empty())
+  {
+    archive = std::make_shared<robot_trajectory::TrajectoryArchiveWriter>(filename);
+    if (!archive->isOpen())
+      archive.reset();
+    else
+      RCLCPP_INFO(LOGGER, "Archiving executed trajectories to '%s'", filename.c_str());
+  }
+  std::atomic_store(&trajectory_archive_, archive);
+}
+
 bool TrajectoryExecutionManager::isManagingControllers() const
 {
   return manage_controllers_;
@@ -304,6 +392,22 @@ void TrajectoryExecutionManager::receiveEvent(const std_msgs::msg::String::Const
   processEvent(event->data);
 }
 
+void TrajectoryExecutionManager::receiveCompactTrajectory(const moveit_msgs::msg::RobotTrajectory& trajectory)
+{
+  if (trajectory.joint_trajectory.points.empty() && trajectory.multi_dof_joint_trajectory.points.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "Received an empty or invalid compact trajectory");
+    return;
+  }
+  if (!execution_complete_)
+  {
+    append(trajectory);
+    return;
+  }
+  if (push(trajectory))
+    execute();
+}
+
 bool TrajectoryExecutionManager::push(const moveit_msgs::msg::RobotTrajectory& trajectory, const std::string& controller)
 {
   if (controller.empty())
@@ -373,6 +477,165 @@ bool TrajectoryExecutionManager::push(const moveit_msgs::msg::RobotTrajectory& t
   return false;
 }
 
+bool TrajectoryExecutionManager::append(const moveit_msgs::msg::RobotTrajectory& trajectory)
+{
+  if (execution_complete_ || trajectories_.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "Cannot append a trajectory when no trajectory is being executed");
+    return false;
+  }
+
+  TrajectoryExecutionContext segment;
+  if (!configure(segment, trajectory, trajectories_.back()->controllers_))
+    return false;
+
+  std::scoped_lock slock(execution_state_mutex_);
+  {
+    std::scoped_lock tlock(time_index_mutex_);
+    if (execution_complete_ || current_context_ != static_cast<int>(trajectories_.size()) - 1 || time_index_part_ < 0)
+    {
+      RCLCPP_ERROR(LOGGER, "Cannot append a trajectory before the last pushed trajectory is being executed");
+      return false;
+    }
+  }
+
+  TrajectoryExecutionContext& context = *trajectories_[current_context_];
+  if (segment.controllers_ != context.controllers_ || active_handles_.size() != context.controllers_.size())
+  {
+    RCLCPP_ERROR(LOGGER, "Appended trajectories must use the controllers of the trajectory being executed");
+    return false;
+  }
+
+  std::vector<moveit_msgs::msg::RobotTrajectory> parts = context.trajectory_parts_;
+  for (std::size_t i = 0; i < parts.size(); ++i)
+  {
+    if (!appendPart(parts[i], segment.trajectory_parts_[i]))
+      return false;
+  }
+
+  // the update preempts the goals waited for in executePart(), which waits for the updated goals instead
+  ++trajectory_updates_;
+  for (std::size_t i = 0; i < parts.size(); ++i)
+  {
+    bool ok = false;
+    try
+    {
+      ok = active_handles_[i]->updateTrajectory(parts[i]);
+    }
+    catch (std::exception& ex)
+    {
+      RCLCPP_ERROR(LOGGER, "Caught %s when updating trajectory of controller", ex.what());
+    }
+    if (!ok)
+    {
+      RCLCPP_ERROR(LOGGER, "Failed to update the trajectory of controller %s", active_handles_[i]->getName().c_str());
+      // the parts updated so far no longer match the others
+      if (i > 0)
+      {
+        stopExecutionInternal();
+        last_execution_status_ = moveit_controller_manager::ExecutionStatus::ABORTED;
+      }
+      return false;
+    }
+  }
+
+  // extend the expected duration and the time index by the appended points
+  auto segment_duration = rclcpp::Duration::from_seconds(0);
+  for (std::size_t i = 0; i < parts.size(); ++i)
+  {
+    const moveit_msgs::msg::RobotTrajectory& appended = segment.trajectory_parts_[i];
+    if (!appended.joint_trajectory.points.empty())
+      segment_duration =
+          std::max(segment_duration, rclcpp::Duration(appended.joint_trajectory.points.back().time_from_start));
+    if (!appended.multi_dof_joint_trajectory.points.empty())
+      segment_duration = std::max(
+          segment_duration, rclcpp::Duration(appended.multi_dof_joint_trajectory.points.back().time_from_start));
+  }
+  appended_duration_ = appended_duration_ + segment_duration * allowed_execution_duration_scaling_;
+
+  {
+    std::scoped_lock tlock(time_index_mutex_);
+    const moveit_msgs::msg::RobotTrajectory& part = parts[time_index_part_];
+    if (part.joint_trajectory.points.size() >= part.multi_dof_joint_trajectory.points.size())
+    {
+      for (std::size_t j = time_index_.size(); j < part.joint_trajectory.points.size(); ++j)
+        time_index_.push_back(time_index_start_ + rclcpp::Duration(part.joint_trajectory.points[j].time_from_start));
+    }
+    else
+    {
+      for (std::size_t j = time_index_.size(); j < part.multi_dof_joint_trajectory.points.size(); ++j)
+        time_index_.push_back(time_index_start_ +
+                              rclcpp::Duration(part.multi_dof_joint_trajectory.points[j].time_from_start));
+    }
+
+    // the progress tracking reads the parts under this lock
+    context.trajectory_parts_ = std::move(parts);
+  }
+  return true;
+}
+
+bool TrajectoryExecutionManager::appendPart(moveit_msgs::msg::RobotTrajectory& part,
+                                            const moveit_msgs::msg::RobotTrajectory& segment) const
+{
+  if (part.joint_trajectory.joint_names != segment.joint_trajectory.joint_names ||
+      part.multi_dof_joint_trajectory.joint_names != segment.multi_dof_joint_trajectory.joint_names ||
+      part.joint_trajectory.points.empty() != segment.joint_trajectory.points.empty() ||
+      part.multi_dof_joint_trajectory.points.empty() != segment.multi_dof_joint_trajectory.points.empty())
+  {
+    RCLCPP_ERROR(LOGGER, "Appended trajectories must use the joints of the trajectory being executed");
+    return false;
+  }
+
+  // the segment starts where the part ends, so its first point is skipped
+  if (!segment.joint_trajectory.points.empty() && allowed_start_tolerance_ > 0)
+  {
+    const std::vector<double>& end = part.joint_trajectory.points.back().positions;
+    const std::vector<double>& start = segment.joint_trajectory.points.front().positions;
+    for (std::size_t i = 0; i < segment.joint_trajectory.joint_names.size(); ++i)
+    {
+      const moveit::core::JointModel* jm = robot_model_->getJointModel(segment.joint_trajectory.joint_names[i]);
+      if (!jm || i >= end.size() || i >= start.size())
+        return false;
+      if (jm->distance(&end[i], &start[i]) > allowed_start_tolerance_)
+      {
+        RCLCPP_ERROR(LOGGER,
+                     "Appended trajectory deviates from the end of the trajectory being executed more than %g at "
+                     "joint '%s': expected: %g, start: %g",
+                     allowed_start_tolerance_, jm->getName().c_str(), end[i], start[i]);
+        return false;
+      }
+    }
+  }
+
+  // controllers time a goal without stamp from its arrival, so the update gets the time the executing goal was sent
+  if (rclcpp::Time(part.joint_trajectory.header.stamp).nanoseconds() == 0)
+    part.joint_trajectory.header.stamp = part_start_time_;
+  if (rclcpp::Time(part.multi_dof_joint_trajectory.header.stamp).nanoseconds() == 0)
+    part.multi_dof_joint_trajectory.header.stamp = part_start_time_;
+
+  if (!segment.joint_trajectory.points.empty())
+  {
+    const rclcpp::Duration offset(part.joint_trajectory.points.back().time_from_start);
+    for (std::size_t j = 1; j < segment.joint_trajectory.points.size(); ++j)
+    {
+      part.joint_trajectory.points.push_back(segment.joint_trajectory.points[j]);
+      part.joint_trajectory.points.back().time_from_start =
+          offset + rclcpp::Duration(segment.joint_trajectory.points[j].time_from_start);
+    }
+  }
+  if (!segment.multi_dof_joint_trajectory.points.empty())
+  {
+    const rclcpp::Duration offset(part.multi_dof_joint_trajectory.points.back().time_from_start);
+    for (std::size_t j = 1; j < segment.multi_dof_joint_trajectory.points.size(); ++j)
+    {
+      part.multi_dof_joint_trajectory.points.push_back(segment.multi_dof_joint_trajectory.points[j]);
+      part.multi_dof_joint_trajectory.points.back().time_from_start =
+          offset + rclcpp::Duration(segment.multi_dof_joint_trajectory.points[j].time_from_start);
+    }
+  }
+  return true;
+}
+
 void TrajectoryExecutionManager::reloadControllerInformation()
 {
   known_controllers_.clear();
@@ -1223,6 +1486,8 @@ void TrajectoryExecutionManager::executeThread(const ExecutionCompleteCallback&
 
 bool TrajectoryExecutionManager::executePart(std::size_t part_index)
 {
+  moveit::tracing::ScopedTrace trace("trajectory_execution_part");
+  const auto part_start = std::chrono::steady_clock::now();
   TrajectoryExecutionContext& context = *trajectories_[part_index];
 
   // first make sure desired controllers are active
@@ -1264,40 +1529,77 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
           active_handles_[i] = h;
         }
         handles = active_handles_;  // keep a copy for later, to avoid thread safety issues
-        for (std::size_t i = 0; i < context.trajectory_parts_.size(); ++i)
+
+        // let controllers start their parts at the same time, instead of when each part is received
+        if (synchronized_start_delay_ > 0.0 && context.trajectory_parts_.size() > 1)
         {
-          bool ok = false;
-          try
+          const rclcpp::Time start = node_->now() + rclcpp::Duration::from_seconds(synchronized_start_delay_);
+          for (moveit_msgs::msg::RobotTrajectory& part : context.trajectory_parts_)
           {
-            ok = active_handles_[i]->sendTrajectory(context.trajectory_parts_[i]);
+            if (rclcpp::Time(part.joint_trajectory.header.stamp).nanoseconds() == 0)
+              part.joint_trajectory.header.stamp = start;
+            if (rclcpp::Time(part.multi_dof_joint_trajectory.header.stamp).nanoseconds() == 0)
+              part.multi_dof_joint_trajectory.header.stamp = start;
           }
-          catch (std::exception& ex)
-          {
-            RCLCPP_ERROR(LOGGER, "Caught %s when sending trajectory to controller", ex.what());
-          }
-          if (!ok)
+        }
+
+        // send the parts concurrently, as sending blocks until the controller accepted the goal
+        std::vector<std::future<bool>> sent;
+        for (std::size_t i = 0; i < context.trajectory_parts_.size(); ++i)
+        {
+          sent.push_back(std::async(context.trajectory_parts_.size() > 1 ? std::launch::async : std::launch::deferred,
+                                    [&handle = active_handles_[i], &part = context.trajectory_parts_[i]] {
+                                      try
+                                      {
+                                        moveit::tracing::ScopedTrace trace("trajectory_dispatch", handle->getName());
+                                        return handle->sendTrajectory(part);
+                                      }
+                                      catch (std::exception& ex)
+                                      {
+                                        RCLCPP_ERROR(LOGGER, "Caught %s when sending trajectory to controller",
+                                                     ex.what());
+                                      }
+                                      return false;
+                                    }));
+        }
+        std::vector<std::size_t> failed;
+        for (std::size_t i = 0; i < sent.size(); ++i)
+        {
+          if (!sent[i].get())
+            failed.push_back(i);
+        }
+        if (!failed.empty())
+        {
+          for (std::size_t i = 0; i < active_handles_.size(); ++i)
           {
-            for (std::size_t j = 0; j < i; ++j)
+            if (std::find(failed.begin(), failed.end(), i) != failed.end())
             {
-              try
-              {
-                active_handles_[j]->cancelExecution();
-              }
-              catch (std::exception& ex)
-              {
-                RCLCPP_ERROR(LOGGER, "Caught %s when canceling execution", ex.what());
-              }
+              RCLCPP_ERROR(LOGGER, "Failed to send trajectory part %zu of %zu to controller %s", i + 1,
+                           context.trajectory_parts_.size(), active_handles_[i]->getName().c_str());
+              continue;
+            }
+            try
+            {
+              active_handles_[i]->cancelExecution();
+            }
+            catch (std::exception& ex)
+            {
+              RCLCPP_ERROR(LOGGER, "Caught %s when canceling execution", ex.what());
             }
-            RCLCPP_ERROR(LOGGER, "Failed to send trajectory part %zu of %zu to controller %s", i + 1,
-                         context.trajectory_parts_.size(), active_handles_[i]->getName().c_str());
-            if (i > 0)
-              RCLCPP_ERROR(LOGGER, "Cancelling previously sent trajectory parts");
-            active_handles_.clear();
-            current_context_ = -1;
-            last_execution_status_ = moveit_controller_manager::ExecutionStatus::ABORTED;
-            return false;
           }
+          if (failed.size() < active_handles_.size())
+            RCLCPP_ERROR(LOGGER, "Cancelling the trajectory parts sent to other controllers");
+          active_handles_.clear();
+          current_context_ = -1;
+          last_execution_status_ = moveit_controller_manager::ExecutionStatus::ABORTED;
+          return false;
         }
+        part_start_time_ = node_->now();
+        appended_duration_ = rclcpp::Duration::from_seconds(0);
+        execution_progress_ = 0.0;
+        execution_deviation_ = 0.0;
+        execution_deviated_ = false;
+        execution_start_latency_.record(std::chrono::steady_clock::now() - part_start);
       }
     }
 
@@ -1369,6 +1671,7 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
         for (trajectory_msgs::msg::JointTrajectoryPoint& point :
              context.trajectory_parts_[longest_part].joint_trajectory.points)
           time_index_.push_back(current_time + d + rclcpp::Duration(point.time_from_start));
+        time_index_start_ = current_time + d;
       }
       else
       {
@@ -1381,48 +1684,94 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
         for (trajectory_msgs::msg::MultiDOFJointTrajectoryPoint& point :
              context.trajectory_parts_[longest_part].multi_dof_joint_trajectory.points)
           time_index_.push_back(current_time + d + rclcpp::Duration(point.time_from_start));
+        time_index_start_ = current_time + d;
       }
+      time_index_part_ = longest_part;
     }
 
-    bool result = true;
-    for (moveit_controller_manager::MoveItControllerHandlePtr& handle : handles)
+    // wait for all handles at once, so that a failing controller stops the others right away
+    const std::size_t initial_updates = trajectory_updates_;
+    std::mutex wait_mutex;
+    std::condition_variable wait_condition;
+    std::size_t finished = 0;
+    std::size_t first_failure = handles.size();
+    std::vector<std::future<bool>> timed_out;
+    for (std::size_t i = 0; i < handles.size(); ++i)
     {
-      if (execution_duration_monitoring_)
-      {
-        if (!handle->waitForExecution(expected_trajectory_duration))
+      timed_out.push_back(std::async(handles.size() > 1 ? std::launch::async : std::launch::deferred, [&, i] {
+        bool handle_timed_out;
         {
-          if (!execution_complete_ && node_->now() - current_time > expected_trajectory_duration)
-          {
-            RCLCPP_ERROR(LOGGER,
-                         "Controller is taking too long to execute trajectory (the expected upper "
-                         "bound for the trajectory execution was %lf seconds). Stopping trajectory.",
-                         expected_trajectory_duration.seconds());
-            {
-              std::scoped_lock slock(execution_state_mutex_);
-              stopExecutionInternal();  // this is really tricky. we can't call stopExecution() here, so we call the
-                                        // internal function only
-            }
-            last_execution_status_ = moveit_controller_manager::ExecutionStatus::TIMED_OUT;
-            result = false;
-            break;
-          }
+          moveit::tracing::ScopedTrace trace("controller_execution", handles[i]->getName());
+          handle_timed_out = waitForHandle(*handles[i], expected_trajectory_duration, current_time, initial_updates);
+        }
+        {
+          std::scoped_lock lock(wait_mutex);
+          ++finished;
+          if (first_failure == handles.size() &&
+              (handle_timed_out ||
+               handles[i]->getLastExecutionStatus() != moveit_controller_manager::ExecutionStatus::SUCCEEDED))
+            first_failure = i;
         }
+        wait_condition.notify_all();
+        return handle_timed_out;
+      }));
+    }
+    if (handles.size() > 1)
+    {
+      bool stop_others;
+      {
+        std::unique_lock<std::mutex> lock(wait_mutex);
+        wait_condition.wait(lock, [&] { return finished == handles.size() || first_failure < handles.size(); });
+        stop_others = finished < handles.size() && !execution_complete_;
       }
-      else
-        handle->waitForExecution();
+      if (stop_others)
+      {
+        std::scoped_lock slock(execution_state_mutex_);
+        stopExecutionInternal();  // this is really tricky. we can't call stopExecution() here, so we call the
+                                  // internal function only
+      }
+    }
+    for (std::future<bool>& handle_timed_out : timed_out)
+      handle_timed_out.wait();
 
-      // if something made the trajectory stop, we stop this thread too
-      if (execution_complete_)
+    if (const auto archive = std::atomic_load(&trajectory_archive_))
+    {
+      for (std::size_t i = 0; i < handles.size(); ++i)
       {
-        result = false;
-        break;
+        if (!context.trajectory_parts_[i].joint_trajectory.points.empty())
+          archive->write(context.trajectory_parts_[i].joint_trajectory,
+                         handles[i]->getName() + ' ' + handles[i]->getLastExecutionStatus().asString(),
+                         current_time.nanoseconds());
       }
-      else if (handle->getLastExecutionStatus() != moveit_controller_manager::ExecutionStatus::SUCCEEDED)
+    }
+
+    bool result = true;
+    // if something made the trajectory stop, we stop this thread too
+    if (execution_complete_)
+    {
+      result = false;
+    }
+    else if (first_failure < handles.size())
+    {
+      result = false;
+      if (execution_deviated_)
       {
+        last_execution_status_ = moveit_controller_manager::ExecutionStatus::ABORTED;
+      }
+      else if (timed_out[first_failure].get())
+      {
+        {
+          std::scoped_lock slock(execution_state_mutex_);
+          stopExecutionInternal();
+        }
+        last_execution_status_ = moveit_controller_manager::ExecutionStatus::TIMED_OUT;
+      }
+      else
+      {
+        const moveit_controller_manager::MoveItControllerHandlePtr& handle = handles[first_failure];
         RCLCPP_WARN_STREAM(LOGGER, "Controller handle " << handle->getName() << " reports status "
                                                         << handle->getLastExecutionStatus().asString());
         last_execution_status_ = handle->getLastExecutionStatus();
-        result = false;
       }
     }
 
@@ -1434,6 +1783,7 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
     time_index_mutex_.lock();
     time_index_.clear();
     current_context_ = -1;
+    time_index_part_ = -1;
     time_index_mutex_.unlock();
 
     execution_state_mutex_.unlock();
@@ -1447,6 +1797,41 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
   }
 }
 
+bool TrajectoryExecutionManager::waitForHandle(moveit_controller_manager::MoveItControllerHandle& handle,
+                                               const rclcpp::Duration& expected_trajectory_duration,
+                                               const rclcpp::Time& start_time, std::size_t initial_updates)
+{
+  auto allowed_duration = expected_trajectory_duration;
+  std::size_t updates;
+  do
+  {
+    updates = trajectory_updates_;
+    if (execution_duration_monitoring_)
+    {
+      {
+        std::scoped_lock slock(execution_state_mutex_);
+        allowed_duration = expected_trajectory_duration + appended_duration_;
+      }
+      if (!handle.waitForExecution(allowed_duration) && !execution_complete_ &&
+          node_->now() - start_time > allowed_duration)
+      {
+        RCLCPP_ERROR(LOGGER,
+                     "Controller is taking too long to execute trajectory (the expected upper "
+                     "bound for the trajectory execution was %lf seconds). Stopping trajectory.",
+                     allowed_duration.seconds());
+        return true;
+      }
+    }
+    else
+      handle.waitForExecution();
+    // a goal replaced by append() finishes while the handle still runs the update, so wait again
+  } while (!execution_complete_ &&
+           (updates != trajectory_updates_ ||
+            (updates != initial_updates &&
+             handle.getLastExecutionStatus() == moveit_controller_manager::ExecutionStatus::RUNNING)));
+  return false;
+}
+
 bool TrajectoryExecutionManager::waitForRobotToStop(const TrajectoryExecutionContext& context, double wait_time)
 {
   // skip waiting for convergence?
@@ -1507,6 +1892,71 @@ bool TrajectoryExecutionManager::waitForRobotToStop(const TrajectoryExecutionCon
   return time_remaining > 0;
 }
 
+void TrajectoryExecutionManager::updateExecutionProgress(const sensor_msgs::msg::JointState& joint_state)
+{
+  if (execution_complete_)
+    return;
+
+  double deviation = 0.0;
+  {
+    std::scoped_lock slock(time_index_mutex_);
+    if (current_context_ < 0 || time_index_part_ < 0 || time_index_.empty())
+      return;
+
+    const rclcpp::Time now = node_->now();
+    const double duration = (time_index_.back() - time_index_start_).seconds();
+    const double elapsed = (now - time_index_start_).seconds();
+    execution_progress_ = duration > 0.0 ? std::clamp(elapsed / duration, 0.0, 1.0) : 1.0;
+
+    // interpolate the expected joint values of each part at the elapsed time
+    for (const moveit_msgs::msg::RobotTrajectory& part : trajectories_[current_context_]->trajectory_parts_)
+    {
+      const std::vector<trajectory_msgs::msg::JointTrajectoryPoint>& points = part.joint_trajectory.points;
+      if (points.empty())
+        continue;
+      const auto next = std::upper_bound(
+          points.begin(), points.end(), elapsed,
+          [](double t, const trajectory_msgs::msg::JointTrajectoryPoint& point) {
+            return t < rclcpp::Duration(point.time_from_start).seconds();
+          });
+      const trajectory_msgs::msg::JointTrajectoryPoint& after = next == points.end() ? points.back() : *next;
+      const trajectory_msgs::msg::JointTrajectoryPoint& before = next == points.begin() ? after : *(next - 1);
+      const double t_before = rclcpp::Duration(before.time_from_start).seconds();
+      const double t_after = rclcpp::Duration(after.time_from_start).seconds();
+      const double alpha = t_after > t_before ? (elapsed - t_before) / (t_after - t_before) : 1.0;
+
+      const std::vector<std::string>& joint_names = part.joint_trajectory.joint_names;
+      for (std::size_t i = 0; i < joint_names.size(); ++i)
+      {
+        const auto it = std::find(joint_state.name.begin(), joint_state.name.end(), joint_names[i]);
+        const std::size_t k = it - joint_state.name.begin();
+        if (it == joint_state.name.end() || k >= joint_state.position.size() || i >= after.positions.size() ||
+            i >= before.positions.size())
+          continue;
+        const moveit::core::JointModel* jm = robot_model_->getJointModel(joint_names[i]);
+        if (!jm || jm->getVariableCount() != 1)
+          continue;
+        const double expected = before.positions[i] + alpha * (after.positions[i] - before.positions[i]);
+        deviation = std::max(deviation, jm->distance(&expected, &joint_state.position[k]));
+      }
+    }
+  }
+  execution_deviation_ = deviation;
+
+  if (allowed_execution_deviation_ <= 0.0 || deviation <= allowed_execution_deviation_)
+    return;
+
+  std::scoped_lock slock(execution_state_mutex_);
+  if (!execution_complete_ && !active_handles_.empty() && !execution_deviated_.exchange(true))
+  {
+    RCLCPP_ERROR(LOGGER,
+                 "Robot deviates from the executed trajectory by %lf, which exceeds the allowed deviation of %lf. "
+                 "Stopping trajectory.",
+                 deviation, allowed_execution_deviation_);
+    stopExecutionInternal();
+  }
+}
+
 std::pair<int, int> TrajectoryExecutionManager::getCurrentExpectedTrajectoryIndex() const
 {
   std::scoped_lock slock(time_index_mutex_);
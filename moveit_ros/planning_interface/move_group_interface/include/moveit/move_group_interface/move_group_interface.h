@@ -53,6 +53,7 @@
 
 #include <rclcpp_action/rclcpp_action.hpp>
 
+#include <future>
 #include <memory>
 #include <utility>
 #include <tf2_ros/buffer.h>
@@ -115,6 +116,29 @@ public:
     double planning_time;
   };
 
+  /** \brief The result of planAsync() */
+  struct PlanResult
+  {
+    /// The outcome of planning
+    moveit::core::MoveItErrorCode error_code;
+
+    /// The plan, only set if planning succeeded
+    Plan plan;
+  };
+
+  /** \brief The result of computeCartesianPathAsync() */
+  struct CartesianPathResult
+  {
+    /// The fraction of the path achieved, between 0.0 and 1.0, or -1.0 in case of error
+    double fraction = -1.0;
+
+    /// The computed path, only set if \e fraction is not negative
+    moveit_msgs::msg::RobotTrajectory trajectory;
+
+    /// The error code reported by move_group
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+  };
+
   /**
       \brief Construct a MoveGroupInterface instance call using a specified set of options \e opt.
 
@@ -710,6 +734,12 @@ public:
       target. No execution is performed. The resulting plan is stored in \e plan*/
   moveit::core::MoveItErrorCode plan(Plan& plan);
 
+  /** \brief Like plan(), but return without waiting for the result.
+      The request is built from the targets, start state and parameters set when this is called, so they may be changed
+      for the next request right away. Any number of requests may be in flight; they are sent to move_group by the same
+      action client. The future is set from the callback thread of this interface, so it must not be waited on there. */
+  std::future<PlanResult> planAsync();
+
   /** \brief Given a \e plan, execute it without waiting for completion.
    *  \param [in] plan The motion plan for which to execute
    *  \param [in] controllers An optional list of ros2_controllers to execute with. If none, MoveIt will attempt to find
@@ -746,6 +776,16 @@ public:
   moveit::core::MoveItErrorCode execute(const moveit_msgs::msg::RobotTrajectory& trajectory,
                                         const std::vector<std::string>& controllers = std::vector<std::string>());
 
+  /** \brief Send a \e robot trajectory for execution in a compact binary encoding, which is faster to send and receive
+   *  than the execute action for long trajectories. move_group needs to be started with the
+   *  trajectory_execution.compact_trajectory_transport parameter set. No result is reported and the default controllers
+   *  are used. While a trajectory executes, \e trajectory is appended to it, so it needs to start where the executing
+   *  trajectory ends.
+   *  \return moveit::core::MoveItErrorCode::SUCCESS if the trajectory was sent, INVALID_MOTION_PLAN if it cannot be
+   *  encoded because its waypoints do not all have the same values
+   */
+  moveit::core::MoveItErrorCode asyncExecuteCompact(const moveit_msgs::msg::RobotTrajectory& trajectory);
+
   /** \brief Compute a Cartesian path that follows specified waypoints with a step size of at most \e eef_step meters
       between end effector configurations of consecutive points in the result \e trajectory. The reference frame for the
       waypoints is that specified by setPoseReferenceFrame(). No more than \e jump_threshold
@@ -776,6 +816,14 @@ public:
                               const moveit_msgs::msg::Constraints& path_constraints, bool avoid_collisions = true,
                               moveit_msgs::msg::MoveItErrorCodes* error_code = nullptr);
 
+  /** \brief Like computeCartesianPath(), but return without waiting for the result.
+      As for planAsync(), the request is built when this is called and many requests may be in flight. */
+  std::future<CartesianPathResult>
+  computeCartesianPathAsync(const std::vector<geometry_msgs::msg::Pose>& waypoints, double eef_step,
+                            double jump_threshold,
+                            const moveit_msgs::msg::Constraints& path_constraints = moveit_msgs::msg::Constraints(),
+                            bool avoid_collisions = true);
+
   /** \brief Stop any trajectory execution, if one is active */
   void stop();
 
@@ -36,6 +36,7 @@
 
 /* Author: Ioan Sucan, Sachin Chitta */
 
+#include <future>
 #include <stdexcept>
 #include <sstream>
 #include <memory>
@@ -50,6 +51,7 @@
 #include <moveit/trajectory_execution_manager/trajectory_execution_manager.h>
 #include <moveit/common_planning_interface_objects/common_objects.h>
 #include <moveit/robot_state/conversions.h>
+#include <moveit/robot_trajectory/trajectory_transport.h>
 #include <moveit_msgs/action/execute_trajectory.hpp>
 #include <moveit_msgs/srv/query_planner_interfaces.hpp>
 #include <moveit_msgs/srv/get_cartesian_path.hpp>
@@ -164,6 +166,10 @@ public:
         rclcpp::names::append(opt_.move_group_namespace,
                               trajectory_execution_manager::TrajectoryExecutionManager::EXECUTION_EVENT_TOPIC),
         1);
+    compact_trajectory_publisher_ = node_->create_publisher<robot_trajectory::CompactTrajectoryAdapter>(
+        rclcpp::names::append(opt_.move_group_namespace,
+                              trajectory_execution_manager::TrajectoryExecutionManager::COMPACT_TRAJECTORY_TOPIC),
+        rclcpp::SystemDefaultsQoS());
     attached_object_publisher_ = node_->create_publisher<moveit_msgs::msg::AttachedCollisionObject>(
         rclcpp::names::append(opt_.move_group_namespace,
                               planning_scene_monitor::PlanningSceneMonitor::DEFAULT_ATTACHED_COLLISION_OBJECT_TOPIC),
@@ -637,10 +643,23 @@ public:
 
   moveit::core::MoveItErrorCode plan(Plan& plan)
   {
+    PlanResult result = planAsync().get();
+    if (result.error_code)
+      plan = std::move(result.plan);
+    return result.error_code;
+  }
+
+  std::future<PlanResult> planAsync()
+  {
+    // the callbacks may outlive this call, so they share the promise
+    auto promise = std::make_shared<std::promise<PlanResult>>();
+    std::future<PlanResult> future = promise->get_future();
+
     if (!move_action_client_ || !move_action_client_->action_server_is_ready())
     {
       RCLCPP_INFO_STREAM(LOGGER, "MoveGroup action client/server not ready");
-      return moveit::core::MoveItErrorCode::FAILURE;
+      promise->set_value(PlanResult{ moveit::core::MoveItErrorCode::FAILURE, Plan() });
+      return future;
     }
     RCLCPP_INFO_STREAM(LOGGER, "MoveGroup action client/server ready");
 
@@ -652,27 +671,20 @@ public:
     goal.planning_options.planning_scene_diff.is_diff = true;
     goal.planning_options.planning_scene_diff.robot_state.is_diff = true;
 
-    bool done = false;
-    rclcpp_action::ResultCode code = rclcpp_action::ResultCode::UNKNOWN;
-    std::shared_ptr<moveit_msgs::action::MoveGroup::Result> res;
     auto send_goal_opts = rclcpp_action::Client<moveit_msgs::action::MoveGroup>::SendGoalOptions();
 
     send_goal_opts.goal_response_callback =
-        [&](const rclcpp_action::ClientGoalHandle<moveit_msgs::action::MoveGroup>::SharedPtr& goal_handle) {
+        [promise](const rclcpp_action::ClientGoalHandle<moveit_msgs::action::MoveGroup>::SharedPtr& goal_handle) {
           if (!goal_handle)
           {
-            done = true;
             RCLCPP_INFO(LOGGER, "Planning request rejected");
+            promise->set_value(PlanResult{ moveit::core::MoveItErrorCode::FAILURE, Plan() });
           }
           else
             RCLCPP_INFO(LOGGER, "Planning request accepted");
         };
     send_goal_opts.result_callback =
-        [&](const rclcpp_action::ClientGoalHandle<moveit_msgs::action::MoveGroup>::WrappedResult& result) {
-          res = result.result;
-          code = result.code;
-          done = true;
-
+        [promise](const rclcpp_action::ClientGoalHandle<moveit_msgs::action::MoveGroup>::WrappedResult& result) {
           switch (result.code)
           {
             case rclcpp_action::ResultCode::SUCCEEDED:
@@ -680,36 +692,34 @@ public:
               break;
             case rclcpp_action::ResultCode::ABORTED:
               RCLCPP_INFO(LOGGER, "Planning request aborted");
-              return;
+              break;
             case rclcpp_action::ResultCode::CANCELED:
               RCLCPP_INFO(LOGGER, "Planning request canceled");
-              return;
+              break;
             default:
               RCLCPP_INFO(LOGGER, "Planning request unknown result code");
-              return;
+              break;
           }
-        };
-
-    auto goal_handle_future = move_action_client_->async_send_goal(goal, send_goal_opts);
-
-    // wait until send_goal_opts.result_callback is called
-    while (!done)
-    {
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-
-    if (code != rclcpp_action::ResultCode::SUCCEEDED)
-    {
-      RCLCPP_ERROR_STREAM(LOGGER, "MoveGroupInterface::plan() failed or timeout reached");
-      return res->error_code;
-    }
 
-    plan.trajectory = res->planned_trajectory;
-    plan.start_state = res->trajectory_start;
-    plan.planning_time = res->planning_time;
-    RCLCPP_INFO(LOGGER, "time taken to generate plan: %g seconds", plan.planning_time);
+          PlanResult plan_result{ moveit::core::MoveItErrorCode::FAILURE, Plan() };
+          if (result.result)
+            plan_result.error_code = result.result->error_code;
+          if (result.code != rclcpp_action::ResultCode::SUCCEEDED || !result.result)
+          {
+            RCLCPP_ERROR_STREAM(LOGGER, "MoveGroupInterface::plan() failed or timeout reached");
+          }
+          else
+          {
+            plan_result.plan.trajectory = result.result->planned_trajectory;
+            plan_result.plan.start_state = result.result->trajectory_start;
+            plan_result.plan.planning_time = result.result->planning_time;
+            RCLCPP_INFO(LOGGER, "time taken to generate plan: %g seconds", plan_result.plan.planning_time);
+          }
+          promise->set_value(std::move(plan_result));
+        };
 
-    return res->error_code;
+    move_action_client_->async_send_goal(goal, send_goal_opts);
+    return future;
   }
 
   moveit::core::MoveItErrorCode move(bool wait)
@@ -855,9 +865,21 @@ public:
                               double jump_threshold, moveit_msgs::msg::RobotTrajectory& msg,
                               const moveit_msgs::msg::Constraints& path_constraints, bool avoid_collisions,
                               moveit_msgs::msg::MoveItErrorCodes& error_code)
+  {
+    CartesianPathResult result =
+        computeCartesianPathAsync(waypoints, step, jump_threshold, path_constraints, avoid_collisions).get();
+    error_code = result.error_code;
+    if (result.fraction >= 0.0)
+      msg = std::move(result.trajectory);
+    return result.fraction;
+  }
+
+  std::future<CartesianPathResult> computeCartesianPathAsync(const std::vector<geometry_msgs::msg::Pose>& waypoints,
+                                                             double step, double jump_threshold,
+                                                             const moveit_msgs::msg::Constraints& path_constraints,
+                                                             bool avoid_collisions)
   {
     auto req = std::make_shared<moveit_msgs::srv::GetCartesianPath::Request>();
-    moveit_msgs::srv::GetCartesianPath::Response::SharedPtr response;
 
     if (considered_start_state_)
     {
@@ -880,24 +902,31 @@ public:
     req->max_velocity_scaling_factor = max_velocity_scaling_factor_;
     req->max_acceleration_scaling_factor = max_acceleration_scaling_factor_;
 
-    auto future_response = cartesian_path_service_->async_send_request(req);
-    if (future_response.valid())
-    {
-      response = future_response.get();
-      error_code = response->error_code;
-      if (response->error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS)
-      {
-        msg = response->solution;
-        return response->fraction;
-      }
-      else
-        return -1.0;
-    }
-    else
-    {
-      error_code.val = error_code.FAILURE;
-      return -1.0;
-    }
+    auto promise = std::make_shared<std::promise<CartesianPathResult>>();
+    std::future<CartesianPathResult> future = promise->get_future();
+    cartesian_path_service_->async_send_request(
+        req, [promise](rclcpp::Client<moveit_msgs::srv::GetCartesianPath>::SharedFuture future_response) {
+          CartesianPathResult result;
+          const auto& response = future_response.get();
+          result.error_code = response->error_code;
+          if (response->error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS)
+          {
+            result.trajectory = response->solution;
+            result.fraction = response->fraction;
+          }
+          promise->set_value(std::move(result));
+        });
+    return future;
+  }
+
+  moveit::core::MoveItErrorCode executeCompact(const moveit_msgs::msg::RobotTrajectory& trajectory)
+  {
+    // encode here rather than in the type adapter, to report trajectories that cannot be encoded
+    auto msg = std::make_unique<std_msgs::msg::UInt8MultiArray>();
+    if (!robot_trajectory::encodeCompactTrajectory(trajectory, msg->data))
+      return moveit::core::MoveItErrorCode::INVALID_MOTION_PLAN;
+    compact_trajectory_publisher_->publish(std::move(msg));
+    return moveit::core::MoveItErrorCode::SUCCESS;
   }
 
   void stop()
@@ -1306,6 +1335,7 @@ private:
 
   // ROS communication
   rclcpp::Publisher<std_msgs::msg::String>::SharedPtr trajectory_event_publisher_;
+  rclcpp::Publisher<robot_trajectory::CompactTrajectoryAdapter>::SharedPtr compact_trajectory_publisher_;
   rclcpp::Publisher<moveit_msgs::msg::AttachedCollisionObject>::SharedPtr attached_object_publisher_;
   rclcpp::Client<moveit_msgs::srv::QueryPlannerInterfaces>::SharedPtr query_service_;
   rclcpp::Client<moveit_msgs::srv::GetPlannerParams>::SharedPtr get_params_service_;
@@ -1480,11 +1510,22 @@ moveit::core::MoveItErrorCode MoveGroupInterface::execute(const moveit_msgs::msg
   return impl_->execute(trajectory, true, controllers);
 }
 
+moveit::core::MoveItErrorCode
+MoveGroupInterface::asyncExecuteCompact(const moveit_msgs::msg::RobotTrajectory& trajectory)
+{
+  return impl_->executeCompact(trajectory);
+}
+
 moveit::core::MoveItErrorCode MoveGroupInterface::plan(Plan& plan)
 {
   return impl_->plan(plan);
 }
 
+std::future<MoveGroupInterface::PlanResult> MoveGroupInterface::planAsync()
+{
+  return impl_->planAsync();
+}
+
 // moveit_msgs::action::Pickup::Goal MoveGroupInterface::constructPickupGoal(const std::string& object,
 //                                                                        std::vector<moveit_msgs::msg::Grasp> grasps,
 //                                                                        bool plan_only = false) const
@@ -1554,6 +1595,15 @@ double MoveGroupInterface::computeCartesianPath(const std::vector<geometry_msgs:
   }
 }
 
+std::future<MoveGroupInterface::CartesianPathResult>
+MoveGroupInterface::computeCartesianPathAsync(const std::vector<geometry_msgs::msg::Pose>& waypoints, double eef_step,
+                                              double jump_threshold,
+                                              const moveit_msgs::msg::Constraints& path_constraints,
+                                              bool avoid_collisions)
+{
+  return impl_->computeCartesianPathAsync(waypoints, eef_step, jump_threshold, path_constraints, avoid_collisions);
+}
+
 void MoveGroupInterface::stop()
 {
   impl_->stop();
@@ -42,8 +42,10 @@
 #include <moveit/macros/class_forward.h>
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/robot_interaction/interaction.h>
+#include <chrono>
 #include <memory>
 #include <functional>
+#include <set>
 #include <thread>
 
 // This is needed for legacy code that includes robot_interaction.h but not
@@ -123,8 +125,15 @@ public:
 
   // Update pose of all interactive markers to match the handler's RobotState.
   // Call this when the handler's RobotState changes.
+  // Updates are published at most at the rate set by setMaxMarkerUpdateRate();
+  // updates arriving faster are merged and the latest poses are published
+  // once the period has passed.
   void updateInteractiveMarkers(const InteractionHandlerPtr& handler);
 
+  // Set the maximum rate (in Hz) at which updateInteractiveMarkers() publishes
+  // marker poses.  A rate of 0 publishes every update.  Defaults to 30 Hz.
+  void setMaxMarkerUpdateRate(double rate);
+
   // True if markers are being shown for this handler.
   bool showingMarkers(const InteractionHandlerPtr& handler);
 
@@ -194,13 +203,29 @@ private:
   processInteractiveMarkerFeedback(const visualization_msgs::msg::InteractiveMarkerFeedback::ConstSharedPtr& feedback);
   void subscribeMoveInteractiveMarker(const std::string marker_name, const std::string& name);
   void processingThread();
+  // pass feedback to its handler; called with marker_access_lock_ held by ulock, which is released while the
+  // handler runs
+  void processFeedback(const visualization_msgs::msg::InteractiveMarkerFeedback::ConstSharedPtr& feedback,
+                       std::unique_lock<std::mutex>& ulock);
+  // publish pending_pose_updates_; called with marker_access_lock_ held by ulock, which is released while publishing
+  void publishPendingPoseUpdates(std::unique_lock<std::mutex>& ulock);
   void clearInteractiveMarkersUnsafe();
 
-  std::unique_ptr<std::thread> processing_thread_;
+  // feedback is processed by a pool of threads, so IK for one marker does not hold up the others
+  std::vector<std::thread> processing_threads_;
   bool run_processing_thread_;
 
   std::condition_variable new_feedback_condition_;
+  // only the latest feedback of each marker is kept, so a slow handler skips the poses it fell behind on
   std::map<std::string, visualization_msgs::msg::InteractiveMarkerFeedback::ConstSharedPtr> feedback_map_;
+  // markers whose feedback is being processed; each marker is processed by one thread at a time
+  std::set<std::string> markers_in_progress_;
+
+  // marker poses from updateInteractiveMarkers() waiting to be published
+  std::map<std::string, geometry_msgs::msg::Pose> pending_pose_updates_;
+  std_msgs::msg::Header pending_pose_header_;
+  std::chrono::steady_clock::time_point last_pose_publish_;
+  std::chrono::steady_clock::duration min_pose_publish_period_;
 
   moveit::core::RobotModelConstPtr robot_model_;
 
@@ -212,7 +237,8 @@ private:
   std::map<std::string, std::size_t> shown_markers_;
 
   // This mutex is locked every time markers are read or updated;
-  // This includes the active_* arrays and shown_markers_
+  // This includes the active_* arrays and shown_markers_, as well as the
+  // feedback and pose update queues
   // Please note that this mutex *MUST NOT* be locked while operations
   // on the interactive marker server are called because the server
   // also locks internally and we could othewrise end up with a problem
@@ -58,6 +58,8 @@ namespace robot_interaction
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit_ros_robot_interaction.robot_interaction");
 static const double END_EFFECTOR_UNREACHABLE_COLOR[4] = { 1.0, 0.3, 0.3, 1.0 };
 static const double END_EFFECTOR_REACHABLE_COLOR[4] = { 0.2, 1.0, 0.2, 1.0 };
+static const unsigned int MAX_PROCESSING_THREADS = 4;
+static const double DEFAULT_MAX_MARKER_UPDATE_RATE = 30.0;
 
 const std::string RobotInteraction::INTERACTIVE_MARKER_TOPIC = "robot_interaction_interactive_marker_topic";
 
@@ -68,17 +70,24 @@ RobotInteraction::RobotInteraction(const moveit::core::RobotModelConstPtr& robot
   topic_ = ns.empty() ? INTERACTIVE_MARKER_TOPIC : ns + "/" + INTERACTIVE_MARKER_TOPIC;
   node_ = node;
   int_marker_server_ = new interactive_markers::InteractiveMarkerServer(topic_, node_);
+  setMaxMarkerUpdateRate(DEFAULT_MAX_MARKER_UPDATE_RATE);
 
-  // spin a thread that will process feedback events
+  // spin the threads that will process feedback events
   run_processing_thread_ = true;
-  processing_thread_ = std::make_unique<std::thread>([this] { processingThread(); });
+  const unsigned int thread_count = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_PROCESSING_THREADS);
+  for (unsigned int i = 0; i < thread_count; ++i)
+    processing_threads_.emplace_back([this] { processingThread(); });
 }
 
 RobotInteraction::~RobotInteraction()
 {
-  run_processing_thread_ = false;
+  {
+    std::unique_lock<std::mutex> ulock(marker_access_lock_);
+    run_processing_thread_ = false;
+  }
   new_feedback_condition_.notify_all();
-  processing_thread_->join();
+  for (std::thread& thread : processing_threads_)
+    thread.join();
 
   clear();
   delete int_marker_server_;
@@ -380,6 +389,7 @@ void RobotInteraction::clearInteractiveMarkersUnsafe()
 {
   handlers_.clear();
   shown_markers_.clear();
+  pending_pose_updates_.clear();
   int_marker_move_subscribers_.clear();
   int_marker_move_topics_.clear();
   int_marker_names_.clear();
@@ -646,13 +656,12 @@ void RobotInteraction::computeMarkerPose(const InteractionHandlerPtr& handler, c
 
 void RobotInteraction::updateInteractiveMarkers(const InteractionHandlerPtr& handler)
 {
-  std::string root_link;
   std::map<std::string, geometry_msgs::msg::Pose> pose_updates;
   {
     std::unique_lock<std::mutex> ulock(marker_access_lock_);
 
     moveit::core::RobotStateConstPtr s = handler->getState();
-    root_link = s->getRobotModel()->getModelFrame();
+    pending_pose_header_.frame_id = s->getRobotModel()->getModelFrame();  // marker poses are give w.r.t. root frame
 
     for (const EndEffectorInteraction& eef : active_eef_)
     {
@@ -674,14 +683,45 @@ void RobotInteraction::updateInteractiveMarkers(const InteractionHandlerPtr& han
       if (gi.update_pose && gi.update_pose(*s, pose))
         pose_updates[marker_name] = pose;
     }
+
+    for (auto& pose_update : pose_updates)
+      pending_pose_updates_[pose_update.first] = pose_update.second;
+
+    // while dragging, the state changes faster than the markers need to follow; a processing thread publishes the
+    // latest poses once the period has passed
+    if (std::chrono::steady_clock::now() < last_pose_publish_ + min_pose_publish_period_)
+    {
+      new_feedback_condition_.notify_one();
+      return;
+    }
+    publishPendingPoseUpdates(ulock);
   }
+}
 
-  std_msgs::msg::Header header;
-  header.frame_id = root_link;  // marker poses are give w.r.t. root frame
-  for (std::map<std::string, geometry_msgs::msg::Pose>::const_iterator it = pose_updates.begin();
-       it != pose_updates.end(); ++it)
-    int_marker_server_->setPose(it->first, it->second, header);
+void RobotInteraction::setMaxMarkerUpdateRate(double rate)
+{
+  std::unique_lock<std::mutex> ulock(marker_access_lock_);
+  min_pose_publish_period_ = std::chrono::steady_clock::duration::zero();
+  if (rate > 0.0)
+  {
+    min_pose_publish_period_ =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+  }
+}
+
+void RobotInteraction::publishPendingPoseUpdates(std::unique_lock<std::mutex>& ulock)
+{
+  std::map<std::string, geometry_msgs::msg::Pose> pose_updates;
+  pose_updates.swap(pending_pose_updates_);
+  const std_msgs::msg::Header header = pending_pose_header_;
+  last_pose_publish_ = std::chrono::steady_clock::now();
+
+  // the interactive marker server locks internally, see marker_access_lock_
+  ulock.unlock();
+  for (const auto& pose_update : pose_updates)
+    int_marker_server_->setPose(pose_update.first, pose_update.second, header);
   int_marker_server_->applyChanges();
+  ulock.lock();
 }
 
 void RobotInteraction::publishInteractiveMarkers()
@@ -761,101 +801,129 @@ void RobotInteraction::processingThread()
 
   while (run_processing_thread_ && rclcpp::ok())
   {
-    while (feedback_map_.empty() && run_processing_thread_ && rclcpp::ok())
-      new_feedback_condition_.wait(ulock);
+    // take the feedback of a marker no other thread is working on, so the feedback of each marker is handled in order
+    auto feedback_it = feedback_map_.begin();
+    while (feedback_it != feedback_map_.end() && markers_in_progress_.count(feedback_it->first))
+      ++feedback_it;
 
-    while (!feedback_map_.empty() && rclcpp::ok())
+    if (feedback_it == feedback_map_.end())
     {
-      auto feedback = feedback_map_.begin()->second;
-      feedback_map_.erase(feedback_map_.begin());
-      RCLCPP_DEBUG(LOGGER, "Processing feedback from map for marker [%s]", feedback->marker_name.c_str());
+      if (pending_pose_updates_.empty())
+      {
+        new_feedback_condition_.wait(ulock);
+      }
+      else
+      {
+        const auto publish_time = last_pose_publish_ + min_pose_publish_period_;
+        if (std::chrono::steady_clock::now() >= publish_time)
+          publishPendingPoseUpdates(ulock);
+        else
+          new_feedback_condition_.wait_until(ulock, publish_time);
+      }
+      continue;
+    }
+
+    auto feedback = feedback_it->second;
+    feedback_map_.erase(feedback_it);
+    markers_in_progress_.insert(feedback->marker_name);
+    processFeedback(feedback, ulock);
+    markers_in_progress_.erase(feedback->marker_name);
+    // newer feedback for this marker may have arrived while it was being processed
+    if (feedback_map_.count(feedback->marker_name))
+      new_feedback_condition_.notify_one();
+  }
+}
+
+void RobotInteraction::processFeedback(
+    const visualization_msgs::msg::InteractiveMarkerFeedback::ConstSharedPtr& feedback,
+    std::unique_lock<std::mutex>& ulock)
+{
+  RCLCPP_DEBUG(LOGGER, "Processing feedback from map for marker [%s]", feedback->marker_name.c_str());
+
+  std::map<std::string, std::size_t>::const_iterator it = shown_markers_.find(feedback->marker_name);
+  if (it == shown_markers_.end())
+  {
+    RCLCPP_ERROR(LOGGER,
+                 "Unknown marker name: '%s' (not published by RobotInteraction class) "
+                 "(should never have ended up in the feedback_map!)",
+                 feedback->marker_name.c_str());
+    return;
+  }
+  std::size_t u = feedback->marker_name.find_first_of('_');
+  if (u == std::string::npos || u < 4)
+  {
+    RCLCPP_ERROR(LOGGER, "Invalid marker name: '%s' (should never have ended up in the feedback_map!)",
+                 feedback->marker_name.c_str());
+    return;
+  }
+  std::string marker_class = feedback->marker_name.substr(0, 2);
+  std::string handler_name = feedback->marker_name.substr(3, u - 3);  // skip the ":"
+  std::map<std::string, InteractionHandlerPtr>::const_iterator jt = handlers_.find(handler_name);
+  if (jt == handlers_.end())
+  {
+    RCLCPP_ERROR(LOGGER, "Interactive Marker Handler '%s' is not known.", handler_name.c_str());
+    return;
+  }
 
-      std::map<std::string, std::size_t>::const_iterator it = shown_markers_.find(feedback->marker_name);
-      if (it == shown_markers_.end())
+  // we put this in a try-catch because user specified callbacks may be triggered
+  try
+  {
+    if (marker_class == "EE")
+    {
+      // make a copy of the data, so we do not lose it while we are unlocked
+      EndEffectorInteraction eef = active_eef_[it->second];
+      InteractionHandlerPtr ih = jt->second;
+      ulock.unlock();
+      try
       {
-        RCLCPP_ERROR(LOGGER,
-                     "Unknown marker name: '%s' (not published by RobotInteraction class) "
-                     "(should never have ended up in the feedback_map!)",
-                     feedback->marker_name.c_str());
-        continue;
+        ih->handleEndEffector(eef, feedback);
       }
-      std::size_t u = feedback->marker_name.find_first_of('_');
-      if (u == std::string::npos || u < 4)
+      catch (std::exception& ex)
       {
-        RCLCPP_ERROR(LOGGER, "Invalid marker name: '%s' (should never have ended up in the feedback_map!)",
-                     feedback->marker_name.c_str());
-        continue;
+        RCLCPP_ERROR(LOGGER, "Exception caught while handling end-effector update: %s", ex.what());
       }
-      std::string marker_class = feedback->marker_name.substr(0, 2);
-      std::string handler_name = feedback->marker_name.substr(3, u - 3);  // skip the ":"
-      std::map<std::string, InteractionHandlerPtr>::const_iterator jt = handlers_.find(handler_name);
-      if (jt == handlers_.end())
+      ulock.lock();
+    }
+    else if (marker_class == "JJ")
+    {
+      // make a copy of the data, so we do not lose it while we are unlocked
+      JointInteraction vj = active_vj_[it->second];
+      InteractionHandlerPtr ih = jt->second;
+      ulock.unlock();
+      try
       {
-        RCLCPP_ERROR(LOGGER, "Interactive Marker Handler '%s' is not known.", handler_name.c_str());
-        continue;
+        ih->handleJoint(vj, feedback);
       }
-
-      // we put this in a try-catch because user specified callbacks may be triggered
+      catch (std::exception& ex)
+      {
+        RCLCPP_ERROR(LOGGER, "Exception caught while handling joint update: %s", ex.what());
+      }
+      ulock.lock();
+    }
+    else if (marker_class == "GG")
+    {
+      InteractionHandlerPtr ih = jt->second;
+      GenericInteraction g = active_generic_[it->second];
+      ulock.unlock();
       try
       {
-        if (marker_class == "EE")
-        {
-          // make a copy of the data, so we do not lose it while we are unlocked
-          EndEffectorInteraction eef = active_eef_[it->second];
-          InteractionHandlerPtr ih = jt->second;
-          marker_access_lock_.unlock();
-          try
-          {
-            ih->handleEndEffector(eef, feedback);
-          }
-          catch (std::exception& ex)
-          {
-            RCLCPP_ERROR(LOGGER, "Exception caught while handling end-effector update: %s", ex.what());
-          }
-          marker_access_lock_.lock();
-        }
-        else if (marker_class == "JJ")
-        {
-          // make a copy of the data, so we do not lose it while we are unlocked
-          JointInteraction vj = active_vj_[it->second];
-          InteractionHandlerPtr ih = jt->second;
-          marker_access_lock_.unlock();
-          try
-          {
-            ih->handleJoint(vj, feedback);
-          }
-          catch (std::exception& ex)
-          {
-            RCLCPP_ERROR(LOGGER, "Exception caught while handling joint update: %s", ex.what());
-          }
-          marker_access_lock_.lock();
-        }
-        else if (marker_class == "GG")
-        {
-          InteractionHandlerPtr ih = jt->second;
-          GenericInteraction g = active_generic_[it->second];
-          marker_access_lock_.unlock();
-          try
-          {
-            ih->handleGeneric(g, feedback);
-          }
-          catch (std::exception& ex)
-          {
-            RCLCPP_ERROR(LOGGER, "Exception caught while handling joint update: %s", ex.what());
-          }
-          marker_access_lock_.lock();
-        }
-        else
-        {
-          RCLCPP_ERROR(LOGGER, "Unknown marker class ('%s') for marker '%s'", marker_class.c_str(),
-                       feedback->marker_name.c_str());
-        }
+        ih->handleGeneric(g, feedback);
       }
       catch (std::exception& ex)
       {
-        RCLCPP_ERROR(LOGGER, "Exception caught while processing event: %s", ex.what());
+        RCLCPP_ERROR(LOGGER, "Exception caught while handling joint update: %s", ex.what());
       }
+      ulock.lock();
     }
+    else
+    {
+      RCLCPP_ERROR(LOGGER, "Unknown marker class ('%s') for marker '%s'", marker_class.c_str(),
+                   feedback->marker_name.c_str());
+    }
+  }
+  catch (std::exception& ex)
+  {
+    RCLCPP_ERROR(LOGGER, "Exception caught while processing event: %s", ex.what());
   }
 }
 }  // namespace robot_interaction
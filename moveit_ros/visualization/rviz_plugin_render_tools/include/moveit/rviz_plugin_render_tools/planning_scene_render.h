@@ -41,6 +41,8 @@
 #include <moveit/rviz_plugin_render_tools/render_shapes.h>
 #include <rviz_common/properties/color_property.hpp>
 #include <OgreMaterial.h>
+#include <map>
+#include <string>
 
 namespace moveit_rviz_plugin
 {
@@ -67,6 +69,11 @@ public:
 
   void updateRobotPosition(const planning_scene::PlanningSceneConstPtr& scene);
 
+  /** \brief Render the robot and the world objects of \e scene.
+   *
+   * Only the world objects that changed since the last call are rendered again: objects that were moved are only
+   * repositioned, objects that were added, removed, reshaped or recolored are created or destroyed. The octomap is only
+   * rendered again when it changed. */
   void renderPlanningScene(const planning_scene::PlanningSceneConstPtr& scene,
                            const Ogre::ColourValue& default_scene_color,
                            const Ogre::ColourValue& default_attached_color, OctreeVoxelRenderMode voxel_render_mode,
@@ -74,9 +81,36 @@ public:
   void clear();
 
 private:
+  /** \brief The rendered shapes of a world object, in the frame of the object */
+  struct ObjectRender
+  {
+    Ogre::SceneNode* node;
+    RenderShapesPtr render_shapes;
+
+    // what was rendered, to detect changes
+    std::vector<shapes::ShapeConstPtr> shapes;
+    EigenSTL::vector_Isometry3d shape_poses;
+    Eigen::Isometry3d pose;
+    Ogre::ColourValue color;
+    double alpha;
+    std::size_t octomap_version;
+  };
+
+  /** \brief Render \e object, reusing \e render if only its pose changed */
+  void renderObject(const collision_detection::World::Object& object, ObjectRender& render,
+                    const Ogre::ColourValue& color, double alpha, std::size_t octomap_version);
+  void destroyObject(ObjectRender& render);
+
   Ogre::SceneNode* planning_scene_geometry_node_;
   rviz_common::DisplayContext* context_;
-  RenderShapesPtr render_shapes_;
   RobotStateVisualizationPtr scene_robot_;
+
+  std::map<std::string, ObjectRender> object_renders_;
+
+  // the settings the objects were last rendered with
+  OctreeVoxelRenderMode voxel_render_mode_;
+  OctreeVoxelColorMode voxel_color_mode_;
+  Ogre::ColourValue default_scene_color_;
+  double default_scene_alpha_;
 };
 }  // namespace moveit_rviz_plugin
@@ -115,6 +115,7 @@ private Q_SLOTS:
   void changedLoopDisplay();
   void changedShowTrail();
   void changedTrailStepSize();
+  void changedTrailDecimation();
   void changedTrajectoryTopic();
   void changedStateDisplayTime();
   void changedRobotColor();
@@ -135,6 +136,13 @@ protected:
   double getStateDisplayTime();
   void clearTrajectoryTrail();
 
+  /**
+   * \brief Select the waypoints of \e trajectory that are shown in the trail: every trail step size-th waypoint, at
+   * least the trail min joint distance apart, and at most trail max states of them, spread evenly along the path.
+   * The last waypoint is always included.
+   */
+  std::vector<std::size_t> selectTrailWaypoints(const robot_trajectory::RobotTrajectory& trajectory) const;
+
   // Handles actually drawing the robot along motion plans
   RobotStateVisualizationPtr display_path_robot_;
   std_msgs::msg::ColorRGBA default_attached_object_color_;
@@ -146,6 +154,7 @@ protected:
   robot_trajectory::RobotTrajectoryPtr displaying_trajectory_message_;
   robot_trajectory::RobotTrajectoryPtr trajectory_message_to_display_;
   std::vector<RobotStateVisualizationUniquePtr> trajectory_trail_;
+  std::vector<std::size_t> trajectory_trail_waypoints_;  // the waypoint shown by each robot of trajectory_trail_
   rclcpp::Subscription<moveit_msgs::msg::DisplayTrajectory>::SharedPtr trajectory_topic_sub_;
   bool animating_path_;
   bool drop_displaying_trajectory_;
@@ -178,6 +187,8 @@ protected:
   rviz_common::properties::ColorProperty* robot_color_property_;
   rviz_common::properties::BoolProperty* enable_robot_color_property_;
   rviz_common::properties::IntProperty* trail_step_size_property_;
+  rviz_common::properties::FloatProperty* trail_min_distance_property_;
+  rviz_common::properties::IntProperty* trail_max_states_property_;
 };
 
 }  // namespace moveit_rviz_plugin
@@ -42,17 +42,24 @@
 #include <OgreSceneNode.h>
 #include <OgreSceneManager.h>
 
+#include <algorithm>
+
 namespace moveit_rviz_plugin
 {
 PlanningSceneRender::PlanningSceneRender(Ogre::SceneNode* node, rviz_common::DisplayContext* context,
                                          const RobotStateVisualizationPtr& robot)
-  : planning_scene_geometry_node_(node->createChildSceneNode()), context_(context), scene_robot_(robot)
+  : planning_scene_geometry_node_(node->createChildSceneNode())
+  , context_(context)
+  , scene_robot_(robot)
+  , voxel_render_mode_(OCTOMAP_DISABLED)
+  , voxel_color_mode_(OCTOMAP_Z_AXIS_COLOR)
+  , default_scene_alpha_(0.0)
 {
-  render_shapes_ = std::make_shared<RenderShapes>(context);
 }
 
 PlanningSceneRender::~PlanningSceneRender()
 {
+  clear();
   context_->getSceneManager()->destroySceneNode(planning_scene_geometry_node_);
 }
 
@@ -68,7 +75,55 @@ void PlanningSceneRender::updateRobotPosition(const planning_scene::PlanningScen
 
 void PlanningSceneRender::clear()
 {
-  render_shapes_->clear();
+  for (auto& object_render : object_renders_)
+    destroyObject(object_render.second);
+  object_renders_.clear();
+}
+
+void PlanningSceneRender::destroyObject(ObjectRender& render)
+{
+  render.render_shapes.reset();  // the shapes are attached to the node
+  context_->getSceneManager()->destroySceneNode(render.node);
+  render.node = nullptr;
+}
+
+void PlanningSceneRender::renderObject(const collision_detection::World::Object& object, ObjectRender& render,
+                                       const Ogre::ColourValue& color, double alpha, std::size_t octomap_version)
+{
+  const bool reshaped = !render.node || render.shapes != object.shapes_ || render.color != color ||
+                        render.alpha != alpha || render.octomap_version != octomap_version ||
+                        render.shape_poses.size() != object.shape_poses_.size() ||
+                        !std::equal(render.shape_poses.begin(), render.shape_poses.end(), object.shape_poses_.begin(),
+                                    [](const Eigen::Isometry3d& a, const Eigen::Isometry3d& b) {
+                                      return a.matrix() == b.matrix();
+                                    });
+  if (reshaped)
+  {
+    if (!render.node)
+      render.node = planning_scene_geometry_node_->createChildSceneNode();
+    render.render_shapes = std::make_shared<RenderShapes>(context_);
+    for (std::size_t j = 0; j < object.shapes_.size(); ++j)
+    {
+      render.render_shapes->renderShape(render.node, object.shapes_[j].get(), object.shape_poses_[j],
+                                        voxel_render_mode_, voxel_color_mode_, color, alpha);
+    }
+    render.shapes = object.shapes_;
+    render.shape_poses = object.shape_poses_;
+    render.color = color;
+    render.alpha = alpha;
+    render.octomap_version = octomap_version;
+  }
+  else if (render.pose.matrix() == object.pose_.matrix())
+  {
+    return;
+  }
+
+  // the shapes are rendered relative to the object, so a moved object only moves its node
+  render.pose = object.pose_;
+  const Eigen::Vector3d translation = object.pose_.translation();
+  const Eigen::Quaterniond q(object.pose_.linear());
+  render.node->setPosition(Ogre::Vector3(translation.x(), translation.y(), translation.z()));
+  render.node->setOrientation(Ogre::Quaternion(q.w(), q.x(), q.y(), q.z()));
 }
 
 void PlanningSceneRender::renderPlanningScene(const planning_scene::PlanningSceneConstPtr& scene,
@@ -80,7 +135,15 @@ void PlanningSceneRender::renderPlanningScene(const planning_scene::PlanningScen
   if (!scene)
     return;
 
-  clear();
+  if (voxel_render_mode_ != octree_voxel_rendering || voxel_color_mode_ != octree_color_mode ||
+      default_scene_color_ != default_env_color || default_scene_alpha_ != default_scene_alpha)
+  {
+    clear();
+    voxel_render_mode_ = octree_voxel_rendering;
+    voxel_color_mode_ = octree_color_mode;
+    default_scene_color_ = default_env_color;
+    default_scene_alpha_ = default_scene_alpha;
+  }
 
   if (scene_robot_)
   {
@@ -97,10 +160,23 @@ void PlanningSceneRender::renderPlanningScene(const planning_scene::PlanningScen
     scene_robot_->update(moveit::core::RobotStateConstPtr(rs), color, color_map);
   }
 
-  const std::vector<std::string>& ids = scene->getWorld()->getObjectIds();
-  for (const std::string& id : ids)
+  // object colors and the parents of diff scenes are not versioned, so all objects are compared, but only the ones
+  // that changed touch Ogre
+  const collision_detection::WorldConstPtr& world = scene->getWorld();
+  const std::size_t octomap_version = scene->getOctomapVersion();
+
+  // both maps are sorted by id, so removed objects are found by walking them side by side
+  auto render_it = object_renders_.begin();
+  for (const auto& [id, object] : *world)
   {
-    collision_detection::CollisionEnv::ObjectConstPtr object = scene->getWorld()->getObject(id);
+    while (render_it != object_renders_.end() && render_it->first < id)
+    {
+      destroyObject(render_it->second);
+      render_it = object_renders_.erase(render_it);
+    }
+    if (render_it == object_renders_.end() || render_it->first != id)
+      render_it = object_renders_.emplace_hint(render_it, id, ObjectRender{});
+
     Ogre::ColourValue color = default_env_color;
     double alpha = default_scene_alpha;
     if (scene->hasObjectColor(id))
@@ -112,12 +188,15 @@ void PlanningSceneRender::renderPlanningScene(const planning_scene::PlanningScen
       color.a = c.a;
       alpha = c.a;
     }
-    for (std::size_t j = 0; j < object->shapes_.size(); ++j)
-    {
-      render_shapes_->renderShape(planning_scene_geometry_node_, object->shapes_[j].get(),
-                                  object->global_shape_poses_[j], octree_voxel_rendering, octree_color_mode, color,
-                                  alpha);
-    }
+    // the octomap is updated in place, so its shapes do not tell whether it changed
+    renderObject(*object, render_it->second, color, alpha,
+                 id == planning_scene::PlanningScene::OCTOMAP_NS ? octomap_version : 0);
+    ++render_it;
+  }
+  while (render_it != object_renders_.end())
+  {
+    destroyObject(render_it->second);
+    render_it = object_renders_.erase(render_it);
   }
 }
 }  // namespace moveit_rviz_plugin
@@ -127,6 +127,18 @@ TrajectoryVisualization::TrajectoryVisualization(rviz_common::properties::Proper
                                                                        widget, SLOT(changedTrailStepSize()), this);
   trail_step_size_property_->setMin(1);
 
+  trail_min_distance_property_ = new rviz_common::properties::FloatProperty(
+      "Trail Min Joint Distance", 0.0f,
+      "Waypoints closer than this joint-space distance to the previous trail state are left out of the trail.", widget,
+      SLOT(changedTrailDecimation()), this);
+  trail_min_distance_property_->setMin(0.0);
+
+  trail_max_states_property_ = new rviz_common::properties::IntProperty(
+      "Trail Max States", 100,
+      "The maximum number of robots shown in the trail. Longer trails are decimated evenly along the path.", widget,
+      SLOT(changedTrailDecimation()), this);
+  trail_max_states_property_->setMin(2);
+
   interrupt_display_property_ = new rviz_common::properties::BoolProperty(
       "Interrupt Display", false,
       "Immediately show newly planned trajectory, interrupting the currently displayed one.", widget);
@@ -197,6 +209,7 @@ void TrajectoryVisualization::setName(const QString& name)
 void TrajectoryVisualization::onRobotModelLoaded(const moveit::core::RobotModelConstPtr& robot_model)
 {
   robot_model_ = robot_model;
+  clearTrajectoryTrail();  // the trail robots were loaded for the previous model
 
   // Error check
   if (!robot_model_)
@@ -233,6 +246,56 @@ void TrajectoryVisualization::reset()
 void TrajectoryVisualization::clearTrajectoryTrail()
 {
   trajectory_trail_.clear();
+  trajectory_trail_waypoints_.clear();
+}
+
+std::vector<std::size_t>
+TrajectoryVisualization::selectTrailWaypoints(const robot_trajectory::RobotTrajectory& trajectory) const
+{
+  const std::size_t waypoint_count = trajectory.getWayPointCount();
+  const std::size_t step_size = trail_step_size_property_->getInt();
+  const double min_distance = trail_min_distance_property_->getFloat();
+  const std::size_t max_states = trail_max_states_property_->getInt();
+
+  // candidates by step size and distance, with the path length up to each of them
+  std::vector<std::size_t> candidates;
+  std::vector<double> path_length;
+  double length = 0.0;
+  for (std::size_t i = 0; i < waypoint_count; i += step_size)
+  {
+    if (!candidates.empty())
+    {
+      const double distance = trajectory.getWayPoint(i).distance(trajectory.getWayPoint(candidates.back()));
+      if (distance < min_distance)
+        continue;
+      length += distance;
+    }
+    candidates.push_back(i);
+    path_length.push_back(length);
+  }
+  // always include last trajectory point
+  if (candidates.back() != waypoint_count - 1)
+  {
+    length += trajectory.getLastWayPoint().distance(trajectory.getWayPoint(candidates.back()));
+    candidates.push_back(waypoint_count - 1);
+    path_length.push_back(length);
+  }
+  if (candidates.size() <= max_states)
+    return candidates;
+
+  // too many: take the candidates closest past evenly spaced path lengths, so that dense parts are thinned most
+  std::vector<std::size_t> selected;
+  std::size_t c = 0;
+  for (std::size_t k = 0; k < max_states && c < candidates.size(); ++k)
+  {
+    const double target = length * k / (max_states - 1);
+    while (c + 1 < candidates.size() && path_length[c] < target)
+      ++c;
+    selected.push_back(candidates[c++]);
+  }
+  if (selected.back() != waypoint_count - 1)
+    selected.back() = waypoint_count - 1;
+  return selected;
 }
 
 void TrajectoryVisualization::changedLoopDisplay()
@@ -244,34 +307,45 @@ void TrajectoryVisualization::changedLoopDisplay()
 
 void TrajectoryVisualization::changedShowTrail()
 {
-  clearTrajectoryTrail();
-
   if (!trail_display_property_->getBool())
+  {
+    clearTrajectoryTrail();
     return;
+  }
   robot_trajectory::RobotTrajectoryPtr t = trajectory_message_to_display_;
   if (!t)
     t = displaying_trajectory_message_;
-  if (!t)
+  if (!t || t->empty())
+  {
+    clearTrajectoryTrail();
     return;
+  }
 
-  int stepsize = trail_step_size_property_->getInt();
-  // always include last trajectory point
-  trajectory_trail_.resize(
-      static_cast<int>(std::ceil((t->getWayPointCount() + stepsize - 1) / static_cast<float>(stepsize))));
-  for (std::size_t i = 0; i < trajectory_trail_.size(); ++i)
+  trajectory_trail_waypoints_ = selectTrailWaypoints(*t);
+
+  // loading the robot meshes is the expensive part, so robots of the previous trail are kept and only moved
+  const std::size_t loaded = trajectory_trail_.size();
+  trajectory_trail_.resize(trajectory_trail_waypoints_.size());
+  for (std::size_t i = loaded; i < trajectory_trail_.size(); ++i)
   {
-    int waypoint_i = std::min(i * stepsize, t->getWayPointCount() - 1);  // limit to last trajectory point
     auto r =
         std::make_unique<RobotStateVisualization>(scene_node_, context_, "Trail Robot " + std::to_string(i), nullptr);
     r->load(*robot_model_->getURDF());
+    r->setAlpha(robot_path_alpha_property_->getFloat());
+    trajectory_trail_[i] = std::move(r);
+  }
+  for (std::size_t i = 0; i < trajectory_trail_.size(); ++i)
+  {
+    const RobotStateVisualizationUniquePtr& r = trajectory_trail_[i];
+    const int waypoint_i = trajectory_trail_waypoints_[i];
     r->setVisualVisible(display_path_visual_enabled_property_->getBool());
     r->setCollisionVisible(display_path_collision_enabled_property_->getBool());
-    r->setAlpha(robot_path_alpha_property_->getFloat());
     r->update(t->getWayPointPtr(waypoint_i), default_attached_object_color_);
     if (enable_robot_color_property_->getBool())
       setRobotColor(&(r->getRobot()), robot_color_property_->getColor());
+    else if (i < loaded)
+      unsetRobotColor(&(r->getRobot()));
     r->setVisible(display_->isEnabled() && (!animating_path_ || waypoint_i <= current_state_));
-    trajectory_trail_[i] = std::move(r);
   }
 }
 
@@ -281,6 +355,12 @@ void TrajectoryVisualization::changedTrailStepSize()
     changedShowTrail();
 }
 
+void TrajectoryVisualization::changedTrailDecimation()
+{
+  if (trail_display_property_->getBool())
+    changedShowTrail();
+}
+
 void TrajectoryVisualization::changedRobotPathAlpha()
 {
   display_path_robot_->setAlpha(robot_path_alpha_property_->getFloat());
@@ -498,10 +578,8 @@ void TrajectoryVisualization::update(double wall_dt, double sim_dt)
              (tm = displaying_trajectory_message_->getWayPointDurationFromPrevious(current_state_ + 1) / rt_factor) <
                  current_state_time_)
       {
+        // skipped waypoints are never rendered, so the robot is only moved to the waypoint reached below
         current_state_time_ -= tm;
-        // if we are stuck in the while loop we should move the robot along the path to keep up
-        if (tm < current_state_time_)
-          display_path_robot_->update(displaying_trajectory_message_->getWayPointPtr(current_state_));
         ++current_state_;
       }
     }
@@ -520,10 +598,7 @@ void TrajectoryVisualization::update(double wall_dt, double sim_dt)
         trajectory_slider_panel_->setSliderPosition(current_state_);
       display_path_robot_->update(displaying_trajectory_message_->getWayPointPtr(current_state_));
       for (std::size_t i = 0; i < trajectory_trail_.size(); ++i)
-      {
-        trajectory_trail_[i]->setVisible(
-            std::min(waypoint_count - 1, static_cast<int>(i) * trail_step_size_property_->getInt()) <= current_state_);
-      }
+        trajectory_trail_[i]->setVisible(static_cast<int>(trajectory_trail_waypoints_[i]) <= current_state_);
     }
     else
     {
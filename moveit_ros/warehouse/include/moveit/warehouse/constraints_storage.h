@@ -62,6 +62,10 @@ public:
 
   void addConstraints(const moveit_msgs::msg::Constraints& msg, const std::string& robot = "",
                       const std::string& group = "");
+  /** \brief Add all \e msgs, replacing constraints of the same names. The stored names are read once for the whole
+      batch. */
+  void addConstraints(const std::vector<moveit_msgs::msg::Constraints>& msgs, const std::string& robot = "",
+                      const std::string& group = "");
   bool hasConstraints(const std::string& name, const std::string& robot = "", const std::string& group = "") const;
   void getKnownConstraints(std::vector<std::string>& names, const std::string& robot = "",
                            const std::string& group = "") const;
@@ -72,6 +76,11 @@ public:
   bool getConstraints(ConstraintsWithMetadata& msg_m, const std::string& name, const std::string& robot = "",
                       const std::string& group = "") const;
 
+  /** \brief Get the constraints whose names match \e regex, sorted by name, with a single database query */
+  void getConstraints(const std::string& regex, std::vector<ConstraintsWithMetadata>& msgs,
+                      std::vector<std::string>& names, const std::string& robot = "",
+                      const std::string& group = "") const;
+
   void renameConstraints(const std::string& old_name, const std::string& new_name, const std::string& robot = "",
                          const std::string& group = "");
 
@@ -37,8 +37,10 @@
 #pragma once
 
 #include <warehouse_ros/database_connection.h>
-#include <vector>
+#include <regex>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace moveit_warehouse
 {
@@ -59,6 +61,26 @@ protected:
   /// Keep only the \e names that match \e regex
   void filterNames(const std::string& regex, std::vector<std::string>& names) const;
 
+  /// Keep only the \e names that match \e regex, and the \e items at the same positions
+  template <typename T>
+  void filterNames(const std::string& regex, std::vector<std::string>& names, std::vector<T>& items) const
+  {
+    if (regex.empty())
+      return;
+    std::regex r(regex);
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+      if (!std::regex_match(names[i], r))
+        continue;
+      names[kept] = std::move(names[i]);
+      items[kept] = std::move(items[i]);
+      ++kept;
+    }
+    names.resize(kept);
+    items.resize(kept);
+  }
+
   warehouse_ros::DatabaseConnection::Ptr conn_;
 };
 
@@ -41,6 +41,13 @@
 #include <moveit_msgs/msg/planning_scene.hpp>
 #include <moveit_msgs/msg/motion_plan_request.hpp>
 #include <moveit_msgs/msg/robot_trajectory.hpp>
+#include <octomap_msgs/msg/octomap.hpp>
+#include <shape_msgs/msg/mesh.hpp>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <moveit_warehouse_export.h>
 
@@ -53,6 +60,8 @@ typedef warehouse_ros::MessageWithMetadata<moveit_msgs::msg::RobotTrajectory>::C
 typedef warehouse_ros::MessageCollection<moveit_msgs::msg::PlanningScene>::Ptr PlanningSceneCollection;
 typedef warehouse_ros::MessageCollection<moveit_msgs::msg::MotionPlanRequest>::Ptr MotionPlanRequestCollection;
 typedef warehouse_ros::MessageCollection<moveit_msgs::msg::RobotTrajectory>::Ptr RobotTrajectoryCollection;
+typedef warehouse_ros::MessageCollection<shape_msgs::msg::Mesh>::Ptr MeshCollection;
+typedef warehouse_ros::MessageCollection<octomap_msgs::msg::Octomap>::Ptr OctomapCollection;
 
 MOVEIT_CLASS_FORWARD(PlanningSceneStorage);  // Defines PlanningSceneStoragePtr, ConstPtr, WeakPtr... etc
 
@@ -63,15 +72,30 @@ public:
 
   static const std::string PLANNING_SCENE_ID_NAME;
   static const std::string MOTION_PLAN_REQUEST_ID_NAME;
+  static const std::string MOTION_PLAN_REQUEST_GROUP_NAME;
+  static const std::string CONTENT_KEY_NAME;
+  static const std::string MESH_REFERENCES_NAME;
+  static const std::string OCTOMAP_REFERENCE_NAME;
 
   PlanningSceneStorage(warehouse_ros::DatabaseConnection::Ptr conn);
 
+  /** \brief Store \e scene, replacing a stored scene with the same name.
+
+      The meshes of collision objects and attached objects and the octomap are stored once per content, in collections
+      of their own, and the stored scene refers to them by a hash of their data. getPlanningScene() puts the data back
+      into the scene. Removing scenes does not remove the shared data, see pruneSharedData(). */
   void addPlanningScene(const moveit_msgs::msg::PlanningScene& scene);
   void addPlanningQuery(const moveit_msgs::msg::MotionPlanRequest& planning_query, const std::string& scene_name,
                         const std::string& query_name = "");
   void addPlanningResult(const moveit_msgs::msg::MotionPlanRequest& planning_query,
                          const moveit_msgs::msg::RobotTrajectory& result, const std::string& scene_name);
 
+  /** \brief Add the \e planning_queries for scene \e scene_name, like calling addPlanningQuery() for each of them.
+      \e query_names is either empty, to generate names, or holds one name per query. The stored queries are read
+      once for the whole batch instead of once per query. */
+  void addPlanningQueries(const std::vector<moveit_msgs::msg::MotionPlanRequest>& planning_queries,
+                          const std::string& scene_name, const std::vector<std::string>& query_names = {});
+
   bool hasPlanningScene(const std::string& name) const;
   void getPlanningSceneNames(std::vector<std::string>& names) const;
   void getPlanningSceneNames(const std::string& regex, std::vector<std::string>& names) const;
@@ -91,6 +115,21 @@ public:
   void getPlanningQueries(std::vector<MotionPlanRequestWithMetadata>& planning_queries,
                           std::vector<std::string>& query_names, const std::string& scene_name) const;
 
+  /** \brief Get the queries of scene \e scene_name whose names match \e regex, with a single database query */
+  void getPlanningQueries(const std::string& regex, std::vector<MotionPlanRequestWithMetadata>& planning_queries,
+                          std::vector<std::string>& query_names, const std::string& scene_name) const;
+
+  /** \brief Get the queries of scene \e scene_name for the planning group \e group. Only finds queries stored with
+      the group in their metadata, i.e. not those added by older versions of this class. */
+  void getPlanningQueriesForGroup(std::vector<MotionPlanRequestWithMetadata>& planning_queries,
+                                  std::vector<std::string>& query_names, const std::string& scene_name,
+                                  const std::string& group) const;
+
+  /** \brief Get the scene and query names of all stored queries, or of those for planning group \e group if it is
+      not empty. Only metadata is read. */
+  void getAllPlanningQueriesNames(std::vector<std::pair<std::string, std::string>>& scene_query_names,
+                                  const std::string& group = "") const;
+
   void getPlanningResults(std::vector<RobotTrajectoryWithMetadata>& planning_results, const std::string& scene_name,
                           const moveit_msgs::msg::MotionPlanRequest& planning_query) const;
   void getPlanningResults(std::vector<RobotTrajectoryWithMetadata>& planning_results, const std::string& scene_name,
@@ -106,18 +145,38 @@ public:
   void removePlanningResults(const std::string& scene_name);
   void removePlanningResults(const std::string& scene_name, const std::string& query_name);
 
+  /** \brief Remove the meshes and octomaps no stored scene refers to anymore. Returns the number of removed entries. */
+  std::size_t pruneSharedData();
+
   void reset();
 
 private:
   void createCollections();
 
+  /** \brief Store \e mesh in the mesh collection unless it is there already. Returns the key of the stored mesh, or
+      an empty string if the mesh has to be stored inline because a different mesh has the same key. */
+  std::string storeMesh(const shape_msgs::msg::Mesh& mesh);
+
+  /** \brief Put the meshes and the octomap the metadata of \e scene_m refers to back into \e scene, the message of
+      \e scene_m */
+  bool resolveSharedData(moveit_msgs::msg::PlanningScene& scene, const PlanningSceneWithMetadata& scene_m) const;
+
   std::string getMotionPlanRequestName(const moveit_msgs::msg::MotionPlanRequest& planning_query,
                                        const std::string& scene_name) const;
   std::string addNewPlanningRequest(const moveit_msgs::msg::MotionPlanRequest& planning_query,
                                     const std::string& scene_name, const std::string& query_name);
+  void insertPlanningRequest(const moveit_msgs::msg::MotionPlanRequest& planning_query, const std::string& scene_name,
+                             const std::string& query_name);
 
   PlanningSceneCollection planning_scene_collection_;
   MotionPlanRequestCollection motion_plan_request_collection_;
   RobotTrajectoryCollection robot_trajectory_collection_;
+  MeshCollection mesh_collection_;
+  OctomapCollection octomap_collection_;
+
+  // meshes loaded from or stored in the mesh collection, by key. Octomaps are not cached, they are rarely shared
+  // by many scenes and can be large.
+  mutable std::unordered_map<std::string, shape_msgs::msg::Mesh> mesh_cache_;
+  mutable std::mutex mesh_cache_mutex_;
 };
 }  // namespace moveit_warehouse
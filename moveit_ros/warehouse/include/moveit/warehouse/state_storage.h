@@ -60,6 +60,10 @@ public:
   RobotStateStorage(warehouse_ros::DatabaseConnection::Ptr conn);
 
   void addRobotState(const moveit_msgs::msg::RobotState& msg, const std::string& name, const std::string& robot = "");
+  /** \brief Add \e msgs under the corresponding \e names, replacing states of the same names. The stored names are
+      read once for the whole batch. */
+  void addRobotStates(const std::vector<moveit_msgs::msg::RobotState>& msgs, const std::vector<std::string>& names,
+                      const std::string& robot = "");
   bool hasRobotState(const std::string& name, const std::string& robot = "") const;
   void getKnownRobotStates(std::vector<std::string>& names, const std::string& robot = "") const;
   void getKnownRobotStates(const std::string& regex, std::vector<std::string>& names,
@@ -68,6 +72,10 @@ public:
   /** \brief Get the constraints named \e name. Return false on failure. */
   bool getRobotState(RobotStateWithMetadata& msg_m, const std::string& name, const std::string& robot = "") const;
 
+  /** \brief Get the states whose names match \e regex, sorted by name, with a single database query */
+  void getRobotStates(const std::string& regex, std::vector<RobotStateWithMetadata>& msgs,
+                      std::vector<std::string>& names, const std::string& robot = "") const;
+
   void renameRobotState(const std::string& old_name, const std::string& new_name, const std::string& robot = "");
 
   void removeRobotState(const std::string& name, const std::string& robot = "");
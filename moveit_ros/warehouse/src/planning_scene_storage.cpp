@@ -36,19 +36,102 @@
 
 #include <moveit/warehouse/planning_scene_storage.h>
 #include <utility>
+#include <fmt/format.h>
 #include <rclcpp/serialization.hpp>
 #include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
 
 const std::string moveit_warehouse::PlanningSceneStorage::DATABASE_NAME = "moveit_planning_scenes";
 
 const std::string moveit_warehouse::PlanningSceneStorage::PLANNING_SCENE_ID_NAME = "planning_scene_id";
 const std::string moveit_warehouse::PlanningSceneStorage::MOTION_PLAN_REQUEST_ID_NAME = "motion_request_id";
+const std::string moveit_warehouse::PlanningSceneStorage::MOTION_PLAN_REQUEST_GROUP_NAME = "group_id";
+const std::string moveit_warehouse::PlanningSceneStorage::CONTENT_KEY_NAME = "content_key";
+const std::string moveit_warehouse::PlanningSceneStorage::MESH_REFERENCES_NAME = "mesh_references";
+const std::string moveit_warehouse::PlanningSceneStorage::OCTOMAP_REFERENCE_NAME = "octomap_reference";
 
 using warehouse_ros::Metadata;
 using warehouse_ros::Query;
 
 static const rclcpp::Logger LOGGER = rclcpp::get_logger("moveit.ros.warehouse.planning_scene_storage");
 
+namespace
+{
+// the key in MESH_REFERENCES_NAME of a mesh that is stored inline in the scene
+const std::string INLINE_MESH = "-";
+
+// The meshes of the collision objects and attached objects of \e scene, in the order of MESH_REFERENCES_NAME
+std::vector<shape_msgs::msg::Mesh*> sceneMeshes(moveit_msgs::msg::PlanningScene& scene)
+{
+  std::vector<shape_msgs::msg::Mesh*> meshes;
+  for (moveit_msgs::msg::CollisionObject& object : scene.world.collision_objects)
+  {
+    for (shape_msgs::msg::Mesh& mesh : object.meshes)
+      meshes.push_back(&mesh);
+  }
+  for (moveit_msgs::msg::AttachedCollisionObject& attached_object : scene.robot_state.attached_collision_objects)
+  {
+    for (shape_msgs::msg::Mesh& mesh : attached_object.object.meshes)
+      meshes.push_back(&mesh);
+  }
+  return meshes;
+}
+
+// The key of the content of \e msg: a 64 bit FNV-1a hash of its serialization and the size of the serialization
+template <typename M>
+std::string contentKey(const M& msg)
+{
+  rclcpp::Serialization<M> serializer;
+  rclcpp::SerializedMessage serialized_msg;
+  serializer.serialize_message(&msg, &serialized_msg);
+  const std::size_t size = serialized_msg.size();
+  const uint8_t* data = serialized_msg.get_rcl_serialized_message().buffer;
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return fmt::format("{:016x}-{}", hash, size);
+}
+
+// Get the message stored under \e key in \e collection
+template <typename M>
+bool findContent(warehouse_ros::MessageCollection<M>& collection, const std::string& key, M& msg)
+{
+  Query::Ptr q = collection.createQuery();
+  q->append(moveit_warehouse::PlanningSceneStorage::CONTENT_KEY_NAME, key);
+  const auto found = collection.queryList(q, false);
+  if (found.empty())
+    return false;
+  msg = *found.back();
+  return true;
+}
+
+// Remove the messages in \e collection whose keys are not in \e referenced
+template <typename M>
+std::size_t removeUnreferencedContent(warehouse_ros::MessageCollection<M>& collection,
+                                      const std::set<std::string>& referenced)
+{
+  std::size_t removed = 0;
+  for (const auto& content : collection.queryList(collection.createQuery(), true))
+  {
+    if (!content->lookupField(moveit_warehouse::PlanningSceneStorage::CONTENT_KEY_NAME))
+      continue;
+    const std::string key = content->lookupString(moveit_warehouse::PlanningSceneStorage::CONTENT_KEY_NAME);
+    if (referenced.count(key))
+      continue;
+    Query::Ptr q = collection.createQuery();
+    q->append(moveit_warehouse::PlanningSceneStorage::CONTENT_KEY_NAME, key);
+    removed += collection.removeMessages(q);
+  }
+  return removed;
+}
+}  // namespace
+
 moveit_warehouse::PlanningSceneStorage::PlanningSceneStorage(warehouse_ros::DatabaseConnection::Ptr conn)
   : MoveItMessageStorage(std::move(conn))
 {
@@ -63,6 +146,18 @@ void moveit_warehouse::PlanningSceneStorage::createCollections()
       conn_->openCollectionPtr<moveit_msgs::msg::MotionPlanRequest>(DATABASE_NAME, "motion_plan_request");
   robot_trajectory_collection_ =
       conn_->openCollectionPtr<moveit_msgs::msg::RobotTrajectory>(DATABASE_NAME, "robot_trajectory");
+  mesh_collection_ = conn_->openCollectionPtr<shape_msgs::msg::Mesh>(DATABASE_NAME, "mesh");
+  octomap_collection_ = conn_->openCollectionPtr<octomap_msgs::msg::Octomap>(DATABASE_NAME, "octomap");
+
+  // all lookups select by scene and query name, queries can also be selected by group
+  planning_scene_collection_->ensureIndex(PLANNING_SCENE_ID_NAME);
+  motion_plan_request_collection_->ensureIndex(PLANNING_SCENE_ID_NAME);
+  motion_plan_request_collection_->ensureIndex(MOTION_PLAN_REQUEST_ID_NAME);
+  motion_plan_request_collection_->ensureIndex(MOTION_PLAN_REQUEST_GROUP_NAME);
+  robot_trajectory_collection_->ensureIndex(PLANNING_SCENE_ID_NAME);
+  robot_trajectory_collection_->ensureIndex(MOTION_PLAN_REQUEST_ID_NAME);
+  mesh_collection_->ensureIndex(CONTENT_KEY_NAME);
+  octomap_collection_->ensureIndex(CONTENT_KEY_NAME);
 }
 
 void moveit_warehouse::PlanningSceneStorage::reset()
@@ -70,6 +165,12 @@ void moveit_warehouse::PlanningSceneStorage::reset()
   planning_scene_collection_.reset();
   motion_plan_request_collection_.reset();
   robot_trajectory_collection_.reset();
+  mesh_collection_.reset();
+  octomap_collection_.reset();
+  {
+    std::scoped_lock lock(mesh_cache_mutex_);
+    mesh_cache_.clear();
+  }
   conn_->dropDatabase(DATABASE_NAME);
   createCollections();
 }
@@ -84,10 +185,145 @@ void moveit_warehouse::PlanningSceneStorage::addPlanningScene(const moveit_msgs:
   }
   Metadata::Ptr metadata = planning_scene_collection_->createMetadata();
   metadata->append(PLANNING_SCENE_ID_NAME, scene.name);
-  planning_scene_collection_->insert(scene, metadata);
+
+  // move meshes and the octomap to the shared collections, the scene keeps their keys
+  moveit_msgs::msg::PlanningScene stored_scene = scene;
+  std::string mesh_references;
+  for (shape_msgs::msg::Mesh* mesh : sceneMeshes(stored_scene))
+  {
+    std::string key = storeMesh(*mesh);
+    if (key.empty())
+      key = INLINE_MESH;
+    else
+      *mesh = shape_msgs::msg::Mesh();
+    mesh_references += mesh_references.empty() ? key : ' ' + key;
+  }
+  if (!mesh_references.empty())
+    metadata->append(MESH_REFERENCES_NAME, mesh_references);
+
+  if (!stored_scene.world.octomap.octomap.data.empty())
+  {
+    // the header differs between octomaps with the same content, it stays in the scene
+    octomap_msgs::msg::Octomap octomap = stored_scene.world.octomap.octomap;
+    octomap.header = std_msgs::msg::Header();
+    const std::string key = contentKey(octomap);
+    octomap_msgs::msg::Octomap stored_octomap;
+    const bool found = findContent(*octomap_collection_, key, stored_octomap);
+    if (!found)
+    {
+      Metadata::Ptr octomap_metadata = octomap_collection_->createMetadata();
+      octomap_metadata->append(CONTENT_KEY_NAME, key);
+      octomap_collection_->insert(octomap, octomap_metadata);
+    }
+    // the key is a hash, a different octomap with the same key is stored inline
+    if (!found || stored_octomap == octomap)
+    {
+      metadata->append(OCTOMAP_REFERENCE_NAME, key);
+      stored_scene.world.octomap.octomap.data.clear();
+    }
+  }
+
+  planning_scene_collection_->insert(stored_scene, metadata);
   RCLCPP_DEBUG(LOGGER, "%s scene '%s'", replace ? "Replaced" : "Added", scene.name.c_str());
 }
 
+std::string moveit_warehouse::PlanningSceneStorage::storeMesh(const shape_msgs::msg::Mesh& mesh)
+{
+  const std::string key = contentKey(mesh);
+  std::scoped_lock lock(mesh_cache_mutex_);
+  auto it = mesh_cache_.find(key);
+  if (it == mesh_cache_.end())
+  {
+    shape_msgs::msg::Mesh stored_mesh;
+    if (!findContent(*mesh_collection_, key, stored_mesh))
+    {
+      Metadata::Ptr metadata = mesh_collection_->createMetadata();
+      metadata->append(CONTENT_KEY_NAME, key);
+      mesh_collection_->insert(mesh, metadata);
+      stored_mesh = mesh;
+    }
+    it = mesh_cache_.emplace(key, std::move(stored_mesh)).first;
+  }
+  // the key is a hash, make sure it does not stand for a different mesh
+  return it->second == mesh ? key : std::string();
+}
+
+bool moveit_warehouse::PlanningSceneStorage::resolveSharedData(moveit_msgs::msg::PlanningScene& scene,
+                                                               const PlanningSceneWithMetadata& scene_m) const
+{
+  if (scene_m->lookupField(MESH_REFERENCES_NAME))
+  {
+    std::istringstream references(scene_m->lookupString(MESH_REFERENCES_NAME));
+    std::scoped_lock lock(mesh_cache_mutex_);
+    for (shape_msgs::msg::Mesh* mesh : sceneMeshes(scene))
+    {
+      std::string key;
+      if (!(references >> key))
+      {
+        RCLCPP_ERROR(LOGGER, "Planning scene '%s' refers to fewer meshes than it has", scene.name.c_str());
+        return false;
+      }
+      if (key == INLINE_MESH)
+        continue;
+      auto it = mesh_cache_.find(key);
+      if (it == mesh_cache_.end())
+      {
+        shape_msgs::msg::Mesh stored_mesh;
+        if (!findContent(*mesh_collection_, key, stored_mesh))
+        {
+          RCLCPP_ERROR(LOGGER, "Mesh '%s' of planning scene '%s' was not found in the database", key.c_str(),
+                       scene.name.c_str());
+          return false;
+        }
+        it = mesh_cache_.emplace(key, std::move(stored_mesh)).first;
+      }
+      *mesh = it->second;
+    }
+  }
+
+  if (scene_m->lookupField(OCTOMAP_REFERENCE_NAME))
+  {
+    const std::string key = scene_m->lookupString(OCTOMAP_REFERENCE_NAME);
+    octomap_msgs::msg::Octomap stored_octomap;
+    if (!findContent(*octomap_collection_, key, stored_octomap))
+    {
+      RCLCPP_ERROR(LOGGER, "Octomap '%s' of planning scene '%s' was not found in the database", key.c_str(),
+                   scene.name.c_str());
+      return false;
+    }
+    stored_octomap.header = scene.world.octomap.octomap.header;
+    scene.world.octomap.octomap = std::move(stored_octomap);
+  }
+  return true;
+}
+
+std::size_t moveit_warehouse::PlanningSceneStorage::pruneSharedData()
+{
+  std::set<std::string> referenced;
+  Query::Ptr q = planning_scene_collection_->createQuery();
+  for (const PlanningSceneWithMetadata& planning_scene : planning_scene_collection_->queryList(q, true))
+  {
+    if (planning_scene->lookupField(MESH_REFERENCES_NAME))
+    {
+      std::istringstream references(planning_scene->lookupString(MESH_REFERENCES_NAME));
+      std::string key;
+      while (references >> key)
+        referenced.insert(key);
+    }
+    if (planning_scene->lookupField(OCTOMAP_REFERENCE_NAME))
+      referenced.insert(planning_scene->lookupString(OCTOMAP_REFERENCE_NAME));
+  }
+
+  const std::size_t removed = removeUnreferencedContent(*mesh_collection_, referenced) +
+                              removeUnreferencedContent(*octomap_collection_, referenced);
+  {
+    std::scoped_lock lock(mesh_cache_mutex_);
+    mesh_cache_.clear();
+  }
+  RCLCPP_DEBUG(LOGGER, "Removed %zu meshes and octomaps no planning scene refers to", removed);
+  return removed;
+}
+
 bool moveit_warehouse::PlanningSceneStorage::hasPlanningScene(const std::string& name) const
 {
   Query::Ptr q = planning_scene_collection_->createQuery();
@@ -169,12 +405,75 @@ moveit_warehouse::PlanningSceneStorage::addNewPlanningRequest(const moveit_msgs:
       index++;
     } while (used.find(id) != used.end());
   }
+  insertPlanningRequest(planning_query, scene_name, id);
+  return id;
+}
+
+void moveit_warehouse::PlanningSceneStorage::insertPlanningRequest(
+    const moveit_msgs::msg::MotionPlanRequest& planning_query, const std::string& scene_name,
+    const std::string& query_name)
+{
   Metadata::Ptr metadata = motion_plan_request_collection_->createMetadata();
   metadata->append(PLANNING_SCENE_ID_NAME, scene_name);
-  metadata->append(MOTION_PLAN_REQUEST_ID_NAME, id);
+  metadata->append(MOTION_PLAN_REQUEST_ID_NAME, query_name);
+  metadata->append(MOTION_PLAN_REQUEST_GROUP_NAME, planning_query.group_name);
   motion_plan_request_collection_->insert(planning_query, metadata);
-  RCLCPP_DEBUG(LOGGER, "Saved planning query '%s' for scene '%s'", id.c_str(), scene_name.c_str());
-  return id;
+  RCLCPP_DEBUG(LOGGER, "Saved planning query '%s' for scene '%s'", query_name.c_str(), scene_name.c_str());
+}
+
+void moveit_warehouse::PlanningSceneStorage::addPlanningQueries(
+    const std::vector<moveit_msgs::msg::MotionPlanRequest>& planning_queries, const std::string& scene_name,
+    const std::vector<std::string>& query_names)
+{
+  if (!query_names.empty() && query_names.size() != planning_queries.size())
+    throw std::invalid_argument("Expected one name per planning query");
+
+  rclcpp::Serialization<moveit_msgs::msg::MotionPlanRequest> serializer;
+  const auto serialize = [&serializer](const moveit_msgs::msg::MotionPlanRequest& planning_query) {
+    rclcpp::SerializedMessage serialized_msg;
+    serializer.serialize_message(&planning_query, &serialized_msg);
+    const rcl_serialized_message_t& buffer = serialized_msg.get_rcl_serialized_message();
+    return std::string(reinterpret_cast<const char*>(buffer.buffer), buffer.buffer_length);
+  };
+
+  // read the stored queries once, the same lookups addPlanningQuery() does per query are then done in memory
+  Query::Ptr q = motion_plan_request_collection_->createQuery();
+  q->append(PLANNING_SCENE_ID_NAME, scene_name);
+  std::vector<MotionPlanRequestWithMetadata> existing_requests = motion_plan_request_collection_->queryList(q, false);
+  std::unordered_map<std::string, std::string> id_by_content;
+  std::set<std::string> used;
+  for (const MotionPlanRequestWithMetadata& existing_request : existing_requests)
+  {
+    const std::string id = existing_request->lookupString(MOTION_PLAN_REQUEST_ID_NAME);
+    id_by_content.emplace(serialize(*existing_request), id);
+    used.insert(id);
+  }
+  std::size_t index = existing_requests.size();
+
+  for (std::size_t i = 0; i < planning_queries.size(); ++i)
+  {
+    const std::string content = serialize(planning_queries[i]);
+    const auto existing = id_by_content.find(content);
+    const std::string id = existing == id_by_content.end() ? std::string() : existing->second;
+    std::string query_name = query_names.empty() ? std::string() : query_names[i];
+
+    if (!query_name.empty() && id.empty() && used.count(query_name))
+      removePlanningQuery(scene_name, query_name);
+
+    if (id != query_name || id.empty())
+    {
+      if (query_name.empty())
+      {
+        do
+        {
+          query_name = "Motion Plan Request " + std::to_string(index++);
+        } while (used.count(query_name));
+      }
+      insertPlanningRequest(planning_queries[i], scene_name, query_name);
+      id_by_content.emplace(content, query_name);
+      used.insert(query_name);
+    }
+  }
 }
 
 void moveit_warehouse::PlanningSceneStorage::addPlanningResult(const moveit_msgs::msg::MotionPlanRequest& planning_query,
@@ -235,10 +534,11 @@ bool moveit_warehouse::PlanningSceneStorage::getPlanningScene(PlanningSceneWithM
     return false;
   }
   scene_m = planning_scenes.back();
+  moveit_msgs::msg::PlanningScene& scene = const_cast<moveit_msgs::msg::PlanningScene&>(
+      static_cast<const moveit_msgs::msg::PlanningScene&>(*scene_m));
   // in case the scene was renamed, the name in the message may be out of date
-  const_cast<moveit_msgs::msg::PlanningScene*>(static_cast<const moveit_msgs::msg::PlanningScene*>(scene_m.get()))->name =
-      scene_name;
-  return true;
+  scene.name = scene_name;
+  return resolveSharedData(scene, scene_m);
 }
 
 bool moveit_warehouse::PlanningSceneStorage::getPlanningQuery(MotionPlanRequestWithMetadata& query_m,
@@ -326,6 +626,47 @@ void moveit_warehouse::PlanningSceneStorage::getPlanningQueries(
   }
 }
 
+void moveit_warehouse::PlanningSceneStorage::getPlanningQueries(
+    const std::string& regex, std::vector<MotionPlanRequestWithMetadata>& planning_queries,
+    std::vector<std::string>& query_names, const std::string& scene_name) const
+{
+  getPlanningQueries(planning_queries, query_names, scene_name);
+  filterNames(regex, query_names, planning_queries);
+}
+
+void moveit_warehouse::PlanningSceneStorage::getPlanningQueriesForGroup(
+    std::vector<MotionPlanRequestWithMetadata>& planning_queries, std::vector<std::string>& query_names,
+    const std::string& scene_name, const std::string& group) const
+{
+  Query::Ptr q = motion_plan_request_collection_->createQuery();
+  q->append(PLANNING_SCENE_ID_NAME, scene_name);
+  q->append(MOTION_PLAN_REQUEST_GROUP_NAME, group);
+  planning_queries = motion_plan_request_collection_->queryList(q, false, MOTION_PLAN_REQUEST_ID_NAME, true);
+  query_names.clear();
+  for (const MotionPlanRequestWithMetadata& planning_query : planning_queries)
+    query_names.push_back(planning_query->lookupField(MOTION_PLAN_REQUEST_ID_NAME) ?
+                              planning_query->lookupString(MOTION_PLAN_REQUEST_ID_NAME) :
+                              std::string());
+}
+
+void moveit_warehouse::PlanningSceneStorage::getAllPlanningQueriesNames(
+    std::vector<std::pair<std::string, std::string>>& scene_query_names, const std::string& group) const
+{
+  Query::Ptr q = motion_plan_request_collection_->createQuery();
+  if (!group.empty())
+    q->append(MOTION_PLAN_REQUEST_GROUP_NAME, group);
+  std::vector<MotionPlanRequestWithMetadata> planning_queries = motion_plan_request_collection_->queryList(q, true);
+  scene_query_names.clear();
+  for (const MotionPlanRequestWithMetadata& planning_query : planning_queries)
+  {
+    if (planning_query->lookupField(PLANNING_SCENE_ID_NAME) && planning_query->lookupField(MOTION_PLAN_REQUEST_ID_NAME))
+    {
+      scene_query_names.emplace_back(planning_query->lookupString(PLANNING_SCENE_ID_NAME),
+                                     planning_query->lookupString(MOTION_PLAN_REQUEST_ID_NAME));
+    }
+  }
+}
+
 void moveit_warehouse::PlanningSceneStorage::getPlanningResults(
     std::vector<RobotTrajectoryWithMetadata>& planning_results, const std::string& scene_name,
     const moveit_msgs::msg::MotionPlanRequest& planning_query) const
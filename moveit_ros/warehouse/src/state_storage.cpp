@@ -36,6 +36,8 @@
 
 #include <moveit/warehouse/state_storage.h>
 
+#include <set>
+#include <stdexcept>
 #include <utility>
 
 const std::string moveit_warehouse::RobotStateStorage::DATABASE_NAME = "moveit_robot_states";
@@ -57,6 +59,8 @@ moveit_warehouse::RobotStateStorage::RobotStateStorage(warehouse_ros::DatabaseCo
 void moveit_warehouse::RobotStateStorage::createCollections()
 {
   state_collection_ = conn_->openCollectionPtr<moveit_msgs::msg::RobotState>(DATABASE_NAME, "robot_states");
+  state_collection_->ensureIndex(STATE_NAME);
+  state_collection_->ensureIndex(ROBOT_NAME);
 }
 
 void moveit_warehouse::RobotStateStorage::reset()
@@ -82,6 +86,28 @@ void moveit_warehouse::RobotStateStorage::addRobotState(const moveit_msgs::msg::
   RCLCPP_DEBUG(LOGGER, "%s robot state '%s'", replace ? "Replaced" : "Added", name.c_str());
 }
 
+void moveit_warehouse::RobotStateStorage::addRobotStates(const std::vector<moveit_msgs::msg::RobotState>& msgs,
+                                                         const std::vector<std::string>& names,
+                                                         const std::string& robot)
+{
+  if (msgs.size() != names.size())
+    throw std::invalid_argument("Expected one name per robot state");
+
+  std::vector<std::string> known_names;
+  getKnownRobotStates(known_names, robot);
+  const std::set<std::string> known(known_names.begin(), known_names.end());
+  for (std::size_t i = 0; i < msgs.size(); ++i)
+  {
+    if (known.count(names[i]))
+      removeRobotState(names[i], robot);
+    Metadata::Ptr metadata = state_collection_->createMetadata();
+    metadata->append(STATE_NAME, names[i]);
+    metadata->append(ROBOT_NAME, robot);
+    state_collection_->insert(msgs[i], metadata);
+  }
+  RCLCPP_DEBUG(LOGGER, "Added %zu robot states", msgs.size());
+}
+
 bool moveit_warehouse::RobotStateStorage::hasRobotState(const std::string& name, const std::string& robot) const
 {
   Query::Ptr q = state_collection_->createQuery();
@@ -133,6 +159,21 @@ bool moveit_warehouse::RobotStateStorage::getRobotState(RobotStateWithMetadata&
   }
 }
 
+void moveit_warehouse::RobotStateStorage::getRobotStates(const std::string& regex,
+                                                         std::vector<RobotStateWithMetadata>& msgs,
+                                                         std::vector<std::string>& names,
+                                                         const std::string& robot) const
+{
+  Query::Ptr q = state_collection_->createQuery();
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  msgs = state_collection_->queryList(q, false, STATE_NAME, true);
+  names.clear();
+  for (const RobotStateWithMetadata& msg : msgs)
+    names.push_back(msg->lookupField(STATE_NAME) ? msg->lookupString(STATE_NAME) : std::string());
+  filterNames(regex, names, msgs);
+}
+
 void moveit_warehouse::RobotStateStorage::renameRobotState(const std::string& old_name, const std::string& new_name,
                                                            const std::string& robot)
 {
@@ -35,10 +35,14 @@
 /* Author: Dave Coleman */
 
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/utils/thread_placement.h>
+#include <moveit/utils/worker_pool.h>
 #include <moveit_setup_srdf_plugins/compute_default_collisions.hpp>
 #include <boost/math/special_functions/binomial.hpp>  // for statistics at end
 #include <boost/thread.hpp>
 #include <boost/assign.hpp>
+#include <algorithm>
+#include <atomic>
 #include <unordered_map>
 
 namespace moveit_setup
@@ -62,28 +66,20 @@ static const rclcpp::Logger LOGGER = rclcpp::get_logger("collision_updater");
 // Unique set of pairs of links in string-based form
 typedef std::set<std::pair<std::string, std::string> > StringPairSet;
 
-// Struct for passing parameters to threads, for cleaner code
-struct ThreadComputation
+// Number of random states a thread checks for "never in collision" before it shares the link pairs it found colliding
+// with the other threads and takes over theirs
+static const unsigned int NEVER_TRIAL_BATCH = 100;
+
+// State shared by the threads sampling for "never in collision"
+struct NeverInCollisionSampling
 {
-  ThreadComputation(planning_scene::PlanningScene& scene, const collision_detection::CollisionRequest& req,
-                    int thread_id, int num_trials, StringPairSet* links_seen_colliding, std::mutex* lock,
-                    unsigned int* progress)
-    : scene_(scene)
-    , req_(req)
-    , thread_id_(thread_id)
-    , num_trials_(num_trials)
-    , links_seen_colliding_(links_seen_colliding)
-    , lock_(lock)
-    , progress_(progress)
-  {
-  }
-  planning_scene::PlanningScene& scene_;
-  const collision_detection::CollisionRequest& req_;
-  int thread_id_;
-  unsigned int num_trials_;
-  StringPairSet* links_seen_colliding_;
-  std::mutex* lock_;
-  unsigned int* progress_;  // only to be updated by thread 0
+  std::mutex lock;
+  StringPairSet links_seen_colliding;  // guarded by lock
+  std::atomic<unsigned int> next_trial{ 0 };
+  std::atomic<unsigned int> trials_done{ 0 };
+  std::atomic<unsigned int> last_new_pair_trial{ 0 };  // end of the last batch in which a new colliding pair was found
+  std::atomic<bool> converged{ false };
+  std::atomic<bool> cancelled{ false };
 };
 
 // LinkGraph defines a Link's model and a set of unique links it connects
@@ -150,7 +146,8 @@ static unsigned int disableDefaultCollisions(planning_scene::PlanningScene& scen
  */
 static unsigned int disableAlwaysInCollision(planning_scene::PlanningScene& scene, LinkPairMap& link_pairs,
                                              collision_detection::CollisionRequest& req,
-                                             StringPairSet& links_seen_colliding, double min_collision_faction = 0.95);
+                                             StringPairSet& links_seen_colliding, moveit::core::WorkerPool& pool,
+                                             double min_collision_faction = 0.95);
 
 /**
  * \brief Get the pairs of links that are never in collision
@@ -158,24 +155,31 @@ static unsigned int disableAlwaysInCollision(planning_scene::PlanningScene& scen
  * \param link_pairs List of all unique link pairs and each pair's properties
  * \param req A reference to a collision request that is already initialized
  * \param links_seen_colliding Set of links that have at some point been seen in collision
+ * \param convergence_trials Stop once this many trials found no new colliding pair. 0 runs all trials.
  * \return number of never in collision links found and disabled
  */
 static unsigned int disableNeverInCollision(const unsigned int num_trials, planning_scene::PlanningScene& scene,
                                             LinkPairMap& link_pairs, const collision_detection::CollisionRequest& req,
-                                            StringPairSet& links_seen_colliding, unsigned int* progress);
+                                            StringPairSet& links_seen_colliding, unsigned int* progress,
+                                            moveit::core::WorkerPool& pool, const unsigned int convergence_trials);
 
 /**
  * \brief Thread for getting the pairs of links that are never in collision
- * \param tc Struct that encapsulates all the data each thread needs
+ * \param thread The number of the thread, thread 0 reports the progress
+ * \param sampling The state shared by the threads
  */
-static void disableNeverInCollisionThread(ThreadComputation tc);
+static void disableNeverInCollisionThread(const unsigned int num_trials, const planning_scene::PlanningScene& scene,
+                                          const collision_detection::CollisionRequest& req, unsigned int* progress,
+                                          const unsigned int convergence_trials, unsigned int thread,
+                                          NeverInCollisionSampling& sampling);
 
 // ******************************************************************************************
 // Generates an adjacency list of links that are always and never in collision, to speed up collision detection
 // ******************************************************************************************
 LinkPairMap computeDefaultCollisions(const planning_scene::PlanningSceneConstPtr& parent_scene, unsigned int* progress,
                                      const bool include_never_colliding, const unsigned int num_trials,
-                                     const double min_collision_fraction, const bool verbose)
+                                     const double min_collision_fraction, const bool verbose,
+                                     const unsigned int convergence_trials)
 {
   // Create new instance of planning scene using pointer
   planning_scene::PlanningScenePtr scene = parent_scene->diff();
@@ -227,10 +231,14 @@ LinkPairMap computeDefaultCollisions(const planning_scene::PlanningSceneConstPtr
   *progress = 6;  // Progress bar feedback
   boost::this_thread::interruption_point();
 
+  // The random states of the following steps are checked in parallel
+  moveit::core::WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()),
+                                moveit::core::thread_roles::SETUP_ASSISTANT);
+
   // 5. ALWAYS IN COLLISION --------------------------------------------------------------------
   // Compute the links that are always in collision
   unsigned int num_always =
-      disableAlwaysInCollision(*scene, link_pairs, req, links_seen_colliding, min_collision_fraction);
+      disableAlwaysInCollision(*scene, link_pairs, req, links_seen_colliding, pool, min_collision_fraction);
   // RCLCPP_INFO_STREAM(LOGGER, "Links seen colliding total = %d", int(links_seen_colliding.size()));
   *progress = 8;  // Progress bar feedback
   boost::this_thread::interruption_point();
@@ -240,7 +248,8 @@ LinkPairMap computeDefaultCollisions(const planning_scene::PlanningSceneConstPtr
   unsigned int num_never = 0;
   if (include_never_colliding)  // option of function
   {
-    num_never = disableNeverInCollision(num_trials, *scene, link_pairs, req, links_seen_colliding, progress);
+    num_never = disableNeverInCollision(num_trials, *scene, link_pairs, req, links_seen_colliding, progress, pool,
+                                        convergence_trials);
   }
 
   // RCLCPP_INFO_STREAM(LOGGER, "Link pairs seen colliding ever: %d", int(links_seen_colliding.size()));
@@ -478,7 +487,7 @@ unsigned int disableDefaultCollisions(planning_scene::PlanningScene& scene, Link
 // ******************************************************************************************
 unsigned int disableAlwaysInCollision(planning_scene::PlanningScene& scene, LinkPairMap& link_pairs,
                                       collision_detection::CollisionRequest& req, StringPairSet& links_seen_colliding,
-                                      double min_collision_faction)
+                                      moveit::core::WorkerPool& pool, double min_collision_faction)
 {
   // Trial count variables
   static const unsigned int SMALL_TRIAL_COUNT = 200;
@@ -488,31 +497,50 @@ unsigned int disableAlwaysInCollision(planning_scene::PlanningScene& scene, Link
   bool done = false;
   unsigned int num_disabled = 0;
 
+  // Every thread samples into its own state and statistics, which are merged after each round
+  std::vector<moveit::core::RobotState> robot_states(pool.size(), moveit::core::RobotState(scene.getRobotModel()));
+  std::vector<std::map<std::pair<std::string, std::string>, unsigned int>> thread_collision_counts(pool.size());
+  std::vector<std::size_t> thread_max_contacts(pool.size());
+
   while (!done)
   {
     // DO 'SMALL_TRIAL_COUNT' COLLISION CHECKS AND RECORD STATISTICS ---------------------------------------
     std::map<std::pair<std::string, std::string>, unsigned int> collision_count;
+    for (std::size_t thread = 0; thread < pool.size(); ++thread)
+    {
+      thread_collision_counts[thread].clear();
+      thread_max_contacts[thread] = 0;
+    }
 
     // Do a large number of tests
-    for (unsigned int i = 0; i < SMALL_TRIAL_COUNT; ++i)
-    {
+    pool.run(SMALL_TRIAL_COUNT, [&](std::size_t /* trial */, unsigned int thread) {
       // Check for collisions
       collision_detection::CollisionResult res;
-      scene.getCurrentStateNonConst().setToRandomPositions();
-      scene.checkSelfCollision(req, res);
+      robot_states[thread].setToRandomPositions();
+      scene.checkSelfCollision(req, res, robot_states[thread]);
 
       // Sum the number of collisions
-      unsigned int nc = 0;
+      std::size_t nc = 0;
       for (collision_detection::CollisionResult::ContactMap::const_iterator it = res.contacts.begin();
            it != res.contacts.end(); ++it)
       {
-        collision_count[it->first]++;
-        links_seen_colliding.insert(it->first);
+        thread_collision_counts[thread][it->first]++;
         nc += it->second.size();
       }
+      thread_max_contacts[thread] = std::max(thread_max_contacts[thread], nc);
+    });
+
+    for (std::size_t thread = 0; thread < pool.size(); ++thread)
+    {
+      for (const std::pair<const std::pair<std::string, std::string>, unsigned int>& count :
+           thread_collision_counts[thread])
+      {
+        collision_count[count.first] += count.second;
+        links_seen_colliding.insert(count.first);
+      }
 
       // Check if the number of contacts is greater than the max count
-      if (nc >= req.max_contacts)
+      if (thread_max_contacts[thread] >= req.max_contacts)
       {
         req.max_contacts *= 2;  // double the max contacts that the CollisionRequest checks for
         // RCLCPP_INFO_STREAM(LOGGER, "Doubling max_contacts to %d", int(req.max_contacts));
@@ -554,25 +582,29 @@ unsigned int disableAlwaysInCollision(planning_scene::PlanningScene& scene, Link
 // ******************************************************************************************
 unsigned int disableNeverInCollision(const unsigned int num_trials, planning_scene::PlanningScene& scene,
                                      LinkPairMap& link_pairs, const collision_detection::CollisionRequest& req,
-                                     StringPairSet& links_seen_colliding, unsigned int* progress)
+                                     StringPairSet& links_seen_colliding, unsigned int* progress,
+                                     moveit::core::WorkerPool& pool, const unsigned int convergence_trials)
 {
   unsigned int num_disabled = 0;
-  std::vector<std::thread> bgroup;
-  std::mutex lock;  // used for sharing the same data structures
-
-  int num_threads = std::thread::hardware_concurrency();  // how many cores does this computer have?
   // RCLCPP_INFO_STREAM_STREAM(LOGGER, "Performing " << num_trials << " trials for 'always in collision' checking on " <<
-  //   num_threads << " threads...");
+  //   pool.size() << " threads...");
 
-  for (int i = 0; i < num_threads; ++i)
-  {
-    ThreadComputation tc(scene, req, i, num_trials / num_threads, &links_seen_colliding, &lock, progress);
-    bgroup.push_back(std::thread([tc] { return disableNeverInCollisionThread(tc); }));
-  }
+  NeverInCollisionSampling sampling;
+  sampling.links_seen_colliding.swap(links_seen_colliding);
+  pool.run(pool.size(), [&](std::size_t /* index */, unsigned int thread) {
+    disableNeverInCollisionThread(num_trials, scene, req, progress, convergence_trials, thread, sampling);
+  });
+  links_seen_colliding.swap(sampling.links_seen_colliding);
+
+  // The threads only note a cancellation, so that it is not thrown out of the worker pool
+  if (sampling.cancelled)
+    boost::this_thread::interruption_point();
 
-  for (auto& thread : bgroup)
+  if (sampling.converged)
   {
-    thread.join();
+    RCLCPP_INFO_STREAM(LOGGER, "No new colliding link pairs were found in the last "
+                                   << convergence_trials << " trials, stopped after " << sampling.trials_done
+                                   << " of " << num_trials << " trials");
   }
 
   // Loop through every possible link pair and check if it has ever been seen in collision
@@ -601,48 +633,94 @@ unsigned int disableNeverInCollision(const unsigned int num_trials, planning_sce
 // ******************************************************************************************
 // Thread for getting the pairs of links that are never in collision
 // ******************************************************************************************
-void disableNeverInCollisionThread(ThreadComputation tc)
+void disableNeverInCollisionThread(const unsigned int num_trials, const planning_scene::PlanningScene& scene,
+                                   const collision_detection::CollisionRequest& req, unsigned int* progress,
+                                   const unsigned int convergence_trials, unsigned int thread,
+                                   NeverInCollisionSampling& sampling)
 {
-  // RCLCPP_INFO_STREAM_STREAM(LOGGER, "Thread " << tc.thread_id_ << " running " << tc.num_trials_ << " trials");
-
-  // User feedback vars
-  const unsigned int progress_interval = tc.num_trials_ / 20;  // show progress update every 5%
-
   // Create a new kinematic state for this thread to work on
-  moveit::core::RobotState robot_state(tc.scene_.getRobotModel());
+  moveit::core::RobotState robot_state(scene.getRobotModel());
+
+  // Pairs seen colliding are allowed in the thread's own collision matrix, so only the pairs that are still
+  // undecided are checked
+  collision_detection::AllowedCollisionMatrix acm = scene.getAllowedCollisionMatrix();
+  StringPairSet known_colliding;
+  std::vector<std::pair<std::string, std::string>> new_colliding;
 
-  // Do a large number of tests
-  for (unsigned int i = 0; i < tc.num_trials_; ++i)
+  while (true)
   {
-    boost::this_thread::interruption_point();
+    // Take over the pairs found by the other threads and share the new ones of this thread
+    {
+      std::scoped_lock slock(sampling.lock);
+      if (!new_colliding.empty())
+      {
+        sampling.links_seen_colliding.insert(new_colliding.begin(), new_colliding.end());
+        new_colliding.clear();
+      }
+      if (known_colliding.size() < sampling.links_seen_colliding.size())
+      {
+        for (const std::pair<std::string, std::string>& link_pair : sampling.links_seen_colliding)
+        {
+          if (known_colliding.insert(link_pair).second)
+            acm.setEntry(link_pair.first, link_pair.second, true);
+        }
+      }
+    }
+
+    if (boost::this_thread::interruption_requested())
+      sampling.cancelled = true;
+    if (sampling.cancelled || sampling.converged)
+      break;
 
-    // Status update at intervals and only for 0 thread
-    if (i % progress_interval == 0 && tc.thread_id_ == 0)
+    // Stop at the end, or once the pair statistics have converged
+    const unsigned int first_trial = sampling.next_trial.fetch_add(NEVER_TRIAL_BATCH);
+    if (first_trial >= num_trials)
+      break;
+    if (convergence_trials > 0 && first_trial >= sampling.last_new_pair_trial + convergence_trials)
     {
-      (*tc.progress_) = i * 92 / tc.num_trials_ + 8;  // 8 is the amount of progress already completed in prev steps
+      sampling.converged = true;
+      break;
     }
+    const unsigned int end_trial = std::min(first_trial + NEVER_TRIAL_BATCH, num_trials);
 
-    collision_detection::CollisionResult res;
-    robot_state.setToRandomPositions();
-    tc.scene_.checkSelfCollision(tc.req_, res, robot_state);
+    // Status update and only for 0 thread
+    if (thread == 0)
+    {
+      (*progress) = first_trial * 92 / num_trials + 8;  // 8 is the amount of progress already completed in prev steps
+    }
 
-    // Check all contacts
-    for (collision_detection::CollisionResult::ContactMap::const_iterator it = res.contacts.begin();
-         it != res.contacts.end(); ++it)
+    for (unsigned int i = first_trial; i < end_trial; ++i)
     {
-      // Check if this collision pair is unique before doing a thread lock
-      if (tc.links_seen_colliding_->find(it->first) == tc.links_seen_colliding_->end())
-      {
-        // Collision Matrix and links_seen_colliding is modified only if needed, based on above if statement
+      collision_detection::CollisionResult res;
+      robot_state.setToRandomPositions();
+      scene.checkSelfCollision(req, res, robot_state, acm);
 
-        std::scoped_lock slock(*tc.lock_);
-        tc.links_seen_colliding_->insert(it->first);
+      // Check all contacts
+      for (collision_detection::CollisionResult::ContactMap::const_iterator it = res.contacts.begin();
+           it != res.contacts.end(); ++it)
+      {
+        if (known_colliding.insert(it->first).second)
+        {
+          new_colliding.push_back(it->first);
+          acm.setEntry(it->first.first, it->first.second, true);  // disable link checking in the collision matrix
+        }
+      }
+    }
 
-        tc.scene_.getAllowedCollisionMatrixNonConst().setEntry(it->first.first, it->first.second,
-                                                               true);  // disable link checking in the collision matrix
+    sampling.trials_done += end_trial - first_trial;
+    if (!new_colliding.empty())
+    {
+      unsigned int last_new_pair_trial = sampling.last_new_pair_trial;
+      while (last_new_pair_trial < end_trial &&
+             !sampling.last_new_pair_trial.compare_exchange_weak(last_new_pair_trial, end_trial))
+      {
       }
     }
   }
+
+  // Share the pairs of the last batch
+  std::scoped_lock slock(sampling.lock);
+  sampling.links_seen_colliding.insert(new_colliding.begin(), new_colliding.end());
 }
 
 // ******************************************************************************************
@@ -162,9 +162,10 @@ void DefaultCollisions::generateCollisionTable(unsigned int num_trials, double m
   // clear previously loaded collision matrix entries
   srdf_config_->getPlanningScene()->getAllowedCollisionMatrixNonConst().clear();
 
-  // Find the default collision matrix - all links that are allowed to collide
+  // Find the default collision matrix - all links that are allowed to collide.
+  // Sampling stops early once the last quarter of the trials found no new colliding link pair.
   link_pairs_ = computeDefaultCollisions(srdf_config_->getPlanningScene(), &progress_, include_never_colliding,
-                                         num_trials, min_frac, verbose);
+                                         num_trials, min_frac, verbose, num_trials / 4);
 
   // End the progress bar loop
   progress_ = 100;